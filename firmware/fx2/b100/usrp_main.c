@@ -75,11 +75,15 @@ get_ep0_data (void)
     ;
 }
 
+//set when a packet ended with a flush: the ZLP goes out once EP6 has drained
+static bit zlp_pending = 0;
+
 static void initialize_gpif_buffer(int ep) {
   //clear the GPIF buffers on startup to keep crap out of the data path
   FIFORESET = 0x80; SYNCDELAY; //activate NAKALL
   FIFORESET = ep; SYNCDELAY;
   FIFORESET = 0x00; SYNCDELAY;
+  if (ep == 6) zlp_pending = 0; //the packet it would end is gone
 }
 
 /*
@@ -254,13 +258,20 @@ inline static void handle_data_read(void) {
     while (!(GPIFTRIG & bmGPIF_IDLE));
     INPKTEND = 0x06;	// tell USB we filled buffer (6 is our endpoint num)
     SYNCDELAY;
-    if(SHORT_PACKET_DETECTED) {
-        while(!(EP6CS & bmEPEMPTY)); //wait for packet to send
-        INPKTEND = 0x06; //send a ZLP
-        //toggle_led_1(); //FIXME DEBUG
-    }
+    if(SHORT_PACKET_DETECTED) zlp_pending = 1; //end the transfer after this packet
+}
+
+//the ZLP must follow the last frame of the packet, so it waits for EP6 to drain,
+//meanwhile no data is read for EP6 but the other paths keep running
+inline static void handle_zlp(void) {
+    if (!(EP6CS & bmEPEMPTY)) return;
+    INPKTEND = 0x06; //send a ZLP
+    SYNCDELAY;
+    zlp_pending = 0;
 }
 
+#define can_data_read() (!zlp_pending && fx2_has_room_for_data_packet() && fpga_has_data_packet_avail())
+
 inline static void handle_ctrl_read(void) {
     GPIFTCB1 = 0x00;
     GPIFTCB0 = 0x10;
@@ -294,24 +305,25 @@ main_loop (void)
       usb_handle_setup_packet ();
 
     if(enable_gpif){
+        if  (zlp_pending)                                                       handle_zlp();
         if  (fx2_has_ctrl_packet_avail()    && fpga_has_room_for_ctrl_packet()) handle_ctrl_write();
         if  (fx2_has_room_for_ctrl_packet() && fpga_has_ctrl_packet_avail())    handle_ctrl_read();
         
         //we do this
         if  (fx2_has_data_packet_avail()    && fpga_has_room_for_data_packet()) handle_data_write();
-        if  (fx2_has_room_for_data_packet() && fpga_has_data_packet_avail())    handle_data_read();
+        if  (can_data_read())                                                   handle_data_read();
         //five times so that
         if  (fx2_has_data_packet_avail()    && fpga_has_room_for_data_packet()) handle_data_write();
-        if  (fx2_has_room_for_data_packet() && fpga_has_data_packet_avail())    handle_data_read();
+        if  (can_data_read())                                                   handle_data_read();
         //we can piggyback
         if  (fx2_has_data_packet_avail()    && fpga_has_room_for_data_packet()) handle_data_write();
-        if  (fx2_has_room_for_data_packet() && fpga_has_data_packet_avail())    handle_data_read();
+        if  (can_data_read())                                                   handle_data_read();
         //data transfers
         if  (fx2_has_data_packet_avail()    && fpga_has_room_for_data_packet()) handle_data_write();
-        if  (fx2_has_room_for_data_packet() && fpga_has_data_packet_avail())    handle_data_read();
+        if  (can_data_read())                                                   handle_data_read();
         //without loop overhead
         if  (fx2_has_data_packet_avail()    && fpga_has_room_for_data_packet()) handle_data_write();
-        if  (fx2_has_room_for_data_packet() && fpga_has_data_packet_avail())    handle_data_read();
+        if  (can_data_read())                                                   handle_data_read();
     }
   }
 }
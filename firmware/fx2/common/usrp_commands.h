@@ -56,6 +56,9 @@
 
 #define VRQ_FW_COMPAT 0x83 //low 16 bits
 
+#define	VRQ_GET_BATCH_SEQ		0x84		// returns 2 bytes, LSB first:
+							// the wValue of the last VRQ_SPI_WRITE_BATCH applied
+
 // OUT commands
 
 #define	VRQ_SET_LED			0x01		// wValueL off/on {0,1}; wIndexL: which {0,1}
@@ -93,6 +96,22 @@
 #define VRQ_ENABLE_GPIF			0x0d
 #define VRQ_CLEAR_FPGA_FIFO     0x0e
 
+#define VRQ_SET_STATUS_EP		0x0f		// wValueL: {0,1}
+// when enabled, the under/over run flags are pushed on the status
+// interrupt endpoint (ep1 IN) as soon as they are recorded.
+// each status packet is STATUS_EP_LEN bytes:
+#define		STATUS_EP_TX_UNDERRUN		0	// byte offset: {0,1}
+#define		STATUS_EP_RX_OVERRUN		1	// byte offset: {0,1}
+#define		STATUS_EP_LEN			2
+
+#define	VRQ_SPI_WRITE_BATCH		0x10		// wValue: batch sequence number
+							// data: spi write records, none spans a 64 byte packet
+// each record is SPI_BATCH_HDR_LEN bytes followed by len data bytes:
+// len, enables, format, header_hi, header_lo
+// a zero len ends the records of a packet (padding).
+// the batch stops at the first failed write and stalls the endpoint.
+#define		SPI_BATCH_HDR_LEN		5
+
 
 // -------------------------------------------------------------------
 // we store the hashes at fixed addresses in the FX2 internal memory
@@ -55,7 +55,7 @@ init_usrp (void)
   // configure end points
 
   EP1OUTCFG = bmVALID | bmBULK;				SYNCDELAY;
-  EP1INCFG  = bmVALID | bmBULK | bmIN;			SYNCDELAY;
+  EP1INCFG  = bmVALID | bmINTERRUPT | bmIN;		SYNCDELAY;	// status IN
 
   EP2CFG    = bmVALID | bmBULK | bmQUADBUF;		SYNCDELAY;	// 512 quad bulk OUT
   EP4CFG    = 0;					SYNCDELAY;	// disabled
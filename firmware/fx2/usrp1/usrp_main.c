@@ -57,6 +57,8 @@ unsigned char g_tx_enable = 0;
 unsigned char g_rx_enable = 0;
 unsigned char g_rx_overrun = 0;
 unsigned char g_tx_underrun = 0;
+unsigned char g_status_ep_enable = 0;
+unsigned short g_batch_seq = 0;
 
 /*
  * the host side fpga loader code pushes an MD5 hash of the bitstream
@@ -74,6 +76,53 @@ get_ep0_data (void)
     ;
 }
 
+/*
+ * Apply the spi write records of one EP0 packet.
+ * Returns non-zero if all writes succeed.
+ */
+static unsigned char
+spi_write_batch_packet (xdata unsigned char *p, unsigned char n)
+{
+  unsigned char len;
+
+  while (n >= SPI_BATCH_HDR_LEN && p[0] != 0){
+    len = p[0];
+    if (n < SPI_BATCH_HDR_LEN + len)
+      return 0;
+
+    if (!spi_write (p[3], p[4], p[1], p[2], p + SPI_BATCH_HDR_LEN, len))
+      return 0;
+
+    p += SPI_BATCH_HDR_LEN + len;
+    n -= SPI_BATCH_HDR_LEN + len;
+  }
+  return 1;
+}
+
+/*
+ * Receive a batch one EP0 packet at a time and apply its records.
+ */
+static unsigned char
+spi_write_batch (void)
+{
+  unsigned short remaining = (wLengthH << 8) | wLengthL;
+  unsigned short seq = (wValueH << 8) | wValueL;
+
+  while (remaining != 0){
+    get_ep0_data ();
+    if (EP0BCL == 0 || EP0BCL > remaining)
+      return 0;
+
+    if (!spi_write_batch_packet (EP0BUF, EP0BCL))
+      return 0;
+
+    remaining -= EP0BCL;
+  }
+
+  g_batch_seq = seq;
+  return 1;
+}
+
 /*
  * Handle our "Vendor Extension" commands on endpoint 0.
  * If we handle this one, return non-zero.
@@ -127,6 +176,13 @@ app_vendor_cmd (void)
       EP0BCL = wLengthL;
       break;
 
+    case VRQ_GET_BATCH_SEQ:
+      EP0BUF[0] = g_batch_seq & 0xff;
+      EP0BUF[1] = g_batch_seq >> 8;
+      EP0BCH = 0;
+      EP0BCL = 2;
+      break;
+
     default:
       return 0;
     }
@@ -193,6 +249,10 @@ app_vendor_cmd (void)
       fpga_set_rx_reset (wValueL);
       break;
 
+    case VRQ_SET_STATUS_EP:
+      g_status_ep_enable = wValueL;
+      break;
+
     case VRQ_I2C_WRITE:
       get_ep0_data ();
       if (!i2c_write (wValueL, EP0BUF, EP0BCL))
@@ -205,6 +265,9 @@ app_vendor_cmd (void)
 	return 0;
       break;
 
+    case VRQ_SPI_WRITE_BATCH:
+      return spi_write_batch ();
+
     default:
       return 0;
     }
@@ -248,6 +311,19 @@ main_loop (void)
 	fpga_clear_flags ();
       }
 
+      // Push any recorded under/over run on the status endpoint,
+      // so the host does not have to poll for it.
+
+      if (g_status_ep_enable && (g_tx_underrun || g_rx_overrun)
+	  && !(EP1INCS & bmEPBUSY)){	// status endpoint buffer is free...
+
+	EP1INBUF[STATUS_EP_TX_UNDERRUN] = g_tx_underrun;
+	EP1INBUF[STATUS_EP_RX_OVERRUN] = g_rx_overrun;
+	g_tx_underrun = 0;
+	g_rx_overrun = 0;
+	EP1INBC = STATUS_EP_LEN;	// arm the endpoint
+      }
+
       // Next see if there are any "OUT" packets waiting for our attention,
       // and if so, if there's room in the FPGA's FIFO for them.
 
@@ -19,6 +19,7 @@
 #include "u2_init.h"
 #include "spi.h"
 #include "i2c.h"
+#include "i2c_async.h"
 #include "hal_io.h"
 #include "pic.h"
 
@@ -47,12 +48,49 @@
 //virtual registers in the firmware to store persistent values
 static uint32_t fw_regs[8];
 
-static void handle_udp_data_packet(
-    struct socket_address src, struct socket_address dst,
-    unsigned char *payload, int payload_len
-){
-    //handle ICMP destination unreachable
-    if (payload == NULL) switch(src.port){
+/***********************************************************************
+ * Data framers: programmed by a control packet or the first data packet
+ **********************************************************************/
+#define NUM_FRAMERS 4
+
+//the host socket that each framer streams to, valid once programmed
+static struct socket_address framer_hosts[NUM_FRAMERS];
+static bool framer_valid[NUM_FRAMERS];
+
+//map a dsp port to its framer table entry, return false for other ports
+static bool framer_which(uint16_t dsp_port, size_t *which){
+    switch(dsp_port){
+    case USRP2_UDP_RX_DSP0_PORT: *which = 0; return true;
+    case USRP2_UDP_TX_DSP0_PORT: *which = 1; return true;
+    case USRP2_UDP_RX_DSP1_PORT: *which = 2; return true;
+    case USRP2_UDP_TX_DSP1_PORT: *which = 3; return true;
+    default: return false;
+    }
+}
+
+//program the framer of a dsp port to stream to the host socket,
+//a framer that already streams there is left alone
+static bool program_framer(struct socket_address host, uint16_t dsp_port){
+    size_t which;
+    if (!framer_which(dsp_port, &which)) return false;
+    if (framer_valid[which] && framer_hosts[which].port == host.port
+        && framer_hosts[which].addr.addr == host.addr.addr) return true;
+
+    eth_mac_addr_t eth_mac_host;
+    if (!arp_cache_lookup_mac(&host.addr, &eth_mac_host)) return false;
+    struct socket_address dsp;
+    dsp.port = dsp_port;
+    dsp.addr = *get_ip_addr();
+    setup_framer(eth_mac_host, *ethernet_mac_addr(), host, dsp, which);
+
+    framer_hosts[which] = host;
+    framer_valid[which] = true;
+    return true;
+}
+
+//the host socket of a dsp went away (ICMP destination unreachable)
+static void handle_udp_data_unreachable(uint16_t dsp_port){
+    switch(dsp_port){
     case USRP2_UDP_RX_DSP0_PORT:
         //the end continuous streaming command
         sr_rx_ctrl0->cmd = 1 << 31 | 1 << 28; //no samples now
@@ -72,33 +110,234 @@ static void handle_udp_data_packet(
         sr_tx_ctrl->cyc_per_up = 0;
         break;
 
+    case USRP2_UDP_TX_DSP1_PORT:
+        //end async update packets per second
+        sr_tx_ctrl1->cyc_per_up = 0;
+        break;
+
     default: return;
     }
 
-    //handle an incoming UDP packet
-    size_t which = 0;
-    if (payload != 0) switch(dst.port){
-    case USRP2_UDP_RX_DSP0_PORT:
-        which = 0;
-        break;
+    //the next host must program the framer again
+    size_t which;
+    if (framer_which(dsp_port, &which)) framer_valid[which] = false;
+}
 
-    case USRP2_UDP_RX_DSP1_PORT:
-        which = 2;
-        break;
+static void handle_udp_data_packet(
+    struct socket_address src, struct socket_address dst,
+    unsigned char *payload, int payload_len
+){
+    if (payload == NULL) return handle_udp_data_unreachable(src.port);
 
-    case USRP2_UDP_TX_DSP0_PORT:
-        which = 1;
-        break;
+    //a data packet from the host: stream back to its socket
+    program_framer(src, dst.port);
+}
+
+#define OTW_GPIO_BANK_TO_NUM(bank) \
+    (((bank) == USRP2_DIR_RX)? (GPIO_RX_BANK) : (GPIO_TX_BANK))
+
+static uint32_t do_spi_transact(
+    uint8_t readback, uint32_t dev, uint32_t data,
+    uint8_t num_bits, uint8_t mosi_edge, uint8_t miso_edge
+){
+    return spi_transact(
+        (readback == 0)? SPI_TXONLY : SPI_TXRX,
+        dev,      //which device
+        data,     //32 bit data
+        num_bits, //length in bits
+        (mosi_edge == USRP2_CLK_EDGE_RISE)? SPIF_PUSH_FALL : SPIF_PUSH_RISE |
+        (miso_edge == USRP2_CLK_EDGE_RISE)? SPIF_LATCH_RISE : SPIF_LATCH_FALL
+    );
+}
+
+//perform a register or spi action, return the readback value
+static uint32_t do_reg_action(uint8_t action, uint32_t addr, uint32_t data){
+    switch(action){
+        case USRP2_REG_ACTION_FPGA_PEEK32:
+            return *((uint32_t *) addr);
+
+        case USRP2_REG_ACTION_FPGA_PEEK16:
+            return *((uint16_t *) addr);
+
+        case USRP2_REG_ACTION_FPGA_POKE32:
+            *((uint32_t *) addr) = (uint32_t)data;
+            break;
+
+        case USRP2_REG_ACTION_FPGA_POKE16:
+            *((uint16_t *) addr) = (uint16_t)data;
+            break;
+
+        case USRP2_REG_ACTION_FW_PEEK32:
+            return fw_regs[addr];
+
+        case USRP2_REG_ACTION_FW_POKE32:
+            fw_regs[addr] = data;
+            break;
 
-    default: return;
     }
+    return data;
+}
 
-    eth_mac_addr_t eth_mac_host; arp_cache_lookup_mac(&src.addr, &eth_mac_host);
-    setup_framer(eth_mac_host, *ethernet_mac_addr(), src, dst, which);
+//perform one operation from an ops packet, return the readback value
+static uint32_t do_ctrl_op(const usrp2_ctrl_op_t *op){
+    switch(op->action){
+        case USRP2_REG_ACTION_SPI_WRITE:
+        case USRP2_REG_ACTION_SPI_READ:
+            return do_spi_transact(
+                (op->action == USRP2_REG_ACTION_SPI_READ)? 1 : 0,
+                op->addr, op->data, op->num_bits, op->mosi_edge, op->miso_edge
+            );
+
+        default:
+            return do_reg_action(op->action, op->addr, op->data);
+    }
 }
 
-#define OTW_GPIO_BANK_TO_NUM(bank) \
-    (((bank) == USRP2_DIR_RX)? (GPIO_RX_BANK) : (GPIO_TX_BANK))
+/***********************************************************************
+ * Timed ops: queued by the control handler, executed from the main loop
+ **********************************************************************/
+typedef struct{
+    uint32_t secs, ticks;
+    uint32_t num_ops;
+    usrp2_ctrl_op_t ops[USRP2_CTRL_MAX_OPS];
+} timed_batch_t;
+
+static timed_batch_t timed_batches[USRP2_CTRL_MAX_TIMED_BATCHES];
+static size_t timed_batches_head = 0, timed_batches_count = 0;
+
+//has the vita time reached secs and ticks?
+static bool time_reached(uint32_t secs, uint32_t ticks){
+    uint32_t now_secs, now_ticks;
+    do{ //reread when the seconds rolled over between the two reads
+        now_secs = router_status->time64_secs_rb;
+        now_ticks = router_status->time64_ticks_rb;
+    } while(now_secs != router_status->time64_secs_rb);
+    return (now_secs > secs) || (now_secs == secs && now_ticks >= ticks);
+}
+
+//execute the queued batches in order once their time is reached
+static void poll_timed_batches(void){
+    while (timed_batches_count > 0){
+        timed_batch_t *batch = &timed_batches[timed_batches_head];
+        if (!time_reached(batch->secs, batch->ticks)) return;
+        for (size_t i = 0; i < batch->num_ops; i++){
+            do_ctrl_op(&batch->ops[i]);
+        }
+        timed_batches_head = (timed_batches_head + 1) % USRP2_CTRL_MAX_TIMED_BATCHES;
+        timed_batches_count--;
+    }
+}
+
+/***********************************************************************
+ * Queued i2c: run on the async i2c engine from the main loop,
+ * the host polls each ticket until its transaction is done
+ **********************************************************************/
+typedef enum{
+    QUEUED_I2C_FREE,
+    QUEUED_I2C_WAITING,
+    QUEUED_I2C_ACTIVE,
+    QUEUED_I2C_DONE
+} queued_i2c_state_t;
+
+typedef struct{
+    uint32_t ticket;
+    uint8_t state; //queued_i2c_state_t
+    uint8_t status; //usrp2_i2c_status_t
+    uint8_t addr, bytes, flags;
+    uint8_t data[USRP2_CTRL_MAX_QUEUED_I2C_BYTES];
+} queued_i2c_t;
+
+static queued_i2c_t queued_i2cs[USRP2_CTRL_MAX_QUEUED_I2C];
+static queued_i2c_t *queued_i2c_active = NULL;
+static uint32_t queued_i2c_next_ticket = 1;
+static volatile bool queued_i2c_complete = false;
+
+static void queued_i2c_callback(void){
+    queued_i2c_complete = true;
+}
+
+static queued_i2c_t *queued_i2c_find(uint32_t ticket){
+    for (size_t i = 0; i < USRP2_CTRL_MAX_QUEUED_I2C; i++){
+        if (queued_i2cs[i].state != QUEUED_I2C_FREE && queued_i2cs[i].ticket == ticket) return &queued_i2cs[i];
+    }
+    return NULL;
+}
+
+//is a transaction running or waiting to run?
+static bool queued_i2c_busy(void){
+    for (size_t i = 0; i < USRP2_CTRL_MAX_QUEUED_I2C; i++){
+        if (queued_i2cs[i].state == QUEUED_I2C_WAITING || queued_i2cs[i].state == QUEUED_I2C_ACTIVE) return true;
+    }
+    return false;
+}
+
+static void queued_i2c_finish(queued_i2c_t *x, uint8_t status){
+    x->status = status;
+    x->state = QUEUED_I2C_DONE;
+    if (status == USRP2_I2C_STATUS_ERROR) printf("!Error in queued i2c: transaction to 0x%x failed\n", x->addr);
+}
+
+//retire the active transaction once done, then start the oldest waiting one
+static void poll_queued_i2c(void){
+    if (queued_i2c_active != NULL){
+        queued_i2c_t *x = queued_i2c_active;
+        if (queued_i2c_complete){
+            if (x->flags & USRP2_I2C_FLAG_READ) i2c_async_data_ready(x->data);
+            queued_i2c_finish(x, USRP2_I2C_STATUS_DONE);
+        }
+        else if (i2c_async_idle()){ //the engine dropped the transaction
+            queued_i2c_finish(x, USRP2_I2C_STATUS_ERROR);
+        }
+        else return;
+        queued_i2c_active = NULL;
+    }
+
+    queued_i2c_t *next = NULL;
+    for (size_t i = 0; i < USRP2_CTRL_MAX_QUEUED_I2C; i++){
+        if (queued_i2cs[i].state != QUEUED_I2C_WAITING) continue;
+        if (next == NULL || (int32_t)(queued_i2cs[i].ticket - next->ticket) < 0) next = &queued_i2cs[i];
+    }
+    if (next == NULL) return;
+
+    queued_i2c_complete = false;
+    bool started = (next->flags & USRP2_I2C_FLAG_READ)?
+        i2c_async_read(next->addr, next->bytes) :
+        i2c_async_write(next->addr, next->data, next->bytes);
+    if (!started){
+        queued_i2c_finish(next, USRP2_I2C_STATUS_ERROR);
+        return;
+    }
+    next->state = QUEUED_I2C_ACTIVE;
+    queued_i2c_active = next;
+}
+
+//run the queued transactions to completion (before a synchronous one)
+static void drain_queued_i2c(void){
+    while (queued_i2c_busy()){
+        pic_interrupt_handler();
+        poll_queued_i2c();
+    }
+}
+
+//queue a transaction, return its ticket or 0 when no slot is free
+static uint32_t queue_i2c(uint8_t addr, uint8_t bytes, uint8_t flags, const uint8_t *data){
+    if (bytes == 0 || bytes > USRP2_CTRL_MAX_QUEUED_I2C_BYTES) return 0;
+    for (size_t i = 0; i < USRP2_CTRL_MAX_QUEUED_I2C; i++){
+        queued_i2c_t *x = &queued_i2cs[i];
+        if (x->state != QUEUED_I2C_FREE) continue;
+        if (queued_i2c_next_ticket == 0) queued_i2c_next_ticket++; //0 is never a ticket
+        x->ticket = queued_i2c_next_ticket++;
+        x->state = QUEUED_I2C_WAITING;
+        x->status = USRP2_I2C_STATUS_PENDING;
+        x->addr = addr;
+        x->bytes = bytes;
+        x->flags = flags;
+        if (!(flags & USRP2_I2C_FLAG_READ)) memcpy(x->data, data, bytes);
+        poll_queued_i2c(); //start it now when the engine is free
+        return x->ticket;
+    }
+    return 0;
+}
 
 static void handle_udp_ctrl_packet(
     struct socket_address src, struct socket_address dst,
@@ -146,13 +385,13 @@ static void handle_udp_ctrl_packet(
      ******************************************************************/
     case USRP2_CTRL_ID_TRANSACT_ME_SOME_SPI_BRO:{
             //transact
-            uint32_t result = spi_transact(
-                (ctrl_data_in->data.spi_args.readback == 0)? SPI_TXONLY : SPI_TXRX,
-                ctrl_data_in->data.spi_args.dev,      //which device
-                ctrl_data_in->data.spi_args.data,     //32 bit data
-                ctrl_data_in->data.spi_args.num_bits, //length in bits
-                (ctrl_data_in->data.spi_args.mosi_edge == USRP2_CLK_EDGE_RISE)? SPIF_PUSH_FALL : SPIF_PUSH_RISE |
-                (ctrl_data_in->data.spi_args.miso_edge == USRP2_CLK_EDGE_RISE)? SPIF_LATCH_RISE : SPIF_LATCH_FALL
+            uint32_t result = do_spi_transact(
+                ctrl_data_in->data.spi_args.readback,
+                ctrl_data_in->data.spi_args.dev,
+                ctrl_data_in->data.spi_args.data,
+                ctrl_data_in->data.spi_args.num_bits,
+                ctrl_data_in->data.spi_args.mosi_edge,
+                ctrl_data_in->data.spi_args.miso_edge
             );
 
             //load output
@@ -166,6 +405,7 @@ static void handle_udp_ctrl_packet(
      ******************************************************************/
     case USRP2_CTRL_ID_DO_AN_I2C_READ_FOR_ME_BRO:{
             uint8_t num_bytes = ctrl_data_in->data.i2c_args.bytes;
+            drain_queued_i2c();
             i2c_read(
                 ctrl_data_in->data.i2c_args.addr,
                 ctrl_data_out.data.i2c_args.data,
@@ -178,6 +418,7 @@ static void handle_udp_ctrl_packet(
 
     case USRP2_CTRL_ID_WRITE_THESE_I2C_VALUES_BRO:{
             uint8_t num_bytes = ctrl_data_in->data.i2c_args.bytes;
+            drain_queued_i2c();
             i2c_write(
                 ctrl_data_in->data.i2c_args.addr,
                 ctrl_data_in->data.i2c_args.data,
@@ -188,37 +429,115 @@ static void handle_udp_ctrl_packet(
         }
         break;
 
+    case USRP2_CTRL_ID_QUEUE_THIS_I2C_BRO:
+        ctrl_data_out.data.queued_i2c_args = ctrl_data_in->data.queued_i2c_args;
+        ctrl_data_out.data.queued_i2c_args.ticket = queue_i2c(
+            ctrl_data_in->data.queued_i2c_args.addr,
+            ctrl_data_in->data.queued_i2c_args.bytes,
+            ctrl_data_in->data.queued_i2c_args.flags,
+            ctrl_data_in->data.queued_i2c_args.data
+        );
+        ctrl_data_out.id = USRP2_CTRL_ID_I2C_IS_QUEUED_DUDE;
+        break;
+
+    case USRP2_CTRL_ID_HOWS_MY_I2C_BRO:{
+            ctrl_data_out.data.queued_i2c_args = ctrl_data_in->data.queued_i2c_args;
+            ctrl_data_out.data.queued_i2c_args.status = USRP2_I2C_STATUS_UNKNOWN;
+            queued_i2c_t *x = queued_i2c_find(ctrl_data_in->data.queued_i2c_args.ticket);
+            if (x != NULL) ctrl_data_out.data.queued_i2c_args.status = x->status;
+            if (x != NULL && x->state == QUEUED_I2C_DONE){
+                memcpy(ctrl_data_out.data.queued_i2c_args.data, x->data, x->bytes);
+                ctrl_data_out.data.queued_i2c_args.bytes = x->bytes;
+                x->state = QUEUED_I2C_FREE;
+            }
+            ctrl_data_out.id = USRP2_CTRL_ID_HERES_YOUR_I2C_DUDE;
+        }
+        break;
+
     /*******************************************************************
      * Peek and Poke Register
      ******************************************************************/
     case USRP2_CTRL_ID_GET_THIS_REGISTER_FOR_ME_BRO:
-        switch(ctrl_data_in->data.reg_args.action){
-            case USRP2_REG_ACTION_FPGA_PEEK32:
-                ctrl_data_out.data.reg_args.data = *((uint32_t *) ctrl_data_in->data.reg_args.addr);
-                break;
-
-            case USRP2_REG_ACTION_FPGA_PEEK16:
-                ctrl_data_out.data.reg_args.data = *((uint16_t *) ctrl_data_in->data.reg_args.addr);
-                break;
-
-            case USRP2_REG_ACTION_FPGA_POKE32:
-                *((uint32_t *) ctrl_data_in->data.reg_args.addr) = (uint32_t)ctrl_data_in->data.reg_args.data;
-                break;
-
-            case USRP2_REG_ACTION_FPGA_POKE16:
-                *((uint16_t *) ctrl_data_in->data.reg_args.addr) = (uint16_t)ctrl_data_in->data.reg_args.data;
-                break;
+        ctrl_data_out.data.reg_args.data = do_reg_action(
+            ctrl_data_in->data.reg_args.action,
+            ctrl_data_in->data.reg_args.addr,
+            ctrl_data_in->data.reg_args.data
+        );
+        ctrl_data_out.id = USRP2_CTRL_ID_OMG_GOT_REGISTER_SO_BAD_DUDE;
+        break;
 
-            case USRP2_REG_ACTION_FW_PEEK32:
-                ctrl_data_out.data.reg_args.data = fw_regs[(ctrl_data_in->data.reg_args.addr)];
+    /*******************************************************************
+     * Multiple operations in one packet
+     ******************************************************************/
+    case USRP2_CTRL_ID_DO_ALL_THESE_OPS_BRO:{
+            const usrp2_ctrl_ops_data_t *ops_data_in = (usrp2_ctrl_ops_data_t *)payload;
+            uint32_t num_ops = ctrl_data_in->data.ops_args.num_ops;
+            size_t ops_len = sizeof(usrp2_ctrl_data_t) + num_ops*sizeof(usrp2_ctrl_op_t);
+            if (num_ops > USRP2_CTRL_MAX_OPS || payload_len < ops_len){
+                printf("!Error in control packet handler: Bad ops packet with %d ops\n", (int)num_ops);
                 break;
+            }
+
+            //execute the ops in order, the reply carries all readbacks
+            static usrp2_ctrl_ops_data_t ops_data_out;
+            for (size_t i = 0; i < num_ops; i++){
+                ops_data_out.ops[i] = ops_data_in->ops[i];
+                ops_data_out.ops[i].data = do_ctrl_op(&ops_data_in->ops[i]);
+            }
+
+            ops_data_out.ctrl = ctrl_data_out;
+            ops_data_out.ctrl.id = USRP2_CTRL_ID_DID_ALL_THOSE_OPS_DUDE;
+            ops_data_out.ctrl.data.ops_args.num_ops = num_ops;
+            send_udp_pkt(USRP2_UDP_CTRL_PORT, src, &ops_data_out, ops_len);
+        }
+        return;
 
-            case USRP2_REG_ACTION_FW_POKE32:
-                fw_regs[(ctrl_data_in->data.reg_args.addr)] = ctrl_data_in->data.reg_args.data;
+    case USRP2_CTRL_ID_DO_THESE_OPS_LATER_BRO:{
+            const usrp2_ctrl_ops_data_t *ops_data_in = (usrp2_ctrl_ops_data_t *)payload;
+            uint32_t num_ops = ctrl_data_in->data.ops_args.num_ops;
+            size_t ops_len = sizeof(usrp2_ctrl_data_t) + num_ops*sizeof(usrp2_ctrl_op_t);
+            if (num_ops > USRP2_CTRL_MAX_OPS || payload_len < ops_len){
+                printf("!Error in control packet handler: Bad timed ops packet with %d ops\n", (int)num_ops);
                 break;
+            }
+
+            //queue the ops, reply with zero ops when the queue is full
+            ctrl_data_out.id = USRP2_CTRL_ID_OPS_ARE_QUEUED_UP_DUDE;
+            ctrl_data_out.data.ops_args.num_ops = 0;
+            if (timed_batches_count == USRP2_CTRL_MAX_TIMED_BATCHES) break;
+            timed_batch_t *batch = &timed_batches[
+                (timed_batches_head + timed_batches_count) % USRP2_CTRL_MAX_TIMED_BATCHES
+            ];
+            batch->secs = ctrl_data_in->data.ops_args.time_secs;
+            batch->ticks = ctrl_data_in->data.ops_args.time_ticks;
+            batch->num_ops = num_ops;
+            for (size_t i = 0; i < num_ops; i++){
+                batch->ops[i] = ops_data_in->ops[i];
+            }
+            timed_batches_count++;
+            ctrl_data_out.data.ops_args.num_ops = num_ops;
+        }
+        break;
 
+    /*******************************************************************
+     * Data framers
+     ******************************************************************/
+    case USRP2_CTRL_ID_SET_UP_THESE_FRAMERS_BRO:{
+            uint32_t num_framers = ctrl_data_in->data.framer_args.num_framers;
+            if (num_framers > USRP2_CTRL_MAX_FRAMERS) num_framers = 0;
+
+            //the framers stream to the host that sent this packet
+            ctrl_data_out.data.framer_args = ctrl_data_in->data.framer_args;
+            ctrl_data_out.data.framer_args.num_framers = 0;
+            struct socket_address host = src;
+            for (size_t i = 0; i < num_framers; i++){
+                host.port = ctrl_data_in->data.framer_args.framers[i].host_port;
+                if (program_framer(host, ctrl_data_in->data.framer_args.framers[i].dsp_port)){
+                    ctrl_data_out.data.framer_args.num_framers++;
+                }
+            }
+            ctrl_data_out.id = USRP2_CTRL_ID_FRAMERS_ARE_SET_UP_DUDE;
         }
-        ctrl_data_out.id = USRP2_CTRL_ID_OMG_GOT_REGISTER_SO_BAD_DUDE;
         break;
 
     /*******************************************************************
@@ -304,7 +623,7 @@ main(void)
 
   //1) register the addresses into the network stack
   register_addrs(ethernet_mac_addr(), get_ip_addr());
-  pkt_ctrl_program_inspector(get_ip_addr(), USRP2_UDP_TX_DSP0_PORT);
+  pkt_ctrl_program_inspector(get_ip_addr(), USRP2_UDP_TX_DSP0_PORT, USRP2_UDP_TX_DSP1_PORT);
 
   //2) register callbacks for udp ports we service
   init_udp_listeners();
@@ -312,6 +631,7 @@ main(void)
   register_udp_listener(USRP2_UDP_RX_DSP0_PORT, handle_udp_data_packet);
   register_udp_listener(USRP2_UDP_RX_DSP1_PORT, handle_udp_data_packet);
   register_udp_listener(USRP2_UDP_TX_DSP0_PORT, handle_udp_data_packet);
+  register_udp_listener(USRP2_UDP_TX_DSP1_PORT, handle_udp_data_packet);
   
 #ifdef USRP2P
   register_udp_listener(USRP2_UDP_UPDATE_PORT, handle_udp_fw_update_packet);
@@ -319,6 +639,10 @@ main(void)
 
   udp_uart_init(USRP2_UDP_UART_BASE_PORT); //setup uart messaging
 
+  //queued i2c runs on the interrupt driven engine
+  i2c_register_handler();
+  i2c_register_callback(queued_i2c_callback);
+
   //3) set the routing mode to slave to set defaults
   pkt_ctrl_set_routing_mode(PKT_CTRL_ROUTING_MODE_SLAVE);
 
@@ -337,6 +661,10 @@ main(void)
 
     udp_uart_poll(); //uart message handling
 
+    poll_timed_batches(); //timed control ops
+
+    poll_queued_i2c(); //queued i2c transactions
+
     pic_interrupt_handler();
     /*
     int pending = pic_regs->pending;		// poll for under or overrun
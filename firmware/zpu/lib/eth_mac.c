@@ -50,7 +50,11 @@ eth_mac_init(const eth_mac_addr_t *src)
   eth_mac->settings = MAC_SET_PAUSE_EN | MAC_SET_PASS_BCAST | MAC_SET_PASS_UCAST | MAC_SET_PAUSE_SEND_EN | MAC_SET_PASS_ALL;
 
   eth_mac->pause_time = 38;
+#ifdef USRP2P
+  eth_mac->pause_thresh = 2400;	// the rx fifo holds 4096 lines, leave room for a jumbo frame
+#else
   eth_mac->pause_thresh = 1200;
+#endif
 
   // set rx flow control high and low water marks
   // unsigned int lwmark = (2*2048 + 64)/4; // 2 * 2048-byte frames + 1 * 64-byte pause frame
@@ -204,3 +204,6 @@ bool i2c_async_data_ready(void *buf) {
   return false;
 }
 
+bool i2c_async_idle(void) {
+  return i2c_state == I2C_STATE_IDLE;
+}
@@ -37,6 +37,7 @@ typedef enum { I2C_DIR_WRITE=0, I2C_DIR_READ=1 } i2c_dir_t;
 bool i2c_async_read(uint8_t addr, unsigned int len);
 bool i2c_async_write(uint8_t addr, const uint8_t *buf, unsigned int len);
 bool i2c_async_data_ready(void *);
+bool i2c_async_idle(void); //true when no transfer is in progress or waiting to be read out
 //static void i2c_irq_handler(unsigned irq);
 void i2c_register_callback(void (*callback)(void));
 void i2c_register_handler(void);
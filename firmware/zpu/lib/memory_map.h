@@ -217,6 +217,8 @@ typedef struct {
 #define SR_TX_FRONT 128   // ?
 #define SR_TX_CTRL  144   // 6
 #define SR_TX_DSP   160   // 5
+#define SR_TX_CTRL1 176   // 6
+#define SR_TX_DSP1  184   // 5
 
 #define SR_UDP_SM   192   // 64
 
@@ -294,6 +296,7 @@ typedef struct {
 } sr_tx_ctrl_t;
 
 #define sr_tx_ctrl ((sr_tx_ctrl_t *) _SR_ADDR(SR_TX_CTRL))
+#define sr_tx_ctrl1 ((sr_tx_ctrl_t *) _SR_ADDR(SR_TX_CTRL1))
 
 // --- VITA RX CTRL regs ---
 typedef struct {
@@ -48,6 +48,9 @@ typedef enum {
   USRP2_FW_UPDATE_ID_I_CAN_HAS_HW_REV_LOL = 'v',
   USRP2_FW_UPDATE_ID_HERES_TEH_HW_REV_OMG = 'V',
 
+  USRP2_FW_UPDATE_ID_HASH_TEH_FLASHES_LOL = 'h',
+  USRP2_FW_UPDATE_ID_HERES_TEH_HASH_OMG = 'H',
+
   USRP2_FW_UPDATE_ID_KTHXBAI = '~'
 
 } usrp2_fw_update_id_t;
@@ -68,8 +71,19 @@ typedef struct {
       uint32_t sector_size_bytes;
       uint32_t memory_size_bytes;
     } flash_info_args;
+    struct {
+      uint32_t flash_addr;
+      uint32_t length;
+      uint32_t crc; //crc32 of the range, in the reply
+    } flash_hash_args;
   } data;
 } usrp2_fw_update_data_t;
 
+/*
+ * Every reply carries the seq of its request,
+ * and flash write and read replies carry the flash address and length,
+ * so the host can keep several requests in flight.
+ */
+
 void handle_udp_fw_update_packet(struct socket_address src, struct socket_address dst,
                                  unsigned char *payload, int payload_len);
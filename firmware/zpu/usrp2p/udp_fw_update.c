@@ -37,6 +37,28 @@ uint16_t get_hw_rev(void) {
 
 spi_flash_async_state_t spi_flash_async_state;
 
+//crc32 (as in zlib) of a flash range, a nibble table keeps the image small
+static uint32_t spi_flash_crc32(uint32_t flash_addr, uint32_t length){
+  static const uint32_t crc_table[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+  };
+  uint8_t buff[256];
+  uint32_t crc = 0xffffffff;
+  while (length > 0){
+    uint32_t n = (length < sizeof(buff))? length : sizeof(buff);
+    spi_flash_read(flash_addr, n, buff);
+    for (uint32_t i = 0; i < n; i++){
+      crc ^= buff[i];
+      crc = (crc >> 4) ^ crc_table[crc & 0xf];
+      crc = (crc >> 4) ^ crc_table[crc & 0xf];
+    }
+    flash_addr += n;
+    length -= n;
+  }
+  return crc ^ 0xffffffff;
+}
+
 //Firmware update packet handler
 void handle_udp_fw_update_packet(struct socket_address src, struct socket_address dst,
                                  unsigned char *payload, int payload_len) {
@@ -45,6 +67,8 @@ void handle_udp_fw_update_packet(struct socket_address src, struct socket_addres
 
   usrp2_fw_update_data_t update_data_out;
   usrp2_fw_update_id_t update_data_in_id = update_data_in->id;
+  update_data_out.proto_ver = update_data_in->proto_ver;
+  update_data_out.seq = update_data_in->seq; //so the host can match replies in flight
 
   //ensure that the protocol versions match
 /*  if (payload_len >= sizeof(uint32_t) && update_data_in->proto_ver != USRP2_FW_COMPAT_NUM){
@@ -74,6 +98,7 @@ void handle_udp_fw_update_packet(struct socket_address src, struct socket_addres
     sr_rx_ctrl1->time_secs = 0;
     sr_rx_ctrl1->time_ticks = 0; //latch the command
     sr_tx_ctrl->cyc_per_up = 0;
+    sr_tx_ctrl1->cyc_per_up = 0;
     break;
 
   case USRP2_FW_UPDATE_ID_WATS_TEH_FLASH_INFO_LOL: //query sector size, memory size so the host can mind the boundaries
@@ -103,14 +128,27 @@ void handle_udp_fw_update_packet(struct socket_address src, struct socket_addres
     //spi_flash_program() goes pretty quick compared to page erases, so we don't bother polling -- it'll come back in some milliseconds
     //if it doesn't come back fast enough, we'll just write smaller packets at a time until it does
     spi_flash_program(update_data_in->data.flash_args.flash_addr, update_data_in->data.flash_args.length, update_data_in->data.flash_args.data);
+    update_data_out.data.flash_args.flash_addr = update_data_in->data.flash_args.flash_addr;
+    update_data_out.data.flash_args.length = update_data_in->data.flash_args.length;
     update_data_out.id = USRP2_FW_UPDATE_ID_WROTE_TEH_FLASHES_OMG;
     break;
 
   case USRP2_FW_UPDATE_ID_READ_TEH_FLASHES_LOL: //for verify
     spi_flash_read(update_data_in->data.flash_args.flash_addr,  update_data_in->data.flash_args.length, update_data_out.data.flash_args.data);
+    update_data_out.data.flash_args.flash_addr = update_data_in->data.flash_args.flash_addr;
+    update_data_out.data.flash_args.length = update_data_in->data.flash_args.length;
     update_data_out.id = USRP2_FW_UPDATE_ID_KK_READ_TEH_FLASHES_OMG;
     break;
 
+  case USRP2_FW_UPDATE_ID_HASH_TEH_FLASHES_LOL: //verify without reading it all back
+    update_data_out.data.flash_hash_args.flash_addr = update_data_in->data.flash_hash_args.flash_addr;
+    update_data_out.data.flash_hash_args.length = update_data_in->data.flash_hash_args.length;
+    update_data_out.data.flash_hash_args.crc = spi_flash_crc32(
+      update_data_in->data.flash_hash_args.flash_addr, update_data_in->data.flash_hash_args.length
+    );
+    update_data_out.id = USRP2_FW_UPDATE_ID_HERES_TEH_HASH_OMG;
+    break;
+
   case USRP2_FW_UPDATE_ID_RESET_MAH_COMPUTORZ_LOL: //for if we ever get the ICAP working
     //should reset via icap_reload_fpga(uint32_t flash_address);
     update_data_out.id = USRP2_FW_UPDATE_ID_RESETTIN_TEH_COMPUTORZ_OMG;
@@ -6,14 +6,15 @@
 // The packet dispatcher expects 2-byte padded ethernet frames.
 // The frames will be inspected at ethernet, IPv4, UDP, and VRT layers.
 // Packets are dispatched into the following streams:
-//   * tx dsp stream
+//   * tx dsp0 stream
+//   * tx dsp1 stream
 //   * to cpu stream
 //   * to external stream
 //   * to both cpu and external
 //
 // The following registers are used for dispatcher control:
 //   * base + 0 = this ipv4 address (32 bits)
-//   * base + 1 = udp dst port (lower 16 bits)
+//   * base + 1 = udp dst ports (dsp0 lower 16 bits, dsp1 upper 16 bits)
 //
 
 module packet_dispatcher36_x3
@@ -32,7 +33,8 @@ module packet_dispatcher36_x3
 
         //output stream interfaces:
         output [35:0] ext_out_data, output ext_out_valid, input ext_out_ready,
-        output [35:0] dsp_out_data, output dsp_out_valid, input dsp_out_ready,
+        output [35:0] dsp0_out_data, output dsp0_out_valid, input dsp0_out_ready,
+        output [35:0] dsp1_out_data, output dsp1_out_valid, input dsp1_out_ready,
         output [35:0] cpu_out_data, output cpu_out_valid, input cpu_out_ready
     );
 
@@ -44,35 +46,40 @@ module packet_dispatcher36_x3
         .out(my_ip_addr),.changed()
     );
 
-    //setting register to program the UDP DSP port
-    wire [15:0] dsp_udp_port;
-    setting_reg #(.my_addr(BASE+1), .width(16)) sreg_data_port(
+    //setting register to program the UDP DSP ports
+    wire [15:0] dsp0_udp_port, dsp1_udp_port;
+    setting_reg #(.my_addr(BASE+1)) sreg_data_port(
         .clk(clk),.rst(rst),
         .strobe(set_stb),.addr(set_addr),.in(set_data),
-        .out(dsp_udp_port),.changed()
+        .out({dsp1_udp_port, dsp0_udp_port}),.changed()
     );
 
     ////////////////////////////////////////////////////////////////////
     // Communication input inspector
-    //   - inspect com input and send it to DSP, EXT, CPU, or BOTH
+    //   - inspect com input and send it to DSP0, DSP1, EXT, CPU, or BOTH
     ////////////////////////////////////////////////////////////////////
     localparam PD_STATE_READ_COM_PRE = 0;
     localparam PD_STATE_READ_COM = 1;
     localparam PD_STATE_WRITE_REGS = 2;
     localparam PD_STATE_WRITE_LIVE = 3;
 
-    localparam PD_DEST_DSP = 0;
+    localparam PD_DEST_DSP0 = 0;
     localparam PD_DEST_EXT = 1;
     localparam PD_DEST_CPU = 2;
     localparam PD_DEST_BOF = 3;
+    localparam PD_DEST_DSP1 = 4;
 
     localparam PD_MAX_NUM_DREGS = 13; //padded_eth + ip + udp + seq + vrt_hdr
     localparam PD_DREGS_DSP_OFFSET = 11; //offset to start dsp at
 
     //output inspector interfaces
-    wire [35:0] pd_out_dsp_data;
-    wire        pd_out_dsp_valid;
-    wire        pd_out_dsp_ready;
+    wire [35:0] pd_out_dsp0_data;
+    wire        pd_out_dsp0_valid;
+    wire        pd_out_dsp0_ready;
+
+    wire [35:0] pd_out_dsp1_data;
+    wire        pd_out_dsp1_valid;
+    wire        pd_out_dsp1_ready;
 
     wire [35:0] pd_out_ext_data;
     wire        pd_out_ext_valid;
@@ -87,7 +94,7 @@ module packet_dispatcher36_x3
     wire        pd_out_bof_ready;
 
     reg [1:0] pd_state;
-    reg [1:0] pd_dest;
+    reg [2:0] pd_dest;
     reg [3:0] pd_dreg_count; //data registers to buffer headers
     wire [3:0] pd_dreg_count_next = pd_dreg_count + 1'b1;
     wire pd_dreg_counter_done = (pd_dreg_count_next == PD_MAX_NUM_DREGS)? 1'b1 : 1'b0;
@@ -97,14 +104,15 @@ module packet_dispatcher36_x3
     reg is_eth_type_ipv4;
     reg is_eth_ipv4_proto_udp;
     reg is_eth_ipv4_dst_addr_here;
-    reg is_eth_udp_dst_port_here;
+    reg is_eth_udp_dst_port_dsp0;
+    reg is_eth_udp_dst_port_dsp1;
     wire is_vrt_size_zero = (com_inp_data[15:0] == 16'h0); //needed on the same cycle, so it cant be registered
 
     //Inspector output flags special case:
     //Inject SOF into flags at first DSP line.
     wire [3:0] pd_out_flags = (
         (pd_dreg_count == PD_DREGS_DSP_OFFSET) &&
-        (pd_dest == PD_DEST_DSP)
+        (pd_dest == PD_DEST_DSP0 || pd_dest == PD_DEST_DSP1)
     )? 4'b0001 : pd_dregs[pd_dreg_count][35:32];
 
     //The communication inspector ouput data and valid signals:
@@ -120,21 +128,24 @@ module packet_dispatcher36_x3
     //The communication inspector ouput ready signal:
     //Mux between the various destination ready signals.
     wire pd_out_ready =
-        (pd_dest == PD_DEST_DSP)? pd_out_dsp_ready : (
+        (pd_dest == PD_DEST_DSP0)? pd_out_dsp0_ready : (
+        (pd_dest == PD_DEST_DSP1)? pd_out_dsp1_ready : (
         (pd_dest == PD_DEST_EXT)? pd_out_ext_ready : (
         (pd_dest == PD_DEST_CPU)? pd_out_cpu_ready : (
         (pd_dest == PD_DEST_BOF)? pd_out_bof_ready : (
-    1'b0))));
+    1'b0)))));
 
     //Always connected output data lines.
-    assign pd_out_dsp_data = pd_out_data;
+    assign pd_out_dsp0_data = pd_out_data;
+    assign pd_out_dsp1_data = pd_out_data;
     assign pd_out_ext_data = pd_out_data;
     assign pd_out_cpu_data = pd_out_data;
     assign pd_out_bof_data = pd_out_data;
 
     //Destination output valid signals:
     //Comes from inspector valid when destination is selected, and otherwise low.
-    assign pd_out_dsp_valid = (pd_dest == PD_DEST_DSP)? pd_out_valid : 1'b0;
+    assign pd_out_dsp0_valid = (pd_dest == PD_DEST_DSP0)? pd_out_valid : 1'b0;
+    assign pd_out_dsp1_valid = (pd_dest == PD_DEST_DSP1)? pd_out_valid : 1'b0;
     assign pd_out_ext_valid = (pd_dest == PD_DEST_EXT)? pd_out_valid : 1'b0;
     assign pd_out_cpu_valid = (pd_dest == PD_DEST_CPU)? pd_out_valid : 1'b0;
     assign pd_out_bof_valid = (pd_dest == PD_DEST_BOF)? pd_out_valid : 1'b0;
@@ -169,7 +180,8 @@ module packet_dispatcher36_x3
             is_eth_ipv4_dst_addr_here <= (com_inp_data[31:0] == my_ip_addr);
         end
         9: begin
-            is_eth_udp_dst_port_here <= (com_inp_data[15:0] == dsp_udp_port);
+            is_eth_udp_dst_port_dsp0 <= (com_inp_data[15:0] == dsp0_udp_port);
+            is_eth_udp_dst_port_dsp1 <= (com_inp_data[15:0] == dsp1_udp_port);
         end
         endcase //pd_dreg_count
     end
@@ -211,8 +223,14 @@ module packet_dispatcher36_x3
                     end
 
                     //UDP data port and VRT:
-                    else if (is_eth_udp_dst_port_here && ~is_vrt_size_zero) begin
-                        pd_dest <= PD_DEST_DSP;
+                    else if (is_eth_udp_dst_port_dsp0 && ~is_vrt_size_zero) begin
+                        pd_dest <= PD_DEST_DSP0;
+                        pd_dreg_count <= PD_DREGS_DSP_OFFSET;
+                    end
+
+                    //UDP data port and VRT (a zero port is never used):
+                    else if (is_eth_udp_dst_port_dsp1 && (dsp1_udp_port != 16'h0) && ~is_vrt_size_zero) begin
+                        pd_dest <= PD_DEST_DSP1;
                         pd_dreg_count <= PD_DREGS_DSP_OFFSET;
                     end
 
@@ -254,10 +272,14 @@ module packet_dispatcher36_x3
         endcase //pd_state
     end
 
-    //connect this fast-path signals directly to the DSP out
-    assign dsp_out_data = pd_out_dsp_data;
-    assign dsp_out_valid = pd_out_dsp_valid;
-    assign pd_out_dsp_ready = dsp_out_ready;
+    //connect this fast-path signals directly to the DSP outs
+    assign dsp0_out_data = pd_out_dsp0_data;
+    assign dsp0_out_valid = pd_out_dsp0_valid;
+    assign pd_out_dsp0_ready = dsp0_out_ready;
+
+    assign dsp1_out_data = pd_out_dsp1_data;
+    assign dsp1_out_valid = pd_out_dsp1_valid;
+    assign pd_out_dsp1_ready = dsp1_out_ready;
 
     ////////////////////////////////////////////////////////////////////
     // Splitter and output muxes for the bof packets
@@ -57,7 +57,8 @@ module packet_router
 
         // Output Interfaces (out of router)
         output [35:0] ser_out_data, output ser_out_valid, input ser_out_ready,
-        output [35:0] dsp_out_data, output dsp_out_valid, input dsp_out_ready,
+        output [35:0] dsp0_out_data, output dsp0_out_valid, input dsp0_out_ready,
+        output [35:0] dsp1_out_data, output dsp1_out_valid, input dsp1_out_ready,
         output [35:0] eth_out_data, output eth_out_valid, input eth_out_ready
     );
 
@@ -253,7 +254,8 @@ module packet_router
         .set_stb(set_stb), .set_addr(set_addr), .set_data(set_data),
         .com_inp_data(com_inp_data), .com_inp_valid(com_inp_valid), .com_inp_ready(com_inp_ready),
         .ext_out_data(ext_out_data), .ext_out_valid(ext_out_valid), .ext_out_ready(ext_out_ready),
-        .dsp_out_data(dsp_out_data), .dsp_out_valid(dsp_out_valid), .dsp_out_ready(dsp_out_ready),
+        .dsp0_out_data(dsp0_out_data), .dsp0_out_valid(dsp0_out_valid), .dsp0_out_ready(dsp0_out_ready),
+        .dsp1_out_data(dsp1_out_data), .dsp1_out_valid(dsp1_out_valid), .dsp1_out_ready(dsp1_out_ready),
         .cpu_out_data(_cpu_out_data), .cpu_out_valid(_cpu_out_valid), .cpu_out_ready(_cpu_out_ready)
     );
 
@@ -297,8 +299,9 @@ module packet_router
         eth_inp_ready, eth_inp_valid,
         cpu_inp_ready, cpu_inp_valid,
 
-        //outputs from the router (8)
-        dsp_out_ready, dsp_out_valid,
+        //outputs from the router (10)
+        dsp0_out_ready, dsp0_out_valid,
+        dsp1_out_ready, dsp1_out_valid,
         ser_out_ready, ser_out_valid,
         eth_out_ready, eth_out_valid,
         cpu_out_ready, cpu_out_valid,
@@ -309,7 +312,7 @@ module packet_router
         ext_out_ready, ext_out_valid,
         com_inp_ready, com_inp_valid,
 
-        4'b0
+        2'b0
     };
 
 endmodule // packet_router
@@ -17,7 +17,8 @@
 
 
 module dsp_core_rx
-  #(parameter BASE = 160)
+  #(parameter BASE = 160,
+    parameter SC12_LITTLE_ENDIAN = 0) // byte order of the packed sc12 lines on the host link
   (input clk, input rst,
    input set_stb, input [7:0] set_addr, input [31:0] set_data,
 
@@ -46,6 +47,7 @@ module dsp_core_rx
    reg [23:0]  adc_i_mux, adc_q_mux;
    wire        realmode;
    wire        swap_iq;
+   wire        format_sc8, format_sc12;
    
    setting_reg #(.my_addr(BASE+0)) sr_0
      (.clk(clk),.rst(rst),.strobe(set_stb),.addr(set_addr),
@@ -65,6 +67,10 @@ module dsp_core_rx
      (.clk(clk),.rst(rst),.strobe(set_stb),.addr(set_addr),
       .in(set_data),.out({realmode,swap_iq}),.changed());
 
+   setting_reg #(.my_addr(BASE+4), .width(2)) sr_4
+     (.clk(clk),.rst(rst),.strobe(set_stb),.addr(set_addr),
+      .in(set_data),.out({format_sc12,format_sc8}),.changed());
+
    // MUX so we can do realmode signals on either input
    
    always @(posedge clk)
@@ -131,11 +137,64 @@ module dsp_core_rx
       .stb_in(strobe_hb1),.data_in(q_hb1),.stb_out(),.data_out(q_hb2));
 
    // Round final answer to 16 bits
+   wire [31:0] sample_sc16;
+   wire        strobe_sc16;
    round_sd #(.WIDTH_IN(24),.WIDTH_OUT(16)) round_i
-     (.clk(clk),.reset(rst), .in(i_hb2),.strobe_in(strobe_hb2), .out(sample[31:16]), .strobe_out(strobe));
+     (.clk(clk),.reset(rst), .in(i_hb2),.strobe_in(strobe_hb2), .out(sample_sc16[31:16]), .strobe_out(strobe_sc16));
 
    round_sd #(.WIDTH_IN(24),.WIDTH_OUT(16)) round_q
-     (.clk(clk),.reset(rst), .in(q_hb2),.strobe_in(strobe_hb2), .out(sample[15:0]), .strobe_out());
+     (.clk(clk),.reset(rst), .in(q_hb2),.strobe_in(strobe_hb2), .out(sample_sc16[15:0]), .strobe_out());
+
+   // Optional sc8 format: otw = dsp >> 8, two samples per line {first, second}
+   wire [7:0]  i_sc8, q_sc8;
+   reg [15:0]  first_sc8;
+   reg 	       second_sc8;
+   round #(.bits_in(16),.bits_out(8)) round_i_sc8 (.in(sample_sc16[31:16]),.out(i_sc8),.err());
+   round #(.bits_in(16),.bits_out(8)) round_q_sc8 (.in(sample_sc16[15:0]),.out(q_sc8),.err());
+
+   always @(posedge clk)
+     if(rst | ~run)
+       second_sc8 <= 0;
+     else if(strobe_sc16 & format_sc8)
+       begin
+	  second_sc8 <= ~second_sc8;
+	  if(~second_sc8)
+	    first_sc8 <= {i_sc8, q_sc8};
+       end
+
+   // Optional sc12 format: otw = dsp >> 4, each sample {i,q} is 24 bits,
+   //   four samples per three lines, the bytes of a sample stay in order on the link
+   wire [11:0] i_sc12, q_sc12;
+   reg [23:0]  hold_sc12;
+   reg [1:0]   phase_sc12;
+   round #(.bits_in(16),.bits_out(12)) round_i_sc12 (.in(sample_sc16[31:16]),.out(i_sc12),.err());
+   round #(.bits_in(16),.bits_out(12)) round_q_sc12 (.in(sample_sc16[15:0]),.out(q_sc12),.err());
+   wire [23:0] samp_sc12 = {i_sc12, q_sc12};
+
+   always @(posedge clk)
+     if(rst | ~run)
+       phase_sc12 <= 0;
+     else if(strobe_sc16 & format_sc12)
+       begin
+	  phase_sc12 <= phase_sc12 + 1;
+	  case(phase_sc12)
+	    0 : hold_sc12 <= samp_sc12;
+	    1 : hold_sc12 <= SC12_LITTLE_ENDIAN ? {8'd0,samp_sc12[23:8]} : {8'd0,samp_sc12[15:0]};
+	    2 : hold_sc12 <= SC12_LITTLE_ENDIAN ? {16'd0,samp_sc12[23:16]} : {16'd0,samp_sc12[7:0]};
+	  endcase // case (phase_sc12)
+       end
+
+   reg [31:0]  line_sc12;
+   always @*
+     case(phase_sc12)
+       1 : line_sc12 = SC12_LITTLE_ENDIAN ? {samp_sc12[7:0], hold_sc12[23:0]} : {hold_sc12[23:0], samp_sc12[23:16]};
+       2 : line_sc12 = SC12_LITTLE_ENDIAN ? {samp_sc12[15:0], hold_sc12[15:0]} : {hold_sc12[15:0], samp_sc12[23:8]};
+       default : line_sc12 = SC12_LITTLE_ENDIAN ? {samp_sc12, hold_sc12[7:0]} : {hold_sc12[7:0], samp_sc12};
+     endcase // case (phase_sc12)
+
+   assign      sample = format_sc12 ? line_sc12 : format_sc8 ? {first_sc8, i_sc8, q_sc8} : sample_sc16;
+   assign      strobe = format_sc12 ? (strobe_sc16 & (phase_sc12 != 0)) :
+			format_sc8 ? (strobe_sc16 & second_sc8) : strobe_sc16;
    
    assign      debug = {enable_hb1, enable_hb2, run, strobe, strobe_cic, strobe_hb1, strobe_hb2};
    
@@ -17,7 +17,8 @@
 
 
 module dsp_core_tx
-  #(parameter BASE=0)
+  #(parameter BASE=0,
+    parameter SC12_LITTLE_ENDIAN = 0) // byte order of the packed sc12 lines on the host link
   (input clk, input rst,
    input set_stb, input [7:0] set_addr, input [31:0] set_data,
 
@@ -37,6 +38,7 @@ module dsp_core_tx
    wire [3:0]  dacmux_a, dacmux_b;
    wire        enable_hb1, enable_hb2;
    wire        rate_change;
+   wire        format_sc8, format_sc12;
    
    setting_reg #(.my_addr(BASE+0)) sr_0
      (.clk(clk),.rst(rst),.strobe(set_stb),.addr(set_addr),
@@ -50,6 +52,10 @@ module dsp_core_tx
      (.clk(clk),.rst(rst),.strobe(set_stb),.addr(set_addr),
       .in(set_data),.out({enable_hb1, enable_hb2, interp_rate}),.changed(rate_change));
 
+   setting_reg #(.my_addr(BASE+3), .width(2)) sr_3
+     (.clk(clk),.rst(rst),.strobe(set_stb),.addr(set_addr),
+      .in(set_data),.out({format_sc12,format_sc8}),.changed());
+
    // Strobes are all now delayed by 1 cycle for timing reasons
    wire        strobe_cic_pre, strobe_hb1_pre, strobe_hb2_pre;
    reg 	       strobe_cic = 1;
@@ -82,8 +88,45 @@ module dsp_core_tx
    wire        signed [17:0] da, db;
    wire        signed [35:0] prod_i, prod_q;
 
-   wire [17:0] bb_i = {sample[31:16],2'b0};
-   wire [17:0] bb_q = {sample[15:0],2'b0};
+   // Optional sc8 format: dsp = otw << 8, two samples per line {first, second}
+   reg 	       second_sc8;
+   always @(posedge clk)
+     if(rst | ~run)
+       second_sc8 <= 0;
+     else if(strobe_hb1 & format_sc8)
+       second_sc8 <= ~second_sc8;
+
+   wire [15:0] sample_sc8 = second_sc8 ? sample[15:0] : sample[31:16];
+
+   // Optional sc12 format: dsp = otw << 4, each sample {i,q} is 24 bits,
+   //   four samples per three lines, the third line holds the last two samples
+   reg [1:0]   phase_sc12;
+   reg [15:0]  hold_sc12;
+   always @(posedge clk)
+     if(rst | ~run)
+       phase_sc12 <= 0;
+     else if(strobe_hb1 & format_sc12)
+       begin
+	  phase_sc12 <= phase_sc12 + 1;
+	  case(phase_sc12)
+	    0 : hold_sc12 <= SC12_LITTLE_ENDIAN ? {8'd0,sample[31:24]} : {8'd0,sample[7:0]};
+	    1 : hold_sc12 <= SC12_LITTLE_ENDIAN ? sample[31:16] : sample[15:0];
+	  endcase // case (phase_sc12)
+       end
+
+   reg [23:0]  sample_sc12;
+   always @*
+     case(phase_sc12)
+       0 : sample_sc12 = SC12_LITTLE_ENDIAN ? sample[23:0] : sample[31:8];
+       1 : sample_sc12 = SC12_LITTLE_ENDIAN ? {sample[15:0], hold_sc12[7:0]} : {hold_sc12[7:0], sample[31:16]};
+       2 : sample_sc12 = SC12_LITTLE_ENDIAN ? {sample[7:0], hold_sc12[15:0]} : {hold_sc12[15:0], sample[31:24]};
+       default : sample_sc12 = SC12_LITTLE_ENDIAN ? sample[31:8] : sample[23:0];
+     endcase // case (phase_sc12)
+
+   wire [17:0] bb_i = format_sc12 ? {sample_sc12[23:12],6'b0} :
+		      format_sc8 ? {sample_sc8[15:8],10'b0} : {sample[31:16],2'b0};
+   wire [17:0] bb_q = format_sc12 ? {sample_sc12[11:0],6'b0} :
+		      format_sc8 ? {sample_sc8[7:0],10'b0} : {sample[15:0],2'b0};
    wire [17:0] i_interp, q_interp;
 
    wire [17:0] hb1_i, hb1_q, hb2_i, hb2_q;
@@ -114,7 +157,10 @@ module dsp_core_tx
 		  .strobe_in(strobe_cic),.strobe_out(1),
 		  .signal_in(hb2_q),.signal_out(q_interp));
 
-   assign      strobe = strobe_hb1;
+   // Only consume the line from tx_control after its second sc8 sample,
+   //   or after its last sc12 sample: the sc12 samples 2 and 3 share the third line
+   assign      strobe = format_sc12 ? (strobe_hb1 & (phase_sc12 != 2)) :
+			format_sc8 ? (strobe_hb1 & second_sc8) : strobe_hb1;
 
    localparam  cwidth = 24;  // was 18
    localparam  zwidth = 24;  // was 16
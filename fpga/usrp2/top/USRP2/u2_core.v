@@ -167,12 +167,15 @@ module u2_core
    localparam SR_TX_FRONT = 128;   // ?
    localparam SR_TX_CTRL  = 144;   // 6
    localparam SR_TX_DSP   = 160;   // 5
+   localparam SR_TX_CTRL1 = 176;   // 6
+   localparam SR_TX_DSP1  = 184;   // 5
 
    localparam SR_UDP_SM   = 192;   // 64
    
    // FIFO Sizes, 9 = 512 lines, 10 = 1024, 11 = 2048
    // all (most?) are 36 bits wide, so 9 is 1 BRAM, 10 is 2, 11 is 4 BRAMs
    // localparam DSP_TX_FIFOSIZE = 9;  unused -- DSPTX uses extram fifo
+   localparam DSP_TX1_FIFOSIZE = 12;
    localparam DSP_RX_FIFOSIZE = 10;
    localparam ETH_TX_FIFOSIZE = 9;
    localparam ETH_RX_FIFOSIZE = 11;
@@ -189,7 +192,7 @@ module u2_core
    
    wire [31:0] 	status;
    wire 	bus_error, spi_int, i2c_int, pps_int, onetime_int, periodic_int, buffer_int;
-   wire 	proc_int, overrun0, overrun1, underrun;
+   wire 	proc_int, overrun0, overrun1, underrun, underrun0, underrun1;
    wire 	uart_tx_int, uart_rx_int;
 
    wire [31:0] 	debug_gpio_0, debug_gpio_1;
@@ -206,7 +209,7 @@ module u2_core
    wire [31:0] 	irq;
    wire [63:0] 	vita_time, vita_time_pps;
    
-   wire 	 run_rx0, run_rx1, run_tx;
+   wire 	 run_rx0, run_rx1, run_tx, run_tx0, run_tx1;
    reg 		 run_rx0_d1, run_rx1_d1;
    
    // ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -395,7 +398,8 @@ module u2_core
       .err_inp_data(tx_err_data), .err_inp_ready(tx_err_dst_rdy), .err_inp_valid(tx_err_src_rdy),
 
       .ser_out_data(rd0_dat), .ser_out_valid(rd0_ready_o), .ser_out_ready(rd0_ready_i),
-      .dsp_out_data(rd1_dat), .dsp_out_valid(rd1_ready_o), .dsp_out_ready(rd1_ready_i),
+      .dsp0_out_data(rd1_dat), .dsp0_out_valid(rd1_ready_o), .dsp0_out_ready(rd1_ready_i),
+      .dsp1_out_data(rd3_dat), .dsp1_out_valid(rd3_ready_o), .dsp1_out_ready(rd3_ready_i),
       .eth_out_data(rd2_dat), .eth_out_valid(rd2_ready_o), .eth_out_ready(rd2_ready_i)
       );
 
@@ -432,7 +436,7 @@ module u2_core
    // Buffer Pool Status -- Slave #5   
    
    //compatibility number -> increment when the fpga has been sufficiently altered
-   localparam compat_num = {16'd7, 16'd3}; //major, minor
+   localparam compat_num = {16'd7, 16'd6}; //major, minor
 
    wb_readback_mux buff_pool_status
      (.wb_clk_i(wb_clk), .wb_rst_i(wb_rst), .wb_stb_i(s5_stb),
@@ -685,22 +689,79 @@ module u2_core
 	.debug(debug_extfifo),
 	.debug2(debug_extfifo2) );
 
-   wire [23:0] 	 tx_i, tx_q;
+   wire [23:0] 	 tx0_i, tx0_q;
+   wire [35:0] 	 tx0_err_data;
+   wire 	 tx0_err_src_rdy, tx0_err_dst_rdy;
    
    vita_tx_chain #(.BASE_CTRL(SR_TX_CTRL), .BASE_DSP(SR_TX_DSP), 
 		   .REPORT_ERROR(1), .DO_FLOW_CONTROL(1),
 		   .PROT_ENG_FLAGS(1), .USE_TRANS_HEADER(1),
 		   .DSP_NUMBER(0))
-   vita_tx_chain
+   vita_tx_chain0
      (.clk(dsp_clk), .reset(dsp_rst),
       .set_stb(set_stb_dsp),.set_addr(set_addr_dsp),.set_data(set_data_dsp),
       .vita_time(vita_time),
       .tx_data_i(tx_data), .tx_src_rdy_i(tx_src_rdy), .tx_dst_rdy_o(tx_dst_rdy),
-      .err_data_o(tx_err_data), .err_src_rdy_o(tx_err_src_rdy), .err_dst_rdy_i(tx_err_dst_rdy),
-      .tx_i(tx_i),.tx_q(tx_q),
-      .underrun(underrun), .run(run_tx),
+      .err_data_o(tx0_err_data), .err_src_rdy_o(tx0_err_src_rdy), .err_dst_rdy_i(tx0_err_dst_rdy),
+      .tx_i(tx0_i),.tx_q(tx0_q),
+      .underrun(underrun0), .run(run_tx0),
       .debug(debug_vt));
 
+   // ///////////////////////////////////////////////////////////////////////////////////
+   // DSP TX 1 (buffered in block ram, the sram belongs to DSP TX 0)
+
+   wire [35:0] 	 tx1_data;
+   wire 	 tx1_src_rdy, tx1_dst_rdy;
+   wire 	 clear_tx1;
+
+   setting_reg #(.my_addr(SR_TX_CTRL1+1)) sr_clear_tx1
+     (.clk(dsp_clk),.rst(dsp_rst),.strobe(set_stb_dsp),.addr(set_addr_dsp),
+      .in(set_data_dsp),.out(),.changed(clear_tx1));
+
+   fifo_cascade #(.WIDTH(36), .SIZE(DSP_TX1_FIFOSIZE)) tx1_fifo
+     (.clk(dsp_clk), .reset(dsp_rst), .clear(clear_tx1),
+      .datain(rd3_dat), .src_rdy_i(rd3_ready_o), .dst_rdy_o(rd3_ready_i),
+      .dataout(tx1_data), .src_rdy_o(tx1_src_rdy), .dst_rdy_i(tx1_dst_rdy),
+      .space(), .occupied() );
+
+   wire [23:0] 	 tx1_i, tx1_q;
+   wire [35:0] 	 tx1_err_data;
+   wire 	 tx1_err_src_rdy, tx1_err_dst_rdy;
+
+   vita_tx_chain #(.BASE_CTRL(SR_TX_CTRL1), .BASE_DSP(SR_TX_DSP1),
+		   .REPORT_ERROR(1), .DO_FLOW_CONTROL(1),
+		   .PROT_ENG_FLAGS(1), .USE_TRANS_HEADER(1),
+		   .DSP_NUMBER(1))
+   vita_tx_chain1
+     (.clk(dsp_clk), .reset(dsp_rst),
+      .set_stb(set_stb_dsp),.set_addr(set_addr_dsp),.set_data(set_data_dsp),
+      .vita_time(vita_time),
+      .tx_data_i(tx1_data), .tx_src_rdy_i(tx1_src_rdy), .tx_dst_rdy_o(tx1_dst_rdy),
+      .err_data_o(tx1_err_data), .err_src_rdy_o(tx1_err_src_rdy), .err_dst_rdy_i(tx1_err_dst_rdy),
+      .tx_i(tx1_i),.tx_q(tx1_q),
+      .underrun(underrun1), .run(run_tx1),
+      .debug());
+
+   // ///////////////////////////////////////////////////////////////////////////////////
+   // DSP TX combine: one error stream to the router, the samples summed into the frontend
+
+   fifo36_mux #(.prio(0)) tx_err_mux
+     (.clk(dsp_clk), .reset(dsp_rst), .clear(1'b0),
+      .data0_i(tx0_err_data), .src0_rdy_i(tx0_err_src_rdy), .dst0_rdy_o(tx0_err_dst_rdy),
+      .data1_i(tx1_err_data), .src1_rdy_i(tx1_err_src_rdy), .dst1_rdy_o(tx1_err_dst_rdy),
+      .data_o(tx_err_data), .src_rdy_o(tx_err_src_rdy), .dst_rdy_i(tx_err_dst_rdy));
+
+   assign underrun = underrun0 | underrun1;
+   assign run_tx = run_tx0 | run_tx1;
+
+   wire [23:0] 	 tx_i, tx_q;
+
+   add2_and_clip_reg #(.WIDTH(24)) add_tx_i
+     (.clk(dsp_clk), .rst(dsp_rst), .in1(tx0_i), .in2(tx1_i), .strobe_in(1'b1), .sum(tx_i), .strobe_out());
+
+   add2_and_clip_reg #(.WIDTH(24)) add_tx_q
+     (.clk(dsp_clk), .rst(dsp_rst), .in1(tx0_q), .in2(tx1_q), .strobe_in(1'b1), .sum(tx_q), .strobe_out());
+
    tx_frontend #(.BASE(SR_TX_FRONT)) tx_frontend
      (.clk(dsp_clk), .rst(dsp_rst),
       .set_stb(set_stb_dsp),.set_addr(set_addr_dsp),.set_data(set_data_dsp),
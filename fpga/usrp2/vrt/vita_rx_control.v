@@ -204,8 +204,16 @@ module vita_rx_control
 		      end
 	       end // else: !if(full)
 	 IBS_OVERRUN :
+	   // A continuous stream resumes on its own once the overrun is flagged,
+	   // the host sees a timestamp discontinuity instead of a stopped stream.
 	   if(sample_fifo_in_rdy)
-	     ibs_state <= IBS_IDLE;
+	     if(chain & reload & ~not_empty_ctrl)
+	       begin
+		  ibs_state  <= IBS_RUNNING;
+		  lines_left <= lines_total;
+	       end
+	     else
+	       ibs_state <= IBS_IDLE;
 	 IBS_LATECMD :
 	   if(sample_fifo_in_rdy)
 	     ibs_state <= IBS_IDLE;
@@ -23,7 +23,8 @@ module vita_tx_chain
     parameter DO_FLOW_CONTROL=0,
     parameter PROT_ENG_FLAGS=0,
     parameter USE_TRANS_HEADER=0,
-    parameter DSP_NUMBER=0)
+    parameter DSP_NUMBER=0,
+    parameter SC12_LITTLE_ENDIAN=0)
    (input clk, input reset,
     input set_stb, input [7:0] set_addr, input [31:0] set_data,
     input [63:0] vita_time,
@@ -80,7 +81,7 @@ module vita_tx_chain
       .sample(sample_tx), .run(run), .strobe(strobe_tx), .packet_consumed(packet_consumed),
       .debug(debug_vtc) );
    
-   dsp_core_tx #(.BASE(BASE_DSP)) dsp_core_tx
+   dsp_core_tx #(.BASE(BASE_DSP), .SC12_LITTLE_ENDIAN(SC12_LITTLE_ENDIAN)) dsp_core_tx
      (.clk(clk),.rst(reset),
       .set_stb(set_stb),.set_addr(set_addr),.set_data(set_data),
       .sample(sample_tx), .run(run), .strobe(strobe_tx),
@@ -27,6 +27,47 @@ namespace acsii_art_dft{
         const std::complex<T> *samps, size_t nsamps
     );
 
+    /*!
+     * A reusable log power DFT of a fixed size.
+     * The window, twiddles, and buffers are computed once,
+     * so each update only runs the windowing and an iterative FFT.
+     * Several updates between reads average their power.
+     */
+    template <typename T> class log_pwr_dft_engine{
+    public:
+        /*!
+         * Make a new DFT engine.
+         * \param nsamps the number of samples per DFT (a power of 2)
+         */
+        log_pwr_dft_engine(size_t nsamps);
+
+        //! Get the number of samples per DFT
+        size_t size(void) const{return _window.size();}
+
+        //! Get the number of DFTs averaged since the last read
+        size_t get_num_averaged(void) const{return _num_averaged;}
+
+        /*!
+         * Add the power of one DFT into the average.
+         * \param samps a pointer to size() complex samples
+         */
+        void update(const std::complex<T> *samps);
+
+        /*!
+         * Read the averaged log power bins and restart the average.
+         * \param dft the vector to fill with size() bins in units of dB
+         */
+        void read(log_pwr_dft_type &dft);
+
+    private:
+        std::vector<T> _window;
+        std::vector<size_t> _bitrev;
+        std::vector<std::complex<T> > _twiddles, _fft;
+        std::vector<T> _pwr;
+        size_t _num_averaged;
+        double _win_pwr;
+    };
+
     /*!
      * Convert a DFT to a piroundable ascii plot.
      * \param dft the log power dft bins
@@ -56,6 +97,9 @@ namespace acsii_art_dft{
 #include <cmath>
 #include <sstream>
 #include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /***********************************************************************
  * Helper functions
@@ -83,29 +127,56 @@ namespace {/*anon*/
         return ((num < 0)? -1 : 1)*clean*pow10;
     }
 
-    //! Compute an FFT with pre-computed factors using Cooley-Tukey
-    template <typename T> std::complex<T> ct_fft_f(
-        const std::complex<T> *samps, size_t nsamps,
-        const std::complex<T> *factors,
-        size_t start = 0, size_t step = 1
+    //! Run one radix-2 stage, the twiddles of the stage are contiguous
+    template <typename T> void fft_stage(
+        std::complex<T> *a, size_t nsamps, size_t half,
+        const std::complex<T> *twiddles
     ){
-        if (nsamps == 1) return samps[start];
-        std::complex<T> E_k = ct_fft_f(samps, nsamps/2, factors+1, start,      step*2);
-        std::complex<T> O_k = ct_fft_f(samps, nsamps/2, factors+1, start+step, step*2);
-        return E_k + factors[0]*O_k;
+        for (size_t i = 0; i < nsamps; i += 2*half){
+            for (size_t j = 0; j < half; j++){
+                const std::complex<T> u = a[i+j];
+                const std::complex<T> v = a[i+j+half]*twiddles[j];
+                a[i+j] = u + v;
+                a[i+j+half] = u - v;
+            }
+        }
     }
 
-    //! Compute an FFT for a particular bin k using Cooley-Tukey
-    template <typename T> std::complex<T> ct_fft_k(
-        const std::complex<T> *samps, size_t nsamps, size_t k
+#ifdef __SSE2__
+    //! Run one radix-2 stage with two complex floats per register
+    template <> inline void fft_stage(
+        std::complex<float> *a, size_t nsamps, size_t half,
+        const std::complex<float> *twiddles
     ){
-        //pre-compute the factors to use in Cooley-Tukey
-        std::vector<std::complex<T> > factors;
-        for (size_t N = nsamps; N != 0; N /= 2){
-            factors.push_back(std::exp(std::complex<T>(0, T(-2*pi*k/N))));
+        if (half < 2){ //the first stage is not vector friendly
+            for (size_t i = 0; i < nsamps; i += 2){
+                const std::complex<float> u = a[i], v = a[i+1];
+                a[i] = u + v;
+                a[i+1] = u - v;
+            }
+            return;
+        }
+        const __m128 neg_re = _mm_castsi128_ps(_mm_set_epi32(0, 0x80000000, 0, 0x80000000));
+        float *f = reinterpret_cast<float *>(a);
+        const float *w = reinterpret_cast<const float *>(twiddles);
+        for (size_t i = 0; i < 2*nsamps; i += 4*half){
+            for (size_t j = 0; j < 2*half; j += 4){
+                const __m128 u = _mm_loadu_ps(f+i+j);
+                const __m128 v = _mm_loadu_ps(f+i+j+2*half);
+                const __m128 t = _mm_loadu_ps(w+j);
+                //(a+jb)(c+jd) = (ac-bd) + j(bc+ad)
+                const __m128 t_re = _mm_shuffle_ps(t, t, _MM_SHUFFLE(2,2,0,0));
+                const __m128 t_im = _mm_shuffle_ps(t, t, _MM_SHUFFLE(3,3,1,1));
+                const __m128 v_swap = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2,3,0,1));
+                const __m128 prod = _mm_add_ps(
+                    _mm_mul_ps(v, t_re), _mm_xor_ps(_mm_mul_ps(v_swap, t_im), neg_re)
+                );
+                _mm_storeu_ps(f+i+j, _mm_add_ps(u, prod));
+                _mm_storeu_ps(f+i+j+2*half, _mm_sub_ps(u, prod));
+            }
         }
-        return ct_fft_f(samps, nsamps, &factors.front());
     }
+#endif /*__SSE2__*/
 
     //! Helper class to build a DFT plot frame
     class frame_type{
@@ -153,15 +224,13 @@ namespace acsii_art_dft{
     //! skip constants for amplitude and frequency labels
     static const size_t albl_skip = 5, flbl_skip = 20;
 
-    template <typename T> log_pwr_dft_type log_pwr_dft(
-        const std::complex<T> *samps, size_t nsamps
-    ){
-        if (nsamps & (nsamps - 1))
+    template <typename T> log_pwr_dft_engine<T>::log_pwr_dft_engine(size_t nsamps):
+        _num_averaged(0), _win_pwr(0)
+    {
+        if (nsamps == 0 or (nsamps & (nsamps - 1)))
             throw std::runtime_error("num samps is not a power of 2");
 
         //compute the window
-        double win_pwr = 0;
-        std::vector<std::complex<T> > win_samps;
         for(size_t n = 0; n < nsamps; n++){
             //double w_n = 1;
             //double w_n = 0.54 //hamming window
@@ -178,22 +247,71 @@ namespace acsii_art_dft{
             //    -0.388*std::cos(6*pi*n/(nsamps-1))
             //    +0.032*std::cos(8*pi*n/(nsamps-1))
             //;
-            win_samps.push_back(T(w_n)*samps[n]);
-            win_pwr += w_n*w_n;
+            _window.push_back(T(w_n));
+            _win_pwr += w_n*w_n;
         }
 
-        //compute the log-power dft
-        log_pwr_dft_type log_pwr_dft;
-        for(size_t k = 0; k < nsamps; k++){
-            std::complex<T> dft_k = ct_fft_k(&win_samps.front(), nsamps, k);
-            log_pwr_dft.push_back(float(
-                + 20*std::log10(std::abs(dft_k))
-                - 20*std::log10(T(nsamps))
-                - 10*std::log10(win_pwr/nsamps)
-                + 3
-            ));
+        //the samples are loaded in bit reversed order
+        size_t num_bits = 0;
+        while ((size_t(1) << num_bits) < nsamps) num_bits++;
+        for (size_t n = 0; n < nsamps; n++){
+            size_t r = 0;
+            for (size_t b = 0; b < num_bits; b++){
+                if (n & (size_t(1) << b)) r |= size_t(1) << (num_bits - 1 - b);
+            }
+            _bitrev.push_back(r);
         }
 
+        //the twiddles of each stage, stage by stage (nsamps-1 in total)
+        for (size_t half = 1; half < nsamps; half *= 2){
+            for (size_t j = 0; j < half; j++){
+                _twiddles.push_back(std::polar(T(1), T(-pi*j/half)));
+            }
+        }
+
+        _fft.resize(nsamps);
+        _pwr.resize(nsamps, 0);
+    }
+
+    template <typename T> void log_pwr_dft_engine<T>::update(const std::complex<T> *samps){
+        const size_t nsamps = this->size();
+        for (size_t n = 0; n < nsamps; n++){
+            _fft[_bitrev[n]] = _window[n]*samps[n];
+        }
+        const std::complex<T> *twiddles = &_twiddles.front();
+        for (size_t half = 1; half < nsamps; half *= 2){
+            fft_stage(&_fft.front(), nsamps, half, twiddles);
+            twiddles += half;
+        }
+        for (size_t k = 0; k < nsamps; k++){
+            _pwr[k] += std::norm(_fft[k]);
+        }
+        _num_averaged++;
+    }
+
+    template <typename T> void log_pwr_dft_engine<T>::read(log_pwr_dft_type &dft){
+        const size_t nsamps = this->size();
+        const double offset = (_num_averaged == 0)? 0 : (
+            - 10*std::log10(double(_num_averaged))
+            - 20*std::log10(double(nsamps))
+            - 10*std::log10(_win_pwr/nsamps)
+            + 3
+        );
+        dft.resize(nsamps);
+        for (size_t k = 0; k < nsamps; k++){
+            dft[k] = float(10*std::log10(_pwr[k]) + offset);
+            _pwr[k] = 0;
+        }
+        _num_averaged = 0;
+    }
+
+    template <typename T> log_pwr_dft_type log_pwr_dft(
+        const std::complex<T> *samps, size_t nsamps
+    ){
+        log_pwr_dft_engine<T> engine(nsamps);
+        engine.update(samps);
+        log_pwr_dft_type log_pwr_dft;
+        engine.read(log_pwr_dft);
         return log_pwr_dft;
     }
 
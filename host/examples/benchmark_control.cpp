@@ -0,0 +1,231 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+
+namespace po = boost::program_options;
+using namespace uhd::usrp;
+
+/***********************************************************************
+ * One control operation and its measurements
+ **********************************************************************/
+struct ctrl_result_t{
+    std::string op;         //peek, poke, spi, spi_batch, or i2c
+    size_t batch;           //operations per call
+    unsigned long long num_calls;
+    double ops_per_sec;
+    double lat_min_us, lat_avg_us, lat_p50_us, lat_p90_us, lat_p99_us, lat_max_us;
+
+    ctrl_result_t(void):
+        batch(1), num_calls(0), ops_per_sec(0),
+        lat_min_us(0), lat_avg_us(0), lat_p50_us(0), lat_p90_us(0), lat_p99_us(0), lat_max_us(0)
+    {}
+};
+
+template <typename T> static std::vector<T> split_list(const std::string &list, const std::string &seps = ","){
+    std::vector<std::string> tokens;
+    boost::split(tokens, list, boost::is_any_of(seps));
+    std::vector<T> values;
+    BOOST_FOREACH(const std::string &token, tokens){
+        values.push_back(boost::lexical_cast<T>(boost::trim_copy(token)));
+    }
+    return values;
+}
+
+static double percentile(const std::vector<double> &sorted, double p){
+    return sorted[std::min(sorted.size() - 1, size_t(p*sorted.size()))];
+}
+
+/***********************************************************************
+ * Time calls of an operation back to back for the duration:
+ * the latency is per call, the rate counts batch operations per call
+ **********************************************************************/
+static void benchmark_op(const boost::function<void(void)> &call, double duration, ctrl_result_t &result){
+    std::vector<double> latencies;
+    call(); //warm up, the first call may set up the transport
+
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    uhd::time_spec_t now = start;
+    while ((now - start).get_real_secs() < duration){
+        const uhd::time_spec_t call_start = now;
+        call();
+        now = uhd::time_spec_t::get_system_time();
+        latencies.push_back((now - call_start).get_real_secs()*1e6);
+    }
+    const double elapsed = (now - start).get_real_secs();
+
+    result.num_calls = latencies.size();
+    if (latencies.empty()) return;
+    result.ops_per_sec = latencies.size()*result.batch/elapsed;
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0;
+    BOOST_FOREACH(double latency, latencies) sum += latency;
+    result.lat_min_us = latencies.front();
+    result.lat_avg_us = sum/latencies.size();
+    result.lat_p50_us = percentile(latencies, 0.50);
+    result.lat_p90_us = percentile(latencies, 0.90);
+    result.lat_p99_us = percentile(latencies, 0.99);
+    result.lat_max_us = latencies.back();
+}
+
+/***********************************************************************
+ * The operations through the daughterboard interface:
+ *  - peek reads the GPIO pins, poke rewrites the GPIO outputs unchanged.
+ *  - spi writes the word to the daughterboard's SPI slave,
+ *    spi_batch writes batch words in one write_spi_batch call.
+ *  - i2c reads one byte from the I2C address.
+ **********************************************************************/
+static void peek_op(dboard_iface::sptr iface, dboard_iface::unit_t unit){
+    iface->read_gpio(unit);
+}
+
+static void poke_op(dboard_iface::sptr iface, dboard_iface::unit_t unit){
+    iface->set_gpio_out(unit, iface->get_gpio_out(unit));
+}
+
+static void spi_op(dboard_iface::sptr iface, dboard_iface::unit_t unit, boost::uint32_t word){
+    iface->write_spi(unit, uhd::spi_config_t::EDGE_RISE, word, 32);
+}
+
+static void spi_batch_op(dboard_iface::sptr iface, dboard_iface::unit_t unit, const std::vector<boost::uint32_t> &words){
+    iface->write_spi_batch(unit, uhd::spi_config_t::EDGE_RISE, words, 32);
+}
+
+static void i2c_op(dboard_iface::sptr iface, boost::uint8_t addr){
+    iface->read_i2c(addr, 1);
+}
+
+/***********************************************************************
+ * Report writers
+ **********************************************************************/
+static void print_result(const ctrl_result_t &r){
+    std::cout << boost::format(
+        "%-9s batch %-4u: %10.0f ops/s, "
+        "latency min/avg/p50/p90/p99/max %.1f/%.1f/%.1f/%.1f/%.1f/%.1f us per call"
+    ) % r.op % r.batch % r.ops_per_sec
+      % r.lat_min_us % r.lat_avg_us % r.lat_p50_us % r.lat_p90_us % r.lat_p99_us % r.lat_max_us << std::endl;
+}
+
+static void write_csv(const std::string &file, const std::string &device, const std::vector<ctrl_result_t> &results){
+    std::ofstream out(file.c_str());
+    out << "device,op,batch,calls,ops_per_sec,"
+        "lat_min_us,lat_avg_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_max_us" << std::endl;
+    BOOST_FOREACH(const ctrl_result_t &r, results){
+        out << boost::format("%s,%s,%u,%u,%f,%f,%f,%f,%f,%f,%f")
+            % device % r.op % r.batch % r.num_calls % r.ops_per_sec
+            % r.lat_min_us % r.lat_avg_us % r.lat_p50_us % r.lat_p90_us % r.lat_p99_us % r.lat_max_us
+        << std::endl;
+    }
+}
+
+/***********************************************************************
+ * Main code + sweep
+ **********************************************************************/
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    std::string args, ops, batches, unit_name, csv;
+    double duration;
+    size_t chan;
+    boost::uint32_t spi_word;
+    unsigned i2c_addr;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "single uhd device address args")
+        ("duration", po::value<double>(&duration)->default_value(1.0), "duration for each operation in seconds")
+        ("ops", po::value<std::string>(&ops)->default_value("peek,poke"), "comma separated operations: peek, poke, spi, spi_batch, i2c")
+        ("batch", po::value<std::string>(&batches)->default_value("1,8,32"), "comma separated words per spi_batch call")
+        ("unit", po::value<std::string>(&unit_name)->default_value("rx"), "the daughterboard interface unit: rx or tx")
+        ("chan", po::value<size_t>(&chan)->default_value(0), "the channel of the daughterboard interface")
+        ("spi_word", po::value<boost::uint32_t>(&spi_word)->default_value(0), "the 32 bit word for the spi operations")
+        ("i2c_addr", po::value<unsigned>(&i2c_addr)->default_value(0x50), "the I2C address for the i2c operation")
+        ("csv", po::value<std::string>(&csv), "write the results to a CSV file")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Benchmark Control %s") % desc << std::endl;
+        std::cout <<
+        "    Time the control operations through the daughterboard interface, call after call.\n"
+        "    The spi operations write the word into the daughterboard's SPI slave:\n"
+        "    the daughterboard needs to be set up again (ex: retuned) after the benchmark.\n"
+        "    Ex: --ops=peek,poke,spi_batch,i2c --batch=1,16 --csv=ctrl.csv\n"
+        << std::endl;
+        return ~0;
+    }
+
+    //create a usrp device
+    std::cout << std::endl;
+    std::cout << boost::format("Creating the usrp device with: %s...") % args << std::endl;
+    multi_usrp::sptr usrp = multi_usrp::make(args);
+    std::cout << boost::format("Using Device: %s") % usrp->get_pp_string() << std::endl;
+
+    const dboard_iface::unit_t unit = (unit_name == "tx")? dboard_iface::UNIT_TX : dboard_iface::UNIT_RX;
+    dboard_iface::sptr iface = (unit == dboard_iface::UNIT_TX)?
+        usrp->get_tx_dboard_iface(chan) : usrp->get_rx_dboard_iface(chan);
+
+    //run each operation, and spi_batch once per batch size
+    std::vector<ctrl_result_t> results;
+    BOOST_FOREACH(const std::string &op, split_list<std::string>(ops)){
+        std::vector<size_t> op_batches(1, 1);
+        if (op == "spi_batch") op_batches = split_list<size_t>(batches);
+        BOOST_FOREACH(size_t batch, op_batches){
+            ctrl_result_t result;
+            result.op = op;
+            result.batch = std::max<size_t>(batch, 1);
+            const std::vector<boost::uint32_t> words(result.batch, spi_word);
+            boost::function<void(void)> call;
+            if (op == "peek") call = boost::bind(&peek_op, iface, unit);
+            else if (op == "poke") call = boost::bind(&poke_op, iface, unit);
+            else if (op == "spi") call = boost::bind(&spi_op, iface, unit, spi_word);
+            else if (op == "spi_batch") call = boost::bind(&spi_batch_op, iface, unit, words);
+            else if (op == "i2c") call = boost::bind(&i2c_op, iface, boost::uint8_t(i2c_addr));
+            else throw std::runtime_error("Unknown operation " + op);
+            benchmark_op(call, duration, result);
+            print_result(result);
+            results.push_back(result);
+        }
+    }
+
+    if (vm.count("csv")) write_csv(csv, usrp->get_mboard_name(), results);
+
+    //finished
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/sample_buffer.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/convert.hpp>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/tokenizer.hpp>
+#include <boost/lexical_cast.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <complex>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace po = boost::program_options;
+
+/***********************************************************************
+ * Decode the markup for the printed table
+ **********************************************************************/
+static size_t type_size(const std::string &type){
+    if (type == "fc64")   return sizeof(std::complex<double>);
+    if (type == "fc32")   return sizeof(std::complex<float>);
+    if (type == "sc16")   return sizeof(std::complex<boost::int16_t>);
+    if (type == "sc8")    return sizeof(std::complex<boost::int8_t>);
+    if (type == "item32") return sizeof(boost::uint32_t);
+    if (type == "item16") return sizeof(boost::uint16_t);
+    if (type == "item24") return 3; //packed sc12
+    throw std::runtime_error("unknown type in markup: " + type);
+}
+
+static std::string priority_name(uhd::convert::priority_type prio){
+    switch(prio){
+    case uhd::convert::PRIORITY_GENERAL:       return "general";
+    case uhd::convert::PRIORITY_LIBORC:        return "liborc";
+    case uhd::convert::PRIORITY_CUSTOM:        return "custom";
+    case uhd::convert::PRIORITY_CUSTOM_AVX2:   return "custom_avx2";
+    case uhd::convert::PRIORITY_CUSTOM_STREAM: return "custom_stream";
+    default:                                   return "empty";
+    }
+}
+
+/***********************************************************************
+ * Fill a buffer with samples in the valid range of the type
+ **********************************************************************/
+template <typename T> static void fill_floats(void *mem, size_t num_bytes){
+    T *samps = reinterpret_cast<T *>(mem);
+    for (size_t i = 0; i < num_bytes/sizeof(T); i++){
+        samps[i] = T(std::rand())/T(RAND_MAX)*2 - 1;
+    }
+}
+
+static void fill_buffer(void *mem, size_t num_bytes, const std::string &type){
+    if (type == "fc64") fill_floats<double>(mem, num_bytes);
+    else if (type == "fc32") fill_floats<float>(mem, num_bytes);
+    else{ //integer types take any bit pattern
+        char *bytes = reinterpret_cast<char *>(mem);
+        for (size_t i = 0; i < num_bytes; i++) bytes[i] = char(std::rand());
+    }
+}
+
+/***********************************************************************
+ * Benchmark one converter over a buffer of nsamps per channel:
+ * Call the converter until the duration expires, report the averages.
+ **********************************************************************/
+static void benchmark_converter(
+    const uhd::convert::converter_info_t &info,
+    size_t nsamps, double duration
+){
+    //decode the markup: convert_<in>_<num ins>_to_<out>_<num outs>_<swap>
+    boost::tokenizer<boost::char_separator<char> > tokenizer(info.markup, boost::char_separator<char>("_"));
+    const std::vector<std::string> tokens(tokenizer.begin(), tokenizer.end());
+    const std::string &input_type = tokens.at(1), &output_type = tokens.at(4);
+    const size_t input_size = type_size(input_type), output_size = type_size(output_type);
+    const size_t num_inputs = boost::lexical_cast<size_t>(tokens.at(2));
+    const size_t num_outputs = boost::lexical_cast<size_t>(tokens.at(5));
+    const double scale_factor = (output_type == "item32")? 32767. : 1/32767.;
+    const uhd::convert::function_type converter = uhd::convert::get_converter(info.markup, info.prio);
+
+    //allocate and fill the buffers, the otw side interleaves the channels
+    const size_t input_bytes = nsamps*input_size*num_outputs;
+    const size_t output_bytes = nsamps*output_size*num_inputs;
+    std::vector<boost::shared_ptr<void> > mems;
+    std::vector<const void *> inputs;
+    std::vector<void *> outputs;
+    for (size_t i = 0; i < num_inputs; i++){
+        mems.push_back(uhd::alloc_sample_buffer(input_bytes));
+        fill_buffer(mems.back().get(), input_bytes, input_type);
+        inputs.push_back(mems.back().get());
+    }
+    for (size_t i = 0; i < num_outputs; i++){
+        mems.push_back(uhd::alloc_sample_buffer(output_bytes));
+        outputs.push_back(mems.back().get());
+    }
+
+    //warm up the caches and the branch predictors
+    converter(inputs, outputs, nsamps, scale_factor);
+
+    //run until the duration expires
+    size_t num_calls = 0;
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    uhd::time_spec_t elapsed;
+    do{
+        for (size_t i = 0; i < 8; i++){
+            converter(inputs, outputs, nsamps, scale_factor);
+        }
+        num_calls += 8;
+        elapsed = uhd::time_spec_t::get_system_time() - start;
+    } while (elapsed.get_real_secs() < duration);
+
+    //print the results, samples are counted per channel
+    const double secs = elapsed.get_real_secs();
+    const double total_samps = double(num_calls)*nsamps*num_inputs*num_outputs;
+    const double total_bytes = double(num_calls)*(input_bytes*num_inputs + output_bytes*num_outputs);
+    std::cout << boost::format("%-36s %-14s %-8s %10d %10.3f %10.3f")
+        % info.markup % priority_name(info.prio) % (info.selected? "yes" : "no") % nsamps
+        % (secs*1e9/total_samps) % (total_bytes/secs/1e9)
+    << std::endl;
+}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    size_t small_nsamps, large_nsamps;
+    double duration;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("small", po::value<size_t>(&small_nsamps)->default_value(2048), "samples per channel for the cache resident run")
+        ("large", po::value<size_t>(&large_nsamps)->default_value(1024*1024), "samples per channel for the DRAM sized run (0 to skip)")
+        ("duration", po::value<double>(&duration)->default_value(0.25), "duration per converter and size in seconds")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Benchmark Convert %s") % desc << std::endl;
+        std::cout <<
+        "    Runs every registered converter implementation over a small and a large buffer.\n"
+        "    The selected column marks the implementation that devices will use.\n"
+        "    Results are in ns per sample and GB/s of memory traffic (in + out).\n"
+        << std::endl;
+        return ~0;
+    }
+
+    std::vector<size_t> sizes;
+    if (small_nsamps != 0) sizes.push_back(small_nsamps);
+    if (large_nsamps != 0) sizes.push_back(large_nsamps);
+
+    std::cout << boost::format("%-36s %-14s %-8s %10s %10s %10s")
+        % "converter" % "priority" % "selected" % "nsamps" % "ns/samp" % "GB/s"
+    << std::endl;
+
+    const uhd::convert::converter_infos_t infos = uhd::convert::get_converter_infos();
+    for (size_t s = 0; s < sizes.size(); s++){
+        for (size_t i = 0; i < infos.size(); i++){
+            benchmark_converter(infos[i], sizes[s], duration);
+        }
+    }
+
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+    return 0;
+}
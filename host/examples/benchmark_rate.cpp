@@ -17,11 +17,11 @@
 
 #include <uhd/utils/thread_priority.hpp>
 #include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/sample_buffer.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <boost/program_options.hpp>
 #include <boost/format.hpp>
 #include <boost/thread/thread.hpp>
-#include <boost/math/special_functions/round.hpp>
 #include <iostream>
 #include <complex>
 
@@ -51,31 +51,24 @@ void benchmark_rx_rate(uhd::usrp::multi_usrp::sptr usrp){
     //setup variables and allocate buffer
     uhd::rx_metadata_t md;
     const size_t max_samps_per_packet = usrp->get_device()->get_max_recv_samps_per_packet();
-    std::vector<std::complex<float> > buff(max_samps_per_packet);
-    bool had_an_overflow = false;
-    uhd::time_spec_t last_time;
-    const double rate = usrp->get_rx_rate();
+    boost::shared_ptr<std::complex<float> > buff = uhd::alloc_sample_buffer<std::complex<float> >(max_samps_per_packet);
 
     usrp->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
     while (not boost::this_thread::interruption_requested()){
         num_rx_samps += usrp->get_device()->recv(
-            &buff.front(), buff.size(), md,
+            buff.get(), max_samps_per_packet, md,
             uhd::io_type_t::COMPLEX_FLOAT32,
             uhd::device::RECV_MODE_ONE_PACKET
         );
 
-        //handle the error codes
+        //handle the error codes,
+        //the samples after an overflow carry the number of samples lost
         switch(md.error_code){
         case uhd::rx_metadata_t::ERROR_CODE_NONE:
-            if (had_an_overflow){
-                had_an_overflow = false;
-                num_dropped_samps += boost::math::iround((md.time_spec - last_time).get_real_secs()*rate);
-            }
+            num_dropped_samps += md.num_samps_lost;
             break;
 
         case uhd::rx_metadata_t::ERROR_CODE_OVERFLOW:
-            had_an_overflow = true;
-            last_time = md.time_spec;
             num_overflows++;
             break;
 
@@ -104,11 +97,11 @@ void benchmark_tx_rate(uhd::usrp::multi_usrp::sptr usrp){
     uhd::tx_metadata_t md;
     md.has_time_spec = false;
     const size_t max_samps_per_packet = usrp->get_device()->get_max_send_samps_per_packet();
-    std::vector<std::complex<float> > buff(max_samps_per_packet);
+    boost::shared_ptr<std::complex<float> > buff = uhd::alloc_sample_buffer<std::complex<float> >(max_samps_per_packet);
 
     while (not boost::this_thread::interruption_requested()){
         num_tx_samps += usrp->get_device()->send(
-            &buff.front(), buff.size(), md,
+            buff.get(), max_samps_per_packet, md,
             uhd::io_type_t::COMPLEX_FLOAT32,
             uhd::device::SEND_MODE_ONE_PACKET
         );
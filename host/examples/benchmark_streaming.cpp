@@ -0,0 +1,402 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/math/special_functions/round.hpp>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <complex>
+#include <cmath>
+
+namespace po = boost::program_options;
+
+/***********************************************************************
+ * One point of the sweep and its measurements
+ **********************************************************************/
+struct bench_point_t{
+    std::string direction; //rx or tx
+    double rate;
+    std::string subdev;    //empty for the device default
+    std::string type;      //fc32, fc64, or sc16
+    std::string mode;      //one_packet or full_buff
+    size_t spb;            //0 for one packet worth
+};
+
+struct bench_result_t{
+    bench_point_t point;
+    double actual_rate;
+    size_t num_channels, spb;
+    unsigned long long num_samps, num_calls;
+    unsigned long long num_overflows, num_underflows, num_seq_errors;
+    unsigned long long num_timeouts, num_dropped_samps, num_other_errors;
+    std::vector<double> per_sec_msps;
+    double lat_p50_us, lat_p90_us, lat_p99_us, lat_max_us;
+
+    bench_result_t(void):
+        actual_rate(0), num_channels(0), spb(0), num_samps(0), num_calls(0),
+        num_overflows(0), num_underflows(0), num_seq_errors(0),
+        num_timeouts(0), num_dropped_samps(0), num_other_errors(0),
+        lat_p50_us(0), lat_p90_us(0), lat_p99_us(0), lat_max_us(0)
+    {}
+};
+
+static uhd::io_type_t::tid_t type_to_tid(const std::string &type){
+    if (type == "fc32") return uhd::io_type_t::COMPLEX_FLOAT32;
+    if (type == "fc64") return uhd::io_type_t::COMPLEX_FLOAT64;
+    if (type == "sc16") return uhd::io_type_t::COMPLEX_INT16;
+    throw std::runtime_error("Unknown type " + type);
+}
+
+template <typename T> static std::vector<T> split_list(const std::string &list, const std::string &seps = ","){
+    std::vector<std::string> tokens;
+    boost::split(tokens, list, boost::is_any_of(seps));
+    std::vector<T> values;
+    BOOST_FOREACH(const std::string &token, tokens){
+        values.push_back(boost::lexical_cast<T>(boost::trim_copy(token)));
+    }
+    return values;
+}
+
+/***********************************************************************
+ * Per call accounting shared by the receive and transmit loops
+ **********************************************************************/
+class call_recorder{
+public:
+    call_recorder(double duration):
+        _start(uhd::time_spec_t::get_system_time()), _duration(duration)
+    {
+        _num_samps.resize(size_t(std::ceil(duration)), 0);
+    }
+
+    bool done(void) const{
+        return (uhd::time_spec_t::get_system_time() - _start).get_real_secs() >= _duration;
+    }
+
+    void record(const uhd::time_spec_t &call_start, size_t num_samps){
+        const uhd::time_spec_t now = uhd::time_spec_t::get_system_time();
+        _latencies.push_back((now - call_start).get_real_secs()*1e6);
+        const size_t sec = size_t((now - _start).get_real_secs());
+        if (sec < _num_samps.size()) _num_samps[sec] += num_samps;
+    }
+
+    void finish(bench_result_t &result){
+        result.num_calls = _latencies.size();
+        result.per_sec_msps.clear();
+        BOOST_FOREACH(unsigned long long num_samps, _num_samps){
+            result.per_sec_msps.push_back(num_samps/1e6);
+        }
+        if (_latencies.empty()) return;
+        std::sort(_latencies.begin(), _latencies.end());
+        result.lat_p50_us = this->percentile(0.50);
+        result.lat_p90_us = this->percentile(0.90);
+        result.lat_p99_us = this->percentile(0.99);
+        result.lat_max_us = _latencies.back();
+    }
+
+private:
+    double percentile(double p) const{
+        return _latencies[std::min(_latencies.size() - 1, size_t(p*_latencies.size()))];
+    }
+
+    const uhd::time_spec_t _start;
+    const double _duration;
+    std::vector<double> _latencies;
+    std::vector<unsigned long long> _num_samps;
+};
+
+/***********************************************************************
+ * Benchmark one receive point
+ **********************************************************************/
+static void benchmark_rx(uhd::usrp::multi_usrp::sptr usrp, double duration, bench_result_t &result){
+    const uhd::io_type_t io_type(type_to_tid(result.point.type));
+    const uhd::device::recv_mode_t mode = (result.point.mode == "full_buff")?
+        uhd::device::RECV_MODE_FULL_BUFF : uhd::device::RECV_MODE_ONE_PACKET;
+
+    std::vector<std::vector<char> > buffs(result.num_channels, std::vector<char>(result.spb*io_type.size));
+    std::vector<void *> buff_ptrs;
+    for (size_t ch = 0; ch < buffs.size(); ch++) buff_ptrs.push_back(&buffs[ch].front());
+
+    bool had_an_overflow = false;
+    uhd::time_spec_t last_time;
+    uhd::rx_metadata_t md;
+
+    usrp->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    call_recorder recorder(duration);
+    while (not recorder.done()){
+        const uhd::time_spec_t call_start = uhd::time_spec_t::get_system_time();
+        const size_t num_samps = usrp->get_device()->recv(buff_ptrs, result.spb, md, io_type, mode);
+        recorder.record(call_start, num_samps);
+        result.num_samps += num_samps;
+
+        switch(md.error_code){
+        case uhd::rx_metadata_t::ERROR_CODE_NONE:
+            if (had_an_overflow){
+                had_an_overflow = false;
+                result.num_dropped_samps += boost::math::iround((md.time_spec - last_time).get_real_secs()*result.actual_rate);
+            }
+            break;
+
+        case uhd::rx_metadata_t::ERROR_CODE_OVERFLOW:
+            had_an_overflow = true;
+            last_time = md.time_spec;
+            result.num_overflows++;
+            break;
+
+        case uhd::rx_metadata_t::ERROR_CODE_TIMEOUT:
+            result.num_timeouts++;
+            break;
+
+        default:
+            result.num_other_errors++;
+            break;
+        }
+    }
+    usrp->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+    recorder.finish(result);
+
+    //drain the stream so the next point starts clean
+    while (usrp->get_device()->recv(buff_ptrs, result.spb, md, io_type, uhd::device::RECV_MODE_ONE_PACKET) != 0){}
+}
+
+/***********************************************************************
+ * Benchmark one transmit point
+ **********************************************************************/
+static void benchmark_tx_async_helper(uhd::usrp::multi_usrp::sptr usrp, bench_result_t &result){
+    uhd::async_metadata_t async_md;
+    while (not boost::this_thread::interruption_requested()){
+        if (not usrp->get_device()->recv_async_msg(async_md)) continue;
+        switch(async_md.event_code){
+        case uhd::async_metadata_t::EVENT_CODE_BURST_ACK:
+            return;
+
+        case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
+        case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET:
+            result.num_underflows++;
+            break;
+
+        case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR:
+        case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST:
+            result.num_seq_errors++;
+            break;
+
+        default:
+            result.num_other_errors++;
+            break;
+        }
+    }
+}
+
+static void benchmark_tx(uhd::usrp::multi_usrp::sptr usrp, double duration, bench_result_t &result){
+    const uhd::io_type_t io_type(type_to_tid(result.point.type));
+    const uhd::device::send_mode_t mode = (result.point.mode == "full_buff")?
+        uhd::device::SEND_MODE_FULL_BUFF : uhd::device::SEND_MODE_ONE_PACKET;
+
+    std::vector<std::vector<char> > buffs(result.num_channels, std::vector<char>(result.spb*io_type.size));
+    std::vector<const void *> buff_ptrs;
+    for (size_t ch = 0; ch < buffs.size(); ch++) buff_ptrs.push_back(&buffs[ch].front());
+
+    boost::thread async_thread(boost::bind(&benchmark_tx_async_helper, usrp, boost::ref(result)));
+
+    uhd::tx_metadata_t md;
+    md.has_time_spec = false;
+    call_recorder recorder(duration);
+    while (not recorder.done()){
+        const uhd::time_spec_t call_start = uhd::time_spec_t::get_system_time();
+        const size_t num_samps = usrp->get_device()->send(buff_ptrs, result.spb, md, io_type, mode);
+        recorder.record(call_start, num_samps);
+        result.num_samps += num_samps;
+        if (num_samps == 0) result.num_timeouts++;
+    }
+    recorder.finish(result);
+
+    //send a mini EOB packet and wait for the burst ack
+    md.end_of_burst = true;
+    usrp->get_device()->send(buff_ptrs, 0, md, io_type, uhd::device::SEND_MODE_FULL_BUFF);
+    if (not async_thread.timed_join(boost::posix_time::seconds(1))){
+        async_thread.interrupt();
+        async_thread.join();
+    }
+}
+
+/***********************************************************************
+ * Report writers
+ **********************************************************************/
+static void print_result(const bench_result_t &r){
+    std::cout << boost::format(
+        "%s %8.3f Msps %u ch %s %-10s spb %-6u: %8.3f Msps, "
+        "latency p50/p99/max %.1f/%.1f/%.1f us, O %u U %u S %u T %u"
+    ) % r.point.direction % (r.actual_rate/1e6) % r.num_channels % r.point.type % r.point.mode % r.spb
+      % ((r.per_sec_msps.empty())? 0.0 : r.num_samps/1e6/r.per_sec_msps.size())
+      % r.lat_p50_us % r.lat_p99_us % r.lat_max_us
+      % r.num_overflows % r.num_underflows % r.num_seq_errors % r.num_timeouts << std::endl;
+}
+
+static void write_csv(const std::string &file, const std::vector<bench_result_t> &results){
+    std::ofstream out(file.c_str());
+    out << "direction,rate,channels,type,mode,spb,samples,calls,"
+        "lat_p50_us,lat_p90_us,lat_p99_us,lat_max_us,"
+        "overflows,dropped_samples,underflows,seq_errors,timeouts,other_errors,per_sec_msps" << std::endl;
+    BOOST_FOREACH(const bench_result_t &r, results){
+        out << boost::format("%s,%f,%u,%s,%s,%u,%u,%u,%f,%f,%f,%f,%u,%u,%u,%u,%u,%u,")
+            % r.point.direction % r.actual_rate % r.num_channels % r.point.type % r.point.mode % r.spb
+            % r.num_samps % r.num_calls % r.lat_p50_us % r.lat_p90_us % r.lat_p99_us % r.lat_max_us
+            % r.num_overflows % r.num_dropped_samps % r.num_underflows % r.num_seq_errors
+            % r.num_timeouts % r.num_other_errors;
+        for (size_t i = 0; i < r.per_sec_msps.size(); i++){
+            out << ((i == 0)? "" : ";") << r.per_sec_msps[i];
+        }
+        out << std::endl;
+    }
+}
+
+static std::string json_escape(const std::string &str){
+    std::string out;
+    BOOST_FOREACH(char ch, str){
+        if (ch == '"' or ch == '\\') out += '\\';
+        if (ch == '\n') out += "\\n";
+        else out += ch;
+    }
+    return out;
+}
+
+static void write_json(const std::string &file, const std::string &device, const std::vector<bench_result_t> &results){
+    std::ofstream out(file.c_str());
+    out << "{\n  \"device\": \"" << json_escape(device) << "\",\n  \"results\": [";
+    for (size_t n = 0; n < results.size(); n++){
+        const bench_result_t &r = results[n];
+        out << ((n == 0)? "\n" : ",\n") << boost::format(
+            "    {\"direction\": \"%s\", \"rate\": %f, \"channels\": %u, \"type\": \"%s\", \"mode\": \"%s\", \"spb\": %u,\n"
+            "     \"samples\": %u, \"calls\": %u, \"latency_us\": {\"p50\": %f, \"p90\": %f, \"p99\": %f, \"max\": %f},\n"
+            "     \"errors\": {\"overflows\": %u, \"dropped_samples\": %u, \"underflows\": %u, \"seq_errors\": %u, \"timeouts\": %u, \"other\": %u},\n"
+            "     \"per_sec_msps\": ["
+        ) % r.point.direction % r.actual_rate % r.num_channels % r.point.type % r.point.mode % r.spb
+          % r.num_samps % r.num_calls % r.lat_p50_us % r.lat_p90_us % r.lat_p99_us % r.lat_max_us
+          % r.num_overflows % r.num_dropped_samps % r.num_underflows % r.num_seq_errors
+          % r.num_timeouts % r.num_other_errors;
+        for (size_t i = 0; i < r.per_sec_msps.size(); i++){
+            out << ((i == 0)? "" : ", ") << r.per_sec_msps[i];
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+/***********************************************************************
+ * Main code + sweep
+ **********************************************************************/
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    std::string args, rx_rates, tx_rates, subdevs, types, modes, spbs, csv, json;
+    double duration;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "single uhd device address args")
+        ("duration", po::value<double>(&duration)->default_value(5.0), "duration for each test point in seconds")
+        ("rx_rates", po::value<std::string>(&rx_rates), "comma separated receive rates to test (sps)")
+        ("tx_rates", po::value<std::string>(&tx_rates), "comma separated transmit rates to test (sps)")
+        ("subdevs", po::value<std::string>(&subdevs)->default_value(""), "semicolon separated subdevice specs, one per channel count")
+        ("types", po::value<std::string>(&types)->default_value("fc32"), "comma separated sample types: fc32, fc64, sc16")
+        ("modes", po::value<std::string>(&modes)->default_value("one_packet"), "comma separated modes: one_packet, full_buff")
+        ("spbs", po::value<std::string>(&spbs)->default_value("0"), "comma separated samples per buffer (0 for one packet)")
+        ("csv", po::value<std::string>(&csv), "write the results to a CSV file")
+        ("json", po::value<std::string>(&json), "write the results to a JSON file")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help") or (vm.count("rx_rates") + vm.count("tx_rates")) == 0){
+        std::cout << boost::format("UHD Benchmark Streaming %s") % desc << std::endl;
+        std::cout <<
+        "    Sweep every combination of the rates, subdevice specs, types, modes, and buffer sizes.\n"
+        "    Ex: --rx_rates=1e6,10e6 --subdevs=\"A:A;A:A A:B\" --types=fc32,sc16 --csv=bench.csv\n"
+        << std::endl;
+        return ~0;
+    }
+
+    //create a usrp device
+    std::cout << std::endl;
+    std::cout << boost::format("Creating the usrp device with: %s...") % args << std::endl;
+    uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(args);
+    std::cout << boost::format("Using Device: %s") % usrp->get_pp_string() << std::endl;
+
+    //build the sweep, rx points first
+    std::vector<bench_point_t> points;
+    for (size_t dir = 0; dir < 2; dir++){
+        const std::string &rates = (dir == 0)? rx_rates : tx_rates;
+        if (rates.empty()) continue;
+        BOOST_FOREACH(double rate, split_list<double>(rates))
+        BOOST_FOREACH(const std::string &subdev, split_list<std::string>(subdevs, ";"))
+        BOOST_FOREACH(const std::string &type, split_list<std::string>(types))
+        BOOST_FOREACH(const std::string &mode, split_list<std::string>(modes))
+        BOOST_FOREACH(size_t spb, split_list<size_t>(spbs)){
+            type_to_tid(type); //check the type before streaming
+            bench_point_t point;
+            point.direction = (dir == 0)? "rx" : "tx";
+            point.rate = rate; point.subdev = subdev;
+            point.type = type; point.mode = mode; point.spb = spb;
+            points.push_back(point);
+        }
+    }
+
+    //run each point
+    std::vector<bench_result_t> results;
+    BOOST_FOREACH(const bench_point_t &point, points){
+        bench_result_t result;
+        result.point = point;
+        if (point.direction == "rx"){
+            if (not point.subdev.empty()) usrp->set_rx_subdev_spec(point.subdev);
+            usrp->set_rx_rate(point.rate);
+            result.actual_rate = usrp->get_rx_rate();
+            result.num_channels = usrp->get_rx_num_channels();
+            result.spb = (point.spb == 0)? usrp->get_device()->get_max_recv_samps_per_packet() : point.spb;
+            benchmark_rx(usrp, duration, result);
+        }
+        else{
+            if (not point.subdev.empty()) usrp->set_tx_subdev_spec(point.subdev);
+            usrp->set_tx_rate(point.rate);
+            result.actual_rate = usrp->get_tx_rate();
+            result.num_channels = usrp->get_tx_num_channels();
+            result.spb = (point.spb == 0)? usrp->get_device()->get_max_send_samps_per_packet() : point.spb;
+            benchmark_tx(usrp, duration, result);
+        }
+        print_result(result);
+        results.push_back(result);
+    }
+
+    if (vm.count("csv")) write_csv(csv, results);
+    if (vm.count("json")) write_json(json, usrp->get_pp_string(), results);
+
+    //finished
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+
+    return 0;
+}
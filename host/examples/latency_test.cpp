@@ -14,36 +14,236 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
-
 #include <uhd/utils/thread_priority.hpp>
 #include <uhd/utils/safe_main.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 #include <complex>
+#include <cmath>
 
 namespace po = boost::program_options;
 
+/***********************************************************************
+ * Results of a series of runs at one rtt
+ **********************************************************************/
+struct run_results_t{
+    int ack, underflow, time_error, other, timeout;
+    //device time of the tx commit minus the rx timestamp, in seconds
+    std::vector<double> latencies;
+
+    run_results_t(void): ack(0), underflow(0), time_error(0), other(0), timeout(0){}
+
+    bool all_on_time(void) const{
+        return underflow == 0 and time_error == 0 and other == 0 and timeout == 0;
+    }
+};
+
+/***********************************************************************
+ * Map the host clock to the device clock:
+ * Bracket a device time read with host time reads,
+ * and keep the offset from the fastest of several reads.
+ **********************************************************************/
+static uhd::time_spec_t get_device_time_offset(uhd::usrp::multi_usrp::sptr usrp){
+    uhd::time_spec_t offset, best_span(1.0);
+    for (size_t i = 0; i < 10; i++){
+        const uhd::time_spec_t before = uhd::time_spec_t::get_system_time();
+        const uhd::time_spec_t device = usrp->get_time_now();
+        const uhd::time_spec_t after = uhd::time_spec_t::get_system_time();
+        if (after - before > best_span) continue;
+        best_span = after - before;
+        offset = device - (before + uhd::time_spec_t(best_span.get_real_secs()/2));
+    }
+    return offset;
+}
+
+/***********************************************************************
+ * One run: receive a packet at time t, send a packet at time t + rtt
+ **********************************************************************/
+static void run_once(
+    uhd::usrp::multi_usrp::sptr usrp,
+    std::vector<std::complex<float> > &buffer,
+    double rtt, const uhd::time_spec_t &offset,
+    bool verbose, run_results_t &results
+){
+    /***************************************************************
+     * Issue a stream command some time in the near future
+     **************************************************************/
+    uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    stream_cmd.num_samps = buffer.size();
+    stream_cmd.stream_now = false;
+    stream_cmd.time_spec = usrp->get_time_now() + uhd::time_spec_t(0.01);
+    usrp->issue_stream_cmd(stream_cmd);
+
+    /***************************************************************
+     * Receive the requested packet
+     **************************************************************/
+    uhd::rx_metadata_t rx_md;
+    size_t num_rx_samps = usrp->get_device()->recv(
+        &buffer.front(), buffer.size(), rx_md,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::RECV_MODE_FULL_BUFF
+    );
+
+    if(verbose) std::cout << boost::format("Got packet: %u samples, %u full secs, %f frac secs")
+        % num_rx_samps % rx_md.time_spec.get_full_secs() % rx_md.time_spec.get_frac_secs() << std::endl;
+
+    /***************************************************************
+     * Transmit a packet with delta time after received packet
+     **************************************************************/
+    uhd::tx_metadata_t tx_md;
+    tx_md.start_of_burst = true;
+    tx_md.end_of_burst = true;
+    tx_md.has_time_spec = true;
+    tx_md.time_spec = rx_md.time_spec + uhd::time_spec_t(rtt);
+    size_t num_tx_samps = usrp->get_device()->send(
+        &buffer.front(), buffer.size(), tx_md,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_FULL_BUFF
+    );
+    const uhd::time_spec_t commit_time = uhd::time_spec_t::get_system_time() + offset;
+    results.latencies.push_back((commit_time - rx_md.time_spec).get_real_secs());
+    if(verbose) std::cout << boost::format("Sent %d samples") % num_tx_samps << std::endl;
+
+    /***************************************************************
+     * Check the async messages for result
+     **************************************************************/
+    uhd::async_metadata_t async_md;
+    if (not usrp->get_device()->recv_async_msg(async_md)){
+        std::cout << boost::format("failed:\n    Async message recv timed out.\n") << std::endl;
+        results.timeout++;
+        return;
+    }
+    switch(async_md.event_code){
+    case uhd::async_metadata_t::EVENT_CODE_TIME_ERROR:
+        results.time_error++;
+        break;
+
+    case uhd::async_metadata_t::EVENT_CODE_BURST_ACK:
+        results.ack++;
+        break;
+
+    case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
+        results.underflow++;
+        break;
+
+    default:
+        std::cerr << boost::format(
+            "failed:\n    Got unexpected event code 0x%x.\n"
+        ) % async_md.event_code << std::endl;
+        results.other++;
+        break;
+    }
+}
+
+static run_results_t run_many(
+    uhd::usrp::multi_usrp::sptr usrp,
+    std::vector<std::complex<float> > &buffer,
+    double rtt, size_t nruns, bool verbose
+){
+    const uhd::time_spec_t offset = get_device_time_offset(usrp);
+    run_results_t results;
+    for(size_t nrun = 0; nrun < nruns; nrun++){
+        run_once(usrp, buffer, rtt, offset, verbose, results);
+    }
+    return results;
+}
+
+/***********************************************************************
+ * Binary search for the smallest rtt where every run is on time
+ **********************************************************************/
+static double search_min_rtt(
+    uhd::usrp::multi_usrp::sptr usrp,
+    std::vector<std::complex<float> > &buffer,
+    double rtt, double resolution, size_t nruns
+){
+    //grow the upper bound until it passes
+    double hi = std::max(rtt, resolution);
+    while (not run_many(usrp, buffer, hi, nruns, false).all_on_time()){
+        std::cout << boost::format("  rtt %.1f us: late") % (hi*1e6) << std::endl;
+        hi *= 2;
+        if (hi > 1.0) throw std::runtime_error("no rtt under one second was on time");
+    }
+
+    double lo = 0.0;
+    while (hi - lo > resolution){
+        const double mid = (lo + hi)/2;
+        const bool pass = run_many(usrp, buffer, mid, nruns, false).all_on_time();
+        std::cout << boost::format("  rtt %.1f us: %s") % (mid*1e6) % ((pass)? "on time" : "late") << std::endl;
+        if (pass) hi = mid; else lo = mid;
+    }
+    return hi;
+}
+
+/***********************************************************************
+ * Latency report
+ **********************************************************************/
+static double percentile(const std::vector<double> &sorted, double p){
+    return sorted[std::min(sorted.size() - 1, size_t(p*sorted.size()))];
+}
+
+static void print_histogram(const std::vector<double> &sorted, double bin){
+    const double first = std::floor(sorted.front()/bin)*bin;
+    size_t i = 0, peak = 1;
+    std::vector<size_t> counts;
+    while (i < sorted.size()){
+        size_t count = 0;
+        const double edge = first + bin*(counts.size() + 1);
+        for (; i < sorted.size() and sorted[i] < edge; i++) count++;
+        counts.push_back(count);
+        peak = std::max(peak, count);
+    }
+    for (size_t n = 0; n < counts.size(); n++){
+        if (counts[n] == 0) continue;
+        std::cout << boost::format("  %9.1f us %7u %s")
+            % ((first + bin*n)*1e6) % counts[n] % std::string((counts[n]*50 + peak - 1)/peak, '#') << std::endl;
+    }
+}
+
+static void print_report(const std::string &args, double rtt, const run_results_t &results, double bin){
+    std::cout << boost::format("\nACK %d, UNDERFLOW %d, TIME_ERR %d, other %d, timeout %d")
+        % results.ack % results.underflow % results.time_error % results.other % results.timeout << std::endl;
+    if (results.latencies.empty()) return;
+
+    std::vector<double> sorted(results.latencies);
+    std::sort(sorted.begin(), sorted.end());
+    std::cout << boost::format(
+        "Commit latency for \"%s\" at rtt %.1f us:\n"
+        "  min %.1f us, p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us"
+    ) % args % (rtt*1e6) % (sorted.front()*1e6) % (percentile(sorted, 0.5)*1e6)
+      % (percentile(sorted, 0.99)*1e6) % (percentile(sorted, 0.999)*1e6) % (sorted.back()*1e6) << std::endl;
+    if (bin > 0) print_histogram(sorted, bin);
+}
+
 int UHD_SAFE_MAIN(int argc, char *argv[]){
     uhd::set_thread_priority_safe();
 
     //variables to be set by po
-    std::string args;
+    std::string args, csv;
     size_t nsamps;
     double rate;
-    double rtt;
-    size_t nruns;
+    double rtt, resolution, bin_us;
+    size_t nruns, search_runs;
 
     //setup the program options
     po::options_description desc("Allowed options");
     desc.add_options()
         ("help", "help message")
-        ("args",   po::value<std::string>(&args)->default_value(""), "single uhd device address args")
+        ("args",   po::value<std::string>(&args)->default_value(""), "single uhd device address args, separate several with ; to compare them")
         ("nsamps", po::value<size_t>(&nsamps)->default_value(100),   "number of samples per run")
         ("nruns",  po::value<size_t>(&nruns)->default_value(1000),   "number of tests to perform")
         ("rtt",    po::value<double>(&rtt)->default_value(0.001),    "delay between receive and transmit (seconds)")
         ("rate",   po::value<double>(&rate)->default_value(100e6/4), "sample rate for receive and transmit (sps)")
+        ("search", "binary search the minimum on time rtt before measuring at it")
+        ("search_runs", po::value<size_t>(&search_runs)->default_value(100), "number of tests per search step")
+        ("resolution", po::value<double>(&resolution)->default_value(10e-6), "rtt search resolution (seconds)")
+        ("bin", po::value<double>(&bin_us)->default_value(0), "histogram bin width in us (0 for no histogram)")
+        ("csv", po::value<std::string>(&csv), "write every commit latency to a CSV file")
         ("verbose", "specify to enable inner-loop verbose")
     ;
     po::variables_map vm;
@@ -58,110 +258,71 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         "    and tries to send a packet at time t + rtt,\n"
         "    where rtt is the round trip time sample time\n"
         "    from device to host and back to the device.\n"
+        "    The commit latency is the device time when send() returns,\n"
+        "    minus the time stamp of the received packet.\n"
         << std::endl;
         return ~0;
     }
 
     bool verbose = vm.count("verbose") != 0;
+    std::ofstream csv_file;
+    if (vm.count("csv")){
+        csv_file.open(csv.c_str());
+        csv_file << "args,rtt_us,run,latency_us" << std::endl;
+    }
 
-    //create a usrp device
-    std::cout << std::endl;
-    //std::cout << boost::format("Creating the usrp device with: %s...") % args << std::endl;
-    uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(args);
-    //std::cout << boost::format("Using Device: %s") % usrp->get_pp_string() << std::endl;
-
-    usrp->set_time_now(uhd::time_spec_t(0.0));
+    std::vector<std::string> configs;
+    boost::split(configs, args, boost::is_any_of(";"));
+    std::vector<std::string> summary;
 
-    //set the tx sample rate
-    usrp->set_tx_rate(rate);
-    std::cout << boost::format("Actual TX Rate: %f Msps...") % (usrp->get_tx_rate()/1e6) << std::endl;
+    BOOST_FOREACH(const std::string &config, configs){
+        //create a usrp device
+        std::cout << std::endl;
+        std::cout << boost::format("Creating the usrp device with: %s...") % config << std::endl;
+        uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(config);
 
-    //set the rx sample rate
-    usrp->set_rx_rate(rate);
-    std::cout << boost::format("Actual RX Rate: %f Msps...") % (usrp->get_rx_rate()/1e6) << std::endl;
+        usrp->set_time_now(uhd::time_spec_t(0.0));
 
-    //allocate a buffer to use
-    std::vector<std::complex<float> > buffer(nsamps);
+        //set the tx sample rate
+        usrp->set_tx_rate(rate);
+        std::cout << boost::format("Actual TX Rate: %f Msps...") % (usrp->get_tx_rate()/1e6) << std::endl;
 
-    //initialize result counts
-    int time_error = 0;
-    int ack = 0;
-    int underflow = 0;
-    int other = 0;
+        //set the rx sample rate
+        usrp->set_rx_rate(rate);
+        std::cout << boost::format("Actual RX Rate: %f Msps...") % (usrp->get_rx_rate()/1e6) << std::endl;
 
-    for(size_t nrun = 0; nrun < nruns; nrun++){
+        //allocate a buffer to use
+        std::vector<std::complex<float> > buffer(nsamps);
 
-        /***************************************************************
-         * Issue a stream command some time in the near future
-         **************************************************************/
-        uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
-        stream_cmd.num_samps = buffer.size();
-        stream_cmd.stream_now = false;
-        stream_cmd.time_spec = usrp->get_time_now() + uhd::time_spec_t(0.01);
-        usrp->issue_stream_cmd(stream_cmd);
-
-        /***************************************************************
-         * Receive the requested packet
-         **************************************************************/
-        uhd::rx_metadata_t rx_md;
-        size_t num_rx_samps = usrp->get_device()->recv(
-            &buffer.front(), buffer.size(), rx_md,
-            uhd::io_type_t::COMPLEX_FLOAT32,
-            uhd::device::RECV_MODE_FULL_BUFF
-        );
-
-        if(verbose) std::cout << boost::format("Got packet: %u samples, %u full secs, %f frac secs")
-            % num_rx_samps % rx_md.time_spec.get_full_secs() % rx_md.time_spec.get_frac_secs() << std::endl;
-
-        /***************************************************************
-         * Transmit a packet with delta time after received packet
-         **************************************************************/
-        uhd::tx_metadata_t tx_md;
-        tx_md.start_of_burst = true;
-        tx_md.end_of_burst = true;
-        tx_md.has_time_spec = true;
-        tx_md.time_spec = rx_md.time_spec + uhd::time_spec_t(rtt);
-        size_t num_tx_samps = usrp->get_device()->send(
-            &buffer.front(), buffer.size(), tx_md,
-            uhd::io_type_t::COMPLEX_FLOAT32,
-            uhd::device::SEND_MODE_FULL_BUFF
-        );
-        if(verbose) std::cout << boost::format("Sent %d samples") % num_tx_samps << std::endl;
-
-        /***************************************************************
-         * Check the async messages for result
-         **************************************************************/
-        uhd::async_metadata_t async_md;
-        if (not usrp->get_device()->recv_async_msg(async_md)){
-            std::cout << boost::format("failed:\n    Async message recv timed out.\n") << std::endl;
-            continue;
+        double test_rtt = rtt;
+        if (vm.count("search")){
+            std::cout << "Searching for the minimum rtt..." << std::endl;
+            test_rtt = search_min_rtt(usrp, buffer, rtt, resolution, search_runs);
+            std::cout << boost::format("Minimum on time rtt: %.1f us") % (test_rtt*1e6) << std::endl;
         }
-        switch(async_md.event_code){
-        case uhd::async_metadata_t::EVENT_CODE_TIME_ERROR:
-            time_error++;
-            break;
-
-        case uhd::async_metadata_t::EVENT_CODE_BURST_ACK:
-            ack++;
-            break;
-
-        case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
-            underflow++;
-            break;
-
-        default:
-            std::cerr << boost::format(
-                "failed:\n    Got unexpected event code 0x%x.\n"
-            ) % async_md.event_code << std::endl;
-            other++;
-            break;
+
+        const run_results_t results = run_many(usrp, buffer, test_rtt, nruns, verbose);
+        print_report(config, test_rtt, results, bin_us*1e-6);
+
+        for (size_t i = 0; i < results.latencies.size(); i++){
+            if (csv_file.is_open()) csv_file << boost::format("\"%s\",%f,%u,%f")
+                % config % (test_rtt*1e6) % i % (results.latencies[i]*1e6) << std::endl;
         }
+        std::vector<double> sorted(results.latencies);
+        std::sort(sorted.begin(), sorted.end());
+        if (not sorted.empty()) summary.push_back(str(boost::format(
+            "  %-40s rtt %8.1f us, p50 %8.1f us, p99 %8.1f us, p99.9 %8.1f us, late %d"
+        ) % ("\"" + config + "\"") % (test_rtt*1e6) % (percentile(sorted, 0.5)*1e6)
+          % (percentile(sorted, 0.99)*1e6) % (percentile(sorted, 0.999)*1e6)
+          % (nruns - results.ack)));
     }
 
     /***************************************************************
-     * Print the summary
+     * Print the comparison
      **************************************************************/
-    std::cout << boost::format("\nACK %d, UNDERFLOW %d, TIME_ERR %d, other %d")
-        % ack % underflow % time_error % other << std::endl;
+    if (configs.size() > 1){
+        std::cout << std::endl << "Comparison:" << std::endl;
+        BOOST_FOREACH(const std::string &line, summary) std::cout << line << std::endl;
+    }
     return 0;
 }
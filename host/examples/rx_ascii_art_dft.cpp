@@ -33,7 +33,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
 
     //variables to be set by po
     std::string args, ant, subdev, ref;
-    size_t num_bins;
+    size_t num_bins, num_avg;
     double rate, freq, gain, bw, frame_rate;
     float ref_lvl, dyn_rng;
 
@@ -52,6 +52,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         // display parameters
         ("num-bins", po::value<size_t>(&num_bins)->default_value(512), "the number of bins in the DFT")
         ("frame-rate", po::value<double>(&frame_rate)->default_value(5), "frame rate of the display (fps)")
+        ("avg", po::value<size_t>(&num_avg)->default_value(1), "the number of DFTs to average per frame")
         ("ref-lvl", po::value<float>(&ref_lvl)->default_value(0), "reference level for the display (dB)")
         ("dyn-rng", po::value<float>(&dyn_rng)->default_value(60), "dynamic range for the display (dB)")
         ("ref", po::value<std::string>(&ref)->default_value("INTERNAL"), "waveform type (INTERNAL, EXTERNAL, MIMO)")
@@ -150,6 +151,11 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     //allocate recv buffer and metatdata
     uhd::rx_metadata_t md;
     std::vector<std::complex<float> > buff(num_bins);
+
+    //the dft tables and buffers are made once and reused every frame
+    acsii_art_dft::log_pwr_dft_engine<float> dft_engine(num_bins);
+    acsii_art_dft::log_pwr_dft_type lpdft;
+    num_avg = std::max<size_t>(num_avg, 1);
     //------------------------------------------------------------------
     //-- Initialize
     //------------------------------------------------------------------
@@ -169,14 +175,15 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         );
         if (num_rx_samps != buff.size()) continue;
 
+        //average up to num_avg dfts of the buffers between refreshes
+        if (dft_engine.get_num_averaged() < num_avg) dft_engine.update(&buff.front());
+
         //check and update the display refresh condition
         if (boost::get_system_time() < next_refresh) continue;
         next_refresh = boost::get_system_time() + boost::posix_time::microseconds(long(1e6/frame_rate));
 
-        //calculate the dft and create the ascii art frame
-        acsii_art_dft::log_pwr_dft_type lpdft(
-            acsii_art_dft::log_pwr_dft(&buff.front(), num_rx_samps)
-        );
+        //read the averaged dft and create the ascii art frame
+        dft_engine.read(lpdft);
         std::string frame = acsii_art_dft::dft_to_plot(
             lpdft, COLS, LINES,
             usrp->get_rx_rate(),
@@ -15,24 +15,186 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "../utils/rx_recorder_engine.hpp"
 #include <uhd/utils/thread_priority.hpp>
 #include <uhd/utils/safe_main.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
 #include <boost/thread.hpp>
 #include <iostream>
 #include <complex>
+#include <csignal>
 
 namespace po = boost::program_options;
 
+static bool stop_signal_called = false;
+void sig_int_handler(int){stop_signal_called = true;}
+
+/***********************************************************************
+ * Threaded capture:
+ * One device and one receive thread per motherboard, each recording
+ * its channels through the recorder engine to files of its own.
+ * The threads share nothing, so the capture scales with the cores.
+ **********************************************************************/
+struct mboard_capture_t{
+    uhd::usrp::multi_usrp::sptr usrp;
+    boost::shared_ptr<block_recorder> recorder;
+    std::vector<size_t> cpus;
+    boost::system_time end_time;
+};
+
+static void capture_loop(mboard_capture_t &capture, size_t total_num_samps, double delay){
+    uhd::set_thread_priority_safe();
+    if (not capture.cpus.empty()) uhd::set_thread_affinity_safe(capture.cpus);
+    capture.recorder->set_start_delay(delay);
+    capture.recorder->run(total_num_samps);
+    capture.end_time = boost::get_system_time();
+}
+
+static std::string mboard_file_name(const std::string &file, size_t num_mboards, size_t mb){
+    if (num_mboards == 1) return file;
+    const size_t dot = file.find_last_of('.');
+    const std::string ext = (dot == std::string::npos)? "" : file.substr(dot);
+    return str(boost::format("%s.mb%u%s") % file.substr(0, file.size() - ext.size()) % mb % ext);
+}
+
+static int capture_threaded(
+    const std::string &args, const std::string &subdev, const std::string &sync, const std::string &cpus,
+    const std::string &file, const std::string &type, bool direct,
+    double rate, double seconds_in_future, size_t total_num_samps, size_t spb, size_t num_blocks
+){
+    //one device per motherboard, so that each one has a receive path of its own
+    std::vector<mboard_capture_t> captures;
+    BOOST_FOREACH(const uhd::device_addr_t &dev_addr, uhd::separate_device_addr(uhd::device_addr_t(args))){
+        mboard_capture_t capture;
+        std::cout << boost::format("Creating the usrp device with: %s...") % dev_addr.to_string() << std::endl;
+        capture.usrp = uhd::usrp::multi_usrp::make(dev_addr);
+        if (not subdev.empty()) capture.usrp->set_rx_subdev_spec(subdev);
+        capture.usrp->set_rx_rate(rate);
+        captures.push_back(capture);
+    }
+    const size_t num_mboards = captures.size();
+    const double actual_rate = captures.front().usrp->get_rx_rate();
+    std::cout << boost::format("Actual RX Rate: %f Msps...") % (actual_rate/1e6) << std::endl << std::endl;
+
+    //the cpus of each thread: a comma separated list of cpu sets, used round robin
+    std::vector<std::string> cpu_sets;
+    if (not cpus.empty()) boost::split(cpu_sets, cpus, boost::is_any_of(","));
+    for (size_t mb = 0; mb < num_mboards and not cpu_sets.empty(); mb++){
+        captures[mb].cpus = uhd::cpus_from_string(cpu_sets[mb % cpu_sets.size()]);
+    }
+
+    //the devices are separate: set the same time on all of them
+    std::cout << boost::format("Setting device timestamps to 0...") << std::endl;
+    if (sync == "now"){
+        //not a true time lock, the devices are off by the setup time between them
+        BOOST_FOREACH(mboard_capture_t &capture, captures) capture.usrp->set_time_now(uhd::time_spec_t(0.0));
+    }
+    else if (sync == "pps"){
+        //wait for a pps edge, then latch the time on the next one on every device
+        const uhd::time_spec_t last_pps = captures.front().usrp->get_time_last_pps();
+        while (last_pps == captures.front().usrp->get_time_last_pps()){
+            boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+        }
+        BOOST_FOREACH(mboard_capture_t &capture, captures) capture.usrp->set_time_next_pps(uhd::time_spec_t(0.0));
+        boost::this_thread::sleep(boost::posix_time::seconds(1)); //wait for pps sync pulse
+    }
+    else if (sync == "mimo"){
+        UHD_ASSERT_THROW(num_mboards == 2);
+
+        //make mboard 1 a slave over the MIMO Cable
+        uhd::clock_config_t clock_config;
+        clock_config.ref_source = uhd::clock_config_t::REF_MIMO;
+        clock_config.pps_source = uhd::clock_config_t::PPS_MIMO;
+        captures[1].usrp->set_clock_config(clock_config, 0);
+
+        //set time on the master (mboard 0)
+        captures[0].usrp->set_time_now(uhd::time_spec_t(0.0), 0);
+
+        //sleep a bit while the slave locks its time to the master
+        boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    }
+
+    //the recorders, each one writes a file per channel of its motherboard
+    for (size_t mb = 0; mb < num_mboards; mb++){
+        const size_t num_chans = captures[mb].usrp->get_rx_num_channels();
+        const std::string mb_file = mboard_file_name(file, num_mboards, mb);
+        captures[mb].recorder.reset(new block_recorder(
+            captures[mb].usrp->get_device(), type, actual_rate, num_chans,
+            mb_file, spb, num_blocks, direct, stop_signal_called
+        ));
+        std::cout << boost::format("Mboard %u: %u channels to %s%s")
+            % mb % num_chans % mb_file % ((captures[mb].recorder->get_file(0)->is_direct())? " (direct I/O)" : "") << std::endl;
+    }
+
+    //all motherboards start at the same device time
+    std::cout << std::endl << boost::format(
+        "Begin streaming %u samples, %f seconds in the future..."
+    ) % total_num_samps % seconds_in_future << std::endl;
+    uhd::stream_cmd_t stream_cmd((total_num_samps == 0)?
+        uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS:
+        uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE
+    );
+    stream_cmd.num_samps = total_num_samps;
+    stream_cmd.stream_now = false;
+    stream_cmd.time_spec = uhd::time_spec_t(seconds_in_future);
+    const uhd::time_spec_t start_time = captures.front().usrp->get_time_now();
+    BOOST_FOREACH(mboard_capture_t &capture, captures) capture.usrp->issue_stream_cmd(stream_cmd);
+    const boost::system_time stream_time = boost::get_system_time() +
+        boost::posix_time::microseconds(long((seconds_in_future - start_time.get_real_secs())*1e6));
+    std::signal(SIGINT, &sig_int_handler);
+    if (total_num_samps == 0) std::cout << "Press Ctrl + C to stop streaming..." << std::endl;
+
+    boost::thread_group threads;
+    BOOST_FOREACH(mboard_capture_t &capture, captures){
+        threads.create_thread(boost::bind(&capture_loop, boost::ref(capture), total_num_samps, seconds_in_future));
+    }
+    threads.join_all();
+    if (total_num_samps == 0){
+        BOOST_FOREACH(mboard_capture_t &capture, captures){
+            capture.usrp->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+        }
+    }
+
+    //report the throughput of each motherboard and the aggregate
+    std::cout << std::endl;
+    double aggregate_rate = 0;
+    size_t num_aligned = 0;
+    for (size_t mb = 0; mb < num_mboards; mb++){
+        const recorder_stats_t &stats = captures[mb].recorder->get_stats();
+        const size_t num_chans = captures[mb].usrp->get_rx_num_channels();
+        const size_t num_samps = stats.num_written_bytes/captures[mb].recorder->get_item_size();
+        const double secs = std::max(1e-6, (captures[mb].end_time - stream_time).total_microseconds()/1e6);
+        const bool aligned = stats.has_first_time and stats.first_time == stream_cmd.time_spec and
+            stats.num_overflows == 0 and stats.num_drops == 0;
+        aggregate_rate += num_chans*num_samps/secs;
+        if (aligned) num_aligned++;
+        std::cout << boost::format(
+            "Mboard %u: %u samples per channel, %f Msps per channel, first sample at %f secs\n"
+            "    overflows: %u, timeouts: %u, dropped buffers: %u, peak buffers waiting on disk: %u of %u\n"
+            "    %s"
+        ) % mb % num_samps % (num_samps/secs/1e6) % stats.first_time.get_real_secs()
+          % stats.num_overflows % stats.num_timeouts % stats.num_drops % stats.max_pending_blocks % num_blocks
+          % ((aligned)? "aligned" : "NOT aligned: the first sample is late or samples were lost") << std::endl;
+    }
+    std::cout << std::endl << boost::format(
+        "Aggregate: %f Msps over %u channels on %u threads, %u of %u motherboards aligned"
+    ) % (aggregate_rate/1e6) % (num_mboards*captures.front().usrp->get_rx_num_channels())
+      % num_mboards % num_aligned % num_mboards << std::endl;
+
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+    return (num_aligned == num_mboards)? 0 : 1;
+}
+
 int UHD_SAFE_MAIN(int argc, char *argv[]){
     uhd::set_thread_priority_safe();
 
     //variables to be set by po
-    std::string args, sync, subdev;
+    std::string args, sync, subdev, file, type, cpus;
     double seconds_in_future;
-    size_t total_num_samps;
+    size_t total_num_samps, spb, num_blocks;
     double rate;
 
     //setup the program options
@@ -46,6 +208,13 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("sync", po::value<std::string>(&sync)->default_value("now"), "synchronization method: now, pps, mimo")
         ("subdev", po::value<std::string>(&subdev), "subdev spec (homogeneous across motherboards)")
         ("dilv", "specify to disable inner-loop verbose")
+        ("threaded", "receive each motherboard on a thread of its own and record to files")
+        ("file", po::value<std::string>(&file)->default_value("usrp_samples.dat"), "threaded: the base name of the files, one per motherboard and channel")
+        ("type", po::value<std::string>(&type)->default_value("short"), "threaded: sample type: float, short, or otw (raw items without conversion)")
+        ("spb", po::value<size_t>(&spb)->default_value(1 << 18), "threaded: samples per buffer per channel")
+        ("nbuffs", po::value<size_t>(&num_blocks)->default_value(32), "threaded: number of buffers between receive and disk per motherboard")
+        ("cpus", po::value<std::string>(&cpus)->default_value(""), "threaded: comma separated cpus for the threads, ex: 2,3 or 2-3,4-5")
+        ("buffered", "threaded: use buffered writes instead of direct I/O")
     ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -64,10 +233,22 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         "\n"
         "    Specify --args to select multiple motherboards in a configuration.\n"
         "      Ex: --args=\"addr0=192.168.10.2, addr1=192.168.10.3\"\n"
+        "\n"
+        "    Specify --threaded to make a device per motherboard, each received on its own thread\n"
+        "    and recorded to <file>.mb<n>.ch<n>, then report the sustained throughput and alignment.\n"
+        "    Use --nsamps=0 to stream until Ctrl + C.\n"
         << std::endl;
         return ~0;
     }
 
+    if (vm.count("threaded")){
+        std::cout << std::endl;
+        return capture_threaded(
+            args, (vm.count("subdev"))? subdev : "", sync, cpus, file, type, not vm.count("buffered"),
+            rate, seconds_in_future, total_num_samps, spb, num_blocks
+        );
+    }
+
     bool verbose = vm.count("dilv") == 0;
 
     //create a usrp device
@@ -0,0 +1,85 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/transport/shm_fanout.hpp>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <iostream>
+#include <fstream>
+#include <csignal>
+#include <complex>
+
+namespace po = boost::program_options;
+
+static bool stop_signal_called = false;
+void sig_int_handler(int){stop_signal_called = true;}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    //variables to be set by po
+    std::string name, file;
+    size_t total_num_samps;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("name", po::value<std::string>(&name)->default_value("uhd_rx_samples"), "name of the shared memory ring")
+        ("file", po::value<std::string>(&file)->default_value("usrp_samples.dat"), "name of the file to write binary samples to")
+        ("nsamps", po::value<size_t>(&total_num_samps)->default_value(0), "total number of samples to receive")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD RX samples from shared memory %s") % desc << std::endl
+            << "The samples are published by rx_samples_to_shm --name " << name << std::endl;
+        return ~0;
+    }
+
+    //attach to the ring, this does not touch the device
+    uhd::transport::shm_fanout_reader::sptr reader = uhd::transport::shm_fanout_reader::make(name);
+    std::ofstream outfile(file.c_str(), std::ofstream::binary);
+    std::signal(SIGINT, &sig_int_handler);
+    std::cout << "Press Ctrl + C to stop..." << std::endl;
+
+    size_t num_acc_samps = 0, num_dev_overflows = 0;
+    while(not stop_signal_called and (total_num_samps == 0 or num_acc_samps < total_num_samps)){
+        size_t num_bytes;
+        uhd::rx_metadata_t md;
+        const void *frame = reader->get_frame(num_bytes, md);
+
+        //an overflow from the ring means this consumer fell behind
+        if (frame == NULL) continue;
+        if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW) num_dev_overflows++;
+
+        //write the frame in place, then make sure it was not overwritten meanwhile
+        outfile.write(static_cast<const char *>(frame), num_bytes);
+        if (not reader->frame_valid()) std::cerr << "Frame overwritten while writing" << std::endl;
+        num_acc_samps += num_bytes/sizeof(std::complex<float>);
+    }
+
+    outfile.close();
+    std::cout << boost::format("Received %u samples, %u consumer overflows, %u device overflows")
+        % num_acc_samps % reader->get_num_overflows() % num_dev_overflows << std::endl;
+
+    //finished
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+
+    return 0;
+}
@@ -17,6 +17,7 @@
 
 #include <uhd/utils/thread_priority.hpp>
 #include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/sample_buffer.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <uhd/exception.hpp>
 #include <boost/program_options.hpp>
@@ -39,12 +40,15 @@ template<typename samp_type> void recv_to_file(
     size_t samps_per_buff
 ){
     uhd::rx_metadata_t md;
-    std::vector<samp_type> buff(samps_per_buff);
+    //a page aligned buffer takes the vector paths of the converters
+    boost::shared_ptr<samp_type> buff = uhd::alloc_sample_buffer<samp_type>(
+        samps_per_buff, uhd::SAMPLE_BUFFER_PAGE_ALIGNMENT
+    );
     std::ofstream outfile(file.c_str(), std::ofstream::binary);
 
     while(not stop_signal_called){
         size_t num_rx_samps = usrp->get_device()->recv(
-            &buff.front(), buff.size(), md, io_type,
+            buff.get(), samps_per_buff, md, io_type,
             uhd::device::RECV_MODE_FULL_BUFF
         );
 
@@ -55,7 +59,7 @@ template<typename samp_type> void recv_to_file(
             ) % md.error_code));
         }
 
-        outfile.write((const char*)&buff.front(), num_rx_samps*sizeof(samp_type));
+        outfile.write((const char*)buff.get(), num_rx_samps*sizeof(samp_type));
     }
 
     outfile.close();
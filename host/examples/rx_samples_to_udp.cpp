@@ -19,8 +19,10 @@
 #include <uhd/utils/safe_main.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <uhd/transport/udp_simple.hpp>
+#include <uhd/transport/vrt_relay.hpp>
 #include <uhd/exception.hpp>
 #include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
 #include <boost/thread.hpp>
 #include <iostream>
@@ -28,6 +30,58 @@
 
 namespace po = boost::program_options;
 
+/***********************************************************************
+ * Relay the raw frames:
+ * The VRT frames are forwarded from transport memory, header and all,
+ * so there is no conversion, and the destinations can share a capture.
+ **********************************************************************/
+static void relay_frames(
+    uhd::device::sptr dev, const std::string &addr, const std::string &port, size_t total_num_samps
+){
+    std::vector<std::string> addrs;
+    boost::split(addrs, addr, boost::is_any_of(","));
+    uhd::transport::vrt_relay::sptr relay = uhd::transport::vrt_relay::make(addrs, port);
+
+    size_t num_acc_samps = 0; //number of accumulated samples
+    uhd::device::recv_view_t view;
+    while(num_acc_samps < total_num_samps){
+        const size_t num_rx_samps = dev->recv_view(view);
+
+        //handle the error codes
+        switch(view.metadata.error_code){
+        case uhd::rx_metadata_t::ERROR_CODE_NONE:
+            break;
+
+        case uhd::rx_metadata_t::ERROR_CODE_OVERFLOW:
+            relay->mark_gap(); //the destinations see a sequence error
+            continue;
+
+        case uhd::rx_metadata_t::ERROR_CODE_TIMEOUT:
+            if (num_acc_samps == 0) continue;
+            std::cout << boost::format(
+                "Got timeout before all samples received, possible packet loss, exiting loop..."
+            ) << std::endl;
+            goto done_loop;
+
+        default:
+            std::cout << boost::format(
+                "Got error code 0x%x, exiting loop..."
+            ) % view.metadata.error_code << std::endl;
+            goto done_loop;
+        }
+
+        //the relay holds the frames until they are sent
+        relay->relay(view);
+        view.release();
+
+        num_acc_samps += num_rx_samps;
+    } done_loop:
+
+    relay->flush();
+    std::cout << boost::format("Relayed %u frames to %u destinations, %u datagrams dropped")
+        % relay->get_num_frames() % addrs.size() % relay->get_num_dropped() << std::endl;
+}
+
 int UHD_SAFE_MAIN(int argc, char *argv[]){
     uhd::set_thread_priority_safe();
 
@@ -50,7 +104,8 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("subdev", po::value<std::string>(&subdev), "daughterboard subdevice specification")
         ("bw", po::value<double>(&bw), "daughterboard IF filter bandwidth in Hz")
         ("port", po::value<std::string>(&port)->default_value("7124"), "server udp port")
-        ("addr", po::value<std::string>(&addr)->default_value("192.168.1.10"), "resolvable server address")
+        ("addr", po::value<std::string>(&addr)->default_value("192.168.1.10"), "resolvable server address (comma separated to relay)")
+        ("relay", "relay the raw VRT frames without conversion")
         ("ref", po::value<std::string>(&ref)->default_value("INTERNAL"), "waveform type (INTERNAL, EXTERNAL, MIMO)")
     ;
     po::variables_map vm;
@@ -136,6 +191,12 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     stream_cmd.stream_now = true;
     usrp->issue_stream_cmd(stream_cmd);
 
+    if (vm.count("relay")){
+        relay_frames(usrp->get_device(), addr, port, total_num_samps);
+        std::cout << std::endl << "Done!" << std::endl << std::endl;
+        return 0;
+    }
+
     //loop until total number of samples reached
     size_t num_acc_samps = 0; //number of accumulated samples
     uhd::rx_metadata_t md;
@@ -17,15 +17,25 @@
 
 #include <uhd/utils/thread_priority.hpp>
 #include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/sample_buffer.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <boost/program_options.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/version.hpp>
 #include <boost/format.hpp>
 #include <boost/thread.hpp>
 #include <iostream>
 #include <fstream>
+#include <csignal>
+#include <cstring>
 #include <complex>
 
 namespace po = boost::program_options;
+namespace ipc = boost::interprocess;
+
+static bool stop_signal_called = false;
+void sig_int_handler(int){stop_signal_called = true;}
 
 template<typename samp_type> void send_from_file(
     uhd::usrp::multi_usrp::sptr usrp,
@@ -36,19 +46,21 @@ template<typename samp_type> void send_from_file(
     uhd::tx_metadata_t md;
     md.start_of_burst = false;
     md.end_of_burst = false;
-    std::vector<samp_type> buff(samps_per_buff);
+    boost::shared_ptr<samp_type> buff = uhd::alloc_sample_buffer<samp_type>(
+        samps_per_buff, uhd::SAMPLE_BUFFER_PAGE_ALIGNMENT
+    );
     std::ifstream infile(file.c_str(), std::ifstream::binary);
 
     //loop until the entire file has been read
     while(not md.end_of_burst){
 
-        infile.read((char*)&buff.front(), buff.size()*sizeof(samp_type));
+        infile.read((char*)buff.get(), samps_per_buff*sizeof(samp_type));
         size_t num_tx_samps = infile.gcount()/sizeof(samp_type);
 
         md.end_of_burst = infile.eof();
 
         usrp->get_device()->send(
-            &buff.front(), num_tx_samps, md, io_type,
+            buff.get(), num_tx_samps, md, io_type,
             uhd::device::SEND_MODE_FULL_BUFF
         );
     }
@@ -56,6 +68,81 @@ template<typename samp_type> void send_from_file(
     infile.close();
 }
 
+/***********************************************************************
+ * Memory mapped playback:
+ * The file is sent straight from the page cache, without a read copy.
+ * A looped playback sends the same pages again without re-reading.
+ **********************************************************************/
+static void send_from_memory(
+    uhd::usrp::multi_usrp::sptr usrp,
+    const uhd::io_type_t &io_type,
+    const char *mem, size_t num_samps,
+    size_t samps_per_buff, bool repeat
+){
+    uhd::tx_metadata_t md;
+    md.start_of_burst = false;
+    md.end_of_burst = false;
+
+    size_t offset = 0;
+    while(not md.end_of_burst){
+        const size_t num_tx_samps = std::min(samps_per_buff, num_samps - offset);
+        md.end_of_burst = stop_signal_called or (not repeat and offset + num_tx_samps == num_samps);
+
+        usrp->get_device()->send(
+            mem + offset*io_type.size, num_tx_samps, md, io_type,
+            uhd::device::SEND_MODE_FULL_BUFF
+        );
+
+        offset += num_tx_samps;
+        if (offset == num_samps) offset = 0;
+    }
+}
+
+/***********************************************************************
+ * Otw playback:
+ * The file holds otw items, such as a recording made in the otw type.
+ * Each packet is one copy from the mapping into the transport frame.
+ **********************************************************************/
+static void send_otw_from_memory(
+    uhd::usrp::multi_usrp::sptr usrp,
+    const char *mem, size_t num_bytes, bool repeat
+){
+    uhd::device::send_view_t view;
+    view.metadata.start_of_burst = false;
+    view.metadata.end_of_burst = false;
+
+    size_t offset = 0;
+    while(not view.metadata.end_of_burst){
+        const size_t max_items = usrp->get_device()->get_send_view(view);
+        if (max_items == 0) continue; //timeout
+        const size_t num_bytes_tx = std::min(max_items*view.item_size, num_bytes - offset);
+        view.metadata.end_of_burst = stop_signal_called or (not repeat and offset + num_bytes_tx == num_bytes);
+
+        //every channel plays the same file
+        for (size_t ch = 0; ch < view.payloads.size(); ch++){
+            std::memcpy(view.payloads[ch], mem + offset, num_bytes_tx);
+        }
+        usrp->get_device()->commit_send_view(view, num_bytes_tx/view.item_size);
+
+        offset += num_bytes_tx;
+        if (offset == num_bytes) offset = 0;
+    }
+}
+
+//! Convert the file once to sc16, so a looped playback skips the float conversion
+template<typename samp_type> static void preconvert_to_sc16(
+    const char *mem, size_t num_samps, std::vector<std::complex<short> > &out
+){
+    const samp_type *in = reinterpret_cast<const samp_type *>(mem);
+    out.resize(num_samps);
+    for (size_t i = 0; i < num_samps; i++){
+        out[i] = std::complex<short>(
+            short(std::max(-1.0, std::min(1.0, double(in[i].real())))*32767),
+            short(std::max(-1.0, std::min(1.0, double(in[i].imag())))*32767)
+        );
+    }
+}
+
 int UHD_SAFE_MAIN(int argc, char *argv[]){
     uhd::set_thread_priority_safe();
 
@@ -70,8 +157,11 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("help", "help message")
         ("args", po::value<std::string>(&args)->default_value(""), "multi uhd device address args")
         ("file", po::value<std::string>(&file)->default_value("usrp_samples.dat"), "name of the file to read binary samples from")
-        ("type", po::value<std::string>(&type)->default_value("float"), "sample type: double, float, or short")
+        ("type", po::value<std::string>(&type)->default_value("float"), "sample type: double, float, short, or otw (implies mmap)")
         ("spb", po::value<size_t>(&spb)->default_value(10000), "samples per buffer")
+        ("mmap", "map the file into memory instead of reading it")
+        ("repeat", "loop the file until Ctrl + C (implies mmap)")
+        ("preconvert", "convert a float or double file to sc16 once before playback (implies mmap)")
         ("rate", po::value<double>(&rate), "rate of outgoing samples")
         ("freq", po::value<double>(&freq), "RF center frequency in Hz")
         ("gain", po::value<double>(&gain), "gain for the RF chain")
@@ -171,11 +261,53 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         UHD_ASSERT_THROW(ref_locked.to_bool());
     }
 
+    if (type != "double" and type != "float" and type != "short" and type != "otw"){
+        throw std::runtime_error("Unknown type " + type);
+    }
+    const uhd::io_type_t io_type(
+        (type == "double")? uhd::io_type_t::COMPLEX_FLOAT64 :
+        (type == "short")? uhd::io_type_t::COMPLEX_INT16 :
+        uhd::io_type_t::COMPLEX_FLOAT32 //unused for otw
+    );
+
+    const bool repeat = vm.count("repeat") != 0;
+    if (repeat){
+        std::signal(SIGINT, &sig_int_handler);
+        std::cout << "Press Ctrl + C to stop playback..." << std::endl;
+    }
+
     //send from file
-    if (type == "double") send_from_file<std::complex<double> >(usrp, uhd::io_type_t::COMPLEX_FLOAT64, file, spb);
-    else if (type == "float") send_from_file<std::complex<float> >(usrp, uhd::io_type_t::COMPLEX_FLOAT32, file, spb);
-    else if (type == "short") send_from_file<std::complex<short> >(usrp, uhd::io_type_t::COMPLEX_INT16, file, spb);
-    else throw std::runtime_error("Unknown type " + type);
+    if (not vm.count("mmap") and not repeat and not vm.count("preconvert") and type != "otw"){
+        if (type == "double") send_from_file<std::complex<double> >(usrp, io_type, file, spb);
+        else if (type == "float") send_from_file<std::complex<float> >(usrp, io_type, file, spb);
+        else send_from_file<std::complex<short> >(usrp, io_type, file, spb);
+    }
+
+    //send from the memory mapped file
+    else{
+        ipc::file_mapping mapping(file.c_str(), ipc::read_only);
+        ipc::mapped_region region(mapping, ipc::read_only);
+        const char *mem = static_cast<const char *>(region.get_address());
+        if (region.get_size() < io_type.size) throw std::runtime_error("The file is empty: " + file);
+#if BOOST_VERSION >= 105200
+        //read ahead of the playback, the pages are sent in order
+        region.advise(ipc::mapped_region::advice_sequential);
+        region.advise(ipc::mapped_region::advice_willneed);
+#endif
+
+        if (type == "otw") send_otw_from_memory(usrp, mem, region.get_size(), repeat);
+        else if (vm.count("preconvert") and type != "short"){
+            std::vector<std::complex<short> > sc16;
+            const size_t num_samps = region.get_size()/io_type.size;
+            if (type == "double") preconvert_to_sc16<std::complex<double> >(mem, num_samps, sc16);
+            else preconvert_to_sc16<std::complex<float> >(mem, num_samps, sc16);
+            send_from_memory(
+                usrp, uhd::io_type_t::COMPLEX_INT16,
+                reinterpret_cast<const char *>(&sc16.front()), sc16.size(), spb, repeat
+            );
+        }
+        else send_from_memory(usrp, io_type, mem, region.get_size()/io_type.size, spb, repeat);
+    }
 
     //finished
     std::cout << std::endl << "Done!" << std::endl << std::endl;
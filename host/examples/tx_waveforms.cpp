@@ -20,13 +20,17 @@
 #include <uhd/utils/static.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <uhd/exception.hpp>
+#include <uhd/utils/byteswap.hpp>
 #include <boost/program_options.hpp>
 #include <boost/math/special_functions/round.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <iostream>
 #include <complex>
 #include <csignal>
+#include <cstring>
 #include <cmath>
 
 namespace po = boost::program_options;
@@ -83,6 +87,156 @@ private:
     std::vector<std::complex<float> > _wave_table;
 };
 
+/***********************************************************************
+ * Pre-rendered waveforms:
+ * Each channel is rendered once into a buffer of render_len samples,
+ * which holds a whole number of periods, so the buffer loops seamlessly.
+ * The samples after render_len repeat the start of the buffer,
+ * so any offset into the buffer has a contiguous run of extra samples.
+ **********************************************************************/
+static const size_t render_len = wave_table_len*8;
+
+class wave_render_class{
+public:
+    wave_render_class(const wave_table_class &wave_table, const size_t periods, const size_t extra):
+        _sc16(render_len + extra)
+    {
+        for (size_t n = 0; n < _sc16.size(); n++){
+            const std::complex<float> samp = wave_table(double((boost::uint64_t(n)*periods)%render_len)/render_len);
+            _sc16[n] = std::complex<short>(
+                short(boost::math::iround(samp.real()*32767)),
+                short(boost::math::iround(samp.imag()*32767))
+            );
+        }
+    }
+
+    const std::complex<short> *get_sc16(const size_t offset) const{
+        return &_sc16[offset];
+    }
+
+    //! Pack the samples as sc16 otw items in the byte order of the device
+    void render_otw(const uhd::otw_type_t &otw_type){
+        if (otw_type.width != 16) throw std::runtime_error("otw type: only sc16 on the wire is supported");
+        _otw.resize(_sc16.size());
+        for (size_t n = 0; n < _sc16.size(); n++){
+            const boost::uint32_t item =
+                (boost::uint32_t(boost::uint16_t(_sc16[n].real())) << 16) |
+                (boost::uint32_t(boost::uint16_t(_sc16[n].imag())) << 0);
+            _otw[n] = (otw_type.byteorder == uhd::otw_type_t::BO_BIG_ENDIAN)? uhd::htonx(item) :
+                      (otw_type.byteorder == uhd::otw_type_t::BO_LITTLE_ENDIAN)? uhd::htowx(item) : item;
+        }
+    }
+
+    const boost::uint32_t *get_otw(const size_t offset) const{
+        return &_otw[offset];
+    }
+
+private:
+    std::vector<std::complex<short> > _sc16;
+    std::vector<boost::uint32_t> _otw;
+};
+
+//! Get the value of a channel from a comma separated list, the last value repeats
+static std::string get_chan_value(const std::string &list, const size_t chan){
+    std::vector<std::string> toks;
+    boost::split(toks, list, boost::is_any_of(","));
+    return boost::trim_copy(toks[std::min(chan, toks.size()-1)]);
+}
+
+/***********************************************************************
+ * Streaming loops
+ **********************************************************************/
+//! Generate the float samples for every call (the wave-freq is exact)
+static void send_generated_float(
+    uhd::usrp::multi_usrp::sptr usrp, uhd::tx_metadata_t &md,
+    const std::vector<wave_table_class> &wave_tables, const std::vector<double> &cpss, const size_t spb
+){
+    //allocate a buffer for each channel
+    const size_t num_chans = wave_tables.size();
+    std::vector<std::vector<std::complex<float> > > buffs(num_chans, std::vector<std::complex<float> >(spb));
+    std::vector<std::complex<float> *> buff_ptrs;
+    for (size_t ch = 0; ch < num_chans; ch++) buff_ptrs.push_back(&buffs[ch].front());
+    std::vector<double> thetas(num_chans, 0.0);
+
+    //send data until the signal handler gets called
+    while(not stop_signal_called){
+        for (size_t ch = 0; ch < num_chans; ch++){
+            //fill the buffer with the waveform
+            for (size_t n = 0; n < spb; n++){
+                buffs[ch][n] = wave_tables[ch](thetas[ch] += cpss[ch]);
+            }
+
+            //bring the theta back into range [0, 1)
+            thetas[ch] = std::fmod(thetas[ch], 1);
+        }
+
+        //send the entire contents of the buffer
+        usrp->get_device()->send(
+            buff_ptrs, spb, md,
+            uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::SEND_MODE_FULL_BUFF
+        );
+
+        md.start_of_burst = false;
+        md.has_time_spec = false;
+    }
+}
+
+//! Send the pre-rendered sc16 samples, the host only converts sc16 to otw
+static void send_rendered_sc16(
+    uhd::usrp::multi_usrp::sptr usrp, uhd::tx_metadata_t &md,
+    const std::vector<wave_render_class> &renders, const size_t spb
+){
+    std::vector<const void *> buff_ptrs(renders.size());
+    size_t offset = 0;
+    while(not stop_signal_called){
+        for (size_t ch = 0; ch < renders.size(); ch++) buff_ptrs[ch] = renders[ch].get_sc16(offset);
+        const size_t num_tx_samps = usrp->get_device()->send(
+            buff_ptrs, spb, md,
+            uhd::io_type_t::COMPLEX_INT16,
+            uhd::device::SEND_MODE_FULL_BUFF
+        );
+        offset = (offset + num_tx_samps)%render_len;
+
+        md.start_of_burst = false;
+        md.has_time_spec = false;
+    }
+}
+
+//! Copy the pre-rendered otw items straight into the transport frames
+static void send_rendered_otw(
+    uhd::usrp::multi_usrp::sptr usrp, uhd::tx_metadata_t &md,
+    std::vector<wave_render_class> &renders, const size_t extra
+){
+    uhd::device::send_view_t view;
+    view.metadata = md;
+    size_t offset = 0;
+    bool rendered = false;
+    while(not stop_signal_called){
+        const size_t max_items = usrp->get_device()->get_send_view(view, 1.0);
+        if (max_items == 0) continue; //timeout
+
+        //the byte order of the items is known once the first view arrives
+        if (not rendered){
+            if (view.item_size != sizeof(boost::uint32_t)) throw std::runtime_error("otw type: only sc16 on the wire is supported");
+            if (view.payloads.size() != renders.size()) throw std::runtime_error("otw type: the channels share a payload, use the short type");
+            BOOST_FOREACH(wave_render_class &render, renders) render.render_otw(view.otw_type);
+            rendered = true;
+        }
+
+        const size_t nitems = std::min(max_items, extra);
+        for (size_t ch = 0; ch < view.payloads.size(); ch++){
+            std::memcpy(view.payloads[ch], renders[ch].get_otw(offset), nitems*view.item_size);
+        }
+        offset = (offset + usrp->get_device()->commit_send_view(view, nitems, 1.0))%render_len;
+
+        view.metadata.start_of_burst = false;
+        view.metadata.has_time_spec = false;
+    }
+    md.start_of_burst = false;
+    md.has_time_spec = false;
+}
+
 /***********************************************************************
  * Main function
  **********************************************************************/
@@ -90,10 +244,9 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     uhd::set_thread_priority_safe();
 
     //variables to be set by po
-    std::string args, wave_type, ant, subdev, ref;
+    std::string args, wave_types, wave_freqs, ampls, type, ant, subdev, ref;
     size_t spb;
-    double rate, freq, gain, wave_freq, bw;
-    float ampl;
+    double rate, freq, gain, bw;
 
     //setup the program options
     po::options_description desc("Allowed options");
@@ -103,13 +256,14 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("spb", po::value<size_t>(&spb)->default_value(10000), "samples per buffer")
         ("rate", po::value<double>(&rate), "rate of outgoing samples")
         ("freq", po::value<double>(&freq), "RF center frequency in Hz")
-        ("ampl", po::value<float>(&ampl)->default_value(float(0.3)), "amplitude of the waveform")
+        ("ampl", po::value<std::string>(&ampls)->default_value("0.3"), "amplitude of the waveform, or a comma separated list per channel")
         ("gain", po::value<double>(&gain), "gain for the RF chain")
         ("ant", po::value<std::string>(&ant), "daughterboard antenna selection")
         ("subdev", po::value<std::string>(&subdev), "daughterboard subdevice specification")
         ("bw", po::value<double>(&bw), "daughterboard IF filter bandwidth in Hz")
-        ("wave-type", po::value<std::string>(&wave_type)->default_value("CONST"), "waveform type (CONST, SQUARE, RAMP, SINE)")
-        ("wave-freq", po::value<double>(&wave_freq)->default_value(0), "waveform frequency in Hz")
+        ("wave-type", po::value<std::string>(&wave_types)->default_value("CONST"), "waveform type (CONST, SQUARE, RAMP, SINE), or a comma separated list per channel")
+        ("wave-freq", po::value<std::string>(&wave_freqs)->default_value("0"), "waveform frequency in Hz, or a comma separated list per channel")
+        ("type", po::value<std::string>(&type)->default_value("float"), "sample generator: float (per buffer), short (pre-rendered sc16), or otw (pre-rendered into the transport frames)")
         ("ref", po::value<std::string>(&ref)->default_value("INTERNAL"), "waveform type (INTERNAL, EXTERNAL, MIMO)")
     ;
     po::variables_map vm;
@@ -119,6 +273,16 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     //print the help message
     if (vm.count("help")){
         std::cout << boost::format("UHD TX Waveforms %s") % desc << std::endl;
+        std::cout <<
+            "    The short and otw types render each waveform once before streaming,\n"
+            "    with the wave-freq rounded to a multiple of rate/" << render_len << ",\n"
+            "    so the host does no waveform math while streaming at a high rate.\n"
+            "    The otw type also skips the conversion (sc16 on the wire only).\n"
+            << std::endl;
+        return ~0;
+    }
+    if (type != "float" and type != "short" and type != "otw"){
+        std::cerr << "Unknown sample generator type: " << type << std::endl;
         return ~0;
     }
 
@@ -184,27 +348,43 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         if (vm.count("ant")) usrp->set_tx_antenna(ant, chan);
     }
 
-    //for the const wave, set the wave freq for small samples per period
-    if (wave_freq == 0 and wave_type == "CONST"){
-        wave_freq = usrp->get_tx_rate()/2;
-    }
+    //the waveform of each channel: the lists apply the last value to the remaining channels
+    const size_t num_chans = usrp->get_tx_num_channels();
+    std::vector<wave_table_class> wave_tables;
+    std::vector<double> cpss;
+    for (size_t chan = 0; chan < num_chans; chan++){
+        const std::string wave_type = get_chan_value(wave_types, chan);
+        double wave_freq = boost::lexical_cast<double>(get_chan_value(wave_freqs, chan));
+
+        //for the const wave, set the wave freq for small samples per period
+        if (wave_freq == 0 and wave_type == "CONST"){
+            wave_freq = usrp->get_tx_rate()/2;
+        }
 
-    //error when the waveform is not possible to generate
-    if (std::abs(wave_freq) > usrp->get_tx_rate()/2){
-        throw std::runtime_error("wave freq out of Nyquist zone");
-    }
-    if (usrp->get_tx_rate()/std::abs(wave_freq) > wave_table_len/2){
-        throw std::runtime_error("wave freq too small for table");
-    }
+        //error when the waveform is not possible to generate
+        if (std::abs(wave_freq) > usrp->get_tx_rate()/2){
+            throw std::runtime_error("wave freq out of Nyquist zone");
+        }
+        if (usrp->get_tx_rate()/std::abs(wave_freq) > wave_table_len/2){
+            throw std::runtime_error("wave freq too small for table");
+        }
 
-    //pre-compute the waveform values
-    const wave_table_class wave_table(wave_type, ampl);
-    const double cps = wave_freq/usrp->get_tx_rate();
-    double theta = 0;
+        //pre-compute the waveform values
+        wave_tables.push_back(wave_table_class(wave_type, boost::lexical_cast<float>(get_chan_value(ampls, chan))));
+        cpss.push_back(wave_freq/usrp->get_tx_rate());
+        std::cout << boost::format("Channel %u: %s wave at %f kHz") % chan % wave_type % (wave_freq/1e3) << std::endl;
+    }
 
-    //allocate a buffer which we re-use for each channel
-    std::vector<std::complex<float> > buff(spb);
-    std::vector<std::complex<float> *> buffs(usrp->get_tx_num_channels(), &buff.front());
+    //pre-render the waveforms, with room for a whole buffer or packet from any offset
+    std::vector<wave_render_class> renders;
+    const size_t extra = std::max(spb, usrp->get_device()->get_max_send_samps_per_packet());
+    if (type != "float") for (size_t chan = 0; chan < num_chans; chan++){
+        const long periods = boost::math::lround(cpss[chan]*render_len);
+        if (periods == 0) throw std::runtime_error("wave freq too small to render");
+        renders.push_back(wave_render_class(wave_tables[chan], size_t((periods + long(render_len))%long(render_len)), extra));
+        std::cout << boost::format("Channel %u: rendered at %f kHz") % chan % (periods*usrp->get_tx_rate()/render_len/1e3) << std::endl;
+    }
+    std::cout << std::endl;
 
     //setup the metadata flags
     uhd::tx_metadata_t md;
@@ -239,26 +419,9 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     std::signal(SIGINT, &sig_int_handler);
     std::cout << "Press Ctrl + C to stop streaming..." << std::endl;
 
-    //send data until the signal handler gets called
-    while(not stop_signal_called){
-        //fill the buffer with the waveform
-        for (size_t n = 0; n < buff.size(); n++){
-            buff[n] = wave_table(theta += cps);
-        }
-
-        //bring the theta back into range [0, 1)
-        theta = std::fmod(theta, 1);
-
-        //send the entire contents of the buffer
-        usrp->get_device()->send(
-            buffs, buff.size(), md,
-            uhd::io_type_t::COMPLEX_FLOAT32,
-            uhd::device::SEND_MODE_FULL_BUFF
-        );
-
-        md.start_of_burst = false;
-        md.has_time_spec = false;
-    }
+    if (type == "float") send_generated_float(usrp, md, wave_tables, cpss, spb);
+    if (type == "short") send_rendered_sc16(usrp, md, renders, spb);
+    if (type == "otw") send_rendered_otw(usrp, md, renders, extra);
 
     //send a mini EOB packet
     md.end_of_burst = true;
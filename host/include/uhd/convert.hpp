@@ -23,25 +23,33 @@
 #include <uhd/types/otw_type.hpp>
 #include <uhd/types/ref_vector.hpp>
 #include <boost/function.hpp>
+#include <complex>
 #include <string>
+#include <vector>
 
 namespace uhd{ namespace convert{
 
     typedef uhd::ref_vector<void *> output_type;
     typedef uhd::ref_vector<const void *> input_type;
     typedef boost::function<void(const input_type&, const output_type&, size_t, double)> function_type;
+    typedef void (*function_ptr_type)(const input_type&, const output_type&, size_t, double);
 
     /*!
      * Describe the priority of a converter function.
      * A higher priority function takes precedence.
      * The general case function are the lowest.
      * Next comes the liborc implementations.
-     * Custom intrinsics implementations are highest.
+     * Custom intrinsics implementations come after that.
+     * Implementations needing a runtime cpu check are highest.
+     * The custom stream implementations write the output with
+     * non-temporal stores, they are only used when forced.
      */
     enum priority_type{
         PRIORITY_GENERAL = 0,
         PRIORITY_LIBORC = 1,
         PRIORITY_CUSTOM = 2,
+        PRIORITY_CUSTOM_AVX2 = 3,
+        PRIORITY_CUSTOM_STREAM = -2,
         PRIORITY_EMPTY = -1,
     };
 
@@ -85,6 +93,181 @@ namespace uhd{ namespace convert{
         size_t num_output_buffs
     );
 
+    /*!
+     * Get the priority of the converter that converts cpu to otw.
+     * The arguments are the same as for get_converter_cpu_to_otw().
+     * \return the winning priority or PRIORITY_EMPTY when unregistered
+     */
+    UHD_API priority_type get_priority_cpu_to_otw(
+        const io_type_t &io_type,
+        const otw_type_t &otw_type,
+        size_t num_input_buffs,
+        size_t num_output_buffs
+    );
+
+    /*!
+     * Get the priority of the converter that converts otw to cpu.
+     * The arguments are the same as for get_converter_otw_to_cpu().
+     * \return the winning priority or PRIORITY_EMPTY when unregistered
+     */
+    UHD_API priority_type get_priority_otw_to_cpu(
+        const io_type_t &io_type,
+        const otw_type_t &otw_type,
+        size_t num_input_buffs,
+        size_t num_output_buffs
+    );
+
+    /*!
+     * Describe one registered converter implementation.
+     * Implementations of the same markup differ in priority.
+     */
+    struct UHD_API converter_info_t{
+        //! the markup, ex: convert_fc32_1_to_item32_1_nswap
+        std::string markup;
+        //! the priority the implementation registered with
+        priority_type prio;
+        //! true when lookups for the markup return this implementation
+        bool selected;
+    };
+    typedef std::vector<converter_info_t> converter_infos_t;
+
+    /*!
+     * Get every registered converter implementation.
+     * \return a list of infos, lower priorities first per markup
+     */
+    UHD_API converter_infos_t get_converter_infos(void);
+
+    /*!
+     * Get a specific converter implementation.
+     * \param markup representing the signature
+     * \param prio the priority it registered with
+     * \return the converter function
+     * \throw uhd::lookup_error when not registered
+     */
+    UHD_API function_type get_converter(
+        const std::string &markup, priority_type prio
+    );
+
+    /*!
+     * Force the implementation that converter lookups return.
+     * When nothing is registered at the forced priority for a markup,
+     * lookups fall back to the highest priority implementation.
+     * This only affects converters that are looked up afterwards.
+     *
+     * The UHD_CONVERT_PRIORITY environment variable sets the initial state:
+     * a comma separated list of <prio> or <markup>:<prio> entries.
+     * The device address key convert_prio forces a priority for all markups.
+     *
+     * \param prio general, liborc, custom, custom_avx2, custom_stream, or a number (empty to reset)
+     * \param markup the converter markup (empty for all markups)
+     * \throw uhd::value_error for an unknown priority
+     */
+    UHD_API void set_forced_priority(
+        const std::string &prio, const std::string &markup = ""
+    );
+
+    /*!
+     * A correction applied to the samples in otw to cpu conversion.
+     * The DC offset is subtracted from the scaled sample,
+     * then the 2x2 matrix multiplies the (I, Q) column vector:
+     *     I' = ii*(I - dc.I) + iq*(Q - dc.Q)
+     *     Q' = qi*(I - dc.I) + qq*(Q - dc.Q)
+     */
+    struct UHD_API correction_t{
+        std::complex<double> dc_offset;
+        double ii, iq, qi, qq;
+
+        //! Create an identity correction
+        correction_t(void);
+
+        //! True when the correction does not change the samples
+        bool is_identity(void) const;
+    };
+
+    typedef boost::function<void(
+        const input_type&, const output_type&, size_t, double, const correction_t &
+    )> corrected_function_type;
+
+    /*!
+     * Register a converter function that converts otw type to cpu type
+     * and applies a correction to each sample in the same pass.
+     * \param markup representing the signature (one input and output)
+     * \param fcn a pointer to the corrected converter
+     * \param prio the function priority
+     */
+    UHD_API void register_corrected_converter(
+        const std::string &markup,
+        corrected_function_type fcn,
+        priority_type prio
+    );
+
+    /*!
+     * Get a converter function that converts otw to cpu with a correction.
+     * The correction is bound into the returned function.
+     * \param io_type the type of the output samples
+     * \param otw_type the type of the input samples
+     * \param correction the dc offset and iq correction
+     * \return a converter for one input and one output buffer
+     * \throw uhd::lookup_error when no corrected converter is registered
+     */
+    UHD_API function_type get_corrected_converter_otw_to_cpu(
+        const io_type_t &io_type,
+        const otw_type_t &otw_type,
+        const correction_t &correction
+    );
+
+    /*!
+     * A conversion plan: a converter resolved once at stream setup.
+     * The plan calls the converter through a plain function pointer
+     * when it was registered as one (bound converters keep the function),
+     * and fixes the buffer counts and scale factor at creation.
+     */
+    class UHD_API plan_t{
+    public:
+        //! Create an empty plan, calling it throws
+        plan_t(void);
+
+        /*!
+         * Create a plan for a converter.
+         * \param fcn the converter from a lookup function
+         * \param num_input_buffs the number of inputs
+         * \param num_output_buffs the number of outputs
+         * \param scale_factor the scale factor passed to each call
+         */
+        plan_t(
+            const function_type &fcn,
+            size_t num_input_buffs,
+            size_t num_output_buffs,
+            double scale_factor
+        );
+
+        //! True when the plan has no converter
+        bool empty(void) const{
+            return _fcn_ptr == NULL and _fcn.empty();
+        }
+
+        /*!
+         * Convert samples between the buffers.
+         * \param inputs an array of num_input_buffs pointers
+         * \param outputs an array of num_output_buffs pointers
+         * \param nsamps the number of samples per buffer
+         */
+        UHD_INLINE void operator()(
+            const void *const *inputs, void *const *outputs, size_t nsamps
+        ) const{
+            const input_type in(inputs, _num_input_buffs);
+            const output_type out(outputs, _num_output_buffs);
+            if (_fcn_ptr != NULL) _fcn_ptr(in, out, nsamps, _scale_factor);
+            else _fcn(in, out, nsamps, _scale_factor);
+        }
+
+    private:
+        function_ptr_type _fcn_ptr;
+        function_type _fcn; //empty when the pointer is set
+        size_t _num_input_buffs, _num_output_buffs;
+        double _scale_factor;
+    };
+
 }} //namespace
 
 #endif /* INCLUDED_UHD_CONVERT_HPP */
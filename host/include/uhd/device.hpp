@@ -22,11 +22,15 @@
 #include <uhd/types/device_addr.hpp>
 #include <uhd/types/metadata.hpp>
 #include <uhd/types/io_type.hpp>
+#include <uhd/types/otw_type.hpp>
 #include <uhd/types/ref_vector.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/transport/zero_copy.hpp>
 #include <uhd/wax.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
+#include <vector>
 
 namespace uhd{
 
@@ -71,6 +75,8 @@ public:
      * The make routine will call find and pick one of the results.
      * By default, the first result will be used to create a new device.
      * Use the which parameter as an index into the list of results.
+     * Different devices can be made concurrently from several threads,
+     * a make of a device that is being made waits and returns the same device.
      *
      * \param hint a partially (or fully) filled in device address
      * \param which which address to use when multiple are found
@@ -120,6 +126,11 @@ public:
      * Under a timeout condition, the number of samples returned
      * may be less than the number of samples specified.
      *
+     * A timeout of zero makes the call non-blocking: it never waits
+     * on a condition or a socket, and returns fewer samples (or zero)
+     * when a packet would block. A packet is sent on all channels or
+     * none, so the call can be repeated with the remaining samples.
+     *
      * \param buffs a vector of read-only memory containing IF data
      * \param nsamps_per_buff the number of samples to send, per buffer
      * \param metadata data describing the buffer's contents
@@ -160,6 +171,11 @@ public:
      * to the first packet received and written into the recv buffers.
      * Use the one packet recv mode to get per packet metadata.
      *
+     * A timeout of zero makes the call non-blocking: it never waits
+     * on a condition or a socket, and reports ERROR_CODE_TIMEOUT
+     * when a packet would block. The packets received so far for
+     * some of the channels are kept for the next call.
+     *
      * \param buffs a vector of writable memory to fill with IF data
      * \param nsamps_per_buff the size of each buffer in number of samples
      * \param metadata data to fill describing the buffer
@@ -177,6 +193,190 @@ public:
         double timeout = 0.1
     ) = 0;
 
+    //! The metadata of one packet written into the recv buffers
+    struct UHD_API recv_packet_metadata_t{
+        //! the offset of the packet's first sample into each buffer
+        size_t offset;
+
+        //! data describing the packet
+        rx_metadata_t metadata;
+
+        recv_packet_metadata_t(void): offset(0){}
+    };
+
+    //! The metadata of every packet written by one full buffer receive
+    typedef std::vector<recv_packet_metadata_t> recv_metadata_array_type;
+
+    /*!
+     * Receive a full buffer and keep the metadata of every packet.
+     * Works like recv() in full buffer mode, but appends one entry
+     * per packet (or fragment) to the metadata array, so large reads
+     * keep the exact time of every packet.
+     *
+     * An overflow is recorded as an entry with no samples
+     * and the receive continues with the next packet.
+     * Any other error ends the call and is the last entry.
+     * The array is cleared first; reuse it to avoid allocations.
+     *
+     * \param buffs a vector of writable memory to fill with IF data
+     * \param nsamps_per_buff the size of each buffer in number of samples
+     * \param metadata_array the per packet metadata to fill
+     * \param io_type the type of data to fill into the buffer
+     * \param timeout the timeout in seconds to wait for each packet
+     * 
+eturn the number of samples received
+     */
+    virtual size_t recv_full_buff(
+        const recv_buffs_type &buffs,
+        size_t nsamps_per_buff,
+        recv_metadata_array_type &metadata_array,
+        const io_type_t &io_type,
+        double timeout = 0.1
+    );
+
+    /*!
+     * A borrowed view of the transport frames from one receive.
+     * There is one payload per channel, each holds nsamps otw items
+     * in the over-the-wire format (the streams of a channel interleave).
+     * The view owns the frames until release() or destruction;
+     * the transport cannot reuse a frame while a view holds it.
+     */
+    struct UHD_API recv_view_t{
+        //! pointers to the payloads in transport memory, per channel
+        std::vector<const void *> payloads;
+
+        //! the number of otw items in each payload
+        size_t nsamps;
+
+        //! the number of bytes per otw item (set on receive)
+        size_t item_size;
+
+        //! the over-the-wire format of the payloads (set on receive)
+        otw_type_t otw_type;
+
+        //! data describing the payloads
+        rx_metadata_t metadata;
+
+        //! the borrowed transport frames, per channel
+        std::vector<transport::managed_recv_buffer::sptr> frames;
+
+        recv_view_t(void): nsamps(0), item_size(0){}
+
+        //! Release the frames back to the transport
+        void release(void){
+            payloads.clear();
+            frames.clear();
+            nsamps = 0;
+        }
+    };
+
+    /*!
+     * Receive one packet per channel without copying the payloads.
+     * The payloads are handed out as views into transport memory.
+     * The caller must release the view to return the frames;
+     * hold few views at once or the transport will run out of frames.
+     *
+     * The metadata is filled in the same way as the one packet recv mode.
+     * When recv() left a fragment, the view covers the remainder.
+     *
+     * \param view the view to fill (previous frames are released)
+     * \param timeout the timeout in seconds to wait for a packet
+     * \return the number of samples in each payload or 0 on error
+     * \throw uhd::not_implemented_error when the device has no support
+     */
+    virtual size_t recv_view(recv_view_t &view, double timeout = 0.1);
+
+    /*!
+     * Borrowed transport frames to fill in place for one send.
+     * There is one payload per channel, each with room for max_nsamps
+     * otw items in the over-the-wire format, after the reserved header.
+     * The header layout follows metadata.has_time_spec at the time
+     * the view was acquired; the flags and time may change until commit.
+     */
+    struct UHD_API send_view_t{
+        //! pointers to the payloads in transport memory, per channel
+        std::vector<void *> payloads;
+
+        //! the capacity of each payload in otw items
+        size_t max_nsamps;
+
+        //! data describing the payloads, packed into the header on commit
+        tx_metadata_t metadata;
+
+        //! the borrowed transport frames, per channel
+        std::vector<transport::managed_send_buffer::sptr> frames;
+
+        //! the reserved header length (set when acquired)
+        size_t num_header_words32;
+
+        //! the number of bytes per otw item (set when acquired)
+        size_t item_size;
+
+        //! the over-the-wire format of the payloads (set when acquired)
+        otw_type_t otw_type;
+
+        send_view_t(void): max_nsamps(0), num_header_words32(0), item_size(0){}
+
+        //! Drop the frames without sending them
+        void release(void){
+            payloads.clear();
+            frames.clear();
+            max_nsamps = 0;
+        }
+    };
+
+    /*!
+     * Get one frame per channel to fill with otw samples in place.
+     * Set view.metadata.has_time_spec before the call,
+     * since the reserved header space depends on it.
+     * \param view the view to fill (previous frames are dropped)
+     * \param timeout the timeout in seconds to wait for the frames
+     * \return the capacity of each payload in otw items or 0 on timeout
+     * \throw uhd::not_implemented_error when the device has no support
+     */
+    virtual size_t get_send_view(send_view_t &view, double timeout = 0.1);
+
+    /*!
+     * Pack the headers from view.metadata and send the frames.
+     * The view is released afterwards.
+     * \param view a view from get_send_view() with samples written
+     * \param nsamps the number of otw items written into each payload
+     * \param timeout the timeout in seconds for timed sends on the host
+     * \return the number of items sent per payload
+     * \throw uhd::value_error when the header layout changed
+     */
+    virtual size_t commit_send_view(send_view_t &view, size_t nsamps, double timeout = 0.1);
+
+    /*!
+     * Make a receive stream for the cpu type, otw format, and channels.
+     * The stream's recv() skips the per-call dispatch of recv(),
+     * and devices with a handler per stream let separate streams
+     * be received from separate threads at the same time.
+     * Other devices return a stream of recv() with the arguments bound,
+     * which must carry all of the channels in order.
+     * Do not mix a stream and recv() on the same channels.
+     * \param args the stream arguments
+     * \return a new receive stream
+     * \throw uhd::value_error for a format the device cannot stream
+     * \throw uhd::not_implemented_error for channels the device cannot split
+     */
+    virtual rx_streamer::sptr get_rx_stream(const stream_args_t &args);
+
+    /*!
+     * Make a transmit stream for the cpu type, otw format, and channels.
+     * The stream's send() skips the per-call dispatch of send(),
+     * and devices with a handler per stream let separate streams
+     * be sent from separate threads at the same time.
+     * Other devices return a stream of send() with the arguments bound,
+     * which must carry all of the channels in order.
+     * Do not mix a stream and send() on the same channels.
+     * \param args the stream arguments
+     * \return a new transmit stream
+     * \throw uhd::value_error for a format the device cannot stream
+     * \throw uhd::not_implemented_error for channels the device cannot split
+     */
+    virtual tx_streamer::sptr get_tx_stream(const stream_args_t &args);
+
     /*!
      * Get the maximum number of samples per packet on send.
      * \return the number of samples
@@ -199,6 +399,26 @@ public:
         async_metadata_t &async_metadata, double timeout = 0.1
     ) = 0;
 
+    /*!
+     * Get the descriptors that signal receive readiness.
+     * Wait on these in an event loop instead of blocking in recv():
+     * when any descriptor is ready, call recv() with a zero timeout
+     * until it returns zero samples, then wait again.
+     * The descriptors may wake up spuriously.
+     * \return a set of poll descriptors
+     * \throw uhd::not_implemented_error if the device cannot be polled
+     */
+    virtual transport::poll_fds_t get_recv_poll_fds(void);
+
+    /*!
+     * Get the descriptors that signal async message readiness.
+     * When any descriptor is ready, call recv_async_msg() with a
+     * zero timeout until it returns false, then wait again.
+     * \return a set of poll descriptors
+     * \throw uhd::not_implemented_error if the device cannot be polled
+     */
+    virtual transport::poll_fds_t get_async_msg_poll_fds(void);
+
     //! Get access to the underlying property structure
     virtual boost::shared_ptr<property_tree> get_tree(void) const = 0;
 
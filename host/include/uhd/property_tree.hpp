@@ -22,6 +22,7 @@
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
+#include <typeinfo>
 #include <vector>
 
 namespace uhd{
@@ -32,6 +33,7 @@ namespace uhd{
  */
 template <typename T> class property : boost::noncopyable{
 public:
+    typedef boost::shared_ptr<property<T> > sptr;
     typedef boost::function<void(const T &)> subscriber_type;
     typedef boost::function<T(void)> publisher_type;
     typedef boost::function<T(const T &)> coercer_type;
@@ -136,19 +138,67 @@ public:
     //! Get an iterable to all things in the given path
     virtual std::vector<std::string> list(const fs_path &path) const = 0;
 
+    /*!
+     * Get the type of a property in the tree, the T it was created with.
+     * A caller that only has the path, such as a property server,
+     * checks the type before it accesses the property.
+     */
+    virtual const std::type_info &type_of(const fs_path &path) const = 0;
+
     //! Create a new property entry in the tree
     template <typename T> property<T> &create(const fs_path &path);
 
     //! Get access to a property in the tree
     template <typename T> property<T> &access(const fs_path &path);
 
+    /*!
+     * Get a handle to a property in the tree.
+     * The path is resolved once, so the handle can be kept and reused
+     * without walking or locking the tree on every access.
+     * The handle keeps the property alive if it is removed from the tree.
+     */
+    template <typename T> typename property<T>::sptr access_handle(const fs_path &path);
+
 private:
     //! Internal create property with wild-card type
-    virtual void _create(const fs_path &path, const boost::shared_ptr<void> &prop) = 0;
+    virtual void _create(const fs_path &path, const boost::shared_ptr<void> &prop, const std::type_info &type) = 0;
 
     //! Internal access property with wild-card type
-    virtual boost::shared_ptr<void> &_access(const fs_path &path) const = 0;
+    virtual boost::shared_ptr<void> _access(const fs_path &path) const = 0;
+
+};
 
+/*!
+ * A property transaction queues sets on the properties of a tree
+ * and applies them together on commit.
+ * A property that is queued more than once is set once with its last value,
+ * so its coercer and subscribers run once per commit.
+ * Properties are set in the order they were first queued:
+ * queue the properties that others depend upon first (ex: rates before freqs).
+ */
+class property_transaction : boost::noncopyable{
+public:
+    //! Make a new empty transaction on the tree
+    property_transaction(property_tree::sptr tree);
+
+    /*!
+     * Queue a set on a property.
+     * The path is resolved now, so a bad path throws here, not on commit.
+     * \param path the path of the property in the tree
+     * \param value the new value for the property
+     * \return a reference to this transaction for chaining
+     */
+    template <typename T> property_transaction &set(const fs_path &path, const T &value);
+
+    /*!
+     * Apply the queued sets and empty the transaction.
+     * When a set throws, the sets queued after it are discarded.
+     */
+    void commit(void);
+
+private:
+    property_tree::sptr _tree;
+    std::vector<std::pair<const void *, boost::function<void(void)> > > _sets;
 };
 
 } //namespace uhd
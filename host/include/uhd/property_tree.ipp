@@ -20,6 +20,9 @@
 
 #include <uhd/exception.hpp>
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/optional.hpp>
+#include <boost/utility/in_place_factory.hpp>
 #include <vector>
 
 /***********************************************************************
@@ -51,7 +54,8 @@ public:
     }
 
     property<T> &set(const T &value){
-        _value = boost::shared_ptr<T>(new T(_coercer.empty()? value : _coercer(value)));
+        //the value is held inline, construct in place so T need not be assignable
+        _value = boost::in_place(_coercer.empty()? value : _coercer(value));
         BOOST_FOREACH(typename property<T>::subscriber_type &subscriber, _subscribers){
             subscriber(*_value); //let errors propagate
         }
@@ -64,14 +68,14 @@ public:
     }
 
     bool empty(void) const{
-        return _publisher.empty() and _value.get() == NULL;
+        return _publisher.empty() and not _value;
     }
 
 private:
     std::vector<typename property<T>::subscriber_type> _subscribers;
     typename property<T>::publisher_type _publisher;
     typename property<T>::coercer_type _coercer;
-    boost::shared_ptr<T> _value;
+    boost::optional<T> _value;
 };
 
 }} //namespace uhd::/*anon*/
@@ -82,12 +86,57 @@ private:
 namespace uhd{
 
     template <typename T> property<T> &property_tree::create(const fs_path &path){
-        this->_create(path, typename boost::shared_ptr<property<T> >(new property_impl<T>()));
+        this->_create(path, typename boost::shared_ptr<property<T> >(new property_impl<T>()), typeid(T));
         return this->access<T>(path);
     }
 
     template <typename T> property<T> &property_tree::access(const fs_path &path){
-        return *boost::static_pointer_cast<property<T> >(this->_access(path));
+        return *this->access_handle<T>(path);
+    }
+
+    template <typename T> typename property<T>::sptr property_tree::access_handle(const fs_path &path){
+        return boost::static_pointer_cast<property<T> >(this->_access(path));
+    }
+
+/***********************************************************************
+ * Implement the property transaction
+ **********************************************************************/
+    template <typename T> static void property_transaction_set(
+        typename property<T>::sptr prop, const T &value
+    ){
+        prop->set(value);
+    }
+
+    inline property_transaction::property_transaction(property_tree::sptr tree):
+        _tree(tree)
+    {
+        /* NOP */
+    }
+
+    template <typename T> property_transaction &property_transaction::set(
+        const fs_path &path, const T &value
+    ){
+        const typename property<T>::sptr prop = _tree->access_handle<T>(path);
+        const boost::function<void(void)> setter = boost::bind(
+            &property_transaction_set<T>, prop, value
+        );
+
+        //a repeated set replaces the queued value but keeps its place
+        for (size_t i = 0; i < _sets.size(); i++){
+            if (_sets[i].first != prop.get()) continue;
+            _sets[i].second = setter;
+            return *this;
+        }
+        _sets.push_back(std::make_pair(static_cast<const void *>(prop.get()), setter));
+        return *this;
+    }
+
+    inline void property_transaction::commit(void){
+        std::vector<std::pair<const void *, boost::function<void(void)> > > sets;
+        sets.swap(_sets);
+        for (size_t i = 0; i < sets.size(); i++){
+            sets[i].second(); //let errors propagate
+        }
     }
 
 } //namespace uhd
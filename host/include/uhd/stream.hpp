@@ -0,0 +1,185 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_STREAM_HPP
+#define INCLUDED_UHD_STREAM_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/io_type.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/ref_vector.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <vector>
+#include <string>
+
+namespace uhd{
+
+/*!
+ * The arguments to request a stream from a device.
+ * A stream is set up once for a cpu type, an otw format,
+ * and the device channels that it carries.
+ */
+struct UHD_API stream_args_t{
+
+    //! Convenience constructor for the cpu type and otw format
+    stream_args_t(
+        const io_type_t::tid_t cpu_type = io_type_t::COMPLEX_FLOAT32,
+        const std::string &otw_format = ""
+    );
+
+    //! The type of the samples in the host buffers
+    io_type_t::tid_t cpu_type;
+
+    /*!
+     * The over-the-wire format: sc16, sc12, or sc8.
+     * Empty for the format of the device address keys,
+     * recv_otw_format and send_otw_format (sc16 by default).
+     * Not every device can change the format per stream.
+     */
+    std::string otw_format;
+
+    /*!
+     * The device channels of the stream, one buffer each, in order.
+     * The channels are the ones of the subdevice specifications,
+     * numbered across the mboards like device::recv() and send().
+     * Empty for all of the channels.
+     */
+    std::vector<size_t> channels;
+
+    /*!
+     * The samples per packet of the stream, at most the maximum of the device.
+     * Small packets arrive sooner at low rates, at the cost of more packets.
+     * Zero for the maximum that fits the transport frame (the default).
+     */
+    size_t spp;
+};
+
+/*!
+ * A receive stream returned by device::get_rx_stream().
+ * The handler of the stream is made for its arguments,
+ * so that recv() has no io type or mode to dispatch on.
+ * Streams over separate channels can be received from separate threads.
+ * The device must outlive its streams.
+ */
+class UHD_API rx_streamer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_streamer> sptr;
+
+    //! Typedef for a pointer to a single, or a collection of recv buffers
+    typedef ref_vector<void *> buffs_type;
+
+    /*!
+     * A receive hook runs on the samples of each packet in place,
+     * right after their conversion, while they are still in cache:
+     * ex: a filter, a detector, or a decimator.
+     * The hook may keep fewer samples, moved to the start of the buffer.
+     * \param chan the channel of the stream
+     * \param buff the converted samples, in the cpu type of the stream
+     * \param nsamps the number of samples in the buffer
+     * \param metadata the metadata of the first sample
+     * \return the number of samples to keep, at most nsamps
+     */
+    typedef boost::function<size_t(size_t chan, void *buff, size_t nsamps, const rx_metadata_t &metadata)> recv_hook_type;
+
+    virtual ~rx_streamer(void);
+
+    //! Get the number of channels, and so of buffers, of the stream
+    virtual size_t get_num_channels(void) const = 0;
+
+    //! Get the maximum number of samples per packet
+    virtual size_t get_max_num_samps(void) const = 0;
+
+    /*!
+     * Receive buffers containing IF data described by the metadata.
+     * Works like device::recv() with the cpu type of the stream.
+     * \param buffs a vector of writable memory, one per channel
+     * \param nsamps_per_buff the size of each buffer in number of samples
+     * \param metadata data to fill describing the buffer
+     * \param timeout the timeout in seconds to wait for a packet
+     * \param one_packet true to return after one packet, like RECV_MODE_ONE_PACKET
+     * \return the number of samples received or 0 on error
+     */
+    virtual size_t recv(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &metadata,
+        double timeout = 0.1,
+        bool one_packet = false
+    ) = 0;
+
+    /*!
+     * Set a hook on the converted samples of each packet.
+     * The hook runs within recv(), once per channel per packet,
+     * so a second pass over the samples is not needed.
+     * The channels of a stream that convert in parallel
+     * (recv_convert_threads) run their hooks on the convert threads.
+     * When the channels keep different numbers of samples, recv() keeps the fewest.
+     * A full buffer recv() hooks whole packets, the ones that fit in the buffer
+     * before the hook, and returns early after a packet that the hook empties.
+     * A packet that the hook empties returns no samples in a one packet recv().
+     * The hook does not run on the frames of a receive view.
+     * \param hook the hook, or an empty function to remove it
+     * \throw uhd::not_implemented_error when the stream has no hooks
+     */
+    virtual void set_recv_hook(const recv_hook_type &hook);
+};
+
+/*!
+ * A transmit stream returned by device::get_tx_stream().
+ * The handler of the stream is made for its arguments,
+ * so that send() has no io type or mode to dispatch on.
+ * Streams over separate channels can be sent from separate threads.
+ * The device must outlive its streams.
+ */
+class UHD_API tx_streamer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<tx_streamer> sptr;
+
+    //! Typedef for a pointer to a single, or a collection of send buffers
+    typedef ref_vector<const void *> buffs_type;
+
+    virtual ~tx_streamer(void);
+
+    //! Get the number of channels, and so of buffers, of the stream
+    virtual size_t get_num_channels(void) const = 0;
+
+    //! Get the maximum number of samples per packet
+    virtual size_t get_max_num_samps(void) const = 0;
+
+    /*!
+     * Send buffers containing IF data described by the metadata.
+     * Works like device::send() in the full buffer mode,
+     * with the cpu type of the stream.
+     * \param buffs a vector of read-only memory, one per channel
+     * \param nsamps_per_buff the number of samples to send, per buffer
+     * \param metadata data describing the buffer's contents
+     * \param timeout the timeout in seconds to wait on a packet
+     * \return the number of samples sent
+     */
+    virtual size_t send(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const tx_metadata_t &metadata,
+        double timeout = 0.1
+    ) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_STREAM_HPP */
@@ -76,7 +76,7 @@ namespace uhd{ namespace transport{
          * Push a new element into the bounded_buffer.
          * Wait until the bounded_buffer becomes non-full or timeout.
          * \param elem the new element to push
-         * \param timeout the timeout in seconds
+         * \param timeout the timeout in seconds (zero does not wait at all)
          * \return false when the operation times out
          */
         UHD_INLINE bool push_with_timed_wait(const elem_type &elem, double timeout){
@@ -106,7 +106,7 @@ namespace uhd{ namespace transport{
          * Pop an element from the bounded_buffer.
          * Wait until the bounded_buffer becomes non-empty or timeout.
          * \param elem the element reference pop to
-         * \param timeout the timeout in seconds
+         * \param timeout the timeout in seconds (zero does not wait at all)
          * \return false when the operation times out
          */
         UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
@@ -116,6 +116,91 @@ namespace uhd{ namespace transport{
     private: bounded_buffer_detail<elem_type> _detail;
     };
 
+    /*!
+     * Implement a templated single-producer single-consumer bounded buffer:
+     * Used for free-lists where only one thread pushes and one thread pops.
+     * The push and pop operations are lock-free when they do not wait.
+     * The waits spin briefly, then block on condition variables;
+     * the other side only takes a lock when it must wake a blocked waiter.
+     * Unlike bounded_buffer, there is no push with pop on full,
+     * since only the consumer side may pop elements.
+     */
+    template <typename elem_type> class spsc_bounded_buffer{
+    public:
+
+        /*!
+         * Create a new spsc bounded buffer object.
+         * \param capacity the spsc_bounded_buffer capacity
+         */
+        spsc_bounded_buffer(size_t capacity):
+            _detail(capacity)
+        {
+            /* NOP */
+        }
+
+        /*!
+         * Push a new element into the bounded buffer immediately.
+         * The element will not be pushed when the buffer is full.
+         * \param elem the element reference pop to
+         * \return false when the buffer is full
+         */
+        UHD_INLINE bool push_with_haste(const elem_type &elem){
+            return _detail.push_with_haste(elem);
+        }
+
+        /*!
+         * Push a new element into the bounded_buffer.
+         * Wait until the bounded_buffer becomes non-full.
+         * \param elem the new element to push
+         */
+        UHD_INLINE void push_with_wait(const elem_type &elem){
+            return _detail.push_with_wait(elem);
+        }
+
+        /*!
+         * Push a new element into the bounded_buffer.
+         * Wait until the bounded_buffer becomes non-full or timeout.
+         * \param elem the new element to push
+         * \param timeout the timeout in seconds (zero does not wait at all)
+         * \return false when the operation times out
+         */
+        UHD_INLINE bool push_with_timed_wait(const elem_type &elem, double timeout){
+            return _detail.push_with_timed_wait(elem, timeout);
+        }
+
+        /*!
+         * Pop an element from the bounded buffer immediately.
+         * The element will not be popped when the buffer is empty.
+         * \param elem the element reference pop to
+         * \return false when the buffer is empty
+         */
+        UHD_INLINE bool pop_with_haste(elem_type &elem){
+            return _detail.pop_with_haste(elem);
+        }
+
+        /*!
+         * Pop an element from the bounded_buffer.
+         * Wait until the bounded_buffer becomes non-empty.
+         * \param elem the element reference pop to
+         */
+        UHD_INLINE void pop_with_wait(elem_type &elem){
+            return _detail.pop_with_wait(elem);
+        }
+
+        /*!
+         * Pop an element from the bounded_buffer.
+         * Wait until the bounded_buffer becomes non-empty or timeout.
+         * \param elem the element reference pop to
+         * \param timeout the timeout in seconds (zero does not wait at all)
+         * \return false when the operation times out
+         */
+        UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
+            return _detail.pop_with_timed_wait(elem, timeout);
+        }
+
+    private: spsc_bounded_buffer_detail<elem_type> _detail;
+    };
+
 }} //namespace
 
 #endif /* INCLUDED_UHD_TRANSPORT_BOUNDED_BUFFER_HPP */
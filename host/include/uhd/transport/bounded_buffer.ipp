@@ -19,12 +19,15 @@
 #define INCLUDED_UHD_TRANSPORT_BOUNDED_BUFFER_IPP
 
 #include <uhd/config.hpp>
+#include <uhd/utils/atomic.hpp>
 #include <boost/bind.hpp>
 #include <boost/utility.hpp>
 #include <boost/function.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/thread/locks.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <vector>
 
 namespace uhd{ namespace transport{ namespace{ /*anon*/
 
@@ -75,6 +78,7 @@ namespace uhd{ namespace transport{ namespace{ /*anon*/
 
         UHD_INLINE bool push_with_timed_wait(const elem_type &elem, double timeout){
             if (this->push_with_haste(elem)) return true;
+            if (timeout <= 0) return false; //non-blocking, skip the condition
             boost::mutex::scoped_lock lock(_mutex);
             if (not _full_cond.timed_wait(
                 lock, to_time_dur(timeout), _not_full_fcn
@@ -105,6 +109,7 @@ namespace uhd{ namespace transport{ namespace{ /*anon*/
 
         UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
             if (this->pop_with_haste(elem)) return true;
+            if (timeout <= 0) return false; //non-blocking, skip the condition
             boost::mutex::scoped_lock lock(_mutex);
             if (not _empty_cond.timed_wait(
                 lock, to_time_dur(timeout), _not_empty_fcn
@@ -142,6 +147,127 @@ namespace uhd{ namespace transport{ namespace{ /*anon*/
         }
 
     };
+
+    template <typename elem_type> class spsc_bounded_buffer_detail : boost::noncopyable{
+    public:
+
+        spsc_bounded_buffer_detail(size_t capacity):
+            _buffer(capacity + 1)
+        {
+            /* NOP */
+        }
+
+        UHD_INLINE bool push_with_haste(const elem_type &elem){
+            const boost::uint32_t head = _head.read();
+            const boost::uint32_t next = this->next(head);
+            if (next == _tail.read()) return false;
+            _buffer[head] = elem;
+            uhd::atomic_full_barrier(); //the slot is written before it is published
+            _head.write(next);
+            uhd::atomic_full_barrier(); //the index is published before the flag is read
+            if (_pop_waiting.read()) this->notify(_empty_cond);
+            return true;
+        }
+
+        UHD_INLINE void push_with_wait(const elem_type &elem){
+            this->wait(&spsc_bounded_buffer_detail<elem_type>::not_full, _push_waiting, _full_cond, -1.0);
+            this->push_with_haste(elem);
+        }
+
+        UHD_INLINE bool push_with_timed_wait(const elem_type &elem, double timeout){
+            if (this->push_with_haste(elem)) return true;
+            if (timeout <= 0) return false; //non-blocking, skip the spin and condition
+            if (not this->wait(
+                &spsc_bounded_buffer_detail<elem_type>::not_full, _push_waiting, _full_cond, timeout
+            )) return false;
+            return this->push_with_haste(elem);
+        }
+
+        UHD_INLINE bool pop_with_haste(elem_type &elem){
+            const boost::uint32_t tail = _tail.read();
+            if (tail == _head.read()) return false;
+            uhd::atomic_full_barrier(); //the slot is read after its index
+            elem = _buffer[tail];
+            _buffer[tail] = elem_type();
+            uhd::atomic_full_barrier(); //the slot is done with before it is freed
+            _tail.write(this->next(tail));
+            uhd::atomic_full_barrier(); //the index is published before the flag is read
+            if (_push_waiting.read()) this->notify(_full_cond);
+            return true;
+        }
+
+        UHD_INLINE void pop_with_wait(elem_type &elem){
+            this->wait(&spsc_bounded_buffer_detail<elem_type>::not_empty, _pop_waiting, _empty_cond, -1.0);
+            this->pop_with_haste(elem);
+        }
+
+        UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
+            if (this->pop_with_haste(elem)) return true;
+            if (timeout <= 0) return false; //non-blocking, skip the spin and condition
+            if (not this->wait(
+                &spsc_bounded_buffer_detail<elem_type>::not_empty, _pop_waiting, _empty_cond, timeout
+            )) return false;
+            return this->pop_with_haste(elem);
+        }
+
+    private:
+        //! The number of checks before a waiter blocks on the condition
+        static const size_t SPIN_COUNT = 1000;
+
+        std::vector<elem_type> _buffer;
+        uhd::atomic_uint32_t _head, _tail;
+        uhd::atomic_uint32_t _push_waiting, _pop_waiting;
+        boost::mutex _mutex;
+        boost::condition _empty_cond, _full_cond;
+
+        bool not_full(void){return this->next(_head.read()) != _tail.read();}
+        bool not_empty(void){return _tail.read() != _head.read();}
+
+        UHD_INLINE boost::uint32_t next(const boost::uint32_t index) const{
+            return (index + 1 == _buffer.size())? 0 : index + 1;
+        }
+
+        /*!
+         * The waiter flag is written before the waiter checks the condition,
+         * and the index is written before the other side reads the flag.
+         * A full barrier follows both writes, so either the waiter sees the
+         * change, or the other side sees the flag and notifies under the lock.
+         */
+        UHD_INLINE void notify(boost::condition &cond){
+            boost::mutex::scoped_lock lock(_mutex);
+            cond.notify_one();
+        }
+
+        /*!
+         * Spin-then-block wait for the ready condition:
+         * Check the condition a few times without any system calls,
+         * then block on the condition variable until ready or timeout.
+         * A negative timeout waits forever.
+         */
+        UHD_INLINE bool wait(
+            bool (spsc_bounded_buffer_detail<elem_type>::*ready)(void),
+            uhd::atomic_uint32_t &waiting, boost::condition &cond, double timeout
+        ){
+            for (size_t i = 0; i < SPIN_COUNT; i++){
+                if ((this->*ready)()) return true;
+            }
+            const boost::system_time exit_time = boost::get_system_time() + to_time_dur(timeout);
+            boost::mutex::scoped_lock lock(_mutex);
+            waiting.write(1);
+            uhd::atomic_full_barrier(); //the flag is published before the check
+            while (not (this->*ready)()){
+                if (timeout < 0) cond.wait(lock);
+                else if (not cond.timed_wait(lock, exit_time)) break;
+            }
+            waiting.write(0);
+            return (this->*ready)();
+        }
+
+        static UHD_INLINE boost::posix_time::time_duration to_time_dur(double timeout){
+            return boost::posix_time::microseconds(long(timeout*1e6));
+        }
+
+    };
 }}} //namespace
 
 #endif /* INCLUDED_UHD_TRANSPORT_BOUNDED_BUFFER_IPP */
@@ -19,8 +19,11 @@
 #define INCLUDED_UHD_TRANSPORT_BUFFER_POOL_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/types/device_addr.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <string>
 
 namespace uhd{ namespace transport{
 
@@ -33,6 +36,62 @@ namespace uhd{ namespace transport{
         typedef boost::shared_ptr<buffer_pool> sptr;
         typedef void * ptr_type;
 
+        /*!
+         * A memory provider allocates the memory behind a buffer pool,
+         * ex: pinned host memory for a GPU or a shared memory segment.
+         * The provider returns at least num_bytes of memory (or throws);
+         * the deleter of the pointer releases the memory
+         * once the pool and every buffer in it are released.
+         */
+        typedef boost::function<boost::shared_ptr<void>(size_t num_bytes)> mem_provider_type;
+
+        /*!
+         * Register a memory provider under a name.
+         * The transport hint "<prefix>_mem_provider=<name>" selects it.
+         * Registering a name again replaces the previous provider.
+         * \param name the name for the hints
+         * \param provider the memory provider function
+         */
+        static void register_mem_provider(const std::string &name, const mem_provider_type &provider);
+
+        /*!
+         * The allocation policy for the memory behind a buffer pool.
+         * Each option is a request: when the platform cannot honor it,
+         * the pool prints a warning and falls back to normal memory.
+         */
+        struct UHD_API alloc_policy_t{
+            //! Back the pool with 2MB hugepages (linux only)
+            bool hugepages;
+
+            //! The preferred NUMA node for the pages or -1 for no preference (linux only)
+            int numa_node;
+
+            //! Lock the pages into memory so they are never swapped
+            bool lock;
+
+            /*!
+             * The provider of the memory or empty to allocate it here.
+             * The memory of a provider is used as is:
+             * the hugepages, NUMA node, and lock options do not apply.
+             */
+            mem_provider_type mem_provider;
+
+            //! Create a default policy: normal pages, any node, unlocked
+            alloc_policy_t(void);
+
+            /*!
+             * Create a policy from transport hints:
+             * Reads the keys "<prefix>_hugepages", "<prefix>_numa_node",
+             * "<prefix>_mlock", and "<prefix>_mem_provider",
+             * where prefix is "recv" or "send".
+             * \param hints the transport hints
+             * \param prefix the direction prefix of the hint keys
+             * \return a new allocation policy
+             * \throw uhd::key_error for an unregistered memory provider
+             */
+            static alloc_policy_t from_hints(const device_addr_t &hints, const std::string &prefix);
+        };
+
         /*!
          * Make a new buffer pool.
          * \param num_buffs the number of buffers to allocate
@@ -46,6 +105,21 @@ namespace uhd{ namespace transport{
             const size_t alignment = 16
         );
 
+        /*!
+         * Make a new buffer pool with an allocation policy.
+         * \param num_buffs the number of buffers to allocate
+         * \param buff_size the size of each buffer in bytes
+         * \param alignment the alignment boundary in bytes
+         * \param policy the allocation policy for the memory
+         * \return a new buffer pool buff_size X num_buffs
+         */
+        static sptr make(
+            const size_t num_buffs,
+            const size_t buff_size,
+            const size_t alignment,
+            const alloc_policy_t &policy
+        );
+
         //! Get a pointer to the buffer start at the specified index
         virtual ptr_type at(const size_t index) const = 0;
 
@@ -31,6 +31,7 @@ namespace uhd{ namespace transport{
         std::string inet;
         std::string mask;
         std::string bcast;
+        std::string name; //!< the interface name, empty when unknown
     };
 
     /*!
@@ -40,6 +41,32 @@ namespace uhd{ namespace transport{
      */
     UHD_API std::vector<if_addrs_t> get_if_addrs(void);
 
+    /*!
+     * The locality of a network interface on the host:
+     * the NUMA node and the CPUs that the NIC is attached to.
+     */
+    struct UHD_API if_locality_t{
+        //! The interface name (ex: eth2), empty when unknown
+        std::string name;
+
+        //! The NUMA node of the NIC, -1 when unknown
+        int numa_node;
+
+        //! The CPUs local to the NIC, empty when unknown
+        std::vector<size_t> cpus;
+
+        if_locality_t(void);
+    };
+
+    /*!
+     * Get the locality of the network interface on the route to an address.
+     * The interface is the one the host routes a UDP socket through,
+     * the NUMA node and CPUs are read from sysfs (linux only).
+     * \param addr the remote IPv4 address or host name
+     * \return the locality, with empty fields when unknown
+     */
+    UHD_API if_locality_t get_if_locality(const std::string &addr);
+
 }} //namespace
 
 
@@ -0,0 +1,119 @@
+//
+// Copyright 2010 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_SHM_FANOUT_HPP
+#define INCLUDED_UHD_TRANSPORT_SHM_FANOUT_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/metadata.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * The writer side of a shared memory fan-out ring.
+ * One process receives samples directly into the ring frames,
+ * and any number of local reader processes consume them.
+ * The writer never waits on the readers:
+ * a reader that falls behind by a whole ring gets an overflow.
+ */
+class UHD_API shm_fanout_writer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<shm_fanout_writer> sptr;
+
+    /*!
+     * Make a new shared memory ring.
+     * An old ring with the same name is replaced.
+     * The ring is removed when the writer is destroyed,
+     * readers that are already attached keep their mapping.
+     * \param name the shared memory object name
+     * \param frame_size the maximum number of bytes per frame
+     * \param num_frames the number of frames in the ring
+     * \return a new writer
+     */
+    static sptr make(const std::string &name, size_t frame_size, size_t num_frames);
+
+    /*!
+     * Get the memory for the next frame.
+     * The frame is hidden from the readers until it is committed.
+     * \return a pointer to frame_size bytes
+     */
+    virtual void *get_frame_buff(void) = 0;
+
+    /*!
+     * Publish the frame from get_frame_buff() to the readers.
+     * \param num_bytes the number of bytes written to the frame
+     * \param metadata the receive metadata for this frame
+     */
+    virtual void commit(size_t num_bytes, const rx_metadata_t &metadata) = 0;
+
+    //! Get the maximum number of bytes per frame
+    virtual size_t get_frame_size(void) const = 0;
+};
+
+/*!
+ * The reader side of a shared memory fan-out ring.
+ * The ring is mapped read-only, and each reader keeps its own cursor.
+ * Frames are read in place, without a copy.
+ */
+class UHD_API shm_fanout_reader : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<shm_fanout_reader> sptr;
+
+    /*!
+     * Attach to an existing shared memory ring.
+     * The reader starts at the newest frame.
+     * \param name the shared memory object name
+     * \return a new reader
+     */
+    static sptr make(const std::string &name);
+
+    /*!
+     * Get the next frame in the ring.
+     * On a timeout, the metadata error code is ERROR_CODE_TIMEOUT.
+     * When the writer has lapped this reader, the frames are lost,
+     * the error code is ERROR_CODE_OVERFLOW,
+     * and the cursor jumps forward to the middle of the ring.
+     * \param num_bytes set to the number of bytes in the frame
+     * \param metadata set to the frame metadata or error code
+     * \param timeout the timeout in seconds to wait for a frame
+     * \return a pointer to the frame memory or NULL on error
+     */
+    virtual const void *get_frame(
+        size_t &num_bytes, rx_metadata_t &metadata, double timeout = 0.1
+    ) = 0;
+
+    /*!
+     * Is the last frame from get_frame() still intact?
+     * Check after using the frame memory in place:
+     * if the writer lapped the reader, the frame was overwritten.
+     * \return true if the frame was not touched by the writer
+     */
+    virtual bool frame_valid(void) = 0;
+
+    //! Get the number of overflows seen by this reader
+    virtual size_t get_num_overflows(void) const = 0;
+
+    //! Get the maximum number of bytes per frame
+    virtual size_t get_frame_size(void) const = 0;
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_UHD_TRANSPORT_SHM_FANOUT_HPP */
@@ -0,0 +1,89 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_TRANSPORT_PROFILE_HPP
+#define INCLUDED_UHD_TRANSPORT_TRANSPORT_PROFILE_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <string>
+
+namespace uhd{ namespace transport{
+
+    /*!
+     * A transport profile holds the tuned transport hints of one device,
+     * ex: recv_frame_size=8000, num_recv_frames=128, recv_buff_size=50e6.
+     * The uhd_transport_tuner utility writes a profile for a device,
+     * and device::make() adds the profile hints to the device address.
+     * Hints given in the device address take precedence over the profile,
+     * and the address key transport_profile=0 skips the profile.
+     *
+     * Profiles are files in the directory named by the environment
+     * variable UHD_PROFILE_PATH, by default the .uhd/profiles directory
+     * in the user's home directory. A device is identified by its type
+     * and serial number, or its address when it reports no serial.
+     */
+
+    /*!
+     * Get the path of the transport profile for a device.
+     * \param dev_addr the device address from discovery
+     * \return the profile file path, empty when the device has no identity
+     */
+    UHD_API std::string get_transport_profile_path(const device_addr_t &dev_addr);
+
+    /*!
+     * Load the transport profile for a device.
+     * \param dev_addr the device address from discovery
+     * \return the profile hints, empty when there is no profile
+     */
+    UHD_API device_addr_t load_transport_profile(const device_addr_t &dev_addr);
+
+    /*!
+     * Save the transport profile for a device, replacing any old profile.
+     * \param dev_addr the device address from discovery
+     * \param profile the profile hints
+     * \return the path of the profile file
+     * \throw uhd::io_error when the profile cannot be written
+     */
+    UHD_API std::string save_transport_profile(
+        const device_addr_t &dev_addr, const device_addr_t &profile
+    );
+
+    /*!
+     * A named profile is a coherent set of hints for one goal,
+     * selected with the device address key profile=<name>:
+     *  - low_latency: small frames, few frames in flight, busy polling
+     *  - throughput: large frames, many frames, batched system calls
+     *  - low_cpu: large frames and batches, fewer threads, no spinning
+     * The hints depend on the device type, since each transport reads
+     * its own keys. device::make() fills in the hints of a named profile
+     * before the saved transport profile: the hints given in the device
+     * address take precedence over both.
+     */
+
+    /*!
+     * Get the hints of a named profile for a device type.
+     * \param name the profile name: low_latency, throughput, or low_cpu
+     * \param type the device type from discovery (ex: usrp2, b100)
+     * \return the profile hints, empty for a type without tuned hints
+     * \throw uhd::key_error for an unknown profile name
+     */
+    UHD_API device_addr_t get_named_transport_profile(const std::string &name, const std::string &type);
+
+}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_TRANSPORT_PROFILE_HPP */
@@ -20,6 +20,7 @@
 
 #include <uhd/config.hpp>
 #include <uhd/types/serial.hpp>
+#include <uhd/types/device_addr.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
@@ -43,10 +44,18 @@ public:
      * The address will be resolved, it can be a host name or ipv4.
      * The port will be resolved, it can be a port type or number.
      *
+     * The hint recv_busy_poll is the time in seconds to spin on the
+     * socket before a receive blocks: a reply that arrives within it
+     * is received without the wakeup latency of a blocked thread.
+     *
      * \param addr a string representing the destination address
      * \param port a string representing the destination port
+     * \param hints optional parameters to pass to the underlying transport
      */
-    static sptr make_connected(const std::string &addr, const std::string &port);
+    static sptr make_connected(
+        const std::string &addr, const std::string &port,
+        const device_addr_t &hints = device_addr_t()
+    );
 
     /*!
      * Make a new broadcasting udp transport:
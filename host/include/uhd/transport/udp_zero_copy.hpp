@@ -22,6 +22,7 @@
 #include <uhd/transport/zero_copy.hpp>
 #include <uhd/types/device_addr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
 
 namespace uhd{ namespace transport{
 
@@ -58,6 +59,22 @@ public:
         const std::string &port,
         const device_addr_t &hints = device_addr_t()
     );
+
+    /*!
+     * Get the local port of the socket, where the endpoint sends to.
+     * \return the udp port number on this host
+     */
+    virtual boost::uint16_t get_local_port(void) const = 0;
+
+    /*!
+     * Get the descriptor that the receive path waits on.
+     * It polls readable when get_recv_buff() has a frame,
+     * so one thread can wait on many transports.
+     * Drain with get_recv_buff(0.0) after it polls readable,
+     * since frames already taken in a batch do not poll.
+     * \return the native socket file descriptor
+     */
+    virtual int get_recv_fd(void) const = 0;
 };
 
 }} //namespace
@@ -0,0 +1,128 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_USB_GATEWAY_HPP
+#define INCLUDED_UHD_TRANSPORT_USB_GATEWAY_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/usb_control.hpp>
+#include <uhd/transport/usb_zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * A gateway carries a USB device over the network.
+ * The server runs on the host of the USB device,
+ * and the client side makes the same USB transports on a remote host:
+ * control requests are forwarded one at a time,
+ * and the bulk transfer frames of each pipe pass through unchanged,
+ * one UDP datagram per transfer frame.
+ *
+ * The server sends the received frames in batches.
+ * Sent frames are flow controlled with credits:
+ * the server reports the frames it committed to the device,
+ * and the client holds back frames beyond a window of the send frames.
+ */
+class UHD_API usb_gateway_server : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<usb_gateway_server> sptr;
+
+    /*!
+     * Make a new gateway server for a USB device.
+     * The server handles clients on its own threads until destroyed.
+     * Each pipe a client opens gets a UDP port of its own.
+     * \param handle the USB device to serve
+     * \param port the UDP port for the control requests
+     * \param hints optional parameters (send_batch: frames per send call)
+     * \return a new gateway server
+     */
+    static sptr make(
+        usb_device_handle::sptr handle,
+        const std::string &port = "49200",
+        const device_addr_t &hints = device_addr_t()
+    );
+
+    //! Get the number of frames relayed from the device to the clients
+    virtual size_t get_num_recv_frames(void) const = 0;
+
+    //! Get the number of frames relayed from the clients to the device
+    virtual size_t get_num_send_frames(void) const = 0;
+};
+
+//! The client side transports of a USB gateway
+namespace usb_gateway{
+
+    /*!
+     * Get the identity of the USB device behind a gateway.
+     * \param addr the gateway host name or ipv4
+     * \param port the gateway control port
+     * \param vid set to the USB vendor ID
+     * \param pid set to the USB product ID
+     * \return the USB device serial number
+     * \throw uhd::io_error when the gateway does not answer
+     */
+    UHD_API std::string get_device_info(
+        const std::string &addr, const std::string &port,
+        boost::uint16_t &vid, boost::uint16_t &pid
+    );
+
+    /*!
+     * Make a control transport through a gateway.
+     * Like usb_control::make, for the device behind the gateway.
+     * \param addr the gateway host name or ipv4
+     * \param port the gateway control port
+     * \return a new usb control transport
+     */
+    UHD_API usb_control::sptr make_control(
+        const std::string &addr, const std::string &port = "49200"
+    );
+
+    /*!
+     * Make a zero copy transport through a gateway.
+     * Like usb_zero_copy::make, for the device behind the gateway:
+     * the server opens the endpoints with the same hints.
+     * Client side hints: gateway_window, the send frames in flight
+     * before a credit from the server (default num_send_frames,
+     * at most what the socket buffer of the server holds).
+     * \param addr the gateway host name or ipv4
+     * \param port the gateway control port
+     * \param recv_interface an IN interface number
+     * \param recv_endpoint an IN endpoint number
+     * \param send_interface an OUT interface number
+     * \param send_endpoint an OUT endpoint number
+     * \param hints parameters for the transports on both sides
+     * \return a new zero copy transport
+     */
+    UHD_API usb_zero_copy::sptr make_zero_copy(
+        const std::string &addr,
+        const std::string &port,
+        const size_t recv_interface,
+        const size_t recv_endpoint,
+        const size_t send_interface,
+        const size_t send_endpoint,
+        const device_addr_t &hints = device_addr_t()
+    );
+
+} //namespace usb_gateway
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_UHD_TRANSPORT_USB_GATEWAY_HPP */
@@ -71,6 +71,8 @@ public:
      * When enable multiple receive packets is set to true,
      * the implementation inspects the vita length on transfers,
      * and may split a single transfer into multiple managed buffers.
+     * The managed buffers are views into the transfer memory (no copy);
+     * the transfer is resubmitted once all of its buffers are released.
      *
      * \param usb_zc a usb zero copy interface object
      * \param usb_frame_boundary bytes per frame
@@ -79,6 +81,33 @@ public:
     static sptr make_wrapper(
         sptr usb_zc, size_t usb_frame_boundary = 512
     );
+
+    /*!
+     * Tune the receive transfers to the stream rate.
+     * Only transports made with the xfer_latency hint are tuned:
+     * the transfer size follows the rate and the latency target,
+     * and the recv_frame_size hint becomes the largest size.
+     * The transfers in flight take the new size when resubmitted.
+     * Call this while no other thread uses the receive buffers.
+     * \param bytes_per_sec the rate of the receive stream
+     */
+    virtual void set_recv_rate(double bytes_per_sec) = 0;
+
+    /*!
+     * Tune the send transfers to the stream rate.
+     * The same rules as set_recv_rate apply to the send direction.
+     * \param bytes_per_sec the rate of the send stream
+     */
+    virtual void set_send_rate(double bytes_per_sec) = 0;
+
+    /*!
+     * Limit the number of send frames in flight to the device.
+     * A smaller window bounds the latency of the send stream;
+     * the frames above the window are held back until it grows.
+     * Call this while no other thread uses the send buffers.
+     * \param num_frames the window, clipped to [1, num send frames]
+     */
+    virtual void set_send_window(size_t num_frames) = 0;
 };
 
 }} //namespace
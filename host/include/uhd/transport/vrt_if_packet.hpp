@@ -99,6 +99,30 @@ namespace vrt{
         if_packet_info_t &if_packet_info
     );
 
+    /*!
+     * Unpack a vrt header with a fixed layout (big endian format).
+     * The layout has a stream id, integer and fractional time, and a trailer.
+     * Headers of another layout are handed to the generic unpacker.
+     * \param packet_buff memory to read the packed vrt header
+     * \param if_packet_info the if packet info (read/write)
+     */
+    UHD_API void if_hdr_unpack_be_sid_tsi_tsf_tlr(
+        const boost::uint32_t *packet_buff,
+        if_packet_info_t &if_packet_info
+    );
+
+    /*!
+     * Unpack a vrt header with a fixed layout (little endian format).
+     * The layout has a stream id, integer and fractional time, and a trailer.
+     * Headers of another layout are handed to the generic unpacker.
+     * \param packet_buff memory to read the packed vrt header
+     * \param if_packet_info the if packet info (read/write)
+     */
+    UHD_API void if_hdr_unpack_le_sid_tsi_tsf_tlr(
+        const boost::uint32_t *packet_buff,
+        if_packet_info_t &if_packet_info
+    );
+
 } //namespace vrt
 
 }} //namespace
@@ -0,0 +1,85 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_VRT_RELAY_HPP
+#define INCLUDED_UHD_TRANSPORT_VRT_RELAY_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/device.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * Relay received VRT frames to UDP destinations without conversion.
+ * The frames from a recv view are sent whole, header and all,
+ * straight from transport memory to every destination.
+ * Frames are batched into one sendmmsg call where supported.
+ *
+ * The packet count in each header is rewritten per channel,
+ * so the relayed stream counts up without the packets the receive
+ * handler consumed. A gap in the samples skips a count, so the
+ * receivers of the relay see a sequence error where samples were lost.
+ */
+class UHD_API vrt_relay : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<vrt_relay> sptr;
+
+    /*!
+     * Make a new relay.
+     * The addresses will be resolved, they can be host names or ipv4,
+     * each with an optional ":port" to override the default port.
+     * The relay holds up to batch_size views of frames until it sends,
+     * so keep the batch well below the number of receive frames.
+     * \param addrs the destination addresses
+     * \param port the default destination port
+     * \param batch_size the views to hold per send call
+     * \return a new relay
+     */
+    static sptr make(
+        const std::vector<std::string> &addrs,
+        const std::string &port,
+        size_t batch_size = 16
+    );
+
+    /*!
+     * Queue the frames of a view to the destinations.
+     * The relay keeps a reference to the frames until they are sent,
+     * so the view may be released right after this call.
+     * \param view a view from device::recv_view() with frames
+     */
+    virtual void relay(const device::recv_view_t &view) = 0;
+
+    //! Skip a packet count on every channel to mark lost samples
+    virtual void mark_gap(void) = 0;
+
+    //! Send the queued frames now
+    virtual void flush(void) = 0;
+
+    //! Get the number of frames sent to each destination
+    virtual size_t get_num_frames(void) const = 0;
+
+    //! Get the number of datagrams the kernel did not take
+    virtual size_t get_num_dropped(void) const = 0;
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_UHD_TRANSPORT_VRT_RELAY_HPP */
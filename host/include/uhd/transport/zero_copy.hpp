@@ -19,18 +19,51 @@
 #define INCLUDED_UHD_TRANSPORT_ZERO_COPY_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/atomic.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/intrusive_ptr.hpp>
+#include <boost/cstdint.hpp>
+#include <vector>
 
 namespace uhd{ namespace transport{
 
-    //! Create smart pointer to a reusable managed buffer
-    template <typename T> UHD_INLINE boost::intrusive_ptr<T> make_managed_buffer(T *p){
+    /*!
+     * The reference count policies of the managed buffers.
+     * The local policy counts with plain integer operations:
+     * the references of a buffer stay in one thread at a time.
+     * The shared policy counts with atomic operations:
+     * the references may be copied and dropped in several threads,
+     * and the release or commit runs in the thread that drops the last one.
+     */
+    struct managed_buffer_local_refs{static const bool atomic = false;};
+    struct managed_buffer_shared_refs{static const bool atomic = true;};
+
+    //! Create smart pointer to a reusable managed buffer with a reference count policy
+    template <typename ref_policy, typename T> UHD_INLINE boost::intrusive_ptr<T> make_managed_buffer(T *p){
         p->_ref_count = 1; //reset the count to 1 reference
+        p->_ref_atomic = ref_policy::atomic;
         return boost::intrusive_ptr<T>(p, false);
     }
 
+    //! Create smart pointer to a reusable managed buffer with local references
+    template <typename T> UHD_INLINE boost::intrusive_ptr<T> make_managed_buffer(T *p){
+        return make_managed_buffer<managed_buffer_local_refs>(p);
+    }
+
+    //! Add a reference under the policy of the buffer
+    template <typename T> UHD_INLINE void managed_buffer_add_ref(T *p){
+        if (p->_ref_atomic) UHD_IPC_DETAIL::atomic_inc32(&p->_ref_count);
+        else ++(p->_ref_count);
+    }
+
+    //! Drop a reference under the policy of the buffer, true for the last one
+    template <typename T> UHD_INLINE bool managed_buffer_drop_ref(T *p){
+        if (p->_ref_atomic) return UHD_IPC_DETAIL::atomic_dec32(&p->_ref_count) == 1;
+        return --(p->_ref_count) == 0;
+    }
+
     /*!
      * A managed receive buffer:
      * Contains a reference to transport-managed memory,
@@ -40,6 +73,8 @@ namespace uhd{ namespace transport{
     public:
         typedef boost::intrusive_ptr<managed_recv_buffer> sptr;
 
+        managed_recv_buffer(void): _ref_count(0), _ref_atomic(false){/* NOP */}
+
         /*!
          * Signal to the transport that we are done with the buffer.
          * This should be called to release the buffer to the transport object.
@@ -63,19 +98,40 @@ namespace uhd{ namespace transport{
             return this->get_size();
         }
 
+        /*!
+         * Get the time the frame was received by the host,
+         * from transports with receive timestamping enabled.
+         * The time is on the system realtime clock, or the NIC clock for hardware timestamps.
+         * \param time set to the receive timestamp when there is one
+         * \return true when the frame has a receive timestamp
+         */
+        virtual bool get_recv_timestamp(time_spec_t &time) const{
+            (void)time;
+            return false;
+        }
+
+        /*!
+         * Count the references to this buffer atomically until it is released,
+         * so that references can be handed to other threads.
+         * Call before the first reference leaves the current thread.
+         */
+        inline void enable_shared_refs(void){
+            _ref_atomic = true;
+        }
+
     private:
         virtual const void *get_buff(void) const = 0;
         virtual size_t get_size(void) const = 0;
 
-    public: int _ref_count;
+    public: boost::uint32_t _ref_count; bool _ref_atomic;
     };
 
     UHD_INLINE void intrusive_ptr_add_ref(managed_recv_buffer *p){
-        ++(p->_ref_count);
+        managed_buffer_add_ref(p);
     }
 
     UHD_INLINE void intrusive_ptr_release(managed_recv_buffer *p){
-        if (--(p->_ref_count) == 0) p->release();
+        if (managed_buffer_drop_ref(p)) p->release();
     }
 
     /*!
@@ -87,6 +143,8 @@ namespace uhd{ namespace transport{
     public:
         typedef boost::intrusive_ptr<managed_send_buffer> sptr;
 
+        managed_send_buffer(void): _ref_count(0), _ref_atomic(false){/* NOP */}
+
         /*!
          * Signal to the transport that we are done with the buffer.
          * This should be called to commit the write to the transport object.
@@ -111,21 +169,147 @@ namespace uhd{ namespace transport{
             return this->get_size();
         }
 
+        /*!
+         * Count the references to this buffer atomically until it is committed,
+         * so that references can be handed to other threads.
+         * Call before the first reference leaves the current thread.
+         */
+        inline void enable_shared_refs(void){
+            _ref_atomic = true;
+        }
+
     private:
         virtual void *get_buff(void) const = 0;
         virtual size_t get_size(void) const = 0;
 
-    public: int _ref_count;
+    public: boost::uint32_t _ref_count; bool _ref_atomic;
     };
 
     UHD_INLINE void intrusive_ptr_add_ref(managed_send_buffer *p){
-        ++(p->_ref_count);
+        managed_buffer_add_ref(p);
     }
 
     UHD_INLINE void intrusive_ptr_release(managed_send_buffer *p){
-        if (--(p->_ref_count) == 0) p->commit(0);
+        if (managed_buffer_drop_ref(p)) p->commit(0);
     }
 
+    /*!
+     * Performance counters for a zero-copy interface.
+     * The counters accumulate over the lifetime of the transport.
+     * They are plain integers updated by the thread that streams
+     * through the transport, so they are cheap enough to leave on;
+     * a reader in another thread sees recent but approximate values.
+     */
+    struct zero_copy_stats_t{
+        //! The number of receive buffers handed out
+        boost::uint64_t recv_frames;
+
+        //! The number of bytes in the receive buffers handed out
+        boost::uint64_t recv_bytes;
+
+        //! The number of calls to get a receive buffer that timed out
+        boost::uint64_t recv_timeouts;
+
+        //! The number of receive buffers currently held by callers
+        size_t recv_outstanding;
+
+        //! The most receive buffers held by callers at once
+        size_t recv_high_water;
+
+        //! The number of send buffers handed out
+        boost::uint64_t send_frames;
+
+        //! The number of bytes committed to send buffers
+        boost::uint64_t send_bytes;
+
+        //! The number of calls to get a send buffer that timed out
+        boost::uint64_t send_timeouts;
+
+        //! The total time in seconds spent waiting for a free send buffer
+        double send_wait_time;
+
+        //! The number of send buffers currently held by callers
+        size_t send_outstanding;
+
+        //! The most send buffers held by callers at once
+        size_t send_high_water;
+
+        //! The number of receive buffers with a receive timestamp
+        boost::uint64_t recv_timestamps;
+
+        //! The total time in seconds from the receive timestamps to the transport handing out the buffers
+        double recv_queue_time;
+
+        //! The longest time in seconds from a receive timestamp to the transport handing out the buffer
+        double recv_queue_time_max;
+
+        zero_copy_stats_t(void):
+            recv_frames(0), recv_bytes(0), recv_timeouts(0),
+            recv_outstanding(0), recv_high_water(0),
+            send_frames(0), send_bytes(0), send_timeouts(0), send_wait_time(0.0),
+            send_outstanding(0), send_high_water(0),
+            recv_timestamps(0), recv_queue_time(0.0), recv_queue_time_max(0.0)
+        {
+            /* NOP */
+        }
+
+        //! Count a receive buffer handed out with num_bytes
+        UHD_INLINE void claim_recv(size_t num_bytes){
+            recv_frames++;
+            recv_bytes += num_bytes;
+            if (++recv_outstanding > recv_high_water) recv_high_water = recv_outstanding;
+        }
+
+        //! Count a receive buffer released by the caller
+        UHD_INLINE void release_recv(void){
+            recv_outstanding--;
+        }
+
+        //! Count a receive timestamp that was queue_time seconds old when handed out
+        UHD_INLINE void timestamp_recv(double queue_time){
+            recv_timestamps++;
+            recv_queue_time += queue_time;
+            if (queue_time > recv_queue_time_max) recv_queue_time_max = queue_time;
+        }
+
+        //! Count a send buffer handed out
+        UHD_INLINE void claim_send(void){
+            send_frames++;
+            if (++send_outstanding > send_high_water) send_high_water = send_outstanding;
+        }
+
+        //! Count a send buffer committed by the caller with num_bytes
+        UHD_INLINE void commit_send(size_t num_bytes){
+            send_bytes += num_bytes;
+            send_outstanding--;
+        }
+    };
+
+    /*!
+     * A descriptor to wait on for transport readiness.
+     * The descriptor and events are suitable for poll(2),
+     * select(2), or an epoll event loop: wait until the
+     * descriptor reports any of the given poll events,
+     * then get buffers with a zero timeout until none remain.
+     * The descriptor may wake up spuriously.
+     */
+    struct UHD_API poll_fd_t{
+        //! The file descriptor to wait on
+        int fd;
+
+        //! The poll(2) events to wait for (POLLIN, POLLOUT...)
+        short events;
+
+        poll_fd_t(int fd = -1, short events = 0):
+            fd(fd), events(events)
+        {
+            /* NOP */
+        }
+    };
+
+    //! A set of descriptors, ready when any one is ready
+    typedef std::vector<poll_fd_t> poll_fds_t;
+
     /*!
      * A zero-copy interface for transport objects.
      * Provides a way to get send and receive buffers
@@ -177,6 +361,41 @@ namespace uhd{ namespace transport{
          */
         virtual size_t get_send_frame_size(void) const = 0;
 
+        /*!
+         * Flush committed send buffers held back by the transport.
+         * A transport may defer the actual send of committed buffers
+         * so that it can send them in batches; this call forces out
+         * any such buffers. The default implementation does nothing.
+         */
+        virtual void flush_send_buffs(void){
+            /* NOP */
+        }
+
+        /*!
+         * Get the performance counters of this transport.
+         * Use the counters to size the number of frames and buffers:
+         * a high water mark near the number of frames, timeouts,
+         * or a large send wait time all indicate too few buffers.
+         * The default implementation returns zeroed counters.
+         * \return a copy of the current counters
+         */
+        virtual zero_copy_stats_t get_stats(void) const{
+            return zero_copy_stats_t();
+        }
+
+        /*!
+         * Get the descriptors that signal receive readiness.
+         * When any descriptor is ready, get_recv_buff() with a zero
+         * timeout may return a buffer; call it until it returns null
+         * before waiting on the descriptors again.
+         * The default implementation returns an empty set,
+         * meaning the transport cannot be polled.
+         * \return a set of poll descriptors
+         */
+        virtual poll_fds_t get_recv_poll_fds(void) const{
+            return poll_fds_t();
+        }
+
     };
 
 }} //namespace
@@ -21,11 +21,56 @@
 #include <uhd/config.hpp>
 #include <vector>
 #include <list>
+#include <map>
+#include <string>
 
 namespace uhd{
 
+    namespace dict_detail{
+
+        //! Find keys by scanning the container (keys only need operator==)
+        template <typename Key, typename List> struct scan_index{
+            typedef typename List::iterator iterator;
+            typedef typename List::const_iterator const_iterator;
+            iterator find(List &list, const Key &key) const;
+            const_iterator find(const List &list, const Key &key) const;
+            void insert(List &, const Key &, iterator){}
+            void erase(const Key &){}
+            void rebuild(List &){}
+        };
+
+        /*!
+         * Find keys through an ordered map of container iterators.
+         * A scan beats the map for a few keys, and copies are cheaper
+         * without a map, so the map is only built for larger containers.
+         */
+        template <typename Key, typename List> struct map_index : scan_index<Key, List>{
+            typedef typename List::iterator iterator;
+            typedef typename List::const_iterator const_iterator;
+            static const std::size_t threshold = 16; //number of items to start the map
+            iterator find(List &list, const Key &key) const;
+            const_iterator find(const List &list, const Key &key) const;
+            void insert(List &list, const Key &key, iterator it);
+            void erase(const Key &key){_map.erase(key);}
+            void rebuild(List &list);
+            std::map<Key, iterator> _map; //empty until the threshold
+        };
+
+        //! Select the index for a key type, string keys are indexed
+        template <typename Key, typename List> struct select_index{
+            typedef scan_index<Key, List> type;
+        };
+        template <typename List> struct select_index<std::string, List>{
+            typedef map_index<std::string, List> type;
+        };
+
+    } //namespace dict_detail
+
     /*!
      * A templated dictionary class with a python-like interface.
+     * The items are kept in insertion order.
+     * Dictionaries with string keys also keep an ordered index,
+     * so that key lookups are logarithmic instead of linear.
      */
     template <typename Key, typename Val> class dict{
     public:
@@ -37,12 +82,19 @@ namespace uhd{
         /*!
          * Input iterator constructor:
          * Makes boost::assign::map_list_of work.
+         * The first item of a key is kept, later duplicates are dropped.
          * \param first the begin iterator
          * \param last the end iterator
          */
         template <typename InputIterator>
         dict(InputIterator first, InputIterator last);
 
+        //! Copy constructor: the index is rebuilt for the new items
+        dict(const dict &other);
+
+        //! Assignment operator: the index is rebuilt for the new items
+        dict &operator=(const dict &other);
+
         /*!
          * Get the number of elements in this dict.
          * \return the number of elements
@@ -119,7 +171,10 @@ namespace uhd{
 
     private:
         typedef std::pair<Key, Val> pair_t;
-        std::list<pair_t> _map; //private container
+        typedef std::list<pair_t> list_t;
+        list_t _map; //private container, in insertion order
+        typename dict_detail::select_index<Key, list_t>::type _index;
+        void rebuild_index(void);
     };
 
 } //namespace uhd
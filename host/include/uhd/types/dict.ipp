@@ -41,16 +41,88 @@ namespace uhd{
         };
     } // namespace /*anon*/
 
+    namespace dict_detail{
+
+        template <typename Key, typename List>
+        typename List::iterator scan_index<Key, List>::find(List &list, const Key &key) const{
+            iterator it = list.begin();
+            while (it != list.end() and not (it->first == key)) ++it;
+            return it;
+        }
+
+        template <typename Key, typename List>
+        typename List::const_iterator scan_index<Key, List>::find(const List &list, const Key &key) const{
+            const_iterator it = list.begin();
+            while (it != list.end() and not (it->first == key)) ++it;
+            return it;
+        }
+
+        template <typename Key, typename List>
+        typename List::iterator map_index<Key, List>::find(List &list, const Key &key) const{
+            if (_map.empty()) return scan_index<Key, List>::find(list, key);
+            typename std::map<Key, iterator>::const_iterator it = _map.find(key);
+            return (it == _map.end())? list.end() : it->second;
+        }
+
+        template <typename Key, typename List>
+        typename List::const_iterator map_index<Key, List>::find(const List &list, const Key &key) const{
+            if (_map.empty()) return scan_index<Key, List>::find(list, key);
+            typename std::map<Key, iterator>::const_iterator it = _map.find(key);
+            return (it == _map.end())? list.end() : const_iterator(it->second);
+        }
+
+        template <typename Key, typename List>
+        void map_index<Key, List>::insert(List &list, const Key &key, iterator it){
+            if (not _map.empty()) _map.insert(std::make_pair(key, it));
+            else if (list.size() > threshold) this->rebuild(list);
+        }
+
+        template <typename Key, typename List>
+        void map_index<Key, List>::rebuild(List &list){
+            _map.clear();
+            if (list.size() <= threshold) return;
+            //insert keeps the first item of a key, as the scan would find
+            for (iterator it = list.begin(); it != list.end(); ++it){
+                _map.insert(std::make_pair(it->first, it));
+            }
+        }
+
+    } //namespace dict_detail
+
     template <typename Key, typename Val>
     dict<Key, Val>::dict(void){
         /* NOP */
     }
 
     template <typename Key, typename Val> template <typename InputIterator>
-    dict<Key, Val>::dict(InputIterator first, InputIterator last):
-        _map(first, last)
+    dict<Key, Val>::dict(InputIterator first, InputIterator last){
+        //the first item of a key is kept, a later duplicate is dropped
+        for (; first != last; ++first){
+            if (this->has_key(first->first)) continue;
+            _map.push_back(pair_t(first->first, first->second));
+            _index.insert(_map, first->first, --_map.end());
+        }
+    }
+
+    template <typename Key, typename Val>
+    dict<Key, Val>::dict(const dict &other):
+        _map(other._map)
     {
-        /* NOP */
+        this->rebuild_index();
+    }
+
+    template <typename Key, typename Val>
+    dict<Key, Val> &dict<Key, Val>::operator=(const dict &other){
+        if (this != &other){
+            _map = other._map;
+            this->rebuild_index();
+        }
+        return *this;
+    }
+
+    template <typename Key, typename Val>
+    void dict<Key, Val>::rebuild_index(void){
+        _index.rebuild(_map);
     }
 
     template <typename Key, typename Val>
@@ -78,26 +150,19 @@ namespace uhd{
 
     template <typename Key, typename Val>
     bool dict<Key, Val>::has_key(const Key &key) const{
-        BOOST_FOREACH(const pair_t &p, _map){
-            if (p.first == key) return true;
-        }
-        return false;
+        return _index.find(_map, key) != _map.end();
     }
 
     template <typename Key, typename Val>
     const Val &dict<Key, Val>::get(const Key &key, const Val &other) const{
-        BOOST_FOREACH(const pair_t &p, _map){
-            if (p.first == key) return p.second;
-        }
+        typename list_t::const_iterator it = _index.find(_map, key);
+        if (it != _map.end()) return it->second;
         return other;
     }
 
     template <typename Key, typename Val>
     const Val &dict<Key, Val>::get(const Key &key) const{
-        BOOST_FOREACH(const pair_t &p, _map){
-            if (p.first == key) return p.second;
-        }
-        throw key_not_found<Key, Val>(key);
+        return (*this)[key];
     }
 
     template <typename Key, typename Val>
@@ -107,32 +172,28 @@ namespace uhd{
 
     template <typename Key, typename Val>
     const Val &dict<Key, Val>::operator[](const Key &key) const{
-        BOOST_FOREACH(const pair_t &p, _map){
-            if (p.first == key) return p.second;
-        }
+        typename list_t::const_iterator it = _index.find(_map, key);
+        if (it != _map.end()) return it->second;
         throw key_not_found<Key, Val>(key);
     }
 
     template <typename Key, typename Val>
     Val &dict<Key, Val>::operator[](const Key &key){
-        BOOST_FOREACH(pair_t &p, _map){
-            if (p.first == key) return p.second;
-        }
+        typename list_t::iterator it = _index.find(_map, key);
+        if (it != _map.end()) return it->second;
         _map.push_back(std::make_pair(key, Val()));
+        _index.insert(_map, key, --_map.end());
         return _map.back().second;
     }
 
     template <typename Key, typename Val>
     Val dict<Key, Val>::pop(const Key &key){
-        typename std::list<pair_t>::iterator it;
-        for (it = _map.begin(); it != _map.end(); it++){
-            if (it->first == key){
-                Val val = it->second;
-                _map.erase(it);
-                return val;
-            }
-        }
-        throw key_not_found<Key, Val>(key);
+        typename list_t::iterator it = _index.find(_map, key);
+        if (it == _map.end()) throw key_not_found<Key, Val>(key);
+        Val val = it->second;
+        _map.erase(it);
+        _index.erase(key);
+        return val;
     }
 
 } //namespace uhd
@@ -86,6 +86,36 @@ namespace uhd{
             //! The packet could not be parsed.
             ERROR_CODE_BAD_PACKET   = 0xf
         } error_code;
+
+        /*!
+         * The number of samples lost just before the first sample.
+         * After an overflow, the first samples to arrive tell from their
+         * timestamp how many samples never reached the host.
+         * The count is set on those samples, and is zero otherwise.
+         */
+        size_t num_samps_lost;
+
+        //! Has a host receive timestamp?
+        bool has_recv_timestamp;
+
+        /*!
+         * When the host received the packet of the first sample:
+         * set by the udp transport with the recv_timestamping hint,
+         * on the system realtime clock (software) or the NIC clock (hardware).
+         * Compare it with the time spec and the return of recv()
+         * to split the latency between the device, the link and the host.
+         */
+        time_spec_t recv_timestamp;
+
+        /*!
+         * Does this buffer start at a new sample rate?
+         * Set on the first buffer after a rate change with a command time,
+         * a buffer never holds samples of both the old and the new rate.
+         */
+        bool has_rate_change;
+
+        //! The rate of samples per second of the samples in this buffer
+        double samp_rate;
     };
 
     /*!
@@ -0,0 +1,105 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TYPES_TICK_TIME_HPP
+#define INCLUDED_UHD_TYPES_TICK_TIME_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/operators.hpp>
+#include <ctime>
+
+namespace uhd{
+
+    /*!
+     * A tick_time_t holds a whole seconds count and a tick count
+     * in a clock domain with an integer number of ticks per second.
+     *
+     * Adding ticks to a tick_time_t is exact integer arithmetic,
+     * so timestamps that advance by whole ticks never drift.
+     * Convert to and from a time_spec_t at the API boundaries.
+     */
+    class UHD_API tick_time_t : boost::totally_ordered<tick_time_t>{
+    public:
+
+        /*!
+         * Create a tick_time_t from whole seconds and ticks.
+         * The tick count may be negative or span several seconds.
+         * \param full_secs the whole/integer seconds count
+         * \param ticks the ticks count past the whole seconds
+         * \param tick_rate the number of ticks per second (rounded to an integer)
+         */
+        tick_time_t(time_t full_secs = 0, boost::int64_t ticks = 0, double tick_rate = 1);
+
+        /*!
+         * Create a tick_time_t from a time_spec_t.
+         * The fractional seconds are rounded to the nearest tick.
+         * \param time the time spec to convert
+         * \param tick_rate the number of ticks per second (rounded to an integer)
+         */
+        tick_time_t(const time_spec_t &time, double tick_rate);
+
+        /*!
+         * Convert this tick_time_t into a time_spec_t.
+         * \return a time spec for the same time
+         */
+        time_spec_t to_time_spec(void) const;
+
+        //! Get the whole/integer part of the time in seconds
+        time_t get_full_secs(void) const{
+            return _full_secs;
+        }
+
+        //! Get the fractional part of the time in ticks
+        boost::int64_t get_ticks(void) const{
+            return _ticks;
+        }
+
+        //! Get the number of ticks per second
+        boost::int64_t get_tick_rate(void) const{
+            return _tick_rate;
+        }
+
+        //! Advance the time by a number of ticks
+        tick_time_t &operator+=(const boost::int64_t num_ticks){
+            _ticks += num_ticks;
+            //a small step only needs one compare, not a divide
+            if (_ticks >= _tick_rate or _ticks < 0) this->normalize();
+            return *this;
+        }
+
+        //! Move the time back by a number of ticks
+        tick_time_t &operator-=(const boost::int64_t num_ticks){
+            return *this += -num_ticks;
+        }
+
+    //private time storage details
+    private:
+        void normalize(void);
+        time_t _full_secs; boost::int64_t _ticks, _tick_rate;
+    };
+
+    //! Implement equality_comparable interface
+    UHD_API bool operator==(const tick_time_t &, const tick_time_t &);
+
+    //! Implement less_than_comparable interface
+    UHD_API bool operator<(const tick_time_t &, const tick_time_t &);
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_TYPES_TICK_TIME_HPP */
@@ -19,6 +19,7 @@
 #define INCLUDED_UHD_USRP_DBOARD_BASE_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/property_tree.hpp>
 #include <uhd/wax.hpp>
 #include <uhd/utils/pimpl.hpp>
 #include <boost/utility.hpp>
@@ -36,6 +37,8 @@ namespace uhd{ namespace usrp{
      *
      * A real subdevice is only physically connected one channel,
      * either only the I channel or only the Q channel.
+     *
+     * Deprecated: only used by the wax interface of dboard_base.
      */
     enum subdev_conn_t{
         SUBDEV_CONN_COMPLEX_IQ = 'C',
@@ -46,6 +49,8 @@ namespace uhd{ namespace usrp{
 
     /*!
      * Possible device subdev properties
+     *
+     * Deprecated: only used by the wax interface of dboard_base.
      */
     enum subdev_prop_t{
         SUBDEV_PROP_NAME,               //ro, std::string
@@ -83,11 +88,35 @@ public:
     dboard_base(ctor_args_t);
     virtual ~dboard_base(void);
 
-    //interface
-    virtual void rx_get(const wax::obj &key, wax::obj &val) = 0;
-    virtual void rx_set(const wax::obj &key, const wax::obj &val) = 0;
-    virtual void tx_get(const wax::obj &key, wax::obj &val) = 0;
-    virtual void tx_set(const wax::obj &key, const wax::obj &val) = 0;
+    /*!
+     * Deprecated wax interface for the rx and tx frontends.
+     * A dboard that creates no frontend properties in its constructor
+     * overrides these instead, and the dboard manager populates
+     * the frontend subtree with properties that forward to them.
+     * The defaults throw, a dboard should populate its subtrees.
+     */
+    virtual void rx_get(const wax::obj &key, wax::obj &val);
+    virtual void rx_set(const wax::obj &key, const wax::obj &val);
+    virtual void tx_get(const wax::obj &key, wax::obj &val);
+    virtual void tx_set(const wax::obj &key, const wax::obj &val);
+
+    /*!
+     * Create a frontend property with an initial value and a coercer.
+     * The initial value is stored as given and does not pass the coercer,
+     * only the later sets do. Use this when the hardware already has
+     * the initial value, or when the coercer warns that it cannot change.
+     * \param subtree the rx or tx frontend subtree
+     * \param path the path of the property in the subtree
+     * \param value the initial value
+     * \param coercer the coercer for the later sets
+     * \return a reference to the property
+     */
+    template <typename T> static property<T> &create_coerced(
+        property_tree::sptr subtree, const fs_path &path,
+        const T &value, const typename property<T>::coercer_type &coercer
+    ){
+        return subtree->create<T>(path).set(value).coerce(coercer);
+    }
 
 protected:
     std::string get_subdev_name(void);
@@ -95,6 +124,16 @@ protected:
     dboard_id_t get_rx_id(void);
     dboard_id_t get_tx_id(void);
 
+    /*!
+     * Get the subtree of the rx or tx frontend.
+     * The constructor creates the frontend properties in here,
+     * and registers the callbacks that drive the hardware.
+     * A rx dboard has no tx subtree and vice versa (null sptr).
+     */
+    property_tree::sptr get_rx_subtree(void);
+    property_tree::sptr get_tx_subtree(void);
+
+
 private:
     UHD_PIMPL_DECL(impl) _impl;
 };
@@ -125,10 +164,6 @@ public:
     rx_dboard_base(ctor_args_t);
 
     virtual ~rx_dboard_base(void);
-
-    //override here so the derived classes cannot
-    void tx_get(const wax::obj &key, wax::obj &val);
-    void tx_set(const wax::obj &key, const wax::obj &val);
 };
 
 /*!
@@ -143,10 +178,6 @@ public:
     tx_dboard_base(ctor_args_t);
 
     virtual ~tx_dboard_base(void);
-
-    //override here so the derived classes cannot
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
 };
 
 }} //namespace
@@ -192,6 +192,18 @@ public:
      */
     virtual boost::uint16_t get_gpio_out(unit_t unit);
 
+    /*!
+     * Begin a batch of pin control, ATR, and GPIO settings.
+     * The set calls of both units update the settings,
+     * and commit_gpio_update() writes them to the device at once.
+     * Calls may nest, the outermost commit writes.
+     * A device may also write each setting as it is called.
+     */
+    virtual void begin_gpio_update(void);
+
+    //! Write the settings of the batch begun with begin_gpio_update()
+    virtual void commit_gpio_update(void);
+
     /*!
      * Setup the GPIO debug mux.
      *
@@ -223,6 +235,23 @@ public:
         size_t num_bits
     ) = 0;
 
+    /*!
+     * Write a sequence of words to SPI bus peripheral.
+     * The words are written in order, as with one write_spi per word.
+     * A device may send the entire sequence in a single transaction.
+     *
+     * \param unit which unit, rx or tx
+     * \param config configuration settings
+     * \param data the words to write, each LSB first
+     * \param num_bits the number of bits in each word
+     */
+    virtual void write_spi_batch(
+        unit_t unit,
+        const spi_config_t &config,
+        const std::vector<boost::uint32_t> &data,
+        size_t num_bits
+    );
+
     /*!
      * Read and write data to SPI bus peripheral.
      *
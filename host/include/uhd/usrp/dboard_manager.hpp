@@ -31,17 +31,12 @@ namespace uhd{ namespace usrp{
 /*!
  * A daughter board subdev dboard_manager class.
  * Create subdev instances for each subdev on a dboard.
- * Provide wax::obj access to the subdevs inside.
+ * The subdevs populate the frontends of the dboard subtree.
  */
 class UHD_API dboard_manager : boost::noncopyable{
 public:
     typedef boost::shared_ptr<dboard_manager> sptr;
 
-    //! It does what it says...
-    static void populate_prop_tree_from_subdev(
-        property_tree::sptr subtree, wax::obj subdev
-    );
-
     //dboard constructor (each dboard should have a ::make with this signature)
     typedef dboard_base::sptr(*dboard_ctor_t)(dboard_base::ctor_args_t);
 
@@ -79,22 +74,59 @@ public:
 
     /*!
      * Make a new dboard manager.
+     * Each subdev driver creates the properties of its frontends
+     * under rx_frontends and tx_frontends of the given subtree.
+     *
+     * With deferred init, each subdev driver is constructed
+     * the first time it is used instead of in make.
+     * The common frontend properties exist up front and forward to the driver,
+     * the sensors and gains appear once the driver is constructed
+     * by a property access, such as enabling it through the subdev spec.
+     *
      * \param rx_dboard_id the id of the rx dboard
      * \param tx_dboard_id the id of the tx dboard
      * \param iface the custom dboard interface
+     * \param subtree the subtree of the dboard slot
+     * \param defer_init true to construct the subdevs on first use
      * \return an sptr to the new dboard manager
      */
     static sptr make(
         dboard_id_t rx_dboard_id,
         dboard_id_t tx_dboard_id,
-        dboard_iface::sptr iface
+        dboard_iface::sptr iface,
+        property_tree::sptr subtree,
+        bool defer_init = false
     );
 
+    /*!
+     * Make a new dboard manager without a subtree (deprecated).
+     * The subdevs are made by the call to populate_prop_tree,
+     * use the make with a subtree instead.
+     * \param rx_dboard_id the id of the rx dboard
+     * \param tx_dboard_id the id of the tx dboard
+     * \param iface the custom dboard interface
+     * \param defer_init true to construct the subdevs on first use
+     * \return an sptr to the new dboard manager
+     */
+    UHD_DEPRECATED static sptr make(
+        dboard_id_t rx_dboard_id,
+        dboard_id_t tx_dboard_id,
+        dboard_iface::sptr iface,
+        bool defer_init = false
+    );
+
+    /*!
+     * Populate the rx_frontends and tx_frontends of a dboard subtree (deprecated).
+     * Only for a manager from the make without a subtree,
+     * which makes the subdevs here.
+     * \param subtree the subtree of the dboard slot
+     * \throw uhd::runtime_error if the manager already has a subtree
+     */
+    virtual void populate_prop_tree(property_tree::sptr subtree) = 0;
+
     //dboard manager interface
     virtual prop_names_t get_rx_subdev_names(void) = 0;
     virtual prop_names_t get_tx_subdev_names(void) = 0;
-    virtual wax::obj get_rx_subdev(const std::string &subdev_name) = 0;
-    virtual wax::obj get_tx_subdev(const std::string &subdev_name) = 0;
 };
 
 }} //namespace
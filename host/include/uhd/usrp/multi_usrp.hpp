@@ -20,6 +20,7 @@
 
 #include <uhd/config.hpp>
 #include <uhd/device.hpp>
+#include <uhd/types/dict.hpp>
 #include <uhd/types/ranges.hpp>
 #include <uhd/types/stream_cmd.hpp>
 #include <uhd/types/clock_config.hpp>
@@ -30,7 +31,9 @@
 #include <uhd/usrp/dboard_iface.hpp>
 #include <uhd/usrp/mboard_iface.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
 #include <boost/utility.hpp>
+#include <utility>
 #include <vector>
 
 namespace uhd{ namespace usrp{
@@ -151,6 +154,18 @@ public:
      */
     virtual time_spec_t get_time_now(size_t mboard = 0) = 0;
 
+    /*!
+     * Get the current usrp time extrapolated with the host clock.
+     * The time registers are sampled about once a second,
+     * and calls between samples are answered on the host
+     * (see uhd::usrp::time_extrapolator for the error model).
+     * Use get_time_now() when an exact register read is needed.
+     * \param uncertainty set to the bound on the estimate error in seconds
+     * \param mboard which motherboard to query
+     * \return a timespec estimating the current usrp time
+     */
+    virtual time_spec_t get_time_now_extrapolated(double &uncertainty, size_t mboard = 0) = 0;
+
     /*!
      * Get the time when the last pps pulse occured.
      * \param mboard which motherboard to query
@@ -179,6 +194,8 @@ public:
      *
      * Note: Because this call sets the time on the "next" pps,
      * the seconds in the time spec should be current seconds + 1.
+     * The boards are set concurrently, so that the writes of all boards
+     * take about one control round trip before the pulse.
      *
      * \param time_spec the time to latch into the usrp device
      */
@@ -194,8 +211,10 @@ public:
      * This is a 2-step process, and will take at most 2 seconds to complete.
      * Upon completion, the times will be synchronized to the time provided.
      *
-     * - Step1: wait for the last pps time to transition to catch the edge
-     * - Step2: set the time at the next pps (synchronous for all boards)
+     * - Step1: wait for the last pps time to transition to catch the edge,
+     *   unless the time since the last pps leaves room to set before the next one
+     * - Step2: set the time at the next pps (synchronous for all boards),
+     *   then wait for that pps and check that board 0 latched the time
      *
      * \param time_spec the time to latch at the next pps after catching the edge
      */
@@ -209,6 +228,32 @@ public:
      */
     virtual bool get_time_synchronized(void) = 0;
 
+    /*!
+     * Set the time at which the control commands will take effect.
+     *
+     * Settings such as frequency and gain made after this call are queued
+     * in the device and take effect when its time reaches the command time.
+     * Readbacks are not timed, they see the current state of the device.
+     * Call clear_command_time() to hand the queued commands to the device
+     * and to make subsequent settings take effect immediately again.
+     *
+     * Timed commands are executed by the device's control processor,
+     * so they are accurate to the latency of its control loop,
+     * not to the sample clock.
+     * Not all devices support timed commands.
+     *
+     * \param time_spec the time at which the next commands will activate
+     * \param mboard which motherboard to set the config
+     */
+    virtual void set_command_time(const uhd::time_spec_t &time_spec, size_t mboard = ALL_MBOARDS) = 0;
+
+    /*!
+     * Clear the command time so future commands are sent ASAP.
+     * Commands queued since set_command_time() are sent to the device.
+     * \param mboard which motherboard to set the config
+     */
+    virtual void clear_command_time(size_t mboard = ALL_MBOARDS) = 0;
+
     /*!
      * Issue a stream command to the usrp device.
      * This tells the usrp to send samples into the host.
@@ -223,6 +268,21 @@ public:
      */
     virtual void issue_stream_cmd(const stream_cmd_t &stream_cmd, size_t chan = ALL_CHANS) = 0;
 
+    /*!
+     * Issue stream commands to several channels.
+     * The channels of each motherboard get their commands in order,
+     * and different motherboards get theirs concurrently,
+     * so all motherboards take about as long as the slowest one.
+     * Issuing to all channels (ALL_CHANS) goes through here.
+     *
+     * Use the returned time to size the margin of a timed start:
+     * the start time must be at least that far past the time now.
+     *
+     * \param stream_cmds pairs of channel index and stream command
+     * \return the worst-case seconds for a motherboard to take its commands
+     */
+    virtual double issue_stream_cmds(const std::vector<std::pair<size_t, stream_cmd_t> > &stream_cmds) = 0;
+
     /*!
      * Set the clock configuration for the usrp device.
      * This tells the usrp how to get a 10Mhz reference and PPS clock.
@@ -251,6 +311,20 @@ public:
      * \return a vector of sensor names
      */
     virtual std::vector<std::string> get_mboard_sensor_names(size_t mboard = 0) = 0;
+
+    /*!
+     * Get a snapshot of all sensors on a motherboard and its frontends.
+     * The keys are the sensor paths under the motherboard, such as
+     * "sensors/ref_locked" or "dboards/A/rx_frontends/0/sensors/lo_locked".
+     * Devices that support it read the sensor registers in one control transaction.
+     * A snapshot taken less than max_age seconds ago is returned from a cache,
+     * so several monitors sharing this object do not each read the hardware.
+     * A sensor that fails to read is left out with a warning.
+     * \param mboard the motherboard index 0 to M-1
+     * \param max_age the oldest cached snapshot to accept in seconds (0 to always read)
+     * \return a dictionary of sensor paths to sensor values
+     */
+    virtual dict<std::string, sensor_value_t> get_mboard_sensor_snapshot(size_t mboard = 0, double max_age = 0.0) = 0;
     
     /*!
      * Get a handle to the mboard_iface object which controls peripheral access.
@@ -299,8 +373,26 @@ public:
      */
     virtual void set_rx_rate(double rate, size_t chan = ALL_CHANS) = 0;
 
+    /*!
+     * Set the RX sample rate with resampler options.
+     * When the hardware cannot make the requested rate exactly,
+     * the dsp runs at the closest rate at or above it,
+     * and a polyphase resampler after conversion makes the rate on the host.
+     * The resampler works on complex float samples only.
+     * The options (all optional) are:
+     *  - resample: auto to resample when needed (default), or off
+     *  - taps_per_phase: the filter length of each phase (default 16)
+     *  - max_phases: the largest interpolation factor (default 256),
+     *    larger values approximate the rate ratio more closely
+     * \param rate the rate in Sps
+     * \param options the resampler options
+     * \param chan the channel index 0 to N-1
+     */
+    virtual void set_rx_rate(double rate, const device_addr_t &options, size_t chan = ALL_CHANS) = 0;
+
     /*!
      * Gets the RX sample rate.
+     * This is the host side rate when the resampler is on.
      * \param chan the channel index 0 to N-1
      * \return the rate in Sps
      */
@@ -316,6 +408,32 @@ public:
         const tune_request_t &tune_request, size_t chan = 0
     ) = 0;
 
+    /*!
+     * Make a tune plan for the RX center frequency.
+     * The channel is tuned once to resolve the tune request.
+     * The returned request sets the RF and DSP frequencies manually,
+     * so passing it to set_rx_freq() retunes without evaluating the policies.
+     * Daughterboards that cache their LO dividers also skip the divider search.
+     * Use this to pre-compute the frequencies of a hopping pattern.
+     * \param tune_request tune request instructions
+     * \param chan the channel index 0 to N-1
+     * \return a tune request with manual policies
+     */
+    virtual tune_request_t make_rx_tune_plan(
+        const tune_request_t &tune_request, size_t chan = 0
+    ) = 0;
+
+    /*!
+     * Set the RX center frequency on several channels.
+     * The channels of each motherboard are tuned in order,
+     * and different motherboards are tuned concurrently.
+     * \param tune_requests pairs of channel index and tune request
+     * \return the tune results in the order of the requests
+     */
+    virtual std::vector<tune_result_t> set_rx_freqs(
+        const std::vector<std::pair<size_t, tune_request_t> > &tune_requests
+    ) = 0;
+
     /*!
      * Get the RX center frequency.
      * \param chan the channel index 0 to N-1
@@ -344,6 +462,13 @@ public:
         return this->set_rx_gain(gain, ALL_GAINS, chan);
     }
 
+    /*!
+     * Set the overall RX gain on several channels.
+     * Different motherboards are set concurrently.
+     * \param gains pairs of channel index and gain in dB
+     */
+    virtual void set_rx_gains(const std::vector<std::pair<size_t, double> > &gains) = 0;
+
     /*!
      * Get the RX gain value for the specified gain element.
      * For an empty name, sum across all gain elements.
@@ -387,6 +512,13 @@ public:
      */
     virtual void set_rx_antenna(const std::string &ant, size_t chan = 0) = 0;
 
+    /*!
+     * Select the RX antennas on several subdevices.
+     * Different motherboards are set concurrently.
+     * \param ants pairs of channel index and antenna name
+     */
+    virtual void set_rx_antennas(const std::vector<std::pair<size_t, std::string> > &ants) = 0;
+
     /*!
      * Get the selected RX antenna on the subdevice.
      * \param chan the channel index 0 to N-1
@@ -458,6 +590,33 @@ public:
      */
     virtual std::vector<std::string> get_rx_sensor_names(size_t chan = 0) = 0;
 
+    //! The callback for an async LO lock wait, called with the lock status
+    typedef boost::function<void(bool locked)> lo_locked_callback_type;
+
+    /*!
+     * Wait for the LO on the RX subdevice to lock, ex: after a tune.
+     * The lo_locked sensor is read until it reports locked or the timeout expires.
+     * Each read is a control transaction, so the waiting does not sleep.
+     * A subdevice without an lo_locked sensor is reported as locked.
+     * \param timeout the maximum time to wait in seconds
+     * \param chan the channel index 0 to N-1
+     * \return true when the LO locked within the timeout
+     */
+    virtual bool wait_rx_lo_locked(double timeout = 0.1, size_t chan = 0) = 0;
+
+    /*!
+     * Wait for the LO on the RX subdevice to lock in the background.
+     * The call returns right away. A worker thread performs the waits
+     * in the order they were requested, and calls the callback
+     * with the result of each wait.
+     * \param callback called on the worker thread with the lock status
+     * \param timeout the maximum time to wait in seconds
+     * \param chan the channel index 0 to N-1
+     */
+    virtual void async_wait_rx_lo_locked(
+        const lo_locked_callback_type &callback, double timeout = 0.1, size_t chan = 0
+    ) = 0;
+
     /*******************************************************************
      * TX methods
      ******************************************************************/
@@ -499,8 +658,26 @@ public:
      */
     virtual void set_tx_rate(double rate, size_t chan = ALL_CHANS) = 0;
 
+    /*!
+     * Set the TX sample rate with resampler options.
+     * When the hardware cannot make the requested rate exactly,
+     * the dsp runs at the closest rate at or above it,
+     * and a polyphase resampler before conversion makes the rate on the host.
+     * The resampler works on complex float samples only.
+     * The options (all optional) are:
+     *  - resample: auto to resample when needed (default), or off
+     *  - taps_per_phase: the filter length of each phase (default 16)
+     *  - max_phases: the largest interpolation factor (default 256),
+     *    larger values approximate the rate ratio more closely
+     * \param rate the rate in Sps
+     * \param options the resampler options
+     * \param chan the channel index 0 to N-1
+     */
+    virtual void set_tx_rate(double rate, const device_addr_t &options, size_t chan = ALL_CHANS) = 0;
+
     /*!
      * Gets the TX sample rate.
+     * This is the host side rate when the resampler is on.
      * \param chan the channel index 0 to N-1
      * \return the rate in Sps
      */
@@ -516,6 +693,32 @@ public:
         const tune_request_t &tune_request, size_t chan = 0
     ) = 0;
 
+    /*!
+     * Make a tune plan for the TX center frequency.
+     * The channel is tuned once to resolve the tune request.
+     * The returned request sets the RF and DSP frequencies manually,
+     * so passing it to set_tx_freq() retunes without evaluating the policies.
+     * Daughterboards that cache their LO dividers also skip the divider search.
+     * Use this to pre-compute the frequencies of a hopping pattern.
+     * \param tune_request tune request instructions
+     * \param chan the channel index 0 to N-1
+     * \return a tune request with manual policies
+     */
+    virtual tune_request_t make_tx_tune_plan(
+        const tune_request_t &tune_request, size_t chan = 0
+    ) = 0;
+
+    /*!
+     * Set the TX center frequency on several channels.
+     * The channels of each motherboard are tuned in order,
+     * and different motherboards are tuned concurrently.
+     * \param tune_requests pairs of channel index and tune request
+     * \return the tune results in the order of the requests
+     */
+    virtual std::vector<tune_result_t> set_tx_freqs(
+        const std::vector<std::pair<size_t, tune_request_t> > &tune_requests
+    ) = 0;
+
     /*!
      * Get the TX center frequency.
      * \param chan the channel index 0 to N-1
@@ -544,6 +747,13 @@ public:
         return this->set_tx_gain(gain, ALL_GAINS, chan);
     }
 
+    /*!
+     * Set the overall TX gain on several channels.
+     * Different motherboards are set concurrently.
+     * \param gains pairs of channel index and gain in dB
+     */
+    virtual void set_tx_gains(const std::vector<std::pair<size_t, double> > &gains) = 0;
+
     /*!
      * Get the TX gain value for the specified gain element.
      * For an empty name, sum across all gain elements.
@@ -587,6 +797,13 @@ public:
      */
     virtual void set_tx_antenna(const std::string &ant, size_t chan = 0) = 0;
 
+    /*!
+     * Select the TX antennas on several subdevices.
+     * Different motherboards are set concurrently.
+     * \param ants pairs of channel index and antenna name
+     */
+    virtual void set_tx_antennas(const std::vector<std::pair<size_t, std::string> > &ants) = 0;
+
     /*!
      * Get the selected TX antenna on the subdevice.
      * \param chan the channel index 0 to N-1
@@ -647,6 +864,26 @@ public:
      * \return a vector of sensor names
      */
     virtual std::vector<std::string> get_tx_sensor_names(size_t chan = 0) = 0;
+
+    /*!
+     * Wait for the LO on the TX subdevice to lock, ex: after a tune.
+     * See wait_rx_lo_locked().
+     * \param timeout the maximum time to wait in seconds
+     * \param chan the channel index 0 to N-1
+     * \return true when the LO locked within the timeout
+     */
+    virtual bool wait_tx_lo_locked(double timeout = 0.1, size_t chan = 0) = 0;
+
+    /*!
+     * Wait for the LO on the TX subdevice to lock in the background.
+     * See async_wait_rx_lo_locked().
+     * \param callback called on the worker thread with the lock status
+     * \param timeout the maximum time to wait in seconds
+     * \param chan the channel index 0 to N-1
+     */
+    virtual void async_wait_tx_lo_locked(
+        const lo_locked_callback_type &callback, double timeout = 0.1, size_t chan = 0
+    ) = 0;
 };
 
 }}
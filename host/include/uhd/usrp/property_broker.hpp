@@ -0,0 +1,106 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_USRP_PROPERTY_BROKER_HPP
+#define INCLUDED_UHD_USRP_PROPERTY_BROKER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/property_tree.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace uhd{ namespace usrp{
+
+/*!
+ * A property server shares the property tree of a device
+ * with the other processes of the host, over a local (unix) socket.
+ * The process that owns the device serves its tree,
+ * and tools such as monitors attach with a property client,
+ * without another device handle or a detour through the application.
+ *
+ * The server answers from a thread of its own,
+ * so the streaming threads of the owner never wait on a client.
+ * Properties are read and written as strings:
+ * the types bool, int, double, size_t, string, and time spec can be set,
+ * and ranges, sensor values, and string lists can also be read.
+ *
+ * The devices start a server with the device address key prop_socket,
+ * the path of the socket to serve.
+ */
+class UHD_API property_server : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<property_server> sptr;
+
+    /*!
+     * Make a new server for a property tree.
+     * An old socket file at the path is replaced,
+     * and the file is removed when the server is destroyed.
+     * The socket is only accessible to the user of the process (mode 0600).
+     * A client that does not read its replies is dropped.
+     * \param tree the property tree to serve
+     * \param socket_path the file system path of the socket
+     * \return a new property server
+     * \throw uhd::not_implemented_error without local sockets
+     * \throw uhd::runtime_error when a server already answers at the path
+     */
+    static sptr make(property_tree::sptr tree, const std::string &socket_path);
+
+    //! Get the number of requests answered
+    virtual size_t get_num_requests(void) const = 0;
+};
+
+/*!
+ * A property client reads and writes the tree of a property server.
+ * One request is in flight at a time, a client may be shared by threads.
+ * The errors of the server, such as a path not found, are thrown here.
+ */
+class UHD_API property_client : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<property_client> sptr;
+
+    /*!
+     * Make a new client connected to a property server.
+     * \param socket_path the socket path of the server
+     * \param timeout the seconds to wait for each reply
+     * \return a new property client
+     * \throw uhd::io_error when the server cannot be reached
+     */
+    static sptr make(const std::string &socket_path, double timeout = 10.0);
+
+    //! Get the names in a directory of the tree
+    virtual std::vector<std::string> list(const fs_path &path) = 0;
+
+    //! Get the type of a property, such as double or string
+    virtual std::string get_type(const fs_path &path) = 0;
+
+    //! Get the value of a property as a string
+    virtual std::string get(const fs_path &path) = 0;
+
+    /*!
+     * Set the value of a property from a string.
+     * \param path the path of the property
+     * \param value the new value, ex: "1e6"
+     * \return the value after the set, as coerced by the device
+     */
+    virtual std::string set(const fs_path &path, const std::string &value) = 0;
+};
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_UHD_USRP_PROPERTY_BROKER_HPP */
@@ -0,0 +1,118 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_USRP_RX_CALLBACK_STREAMER_HPP
+#define INCLUDED_UHD_USRP_RX_CALLBACK_STREAMER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/device.hpp>
+#include <uhd/types/io_type.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/utility.hpp>
+#include <vector>
+
+namespace uhd{ namespace usrp{
+
+/*!
+ * The RX callback streamer pushes received samples to a callback.
+ *
+ * A streaming thread owned by the streamer is the only caller of
+ * the device receive path: it receives in a loop and invokes the
+ * callback in place, so there is no handoff between threads
+ * before the samples reach the application.
+ * The thread is pinned and scheduled like the other UHD threads.
+ *
+ * The callback is also invoked for errors such as an overflow,
+ * with the error code in the metadata and zero samples.
+ * Timeouts are not reported, the thread simply receives again.
+ * The callback should return quickly, or the transport overflows.
+ * An exception thrown by the callback ends the streaming thread.
+ *
+ * Control the device as usual (rate, frequency, stream commands),
+ * but do not call device::recv() while the streamer exists.
+ */
+class UHD_API rx_callback_streamer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_callback_streamer> sptr;
+
+    /*!
+     * The callback for converted samples.
+     * The buffers are owned by the streamer and reused after the callback.
+     * \param buffs one buffer of samples per channel
+     * \param nsamps the number of samples in each buffer
+     * \param metadata the metadata describing the buffers
+     */
+    typedef boost::function<void(
+        const std::vector<const void *> &buffs, size_t nsamps, const rx_metadata_t &metadata
+    )> recv_callback_type;
+
+    /*!
+     * The callback for raw transport frames.
+     * The view is released back to the transport after the callback.
+     * \param view the borrowed frames in the over-the-wire format
+     */
+    typedef boost::function<void(const device::recv_view_t &view)> view_callback_type;
+
+    /*!
+     * Make a new streamer of converted samples.
+     * \param dev the device to receive from
+     * \param io_type the host type of the samples
+     * \param num_chans the number of receive channels
+     * \param nsamps_per_buff the samples per buffer (0 for one packet per callback)
+     * \param callback the function to call with each buffer
+     * \param cpus the CPUs for the streaming thread, empty for any
+     * \param sched the scheduling for the streaming thread
+     * \return a new streamer, receiving until it is destroyed
+     */
+    static sptr make(
+        device::sptr dev,
+        const io_type_t &io_type,
+        size_t num_chans,
+        size_t nsamps_per_buff,
+        const recv_callback_type &callback,
+        const std::vector<size_t> &cpus = std::vector<size_t>(),
+        const thread_sched_t &sched = thread_sched_t()
+    );
+
+    /*!
+     * Make a new streamer of raw transport frames.
+     * \param dev the device to receive from (must support recv_view)
+     * \param callback the function to call with each view
+     * \param cpus the CPUs for the streaming thread, empty for any
+     * \param sched the scheduling for the streaming thread
+     * \return a new streamer, receiving until it is destroyed
+     */
+    static sptr make_raw(
+        device::sptr dev,
+        const view_callback_type &callback,
+        const std::vector<size_t> &cpus = std::vector<size_t>(),
+        const thread_sched_t &sched = thread_sched_t()
+    );
+
+    //! Get the number of callbacks made so far
+    virtual size_t get_num_callbacks(void) const = 0;
+
+    //! Get the scheduling granted to the streaming thread
+    virtual thread_sched_t get_sched(void) const = 0;
+};
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_UHD_USRP_RX_CALLBACK_STREAMER_HPP */
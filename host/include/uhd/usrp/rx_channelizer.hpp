@@ -0,0 +1,112 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_USRP_RX_CHANNELIZER_HPP
+#define INCLUDED_UHD_USRP_RX_CHANNELIZER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/device.hpp>
+#include <uhd/types/metadata.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+namespace uhd{ namespace usrp{
+
+/*!
+ * The RX channelizer splits one wide receive stream into narrow channels.
+ *
+ * A polyphase filterbank divides the band of the first receive channel
+ * into num_chans equally spaced channels, each at 1/num_chans of the rate.
+ * Channel c is centered at c*rate/num_chans from the tuned frequency;
+ * the channels above num_chans/2 wrap around to the negative frequencies.
+ * Neighbouring channels overlap at their band edges (critical sampling).
+ *
+ * The channelizer takes the frames straight from the transport
+ * through device::recv_view() and converts the over-the-wire samples
+ * once into the filterbank input, skipping the copy into a user buffer.
+ * The filterbank is computed with an FFT, and the output blocks
+ * can be split across a pool of worker threads.
+ *
+ * Control the device as usual (rate, frequency, stream commands),
+ * but do not call device::recv() while the channelizer is receiving.
+ */
+class UHD_API rx_channelizer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_channelizer> sptr;
+
+    /*!
+     * Make a new channelizer on a device.
+     * \param dev the device to receive from (must support recv_view)
+     * \param samp_rate the sample rate of the wide stream in Sps
+     * \param num_chans the number of output channels (a power of two)
+     * \param taps_per_chan the prototype filter taps per channel
+     * \param num_threads the number of worker threads (0 computes in the caller)
+     * \param scale_factor the scale from over-the-wire integers to floats
+     * \return a new channelizer
+     * \throw uhd::value_error for an invalid number of channels or taps
+     */
+    static sptr make(
+        device::sptr dev,
+        double samp_rate,
+        size_t num_chans,
+        size_t taps_per_chan = 12,
+        size_t num_threads = 0,
+        double scale_factor = 1/32767.
+    );
+
+    //! Get the number of output channels
+    virtual size_t get_num_chans(void) const = 0;
+
+    //! Get the sample rate of each output channel in Sps
+    virtual double get_chan_rate(void) const = 0;
+
+    /*!
+     * Get the center of a channel relative to the tuned frequency.
+     * \param chan the channel index
+     * \return the frequency offset in Hz
+     */
+    virtual double get_chan_freq(size_t chan) const = 0;
+
+    /*!
+     * Receive the same number of complex float samples in every channel.
+     * This is a full buffer call: it returns once all buffers are filled.
+     *
+     * The metadata time is the time of the first sample of each buffer,
+     * corrected for the group delay of the filterbank.
+     * On an overflow, the filterbank restarts from the next packet.
+     * On a timeout, the input received so far is kept for the next call.
+     *
+     * \param buffs one buffer of fc32 samples per channel
+     * \param nsamps_per_buff the number of samples to fill into each buffer
+     * \param metadata data to fill describing the buffers
+     * \param timeout the timeout in seconds to wait for each packet
+     * \return nsamps_per_buff or 0 on error
+     */
+    virtual size_t recv(
+        const device::recv_buffs_type &buffs,
+        size_t nsamps_per_buff,
+        rx_metadata_t &metadata,
+        double timeout = 0.1
+    ) = 0;
+
+    //! Drop the buffered input and restart the filterbank
+    virtual void reset(void) = 0;
+};
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_UHD_USRP_RX_CHANNELIZER_HPP */
@@ -0,0 +1,83 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_USRP_TIME_EXTRAPOLATOR_HPP
+#define INCLUDED_UHD_USRP_TIME_EXTRAPOLATOR_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+namespace uhd{ namespace usrp{
+
+/*!
+ * The time extrapolator answers device time queries from the host clock.
+ *
+ * Each sample reads the device time once and brackets the read
+ * with two host clock reads; the device time is paired with the
+ * host midpoint, and half of the round trip bounds the pairing error.
+ * The offset comes from the newest sample and the drift from the
+ * oldest and newest samples in a sliding window.
+ *
+ * A query past the resample period takes a new sample first,
+ * so most queries cost two host clock reads and no device transaction.
+ * Call reset() whenever the device time or tick rate is changed.
+ */
+class UHD_API time_extrapolator : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<time_extrapolator> sptr;
+    typedef boost::function<time_spec_t(void)> time_fcn_t;
+
+    /*!
+     * Make a new time extrapolator.
+     * \param device_time reads the device time (a hardware read)
+     * \param host_time reads a monotonic host clock
+     * \return a new time extrapolator
+     */
+    static sptr make(
+        const time_fcn_t &device_time,
+        const time_fcn_t &host_time = &time_spec_t::get_system_time
+    );
+
+    /*!
+     * Set how long a sample is trusted before a resample.
+     * \param period the resample period in host seconds
+     */
+    virtual void set_resample_period(double period) = 0;
+
+    //! Discard all samples, the next query reads the device
+    virtual void reset(void) = 0;
+
+    /*!
+     * Read the device time and add the result to the samples.
+     * \return the device time that was read
+     */
+    virtual time_spec_t sample(void) = 0;
+
+    /*!
+     * Get the extrapolated device time.
+     * \param uncertainty set to the bound on the estimate error in seconds
+     * \return the estimated device time
+     */
+    virtual time_spec_t get_time_now(double &uncertainty) = 0;
+};
+
+}} //namespace
+
+#endif /* INCLUDED_UHD_USRP_TIME_EXTRAPOLATOR_HPP */
@@ -0,0 +1,138 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_USRP_TX_BURST_SCHEDULER_HPP
+#define INCLUDED_UHD_USRP_TX_BURST_SCHEDULER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/utility.hpp>
+#include <vector>
+
+namespace uhd{ namespace usrp{
+
+/*!
+ * The TX burst scheduler sends timed bursts queued ahead of their time.
+ *
+ * The application queues bursts for any of the streams, in any order.
+ * A sending thread owned by the scheduler takes the bursts in time order
+ * and sends each one the lead time before its time spec,
+ * so the device holds only the bursts that are about to go out,
+ * and its flow control window is not filled by bursts far in the future.
+ * The thread is pinned and scheduled like the other UHD threads.
+ *
+ * A burst whose time has passed when its turn comes is dropped, not sent.
+ * Each burst is released once the scheduler is done with its buffers,
+ * sent or not, and the buffers must stay valid until then.
+ * The bursts still queued when the scheduler is destroyed are released unsent.
+ *
+ * Do not call send() on the streams while the scheduler exists.
+ */
+class UHD_API tx_burst_scheduler : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<tx_burst_scheduler> sptr;
+
+    //! Get the device time, such as with multi_usrp::get_time_now()
+    typedef boost::function<time_spec_t(void)> time_fcn_type;
+
+    //! Called on the sending thread once the buffers of a burst are no longer used
+    typedef boost::function<void(bool sent)> release_type;
+
+    //! A timed burst to send
+    struct burst_t{
+        //! The index of the stream to send on
+        size_t stream;
+
+        //! The device time of the first sample
+        time_spec_t time;
+
+        //! One buffer per channel of the stream, each of nsamps samples
+        std::vector<const void *> buffs;
+
+        //! The number of samples per buffer
+        size_t nsamps;
+
+        //! The release of the buffers (optional)
+        release_type release;
+
+        burst_t(void): stream(0), nsamps(0){}
+    };
+
+    //! The counts and timing of the bursts since construction
+    struct stats_t{
+        //! The bursts waiting in the queue
+        size_t num_queued;
+
+        //! The bursts that were sent whole
+        size_t num_sent;
+
+        //! The bursts dropped because their time had passed
+        size_t num_late;
+
+        //! The bursts that a send did not take whole
+        size_t num_short;
+
+        //! The least time in seconds from the end of a send to the time of its burst
+        double min_margin;
+
+        //! The most time in seconds that a dropped burst was late by
+        double max_lateness;
+
+        stats_t(void):
+            num_queued(0), num_sent(0), num_late(0), num_short(0),
+            min_margin(0.0), max_lateness(0.0){}
+    };
+
+    /*!
+     * Make a new scheduler.
+     * \param streams the streams the bursts are sent on, by index
+     * \param time_fcn the source of the device time
+     * \param lead_time the seconds before its time that a burst is sent
+     * \param cpus the CPUs for the sending thread, empty for any
+     * \param sched the scheduling for the sending thread
+     * \return a new scheduler, sending until it is destroyed
+     */
+    static sptr make(
+        const std::vector<tx_streamer::sptr> &streams,
+        const time_fcn_type &time_fcn,
+        double lead_time = 0.01,
+        const std::vector<size_t> &cpus = std::vector<size_t>(),
+        const thread_sched_t &sched = thread_sched_t()
+    );
+
+    /*!
+     * Queue a burst to be sent ahead of its time.
+     * Bursts of the same time are sent in the order they were queued.
+     * \param burst the burst, with buffers that stay valid until its release
+     * \throw uhd::index_error when the stream index is out of range
+     */
+    virtual void enqueue(const burst_t &burst) = 0;
+
+    //! Get the counts and timing of the bursts
+    virtual stats_t get_stats(void) const = 0;
+
+    //! Get the scheduling granted to the sending thread
+    virtual thread_sched_t get_sched(void) const = 0;
+};
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_UHD_USRP_TX_BURST_SCHEDULER_HPP */
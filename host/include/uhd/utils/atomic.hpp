@@ -0,0 +1,92 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_ATOMIC_HPP
+#define INCLUDED_UHD_UTILS_ATOMIC_HPP
+
+#include <uhd/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/version.hpp>
+#include <boost/interprocess/detail/atomic.hpp>
+
+#if BOOST_VERSION >= 104800
+#  define UHD_IPC_DETAIL boost::interprocess::ipcdetail
+#else
+#  define UHD_IPC_DETAIL boost::interprocess::detail
+#endif
+
+namespace uhd{
+
+    /*!
+     * A full memory barrier:
+     * no load or store moves across it, on the compiler or the cpu.
+     */
+    UHD_INLINE void atomic_full_barrier(void){
+    #if defined(__GNUC__)
+        __sync_synchronize();
+    #else
+        static volatile boost::uint32_t dummy = 0;
+        UHD_IPC_DETAIL::atomic_cas32(&dummy, 0, 0);
+    #endif
+    }
+
+    /*!
+     * A 32-bit integer that can be atomically accessed.
+     * The cas, inc, and dec operations are full memory barriers.
+     * The read and write operations are only atomic:
+     * on some cpus, such as ARM and POWER, they do not order
+     * the other memory accesses, use atomic_full_barrier() for that.
+     */
+    class atomic_uint32_t{
+    public:
+
+        //! Create a new atomic 32-bit integer, initially zero
+        atomic_uint32_t(void){
+            this->write(0);
+        }
+
+        //! Read the current value of the integer
+        UHD_INLINE boost::uint32_t read(void){
+            return UHD_IPC_DETAIL::atomic_read32(&_num);
+        }
+
+        //! Write a new value to the integer
+        UHD_INLINE void write(const boost::uint32_t newval){
+            UHD_IPC_DETAIL::atomic_write32(&_num, newval);
+        }
+
+        //! Compare with cmp, swap with newval if same, return old value
+        UHD_INLINE boost::uint32_t cas(const boost::uint32_t newval, const boost::uint32_t cmp){
+            return UHD_IPC_DETAIL::atomic_cas32(&_num, newval, cmp);
+        }
+
+        //! Increment by 1 and return the old value
+        UHD_INLINE boost::uint32_t inc(void){
+            return UHD_IPC_DETAIL::atomic_inc32(&_num);
+        }
+
+        //! Decrement by 1 and return the old value
+        UHD_INLINE boost::uint32_t dec(void){
+            return UHD_IPC_DETAIL::atomic_dec32(&_num);
+        }
+
+    private: volatile boost::uint32_t _num;
+    };
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_UTILS_ATOMIC_HPP */
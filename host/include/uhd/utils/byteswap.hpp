@@ -20,10 +20,13 @@
 
 #include <uhd/config.hpp>
 #include <boost/cstdint.hpp>
+#include <cstddef>
 
 /*! \file byteswap.hpp
  * Provide fast byteswaping routines for 16, 32, and 64 bit integers,
  * by using the system's native routines/intrinsics when available.
+ * The buffer routines swap whole arrays with SIMD instructions
+ * when the host cpu supports them (checked once at runtime).
  */
 
 namespace uhd{
@@ -37,6 +40,21 @@ namespace uhd{
     //! perform a byteswap on a 64 bit integer
     boost::uint64_t byteswap(boost::uint64_t);
 
+    /*!
+     * Byteswap each word of a buffer of 16 bit integers.
+     * The output may be the input (in-place), but may not partially overlap it.
+     * \param out the output buffer of nwords
+     * \param in the input buffer of nwords
+     * \param nwords the number of words to swap
+     */
+    UHD_API void byteswap_buffer(boost::uint16_t *out, const boost::uint16_t *in, size_t nwords);
+
+    //! byteswap each word of a buffer of 32 bit integers (see above)
+    UHD_API void byteswap_buffer(boost::uint32_t *out, const boost::uint32_t *in, size_t nwords);
+
+    //! byteswap each word of a buffer of 64 bit integers (see above)
+    UHD_API void byteswap_buffer(boost::uint64_t *out, const boost::uint64_t *in, size_t nwords);
+
     //! network to host: short, long, or long-long
     template<typename T> T ntohx(T);
 
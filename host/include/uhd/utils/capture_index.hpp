@@ -0,0 +1,140 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_CAPTURE_INDEX_HPP
+#define INCLUDED_UHD_UTILS_CAPTURE_INDEX_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <boost/cstdint.hpp>
+#include <string>
+#include <vector>
+
+namespace uhd{
+
+/*!
+ * A capture index is the sidecar file of a recording:
+ * The data files hold the samples as received, one file per channel,
+ * otw items or converted samples, without any framing.
+ * The index maps the device time to the byte offset in the data files.
+ * The channels of a recording are sample aligned,
+ * so a byte offset is the same in every channel file.
+ *
+ * An entry marks the first sample of a contiguous run of samples:
+ * Within the run, the time advances by one sample period per item,
+ * up to the offset of the next entry.
+ */
+struct UHD_API capture_index_entry_t{
+    //! The byte offset of the first sample in each data file
+    boost::uint64_t offset;
+
+    //! The device time of the first sample (when has_time is set)
+    time_spec_t time;
+
+    //! The device provided a time for the first sample
+    bool has_time;
+
+    //! Samples were lost before the first sample: an overflow or a drop
+    bool overflow;
+
+    capture_index_entry_t(void);
+};
+
+/*!
+ * Write the index of a recording as it records.
+ * Each entry is written through, so the index of a recording
+ * that was cut short is valid up to its last entry.
+ */
+class UHD_API capture_index_writer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<capture_index_writer> sptr;
+
+    /*!
+     * Make a new index file, replacing an old one.
+     * \param path the index file path
+     * \param item_size the bytes per sample in the data files
+     * \param rate the sample rate in samples per second
+     * \param num_chans the number of channel data files
+     * \return a new index writer
+     * \throw uhd::io_error when the file cannot be written
+     */
+    static sptr make(const std::string &path, size_t item_size, double rate, size_t num_chans);
+
+    /*!
+     * Append an entry, the offsets must not decrease.
+     * \param entry the new index entry
+     */
+    virtual void append(const capture_index_entry_t &entry) = 0;
+};
+
+/*!
+ * Read the index of a recording and seek by device time.
+ */
+class UHD_API capture_index_reader : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<capture_index_reader> sptr;
+
+    /*!
+     * Read an index file.
+     * \param path the index file path
+     * \return a new index reader
+     * \throw uhd::io_error when the file is not a capture index
+     */
+    static sptr make(const std::string &path);
+
+    //! Get the bytes per sample in the data files
+    virtual size_t get_item_size(void) const = 0;
+
+    //! Get the sample rate in samples per second
+    virtual double get_rate(void) const = 0;
+
+    //! Get the number of channel data files
+    virtual size_t get_num_chans(void) const = 0;
+
+    //! Get all entries in file order
+    virtual const std::vector<capture_index_entry_t> &get_entries(void) const = 0;
+
+    /*!
+     * Find the byte offset of the sample at a device time.
+     * The search is a binary search over the timed entries.
+     * A time within a gap of lost samples gives the first offset after the gap,
+     * and a time before the recording gives its first timed offset.
+     * \param time the device time to seek to
+     * \return the byte offset in each data file, a multiple of the item size
+     * \throw uhd::lookup_error when no entry has a time
+     */
+    virtual boost::uint64_t find_offset(const time_spec_t &time) const = 0;
+};
+
+/*!
+ * Map a region of a data file read-only.
+ * The mapping is released with the last copy of the pointer.
+ * \param path the data file path
+ * \param offset the byte offset of the region, ex: from find_offset()
+ * \param num_bytes the number of bytes to map
+ * \return a pointer to the region start
+ * \throw uhd::io_error when the file cannot be mapped
+ */
+UHD_API boost::shared_ptr<const void> map_capture_region(
+    const std::string &path, boost::uint64_t offset, size_t num_bytes
+);
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_UTILS_CAPTURE_INDEX_HPP */
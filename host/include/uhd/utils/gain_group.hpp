@@ -68,6 +68,17 @@ public:
      */
     virtual void set_value(double gain, const std::string &name = "") = 0;
 
+    /*!
+     * Precompute the distribution of the overall gain at a fixed step.
+     * An overall set_value() then rounds the gain to the nearest table entry,
+     * looks up the element gains, and only writes the elements that changed.
+     * The table uses the element ranges at the time of this call;
+     * registering another element turns the table off.
+     * \param step the overall gain step of the table (0 to turn it off)
+     * \throw uhd::value_error when the table would be too large
+     */
+    virtual void set_table_step(double step) = 0;
+
     /*!
      * Get a list of names of registered gain elements.
      * The names are in the order that they were registered.
@@ -29,7 +29,10 @@
  *
  * The logger enables UHD library code to easily log events into a file.
  * Log entries are time-stamped and stored with file, line, and function.
- * Each call to the UHD_LOG macros is synchronous and thread-safe.
+ * Each call to the UHD_LOG macros is thread-safe and does not block:
+ * the entry is queued and a background thread writes it to the file.
+ * When the writer falls behind, new entries are dropped,
+ * and the log file records how many were dropped.
  *
  * The log file can be found in the path <temp-directory>/uhd.log,
  * where <temp-directory> is the user or system's temporary directory.
@@ -0,0 +1,73 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_SAMPLE_BUFFER_HPP
+#define INCLUDED_UHD_UTILS_SAMPLE_BUFFER_HPP
+
+#include <uhd/config.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+
+namespace uhd{
+
+    //! The alignment of a cache line on the common host cpus
+    static const size_t SAMPLE_BUFFER_CACHE_ALIGNMENT = 64;
+
+    //! The alignment of a page on the common host cpus
+    static const size_t SAMPLE_BUFFER_PAGE_ALIGNMENT = 4096;
+
+    /*!
+     * Allocate a buffer for the samples of a send or recv call.
+     * The converters take the vector paths for the whole buffer
+     * when it starts on an alignment boundary of the vector size.
+     * The memory is zeroed and freed with the last copy of the pointer.
+     *
+     * Hugepages are a request: when the platform cannot honor it,
+     * a warning is printed and the buffer is in normal memory.
+     *
+     * \param num_bytes the size of the buffer in bytes
+     * \param alignment the alignment boundary in bytes
+     * \param hugepages true to back the buffer with hugepages (linux only)
+     * \return a shared pointer to the buffer start
+     */
+    UHD_API boost::shared_ptr<void> alloc_sample_buffer(
+        const size_t num_bytes,
+        const size_t alignment = SAMPLE_BUFFER_CACHE_ALIGNMENT,
+        const bool hugepages = false
+    );
+
+    /*!
+     * Allocate a buffer for a number of samples of a type.
+     * Example: alloc_sample_buffer<std::complex<float> >(num_samps)
+     * \param num_samps the size of the buffer in samples
+     * \param alignment the alignment boundary in bytes
+     * \param hugepages true to back the buffer with hugepages (linux only)
+     * \return a shared pointer to the first sample
+     */
+    template <typename samp_type> boost::shared_ptr<samp_type> alloc_sample_buffer(
+        const size_t num_samps,
+        const size_t alignment = SAMPLE_BUFFER_CACHE_ALIGNMENT,
+        const bool hugepages = false
+    ){
+        return boost::static_pointer_cast<samp_type>(
+            alloc_sample_buffer(num_samps*sizeof(samp_type), alignment, hugepages)
+        );
+    }
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_UTILS_SAMPLE_BUFFER_HPP */
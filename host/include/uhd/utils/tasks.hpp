@@ -19,13 +19,40 @@
 #define INCLUDED_UHD_UTILS_TASKS_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
 #include <boost/utility.hpp>
+#include <string>
+#include <vector>
 
 namespace uhd{
 
-    class task : boost::noncopyable{
+    /*!
+     * The resource accounting of a task thread.
+     * The times are in seconds since the thread started.
+     * The cpu and wait times are zero on platforms without a thread cpu clock.
+     */
+    struct UHD_API task_stats_t{
+        //! The name given with set_name(), "task" by default
+        std::string name;
+
+        //! The number of calls to the task function that returned
+        size_t iterations;
+
+        //! The wall clock time the thread has run for
+        double run_time;
+
+        //! The cpu time the thread has consumed
+        double cpu_time;
+
+        //! The time the thread was off a cpu: blocked or preempted
+        double wait_time;
+
+        task_stats_t(void);
+    };
+
+    class UHD_API task : boost::noncopyable{
     public:
         typedef boost::shared_ptr<task> sptr;
         typedef boost::function<void(void)> task_fcn_type;
@@ -45,6 +72,52 @@ namespace uhd{
          */
         static sptr make(const task_fcn_type &task_fcn);
 
+        /*!
+         * Create a new task object with function callback.
+         * The task thread is restricted to a set of CPUs
+         * before the task function callback is first run.
+         * Failing to set the affinity prints a warning.
+         * \param task_fcn the task callback function
+         * \param cpus the CPUs for the thread, empty for any
+         * \return a new task object
+         */
+        static sptr make(const task_fcn_type &task_fcn, const std::vector<size_t> &cpus);
+
+        /*!
+         * Create a new task object with function callback.
+         * The task thread is restricted to a set of CPUs
+         * and given its scheduling before the callback is first run.
+         * Failing to set the affinity or scheduling prints a warning.
+         * \param task_fcn the task callback function
+         * \param cpus the CPUs for the thread, empty for any
+         * \param sched the scheduling for the thread
+         * \return a new task object
+         */
+        static sptr make(
+            const task_fcn_type &task_fcn,
+            const std::vector<size_t> &cpus,
+            const thread_sched_t &sched
+        );
+
+        /*!
+         * Get the scheduling granted to the task thread.
+         * The scheduling is read back once the thread has set it.
+         * \return the policy and priority as reported by the system
+         */
+        virtual thread_sched_t get_sched(void) const = 0;
+
+        /*!
+         * Name the task for its stats.
+         * \param name a short name such as "usrp2 pirate 0"
+         */
+        virtual void set_name(const std::string &name) = 0;
+
+        //! Get the resource accounting of the task thread
+        virtual task_stats_t get_stats(void) const = 0;
+
+        //! Get the resource accounting of every task in the process
+        static std::vector<task_stats_t> get_all_stats(void);
+
     };
 
 } //namespace uhd
@@ -19,6 +19,8 @@
 #define INCLUDED_UHD_UTILS_THREAD_PRIORITY_HPP
 
 #include <uhd/config.hpp>
+#include <string>
+#include <vector>
 
 namespace uhd{
 
@@ -53,6 +55,110 @@ namespace uhd{
         bool realtime = true
     );
 
+    /*!
+     * A scheduling request for a thread, or a report of the granted scheduling.
+     * The priority is used with the other, round-robin, and fifo policies.
+     * The runtime, deadline, and period are used with the deadline policy.
+     */
+    struct UHD_API thread_sched_t{
+        //! The scheduling policy
+        enum policy_t{
+            //! Leave the current scheduling of the thread unchanged
+            POLICY_INHERIT  = 'i',
+            //! Normal time-shared scheduling
+            POLICY_OTHER    = 'o',
+            //! Realtime round-robin scheduling (SCHED_RR)
+            POLICY_RR       = 'r',
+            //! Realtime first-in first-out scheduling (SCHED_FIFO)
+            POLICY_FIFO     = 'f',
+            //! Earliest deadline first scheduling (SCHED_DEADLINE, linux only)
+            POLICY_DEADLINE = 'd'
+        } policy;
+
+        //! The priority, a value between -1 and 1
+        float priority;
+
+        //! The deadline policy's budget of run time per period in seconds
+        double runtime;
+
+        //! The deadline policy's relative deadline in seconds
+        double deadline;
+
+        //! The deadline policy's period in seconds
+        double period;
+
+        /*!
+         * Create a new scheduling request.
+         * \param policy the scheduling policy
+         * \param priority a value between -1 and 1
+         */
+        thread_sched_t(
+            policy_t policy = POLICY_INHERIT,
+            float priority = default_thread_priority
+        );
+
+        /*!
+         * Create a new scheduling request from a string.
+         * The formats are "policy" and "policy:priority"
+         * for the other, rr, and fifo policies,
+         * and "deadline:runtime:period" with the times in seconds.
+         * An empty string is the inherit policy.
+         * \param sched the string to parse, such as "fifo:0.8"
+         * \return a new scheduling request
+         * \throw uhd::value_error on a malformed string
+         */
+        static thread_sched_t from_string(const std::string &sched);
+
+        //! Convert to a string in the same format as from_string
+        std::string to_string(void) const;
+    };
+
+    /*!
+     * Set the scheduling policy and priority on the current thread.
+     * \param sched the scheduling request
+     * \throw exception on set scheduling failure
+     */
+    UHD_API void set_thread_sched(const thread_sched_t &sched);
+
+    /*!
+     * Set the scheduling policy and priority on the current thread.
+     * Same as set_thread_sched but does not throw on failure.
+     * \return true on success, false on failure
+     */
+    UHD_API bool set_thread_sched_safe(const thread_sched_t &sched);
+
+    /*!
+     * Get the scheduling that was granted to the current thread.
+     * \return the policy and priority as reported by the system
+     */
+    UHD_API thread_sched_t get_thread_sched(void);
+
+    /*!
+     * Restrict the current thread to run on a set of CPUs.
+     * An empty set leaves the thread free to run on any CPU.
+     * \param cpus the indexes of the allowed CPUs
+     * \throw exception on set affinity failure
+     */
+    UHD_API void set_thread_affinity(const std::vector<size_t> &cpus);
+
+    /*!
+     * Restrict the current thread to run on a set of CPUs.
+     * Same as set_thread_affinity but does not throw on failure.
+     * \return true on success, false on failure
+     */
+    UHD_API bool set_thread_affinity_safe(const std::vector<size_t> &cpus);
+
+    /*!
+     * Parse a CPU set from a string.
+     * The string is one CPU index ("3"), an inclusive range ("2-5"),
+     * or a comma separated list of both ("0-3,8"), as in the sysfs cpulists.
+     * An empty string is an empty set.
+     * \param cpus the string to parse
+     * \return the indexes of the CPUs
+     * \throw uhd::value_error on a malformed string
+     */
+    UHD_API std::vector<size_t> cpus_from_string(const std::string &cpus);
+
 } //namespace uhd
 
 #endif /* INCLUDED_UHD_UTILS_THREAD_PRIORITY_HPP */
@@ -0,0 +1,121 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_TRACE_HPP
+#define INCLUDED_UHD_UTILS_TRACE_HPP
+
+#include <uhd/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/preprocessor/cat.hpp>
+#include <string>
+
+/*! \file trace.hpp
+ * The UHD hot path tracer.
+ *
+ * Trace points record timestamped events into a ring per thread.
+ * A ring has one writer, its thread, so recording takes no lock.
+ * The events can be written out in the Chrome trace event format,
+ * and viewed in chrome://tracing or any compatible viewer.
+ *
+ * The trace points are compiled in when the pre-processor define UHD_TRACE is set
+ * (configure with -DENABLE_TRACE=ON), and are off until enabled at runtime.
+ * Disabled, a trace point costs one read of the enable flag.
+ * Without UHD_TRACE, the trace points compile to nothing.
+ *
+ * To trace a whole run, set the environment variable UHD_TRACE_FILE:
+ * tracing is enabled on load, and the file is written when the process exits.
+ *   - Example environment variable: export UHD_TRACE_FILE=/tmp/uhd_trace.json
+ */
+
+#ifdef UHD_TRACE
+/*!
+ * Trace the duration of the enclosing scope.
+ * Usage: UHD_TRACE_SCOPE("udp_wait_recv");
+ * \param name a string literal, it is stored by pointer
+ */
+#  define UHD_TRACE_SCOPE(name) \
+    uhd::_trace::scope BOOST_PP_CAT(_uhd_trace_scope_, __LINE__)(name)
+
+/*!
+ * Trace an event without a duration.
+ * Usage: UHD_TRACE_INSTANT("tx_fc_update");
+ * \param name a string literal, it is stored by pointer
+ */
+#  define UHD_TRACE_INSTANT(name) \
+    if (not uhd::_trace::is_on){} else uhd::_trace::record(name, uhd::_trace::get_time_ns(), -1)
+#else
+#  define UHD_TRACE_SCOPE(name)
+#  define UHD_TRACE_INSTANT(name)
+#endif
+
+namespace uhd{ namespace trace{
+
+    //! Are the trace points compiled into this build of the library?
+    UHD_API bool is_compiled(void);
+
+    //! Start or stop recording at the trace points
+    UHD_API void set_enabled(const bool enb);
+
+    //! Is recording enabled?
+    UHD_API bool is_enabled(void);
+
+    //! Discard the recorded events of all threads, safe while recording
+    UHD_API void clear(void);
+
+    /*!
+     * Write the recorded events of all threads to a file.
+     * Safe while recording, but the oldest events of a busy ring may be skipped.
+     * \param path the file path of the Chrome trace event json
+     * \return the number of events written
+     */
+    UHD_API size_t write_chrome_json(const std::string &path);
+
+}} //namespace uhd::trace
+
+//! Internal implementation of the trace points
+namespace uhd{ namespace _trace{
+
+    //! The runtime enable flag, read by every trace point
+    UHD_API extern volatile bool is_on;
+
+    //! The monotonic time in nanoseconds
+    UHD_API boost::int64_t get_time_ns(void);
+
+    //! Record an event into this thread's ring, a negative duration is an instant
+    UHD_API void record(const char *name, boost::int64_t time_ns, boost::int64_t dur_ns);
+
+    //! Records the duration from construction to destruction
+    class scope{
+    public:
+        UHD_INLINE scope(const char *name):
+            _name(name), _time_ns(is_on? get_time_ns() : -1)
+        {
+            /* NOP */
+        }
+
+        UHD_INLINE ~scope(void){
+            if (_time_ns >= 0) record(_name, _time_ns, get_time_ns() - _time_ns);
+        }
+
+    private:
+        const char *_name;
+        const boost::int64_t _time_ns;
+    };
+
+}} //namespace uhd::_trace
+
+#endif /* INCLUDED_UHD_UTILS_TRACE_HPP */
@@ -21,6 +21,7 @@
 #include <uhd/convert.hpp>
 #include <uhd/utils/static.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/detail/endian.hpp>
 #include <complex>
 
 #define DECLARE_CONVERTER(fcn, prio) \
@@ -38,6 +39,60 @@
         size_t nsamps, double scale_factor \
     )
 
+/*!
+ * Declare a converter of a generated table, registered with the table.
+ */
+#define DECLARE_TABLE_CONVERTER(fcn) \
+    static void fcn( \
+        const uhd::convert::input_type &inputs, \
+        const uhd::convert::output_type &outputs, \
+        size_t nsamps, double scale_factor \
+    )
+
+/*!
+ * Declare a converter of a generated table that ignores the scale factor.
+ */
+#define DECLARE_UNSCALED_TABLE_CONVERTER(fcn) \
+    static void fcn( \
+        const uhd::convert::input_type &inputs, \
+        const uhd::convert::output_type &outputs, \
+        size_t nsamps, double /*scale_factor*/ \
+    )
+
+#define DECLARE_CORRECTED_CONVERTER(fcn, prio) \
+    static void fcn( \
+        const uhd::convert::input_type &inputs, \
+        const uhd::convert::output_type &outputs, \
+        size_t nsamps, double scale_factor, \
+        const uhd::convert::correction_t &correction \
+    ); \
+    UHD_STATIC_BLOCK(register_corrected_##fcn##_##prio){ \
+        uhd::convert::register_corrected_converter(#fcn, fcn, prio); \
+    } \
+    static void fcn( \
+        const uhd::convert::input_type &inputs, \
+        const uhd::convert::output_type &outputs, \
+        size_t nsamps, double scale_factor, \
+        const uhd::convert::correction_t &correction \
+    )
+
+/***********************************************************************
+ * Generated converter tables:
+ *    The markup of each entry is parsed into its direction and predicate
+ *    by the generator, so the registration does no parsing or logging.
+ **********************************************************************/
+struct converter_table_entry_type{
+    const char *markup;
+    size_t dir; //the dir_type of convert_pred.hpp
+    size_t pred;
+    uhd::convert::function_ptr_type fcn;
+};
+
+void register_converter_table(
+    const converter_table_entry_type *table, size_t num_entries,
+    uhd::convert::priority_type prio
+);
+
 /***********************************************************************
  * Typedefs
  **********************************************************************/
@@ -46,6 +101,8 @@ typedef std::complex<float>          fc32_t;
 typedef std::complex<boost::int16_t> sc16_t;
 typedef std::complex<boost::int8_t>  sc8_t;
 typedef boost::uint32_t              item32_t;
+typedef boost::uint16_t              item16_t;
+typedef boost::uint8_t               item24_t; //3 bytes per item
 
 /***********************************************************************
  * Convert complex short buffer to items32
@@ -104,4 +161,148 @@ static UHD_INLINE fc64_t item32_to_fc64(item32_t item, double scale_factor){
     );
 }
 
+/***********************************************************************
+ * Packed sc8 over-the-wire items: (i << 8) | q, otw_int = dsp_int >> 8
+ **********************************************************************/
+static UHD_INLINE item16_t sc8_to_item16(sc8_t num, double){
+    boost::uint8_t real = num.real();
+    boost::uint8_t imag = num.imag();
+    return (item16_t(real) << 8) | (item16_t(imag) << 0);
+}
+
+static UHD_INLINE sc8_t item16_to_sc8(item16_t item, double){
+    return sc8_t(
+        boost::int8_t(item >> 8),
+        boost::int8_t(item >> 0)
+    );
+}
+
+static UHD_INLINE item16_t sc16_to_item16(sc16_t num, double){
+    boost::uint8_t real = boost::int8_t(num.real() >> 8);
+    boost::uint8_t imag = boost::int8_t(num.imag() >> 8);
+    return (item16_t(real) << 8) | (item16_t(imag) << 0);
+}
+
+static UHD_INLINE sc16_t item16_to_sc16(item16_t item, double){
+    return sc16_t(
+        boost::int16_t(boost::int8_t(item >> 8) << 8),
+        boost::int16_t(boost::int8_t(item >> 0) << 8)
+    );
+}
+
+static UHD_INLINE item16_t fc32_to_item16(fc32_t num, float scale_factor){
+    boost::uint8_t real = boost::int8_t(num.real()*scale_factor);
+    boost::uint8_t imag = boost::int8_t(num.imag()*scale_factor);
+    return (item16_t(real) << 8) | (item16_t(imag) << 0);
+}
+
+static UHD_INLINE fc32_t item16_to_fc32(item16_t item, float scale_factor){
+    return fc32_t(
+        float(boost::int8_t(item >> 8)*scale_factor),
+        float(boost::int8_t(item >> 0)*scale_factor)
+    );
+}
+
+static UHD_INLINE item16_t fc64_to_item16(fc64_t num, double scale_factor){
+    boost::uint8_t real = boost::int8_t(num.real()*scale_factor);
+    boost::uint8_t imag = boost::int8_t(num.imag()*scale_factor);
+    return (item16_t(real) << 8) | (item16_t(imag) << 0);
+}
+
+static UHD_INLINE fc64_t item16_to_fc64(item16_t item, double scale_factor){
+    return fc64_t(
+        double(boost::int8_t(item >> 8)*scale_factor),
+        double(boost::int8_t(item >> 0)*scale_factor)
+    );
+}
+
+/***********************************************************************
+ * Packed sc12 over-the-wire items: (i << 12) | q, otw_int = dsp_int >> 4
+ * Each item is 3 bytes, the nswap item is in host byte order.
+ * The items below carry the 24 bits in the lower bits of an item32.
+ **********************************************************************/
+static UHD_INLINE item32_t item24_load_nswap(const item24_t *p){
+#ifdef BOOST_BIG_ENDIAN
+    return (item32_t(p[0]) << 16) | (item32_t(p[1]) << 8) | (item32_t(p[2]) << 0);
+#else
+    return (item32_t(p[2]) << 16) | (item32_t(p[1]) << 8) | (item32_t(p[0]) << 0);
+#endif
+}
+
+static UHD_INLINE item32_t item24_load_bswap(const item24_t *p){
+#ifdef BOOST_BIG_ENDIAN
+    return (item32_t(p[2]) << 16) | (item32_t(p[1]) << 8) | (item32_t(p[0]) << 0);
+#else
+    return (item32_t(p[0]) << 16) | (item32_t(p[1]) << 8) | (item32_t(p[2]) << 0);
+#endif
+}
+
+static UHD_INLINE void item24_store_nswap(item24_t *p, item32_t item){
+#ifdef BOOST_BIG_ENDIAN
+    p[0] = item24_t(item >> 16); p[1] = item24_t(item >> 8); p[2] = item24_t(item >> 0);
+#else
+    p[2] = item24_t(item >> 16); p[1] = item24_t(item >> 8); p[0] = item24_t(item >> 0);
+#endif
+}
+
+static UHD_INLINE void item24_store_bswap(item24_t *p, item32_t item){
+#ifdef BOOST_BIG_ENDIAN
+    p[2] = item24_t(item >> 16); p[1] = item24_t(item >> 8); p[0] = item24_t(item >> 0);
+#else
+    p[0] = item24_t(item >> 16); p[1] = item24_t(item >> 8); p[2] = item24_t(item >> 0);
+#endif
+}
+
+//the 12-bit components sign extended through the upper bits of an int16
+static UHD_INLINE boost::int16_t item24_real(item32_t item){
+    return boost::int16_t(boost::uint16_t(item >> 8) & 0xfff0) >> 4;
+}
+
+static UHD_INLINE boost::int16_t item24_imag(item32_t item){
+    return boost::int16_t(boost::uint16_t(item << 4) & 0xfff0) >> 4;
+}
+
+static UHD_INLINE item32_t item24_pack(boost::int16_t real, boost::int16_t imag){
+    return ((item32_t(real) & 0xfff) << 12) | ((item32_t(imag) & 0xfff) << 0);
+}
+
+static UHD_INLINE item32_t sc16_to_item24(sc16_t num, double){
+    return item24_pack(num.real() >> 4, num.imag() >> 4);
+}
+
+static UHD_INLINE sc16_t item24_to_sc16(item32_t item, double){
+    return sc16_t(
+        boost::int16_t(boost::uint16_t(item >> 8) & 0xfff0),
+        boost::int16_t(boost::uint16_t(item << 4) & 0xfff0)
+    );
+}
+
+static UHD_INLINE item32_t fc32_to_item24(fc32_t num, float scale_factor){
+    return item24_pack(
+        boost::int16_t(num.real()*scale_factor),
+        boost::int16_t(num.imag()*scale_factor)
+    );
+}
+
+static UHD_INLINE fc32_t item24_to_fc32(item32_t item, float scale_factor){
+    return fc32_t(
+        float(item24_real(item)*scale_factor),
+        float(item24_imag(item)*scale_factor)
+    );
+}
+
+static UHD_INLINE item32_t fc64_to_item24(fc64_t num, double scale_factor){
+    return item24_pack(
+        boost::int16_t(num.real()*scale_factor),
+        boost::int16_t(num.imag()*scale_factor)
+    );
+}
+
+static UHD_INLINE fc64_t item24_to_fc64(item32_t item, double scale_factor){
+    return fc64_t(
+        double(item24_real(item)*scale_factor),
+        double(item24_imag(item)*scale_factor)
+    );
+}
+
 #endif /* INCLUDED_LIBUHD_CONVERT_COMMON_HPP */
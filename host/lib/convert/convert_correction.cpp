@@ -0,0 +1,61 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * General corrected converters for otw to fc32:
+ * The correction is applied in the same pass as the conversion.
+ **********************************************************************/
+struct fc32_correction_type{
+    fc32_correction_type(const correction_t &correction):
+        dc_offset(correction.dc_offset),
+        ii(float(correction.ii)), iq(float(correction.iq)),
+        qi(float(correction.qi)), qq(float(correction.qq))
+    {
+        /* NOP */
+    }
+
+    UHD_INLINE fc32_t operator()(const fc32_t &num) const{
+        const fc32_t tmp = num - dc_offset;
+        return fc32_t(
+            ii*tmp.real() + iq*tmp.imag(),
+            qi*tmp.real() + qq*tmp.imag()
+        );
+    }
+
+    fc32_t dc_offset;
+    float ii, iq, qi, qq;
+};
+
+#define DECLARE_GENERAL_CORRECTED_CONVERTER(otw_type, swap, swap_fcn) \
+    DECLARE_CORRECTED_CONVERTER(convert_##otw_type##_1_to_fc32_1_##swap, PRIORITY_GENERAL){ \
+        const otw_type##_t *input = reinterpret_cast<const otw_type##_t *>(inputs[0]); \
+        fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]); \
+        const fc32_correction_type correct(correction); \
+        for (size_t i = 0; i < nsamps; i++){ \
+            output[i] = correct(otw_type##_to_fc32(swap_fcn(input[i]), float(scale_factor))); \
+        } \
+    }
+
+DECLARE_GENERAL_CORRECTED_CONVERTER(item32, nswap, )
+DECLARE_GENERAL_CORRECTED_CONVERTER(item32, bswap, uhd::byteswap)
+DECLARE_GENERAL_CORRECTED_CONVERTER(item16, nswap, )
+DECLARE_GENERAL_CORRECTED_CONVERTER(item16, bswap, uhd::byteswap)
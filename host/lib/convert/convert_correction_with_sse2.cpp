@@ -0,0 +1,107 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * SSE2 corrected converters for item32 to fc32:
+ * Each vector holds two samples (I0 Q0 I1 Q1).
+ * The matrix is split into a diagonal part (ii qq ii qq)
+ * and a cross part (iq qi iq qi) applied to the IQ swapped vector.
+ **********************************************************************/
+struct sse2_correction_type{
+    sse2_correction_type(const correction_t &correction){
+        dc_offset = _mm_set_ps(
+            float(correction.dc_offset.imag()), float(correction.dc_offset.real()),
+            float(correction.dc_offset.imag()), float(correction.dc_offset.real())
+        );
+        diag = _mm_set_ps(
+            float(correction.qq), float(correction.ii),
+            float(correction.qq), float(correction.ii)
+        );
+        cross = _mm_set_ps(
+            float(correction.qi), float(correction.iq),
+            float(correction.qi), float(correction.iq)
+        );
+    }
+
+    UHD_INLINE __m128 operator()(__m128 tmp) const{
+        tmp = _mm_sub_ps(tmp, dc_offset);
+        const __m128 tmpx = _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_add_ps(_mm_mul_ps(tmp, diag), _mm_mul_ps(tmpx, cross));
+    }
+
+    //the scalar version for the remainder
+    UHD_INLINE fc32_t operator()(const fc32_t &num) const{
+        fc32_t out;
+        _mm_storel_pi(reinterpret_cast<__m64 *>(&out), (*this)(_mm_set_ps(0, 0, num.imag(), num.real())));
+        return out;
+    }
+
+    __m128 dc_offset, diag, cross;
+};
+
+template <bool bswap> static UHD_INLINE __m128i swap_items(__m128i tmpi){
+    if (bswap) return _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8));
+    tmpi = _mm_shufflelo_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+template <bool bswap> static void item32_1_to_fc32_1_corrected(
+    const input_type &inputs, const output_type &outputs,
+    size_t nsamps, double scale_factor, const correction_t &correction
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 16));
+    const __m128i zeroi = _mm_setzero_si128();
+    const sse2_correction_type correct(correction);
+
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        //load, swap, and unpack so the value is in the upper 16 bits
+        __m128i tmpi = swap_items<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i)));
+        __m128i tmpilo = _mm_unpacklo_epi16(zeroi, tmpi);
+        __m128i tmpihi = _mm_unpackhi_epi16(zeroi, tmpi);
+
+        //convert, scale, and correct in registers
+        __m128 tmplo = correct(_mm_mul_ps(_mm_cvtepi32_ps(tmpilo), scalar));
+        __m128 tmphi = correct(_mm_mul_ps(_mm_cvtepi32_ps(tmpihi), scalar));
+
+        _mm_storeu_ps(reinterpret_cast<float *>(output+i+0), tmplo);
+        _mm_storeu_ps(reinterpret_cast<float *>(output+i+2), tmphi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        const item32_t item = (bswap)? uhd::byteswap(input[i]) : input[i];
+        output[i] = correct(item32_to_fc32(item, float(scale_factor)));
+    }
+}
+
+DECLARE_CORRECTED_CONVERTER(convert_item32_1_to_fc32_1_nswap, PRIORITY_CUSTOM){
+    item32_1_to_fc32_1_corrected<false>(inputs, outputs, nsamps, scale_factor, correction);
+}
+
+DECLARE_CORRECTED_CONVERTER(convert_item32_1_to_fc32_1_bswap, PRIORITY_CUSTOM){
+    item32_1_to_fc32_1_corrected<true>(inputs, outputs, nsamps, scale_factor, correction);
+}
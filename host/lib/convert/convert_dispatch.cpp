@@ -0,0 +1,83 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/static.hpp>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+/***********************************************************************
+ * This file is compiled without any instruction set flags:
+ * It checks the host cpu at runtime and registers the converters
+ * that were compiled for an instruction set only when it is supported.
+ **********************************************************************/
+#ifdef HAVE_AVX2_CONVERT
+
+void convert_register_avx2(void);
+
+static bool cpu_has_avx2(void){
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+    __cpuid(regs, 1);
+    //the os must save the ymm registers on a context switch
+    const int osxsave_avx = (1 << 27) | (1 << 28);
+    if ((regs[2] & osxsave_avx) != osxsave_avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+UHD_STATIC_BLOCK(convert_dispatch_avx2){
+    if (not cpu_has_avx2()) return;
+    convert_register_avx2();
+}
+
+#endif /*HAVE_AVX2_CONVERT*/
+
+#ifdef HAVE_SSSE3_CONVERT
+
+void convert_register_ssse3(void);
+
+static bool cpu_has_ssse3(void){
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    return (regs[2] & (1 << 9)) != 0;
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3") != 0;
+#else
+    return false;
+#endif
+}
+
+UHD_STATIC_BLOCK(convert_dispatch_ssse3){
+    if (not cpu_has_ssse3()) return;
+    convert_register_ssse3();
+}
+
+#endif /*HAVE_SSSE3_CONVERT*/
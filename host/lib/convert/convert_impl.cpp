@@ -15,10 +15,20 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "convert_common.hpp"
 #include <uhd/convert.hpp>
 #include <uhd/utils/log.hpp>
+#include <uhd/utils/msg.hpp>
 #include <uhd/utils/static.hpp>
 #include <uhd/exception.hpp>
+#include <boost/foreach.hpp>
+#include <boost/tokenizer.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <cstdlib> //getenv
+#include <map>
 
 using namespace uhd;
 
@@ -27,9 +37,13 @@ using namespace uhd;
 /***********************************************************************
  * Define types for the function tables
  **********************************************************************/
+typedef std::map<convert::priority_type, convert::function_type> fcn_impls_type;
+
 struct fcn_table_entry_type{
     convert::priority_type prio;
     convert::function_type fcn;
+    std::string markup;
+    fcn_impls_type impls; //every registered implementation
     fcn_table_entry_type(void)
     : prio(convert::PRIORITY_EMPTY), fcn(NULL){
         /* NOP */
@@ -51,17 +65,87 @@ fcn_table_type &get_table(dir_type dir){
     UHD_THROW_INVALID_CODE_PATH();
 }
 
+/***********************************************************************
+ * Forced priorities:
+ *    The key is a markup, the empty key applies to every markup.
+ *    Initialized from the UHD_CONVERT_PRIORITY environment variable:
+ *    a comma separated list of <prio> or <markup>:<prio> entries.
+ *    The variable is read during the static registration,
+ *    so a malformed entry is reported and skipped instead of thrown.
+ *    The mutex guards the forced priorities and the table selections.
+ **********************************************************************/
+UHD_SINGLETON_FCN(boost::mutex, get_forced_prio_mutex);
+
+typedef std::map<std::string, convert::priority_type> forced_prio_type;
+
+static convert::priority_type priority_from_string(const std::string &prio){
+    if (prio == "general")       return convert::PRIORITY_GENERAL;
+    if (prio == "liborc")        return convert::PRIORITY_LIBORC;
+    if (prio == "custom")        return convert::PRIORITY_CUSTOM;
+    if (prio == "custom_avx2")   return convert::PRIORITY_CUSTOM_AVX2;
+    if (prio == "custom_stream") return convert::PRIORITY_CUSTOM_STREAM;
+    try{
+        return convert::priority_type(boost::lexical_cast<int>(prio));
+    }
+    catch(const boost::bad_lexical_cast &){
+        throw uhd::value_error("convert: unknown converter priority " + prio);
+    }
+}
+
+static forced_prio_type get_forced_prio_from_env(void){
+    forced_prio_type forced;
+    const char *env = std::getenv("UHD_CONVERT_PRIORITY");
+    if (env == NULL) return forced;
+    const std::string env_str(env);
+    boost::tokenizer<boost::char_separator<char> > tokenizer(env_str, boost::char_separator<char>(","));
+    BOOST_FOREACH(const std::string &entry, tokenizer){
+        const size_t colon = entry.find(':');
+        try{
+            if (colon == std::string::npos) forced[""] = priority_from_string(entry);
+            else forced[entry.substr(0, colon)] = priority_from_string(entry.substr(colon+1));
+        }
+        catch(const uhd::value_error &e){
+            UHD_MSG(warning) << "UHD_CONVERT_PRIORITY: ignoring the entry " << entry << ": " << e.what() << std::endl;
+        }
+    }
+    return forced;
+}
+
+static forced_prio_type &get_forced_prio(void){
+    static forced_prio_type forced = get_forced_prio_from_env();
+    return forced;
+}
+
+/*!
+ * Select an implementation from a non-empty map of implementations:
+ * Use the forced priority when registered, otherwise the highest.
+ */
+template <typename impls_type> static typename impls_type::const_iterator
+select_prio(const std::string &markup, const impls_type &impls){
+    const forced_prio_type &forced = get_forced_prio();
+    forced_prio_type::const_iterator it = forced.find(markup);
+    if (it == forced.end()) it = forced.find("");
+    typename impls_type::const_iterator impl = impls.end();
+    if (it != forced.end()) impl = impls.find(it->second);
+    if (impl == impls.end()) impl = --impls.end();
+    return impl;
+}
+
+static void select_impl(fcn_table_entry_type &entry){
+    if (entry.impls.empty()) return;
+    fcn_impls_type::const_iterator impl = select_prio(entry.markup, entry.impls);
+    entry.prio = impl->first;
+    entry.fcn = impl->second;
+}
+
 /***********************************************************************
  * The registry functions
  **********************************************************************/
-void uhd::convert::register_converter(
-    const std::string &markup,
-    function_type fcn,
-    priority_type prio
+static void register_converter_pred(
+    const std::string &markup, dir_type dir, pred_type pred,
+    const convert::function_type &fcn, convert::priority_type prio
 ){
-    //extract the predicate and direction from the markup
-    dir_type dir;
-    pred_type pred = make_pred(markup, dir);
+    boost::mutex::scoped_lock lock(get_forced_prio_mutex());
 
     //get a reference to the function table
     fcn_table_type &table = get_table(dir);
@@ -69,11 +153,21 @@ void uhd::convert::register_converter(
     //resize the table so that its at least pred+1
     if (table.size() <= pred) table.resize(pred+1);
 
-    //register the function if higher priority
-    if (table[pred].prio < prio){
-        table[pred].fcn = fcn;
-        table[pred].prio = prio;
-    }
+    //register the function and reselect the implementation
+    table[pred].markup = markup;
+    table[pred].impls[prio] = fcn;
+    select_impl(table[pred]);
+}
+
+void uhd::convert::register_converter(
+    const std::string &markup,
+    function_type fcn,
+    priority_type prio
+){
+    //extract the predicate and direction from the markup
+    dir_type dir;
+    pred_type pred = make_pred(markup, dir);
+    register_converter_pred(markup, dir, pred, fcn, prio);
 
     //----------------------------------------------------------------//
     UHD_LOGV(always) << "register_converter: " << markup << std::endl
@@ -85,6 +179,69 @@ void uhd::convert::register_converter(
     //----------------------------------------------------------------//
 }
 
+void register_converter_table(
+    const converter_table_entry_type *table, size_t num_entries,
+    convert::priority_type prio
+){
+    for (size_t i = 0; i < num_entries; i++){
+        register_converter_pred(table[i].markup, dir_type(table[i].dir), table[i].pred, table[i].fcn, prio);
+    }
+
+    //----------------------------------------------------------------//
+    UHD_LOGV(always) << "register_converter_table: " << num_entries << " converters" << std::endl
+        << "    prio: " << prio << std::endl
+        << std::endl
+    ;
+    //----------------------------------------------------------------//
+}
+
+convert::converter_infos_t convert::get_converter_infos(void){
+    boost::mutex::scoped_lock lock(get_forced_prio_mutex());
+    converter_infos_t infos;
+    for (size_t dir = 0; dir < 2; dir++){
+        BOOST_FOREACH(const fcn_table_entry_type &entry, get_table(dir_type(dir))){
+            BOOST_FOREACH(const fcn_impls_type::value_type &impl, entry.impls){
+                converter_info_t info;
+                info.markup = entry.markup;
+                info.prio = impl.first;
+                info.selected = (impl.first == entry.prio);
+                infos.push_back(info);
+            }
+        }
+    }
+    return infos;
+}
+
+convert::function_type convert::get_converter(
+    const std::string &markup, priority_type prio
+){
+    dir_type dir;
+    pred_type pred = make_pred(markup, dir);
+    const fcn_table_type &table = get_table(dir);
+    if (pred < table.size()){
+        fcn_impls_type::const_iterator impl = table[pred].impls.find(prio);
+        if (impl != table[pred].impls.end()) return impl->second;
+    }
+    throw uhd::lookup_error(str(boost::format(
+        "convert: no converter %s with priority %d"
+    ) % markup % prio));
+}
+
+void convert::set_forced_priority(
+    const std::string &prio, const std::string &markup
+){
+    const convert::priority_type forced_prio = prio.empty()? convert::PRIORITY_EMPTY : priority_from_string(prio);
+    boost::mutex::scoped_lock lock(get_forced_prio_mutex());
+    if (prio.empty()) get_forced_prio().erase(markup);
+    else get_forced_prio()[markup] = forced_prio;
+
+    for (size_t dir = 0; dir < 2; dir++){
+        BOOST_FOREACH(fcn_table_entry_type &entry, get_table(dir_type(dir))){
+            select_impl(entry);
+        }
+    }
+}
+
 /***********************************************************************
  * The converter functions
  **********************************************************************/
@@ -107,3 +264,126 @@ const convert::function_type &convert::get_converter_otw_to_cpu(
     pred_type pred = make_pred(io_type, otw_type, num_input_buffs, num_output_buffs);
     return get_otw_to_cpu_table().at(pred).fcn;
 }
+
+/***********************************************************************
+ * The conversion plan
+ **********************************************************************/
+convert::plan_t::plan_t(void):
+    _fcn_ptr(NULL), _num_input_buffs(0), _num_output_buffs(0), _scale_factor(1.0)
+{
+    /* NOP */
+}
+
+convert::plan_t::plan_t(
+    const function_type &fcn,
+    size_t num_input_buffs,
+    size_t num_output_buffs,
+    double scale_factor
+):
+    _fcn_ptr(NULL),
+    _num_input_buffs(num_input_buffs),
+    _num_output_buffs(num_output_buffs),
+    _scale_factor(scale_factor)
+{
+    //registered converters are plain functions, bound ones stay wrapped
+    const function_ptr_type *fcn_ptr = fcn.target<function_ptr_type>();
+    if (fcn_ptr != NULL) _fcn_ptr = *fcn_ptr;
+    else _fcn = fcn;
+}
+
+/***********************************************************************
+ * The priority functions
+ **********************************************************************/
+static convert::priority_type get_priority(
+    const fcn_table_type &table, pred_type pred
+){
+    if (pred >= table.size()) return convert::PRIORITY_EMPTY;
+    return table[pred].prio;
+}
+
+convert::priority_type convert::get_priority_cpu_to_otw(
+    const io_type_t &io_type,
+    const otw_type_t &otw_type,
+    size_t num_input_buffs,
+    size_t num_output_buffs
+){
+    pred_type pred = make_pred(io_type, otw_type, num_input_buffs, num_output_buffs);
+    return get_priority(get_cpu_to_otw_table(), pred);
+}
+
+convert::priority_type convert::get_priority_otw_to_cpu(
+    const io_type_t &io_type,
+    const otw_type_t &otw_type,
+    size_t num_input_buffs,
+    size_t num_output_buffs
+){
+    pred_type pred = make_pred(io_type, otw_type, num_input_buffs, num_output_buffs);
+    return get_priority(get_otw_to_cpu_table(), pred);
+}
+
+/***********************************************************************
+ * The corrected converters:
+ *    Only otw to cpu with one input and one output buffer.
+ *    The implementation is selected on lookup since the result is bound.
+ **********************************************************************/
+convert::correction_t::correction_t(void):
+    dc_offset(0.0), ii(1.0), iq(0.0), qi(0.0), qq(1.0)
+{
+    /* NOP */
+}
+
+bool convert::correction_t::is_identity(void) const{
+    return dc_offset == std::complex<double>(0.0)
+        and ii == 1.0 and iq == 0.0 and qi == 0.0 and qq == 1.0;
+}
+
+typedef std::map<convert::priority_type, convert::corrected_function_type> corrected_impls_type;
+
+struct corrected_table_entry_type{
+    std::string markup;
+    corrected_impls_type impls;
+};
+typedef std::map<pred_type, corrected_table_entry_type> corrected_table_type;
+
+UHD_SINGLETON_FCN(corrected_table_type, get_corrected_table);
+
+void uhd::convert::register_corrected_converter(
+    const std::string &markup,
+    corrected_function_type fcn,
+    priority_type prio
+){
+    dir_type dir;
+    pred_type pred = make_pred(markup, dir);
+    if (dir != DIR_OTW_TO_CPU) throw uhd::value_error(
+        "convert: corrected converters are otw to cpu only: " + markup
+    );
+
+    corrected_table_entry_type &entry = get_corrected_table()[pred];
+    entry.markup = markup;
+    entry.impls[prio] = fcn;
+
+    //----------------------------------------------------------------//
+    UHD_LOGV(always) << "register_corrected_converter: " << markup << std::endl
+        << "    prio: " << prio << std::endl
+        << "    pred: " << pred << std::endl
+        << std::endl
+    ;
+    //----------------------------------------------------------------//
+}
+
+convert::function_type convert::get_corrected_converter_otw_to_cpu(
+    const io_type_t &io_type,
+    const otw_type_t &otw_type,
+    const correction_t &correction
+){
+    pred_type pred = make_pred(io_type, otw_type, 1, 1);
+    const corrected_table_type &table = get_corrected_table();
+    corrected_table_type::const_iterator it = table.find(pred);
+    if (it == table.end() or it->second.impls.empty()) throw uhd::lookup_error(
+        "convert: no corrected converter for the io and otw types"
+    );
+    return boost::bind(
+        select_prio(it->second.markup, it->second.impls)->second,
+        _1, _2, _3, _4, correction
+    );
+}
@@ -0,0 +1,314 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * Fused interleave/deinterleave for multiple streams per channel:
+ * The otw buffer holds one item32 per stream for each sample time,
+ * ex: width 2 is ch0s0, ch1s0, ch0s1, ch1s1...
+ * Helpers are templated on the byte order of the otw items.
+ **********************************************************************/
+template <bool bswap> static UHD_INLINE __m128i swap_items(__m128i tmpi){
+    if (bswap) return _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8));
+    tmpi = _mm_shufflelo_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+template <bool bswap> static UHD_INLINE item32_t swap_item(item32_t item){
+    return (bswap)? uhd::byteswap(item) : item;
+}
+
+//! convert 2 + 2 fc32 samples into 4 items, in order
+template <bool bswap> static UHD_INLINE __m128i fc32_to_items(
+    __m128 tmplo, __m128 tmphi, const __m128 &scalar
+){
+    __m128i tmpilo = _mm_cvtps_epi32(_mm_mul_ps(tmplo, scalar));
+    __m128i tmpihi = _mm_cvtps_epi32(_mm_mul_ps(tmphi, scalar));
+    return swap_items<bswap>(_mm_packs_epi32(tmpilo, tmpihi));
+}
+
+//! convert 4 items into 2 + 2 fc32 samples, in order
+template <bool bswap> static UHD_INLINE void items_to_fc32(
+    __m128i tmpi, __m128 &tmplo, __m128 &tmphi, const __m128 &scalar
+){
+    const __m128i zeroi = _mm_setzero_si128();
+    tmpi = swap_items<bswap>(tmpi);
+    tmplo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(zeroi, tmpi)), scalar);
+    tmphi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(zeroi, tmpi)), scalar);
+}
+
+//! pick the low or high sample of two fc32 vectors (2 samples each)
+static UHD_INLINE __m128 unpacklo_samps(__m128 a, __m128 b){
+    return _mm_castpd_ps(_mm_unpacklo_pd(_mm_castps_pd(a), _mm_castps_pd(b)));
+}
+
+static UHD_INLINE __m128 unpackhi_samps(__m128 a, __m128 b){
+    return _mm_castpd_ps(_mm_unpackhi_pd(_mm_castps_pd(a), _mm_castps_pd(b)));
+}
+
+/***********************************************************************
+ * fc32 interleave/deinterleave implementations
+ **********************************************************************/
+template <bool bswap> static void fc32_2_to_item32_1(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const fc32_t *input0 = reinterpret_cast<const fc32_t *>(inputs[0]);
+    const fc32_t *input1 = reinterpret_cast<const fc32_t *>(inputs[1]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+2 <= nsamps; i+=2){
+        __m128 a = _mm_loadu_ps(reinterpret_cast<const float *>(input0+i));
+        __m128 b = _mm_loadu_ps(reinterpret_cast<const float *>(input1+i));
+        __m128i tmpi = fc32_to_items<bswap>(unpacklo_samps(a, b), unpackhi_samps(a, b), scalar);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+2*i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[2*i+0] = swap_item<bswap>(fc32_to_item32(input0[i], float(scale_factor)));
+        output[2*i+1] = swap_item<bswap>(fc32_to_item32(input1[i], float(scale_factor)));
+    }
+}
+
+template <bool bswap> static void fc32_4_to_item32_1(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const fc32_t *input0 = reinterpret_cast<const fc32_t *>(inputs[0]);
+    const fc32_t *input1 = reinterpret_cast<const fc32_t *>(inputs[1]);
+    const fc32_t *input2 = reinterpret_cast<const fc32_t *>(inputs[2]);
+    const fc32_t *input3 = reinterpret_cast<const fc32_t *>(inputs[3]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+2 <= nsamps; i+=2){
+        __m128 a = _mm_loadu_ps(reinterpret_cast<const float *>(input0+i));
+        __m128 b = _mm_loadu_ps(reinterpret_cast<const float *>(input1+i));
+        __m128 c = _mm_loadu_ps(reinterpret_cast<const float *>(input2+i));
+        __m128 d = _mm_loadu_ps(reinterpret_cast<const float *>(input3+i));
+        __m128i tmpi0 = fc32_to_items<bswap>(unpacklo_samps(a, b), unpacklo_samps(c, d), scalar);
+        __m128i tmpi1 = fc32_to_items<bswap>(unpackhi_samps(a, b), unpackhi_samps(c, d), scalar);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+0), tmpi0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+4), tmpi1);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[4*i+0] = swap_item<bswap>(fc32_to_item32(input0[i], float(scale_factor)));
+        output[4*i+1] = swap_item<bswap>(fc32_to_item32(input1[i], float(scale_factor)));
+        output[4*i+2] = swap_item<bswap>(fc32_to_item32(input2[i], float(scale_factor)));
+        output[4*i+3] = swap_item<bswap>(fc32_to_item32(input3[i], float(scale_factor)));
+    }
+}
+
+template <bool bswap> static void item32_1_to_fc32_2(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output0 = reinterpret_cast<fc32_t *>(outputs[0]);
+    fc32_t *output1 = reinterpret_cast<fc32_t *>(outputs[1]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 16));
+
+    size_t i = 0;
+    for (; i+2 <= nsamps; i+=2){
+        __m128 lo, hi;
+        items_to_fc32<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+2*i)), lo, hi, scalar);
+        _mm_storeu_ps(reinterpret_cast<float *>(output0+i), unpacklo_samps(lo, hi));
+        _mm_storeu_ps(reinterpret_cast<float *>(output1+i), unpackhi_samps(lo, hi));
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output0[i] = item32_to_fc32(swap_item<bswap>(input[2*i+0]), float(scale_factor));
+        output1[i] = item32_to_fc32(swap_item<bswap>(input[2*i+1]), float(scale_factor));
+    }
+}
+
+template <bool bswap> static void item32_1_to_fc32_4(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output0 = reinterpret_cast<fc32_t *>(outputs[0]);
+    fc32_t *output1 = reinterpret_cast<fc32_t *>(outputs[1]);
+    fc32_t *output2 = reinterpret_cast<fc32_t *>(outputs[2]);
+    fc32_t *output3 = reinterpret_cast<fc32_t *>(outputs[3]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 16));
+
+    size_t i = 0;
+    for (; i+2 <= nsamps; i+=2){
+        //ab0 = ch0s0 ch1s0, cd0 = ch2s0 ch3s0, then the same for s1
+        __m128 ab0, cd0, ab1, cd1;
+        items_to_fc32<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+0)), ab0, cd0, scalar);
+        items_to_fc32<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+4)), ab1, cd1, scalar);
+        _mm_storeu_ps(reinterpret_cast<float *>(output0+i), unpacklo_samps(ab0, ab1));
+        _mm_storeu_ps(reinterpret_cast<float *>(output1+i), unpackhi_samps(ab0, ab1));
+        _mm_storeu_ps(reinterpret_cast<float *>(output2+i), unpacklo_samps(cd0, cd1));
+        _mm_storeu_ps(reinterpret_cast<float *>(output3+i), unpackhi_samps(cd0, cd1));
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output0[i] = item32_to_fc32(swap_item<bswap>(input[4*i+0]), float(scale_factor));
+        output1[i] = item32_to_fc32(swap_item<bswap>(input[4*i+1]), float(scale_factor));
+        output2[i] = item32_to_fc32(swap_item<bswap>(input[4*i+2]), float(scale_factor));
+        output3[i] = item32_to_fc32(swap_item<bswap>(input[4*i+3]), float(scale_factor));
+    }
+}
+
+/***********************************************************************
+ * sc16 interleave/deinterleave implementations:
+ * An sc16 sample is 32 bits, so (de)interleaving is a 32-bit transpose.
+ **********************************************************************/
+template <bool bswap> static void sc16_2_to_item32_1(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const sc16_t *input0 = reinterpret_cast<const sc16_t *>(inputs[0]);
+    const sc16_t *input1 = reinterpret_cast<const sc16_t *>(inputs[1]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input0+i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input1+i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+2*i+0), swap_items<bswap>(_mm_unpacklo_epi32(a, b)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+2*i+4), swap_items<bswap>(_mm_unpackhi_epi32(a, b)));
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[2*i+0] = swap_item<bswap>(sc16_to_item32(input0[i], scale_factor));
+        output[2*i+1] = swap_item<bswap>(sc16_to_item32(input1[i], scale_factor));
+    }
+}
+
+template <bool bswap> static void sc16_4_to_item32_1(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const sc16_t *input0 = reinterpret_cast<const sc16_t *>(inputs[0]);
+    const sc16_t *input1 = reinterpret_cast<const sc16_t *>(inputs[1]);
+    const sc16_t *input2 = reinterpret_cast<const sc16_t *>(inputs[2]);
+    const sc16_t *input3 = reinterpret_cast<const sc16_t *>(inputs[3]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input0+i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input1+i));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input2+i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input3+i));
+        __m128i ab01 = _mm_unpacklo_epi32(a, b), cd01 = _mm_unpacklo_epi32(c, d);
+        __m128i ab23 = _mm_unpackhi_epi32(a, b), cd23 = _mm_unpackhi_epi32(c, d);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+0),  swap_items<bswap>(_mm_unpacklo_epi64(ab01, cd01)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+4),  swap_items<bswap>(_mm_unpackhi_epi64(ab01, cd01)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+8),  swap_items<bswap>(_mm_unpacklo_epi64(ab23, cd23)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+12), swap_items<bswap>(_mm_unpackhi_epi64(ab23, cd23)));
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[4*i+0] = swap_item<bswap>(sc16_to_item32(input0[i], scale_factor));
+        output[4*i+1] = swap_item<bswap>(sc16_to_item32(input1[i], scale_factor));
+        output[4*i+2] = swap_item<bswap>(sc16_to_item32(input2[i], scale_factor));
+        output[4*i+3] = swap_item<bswap>(sc16_to_item32(input3[i], scale_factor));
+    }
+}
+
+template <bool bswap> static void item32_1_to_sc16_2(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output0 = reinterpret_cast<sc16_t *>(outputs[0]);
+    sc16_t *output1 = reinterpret_cast<sc16_t *>(outputs[1]);
+
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        __m128i v0 = swap_items<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+2*i+0)));
+        __m128i v1 = swap_items<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+2*i+4)));
+        __m128i t0 = _mm_unpacklo_epi32(v0, v1), t1 = _mm_unpackhi_epi32(v0, v1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output0+i), _mm_unpacklo_epi32(t0, t1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output1+i), _mm_unpackhi_epi32(t0, t1));
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output0[i] = item32_to_sc16(swap_item<bswap>(input[2*i+0]), scale_factor);
+        output1[i] = item32_to_sc16(swap_item<bswap>(input[2*i+1]), scale_factor);
+    }
+}
+
+template <bool bswap> static void item32_1_to_sc16_4(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output0 = reinterpret_cast<sc16_t *>(outputs[0]);
+    sc16_t *output1 = reinterpret_cast<sc16_t *>(outputs[1]);
+    sc16_t *output2 = reinterpret_cast<sc16_t *>(outputs[2]);
+    sc16_t *output3 = reinterpret_cast<sc16_t *>(outputs[3]);
+
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        __m128i v0 = swap_items<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+0)));
+        __m128i v1 = swap_items<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+4)));
+        __m128i v2 = swap_items<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+8)));
+        __m128i v3 = swap_items<bswap>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+12)));
+        __m128i t01lo = _mm_unpacklo_epi32(v0, v1), t23lo = _mm_unpacklo_epi32(v2, v3);
+        __m128i t01hi = _mm_unpackhi_epi32(v0, v1), t23hi = _mm_unpackhi_epi32(v2, v3);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output0+i), _mm_unpacklo_epi64(t01lo, t23lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output1+i), _mm_unpackhi_epi64(t01lo, t23lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output2+i), _mm_unpacklo_epi64(t01hi, t23hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output3+i), _mm_unpackhi_epi64(t01hi, t23hi));
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output0[i] = item32_to_sc16(swap_item<bswap>(input[4*i+0]), scale_factor);
+        output1[i] = item32_to_sc16(swap_item<bswap>(input[4*i+1]), scale_factor);
+        output2[i] = item32_to_sc16(swap_item<bswap>(input[4*i+2]), scale_factor);
+        output3[i] = item32_to_sc16(swap_item<bswap>(input[4*i+3]), scale_factor);
+    }
+}
+
+/***********************************************************************
+ * Registration
+ **********************************************************************/
+#define DECLARE_INTERLEAVE_CONVERTERS(fcn, markup_head, markup_tail) \
+    DECLARE_CONVERTER(convert_##markup_head##_to_##markup_tail##_nswap, PRIORITY_CUSTOM){ \
+        fcn<false>(inputs, outputs, nsamps, scale_factor); \
+    } \
+    DECLARE_CONVERTER(convert_##markup_head##_to_##markup_tail##_bswap, PRIORITY_CUSTOM){ \
+        fcn<true>(inputs, outputs, nsamps, scale_factor); \
+    }
+
+DECLARE_INTERLEAVE_CONVERTERS(fc32_2_to_item32_1, fc32_2, item32_1)
+DECLARE_INTERLEAVE_CONVERTERS(fc32_4_to_item32_1, fc32_4, item32_1)
+DECLARE_INTERLEAVE_CONVERTERS(item32_1_to_fc32_2, item32_1, fc32_2)
+DECLARE_INTERLEAVE_CONVERTERS(item32_1_to_fc32_4, item32_1, fc32_4)
+DECLARE_INTERLEAVE_CONVERTERS(sc16_2_to_item32_1, sc16_2, item32_1)
+DECLARE_INTERLEAVE_CONVERTERS(sc16_4_to_item32_1, sc16_4, item32_1)
+DECLARE_INTERLEAVE_CONVERTERS(item32_1_to_sc16_2, item32_1, sc16_2)
+DECLARE_INTERLEAVE_CONVERTERS(item32_1_to_sc16_4, item32_1, sc16_4)
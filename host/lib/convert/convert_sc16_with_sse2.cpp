@@ -0,0 +1,99 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * The sc16 <-> item32 conversions are pure data movement:
+ * An item32 is (i << 16) | q, so its native (nswap) layout in memory
+ * is q, i and the halves of each item swap places.
+ * The big endian (bswap) layout is i, q with each half byte swapped.
+ * Either swap is its own inverse and serves both directions.
+ * The copy moves 8 samples (32 bytes) per iteration.
+ **********************************************************************/
+static UHD_INLINE __m128i swap32_halves(__m128i tmpi){
+    tmpi = _mm_shufflelo_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+static UHD_INLINE __m128i swap16_bytes(__m128i tmpi){
+    return _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8));
+}
+
+#define SC16_ITEM32_COPY(swap_fcn) \
+    size_t i = 0; \
+    for (; i+8 <= nsamps; i+=8){ \
+        __m128i tmpi0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i+0)); \
+        __m128i tmpi1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i+4)); \
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i+0), swap_fcn(tmpi0)); \
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i+4), swap_fcn(tmpi1)); \
+    }
+
+/***********************************************************************
+ * Convert sc16 <-> item32
+ **********************************************************************/
+DECLARE_CONVERTER(convert_sc16_1_to_item32_1_nswap, PRIORITY_CUSTOM){
+    const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    SC16_ITEM32_COPY(swap32_halves)
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = sc16_to_item32(input[i], scale_factor);
+    }
+}
+
+DECLARE_CONVERTER(convert_sc16_1_to_item32_1_bswap, PRIORITY_CUSTOM){
+    const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    SC16_ITEM32_COPY(swap16_bytes)
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = uhd::byteswap(sc16_to_item32(input[i], scale_factor));
+    }
+}
+
+DECLARE_CONVERTER(convert_item32_1_to_sc16_1_nswap, PRIORITY_CUSTOM){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    SC16_ITEM32_COPY(swap32_halves)
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item32_to_sc16(input[i], scale_factor);
+    }
+}
+
+DECLARE_CONVERTER(convert_item32_1_to_sc16_1_bswap, PRIORITY_CUSTOM){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    SC16_ITEM32_COPY(swap16_bytes)
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item32_to_sc16(uhd::byteswap(input[i]), scale_factor);
+    }
+}
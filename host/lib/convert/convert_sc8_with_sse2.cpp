@@ -0,0 +1,206 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * Packed sc8 items: 8 samples (16 bytes) per iteration.
+ * An item16 is (i << 8) | q, so the big endian (bswap) byte order
+ * is the order packs_epi16 produces: i0 q0 i1 q1...
+ **********************************************************************/
+static UHD_INLINE __m128i swap16_bytes(__m128i tmpi){
+    return _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8));
+}
+
+static UHD_INLINE __m128i fc32_to_epi8(const fc32_t *input, const __m128 &scalar){
+    __m128i tmpi0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(reinterpret_cast<const float *>(input+0)), scalar));
+    __m128i tmpi1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(reinterpret_cast<const float *>(input+2)), scalar));
+    __m128i tmpi2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(reinterpret_cast<const float *>(input+4)), scalar));
+    __m128i tmpi3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(reinterpret_cast<const float *>(input+6)), scalar));
+    return _mm_packs_epi16(_mm_packs_epi32(tmpi0, tmpi1), _mm_packs_epi32(tmpi2, tmpi3));
+}
+
+static UHD_INLINE void epi8_to_fc32(__m128i tmpi, fc32_t *output, const __m128 &scalar){
+    //unpack each byte into the top of an int32, the scalar undoes the << 24
+    const __m128i zeroi = _mm_setzero_si128();
+    __m128i tmpilo = _mm_unpacklo_epi8(zeroi, tmpi);
+    __m128i tmpihi = _mm_unpackhi_epi8(zeroi, tmpi);
+    _mm_storeu_ps(reinterpret_cast<float *>(output+0), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(zeroi, tmpilo)), scalar));
+    _mm_storeu_ps(reinterpret_cast<float *>(output+2), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(zeroi, tmpilo)), scalar));
+    _mm_storeu_ps(reinterpret_cast<float *>(output+4), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(zeroi, tmpihi)), scalar));
+    _mm_storeu_ps(reinterpret_cast<float *>(output+6), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(zeroi, tmpihi)), scalar));
+}
+
+static UHD_INLINE __m128i sc16_to_epi8(const sc16_t *input){
+    //otw_int = dsp_int >> 8, the pack cannot saturate after the shift
+    __m128i tmpilo = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+0)), 8);
+    __m128i tmpihi = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4)), 8);
+    return _mm_packs_epi16(tmpilo, tmpihi);
+}
+
+static UHD_INLINE void epi8_to_sc16(__m128i tmpi, sc16_t *output){
+    //dsp_int = otw_int << 8
+    const __m128i zeroi = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output+0), _mm_unpacklo_epi8(zeroi, tmpi));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4), _mm_unpackhi_epi8(zeroi, tmpi));
+}
+
+/***********************************************************************
+ * Convert fc32 <-> item16
+ **********************************************************************/
+DECLARE_CONVERTER(convert_fc32_1_to_item16_1_nswap, PRIORITY_CUSTOM){
+    const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+    item16_t *output = reinterpret_cast<item16_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpi = swap16_bytes(fc32_to_epi8(input+i, scalar));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = fc32_to_item16(input[i], float(scale_factor));
+    }
+}
+
+DECLARE_CONVERTER(convert_fc32_1_to_item16_1_bswap, PRIORITY_CUSTOM){
+    const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+    item16_t *output = reinterpret_cast<item16_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpi = fc32_to_epi8(input+i, scalar);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = uhd::byteswap(fc32_to_item16(input[i], float(scale_factor)));
+    }
+}
+
+DECLARE_CONVERTER(convert_item16_1_to_fc32_1_nswap, PRIORITY_CUSTOM){
+    const item16_t *input = reinterpret_cast<const item16_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 24));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+        epi8_to_fc32(swap16_bytes(tmpi), output+i, scalar);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item16_to_fc32(input[i], float(scale_factor));
+    }
+}
+
+DECLARE_CONVERTER(convert_item16_1_to_fc32_1_bswap, PRIORITY_CUSTOM){
+    const item16_t *input = reinterpret_cast<const item16_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 24));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+        epi8_to_fc32(tmpi, output+i, scalar);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item16_to_fc32(uhd::byteswap(input[i]), float(scale_factor));
+    }
+}
+
+/***********************************************************************
+ * Convert sc16 <-> item16
+ **********************************************************************/
+DECLARE_CONVERTER(convert_sc16_1_to_item16_1_nswap, PRIORITY_CUSTOM){
+    const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
+    item16_t *output = reinterpret_cast<item16_t *>(outputs[0]);
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpi = swap16_bytes(sc16_to_epi8(input+i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = sc16_to_item16(input[i], scale_factor);
+    }
+}
+
+DECLARE_CONVERTER(convert_sc16_1_to_item16_1_bswap, PRIORITY_CUSTOM){
+    const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
+    item16_t *output = reinterpret_cast<item16_t *>(outputs[0]);
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpi = sc16_to_epi8(input+i);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = uhd::byteswap(sc16_to_item16(input[i], scale_factor));
+    }
+}
+
+DECLARE_CONVERTER(convert_item16_1_to_sc16_1_nswap, PRIORITY_CUSTOM){
+    const item16_t *input = reinterpret_cast<const item16_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+        epi8_to_sc16(swap16_bytes(tmpi), output+i);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item16_to_sc16(input[i], scale_factor);
+    }
+}
+
+DECLARE_CONVERTER(convert_item16_1_to_sc16_1_bswap, PRIORITY_CUSTOM){
+    const item16_t *input = reinterpret_cast<const item16_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+        epi8_to_sc16(tmpi, output+i);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item16_to_sc16(uhd::byteswap(input[i]), scale_factor);
+    }
+}
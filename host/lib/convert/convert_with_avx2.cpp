@@ -0,0 +1,410 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <immintrin.h>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * This file is compiled with AVX2 enabled:
+ * The converters are not registered by static blocks here,
+ * because the host cpu may not support AVX2 instructions.
+ * convert_dispatch.cpp calls convert_register_avx2()
+ * once a runtime cpu check finds AVX2 support.
+ *
+ * All loads and stores are unaligned: on AVX2 capable cpus,
+ * unaligned accesses to aligned memory cost the same as aligned ones.
+ * The exception are the streaming converters at the end of this file.
+ **********************************************************************/
+
+/***********************************************************************
+ * Helpers: 8 samples at a time
+ **********************************************************************/
+//! swap the 16-bit halves of each item32 (nswap)
+static UHD_INLINE __m256i swap16_pairs(__m256i tmpi){
+    tmpi = _mm256_shufflelo_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_shufflehi_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+//! byteswap each 16-bit word (bswap)
+static UHD_INLINE __m256i swap16_bytes(__m256i tmpi){
+    return _mm256_or_si256(_mm256_srli_epi16(tmpi, 8), _mm256_slli_epi16(tmpi, 8));
+}
+
+//! pack 16 int32 values into 16 saturated int16 values in order
+static UHD_INLINE __m256i pack_epi32_in_order(__m256i tmpilo, __m256i tmpihi){
+    //the pack works within 128-bit lanes, so take the 64-bit blocks in order
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(tmpilo, tmpihi), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+//! spread 16 int16 values into two vectors of int32 values (in the upper 16 bits)
+static UHD_INLINE void unpack_epi16_in_order(__m256i tmpi, __m256i &tmpilo, __m256i &tmpihi){
+    //the unpack works within 128-bit lanes, so order the 64-bit blocks first
+    tmpi = _mm256_permute4x64_epi64(tmpi, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256i zeroi = _mm256_setzero_si256();
+    tmpilo = _mm256_unpacklo_epi16(zeroi, tmpi);
+    tmpihi = _mm256_unpackhi_epi16(zeroi, tmpi);
+}
+
+static UHD_INLINE __m256i fc32_to_epi16(const fc32_t *input, const __m256 &scalar){
+    __m256 tmplo = _mm256_loadu_ps(reinterpret_cast<const float *>(input+0));
+    __m256 tmphi = _mm256_loadu_ps(reinterpret_cast<const float *>(input+4));
+    __m256i tmpilo = _mm256_cvtps_epi32(_mm256_mul_ps(tmplo, scalar));
+    __m256i tmpihi = _mm256_cvtps_epi32(_mm256_mul_ps(tmphi, scalar));
+    return pack_epi32_in_order(tmpilo, tmpihi);
+}
+
+static UHD_INLINE void epi16_to_fc32(__m256i tmpi, fc32_t *output, const __m256 &scalar){
+    __m256i tmpilo, tmpihi;
+    unpack_epi16_in_order(tmpi, tmpilo, tmpihi);
+    _mm256_storeu_ps(reinterpret_cast<float *>(output+0), _mm256_mul_ps(_mm256_cvtepi32_ps(tmpilo), scalar));
+    _mm256_storeu_ps(reinterpret_cast<float *>(output+4), _mm256_mul_ps(_mm256_cvtepi32_ps(tmpihi), scalar));
+}
+
+static UHD_INLINE __m256i fc64_to_epi32(const fc64_t *input, const __m256d &scalar){
+    __m256d tmp0 = _mm256_loadu_pd(reinterpret_cast<const double *>(input+0));
+    __m256d tmp1 = _mm256_loadu_pd(reinterpret_cast<const double *>(input+2));
+    __m128i tmpi0 = _mm256_cvttpd_epi32(_mm256_mul_pd(tmp0, scalar));
+    __m128i tmpi1 = _mm256_cvttpd_epi32(_mm256_mul_pd(tmp1, scalar));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(tmpi0), tmpi1, 1);
+}
+
+static UHD_INLINE __m256i fc64_to_epi16(const fc64_t *input, const __m256d &scalar){
+    return pack_epi32_in_order(fc64_to_epi32(input+0, scalar), fc64_to_epi32(input+4, scalar));
+}
+
+static UHD_INLINE void epi32_to_fc64(__m256i tmpi, fc64_t *output, const __m256d &scalar){
+    __m256d tmp0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(tmpi));
+    __m256d tmp1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(tmpi, 1));
+    _mm256_storeu_pd(reinterpret_cast<double *>(output+0), _mm256_mul_pd(tmp0, scalar));
+    _mm256_storeu_pd(reinterpret_cast<double *>(output+2), _mm256_mul_pd(tmp1, scalar));
+}
+
+static UHD_INLINE void epi16_to_fc64(__m256i tmpi, fc64_t *output, const __m256d &scalar){
+    __m256i tmpilo, tmpihi;
+    unpack_epi16_in_order(tmpi, tmpilo, tmpihi);
+    epi32_to_fc64(tmpilo, output+0, scalar);
+    epi32_to_fc64(tmpihi, output+4, scalar);
+}
+
+/***********************************************************************
+ * Convert fc32 <-> item32
+ **********************************************************************/
+static void convert_fc32_1_to_item32_1_nswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpi = swap16_pairs(fc32_to_epi16(input+i, scalar));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = fc32_to_item32(input[i], float(scale_factor));
+    }
+}
+
+static void convert_fc32_1_to_item32_1_bswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpi = swap16_bytes(fc32_to_epi16(input+i, scalar));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = uhd::byteswap(fc32_to_item32(input[i], float(scale_factor)));
+    }
+}
+
+static void convert_item32_1_to_fc32_1_nswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor)/(1 << 16));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+        epi16_to_fc32(swap16_pairs(tmpi), output+i, scalar);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item32_to_fc32(input[i], float(scale_factor));
+    }
+}
+
+static void convert_item32_1_to_fc32_1_bswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor)/(1 << 16));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+        epi16_to_fc32(swap16_bytes(tmpi), output+i, scalar);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item32_to_fc32(uhd::byteswap(input[i]), float(scale_factor));
+    }
+}
+
+/***********************************************************************
+ * Convert fc64 <-> item32
+ **********************************************************************/
+static void convert_fc64_1_to_item32_1_nswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const fc64_t *input = reinterpret_cast<const fc64_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const __m256d scalar = _mm256_set1_pd(scale_factor);
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpi = swap16_pairs(fc64_to_epi16(input+i, scalar));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = fc64_to_item32(input[i], scale_factor);
+    }
+}
+
+static void convert_fc64_1_to_item32_1_bswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const fc64_t *input = reinterpret_cast<const fc64_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const __m256d scalar = _mm256_set1_pd(scale_factor);
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpi = swap16_bytes(fc64_to_epi16(input+i, scalar));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i), tmpi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = uhd::byteswap(fc64_to_item32(input[i], scale_factor));
+    }
+}
+
+static void convert_item32_1_to_fc64_1_nswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
+
+    const __m256d scalar = _mm256_set1_pd(scale_factor/(1 << 16));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+        epi16_to_fc64(swap16_pairs(tmpi), output+i, scalar);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item32_to_fc64(input[i], scale_factor);
+    }
+}
+
+static void convert_item32_1_to_fc64_1_bswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
+
+    const __m256d scalar = _mm256_set1_pd(scale_factor/(1 << 16));
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+        epi16_to_fc64(swap16_bytes(tmpi), output+i, scalar);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item32_to_fc64(uhd::byteswap(input[i]), scale_factor);
+    }
+}
+
+/***********************************************************************
+ * Streaming converters item32 -> fc32/fc64:
+ * The non-temporal stores write the output around the caches,
+ * which keeps the caches for the transport frames when the output
+ * is a large buffer that is not read back right away (ex: to disk).
+ * They hurt when the output is read back soon after the conversion,
+ * so they register below the general priority and only run when
+ * forced with the custom_stream priority.
+ *
+ * Streaming stores need 32-byte aligned addresses:
+ * The head is converted one sample at a time until the output is aligned,
+ * which is never with a buffer from uhd::alloc_sample_buffer().
+ * An output that is not aligned to its sample size never gets aligned
+ * and is converted one sample at a time.
+ **********************************************************************/
+template <bool bswap> static UHD_INLINE __m256i load_item32_stream(const item32_t *input){
+    const __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input));
+    return bswap? swap16_bytes(tmpi) : swap16_pairs(tmpi);
+}
+
+static UHD_INLINE bool is_stream_aligned(const void *output){
+    return (size_t(output) & 0x1f) == 0;
+}
+
+template <bool bswap> static UHD_INLINE void stream_item32_to_fc32(
+    const item32_t *input, fc32_t *output, size_t nsamps, double scale_factor
+){
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor)/(1 << 16));
+
+    //convert the head until the output is aligned
+    size_t i = 0;
+    for (; i < nsamps and not is_stream_aligned(output+i); i++){
+        output[i] = item32_to_fc32(bswap? uhd::byteswap(input[i]) : input[i], float(scale_factor));
+    }
+
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpilo, tmpihi;
+        unpack_epi16_in_order(load_item32_stream<bswap>(input+i), tmpilo, tmpihi);
+        _mm256_stream_ps(reinterpret_cast<float *>(output+i+0), _mm256_mul_ps(_mm256_cvtepi32_ps(tmpilo), scalar));
+        _mm256_stream_ps(reinterpret_cast<float *>(output+i+4), _mm256_mul_ps(_mm256_cvtepi32_ps(tmpihi), scalar));
+    }
+    _mm_sfence(); //order the streaming stores before the caller reads
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item32_to_fc32(bswap? uhd::byteswap(input[i]) : input[i], float(scale_factor));
+    }
+}
+
+static UHD_INLINE void stream_epi32_to_fc64(__m256i tmpi, fc64_t *output, const __m256d &scalar){
+    __m256d tmp0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(tmpi));
+    __m256d tmp1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(tmpi, 1));
+    _mm256_stream_pd(reinterpret_cast<double *>(output+0), _mm256_mul_pd(tmp0, scalar));
+    _mm256_stream_pd(reinterpret_cast<double *>(output+2), _mm256_mul_pd(tmp1, scalar));
+}
+
+template <bool bswap> static UHD_INLINE void stream_item32_to_fc64(
+    const item32_t *input, fc64_t *output, size_t nsamps, double scale_factor
+){
+    const __m256d scalar = _mm256_set1_pd(scale_factor/(1 << 16));
+
+    //convert the head until the output is aligned
+    size_t i = 0;
+    for (; i < nsamps and not is_stream_aligned(output+i); i++){
+        output[i] = item32_to_fc64(bswap? uhd::byteswap(input[i]) : input[i], scale_factor);
+    }
+
+    for (; i+8 <= nsamps; i+=8){
+        __m256i tmpilo, tmpihi;
+        unpack_epi16_in_order(load_item32_stream<bswap>(input+i), tmpilo, tmpihi);
+        stream_epi32_to_fc64(tmpilo, output+i+0, scalar);
+        stream_epi32_to_fc64(tmpihi, output+i+4, scalar);
+    }
+    _mm_sfence(); //order the streaming stores before the caller reads
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item32_to_fc64(bswap? uhd::byteswap(input[i]) : input[i], scale_factor);
+    }
+}
+
+static void convert_stream_item32_1_to_fc32_1_nswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    stream_item32_to_fc32<false>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+static void convert_stream_item32_1_to_fc32_1_bswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    stream_item32_to_fc32<true>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+static void convert_stream_item32_1_to_fc64_1_nswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    stream_item32_to_fc64<false>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<fc64_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+static void convert_stream_item32_1_to_fc64_1_bswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    stream_item32_to_fc64<true>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<fc64_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+/***********************************************************************
+ * Registration: called only on cpus with AVX2 support
+ **********************************************************************/
+#define REGISTER_AVX2_CONVERTER(fcn) \
+    register_converter(#fcn, fcn, PRIORITY_CUSTOM_AVX2)
+
+void convert_register_avx2(void){
+    REGISTER_AVX2_CONVERTER(convert_fc32_1_to_item32_1_nswap);
+    REGISTER_AVX2_CONVERTER(convert_fc32_1_to_item32_1_bswap);
+    REGISTER_AVX2_CONVERTER(convert_item32_1_to_fc32_1_nswap);
+    REGISTER_AVX2_CONVERTER(convert_item32_1_to_fc32_1_bswap);
+    REGISTER_AVX2_CONVERTER(convert_fc64_1_to_item32_1_nswap);
+    REGISTER_AVX2_CONVERTER(convert_fc64_1_to_item32_1_bswap);
+    REGISTER_AVX2_CONVERTER(convert_item32_1_to_fc64_1_nswap);
+    REGISTER_AVX2_CONVERTER(convert_item32_1_to_fc64_1_bswap);
+
+    //the markups drop the stream prefix of the function names
+    register_converter("convert_item32_1_to_fc32_1_nswap", convert_stream_item32_1_to_fc32_1_nswap, PRIORITY_CUSTOM_STREAM);
+    register_converter("convert_item32_1_to_fc32_1_bswap", convert_stream_item32_1_to_fc32_1_bswap, PRIORITY_CUSTOM_STREAM);
+    register_converter("convert_item32_1_to_fc64_1_nswap", convert_stream_item32_1_to_fc64_1_nswap, PRIORITY_CUSTOM_STREAM);
+    register_converter("convert_item32_1_to_fc64_1_bswap", convert_stream_item32_1_to_fc64_1_bswap, PRIORITY_CUSTOM_STREAM);
+}
@@ -16,46 +16,506 @@
 //
 
 #include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
 #include <arm_neon.h>
 
 using namespace uhd::convert;
 
-DECLARE_CONVERTER(convert_fc32_1_to_item32_1_nswap, PRIORITY_CUSTOM){
-    const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
-    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+/***********************************************************************
+ * Helpers: 4 samples of item32 per 128-bit register.
+ * The nswap items are little endian, i is in the upper 16 bits;
+ * the bswap items are big endian, vrev32 on the bytes swaps each item.
+ **********************************************************************/
+template <bool bswap> static UHD_INLINE uint32x4_t swap_items(uint32x4_t items){
+    if (bswap) return vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(items)));
+    return items;
+}
+
+static UHD_INLINE int16x8_t f32_to_s16(float32x4_t lo, float32x4_t hi, float32x4_t scalar){
+    return vcombine_s16(
+        vmovn_s32(vcvtq_s32_f32(vmulq_f32(lo, scalar))),
+        vmovn_s32(vcvtq_s32_f32(vmulq_f32(hi, scalar)))
+    );
+}
+
+static UHD_INLINE float32x4x2_t s16_to_f32(int16x8_t Q0, float32x4_t scalar){
+    float32x4x2_t Q1;
+    Q1.val[0] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(Q0))), scalar);
+    Q1.val[1] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(Q0))), scalar);
+    return Q1;
+}
+
+static UHD_INLINE uint32x4_t sc16_to_items(int16x8_t Q0){
+    return vreinterpretq_u32_s16(vrev32q_s16(Q0));
+}
+
+static UHD_INLINE int16x8_t items_to_sc16(uint32x4_t items){
+    return vrev32q_s16(vreinterpretq_s16_u32(items));
+}
+
+static UHD_INLINE void items_to_fc32(uint32x4_t items, fc32_t *output, float32x4_t scalar){
+    float32x4x2_t Q0 = s16_to_f32(items_to_sc16(items), scalar);
+    vst1q_f32(reinterpret_cast<float *>(output+0), Q0.val[0]);
+    vst1q_f32(reinterpret_cast<float *>(output+2), Q0.val[1]);
+}
+
+/***********************************************************************
+ * The armv7 neon unit has no double lanes:
+ * fc64 samples are narrowed to floats (and back) by the vfp,
+ * the scaling and the integer conversions happen in the neon unit.
+ * The item32 -> fc64 general converter also scales in float.
+ **********************************************************************/
+static UHD_INLINE float32x4_t fc64_to_f32(const fc64_t *input){
+    const float tmp[4] = {
+        float(input[0].real()), float(input[0].imag()),
+        float(input[1].real()), float(input[1].imag())
+    };
+    return vld1q_f32(tmp);
+}
+
+static UHD_INLINE void f32_to_fc64(float32x4_t Q0, fc64_t *output){
+    float tmp[4];
+    vst1q_f32(tmp, Q0);
+    output[0] = fc64_t(tmp[0], tmp[1]);
+    output[1] = fc64_t(tmp[2], tmp[3]);
+}
+
+/***********************************************************************
+ * Convert fc32 and fc64 <-> item32
+ **********************************************************************/
+template <bool bswap> static UHD_INLINE void fc32_to_item32_neon(
+    const fc32_t *input, item32_t *output, size_t nsamps, double scale_factor
+){
+    float32x4_t Q0 = vdupq_n_f32(float(scale_factor));
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        int16x8_t Q1 = f32_to_s16(
+            vld1q_f32(reinterpret_cast<const float *>(&input[i+0])),
+            vld1q_f32(reinterpret_cast<const float *>(&input[i+2])), Q0
+        );
+        vst1q_u32(&output[i], swap_items<bswap>(sc16_to_items(Q1)));
+    }
 
-    size_t i;
+    for (; i < nsamps; i++){
+        const item32_t item = fc32_to_item32(input[i], float(scale_factor));
+        output[i] = bswap? uhd::byteswap(item) : item;
+    }
+}
 
+template <bool bswap> static UHD_INLINE void item32_to_fc32_neon(
+    const item32_t *input, fc32_t *output, size_t nsamps, double scale_factor
+){
     float32x4_t Q0 = vdupq_n_f32(float(scale_factor));
-    for (i=0; i < (nsamps & ~0x03); i+=2) {
-        float32x4_t Q1 = vld1q_f32(reinterpret_cast<const float *>(&input[i]));
-        float32x4_t Q2 = vmulq_f32(Q1, Q0);
-        int32x4_t Q3 = vcvtq_s32_f32(Q2);
-        int16x4_t D8 = vmovn_s32(Q3);
-        int16x4_t D9 = vrev32_s16(D8);
-        vst1_s16((reinterpret_cast<int16_t *>(&output[i])), D9);
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        items_to_fc32(swap_items<bswap>(vld1q_u32(&input[i])), &output[i], Q0);
     }
 
-    for (; i < nsamps; i++)
-        output[i] = fc32_to_item32(input[i], float(scale_factor));
+    for (; i < nsamps; i++){
+        output[i] = item32_to_fc32(bswap? uhd::byteswap(input[i]) : input[i], float(scale_factor));
+    }
+}
+
+template <bool bswap> static UHD_INLINE void fc64_to_item32_neon(
+    const fc64_t *input, item32_t *output, size_t nsamps, double scale_factor
+){
+    float32x4_t Q0 = vdupq_n_f32(float(scale_factor));
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        int16x8_t Q1 = f32_to_s16(fc64_to_f32(&input[i+0]), fc64_to_f32(&input[i+2]), Q0);
+        vst1q_u32(&output[i], swap_items<bswap>(sc16_to_items(Q1)));
+    }
+
+    for (; i < nsamps; i++){
+        const item32_t item = fc64_to_item32(input[i], scale_factor);
+        output[i] = bswap? uhd::byteswap(item) : item;
+    }
+}
+
+template <bool bswap> static UHD_INLINE void item32_to_fc64_neon(
+    const item32_t *input, fc64_t *output, size_t nsamps, double scale_factor
+){
+    float32x4_t Q0 = vdupq_n_f32(float(scale_factor));
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        float32x4x2_t Q1 = s16_to_f32(items_to_sc16(swap_items<bswap>(vld1q_u32(&input[i]))), Q0);
+        f32_to_fc64(Q1.val[0], &output[i+0]);
+        f32_to_fc64(Q1.val[1], &output[i+2]);
+    }
+
+    for (; i < nsamps; i++){
+        output[i] = item32_to_fc64(bswap? uhd::byteswap(input[i]) : input[i], scale_factor);
+    }
+}
+
+DECLARE_CONVERTER(convert_fc32_1_to_item32_1_nswap, PRIORITY_CUSTOM){
+    fc32_to_item32_neon<false>(
+        reinterpret_cast<const fc32_t *>(inputs[0]),
+        reinterpret_cast<item32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_fc32_1_to_item32_1_bswap, PRIORITY_CUSTOM){
+    fc32_to_item32_neon<true>(
+        reinterpret_cast<const fc32_t *>(inputs[0]),
+        reinterpret_cast<item32_t *>(outputs[0]), nsamps, scale_factor
+    );
 }
 
 DECLARE_CONVERTER(convert_item32_1_to_fc32_1_nswap, PRIORITY_CUSTOM){
+    item32_to_fc32_neon<false>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_item32_1_to_fc32_1_bswap, PRIORITY_CUSTOM){
+    item32_to_fc32_neon<true>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_fc64_1_to_item32_1_nswap, PRIORITY_CUSTOM){
+    fc64_to_item32_neon<false>(
+        reinterpret_cast<const fc64_t *>(inputs[0]),
+        reinterpret_cast<item32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_fc64_1_to_item32_1_bswap, PRIORITY_CUSTOM){
+    fc64_to_item32_neon<true>(
+        reinterpret_cast<const fc64_t *>(inputs[0]),
+        reinterpret_cast<item32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_item32_1_to_fc64_1_nswap, PRIORITY_CUSTOM){
+    item32_to_fc64_neon<false>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<fc64_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_item32_1_to_fc64_1_bswap, PRIORITY_CUSTOM){
+    item32_to_fc64_neon<true>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<fc64_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+/***********************************************************************
+ * Packed sc8 items: 8 samples (16 bytes) per iteration.
+ * An item16 is (i << 8) | q, so the big endian (bswap) byte order
+ * is the order the narrowing produces: i0 q0 i1 q1...
+ * The nswap items swap the bytes of each pair with vrev16.
+ **********************************************************************/
+template <bool bswap> static UHD_INLINE int8x16_t swap_items16(int8x16_t bytes){
+    if (bswap) return bytes;
+    return vrev16q_s8(bytes);
+}
+
+template <bool bswap> static UHD_INLINE void fc32_to_item16_neon(
+    const fc32_t *input, item16_t *output, size_t nsamps, double scale_factor
+){
+    float32x4_t Q0 = vdupq_n_f32(float(scale_factor));
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        const float *in = reinterpret_cast<const float *>(&input[i]);
+        int16x8_t Q1 = f32_to_s16(vld1q_f32(in+0), vld1q_f32(in+4), Q0);
+        int16x8_t Q2 = f32_to_s16(vld1q_f32(in+8), vld1q_f32(in+12), Q0);
+        int8x16_t Q3 = vcombine_s8(vmovn_s16(Q1), vmovn_s16(Q2));
+        vst1q_s8(reinterpret_cast<int8_t *>(&output[i]), swap_items16<bswap>(Q3));
+    }
+
+    for (; i < nsamps; i++){
+        const item16_t item = fc32_to_item16(input[i], float(scale_factor));
+        output[i] = bswap? uhd::byteswap(item) : item;
+    }
+}
+
+template <bool bswap> static UHD_INLINE void item16_to_fc32_neon(
+    const item16_t *input, fc32_t *output, size_t nsamps, double scale_factor
+){
+    float32x4_t Q0 = vdupq_n_f32(float(scale_factor));
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        int8x16_t Q1 = swap_items16<bswap>(vld1q_s8(reinterpret_cast<const int8_t *>(&input[i])));
+        float32x4x2_t Q2 = s16_to_f32(vmovl_s8(vget_low_s8(Q1)), Q0);
+        float32x4x2_t Q3 = s16_to_f32(vmovl_s8(vget_high_s8(Q1)), Q0);
+        float *out = reinterpret_cast<float *>(&output[i]);
+        vst1q_f32(out+0, Q2.val[0]);
+        vst1q_f32(out+4, Q2.val[1]);
+        vst1q_f32(out+8, Q3.val[0]);
+        vst1q_f32(out+12, Q3.val[1]);
+    }
+
+    for (; i < nsamps; i++){
+        output[i] = item16_to_fc32(bswap? uhd::byteswap(input[i]) : input[i], float(scale_factor));
+    }
+}
+
+template <bool bswap> static UHD_INLINE void sc16_to_item16_neon(
+    const sc16_t *input, item16_t *output, size_t nsamps
+){
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        //otw_int = dsp_int >> 8
+        const int16_t *in = reinterpret_cast<const int16_t *>(&input[i]);
+        int8x16_t Q0 = vcombine_s8(vshrn_n_s16(vld1q_s16(in+0), 8), vshrn_n_s16(vld1q_s16(in+8), 8));
+        vst1q_s8(reinterpret_cast<int8_t *>(&output[i]), swap_items16<bswap>(Q0));
+    }
+
+    for (; i < nsamps; i++){
+        const item16_t item = sc16_to_item16(input[i], 0);
+        output[i] = bswap? uhd::byteswap(item) : item;
+    }
+}
+
+template <bool bswap> static UHD_INLINE void item16_to_sc16_neon(
+    const item16_t *input, sc16_t *output, size_t nsamps
+){
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        //dsp_int = otw_int << 8
+        int8x16_t Q0 = swap_items16<bswap>(vld1q_s8(reinterpret_cast<const int8_t *>(&input[i])));
+        int16_t *out = reinterpret_cast<int16_t *>(&output[i]);
+        vst1q_s16(out+0, vshll_n_s8(vget_low_s8(Q0), 8));
+        vst1q_s16(out+8, vshll_n_s8(vget_high_s8(Q0), 8));
+    }
+
+    for (; i < nsamps; i++){
+        output[i] = item16_to_sc16(bswap? uhd::byteswap(input[i]) : input[i], 0);
+    }
+}
+
+DECLARE_CONVERTER(convert_fc32_1_to_item16_1_nswap, PRIORITY_CUSTOM){
+    fc32_to_item16_neon<false>(
+        reinterpret_cast<const fc32_t *>(inputs[0]),
+        reinterpret_cast<item16_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_fc32_1_to_item16_1_bswap, PRIORITY_CUSTOM){
+    fc32_to_item16_neon<true>(
+        reinterpret_cast<const fc32_t *>(inputs[0]),
+        reinterpret_cast<item16_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_item16_1_to_fc32_1_nswap, PRIORITY_CUSTOM){
+    item16_to_fc32_neon<false>(
+        reinterpret_cast<const item16_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_item16_1_to_fc32_1_bswap, PRIORITY_CUSTOM){
+    item16_to_fc32_neon<true>(
+        reinterpret_cast<const item16_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(convert_sc16_1_to_item16_1_nswap, PRIORITY_CUSTOM){
+    sc16_to_item16_neon<false>(
+        reinterpret_cast<const sc16_t *>(inputs[0]),
+        reinterpret_cast<item16_t *>(outputs[0]), nsamps
+    );
+}
+
+DECLARE_CONVERTER(convert_sc16_1_to_item16_1_bswap, PRIORITY_CUSTOM){
+    sc16_to_item16_neon<true>(
+        reinterpret_cast<const sc16_t *>(inputs[0]),
+        reinterpret_cast<item16_t *>(outputs[0]), nsamps
+    );
+}
+
+DECLARE_CONVERTER(convert_item16_1_to_sc16_1_nswap, PRIORITY_CUSTOM){
+    item16_to_sc16_neon<false>(
+        reinterpret_cast<const item16_t *>(inputs[0]),
+        reinterpret_cast<sc16_t *>(outputs[0]), nsamps
+    );
+}
+
+DECLARE_CONVERTER(convert_item16_1_to_sc16_1_bswap, PRIORITY_CUSTOM){
+    item16_to_sc16_neon<true>(
+        reinterpret_cast<const item16_t *>(inputs[0]),
+        reinterpret_cast<sc16_t *>(outputs[0]), nsamps
+    );
+}
+
+/***********************************************************************
+ * Deinterleave for multiple streams per channel (ex: usrp1 2 and 4 ddcs):
+ * The structure loads split the interleaved items into one register
+ * per stream, ex: width 2 is ch0s0, ch1s0, ch0s1, ch1s1...
+ **********************************************************************/
+DECLARE_CONVERTER(convert_item32_1_to_sc16_2_nswap, PRIORITY_CUSTOM){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output0 = reinterpret_cast<sc16_t *>(outputs[0]);
+    sc16_t *output1 = reinterpret_cast<sc16_t *>(outputs[1]);
+
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        uint32x4x2_t Q0 = vld2q_u32(&input[2*i]);
+        vst1q_s16(reinterpret_cast<int16_t *>(&output0[i]), items_to_sc16(Q0.val[0]));
+        vst1q_s16(reinterpret_cast<int16_t *>(&output1[i]), items_to_sc16(Q0.val[1]));
+    }
+
+    for (; i < nsamps; i++){
+        output0[i] = item32_to_sc16(input[2*i+0], scale_factor);
+        output1[i] = item32_to_sc16(input[2*i+1], scale_factor);
+    }
+}
+
+DECLARE_CONVERTER(convert_item32_1_to_sc16_4_nswap, PRIORITY_CUSTOM){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output0 = reinterpret_cast<sc16_t *>(outputs[0]);
+    sc16_t *output1 = reinterpret_cast<sc16_t *>(outputs[1]);
+    sc16_t *output2 = reinterpret_cast<sc16_t *>(outputs[2]);
+    sc16_t *output3 = reinterpret_cast<sc16_t *>(outputs[3]);
+
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        uint32x4x4_t Q0 = vld4q_u32(&input[4*i]);
+        vst1q_s16(reinterpret_cast<int16_t *>(&output0[i]), items_to_sc16(Q0.val[0]));
+        vst1q_s16(reinterpret_cast<int16_t *>(&output1[i]), items_to_sc16(Q0.val[1]));
+        vst1q_s16(reinterpret_cast<int16_t *>(&output2[i]), items_to_sc16(Q0.val[2]));
+        vst1q_s16(reinterpret_cast<int16_t *>(&output3[i]), items_to_sc16(Q0.val[3]));
+    }
+
+    for (; i < nsamps; i++){
+        output0[i] = item32_to_sc16(input[4*i+0], scale_factor);
+        output1[i] = item32_to_sc16(input[4*i+1], scale_factor);
+        output2[i] = item32_to_sc16(input[4*i+2], scale_factor);
+        output3[i] = item32_to_sc16(input[4*i+3], scale_factor);
+    }
+}
+
+DECLARE_CONVERTER(convert_item32_1_to_fc32_2_nswap, PRIORITY_CUSTOM){
     const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
-    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+    fc32_t *output0 = reinterpret_cast<fc32_t *>(outputs[0]);
+    fc32_t *output1 = reinterpret_cast<fc32_t *>(outputs[1]);
 
-    size_t i;
+    float32x4_t Q1 = vdupq_n_f32(float(scale_factor));
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        uint32x4x2_t Q0 = vld2q_u32(&input[2*i]);
+        items_to_fc32(Q0.val[0], &output0[i], Q1);
+        items_to_fc32(Q0.val[1], &output1[i], Q1);
+    }
+
+    for (; i < nsamps; i++){
+        output0[i] = item32_to_fc32(input[2*i+0], float(scale_factor));
+        output1[i] = item32_to_fc32(input[2*i+1], float(scale_factor));
+    }
+}
+
+DECLARE_CONVERTER(convert_item32_1_to_fc32_4_nswap, PRIORITY_CUSTOM){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output0 = reinterpret_cast<fc32_t *>(outputs[0]);
+    fc32_t *output1 = reinterpret_cast<fc32_t *>(outputs[1]);
+    fc32_t *output2 = reinterpret_cast<fc32_t *>(outputs[2]);
+    fc32_t *output3 = reinterpret_cast<fc32_t *>(outputs[3]);
 
     float32x4_t Q1 = vdupq_n_f32(float(scale_factor));
-    for (i=0; i < (nsamps & ~0x03); i+=2) {
-        int16x4_t D0 = vld1_s16(reinterpret_cast<const int16_t *>(&input[i]));
-        int16x4_t D1 = vrev32_s16(D0);
-        int32x4_t Q2 = vmovl_s16(D1);
-        float32x4_t Q3 = vcvtq_f32_s32(Q2);
-        float32x4_t Q4 = vmulq_f32(Q3, Q1);
-        vst1q_f32((reinterpret_cast<float *>(&output[i])), Q4);
+    size_t i = 0;
+    for (; i+4 <= nsamps; i+=4){
+        uint32x4x4_t Q0 = vld4q_u32(&input[4*i]);
+        items_to_fc32(Q0.val[0], &output0[i], Q1);
+        items_to_fc32(Q0.val[1], &output1[i], Q1);
+        items_to_fc32(Q0.val[2], &output2[i], Q1);
+        items_to_fc32(Q0.val[3], &output3[i], Q1);
+    }
+
+    for (; i < nsamps; i++){
+        output0[i] = item32_to_fc32(input[4*i+0], float(scale_factor));
+        output1[i] = item32_to_fc32(input[4*i+1], float(scale_factor));
+        output2[i] = item32_to_fc32(input[4*i+2], float(scale_factor));
+        output3[i] = item32_to_fc32(input[4*i+3], float(scale_factor));
     }
+}
+
+/***********************************************************************
+ * Unpack packed sc12 items (3 bytes per sample):
+ * The structure load splits 8 items into their first, middle, and last
+ * bytes, each component is rebuilt with the 12 bits in the upper bits.
+ * The nswap items are little endian, the bswap items are big endian.
+ **********************************************************************/
+template <bool big_endian> static UHD_INLINE int16x8x2_t items24_to_sc16(const item24_t *input){
+    uint8x8x3_t D0 = vld3_u8(input);
+    uint16x8_t hi  = vmovl_u8(D0.val[big_endian? 0 : 2]);
+    uint16x8_t mid = vmovl_u8(D0.val[1]);
+    uint16x8_t lo  = vmovl_u8(D0.val[big_endian? 2 : 0]);
+    int16x8x2_t Q0;
+    Q0.val[0] = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(hi, 8), vandq_u16(mid, vdupq_n_u16(0xf0))));
+    Q0.val[1] = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(mid, 12), vshlq_n_u16(lo, 4)));
+    return Q0;
+}
+
+template <bool big_endian> static UHD_INLINE void item24_to_sc16_neon(
+    const item24_t *input, sc16_t *output, size_t nsamps
+){
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        vst2q_s16(reinterpret_cast<int16_t *>(&output[i]), items24_to_sc16<big_endian>(&input[3*i]));
+    }
+
+    for (; i < nsamps; i++){
+        output[i] = item24_to_sc16(big_endian?
+            item24_load_bswap(&input[3*i]) : item24_load_nswap(&input[3*i]), 0
+        );
+    }
+}
+
+template <bool big_endian> static UHD_INLINE void item24_to_fc32_neon(
+    const item24_t *input, fc32_t *output, size_t nsamps, double scale_factor
+){
+    //the 12-bit values are in the upper bits of an int16
+    float32x4_t Q1 = vdupq_n_f32(float(scale_factor)/(1 << 4));
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        int16x8x2_t Q0 = items24_to_sc16<big_endian>(&input[3*i]);
+        float32x4x2_t Q2, Q3;
+        Q2.val[0] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(Q0.val[0]))), Q1);
+        Q2.val[1] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(Q0.val[1]))), Q1);
+        Q3.val[0] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(Q0.val[0]))), Q1);
+        Q3.val[1] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(Q0.val[1]))), Q1);
+        vst2q_f32(reinterpret_cast<float *>(&output[i+0]), Q2);
+        vst2q_f32(reinterpret_cast<float *>(&output[i+4]), Q3);
+    }
+
+    for (; i < nsamps; i++){
+        output[i] = item24_to_fc32(big_endian?
+            item24_load_bswap(&input[3*i]) : item24_load_nswap(&input[3*i]), float(scale_factor)
+        );
+    }
+}
+
+DECLARE_CONVERTER(convert_item24_1_to_sc16_1_nswap, PRIORITY_CUSTOM){
+    item24_to_sc16_neon<false>(
+        reinterpret_cast<const item24_t *>(inputs[0]),
+        reinterpret_cast<sc16_t *>(outputs[0]), nsamps
+    );
+}
+
+DECLARE_CONVERTER(convert_item24_1_to_sc16_1_bswap, PRIORITY_CUSTOM){
+    item24_to_sc16_neon<true>(
+        reinterpret_cast<const item24_t *>(inputs[0]),
+        reinterpret_cast<sc16_t *>(outputs[0]), nsamps
+    );
+}
+
+DECLARE_CONVERTER(convert_item24_1_to_fc32_1_nswap, PRIORITY_CUSTOM){
+    item24_to_fc32_neon<false>(
+        reinterpret_cast<const item24_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
 
-    for (; i < nsamps; i++)
-        output[i] = item32_to_fc32(input[i], float(scale_factor));
+DECLARE_CONVERTER(convert_item24_1_to_fc32_1_bswap, PRIORITY_CUSTOM){
+    item24_to_fc32_neon<true>(
+        reinterpret_cast<const item24_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
 }
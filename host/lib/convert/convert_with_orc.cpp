@@ -16,39 +16,69 @@
 //
 
 #include "convert_common.hpp"
+#include "convert_orc.hpp"
+#include <uhd/utils/static.hpp>
+#include <uhd/utils/log.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <boost/bind.hpp>
+#include <orc/orc.h>
+#include <orc/orcparse.h>
+#include <cstring>
 
 using namespace uhd::convert;
 
-extern "C" {
-extern void _convert_fc32_1_to_item32_1_nswap_orc(void *, const void *, float, int);
-extern void _convert_fc32_1_to_item32_1_bswap_orc(void *, const void *, float, int);
-extern void _convert_item32_1_to_fc32_1_nswap_orc(void *, const void *, float, int);
-extern void _convert_item32_1_to_fc32_1_bswap_orc(void *, const void *, float, int);
-extern void _convert_sc16_1_to_item32_1_nswap_orc(void *, const void *, float, int);
-extern void _convert_item32_1_to_sc16_1_nswap_orc(void *, const void *, float, int);
+/***********************************************************************
+ * The orc programs (see gen_convert_orc.py) are parsed and compiled
+ * when libuhd loads: liborc generates code for the simd unit of the
+ * host cpu (sse, neon, altivec...), so one binary uses the best target
+ * on each machine, and no orc compiler is needed to build libuhd.
+ *
+ * A program that liborc cannot compile for the host is not registered,
+ * its emulation would be slower than the general converters.
+ **********************************************************************/
+static void orc_converter(
+    OrcProgram *program,
+    const input_type &inputs, const output_type &outputs,
+    size_t nsamps, double scale_factor
+){
+    //one executor per call, the compiled program is shared
+    OrcExecutor _ex, *ex = &_ex;
+    std::memset(ex, 0, sizeof(*ex));
+    orc_executor_set_program(ex, program);
+    orc_executor_set_n(ex, int(nsamps));
+    for (size_t i = 0; i < outputs.size(); i++){
+        orc_executor_set_array(ex, ORC_VAR_D1 + int(i), outputs[i]);
+    }
+    for (size_t i = 0; i < inputs.size(); i++){
+        orc_executor_set_array(ex, ORC_VAR_S1 + int(i), const_cast<void *>(inputs[i]));
+    }
+    orc_executor_set_param_float(ex, ORC_VAR_P1, float(scale_factor));
+    orc_executor_run(ex);
 }
 
-DECLARE_CONVERTER(convert_fc32_1_to_item32_1_nswap, PRIORITY_LIBORC){
-    _convert_fc32_1_to_item32_1_nswap_orc(outputs[0], inputs[0], scale_factor, nsamps);
-}
-
-DECLARE_CONVERTER(convert_fc32_1_to_item32_1_bswap, PRIORITY_LIBORC){
-    _convert_fc32_1_to_item32_1_bswap_orc(outputs[0], inputs[0], scale_factor, nsamps);
-}
+#ifndef BOOST_BIG_ENDIAN //the programs are written for little endian hosts
 
-DECLARE_CONVERTER(convert_item32_1_to_fc32_1_nswap, PRIORITY_LIBORC){
-    _convert_item32_1_to_fc32_1_nswap_orc(outputs[0], inputs[0], scale_factor, nsamps);
-}
+UHD_STATIC_BLOCK(register_convert_orc){
+    orc_init();
 
-DECLARE_CONVERTER(convert_item32_1_to_fc32_1_bswap, PRIORITY_LIBORC){
-    _convert_item32_1_to_fc32_1_bswap_orc(outputs[0], inputs[0], scale_factor, nsamps);
-}
+    //the programs live as long as the registered converters
+    OrcProgram **programs = NULL;
+    const int num_programs = orc_parse(convert_orc_source, &programs);
 
-DECLARE_CONVERTER(convert_sc16_1_to_item32_1_nswap, PRIORITY_LIBORC){
-    _convert_sc16_1_to_item32_1_nswap_orc(outputs[0], inputs[0], scale_factor, nsamps);
+    for (int i = 0; i < num_programs; i++){
+        OrcProgram *program = programs[i];
+        const OrcCompileResult result = orc_program_compile(program);
+        if (not ORC_COMPILE_RESULT_IS_SUCCESSFUL(result)){
+            UHD_LOG << "Orc cannot compile " << orc_program_get_name(program)
+                << " for this cpu (result " << int(result) << ")" << std::endl;
+            continue;
+        }
+        register_converter(
+            orc_program_get_name(program),
+            boost::bind(&orc_converter, program, _1, _2, _3, _4),
+            PRIORITY_LIBORC
+        );
+    }
 }
 
-DECLARE_CONVERTER(convert_item32_1_to_sc16_1_nswap, PRIORITY_LIBORC){
-    _convert_item32_1_to_sc16_1_nswap_orc(outputs[0], inputs[0], scale_factor, nsamps);
-}
+#endif /*BOOST_BIG_ENDIAN*/
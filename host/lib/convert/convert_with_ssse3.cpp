@@ -0,0 +1,183 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <tmmintrin.h>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * This file is compiled with SSSE3 enabled:
+ * The converters are not registered by static blocks here,
+ * because the host cpu may not support SSSE3 instructions.
+ * convert_dispatch.cpp calls convert_register_ssse3()
+ * once a runtime cpu check finds SSSE3 support.
+ *
+ * SSSE3 capable cpus are little endian:
+ * nswap items are little endian, bswap items are big endian.
+ **********************************************************************/
+
+/***********************************************************************
+ * Helpers: unpack 8 sc12 samples (24 bytes) into 16 int16 components,
+ * each one is the 12-bit value in the upper bits (otw_int << 4).
+ *
+ * The byte shuffle moves the 2 bytes holding each component into a
+ * 16-bit lane, then the I lanes are masked and the Q lanes shifted.
+ * The second load starts 8 bytes in, so samples 4-7 start at byte 4,
+ * and nothing is read past the 24 bytes of the 8 samples.
+ **********************************************************************/
+template <bool big_endian> static UHD_INLINE __m128i make_item24_shuffle(const int offset){
+    char shuf[16];
+    for (int k = 0; k < 4; k++){
+        const int b = offset + 3*k; //first byte of sample k
+        shuf[4*k+0] = char(b+1);                   //I low byte
+        shuf[4*k+1] = char(big_endian? b+0 : b+2); //I high byte
+        shuf[4*k+2] = char(big_endian? b+2 : b+0); //Q low byte
+        shuf[4*k+3] = char(b+1);                   //Q high byte
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(shuf));
+}
+
+static UHD_INLINE __m128i item24_shuffled_to_epi16(__m128i tmpi){
+    const __m128i maski = _mm_setr_epi16(
+        short(0xfff0), 0, short(0xfff0), 0, short(0xfff0), 0, short(0xfff0), 0
+    );
+    const __m128i real = _mm_and_si128(tmpi, maski);
+    const __m128i imag = _mm_andnot_si128(maski, _mm_slli_epi16(tmpi, 4));
+    return _mm_or_si128(real, imag);
+}
+
+static UHD_INLINE void item24_to_epi16(
+    const item24_t *input, const __m128i &shuflo, const __m128i &shufhi,
+    __m128i &tmpilo, __m128i &tmpihi
+){
+    const __m128i tmplo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+0));
+    const __m128i tmphi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+8));
+    tmpilo = item24_shuffled_to_epi16(_mm_shuffle_epi8(tmplo, shuflo));
+    tmpihi = item24_shuffled_to_epi16(_mm_shuffle_epi8(tmphi, shufhi));
+}
+
+static UHD_INLINE void epi16_to_fc32(__m128i tmpi, fc32_t *output, const __m128 &scalar){
+    //put the int16 values in the upper 16 bits of an int32
+    const __m128i zeroi = _mm_setzero_si128();
+    const __m128i tmpilo = _mm_unpacklo_epi16(zeroi, tmpi);
+    const __m128i tmpihi = _mm_unpackhi_epi16(zeroi, tmpi);
+    _mm_storeu_ps(reinterpret_cast<float *>(output+0), _mm_mul_ps(_mm_cvtepi32_ps(tmpilo), scalar));
+    _mm_storeu_ps(reinterpret_cast<float *>(output+2), _mm_mul_ps(_mm_cvtepi32_ps(tmpihi), scalar));
+}
+
+/***********************************************************************
+ * Convert item24 -> sc16
+ **********************************************************************/
+template <bool big_endian> static UHD_INLINE void unpack_item24_to_sc16(
+    const item24_t *input, sc16_t *output, size_t nsamps
+){
+    const __m128i shuflo = make_item24_shuffle<big_endian>(0);
+    const __m128i shufhi = make_item24_shuffle<big_endian>(4);
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpilo, tmpihi;
+        item24_to_epi16(input+i*3, shuflo, shufhi, tmpilo, tmpihi);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i+0), tmpilo);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i+4), tmpihi);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item24_to_sc16(big_endian?
+            item24_load_bswap(input+i*3) : item24_load_nswap(input+i*3), 0
+        );
+    }
+}
+
+static void convert_item24_1_to_sc16_1_nswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double
+){
+    unpack_item24_to_sc16<false>(
+        reinterpret_cast<const item24_t *>(inputs[0]),
+        reinterpret_cast<sc16_t *>(outputs[0]), nsamps
+    );
+}
+
+static void convert_item24_1_to_sc16_1_bswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double
+){
+    unpack_item24_to_sc16<true>(
+        reinterpret_cast<const item24_t *>(inputs[0]),
+        reinterpret_cast<sc16_t *>(outputs[0]), nsamps
+    );
+}
+
+/***********************************************************************
+ * Convert item24 -> fc32
+ **********************************************************************/
+template <bool big_endian> static UHD_INLINE void unpack_item24_to_fc32(
+    const item24_t *input, fc32_t *output, size_t nsamps, double scale_factor
+){
+    //the 12-bit values end up in the upper bits of an int32
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 20));
+
+    const __m128i shuflo = make_item24_shuffle<big_endian>(0);
+    const __m128i shufhi = make_item24_shuffle<big_endian>(4);
+
+    size_t i = 0;
+    for (; i+8 <= nsamps; i+=8){
+        __m128i tmpilo, tmpihi;
+        item24_to_epi16(input+i*3, shuflo, shufhi, tmpilo, tmpihi);
+        epi16_to_fc32(tmpilo, output+i+0, scalar);
+        epi16_to_fc32(tmpihi, output+i+4, scalar);
+    }
+
+    //convert remainder
+    for (; i < nsamps; i++){
+        output[i] = item24_to_fc32(big_endian?
+            item24_load_bswap(input+i*3) : item24_load_nswap(input+i*3), float(scale_factor)
+        );
+    }
+}
+
+static void convert_item24_1_to_fc32_1_nswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    unpack_item24_to_fc32<false>(
+        reinterpret_cast<const item24_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+static void convert_item24_1_to_fc32_1_bswap(
+    const input_type &inputs, const output_type &outputs, size_t nsamps, double scale_factor
+){
+    unpack_item24_to_fc32<true>(
+        reinterpret_cast<const item24_t *>(inputs[0]),
+        reinterpret_cast<fc32_t *>(outputs[0]), nsamps, scale_factor
+    );
+}
+
+/***********************************************************************
+ * Registration: called only on cpus with SSSE3 support
+ **********************************************************************/
+#define REGISTER_SSSE3_CONVERTER(fcn) \
+    register_converter(#fcn, fcn, PRIORITY_CUSTOM)
+
+void convert_register_ssse3(void){
+    REGISTER_SSSE3_CONVERTER(convert_item24_1_to_sc16_1_nswap);
+    REGISTER_SSSE3_CONVERTER(convert_item24_1_to_sc16_1_bswap);
+    REGISTER_SSSE3_CONVERTER(convert_item24_1_to_fc32_1_nswap);
+    REGISTER_SSSE3_CONVERTER(convert_item24_1_to_fc32_1_bswap);
+}
@@ -29,7 +29,7 @@ using namespace uhd::convert;
 """
 
 TMPL_CONV_TO_FROM_ITEM32_1 = """
-DECLARE_CONVERTER(convert_$(cpu_type)_1_to_item32_1_$(swap), PRIORITY_GENERAL){
+DECLARE_TABLE_CONVERTER(convert_$(cpu_type)_1_to_item32_1_$(swap)){
     const $(cpu_type)_t *input = reinterpret_cast<const $(cpu_type)_t *>(inputs[0]);
     item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
 
@@ -38,7 +38,7 @@ DECLARE_CONVERTER(convert_$(cpu_type)_1_to_item32_1_$(swap), PRIORITY_GENERAL){
     }
 }
 
-DECLARE_CONVERTER(convert_item32_1_to_$(cpu_type)_1_$(swap), PRIORITY_GENERAL){
+DECLARE_TABLE_CONVERTER(convert_item32_1_to_$(cpu_type)_1_$(swap)){
     const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
     $(cpu_type)_t *output = reinterpret_cast<$(cpu_type)_t *>(outputs[0]);
 
@@ -48,7 +48,7 @@ DECLARE_CONVERTER(convert_item32_1_to_$(cpu_type)_1_$(swap), PRIORITY_GENERAL){
 }
 """
 TMPL_CONV_TO_FROM_ITEM32_X = """
-DECLARE_CONVERTER(convert_$(cpu_type)_$(width)_to_item32_1_$(swap), PRIORITY_GENERAL){
+DECLARE_TABLE_CONVERTER(convert_$(cpu_type)_$(width)_to_item32_1_$(swap)){
     #for $w in range($width)
     const $(cpu_type)_t *input$(w) = reinterpret_cast<const $(cpu_type)_t *>(inputs[$(w)]);
     #end for
@@ -61,7 +61,7 @@ DECLARE_CONVERTER(convert_$(cpu_type)_$(width)_to_item32_1_$(swap), PRIORITY_GEN
     }
 }
 
-DECLARE_CONVERTER(convert_item32_1_to_$(cpu_type)_$(width)_$(swap), PRIORITY_GENERAL){
+DECLARE_TABLE_CONVERTER(convert_item32_1_to_$(cpu_type)_$(width)_$(swap)){
     const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
     #for $w in range($width)
     $(cpu_type)_t *output$(w) = reinterpret_cast<$(cpu_type)_t *>(outputs[$(w)]);
@@ -75,6 +75,91 @@ DECLARE_CONVERTER(convert_item32_1_to_$(cpu_type)_$(width)_$(swap), PRIORITY_GEN
 }
 """
 
+TMPL_CONV_SC16_TO_FROM_ITEM32_1_BSWAP = """
+//sc16 to and from swapped item32 is a pure byte permutation:
+//little endian hosts swap each 16-bit component, big endian hosts each 32-bit item
+static UHD_INLINE void sc16_item32_bswap(void *out, const void *in, size_t nsamps){
+\#ifdef BOOST_BIG_ENDIAN
+    uhd::byteswap_buffer(reinterpret_cast<boost::uint32_t *>(out), reinterpret_cast<const boost::uint32_t *>(in), nsamps);
+\#else
+    uhd::byteswap_buffer(reinterpret_cast<boost::uint16_t *>(out), reinterpret_cast<const boost::uint16_t *>(in), nsamps*2);
+\#endif
+}
+
+DECLARE_UNSCALED_TABLE_CONVERTER(convert_sc16_1_to_item32_1_bswap){
+    sc16_item32_bswap(outputs[0], inputs[0], nsamps);
+}
+
+DECLARE_UNSCALED_TABLE_CONVERTER(convert_item32_1_to_sc16_1_bswap){
+    sc16_item32_bswap(outputs[0], inputs[0], nsamps);
+}
+"""
+
+TMPL_CONV_TO_FROM_ITEM16_1 = """
+DECLARE_TABLE_CONVERTER(convert_$(cpu_type)_1_to_item16_1_$(swap)){
+    const $(cpu_type)_t *input = reinterpret_cast<const $(cpu_type)_t *>(inputs[0]);
+    item16_t *output = reinterpret_cast<item16_t *>(outputs[0]);
+
+    for (size_t i = 0; i < nsamps; i++){
+        output[i] = $(swap_fcn)($(cpu_type)_to_item16(input[i], float(scale_factor)));
+    }
+}
+
+DECLARE_TABLE_CONVERTER(convert_item16_1_to_$(cpu_type)_1_$(swap)){
+    const item16_t *input = reinterpret_cast<const item16_t *>(inputs[0]);
+    $(cpu_type)_t *output = reinterpret_cast<$(cpu_type)_t *>(outputs[0]);
+
+    for (size_t i = 0; i < nsamps; i++){
+        output[i] = item16_to_$(cpu_type)($(swap_fcn)(input[i]), float(scale_factor));
+    }
+}
+"""
+
+TMPL_CONV_TO_FROM_ITEM24_1 = """
+DECLARE_TABLE_CONVERTER(convert_$(cpu_type)_1_to_item24_1_$(swap)){
+    const $(cpu_type)_t *input = reinterpret_cast<const $(cpu_type)_t *>(inputs[0]);
+    item24_t *output = reinterpret_cast<item24_t *>(outputs[0]);
+
+    for (size_t i = 0; i < nsamps; i++){
+        item24_store_$(swap)(output + i*3, $(cpu_type)_to_item24(input[i], float(scale_factor)));
+    }
+}
+
+DECLARE_TABLE_CONVERTER(convert_item24_1_to_$(cpu_type)_1_$(swap)){
+    const item24_t *input = reinterpret_cast<const item24_t *>(inputs[0]);
+    $(cpu_type)_t *output = reinterpret_cast<$(cpu_type)_t *>(outputs[0]);
+
+    for (size_t i = 0; i < nsamps; i++){
+        output[i] = item24_to_$(cpu_type)(item24_load_$(swap)(input + i*3), float(scale_factor));
+    }
+}
+"""
+
+TMPL_TABLE = """
+/***********************************************************************
+ * The table of the converters above, parsed at build time,
+ * so that loading the library does not parse every markup
+ **********************************************************************/
+static const converter_table_entry_type general_converters[] = {
+    #for $markup, $dir, $pred in $entries
+    {"$markup", $dir, $pred, &$markup},
+    #end for
+};
+
+UHD_STATIC_BLOCK(register_general_converters){
+    register_converter_table(
+        general_converters, sizeof(general_converters)/sizeof(*general_converters),
+        PRIORITY_GENERAL
+    );
+}
+"""
+
+def make_table(output):
+    import re, gen_convert_pred
+    markups = re.findall(r'DECLARE_TABLE_CONVERTER\((\w+)\)', output)
+    entries = [(markup,) + gen_convert_pred.make_pred(markup) for markup in markups]
+    return parse_tmpl(TMPL_TABLE, entries=entries)
+
 def parse_tmpl(_tmpl_text, **kwargs):
     from Cheetah.Template import Template
     return str(Template(_tmpl_text, kwargs))
@@ -86,8 +171,24 @@ if __name__ == '__main__':
     for width in 1, 2, 3, 4:
         for swap, swap_fcn in (('nswap', ''), ('bswap', 'uhd::byteswap')):
             for cpu_type in 'fc64', 'fc32', 'sc16':
+                if width == 1 and swap == 'bswap' and cpu_type == 'sc16':
+                    output += parse_tmpl(TMPL_CONV_SC16_TO_FROM_ITEM32_1_BSWAP)
+                    continue
                 output += parse_tmpl(
                     TMPL_CONV_TO_FROM_ITEM32_1 if width == 1 else TMPL_CONV_TO_FROM_ITEM32_X,
                     width=width, swap=swap, swap_fcn=swap_fcn, cpu_type=cpu_type
                 )
+    for swap, swap_fcn in (('nswap', ''), ('bswap', 'uhd::byteswap')):
+        for cpu_type in 'fc64', 'fc32', 'sc16', 'sc8':
+            output += parse_tmpl(
+                TMPL_CONV_TO_FROM_ITEM16_1,
+                swap=swap, swap_fcn=swap_fcn, cpu_type=cpu_type
+            )
+    for swap in 'nswap', 'bswap':
+        for cpu_type in 'fc64', 'fc32', 'sc16':
+            output += parse_tmpl(
+                TMPL_CONV_TO_FROM_ITEM24_1,
+                swap=swap, cpu_type=cpu_type
+            )
+    output += make_table(output)
     open(sys.argv[1], 'w').write(output)
@@ -0,0 +1,206 @@
+#!/usr/bin/env python
+#
+# Copyright 2011 Ettus Research LLC
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+########################################################################
+# The orc programs are compiled by liborc when libuhd loads,
+# this file renders their source text into a string for convert_with_orc.cpp.
+# Each program name is the markup of the converter it implements.
+#
+# The programs assume a little endian host (like the simd converters):
+#  - an sc16 sample in memory is the 32-bit value (q << 16) | i
+#  - item32 nswap swaps the 16-bit halves, item32 bswap each 16-bit half
+#  - an sc8 byte pair in memory is the big endian (bswap) item16,
+#    item16 nswap swaps the bytes
+#
+# Orc variables are at most 8 bytes, which leaves out fc64 samples,
+# 3 byte item24, and more than 2 channels per item32 stream.
+########################################################################
+
+TMPL_HEADER = """
+#import time
+/***********************************************************************
+ * This file was generated by $file on $time.strftime("%c")
+ **********************************************************************/
+
+static const char *convert_orc_source =
+"""
+
+TMPL_CONV_TO_ITEM32 = """
+.function convert_$(cpu_type)_$(width)_to_item32_1_$(swap)
+#for $ch in range($width)
+.source $(cpu_size) src$(ch)
+#end for
+.dest $(4*width) dst
+.floatparam 4 scalar
+#for $ch in range($width)
+#if $cpu_type == 'fc32'
+.temp 8 scaled$(ch)
+.temp 8 converted$(ch)
+.temp 4 short$(ch)
+#end if
+#if $swap == 'nswap'
+.temp 4 swapped$(ch)
+#end if
+#if $width > 1
+.temp 4 item$(ch)
+#end if
+#end for
+#for $ch in range($width)
+#set $short = ('short%d' % $ch) if $cpu_type == 'fc32' else ('src%d' % $ch)
+#set $item = ('item%d' % $ch) if $width > 1 else 'dst'
+#if $cpu_type == 'fc32'
+x2 mulf scaled$(ch), src$(ch), scalar
+x2 convfl converted$(ch), scaled$(ch)
+x2 convlw $short, converted$(ch)
+#end if
+#if $swap == 'nswap'
+swapl swapped$(ch), $short
+x2 swapw $item, swapped$(ch)
+#else
+x2 swapw $item, $short
+#end if
+#end for
+#if $width > 1
+mergelq dst, item0, item1
+#end if
+"""
+
+TMPL_CONV_FROM_ITEM32 = """
+.function convert_item32_1_to_$(cpu_type)_$(width)_$(swap)
+.source $(4*width) src
+#for $ch in range($width)
+.dest $(cpu_size) dst$(ch)
+#end for
+.floatparam 4 scalar
+#for $ch in range($width)
+#if $width > 1
+.temp 4 item$(ch)
+#end if
+#if $swap == 'nswap'
+.temp 4 swapped$(ch)
+#end if
+#if $cpu_type == 'fc32'
+.temp 4 short$(ch)
+.temp 8 converted$(ch)
+#end if
+#end for
+#if $width > 1
+select0ql item0, src
+select1ql item1, src
+#end if
+#for $ch in range($width)
+#set $item = ('item%d' % $ch) if $width > 1 else 'src'
+#set $short = ('short%d' % $ch) if $cpu_type == 'fc32' else ('dst%d' % $ch)
+#if $swap == 'nswap'
+x2 swapw swapped$(ch), $item
+swapl $short, swapped$(ch)
+#else
+x2 swapw $short, $item
+#end if
+#if $cpu_type == 'fc32'
+x2 convswl converted$(ch), $short
+x2 convlf converted$(ch), converted$(ch)
+x2 mulf dst$(ch), converted$(ch), scalar
+#end if
+#end for
+"""
+
+TMPL_CONV_TO_ITEM16 = """
+.function convert_$(cpu_type)_1_to_item16_1_$(swap)
+.source $(cpu_size) src
+.dest 2 dst
+.floatparam 4 scalar
+#if $cpu_type == 'fc32'
+.temp 8 scaled
+.temp 8 converted
+.temp 4 short
+#end if
+#if $swap == 'nswap'
+.temp 2 bytes
+#end if
+#set $bytes = 'bytes' if $swap == 'nswap' else 'dst'
+#if $cpu_type == 'fc32'
+x2 mulf scaled, src, scalar
+x2 convfl converted, scaled
+x2 convlw short, converted
+x2 convwb $bytes, short
+#else
+x2 convhwb $bytes, src
+#end if
+#if $swap == 'nswap'
+swapw dst, bytes
+#end if
+"""
+
+TMPL_CONV_FROM_ITEM16 = """
+.function convert_item16_1_to_$(cpu_type)_1_$(swap)
+.source 2 src
+.dest $(cpu_size) dst
+.floatparam 4 scalar
+#if $swap == 'nswap'
+.temp 2 bytes
+#end if
+#if $cpu_type == 'fc32'
+.temp 4 short
+.temp 8 converted
+#else
+.const 1 zero 0
+#end if
+#set $bytes = 'bytes' if $swap == 'nswap' else 'src'
+#if $swap == 'nswap'
+swapw bytes, src
+#end if
+#if $cpu_type == 'fc32'
+x2 convsbw short, $bytes
+x2 convswl converted, short
+x2 convlf converted, converted
+x2 mulf dst, converted, scalar
+#else
+x2 mergebw dst, zero, $bytes
+#end if
+"""
+
+def parse_tmpl(_tmpl_text, **kwargs):
+    from Cheetah.Template import Template
+    return str(Template(_tmpl_text, kwargs))
+
+def quote_lines(text):
+    return ''.join('"%s\\n"\n'%line for line in text.splitlines() if line.strip())
+
+if __name__ == '__main__':
+    import sys, os
+    file = os.path.basename(__file__)
+    source = ''
+    cpu_sizes = {'fc32': 8, 'sc16': 4}
+    for width in 1, 2:
+        for swap in 'nswap', 'bswap':
+            for cpu_type in 'fc32', 'sc16':
+                for tmpl in TMPL_CONV_TO_ITEM32, TMPL_CONV_FROM_ITEM32:
+                    source += parse_tmpl(
+                        tmpl, width=width, swap=swap,
+                        cpu_type=cpu_type, cpu_size=cpu_sizes[cpu_type]
+                    )
+    for swap in 'nswap', 'bswap':
+        for cpu_type in 'fc32', 'sc16':
+            for tmpl in TMPL_CONV_TO_ITEM16, TMPL_CONV_FROM_ITEM16:
+                source += parse_tmpl(
+                    tmpl, swap=swap,
+                    cpu_type=cpu_type, cpu_size=cpu_sizes[cpu_type]
+                )
+    output = parse_tmpl(TMPL_HEADER, file=file) + quote_lines(source) + ';\n'
+    open(sys.argv[1], 'w').write(output)
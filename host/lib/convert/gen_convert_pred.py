@@ -77,7 +77,9 @@ pred_type make_pred(const std::string &markup, dir_type &dir){
         else if (cpu_type == "sc8")  pred |= $ph.sc8_p;
         else throw pred_error("unhandled io type " + cpu_type);
 
-        if (otw_type == "item32") pred |= $ph.item32_p;
+        if      (otw_type == "item32") pred |= $ph.item32_p;
+        else if (otw_type == "item16") pred |= $ph.item16_p;
+        else if (otw_type == "item24") pred |= $ph.item24_p;
         else throw pred_error("unhandled otw type " + otw_type);
 
         int num_inputs = boost::lexical_cast<int>(num_inps);
@@ -125,6 +127,7 @@ static pred_vector_type get_pred_io_type_table(void){
     table[pred_table_index(io_type_t::COMPLEX_FLOAT64)]    = $ph.fc64_p;
     table[pred_table_index(io_type_t::COMPLEX_FLOAT32)]    = $ph.fc32_p;
     table[pred_table_index(io_type_t::COMPLEX_INT16)]      = $ph.sc16_p;
+    table[pred_table_index(io_type_t::COMPLEX_INT8)]       = $ph.sc8_p;
     return table;
 }
 
@@ -143,7 +146,14 @@ UHD_INLINE pred_type make_pred(
     size_t num_inputs,
     size_t num_outputs
 ){
-    pred_type pred = $ph.item32_p; //only item32 supported as of now
+    //sc16 samples are sent as item32, packed sc12 as item24, packed sc8 as item16
+    pred_type pred = 0;
+    switch(otw_type.width){
+    case 16: pred |= $ph.item32_p; break;
+    case 12: pred |= $ph.item24_p; break;
+    case 8:  pred |= $ph.item16_p; break;
+    default: throw pred_error("unhandled otw width for make_pred()");
+    }
 
     static const pred_vector_type pred_byte_order_table(get_pred_byte_order_table());
     pred |= pred_byte_order_table[pred_table_index(otw_type.byteorder)];
@@ -169,7 +179,9 @@ def parse_tmpl(_tmpl_text, **kwargs):
 class ph:
     bswap_p  = 0b00001
     nswap_p  = 0b00000
-    item32_p = 0b00000
+    item32_p = 0b000000
+    item16_p = 0b100000
+    item24_p = 0b1000000
     sc8_p    = 0b00000
     sc16_p   = 0b00010
     fc32_p   = 0b00100
@@ -179,6 +191,21 @@ class ph:
     chan3_p  = 0b10000
     chan4_p  = 0b11000
 
+def make_pred(markup):
+    """
+    Get the direction and predicate of a converter markup,
+    the build time twin of make_pred() in the template above.
+    The direction is the value of dir_type: 0 for otw to cpu, 1 for cpu to otw.
+    """
+    tokens = markup.split('_')
+    inp_type, num_inps, out_type, num_outs, swap_type = tokens[1], tokens[2], tokens[4], tokens[5], tokens[6]
+    if 'item' not in inp_type: cpu_type, otw_type, dir = inp_type, out_type, 1
+    else: cpu_type, otw_type, dir = out_type, inp_type, 0
+    pred = getattr(ph, cpu_type + '_p') | getattr(ph, otw_type + '_p')
+    pred |= getattr(ph, 'chan%d_p'%(int(num_inps)*int(num_outs)))
+    pred |= getattr(ph, swap_type + '_p')
+    return dir, pred
+
 if __name__ == '__main__':
     import sys, os
     file = os.path.basename(__file__)
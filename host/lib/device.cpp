@@ -15,8 +15,13 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "usrp/common/open_timer.hpp"
 #include <uhd/device.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/transport/transport_profile.hpp>
 #include <uhd/types/dict.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/usrp/subdev_spec.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/msg.hpp>
@@ -28,10 +33,15 @@
 #include <boost/functional/hash.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <set>
 
 using namespace uhd;
 
 static boost::mutex _device_mutex;
+static boost::condition_variable _device_made_cond; //signaled when a make is done
+
+void load_modules(void); //defined in load_modules.cpp
 
 /***********************************************************************
  * Helper Functions
@@ -74,6 +84,7 @@ void device::register_device(
  * Discover
  **********************************************************************/
 device_addrs_t device::find(const device_addr_t &hint){
+    load_modules(); //the modules may register devices
     boost::mutex::scoped_lock lock(_device_mutex);
 
     device_addrs_t device_addrs;
@@ -99,10 +110,12 @@ device_addrs_t device::find(const device_addr_t &hint){
  * Make
  **********************************************************************/
 device::sptr device::make(const device_addr_t &hint, size_t which){
+    load_modules(); //the modules may register devices
     boost::mutex::scoped_lock lock(_device_mutex);
 
     typedef boost::tuple<device_addr_t, make_t> dev_addr_make_t;
     std::vector<dev_addr_make_t> dev_addr_makers;
+    const time_spec_t find_start_time = time_spec_t::get_system_time();
 
     BOOST_FOREACH(const dev_fcn_reg_t &fcn, get_dev_fcn_regs()){
         BOOST_FOREACH(device_addr_t dev_addr, fcn.get<0>()(hint)){
@@ -137,19 +150,232 @@ device::sptr device::make(const device_addr_t &hint, size_t which){
         if (not dev_addr.has_key(key)) dev_addr[key] = hint[key];
     }
 
+    //fill in the hints of a named profile, then of a saved transport profile
+    //the hints given by the caller take precedence
+    if (dev_addr.has_key("profile")){
+        const device_addr_t profile = transport::get_named_transport_profile(dev_addr["profile"], dev_addr.get("type", ""));
+        device_addr_t applied;
+        BOOST_FOREACH(const std::string &key, profile.keys()){
+            if (dev_addr.has_key(key)){
+                UHD_LOG << boost::format("profile %s: %s=%s overridden by %s") % dev_addr["profile"] % key % profile[key] % dev_addr[key] << std::endl;
+                continue;
+            }
+            dev_addr[key] = applied[key] = profile[key];
+        }
+        UHD_MSG(status) << boost::format("Using the %s profile: %s") % dev_addr["profile"] % applied.to_string() << std::endl;
+    }
+    if (dev_addr.get("transport_profile", "1") != "0"){
+        const device_addr_t profile = transport::load_transport_profile(dev_addr);
+        if (profile.size() != 0) UHD_MSG(status) << boost::format(
+            "Using the transport profile %s"
+        ) % transport::get_transport_profile_path(dev_addr) << std::endl;
+        BOOST_FOREACH(const std::string &key, profile.keys()){
+            if (not dev_addr.has_key(key)) dev_addr[key] = profile[key];
+        }
+    }
+
+    //force a converter implementation before the device looks them up
+    if (dev_addr.has_key("convert_prio")){
+        try{
+            convert::set_forced_priority(dev_addr["convert_prio"]);
+        }
+        catch(const uhd::value_error &e){
+            UHD_MSG(warning) << "Ignoring the device address key convert_prio: " << e.what() << std::endl;
+        }
+    }
+
     //map device address hash to created devices
     static uhd::dict<size_t, boost::weak_ptr<device> > hash_to_device;
 
+    //the hashes of the devices being made by other threads without the lock
+    static std::set<size_t> hashes_in_make;
+
+    //a make of the same device in another thread: wait for it and share its result
+    while (hashes_in_make.count(dev_hash) != 0) _device_made_cond.wait(lock);
+
     //try to find an existing device
-    try{
-        UHD_ASSERT_THROW(hash_to_device.has_key(dev_hash));
-        UHD_ASSERT_THROW(not hash_to_device[dev_hash].expired());
+    if (hash_to_device.has_key(dev_hash) and not hash_to_device[dev_hash].expired()){
         return hash_to_device[dev_hash].lock();
     }
-    //create and register a new device
-    catch(const uhd::assertion_error &){
-        device::sptr dev = maker(dev_addr);
-        hash_to_device[dev_hash] = dev;
-        return dev;
+
+    //create and register a new device:
+    //the lock is released while the driver makes it,
+    //so that different devices are made concurrently
+    hashes_in_make.insert(dev_hash);
+    lock.unlock();
+    const time_spec_t make_start_time = time_spec_t::get_system_time();
+    device::sptr dev;
+    try{
+        dev = maker(dev_addr);
+    }
+    catch(...){
+        lock.lock();
+        hashes_in_make.erase(dev_hash);
+        _device_made_cond.notify_all();
+        throw;
+    }
+    const time_spec_t make_done_time = time_spec_t::get_system_time();
+    lock.lock();
+    hash_to_device[dev_hash] = dev;
+    hashes_in_make.erase(dev_hash);
+    _device_made_cond.notify_all();
+
+    //the device tree did not exist during the discovery, record it now
+    property_tree::sptr tree = dev->get_tree();
+    usrp::record_open_time(tree, "/", "find", (make_start_time - find_start_time).get_real_secs());
+    usrp::record_open_time(tree, "/", "make", (make_done_time - make_start_time).get_real_secs());
+    return dev;
+}
+
+/***********************************************************************
+ * Default implementations
+ **********************************************************************/
+size_t device::recv_full_buff(
+    const recv_buffs_type &buffs,
+    size_t nsamps_per_buff,
+    recv_metadata_array_type &metadata_array,
+    const io_type_t &io_type,
+    double timeout
+){
+    metadata_array.clear();
+    std::vector<void *> offset_buffs(buffs.size());
+
+    //one packet at a time, so that each keeps its own metadata
+    size_t accum_num_samps = 0;
+    while(accum_num_samps < nsamps_per_buff){
+        for (size_t i = 0; i < buffs.size(); i++){
+            offset_buffs[i] = reinterpret_cast<char *>(buffs[i]) + accum_num_samps*io_type.size;
+        }
+        metadata_array.push_back(recv_packet_metadata_t());
+        recv_packet_metadata_t &entry = metadata_array.back();
+        entry.offset = accum_num_samps;
+        accum_num_samps += this->recv(
+            offset_buffs, nsamps_per_buff - accum_num_samps,
+            entry.metadata, io_type, RECV_MODE_ONE_PACKET, timeout
+        );
+        if (entry.metadata.error_code == rx_metadata_t::ERROR_CODE_NONE) continue;
+        if (entry.metadata.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW) continue;
+        break;
+    }
+    return accum_num_samps;
+}
+
+size_t device::recv_view(recv_view_t &, double){
+    throw uhd::not_implemented_error("this device does not support recv_view");
+}
+
+size_t device::get_send_view(send_view_t &, double){
+    throw uhd::not_implemented_error("this device does not support get_send_view");
+}
+
+size_t device::commit_send_view(send_view_t &, size_t, double){
+    throw uhd::not_implemented_error("this device does not support commit_send_view");
+}
+
+transport::poll_fds_t device::get_recv_poll_fds(void){
+    throw uhd::not_implemented_error("this device does not support get_recv_poll_fds");
+}
+
+transport::poll_fds_t device::get_async_msg_poll_fds(void){
+    throw uhd::not_implemented_error("this device does not support get_async_msg_poll_fds");
+}
+
+/***********************************************************************
+ * Default streams: the device's recv and send with the arguments bound
+ **********************************************************************/
+//! Check the arguments of a default stream, return the number of channels
+static size_t check_default_stream_args(
+    property_tree::sptr tree, const stream_args_t &args, const std::string &dir
+){
+    if (not args.otw_format.empty()) throw uhd::value_error(str(boost::format(
+        "this device sets the %s otw format with the %s_otw_format device address key"
+    ) % dir % ((dir == "rx")? "recv" : "send")));
+
+    //the device streams every channel of its subdevice specifications
+    size_t num_chans = 0;
+    BOOST_FOREACH(const std::string &mb, tree->list("/mboards")){
+        num_chans += tree->access<usrp::subdev_spec_t>("/mboards/" + mb + "/" + dir + "_subdev_spec").get().size();
+    }
+    for (size_t i = 0; i < args.channels.size(); i++){
+        if (args.channels.size() == num_chans and args.channels[i] == i) continue;
+        throw uhd::not_implemented_error(str(boost::format(
+            "this device streams all of its %u %s channels together, in order"
+        ) % num_chans % dir));
+    }
+    return num_chans;
+}
+
+class default_rx_streamer : public rx_streamer{
+public:
+    default_rx_streamer(device &dev, const stream_args_t &args):
+        _dev(dev), _io_type(args.cpu_type),
+        _num_chans(check_default_stream_args(dev.get_tree(), args, "rx"))
+    {
+        /* NOP */
+    }
+
+    size_t get_num_channels(void) const{
+        return _num_chans;
     }
+
+    size_t get_max_num_samps(void) const{
+        return _dev.get_max_recv_samps_per_packet();
+    }
+
+    size_t recv(
+        const buffs_type &buffs, const size_t nsamps_per_buff,
+        rx_metadata_t &metadata, double timeout, bool one_packet
+    ){
+        return _dev.recv(
+            buffs, nsamps_per_buff, metadata, _io_type,
+            (one_packet)? device::RECV_MODE_ONE_PACKET : device::RECV_MODE_FULL_BUFF,
+            timeout
+        );
+    }
+
+private:
+    device &_dev;
+    const io_type_t _io_type;
+    const size_t _num_chans;
+};
+
+class default_tx_streamer : public tx_streamer{
+public:
+    default_tx_streamer(device &dev, const stream_args_t &args):
+        _dev(dev), _io_type(args.cpu_type),
+        _num_chans(check_default_stream_args(dev.get_tree(), args, "tx"))
+    {
+        /* NOP */
+    }
+
+    size_t get_num_channels(void) const{
+        return _num_chans;
+    }
+
+    size_t get_max_num_samps(void) const{
+        return _dev.get_max_send_samps_per_packet();
+    }
+
+    size_t send(
+        const buffs_type &buffs, const size_t nsamps_per_buff,
+        const tx_metadata_t &metadata, double timeout
+    ){
+        return _dev.send(
+            buffs, nsamps_per_buff, metadata, _io_type,
+            device::SEND_MODE_FULL_BUFF, timeout
+        );
+    }
+
+private:
+    device &_dev;
+    const io_type_t _io_type;
+    const size_t _num_chans;
+};
+
+rx_streamer::sptr device::get_rx_stream(const stream_args_t &args){
+    return rx_streamer::sptr(new default_rx_streamer(*this, args));
+}
+
+tx_streamer::sptr device::get_tx_stream(const stream_args_t &args){
+    return tx_streamer::sptr(new default_tx_streamer(*this, args));
 }
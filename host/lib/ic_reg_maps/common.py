@@ -59,6 +59,28 @@ public:
         delete _state;
     }
 
+    $(name)_t(const $(name)_t &other){
+        _state = NULL;
+        *this = other;
+    }
+
+    $(name)_t &operator=(const $(name)_t &other){
+        if (this == &other) return *this;
+        #for $reg in $regs
+        $reg.get_name() = other.$reg.get_name();
+        #end for
+        //deep copy the saved state so copies diff independently
+        if (other._state == NULL){
+            delete _state;
+            _state = NULL;
+        }
+        else{
+            if (_state == NULL) _state = new $(name)_t();
+            *_state = *other._state;
+        }
+        return *this;
+    }
+
     $body
 
     void save_state(void){
@@ -68,6 +90,10 @@ public:
         #end for
     }
 
+    bool has_saved_state(void) const{
+        return _state != NULL;
+    }
+
     template<typename T> std::set<T> get_changed_addrs(void){
         if (_state == NULL) throw uhd::runtime_error("no saved state");
         //check each register for changes
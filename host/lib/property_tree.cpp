@@ -18,7 +18,8 @@
 #include <uhd/property_tree.hpp>
 #include <uhd/types/dict.hpp>
 #include <boost/foreach.hpp>
-#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
 #include <boost/make_shared.hpp>
 #include <iostream>
 
@@ -79,7 +80,7 @@ public:
 
     sptr subtree(const fs_path &path_) const{
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
 
         property_tree_impl *subtree = new property_tree_impl(path);
         subtree->_guts = this->_guts; //copy the guts sptr
@@ -88,7 +89,7 @@ public:
 
     void remove(const fs_path &path_){
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::unique_lock<boost::shared_mutex> lock(_guts->mutex);
 
         node_type *parent = NULL;
         node_type *node = &_guts->root;
@@ -103,9 +104,9 @@ public:
 
     bool exists(const fs_path &path_) const{
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
 
-        node_type *node = &_guts->root;
+        const node_type *node = &_guts->root;
         BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
             if (not node->has_key(name)) return false;
             node = &(*node)[name];
@@ -115,9 +116,9 @@ public:
 
     std::vector<std::string> list(const fs_path &path_) const{
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
 
-        node_type *node = &_guts->root;
+        const node_type *node = &_guts->root;
         BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
             if (not node->has_key(name)) throw_path_not_found(path);
             node = &(*node)[name];
@@ -126,9 +127,15 @@ public:
         return node->keys();
     }
 
-    void _create(const fs_path &path_, const boost::shared_ptr<void> &prop){
+    const std::type_info &type_of(const fs_path &path_) const{
+        const fs_path path = _root / path_;
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
+        return *this->get_prop_node(path).type;
+    }
+
+    void _create(const fs_path &path_, const boost::shared_ptr<void> &prop, const std::type_info &type){
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::unique_lock<boost::shared_mutex> lock(_guts->mutex);
 
         node_type *node = &_guts->root;
         BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
@@ -137,35 +144,45 @@ public:
         }
         if (node->prop.get() != NULL) throw uhd::runtime_error("Cannot create! Property already exists at: " + path);
         node->prop = prop;
+        node->type = &type;
     }
 
-    boost::shared_ptr<void> &_access(const fs_path &path_) const{
+    boost::shared_ptr<void> _access(const fs_path &path_) const{
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
+        return this->get_prop_node(path).prop;
+    }
 
-        node_type *node = &_guts->root;
+private:
+    struct node_type;
+
+    //! Walk to the node of a property, call with the lock held
+    const node_type &get_prop_node(const fs_path &path) const{
+        const node_type *node = &_guts->root;
         BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
             if (not node->has_key(name)) throw_path_not_found(path);
             node = &(*node)[name];
         }
         if (node->prop.get() == NULL) throw uhd::runtime_error("Cannot access! Property uninitialized at: " + path);
-        return node->prop;
+        return *node;
     }
 
-private:
     void throw_path_not_found(const fs_path &path) const{
         throw uhd::lookup_error("Path not found in tree: " + path);
     }
 
     //basic structural node element
     struct node_type : uhd::dict<std::string, node_type>{
+        node_type(void): type(NULL){}
         boost::shared_ptr<void> prop;
+        const std::type_info *type; //the type of the property
     };
 
-    //tree guts which may be referenced in a subtree
+    //tree guts which may be referenced in a subtree:
+    //lookups share the lock, only create and remove take it exclusively
     struct tree_guts_type{
         node_type root;
-        boost::mutex mutex;
+        boost::shared_mutex mutex;
     };
 
     //members, the tree and root prefix
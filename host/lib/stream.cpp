@@ -0,0 +1,41 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/stream.hpp>
+#include <uhd/exception.hpp>
+
+using namespace uhd;
+
+stream_args_t::stream_args_t(
+    const io_type_t::tid_t cpu_type_, const std::string &otw_format_
+):
+    cpu_type(cpu_type_), otw_format(otw_format_), spp(0)
+{
+    /* NOP */
+}
+
+rx_streamer::~rx_streamer(void){
+    /* NOP */
+}
+
+void rx_streamer::set_recv_hook(const recv_hook_type &){
+    throw uhd::not_implemented_error("this receive stream has no hooks");
+}
+
+tx_streamer::~tx_streamer(void){
+    /* NOP */
+}
@@ -0,0 +1,239 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_ASYNC_MSG_RING_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_ASYNC_MSG_RING_HPP
+
+#include "pollable_event.hpp"
+#include <uhd/config.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/utility.hpp>
+#include <boost/bind.hpp>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * A ring of async messages that overwrites the oldest message when full.
+ *
+ * The push never takes a lock: the producer claims a ticket with an
+ * atomic increment and writes the slot of that ticket under a sequence
+ * number, odd while the slot is being written. The pop reads a slot and
+ * checks that its sequence number did not change during the copy,
+ * and it skips over the tickets that were overwritten before it got there.
+ * Only a pop that has to wait takes a lock, and the push only touches that
+ * lock when a pop is waiting.
+ *
+ * The event codes are counted by the push, before a message can be lost,
+ * so the counts are exact even when nobody pops the messages.
+ */
+class async_msg_ring : boost::noncopyable{
+public:
+
+    //! The counters, one per event code bit and one for the lost messages
+    enum counter_t{
+        COUNTER_BURST_ACK = 0,
+        COUNTER_UNDERFLOW,
+        COUNTER_SEQ_ERROR,
+        COUNTER_TIME_ERROR,
+        COUNTER_UNDERFLOW_IN_PACKET,
+        COUNTER_SEQ_ERROR_IN_BURST,
+        COUNTER_DROPPED, //overwritten before a pop
+        NUM_COUNTERS
+    };
+
+    /*!
+     * Make a new async message ring.
+     * \param depth the number of messages, rounded up to a power of two
+     */
+    async_msg_ring(const size_t depth){
+        _depth = 1;
+        while (_depth < depth) _depth *= 2;
+        _slots.reset(new slot_t[_depth]);
+    }
+
+    //! Push a new message, overwriting the oldest when full
+    UHD_INLINE void push_with_pop_on_full(const async_metadata_t &metadata){
+        for (size_t i = 0; i < COUNTER_DROPPED; i++){
+            if (metadata.event_code & (1 << i)) _counts[i].inc();
+        }
+
+        //claim a ticket, then wait out a producer still writing an older ticket to the slot
+        const boost::uint32_t ticket = _write_count.inc();
+        slot_t &slot = _slots[ticket & (_depth - 1)];
+        boost::uint32_t seq;
+        do{
+            seq = slot.seq.read();
+            //a newer ticket got the slot first, the pop counts this one as dropped
+            if (boost::int32_t(seq - (ticket*2 + 1)) > 0) return;
+        } while ((seq & 1) != 0 or slot.seq.cas(ticket*2 + 1, seq) != seq);
+
+        slot.metadata = metadata;
+        uhd::atomic_full_barrier(); //the message is written before it is published
+        slot.seq.write(ticket*2 + 2);
+        uhd::atomic_full_barrier(); //published before the waiters check
+        _event.notify();
+
+        if (_waiters.read() != 0){
+            boost::mutex::scoped_lock lock(_mutex);
+            _cond.notify_all();
+        }
+    }
+
+    //! Pop the oldest message, waiting up to the timeout for one
+    UHD_INLINE bool pop_with_timed_wait(async_metadata_t &metadata, const double timeout){
+        if (this->pop_with_haste(metadata)) return true;
+
+        //the pollable event follows the clear protocol of pollable_event
+        _event.clear();
+        if (this->pop_with_haste(metadata)){
+            _event.notify();
+            return true;
+        }
+        if (timeout <= 0.0) return false;
+
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::microseconds(long(timeout*1e6));
+        boost::mutex::scoped_lock lock(_mutex);
+        _waiters.inc(); //full barrier, before the pop that rechecks
+        bool ret = false;
+        while (not (ret = this->pop_with_haste(metadata))){
+            if (not _cond.timed_wait(lock, exit_time)){
+                ret = this->pop_with_haste(metadata);
+                break;
+            }
+        }
+        _waiters.dec();
+        if (ret) _event.notify(); //more messages may follow this one
+        return ret;
+    }
+
+    //! Get the number of messages the ring holds
+    size_t get_depth(void) const{
+        return _depth;
+    }
+
+    //! Get the bytes of memory used per message
+    static size_t get_bytes_per_msg(void){
+        return sizeof(slot_t);
+    }
+
+    //! Get the descriptors that signal a message may be ready
+    poll_fds_t get_poll_fds(void) const{
+        return _event.get_poll_fds();
+    }
+
+    //! Get the count of a counter since construction (wraps at 32 bits)
+    size_t get_count(const counter_t counter){
+        if (counter != COUNTER_DROPPED) return _counts[counter].read();
+
+        //add the messages that were lapped but not skipped by a pop yet
+        const boost::uint32_t dropped = _counts[counter].read();
+        const boost::uint32_t ticket = _read_count.read();
+        const boost::uint32_t written = _write_count.read();
+        const boost::uint32_t lapped = (written - ticket > _depth)? written - ticket - boost::uint32_t(_depth) : 0;
+        return dropped + lapped;
+    }
+
+    //! Get the property name of a counter
+    static const char *get_name(const counter_t counter){
+        switch(counter){
+        case COUNTER_BURST_ACK: return "burst_acks";
+        case COUNTER_UNDERFLOW: return "underflows";
+        case COUNTER_SEQ_ERROR: return "seq_errors";
+        case COUNTER_TIME_ERROR: return "time_errors";
+        case COUNTER_UNDERFLOW_IN_PACKET: return "underflows_in_packet";
+        case COUNTER_SEQ_ERROR_IN_BURST: return "seq_errors_in_burst";
+        case COUNTER_DROPPED: return "dropped";
+        default: return "unknown";
+        }
+    }
+
+    /*!
+     * Publish the counts as read-only properties under path/async_msgs.
+     * \param tree the property tree
+     * \param path the mboard path, such as /mboards/0
+     * \param ring the ring to read
+     */
+    static void publish(property_tree::sptr tree, const fs_path &path, async_msg_ring &ring){
+        for (size_t i = 0; i < NUM_COUNTERS; i++){
+            tree->create<size_t>(path / "async_msgs" / get_name(counter_t(i)))
+                .publish(boost::bind(&async_msg_ring::get_count, &ring, counter_t(i)));
+        }
+    }
+
+private:
+    struct slot_t{
+        uhd::atomic_uint32_t seq; //ticket*2 + 2 once written, odd while writing
+        async_metadata_t metadata;
+    };
+
+    //! Pop without waiting, false when there is no complete message to pop
+    bool pop_with_haste(async_metadata_t &metadata){
+        while (true){
+            const boost::uint32_t ticket = _read_count.read();
+            const boost::uint32_t written = _write_count.read();
+            if (ticket == written) return false;
+
+            //the producers lapped the reader: skip to the oldest ticket still in the ring
+            if (written - ticket > _depth){
+                const boost::uint32_t oldest = written - boost::uint32_t(_depth);
+                if (_read_count.cas(oldest, ticket) == ticket){
+                    this->add_count(COUNTER_DROPPED, oldest - ticket);
+                }
+                continue;
+            }
+
+            //the ticket is claimed but not written yet, its push will notify
+            slot_t &slot = _slots[ticket & (_depth - 1)];
+            const boost::uint32_t seq = slot.seq.read();
+            if (seq != ticket*2 + 2){
+                if (boost::int32_t(seq - (ticket*2 + 2)) > 0) continue; //overwritten, recheck the counts
+                return false;
+            }
+
+            //copy out, then the cas is a full barrier read of the sequence number
+            uhd::atomic_full_barrier(); //the message is read after its sequence number
+            metadata = slot.metadata;
+            if (slot.seq.cas(seq, seq) != seq) continue; //overwritten during the copy
+            if (_read_count.cas(ticket + 1, ticket) == ticket) return true;
+        }
+    }
+
+    void add_count(const counter_t counter, const boost::uint32_t num){
+        boost::uint32_t count;
+        do count = _counts[counter].read();
+        while (_counts[counter].cas(count + num, count) != count);
+    }
+
+    size_t _depth;
+    boost::scoped_array<slot_t> _slots;
+    uhd::atomic_uint32_t _write_count, _read_count, _waiters;
+    uhd::atomic_uint32_t _counts[NUM_COUNTERS];
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    pollable_event _event;
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_ASYNC_MSG_RING_HPP */
@@ -16,16 +16,150 @@
 //
 
 #include <uhd/transport/buffer_pool.hpp>
-#include <boost/shared_array.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/msg.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/checked_delete.hpp>
+#include <map>
 #include <vector>
+#include <cstring>
+
+#ifdef UHD_PLATFORM_LINUX
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#endif /*UHD_PLATFORM_LINUX*/
 
 using namespace uhd::transport;
 
+//The size of a hugepage on the common linux platforms
+static const size_t HUGEPAGE_SIZE = 2*1024*1024;
+
 //! pad the byte count to a multiple of alignment
 static size_t pad_to_boundary(const size_t bytes, const size_t alignment){
     return bytes + (alignment - bytes)%alignment;
 }
 
+/***********************************************************************
+ * Memory provider registry
+ **********************************************************************/
+typedef std::map<std::string, buffer_pool::mem_provider_type> mem_provider_registry_type;
+
+static mem_provider_registry_type &get_mem_provider_registry(void){
+    static mem_provider_registry_type registry;
+    return registry;
+}
+
+void buffer_pool::register_mem_provider(const std::string &name, const mem_provider_type &provider){
+    get_mem_provider_registry()[name] = provider;
+}
+
+/***********************************************************************
+ * Allocation policy
+ **********************************************************************/
+buffer_pool::alloc_policy_t::alloc_policy_t(void):
+    hugepages(false), numa_node(-1), lock(false)
+{
+    /* NOP */
+}
+
+buffer_pool::alloc_policy_t buffer_pool::alloc_policy_t::from_hints(
+    const device_addr_t &hints, const std::string &prefix
+){
+    alloc_policy_t policy;
+    policy.hugepages = hints.cast<double>(prefix + "_hugepages", 0) != 0;
+    policy.numa_node = int(hints.cast<double>(prefix + "_numa_node", -1));
+    policy.lock = hints.cast<double>(prefix + "_mlock", 0) != 0;
+
+    const std::string provider_key = prefix + "_mem_provider";
+    if (hints.has_key(provider_key)){
+        const std::string &name = hints[provider_key];
+        mem_provider_registry_type::const_iterator it = get_mem_provider_registry().find(name);
+        if (it == get_mem_provider_registry().end()) throw uhd::key_error(
+            "buffer pool: no memory provider registered as " + name
+        );
+        policy.mem_provider = it->second;
+    }
+    return policy;
+}
+
+/***********************************************************************
+ * Memory allocation with a policy:
+ *  - Map anonymous memory, from hugepages when requested.
+ *  - Bind the mapping to the preferred NUMA node before first touch.
+ *  - Lock the mapping and touch every page so that the page faults
+ *    happen here rather than in the streaming path.
+ **********************************************************************/
+#ifdef UHD_PLATFORM_LINUX
+class mmap_deleter{
+public:
+    mmap_deleter(const size_t bytes): _bytes(bytes){/* NOP */}
+    void operator()(char *mem){::munmap(mem, _bytes);}
+private:
+    size_t _bytes;
+};
+
+static boost::shared_ptr<char> alloc_mmap(const size_t bytes, const buffer_pool::alloc_policy_t &policy){
+    void *mem = MAP_FAILED;
+    size_t map_bytes = bytes;
+
+    if (policy.hugepages){
+        #ifdef MAP_HUGETLB
+        map_bytes = pad_to_boundary(bytes, HUGEPAGE_SIZE);
+        mem = ::mmap(NULL, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        #endif /*MAP_HUGETLB*/
+        if (mem == MAP_FAILED) UHD_MSG(warning) <<
+            "Could not allocate the buffer pool from hugepages.\n"
+            "Please reserve hugepages: sudo sysctl -w vm.nr_hugepages=<num>\n"
+            "Falling back to transparent hugepages." << std::endl;
+    }
+
+    if (mem == MAP_FAILED){
+        map_bytes = bytes;
+        mem = ::mmap(NULL, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) throw uhd::os_error("buffer pool: mmap failed");
+        #ifdef MADV_HUGEPAGE
+        if (policy.hugepages) ::madvise(mem, map_bytes, MADV_HUGEPAGE);
+        #endif /*MADV_HUGEPAGE*/
+    }
+
+    if (policy.numa_node >= 0){
+        #ifdef __NR_mbind
+        const unsigned long nodemask = 1UL << policy.numa_node;
+        if (
+            size_t(policy.numa_node) >= sizeof(nodemask)*8 or
+            ::syscall(__NR_mbind, mem, map_bytes, MPOL_PREFERRED, &nodemask, sizeof(nodemask)*8 + 1, 0) != 0
+        )
+        #endif /*__NR_mbind*/
+        UHD_MSG(warning) << "Could not bind the buffer pool to NUMA node " << policy.numa_node << std::endl;
+    }
+
+    if (policy.lock and ::mlock(mem, map_bytes) != 0) UHD_MSG(warning) <<
+        "Could not lock the buffer pool into memory.\n"
+        "Please raise the locked memory limit: ulimit -l" << std::endl;
+
+    std::memset(mem, 0, map_bytes);
+    return boost::shared_ptr<char>(static_cast<char *>(mem), mmap_deleter(map_bytes));
+}
+#endif /*UHD_PLATFORM_LINUX*/
+
+static boost::shared_ptr<char> alloc_mem(const size_t bytes, const buffer_pool::alloc_policy_t &policy){
+    if (policy.mem_provider){
+        boost::shared_ptr<char> mem = boost::static_pointer_cast<char>(policy.mem_provider(bytes));
+        if (mem.get() == NULL) throw uhd::os_error("buffer pool: the memory provider returned no memory");
+        return mem;
+    }
+    if (policy.hugepages or policy.numa_node >= 0 or policy.lock){
+        #ifdef UHD_PLATFORM_LINUX
+        return alloc_mmap(bytes, policy);
+        #else
+        UHD_MSG(warning) << "Buffer pool allocation policies are not supported on this platform." << std::endl;
+        #endif /*UHD_PLATFORM_LINUX*/
+    }
+    return boost::shared_ptr<char>(new char[bytes], boost::checked_array_deleter<char>());
+}
+
 /***********************************************************************
  * Buffer pool implementation
  **********************************************************************/
@@ -33,7 +167,7 @@ class buffer_pool_impl : public buffer_pool{
 public:
     buffer_pool_impl(
         const std::vector<ptr_type> &ptrs,
-        boost::shared_array<char> mem
+        boost::shared_ptr<char> mem
     ): _ptrs(ptrs), _mem(mem){
         /* NOP */
     }
@@ -48,7 +182,7 @@ public:
 
 private:
     std::vector<ptr_type> _ptrs;
-    boost::shared_array<char> _mem;
+    boost::shared_ptr<char> _mem;
 };
 
 /***********************************************************************
@@ -58,12 +192,21 @@ buffer_pool::sptr buffer_pool::make(
     const size_t num_buffs,
     const size_t buff_size,
     const size_t alignment
+){
+    return make(num_buffs, buff_size, alignment, alloc_policy_t());
+}
+
+buffer_pool::sptr buffer_pool::make(
+    const size_t num_buffs,
+    const size_t buff_size,
+    const size_t alignment,
+    const alloc_policy_t &policy
 ){
     //1) pad the buffer size to be a multiple of alignment
     //2) pad the overall memory size for room after alignment
     //3) allocate the memory in one block of sufficient size
     const size_t padded_buff_size = pad_to_boundary(buff_size, alignment);
-    boost::shared_array<char> mem(new char[padded_buff_size*num_buffs + alignment-1]);
+    boost::shared_ptr<char> mem = alloc_mem(padded_buff_size*num_buffs + alignment-1, policy);
 
     //Fill a vector with boundary-aligned points in the memory
     const size_t mem_start = pad_to_boundary(size_t(mem.get()), alignment);
@@ -23,6 +23,10 @@ This script will generate the pack and unpack routines that convert
 metatdata into vrt headers and vrt headers into metadata.
 
 The generated code infers jump tables to speed-up the parsing time.
+
+The fixed layout unpackers hard-code the optional fields of one layout.
+They check the header flags against the layout in a single compare,
+and fall back to the generic unpacker for packets of any other layout.
 """
 
 TMPL_TEXT = """
@@ -242,6 +246,104 @@ void vrt::if_hdr_unpack_$(suffix)(
     }
 }
 
+#for $name, $layout in $fixed_layouts
+########################################################################
+#set $num_header_words = 1
+#set $flags = 0
+#set $flags_mask = $hex((0x1 << 28) | (0x1 << 27) | (0x1 << 26) | (0x3 << 22) | (0x3 << 20))
+#if $layout & $sid_p
+    #set $flags |= (0x1 << 28)
+#end if
+#if $layout & $cid_p
+    #set $flags |= (0x1 << 27)
+#end if
+#if $layout & $tsi_p
+    #set $flags |= (0x3 << 22)
+#end if
+#if $layout & $tsf_p
+    #set $flags |= (0x1 << 20)
+#end if
+#if $layout & $tlr_p
+    #set $flags |= (0x1 << 26)
+    #set $num_trailer_words = 1
+#else
+    #set $num_trailer_words = 0
+#end if
+
+void vrt::if_hdr_unpack_$(suffix)_$(name)(
+    const boost::uint32_t *packet_buff,
+    if_packet_info_t &if_packet_info
+){
+    //extract vrt header
+    boost::uint32_t vrt_hdr_word = $(XE_MACRO)(packet_buff[0]);
+
+    //any other layout takes the generic path
+    if ((vrt_hdr_word & $flags_mask) != $hex($flags)){
+        return vrt::if_hdr_unpack_$(suffix)(packet_buff, if_packet_info);
+    }
+    size_t packet_words32 = vrt_hdr_word & 0xffff;
+
+    //failure case
+    if (if_packet_info.num_packet_words32 < packet_words32)
+        throw uhd::value_error("bad vrt header or packet fragment");
+
+    //extract fields from the header
+    if_packet_info.packet_type = if_packet_info_t::packet_type_t(vrt_hdr_word >> 29);
+    if_packet_info.packet_count = (vrt_hdr_word >> 16) & 0xf;
+    if_packet_info.sob = (vrt_hdr_word & $hex(0x1 << 25)) != 0;
+    if_packet_info.eob = (vrt_hdr_word & $hex(0x1 << 24)) != 0;
+
+    ########## Stream ID ##########
+    #if $layout & $sid_p
+    if_packet_info.has_sid = true;
+    if_packet_info.sid = $(XE_MACRO)(packet_buff[$num_header_words]);
+        #set $num_header_words += 1
+    #else
+    if_packet_info.has_sid = false;
+    #end if
+    ########## Class ID ##########
+    #if $layout & $cid_p
+    if_packet_info.has_cid = true;
+    if_packet_info.cid = 0; //not implemented
+        #set $num_header_words += 2
+    #else
+    if_packet_info.has_cid = false;
+    #end if
+    ########## Integer Time ##########
+    #if $layout & $tsi_p
+    if_packet_info.has_tsi = true;
+    if_packet_info.tsi = $(XE_MACRO)(packet_buff[$num_header_words]);
+        #set $num_header_words += 1
+    #else
+    if_packet_info.has_tsi = false;
+    #end if
+    ########## Fractional Time ##########
+    #if $layout & $tsf_p
+    if_packet_info.has_tsf = true;
+    if_packet_info.tsf = boost::uint64_t($(XE_MACRO)(packet_buff[$num_header_words])) << 32;
+        #set $num_header_words += 1
+    if_packet_info.tsf |= $(XE_MACRO)(packet_buff[$num_header_words]);
+        #set $num_header_words += 1
+    #else
+    if_packet_info.has_tsf = false;
+    #end if
+
+    //another failure case
+    if (packet_words32 < $($num_header_words + $num_trailer_words))
+        throw uhd::value_error("bad vrt header or invalid packet length");
+
+    ########## Trailer ##########
+    #if $layout & $tlr_p
+    if_packet_info.has_tlr = true;
+    if_packet_info.tlr = $(XE_MACRO)(packet_buff[packet_words32-1]);
+    #else
+    if_packet_info.has_tlr = false;
+    #end if
+    if_packet_info.num_header_words32 = $num_header_words;
+    if_packet_info.num_payload_words32 = packet_words32 - $($num_header_words + $num_trailer_words);
+}
+#end for
+
 ########################################################################
 #end def
 ########################################################################
@@ -266,4 +368,7 @@ if __name__ == '__main__':
         tlr_p = 0b0010000,
         sob_p = 0b0100000,
         eob_p = 0b1000000,
+        fixed_layouts = (
+            ('sid_tsi_tsf_tlr', 0b0011101), #data from the dsp cores
+        ),
     ))
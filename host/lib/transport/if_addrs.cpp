@@ -16,9 +16,66 @@
 //
 
 #include <uhd/transport/if_addrs.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <boost/asio.hpp>
 #include <boost/asio/ip/address_v4.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/foreach.hpp>
 #include <boost/cstdint.hpp>
 #include <iostream>
+#include <fstream>
+
+/***********************************************************************
+ * Interface locality through the route and sysfs
+ **********************************************************************/
+uhd::transport::if_locality_t::if_locality_t(void):
+    numa_node(-1)
+{
+    /* NOP */
+}
+
+static std::string read_sysfs_line(const std::string &path){
+    std::ifstream file(path.c_str());
+    std::string line;
+    std::getline(file, line);
+    return boost::algorithm::trim_copy(line);
+}
+
+uhd::transport::if_locality_t uhd::transport::get_if_locality(const std::string &addr){
+    if_locality_t locality;
+
+    //connecting a udp socket selects the route without sending a packet
+    std::string local_addr;
+    try{
+        boost::asio::io_service io_service;
+        boost::asio::ip::udp::resolver resolver(io_service);
+        boost::asio::ip::udp::resolver::query query(boost::asio::ip::udp::v4(), addr, "9");
+        boost::asio::ip::udp::socket socket(io_service, boost::asio::ip::udp::v4());
+        socket.connect(*resolver.resolve(query));
+        local_addr = socket.local_endpoint().address().to_string();
+    }
+    catch(const std::exception &){
+        return locality;
+    }
+
+    BOOST_FOREACH(const if_addrs_t &if_addrs, get_if_addrs()){
+        if (if_addrs.inet == local_addr) locality.name = if_addrs.name;
+    }
+    if (locality.name.empty()) return locality;
+
+    //virtual interfaces (ex: loopback) have no device and no locality
+    const std::string device_path = "/sys/class/net/" + locality.name + "/device/";
+    try{
+        locality.numa_node = boost::lexical_cast<int>(read_sysfs_line(device_path + "numa_node"));
+    }
+    catch(const std::exception &){} //leave the node unknown
+    try{
+        locality.cpus = uhd::cpus_from_string(read_sysfs_line(device_path + "local_cpulist"));
+    }
+    catch(const std::exception &){} //leave the cpus unknown
+    return locality;
+}
 
 /***********************************************************************
  * Interface address discovery through ifaddrs api
@@ -48,6 +105,7 @@ std::vector<uhd::transport::if_addrs_t> uhd::transport::get_if_addrs(void){
             if_addr.inet = sockaddr_to_ip_addr(iter->ifa_addr).to_string();
             if_addr.mask = sockaddr_to_ip_addr(iter->ifa_netmask).to_string();
             if_addr.bcast = sockaddr_to_ip_addr(iter->ifa_broadaddr).to_string();
+            if_addr.name = iter->ifa_name;
             if_addrs.push_back(if_addr);
         }
         freeifaddrs(ifap);
@@ -16,19 +16,50 @@
 //
 
 #include "libusb1_base.hpp"
+#include "pollable_event.hpp"
 #include <uhd/transport/usb_zero_copy.hpp>
 #include <uhd/transport/buffer_pool.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/trace.hpp>
+#include <uhd/utils/algorithm.hpp>
 #include <uhd/exception.hpp>
 #include <boost/foreach.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/bind.hpp>
+#include <cmath>
+#include <cstdlib>
 #include <list>
+#include <vector>
 
 using namespace uhd;
 using namespace uhd::transport;
 
 static const size_t DEFAULT_NUM_XFERS = 16;     //num xfers
 static const size_t DEFAULT_XFER_SIZE = 32*512; //bytes
+static const double AUTO_BUFFER_TIME = 0.05;     //seconds in flight
+static const size_t AUTO_MAX_XFERS = 64;         //num xfers
+static const size_t AUTO_XFER_MULTIPLE = 4*512;  //bytes, a whole device packet
+
+/*!
+ * The number of transfers for a direction:
+ * the hint when given, otherwise with a latency target,
+ * enough transfers of one latency each to cover the buffer time.
+ */
+static size_t get_num_xfers(const device_addr_t &hints, const std::string &key, const double latency){
+    if (hints.has_key(key) or latency <= 0) return size_t(hints.cast<double>(key, DEFAULT_NUM_XFERS));
+    return uhd::clip<size_t>(size_t(std::ceil(AUTO_BUFFER_TIME/latency)), DEFAULT_NUM_XFERS, AUTO_MAX_XFERS);
+}
+
+//! The transfer size that the stream fills in the latency target
+static size_t get_auto_xfer_size(const double bytes_per_sec, const double latency, const size_t max_size){
+    const size_t size = size_t(std::ceil(bytes_per_sec*latency/AUTO_XFER_MULTIPLE))*AUTO_XFER_MULTIPLE;
+    return uhd::clip<size_t>(size, std::min(AUTO_XFER_MULTIPLE, max_size), max_size);
+}
 
 //! Define LIBUSB_CALL when its missing (non-windows)
 #ifndef LIBUSB_CALL
@@ -45,6 +76,11 @@ static void LIBUSB_CALL libusb_async_cb(libusb_transfer *lut){
     *(static_cast<bool *>(lut->user_data)) = true;
 }
 
+//! helper function: pushes a completed managed buffer into its ready queue
+template <typename buff_type> static void LIBUSB_CALL libusb_async_ready_cb(libusb_transfer *lut){
+    static_cast<buff_type *>(lut->user_data)->push_ready();
+}
+
 /*!
  * Wait for a managed buffer to become complete.
  *
@@ -61,18 +97,70 @@ static void LIBUSB_CALL libusb_async_cb(libusb_transfer *lut){
  * \return true for completion, false for timeout
  */
 UHD_INLINE bool wait_for_completion(libusb_context *ctx, const double timeout, bool &completed){
+    if (completed) return true;
     const boost::system_time timeout_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1000000));
 
-    while (not completed and (boost::get_system_time() < timeout_time)){
+    //handle events at least once, so a zero timeout still reaps completions
+    do{
         timeval tv;
         tv.tv_sec = 0;
-        tv.tv_usec = 10000; /*10ms*/
+        tv.tv_usec = (timeout > 0)? 10000 /*10ms*/ : 0;
         libusb_handle_events_timeout(ctx, &tv);
-    }
+    } while (not completed and (boost::get_system_time() < timeout_time));
 
     return completed;
 }
 
+/***********************************************************************
+ * Transfer memory for one direction:
+ *  - Maps usbfs device memory when libusb and the kernel support it,
+ *    so that the kernel does not copy the transfers to user memory.
+ *  - Falls back to a buffer pool otherwise.
+ **********************************************************************/
+class libusb_xfer_memory : boost::noncopyable{
+public:
+    libusb_xfer_memory(
+        libusb::device_handle::sptr handle,
+        const size_t num_buffs, const size_t buff_size,
+        const device_addr_t &hints, const std::string &prefix
+    ):
+        _handle(handle),
+        _stride((buff_size + 15) & ~size_t(15)), //buffer pool alignment
+        _dev_mem(NULL), _dev_mem_len(0)
+    {
+        #ifdef HAVE_LIBUSB_DEV_MEM
+        if (hints.cast<int>(prefix + "_dev_mem", 1) != 0){
+            _dev_mem_len = num_buffs*_stride;
+            _dev_mem = libusb_dev_mem_alloc(_handle->get(), _dev_mem_len);
+            if (_dev_mem != NULL) return;
+            UHD_LOG << "libusb device memory not available for " << prefix << ", using a buffer pool" << std::endl;
+            _dev_mem_len = 0;
+        }
+        #endif /*HAVE_LIBUSB_DEV_MEM*/
+        _pool = buffer_pool::make(num_buffs, buff_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints, prefix)
+        );
+    }
+
+    ~libusb_xfer_memory(void){
+        #ifdef HAVE_LIBUSB_DEV_MEM
+        if (_dev_mem != NULL) libusb_dev_mem_free(_handle->get(), _dev_mem, _dev_mem_len);
+        #endif /*HAVE_LIBUSB_DEV_MEM*/
+    }
+
+    unsigned char *at(const size_t index) const{
+        if (_dev_mem != NULL) return _dev_mem + index*_stride;
+        return static_cast<unsigned char *>(_pool->at(index));
+    }
+
+private:
+    libusb::device_handle::sptr _handle;
+    const size_t _stride;
+    unsigned char *_dev_mem;
+    size_t _dev_mem_len;
+    buffer_pool::sptr _pool;
+};
+
 /***********************************************************************
  * Reusable managed receiver buffer:
  *  - Associated with a particular libusb transfer struct.
@@ -80,26 +168,47 @@ UHD_INLINE bool wait_for_completion(libusb_context *ctx, const double timeout, b
  **********************************************************************/
 class libusb_zero_copy_mrb : public managed_recv_buffer{
 public:
-    libusb_zero_copy_mrb(libusb_transfer *lut):
+    typedef spsc_bounded_buffer<libusb_zero_copy_mrb *> ready_queue_type;
+
+    libusb_zero_copy_mrb(
+        libusb_transfer *lut, zero_copy_stats_t &stats,
+        ready_queue_type *ready, pollable_event *ready_event, const size_t &xfer_size
+    ):
         _ctx(libusb::session::get_global_session()->get_context()),
-        _lut(lut), _expired(false) { /* NOP */ }
+        _lut(lut), _expired(false), _stats(stats),
+        _ready(ready), _ready_event(ready_event), _xfer_size(xfer_size) { /* NOP */ }
 
     void release(void){
         if (_expired) return;
         completed = false;
+        _lut->length = _xfer_size; //resubmit at the current transfer size
         UHD_ASSERT_THROW(libusb_submit_transfer(_lut) == 0);
         _expired = true;
+        _stats.release_recv();
     }
 
     sptr get_new(const double timeout, size_t &index){
         if (wait_for_completion(_ctx, timeout, completed)){
             index++;
-            _expired = false;
-            return make_managed_buffer(this);
+            return get_ready();
         }
+        _stats.recv_timeouts++;
         return managed_recv_buffer::sptr();
     }
 
+    //! Claim this buffer once its transfer is known to be complete
+    sptr get_ready(void){
+        _expired = false;
+        _stats.claim_recv(_lut->actual_length);
+        return make_managed_buffer(this);
+    }
+
+    //! Called by the event thread when the transfer completes
+    void push_ready(void){
+        _ready->push_with_haste(this);
+        _ready_event->notify();
+    }
+
     bool completed;
 
 private:
@@ -109,6 +218,10 @@ private:
     libusb_context *_ctx;
     libusb_transfer *_lut;
     bool _expired;
+    zero_copy_stats_t &_stats;
+    ready_queue_type *_ready;
+    pollable_event *_ready_event;
+    const size_t &_xfer_size;
 };
 
 /***********************************************************************
@@ -118,28 +231,60 @@ private:
  **********************************************************************/
 class libusb_zero_copy_msb : public managed_send_buffer{
 public:
-    libusb_zero_copy_msb(libusb_transfer *lut):
+    typedef spsc_bounded_buffer<libusb_zero_copy_msb *> ready_queue_type;
+
+    libusb_zero_copy_msb(
+        libusb_transfer *lut, zero_copy_stats_t &stats,
+        ready_queue_type *ready, std::vector<libusb_zero_copy_msb *> &idle,
+        const size_t &xfer_size
+    ):
         _ctx(libusb::session::get_global_session()->get_context()),
-        _lut(lut), _expired(false) { /* NOP */ }
+        _lut(lut), _expired(false), _stats(stats), _ready(ready), _idle(idle), _xfer_size(xfer_size) { /* NOP */ }
 
     void commit(size_t len){
         if (_expired) return;
         completed = false;
         _lut->length = len;
-        if (len == 0) libusb_async_cb(_lut);
+        //an empty commit is not submitted, so the buffer is ready right away;
+        //with an event thread, the committing thread keeps it on the idle list
+        //because only the event thread may push into the ready queue
+        if (len == 0){
+            if (_ready == NULL) libusb_async_cb(_lut);
+            else _idle.push_back(this);
+        }
         else UHD_ASSERT_THROW(libusb_submit_transfer(_lut) == 0);
         _expired = true;
+        _stats.commit_send(len);
     }
 
     sptr get_new(const double timeout, size_t &index){
-        if (wait_for_completion(_ctx, timeout, completed)){
+        //only the slow path is timed: wait for the transfer to complete
+        if (not completed){
+            const boost::system_time start_time = boost::get_system_time();
+            wait_for_completion(_ctx, timeout, completed);
+            _stats.send_wait_time += (boost::get_system_time() - start_time).total_microseconds()/1e6;
+        }
+        if (completed){
             index++;
-            _expired = false;
-            return make_managed_buffer(this);
+            return get_ready();
         }
+        _stats.send_timeouts++;
         return managed_send_buffer::sptr();
     }
 
+    //! Claim this buffer once its transfer is known to be complete
+    sptr get_ready(void){
+        _expired = false;
+        _lut->length = _xfer_size; //the buffer size is the current transfer size
+        _stats.claim_send();
+        return make_managed_buffer(this);
+    }
+
+    //! Called by the event thread when the transfer completes
+    void push_ready(void){
+        _ready->push_with_haste(this);
+    }
+
     bool completed;
 
 private:
@@ -149,6 +294,10 @@ private:
     libusb_context *_ctx;
     libusb_transfer *_lut;
     bool _expired;
+    zero_copy_stats_t &_stats;
+    ready_queue_type *_ready;
+    std::vector<libusb_zero_copy_msb *> &_idle;
+    const size_t &_xfer_size;
 };
 
 /***********************************************************************
@@ -166,36 +315,55 @@ public:
         const device_addr_t &hints
     ):
         _handle(handle),
+        _xfer_latency(hints.cast<double>("xfer_latency", 0.0)),
         _recv_frame_size(size_t(hints.cast<double>("recv_frame_size", DEFAULT_XFER_SIZE))),
-        _num_recv_frames(size_t(hints.cast<double>("num_recv_frames", DEFAULT_NUM_XFERS))),
+        _num_recv_frames(get_num_xfers(hints, "num_recv_frames", _xfer_latency)),
         _send_frame_size(size_t(hints.cast<double>("send_frame_size", DEFAULT_XFER_SIZE))),
-        _num_send_frames(size_t(hints.cast<double>("num_send_frames", DEFAULT_NUM_XFERS))),
-        _recv_buffer_pool(buffer_pool::make(_num_recv_frames, _recv_frame_size)),
-        _send_buffer_pool(buffer_pool::make(_num_send_frames, _send_frame_size)),
+        _num_send_frames(get_num_xfers(hints, "num_send_frames", _xfer_latency)),
+        _recv_xfer_size(_recv_frame_size),
+        _send_xfer_size(_send_frame_size),
+        _recv_memory(handle, _num_recv_frames, _recv_frame_size, hints, "recv"),
+        _send_memory(handle, _num_send_frames, _send_frame_size, hints, "send"),
         _next_recv_buff_index(0),
-        _next_send_buff_index(0)
+        _next_send_buff_index(0),
+        _send_window(_num_send_frames)
     {
         _handle->claim_interface(recv_interface);
         _handle->claim_interface(send_interface);
 
+        //with an event thread, completed transfers are handed over through ready queues
+        const bool use_event_thread = hints.cast<int>("event_thread", 0) != 0;
+        if (use_event_thread){
+            _mrb_ready.reset(new libusb_zero_copy_mrb::ready_queue_type(_num_recv_frames));
+            _mrb_ready_event.reset(new pollable_event());
+            _msb_ready.reset(new libusb_zero_copy_msb::ready_queue_type(_num_send_frames));
+        }
+        _msb_idle.reserve(_num_send_frames);
+
         //allocate libusb transfer structs and managed receive buffers
         for (size_t i = 0; i < get_num_recv_frames(); i++){
 
             libusb_transfer *lut = libusb_alloc_transfer(0);
             UHD_ASSERT_THROW(lut != NULL);
 
-            _mrb_pool.push_back(boost::shared_ptr<libusb_zero_copy_mrb>(new libusb_zero_copy_mrb(lut)));
+            _mrb_pool.push_back(boost::shared_ptr<libusb_zero_copy_mrb>(
+                new libusb_zero_copy_mrb(lut, _stats, _mrb_ready.get(), _mrb_ready_event.get(), _recv_xfer_size)
+            ));
 
             libusb_fill_bulk_transfer(
                 lut,                                                    // transfer
                 _handle->get(),                                         // dev_handle
                 (recv_endpoint & 0x7f) | 0x80,                          // endpoint
-                static_cast<unsigned char *>(_recv_buffer_pool->at(i)), // buffer
+                _recv_memory.at(i),                                     // buffer
                 this->get_recv_frame_size(),                            // length
                 libusb_transfer_cb_fn(&libusb_async_cb),                // callback
                 static_cast<void *>(&_mrb_pool.back()->completed),      // user_data
                 0                                                       // timeout (ms)
             );
+            if (use_event_thread){
+                lut->callback = libusb_transfer_cb_fn(&libusb_async_ready_cb<libusb_zero_copy_mrb>);
+                lut->user_data = static_cast<void *>(_mrb_pool.back().get());
+            }
 
             _all_luts.push_back(lut);
             _mrb_pool.back()->release();
@@ -207,27 +375,49 @@ public:
             libusb_transfer *lut = libusb_alloc_transfer(0);
             UHD_ASSERT_THROW(lut != NULL);
 
-            _msb_pool.push_back(boost::shared_ptr<libusb_zero_copy_msb>(new libusb_zero_copy_msb(lut)));
+            _msb_pool.push_back(boost::shared_ptr<libusb_zero_copy_msb>(
+                new libusb_zero_copy_msb(lut, _stats, _msb_ready.get(), _msb_idle, _send_xfer_size)
+            ));
 
             libusb_fill_bulk_transfer(
                 lut,                                                    // transfer
                 _handle->get(),                                         // dev_handle
                 (send_endpoint & 0x7f) | 0x00,                          // endpoint
-                static_cast<unsigned char *>(_send_buffer_pool->at(i)), // buffer
+                _send_memory.at(i),                                     // buffer
                 this->get_send_frame_size(),                            // length
                 libusb_transfer_cb_fn(&libusb_async_cb),                // callback
                 static_cast<void *>(&_msb_pool.back()->completed),      // user_data
                 0                                                       // timeout
             );
+            if (use_event_thread){
+                lut->callback = libusb_transfer_cb_fn(&libusb_async_ready_cb<libusb_zero_copy_msb>);
+                lut->user_data = static_cast<void *>(_msb_pool.back().get());
+            }
 
             _all_luts.push_back(lut);
             _msb_pool.back()->commit(0);
         }
+
+        //the initial submissions above are not caller activity
+        _stats = zero_copy_stats_t();
+
+        //spawn the event thread last, once all transfers are set up
+        if (use_event_thread){
+            _event_task = task::make(
+                boost::bind(&libusb_zero_copy_impl::event_task, this),
+                cpus_from_string(hints.get("pirate_cpu", "")),
+                thread_sched_t::from_string(hints.get("event_sched", "rr"))
+            );
+            _event_task->set_name("libusb event");
+        }
     }
 
     ~libusb_zero_copy_impl(void){
         libusb_context *ctx = libusb::session::get_global_session()->get_context();
 
+        //stop the event thread, the cancelled transfers are reaped below
+        _event_task.reset();
+
         //cancel all transfers
         BOOST_FOREACH(libusb_transfer *lut, _all_luts){
             libusb_cancel_transfer(lut);
@@ -245,35 +435,137 @@ public:
     }
 
     managed_recv_buffer::sptr get_recv_buff(double timeout){
+        if (_mrb_ready.get() != NULL){
+            UHD_TRACE_SCOPE("usb_wait_recv");
+            libusb_zero_copy_mrb *mrb;
+            if (_mrb_ready->pop_with_timed_wait(mrb, timeout)) return mrb->get_ready();
+            //clear the event, then recheck for a push that raced with the clear
+            _mrb_ready_event->clear();
+            if (_mrb_ready->pop_with_haste(mrb)){
+                _mrb_ready_event->notify();
+                return mrb->get_ready();
+            }
+            _stats.recv_timeouts++;
+            return managed_recv_buffer::sptr();
+        }
         if (_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
         return _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
     }
 
     managed_send_buffer::sptr get_send_buff(double timeout){
-        if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
+        if (_msb_ready.get() != NULL) while (true){
+            libusb_zero_copy_msb *msb;
+            if (not _msb_idle.empty()){
+                msb = _msb_idle.back();
+                _msb_idle.pop_back();
+            }
+            else{
+                //only the slow path is timed: wait for a transfer to complete
+                UHD_TRACE_SCOPE("usb_wait_send");
+                const boost::system_time start_time = boost::get_system_time();
+                const bool ready = _msb_ready->pop_with_timed_wait(msb, timeout);
+                _stats.send_wait_time += (boost::get_system_time() - start_time).total_microseconds()/1e6;
+                if (not ready){
+                    _stats.send_timeouts++;
+                    return managed_send_buffer::sptr();
+                }
+            }
+            //hold back the frames above the send window
+            if (_msb_held.size() + _send_window < _num_send_frames){
+                _msb_held.push_back(msb);
+                continue;
+            }
+            return msb->get_ready();
+        }
+        //the frames cycle in order, so the window is the length of the cycle
+        if (_next_send_buff_index >= _send_window) _next_send_buff_index = 0;
         return _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
     }
 
     size_t get_num_recv_frames(void) const { return _num_recv_frames; }
     size_t get_num_send_frames(void) const { return _num_send_frames; }
 
-    size_t get_recv_frame_size(void) const { return _recv_frame_size; }
-    size_t get_send_frame_size(void) const { return _send_frame_size; }
+    size_t get_recv_frame_size(void) const { return _recv_xfer_size; }
+    size_t get_send_frame_size(void) const { return _send_xfer_size; }
+
+    void set_recv_rate(double bytes_per_sec){
+        if (_xfer_latency <= 0) return; //fixed transfer sizes
+        _recv_xfer_size = get_auto_xfer_size(bytes_per_sec, _xfer_latency, _recv_frame_size);
+    }
+
+    void set_send_rate(double bytes_per_sec){
+        if (_xfer_latency <= 0) return; //fixed transfer sizes
+        _send_xfer_size = get_auto_xfer_size(bytes_per_sec, _xfer_latency, _send_frame_size);
+    }
+
+    void set_send_window(size_t num_frames){
+        _send_window = uhd::clip<size_t>(num_frames, 1, _num_send_frames);
+        while (not _msb_held.empty() and _msb_held.size() + _send_window > _num_send_frames){
+            _msb_idle.push_back(_msb_held.back());
+            _msb_held.pop_back();
+        }
+    }
+
+    zero_copy_stats_t get_stats(void) const { return _stats; }
+
+    poll_fds_t get_recv_poll_fds(void) const{
+        if (_mrb_ready_event.get() != NULL) return _mrb_ready_event->get_poll_fds();
+
+        //without an event thread, the caller handles events on libusb's descriptors;
+        //these are shared by the whole context and may wake up for other devices
+        poll_fds_t fds;
+        const libusb_pollfd **pollfds = libusb_get_pollfds(libusb::session::get_global_session()->get_context());
+        if (pollfds == NULL) return fds; //the platform has no pollable descriptors
+        for (size_t i = 0; pollfds[i] != NULL; i++){
+            fds.push_back(poll_fd_t(pollfds[i]->fd, pollfds[i]->events));
+        }
+        std::free(pollfds);
+        return fds;
+    }
 
 private:
     libusb::device_handle::sptr _handle;
+    const double _xfer_latency; //auto transfer sizes when positive
     const size_t _recv_frame_size, _num_recv_frames;
     const size_t _send_frame_size, _num_send_frames;
 
+    //! The current transfer sizes, at most the frame sizes above
+    size_t _recv_xfer_size, _send_xfer_size;
+
+    //! Performance counters updated by the managed buffers
+    zero_copy_stats_t _stats;
+
     //! Storage for transfer related objects
-    buffer_pool::sptr _recv_buffer_pool, _send_buffer_pool;
+    libusb_xfer_memory _recv_memory, _send_memory;
     std::vector<boost::shared_ptr<libusb_zero_copy_mrb> > _mrb_pool;
     std::vector<boost::shared_ptr<libusb_zero_copy_msb> > _msb_pool;
     size_t _next_recv_buff_index, _next_send_buff_index;
 
+    //! The send frames that may be in flight, and the ones held back
+    size_t _send_window;
+    std::vector<libusb_zero_copy_msb *> _msb_held;
+
     //! a list of all transfer structs we allocated
     std::list<libusb_transfer *> _all_luts;
 
+    //! Event thread mode: completed buffers, and empty-committed send buffers
+    boost::scoped_ptr<libusb_zero_copy_mrb::ready_queue_type> _mrb_ready;
+    boost::scoped_ptr<libusb_zero_copy_msb::ready_queue_type> _msb_ready;
+    boost::scoped_ptr<pollable_event> _mrb_ready_event;
+    std::vector<libusb_zero_copy_msb *> _msb_idle;
+
+    /*!
+     * The event thread runs the libusb event handling for all transfers,
+     * so that completions are reaped even when no caller is waiting.
+     * The handle events timeout bounds the time to stop the thread.
+     */
+    void event_task(void){
+        timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = 100000; /*100ms*/
+        libusb_handle_events_timeout(libusb::session::get_global_session()->get_context(), &tv);
+    }
+    task::sptr _event_task;
 
 };
 
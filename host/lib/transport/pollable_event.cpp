@@ -0,0 +1,94 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "pollable_event.hpp"
+#include <uhd/exception.hpp>
+#ifdef HAVE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+#ifndef UHD_PLATFORM_WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#endif
+
+using namespace uhd;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * Setup the descriptors:
+ *  - An eventfd is one descriptor for both ends.
+ *  - A pipe is the fallback on other posix platforms.
+ *  - Without either, the descriptors stay invalid.
+ **********************************************************************/
+pollable_event::pollable_event(void):
+    _read_fd(-1), _write_fd(-1)
+{
+    #if defined(HAVE_EVENTFD)
+    _read_fd = _write_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_read_fd < 0) throw uhd::os_error("pollable event: eventfd failed");
+    #elif !defined(UHD_PLATFORM_WIN32)
+    int fds[2];
+    if (::pipe(fds) != 0) throw uhd::os_error("pollable event: pipe failed");
+    for (size_t i = 0; i < 2; i++){
+        ::fcntl(fds[i], F_SETFL, ::fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        ::fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    _read_fd = fds[0];
+    _write_fd = fds[1];
+    #endif
+}
+
+pollable_event::~pollable_event(void){
+    #ifndef UHD_PLATFORM_WIN32
+    if (_write_fd != _read_fd) ::close(_write_fd);
+    if (_read_fd >= 0) ::close(_read_fd);
+    #endif
+}
+
+poll_fds_t pollable_event::get_poll_fds(void) const{
+    #ifdef UHD_PLATFORM_WIN32
+    return poll_fds_t();
+    #else
+    return poll_fds_t(1, poll_fd_t(_read_fd, POLLIN));
+    #endif
+}
+
+/***********************************************************************
+ * Signal and clear:
+ * The descriptor is drained before the flag is reset,
+ * so a notify that sees the flag still set is always
+ * followed by the consumer's own check of the queue.
+ **********************************************************************/
+void pollable_event::signal(void){
+    //a failed write on a full pipe still leaves the event readable
+    #if defined(HAVE_EVENTFD)
+    const eventfd_t one = 1;
+    (void)::write(_write_fd, &one, sizeof(one));
+    #elif !defined(UHD_PLATFORM_WIN32)
+    const char one = 1;
+    (void)::write(_write_fd, &one, sizeof(one));
+    #endif
+}
+
+void pollable_event::clear(void){
+    #ifndef UHD_PLATFORM_WIN32
+    char buff[64];
+    while (::read(_read_fd, buff, sizeof(buff)) > 0){}
+    #endif
+    _signaled.write(0);
+}
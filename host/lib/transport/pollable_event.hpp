@@ -0,0 +1,103 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_POLLABLE_EVENT_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_POLLABLE_EVENT_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <boost/utility.hpp>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * A pollable event makes a software queue visible to an event loop:
+ * its descriptor is readable while the queue may hold items.
+ * Backed by an eventfd on linux and a non-blocking pipe elsewhere;
+ * platforms without either get an event that cannot be polled.
+ *
+ * The producer calls notify() after every push;
+ * only the first notify after a clear() touches the descriptor.
+ * The consumer calls clear() when a pop comes up empty,
+ * then pops once more and calls notify() if that pop succeeds,
+ * so that a push which raced with the clear is never lost.
+ */
+class pollable_event : boost::noncopyable{
+public:
+    pollable_event(void);
+    ~pollable_event(void);
+
+    //! Get the descriptors to poll, empty when not pollable
+    poll_fds_t get_poll_fds(void) const;
+
+    //! Mark the event ready, called after a push
+    UHD_INLINE void notify(void){
+        if (_signaled.read() == 0 and _signaled.cas(1, 0) == 0) this->signal();
+    }
+
+    //! Mark the event not ready, called after an empty pop
+    void clear(void);
+
+private:
+    void signal(void);
+    atomic_uint32_t _signaled;
+    int _read_fd, _write_fd;
+};
+
+/*!
+ * A bounded buffer with a pollable event for its consumer,
+ * used for queues that an event loop waits on (async messages).
+ */
+template <typename elem_type> class pollable_bounded_buffer{
+public:
+    pollable_bounded_buffer(size_t capacity):
+        _buffer(capacity)
+    {
+        /* NOP */
+    }
+
+    //! Push a new element, popping the oldest when full
+    UHD_INLINE bool push_with_pop_on_full(const elem_type &elem){
+        const bool ret = _buffer.push_with_pop_on_full(elem);
+        _event.notify();
+        return ret;
+    }
+
+    //! Pop an element, waiting up to the timeout for one
+    UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
+        if (_buffer.pop_with_timed_wait(elem, timeout)) return true;
+        _event.clear();
+        if (not _buffer.pop_with_haste(elem)) return false;
+        _event.notify();
+        return true;
+    }
+
+    //! Get the descriptors that signal an element may be ready
+    poll_fds_t get_poll_fds(void) const{
+        return _event.get_poll_fds();
+    }
+
+private:
+    bounded_buffer<elem_type> _buffer;
+    pollable_event _event;
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_POLLABLE_EVENT_HPP */
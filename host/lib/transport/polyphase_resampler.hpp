@@ -0,0 +1,312 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_POLYPHASE_RESAMPLER_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_POLYPHASE_RESAMPLER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/property_tree.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/utility.hpp>
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+namespace uhd{ namespace transport{
+
+/*!
+ * The settings of a host side resampler stage.
+ * A rate of zero means the stage is off.
+ */
+struct resampler_config_t{
+    resampler_config_t(void):
+        rate(0.0), taps_per_phase(16), max_phases(256)
+    {
+        /* NOP */
+    }
+
+    //! the host side sample rate in Sps (zero for off)
+    double rate;
+
+    //! the filter length of each phase (rounded up to even)
+    size_t taps_per_phase;
+
+    //! the largest interpolation factor used to approximate the ratio
+    size_t max_phases;
+};
+
+/*!
+ * A rational polyphase resampler for complex float samples.
+ * The input to output ratio is interp/decim, the closest fraction
+ * to the requested rates with an interpolation of at most max phases.
+ *
+ * The caller writes input in place into get_input_buff(),
+ * commits it, then pulls as many outputs as the input allows.
+ * History between calls is kept in the same buffer,
+ * so the input is only copied when the buffer is compacted.
+ */
+class polyphase_resampler : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<polyphase_resampler> sptr;
+    typedef std::complex<float> sample_type;
+
+    /*!
+     * Make a new resampler.
+     * \param in_rate the input sample rate in Sps
+     * \param out_rate the requested output sample rate in Sps
+     * \param taps_per_phase the filter length of each phase
+     * \param max_phases the largest interpolation factor
+     * \param input_capacity the samples that fit in the input buffer
+     */
+    static sptr make(
+        const double in_rate, const double out_rate,
+        const size_t taps_per_phase, const size_t max_phases,
+        const size_t input_capacity = 4096
+    ){
+        return sptr(new polyphase_resampler(in_rate, out_rate, taps_per_phase, max_phases, input_capacity));
+    }
+
+    //! Get the interpolation factor
+    size_t get_interp(void) const{
+        return _interp;
+    }
+
+    //! Get the decimation factor
+    size_t get_decim(void) const{
+        return _decim;
+    }
+
+    //! Get the actual output rate in Sps
+    double get_out_rate(void) const{
+        return _in_rate*_interp/_decim;
+    }
+
+    /*!
+     * Get the filter delay in input samples.
+     * Output k corresponds to input k*decim/interp - delay,
+     * where input 0 is the first sample committed after a reset.
+     */
+    double get_delay(void) const{
+        return double(_interp*_num_taps - 1)/(2*_interp);
+    }
+
+    //! Clear the history, the next input starts a new stream
+    void reset(void){
+        std::fill(_buff.begin(), _buff.begin() + _num_taps - 1, sample_type());
+        _read_index = 0;
+        _write_index = _num_taps - 1;
+        _phase = 0;
+    }
+
+    /*!
+     * Get the memory for the next input samples.
+     * Up to get_input_space() samples may be written there.
+     * \return a pointer to the end of the buffered input
+     */
+    sample_type *get_input_buff(void){
+        //move the unread history to the front of the buffer
+        const size_t keep_from = std::min(_read_index, _write_index);
+        if (keep_from != 0){
+            std::copy(_buff.begin() + keep_from, _buff.begin() + _write_index, _buff.begin());
+            _read_index -= keep_from;
+            _write_index -= keep_from;
+        }
+        return &_buff[_write_index];
+    }
+
+    //! Get the number of samples that fit after get_input_buff()
+    size_t get_input_space(void) const{
+        return _buff.size() - _write_index;
+    }
+
+    //! Commit samples written into the input buffer
+    void commit_input(const size_t nsamps){
+        _write_index += nsamps;
+    }
+
+    /*!
+     * Filter the buffered input into output samples.
+     * \param out the output samples
+     * \param max_nsamps the most samples to output
+     * \return the number of samples written
+     */
+    UHD_INLINE size_t get_output(sample_type *out, const size_t max_nsamps){
+        size_t nsamps = 0;
+        while (nsamps < max_nsamps and _read_index + _num_taps <= _write_index){
+            out[nsamps++] = dot_product(&_taps[_phase*_num_taps*2], &_buff[_read_index], _num_taps);
+            _phase += _decim;
+            _read_index += _phase/_interp;
+            _phase %= _interp;
+        }
+        return nsamps;
+    }
+
+private:
+    polyphase_resampler(
+        const double in_rate, const double out_rate,
+        const size_t taps_per_phase, const size_t max_phases,
+        const size_t input_capacity
+    ):
+        _in_rate(in_rate),
+        _num_taps(std::max<size_t>(2, taps_per_phase + taps_per_phase%2))
+    {
+        if (in_rate <= 0 or out_rate <= 0) throw uhd::value_error(
+            "polyphase resampler: the rates must be positive"
+        );
+        find_ratio(out_rate/in_rate, std::max<size_t>(1, max_phases), _interp, _decim);
+        design_taps();
+        //room for the history, the input, and a read index past the input
+        _buff.resize(input_capacity + _num_taps + _decim/_interp + 1);
+        this->reset();
+    }
+
+    /*!
+     * Find the closest fraction with a bounded numerator
+     * from the convergents of the continued fraction.
+     */
+    static void find_ratio(const double ratio, const size_t max_interp, size_t &interp, size_t &decim){
+        double p0 = 0, q0 = 1, p1 = 1, q1 = 0, x = ratio;
+        interp = 0; decim = 1;
+        for (size_t i = 0; i < 64; i++){
+            const double a = std::floor(x);
+            const double p2 = a*p1 + p0, q2 = a*q1 + q0;
+            if (p2 > max_interp or q2 > 1e9) break;
+            p0 = p1; q0 = q1; p1 = p2; q1 = q2;
+            if (p1 >= 1){
+                interp = size_t(p1); decim = size_t(q1);
+            }
+            if (std::abs(ratio - p1/q1) < 1e-12*ratio or x - a < 1e-9) break;
+            x = 1/(x - a);
+        }
+        if (interp == 0){ //the ratio is below 1/1e9 or the bound cut off all convergents
+            interp = 1; decim = size_t(std::floor(1/ratio + 0.5));
+        }
+    }
+
+    //! Zeroth order modified bessel function for the kaiser window
+    static double bessel_i0(const double x){
+        double sum = 1, term = 1;
+        for (size_t k = 1; k < 32; k++){
+            term *= (x/(2*k))*(x/(2*k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    /*!
+     * Design a kaiser windowed sinc lowpass at the upsampled rate,
+     * cut off below the nyquist rate of the slower side,
+     * then split it into phases with reversed and doubled taps
+     * so that a tap multiplies both parts of a complex sample.
+     */
+    void design_taps(void){
+        static const double bandwidth = 0.45, beta = 7.0;
+        const size_t num_total = _interp*_num_taps;
+        const double center = double(num_total - 1)/2;
+        const double cutoff = bandwidth/std::max(_interp, _decim);
+        const double pi = std::acos(-1.0);
+        std::vector<double> h(num_total);
+        for (size_t n = 0; n < num_total; n++){
+            const double t = n - center;
+            const double sinc = (t == 0)? 1.0 : std::sin(2*pi*cutoff*t)/(2*pi*cutoff*t);
+            const double r = (num_total == 1)? 0.0 : 2*n/double(num_total - 1) - 1;
+            h[n] = sinc*bessel_i0(beta*std::sqrt(std::max(0.0, 1 - r*r)))/bessel_i0(beta);
+        }
+
+        _taps.resize(num_total*2);
+        for (size_t p = 0; p < _interp; p++){
+            double sum = 0;
+            for (size_t j = 0; j < _num_taps; j++) sum += h[p + j*_interp];
+            for (size_t j = 0; j < _num_taps; j++){
+                //normalize each phase to unity gain at dc
+                const float tap = float(h[p + (_num_taps - 1 - j)*_interp]/sum);
+                _taps[(p*_num_taps + j)*2 + 0] = tap;
+                _taps[(p*_num_taps + j)*2 + 1] = tap;
+            }
+        }
+    }
+
+    //! Multiply the doubled taps with the complex samples and sum
+    static UHD_INLINE sample_type dot_product(const float *taps, const sample_type *samps, const size_t num_taps){
+        const float *x = reinterpret_cast<const float *>(samps);
+        const size_t num_floats = num_taps*2;
+        #if defined(__SSE2__)
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= num_floats; i += 8){
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i + 0), _mm_loadu_ps(taps + i + 0)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(taps + i + 4)));
+        }
+        if (i < num_floats){ //the num taps is even, so one more pair of samples
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(taps + i)));
+        }
+        acc0 = _mm_add_ps(acc0, acc1);
+        acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+        float sum[4];
+        _mm_storeu_ps(sum, acc0);
+        return sample_type(sum[0], sum[1]);
+        #else
+        float re = 0, im = 0;
+        for (size_t i = 0; i < num_floats; i += 2){
+            re += x[i + 0]*taps[i + 0];
+            im += x[i + 1]*taps[i + 1];
+        }
+        return sample_type(re, im);
+        #endif
+    }
+
+    const double _in_rate;
+    const size_t _num_taps; //per phase
+    size_t _interp, _decim;
+    std::vector<float> _taps; //per phase, reversed, each tap twice
+    std::vector<sample_type> _buff; //history then input
+    size_t _read_index, _write_index, _phase;
+};
+
+//! Set the resampler of a packet handler under the handler's lock
+template <typename handler_type>
+resampler_config_t set_resampler_locked(handler_type *handler, const resampler_config_t &config){
+    boost::mutex::scoped_lock lock = handler->get_scoped_lock();
+    return handler->set_resampler(config);
+}
+
+/*!
+ * Publish the resampler settings of a packet handler
+ * as the property path/rate/resampler, initially off.
+ * A set returns the config with the actual host rate.
+ * \param tree the property tree
+ * \param path the dsp path, such as /mboards/0/rx_dsps/0
+ * \param handler the packet handler that streams the dsp
+ */
+template <typename handler_type>
+void publish_resampler(property_tree::sptr tree, const fs_path &path, handler_type &handler){
+    tree->create<resampler_config_t>(path / "rate" / "resampler")
+        .coerce(boost::bind(&set_resampler_locked<handler_type>, &handler, _1))
+        .set(resampler_config_t());
+}
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_POLYPHASE_RESAMPLER_HPP */
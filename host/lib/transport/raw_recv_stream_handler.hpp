@@ -0,0 +1,379 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_RAW_RECV_STREAM_HANDLER_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_RAW_RECV_STREAM_HANDLER_HPP
+
+#include "polyphase_resampler.hpp"
+#include <uhd/config.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/device.hpp>
+#include <uhd/utils/trace.hpp>
+#include <uhd/types/io_type.hpp>
+#include <uhd/types/otw_type.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/foreach.hpp>
+#include <boost/function.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace uhd{ namespace transport{ namespace sph{
+
+/***********************************************************************
+ * Raw receive stream handler:
+ * Receives a continuous stream of samples without packet headers,
+ * such as the usb transfers of the usrp1. There is no per-packet
+ * sequence, timestamp, or alignment bookkeeping: each call converts
+ * whole transfers in as few converter calls as the buffers allow.
+ * The stream carries no time, the caller fills in the time spec.
+ * The transfers hold whole items (all channels of one sample time).
+ **********************************************************************/
+class raw_recv_stream_handler{
+public:
+    typedef boost::function<managed_recv_buffer::sptr(double)> get_buff_type;
+
+    raw_recv_stream_handler(void):
+        _single_owner(false),
+        _bytes_per_item(0),
+        _samp_rate(1.0),
+        _offset_bytes(0),
+        _fragment_offset(0)
+    {
+        _io_buffs.resize(1);
+        this->set_scale_factor(1/32767.);
+    }
+
+    //! Set the rate of samples per second
+    void set_samp_rate(const double rate){
+        _samp_rate = rate;
+        this->update_resamplers();
+    }
+
+    /*!
+     * Resample the received samples on the host.
+     * Same as the recv packet handler: complex float only,
+     * and the recv view path hands out transfers at the sample rate.
+     * \param config the resampler settings (a rate of zero for off)
+     * \return the config with the actual host rate
+     */
+    resampler_config_t set_resampler(const resampler_config_t &config){
+        _resampler_config = config;
+        this->update_resamplers();
+        resampler_config_t actual = config;
+        if (not _resamplers.empty()) actual.rate = _resamplers.front()->get_out_rate();
+        return actual;
+    }
+
+    //! Set the function to get the next transfer
+    void set_xport_get_buff(const get_buff_type &get_buff){
+        _get_buff = get_buff;
+        _buff.reset();
+    }
+
+    /*!
+     * Setup the conversion functions.
+     * \param otw_type the channel data type
+     * \param width the channels interleaved in the stream
+     */
+    void set_converter(const uhd::otw_type_t &otw_type, const size_t width = 1){
+        _io_buffs.resize(width);
+        _bytes_per_item = otw_type.get_sample_size();
+        _otw_type = otw_type;
+        this->update_converters();
+        this->update_resamplers();
+    }
+
+    //! Set the scale factor used in float conversion
+    void set_scale_factor(const double scale_factor){
+        _scale_factor = scale_factor;
+        if (_bytes_per_item != 0) this->update_converters();
+    }
+
+    //! Get a scoped lock object for this instance, only the owner may reconfigure a single owner handler
+    boost::mutex::scoped_lock get_scoped_lock(void){
+        _mutex.lock();
+        if (_single_owner and _owner_id != boost::thread::id() and _owner_id != boost::this_thread::get_id()){
+            _mutex.unlock();
+            throw uhd::runtime_error("single owner: reconfiguration from a thread other than the streaming thread");
+        }
+        return boost::mutex::scoped_lock(_mutex, boost::adopt_lock);
+    }
+
+    //! Declare that a single thread makes all of the fast path calls
+    void set_single_owner(const bool single_owner){
+        _single_owner = single_owner;
+        _owner_id = boost::thread::id();
+    }
+
+    /*******************************************************************
+     * Receive:
+     * One packet mode converts what is left of the current transfer,
+     * full buffer mode converts transfers until the buffers are full.
+     ******************************************************************/
+    UHD_INLINE size_t recv(
+        const uhd::device::recv_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t &metadata,
+        const uhd::io_type_t &io_type,
+        uhd::device::recv_mode_t recv_mode,
+        double timeout
+    ){
+        UHD_TRACE_SCOPE("recv");
+        boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+        this->lock_fast_path(lock);
+        if (recv_mode != uhd::device::RECV_MODE_ONE_PACKET and recv_mode != uhd::device::RECV_MODE_FULL_BUFF){
+            throw uhd::value_error("unknown recv mode");
+        }
+
+        init_metadata(metadata);
+        if (not _resamplers.empty()) return recv_resampled(
+            buffs, nsamps_per_buff, metadata, io_type, recv_mode, timeout
+        );
+
+        size_t accum_num_samps = 0;
+        while (accum_num_samps < nsamps_per_buff){
+            const size_t num_samps = recv_chunk(
+                buffs, nsamps_per_buff - accum_num_samps, metadata,
+                io_type, timeout, accum_num_samps*io_type.size
+            );
+            if (num_samps == 0) break; //timeout, return what was received
+            accum_num_samps += num_samps;
+            if (recv_mode == uhd::device::RECV_MODE_ONE_PACKET) break;
+        }
+        if (accum_num_samps == 0) metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+        metadata.more_fragments = _buff.get() != NULL;
+        return accum_num_samps;
+    }
+
+    /*******************************************************************
+     * Receive view:
+     * Hand out the rest of the current transfer without converting it.
+     ******************************************************************/
+    UHD_INLINE size_t recv_view(uhd::device::recv_view_t &view, double timeout){
+        boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+        this->lock_fast_path(lock);
+        view.release();
+        init_metadata(view.metadata);
+        view.item_size = _bytes_per_item;
+        view.otw_type = _otw_type;
+
+        if (not get_transfer(view.metadata, timeout)){
+            view.metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+
+        //move the transfer into the view, the remainder is consumed
+        view.nsamps = (_buff->size() - _offset_bytes)/_bytes_per_item;
+        view.payloads.push_back(_buff->cast<const char *>() + _offset_bytes);
+        view.frames.push_back(_buff);
+        _buff.reset();
+        return view.nsamps;
+    }
+
+private:
+    //! Lock the per-call mutex unless a single thread owns the calls
+    UHD_INLINE void lock_fast_path(boost::mutex::scoped_lock &lock){
+        if (not _single_owner){
+            lock.lock();
+            return;
+        }
+        if (_owner_id != boost::this_thread::get_id()) this->claim_owner();
+    }
+
+    //! Make the calling thread the owner under the mutex, or throw when there is one
+    void claim_owner(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        UHD_ASSERT_THROW(_owner_id == boost::thread::id());
+        _owner_id = boost::this_thread::get_id();
+    }
+
+    boost::mutex _mutex;
+    bool _single_owner;
+    boost::thread::id _owner_id;
+    get_buff_type _get_buff;
+    std::vector<void *> _io_buffs; //used in conversion
+    size_t _bytes_per_item; //used in conversion, per channel
+    std::vector<uhd::convert::plan_t> _converters; //used in conversion
+    double _scale_factor;
+    uhd::otw_type_t _otw_type;
+    double _samp_rate;
+    resampler_config_t _resampler_config;
+    std::vector<polyphase_resampler::sptr> _resamplers; //one per io buffer
+    std::vector<void *> _resampler_buffs; //the resamplers input buffers
+
+    //the current transfer and how much of it was consumed
+    managed_recv_buffer::sptr _buff;
+    size_t _offset_bytes;
+    size_t _fragment_offset;
+
+    //! Rebuild the resamplers for the rates and the channel layout
+    void update_resamplers(void){
+        _resamplers.clear();
+        if (_resampler_config.rate == 0) return;
+        for (size_t i = 0; i < _io_buffs.size(); i++){
+            _resamplers.push_back(polyphase_resampler::make(
+                _samp_rate, _resampler_config.rate,
+                _resampler_config.taps_per_phase, _resampler_config.max_phases
+            ));
+        }
+        _resampler_buffs.resize(_io_buffs.size());
+    }
+
+    //! Resolve the conversion plans for the otw type and scale factor
+    void update_converters(void){
+        _converters.assign(128, uhd::convert::plan_t());
+        for (size_t io_type = 0; io_type < _converters.size(); io_type++){
+            try{
+                _converters[io_type] = uhd::convert::plan_t(uhd::convert::get_converter_otw_to_cpu(
+                    io_type_t::tid_t(io_type), _otw_type, 1, _io_buffs.size()
+                ), 1, _io_buffs.size(), _scale_factor);
+            }catch(const uhd::value_error &){} //we expect this, not all io_types valid...
+        }
+    }
+
+    //! A headerless stream has only the defaults to report
+    static UHD_INLINE void init_metadata(rx_metadata_t &metadata){
+        metadata.has_time_spec = false;
+        metadata.time_spec = time_spec_t(0.0);
+        metadata.more_fragments = false;
+        metadata.fragment_offset = 0;
+        metadata.start_of_burst = false;
+        metadata.end_of_burst = false;
+        metadata.error_code = rx_metadata_t::ERROR_CODE_NONE;
+        metadata.num_samps_lost = 0;
+        metadata.has_recv_timestamp = false;
+    }
+
+    /*!
+     * Hold a transfer with at least one whole item left.
+     * The first transfer of a call sets the fragment and receive time.
+     * \return false on timeout
+     */
+    UHD_INLINE bool get_transfer(rx_metadata_t &metadata, double timeout){
+        const size_t item_bytes = _bytes_per_item*_io_buffs.size();
+        while (_buff.get() == NULL or _buff->size() - _offset_bytes < item_bytes){
+            _buff = _get_buff(timeout);
+            if (_buff.get() == NULL) return false;
+            _offset_bytes = 0;
+            _fragment_offset = 0;
+        }
+        metadata.fragment_offset = _fragment_offset;
+        metadata.has_recv_timestamp = _buff->get_recv_timestamp(metadata.recv_timestamp);
+        return true;
+    }
+
+    /*!
+     * Convert the next chunk of the stream in one converter call:
+     * the rest of the held transfer, or as much as the buffers take.
+     * \return the samples per buffer, or 0 on timeout
+     */
+    UHD_INLINE size_t recv_chunk(
+        const uhd::device::recv_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t &metadata,
+        const uhd::io_type_t &io_type,
+        double timeout,
+        const size_t buffer_offset_bytes
+    ){
+        //only the first transfer of a call fills in the metadata
+        rx_metadata_t chunk_metadata;
+        if (not get_transfer((buffer_offset_bytes == 0)? metadata : chunk_metadata, timeout)) return 0;
+
+        const size_t item_bytes = _bytes_per_item*_io_buffs.size();
+        const size_t nsamps = std::min(nsamps_per_buff, (_buff->size() - _offset_bytes)/item_bytes);
+        for (size_t i = 0; i < _io_buffs.size(); i++){
+            _io_buffs[i] = reinterpret_cast<char *>(buffs[i]) + buffer_offset_bytes;
+        }
+
+        {
+            UHD_TRACE_SCOPE("recv_convert");
+            const void *input = _buff->cast<const char *>() + _offset_bytes;
+            _converters[io_type.tid](&input, &_io_buffs.front(), nsamps);
+        }
+
+        //release the transfer once its last whole item is consumed
+        _offset_bytes += nsamps*item_bytes;
+        _fragment_offset += nsamps*_io_buffs.size();
+        if (_buff->size() - _offset_bytes < item_bytes) _buff.reset();
+        return nsamps;
+    }
+
+    /*******************************************************************
+     * Receive through the resamplers:
+     * Drain the outputs that the buffered input allows,
+     * then convert the next chunk in place into the resamplers.
+     ******************************************************************/
+    UHD_INLINE size_t recv_resampled(
+        const uhd::device::recv_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t &metadata,
+        const uhd::io_type_t &io_type,
+        uhd::device::recv_mode_t recv_mode,
+        double timeout
+    ){
+        typedef polyphase_resampler::sample_type sample_type;
+        if (io_type.tid != io_type_t::COMPLEX_FLOAT32) throw uhd::value_error(
+            "raw recv stream handler: the host resampler needs complex float samples"
+        );
+        if (buffs.size() != _resamplers.size()) throw uhd::value_error(
+            "raw recv stream handler: one buffer per channel needed to resample"
+        );
+
+        size_t accum_num_samps = 0;
+        rx_metadata_t chunk_metadata;
+        while (true){
+            //all channels hold the same input, so they output the same number
+            size_t num_samps = 0;
+            for (size_t i = 0; i < _resamplers.size(); i++){
+                num_samps = _resamplers[i]->get_output(
+                    reinterpret_cast<sample_type *>(buffs[i]) + accum_num_samps,
+                    nsamps_per_buff - accum_num_samps
+                );
+            }
+            accum_num_samps += num_samps;
+            if (accum_num_samps == nsamps_per_buff) break;
+            if (accum_num_samps != 0 and recv_mode == uhd::device::RECV_MODE_ONE_PACKET) break;
+
+            //convert the next chunk into the resamplers input
+            for (size_t i = 0; i < _resamplers.size(); i++){
+                _resampler_buffs[i] = _resamplers[i]->get_input_buff();
+            }
+            const size_t num_input = recv_chunk(
+                _resampler_buffs, _resamplers.front()->get_input_space(),
+                chunk_metadata, io_type, timeout, 0
+            );
+            if (num_input == 0){
+                if (accum_num_samps == 0) metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+                break;
+            }
+            if (not metadata.has_recv_timestamp){
+                metadata.has_recv_timestamp = chunk_metadata.has_recv_timestamp;
+                metadata.recv_timestamp = chunk_metadata.recv_timestamp;
+            }
+            BOOST_FOREACH(polyphase_resampler::sptr &resampler, _resamplers) resampler->commit_input(num_input);
+        }
+        return accum_num_samps;
+    }
+};
+
+}}} //namespace
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_RAW_RECV_STREAM_HANDLER_HPP */
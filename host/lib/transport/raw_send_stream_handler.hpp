@@ -0,0 +1,421 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_RAW_SEND_STREAM_HANDLER_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_RAW_SEND_STREAM_HANDLER_HPP
+
+#include "polyphase_resampler.hpp"
+#include <uhd/config.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/device.hpp>
+#include <uhd/utils/trace.hpp>
+#include <uhd/types/io_type.hpp>
+#include <uhd/types/otw_type.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/foreach.hpp>
+#include <boost/function.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace uhd{ namespace transport{ namespace sph{
+
+/***********************************************************************
+ * Raw send stream handler:
+ * Sends a continuous stream of samples without packet headers,
+ * such as the usb transfers of the usrp1. The samples are converted
+ * in place into the held transport frame, which is only committed
+ * once it is full, lands on the alignment, or is flushed.
+ * So a send of any length never copies the remainder to the next frame.
+ * A partly filled frame waits for the next send or for flush(),
+ * which pads it out to the alignment with zeros.
+ **********************************************************************/
+class raw_send_stream_handler{
+public:
+    typedef boost::function<managed_send_buffer::sptr(double)> get_buff_type;
+
+    raw_send_stream_handler(void):
+        _bytes_per_item(0),
+        _max_samples_per_packet(0),
+        _samp_rate(1.0),
+        _alignment(1),
+        _offset_bytes(0)
+    {
+        _io_buffs.resize(1);
+        this->set_scale_factor(32767.);
+    }
+
+    //! Set the rate of samples per second
+    void set_samp_rate(const double rate){
+        _samp_rate = rate;
+        this->update_resamplers();
+    }
+
+    /*!
+     * Resample the samples to send on the host.
+     * Same as the send packet handler: complex float only,
+     * and the send view path takes samples at the sample rate.
+     * \param config the resampler settings (a rate of zero for off)
+     * \return the config with the actual host rate
+     */
+    resampler_config_t set_resampler(const resampler_config_t &config){
+        _resampler_config = config;
+        this->update_resamplers();
+        resampler_config_t actual = config;
+        if (not _resamplers.empty()){
+            const polyphase_resampler &resampler = *_resamplers.front();
+            actual.rate = _samp_rate*resampler.get_decim()/resampler.get_interp();
+        }
+        return actual;
+    }
+
+    //! Set the function to get the next frame, the held frame is dropped
+    void set_xport_get_buff(const get_buff_type &get_buff){
+        _get_buff = get_buff;
+        _buff.reset();
+    }
+
+    /*!
+     * Set the alignment of committed lengths.
+     * The frame size must be a multiple of the alignment.
+     * \param num_bytes the commit granularity in bytes
+     */
+    void set_alignment(const size_t num_bytes){
+        _alignment = num_bytes;
+    }
+
+    /*!
+     * Setup the conversion functions.
+     * \param otw_type the channel data type
+     * \param width the channels interleaved in the stream
+     */
+    void set_converter(const uhd::otw_type_t &otw_type, const size_t width = 1){
+        _io_buffs.resize(width);
+        _bytes_per_item = otw_type.get_sample_size();
+        _otw_type = otw_type;
+        this->update_converters();
+        this->update_resamplers();
+    }
+
+    //! Set the maximum number of samples in one packet mode and in a view
+    void set_max_samples_per_packet(const size_t num_samps){
+        _max_samples_per_packet = num_samps;
+    }
+
+    //! Set the scale factor used in float conversion
+    void set_scale_factor(const double scale_factor){
+        _scale_factor = scale_factor;
+        if (_bytes_per_item != 0) this->update_converters();
+    }
+
+    //! Get a scoped lock object for this instance
+    boost::mutex::scoped_lock get_scoped_lock(void){
+        return boost::mutex::scoped_lock(_mutex);
+    }
+
+    /*******************************************************************
+     * Send:
+     * One packet mode converts up to the max samples per packet,
+     * full buffer mode converts the whole buffer across the frames.
+     * On a timeout, the samples sent so far are returned.
+     ******************************************************************/
+    UHD_INLINE size_t send(
+        const uhd::device::send_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata,
+        const uhd::io_type_t &io_type,
+        uhd::device::send_mode_t send_mode,
+        double timeout
+    ){
+        UHD_TRACE_SCOPE("send");
+        boost::mutex::scoped_lock lock(_mutex);
+        if (send_mode != uhd::device::SEND_MODE_ONE_PACKET and send_mode != uhd::device::SEND_MODE_FULL_BUFF){
+            throw uhd::value_error("unknown send mode");
+        }
+
+        if (not _resamplers.empty()) return send_resampled(
+            buffs, nsamps_per_buff, metadata, io_type, timeout
+        );
+        if (send_mode == uhd::device::SEND_MODE_ONE_PACKET){
+            return send_samps(buffs, std::min(nsamps_per_buff, _max_samples_per_packet), io_type, timeout);
+        }
+        return send_samps(buffs, nsamps_per_buff, io_type, timeout);
+    }
+
+    /*******************************************************************
+     * Send view:
+     * Hand out the rest of the held frame to be written in place.
+     * There is no header, the samples follow the previous ones.
+     ******************************************************************/
+    UHD_INLINE size_t get_send_view(uhd::device::send_view_t &view, double timeout){
+        boost::mutex::scoped_lock lock(_mutex);
+        view.release();
+        if (not get_frame(timeout)) return 0; //timeout
+
+        const size_t item_bytes = _bytes_per_item*_io_buffs.size();
+        const size_t nsamps = std::min(_max_samples_per_packet, (_buff->size() - _offset_bytes)/item_bytes);
+        view.payloads.push_back(_buff->cast<char *>() + _offset_bytes);
+        view.frames.push_back(_buff);
+        view.num_header_words32 = 0;
+        view.item_size = _bytes_per_item;
+        view.otw_type = _otw_type;
+        view.max_nsamps = nsamps*_io_buffs.size();
+        return view.max_nsamps;
+    }
+
+    UHD_INLINE size_t commit_send_view(uhd::device::send_view_t &view, const size_t nsamps){
+        boost::mutex::scoped_lock lock(_mutex);
+        if (view.frames.size() != 1 or view.frames.front() != _buff) return 0; //nothing acquired
+        if (nsamps > view.max_nsamps) throw uhd::value_error(
+            "send view: more samples than the payload capacity"
+        );
+        if (nsamps % _io_buffs.size() != 0) throw uhd::value_error(
+            "send view: the samples must fill whole items across the channels"
+        );
+
+        //the frame stays held here, the view only borrowed it
+        view.release();
+        _offset_bytes += nsamps*_bytes_per_item;
+        this->commit_frame(false);
+        return nsamps;
+    }
+
+    /*!
+     * Pad the held frame with zeros to the alignment and commit it.
+     * At least one alignment of zeros is sent, so the device idles on zeros.
+     * Safe to call from another thread than the one that sends.
+     * \param timeout the timeout in seconds to wait for a frame
+     */
+    void flush(double timeout){
+        boost::mutex::scoped_lock lock(_mutex);
+        if (not get_frame(timeout)) return; //timeout
+
+        size_t num_pad = (_alignment - _offset_bytes % _alignment) % _alignment;
+        if (num_pad == 0) num_pad = _alignment;
+        num_pad = std::min(num_pad, _buff->size() - _offset_bytes);
+        std::memset(_buff->cast<char *>() + _offset_bytes, 0, num_pad);
+        _buff->commit(_offset_bytes + num_pad);
+        _buff.reset();
+    }
+
+private:
+    boost::mutex _mutex;
+    get_buff_type _get_buff;
+    std::vector<const void *> _io_buffs; //used in conversion
+    size_t _bytes_per_item; //used in conversion, per channel
+    std::vector<uhd::convert::plan_t> _converters; //used in conversion
+    double _scale_factor;
+    uhd::otw_type_t _otw_type;
+    size_t _max_samples_per_packet;
+    double _samp_rate;
+    resampler_config_t _resampler_config;
+    std::vector<polyphase_resampler::sptr> _resamplers; //one per io buffer
+    std::vector<std::vector<polyphase_resampler::sample_type> > _resampler_outs;
+    std::vector<const void *> _resampler_out_ptrs;
+    size_t _resampler_fill; //outputs waiting in the output buffers
+
+    //the held frame and how much of it was filled
+    size_t _alignment;
+    managed_send_buffer::sptr _buff;
+    size_t _offset_bytes;
+
+    //! Rebuild the resamplers for the rates and the channel layout
+    void update_resamplers(void){
+        _resamplers.clear();
+        if (_resampler_config.rate == 0) return;
+        _resampler_outs.resize(_io_buffs.size());
+        _resampler_out_ptrs.resize(_io_buffs.size());
+        for (size_t i = 0; i < _io_buffs.size(); i++){
+            _resamplers.push_back(polyphase_resampler::make(
+                _resampler_config.rate, _samp_rate,
+                _resampler_config.taps_per_phase, _resampler_config.max_phases
+            ));
+            _resampler_outs[i].resize(4096);
+            _resampler_out_ptrs[i] = &_resampler_outs[i].front();
+        }
+        this->reset_resamplers();
+    }
+
+    //! Start a new stream in the resamplers
+    void reset_resamplers(void){
+        BOOST_FOREACH(polyphase_resampler::sptr &resampler, _resamplers) resampler->reset();
+        _resampler_fill = 0;
+    }
+
+    //! Resolve the conversion plans for the otw type and scale factor
+    void update_converters(void){
+        _converters.assign(128, uhd::convert::plan_t());
+        for (size_t io_type = 0; io_type < _converters.size(); io_type++){
+            try{
+                _converters[io_type] = uhd::convert::plan_t(uhd::convert::get_converter_cpu_to_otw(
+                    io_type_t::tid_t(io_type), _otw_type, _io_buffs.size(), 1
+                ), _io_buffs.size(), 1, _scale_factor);
+            }catch(const uhd::value_error &){} //we expect this, not all io_types valid...
+        }
+    }
+
+    /*!
+     * Hold a frame with room for at least one whole item.
+     * \return false on timeout
+     */
+    UHD_INLINE bool get_frame(double timeout){
+        if (_buff.get() != NULL) return true;
+        _buff = _get_buff(timeout);
+        _offset_bytes = 0;
+        return _buff.get() != NULL;
+    }
+
+    /*!
+     * Commit the held frame when it is full,
+     * or at the end of a call when the fill lands on the alignment.
+     * Otherwise the frame stays held, and nothing is copied.
+     */
+    UHD_INLINE void commit_frame(const bool full_only){
+        const size_t item_bytes = _bytes_per_item*_io_buffs.size();
+        const bool full = _buff->size() - _offset_bytes < item_bytes;
+        const bool aligned = _offset_bytes != 0 and _offset_bytes % _alignment == 0;
+        if (not full and (full_only or not aligned)) return;
+        _buff->commit(_offset_bytes);
+        _buff.reset();
+    }
+
+    /*!
+     * Convert the samples into the frames, one converter call per frame.
+     * \return the samples per buffer sent, short on timeout
+     */
+    UHD_INLINE size_t send_samps(
+        const uhd::device::send_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::io_type_t &io_type,
+        double timeout
+    ){
+        const size_t item_bytes = _bytes_per_item*_io_buffs.size();
+        size_t total_num_samps_sent = 0;
+        while (total_num_samps_sent < nsamps_per_buff){
+            if (not get_frame(timeout)) break; //timeout, return what was sent
+
+            const size_t nsamps = std::min(
+                nsamps_per_buff - total_num_samps_sent,
+                (_buff->size() - _offset_bytes)/item_bytes
+            );
+            for (size_t i = 0; i < _io_buffs.size(); i++){
+                _io_buffs[i] = reinterpret_cast<const char *>(buffs[i]) + total_num_samps_sent*io_type.size;
+            }
+
+            {
+                UHD_TRACE_SCOPE("send_convert");
+                void *output = _buff->cast<char *>() + _offset_bytes;
+                _converters[io_type.tid](&_io_buffs.front(), &output, nsamps);
+            }
+
+            _offset_bytes += nsamps*item_bytes;
+            total_num_samps_sent += nsamps;
+            this->commit_frame(total_num_samps_sent != nsamps_per_buff);
+        }
+        return total_num_samps_sent;
+    }
+
+    /*******************************************************************
+     * Send through the resamplers:
+     * Copy the samples into the resamplers input,
+     * then send the outputs whenever the output buffers fill.
+     * The end of a burst flushes the filter tail with zeros.
+     * On a timeout, the buffered samples are dropped.
+     ******************************************************************/
+    UHD_INLINE size_t send_resampled(
+        const uhd::device::send_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata,
+        const uhd::io_type_t &io_type,
+        double timeout
+    ){
+        typedef polyphase_resampler::sample_type sample_type;
+        if (io_type.tid != io_type_t::COMPLEX_FLOAT32) throw uhd::value_error(
+            "raw send stream handler: the host resampler needs complex float samples"
+        );
+        if (buffs.size() != _resamplers.size()) throw uhd::value_error(
+            "raw send stream handler: one buffer per channel needed to resample"
+        );
+
+        //a burst starts a new stream
+        if (metadata.start_of_burst) this->reset_resamplers();
+
+        size_t num_consumed = 0;
+        while (true){
+            if (not this->send_resampler_outputs(timeout)) return num_consumed;
+            if (num_consumed == nsamps_per_buff) break;
+            const size_t num_samps = std::min(nsamps_per_buff - num_consumed, _resamplers.front()->get_input_space());
+            for (size_t i = 0; i < _resamplers.size(); i++){
+                const sample_type *in = reinterpret_cast<const sample_type *>(buffs[i]) + num_consumed;
+                std::copy(in, in + num_samps, _resamplers[i]->get_input_buff());
+                _resamplers[i]->commit_input(num_samps);
+            }
+            num_consumed += num_samps;
+        }
+
+        //push zeros through to get the outputs of the last samples
+        if (metadata.end_of_burst){
+            const size_t num_samps = size_t(2*_resamplers.front()->get_delay()) + 1;
+            BOOST_FOREACH(polyphase_resampler::sptr &resampler, _resamplers){
+                sample_type *in = resampler->get_input_buff();
+                std::fill(in, in + num_samps, sample_type());
+                resampler->commit_input(num_samps);
+            }
+            if (not this->send_resampler_outputs(timeout)) return num_consumed;
+        }
+
+        //send what is left now, there may be no next call
+        const bool sent = this->send_resampler_fill(timeout);
+        if (metadata.end_of_burst) this->reset_resamplers();
+        return (sent)? num_consumed : 0;
+    }
+
+    //! Resample the buffered input, send each time the outputs fill up
+    UHD_INLINE bool send_resampler_outputs(double timeout){
+        while (true){
+            size_t num_samps = 0;
+            for (size_t i = 0; i < _resamplers.size(); i++){
+                num_samps = _resamplers[i]->get_output(
+                    &_resampler_outs[i][_resampler_fill], _resampler_outs[i].size() - _resampler_fill
+                );
+            }
+            _resampler_fill += num_samps;
+            if (_resampler_fill < _resampler_outs.front().size()) return true;
+            if (not this->send_resampler_fill(timeout)) return false;
+        }
+    }
+
+    //! Send the outputs filled so far
+    UHD_INLINE bool send_resampler_fill(double timeout){
+        const size_t num_sent = send_samps(
+            _resampler_out_ptrs, _resampler_fill, io_type_t::COMPLEX_FLOAT32, timeout
+        );
+        if (num_sent != _resampler_fill){
+            this->reset_resamplers();
+            return false;
+        }
+        _resampler_fill = 0;
+        return true;
+    }
+};
+
+}}} //namespace
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_RAW_SEND_STREAM_HANDLER_HPP */
@@ -0,0 +1,257 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <uhd/transport/shm_fanout.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/exception.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <vector>
+#include <new>
+
+using namespace uhd;
+using namespace uhd::transport;
+namespace ipc = boost::interprocess;
+
+/***********************************************************************
+ * Shared memory layout:
+ * One header, followed by num_frames slots of slot_size bytes.
+ * Each slot holds a slot header and then frame_size bytes of samples.
+ *
+ * A slot sequence word of zero means the writer owns the slot.
+ * Otherwise, it is the frame number tagged with the top bit,
+ * so a reader can tell which frame a slot holds (modulo 2^31).
+ **********************************************************************/
+static const boost::uint32_t shm_magic = 0x55484446; //"UHDF"
+static const size_t shm_align = 64;
+static const double poll_interval = 100e-6; //seconds
+
+struct shm_header_t{
+    atomic_uint32_t magic;
+    boost::uint32_t frame_size;
+    boost::uint32_t num_frames;
+    boost::uint32_t slot_size;
+    atomic_uint32_t write_count;
+};
+
+struct shm_slot_t{
+    atomic_uint32_t seq;
+    boost::uint32_t num_bytes;
+    rx_metadata_t metadata;
+};
+
+static UHD_INLINE size_t align_up(const size_t num_bytes){
+    return (num_bytes + shm_align - 1) & ~(shm_align - 1);
+}
+
+static UHD_INLINE boost::uint32_t frame_tag(const boost::uint32_t frame_num){
+    return frame_num | (1ul << 31);
+}
+
+static UHD_INLINE size_t header_size(void){
+    return align_up(sizeof(shm_header_t));
+}
+
+static UHD_INLINE size_t slot_header_size(void){
+    return align_up(sizeof(shm_slot_t));
+}
+
+/***********************************************************************
+ * Shared memory fan-out writer implementation
+ **********************************************************************/
+class shm_fanout_writer_impl : public shm_fanout_writer{
+public:
+    shm_fanout_writer_impl(const std::string &name, size_t frame_size, size_t num_frames):
+        _name(name), _write_count(0), _slot(NULL)
+    {
+        if (frame_size == 0 or num_frames < 2) throw uhd::value_error(
+            "shm_fanout_writer: need a non-zero frame size and at least 2 frames"
+        );
+        UHD_LOG << boost::format("Creating shm fan-out %s: %u frames of %u bytes")
+            % name % num_frames % frame_size << std::endl;
+
+        const size_t slot_size = slot_header_size() + align_up(frame_size);
+        try{
+            ipc::shared_memory_object::remove(_name.c_str());
+            _shm = ipc::shared_memory_object(ipc::create_only, _name.c_str(), ipc::read_write);
+            _shm.truncate(ipc::offset_t(header_size() + slot_size*num_frames));
+            _region = ipc::mapped_region(_shm, ipc::read_write);
+        }
+        catch(const ipc::interprocess_exception &e){
+            throw uhd::io_error(str(boost::format(
+                "shm_fanout_writer: cannot create %s: %s") % name % e.what()
+            ));
+        }
+
+        //initialize, the magic is written last to let readers attach
+        char *mem = static_cast<char *>(_region.get_address());
+        _header = new (mem) shm_header_t();
+        _header->frame_size = boost::uint32_t(frame_size);
+        _header->num_frames = boost::uint32_t(num_frames);
+        _header->slot_size = boost::uint32_t(slot_size);
+        for (size_t i = 0; i < num_frames; i++){
+            _slots.push_back(new (mem + header_size() + slot_size*i) shm_slot_t());
+        }
+        _header->magic.write(shm_magic);
+    }
+
+    ~shm_fanout_writer_impl(void){
+        ipc::shared_memory_object::remove(_name.c_str());
+    }
+
+    void *get_frame_buff(void){
+        //take ownership of the slot before the caller writes to it
+        _slot = _slots[_write_count % _slots.size()];
+        _slot->seq.write(0);
+        uhd::atomic_full_barrier(); //the slot is invalid before it is written
+        return reinterpret_cast<char *>(_slot) + slot_header_size();
+    }
+
+    void commit(size_t num_bytes, const rx_metadata_t &metadata){
+        if (_slot == NULL) throw uhd::runtime_error(
+            "shm_fanout_writer: commit without get_frame_buff"
+        );
+        _slot->num_bytes = boost::uint32_t(std::min(num_bytes, this->get_frame_size()));
+        _slot->metadata = metadata;
+        uhd::atomic_full_barrier(); //the frame is written before it is tagged
+        _slot->seq.write(frame_tag(_write_count));
+        uhd::atomic_full_barrier(); //the frame is tagged before it is counted
+        _header->write_count.write(++_write_count);
+        _slot = NULL;
+    }
+
+    size_t get_frame_size(void) const{
+        return _header->frame_size;
+    }
+
+private:
+    const std::string _name;
+    ipc::shared_memory_object _shm;
+    ipc::mapped_region _region;
+    shm_header_t *_header;
+    std::vector<shm_slot_t *> _slots;
+    boost::uint32_t _write_count;
+    shm_slot_t *_slot;
+};
+
+shm_fanout_writer::sptr shm_fanout_writer::make(
+    const std::string &name, size_t frame_size, size_t num_frames
+){
+    return sptr(new shm_fanout_writer_impl(name, frame_size, num_frames));
+}
+
+/***********************************************************************
+ * Shared memory fan-out reader implementation
+ **********************************************************************/
+class shm_fanout_reader_impl : public shm_fanout_reader{
+public:
+    shm_fanout_reader_impl(const std::string &name):
+        _num_overflows(0)
+    {
+        try{
+            _shm = ipc::shared_memory_object(ipc::open_only, name.c_str(), ipc::read_only);
+            _region = ipc::mapped_region(_shm, ipc::read_only);
+        }
+        catch(const ipc::interprocess_exception &e){
+            throw uhd::io_error(str(boost::format(
+                "shm_fanout_reader: cannot attach to %s: %s") % name % e.what()
+            ));
+        }
+
+        //the mapping is read-only, so the atomics are only ever read below
+        char *mem = static_cast<char *>(_region.get_address());
+        _header = reinterpret_cast<shm_header_t *>(mem);
+        if (_region.get_size() < header_size() or _header->magic.read() != shm_magic){
+            throw uhd::io_error(str(boost::format(
+                "shm_fanout_reader: %s is not a fan-out ring") % name
+            ));
+        }
+        for (size_t i = 0; i < _header->num_frames; i++){
+            _slots.push_back(reinterpret_cast<shm_slot_t *>(mem + header_size() + _header->slot_size*i));
+        }
+        _cursor = _header->write_count.read();
+        _last = _cursor - 1;
+    }
+
+    const void *get_frame(size_t &num_bytes, rx_metadata_t &metadata, double timeout){
+        num_bytes = 0;
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::microseconds(long(timeout*1e6));
+
+        //poll for a new frame, the writer does not signal the readers
+        boost::uint32_t write_count;
+        while ((write_count = _header->write_count.read()) == _cursor){
+            if (boost::get_system_time() > exit_time){
+                metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+                return NULL;
+            }
+            boost::this_thread::sleep(boost::posix_time::microseconds(long(poll_interval*1e6)));
+        }
+
+        //the writer may be filling the next slot, so more than num_frames - 1 back is too far
+        if (write_count - _cursor >= _slots.size()) return this->overflow(num_bytes, metadata);
+
+        shm_slot_t *slot = _slots[_cursor % _slots.size()];
+        if (slot->seq.read() != frame_tag(_cursor)) return this->overflow(num_bytes, metadata);
+        uhd::atomic_full_barrier(); //the frame is read after its tag
+        num_bytes = slot->num_bytes;
+        metadata = slot->metadata;
+        uhd::atomic_full_barrier(); //the frame is read before the tag is checked again
+        if (slot->seq.read() != frame_tag(_cursor)) return this->overflow(num_bytes, metadata);
+
+        _last = _cursor++;
+        return reinterpret_cast<const char *>(slot) + slot_header_size();
+    }
+
+    bool frame_valid(void){
+        uhd::atomic_full_barrier(); //the caller read the payload before the tag is checked again
+        return _slots[_last % _slots.size()]->seq.read() == frame_tag(_last);
+    }
+
+    size_t get_num_overflows(void) const{
+        return _num_overflows;
+    }
+
+    size_t get_frame_size(void) const{
+        return _header->frame_size;
+    }
+
+private:
+    const void *overflow(size_t &num_bytes, rx_metadata_t &metadata){
+        //skip ahead and keep half of the ring as slack to catch up
+        _cursor = _header->write_count.read() - boost::uint32_t(_slots.size()/2);
+        _num_overflows++;
+        num_bytes = 0;
+        metadata = rx_metadata_t();
+        metadata.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
+        return NULL;
+    }
+
+    ipc::shared_memory_object _shm;
+    ipc::mapped_region _region;
+    shm_header_t *_header;
+    std::vector<shm_slot_t *> _slots;
+    boost::uint32_t _cursor, _last;
+    size_t _num_overflows;
+};
+
+shm_fanout_reader::sptr shm_fanout_reader::make(const std::string &name){
+    return sptr(new shm_fanout_reader_impl(name));
+}
@@ -0,0 +1,125 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_STREAM_EVENT_COUNTERS_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_STREAM_EVENT_COUNTERS_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/msg.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <boost/bind.hpp>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * Counts the streaming error events of one dsp.
+ * The fast path records an event with an atomic increment,
+ * and the counts are read through the property tree.
+ * Recording can also print the classic fastpath character.
+ */
+class stream_event_counters : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<stream_event_counters> sptr;
+
+    enum event_t{
+        EVENT_OVERFLOW = 0,
+        EVENT_UNDERFLOW,
+        EVENT_SEQ_ERROR,
+        EVENT_LATE_COMMAND,
+        EVENT_LATE_SAMPS, //counts samples, recorded by the host (tx only)
+        EVENT_LOST_SAMPS, //counts samples, from the timestamps after an overflow (rx only)
+        NUM_EVENTS
+    };
+
+    /*!
+     * Make new event counters, all starting at zero.
+     * \param print_chars true to print O, U, and S as before
+     */
+    static sptr make(const bool print_chars = true){
+        return sptr(new stream_event_counters(print_chars));
+    }
+
+    //! Count one event and print its character when enabled
+    UHD_INLINE void record(const event_t event){
+        _counts[event].inc();
+        if (_print_chars and get_char(event) != '\0') UHD_MSG(fastpath) << get_char(event);
+    }
+
+    //! Count several events at once, such as the samples of a packet
+    UHD_INLINE void record(const event_t event, const size_t num_events){
+        boost::uint32_t count;
+        do count = _counts[event].read();
+        while (_counts[event].cas(count + boost::uint32_t(num_events), count) != count);
+    }
+
+    //! Get the number of events since construction (wraps at 32 bits)
+    size_t get_count(const event_t event){
+        return _counts[event].read();
+    }
+
+    //! Get the property name of an event
+    static const char *get_name(const event_t event){
+        switch(event){
+        case EVENT_OVERFLOW: return "overflows";
+        case EVENT_UNDERFLOW: return "underflows";
+        case EVENT_SEQ_ERROR: return "seq_errors";
+        case EVENT_LATE_COMMAND: return "late_commands";
+        case EVENT_LATE_SAMPS: return "late_samps";
+        case EVENT_LOST_SAMPS: return "lost_samps";
+        default: return "unknown";
+        }
+    }
+
+    /*!
+     * Publish the counts as read-only properties under path/events.
+     * \param tree the property tree
+     * \param path the dsp path, such as /mboards/0/rx_dsps/0
+     * \param counters the counters to read
+     */
+    static void publish(property_tree::sptr tree, const fs_path &path, sptr counters){
+        for (size_t i = 0; i < NUM_EVENTS; i++){
+            tree->create<size_t>(path / "events" / get_name(event_t(i)))
+                .publish(boost::bind(&stream_event_counters::get_count, counters, event_t(i)));
+        }
+    }
+
+private:
+    stream_event_counters(const bool print_chars):
+        _print_chars(print_chars)
+    {
+        /* NOP */
+    }
+
+    static char get_char(const event_t event){
+        switch(event){
+        case EVENT_OVERFLOW: return 'O';
+        case EVENT_UNDERFLOW: return 'U';
+        case EVENT_SEQ_ERROR: return 'S';
+        default: return '\0'; //late commands never printed a character
+        }
+    }
+
+    const bool _print_chars;
+    uhd::atomic_uint32_t _counts[NUM_EVENTS];
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_STREAM_EVENT_COUNTERS_HPP */
@@ -18,25 +18,44 @@
 #ifndef INCLUDED_LIBUHD_TRANSPORT_SUPER_RECV_PACKET_HANDLER_HPP
 #define INCLUDED_LIBUHD_TRANSPORT_SUPER_RECV_PACKET_HANDLER_HPP
 
+#include "stream_event_counters.hpp"
+#include "polyphase_resampler.hpp"
 #include <uhd/config.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/convert.hpp>
 #include <uhd/device.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/trace.hpp>
 #include <uhd/types/io_type.hpp>
 #include <uhd/types/otw_type.hpp>
 #include <uhd/types/metadata.hpp>
+#include <uhd/types/tick_time.hpp>
 #include <uhd/transport/vrt_if_packet.hpp>
 #include <uhd/transport/zero_copy.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
+#include <boost/bind.hpp>
 #include <boost/format.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <utility>
 #include <vector>
 
+//! hint the cache to pull in the memory at the address
+#if defined(__GNUC__)
+    #define SRPH_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+    #define SRPH_PREFETCH(addr)
+#endif
+
 namespace uhd{ namespace transport{ namespace sph{
 
 UHD_INLINE boost::uint32_t get_context_code(
@@ -51,6 +70,121 @@ UHD_INLINE boost::uint32_t get_context_code(
 typedef boost::function<void(void)> handle_overflow_type;
 static inline void handle_overflow_nop(void){}
 
+/***********************************************************************
+ * Receive hook:
+ * Runs the hook of the stream on the converted samples of a packet,
+ * one call per io buffer, and keeps the fewest samples that a call kept.
+ **********************************************************************/
+typedef uhd::rx_streamer::recv_hook_type recv_hook_type;
+
+static UHD_INLINE size_t run_recv_hook(
+    const recv_hook_type &hook, const size_t first_chan,
+    void *const *buffs, const size_t num_buffs,
+    const size_t nsamps, const uhd::rx_metadata_t &metadata
+){
+    size_t nsamps_kept = nsamps;
+    for (size_t i = 0; i < num_buffs; i++){
+        nsamps_kept = std::min(nsamps_kept, hook(first_chan + i, buffs[i], nsamps, metadata));
+    }
+    return nsamps_kept;
+}
+
+/***********************************************************************
+ * Conversion thread pool
+ *
+ * Runs a batch of independent conversion tasks (one per channel).
+ * The calling thread takes a share of the tasks, then joins the workers.
+ * Task i runs on thread i%(num_threads+1), thread 0 being the caller.
+ * A task with a hook runs it on its outputs while they are in cache.
+ **********************************************************************/
+class convert_thread_pool : boost::noncopyable{
+public:
+    struct task_type{
+        const uhd::convert::plan_t *converter;
+        const void *input;
+        std::vector<void *> outputs;
+        size_t nsamps;
+        const recv_hook_type *hook; //NULL for none
+        size_t first_chan;
+        const uhd::rx_metadata_t *metadata;
+        size_t nsamps_kept; //set by the hook
+    };
+
+    convert_thread_pool(const size_t num_threads):
+        _num_threads(num_threads), _generation(0), _num_pending(0), _running(true)
+    {
+        for (size_t i = 0; i < num_threads; i++){
+            _threads.create_thread(boost::bind(&convert_thread_pool::worker, this, i+1, num_threads+1));
+        }
+    }
+
+    ~convert_thread_pool(void){
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _running = false;
+        }
+        _work_cond.notify_all();
+        _threads.join_all();
+    }
+
+    //! Access the tasks to fill before run()
+    std::vector<task_type> &tasks(void){
+        return _tasks;
+    }
+
+    //! Run all tasks and return when they are complete
+    void run(void){
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _num_pending = _num_threads;
+            _generation++;
+        }
+        _work_cond.notify_all();
+
+        this->run_share(0, _num_threads+1);
+
+        boost::mutex::scoped_lock lock(_mutex);
+        while (_num_pending != 0) _done_cond.wait(lock);
+    }
+
+private:
+    std::vector<task_type> _tasks;
+    size_t _num_threads;
+    boost::thread_group _threads;
+    boost::mutex _mutex;
+    boost::condition_variable _work_cond, _done_cond;
+    size_t _generation, _num_pending;
+    bool _running;
+
+    UHD_INLINE void run_share(const size_t index, const size_t stride){
+        for (size_t i = index; i < _tasks.size(); i += stride){
+            task_type &task = _tasks[i];
+            (*task.converter)(&task.input, &task.outputs.front(), task.nsamps);
+            if (task.hook != NULL) task.nsamps_kept = run_recv_hook(
+                *task.hook, task.first_chan, &task.outputs.front(), task.outputs.size(), task.nsamps, *task.metadata
+            );
+        }
+    }
+
+    void worker(const size_t index, const size_t stride){
+        uhd::set_thread_priority_safe();
+        size_t generation = 0;
+        while (true){
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                while (_running and _generation == generation) _work_cond.wait(lock);
+                if (not _running) return;
+                generation = _generation;
+            }
+            this->run_share(index, stride);
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                if (--_num_pending == 0) _done_cond.notify_one();
+            }
+        }
+    }
+};
+
 /***********************************************************************
  * Super receive packet handler
  *
@@ -70,11 +204,21 @@ public:
      */
     recv_packet_handler(const size_t size = 1):
         _queue_error_for_next_call(false),
+        _single_owner(false),
+        _single_io_type(false),
+        _io_tid(io_type_t::CUSTOM_TYPE),
+        _lookahead(false),
+        _realign_time_valid(false),
+        _gap_pending(false),
+        _next_time_valid(false),
+        _rate_change_pending(false),
         _buffers_infos_index(0)
     {
         this->resize(size);
         set_alignment_failure_threshold(1000);
         this->set_scale_factor(1/32767.);
+        _tick_rate = _samp_rate = 1.0;
+        this->update_ticks_per_samp();
     }
 
     //! Resize the number of transport channels
@@ -83,6 +227,9 @@ public:
         _props.resize(size);
         //re-initialize all buffers infos by re-creating the vector
         _buffers_infos = std::vector<buffers_info_type>(4, buffers_info_type(size));
+        _realign_time_valid = false;
+        _gap_pending = _next_time_valid = false;
+        this->update_resamplers();
     }
 
     //! Get the channel width of this handler
@@ -108,11 +255,50 @@ public:
     //! Set the rate of ticks per second
     void set_tick_rate(const double rate){
         _tick_rate = rate;
+        this->update_ticks_per_samp();
     }
 
     //! Set the rate of samples per second
     void set_samp_rate(const double rate){
-        _samp_rate = rate;
+        _rate_change_pending = false;
+        this->apply_samp_rate(rate);
+        this->update_resamplers();
+    }
+
+    /*!
+     * Set the rate of samples per second at a device time,
+     * for a dsp rate change made with a command time while streaming.
+     * The rate takes effect at the first packet at or after the time,
+     * and the receive call that starts with that packet sets
+     * has_rate_change in its metadata. A receive never returns
+     * samples of both rates: a full buffer receive ends at the change.
+     * With the host resampler, the resampler restarts at the change.
+     * \param time the device time of the first sample at the new rate
+     * \param rate the new rate of samples per second
+     * \param scale_factor the new scale factor, zero to keep the current one
+     */
+    void set_samp_rate_at(const time_spec_t &time, const double rate, const double scale_factor = 0.0){
+        const tick_time_t tick_time(time, _tick_rate);
+        _rate_change_time = packet_time_type(boost::uint64_t(tick_time.get_full_secs()), boost::uint64_t(tick_time.get_ticks()));
+        _rate_change_rate = rate;
+        _rate_change_scale = scale_factor;
+        _rate_change_pending = true;
+    }
+
+    /*!
+     * Resample the received samples on the host.
+     * The samples are resampled from the sample rate to the config rate
+     * after conversion, for each channel, in complex float only.
+     * The recv view path hands out frames at the sample rate.
+     * \param config the resampler settings (a rate of zero for off)
+     * \return the config with the actual host rate
+     */
+    resampler_config_t set_resampler(const resampler_config_t &config){
+        _resampler_config = config;
+        this->update_resamplers();
+        resampler_config_t actual = config;
+        if (not _resamplers.empty()) actual.rate = _resamplers.front()->get_out_rate();
+        return actual;
     }
 
     /*!
@@ -122,26 +308,68 @@ public:
      */
     void set_xport_chan_get_buff(const size_t xport_chan, const get_buff_type &get_buff){
         _props.at(xport_chan).get_buff = get_buff;
+        _props.at(xport_chan).next_buff = managed_recv_buffer::sptr();
+    }
+
+    /*!
+     * Enable a lookahead of one frame per transport channel.
+     * Once the buffers are aligned, the next frames are polled for
+     * and their headers and first payload lines are prefetched
+     * while the current frames are copy-converted.
+     * \param enb true to enable the lookahead
+     */
+    void set_lookahead(const bool enb){
+        _lookahead = enb;
+    }
+
+    /*!
+     * Release the frame held by the lookahead of a transport channel.
+     * Call this when a stream command is issued to the channel,
+     * so a frame polled before a stop or a re-issue is not returned after it.
+     * \param xport_chan which transport channel
+     */
+    void drop_lookahead(const size_t xport_chan){
+        _props.at(xport_chan).next_buff = managed_recv_buffer::sptr();
     }
 
     /*!
      * Setup the conversion functions (homogeneous across transports).
-     * Here, we load a table of converters for all possible io types.
+     * Here, we load a table of conversion plans for all possible io types.
      * This makes the converter look-up an O(1) operation.
      * \param otw_type the channel data type
      * \param width the streams per channel (usually 1)
      */
     void set_converter(const uhd::otw_type_t &otw_type, const size_t width = 1){
         _io_buffs.resize(width);
-        _converters.resize(128);
-        for (size_t io_type = 0; io_type < _converters.size(); io_type++){
-            try{
-                _converters[io_type] = uhd::convert::get_converter_otw_to_cpu(
-                    io_type_t::tid_t(io_type), otw_type, 1, width
-                );
-            }catch(const uhd::value_error &){} //we expect this, not all io_types valid...
-        }
         _bytes_per_item = otw_type.get_sample_size();
+        _otw_type = otw_type;
+        this->update_converters();
+        this->update_resamplers();
+    }
+
+    /*!
+     * Resolve the conversions for one io type only.
+     * A handler made for one stream needs a single conversion plan,
+     * and an otw format without a converter fails in set_converter().
+     * \param io_type the io type of the stream
+     */
+    void set_io_type(const uhd::io_type_t &io_type){
+        _single_io_type = true;
+        _io_tid = io_type.tid;
+        if (not _converters.empty()) this->update_converters();
+    }
+
+    /*!
+     * Set the correction applied when converting to fc32 for a transport channel.
+     * The DC offset and IQ matrix are applied inside the converter,
+     * so the samples are only touched once in memory.
+     * An identity correction restores the plain converter.
+     * \param xport_chan the transport channel index
+     * \param correction the dc offset and iq correction
+     */
+    void set_correction(const size_t xport_chan, const uhd::convert::correction_t &correction){
+        _props.at(xport_chan).correction = correction;
+        if (not _converters.empty()) this->update_corrected_converter(xport_chan);
     }
 
     //! Set the transport channel's overflow handler
@@ -149,14 +377,66 @@ public:
         _props.at(xport_chan).handle_overflow = handle_overflow;
     }
 
-    //! Get a scoped lock object for this instance
+    /*!
+     * Set the event counters for a transport channel.
+     * Overflows and late commands on this channel are counted here.
+     * \param xport_chan the transport channel index
+     * \param counters the counters of the channel's dsp
+     */
+    void set_event_counters(const size_t xport_chan, stream_event_counters::sptr counters){
+        _props.at(xport_chan).counters = counters;
+    }
+
+    /*!
+     * Get a scoped lock object for this instance.
+     * With a single owner, the fast path calls do not take the lock:
+     * once the owner made a call, only the owner may reconfigure.
+     */
     boost::mutex::scoped_lock get_scoped_lock(void){
-        return boost::mutex::scoped_lock(_mutex);
+        _mutex.lock();
+        if (_single_owner and _owner_id != boost::thread::id() and _owner_id != boost::this_thread::get_id()){
+            _mutex.unlock();
+            throw uhd::runtime_error("single owner: reconfiguration from a thread other than the streaming thread");
+        }
+        return boost::mutex::scoped_lock(_mutex, boost::adopt_lock);
     }
 
     //! Set the scale factor used in float conversion
     void set_scale_factor(const double scale_factor){
         _scale_factor = scale_factor;
+        if (not _converters.empty()) this->update_converters();
+    }
+
+    /*!
+     * Convert the channels in parallel on worker threads.
+     * Once the buffers are aligned, the channel conversions are split
+     * between the calling thread and the workers, then joined.
+     * Only handlers with multiple transport channels make use of it.
+     * \param num_threads the number of worker threads (0 to disable)
+     */
+    void set_convert_threads(const size_t num_threads){
+        _convert_pool.reset((num_threads == 0)? NULL : new convert_thread_pool(num_threads));
+    }
+
+    /*!
+     * Run a hook on the samples of each packet, right after their conversion.
+     * The hook works in place on the io buffers, before the next packet,
+     * and on the convert threads when the channels convert in parallel.
+     * \param hook the hook, or an empty function for none
+     */
+    void set_recv_hook(const recv_hook_type &hook){
+        _recv_hook = hook;
+    }
+
+    /*!
+     * Declare that a single thread makes all of the fast path calls.
+     * The per-call mutex is then skipped and the first caller is the owner.
+     * Calls and reconfiguration from any other thread throw.
+     * \param single_owner true to skip the per-call mutex
+     */
+    void set_single_owner(const bool single_owner){
+        _single_owner = single_owner;
+        _owner_id = boost::thread::id();
     }
 
     /*******************************************************************
@@ -172,7 +452,9 @@ public:
         uhd::device::recv_mode_t recv_mode,
         double timeout
     ){
-        boost::mutex::scoped_lock lock(_mutex);
+        UHD_TRACE_SCOPE("recv");
+        boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+        this->lock_fast_path(lock);
 
         //handle metadata queued from a previous receive
         if (_queue_error_for_next_call){
@@ -183,6 +465,10 @@ public:
             if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) return 0;
         }
 
+        if (not _resamplers.empty()) return recv_resampled(
+            buffs, nsamps_per_buff, metadata, io_type, recv_mode, timeout
+        );
+
         switch(recv_mode){
 
         ////////////////////////////////////////////////////////////////
@@ -213,6 +499,8 @@ public:
                     _queue_error_for_next_call = true;
                     break;
                 }
+                if (num_samps == 0 and _queue_metadata.has_rate_change) break; //the new rate starts the next call
+                if (num_samps == 0 and not _recv_hook.empty()) break; //the hook emptied a packet, or the next one does not fit
                 accum_num_samps += num_samps;
             }
             return accum_num_samps;
@@ -222,36 +510,270 @@ public:
         }//switch(recv_mode)
     }
 
+    /*******************************************************************
+     * Receive full buffer:
+     * Fill the buffers like the full buffer mode,
+     * but record the metadata of every packet into an array.
+     ******************************************************************/
+    UHD_INLINE size_t recv_full_buff(
+        const uhd::device::recv_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        uhd::device::recv_metadata_array_type &metadata_array,
+        const uhd::io_type_t &io_type,
+        double timeout
+    ){
+        boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+        this->lock_fast_path(lock);
+        metadata_array.clear();
+
+        //handle metadata queued from a previous receive
+        if (_queue_error_for_next_call){
+            _queue_error_for_next_call = false;
+            metadata_array.push_back(uhd::device::recv_packet_metadata_t());
+            metadata_array.back().metadata = _queue_metadata;
+            switch(_queue_metadata.error_code){
+            case rx_metadata_t::ERROR_CODE_TIMEOUT:
+            case rx_metadata_t::ERROR_CODE_OVERFLOW: break;
+            default: return 0;
+            }
+        }
+
+        if (not _resamplers.empty()){
+            metadata_array.push_back(uhd::device::recv_packet_metadata_t());
+            return recv_resampled(
+                buffs, nsamps_per_buff, metadata_array.back().metadata,
+                io_type, uhd::device::RECV_MODE_FULL_BUFF, timeout
+            );
+        }
+
+        //loop until buffer is filled or an error ends the receive
+        size_t accum_num_samps = 0;
+        while(accum_num_samps < nsamps_per_buff){
+            metadata_array.push_back(uhd::device::recv_packet_metadata_t());
+            uhd::device::recv_packet_metadata_t &entry = metadata_array.back();
+            entry.offset = accum_num_samps;
+            const size_t num_samps = recv_one_packet(
+                buffs, nsamps_per_buff - accum_num_samps, entry.metadata,
+                io_type, timeout, accum_num_samps*io_type.size
+            );
+            accum_num_samps += num_samps;
+            if (num_samps == 0 and entry.metadata.has_rate_change){
+                metadata_array.pop_back(); //the new rate starts the next call
+                break;
+            }
+            if (num_samps == 0 and entry.metadata.error_code == rx_metadata_t::ERROR_CODE_NONE and not _recv_hook.empty()){
+                metadata_array.pop_back(); //the hook emptied a packet, or the next one does not fit
+                break;
+            }
+            if (entry.metadata.error_code == rx_metadata_t::ERROR_CODE_NONE) continue;
+            if (entry.metadata.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW) continue;
+            break;
+        }
+        return accum_num_samps;
+    }
+
+    /*******************************************************************
+     * Receive view:
+     * Hand out the current frames instead of copy-converting them.
+     * The caller's view takes over the references to the frames.
+     ******************************************************************/
+    UHD_INLINE size_t recv_view(uhd::device::recv_view_t &view, double timeout){
+        boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+        this->lock_fast_path(lock);
+        view.release();
+
+        //handle metadata queued from a previous receive
+        if (_queue_error_for_next_call){
+            _queue_error_for_next_call = false;
+            view.metadata = _queue_metadata;
+            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) return 0;
+        }
+
+        //get the next buffer if the current one has expired
+        if (get_curr_buffer_info().data_bytes_to_copy == 0){
+            get_curr_buffer_info().fragment_offset_in_samps = 0;
+            get_curr_buffer_info().alignment_time_valid = false;
+            get_curr_buffer_info().indexes_todo.set();
+            get_aligned_buffs(timeout);
+        }
+
+        buffers_info_type &info = get_curr_buffer_info();
+        view.metadata = info.metadata;
+        view.metadata.time_spec = offset_time_spec(view.metadata.time_spec, info.fragment_offset_in_samps);
+        view.metadata.more_fragments = false;
+        view.metadata.fragment_offset = info.fragment_offset_in_samps;
+        if (info.fragment_offset_in_samps != 0){
+            view.metadata.num_samps_lost = 0;
+            view.metadata.has_rate_change = false;
+        }
+        view.item_size = _bytes_per_item;
+        view.otw_type = _otw_type;
+        if (info.data_bytes_to_copy == 0) return 0;
+
+        //move the frames into the view, the remainder is consumed
+        view.nsamps = info.data_bytes_to_copy/_bytes_per_item;
+        BOOST_FOREACH(per_buffer_info_type &buff_info, info){
+            view.payloads.push_back(buff_info.copy_buff);
+            view.frames.push_back(buff_info.buff);
+            buff_info.buff.reset();
+        }
+        info.data_bytes_to_copy = 0;
+        return view.nsamps;
+    }
+
 private:
 
+    //! Lock the per-call mutex unless a single thread owns the calls
+    UHD_INLINE void lock_fast_path(boost::mutex::scoped_lock &lock){
+        if (not _single_owner){
+            lock.lock();
+            return;
+        }
+        if (_owner_id != boost::this_thread::get_id()) this->claim_owner();
+    }
+
+    //! Make the calling thread the owner under the mutex, or throw when there is one
+    void claim_owner(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        UHD_ASSERT_THROW(_owner_id == boost::thread::id());
+        _owner_id = boost::this_thread::get_id();
+    }
+
     boost::mutex _mutex;
     vrt_unpacker_type _vrt_unpacker;
     size_t _header_offset_words32;
     double _tick_rate, _samp_rate;
+    boost::int64_t _ticks_per_samp; //zero when a sample is not a whole number of ticks
     bool _queue_error_for_next_call;
+    bool _single_owner;
+    boost::thread::id _owner_id;
+    bool _single_io_type;
+    io_type_t::tid_t _io_tid; //the only io type when single
+    bool _lookahead;
     size_t _alignment_faulure_threshold;
     rx_metadata_t _queue_metadata;
     struct xport_chan_props_type{
         xport_chan_props_type(void):
             packet_count(0),
-            handle_overflow(&handle_overflow_nop)
+            realign(false),
+            handle_overflow(&handle_overflow_nop),
+            counters(stream_event_counters::make())
         {}
         get_buff_type get_buff;
+        managed_recv_buffer::sptr next_buff; //held by the lookahead
         size_t packet_count;
+        bool realign; //the next data packet marks where the stream resumed
         handle_overflow_type handle_overflow;
+        stream_event_counters::sptr counters;
+        uhd::convert::correction_t correction;
+        uhd::convert::plan_t corrected_converter; //empty for identity
     };
     std::vector<xport_chan_props_type> _props;
     std::vector<void *> _io_buffs; //used in conversion
     size_t _bytes_per_item; //used in conversion
-    std::vector<uhd::convert::function_type> _converters; //used in conversion
+    std::vector<uhd::convert::plan_t> _converters; //used in conversion
     double _scale_factor;
+    uhd::otw_type_t _otw_type;
+    boost::scoped_ptr<convert_thread_pool> _convert_pool;
+    recv_hook_type _recv_hook;
+    resampler_config_t _resampler_config;
+    std::vector<polyphase_resampler::sptr> _resamplers; //one per io buffer
+    std::vector<void *> _resampler_buffs; //the resamplers input buffers
+    time_spec_t _resampler_time; //time of the first output since a reset
+    bool _resampler_time_valid;
+    bool _resampler_fresh; //no input since a reset
+    size_t _resampler_nsamps; //outputs since a reset
+
+    //! Rebuild the resamplers for the rates and the channel layout
+    void update_resamplers(void){
+        _resamplers.clear();
+        if (_resampler_config.rate == 0) return;
+        const size_t num_buffs = this->size()*std::max<size_t>(1, _io_buffs.size());
+        for (size_t i = 0; i < num_buffs; i++){
+            _resamplers.push_back(polyphase_resampler::make(
+                _samp_rate, _resampler_config.rate,
+                _resampler_config.taps_per_phase, _resampler_config.max_phases
+            ));
+        }
+        _resampler_buffs.resize(num_buffs);
+        this->reset_resamplers();
+    }
+
+    //! Start a new stream in the resamplers after a discontinuity
+    void reset_resamplers(void){
+        BOOST_FOREACH(polyphase_resampler::sptr &resampler, _resamplers) resampler->reset();
+        _resampler_time_valid = false;
+        _resampler_fresh = true;
+        _resampler_nsamps = 0;
+    }
+
+    //! Resolve the conversion plans for the otw type and scale factor
+    void update_converters(void){
+        _converters.assign(128, uhd::convert::plan_t());
+        for (size_t io_type = 0; io_type < _converters.size(); io_type++){
+            if (_single_io_type and io_type != size_t(_io_tid)) continue;
+            try{
+                _converters[io_type] = uhd::convert::plan_t(uhd::convert::get_converter_otw_to_cpu(
+                    io_type_t::tid_t(io_type), _otw_type, 1, _io_buffs.size()
+                ), 1, _io_buffs.size(), _scale_factor);
+            }catch(const uhd::value_error &){
+                //we expect this, not all io_types valid... but the only one must be
+                if (_single_io_type) throw;
+            }
+        }
+        for (size_t i = 0; i < this->size(); i++) this->update_corrected_converter(i);
+    }
+
+    //! Bind the channel's correction into an fc32 converter
+    void update_corrected_converter(const size_t xport_chan){
+        xport_chan_props_type &props = _props.at(xport_chan);
+        props.corrected_converter = uhd::convert::plan_t();
+        if (props.correction.is_identity()) return;
+        if (_io_buffs.size() != 1) throw uhd::not_implemented_error(
+            "recv packet handler: correction needs one stream per channel"
+        );
+        props.corrected_converter = uhd::convert::plan_t(uhd::convert::get_corrected_converter_otw_to_cpu(
+            io_type_t::COMPLEX_FLOAT32, _otw_type, props.correction
+        ), 1, 1, _scale_factor);
+    }
+
+    //! raw packet timestamp (tsi, tsf) for exact ordering and alignment
+    typedef std::pair<boost::uint64_t, boost::uint64_t> packet_time_type;
+
+    //! convert a raw packet timestamp to a time spec for the metadata
+    UHD_INLINE time_spec_t to_time_spec(const packet_time_type &time) const{
+        return time_spec_t(time_t(time.first), size_t(time.second), _tick_rate);
+    }
+
+    //! Set the rate without the resamplers, which may be in use by the caller
+    void apply_samp_rate(const double rate){
+        _samp_rate = rate;
+        this->update_ticks_per_samp();
+    }
+
+    //! Use integer tick math for sample offsets when the rates allow it
+    void update_ticks_per_samp(void){
+        const double ticks_per_samp = _tick_rate/_samp_rate;
+        const double rounded = std::floor(ticks_per_samp + 0.5);
+        _ticks_per_samp = (rounded >= 1 and std::abs(ticks_per_samp - rounded) < 1e-9*rounded)?
+            boost::int64_t(rounded) : 0;
+    }
+
+    //! offset a time spec by a number of samples, exactly when samples are whole ticks
+    UHD_INLINE time_spec_t offset_time_spec(const time_spec_t &time, const size_t nsamps) const{
+        if (nsamps == 0) return time;
+        if (_ticks_per_samp == 0) return time + time_spec_t(0, nsamps, _samp_rate);
+        tick_time_t tick_time(time, _tick_rate);
+        tick_time += boost::int64_t(nsamps)*_ticks_per_samp;
+        return tick_time.to_time_spec();
+    }
 
     //! information stored for a received buffer
     struct per_buffer_info_type{
         managed_recv_buffer::sptr buff;
         const boost::uint32_t *vrt_hdr;
         vrt::if_packet_info_t ifpi;
-        time_spec_t time;
+        packet_time_type time;
         const char *copy_buff;
     };
 
@@ -265,13 +787,27 @@ private:
             fragment_offset_in_samps(0)
         {/* NOP */}
         boost::dynamic_bitset<> indexes_todo; //used in alignment logic
-        time_spec_t alignment_time; //used in alignment logic
+        packet_time_type alignment_time; //used in alignment logic
         bool alignment_time_valid; //used in alignment logic
         size_t data_bytes_to_copy; //keeps track of state
         size_t fragment_offset_in_samps; //keeps track of state
         rx_metadata_t metadata; //packet description
     };
 
+    //! where the channels resumed after an overflow, older packets cannot align
+    packet_time_type _realign_time;
+    bool _realign_time_valid;
+
+    //! the sample loss accounting, from the time after the last aligned buffers
+    bool _gap_pending; //an overflow or a sequence error since then
+    time_spec_t _next_time;
+    bool _next_time_valid;
+
+    //! a rate change that takes effect at the first packet at or after its time
+    bool _rate_change_pending;
+    packet_time_type _rate_change_time;
+    double _rate_change_rate, _rate_change_scale;
+
     //! a circular queue of buffer infos
     std::vector<buffers_info_type> _buffers_infos;
     size_t _buffers_infos_index;
@@ -286,7 +822,8 @@ private:
         PACKET_TIMESTAMP_ERROR,
         PACKET_INLINE_MESSAGE,
         PACKET_TIMEOUT_ERROR,
-        PACKET_SEQUENCE_ERROR
+        PACKET_SEQUENCE_ERROR,
+        PACKET_BAD_PACKET
     };
 
     /*******************************************************************
@@ -303,7 +840,11 @@ private:
     ){
         //get a single packet from the transport layer
         managed_recv_buffer::sptr &buff = curr_buffer_info[index].buff;
-        buff = _props[index].get_buff(timeout);
+        if (_props[index].next_buff.get() != NULL){
+            buff = _props[index].next_buff;
+            _props[index].next_buff = managed_recv_buffer::sptr();
+        }
+        else buff = _props[index].get_buff(timeout);
         if (buff.get() == NULL) return PACKET_TIMEOUT_ERROR;
 
         //bounds check before extract
@@ -317,7 +858,7 @@ private:
         info.ifpi.num_packet_words32 = num_packet_words32 - _header_offset_words32;
         info.vrt_hdr = buff->cast<const boost::uint32_t *>() + _header_offset_words32;
         _vrt_unpacker(info.vrt_hdr, info.ifpi);
-        info.time = time_spec_t(time_t(info.ifpi.tsi), size_t(info.ifpi.tsf), _tick_rate); //assumes has_tsi and has_tsf are true
+        info.time = packet_time_type(info.ifpi.tsi, info.ifpi.tsf); //assumes has_tsi and has_tsf are true
         info.copy_buff = reinterpret_cast<const char *>(info.vrt_hdr + info.ifpi.num_header_words32);
 
         //--------------------------------------------------------------
@@ -345,6 +886,12 @@ private:
         }
 
         //4) otherwise the packet is normal!
+        //the first one after an overflow tells the alignment where the stream resumed
+        if (_props[index].realign){
+            _props[index].realign = false;
+            if (not _realign_time_valid or info.time > _realign_time) _realign_time = info.time;
+            _realign_time_valid = true;
+        }
         return PACKET_IF_DATA;
     }
 
@@ -377,6 +924,30 @@ private:
         //else if (info[index].time < info.alignment_time)...
     }
 
+    /*******************************************************************
+     * Receive a single packet safely:
+     * Call into get and process single packet and catch any exception.
+     * An exception is reported and yields the bad packet return code.
+     ******************************************************************/
+    UHD_INLINE packet_type get_and_process_single_packet_safe(
+        const size_t index,
+        buffers_info_type &prev_buffer_info,
+        buffers_info_type &curr_buffer_info,
+        double timeout
+    ){
+        try{
+            return get_and_process_single_packet(
+                index, prev_buffer_info, curr_buffer_info, timeout
+            );
+        }
+        catch(const std::exception &e){
+            UHD_MSG(error) << boost::format(
+                "The receive packet handler caught an exception.\n%s"
+            ) % e.what() << std::endl;
+            return PACKET_BAD_PACKET;
+        }
+    }
+
     /*******************************************************************
      * Get aligned buffers:
      * Iterate through each index and try to accumulate aligned buffers.
@@ -384,11 +955,42 @@ private:
      * The logic will throw out older packets until it finds a match.
      ******************************************************************/
     UHD_INLINE void get_aligned_buffs(double timeout){
+        UHD_TRACE_SCOPE("recv_align");
 
         increment_buffer_info(); //increment to next buffer
         buffers_info_type &prev_info = get_prev_buffer_info();
         buffers_info_type &curr_info = get_curr_buffer_info();
         buffers_info_type &next_info = get_next_buffer_info();
+        curr_info.metadata.has_rate_change = false;
+        curr_info.metadata.samp_rate = _samp_rate;
+
+        //Fast path for the steady state where the channels are aligned:
+        // - Receive one packet per index in order, no search required.
+        // - Stop at the first packet that is not data matching index zero.
+        // - A single channel handler accepts its data packet right away.
+        //Only a fresh buffer info can take this path, saved progress cannot.
+        size_t index = 0;
+        packet_type packet = PACKET_IF_DATA;
+        bool pending = false; //packet at index still needs handling
+        if (not curr_info.alignment_time_valid){
+            for (; index < curr_info.size(); index++){
+                packet = get_and_process_single_packet_safe(
+                    index, prev_info, curr_info, timeout
+                );
+                if (packet != PACKET_IF_DATA) break;
+                if (index != 0 and curr_info[index].time != curr_info[0].time) break;
+            }
+            pending = index < curr_info.size();
+
+            //hand the aligned indexes over to the general logic below
+            curr_info.indexes_todo.set();
+            for (size_t i = 0; i < index; i++) curr_info.indexes_todo.reset(i);
+            if (index != 0){
+                curr_info.alignment_time_valid = true;
+                curr_info.alignment_time = curr_info[0].time;
+                curr_info.data_bytes_to_copy = curr_info[0].ifpi.num_payload_words32*sizeof(boost::uint32_t);
+            }
+        }
 
         //Loop until we get a message of an aligned set of buffers:
         // - Receive a single packet and extract its info.
@@ -397,32 +999,19 @@ private:
         size_t iterations = 0;
         while (curr_info.indexes_todo.any()){
 
-            //get the index to process for this iteration
-            const size_t index = curr_info.indexes_todo.find_first();
-            packet_type packet;
-
-            //receive a single packet from the transport
-            try{
-                packet = get_and_process_single_packet(
+            //get the index to process for this iteration,
+            //unless the fast path left a packet to be handled
+            if (not pending){
+                index = curr_info.indexes_todo.find_first();
+                packet = get_and_process_single_packet_safe(
                     index, prev_info, curr_info, timeout
                 );
             }
+            pending = false;
 
-            //handle the case when the get packet throws
-            catch(const std::exception &e){
-                UHD_MSG(error) << boost::format(
-                    "The receive packet handler caught an exception.\n%s"
-                ) % e.what() << std::endl;
-                std::swap(curr_info, next_info); //save progress from curr -> next
-                curr_info.metadata.has_time_spec = false;
-                curr_info.metadata.time_spec = time_spec_t(0.0);
-                curr_info.metadata.more_fragments = false;
-                curr_info.metadata.fragment_offset = 0;
-                curr_info.metadata.start_of_burst = false;
-                curr_info.metadata.end_of_burst = false;
-                curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_BAD_PACKET;
-                return;
-            }
+            //after an overflow, packets older than the resumed stream cannot be aligned:
+            //drop them without restarting the alignment or counting them as failures
+            if (packet == PACKET_IF_DATA and _realign_time_valid and curr_info[index].time < _realign_time) continue;
 
             switch(packet){
             case PACKET_IF_DATA:
@@ -443,15 +1032,22 @@ private:
             case PACKET_INLINE_MESSAGE:
                 std::swap(curr_info, next_info); //save progress from curr -> next
                 curr_info.metadata.has_time_spec = next_info[index].ifpi.has_tsi and next_info[index].ifpi.has_tsf;
-                curr_info.metadata.time_spec = next_info[index].time;
+                curr_info.metadata.time_spec = to_time_spec(next_info[index].time);
                 curr_info.metadata.more_fragments = false;
                 curr_info.metadata.fragment_offset = 0;
                 curr_info.metadata.start_of_burst = false;
                 curr_info.metadata.end_of_burst = false;
                 curr_info.metadata.error_code = rx_metadata_t::error_code_t(get_context_code(next_info[index].vrt_hdr, next_info[index].ifpi));
+                curr_info.metadata.num_samps_lost = 0;
+                curr_info.metadata.has_recv_timestamp = false;
                 if (curr_info.metadata.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW){
                     _props[index].handle_overflow();
-                    UHD_MSG(fastpath) << "O";
+                    _props[index].counters->record(stream_event_counters::EVENT_OVERFLOW);
+                    _props[index].realign = true;
+                    _gap_pending = true;
+                }
+                if (curr_info.metadata.error_code == rx_metadata_t::ERROR_CODE_LATE_COMMAND){
+                    _props[index].counters->record(stream_event_counters::EVENT_LATE_COMMAND);
                 }
                 return;
 
@@ -464,20 +1060,38 @@ private:
                 curr_info.metadata.start_of_burst = false;
                 curr_info.metadata.end_of_burst = false;
                 curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+                curr_info.metadata.num_samps_lost = 0;
+                curr_info.metadata.has_recv_timestamp = false;
+                return;
+
+            case PACKET_BAD_PACKET:
+                std::swap(curr_info, next_info); //save progress from curr -> next
+                curr_info.metadata.has_time_spec = false;
+                curr_info.metadata.time_spec = time_spec_t(0.0);
+                curr_info.metadata.more_fragments = false;
+                curr_info.metadata.fragment_offset = 0;
+                curr_info.metadata.start_of_burst = false;
+                curr_info.metadata.end_of_burst = false;
+                curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_BAD_PACKET;
+                curr_info.metadata.num_samps_lost = 0;
+                curr_info.metadata.has_recv_timestamp = false;
                 return;
 
             case PACKET_SEQUENCE_ERROR:
                 alignment_check(index, curr_info);
                 std::swap(curr_info, next_info); //save progress from curr -> next
                 curr_info.metadata.has_time_spec = prev_info.metadata.has_time_spec;
-                curr_info.metadata.time_spec = prev_info.metadata.time_spec + time_spec_t(0,
-                    prev_info[index].ifpi.num_payload_words32*sizeof(boost::uint32_t)/_bytes_per_item, _samp_rate);
+                curr_info.metadata.time_spec = offset_time_spec(prev_info.metadata.time_spec,
+                    prev_info[index].ifpi.num_payload_words32*sizeof(boost::uint32_t)/_bytes_per_item);
                 curr_info.metadata.more_fragments = false;
                 curr_info.metadata.fragment_offset = 0;
                 curr_info.metadata.start_of_burst = false;
                 curr_info.metadata.end_of_burst = false;
                 curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
-                UHD_MSG(fastpath) << "O";
+                curr_info.metadata.num_samps_lost = 0; //counted on the packet after the gap
+                curr_info.metadata.has_recv_timestamp = false;
+                _props[index].counters->record(stream_event_counters::EVENT_OVERFLOW); //dropped packets
+                _gap_pending = true;
                 return;
 
             }
@@ -497,6 +1111,9 @@ private:
                 curr_info.metadata.start_of_burst = false;
                 curr_info.metadata.end_of_burst = false;
                 curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_ALIGNMENT;
+                curr_info.metadata.num_samps_lost = 0;
+                curr_info.metadata.has_recv_timestamp = false;
+                _gap_pending = true;
                 return;
             }
 
@@ -504,7 +1121,7 @@ private:
 
         //set the metadata from the buffer information at index zero
         curr_info.metadata.has_time_spec = curr_info[0].ifpi.has_tsi and curr_info[0].ifpi.has_tsf;
-        curr_info.metadata.time_spec = curr_info[0].time;
+        curr_info.metadata.time_spec = to_time_spec(curr_info[0].time);
         curr_info.metadata.more_fragments = false;
         curr_info.metadata.fragment_offset = 0;
         /* TODO SOB on RX not supported in hardware
@@ -515,7 +1132,151 @@ private:
         static const int tlr_eob_flags = (1 << 20) | (1 << 8); //enable and indicator bits
         curr_info.metadata.end_of_burst   = curr_info[0].ifpi.has_tlr and (int(curr_info[0].ifpi.tlr & tlr_eob_flags) != 0);
         curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_NONE;
+        _realign_time_valid = false; //aligned again
+
+        //a timed rate change takes effect at the first packet at or after its time
+        if (_rate_change_pending and curr_info.metadata.has_time_spec and not (curr_info[0].time < _rate_change_time)){
+            _rate_change_pending = false;
+            this->apply_samp_rate(_rate_change_rate);
+            if (_rate_change_scale != 0.0) this->set_scale_factor(_rate_change_scale);
+            curr_info.metadata.has_rate_change = true;
+            curr_info.metadata.samp_rate = _samp_rate;
+        }
 
+        //the timestamps tell how many samples an overflow cost,
+        //counted from the end of the last aligned buffers
+        curr_info.metadata.has_recv_timestamp = curr_info[0].buff->get_recv_timestamp(curr_info.metadata.recv_timestamp);
+        curr_info.metadata.num_samps_lost = 0;
+        if (_gap_pending and _next_time_valid and curr_info.metadata.has_time_spec){
+            const double gap = (curr_info.metadata.time_spec - _next_time).get_real_secs()*_samp_rate;
+            if (gap >= 0.5) curr_info.metadata.num_samps_lost = size_t(gap + 0.5);
+            for (size_t i = 0; i < _props.size(); i++){
+                _props[i].counters->record(stream_event_counters::EVENT_LOST_SAMPS, curr_info.metadata.num_samps_lost);
+            }
+        }
+        _gap_pending = false;
+        _next_time = offset_time_spec(curr_info.metadata.time_spec, curr_info.data_bytes_to_copy/_bytes_per_item/std::max<size_t>(1, _io_buffs.size()));
+        _next_time_valid = curr_info.metadata.has_time_spec;
+
+    }
+
+    /*******************************************************************
+     * Lookahead next buffers:
+     * Poll each transport channel for its next frame without waiting.
+     * Prefetch the vrt header and the first lines of the payload.
+     ******************************************************************/
+    UHD_INLINE void lookahead_next_buffs(void){
+        static const size_t prefetch_bytes = 256, cache_line_bytes = 64;
+        for (size_t i = 0; i < _props.size(); i++){
+            if (_props[i].next_buff.get() != NULL) continue;
+            _props[i].next_buff = _props[i].get_buff(0.0);
+            if (_props[i].next_buff.get() == NULL) continue;
+            const char *mem = _props[i].next_buff->cast<const char *>() + _header_offset_words32*sizeof(boost::uint32_t);
+            const size_t num_bytes = std::min(prefetch_bytes, _props[i].next_buff->size());
+            for (size_t j = 0; j < num_bytes; j += cache_line_bytes) SRPH_PREFETCH(mem + j);
+        }
+    }
+
+    /*******************************************************************
+     * Receive through the resamplers:
+     * Drain the outputs that the buffered input allows,
+     * then receive the next packet in place into the resamplers.
+     * Errors after some outputs are queued for the next call.
+     ******************************************************************/
+    UHD_INLINE size_t recv_resampled(
+        const uhd::device::recv_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t &metadata,
+        const uhd::io_type_t &io_type,
+        uhd::device::recv_mode_t recv_mode,
+        double timeout
+    ){
+        typedef polyphase_resampler::sample_type sample_type;
+        if (io_type.tid != io_type_t::COMPLEX_FLOAT32) throw uhd::value_error(
+            "recv packet handler: the host resampler needs complex float samples"
+        );
+        if (buffs.size() != _resamplers.size()) throw uhd::value_error(
+            "recv packet handler: one buffer per channel needed to resample"
+        );
+
+        metadata.has_time_spec = false;
+        metadata.more_fragments = false;
+        metadata.fragment_offset = 0;
+        metadata.start_of_burst = false;
+        metadata.end_of_burst = false;
+        metadata.error_code = rx_metadata_t::ERROR_CODE_NONE;
+        metadata.num_samps_lost = 0;
+        metadata.has_recv_timestamp = false;
+        metadata.has_rate_change = false;
+        metadata.samp_rate = _resampler_config.rate;
+
+        size_t accum_num_samps = 0;
+        while (true){
+            //all channels hold the same input, so they output the same number
+            size_t num_samps = 0;
+            for (size_t i = 0; i < _resamplers.size(); i++){
+                num_samps = _resamplers[i]->get_output(
+                    reinterpret_cast<sample_type *>(buffs[i]) + accum_num_samps,
+                    nsamps_per_buff - accum_num_samps
+                );
+            }
+            if (accum_num_samps == 0 and num_samps != 0){
+                metadata.has_time_spec = _resampler_time_valid;
+                metadata.time_spec = _resampler_time + time_spec_t(
+                    0, long(_resampler_nsamps), _resamplers.front()->get_out_rate()
+                );
+            }
+            _resampler_nsamps += num_samps;
+            accum_num_samps += num_samps;
+            if (accum_num_samps == nsamps_per_buff) break;
+            if (accum_num_samps != 0 and recv_mode == uhd::device::RECV_MODE_ONE_PACKET) break;
+
+            //receive the next packet into the resamplers input
+            for (size_t i = 0; i < _resamplers.size(); i++){
+                _resampler_buffs[i] = _resamplers[i]->get_input_buff();
+            }
+            const size_t num_input = recv_one_packet(
+                _resampler_buffs, _resamplers.front()->get_input_space(),
+                _queue_metadata, io_type, timeout
+            );
+
+            //the input is at a new rate: restart the resamplers with it
+            const bool restart = _queue_metadata.has_rate_change and _queue_metadata.error_code == rx_metadata_t::ERROR_CODE_NONE;
+            if (restart){
+                const std::vector<polyphase_resampler::sptr> old_resamplers(_resamplers); //holds the input until copied
+                this->update_resamplers();
+                for (size_t i = 0; i < _resamplers.size(); i++){
+                    const sample_type *input = reinterpret_cast<const sample_type *>(_resampler_buffs[i]);
+                    std::copy(input, input + num_input, _resamplers[i]->get_input_buff());
+                }
+            }
+            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_NONE){
+                //the samples after an overflow do not continue the stream
+                if (_queue_metadata.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW) this->reset_resamplers();
+                if (accum_num_samps == 0){
+                    metadata = _queue_metadata;
+                    return 0;
+                }
+                _queue_error_for_next_call = true;
+                break;
+            }
+
+            //the first input after a reset sets the time of the outputs
+            if (_resampler_fresh){
+                _resampler_time = _queue_metadata.time_spec - time_spec_t(_resamplers.front()->get_delay()/_samp_rate);
+                _resampler_time_valid = _queue_metadata.has_time_spec;
+                _resampler_fresh = false;
+            }
+            metadata.end_of_burst = _queue_metadata.end_of_burst;
+            metadata.num_samps_lost += size_t(_queue_metadata.num_samps_lost*_resamplers.front()->get_out_rate()/_samp_rate + 0.5);
+            if (not metadata.has_recv_timestamp){
+                metadata.has_recv_timestamp = _queue_metadata.has_recv_timestamp;
+                metadata.recv_timestamp = _queue_metadata.recv_timestamp;
+            }
+            BOOST_FOREACH(polyphase_resampler::sptr &resampler, _resamplers) resampler->commit_input(num_input);
+            if (restart and accum_num_samps != 0) break; //the restarted outputs have a time of their own
+        }
+        return accum_num_samps;
     }
 
     /*******************************************************************
@@ -542,21 +1303,40 @@ private:
 
             //perform receive with alignment logic
             get_aligned_buffs(timeout);
+
+            //pull in the next frames while these ones convert
+            if (_lookahead) this->lookahead_next_buffs();
         }
 
         buffers_info_type &info = get_curr_buffer_info();
         metadata = info.metadata;
 
         //interpolate the time spec (useful when this is a fragment)
-        metadata.time_spec += time_spec_t(0, info.fragment_offset_in_samps, _samp_rate);
+        metadata.time_spec = offset_time_spec(metadata.time_spec, info.fragment_offset_in_samps);
+        if (info.fragment_offset_in_samps != 0){
+            metadata.num_samps_lost = 0;
+            metadata.has_rate_change = false;
+        }
+
+        //the samples at a new rate start a receive call of their own
+        if (metadata.has_rate_change and buffer_offset_bytes != 0) return 0;
 
         //extract the number of samples available to copy
         const size_t nsamps_available = info.data_bytes_to_copy/_bytes_per_item;
+
+        //a hook sees whole packets, after the first one of a receive call
+        if (not _recv_hook.empty() and buffer_offset_bytes != 0 and nsamps_available > nsamps_per_buff*_io_buffs.size()) return 0;
         const size_t nsamps_to_copy = std::min(nsamps_per_buff*_io_buffs.size(), nsamps_available);
         const size_t bytes_to_copy = nsamps_to_copy*_bytes_per_item;
         const size_t nsamps_to_copy_per_io_buff = nsamps_to_copy/_io_buffs.size();
 
-        size_t buff_index = 0;
+        //queue the conversions for the thread pool when enabled
+        const bool in_parallel = _convert_pool.get() != NULL and info.size() > 1;
+        if (in_parallel) _convert_pool->tasks().resize(info.size());
+
+        size_t buff_index = 0, xport_chan = 0;
+        size_t nsamps_kept = nsamps_to_copy_per_io_buff;
+        const bool has_hook = not _recv_hook.empty();
         BOOST_FOREACH(per_buffer_info_type &buff_info, info){
 
             //fill a vector with pointers to the io buffers
@@ -564,12 +1344,47 @@ private:
                 io_buff = reinterpret_cast<char *>(buffs[buff_index++]) + buffer_offset_bytes;
             }
 
+            //use the channel's corrected converter for fc32 when set
+            const uhd::convert::plan_t &corrected = _props[xport_chan].corrected_converter;
+            const uhd::convert::plan_t &converter = (
+                io_type.tid == io_type_t::COMPLEX_FLOAT32 and not corrected.empty()
+            )? corrected : _converters[io_type.tid];
+
             //copy-convert the samples from the recv buffer
-            _converters[io_type.tid](buff_info.copy_buff, _io_buffs, nsamps_to_copy_per_io_buff, _scale_factor);
+            if (in_parallel){
+                convert_thread_pool::task_type &task = _convert_pool->tasks()[xport_chan];
+                task.converter = &converter;
+                task.input = buff_info.copy_buff;
+                task.outputs.assign(_io_buffs.begin(), _io_buffs.end());
+                task.nsamps = nsamps_to_copy_per_io_buff;
+                task.hook = (has_hook)? &_recv_hook : NULL;
+                task.first_chan = buff_index - _io_buffs.size();
+                task.metadata = &metadata;
+            }
+            else{
+                UHD_TRACE_SCOPE("recv_convert");
+                const void *input = buff_info.copy_buff;
+                converter(&input, &_io_buffs.front(), nsamps_to_copy_per_io_buff);
+                if (has_hook) nsamps_kept = std::min(nsamps_kept, run_recv_hook(
+                    _recv_hook, buff_index - _io_buffs.size(), &_io_buffs.front(), _io_buffs.size(),
+                    nsamps_to_copy_per_io_buff, metadata
+                ));
+            }
+            xport_chan++;
 
             //update the rx copy buffer to reflect the bytes copied
             buff_info.copy_buff += bytes_to_copy;
         }
+        if (in_parallel){
+            UHD_TRACE_SCOPE("recv_convert");
+            _convert_pool->run();
+            if (has_hook){
+                BOOST_FOREACH(const convert_thread_pool::task_type &task, _convert_pool->tasks()){
+                    nsamps_kept = std::min(nsamps_kept, task.nsamps_kept);
+                }
+            }
+        }
+
         //update the copy buffer's availability
         info.data_bytes_to_copy -= bytes_to_copy;
 
@@ -585,8 +1400,61 @@ private:
             }
         }
 
-        return nsamps_to_copy_per_io_buff;
+        return nsamps_kept;
+    }
+};
+
+/***********************************************************************
+ * Receive packet streamer
+ *
+ * A receive packet handler made for one stream of a device.
+ * The io type is bound and resolved when the stream is made,
+ * the device configures the handler for the stream's channels.
+ **********************************************************************/
+class recv_packet_streamer : public recv_packet_handler, public uhd::rx_streamer{
+public:
+    typedef boost::shared_ptr<recv_packet_streamer> sptr;
+
+    /*!
+     * Make a new packet streamer for receive
+     * \param io_type the io type of the stream
+     * \param max_num_samps the maximum samples per packet
+     */
+    recv_packet_streamer(const uhd::io_type_t &io_type, const size_t max_num_samps):
+        _io_type(io_type), _max_num_samps(max_num_samps)
+    {
+        this->set_io_type(io_type);
+    }
+
+    size_t get_num_channels(void) const{
+        return this->size();
+    }
+
+    size_t get_max_num_samps(void) const{
+        return _max_num_samps;
+    }
+
+    void set_recv_hook(const recv_hook_type &hook){
+        recv_packet_handler::set_recv_hook(hook);
     }
+
+    size_t recv(
+        const rx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t &metadata,
+        double timeout,
+        bool one_packet
+    ){
+        return recv_packet_handler::recv(
+            buffs, nsamps_per_buff, metadata, _io_type,
+            (one_packet)? uhd::device::RECV_MODE_ONE_PACKET : uhd::device::RECV_MODE_FULL_BUFF,
+            timeout
+        );
+    }
+
+private:
+    const uhd::io_type_t _io_type;
+    const size_t _max_num_samps;
 };
 
 }}} //namespace
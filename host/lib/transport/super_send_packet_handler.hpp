@@ -18,21 +18,28 @@
 #ifndef INCLUDED_LIBUHD_TRANSPORT_SUPER_SEND_PACKET_HANDLER_HPP
 #define INCLUDED_LIBUHD_TRANSPORT_SUPER_SEND_PACKET_HANDLER_HPP
 
+#include "polyphase_resampler.hpp"
+#include "stream_event_counters.hpp"
 #include <uhd/config.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/convert.hpp>
 #include <uhd/device.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/trace.hpp>
 #include <uhd/types/io_type.hpp>
 #include <uhd/types/otw_type.hpp>
 #include <uhd/types/metadata.hpp>
+#include <uhd/types/tick_time.hpp>
 #include <uhd/transport/vrt_if_packet.hpp>
 #include <uhd/transport/zero_copy.hpp>
 #include <boost/thread/thread_time.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 
@@ -48,6 +55,9 @@ namespace uhd{ namespace transport{ namespace sph{
 class send_packet_handler{
 public:
     typedef boost::function<managed_send_buffer::sptr(double)> get_buff_type;
+    typedef boost::function<void(void)> flush_type;
+    typedef boost::function<bool(size_t, double)> preload_type;
+    typedef boost::function<uhd::time_spec_t(void)> time_now_type;
     typedef void(*vrt_packer_type)(boost::uint32_t *, vrt::if_packet_info_t &);
     //typedef boost::function<void(boost::uint32_t *, vrt::if_packet_info_t &)> vrt_packer_type;
 
@@ -56,10 +66,20 @@ public:
      * \param size the number of transport channels
      */
     send_packet_handler(const size_t size = 1):
-        _next_packet_seq(0)
+        _late_policy(LATE_POLICY_SEND),
+        _in_burst(false),
+        _late_burst(false),
+        _header_mode(HEADER_MODE_REPACK),
+        _header_cached(false),
+        _next_packet_seq(0),
+        _single_owner(false),
+        _single_io_type(false),
+        _io_tid(io_type_t::CUSTOM_TYPE)
     {
         this->resize(size);
         this->set_scale_factor(32767.);
+        _tick_rate = _samp_rate = 1.0;
+        this->update_ticks_per_samp();
     }
 
     //! Resize the number of transport channels
@@ -68,6 +88,7 @@ public:
         _props.resize(size);
         static const boost::uint64_t zero = 0;
         _zero_buffs.resize(size, &zero);
+        this->update_resamplers();
     }
 
     //! Get the channel width of this handler
@@ -79,16 +100,50 @@ public:
     void set_vrt_packer(const vrt_packer_type &vrt_packer, const size_t header_offset_words32 = 0){
         _vrt_packer = vrt_packer;
         _header_offset_words32 = header_offset_words32;
+        _header_cached = false;
+
+        //probe the byte order of the packer to patch cached headers
+        vrt::if_packet_info_t if_packet_info = vrt::if_packet_info_t();
+        if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+        if_packet_info.packet_count = 1;
+        boost::uint32_t header[vrt::max_if_hdr_words32];
+        _vrt_packer(header, if_packet_info);
+        const boost::uint32_t expected = (1 << 16) | 1;
+        if      (header[0] == expected)                 _header_mode = HEADER_MODE_NATIVE;
+        else if (header[0] == uhd::byteswap(expected)) _header_mode = HEADER_MODE_SWAPPED;
+        else                                            _header_mode = HEADER_MODE_REPACK;
     }
 
     //! Set the rate of ticks per second
     void set_tick_rate(const double rate){
         _tick_rate = rate;
+        this->update_ticks_per_samp();
     }
 
     //! Set the rate of samples per second
     void set_samp_rate(const double rate){
         _samp_rate = rate;
+        this->update_ticks_per_samp();
+        this->update_resamplers();
+    }
+
+    /*!
+     * Resample the samples to send on the host.
+     * The samples are resampled from the config rate to the sample rate
+     * before conversion, for each channel, in complex float only.
+     * The send view path takes samples at the sample rate.
+     * \param config the resampler settings (a rate of zero for off)
+     * \return the config with the actual host rate
+     */
+    resampler_config_t set_resampler(const resampler_config_t &config){
+        _resampler_config = config;
+        this->update_resamplers();
+        resampler_config_t actual = config;
+        if (not _resamplers.empty()){
+            const polyphase_resampler &resampler = *_resamplers.front();
+            actual.rate = _samp_rate*resampler.get_decim()/resampler.get_interp();
+        }
+        return actual;
     }
 
     /*!
@@ -98,26 +153,87 @@ public:
      */
     void set_xport_chan_get_buff(const size_t xport_chan, const get_buff_type &get_buff){
         _props.at(xport_chan).get_buff = get_buff;
+        _props.at(xport_chan).buff.reset(); //from the previous transport
+    }
+
+    /*!
+     * Set the function to flush committed buffers at the end of a burst.
+     * This is only needed for transports that defer (batch) sends.
+     * \param xport_chan which transport channel
+     * \param flush the flush function
+     */
+    void set_xport_chan_flush(const size_t xport_chan, const flush_type &flush){
+        _props.at(xport_chan).flush = flush;
+    }
+
+    /*!
+     * Set the function to wait for device buffer room for a whole burst.
+     * With a preload function on every channel, a timed burst sent in one
+     * call (start and end of burst) is only sent once all of its packets
+     * fit in the device buffer, so the burst is loaded ahead of its time
+     * and the host load during the burst cannot make it underflow.
+     * The function returns false on timeout, and throws when the
+     * burst can never fit. The resampled path does not preload.
+     * \param xport_chan which transport channel
+     * \param preload the function of the number of packets and timeout
+     */
+    void set_xport_chan_preload(const size_t xport_chan, const preload_type &preload){
+        _props.at(xport_chan).preload = preload;
+    }
+
+    //! Set the event counters of a transport channel for late samples
+    void set_event_counters(const size_t xport_chan, stream_event_counters::sptr counters){
+        _props.at(xport_chan).counters = counters;
+    }
+
+    //! What to do with a burst that starts too late on the device
+    enum late_policy_t{
+        LATE_POLICY_SEND, //send it anyway, the device reports a time error
+        LATE_POLICY_FLAG, //send it anyway, count the late samples
+        LATE_POLICY_DROP  //drop it on the host, count the late samples
+    };
+
+    /*!
+     * Check timed bursts against the device time before sending.
+     * Only the first packet of a burst is checked, the device
+     * discards the rest of a burst with a late start as well.
+     * A dropped packet is reported as sent without using a frame.
+     * \param policy what to do with a late burst
+     * \param time_now the earliest current device time (policy send ignores it)
+     * \param margin the seconds a packet needs to reach the device
+     */
+    void set_late_policy(const late_policy_t policy, const time_now_type &time_now, const double margin){
+        _late_policy = policy;
+        _late_time_now = time_now;
+        _late_margin = time_spec_t(margin);
+        _in_burst = _late_burst = false;
     }
 
     /*!
      * Setup the conversion functions (homogeneous across transports).
-     * Here, we load a table of converters for all possible io types.
+     * Here, we load a table of conversion plans for all possible io types.
      * This makes the converter look-up an O(1) operation.
      * \param otw_type the channel data type
      * \param width the streams per channel (usually 1)
      */
     void set_converter(const uhd::otw_type_t &otw_type, const size_t width = 1){
         _io_buffs.resize(width);
-        _converters.resize(128);
-        for (size_t io_type = 0; io_type < _converters.size(); io_type++){
-            try{
-                _converters[io_type] = uhd::convert::get_converter_cpu_to_otw(
-                    io_type_t::tid_t(io_type), otw_type, 1, width
-                );
-            }catch(const uhd::value_error &){} //we expect this, not all io_types valid...
-        }
         _bytes_per_item = otw_type.get_sample_size();
+        _otw_type = otw_type;
+        this->update_converters();
+        this->update_resamplers();
+    }
+
+    /*!
+     * Resolve the conversions for one io type only.
+     * A handler made for one stream needs a single conversion plan,
+     * and an otw format without a converter fails in set_converter().
+     * \param io_type the io type of the stream
+     */
+    void set_io_type(const uhd::io_type_t &io_type){
+        _single_io_type = true;
+        _io_tid = io_type.tid;
+        if (not _converters.empty()) this->update_converters();
     }
 
     /*!
@@ -129,14 +245,35 @@ public:
         _max_samples_per_packet = num_samps;
     }
 
-    //! Get a scoped lock object for this instance
+    /*!
+     * Get a scoped lock object for this instance.
+     * With a single owner, the fast path calls do not take the lock:
+     * once the owner made a call, only the owner may reconfigure.
+     */
     boost::mutex::scoped_lock get_scoped_lock(void){
-        return boost::mutex::scoped_lock(_mutex);
+        _mutex.lock();
+        if (_single_owner and _owner_id != boost::thread::id() and _owner_id != boost::this_thread::get_id()){
+            _mutex.unlock();
+            throw uhd::runtime_error("single owner: reconfiguration from a thread other than the streaming thread");
+        }
+        return boost::mutex::scoped_lock(_mutex, boost::adopt_lock);
     }
 
     //! Set the scale factor used in float conversion
     void set_scale_factor(const double scale_factor){
         _scale_factor = scale_factor;
+        if (not _converters.empty()) this->update_converters();
+    }
+
+    /*!
+     * Declare that a single thread makes all of the fast path calls.
+     * The per-call mutex is then skipped and the first caller is the owner.
+     * Calls and reconfiguration from any other thread throw.
+     * \param single_owner true to skip the per-call mutex
+     */
+    void set_single_owner(const bool single_owner){
+        _single_owner = single_owner;
+        _owner_id = boost::thread::id();
     }
 
     /*******************************************************************
@@ -152,21 +289,308 @@ public:
         uhd::device::send_mode_t send_mode,
         double timeout
     ){
+        UHD_TRACE_SCOPE("send");
+        boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+        this->lock_fast_path(lock);
+
+        if (not _resamplers.empty()) return send_resampled(
+            buffs, nsamps_per_buff, metadata, io_type, timeout
+        );
+        return send_dispatch(buffs, nsamps_per_buff, metadata, io_type, send_mode, timeout);
+    }
+
+    /*******************************************************************
+     * Send view:
+     * Hand out frames with the header space reserved,
+     * then pack the headers and commit after the caller wrote in place.
+     ******************************************************************/
+    UHD_INLINE size_t get_send_view(uhd::device::send_view_t &view, double timeout){
+        boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+        this->lock_fast_path(lock);
+        view.release();
+
+        //pack a header to learn the layout, it is packed again on commit
+        vrt::if_packet_info_t if_packet_info = this->make_if_packet_info(view.metadata);
+        if_packet_info.num_payload_words32 = 0;
+        if_packet_info.packet_count = 0;
+
+        if (not this->acquire_buffs(timeout)) return 0; //timeout
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            managed_send_buffer::sptr buff;
+            std::swap(buff, props.buff);
+            boost::uint32_t *otw_mem = buff->cast<boost::uint32_t *>() + _header_offset_words32;
+            _vrt_packer(otw_mem, if_packet_info);
+            view.payloads.push_back(otw_mem + if_packet_info.num_header_words32);
+            view.frames.push_back(buff);
+        }
+        view.num_header_words32 = if_packet_info.num_header_words32;
+        view.item_size = _bytes_per_item;
+        view.otw_type = _otw_type;
+        view.max_nsamps = _max_samples_per_packet*_io_buffs.size();
+        return view.max_nsamps;
+    }
+
+    UHD_INLINE size_t commit_send_view(uhd::device::send_view_t &view, const size_t nsamps){
+        boost::mutex::scoped_lock lock(_mutex, boost::defer_lock);
+        this->lock_fast_path(lock);
+        if (view.frames.size() != _props.size()) return 0; //nothing acquired
+        if (nsamps > view.max_nsamps) throw uhd::value_error(
+            "send view: more samples than the payload capacity"
+        );
+
+        vrt::if_packet_info_t if_packet_info = this->make_if_packet_info(view.metadata);
+        const size_t num_payload_bytes = nsamps*_bytes_per_item;
+        if_packet_info.num_payload_words32 = (num_payload_bytes + sizeof(boost::uint32_t) - 1)/sizeof(boost::uint32_t);
+        if_packet_info.packet_count = _next_packet_seq;
+
+        //drop a late burst, the frames go back unsent
+        const bool late = this->is_late(if_packet_info);
+        if (late and _late_policy == LATE_POLICY_DROP){
+            view.release();
+            this->update_burst(if_packet_info, nsamps, late);
+            return nsamps;
+        }
+
+        this->pack_header(if_packet_info);
+        if (if_packet_info.num_header_words32 != view.num_header_words32){
+            view.release();
+            throw uhd::value_error("send view: the header layout changed since acquired");
+        }
+
+        for (size_t i = 0; i < _props.size(); i++){
+            boost::uint32_t *otw_mem = view.frames[i]->cast<boost::uint32_t *>() + _header_offset_words32;
+            std::copy(_header, _header + if_packet_info.num_header_words32, otw_mem);
+
+            //zero the unused part of a partial word
+            char *payload_end = reinterpret_cast<char *>(view.payloads[i]) + num_payload_bytes;
+            std::fill(payload_end, reinterpret_cast<char *>(otw_mem + if_packet_info.num_packet_words32), 0);
+
+            size_t num_bytes_total = (_header_offset_words32+if_packet_info.num_packet_words32)*sizeof(boost::uint32_t);
+            view.frames[i]->commit(num_bytes_total);
+
+            //flush batched buffers so the end of burst is not held back
+            if (if_packet_info.eob and _props[i].flush) _props[i].flush();
+        }
+        view.release();
+        _next_packet_seq++; //increment sequence after commits
+        this->update_burst(if_packet_info, nsamps, late);
+        return nsamps;
+    }
+
+private:
+
+    //! Lock the per-call mutex unless a single thread owns the calls
+    UHD_INLINE void lock_fast_path(boost::mutex::scoped_lock &lock){
+        if (not _single_owner){
+            lock.lock();
+            return;
+        }
+        if (_owner_id != boost::this_thread::get_id()) this->claim_owner();
+    }
+
+    //! Make the calling thread the owner under the mutex, or throw when there is one
+    void claim_owner(void){
         boost::mutex::scoped_lock lock(_mutex);
+        UHD_ASSERT_THROW(_owner_id == boost::thread::id());
+        _owner_id = boost::this_thread::get_id();
+    }
 
-        //translate the metadata to vrt if packet info
+    boost::mutex _mutex;
+    late_policy_t _late_policy;
+    time_now_type _late_time_now;
+    time_spec_t _late_margin;
+    bool _in_burst, _late_burst; //burst state for the late policy
+    vrt_packer_type _vrt_packer;
+    size_t _header_offset_words32;
+    enum header_mode_t{
+        HEADER_MODE_NATIVE,  //cached headers are patched in host order
+        HEADER_MODE_SWAPPED, //cached headers are patched byteswapped
+        HEADER_MODE_REPACK   //unknown packer, every header is packed
+    } _header_mode;
+    boost::uint32_t _header[vrt::max_if_hdr_words32]; //the last packed header
+    vrt::if_packet_info_t _header_info; //the packet info of the last packed header
+    bool _header_cached;
+    double _tick_rate, _samp_rate;
+    boost::int64_t _ticks_per_samp; //zero when a sample is not a whole number of ticks
+    struct xport_chan_props_type{
+        get_buff_type get_buff;
+        flush_type flush;
+        preload_type preload;
+        stream_event_counters::sptr counters;
+        managed_send_buffer::sptr buff; //acquired, kept across a timeout
+    };
+    std::vector<xport_chan_props_type> _props;
+    std::vector<const void *> _io_buffs; //used in conversion
+    size_t _bytes_per_item; //used in conversion
+    std::vector<uhd::convert::plan_t> _converters; //used in conversion
+    uhd::otw_type_t _otw_type;
+    size_t _max_samples_per_packet;
+    std::vector<const void *> _zero_buffs;
+    size_t _next_packet_seq;
+    double _scale_factor;
+    bool _single_owner;
+    boost::thread::id _owner_id;
+    bool _single_io_type;
+    io_type_t::tid_t _io_tid; //the only io type when single
+    resampler_config_t _resampler_config;
+    std::vector<polyphase_resampler::sptr> _resamplers; //one per io buffer
+    std::vector<std::vector<polyphase_resampler::sample_type> > _resampler_outs;
+    std::vector<const void *> _resampler_out_ptrs;
+    size_t _resampler_fill; //outputs waiting in the output buffers
+    bool _resampler_fresh; //no input since a reset
+    uhd::tx_metadata_t _resampler_metadata; //for the next packet of outputs
+
+    //! Resolve the conversion plans for the otw type and scale factor
+    void update_converters(void){
+        _converters.assign(128, uhd::convert::plan_t());
+        for (size_t io_type = 0; io_type < _converters.size(); io_type++){
+            if (_single_io_type and io_type != size_t(_io_tid)) continue;
+            try{
+                _converters[io_type] = uhd::convert::plan_t(uhd::convert::get_converter_cpu_to_otw(
+                    io_type_t::tid_t(io_type), _otw_type, _io_buffs.size(), 1
+                ), _io_buffs.size(), 1, _scale_factor);
+            }catch(const uhd::value_error &){
+                //we expect this, not all io_types valid... but the only one must be
+                if (_single_io_type) throw;
+            }
+        }
+    }
+
+    //! Rebuild the resamplers for the rates and the channel layout
+    void update_resamplers(void){
+        _resamplers.clear();
+        if (_resampler_config.rate == 0) return;
+        const size_t num_buffs = this->size()*std::max<size_t>(1, _io_buffs.size());
+        _resampler_outs.resize(num_buffs);
+        _resampler_out_ptrs.resize(num_buffs);
+        for (size_t i = 0; i < num_buffs; i++){
+            _resamplers.push_back(polyphase_resampler::make(
+                _resampler_config.rate, _samp_rate,
+                _resampler_config.taps_per_phase, _resampler_config.max_phases
+            ));
+            _resampler_outs[i].resize(4096);
+            _resampler_out_ptrs[i] = &_resampler_outs[i].front();
+        }
+        this->reset_resamplers();
+    }
+
+    //! Start a new stream in the resamplers
+    void reset_resamplers(void){
+        BOOST_FOREACH(polyphase_resampler::sptr &resampler, _resamplers) resampler->reset();
+        _resampler_fill = 0;
+        _resampler_fresh = true;
+    }
+
+    //! Use integer tick math for sample offsets when the rates allow it
+    void update_ticks_per_samp(void){
+        const double ticks_per_samp = _tick_rate/_samp_rate;
+        const double rounded = std::floor(ticks_per_samp + 0.5);
+        _ticks_per_samp = (rounded >= 1 and std::abs(ticks_per_samp - rounded) < 1e-9*rounded)?
+            boost::int64_t(rounded) : 0;
+    }
+
+    //! Translate the metadata to vrt if packet info
+    UHD_INLINE vrt::if_packet_info_t make_if_packet_info(const uhd::tx_metadata_t &metadata){
         vrt::if_packet_info_t if_packet_info;
+        if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
         if_packet_info.has_sid = false;
         if_packet_info.has_cid = false;
         if_packet_info.has_tlr = false;
         if_packet_info.has_tsi = metadata.has_time_spec;
         if_packet_info.has_tsf = metadata.has_time_spec;
-        if_packet_info.tsi     = boost::uint32_t(metadata.time_spec.get_full_secs());
-        if_packet_info.tsf     = boost::uint64_t(metadata.time_spec.get_tick_count(_tick_rate));
+        const tick_time_t time(metadata.time_spec, _tick_rate);
+        if_packet_info.tsi     = boost::uint32_t(time.get_full_secs());
+        if_packet_info.tsf     = boost::uint64_t(time.get_ticks());
         if_packet_info.sob     = metadata.start_of_burst;
         if_packet_info.eob     = metadata.end_of_burst;
+        return if_packet_info;
+    }
+
+    //! Is this packet part of a burst that starts too late?
+    UHD_INLINE bool is_late(const vrt::if_packet_info_t &if_packet_info){
+        if (_late_policy == LATE_POLICY_SEND) return false;
+        if (_in_burst) return _late_burst;
+        if (not if_packet_info.has_tsf) return false;
+        const tick_time_t time(time_t(if_packet_info.tsi), boost::int64_t(if_packet_info.tsf), _tick_rate);
+        return time < tick_time_t(_late_time_now() + _late_margin, _tick_rate);
+    }
+
+    //! Track the burst state when a packet is sent or dropped
+    UHD_INLINE void update_burst(const vrt::if_packet_info_t &if_packet_info, const size_t nsamps, const bool late){
+        if (_late_policy == LATE_POLICY_SEND) return;
+        _in_burst = not if_packet_info.eob;
+        _late_burst = late and _in_burst;
+        if (not late) return;
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            if (props.counters) props.counters->record(stream_event_counters::EVENT_LATE_SAMPS, nsamps);
+        }
+    }
+
+    //! Store a header word in the byte order of the packer
+    UHD_INLINE boost::uint32_t header_word(const boost::uint32_t word) const{
+        return (_header_mode == HEADER_MODE_SWAPPED)? uhd::byteswap(word) : word;
+    }
+
+    /*!
+     * Pack the vrt header for a packet into the header cache.
+     * Within a burst only the count and the time change between packets,
+     * so those words are patched into the last header when the layout
+     * and size match; the first and last packets of a burst are repacked.
+     */
+    UHD_INLINE void pack_header(vrt::if_packet_info_t &if_packet_info){
+        if (
+            _header_cached and
+            if_packet_info.num_payload_words32 == _header_info.num_payload_words32 and
+            if_packet_info.sob     == _header_info.sob and
+            if_packet_info.eob     == _header_info.eob and
+            if_packet_info.has_tsi == _header_info.has_tsi and
+            if_packet_info.has_tsf == _header_info.has_tsf
+        ){
+            boost::uint32_t *word = _header;
+            const boost::uint32_t hdr_word = header_word(*word) & ~boost::uint32_t(0xf << 16);
+            *word++ = header_word(hdr_word | ((if_packet_info.packet_count & 0xf) << 16));
+            if (if_packet_info.has_tsi) *word++ = header_word(if_packet_info.tsi);
+            if (if_packet_info.has_tsf){
+                *word++ = header_word(boost::uint32_t(if_packet_info.tsf >> 32));
+                *word++ = header_word(boost::uint32_t(if_packet_info.tsf >> 0));
+            }
+            if_packet_info.num_header_words32 = _header_info.num_header_words32;
+            if_packet_info.num_packet_words32 = _header_info.num_packet_words32;
+            return;
+        }
+
+        _vrt_packer(_header, if_packet_info);
+        _header_info = if_packet_info;
+        _header_cached = _header_mode != HEADER_MODE_REPACK
+            and not if_packet_info.has_sid and not if_packet_info.has_cid;
+    }
+
+    /*******************************************************************
+     * Send dispatch:
+     * Split the buffer into combinations of single packet send calls.
+     ******************************************************************/
+    UHD_INLINE size_t send_dispatch(
+        const uhd::device::send_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata,
+        const uhd::io_type_t &io_type,
+        uhd::device::send_mode_t send_mode,
+        double timeout
+    ){
+        //translate the metadata to vrt if packet info
+        vrt::if_packet_info_t if_packet_info = this->make_if_packet_info(metadata);
 
         if (nsamps_per_buff <= _max_samples_per_packet) send_mode = uhd::device::SEND_MODE_ONE_PACKET;
+
+        //a whole timed burst waits for room in the device buffer, then goes out at once
+        if (metadata.has_time_spec and metadata.start_of_burst and metadata.end_of_burst){
+            const size_t num_packets = (send_mode == uhd::device::SEND_MODE_ONE_PACKET)?
+                1 : (nsamps_per_buff + _max_samples_per_packet - 1)/_max_samples_per_packet;
+            BOOST_FOREACH(xport_chan_props_type &props, _props){
+                if (props.preload and not props.preload(num_packets, timeout)) return 0; //timeout
+            }
+        }
+
         switch(send_mode){
 
         ////////////////////////////////////////////////////////////////
@@ -191,6 +615,7 @@ public:
         case uhd::device::SEND_MODE_FULL_BUFF:{
         ////////////////////////////////////////////////////////////////
             size_t total_num_samps_sent = 0;
+            const tick_time_t start_time(metadata.time_spec, _tick_rate);
 
             //false until final fragment
             if_packet_info.eob = false;
@@ -211,9 +636,17 @@ public:
                 if (num_samps_sent == 0) return total_num_samps_sent;
 
                 //setup metadata for the next fragment
-                const time_spec_t time_spec = metadata.time_spec + time_spec_t(0, total_num_samps_sent, _samp_rate);
-                if_packet_info.tsi = boost::uint32_t(time_spec.get_full_secs());
-                if_packet_info.tsf = boost::uint64_t(time_spec.get_tick_count(_tick_rate));
+                if (_ticks_per_samp != 0){ //exact integer math, does not drift
+                    tick_time_t time = start_time;
+                    time += boost::int64_t(total_num_samps_sent)*_ticks_per_samp;
+                    if_packet_info.tsi = boost::uint32_t(time.get_full_secs());
+                    if_packet_info.tsf = boost::uint64_t(time.get_ticks());
+                }
+                else{
+                    const tick_time_t time(metadata.time_spec + time_spec_t(0, total_num_samps_sent, _samp_rate), _tick_rate);
+                    if_packet_info.tsi = boost::uint32_t(time.get_full_secs());
+                    if_packet_info.tsf = boost::uint64_t(time.get_ticks());
+                }
                 if_packet_info.sob = false;
 
             }
@@ -231,23 +664,117 @@ public:
         }//switch(send_mode)
     }
 
-private:
+    /*******************************************************************
+     * Send through the resamplers:
+     * Copy the samples into the resamplers input,
+     * then send the outputs whenever the output buffers fill.
+     * The end of a burst flushes the filter tail with zeros.
+     * On a timeout, the buffered samples are dropped.
+     ******************************************************************/
+    UHD_INLINE size_t send_resampled(
+        const uhd::device::send_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata,
+        const uhd::io_type_t &io_type,
+        double timeout
+    ){
+        typedef polyphase_resampler::sample_type sample_type;
+        if (io_type.tid != io_type_t::COMPLEX_FLOAT32) throw uhd::value_error(
+            "send packet handler: the host resampler needs complex float samples"
+        );
+        if (buffs.size() != _resamplers.size()) throw uhd::value_error(
+            "send packet handler: one buffer per channel needed to resample"
+        );
+
+        //a burst starts a new stream, sent early by the filter delay
+        if (metadata.start_of_burst) this->reset_resamplers();
+        if (_resampler_fresh){
+            const polyphase_resampler &resampler = *_resamplers.front();
+            const double host_rate = _samp_rate*resampler.get_decim()/resampler.get_interp();
+            _resampler_metadata.has_time_spec = metadata.has_time_spec;
+            _resampler_metadata.time_spec = metadata.time_spec - time_spec_t(resampler.get_delay()/host_rate);
+            _resampler_metadata.start_of_burst = metadata.start_of_burst;
+            _resampler_fresh = false;
+        }
 
-    boost::mutex _mutex;
-    vrt_packer_type _vrt_packer;
-    size_t _header_offset_words32;
-    double _tick_rate, _samp_rate;
-    struct xport_chan_props_type{
-        get_buff_type get_buff;
-    };
-    std::vector<xport_chan_props_type> _props;
-    std::vector<const void *> _io_buffs; //used in conversion
-    size_t _bytes_per_item; //used in conversion
-    std::vector<uhd::convert::function_type> _converters; //used in conversion
-    size_t _max_samples_per_packet;
-    std::vector<const void *> _zero_buffs;
-    size_t _next_packet_seq;
-    double _scale_factor;
+        size_t num_consumed = 0;
+        while (true){
+            if (not this->send_resampler_outputs(timeout)) return num_consumed;
+            if (num_consumed == nsamps_per_buff) break;
+            const size_t num_samps = std::min(nsamps_per_buff - num_consumed, _resamplers.front()->get_input_space());
+            for (size_t i = 0; i < _resamplers.size(); i++){
+                const sample_type *in = reinterpret_cast<const sample_type *>(buffs[i]) + num_consumed;
+                std::copy(in, in + num_samps, _resamplers[i]->get_input_buff());
+                _resamplers[i]->commit_input(num_samps);
+            }
+            num_consumed += num_samps;
+        }
+
+        //push zeros through to get the outputs of the last samples
+        if (metadata.end_of_burst){
+            const size_t num_samps = size_t(2*_resamplers.front()->get_delay()) + 1;
+            BOOST_FOREACH(polyphase_resampler::sptr &resampler, _resamplers){
+                sample_type *in = resampler->get_input_buff();
+                std::fill(in, in + num_samps, sample_type());
+                resampler->commit_input(num_samps);
+            }
+            if (not this->send_resampler_outputs(timeout)) return num_consumed;
+        }
+
+        //send what is left now, there may be no next call
+        const bool sent = this->send_resampler_fill(metadata.end_of_burst, timeout);
+        if (metadata.end_of_burst) this->reset_resamplers();
+        return (sent)? num_consumed : 0;
+    }
+
+    //! Resample the buffered input, send each time the outputs fill up
+    UHD_INLINE bool send_resampler_outputs(double timeout){
+        while (true){
+            size_t num_samps = 0;
+            for (size_t i = 0; i < _resamplers.size(); i++){
+                num_samps = _resamplers[i]->get_output(
+                    &_resampler_outs[i][_resampler_fill], _resampler_outs[i].size() - _resampler_fill
+                );
+            }
+            _resampler_fill += num_samps;
+            if (_resampler_fill < _resampler_outs.front().size()) return true;
+            if (not this->send_resampler_fill(false, timeout)) return false;
+        }
+    }
+
+    //! Send the outputs filled so far, only the first packet of a stream is timed
+    UHD_INLINE bool send_resampler_fill(const bool eob, double timeout){
+        if (_resampler_fill == 0 and not eob) return true;
+        uhd::tx_metadata_t metadata = _resampler_metadata;
+        metadata.end_of_burst = eob;
+        const size_t num_sent = send_dispatch(
+            _resampler_out_ptrs, _resampler_fill, metadata,
+            io_type_t::COMPLEX_FLOAT32, uhd::device::SEND_MODE_FULL_BUFF, timeout
+        );
+        if (num_sent != _resampler_fill){
+            this->reset_resamplers();
+            return false;
+        }
+        _resampler_fill = 0;
+        _resampler_metadata.has_time_spec = false;
+        _resampler_metadata.start_of_burst = false;
+        return true;
+    }
+
+    /*******************************************************************
+     * Acquire buffers:
+     * Get a buffer for every channel before any of them is filled.
+     * On a timeout, the buffers acquired so far are kept for the next call,
+     * so that no channel sends a packet that the other channels did not.
+     ******************************************************************/
+    UHD_INLINE bool acquire_buffs(double timeout){
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            if (props.buff.get() != NULL) continue;
+            props.buff = props.get_buff(timeout);
+            if (props.buff.get() == NULL) return false;
+        }
+        return true;
+    }
 
     /*******************************************************************
      * Send a single packet:
@@ -261,13 +788,25 @@ private:
         const size_t buffer_offset_bytes = 0
     ){
         //load the rest of the if_packet_info in here
-        if_packet_info.num_payload_words32 = (nsamps_per_buff*_io_buffs.size()*_bytes_per_item)/sizeof(boost::uint32_t);
+        //round up: packed formats with less than 32 bits per sample may end mid-word
+        const size_t num_payload_bytes = nsamps_per_buff*_io_buffs.size()*_bytes_per_item;
+        if_packet_info.num_payload_words32 = (num_payload_bytes + sizeof(boost::uint32_t) - 1)/sizeof(boost::uint32_t);
         if_packet_info.packet_count = _next_packet_seq;
 
+        //drop a late burst before it takes any frames
+        const bool late = this->is_late(if_packet_info);
+        if (late and _late_policy == LATE_POLICY_DROP){
+            this->update_burst(if_packet_info, nsamps_per_buff, late);
+            return nsamps_per_buff;
+        }
+
+        if (not this->acquire_buffs(timeout)) return 0; //timeout
+        this->pack_header(if_packet_info);
+
         size_t buff_index = 0;
         BOOST_FOREACH(xport_chan_props_type &props, _props){
-            managed_send_buffer::sptr buff = props.get_buff(timeout);
-            if (buff.get() == NULL) return 0; //timeout
+            managed_send_buffer::sptr buff;
+            std::swap(buff, props.buff);
 
             //fill a vector with pointers to the io buffers
             BOOST_FOREACH(const void *&io_buff, _io_buffs){
@@ -275,23 +814,79 @@ private:
             }
             boost::uint32_t *otw_mem = buff->cast<boost::uint32_t *>() + _header_offset_words32;
 
-            //pack metadata into a vrt header
-            _vrt_packer(otw_mem, if_packet_info);
+            //copy in the vrt header, it is the same on every channel
+            std::copy(_header, _header + if_packet_info.num_header_words32, otw_mem);
             otw_mem += if_packet_info.num_header_words32;
 
-            //copy-convert the samples into the send buffer
-            _converters[io_type.tid](_io_buffs, otw_mem, nsamps_per_buff, _scale_factor);
+            //copy-convert the samples into the send buffer, zero the partial word
+            if (num_payload_bytes % sizeof(boost::uint32_t) != 0) otw_mem[if_packet_info.num_payload_words32-1] = 0;
+            void *output = otw_mem;
+            {
+                UHD_TRACE_SCOPE("send_convert");
+                _converters[io_type.tid](&_io_buffs.front(), &output, nsamps_per_buff);
+            }
 
             //commit the samples to the zero-copy interface
             size_t num_bytes_total = (_header_offset_words32+if_packet_info.num_packet_words32)*sizeof(boost::uint32_t);
             buff->commit(num_bytes_total);
 
+            //flush batched buffers so the end of burst is not held back
+            if (if_packet_info.eob and props.flush) props.flush();
         }
         _next_packet_seq++; //increment sequence after commits
+        this->update_burst(if_packet_info, nsamps_per_buff, late);
         return nsamps_per_buff;
     }
 };
 
+/***********************************************************************
+ * Send packet streamer
+ *
+ * A send packet handler made for one stream of a device.
+ * The io type is bound and resolved when the stream is made,
+ * the device configures the handler for the stream's channels.
+ **********************************************************************/
+class send_packet_streamer : public send_packet_handler, public uhd::tx_streamer{
+public:
+    typedef boost::shared_ptr<send_packet_streamer> sptr;
+
+    /*!
+     * Make a new packet streamer for send
+     * \param io_type the io type of the stream
+     * \param max_num_samps the maximum samples per packet
+     */
+    send_packet_streamer(const uhd::io_type_t &io_type, const size_t max_num_samps):
+        _io_type(io_type), _max_num_samps(max_num_samps)
+    {
+        this->set_io_type(io_type);
+        this->set_max_samples_per_packet(max_num_samps);
+    }
+
+    size_t get_num_channels(void) const{
+        return this->size();
+    }
+
+    size_t get_max_num_samps(void) const{
+        return _max_num_samps;
+    }
+
+    size_t send(
+        const tx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata,
+        double timeout
+    ){
+        return send_packet_handler::send(
+            buffs, nsamps_per_buff, metadata, _io_type,
+            uhd::device::SEND_MODE_FULL_BUFF, timeout
+        );
+    }
+
+private:
+    const uhd::io_type_t _io_type;
+    const size_t _max_num_samps;
+};
+
 }}} //namespace
 
 #endif /* INCLUDED_LIBUHD_TRANSPORT_SUPER_SEND_PACKET_HANDLER_HPP */
@@ -0,0 +1,136 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/transport/transport_profile.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/log.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/join.hpp>
+#include <fstream>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+fs::path get_profile_path(void); //defined in paths.cpp
+
+/***********************************************************************
+ * The profile is one line with the hints as an args string
+ **********************************************************************/
+std::string uhd::transport::get_transport_profile_path(const device_addr_t &dev_addr){
+    std::string id;
+    if (dev_addr.has_key("serial") and not dev_addr["serial"].empty()) id = dev_addr["serial"];
+    else if (dev_addr.has_key("addr") and not dev_addr["addr"].empty()) id = dev_addr["addr"];
+    else return "";
+
+    const std::string name = dev_addr.get("type", "device") + "_" + id + ".profile";
+    return (get_profile_path() / name).string();
+}
+
+uhd::device_addr_t uhd::transport::load_transport_profile(const device_addr_t &dev_addr){
+    const std::string path = get_transport_profile_path(dev_addr);
+    if (path.empty()) return device_addr_t();
+
+    std::ifstream file(path.c_str());
+    if (not file.good()) return device_addr_t();
+    std::string line;
+    std::getline(file, line);
+    UHD_LOG << "Loaded the transport profile " << path << ": " << line << std::endl;
+    return device_addr_t(line);
+}
+
+std::string uhd::transport::save_transport_profile(
+    const device_addr_t &dev_addr, const device_addr_t &profile
+){
+    const std::string path = get_transport_profile_path(dev_addr);
+    if (path.empty()) throw uhd::value_error(
+        "transport profile: the device has no serial or address\n" + dev_addr.to_pp_string()
+    );
+
+    try{
+        fs::create_directories(fs::path(path).parent_path());
+    }
+    catch(const fs::filesystem_error &e){
+        throw uhd::io_error("transport profile: " + std::string(e.what()));
+    }
+
+    std::ofstream file(path.c_str());
+    file << profile.to_string() << std::endl;
+    if (not file.good()) throw uhd::io_error("transport profile: cannot write " + path);
+    return path;
+}
+
+/***********************************************************************
+ * Named profiles:
+ *  - usrp2: udp_zero_copy hints plus the control, pirate, and flow control keys.
+ *  - usrp1 and b100: libusb1_zero_copy hints plus the send window.
+ *  - e100: the driver notification batching and the demux thread.
+ *  - Frame sizes above the path MTU are reduced by the MTU discovery.
+ **********************************************************************/
+struct named_profile_t{
+    const char *name;
+    const char *type;
+    const char *hints;
+};
+
+static const named_profile_t named_profiles[] = {
+    {"low_latency", "usrp2",
+        "recv_frame_size=1472, send_frame_size=1472, num_recv_frames=32, num_send_frames=16, "
+        "recv_busy_poll=50e-6, ctrl_busy_poll=50e-6, send_window_time=0.002, pirate_sched=fifo:0.8"},
+    {"low_latency", "usrp1",
+        "recv_frame_size=2048, send_frame_size=2048, num_recv_frames=16, num_send_frames=16, "
+        "send_window_time=0.002, event_sched=fifo:0.8"},
+    {"low_latency", "b100",
+        "recv_frame_size=2048, send_frame_size=2048, num_recv_frames=16, num_send_frames=16, "
+        "send_window_time=0.002, event_sched=fifo:0.8, ctrl_sched=fifo:0.8"},
+    {"low_latency", "e100", "send_batch=1, demux_thread=1"},
+    {"low_latency", "sim", "recv_frame_size=1472, send_frame_size=1472, num_recv_frames=32"},
+
+    {"throughput", "usrp2",
+        "recv_frame_size=8000, send_frame_size=8000, num_recv_frames=256, num_send_frames=64, "
+        "recv_buff_size=50e6, recv_batch=32, send_batch=16, recv_lookahead=1"},
+    {"throughput", "usrp1",
+        "recv_frame_size=16384, send_frame_size=16384, num_recv_frames=64, num_send_frames=64"},
+    {"throughput", "b100",
+        "recv_frame_size=16384, send_frame_size=16384, num_recv_frames=64, num_send_frames=64"},
+    {"throughput", "e100", "send_batch=8, demux_thread=1"},
+    {"throughput", "sim", "recv_frame_size=8000, send_frame_size=8000, num_recv_frames=256"},
+
+    {"low_cpu", "usrp2",
+        "recv_frame_size=8000, send_frame_size=8000, num_recv_frames=128, num_send_frames=32, "
+        "recv_batch=32, send_batch=32, send_batch_timeout=0.005, pirate_threads=1"},
+    {"low_cpu", "usrp1",
+        "recv_frame_size=16384, send_frame_size=16384, num_recv_frames=32, num_send_frames=32"},
+    {"low_cpu", "b100",
+        "recv_frame_size=16384, send_frame_size=16384, num_recv_frames=32, num_send_frames=32"},
+    {"low_cpu", "e100", "send_batch=16, send_batch_timeout=0.005"},
+    {"low_cpu", "sim", "recv_frame_size=8000, send_frame_size=8000, num_recv_frames=128"},
+};
+
+uhd::device_addr_t uhd::transport::get_named_transport_profile(const std::string &name, const std::string &type){
+    bool known_name = false;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < sizeof(named_profiles)/sizeof(named_profiles[0]); i++){
+        if (names.empty() or names.back() != named_profiles[i].name) names.push_back(named_profiles[i].name);
+        if (name != named_profiles[i].name) continue;
+        known_name = true;
+        if (type == named_profiles[i].type) return device_addr_t(named_profiles[i].hints);
+    }
+    if (not known_name) throw uhd::key_error(
+        "unknown profile " + name + ", expected one of " + boost::algorithm::join(names, ", ")
+    );
+    return device_addr_t();
+}
@@ -19,7 +19,13 @@
 #define INCLUDED_LIBUHD_TRANSPORT_VRT_PACKET_HANDLER_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
 #include <boost/asio.hpp>
+#include <algorithm>
+#include <vector>
+#ifndef UHD_PLATFORM_WIN32
+#include <poll.h>
+#endif
 
 namespace uhd{ namespace transport{
 
@@ -48,6 +54,65 @@ namespace uhd{ namespace transport{
         return ::select(sock_fd+1, &rset, NULL, NULL, &tv) > 0;
     }
 
+    /*!
+     * Wait for any of several sockets to become ready for receive.
+     * \param sock_fds the open socket file descriptors
+     * \param timeout the timeout duration in seconds
+     * \param ready set true for each socket that is ready
+     * \return true when at least one socket is ready
+     */
+    UHD_INLINE bool wait_for_recv_ready(
+        const std::vector<int> &sock_fds, double timeout, std::vector<bool> &ready
+    ){
+        ready.assign(sock_fds.size(), false);
+        #ifdef UHD_PLATFORM_WIN32
+        timeval tv;
+        tv.tv_sec = int(timeout);
+        tv.tv_usec = int(timeout*1000000)%1000000;
+
+        fd_set rset;
+        FD_ZERO(&rset);
+        int max_fd = 0;
+        for (size_t i = 0; i < sock_fds.size(); i++){
+            FD_SET(sock_fds[i], &rset);
+            max_fd = std::max(max_fd, sock_fds[i]);
+        }
+        if (::select(max_fd+1, &rset, NULL, NULL, &tv) <= 0) return false;
+        for (size_t i = 0; i < sock_fds.size(); i++){
+            ready[i] = FD_ISSET(sock_fds[i], &rset) != 0;
+        }
+        return true;
+        #else
+        //poll has no limit on the descriptor values unlike select
+        std::vector<pollfd> pfds(sock_fds.size());
+        for (size_t i = 0; i < sock_fds.size(); i++){
+            pfds[i].fd = sock_fds[i];
+            pfds[i].events = POLLIN;
+            pfds[i].revents = 0;
+        }
+        if (pfds.empty() or ::poll(&pfds.front(), pfds.size(), int(timeout*1000)) <= 0) return false;
+        for (size_t i = 0; i < sock_fds.size(); i++){
+            ready[i] = (pfds[i].revents & (POLLIN | POLLERR)) != 0;
+        }
+        return true;
+        #endif
+    }
+
+    /*!
+     * Get the poll descriptors for receive readiness on a socket.
+     * Win32 socket handles are not poll descriptors,
+     * so the set is empty there and the socket cannot be polled.
+     * \param sock_fd the open socket file descriptor
+     * \return a set of poll descriptors
+     */
+    UHD_INLINE poll_fds_t get_recv_poll_fds(int sock_fd){
+        #ifdef UHD_PLATFORM_WIN32
+        return poll_fds_t();
+        #else
+        return poll_fds_t(1, poll_fd_t(sock_fd, POLLIN));
+        #endif
+    }
+
 }} //namespace uhd::transport
 
 #endif /* INCLUDED_LIBUHD_TRANSPORT_VRT_PACKET_HANDLER_HPP */
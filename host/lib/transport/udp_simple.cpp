@@ -18,7 +18,9 @@
 #include "udp_common.hpp"
 #include <uhd/transport/udp_simple.hpp>
 #include <uhd/utils/log.hpp>
+#include <uhd/utils/msg.hpp>
 #include <boost/format.hpp>
+#include <boost/thread/thread_time.hpp>
 
 using namespace uhd::transport;
 namespace asio = boost::asio;
@@ -29,8 +31,9 @@ namespace asio = boost::asio;
 class udp_simple_impl : public udp_simple{
 public:
     udp_simple_impl(
-        const std::string &addr, const std::string &port, bool bcast, bool connect
-    ):_connected(connect){
+        const std::string &addr, const std::string &port, bool bcast, bool connect,
+        const double recv_busy_poll = 0.0
+    ):_connected(connect), _recv_busy_poll(recv_busy_poll){
         UHD_LOG << boost::format("Creating udp transport for %s %s") % addr % port << std::endl;
 
         //resolve the address
@@ -48,6 +51,18 @@ public:
         //connect the socket
         if (connect) _socket->connect(_receiver_endpoint);
 
+        //let blocking receives poll the device queue in the kernel
+        if (_recv_busy_poll > 0){
+            #ifdef SO_BUSY_POLL
+            int busy_poll_us = int(_recv_busy_poll*1e6);
+            if (::setsockopt(_socket->native(), SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us)) < 0){
+                UHD_LOG << "could not set SO_BUSY_POLL on the udp socket" << std::endl;
+            }
+            #endif /*SO_BUSY_POLL*/
+            #ifndef MSG_DONTWAIT
+            UHD_MSG(warning) << "The recv_busy_poll hint is not supported on this platform." << std::endl;
+            #endif /*MSG_DONTWAIT*/
+        }
     }
 
     size_t send(const asio::const_buffer &buff){
@@ -56,12 +71,30 @@ public:
     }
 
     size_t recv(const asio::mutable_buffer &buff, double timeout){
+        //in busy poll mode, spin on non-blocking receives before blocking,
+        //a control reply is seen as soon as it arrives, not when the thread wakes
+        #ifdef MSG_DONTWAIT
+        if (_recv_busy_poll > 0 and timeout > 0){
+            const double spin_time = std::min(timeout, _recv_busy_poll);
+            const boost::system_time exit_time = boost::get_system_time() +
+                boost::posix_time::microseconds(long(spin_time*1e6));
+            do{
+                const ssize_t ret = ::recv(
+                    _socket->native(), asio::buffer_cast<char *>(buff), asio::buffer_size(buff), MSG_DONTWAIT
+                );
+                if (ret >= 0) return size_t(ret);
+            } while (boost::get_system_time() < exit_time);
+            timeout -= spin_time;
+            if (timeout <= 0) return 0;
+        }
+        #endif /*MSG_DONTWAIT*/
         if (not wait_for_recv_ready(_socket->native(), timeout)) return 0;
         return _socket->receive(asio::buffer(buff));
     }
 
 private:
     bool                    _connected;
+    const double            _recv_busy_poll; //the time in seconds to spin before blocking
     asio::io_service        _io_service;
     socket_sptr             _socket;
     asio::ip::udp::endpoint _receiver_endpoint;
@@ -71,9 +104,11 @@ private:
  * UDP public make functions
  **********************************************************************/
 udp_simple::sptr udp_simple::make_connected(
-    const std::string &addr, const std::string &port
+    const std::string &addr, const std::string &port, const device_addr_t &hints
 ){
-    return sptr(new udp_simple_impl(addr, port, false, true /* no bcast, connect */));
+    return sptr(new udp_simple_impl(addr, port, false, true, /* no bcast, connect */
+        hints.cast<double>("recv_busy_poll", 0.0)
+    ));
 }
 
 udp_simple::sptr udp_simple::make_broadcast(
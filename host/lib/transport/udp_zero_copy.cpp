@@ -20,10 +20,23 @@
 #include <uhd/transport/udp_simple.hpp> //mtu
 #include <uhd/transport/bounded_buffer.hpp>
 #include <uhd/transport/buffer_pool.hpp>
+#include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
+#include <uhd/utils/trace.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/format.hpp>
+#include <algorithm>
 #include <list>
+#include <vector>
+#include <cstring>
+
+#ifdef HAVE_SO_TIMESTAMPING
+#include <linux/net_tstamp.h>
+#include <time.h>
+#endif /*HAVE_SO_TIMESTAMPING*/
 
 using namespace uhd;
 using namespace uhd::transport;
@@ -32,6 +45,9 @@ namespace asio = boost::asio;
 //A reasonable number of frames for send/recv and async/sync
 static const size_t DEFAULT_NUM_FRAMES = 32;
 
+//The longest time that a batched send buffer should be held back
+static const double DEFAULT_SEND_BATCH_TIMEOUT = 0.001;
+
 /***********************************************************************
  * Check registry for correct fast-path setting (windows only)
  **********************************************************************/
@@ -65,22 +81,37 @@ static void check_registry_for_fast_send_threshold(const size_t mtu){
  **********************************************************************/
 class udp_zero_copy_asio_mrb : public managed_recv_buffer{
 public:
-    udp_zero_copy_asio_mrb(void *mem, bounded_buffer<udp_zero_copy_asio_mrb *> &pending):
-        _mem(mem), _len(0), _pending(pending){/* NOP */}
+    udp_zero_copy_asio_mrb(
+        void *mem, bounded_buffer<udp_zero_copy_asio_mrb *> &pending, zero_copy_stats_t &stats
+    ):
+        _mem(mem), _len(0), _pending(pending), _stats(stats), _has_timestamp(false){/* NOP */}
 
     void release(void){
         if (_len == 0) return;
         _pending.push_with_haste(this);
         _len = 0;
+        _stats.release_recv();
     }
 
     sptr get_new(size_t len){
         _len = len;
+        _stats.claim_recv(len);
         return make_managed_buffer(this);
     }
 
     template <class T> T cast(void) const{return static_cast<T>(_mem);}
 
+    //! Set the receive timestamp of the next frame, or clear it
+    void set_recv_timestamp(const bool has_timestamp, const time_spec_t &timestamp = time_spec_t(0.0)){
+        _has_timestamp = has_timestamp;
+        _timestamp = timestamp;
+    }
+
+    bool get_recv_timestamp(time_spec_t &time) const{
+        time = _timestamp;
+        return _has_timestamp;
+    }
+
 private:
     const void *get_buff(void) const{return _mem;}
     size_t get_size(void) const{return _len;}
@@ -88,27 +119,78 @@ private:
     void *_mem;
     size_t _len;
     bounded_buffer<udp_zero_copy_asio_mrb *> &_pending;
+    zero_copy_stats_t &_stats;
+    bool _has_timestamp;
+    time_spec_t _timestamp;
+};
+
+/***********************************************************************
+ * Batch of committed send buffers:
+ *  - Committed buffers are queued with their lengths.
+ *  - The queue is sent with a single sendmmsg() call when
+ *    it is full, when it is older than the timeout, or on flush.
+ *  - The age is checked on push and when a send buffer is requested,
+ *    and the queue is flushed before waiting on a free buffer.
+ *  - Sent buffers are pushed back into the pending queue.
+ **********************************************************************/
+class udp_zero_copy_asio_msb;
+
+class udp_zero_copy_asio_send_batch{
+public:
+    udp_zero_copy_asio_send_batch(
+        size_t batch_size, double timeout,
+        bounded_buffer<udp_zero_copy_asio_msb *> &pending, int sock_fd
+    );
+
+    void push(udp_zero_copy_asio_msb *msb, void *mem, size_t len);
+
+    void flush(void);
+
+    //! Flush when the oldest queued buffer is older than the timeout
+    UHD_INLINE void flush_expired(void){
+        if (_num_queued != 0 and boost::get_system_time() >= _deadline) this->flush();
+    }
+
+private:
+    const size_t _batch_size;
+    const boost::posix_time::time_duration _timeout;
+    bounded_buffer<udp_zero_copy_asio_msb *> &_pending;
+    const int _sock_fd;
+    size_t _num_queued;
+    boost::system_time _deadline;
+    std::vector<udp_zero_copy_asio_msb *> _msbs;
+    #ifdef HAVE_SENDMMSG
+    std::vector<iovec> _iovs;
+    std::vector<mmsghdr> _msgs;
+    #endif /*HAVE_SENDMMSG*/
 };
 
 /***********************************************************************
  * Reusable managed send buffer:
  *  - Initialize with memory and a commit callback.
  *  - Call get new with a length in bytes to re-use.
+ *  - When a batch is provided, commit defers the send to the batch.
  **********************************************************************/
 class udp_zero_copy_asio_msb : public managed_send_buffer{
 public:
-    udp_zero_copy_asio_msb(void *mem, bounded_buffer<udp_zero_copy_asio_msb *> &pending, int sock_fd):
-        _mem(mem), _len(0), _pending(pending), _sock_fd(sock_fd){/* NOP */}
+    udp_zero_copy_asio_msb(
+        void *mem, bounded_buffer<udp_zero_copy_asio_msb *> &pending, int sock_fd,
+        zero_copy_stats_t &stats, udp_zero_copy_asio_send_batch *batch = NULL
+    ):
+        _mem(mem), _len(0), _pending(pending), _sock_fd(sock_fd), _stats(stats), _batch(batch){/* NOP */}
 
     void commit(size_t len){
         if (_len == 0) return;
+        _len = 0;
+        _stats.commit_send(len);
+        if (_batch != NULL) return _batch->push(this, _mem, len);
         ::send(_sock_fd, this->cast<const char *>(), len, 0);
         _pending.push_with_haste(this);
-        _len = 0;
     }
 
     sptr get_new(size_t len){
         _len = len;
+        _stats.claim_send();
         return make_managed_buffer(this);
     }
 
@@ -120,8 +202,61 @@ private:
     size_t _len;
     bounded_buffer<udp_zero_copy_asio_msb *> &_pending;
     int _sock_fd;
+    zero_copy_stats_t &_stats;
+    udp_zero_copy_asio_send_batch *_batch;
 };
 
+udp_zero_copy_asio_send_batch::udp_zero_copy_asio_send_batch(
+    size_t batch_size, double timeout,
+    bounded_buffer<udp_zero_copy_asio_msb *> &pending, int sock_fd
+):
+    _batch_size(batch_size),
+    _timeout(boost::posix_time::microseconds(long(timeout*1e6))),
+    _pending(pending),
+    _sock_fd(sock_fd),
+    _num_queued(0),
+    _msbs(batch_size, NULL)
+{
+    #ifdef HAVE_SENDMMSG
+    _iovs.resize(batch_size);
+    _msgs.resize(batch_size);
+    std::memset(&_msgs.front(), 0, _msgs.size()*sizeof(mmsghdr));
+    for (size_t i = 0; i < batch_size; i++){
+        _msgs[i].msg_hdr.msg_iov = &_iovs[i];
+        _msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    #endif /*HAVE_SENDMMSG*/
+}
+
+void udp_zero_copy_asio_send_batch::push(udp_zero_copy_asio_msb *msb, void *mem, size_t len){
+    const boost::system_time now = boost::get_system_time();
+    if (_num_queued == 0) _deadline = now + _timeout;
+    _msbs[_num_queued] = msb;
+    #ifdef HAVE_SENDMMSG
+    _iovs[_num_queued].iov_base = mem;
+    _iovs[_num_queued].iov_len = len;
+    #else
+    ::send(_sock_fd, static_cast<const char *>(mem), len, 0);
+    #endif /*HAVE_SENDMMSG*/
+    _num_queued++;
+    if (_num_queued == _batch_size or now >= _deadline) this->flush();
+}
+
+void udp_zero_copy_asio_send_batch::flush(void){
+    #ifdef HAVE_SENDMMSG
+    size_t num_sent = 0;
+    while (num_sent < _num_queued){
+        const int ret = ::sendmmsg(_sock_fd, &_msgs[num_sent], _num_queued - num_sent, 0);
+        if (ret <= 0) break; //error: the remainder is dropped like a failed send()
+        num_sent += size_t(ret);
+    }
+    #endif /*HAVE_SENDMMSG*/
+    for (size_t i = 0; i < _num_queued; i++){
+        _pending.push_with_haste(_msbs[i]);
+    }
+    _num_queued = 0;
+}
+
 /***********************************************************************
  * Zero Copy UDP implementation with ASIO:
  *   This is the portable zero copy implementation for systems
@@ -142,10 +277,23 @@ public:
         _num_recv_frames(size_t(hints.cast<double>("num_recv_frames", DEFAULT_NUM_FRAMES))),
         _send_frame_size(size_t(hints.cast<double>("send_frame_size", udp_simple::mtu))),
         _num_send_frames(size_t(hints.cast<double>("num_send_frames", DEFAULT_NUM_FRAMES))),
-        _recv_buffer_pool(buffer_pool::make(_num_recv_frames, _recv_frame_size)),
-        _send_buffer_pool(buffer_pool::make(_num_send_frames, _send_frame_size)),
+        _recv_buffer_pool(buffer_pool::make(_num_recv_frames, _recv_frame_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints, "recv")
+        )),
+        _send_buffer_pool(buffer_pool::make(_num_send_frames, _send_frame_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints, "send")
+        )),
         _pending_recv_buffs(_num_recv_frames),
-        _pending_send_buffs(_num_send_frames)
+        _pending_send_buffs(_num_send_frames),
+        _recv_batch(std::max<size_t>(1, std::min<size_t>(_num_recv_frames,
+            size_t(hints.cast<double>("recv_batch", 1))
+        ))),
+        _send_batch(std::max<size_t>(1, std::min<size_t>(_num_send_frames,
+            size_t(hints.cast<double>("send_batch", 1))
+        ))),
+        _recv_busy_poll(hints.cast<double>("recv_busy_poll", 0.0)),
+        _recv_timestamping(hints.get("recv_timestamping", "")),
+        _recv_timestamp_index(-1)
     {
         UHD_LOG << boost::format("Creating udp transport for %s %s") % addr % port << std::endl;
 
@@ -164,21 +312,67 @@ public:
         _socket->connect(receiver_endpoint);
         _sock_fd = _socket->native();
 
+        //let blocking receives poll the device queue in the kernel
+        if (_recv_busy_poll > 0){
+            #ifdef SO_BUSY_POLL
+            int busy_poll_us = int(_recv_busy_poll*1e6);
+            if (::setsockopt(_sock_fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us)) < 0){
+                UHD_LOG << "could not set SO_BUSY_POLL on the udp socket" << std::endl;
+            }
+            #endif /*SO_BUSY_POLL*/
+            #ifndef MSG_DONTWAIT
+            UHD_MSG(warning) << "The recv_busy_poll hint is not supported on this platform." << std::endl;
+            #endif /*MSG_DONTWAIT*/
+        }
+
+        //let the kernel or the NIC timestamp each received datagram
+        if (not _recv_timestamping.empty()) this->enable_recv_timestamping();
+
         //allocate re-usable managed receive buffers
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _mrb_pool.push_back(udp_zero_copy_asio_mrb(
-                _recv_buffer_pool->at(i), _pending_recv_buffs
+                _recv_buffer_pool->at(i), _pending_recv_buffs, _stats
             ));
             _pending_recv_buffs.push_with_haste(&_mrb_pool.back());
         }
 
+        //create the batch for deferred sends
+        if (_send_batch > 1) _batch.reset(new udp_zero_copy_asio_send_batch(
+            _send_batch, hints.cast<double>("send_batch_timeout", DEFAULT_SEND_BATCH_TIMEOUT),
+            _pending_send_buffs, _sock_fd
+        ));
+
         //allocate re-usable managed send buffers
         for (size_t i = 0; i < get_num_send_frames(); i++){
             _msb_pool.push_back(udp_zero_copy_asio_msb(
-                _send_buffer_pool->at(i), _pending_send_buffs, _sock_fd
+                _send_buffer_pool->at(i), _pending_send_buffs, _sock_fd, _stats, _batch.get()
             ));
             _pending_send_buffs.push_with_haste(&_msb_pool.back());
         }
+
+        //setup the message headers for batched receive
+        #ifdef HAVE_RECVMMSG
+        _batch_mrbs.resize(_recv_batch, NULL);
+        _batch_iovs.resize(_recv_batch);
+        _batch_msgs.resize(_recv_batch);
+        std::memset(&_batch_msgs.front(), 0, _batch_msgs.size()*sizeof(mmsghdr));
+        for (size_t i = 0; i < _recv_batch; i++){
+            _batch_msgs[i].msg_hdr.msg_iov = &_batch_iovs[i];
+            _batch_msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        #ifdef HAVE_SO_TIMESTAMPING
+        if (_recv_timestamp_index >= 0) _batch_controls.resize(_recv_batch*RECV_CONTROL_SIZE);
+        #endif /*HAVE_SO_TIMESTAMPING*/
+        _batch_index = _batch_count = 0;
+        #else
+        if (_recv_batch > 1) UHD_MSG(warning) <<
+            "The recv_batch hint is not supported on this platform." << std::endl;
+        #endif /*HAVE_RECVMMSG*/
+
+        #ifndef HAVE_SENDMMSG
+        if (_send_batch > 1) UHD_MSG(warning) <<
+            "The send_batch hint is not supported on this platform." << std::endl;
+        #endif /*HAVE_SENDMMSG*/
     }
 
     //get size for internal socket buffer
@@ -205,23 +399,79 @@ public:
      * the managed receive buffer is released back into the queue.
      ******************************************************************/
     managed_recv_buffer::sptr get_recv_buff(double timeout){
+        #ifdef HAVE_RECVMMSG
+        if (_recv_batch > 1) return this->get_recv_buff_batched(timeout);
+        #endif /*HAVE_RECVMMSG*/
+
         udp_zero_copy_asio_mrb *mrb = NULL;
         if (_pending_recv_buffs.pop_with_timed_wait(mrb, timeout)){
 
             #ifdef MSG_DONTWAIT //try a non-blocking recv() if supported
-            ssize_t ret = ::recv(_sock_fd, mrb->cast<char *>(), _recv_frame_size, MSG_DONTWAIT);
+            ssize_t ret = this->recv_frame(mrb, MSG_DONTWAIT);
             if (ret > 0) return mrb->get_new(ret);
             #endif
 
-            if (wait_for_recv_ready(_sock_fd, timeout)) return mrb->get_new(
-                ::recv(_sock_fd, mrb->cast<char *>(), _recv_frame_size, 0)
+            if (this->wait_for_recv(timeout)) return mrb->get_new(
+                this->recv_frame(mrb, 0)
             );
 
             _pending_recv_buffs.push_with_haste(mrb); //timeout: return the managed buffer to the queue
         }
+        _stats.recv_timeouts++;
         return managed_recv_buffer::sptr();
     }
 
+    #ifdef HAVE_RECVMMSG
+    /*******************************************************************
+     * Batched receive implementation:
+     *
+     * Hand out the frames filled by the last recvmmsg() one at a time.
+     * When the cache is exhausted, claim up to recv_batch frames
+     * and fill as many as possible with a single recvmmsg() call,
+     * falling back to a wait with timeout when nothing is ready.
+     * The frames that were not filled go back into the queue.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff_batched(double timeout){
+        if (_batch_index < _batch_count){
+            const size_t i = _batch_index++;
+            return _batch_mrbs[i]->get_new(_batch_msgs[i].msg_len);
+        }
+
+        //claim the frames: wait on the first, take the rest only if available
+        if (not _pending_recv_buffs.pop_with_timed_wait(_batch_mrbs[0], timeout)){
+            _stats.recv_timeouts++;
+            return managed_recv_buffer::sptr();
+        }
+        size_t num_claimed = 1;
+        while (num_claimed < _recv_batch and _pending_recv_buffs.pop_with_haste(_batch_mrbs[num_claimed])){
+            num_claimed++;
+        }
+        for (size_t i = 0; i < num_claimed; i++){
+            _batch_iovs[i].iov_base = _batch_mrbs[i]->cast<char *>();
+            _batch_iovs[i].iov_len = _recv_frame_size;
+        }
+
+        int ret = this->recv_frames(num_claimed);
+        if (ret <= 0 and this->wait_for_recv(timeout)){
+            ret = this->recv_frames(num_claimed);
+        }
+        const size_t num_recvd = (ret > 0)? size_t(ret) : 0;
+
+        //return the unfilled frames to the queue
+        for (size_t i = num_recvd; i < num_claimed; i++){
+            _pending_recv_buffs.push_with_haste(_batch_mrbs[i]);
+        }
+        if (num_recvd == 0){
+            _stats.recv_timeouts++;
+            return managed_recv_buffer::sptr();
+        }
+
+        _batch_count = num_recvd;
+        _batch_index = 1;
+        return _batch_mrbs[0]->get_new(_batch_msgs[0].msg_len);
+    }
+    #endif /*HAVE_RECVMMSG*/
+
     size_t get_num_recv_frames(void) const {return _num_recv_frames;}
     size_t get_recv_frame_size(void) const {return _recv_frame_size;}
 
@@ -234,18 +484,176 @@ public:
      * and push the managed send buffer back into the queue.
      ******************************************************************/
     managed_send_buffer::sptr get_send_buff(double timeout){
+        if (_batch.get() != NULL) _batch->flush_expired();
         udp_zero_copy_asio_msb *msb = NULL;
-        if (_pending_send_buffs.pop_with_timed_wait(msb, timeout)){
+        if (_pending_send_buffs.pop_with_haste(msb)){
             return msb->get_new(_send_frame_size);
         }
+
+        //only the slow path is timed: wait for a buffer to be freed,
+        //the queued buffers go out first so that they are not held back by the wait
+        UHD_TRACE_SCOPE("udp_wait_send");
+        if (_batch.get() != NULL){
+            _batch->flush();
+            if (_pending_send_buffs.pop_with_haste(msb)) return msb->get_new(_send_frame_size);
+        }
+        const boost::system_time start_time = boost::get_system_time();
+        const bool ready = _pending_send_buffs.pop_with_timed_wait(msb, timeout);
+        _stats.send_wait_time += (boost::get_system_time() - start_time).total_microseconds()/1e6;
+        if (ready) return msb->get_new(_send_frame_size);
+        _stats.send_timeouts++;
         return managed_send_buffer::sptr();
     }
 
     size_t get_num_send_frames(void) const {return _num_send_frames;}
     size_t get_send_frame_size(void) const {return _send_frame_size;}
 
+    void flush_send_buffs(void){
+        if (_batch.get() != NULL) _batch->flush();
+    }
+
+    zero_copy_stats_t get_stats(void) const {return _stats;}
+
+    boost::uint16_t get_local_port(void) const {return _socket->local_endpoint().port();}
+
+    int get_recv_fd(void) const {return _sock_fd;}
+
+    poll_fds_t get_recv_poll_fds(void) const {return transport::get_recv_poll_fds(_sock_fd);}
+
+    //socket accessors for alternative receive implementations
+    int get_sock_fd(void) const {return _sock_fd;}
+    asio::ip::udp::endpoint get_local_endpoint(void) const {return _socket->local_endpoint();}
+    asio::ip::udp::endpoint get_remote_endpoint(void) const {return _socket->remote_endpoint();}
+
 private:
+    /*******************************************************************
+     * Receive timestamping:
+     *
+     * With SO_TIMESTAMPING, each datagram carries a control message
+     * with the software (kernel) and raw hardware (NIC) timestamps.
+     * The timestamp of the chosen mode is stored with the frame,
+     * and its age when the frame is received counts in the stats.
+     * Without timestamping, the plain recv() calls are unchanged.
+     ******************************************************************/
+    void enable_recv_timestamping(void){
+        #ifdef HAVE_SO_TIMESTAMPING
+        int flags = 0;
+        if (_recv_timestamping == "software"){
+            flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+            _recv_timestamp_index = 0;
+        }
+        else if (_recv_timestamping == "hardware"){
+            flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+            _recv_timestamp_index = 2;
+        }
+        else throw uhd::value_error("unknown recv_timestamping mode: " + _recv_timestamping);
+        if (::setsockopt(_sock_fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0){
+            UHD_MSG(warning) << "Could not enable " << _recv_timestamping << " receive timestamps on the udp socket." << std::endl;
+            _recv_timestamp_index = -1;
+        }
+        #else
+        UHD_MSG(warning) << "The recv_timestamping hint is not supported on this platform." << std::endl;
+        #endif /*HAVE_SO_TIMESTAMPING*/
+    }
+
+    #ifdef HAVE_SO_TIMESTAMPING
+    //! Store the timestamp of a received message with its frame
+    void load_recv_timestamp(const msghdr &msg, udp_zero_copy_asio_mrb *mrb, const timespec &now){
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(const_cast<msghdr *>(&msg), cmsg)){
+            if (cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_TIMESTAMPING) continue;
+            const timespec &ts = reinterpret_cast<const timespec *>(CMSG_DATA(cmsg))[_recv_timestamp_index];
+            if (ts.tv_sec == 0 and ts.tv_nsec == 0) break; //not stamped, ex: hardware stamping is off on the NIC
+            mrb->set_recv_timestamp(true, time_spec_t(time_t(ts.tv_sec), ts.tv_nsec*1e-9));
+            _stats.timestamp_recv((now.tv_sec - ts.tv_sec) + (now.tv_nsec - ts.tv_nsec)*1e-9);
+            return;
+        }
+        mrb->set_recv_timestamp(false);
+    }
+    #endif /*HAVE_SO_TIMESTAMPING*/
+
+    //! Receive one datagram into the frame
+    UHD_INLINE int recv_frame(udp_zero_copy_asio_mrb *mrb, const int flags){
+        #ifdef HAVE_SO_TIMESTAMPING
+        if (_recv_timestamp_index >= 0){
+            iovec iov;
+            iov.iov_base = mrb->cast<char *>();
+            iov.iov_len = _recv_frame_size;
+            msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = _recv_control;
+            msg.msg_controllen = RECV_CONTROL_SIZE;
+            const int ret = int(::recvmsg(_sock_fd, &msg, flags));
+            if (ret > 0){
+                timespec now;
+                ::clock_gettime(CLOCK_REALTIME, &now);
+                this->load_recv_timestamp(msg, mrb, now);
+            }
+            return ret;
+        }
+        #endif /*HAVE_SO_TIMESTAMPING*/
+        return int(::recv(_sock_fd, mrb->cast<char *>(), _recv_frame_size, flags));
+    }
+
+    #ifdef HAVE_RECVMMSG
+    //! Receive up to num_claimed datagrams into the claimed batch frames without blocking
+    UHD_INLINE int recv_frames(const size_t num_claimed){
+        #ifdef HAVE_SO_TIMESTAMPING
+        if (_recv_timestamp_index >= 0){
+            for (size_t i = 0; i < num_claimed; i++){
+                _batch_msgs[i].msg_hdr.msg_control = &_batch_controls[i*RECV_CONTROL_SIZE];
+                _batch_msgs[i].msg_hdr.msg_controllen = RECV_CONTROL_SIZE;
+            }
+            const int ret = ::recvmmsg(_sock_fd, &_batch_msgs.front(), num_claimed, MSG_DONTWAIT, NULL);
+            if (ret > 0){
+                timespec now;
+                ::clock_gettime(CLOCK_REALTIME, &now);
+                for (size_t i = 0; i < size_t(ret); i++){
+                    this->load_recv_timestamp(_batch_msgs[i].msg_hdr, _batch_mrbs[i], now);
+                }
+            }
+            return ret;
+        }
+        #endif /*HAVE_SO_TIMESTAMPING*/
+        return ::recvmmsg(_sock_fd, &_batch_msgs.front(), num_claimed, MSG_DONTWAIT, NULL);
+    }
+    #endif /*HAVE_RECVMMSG*/
+
+    /*******************************************************************
+     * Wait for a datagram to be ready on the socket:
+     *
+     * In busy poll mode, spin on non-blocking peeks for the busy poll
+     * time before blocking, so a datagram arriving shortly after the
+     * call is seen without the wakeup latency of a blocked thread.
+     * Then fall back to a blocking wait with the remaining timeout.
+     * The callers already tried a non-blocking receive, so a zero
+     * timeout returns at once without the select system call.
+     ******************************************************************/
+    UHD_INLINE bool wait_for_recv(double timeout){
+        UHD_TRACE_SCOPE("udp_wait_recv");
+        #ifdef MSG_DONTWAIT
+        if (timeout <= 0) return false;
+        if (_recv_busy_poll > 0){
+            const double spin_time = std::min(timeout, _recv_busy_poll);
+            const boost::system_time exit_time = boost::get_system_time() +
+                boost::posix_time::microseconds(long(spin_time*1e6));
+            do{
+                if (::recv(_sock_fd, NULL, 0, MSG_PEEK | MSG_DONTWAIT) >= 0) return true;
+            } while (boost::get_system_time() < exit_time);
+            timeout -= spin_time;
+            if (timeout <= 0) return false;
+        }
+        #endif /*MSG_DONTWAIT*/
+        return wait_for_recv_ready(_sock_fd, timeout);
+    }
+
+    //performance counters -> updated by the buffers and the calls above
+    zero_copy_stats_t _stats;
+
     //memory management -> buffers and fifos
+    //the fifos are free-lists: a buffer is released by whichever thread drops
+    //its last reference (such as a demuxer or shared views), so they are locked
     const size_t _recv_frame_size, _num_recv_frames;
     const size_t _send_frame_size, _num_send_frames;
     buffer_pool::sptr _recv_buffer_pool, _send_buffer_pool;
@@ -254,12 +662,718 @@ private:
     std::list<udp_zero_copy_asio_msb> _msb_pool;
     std::list<udp_zero_copy_asio_mrb> _mrb_pool;
 
+    //batched receive -> claimed frames and message headers
+    const size_t _recv_batch;
+    #ifdef HAVE_RECVMMSG
+    std::vector<udp_zero_copy_asio_mrb *> _batch_mrbs;
+    std::vector<iovec> _batch_iovs;
+    std::vector<mmsghdr> _batch_msgs;
+    size_t _batch_index, _batch_count;
+    #endif /*HAVE_RECVMMSG*/
+
+    //batched send -> committed frames held for sendmmsg
+    const size_t _send_batch;
+    boost::scoped_ptr<udp_zero_copy_asio_send_batch> _batch;
+
+    //busy poll -> the time in seconds to spin before blocking
+    const double _recv_busy_poll;
+
+    //receive timestamping -> the mode, and the index of the timestamp in the control message
+    const std::string _recv_timestamping;
+    int _recv_timestamp_index;
+    #ifdef HAVE_SO_TIMESTAMPING
+    static const size_t RECV_CONTROL_SIZE = 256;
+    char _recv_control[RECV_CONTROL_SIZE];
+    std::vector<char> _batch_controls;
+    #endif /*HAVE_SO_TIMESTAMPING*/
+
     //asio guts -> socket and service
     asio::io_service        _io_service;
     socket_sptr             _socket;
     int                     _sock_fd;
 };
 
+#if defined(HAVE_LINUX_PACKET_RING) || defined(HAVE_LINUX_AF_XDP)
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+#include <poll.h>
+#include <unistd.h>
+
+/***********************************************************************
+ * Find the index of the network interface that owns an IPv4 address
+ **********************************************************************/
+static int get_if_index_for_addr(const boost::uint32_t addr){
+    int if_index = 0;
+    ifaddrs *ifap;
+    if (::getifaddrs(&ifap) == 0){
+        for (ifaddrs *iter = ifap; iter != NULL; iter = iter->ifa_next){
+            if (iter->ifa_addr == NULL or iter->ifa_addr->sa_family != AF_INET) continue;
+            if (ntohl(reinterpret_cast<sockaddr_in *>(iter->ifa_addr)->sin_addr.s_addr) != addr) continue;
+            if_index = ::if_nametoindex(iter->ifa_name);
+            break;
+        }
+        ::freeifaddrs(ifap);
+    }
+    return if_index;
+}
+
+/***********************************************************************
+ * Combine the receive counters of a receive backend
+ * with the send counters of the udp transport that it wraps
+ **********************************************************************/
+static zero_copy_stats_t merge_recv_stats(const zero_copy_stats_t &recv_stats, zero_copy_stats_t stats){
+    stats.recv_frames = recv_stats.recv_frames;
+    stats.recv_bytes = recv_stats.recv_bytes;
+    stats.recv_timeouts = recv_stats.recv_timeouts;
+    stats.recv_outstanding = recv_stats.recv_outstanding;
+    stats.recv_high_water = recv_stats.recv_high_water;
+    stats.recv_timestamps = recv_stats.recv_timestamps;
+    stats.recv_queue_time = recv_stats.recv_queue_time;
+    stats.recv_queue_time_max = recv_stats.recv_queue_time_max;
+    return stats;
+}
+#endif /*HAVE_LINUX_PACKET_RING || HAVE_LINUX_AF_XDP*/
+
+#ifdef HAVE_LINUX_PACKET_RING
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+
+/***********************************************************************
+ * Packet ring managed receive buffer:
+ *  - Points directly into a frame of the kernel packet ring.
+ *  - Release hands the ring frame back to the kernel.
+ **********************************************************************/
+class udp_zero_copy_ring_mrb : public managed_recv_buffer{
+public:
+    udp_zero_copy_ring_mrb(tpacket2_hdr *hdr, zero_copy_stats_t &stats):
+        _hdr(hdr), _mem(NULL), _len(0), _stats(stats){/* NOP */}
+
+    void release(void){
+        if (_mem == NULL) return;
+        _mem = NULL;
+        __sync_synchronize(); //payload reads complete before the kernel owns the frame
+        _hdr->tp_status = TP_STATUS_KERNEL;
+        _stats.release_recv();
+    }
+
+    sptr get_new(const void *mem, size_t len){
+        _mem = mem;
+        _len = len;
+        _stats.claim_recv(len);
+        return make_managed_buffer(this);
+    }
+
+    bool ready(void) const{
+        return (*static_cast<volatile boost::uint32_t *>(&_hdr->tp_status) & TP_STATUS_USER) != 0;
+    }
+
+    //the frame keeps the user status until the caller releases it
+    bool held(void) const{
+        return *static_cast<const void * const volatile *>(&_mem) != NULL;
+    }
+
+    //hand a frame that will not be handed out back to the kernel
+    void drop(void){
+        _hdr->tp_status = TP_STATUS_KERNEL;
+    }
+
+    tpacket2_hdr *hdr(void) const{return _hdr;}
+
+private:
+    const void *get_buff(void) const{return _mem;}
+    size_t get_size(void) const{return _len;}
+
+    tpacket2_hdr *_hdr;
+    const void *_mem;
+    size_t _len;
+    zero_copy_stats_t &_stats;
+};
+
+/***********************************************************************
+ * Zero Copy UDP implementation with a linux kernel packet ring:
+ *   Received datagrams are captured by a PF_PACKET socket bound to the
+ *   interface that routes to the device. The socket filter only
+ *   accepts datagrams from the device address and port to our port.
+ *   The kernel writes the datagrams into a memory mapped ring,
+ *   and the managed receive buffers point directly into ring frames.
+ *   Sends and the port binding are handled by the ASIO implementation.
+ **********************************************************************/
+class udp_zero_copy_ring_impl : public udp_zero_copy{
+public:
+    udp_zero_copy_ring_impl(udp_zero_copy_asio_impl::sptr udp_trans, const size_t ring_bytes):
+        _udp_trans(udp_trans), _sock_fd(-1), _ring(NULL), _ring_size(0), _frame_size(0), _index(0)
+    {
+        _sock_fd = ::socket(PF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+        if (_sock_fd < 0) throw uhd::os_error("packet ring: socket(PF_PACKET) failed, CAP_NET_RAW is required");
+        try{
+            this->setup_filter();
+            this->setup_ring(ring_bytes);
+            this->setup_bind();
+        }
+        catch(...){
+            this->cleanup();
+            throw;
+        }
+        this->setup_socket_drop();
+    }
+
+    ~udp_zero_copy_ring_impl(void){
+        this->cleanup();
+    }
+
+    /*******************************************************************
+     * Receive implementation:
+     *
+     * Check the status of the next frame in the ring.
+     * When the kernel has not handed over the frame yet,
+     * poll on the packet socket with timeout and check again.
+     * The kernel fills the frames in ring order: when the ring wraps
+     * onto a frame that the caller still holds, wait for its release.
+     * The managed buffer points into the ring frame payload,
+     * frames with headers that do not fit the frame are dropped.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff(double timeout){
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::microseconds(long(std::max(timeout, 0.0)*1e6));
+        while (true){
+            udp_zero_copy_ring_mrb &mrb = _mrb_pool[_index];
+            if (not this->wait_for_frame(mrb, exit_time)){
+                _stats.recv_timeouts++;
+                return managed_recv_buffer::sptr();
+            }
+            __sync_synchronize(); //status read completes before payload reads
+            if (++_index == _mrb_pool.size()) _index = 0;
+
+            //parse the ip and udp headers to locate the payload
+            tpacket2_hdr *hdr = mrb.hdr();
+            const boost::uint8_t *frame = reinterpret_cast<const boost::uint8_t *>(hdr);
+            const long net_off = hdr->tp_net;
+            if (net_off < long(sizeof(tpacket2_hdr)) or net_off + 20 + 8 > long(_frame_size)){
+                this->drop_frame(mrb, "network offset");
+                continue;
+            }
+            const boost::uint8_t *ip_hdr = frame + net_off;
+            const long ip_hdr_len = (ip_hdr[0] & 0xf)*4;
+            if (ip_hdr_len < 20 or net_off + ip_hdr_len + 8 > long(_frame_size)){
+                this->drop_frame(mrb, "ip header length");
+                continue;
+            }
+            const boost::uint8_t *udp_hdr = ip_hdr + ip_hdr_len;
+            const long udp_len = (long(udp_hdr[4]) << 8) | udp_hdr[5];
+            const long payload_len = std::min<long>(
+                udp_len - 8, long(hdr->tp_snaplen) - ip_hdr_len - 8
+            );
+            const long payload_off = net_off + ip_hdr_len + 8;
+            if (payload_len < 0 or payload_off + payload_len >= long(_frame_size)){
+                this->drop_frame(mrb, "payload length");
+                continue;
+            }
+            return mrb.get_new(udp_hdr + 8, size_t(payload_len));
+        }
+    }
+
+    size_t get_num_recv_frames(void) const {return _mrb_pool.size();}
+    size_t get_recv_frame_size(void) const {return _udp_trans->get_recv_frame_size();}
+
+    //send implementation is the ASIO implementation
+    managed_send_buffer::sptr get_send_buff(double timeout){return _udp_trans->get_send_buff(timeout);}
+    size_t get_num_send_frames(void) const {return _udp_trans->get_num_send_frames();}
+    size_t get_send_frame_size(void) const {return _udp_trans->get_send_frame_size();}
+    void flush_send_buffs(void){return _udp_trans->flush_send_buffs();}
+
+    zero_copy_stats_t get_stats(void) const {return merge_recv_stats(_stats, _udp_trans->get_stats());}
+
+    boost::uint16_t get_local_port(void) const {return _udp_trans->get_local_port();}
+
+    int get_recv_fd(void) const {return _sock_fd;}
+
+    poll_fds_t get_recv_poll_fds(void) const {return transport::get_recv_poll_fds(_sock_fd);}
+
+private:
+    UHD_INLINE boost::uint32_t local_addr(void) const{
+        return _udp_trans->get_local_endpoint().address().to_v4().to_ulong();
+    }
+
+    //wait for the caller to release the frame, and then for the kernel to fill it
+    bool wait_for_frame(const udp_zero_copy_ring_mrb &mrb, const boost::system_time &exit_time){
+        while (mrb.held()){
+            //the kernel cannot fill this frame: polling the socket would not block
+            if (boost::get_system_time() >= exit_time) return false;
+            boost::this_thread::sleep(boost::posix_time::microseconds(100));
+        }
+        while (not mrb.ready()){
+            //the frame status is in shared memory: an expired timeout needs no poll
+            const long timeout_ms = (exit_time - boost::get_system_time()).total_milliseconds();
+            if (timeout_ms <= 0) return false;
+            pollfd pfd;
+            pfd.fd = _sock_fd;
+            pfd.events = POLLIN | POLLERR;
+            pfd.revents = 0;
+            ::poll(&pfd, 1, int(timeout_ms));
+        }
+        return true;
+    }
+
+    void drop_frame(udp_zero_copy_ring_mrb &mrb, const char *what){
+        UHD_LOG << "packet ring: dropped a frame with a bad " << what << std::endl;
+        mrb.drop();
+    }
+
+    //accept only datagrams from the device endpoint to our local endpoint
+    void setup_filter(void){
+        const boost::uint32_t remote_ip = _udp_trans->get_remote_endpoint().address().to_v4().to_ulong();
+        const boost::uint16_t remote_port = _udp_trans->get_remote_endpoint().port();
+        const boost::uint16_t local_port = _udp_trans->get_local_endpoint().port();
+        sock_filter code[] = {
+            BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 9),                //ip protocol
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   IPPROTO_UDP, 0, 10),
+            BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, 12),               //ip source
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   remote_ip, 0, 8),
+            BPF_STMT(BPF_LD  | BPF_H   | BPF_ABS, 6),                //ip fragment offset
+            BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K,  0x1fff, 6, 0),
+            BPF_STMT(BPF_LDX | BPF_B   | BPF_MSH, 0),                //x = ip header length
+            BPF_STMT(BPF_LD  | BPF_H   | BPF_IND, 0),                //udp source port
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   remote_port, 0, 3),
+            BPF_STMT(BPF_LD  | BPF_H   | BPF_IND, 2),                //udp destination port
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   local_port, 0, 1),
+            BPF_STMT(BPF_RET | BPF_K, 0xffffffff),                   //accept
+            BPF_STMT(BPF_RET | BPF_K, 0),                            //drop
+        };
+        sock_fprog prog;
+        prog.len = sizeof(code)/sizeof(code[0]);
+        prog.filter = code;
+        if (::setsockopt(_sock_fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0){
+            throw uhd::os_error("packet ring: setsockopt(SO_ATTACH_FILTER) failed");
+        }
+    }
+
+    //size the frames to hold the headers plus one transport frame
+    //the ring takes the place of the socket buffer when that is larger
+    void setup_ring(const size_t ring_bytes){
+        int version = TPACKET_V2;
+        if (::setsockopt(_sock_fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0){
+            throw uhd::os_error("packet ring: setsockopt(PACKET_VERSION) failed");
+        }
+
+        const size_t hdr_len = TPACKET_ALIGN(TPACKET2_HDRLEN + 16) + 60/*max ip*/ + 8/*udp*/;
+        size_t frame_size = TPACKET_ALIGNMENT;
+        while (frame_size < hdr_len + _udp_trans->get_recv_frame_size()) frame_size *= 2;
+        const size_t block_size = std::max<size_t>(frame_size, ::getpagesize());
+        const size_t frames_per_block = block_size/frame_size;
+        const size_t num_frames = std::max(_udp_trans->get_num_recv_frames(), ring_bytes/frame_size);
+        const size_t num_blocks = (num_frames + frames_per_block - 1)/frames_per_block;
+
+        tpacket_req req;
+        req.tp_block_size = block_size;
+        req.tp_block_nr = num_blocks;
+        req.tp_frame_size = frame_size;
+        req.tp_frame_nr = num_blocks*frames_per_block;
+        if (::setsockopt(_sock_fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0){
+            throw uhd::os_error("packet ring: setsockopt(PACKET_RX_RING) failed");
+        }
+
+        _ring_size = block_size*num_blocks;
+        void *ring = ::mmap(NULL, _ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, _sock_fd, 0);
+        if (ring == MAP_FAILED) throw uhd::os_error("packet ring: mmap failed");
+        _ring = static_cast<char *>(ring);
+        _frame_size = frame_size;
+
+        for (size_t i = 0; i < req.tp_frame_nr; i++){
+            _mrb_pool.push_back(udp_zero_copy_ring_mrb(
+                reinterpret_cast<tpacket2_hdr *>(_ring + i*frame_size), _stats
+            ));
+        }
+    }
+
+    //bind to the interface that owns the local socket address
+    void setup_bind(void){
+        const int if_index = get_if_index_for_addr(local_addr());
+        if (if_index == 0) throw uhd::os_error("packet ring: no interface for the local address");
+
+        sockaddr_ll addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sll_family = AF_PACKET;
+        addr.sll_protocol = htons(ETH_P_IP);
+        addr.sll_ifindex = if_index;
+        if (::bind(_sock_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0){
+            throw uhd::os_error("packet ring: bind to interface failed");
+        }
+    }
+
+    //the udp socket still gets a copy of each datagram: drop it in the kernel
+    void setup_socket_drop(void){
+        sock_filter code[] = {BPF_STMT(BPF_RET | BPF_K, 0)};
+        sock_fprog prog;
+        prog.len = 1;
+        prog.filter = code;
+        if (::setsockopt(_udp_trans->get_sock_fd(), SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0){
+            UHD_LOG << "packet ring: could not attach drop filter to the udp socket" << std::endl;
+        }
+    }
+
+    void cleanup(void){
+        if (_ring != NULL) ::munmap(_ring, _ring_size);
+        if (_sock_fd >= 0) ::close(_sock_fd);
+        _ring = NULL;
+        _sock_fd = -1;
+    }
+
+    udp_zero_copy_asio_impl::sptr _udp_trans;
+    int _sock_fd;
+    char *_ring;
+    size_t _ring_size;
+    size_t _frame_size;
+    zero_copy_stats_t _stats;
+    std::vector<udp_zero_copy_ring_mrb> _mrb_pool;
+    size_t _index;
+};
+#endif /*HAVE_LINUX_PACKET_RING*/
+
+#ifdef HAVE_LINUX_AF_XDP
+#include <sys/syscall.h>
+#include <linux/if_xdp.h>
+#include <linux/bpf.h>
+#include <boost/thread/mutex.hpp>
+#include <cerrno>
+
+//The UMEM chunk size, the kernel reserves XDP_PACKET_HEADROOM of each
+static const size_t XDP_FRAME_SIZE = 4096;
+
+/***********************************************************************
+ * AF_XDP descriptor ring:
+ *  - The producer and consumer indexes live in the mapped ring.
+ *  - Indexes are free running and masked into the descriptor array.
+ **********************************************************************/
+struct udp_zero_copy_xdp_ring{
+    udp_zero_copy_xdp_ring(void):
+        map(MAP_FAILED), map_size(0), producer(NULL), consumer(NULL), descs(NULL), mask(0)
+    {/* NOP */}
+
+    void mmap(int fd, const xdp_ring_offset &off, const size_t size, const size_t desc_size, const off_t pgoff){
+        map_size = off.desc + size*desc_size;
+        map = ::mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, pgoff);
+        if (map == MAP_FAILED) throw uhd::os_error("AF_XDP: mmap of descriptor ring failed");
+        char *base = static_cast<char *>(map);
+        producer = reinterpret_cast<volatile boost::uint32_t *>(base + off.producer);
+        consumer = reinterpret_cast<volatile boost::uint32_t *>(base + off.consumer);
+        descs = base + off.desc;
+        mask = boost::uint32_t(size - 1);
+    }
+
+    void munmap(void){
+        if (map != MAP_FAILED) ::munmap(map, map_size);
+        map = MAP_FAILED;
+    }
+
+    template <typename T> T &at(const boost::uint32_t index) const{
+        return reinterpret_cast<T *>(descs)[index & mask];
+    }
+
+    void *map;
+    size_t map_size;
+    volatile boost::uint32_t *producer;
+    volatile boost::uint32_t *consumer;
+    void *descs;
+    boost::uint32_t mask;
+};
+
+/***********************************************************************
+ * AF_XDP fill ring:
+ *  - Hands UMEM frames to the kernel for receive.
+ *  - Buffers may be released from any thread, so produce under a lock.
+ **********************************************************************/
+class udp_zero_copy_xdp_fill : boost::noncopyable{
+public:
+    udp_zero_copy_xdp_fill(void): _prod(0){/* NOP */}
+
+    udp_zero_copy_xdp_ring &ring(void){return _ring;}
+
+    void push(const boost::uint64_t addr){
+        boost::mutex::scoped_lock lock(_mutex);
+        _ring.at<boost::uint64_t>(_prod) = addr;
+        __sync_synchronize(); //descriptor write completes before the kernel sees it
+        *_ring.producer = ++_prod;
+    }
+
+private:
+    boost::mutex _mutex;
+    udp_zero_copy_xdp_ring _ring;
+    boost::uint32_t _prod;
+};
+
+/***********************************************************************
+ * AF_XDP managed receive buffer:
+ *  - Points directly into a UMEM frame written by the NIC or kernel.
+ *  - Release places the frame back onto the fill ring.
+ **********************************************************************/
+class udp_zero_copy_xdp_mrb : public managed_recv_buffer{
+public:
+    udp_zero_copy_xdp_mrb(udp_zero_copy_xdp_fill &fill, const boost::uint64_t addr, zero_copy_stats_t &stats):
+        _fill(fill), _addr(addr), _mem(NULL), _len(0), _stats(stats){/* NOP */}
+
+    void release(void){
+        if (_mem == NULL) return;
+        _mem = NULL;
+        _fill.push(_addr);
+        _stats.release_recv();
+    }
+
+    sptr get_new(const void *mem, size_t len){
+        _mem = mem;
+        _len = len;
+        _stats.claim_recv(len);
+        return make_managed_buffer(this);
+    }
+
+    void recycle(void){_fill.push(_addr);}
+
+private:
+    const void *get_buff(void) const{return _mem;}
+    size_t get_size(void) const{return _len;}
+
+    udp_zero_copy_xdp_fill &_fill;
+    const boost::uint64_t _addr;
+    const void *_mem;
+    size_t _len;
+    zero_copy_stats_t &_stats;
+};
+
+/***********************************************************************
+ * Zero Copy UDP implementation with a linux AF_XDP socket:
+ *   The UMEM is allocated through the buffer pool and registered
+ *   with the socket. The socket is bound to one receive queue of the
+ *   interface that routes to the device, and it is inserted into a
+ *   pinned XSKMAP, so that the XDP program attached to the interface
+ *   can redirect the device datagrams to it. Receive descriptors map
+ *   directly onto managed receive buffers; frames are handed back to
+ *   the fill ring on release. The kernel stack never sees the data.
+ *   Sends and the port binding are handled by the ASIO implementation.
+ **********************************************************************/
+class udp_zero_copy_xdp_impl : public udp_zero_copy{
+public:
+    udp_zero_copy_xdp_impl(
+        udp_zero_copy_asio_impl::sptr udp_trans,
+        const std::string &map_path,
+        const size_t queue,
+        const bool zero_copy,
+        const size_t ring_bytes,
+        const buffer_pool::alloc_policy_t &policy
+    ):
+        _udp_trans(udp_trans), _sock_fd(-1), _rx_cons(0)
+    {
+        if (
+            XDP_FRAME_SIZE - XDP_PACKET_HEADROOM <
+            14/*eth*/ + 60/*max ip*/ + 8/*udp*/ + _udp_trans->get_recv_frame_size()
+        ) throw uhd::value_error("AF_XDP: the recv frame size does not fit into a UMEM frame");
+
+        _sock_fd = ::socket(AF_XDP, SOCK_RAW, 0);
+        if (_sock_fd < 0) throw uhd::os_error("AF_XDP: socket(AF_XDP) failed, CAP_NET_RAW is required");
+        try{
+            this->setup_umem(ring_bytes, policy);
+            this->setup_rings();
+            this->setup_bind(queue, zero_copy);
+            this->setup_map(map_path, queue);
+        }
+        catch(...){
+            this->cleanup();
+            throw;
+        }
+    }
+
+    ~udp_zero_copy_xdp_impl(void){
+        this->cleanup();
+    }
+
+    /*******************************************************************
+     * Receive implementation:
+     *
+     * Check the receive ring for a descriptor from the kernel.
+     * When the ring is empty, poll on the socket with timeout.
+     * Frames that do not hold a datagram from the device
+     * are handed straight back to the fill ring.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff(double timeout){
+        bool polled = false;
+        while (true){
+            if (*_rx.producer == _rx_cons){
+                //the ring indexes are in shared memory: a zero timeout needs no poll
+                if (polled or timeout <= 0){
+                    _stats.recv_timeouts++;
+                    return managed_recv_buffer::sptr();
+                }
+                pollfd pfd;
+                pfd.fd = _sock_fd;
+                pfd.events = POLLIN | POLLERR;
+                pfd.revents = 0;
+                ::poll(&pfd, 1, int(timeout*1000));
+                polled = true;
+                continue;
+            }
+            __sync_synchronize(); //producer read completes before descriptor reads
+            const xdp_desc &desc = _rx.at<xdp_desc>(_rx_cons);
+            const boost::uint64_t addr = desc.addr;
+            const size_t len = desc.len;
+            __sync_synchronize(); //descriptor reads complete before the kernel reuses the slot
+            *_rx.consumer = ++_rx_cons;
+
+            udp_zero_copy_xdp_mrb &mrb = _mrb_pool[addr/XDP_FRAME_SIZE];
+            const void *payload; size_t payload_len;
+            if (this->parse(_umem + addr, len, payload, payload_len)){
+                return mrb.get_new(payload, payload_len);
+            }
+            mrb.recycle();
+        }
+    }
+
+    size_t get_num_recv_frames(void) const {return _mrb_pool.size();}
+    size_t get_recv_frame_size(void) const {return _udp_trans->get_recv_frame_size();}
+
+    //send implementation is the ASIO implementation
+    managed_send_buffer::sptr get_send_buff(double timeout){return _udp_trans->get_send_buff(timeout);}
+    size_t get_num_send_frames(void) const {return _udp_trans->get_num_send_frames();}
+    size_t get_send_frame_size(void) const {return _udp_trans->get_send_frame_size();}
+    void flush_send_buffs(void){return _udp_trans->flush_send_buffs();}
+
+    zero_copy_stats_t get_stats(void) const {return merge_recv_stats(_stats, _udp_trans->get_stats());}
+
+    boost::uint16_t get_local_port(void) const {return _udp_trans->get_local_port();}
+
+    int get_recv_fd(void) const {return _sock_fd;}
+
+    poll_fds_t get_recv_poll_fds(void) const {return transport::get_recv_poll_fds(_sock_fd);}
+
+private:
+    //check the ethernet, ip, and udp headers against the transport endpoints
+    bool parse(const boost::uint8_t *frame, const size_t len, const void *&payload, size_t &payload_len) const{
+        if (len < 14 + 20 + 8) return false;
+        if (frame[12] != 0x08 or frame[13] != 0x00) return false; //ipv4 ethertype
+        const boost::uint8_t *ip_hdr = frame + 14;
+        const size_t ip_hdr_len = (ip_hdr[0] & 0xf)*4;
+        if (ip_hdr[9] != IPPROTO_UDP) return false;
+        if (len < 14 + ip_hdr_len + 8) return false;
+        if ((((ip_hdr[6] << 8) | ip_hdr[7]) & 0x3fff) != 0) return false; //fragments
+        boost::uint32_t src_ip; std::memcpy(&src_ip, ip_hdr + 12, sizeof(src_ip));
+        if (ntohl(src_ip) != _remote_ip) return false;
+        const boost::uint8_t *udp_hdr = ip_hdr + ip_hdr_len;
+        if (((udp_hdr[0] << 8) | udp_hdr[1]) != _remote_port) return false;
+        if (((udp_hdr[2] << 8) | udp_hdr[3]) != _local_port) return false;
+        const size_t udp_len = (size_t(udp_hdr[4]) << 8) | udp_hdr[5];
+        payload = udp_hdr + 8;
+        payload_len = std::min<long>(long(udp_len) - 8, long(len) - long(14 + ip_hdr_len + 8));
+        return long(payload_len) >= 0;
+    }
+
+    //allocate and register the UMEM, one receive frame per chunk
+    void setup_umem(const size_t ring_bytes, const buffer_pool::alloc_policy_t &policy){
+        size_t num_frames = 1;
+        while (num_frames < std::max(_udp_trans->get_num_recv_frames(), ring_bytes/XDP_FRAME_SIZE)) num_frames *= 2;
+        _pool = buffer_pool::make(num_frames, XDP_FRAME_SIZE, ::getpagesize(), policy);
+        _umem = static_cast<boost::uint8_t *>(_pool->at(0));
+
+        xdp_umem_reg reg;
+        std::memset(&reg, 0, sizeof(reg));
+        reg.addr = boost::uint64_t(size_t(_umem));
+        reg.len = num_frames*XDP_FRAME_SIZE;
+        reg.chunk_size = XDP_FRAME_SIZE;
+        reg.headroom = 0;
+        if (::setsockopt(_sock_fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0){
+            throw uhd::os_error("AF_XDP: setsockopt(XDP_UMEM_REG) failed");
+        }
+    }
+
+    //the receive and fill rings hold every frame, the completion ring is unused
+    void setup_rings(void){
+        int size = int(_pool->size());
+        if (
+            ::setsockopt(_sock_fd, SOL_XDP, XDP_UMEM_FILL_RING, &size, sizeof(size)) < 0 or
+            ::setsockopt(_sock_fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &size, sizeof(size)) < 0 or
+            ::setsockopt(_sock_fd, SOL_XDP, XDP_RX_RING, &size, sizeof(size)) < 0
+        ) throw uhd::os_error("AF_XDP: setsockopt of the ring sizes failed");
+
+        xdp_mmap_offsets off;
+        socklen_t off_len = sizeof(off);
+        if (::getsockopt(_sock_fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &off_len) < 0){
+            throw uhd::os_error("AF_XDP: getsockopt(XDP_MMAP_OFFSETS) failed");
+        }
+        _rx.mmap(_sock_fd, off.rx, _pool->size(), sizeof(xdp_desc), XDP_PGOFF_RX_RING);
+        _fill.ring().mmap(_sock_fd, off.fr, _pool->size(), sizeof(boost::uint64_t), XDP_UMEM_PGOFF_FILL_RING);
+
+        _rx_cons = *_rx.consumer;
+        for (size_t i = 0; i < _pool->size(); i++){
+            _mrb_pool.push_back(udp_zero_copy_xdp_mrb(_fill, i*XDP_FRAME_SIZE, _stats));
+            _fill.push(i*XDP_FRAME_SIZE);
+        }
+
+        _remote_ip = _udp_trans->get_remote_endpoint().address().to_v4().to_ulong();
+        _remote_port = _udp_trans->get_remote_endpoint().port();
+        _local_port = _udp_trans->get_local_endpoint().port();
+    }
+
+    //bind to a queue of the interface that owns the local socket address
+    void setup_bind(const size_t queue, const bool zero_copy){
+        const int if_index = get_if_index_for_addr(
+            _udp_trans->get_local_endpoint().address().to_v4().to_ulong()
+        );
+        if (if_index == 0) throw uhd::os_error("AF_XDP: no interface for the local address");
+
+        sockaddr_xdp addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sxdp_family = AF_XDP;
+        addr.sxdp_ifindex = if_index;
+        addr.sxdp_queue_id = queue;
+        addr.sxdp_flags = zero_copy? XDP_ZEROCOPY : 0;
+        if (::bind(_sock_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0){
+            throw uhd::os_error(str(boost::format(
+                "AF_XDP: bind to interface queue %d failed (%s)"
+            ) % queue % std::strerror(errno)));
+        }
+    }
+
+    //insert the socket into the pinned XSKMAP of the XDP program
+    void setup_map(const std::string &map_path, const size_t queue){
+        bpf_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.pathname = boost::uint64_t(size_t(map_path.c_str()));
+        const int map_fd = ::syscall(__NR_bpf, BPF_OBJ_GET, &attr, sizeof(attr));
+        if (map_fd < 0) throw uhd::os_error("AF_XDP: could not open the pinned XSKMAP " + map_path);
+
+        const boost::uint32_t key = queue;
+        const boost::uint32_t value = _sock_fd;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.map_fd = map_fd;
+        attr.key = boost::uint64_t(size_t(&key));
+        attr.value = boost::uint64_t(size_t(&value));
+        attr.flags = BPF_ANY;
+        const int ret = ::syscall(__NR_bpf, BPF_MAP_UPDATE_ELEM, &attr, sizeof(attr));
+        ::close(map_fd);
+        if (ret < 0) throw uhd::os_error("AF_XDP: could not insert the socket into the XSKMAP " + map_path);
+    }
+
+    //closing the socket also removes it from the XSKMAP
+    void cleanup(void){
+        _rx.munmap();
+        _fill.ring().munmap();
+        if (_sock_fd >= 0) ::close(_sock_fd);
+        _sock_fd = -1;
+    }
+
+    udp_zero_copy_asio_impl::sptr _udp_trans;
+    int _sock_fd;
+    buffer_pool::sptr _pool;
+    boost::uint8_t *_umem;
+    udp_zero_copy_xdp_ring _rx;
+    boost::uint32_t _rx_cons;
+    udp_zero_copy_xdp_fill _fill;
+    zero_copy_stats_t _stats;
+    std::vector<udp_zero_copy_xdp_mrb> _mrb_pool;
+    boost::uint32_t _remote_ip;
+    boost::uint16_t _remote_port, _local_port;
+};
+#endif /*HAVE_LINUX_AF_XDP*/
+
 /***********************************************************************
  * UDP zero copy make function
  **********************************************************************/
@@ -308,5 +1422,42 @@ udp_zero_copy::sptr udp_zero_copy::make(
     resize_buff_helper<asio::socket_base::receive_buffer_size>(udp_trans, recv_buff_size, "recv");
     resize_buff_helper<asio::socket_base::send_buffer_size>   (udp_trans, send_buff_size, "send");
 
+    //try to use an AF_XDP socket for receive when requested
+    if (hints.has_key("recv_xdp_map")){
+        #ifdef HAVE_LINUX_AF_XDP
+        try{
+            return udp_zero_copy::sptr(new udp_zero_copy_xdp_impl(
+                udp_trans, hints["recv_xdp_map"],
+                size_t(hints.cast<double>("recv_xdp_queue", 0)),
+                hints.cast<double>("recv_xdp_zero_copy", 0) != 0,
+                recv_buff_size, buffer_pool::alloc_policy_t::from_hints(hints, "recv")
+            ));
+        }
+        catch(const std::exception &e){
+            UHD_MSG(warning) << boost::format(
+                "Could not create the AF_XDP socket, using sockets.\n%s\n"
+            ) % e.what();
+        }
+        #else
+        UHD_MSG(warning) << "AF_XDP sockets are not supported on this platform." << std::endl;
+        #endif /*HAVE_LINUX_AF_XDP*/
+    }
+
+    //try to use the kernel packet ring for receive when requested
+    if (hints.cast<double>("recv_packet_ring", 0) != 0){
+        #ifdef HAVE_LINUX_PACKET_RING
+        try{
+            return udp_zero_copy::sptr(new udp_zero_copy_ring_impl(udp_trans, recv_buff_size));
+        }
+        catch(const std::exception &e){
+            UHD_MSG(warning) << boost::format(
+                "Could not create the kernel packet ring, using sockets.\n%s\n"
+            ) % e.what();
+        }
+        #else
+        UHD_MSG(warning) << "The kernel packet ring is not supported on this platform." << std::endl;
+        #endif /*HAVE_LINUX_PACKET_RING*/
+    }
+
     return udp_trans;
 }
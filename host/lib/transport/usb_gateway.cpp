@@ -0,0 +1,709 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "udp_common.hpp"
+#include <uhd/transport/usb_gateway.hpp>
+#include <uhd/transport/udp_simple.hpp>
+#include <uhd/transport/udp_zero_copy.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#ifdef HAVE_SENDMMSG
+#include <sys/socket.h>
+#endif /*HAVE_SENDMMSG*/
+
+using namespace uhd;
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+/***********************************************************************
+ * Gateway protocol:
+ * A control request or reply is one datagram on the control port:
+ * a header of big endian words, then up to max_data_len bytes of data.
+ * A reply echoes the sequence of its request; a repeated request
+ * (because the reply was lost) gets the same reply without a resubmit.
+ *
+ * A pipe port carries the transfer frames unchanged, and flow messages:
+ * the client asks for a credit from a second socket, and the server
+ * answers with the number of frames it committed to the device,
+ * whether it is idle, waiting on frames that never came,
+ * and the sequence of the request it answers.
+ **********************************************************************/
+static const boost::uint32_t GATEWAY_CTRL_MAGIC = 0x55484447; //"UHDG"
+static const boost::uint32_t GATEWAY_FLOW_MAGIC = 0x55484746; //"UHGF"
+static const size_t max_data_len = 4096;
+static const double ctrl_timeout = 0.5; //seconds per try
+static const size_t ctrl_tries = 4;
+static const double poll_interval = 0.1; //seconds, of the server threads
+static const double credit_interval = 0.01; //seconds, between credit requests
+static const boost::posix_time::time_duration poll_timeout = boost::posix_time::milliseconds(long(poll_interval*1000));
+
+enum gateway_op_t{
+    GATEWAY_OP_INFO = 1,
+    GATEWAY_OP_CONTROL,
+    GATEWAY_OP_OPEN,
+    GATEWAY_OP_ATTACH,
+    GATEWAY_OP_RATE,
+    GATEWAY_OP_CLOSE
+};
+
+enum gateway_rate_t{
+    GATEWAY_RATE_RECV = 0,
+    GATEWAY_RATE_SEND,
+    GATEWAY_SEND_WINDOW
+};
+
+//! A control request (code is the op) or reply (code is the status)
+struct gateway_msg_t{
+    boost::uint32_t code;
+    boost::uint32_t args[4];
+    std::string data;
+    gateway_msg_t(const boost::uint32_t code_ = 0): code(code_){
+        std::fill(args, args+4, 0);
+    }
+};
+
+static const size_t gateway_hdr_words = 8; //magic, seq, code, args, len
+
+static std::string pack_msg(const boost::uint32_t seq, const gateway_msg_t &msg){
+    boost::uint32_t hdr[gateway_hdr_words] = {
+        GATEWAY_CTRL_MAGIC, seq, msg.code, msg.args[0], msg.args[1], msg.args[2], msg.args[3],
+        boost::uint32_t(msg.data.size())
+    };
+    for (size_t i = 0; i < gateway_hdr_words; i++) hdr[i] = htonx(hdr[i]);
+    return std::string(reinterpret_cast<const char *>(hdr), sizeof(hdr)) + msg.data;
+}
+
+static bool unpack_msg(const char *buff, const size_t len, boost::uint32_t &seq, gateway_msg_t &msg){
+    boost::uint32_t hdr[gateway_hdr_words];
+    if (len < sizeof(hdr)) return false;
+    std::memcpy(hdr, buff, sizeof(hdr));
+    for (size_t i = 0; i < gateway_hdr_words; i++) hdr[i] = ntohx(hdr[i]);
+    if (hdr[0] != GATEWAY_CTRL_MAGIC or hdr[7] > len - sizeof(hdr)) return false;
+    seq = hdr[1];
+    msg.code = hdr[2];
+    std::copy(hdr+3, hdr+7, msg.args);
+    msg.data = std::string(buff + sizeof(hdr), hdr[7]);
+    return true;
+}
+
+static boost::uint64_t double_to_bits(const double num){
+    boost::uint64_t bits; std::memcpy(&bits, &num, sizeof(bits)); return bits;
+}
+
+static double bits_to_double(const boost::uint64_t bits){
+    double num; std::memcpy(&num, &bits, sizeof(num)); return num;
+}
+
+/***********************************************************************
+ * Server pipe:
+ * The receive thread takes the device frames and sends them in batches.
+ * The send thread claims a device frame first, then receives a datagram
+ * straight into it, so a busy device backs up into the socket buffer.
+ **********************************************************************/
+class gateway_pipe : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<gateway_pipe> sptr;
+
+    gateway_pipe(
+        usb_zero_copy::sptr usb, const size_t send_batch,
+        atomic_uint32_t &num_recv_frames, atomic_uint32_t &num_send_frames
+    ):
+        _usb(usb), _socket(_io_service), _send_batch(std::max<size_t>(1, send_batch)),
+        _num_recv_frames(num_recv_frames), _num_send_frames(num_send_frames),
+        _flow_valid(false), _flow_seq(0), _num_committed(0), _num_credited(0)
+    {
+        _socket.open(asio::ip::udp::v4());
+        _socket.bind(asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+
+        //the frames of a full send window wait in the socket buffer,
+        //the kernel accounts about twice the datagram size for each one
+        boost::system::error_code ec;
+        _socket.set_option(asio::socket_base::receive_buffer_size(
+            int(2*_usb->get_num_send_frames()*_usb->get_send_frame_size())
+        ), ec);
+    }
+
+    //! The bytes of datagrams the pipe socket can hold
+    size_t get_recv_buff_size(void){
+        asio::socket_base::receive_buffer_size option;
+        _socket.get_option(option);
+        return size_t(option.value());
+    }
+
+    ~gateway_pipe(void){
+        _threads.interrupt_all();
+        _threads.join_all();
+    }
+
+    boost::uint16_t get_port(void) const{
+        return _socket.local_endpoint().port();
+    }
+
+    usb_zero_copy::sptr get_usb(void) const{
+        return _usb;
+    }
+
+    void attach(const asio::ip::udp::endpoint &data_endpoint){
+        if (_threads.size() != 0) throw uhd::runtime_error("usb gateway: pipe already attached");
+        _data_endpoint = data_endpoint;
+        _threads.create_thread(boost::bind(&gateway_pipe::recv_loop, this));
+        _threads.create_thread(boost::bind(&gateway_pipe::send_loop, this));
+    }
+
+private:
+    void recv_loop(void){
+        std::vector<managed_recv_buffer::sptr> buffs;
+        #ifdef HAVE_SENDMMSG
+        std::vector<iovec> iovs(_send_batch);
+        std::vector<mmsghdr> msgs(_send_batch);
+        #endif /*HAVE_SENDMMSG*/
+        while (not boost::this_thread::interruption_requested()){
+            //wait for one frame, then batch the ones already waiting
+            managed_recv_buffer::sptr buff = _usb->get_recv_buff(poll_interval);
+            if (buff.get() == NULL) continue;
+            buffs.push_back(buff);
+            while (buffs.size() < _send_batch and (buff = _usb->get_recv_buff(0.0)).get() != NULL){
+                buffs.push_back(buff);
+            }
+
+            #ifdef HAVE_SENDMMSG
+            std::memset(&msgs.front(), 0, msgs.size()*sizeof(mmsghdr));
+            for (size_t i = 0; i < buffs.size(); i++){
+                iovs[i].iov_base = const_cast<char *>(buffs[i]->cast<const char *>());
+                iovs[i].iov_len = buffs[i]->size();
+                msgs[i].msg_hdr.msg_name = _data_endpoint.data();
+                msgs[i].msg_hdr.msg_namelen = socklen_t(_data_endpoint.size());
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            size_t num_sent = 0;
+            while (num_sent < buffs.size()){
+                const int ret = ::sendmmsg(_socket.native(), &msgs[num_sent], buffs.size() - num_sent, 0);
+                if (ret <= 0) break; //error: the remainder is dropped like a failed send()
+                num_sent += size_t(ret);
+            }
+            #else
+            BOOST_FOREACH(const managed_recv_buffer::sptr &frame, buffs){
+                boost::system::error_code ec;
+                _socket.send_to(asio::buffer(frame->cast<const void *>(), frame->size()), _data_endpoint, 0, ec);
+            }
+            #endif /*HAVE_SENDMMSG*/
+
+            for (size_t i = 0; i < buffs.size(); i++) _num_recv_frames.inc();
+            buffs.clear(); //release the frames to the device
+        }
+    }
+
+    void send_loop(void){
+        managed_send_buffer::sptr buff;
+        boost::system_time last_data_time = boost::get_system_time();
+        while (not boost::this_thread::interruption_requested()){
+            if (buff.get() == NULL) buff = _usb->get_send_buff(poll_interval);
+            if (buff.get() == NULL) continue;
+
+            //report the progress once the socket is drained,
+            //and report idle when no frames came for the interval
+            if (not wait_for_recv_ready(_socket.native(), 0.0)){
+                if (_num_committed != _num_credited) this->send_credit(false);
+                if (not wait_for_recv_ready(_socket.native(), poll_interval)){
+                    this->send_credit(boost::get_system_time() - last_data_time >= poll_timeout);
+                    continue;
+                }
+            }
+
+            asio::ip::udp::endpoint sender;
+            boost::system::error_code ec;
+            const size_t len = _socket.receive_from(asio::buffer(buff->cast<void *>(), buff->size()), sender, 0, ec);
+            if (ec) continue;
+
+            //the frame datagrams come from the data socket of the client
+            if (sender == _data_endpoint){
+                if (len == 0) continue;
+                buff->commit(len);
+                buff.reset();
+                _num_committed++;
+                _num_send_frames.inc();
+                last_data_time = boost::get_system_time();
+                continue;
+            }
+
+            //a credit request from the flow socket of the client
+            const boost::uint32_t *request = buff->cast<const boost::uint32_t *>();
+            if (len >= 2*sizeof(boost::uint32_t) and ntohx(request[0]) == GATEWAY_FLOW_MAGIC){
+                _flow_endpoint = sender;
+                _flow_seq = ntohx(request[1]);
+                _flow_valid = true;
+                this->send_credit(boost::get_system_time() - last_data_time >= poll_timeout);
+            }
+        }
+    }
+
+    //! A credit: the frames committed, idle, and the request it answers
+    void send_credit(const bool idle){
+        if (not _flow_valid) return;
+        const boost::uint32_t credit[4] = {
+            htonx(GATEWAY_FLOW_MAGIC), htonx(_num_committed),
+            htonx(boost::uint32_t(idle? 1 : 0)), htonx(_flow_seq)
+        };
+        boost::system::error_code ec;
+        _socket.send_to(asio::buffer(credit, sizeof(credit)), _flow_endpoint, 0, ec);
+        _num_credited = _num_committed;
+    }
+
+    usb_zero_copy::sptr _usb;
+    asio::io_service _io_service;
+    asio::ip::udp::socket _socket;
+    const size_t _send_batch;
+    atomic_uint32_t &_num_recv_frames, &_num_send_frames;
+    asio::ip::udp::endpoint _data_endpoint, _flow_endpoint;
+    bool _flow_valid;
+    boost::uint32_t _flow_seq, _num_committed, _num_credited;
+    boost::thread_group _threads;
+};
+
+/***********************************************************************
+ * Gateway server implementation
+ **********************************************************************/
+class usb_gateway_server_impl : public usb_gateway_server{
+public:
+    usb_gateway_server_impl(usb_device_handle::sptr handle, const std::string &port, const device_addr_t &hints):
+        _handle(handle), _control(usb_control::make(handle, 0)), _socket(_io_service),
+        _send_batch(size_t(hints.cast<double>("send_batch", 16))),
+        _next_pipe_id(0), _last_seq(0)
+    {
+        _socket.open(asio::ip::udp::v4());
+        _socket.bind(asio::ip::udp::endpoint(asio::ip::udp::v4(), boost::lexical_cast<unsigned short>(port)));
+        UHD_LOG << boost::format("usb gateway serving %s on port %s") % handle->get_serial() % port << std::endl;
+        _thread = boost::thread(boost::bind(&usb_gateway_server_impl::ctrl_loop, this));
+    }
+
+    ~usb_gateway_server_impl(void){
+        _thread.interrupt();
+        _thread.join();
+        _pipes.clear();
+    }
+
+    size_t get_num_recv_frames(void) const{
+        return _num_recv_frames.read();
+    }
+
+    size_t get_num_send_frames(void) const{
+        return _num_send_frames.read();
+    }
+
+private:
+    void ctrl_loop(void){
+        std::vector<char> request(max_data_len + gateway_hdr_words*sizeof(boost::uint32_t));
+        while (not boost::this_thread::interruption_requested()){
+            if (not wait_for_recv_ready(_socket.native(), poll_interval)) continue;
+            asio::ip::udp::endpoint sender;
+            boost::system::error_code ec;
+            const size_t len = _socket.receive_from(asio::buffer(request), sender, 0, ec);
+            boost::uint32_t seq;
+            gateway_msg_t msg;
+            if (ec or not unpack_msg(&request.front(), len, seq, msg)) continue;
+
+            //a repeated request gets the reply again, it is not submitted twice
+            if (not (sender == _last_sender and seq == _last_seq)){
+                gateway_msg_t reply;
+                try{
+                    reply = this->handle_request(msg, sender);
+                }
+                catch(const std::exception &e){
+                    reply = gateway_msg_t(~boost::uint32_t(0));
+                    reply.data = e.what();
+                }
+                _last_sender = sender;
+                _last_seq = seq;
+                _last_reply = pack_msg(seq, reply);
+            }
+            _socket.send_to(asio::buffer(_last_reply), sender, 0, ec);
+        }
+    }
+
+    gateway_msg_t handle_request(const gateway_msg_t &msg, const asio::ip::udp::endpoint &sender){
+        gateway_msg_t reply;
+        switch(msg.code){
+        case GATEWAY_OP_INFO:
+            reply.args[0] = _handle->get_vendor_id();
+            reply.args[1] = _handle->get_product_id();
+            reply.data = _handle->get_serial();
+            return reply;
+
+        case GATEWAY_OP_CONTROL:{
+            const boost::uint8_t request_type = boost::uint8_t(msg.args[0] >> 8);
+            const boost::uint16_t length = boost::uint16_t(std::min<size_t>(msg.args[3], max_data_len));
+            std::vector<unsigned char> buff(std::max<size_t>(1, length));
+            if ((request_type & 0x80) == 0) std::copy(msg.data.begin(), msg.data.begin() + std::min<size_t>(length, msg.data.size()), buff.begin());
+            const ssize_t ret = _control->submit(
+                request_type, boost::uint8_t(msg.args[0]), boost::uint16_t(msg.args[1]), boost::uint16_t(msg.args[2]),
+                &buff.front(), length
+            );
+            reply.code = boost::uint32_t(boost::int32_t(ret));
+            if ((request_type & 0x80) != 0 and ret > 0) reply.data = std::string(reinterpret_cast<const char *>(&buff.front()), size_t(ret));
+            return reply;
+        }
+
+        case GATEWAY_OP_OPEN:{
+            gateway_pipe::sptr pipe(new gateway_pipe(usb_zero_copy::make(
+                _handle, msg.args[0], msg.args[1], msg.args[2], msg.args[3], device_addr_t(msg.data)
+            ), _send_batch, _num_recv_frames, _num_send_frames));
+            const boost::uint32_t id = _next_pipe_id++;
+            _pipes[id] = pipe;
+            reply.args[0] = id;
+            reply.args[1] = pipe->get_port();
+            reply.args[2] = boost::uint32_t(pipe->get_recv_buff_size());
+            return reply;
+        }
+
+        case GATEWAY_OP_ATTACH:
+            this->get_pipe(msg.args[0])->attach(asio::ip::udp::endpoint(sender.address(), boost::uint16_t(msg.args[1])));
+            return reply;
+
+        case GATEWAY_OP_RATE:{
+            usb_zero_copy::sptr usb = this->get_pipe(msg.args[0])->get_usb();
+            const double value = bits_to_double((boost::uint64_t(msg.args[2]) << 32) | msg.args[3]);
+            switch(msg.args[1]){
+            case GATEWAY_RATE_RECV: usb->set_recv_rate(value); break;
+            case GATEWAY_RATE_SEND: usb->set_send_rate(value); break;
+            case GATEWAY_SEND_WINDOW: usb->set_send_window(size_t(value)); break;
+            }
+            return reply;
+        }
+
+        case GATEWAY_OP_CLOSE:
+            _pipes.erase(msg.args[0]);
+            return reply;
+        }
+        throw uhd::value_error(str(boost::format("usb gateway: unknown request %u") % msg.code));
+    }
+
+    gateway_pipe::sptr get_pipe(const boost::uint32_t id){
+        if (_pipes.count(id) == 0) throw uhd::key_error(str(boost::format("usb gateway: no pipe %u") % id));
+        return _pipes[id];
+    }
+
+    usb_device_handle::sptr _handle;
+    usb_control::sptr _control;
+    asio::io_service _io_service;
+    asio::ip::udp::socket _socket;
+    const size_t _send_batch;
+    mutable atomic_uint32_t _num_recv_frames, _num_send_frames;
+    std::map<boost::uint32_t, gateway_pipe::sptr> _pipes;
+    boost::uint32_t _next_pipe_id;
+    asio::ip::udp::endpoint _last_sender;
+    boost::uint32_t _last_seq;
+    std::string _last_reply;
+    boost::thread _thread;
+};
+
+usb_gateway_server::sptr usb_gateway_server::make(
+    usb_device_handle::sptr handle, const std::string &port, const device_addr_t &hints
+){
+    return sptr(new usb_gateway_server_impl(handle, port, hints));
+}
+
+/***********************************************************************
+ * Client control requests:
+ * One request in flight at a time, retried until a reply comes.
+ **********************************************************************/
+class gateway_ctrl_client : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<gateway_ctrl_client> sptr;
+
+    gateway_ctrl_client(const std::string &addr, const std::string &port):
+        _addr(addr), _udp(udp_simple::make_connected(addr, port)), _seq(0)
+    {
+        /* NOP */
+    }
+
+    gateway_msg_t transact(const gateway_msg_t &request){
+        boost::mutex::scoped_lock lock(_mutex);
+        const boost::uint32_t seq = ++_seq;
+        const std::string datagram = pack_msg(seq, request);
+        std::vector<char> buff(max_data_len + gateway_hdr_words*sizeof(boost::uint32_t));
+        for (size_t i = 0; i < ctrl_tries; i++){
+            _udp->send(asio::buffer(datagram));
+            size_t len;
+            while ((len = _udp->recv(asio::buffer(buff), ctrl_timeout)) != 0){
+                boost::uint32_t reply_seq;
+                gateway_msg_t reply;
+                if (unpack_msg(&buff.front(), len, reply_seq, reply) and reply_seq == seq) return reply;
+            }
+        }
+        throw uhd::io_error("usb gateway: no reply from " + _addr);
+    }
+
+    //! Transact and throw the message of a failed request
+    gateway_msg_t transact_ok(const gateway_msg_t &request){
+        const gateway_msg_t reply = this->transact(request);
+        if (reply.code != 0) throw uhd::runtime_error("usb gateway: " + reply.data);
+        return reply;
+    }
+
+private:
+    const std::string _addr;
+    udp_simple::sptr _udp;
+    boost::mutex _mutex;
+    boost::uint32_t _seq;
+};
+
+/***********************************************************************
+ * Client control transport
+ **********************************************************************/
+class gateway_usb_control : public usb_control{
+public:
+    gateway_usb_control(const std::string &addr, const std::string &port):
+        _ctrl(new gateway_ctrl_client(addr, port))
+    {
+        /* NOP */
+    }
+
+    ssize_t submit(
+        boost::uint8_t request_type, boost::uint8_t request,
+        boost::uint16_t value, boost::uint16_t index,
+        unsigned char *buff, boost::uint16_t length
+    ){
+        if (length > max_data_len) throw uhd::value_error("usb gateway: control request too long");
+        gateway_msg_t msg(GATEWAY_OP_CONTROL);
+        msg.args[0] = (boost::uint32_t(request_type) << 8) | request;
+        msg.args[1] = value;
+        msg.args[2] = index;
+        msg.args[3] = length;
+        const bool device_to_host = (request_type & 0x80) != 0;
+        if (not device_to_host and length != 0) msg.data = std::string(reinterpret_cast<const char *>(buff), length);
+        const gateway_msg_t reply = _ctrl->transact(msg);
+        const ssize_t ret = ssize_t(boost::int32_t(reply.code));
+        if (device_to_host and ret > 0) std::memcpy(buff, reply.data.data(), std::min<size_t>(reply.data.size(), length));
+        return ret;
+    }
+
+private:
+    gateway_ctrl_client::sptr _ctrl;
+};
+
+/***********************************************************************
+ * Client zero copy transport:
+ * The frames go over a udp zero copy transport to the pipe port.
+ * Sends wait for a credit when the window of frames is in flight;
+ * when the server answers that no frames came for a while,
+ * the frames in flight were lost on the way, and the window opens again.
+ **********************************************************************/
+class gateway_zero_copy : public usb_zero_copy{
+public:
+    gateway_zero_copy(
+        const std::string &addr, const std::string &port,
+        const size_t recv_interface, const size_t recv_endpoint,
+        const size_t send_interface, const size_t send_endpoint,
+        const device_addr_t &hints
+    ):
+        _ctrl(new gateway_ctrl_client(addr, port)),
+        _flow_seq(0), _num_sent(0), _num_acked(0), _num_lost(0)
+    {
+        gateway_msg_t open(GATEWAY_OP_OPEN);
+        open.args[0] = boost::uint32_t(recv_interface);
+        open.args[1] = boost::uint32_t(recv_endpoint);
+        open.args[2] = boost::uint32_t(send_interface);
+        open.args[3] = boost::uint32_t(send_endpoint);
+        open.data = hints.to_string();
+        const gateway_msg_t opened = _ctrl->transact_ok(open);
+        _pipe_id = opened.args[0];
+        const std::string pipe_port = boost::lexical_cast<std::string>(opened.args[1]);
+
+        //the server sends in batches, leave room for them in the socket buffer
+        device_addr_t udp_hints = hints;
+        if (not udp_hints.has_key("recv_buff_size")){
+            udp_hints["recv_buff_size"] = boost::lexical_cast<std::string>(
+                2*size_t(hints.cast<double>("num_recv_frames", 32))*size_t(hints.cast<double>("recv_frame_size", 1472))
+            );
+        }
+        _udp = udp_zero_copy::make(addr, pipe_port, udp_hints);
+        _flow = udp_simple::make_connected(addr, pipe_port);
+        gateway_msg_t attach(GATEWAY_OP_ATTACH);
+        attach.args[0] = _pipe_id;
+        attach.args[1] = _udp->get_local_port();
+        _ctrl->transact_ok(attach);
+
+        //the frames in flight must fit in the socket buffer of the server
+        _max_window = std::max<size_t>(1, std::min<size_t>(
+            _udp->get_num_send_frames(), opened.args[2]/(2*_udp->get_send_frame_size())
+        ));
+        _window = std::max<size_t>(1, std::min(_max_window, size_t(hints.cast<double>("gateway_window", double(_max_window)))));
+        this->request_credit();
+    }
+
+    ~gateway_zero_copy(void){
+        gateway_msg_t close(GATEWAY_OP_CLOSE);
+        close.args[0] = _pipe_id;
+        UHD_SAFE_CALL(_ctrl->transact(close);)
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(double timeout){
+        return _udp->get_recv_buff(timeout);
+    }
+
+    size_t get_num_recv_frames(void) const{
+        return _udp->get_num_recv_frames();
+    }
+
+    size_t get_recv_frame_size(void) const{
+        return _udp->get_recv_frame_size();
+    }
+
+    managed_send_buffer::sptr get_send_buff(double timeout){
+        const boost::system_time exit_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+        while (boost::uint32_t(_num_sent - _num_acked) >= _window){
+            if (not this->wait_for_credit(exit_time)) return managed_send_buffer::sptr();
+        }
+        managed_send_buffer::sptr buff = _udp->get_send_buff(timeout);
+        if (buff.get() != NULL) _num_sent++; //every claimed frame is committed by the handlers
+        return buff;
+    }
+
+    size_t get_num_send_frames(void) const{
+        return _udp->get_num_send_frames();
+    }
+
+    size_t get_send_frame_size(void) const{
+        return _udp->get_send_frame_size();
+    }
+
+    void flush_send_buffs(void){
+        _udp->flush_send_buffs();
+    }
+
+    zero_copy_stats_t get_stats(void) const{
+        return _udp->get_stats();
+    }
+
+    poll_fds_t get_recv_poll_fds(void) const{
+        return _udp->get_recv_poll_fds();
+    }
+
+    void set_recv_rate(double bytes_per_sec){
+        this->set_rate(GATEWAY_RATE_RECV, bytes_per_sec);
+    }
+
+    void set_send_rate(double bytes_per_sec){
+        this->set_rate(GATEWAY_RATE_SEND, bytes_per_sec);
+    }
+
+    void set_send_window(size_t num_frames){
+        _window = std::max<size_t>(1, std::min(num_frames, _max_window));
+        this->set_rate(GATEWAY_SEND_WINDOW, double(_window));
+    }
+
+private:
+    void set_rate(const gateway_rate_t which, const double value){
+        gateway_msg_t rate(GATEWAY_OP_RATE);
+        rate.args[0] = _pipe_id;
+        rate.args[1] = which;
+        rate.args[2] = boost::uint32_t(double_to_bits(value) >> 32);
+        rate.args[3] = boost::uint32_t(double_to_bits(value));
+        _ctrl->transact_ok(rate);
+    }
+
+    void request_credit(void){
+        const boost::uint32_t request[2] = {htonx(GATEWAY_FLOW_MAGIC), htonx(_flow_seq)};
+        _flow->send(asio::buffer(request, sizeof(request)));
+    }
+
+    //! Wait for a credit that opens the window, false on timeout
+    bool wait_for_credit(const boost::system_time &exit_time){
+        _flow_seq++;
+        this->request_credit();
+        boost::uint32_t credit[4];
+        while (true){
+            const double remaining = (exit_time - boost::get_system_time()).total_microseconds()/1e6;
+            if (remaining <= 0) return false;
+            if (_flow->recv(asio::buffer(credit, sizeof(credit)), std::min(credit_interval, remaining)) != sizeof(credit)){
+                this->request_credit(); //the request or the credit was lost
+                continue;
+            }
+            if (ntohx(credit[0]) != GATEWAY_FLOW_MAGIC) continue;
+
+            //the counts wrap: credits behind the last one are stale,
+            //and frames thought lost may turn up after all
+            const boost::uint32_t acked = ntohx(credit[1]) + _num_lost;
+            if (boost::int32_t(acked - _num_acked) > 0) _num_acked = acked;
+            if (boost::int32_t(_num_acked - _num_sent) > 0) _num_acked = _num_sent;
+            if (boost::uint32_t(_num_sent - _num_acked) < _window) return true;
+
+            //the server saw this request and no frames for a while:
+            //the frames in flight were lost, forget them
+            if (ntohx(credit[2]) != 0 and ntohx(credit[3]) == _flow_seq){
+                UHD_LOG << boost::format("usb gateway: %u send frames lost") % (_num_sent - _num_acked) << std::endl;
+                _num_lost += _num_sent - _num_acked;
+                _num_acked = _num_sent;
+                return true;
+            }
+        }
+    }
+
+    gateway_ctrl_client::sptr _ctrl;
+    boost::uint32_t _pipe_id;
+    udp_zero_copy::sptr _udp;
+    udp_simple::sptr _flow;
+    size_t _max_window, _window;
+    boost::uint32_t _flow_seq, _num_sent, _num_acked, _num_lost;
+};
+
+/***********************************************************************
+ * Client factory functions
+ **********************************************************************/
+std::string usb_gateway::get_device_info(
+    const std::string &addr, const std::string &port,
+    boost::uint16_t &vid, boost::uint16_t &pid
+){
+    const gateway_msg_t reply = gateway_ctrl_client(addr, port).transact_ok(gateway_msg_t(GATEWAY_OP_INFO));
+    vid = boost::uint16_t(reply.args[0]);
+    pid = boost::uint16_t(reply.args[1]);
+    return reply.data;
+}
+
+usb_control::sptr usb_gateway::make_control(const std::string &addr, const std::string &port){
+    return usb_control::sptr(new gateway_usb_control(addr, port));
+}
+
+usb_zero_copy::sptr usb_gateway::make_zero_copy(
+    const std::string &addr,
+    const std::string &port,
+    const size_t recv_interface,
+    const size_t recv_endpoint,
+    const size_t send_interface,
+    const size_t send_endpoint,
+    const device_addr_t &hints
+){
+    return usb_zero_copy::sptr(new gateway_zero_copy(
+        addr, port, recv_interface, recv_endpoint, send_interface, send_endpoint, hints
+    ));
+}
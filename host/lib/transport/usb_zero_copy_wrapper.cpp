@@ -19,6 +19,7 @@
 #include <uhd/transport/bounded_buffer.hpp>
 #include <uhd/transport/buffer_pool.hpp>
 #include <boost/foreach.hpp>
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
@@ -32,6 +33,9 @@ static inline size_t next_boundary(size_t length, size_t boundary){
 
 /***********************************************************************
  * USB zero copy wrapper - managed receive buffer
+ *  - A view of one packet inside a usb transfer (no copy).
+ *  - Holds a reference to the transfer's managed buffer,
+ *    which is released once the last view of it is released.
  **********************************************************************/
 class usb_zero_copy_wrapper_mrb : public managed_recv_buffer{
 public:
@@ -40,9 +44,8 @@ public:
 
     void release(void){
         if (_mrb.get() == NULL) return;
-        _mrb->release();
+        _mrb.reset(); //drop this view's reference to the transfer
         _queue.push_with_haste(this);
-        _mrb.reset();
     }
 
     sptr get_new(managed_recv_buffer::sptr mrb, const void *mem, size_t len){
@@ -101,9 +104,9 @@ public:
     ):
         _internal_zc(usb_zc),
         _usb_frame_boundary(usb_frame_boundary),
-        _available_recv_buffs(this->get_num_recv_frames()),
+        _available_recv_buffs(this->get_num_recv_views()),
         _available_send_buffs(this->get_num_send_frames()),
-        _mrb_pool(this->get_num_recv_frames(), usb_zero_copy_wrapper_mrb(_available_recv_buffs)),
+        _mrb_pool(this->get_num_recv_views(), usb_zero_copy_wrapper_mrb(_available_recv_buffs)),
         _msb_pool(this->get_num_send_frames(), usb_zero_copy_wrapper_msb(_available_send_buffs, usb_frame_boundary))
     {
         BOOST_FOREACH(usb_zero_copy_wrapper_mrb &mrb, _mrb_pool){
@@ -129,13 +132,18 @@ public:
             const char *mem = _last_recv_buff->cast<const char *>() + _last_recv_offset;
             const boost::uint32_t *mem32 = reinterpret_cast<const boost::uint32_t *>(mem);
             size_t len = (mem32[0] & 0xffff)*sizeof(boost::uint32_t); //length in bytes (from VRT header)
-            
+
+            //a view never extends past the transfer, and an empty header ends the transfer
+            const size_t remaining = _last_recv_buff->size() - _last_recv_offset;
+            if (len == 0 or len > remaining) len = remaining;
+
             managed_recv_buffer::sptr recv_buff; //the buffer to be returned to the user
-            
+
             recv_buff = wmrb->get_new(_last_recv_buff, mem, len);
             _last_recv_offset = next_boundary(_last_recv_offset + len, _usb_frame_boundary);
-            
-            //check if this receive buffer has been exhausted
+
+            //check if this receive buffer has been exhausted:
+            //the transfer is resubmitted once the views above are released
             if (_last_recv_offset >= _last_recv_buff->size()) {
                 _last_recv_buff.reset();
             }
@@ -176,17 +184,43 @@ public:
         return _internal_zc->get_send_frame_size();
     }
 
+    //the counters are kept per usb transfer by the wrapped transport
+    zero_copy_stats_t get_stats(void) const{
+        return _internal_zc->get_stats();
+    }
+
+    //frames already split off the last transfer are returned before waiting:
+    //the caller drains with a zero timeout after each wakeup, so none are stranded
+    poll_fds_t get_recv_poll_fds(void) const{
+        return _internal_zc->get_recv_poll_fds();
+    }
+
+    void set_recv_rate(double bytes_per_sec){
+        _internal_zc->set_recv_rate(bytes_per_sec);
+    }
+
+    void set_send_rate(double bytes_per_sec){
+        _internal_zc->set_send_rate(bytes_per_sec);
+    }
+
+    void set_send_window(size_t num_frames){
+        _internal_zc->set_send_window(num_frames);
+    }
+
 private:
+    //! the most views that can be outstanding: every packet of every transfer
+    size_t get_num_recv_views(void) const{
+        const size_t views_per_frame = this->get_recv_frame_size()/_usb_frame_boundary;
+        return this->get_num_recv_frames()*std::max<size_t>(views_per_frame, 1);
+    }
+
     sptr _internal_zc;
     size_t _usb_frame_boundary;
     bounded_buffer<usb_zero_copy_wrapper_mrb *> _available_recv_buffs;
     bounded_buffer<usb_zero_copy_wrapper_msb *> _available_send_buffs;
     std::vector<usb_zero_copy_wrapper_mrb> _mrb_pool;
     std::vector<usb_zero_copy_wrapper_msb> _msb_pool;
-    
-    //buffer to store partially-received VRT packets in
-    buffer_pool::sptr _fragment_mem;
-    
+
     //state for last recv buffer to create multiple managed buffers
     managed_recv_buffer::sptr _last_recv_buff;
     size_t _last_recv_offset;
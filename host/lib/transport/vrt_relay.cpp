@@ -0,0 +1,170 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/transport/vrt_relay.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/exception.hpp>
+#include <boost/asio.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <vector>
+#include <cstring>
+
+#ifdef HAVE_SENDMMSG
+#include <sys/socket.h>
+#endif /*HAVE_SENDMMSG*/
+
+using namespace uhd;
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+/***********************************************************************
+ * VRT relay implementation:
+ * Each frame goes out as two pieces, the rewritten first header word
+ * from the relay memory and the rest of the frame from the transport.
+ * So the frames are never copied or written in place.
+ * The packet count lives in bits 16 to 19 of the first header word.
+ **********************************************************************/
+static const boost::uint32_t packet_count_mask = 0xf << 16;
+
+class vrt_relay_impl : public vrt_relay{
+public:
+    vrt_relay_impl(const std::vector<std::string> &addrs, const std::string &port, const size_t batch_size):
+        _socket(_io_service), _batch_size(std::max<size_t>(1, batch_size)), _num_views(0),
+        _num_frames(0), _num_dropped(0)
+    {
+        if (addrs.empty()) throw uhd::value_error("vrt relay: no destination addresses");
+        asio::ip::udp::resolver resolver(_io_service);
+        BOOST_FOREACH(const std::string &addr, addrs){
+            const size_t colon = addr.find(':');
+            const std::string host = addr.substr(0, colon);
+            const std::string host_port = (colon == std::string::npos)? port : addr.substr(colon + 1);
+            asio::ip::udp::resolver::query query(asio::ip::udp::v4(), host, host_port);
+            _endpoints.push_back(*resolver.resolve(query));
+            UHD_LOG << boost::format("vrt relay destination %s") % _endpoints.back() << std::endl;
+        }
+        _socket.open(asio::ip::udp::v4());
+    }
+
+    ~vrt_relay_impl(void){
+        UHD_SAFE_CALL(this->flush();)
+    }
+
+    void relay(const device::recv_view_t &view){
+        if (_counts.size() < view.frames.size()) _counts.resize(view.frames.size(), 0);
+        const bool big_endian = view.otw_type.byteorder == otw_type_t::BO_BIG_ENDIAN;
+        for (size_t ch = 0; ch < view.frames.size(); ch++){
+            const managed_recv_buffer::sptr &frame = view.frames[ch];
+            if (frame.get() == NULL or frame->size() < sizeof(boost::uint32_t)) continue;
+            boost::uint32_t word0 = frame->cast<const boost::uint32_t *>()[0];
+            word0 = big_endian? ntohx(word0) : wtohx(word0);
+            word0 = (word0 & ~packet_count_mask) | (boost::uint32_t(_counts[ch]) << 16);
+            _words.push_back(big_endian? htonx(word0) : htowx(word0));
+            _frames.push_back(frame);
+            _counts[ch] = (_counts[ch] + 1)%16;
+        }
+        if (++_num_views >= _batch_size) this->flush();
+    }
+
+    void mark_gap(void){
+        BOOST_FOREACH(size_t &count, _counts) count = (count + 1)%16;
+    }
+
+    void flush(void){
+        if (_frames.empty()) return;
+
+        #ifdef HAVE_SENDMMSG
+        //one message per frame and destination, the iovecs are shared
+        _iovs.resize(2*_frames.size());
+        _msgs.resize(_frames.size()*_endpoints.size());
+        std::memset(&_msgs.front(), 0, _msgs.size()*sizeof(mmsghdr));
+        for (size_t i = 0; i < _frames.size(); i++){
+            _iovs[2*i+0].iov_base = &_words[i];
+            _iovs[2*i+0].iov_len = sizeof(boost::uint32_t);
+            _iovs[2*i+1].iov_base = const_cast<char *>(_frames[i]->cast<const char *>() + sizeof(boost::uint32_t));
+            _iovs[2*i+1].iov_len = _frames[i]->size() - sizeof(boost::uint32_t);
+            for (size_t d = 0; d < _endpoints.size(); d++){
+                msghdr &hdr = _msgs[i*_endpoints.size() + d].msg_hdr;
+                hdr.msg_name = _endpoints[d].data();
+                hdr.msg_namelen = socklen_t(_endpoints[d].size());
+                hdr.msg_iov = &_iovs[2*i];
+                hdr.msg_iovlen = 2;
+            }
+        }
+        size_t num_sent = 0;
+        while (num_sent < _msgs.size()){
+            const int ret = ::sendmmsg(_socket.native(), &_msgs[num_sent], _msgs.size() - num_sent, 0);
+            if (ret <= 0) break; //error: the remainder is dropped like a failed send()
+            num_sent += size_t(ret);
+        }
+        _num_dropped += _msgs.size() - num_sent;
+
+        #else
+        for (size_t i = 0; i < _frames.size(); i++){
+            std::vector<asio::const_buffer> buffs;
+            buffs.push_back(asio::const_buffer(&_words[i], sizeof(boost::uint32_t)));
+            buffs.push_back(asio::const_buffer(_frames[i]->cast<const char *>() + sizeof(boost::uint32_t),
+                _frames[i]->size() - sizeof(boost::uint32_t)));
+            BOOST_FOREACH(const asio::ip::udp::endpoint &endpoint, _endpoints){
+                boost::system::error_code ec;
+                _socket.send_to(buffs, endpoint, 0, ec);
+                if (ec) _num_dropped++;
+            }
+        }
+        #endif /*HAVE_SENDMMSG*/
+
+        //the frames go back to the transport here
+        _num_frames += _frames.size();
+        _frames.clear();
+        _words.clear();
+        _num_views = 0;
+    }
+
+    size_t get_num_frames(void) const{
+        return _num_frames;
+    }
+
+    size_t get_num_dropped(void) const{
+        return _num_dropped;
+    }
+
+private:
+    asio::io_service _io_service;
+    asio::ip::udp::socket _socket;
+    std::vector<asio::ip::udp::endpoint> _endpoints;
+    const size_t _batch_size;
+    size_t _num_views;
+    std::vector<size_t> _counts; //next packet count per channel
+    std::vector<boost::uint32_t> _words; //rewritten first header words
+    std::vector<managed_recv_buffer::sptr> _frames; //held until sent
+    size_t _num_frames, _num_dropped;
+    #ifdef HAVE_SENDMMSG
+    std::vector<iovec> _iovs;
+    std::vector<mmsghdr> _msgs;
+    #endif /*HAVE_SENDMMSG*/
+};
+
+/***********************************************************************
+ * VRT relay factory function
+ **********************************************************************/
+vrt_relay::sptr vrt_relay::make(
+    const std::vector<std::string> &addrs, const std::string &port, size_t batch_size
+){
+    return sptr(new vrt_relay_impl(addrs, port, batch_size));
+}
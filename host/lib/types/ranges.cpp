@@ -74,19 +74,34 @@ const std::string range_t::to_pp_string(void) const{
 }
 
 /***********************************************************************
- * meta_range_t implementation code
+ * meta_range_t implementation code:
+ *    Monotonic ranges are sorted by start and stop both,
+ *    so the overall start and stop are the ends of the list,
+ *    and the range of a value is found with a binary search.
+ *    The accessors check the ranges to be monotonic in one pass.
+ *    Clip is called per setting, so it only checks in debug builds,
+ *    and keeps to the binary search in release builds.
  **********************************************************************/
-void check_meta_range_monotonic(const meta_range_t &mr){
+static void check_meta_range_not_empty(const meta_range_t &mr){
     if (mr.empty()){
         throw uhd::value_error("meta-range cannot be empty");
     }
+}
+
+void check_meta_range_monotonic(const meta_range_t &mr){
+    check_meta_range_not_empty(mr);
     for (size_t i = 1; i < mr.size(); i++){
-        if (mr.at(i).start() < mr.at(i-1).stop()){
+        if (mr[i].start() < mr[i-1].stop()){
             throw uhd::value_error("meta-range is not monotonic");
         }
     }
 }
 
+//! Does the range stop before the value?
+static bool stops_before(const range_t &r, double value){
+    return r.stop() < value;
+}
+
 meta_range_t::meta_range_t(void){
     /* NOP */
 }
@@ -101,57 +116,50 @@ meta_range_t::meta_range_t(
 
 double meta_range_t::start(void) const{
     check_meta_range_monotonic(*this);
-    double min_start = this->front().start();
-    BOOST_FOREACH(const range_t &r, (*this)){
-        min_start = std::min(min_start, r.start());
-    }
-    return min_start;
+    return this->front().start();
 }
 
 double meta_range_t::stop(void) const{
     check_meta_range_monotonic(*this);
-    double max_stop = this->front().stop();
-    BOOST_FOREACH(const range_t &r, (*this)){
-        max_stop = std::max(max_stop, r.stop());
-    }
-    return max_stop;
+    return this->back().stop();
 }
 
 double meta_range_t::step(void) const{
     check_meta_range_monotonic(*this);
-    std::vector<double> non_zero_steps;
-    range_t last = this->front();
-    BOOST_FOREACH(const range_t &r, (*this)){
-        //steps at each range
-        if (r.step() > 0) non_zero_steps.push_back(r.step());
-        //and steps in-between ranges
-        double ibtw_step = r.start() - last.stop();
-        if (ibtw_step > 0) non_zero_steps.push_back(ibtw_step);
-        //store ref to last
-        last = r;
+    double min_step = 0; //all zero steps, its zero...
+    for (size_t i = 0; i < this->size(); i++){
+        //steps at each range, and steps in-between ranges
+        const double range_step = (*this)[i].step();
+        const double ibtw_step = (i == 0)? 0 : (*this)[i].start() - (*this)[i-1].stop();
+        if (range_step > 0 and (min_step == 0 or range_step < min_step)) min_step = range_step;
+        if (ibtw_step > 0 and (min_step == 0 or ibtw_step < min_step)) min_step = ibtw_step;
     }
-    if (non_zero_steps.empty()) return 0; //all zero steps, its zero...
-    return *std::min_element(non_zero_steps.begin(), non_zero_steps.end());
+    return min_step;
 }
 
 double meta_range_t::clip(double value, bool clip_step) const{
+    #ifdef NDEBUG
+    check_meta_range_not_empty(*this);
+    #else
     check_meta_range_monotonic(*this);
-    double last_stop = this->front().stop();
-    BOOST_FOREACH(const range_t &r, (*this)){
-        //in-between ranges, clip to nearest
-        if (value < r.start()){
-            return (std::abs(value - r.start()) < std::abs(value - last_stop))?
-                r.start() : last_stop;
-        }
-        //in this range, clip here
-        if (value <= r.stop()){
-            if (not clip_step or r.step() == 0) return value;
-            return boost::math::round((value - r.start())/r.step())*r.step() + r.start();
-        }
-        //continue on to the next range
-        last_stop = r.stop();
+    #endif
+
+    //the first range that does not stop before the value
+    const_iterator it = std::lower_bound(this->begin(), this->end(), value, &stops_before);
+    if (it == this->end()) return this->back().stop();
+    const range_t &r = *it;
+
+    //in-between ranges, clip to nearest
+    if (value < r.start()){
+        if (it == this->begin()) return r.start();
+        const double last_stop = (it-1)->stop();
+        return (std::abs(value - r.start()) < std::abs(value - last_stop))?
+            r.start() : last_stop;
     }
-    return last_stop;
+
+    //in this range, clip here
+    if (not clip_step or r.step() == 0) return value;
+    return boost::math::round((value - r.start())/r.step())*r.step() + r.start();
 }
 
 const std::string meta_range_t::to_pp_string(void) const{
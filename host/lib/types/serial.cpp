@@ -18,6 +18,7 @@
 #include <uhd/types/serial.hpp>
 #include <boost/thread.hpp> //for sleeping
 #include <boost/assign/list_of.hpp>
+#include <algorithm>
 
 using namespace uhd;
 
@@ -41,16 +42,25 @@ void i2c_iface::write_eeprom(
     }
 }
 
+/*!
+ * Sequential reads are limited to a chunk size that fits inside
+ * the smallest i2c transaction of the supported transports
+ * (the usrp2 control packet carries up to 20 data bytes).
+ */
+static const size_t EEPROM_READ_CHUNK_SIZE = 16;
+
 byte_vector_t i2c_iface::read_eeprom(
     boost::uint8_t addr,
     boost::uint8_t offset,
     size_t num_bytes
 ){
     byte_vector_t bytes;
-    for (size_t i = 0; i < num_bytes; i++){
-        //do a zero byte write to start read cycle
-        this->write_i2c(addr, byte_vector_t(1, offset+i));
-        bytes.push_back(this->read_i2c(addr, 1).at(0));
+    while (bytes.size() < num_bytes){
+        const size_t chunk = std::min(num_bytes - bytes.size(), EEPROM_READ_CHUNK_SIZE);
+        //do a zero byte write to set the address, then read sequentially
+        this->write_i2c(addr, byte_vector_t(1, offset+bytes.size()));
+        const byte_vector_t chunk_bytes = this->read_i2c(addr, chunk);
+        bytes.insert(bytes.end(), chunk_bytes.begin(), chunk_bytes.end());
     }
     return bytes;
 }
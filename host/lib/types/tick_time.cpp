@@ -0,0 +1,82 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/types/tick_time.hpp>
+#include <uhd/exception.hpp>
+#include <boost/math/special_functions/round.hpp>
+
+using namespace uhd;
+
+/***********************************************************************
+ * Tick time constructors
+ **********************************************************************/
+static boost::int64_t to_integer_rate(const double tick_rate){
+    const boost::int64_t rate = boost::math::llround(tick_rate);
+    if (rate <= 0) throw uhd::value_error("tick_time_t: the tick rate must be positive");
+    return rate;
+}
+
+tick_time_t::tick_time_t(time_t full_secs, boost::int64_t ticks, double tick_rate):
+    _full_secs(full_secs), _ticks(ticks), _tick_rate(to_integer_rate(tick_rate))
+{
+    this->normalize();
+}
+
+tick_time_t::tick_time_t(const time_spec_t &time, double tick_rate):
+    _full_secs(time.get_full_secs()),
+    _ticks(boost::math::llround(time.get_frac_secs()*tick_rate)),
+    _tick_rate(to_integer_rate(tick_rate))
+{
+    this->normalize(); //the rounding can carry into the next second
+}
+
+void tick_time_t::normalize(void){
+    _full_secs += time_t(_ticks/_tick_rate);
+    _ticks %= _tick_rate;
+    if (_ticks < 0){
+        _full_secs -= 1;
+        _ticks += _tick_rate;
+    }
+}
+
+/***********************************************************************
+ * Tick time conversions
+ **********************************************************************/
+time_spec_t tick_time_t::to_time_spec(void) const{
+    return time_spec_t(_full_secs, double(_ticks)/_tick_rate);
+}
+
+/***********************************************************************
+ * Tick time comparisons
+ **********************************************************************/
+bool uhd::operator==(const tick_time_t &lhs, const tick_time_t &rhs){
+    //the ticks are normalized into [0, rate), so cross multiply to compare
+    return
+        lhs.get_full_secs() == rhs.get_full_secs() and
+        boost::uint64_t(lhs.get_ticks())*boost::uint64_t(rhs.get_tick_rate()) ==
+        boost::uint64_t(rhs.get_ticks())*boost::uint64_t(lhs.get_tick_rate())
+    ;
+}
+
+bool uhd::operator<(const tick_time_t &lhs, const tick_time_t &rhs){
+    return (
+        (lhs.get_full_secs() < rhs.get_full_secs()) or (
+        (lhs.get_full_secs() == rhs.get_full_secs()) and
+        (boost::uint64_t(lhs.get_ticks())*boost::uint64_t(rhs.get_tick_rate()) <
+         boost::uint64_t(rhs.get_ticks())*boost::uint64_t(lhs.get_tick_rate()))
+    ));
+}
@@ -29,6 +29,7 @@
 #include <boost/thread/thread.hpp>
 #include <boost/bind.hpp>
 #include <uhd/exception.hpp>
+#include <cstring>
 
 using namespace uhd::transport;
 using namespace uhd;
@@ -37,12 +38,19 @@ bool b100_ctrl_debug = false;
 
 class b100_ctrl_impl : public b100_ctrl {
 public:
-    b100_ctrl_impl(uhd::transport::zero_copy_if::sptr ctrl_transport):
+    b100_ctrl_impl(
+        uhd::transport::zero_copy_if::sptr ctrl_transport,
+        const std::vector<size_t> &cpus,
+        const thread_sched_t &sched
+    ):
         sync_ctrl_fifo(2),
         _ctrl_transport(ctrl_transport),
-        _seq(0)
+        _seq(0),
+        _batch_depth(0),
+        _batch_len(0)
     {
-        viking_marauder = task::make(boost::bind(&b100_ctrl_impl::viking_marauder_loop, this));
+        viking_marauder = task::make(boost::bind(&b100_ctrl_impl::viking_marauder_loop, this), cpus, sched);
+        viking_marauder->set_name("b100 ctrl");
     }
 
     ~b100_ctrl_impl(void){
@@ -86,6 +94,17 @@ public:
         return boost::uint16_t(words[0]);
     }
 
+    void begin_batch(void){
+        boost::mutex::scoped_lock lock(_ctrl_mutex);
+        _batch_depth++;
+    }
+
+    void end_batch(void){
+        boost::mutex::scoped_lock lock(_ctrl_mutex);
+        UHD_ASSERT_THROW(_batch_depth > 0);
+        if (--_batch_depth == 0) this->flush_batch();
+    }
+
     void set_async_cb(const async_cb_type &async_cb){
         boost::mutex::scoped_lock lock(_async_mutex);
         _async_cb = async_cb;
@@ -93,6 +112,7 @@ public:
 
 private:
     int send_pkt(boost::uint16_t *cmd);
+    void flush_batch(void);
 
     //änd hërë wë gö ä-Vïkïng för äsynchronous control packets
     void viking_marauder_loop(void);
@@ -103,6 +123,11 @@ private:
     uhd::transport::zero_copy_if::sptr _ctrl_transport;
     boost::uint8_t _seq;
     boost::mutex _ctrl_mutex, _async_mutex;
+
+    //batched writes: packets packed into one send buffer
+    size_t _batch_depth;
+    managed_send_buffer::sptr _batch_buff;
+    size_t _batch_len;
 };
 
 /***********************************************************************
@@ -143,6 +168,22 @@ void unpack_ctrl_pkt(const boost::uint16_t *pkt_buff,
 }
 
 int b100_ctrl_impl::send_pkt(boost::uint16_t *cmd) {
+    //pack the packet into the batch buffer, send it when its full
+    if (_batch_depth != 0){
+        if (_batch_buff.get() != NULL and _batch_len + CTRL_PACKET_LENGTH > _batch_buff->size()){
+            this->flush_batch();
+        }
+        if (_batch_buff.get() == NULL){
+            _batch_buff = _ctrl_transport->get_send_buff();
+            if(!_batch_buff.get()) {
+                throw uhd::runtime_error("Control channel send error");
+            }
+        }
+        std::memcpy(_batch_buff->cast<char *>() + _batch_len, cmd, CTRL_PACKET_LENGTH);
+        _batch_len += CTRL_PACKET_LENGTH;
+        return 0;
+    }
+
     managed_send_buffer::sptr sbuf = _ctrl_transport->get_send_buff();
     if(!sbuf.get()) {
         throw uhd::runtime_error("Control channel send error");
@@ -156,6 +197,13 @@ int b100_ctrl_impl::send_pkt(boost::uint16_t *cmd) {
     return 0;
 }
 
+void b100_ctrl_impl::flush_batch(void){
+    if (_batch_buff.get() == NULL) return;
+    _batch_buff->commit(_batch_len); //the fpga takes the packets in order
+    _batch_buff.reset();
+    _batch_len = 0;
+}
+
 int b100_ctrl_impl::write(boost::uint32_t addr, const ctrl_data_t &data) {
     UHD_ASSERT_THROW(data.size() <= (CTRL_PACKET_DATA_LENGTH / sizeof(boost::uint16_t)));
     ctrl_pkt_t pkt;
@@ -188,8 +236,11 @@ ctrl_data_t b100_ctrl_impl::read(boost::uint32_t addr, size_t len) {
         UHD_MSG(error) << "B100: control read found unexpected packet." << std::endl;
     }
 
+    //in a batch, the read goes out in one transfer after the pending writes
     pack_ctrl_pkt(pkt_buff, pkt);
     send_pkt(pkt_buff);
+    this->flush_batch();
+    UHD_ASSERT_THROW(_batch_buff.get() == NULL); //the read must not wait in the batch
 
     //block with timeout waiting for the response to appear
     if (not get_ctrl_data(pkt.data, 0.1)) throw uhd::runtime_error(
@@ -207,8 +258,6 @@ ctrl_data_t b100_ctrl_impl::read(boost::uint32_t addr, size_t len) {
  * wait for a control operation to finish before starting another one.
  **********************************************************************/
 void b100_ctrl_impl::viking_marauder_loop(void){
-    set_thread_priority_safe();
-
     while (not boost::this_thread::interruption_requested()){
         managed_recv_buffer::sptr rbuf = _ctrl_transport->get_recv_buff(1.0);
         if(rbuf.get() == NULL) continue; //that's ok, there are plenty of villages to pillage!
@@ -252,6 +301,10 @@ bool b100_ctrl_impl::get_ctrl_data(ctrl_data_t &pkt_data, double timeout){
 /***********************************************************************
  * Public make function for b100_ctrl interface
  **********************************************************************/
-b100_ctrl::sptr b100_ctrl::make(uhd::transport::zero_copy_if::sptr ctrl_transport){
-    return sptr(new b100_ctrl_impl(ctrl_transport));
+b100_ctrl::sptr b100_ctrl::make(
+    uhd::transport::zero_copy_if::sptr ctrl_transport,
+    const std::vector<size_t> &cpus,
+    const thread_sched_t &sched
+){
+    return sptr(new b100_ctrl_impl(ctrl_transport, cpus, sched));
 }
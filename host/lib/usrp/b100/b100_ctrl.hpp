@@ -21,10 +21,13 @@
 #include "wb_iface.hpp"
 #include <uhd/transport/usb_zero_copy.hpp>
 #include <uhd/types/serial.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
 #include "ctrl_packet.hpp"
 #include <boost/function.hpp>
+#include <vector>
 
 class b100_ctrl : boost::noncopyable, public wb_iface{
 public:
@@ -34,9 +37,15 @@ public:
     /*!
      * Make a USRP control object from a data transport
      * \param ctrl_transport a USB data transport
+     * \param cpus the CPUs for the response thread, empty for any
+     * \param sched the scheduling for the response thread
      * \return a new b100 control object
      */
-    static sptr make(uhd::transport::zero_copy_if::sptr ctrl_transport);
+    static sptr make(
+        uhd::transport::zero_copy_if::sptr ctrl_transport,
+        const std::vector<size_t> &cpus = std::vector<size_t>(),
+        const uhd::thread_sched_t &sched = uhd::thread_sched_t(uhd::thread_sched_t::POLICY_RR)
+    );
 
     //! set an async callback for messages
     virtual void set_async_cb(const async_cb_type &async_cb) = 0;
@@ -57,6 +66,32 @@ public:
      */
     virtual ctrl_data_t read(boost::uint32_t addr, size_t len) = 0;
 
+    /*!
+     * Begin a batch of writes.
+     * Until the matching end_batch(), writes from any thread are packed
+     * back to back into USB transfers instead of one transfer per write.
+     * A read sends them along with the read packet in one transfer,
+     * a full transfer or the outermost end_batch() also sends them.
+     * Batches may nest.
+     */
+    virtual void begin_batch(void) = 0;
+
+    //! End a batch of writes and send the pending writes
+    virtual void end_batch(void) = 0;
+
+    //! Batch the writes for the lifetime of this object
+    class scoped_batch : boost::noncopyable{
+    public:
+        scoped_batch(sptr ctrl): _ctrl(ctrl){
+            _ctrl->begin_batch();
+        }
+        ~scoped_batch(void){
+            UHD_SAFE_CALL(_ctrl->end_batch();)
+        }
+    private:
+        sptr _ctrl;
+    };
+
     /*!
      * Get a sync ctrl packet (blocking)
      * \param the packet data buffer
@@ -21,12 +21,14 @@
 #include "usrp_i2c_addr.h"
 #include "usrp_commands.h"
 #include <uhd/transport/usb_control.hpp>
+#include <uhd/transport/usb_gateway.hpp>
 #include "ctrl_packet.hpp"
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/utils/static.hpp>
 #include <uhd/utils/images.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <boost/format.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/filesystem.hpp>
@@ -42,10 +44,47 @@ const boost::uint16_t B100_VENDOR_ID  = 0x2500;
 const boost::uint16_t B100_PRODUCT_ID = 0x0001;
 const boost::uint16_t FX2_VENDOR_ID    = 0x04b4;
 const boost::uint16_t FX2_PRODUCT_ID   = 0x8613;
+static const std::string B100_GATEWAY_PORT = "49200";
 
 /***********************************************************************
  * Discovery
  **********************************************************************/
+static device_addrs_t b100_find_gateway(const device_addr_t &hint)
+{
+    device_addrs_t b100_addrs;
+
+    //the gateway host loaded the firmware when it found the device
+    device_addr_t new_addr;
+    new_addr["type"] = "b100";
+    new_addr["gateway"] = hint["gateway"];
+    new_addr["gateway_port"] = hint.get("gateway_port", B100_GATEWAY_PORT);
+    try{
+        boost::uint16_t vid, pid;
+        new_addr["serial"] = usb_gateway::get_device_info(new_addr["gateway"], new_addr["gateway_port"], vid, pid);
+        if (vid != B100_VENDOR_ID or pid != B100_PRODUCT_ID) return b100_addrs;
+    }
+    catch(const uhd::exception &){
+        return b100_addrs; //no gateway there
+    }
+
+    try{
+        fx2_ctrl::sptr fx2_ctrl = fx2_ctrl::make(usb_gateway::make_control(new_addr["gateway"], new_addr["gateway_port"]));
+        const mboard_eeprom_t mb_eeprom = mboard_eeprom_t(*fx2_ctrl, mboard_eeprom_t::MAP_B000);
+        new_addr["name"] = mb_eeprom["name"];
+    }
+    catch(const uhd::exception &){
+        new_addr["name"] = "";
+    }
+
+    if (
+        (not hint.has_key("name")   or hint["name"]   == new_addr["name"]) and
+        (not hint.has_key("serial") or hint["serial"] == new_addr["serial"])
+    ){
+        b100_addrs.push_back(new_addr);
+    }
+    return b100_addrs;
+}
+
 static device_addrs_t b100_find(const device_addr_t &hint)
 {
     device_addrs_t b100_addrs;
@@ -53,6 +92,9 @@ static device_addrs_t b100_find(const device_addr_t &hint)
     //return an empty list of addresses when type is set to non-b100
     if (hint.has_key("type") and hint["type"] != "b100") return b100_addrs;
 
+    //a gateway host serves the device over the network
+    if (hint.has_key("gateway")) return b100_find_gateway(hint);
+
     //Return an empty list of addresses when an address is specified,
     //since an address is intended for a different, non-USB, device.
     if (hint.has_key("addr")) return b100_addrs;
@@ -144,46 +186,66 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
         device_addr.has_key("fpga")? device_addr["fpga"] : B100_FPGA_FILE_NAME
     );
 
-    //try to match the given device address with something on the USB bus
-    std::vector<usb_device_handle::sptr> device_list =
-        usb_device_handle::get_device_list(B100_VENDOR_ID, B100_PRODUCT_ID);
+    //the transports reach the device on the usb bus or through a gateway host
+    const bool use_gateway = device_addr.has_key("gateway");
+    const std::string gateway_port = device_addr.get("gateway_port", B100_GATEWAY_PORT);
 
-    //locate the matching handle in the device list
+    //try to match the given device address with something on the USB bus
     usb_device_handle::sptr handle;
-    BOOST_FOREACH(usb_device_handle::sptr dev_handle, device_list) {
-        if (dev_handle->get_serial() == device_addr["serial"]){
-            handle = dev_handle;
-            break;
+    if (not use_gateway){
+        std::vector<usb_device_handle::sptr> device_list =
+            usb_device_handle::get_device_list(B100_VENDOR_ID, B100_PRODUCT_ID);
+
+        //locate the matching handle in the device list
+        BOOST_FOREACH(usb_device_handle::sptr dev_handle, device_list) {
+            if (dev_handle->get_serial() == device_addr["serial"]){
+                handle = dev_handle;
+                break;
+            }
         }
+        UHD_ASSERT_THROW(handle.get() != NULL); //better be found
     }
-    UHD_ASSERT_THROW(handle.get() != NULL); //better be found
 
     //create control objects
-    usb_control::sptr fx2_transport = usb_control::make(handle, 0);
+    usb_control::sptr fx2_transport = use_gateway?
+        usb_gateway::make_control(device_addr["gateway"], gateway_port) :
+        usb_control::make(handle, 0);
     _fx2_ctrl = fx2_ctrl::make(fx2_transport);
     this->check_fw_compat(); //check after making fx2
     //-- setup clock after making fx2 and before loading fpga --//
+    //-- the vco calibrates while the fpga loads, wait on lock after --//
     _clock_ctrl = b100_clock_ctrl::make(_fx2_ctrl, device_addr.cast<double>("master_clock_rate", B100_DEFAULT_TICK_RATE));
     _fx2_ctrl->usrp_load_fpga(b100_fpga_image);
+    _clock_ctrl->wait_for_lock();
 
     //create the control transport
     device_addr_t ctrl_xport_args;
     ctrl_xport_args["recv_frame_size"] = boost::lexical_cast<std::string>(CTRL_PACKET_LENGTH);
     ctrl_xport_args["num_recv_frames"] = "16";
-    ctrl_xport_args["send_frame_size"] = boost::lexical_cast<std::string>(CTRL_PACKET_LENGTH);
+    ctrl_xport_args["send_frame_size"] = boost::lexical_cast<std::string>(CTRL_PACKET_LENGTH*CTRL_PACKETS_PER_TRANSFER);
     ctrl_xport_args["num_send_frames"] = "4";
 
-    _ctrl_transport = usb_zero_copy::make(
-        handle,
-        4, 8, //interface, endpoint
-        3, 4, //interface, endpoint
-        ctrl_xport_args
-    );
+    _ctrl_transport = use_gateway?
+        usb_gateway::make_zero_copy(
+            device_addr["gateway"], gateway_port,
+            4, 8, //interface, endpoint
+            3, 4, //interface, endpoint
+            ctrl_xport_args
+        ) :
+        usb_zero_copy::make(
+            handle,
+            4, 8, //interface, endpoint
+            3, 4, //interface, endpoint
+            ctrl_xport_args
+        );
 
     ////////////////////////////////////////////////////////////////////
     // Create controller objects
     ////////////////////////////////////////////////////////////////////
-    _fpga_ctrl = b100_ctrl::make(_ctrl_transport);
+    _fpga_ctrl = b100_ctrl::make(_ctrl_transport,
+        cpus_from_string(device_addr.get("pirate_cpu", "")),
+        thread_sched_t::from_string(device_addr.get("ctrl_sched", "rr"))
+    );
     this->enable_gpif(true); //TODO best place to put this?
     this->check_fpga_compat(); //check after making control
 
@@ -212,8 +274,20 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     data_xport_args["num_recv_frames"] = device_addr.get("num_recv_frames", "16");
     data_xport_args["send_frame_size"] = device_addr.get("send_frame_size", "16384");
     data_xport_args["num_send_frames"] = device_addr.get("num_send_frames", "16");
-
-    _data_transport = usb_zero_copy::make_wrapper(
+    data_xport_args["event_thread"] = device_addr.get("event_thread", "0");
+    data_xport_args["pirate_cpu"] = device_addr.get("pirate_cpu", "");
+    data_xport_args["event_sched"] = device_addr.get("event_sched", "rr");
+    if (device_addr.has_key("xfer_latency")) data_xport_args["xfer_latency"] = device_addr["xfer_latency"];
+
+    //the gateway passes the transfers unchanged, the wrapper splits them here
+    if (device_addr.has_key("gateway_window")) data_xport_args["gateway_window"] = device_addr["gateway_window"];
+    _data_transport = usb_zero_copy::make_wrapper(use_gateway?
+        usb_gateway::make_zero_copy(
+            device_addr["gateway"], gateway_port,
+            2, 6,          // IN interface, endpoint
+            1, 2,          // OUT interface, endpoint
+            data_xport_args    // param hints
+        ) :
         usb_zero_copy::make(
             handle,        // identifier
             2, 6,          // IN interface, endpoint
@@ -273,8 +347,15 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     ////////////////////////////////////////////////////////////////////
     // create frontend control objects
     ////////////////////////////////////////////////////////////////////
-    _rx_fe = rx_frontend_core_200::make(_fpga_ctrl, B100_REG_SR_ADDR(B100_SR_RX_FRONT));
-    _tx_fe = tx_frontend_core_200::make(_fpga_ctrl, B100_REG_SR_ADDR(B100_SR_TX_FRONT));
+    //cache the settings registers of the frontend and dsp cores
+    _wb_cache = wb_cache_iface::make(_fpga_ctrl);
+    _wb_cache->add_range(B100_REG_SR_ADDR(B100_SR_RX_FRONT), 5);
+    _wb_cache->add_range(B100_REG_SR_ADDR(B100_SR_RX_DSP0), 4);
+    _wb_cache->add_range(B100_REG_SR_ADDR(B100_SR_RX_DSP1), 4);
+    _wb_cache->add_range(B100_REG_SR_ADDR(B100_SR_TX_FRONT), 5);
+    _wb_cache->add_range(B100_REG_SR_ADDR(B100_SR_TX_DSP), 3);
+    _rx_fe = rx_frontend_core_200::make(_wb_cache, B100_REG_SR_ADDR(B100_SR_RX_FRONT));
+    _tx_fe = tx_frontend_core_200::make(_wb_cache, B100_REG_SR_ADDR(B100_SR_TX_FRONT));
     //TODO lots of properties to expose here for frontends
     _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec")
         .subscribe(boost::bind(&b100_impl::update_rx_subdev_spec, this, _1));
@@ -285,10 +366,10 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     // create rx dsp control objects
     ////////////////////////////////////////////////////////////////////
     _rx_dsps.push_back(rx_dsp_core_200::make(
-        _fpga_ctrl, B100_REG_SR_ADDR(B100_SR_RX_DSP0), B100_REG_SR_ADDR(B100_SR_RX_CTRL0), B100_RX_SID_BASE + 0
+        _wb_cache, B100_REG_SR_ADDR(B100_SR_RX_DSP0), B100_REG_SR_ADDR(B100_SR_RX_CTRL0), B100_RX_SID_BASE + 0
     ));
     _rx_dsps.push_back(rx_dsp_core_200::make(
-        _fpga_ctrl, B100_REG_SR_ADDR(B100_SR_RX_DSP1), B100_REG_SR_ADDR(B100_SR_RX_CTRL1), B100_RX_SID_BASE + 1
+        _wb_cache, B100_REG_SR_ADDR(B100_SR_RX_DSP1), B100_REG_SR_ADDR(B100_SR_RX_CTRL1), B100_RX_SID_BASE + 1
     ));
     for (size_t dspno = 0; dspno < _rx_dsps.size(); dspno++){
         _rx_dsps[dspno]->set_link_rate(B100_LINK_RATE_BPS);
@@ -310,7 +391,7 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     // create tx dsp control objects
     ////////////////////////////////////////////////////////////////////
     _tx_dsp = tx_dsp_core_200::make(
-        _fpga_ctrl, B100_REG_SR_ADDR(B100_SR_TX_DSP), B100_REG_SR_ADDR(B100_SR_TX_CTRL), B100_TX_ASYNC_SID
+        _wb_cache, B100_REG_SR_ADDR(B100_SR_TX_DSP), B100_REG_SR_ADDR(B100_SR_TX_CTRL), B100_TX_ASYNC_SID
     );
     _tx_dsp->set_link_rate(B100_LINK_RATE_BPS);
     _tree->access<double>(mb_path / "tick_rate")
@@ -380,27 +461,20 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     _dboard_manager = dboard_manager::make(
         rx_db_eeprom.id,
         ((gdb_eeprom.id == dboard_id_t::none())? tx_db_eeprom : gdb_eeprom).id,
-        _dboard_iface
+        _dboard_iface,
+        _tree->subtree(mb_path / "dboards/A"),
+        device_addr.has_key("defer_dboard_init")
     );
-    BOOST_FOREACH(const std::string &name, _dboard_manager->get_rx_subdev_names()){
-        dboard_manager::populate_prop_tree_from_subdev(
-            _tree->subtree(mb_path / "dboards/A/rx_frontends" / name),
-            _dboard_manager->get_rx_subdev(name)
-        );
-    }
-    BOOST_FOREACH(const std::string &name, _dboard_manager->get_tx_subdev_names()){
-        dboard_manager::populate_prop_tree_from_subdev(
-            _tree->subtree(mb_path / "dboards/A/tx_frontends" / name),
-            _dboard_manager->get_tx_subdev(name)
-        );
-    }
 
     //initialize io handling
-    this->io_init();
+    this->io_init(device_addr);
 
     ////////////////////////////////////////////////////////////////////
     // do some post-init tasks
     ////////////////////////////////////////////////////////////////////
+    //batch the register writes from the settings below
+    b100_ctrl::scoped_batch batch(_fpga_ctrl);
+
     _tree->access<double>(mb_path / "tick_rate").update() //update and then subscribe the clock callback
         .subscribe(boost::bind(&b100_clock_ctrl::set_fpga_clock_rate, _clock_ctrl, _1));
 
@@ -416,9 +490,19 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     _tree->access<subdev_spec_t>(mb_path / "tx_subdev_spec").set(subdev_spec_t("A:"+_dboard_manager->get_tx_subdev_names()[0]));
     _tree->access<std::string>(mb_path / "clock_source/value").set("internal");
     _tree->access<std::string>(mb_path / "time_source/value").set("none");
+
+    //export the counters from a thread, with the telemetry device address keys
+    _telemetry = telemetry_exporter::make(device_addr, _tree);
+
+    //share the tree with the local tools, with the prop_socket device address key
+    if (device_addr.has_key("prop_socket")){
+        _prop_server = property_server::make(_tree, device_addr["prop_socket"]);
+    }
 }
 
 b100_impl::~b100_impl(void){
+    _prop_server.reset();
+    _telemetry.reset(); //stop reading the tree first
     //set an empty async callback now that we deconstruct
     _fpga_ctrl->set_async_cb(b100_ctrl::async_cb_type());
 }
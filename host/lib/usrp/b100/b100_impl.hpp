@@ -29,6 +29,9 @@
 #include "rx_dsp_core_200.hpp"
 #include "tx_dsp_core_200.hpp"
 #include "time64_core_200.hpp"
+#include "wb_cache_iface.hpp"
+#include "telemetry.hpp"
+#include <uhd/usrp/property_broker.hpp>
 #include <uhd/device.hpp>
 #include <uhd/property_tree.hpp>
 #include <uhd/utils/pimpl.hpp>
@@ -55,7 +58,7 @@ static const double          B100_DEFAULT_TICK_RATE = 64e6;
 uhd::usrp::dboard_iface::sptr make_b100_dboard_iface(
     wb_iface::sptr wb_iface,
     uhd::i2c_iface::sptr i2c_iface,
-    uhd::spi_iface::sptr spi_iface,
+    spi_core_100::sptr spi_iface,
     b100_clock_ctrl::sptr clock,
     b100_codec_ctrl::sptr codec
 );
@@ -77,9 +80,17 @@ public:
                 size_t, uhd::rx_metadata_t &,
                 const uhd::io_type_t &,
                 recv_mode_t, double);
+    size_t recv_full_buff(const recv_buffs_type &,
+                size_t, recv_metadata_array_type &,
+                const uhd::io_type_t &, double);
+    size_t recv_view(recv_view_t &, double);
+    size_t get_send_view(send_view_t &, double);
+    size_t commit_send_view(send_view_t &, size_t, double);
     size_t get_max_send_samps_per_packet(void) const;
     size_t get_max_recv_samps_per_packet(void) const;
     bool recv_async_msg(uhd::async_metadata_t &, double);
+    uhd::transport::poll_fds_t get_recv_poll_fds(void);
+    uhd::transport::poll_fds_t get_async_msg_poll_fds(void);
 
 private:
     uhd::property_tree::sptr _tree;
@@ -87,6 +98,7 @@ private:
     //controllers
     spi_core_100::sptr _fpga_spi_ctrl;
     i2c_core_100::sptr _fpga_i2c_ctrl;
+    wb_cache_iface::sptr _wb_cache;
     rx_frontend_core_200::sptr _rx_fe;
     tx_frontend_core_200::sptr _tx_fe;
     std::vector<rx_dsp_core_200::sptr> _rx_dsps;
@@ -98,7 +110,8 @@ private:
     uhd::usrp::fx2_ctrl::sptr _fx2_ctrl;
 
     //transports
-    uhd::transport::zero_copy_if::sptr _data_transport, _ctrl_transport;
+    uhd::transport::usb_zero_copy::sptr _data_transport;
+    uhd::transport::zero_copy_if::sptr _ctrl_transport;
 
     //dboard stuff
     uhd::usrp::dboard_manager::sptr _dboard_manager;
@@ -107,7 +120,7 @@ private:
     //handle io stuff
     uhd::otw_type_t _rx_otw_type, _tx_otw_type;
     UHD_PIMPL_DECL(io_impl) _io_impl;
-    void io_init(void);
+    void io_init(const uhd::device_addr_t &);
 
     //device properties interface
     uhd::property_tree::sptr get_tree(void) const{
@@ -122,6 +135,8 @@ private:
     void update_tick_rate(const double rate);
     void update_rx_samp_rate(const double rate);
     void update_tx_samp_rate(const double rate);
+    void update_tx_window(const double rate);
+    void set_tx_window_time(const double);
     void update_rx_subdev_spec(const uhd::usrp::subdev_spec_t &);
     void update_tx_subdev_spec(const uhd::usrp::subdev_spec_t &);
     void update_clock_source(const std::string &);
@@ -129,6 +144,10 @@ private:
     void enable_gpif(const bool);
     void clear_fpga_fifo(void);
     void handle_async_message(uhd::transport::managed_recv_buffer::sptr);
+
+    //last, so the exporter thread stops before the rest goes away
+    uhd::usrp::telemetry_exporter::sptr _telemetry;
+    uhd::usrp::property_server::sptr _prop_server;
 };
 
 #endif /* INCLUDED_b100_IMPL_HPP */
@@ -21,6 +21,7 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/utils/assert_has.hpp>
+#include <uhd/types/dict.hpp>
 #include <uhd/utils/safe_call.hpp>
 #include <boost/cstdint.hpp>
 #include "b100_regs.hpp" //spi slave constants
@@ -171,6 +172,7 @@ class b100_clock_ctrl_impl : public b100_clock_ctrl{
 public:
     b100_clock_ctrl_impl(i2c_iface::sptr iface, double master_clock_rate){
         _iface = iface;
+        _lock_pending = false;
         _chan_rate = 0.0;
         _out_rate = 0.0;
 
@@ -190,7 +192,7 @@ public:
 
         this->use_internal_ref();
 
-        this->set_fpga_clock_rate(master_clock_rate); //initialize to something
+        this->update_fpga_clock_rate(master_clock_rate); //lock waited on in wait_for_lock()
 
         this->enable_fpga_clock(true);
         this->enable_test_clock(ENABLE_THE_TEST_OUT);
@@ -213,7 +215,10 @@ public:
      *  - set clock rate w/ external VCXO
      **********************************************************************/
     void set_clock_settings_with_internal_vco(double rate){
-        const clock_settings_type cs = get_clock_settings(rate);
+        if (not _clock_settings_cache.has_key(rate)){
+            _clock_settings_cache[rate] = get_clock_settings(rate);
+        }
+        const clock_settings_type cs = _clock_settings_cache[rate];
 
         //set the rates to private variables so the implementation knows!
         _chan_rate = cs.get_chan_rate();
@@ -257,8 +262,10 @@ public:
             _ad9522_regs.divider1_bypass
         );
 
+        //the vco only needs calibrating when the pll setup changed
+        const bool pll_changed = this->regs_changed(0x010, 0x01E) or this->regs_changed(0x1E0, 0x1E1);
         this->send_all_regs();
-        calibrate_now();
+        if (pll_changed) this->start_vco_calibration();
     }
 
     void set_clock_settings_with_external_vcxo(double rate){
@@ -294,6 +301,11 @@ public:
     }
 
     void set_fpga_clock_rate(double rate){
+        this->update_fpga_clock_rate(rate);
+        this->wait_for_lock();
+    }
+
+    void update_fpga_clock_rate(double rate){
         if (_out_rate == rate) return;
         if (rate == 61.44e6) set_clock_settings_with_external_vcxo(rate);
         else                 set_clock_settings_with_internal_vco(rate);
@@ -428,12 +440,30 @@ public:
         this->latch_regs();
     }
 
+    void wait_for_lock(void){
+        if (not _lock_pending) return;
+        _lock_pending = false;
+        if (not this->poll_status_bit(_ad9522_regs.vco_calibration_finished)){
+            UHD_MSG(error) << "USRP-B100 clock control: VCO calibration timeout" << std::endl;
+        }
+        if (not this->poll_status_bit(_ad9522_regs.digital_lock_detect)){
+            UHD_MSG(error) << "USRP-B100 clock control: lock detection timeout" << std::endl;
+        }
+    }
+
 private:
     i2c_iface::sptr _iface;
     ad9522_regs_t _ad9522_regs;
     double _out_rate; //rate at the fpga and codec
     double _chan_rate; //rate before final dividers
     double _rx_clock_rate, _tx_clock_rate;
+    bool _lock_pending; //vco calibration started but not waited on
+
+    //register values last written to or read from the chip
+    uhd::dict<boost::uint16_t, boost::uint8_t> _reg_shadow;
+
+    //clock settings computed per requested rate
+    uhd::dict<double, clock_settings_type> _clock_settings_cache;
 
     void latch_regs(void){
         _ad9522_regs.io_update = 1;
@@ -443,6 +473,7 @@ private:
     void send_reg(boost::uint16_t addr){
         boost::uint32_t reg = _ad9522_regs.get_write_reg(addr);
         UHD_LOGV(often) << "clock control write reg: " << std::hex << reg << std::endl;
+        _reg_shadow[addr] = boost::uint8_t(reg & 0xff);
         byte_vector_t buf;
         buf.push_back(boost::uint8_t(reg >> 16));
         buf.push_back(boost::uint8_t(reg >> 8));
@@ -462,7 +493,13 @@ private:
         return boost::uint32_t(buf[0] & 0xFF);
     }
 
-    void calibrate_now(void){
+    void read_status_reg(void){
+        static const boost::uint16_t addr = 0x01F;
+        _ad9522_regs.set_reg(addr, this->read_reg(addr));
+        _reg_shadow[addr] = boost::uint8_t(_ad9522_regs.get_reg(addr));
+    }
+
+    void start_vco_calibration(void){
         //vco calibration routine:
         _ad9522_regs.vco_calibration_now = 0;
         this->send_reg(0x18);
@@ -470,24 +507,22 @@ private:
         _ad9522_regs.vco_calibration_now = 1;
         this->send_reg(0x18);
         this->latch_regs();
-        //wait for calibration done:
-        static const boost::uint8_t addr = 0x01F;
-        for (size_t ms10 = 0; ms10 < 100; ms10++){
-            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-            boost::uint32_t reg = read_reg(addr);
-            _ad9522_regs.set_reg(addr, reg);
-            if (_ad9522_regs.vco_calibration_finished) goto wait_for_ld;
-        }
-        UHD_MSG(error) << "USRP-B100 clock control: VCO calibration timeout" << std::endl;
-        wait_for_ld:
-        //wait for digital lock detect:
-        for (size_t ms10 = 0; ms10 < 100; ms10++){
-            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-            boost::uint32_t reg = read_reg(addr);
-            _ad9522_regs.set_reg(addr, reg);
-            if (_ad9522_regs.digital_lock_detect) return;
+        _lock_pending = true;
+    }
+
+    /*!
+     * Poll the readback register until a status bit is set.
+     * The bit is a field of the register cache, refreshed by each read.
+     * \return true if the bit was set before the deadline
+     */
+    bool poll_status_bit(const boost::uint8_t &bit){
+        const boost::system_time deadline = boost::get_system_time() + boost::posix_time::seconds(1);
+        while (true){
+            this->read_status_reg();
+            if (bit != 0) return true;
+            if (boost::get_system_time() > deadline) return false;
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
         }
-        UHD_MSG(error) << "USRP-B100 clock control: lock detection timeout" << std::endl;
     }
 
     void soft_sync(void){
@@ -499,6 +534,18 @@ private:
         this->latch_regs();
     }
 
+    bool reg_changed(boost::uint16_t addr){
+        return not _reg_shadow.has_key(addr) or
+            _reg_shadow[addr] != boost::uint8_t(_ad9522_regs.get_reg(addr));
+    }
+
+    bool regs_changed(boost::uint16_t first, boost::uint16_t last){
+        for (boost::uint16_t addr = first; addr <= last; addr++){
+            if (this->reg_changed(addr)) return true;
+        }
+        return false;
+    }
+
     void send_all_regs(void){
         //setup a list of register ranges to write
         typedef std::pair<boost::uint16_t, boost::uint16_t> range_t;
@@ -508,10 +555,10 @@ private:
             (range_t(0x1E0, 0x1E1)) (range_t(0x230, 0x230))
         ;
 
-        //write initial register values and latch/update
+        //write the registers that differ from the chip and latch/update
         BOOST_FOREACH(const range_t &range, ranges){
             for(boost::uint16_t addr = range.first; addr <= range.second; addr++){
-                this->send_reg(addr);
+                if (this->reg_changed(addr)) this->send_reg(addr);
             }
         }
         this->latch_regs();
@@ -125,6 +125,14 @@ public:
      */
     virtual void use_auto_ref(void) = 0;
 
+    /*!
+     * Wait for the VCO calibration and PLL lock started by make().
+     * The constructor does not block on lock, so the caller can
+     * do unrelated work (like loading the FPGA) in the meantime.
+     * Call this before anything that needs a stable clock.
+     */
+    virtual void wait_for_lock(void) = 0;
+
 };
 
 #endif /* INCLUDED_B100_CLOCK_CTRL_HPP */
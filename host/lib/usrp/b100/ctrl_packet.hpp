@@ -40,6 +40,11 @@ const size_t CTRL_PACKET_LENGTH = 32;
 const size_t CTRL_PACKET_HEADER_LENGTH = 8;
 const size_t CTRL_PACKET_DATA_LENGTH = 24; //=length-header
 
+/*!
+ * Max number of control packets in one USB transfer (512 byte endpoint)
+ */
+const size_t CTRL_PACKETS_PER_TRANSFER = 16;
+
 /*!
  * Control packet header magic value
  */
@@ -17,17 +17,22 @@
 
 #include "recv_packet_demuxer.hpp"
 #include "validate_subdev_spec.hpp"
+#include "late_send_policy.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
+#include "../../transport/async_msg_ring.hpp"
 #include "usrp_commands.h"
 #include "b100_impl.hpp"
 #include "b100_regs.hpp"
 #include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/algorithm.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
 #include <boost/bind.hpp>
 #include <boost/format.hpp>
+#include <boost/foreach.hpp>
 #include <boost/bind.hpp>
 #include <boost/thread.hpp>
+#include <cmath>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 
@@ -39,31 +44,56 @@ using namespace uhd::transport;
  * IO Implementation Details
  **********************************************************************/
 struct b100_impl::io_impl{
-    io_impl(void):
-        async_msg_fifo(100/*messages deep*/)
+    io_impl(const size_t async_msg_depth):
+        async_msg_fifo(async_msg_depth)
     { /* NOP */ }
 
     zero_copy_if::sptr data_transport;
-    bounded_buffer<async_metadata_t> async_msg_fifo;
+    async_msg_ring async_msg_fifo;
     recv_packet_demuxer::sptr demuxer;
+    std::vector<stream_event_counters::sptr> rx_counters;
+    stream_event_counters::sptr tx_counters;
     sph::recv_packet_handler recv_handler;
     sph::send_packet_handler send_handler;
 };
 
+/***********************************************************************
+ * Helper Functions
+ **********************************************************************/
+static uhd::otw_type_t make_otw_type(const std::string &format){
+    uhd::otw_type_t otw_type;
+    otw_type.byteorder = uhd::otw_type_t::BO_LITTLE_ENDIAN;
+    if (format == "sc16"){
+        otw_type.width = 16;
+        otw_type.shift = 0;
+    }
+    else if (format == "sc12"){ //packed, four samples per three 32-bit lines
+        otw_type.width = 12;
+        otw_type.shift = 4;
+    }
+    else throw uhd::value_error("b100: unknown otw format " + format);
+    return otw_type;
+}
+
+//! packed sc12 fills whole 32-bit lines in groups of 4 samples
+static size_t round_to_otw_group(const size_t nsamps, const uhd::otw_type_t &otw_type){
+    return (otw_type.width == 12)? nsamps & ~size_t(3) : nsamps;
+}
+
 /***********************************************************************
  * Initialize internals within this file
  **********************************************************************/
-void b100_impl::io_init(void){
+void b100_impl::io_init(const device_addr_t &device_addr){
 
-    //setup rx otw type
-    _rx_otw_type.width = 16;
-    _rx_otw_type.shift = 0;
-    _rx_otw_type.byteorder = uhd::otw_type_t::BO_LITTLE_ENDIAN;
+    //setup the otw types (sc12 cuts the bytes per sample on the wire by a quarter)
+    _rx_otw_type = make_otw_type(device_addr.get("recv_otw_format", "sc16"));
+    _tx_otw_type = make_otw_type(device_addr.get("send_otw_format", "sc16"));
 
-    //setup tx otw type
-    _tx_otw_type.width = 16;
-    _tx_otw_type.shift = 0;
-    _tx_otw_type.byteorder = uhd::otw_type_t::BO_LITTLE_ENDIAN;
+    //the dsp cores must pack and unpack the same format
+    BOOST_FOREACH(rx_dsp_core_200::sptr rx_dsp, _rx_dsps){
+        rx_dsp->set_otw_type(_rx_otw_type);
+    }
+    _tx_dsp->set_otw_type(_tx_otw_type);
 
     //clear state machines
     _fpga_ctrl->poke32(B100_REG_CLEAR_RX, 0);
@@ -72,19 +102,60 @@ void b100_impl::io_init(void){
     //set the expected packet size in USB frames
     _fpga_ctrl->poke32(B100_REG_MISC_RX_LEN, 4);
 
-    //create new io impl
-    _io_impl = UHD_PIMPL_MAKE(io_impl, ());
-    _io_impl->demuxer = recv_packet_demuxer::make(_data_transport, _rx_dsps.size(), B100_RX_SID_BASE);
+    //create new io impl, the async messages overwrite the oldest past the depth
+    _io_impl = UHD_PIMPL_MAKE(io_impl, (device_addr.cast<size_t>("async_msg_depth", 100)));
+    async_msg_ring::publish(_tree, "/mboards/0", _io_impl->async_msg_fifo);
+    const std::string demux_policy = device_addr.get("demux_policy", "block");
+    if (demux_policy != "block" and demux_policy != "drop") throw uhd::value_error(
+        "unknown demux_policy " + demux_policy + ", expected block or drop"
+    );
+    _io_impl->demuxer = recv_packet_demuxer::make(
+        _data_transport, _rx_dsps.size(), B100_RX_SID_BASE, device_addr.cast<int>("demux_thread", 0) != 0,
+        (demux_policy == "drop")? recv_packet_demuxer::FULL_POLICY_DROP : recv_packet_demuxer::FULL_POLICY_BLOCK,
+        cpus_from_string(device_addr.get("pirate_cpu", "")),
+        thread_sched_t::from_string(device_addr.get("demux_sched", ""))
+    );
+
+    //publish the frame counters of the demuxer queues
+    for (size_t dspno = 0; dspno < _rx_dsps.size(); dspno++){
+        const fs_path demux_path = str(boost::format("/mboards/0/rx_dsps/%u/demux") % dspno);
+        _tree->create<size_t>(demux_path / "queued")
+            .publish(boost::bind(&recv_packet_demuxer::get_num_queued, _io_impl->demuxer, dspno));
+        _tree->create<size_t>(demux_path / "dropped")
+            .publish(boost::bind(&recv_packet_demuxer::get_num_dropped, _io_impl->demuxer, dspno));
+    }
+
+    //create and publish the streaming event counters
+    const bool fastpath_chars = device_addr.cast<bool>("fastpath_chars", true);
+    for (size_t dspno = 0; dspno < _rx_dsps.size(); dspno++){
+        _io_impl->rx_counters.push_back(stream_event_counters::make(fastpath_chars));
+        stream_event_counters::publish(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _io_impl->rx_counters.back());
+    }
+    _io_impl->tx_counters = stream_event_counters::make(fastpath_chars);
+    stream_event_counters::publish(_tree, "/mboards/0/tx_dsps/0", _io_impl->tx_counters);
+
+    //the host resamplers, one setting per handler shared by the dsps
+    for (size_t dspno = 0; dspno < _rx_dsps.size(); dspno++){
+        publish_resampler(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _io_impl->recv_handler);
+    }
+    publish_resampler(_tree, "/mboards/0/tx_dsps/0", _io_impl->send_handler);
+
+    //the send window may be held in time, recomputed from the rate
+    _tree->create<double>("/mboards/0/tx_dsps/0/fc_window_time")
+        .subscribe(boost::bind(&b100_impl::set_tx_window_time, this, _1))
+        .set(device_addr.cast<double>("send_window_time", 0.0));
 
     //now its safe to register the async callback
     _fpga_ctrl->set_async_cb(boost::bind(&b100_impl::handle_async_message, this, _1));
 
     //init some handler stuff
-    _io_impl->recv_handler.set_vrt_unpacker(&vrt::if_hdr_unpack_le);
+    _io_impl->recv_handler.set_vrt_unpacker(&vrt::if_hdr_unpack_le_sid_tsi_tsf_tlr);
     _io_impl->recv_handler.set_converter(_rx_otw_type);
     _io_impl->send_handler.set_vrt_packer(&vrt::if_hdr_pack_le);
     _io_impl->send_handler.set_converter(_tx_otw_type);
+    _io_impl->send_handler.set_scale_factor(32767./(1 << _tx_otw_type.shift));
     _io_impl->send_handler.set_max_samples_per_packet(get_max_send_samps_per_packet());
+    setup_late_send_policy(_io_impl->send_handler, _tree, "/mboards/0", device_addr);
 }
 
 void b100_impl::handle_async_message(managed_recv_buffer::sptr rbuf){
@@ -111,11 +182,13 @@ void b100_impl::handle_async_message(managed_recv_buffer::sptr rbuf){
         if (metadata.event_code &
             ( async_metadata_t::EVENT_CODE_UNDERFLOW
             | async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET)
-        ) UHD_MSG(fastpath) << "U";
+        ) _io_impl->tx_counters->record(stream_event_counters::EVENT_UNDERFLOW);
         else if (metadata.event_code &
             ( async_metadata_t::EVENT_CODE_SEQ_ERROR
             | async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST)
-        ) UHD_MSG(fastpath) << "S";
+        ) _io_impl->tx_counters->record(stream_event_counters::EVENT_SEQ_ERROR);
+        else if (metadata.event_code & async_metadata_t::EVENT_CODE_TIME_ERROR)
+            _io_impl->tx_counters->record(stream_event_counters::EVENT_LATE_COMMAND);
     }
     else UHD_MSG(error) << "Unknown async packet" << std::endl;
 }
@@ -131,12 +204,34 @@ void b100_impl::update_rx_samp_rate(const double rate){
     boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
     _io_impl->recv_handler.set_samp_rate(rate);
     const double adj = _rx_dsps.front()->get_scaling_adjustment();
-    _io_impl->recv_handler.set_scale_factor(adj/32767.);
+    _io_impl->recv_handler.set_scale_factor(adj*(1 << _rx_otw_type.shift)/32767.);
+    _data_transport->set_recv_rate(rate*_rx_otw_type.get_sample_size()*_io_impl->recv_handler.size());
 }
 
 void b100_impl::update_tx_samp_rate(const double rate){
     boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
     _io_impl->send_handler.set_samp_rate(rate);
+    this->update_tx_window(rate);
+}
+
+void b100_impl::update_tx_window(const double rate){
+    //call with the send handler locked, no other thread may use the send buffers
+    const double window_time = _tree->access<double>("/mboards/0/tx_dsps/0/fc_window_time").get();
+    size_t num_frames = _data_transport->get_num_send_frames();
+    if (window_time > 0.0){
+        const double bytes_per_sec = rate*_tx_otw_type.get_sample_size()*std::max<size_t>(_io_impl->send_handler.size(), 1);
+        num_frames = size_t(uhd::clip<double>(
+            std::ceil(window_time*bytes_per_sec/_data_transport->get_send_frame_size()), 1, num_frames
+        ));
+    }
+    _data_transport->set_send_window(num_frames);
+}
+
+void b100_impl::set_tx_window_time(const double){
+    const property<double> &rate = _tree->access<double>("/mboards/0/tx_dsps/0/rate/value");
+    if (rate.empty()) return; //updated again once the rate is set
+    boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
+    this->update_tx_window(rate.get());
 }
 
 void b100_impl::update_rx_subdev_spec(const uhd::usrp::subdev_spec_t &spec){
@@ -165,6 +260,7 @@ void b100_impl::update_rx_subdev_spec(const uhd::usrp::subdev_spec_t &spec){
             &recv_packet_demuxer::get_recv_buff, _io_impl->demuxer, i, _1
         ));
         _io_impl->recv_handler.set_overflow_handler(i, boost::bind(&rx_dsp_core_200::handle_overflow, _rx_dsps[i]));
+        _io_impl->recv_handler.set_event_counters(i, _io_impl->rx_counters[i]);
     }
 }
 
@@ -187,7 +283,12 @@ void b100_impl::update_tx_subdev_spec(const uhd::usrp::subdev_spec_t &spec){
         _io_impl->send_handler.set_xport_chan_get_buff(i, boost::bind(
             &zero_copy_if::get_send_buff, _data_transport, _1
         ));
+        _io_impl->send_handler.set_event_counters(i, _io_impl->tx_counters);
     }
+
+    //the window in time depends on the number of channels
+    const property<double> &rate = _tree->access<double>("/mboards/0/tx_dsps/0/rate/value");
+    if (not rate.empty()) this->update_tx_window(rate.get());
 }
 
 /***********************************************************************
@@ -200,6 +301,21 @@ bool b100_impl::recv_async_msg(
     return _io_impl->async_msg_fifo.pop_with_timed_wait(async_metadata, timeout);
 }
 
+poll_fds_t b100_impl::get_async_msg_poll_fds(void){
+    const poll_fds_t fds = _io_impl->async_msg_fifo.get_poll_fds();
+    if (fds.empty()) throw uhd::not_implemented_error("b100 async messages cannot be polled on this platform");
+    return fds;
+}
+
+/***********************************************************************
+ * Receive Readiness
+ **********************************************************************/
+poll_fds_t b100_impl::get_recv_poll_fds(void){
+    const poll_fds_t fds = _io_impl->demuxer->get_recv_poll_fds();
+    if (fds.empty()) throw uhd::not_implemented_error("b100 receive transport cannot be polled");
+    return fds;
+}
+
 /***********************************************************************
  * Send Data
  **********************************************************************/
@@ -209,7 +325,7 @@ size_t b100_impl::get_max_send_samps_per_packet(void) const {
         - sizeof(vrt::if_packet_info_t().cid) //no class id ever used
     ;
     static const size_t bpp = 2048 - hdr_size;
-    return bpp / _tx_otw_type.get_sample_size();
+    return round_to_otw_group(bpp / _tx_otw_type.get_sample_size(), _tx_otw_type);
 }
 
 size_t b100_impl::send(
@@ -224,6 +340,14 @@ size_t b100_impl::send(
     );
 }
 
+size_t b100_impl::get_send_view(send_view_t &view, double timeout){
+    return _io_impl->send_handler.get_send_view(view, timeout);
+}
+
+size_t b100_impl::commit_send_view(send_view_t &view, size_t nsamps, double){
+    return _io_impl->send_handler.commit_send_view(view, nsamps);
+}
+
 /***********************************************************************
  * Receive Data
  **********************************************************************/
@@ -234,7 +358,7 @@ size_t b100_impl::get_max_recv_samps_per_packet(void) const {
         - sizeof(vrt::if_packet_info_t().cid) //no class id ever used
     ;
     size_t bpp = 2048 - hdr_size; //limited by FPGA pkt buffer size
-    return bpp/_rx_otw_type.get_sample_size();
+    return round_to_otw_group(bpp/_rx_otw_type.get_sample_size(), _rx_otw_type);
 }
 
 size_t b100_impl::recv(
@@ -248,3 +372,18 @@ size_t b100_impl::recv(
         recv_mode, timeout
     );
 }
+
+size_t b100_impl::recv_full_buff(
+    const recv_buffs_type &buffs, size_t nsamps_per_buff,
+    recv_metadata_array_type &metadata_array,
+    const io_type_t &io_type, double timeout
+){
+    return _io_impl->recv_handler.recv_full_buff(
+        buffs, nsamps_per_buff,
+        metadata_array, io_type, timeout
+    );
+}
+
+size_t b100_impl::recv_view(recv_view_t &view, double timeout){
+    return _io_impl->recv_handler.recv_view(view, timeout);
+}
@@ -53,10 +53,13 @@ static size_t generate_hash(const char *filename)
 
     size_t hash = 0;
 
-    char ch;
-    while (file.get(ch)) {
-        boost::hash_combine(hash, ch);
-    }
+    //read in blocks, a get() per byte is slow on the embedded hosts
+    char buf[4096];
+    do {
+        file.read(buf, sizeof(buf));
+        const std::streamsize n = file.gcount();
+        for (std::streamsize i = 0; i < n; i++) boost::hash_combine(hash, buf[i]);
+    } while (file);
 
     if (not file.eof()){
         throw uhd::io_error(std::string("file error ") + filename);
@@ -0,0 +1,70 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "late_send_policy.hpp"
+#include <uhd/usrp/time_extrapolator.hpp>
+#include <uhd/exception.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+
+using namespace uhd;
+using namespace uhd::usrp;
+using namespace uhd::transport;
+
+static time_spec_t get_device_time(property_tree::sptr tree, const fs_path &path){
+    return tree->access<time_spec_t>(path).get();
+}
+
+//! The earliest time the device could be at now
+static time_spec_t get_earliest_time(time_extrapolator::sptr extrapolator){
+    double uncertainty = 0.0;
+    const time_spec_t now = extrapolator->get_time_now(uncertainty);
+    return now - time_spec_t(uncertainty);
+}
+
+void uhd::usrp::setup_late_send_policy(
+    sph::send_packet_handler &handler,
+    property_tree::sptr tree,
+    const fs_path &mb_path,
+    const device_addr_t &device_addr
+){
+    const std::string policy = device_addr.get("send_late_policy", "send");
+    const double margin = boost::lexical_cast<double>(device_addr.get("send_late_margin", "0"));
+    if (policy == "send"){
+        handler.set_late_policy(sph::send_packet_handler::LATE_POLICY_SEND, sph::send_packet_handler::time_now_type(), margin);
+        return;
+    }
+    if (policy != "flag" and policy != "drop") throw uhd::value_error(
+        "unknown send_late_policy " + policy + ", use send, flag, or drop"
+    );
+
+    //the time registers are only read about once a second
+    time_extrapolator::sptr extrapolator = time_extrapolator::make(
+        boost::bind(&get_device_time, tree, mb_path / "time/now")
+    );
+    const boost::function<void(void)> reset = boost::bind(&time_extrapolator::reset, extrapolator);
+    tree->access<time_spec_t>(mb_path / "time/now").subscribe(boost::bind(reset));
+    if (tree->exists(mb_path / "time/pps")){
+        tree->access<time_spec_t>(mb_path / "time/pps").subscribe(boost::bind(reset));
+    }
+    tree->access<double>(mb_path / "tick_rate").subscribe(boost::bind(reset));
+
+    handler.set_late_policy(
+        (policy == "drop")? sph::send_packet_handler::LATE_POLICY_DROP : sph::send_packet_handler::LATE_POLICY_FLAG,
+        boost::bind(&get_earliest_time, extrapolator), margin
+    );
+}
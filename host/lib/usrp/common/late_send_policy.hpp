@@ -0,0 +1,44 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_COMMON_LATE_SEND_POLICY_HPP
+#define INCLUDED_LIBUHD_USRP_COMMON_LATE_SEND_POLICY_HPP
+
+#include "../../transport/super_send_packet_handler.hpp"
+#include <uhd/config.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/types/device_addr.hpp>
+
+namespace uhd{ namespace usrp{
+
+    /*!
+     * Setup the host-side late policy of a send handler from device args:
+     * send_late_policy is send (the default), flag, or drop,
+     * and send_late_margin is the link latency in seconds (default 0).
+     * The device time comes from a time extrapolator on mb_path/time/now,
+     * which is reset by any set of the time or the tick rate.
+     */
+    void setup_late_send_policy(
+        transport::sph::send_packet_handler &handler,
+        property_tree::sptr tree,
+        const fs_path &mb_path,
+        const device_addr_t &device_addr
+    );
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_LIBUHD_USRP_COMMON_LATE_SEND_POLICY_HPP */
@@ -0,0 +1,99 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "memory_budget.hpp"
+#include <uhd/types/dict.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/log.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+/***********************************************************************
+ * Memory budget:
+ *  - The components are sized in the order they ask,
+ *    so the device asks for what matters most first.
+ *  - A component that records the same name again adds to it.
+ **********************************************************************/
+class memory_budget_impl : public memory_budget{
+public:
+    memory_budget_impl(const size_t budget):
+        _budget(budget), _used(0), _mapped(0)
+    {
+        /* NOP */
+    }
+
+    size_t get_budget(void){
+        return _budget;
+    }
+
+    size_t fit(const size_t item_size, const size_t num_default, const size_t num_min){
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_budget == 0 or item_size == 0) return num_default;
+        const size_t left = (_used < _budget)? _budget - _used : 0;
+        return std::max(num_min, std::min(num_default, left/item_size));
+    }
+
+    void record(const std::string &name, const size_t num_bytes){
+        boost::mutex::scoped_lock lock(_mutex);
+        _items[name] = _items.get(name, 0) + num_bytes;
+        _used += num_bytes;
+    }
+
+    void record_mapped(const std::string &name, const size_t num_bytes){
+        boost::mutex::scoped_lock lock(_mutex);
+        _items[name] = _items.get(name, 0) + num_bytes;
+        _mapped += num_bytes;
+    }
+
+    size_t get_used(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        return _used;
+    }
+
+    void publish(property_tree::sptr tree, const fs_path &path){
+        boost::mutex::scoped_lock lock(_mutex);
+        tree->create<size_t>(path / "memory/budget").set(_budget);
+        tree->create<size_t>(path / "memory/used").set(_used);
+        tree->create<size_t>(path / "memory/mapped").set(_mapped);
+        BOOST_FOREACH(const std::string &name, _items.keys()){
+            tree->create<size_t>(path / "memory/items" / name).set(_items[name]);
+            UHD_LOG << boost::format("memory %s: %u bytes") % name % _items[name] << std::endl;
+        }
+        if (_budget != 0 and _used > _budget) UHD_MSG(warning) << boost::format(
+            "The buffers and queues use %u bytes, more than the memory budget of %u bytes.\n"
+            "The minimum sizes of the components do not fit in the budget."
+        ) % _used % _budget << std::endl;
+    }
+
+private:
+    boost::mutex _mutex;
+    const size_t _budget;
+    size_t _used, _mapped;
+    uhd::dict<std::string, size_t> _items;
+};
+
+/***********************************************************************
+ * Make a memory budget from the device address
+ **********************************************************************/
+memory_budget::sptr memory_budget::make(const device_addr_t &device_addr){
+    return sptr(new memory_budget_impl(size_t(device_addr.cast<double>("mem_budget", 0))));
+}
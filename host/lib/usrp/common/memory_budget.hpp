@@ -0,0 +1,83 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_COMMON_MEMORY_BUDGET_HPP
+#define INCLUDED_LIBUHD_USRP_COMMON_MEMORY_BUDGET_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+namespace uhd{ namespace usrp{
+
+    /*!
+     * A memory budget for the buffers and queues of a device.
+     * The components that can size themselves ask the budget how many
+     * items fit, and every component records the bytes it really uses.
+     * Memory that the kernel maps into the process, such as a driver
+     * ring, is recorded apart: it is reported but not paid from the budget.
+     */
+    class memory_budget{
+    public:
+        typedef boost::shared_ptr<memory_budget> sptr;
+
+        /*!
+         * Make a new memory budget from the device address key mem_budget,
+         * the number of bytes (ex: mem_budget=256e3). Without the key,
+         * the budget is unlimited and every component gets its default.
+         * \param device_addr the device address
+         */
+        static sptr make(const device_addr_t &device_addr);
+
+        //! Get the number of bytes in the budget, zero when unlimited
+        virtual size_t get_budget(void) = 0;
+
+        /*!
+         * Get the number of items that fit in what is left of the budget.
+         * Nothing is recorded: record what the component really allocates.
+         * \param item_size the bytes per item
+         * \param num_default the number of items without a budget
+         * \param num_min the fewest items the component can work with
+         * \return num_default when it fits, else the most that fit, at least num_min
+         */
+        virtual size_t fit(const size_t item_size, const size_t num_default, const size_t num_min) = 0;
+
+        //! Record the bytes used by a component, paid from the budget
+        virtual void record(const std::string &name, const size_t num_bytes) = 0;
+
+        //! Record the bytes that a component maps from the kernel
+        virtual void record_mapped(const std::string &name, const size_t num_bytes) = 0;
+
+        //! Get the bytes recorded so far, paid from the budget
+        virtual size_t get_used(void) = 0;
+
+        /*!
+         * Publish the footprint as read-only properties under path/memory:
+         * budget, used, mapped, and the bytes of each component under items.
+         * Warns when the recorded bytes are over the budget.
+         * Call once all of the components are recorded.
+         * \param tree the property tree
+         * \param path the mboard path, such as /mboards/0
+         */
+        virtual void publish(property_tree::sptr tree, const fs_path &path) = 0;
+    };
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_LIBUHD_USRP_COMMON_MEMORY_BUDGET_HPP */
@@ -0,0 +1,51 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "open_timer.hpp"
+#include <uhd/utils/log.hpp>
+#include <boost/format.hpp>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+void uhd::usrp::record_open_time(
+    property_tree::sptr tree,
+    const fs_path &path,
+    const std::string &phase,
+    const double seconds
+){
+    UHD_LOGV(rarely) << boost::format("Open time %s %s: %f ms") % std::string(path) % phase % (seconds*1e3) << std::endl;
+
+    //a phase that runs more than once accumulates
+    const fs_path time_path = path / "open_times" / phase;
+    if (tree->exists(time_path)){
+        property<double> &time = tree->access<double>(time_path);
+        time.set(time.get() + seconds);
+    }
+    else tree->create<double>(time_path).set(seconds);
+}
+
+open_timer::open_timer(property_tree::sptr tree, const fs_path &path):
+    _tree(tree), _path(path), _last_time(time_spec_t::get_system_time())
+{
+    /* NOP */
+}
+
+void open_timer::mark(const std::string &phase){
+    const time_spec_t now = time_spec_t::get_system_time();
+    record_open_time(_tree, _path, phase, (now - _last_time).get_real_secs());
+    _last_time = now;
+}
@@ -0,0 +1,58 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef INCLUDED_LIBUHD_USRP_COMMON_OPEN_TIMER_HPP
+#define INCLUDED_LIBUHD_USRP_COMMON_OPEN_TIMER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <string>
+
+namespace uhd{ namespace usrp{
+
+    /*!
+     * Record the duration of a device open phase:
+     * the seconds are added to the double at path/open_times/phase,
+     * and the phase is logged at the rarely verbosity.
+     */
+    void record_open_time(
+        property_tree::sptr tree,
+        const fs_path &path,
+        const std::string &phase,
+        const double seconds
+    );
+
+    /*!
+     * Times the consecutive phases of a device open.
+     * Each mark records the time since the previous mark.
+     */
+    class open_timer{
+    public:
+        open_timer(property_tree::sptr tree, const fs_path &path);
+
+        //! Record the time since the previous mark as the named phase
+        void mark(const std::string &phase);
+
+    private:
+        property_tree::sptr _tree;
+        const fs_path _path;
+        time_spec_t _last_time;
+    };
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_LIBUHD_USRP_COMMON_OPEN_TIMER_HPP */
@@ -16,11 +16,17 @@
 //
 
 #include "recv_packet_demuxer.hpp"
+#include "../../transport/pollable_event.hpp"
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
 #include <boost/thread/mutex.hpp>
-#include <queue>
-#include <deque>
+#include <boost/thread/thread.hpp>
+#include <boost/circular_buffer.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
 #include <vector>
 
 using namespace uhd;
@@ -32,16 +38,34 @@ static UHD_INLINE boost::uint32_t extract_sid(managed_recv_buffer::sptr &buff){
     return uhd::wtohx(buff->cast<const boost::uint32_t *>()[1]);
 }
 
+//! Frame counters for one channel, read from other threads
+struct channel_stats_type{
+    uhd::atomic_uint32_t num_queued, num_dropped;
+};
+
+/***********************************************************************
+ * Demuxer:
+ * The calling receiver pulls from the transport under a lock,
+ * and queues the packets for the other channels.
+ * A queue holds as many frames as the transport has,
+ * so with the block policy, a full queue starves the transport
+ * and the receivers time out until the channel is read again.
+ * The queued event is ready while any queue holds a frame.
+ **********************************************************************/
 class recv_packet_demuxer_impl : public uhd::usrp::recv_packet_demuxer{
 public:
     recv_packet_demuxer_impl(
         transport::zero_copy_if::sptr transport,
         const size_t size,
-        const boost::uint32_t sid_base
+        const boost::uint32_t sid_base,
+        const full_policy_type full_policy
     ):
-        _transport(transport), _sid_base(sid_base), _queues(size)
+        _transport(transport), _sid_base(sid_base),
+        _full_policy(full_policy), _stats(size), _num_pending(0)
     {
-        /* NOP */
+        for (size_t i = 0; i < size; i++){
+            _queues.push_back(boost::circular_buffer<managed_recv_buffer::sptr>(transport->get_num_recv_frames()));
+        }
     }
 
     managed_recv_buffer::sptr get_recv_buff(const size_t index, const double timeout){
@@ -49,9 +73,10 @@ public:
         managed_recv_buffer::sptr buff;
 
         //there is already an entry in the queue, so pop that
-        if (not _queues[index].wrapper.empty()){
-            std::swap(buff, _queues[index].wrapper.front());
-            _queues[index].wrapper.pop();
+        if (not _queues[index].empty()){
+            std::swap(buff, _queues[index].front());
+            _queues[index].pop_front();
+            if (--_num_pending == 0) _queued_event.clear();
             return buff;
         }
 
@@ -65,23 +90,168 @@ public:
             if (rx_index == index) return buff; //got expected message
 
             //otherwise queue and try again
-            if (rx_index < _queues.size()) _queues[rx_index].wrapper.push(buff);
+            if (rx_index < _queues.size()) this->queue(rx_index, buff);
             else UHD_MSG(error) << "Got a data packet with unknown SID " << extract_sid(buff) << std::endl;
         }
     }
 
+    size_t get_num_queued(const size_t index){
+        return _stats.at(index).num_queued.read();
+    }
+
+    size_t get_num_dropped(const size_t index){
+        return _stats.at(index).num_dropped.read();
+    }
+
+    poll_fds_t get_recv_poll_fds(void){
+        poll_fds_t fds = _transport->get_recv_poll_fds();
+        if (fds.empty()) return fds; //the transport cannot be polled
+        const poll_fds_t queued_fds = _queued_event.get_poll_fds();
+        fds.insert(fds.end(), queued_fds.begin(), queued_fds.end());
+        return fds;
+    }
+
 private:
+    void queue(const size_t index, managed_recv_buffer::sptr &buff){
+        //the queue can only fill up when it holds every transport frame,
+        //so even the block policy cannot wait here: drop the oldest frame
+        if (_queues[index].full()){
+            _queues[index].pop_front();
+            _num_pending--;
+            _stats[index].num_dropped.inc();
+            if (_full_policy == FULL_POLICY_BLOCK) UHD_MSG(error)
+                << "Dropped a data packet for SID " << extract_sid(buff) << std::endl;
+        }
+        _queues[index].push_back(buff);
+        _num_pending++;
+        _queued_event.notify();
+        _stats[index].num_queued.inc();
+    }
+
     transport::zero_copy_if::sptr _transport;
     const boost::uint32_t _sid_base;
+    const full_policy_type _full_policy;
     boost::mutex _mutex;
-    struct channel_guts_type{
-        channel_guts_type(void): wrapper(container){}
-        std::deque<managed_recv_buffer::sptr> container;
-        std::queue<managed_recv_buffer::sptr> wrapper;
-    };
-    std::vector<channel_guts_type> _queues;
+    std::vector<boost::circular_buffer<managed_recv_buffer::sptr> > _queues;
+    std::vector<channel_stats_type> _stats;
+    size_t _num_pending; //frames in all queues
+    pollable_event _queued_event;
+};
+
+/***********************************************************************
+ * Threaded demuxer:
+ * A dedicated thread is the only reader of the transport
+ * and the only producer into each channel's spsc ring,
+ * so the receivers pop their own rings without any global lock.
+ * Only the receiver pops a ring, so the drop policy drops the new frame.
+ * Each ring has an event that is ready while the ring may hold a frame.
+ **********************************************************************/
+class recv_packet_demuxer_threaded : public uhd::usrp::recv_packet_demuxer{
+public:
+    recv_packet_demuxer_threaded(
+        transport::zero_copy_if::sptr transport,
+        const size_t size,
+        const boost::uint32_t sid_base,
+        const full_policy_type full_policy,
+        const std::vector<size_t> &cpus,
+        const thread_sched_t &sched
+    ):
+        _transport(transport), _sid_base(sid_base),
+        _full_policy(full_policy), _stats(size)
+    {
+        //a ring cannot hold more frames than the transport has
+        for (size_t i = 0; i < size; i++){
+            _rings.push_back(boost::shared_ptr<ring_type>(new ring_type(transport->get_num_recv_frames())));
+            _ring_events.push_back(boost::shared_ptr<pollable_event>(new pollable_event()));
+        }
+        _demux_task = task::make(boost::bind(&recv_packet_demuxer_threaded::demux_loop, this), cpus, sched);
+        _demux_task->set_name("recv demuxer");
+    }
+
+    ~recv_packet_demuxer_threaded(void){
+        _demux_task.reset(); //stop the thread before the rings go away
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(const size_t index, const double timeout){
+        managed_recv_buffer::sptr buff;
+        if (_rings[index]->pop_with_timed_wait(buff, timeout)) return buff;
+
+        //clear the event, then recheck for a push that raced with the clear
+        _ring_events[index]->clear();
+        if (_rings[index]->pop_with_haste(buff)) _ring_events[index]->notify();
+        return buff;
+    }
+
+    size_t get_num_queued(const size_t index){
+        return _stats.at(index).num_queued.read();
+    }
+
+    size_t get_num_dropped(const size_t index){
+        return _stats.at(index).num_dropped.read();
+    }
+
+    poll_fds_t get_recv_poll_fds(void){
+        poll_fds_t fds;
+        for (size_t i = 0; i < _ring_events.size(); i++){
+            const poll_fds_t ring_fds = _ring_events[i]->get_poll_fds();
+            fds.insert(fds.end(), ring_fds.begin(), ring_fds.end());
+        }
+        return fds;
+    }
+
+private:
+    typedef spsc_bounded_buffer<managed_recv_buffer::sptr> ring_type;
+
+    void demux_loop(void){
+        managed_recv_buffer::sptr buff = _transport->get_recv_buff(0.1);
+        if (buff.get() == NULL) return; //timeout, poll for interruption
+
+        //check the stream id to know which channel
+        const size_t rx_index = extract_sid(buff) - _sid_base;
+        if (rx_index >= _rings.size()){
+            UHD_MSG(error) << "Got a data packet with unknown SID " << extract_sid(buff) << std::endl;
+            return;
+        }
+
+        //the receiver drops its reference while this thread drops the local one
+        buff->enable_shared_refs();
+
+        switch(_full_policy){
+        case FULL_POLICY_BLOCK:
+            while (not _rings[rx_index]->push_with_timed_wait(buff, 0.1)){
+                boost::this_thread::interruption_point();
+            }
+            break;
+
+        case FULL_POLICY_DROP:
+            if (not _rings[rx_index]->push_with_haste(buff)){
+                _stats[rx_index].num_dropped.inc();
+                return;
+            }
+            break;
+        }
+        _ring_events[rx_index]->notify();
+        _stats[rx_index].num_queued.inc();
+    }
+
+    transport::zero_copy_if::sptr _transport;
+    const boost::uint32_t _sid_base;
+    const full_policy_type _full_policy;
+    std::vector<boost::shared_ptr<ring_type> > _rings;
+    std::vector<boost::shared_ptr<pollable_event> > _ring_events;
+    std::vector<channel_stats_type> _stats;
+    task::sptr _demux_task;
 };
 
-recv_packet_demuxer::sptr recv_packet_demuxer::make(transport::zero_copy_if::sptr transport, const size_t size, const boost::uint32_t sid_base){
-    return sptr(new recv_packet_demuxer_impl(transport, size, sid_base));
+recv_packet_demuxer::sptr recv_packet_demuxer::make(
+    transport::zero_copy_if::sptr transport,
+    const size_t size,
+    const boost::uint32_t sid_base,
+    const bool threaded,
+    const full_policy_type full_policy,
+    const std::vector<size_t> &cpus,
+    const thread_sched_t &sched
+){
+    if (threaded) return sptr(new recv_packet_demuxer_threaded(transport, size, sid_base, full_policy, cpus, sched));
+    return sptr(new recv_packet_demuxer_impl(transport, size, sid_base, full_policy));
 }
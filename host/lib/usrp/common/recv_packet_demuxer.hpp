@@ -20,8 +20,10 @@
 
 #include <uhd/config.hpp>
 #include <uhd/transport/zero_copy.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/cstdint.hpp>
+#include <vector>
 
 namespace uhd{ namespace usrp{
 
@@ -29,11 +31,55 @@ namespace uhd{ namespace usrp{
     public:
         typedef boost::shared_ptr<recv_packet_demuxer> sptr;
 
-        //! Make a new demuxer from a transport and parameters
-        static sptr make(transport::zero_copy_if::sptr transport, const size_t size, const boost::uint32_t sid_base);
+        /*!
+         * What to do with a packet for a channel whose queue is full.
+         * Each queue holds as many frames as the transport has.
+         */
+        enum full_policy_type{
+            //! wait for the channel's receiver to make room
+            FULL_POLICY_BLOCK,
+            //! drop a frame of the channel (the oldest, or the new one when threaded)
+            FULL_POLICY_DROP
+        };
+
+        /*!
+         * Make a new demuxer from a transport and parameters.
+         * In the threaded mode, a dedicated thread pulls from the transport
+         * and routes each packet into a lock-free ring for its channel,
+         * so that receivers of different channels never wait on each other.
+         * \param transport the transport shared by the channels
+         * \param size the number of channels
+         * \param sid_base the stream id of channel zero
+         * \param threaded true to route packets on a dedicated thread
+         * \param full_policy the policy for a full channel queue
+         * \param cpus the CPUs for the dedicated thread, empty for any
+         * \param sched the scheduling for the dedicated thread
+         */
+        static sptr make(
+            transport::zero_copy_if::sptr transport,
+            const size_t size,
+            const boost::uint32_t sid_base,
+            const bool threaded = false,
+            const full_policy_type full_policy = FULL_POLICY_BLOCK,
+            const std::vector<size_t> &cpus = std::vector<size_t>(),
+            const thread_sched_t &sched = thread_sched_t()
+        );
+
+        //! Get the number of frames queued for the channel so far
+        virtual size_t get_num_queued(const size_t index) = 0;
+
+        //! Get the number of frames dropped for the channel so far
+        virtual size_t get_num_dropped(const size_t index) = 0;
 
         //! Get a buffer at the given index from the transport
         virtual transport::managed_recv_buffer::sptr get_recv_buff(const size_t index, const double timeout) = 0;
+
+        /*!
+         * Get the descriptors that signal receive readiness of any channel.
+         * They cover the transport and the frames queued for the channels.
+         * \return a set of poll descriptors, empty when not pollable
+         */
+        virtual transport::poll_fds_t get_recv_poll_fds(void) = 0;
     };
 
 }} //namespace uhd::usrp
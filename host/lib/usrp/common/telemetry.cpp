@@ -0,0 +1,231 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "telemetry.hpp"
+#include <uhd/transport/udp_simple.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/exception.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::usrp;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * Snapshot formatting
+ **********************************************************************/
+//! The directories of size_t counters and their Prometheus types
+static const char *get_counter_dir_type(const std::string &dir){
+    if (dir == "events")     return "counter";
+    if (dir == "async_msgs") return "counter";
+    if (dir == "xport")      return "counter";
+    if (dir == "ctrl")       return "counter";
+    if (dir == "memory")     return "gauge";
+    return NULL;
+}
+
+//! Replace the characters that a metric name cannot hold
+static std::string to_metric_name(const std::string &name){
+    std::string out = name;
+    BOOST_FOREACH(char &ch, out){
+        if (not std::isalnum((unsigned char)(ch)) and ch != '_') ch = '_';
+    }
+    return out;
+}
+
+//! Escape a label value
+static std::string to_label_value(const std::string &value){
+    std::string out;
+    BOOST_FOREACH(const char ch, value){
+        if (ch == '\\' or ch == '"') out += '\\';
+        if (ch == '\n') out += "\\n";
+        else out += ch;
+    }
+    return out;
+}
+
+//! The samples of each metric name, with the type of the metric first
+typedef std::map<std::string, std::pair<std::string, std::vector<std::string> > > metrics_type;
+
+static void add_sample(
+    metrics_type &metrics, const std::string &name, const std::string &type,
+    const std::string &labels, const std::string &value
+){
+    metrics[name].first = type;
+    metrics[name].second.push_back(name + "{" + labels + "} " + value);
+}
+
+static void add_counter_dir(
+    property_tree::sptr tree, metrics_type &metrics, const fs_path &path,
+    const std::string &name, const std::string &type, const std::string &labels
+){
+    BOOST_FOREACH(const std::string &leaf, tree->list(path)){
+        const fs_path leaf_path = path / leaf;
+        if (not tree->list(leaf_path).empty()){ //a sub directory, such as memory/items
+            BOOST_FOREACH(const std::string &item, tree->list(leaf_path)){
+                add_sample(metrics, name + "_" + to_metric_name(leaf), type,
+                    labels + ",item=\"" + to_label_value(item) + "\"",
+                    str(boost::format("%u") % tree->access<size_t>(leaf_path / item).get())
+                );
+            }
+            continue;
+        }
+        add_sample(metrics, name + "_" + to_metric_name(leaf), type, labels,
+            str(boost::format("%u") % tree->access<size_t>(leaf_path).get())
+        );
+    }
+}
+
+static void add_counter_dirs(property_tree::sptr tree, metrics_type &metrics, const fs_path &path){
+    BOOST_FOREACH(const std::string &name, tree->list(path)){
+        const fs_path dir_path = path / name;
+        const char *type = get_counter_dir_type(name);
+        if (type == NULL) add_counter_dirs(tree, metrics, dir_path);
+        else add_counter_dir(tree, metrics, dir_path, "uhd_" + name, type,
+            "path=\"" + to_label_value(path) + "\""
+        );
+    }
+}
+
+std::string telemetry_exporter::format(property_tree::sptr tree){
+    metrics_type metrics;
+    add_counter_dirs(tree, metrics, "/");
+
+    //the resource accounting of the task threads in this process
+    BOOST_FOREACH(const task_stats_t &stats, task::get_all_stats()){
+        const std::string labels = "task=\"" + to_label_value(stats.name) + "\"";
+        add_sample(metrics, "uhd_task_iterations", "counter", labels, str(boost::format("%u") % stats.iterations));
+        add_sample(metrics, "uhd_task_cpu_seconds", "counter", labels, str(boost::format("%f") % stats.cpu_time));
+        add_sample(metrics, "uhd_task_wait_seconds", "counter", labels, str(boost::format("%f") % stats.wait_time));
+        add_sample(metrics, "uhd_task_run_seconds", "counter", labels, str(boost::format("%f") % stats.run_time));
+    }
+
+    std::string out;
+    for (metrics_type::const_iterator it = metrics.begin(); it != metrics.end(); it++){
+        out += "# TYPE " + it->first + " " + it->second.first + "\n";
+        BOOST_FOREACH(const std::string &line, it->second.second) out += line + "\n";
+    }
+    return out;
+}
+
+/***********************************************************************
+ * Exporter thread:
+ *  - sleeps for the period, then takes a snapshot
+ *  - a failed export is logged, the next period tries again
+ **********************************************************************/
+telemetry_exporter::~telemetry_exporter(void){
+    /* NOP */
+}
+
+class telemetry_exporter_impl : public telemetry_exporter{
+public:
+    telemetry_exporter_impl(
+        property_tree::sptr tree, udp_simple::sptr udp,
+        const std::string &file, const double period
+    ):
+        _tree(tree), _udp(udp), _file(file), _period(period)
+    {
+        _task = task::make(boost::bind(&telemetry_exporter_impl::export_once, this));
+        _task->set_name("telemetry");
+    }
+
+    ~telemetry_exporter_impl(void){
+        _task.reset(); //stop the thread before the members go away
+    }
+
+private:
+    void export_once(void){
+        boost::this_thread::sleep(boost::posix_time::microseconds(long(_period*1e6)));
+        try{
+            const std::string snapshot = format(_tree);
+            if (_udp.get() != NULL){
+                _udp->send(boost::asio::buffer(snapshot.data(), std::min<size_t>(snapshot.size(), MAX_DATAGRAM_BYTES)));
+            }
+            if (not _file.empty()){
+                const std::string tmp_file = _file + ".tmp";
+                std::ofstream out(tmp_file.c_str());
+                out << snapshot;
+                out.close();
+                if (std::rename(tmp_file.c_str(), _file.c_str()) != 0) throw uhd::os_error(
+                    "telemetry: cannot replace " + _file
+                );
+            }
+        }
+        catch(const std::exception &e){
+            UHD_LOG << "telemetry export failed: " << e.what() << std::endl;
+        }
+    }
+
+    //! The largest UDP payload, a longer snapshot is truncated
+    static const size_t MAX_DATAGRAM_BYTES = 65507;
+
+    property_tree::sptr _tree;
+    udp_simple::sptr _udp;
+    const std::string _file;
+    const double _period;
+    task::sptr _task;
+};
+
+/***********************************************************************
+ * Make an exporter from the device address
+ **********************************************************************/
+telemetry_exporter::sptr telemetry_exporter::make(const device_addr_t &device_addr, property_tree::sptr tree){
+    if (not device_addr.has_key("telemetry") and not device_addr.has_key("telemetry_file")) return sptr();
+
+    udp_simple::sptr udp;
+    if (device_addr.has_key("telemetry")){
+        const std::string target = device_addr["telemetry"];
+        const size_t colon = target.rfind(':');
+        if (colon == std::string::npos) throw uhd::value_error(
+            "telemetry: expected addr:port, got " + target
+        );
+        udp = udp_simple::make_connected(target.substr(0, colon), target.substr(colon + 1));
+    }
+
+    const double period = device_addr.cast<double>("telemetry_period", 1.0);
+    if (period <= 0.0) throw uhd::value_error("telemetry: the period must be positive");
+    return sptr(new telemetry_exporter_impl(tree, udp, device_addr.get("telemetry_file", ""), period));
+}
+
+/***********************************************************************
+ * Transport stats properties
+ **********************************************************************/
+static size_t get_xport_count(zero_copy_if::sptr xport, boost::uint64_t zero_copy_stats_t::*count){
+    return size_t(xport->get_stats().*count);
+}
+
+void uhd::usrp::publish_xport_stats(
+    property_tree::sptr tree, const fs_path &path,
+    zero_copy_if::sptr xport, const bool recv
+){
+    tree->create<size_t>(path / "xport/frames").publish(boost::bind(&get_xport_count, xport,
+        recv? &zero_copy_stats_t::recv_frames : &zero_copy_stats_t::send_frames));
+    tree->create<size_t>(path / "xport/bytes").publish(boost::bind(&get_xport_count, xport,
+        recv? &zero_copy_stats_t::recv_bytes : &zero_copy_stats_t::send_bytes));
+    tree->create<size_t>(path / "xport/timeouts").publish(boost::bind(&get_xport_count, xport,
+        recv? &zero_copy_stats_t::recv_timeouts : &zero_copy_stats_t::send_timeouts));
+}
@@ -0,0 +1,81 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_COMMON_TELEMETRY_HPP
+#define INCLUDED_LIBUHD_USRP_COMMON_TELEMETRY_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+
+namespace uhd{ namespace usrp{
+
+    /*!
+     * Exports the counters of a device from a thread of its own.
+     * A snapshot reads the counter properties of the tree, which read
+     * the atomics of the fast path, and the stats of every task thread.
+     * The snapshot is in the Prometheus text format, one sample per line.
+     */
+    class telemetry_exporter : boost::noncopyable{
+    public:
+        typedef boost::shared_ptr<telemetry_exporter> sptr;
+
+        /*!
+         * Make a new exporter from the device address keys:
+         *  - telemetry: send each snapshot as a UDP datagram to addr:port
+         *  - telemetry_file: write each snapshot to a file, replaced whole
+         *  - telemetry_period: the seconds between snapshots (default 1.0)
+         * \param device_addr the device address
+         * \param tree the property tree of the device
+         * \return the exporter, or null when neither key is given
+         */
+        static sptr make(const device_addr_t &device_addr, property_tree::sptr tree);
+
+        /*!
+         * Format a snapshot of the counters under the tree.
+         * The size_t leaves of the directories events, async_msgs, memory,
+         * xport, and ctrl are samples named uhd_<dir>_<leaf>,
+         * labeled with the path of the directory.
+         * \param tree the property tree of the device
+         * \return the snapshot in the Prometheus text format
+         */
+        static std::string format(property_tree::sptr tree);
+
+        //! Stop the exporter thread
+        virtual ~telemetry_exporter(void) = 0;
+    };
+
+    /*!
+     * Publish the stats of a transport as read-only properties under path/xport:
+     * the frames, bytes, and timeouts of the receive or the send direction.
+     * \param tree the property tree
+     * \param path the dsp path, such as /mboards/0/rx_dsps/0
+     * \param xport the transport to read
+     * \param recv true for the receive stats, false for the send stats
+     */
+    void publish_xport_stats(
+        property_tree::sptr tree, const fs_path &path,
+        uhd::transport::zero_copy_if::sptr xport, const bool recv
+    );
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_LIBUHD_USRP_COMMON_TELEMETRY_HPP */
@@ -17,6 +17,13 @@
 
 #include "gpio_core_200.hpp"
 #include <uhd/types/dict.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/exception.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 
 #define REG_GPIO_IDLE          _base + 0
 #define REG_GPIO_RX_ONLY       _base + 4
@@ -30,8 +37,13 @@ using namespace usrp;
 
 class gpio_core_200_impl : public gpio_core_200{
 public:
-    gpio_core_200_impl(wb_iface::sptr iface, const size_t base):
-        _iface(iface), _base(base) { /* NOP */ }
+    gpio_core_200_impl(wb_iface::sptr iface, const size_t base, const poke_batch_type &poke_batch):
+        _iface(iface), _base(base), _poke_batch(poke_batch),
+        _update_depth(0), _read_period(0.0), _read_snapshot(0) { /* NOP */ }
+
+    ~gpio_core_200_impl(void){
+        _read_task.reset(); //stop the thread before the members go away
+    }
 
     void set_pin_ctrl(const unit_t unit, const boost::uint16_t value){
         _pin_ctrl[unit] = value; //shadow
@@ -45,10 +57,7 @@ public:
 
     void set_gpio_ddr(const unit_t unit, const boost::uint16_t value){
         _gpio_ddr[unit] = value; //shadow
-        _iface->poke32(REG_GPIO_DDR, //update the 32 bit register
-            (boost::uint32_t(_gpio_ddr[dboard_iface::UNIT_RX]) << unit2shit(dboard_iface::UNIT_RX)) |
-            (boost::uint32_t(_gpio_ddr[dboard_iface::UNIT_TX]) << unit2shit(dboard_iface::UNIT_TX))
-        );
+        this->update(); //full update
     }
 
     void set_gpio_out(const unit_t unit, const boost::uint16_t value){
@@ -57,44 +66,109 @@ public:
     }
 
     boost::uint16_t read_gpio(const unit_t unit){
-        return boost::uint16_t(_iface->peek32(REG_GPIO_READ) >> unit2shit(unit));
+        if (_read_task.get() == NULL){
+            return boost::uint16_t(_iface->peek32(REG_GPIO_READ) >> unit2shit(unit));
+        }
+        boost::mutex::scoped_lock lock(_read_mutex);
+        return boost::uint16_t(_read_snapshot >> unit2shit(unit));
+    }
+
+    void begin_update(void){
+        _update_depth++;
+    }
+
+    void commit_update(void){
+        if (_update_depth == 0) throw uhd::runtime_error("gpio_core_200: commit without begin");
+        _update_depth--;
+        this->update();
+    }
+
+    void set_read_period(const double period){
+        if (period < 0.0) throw uhd::value_error("gpio_core_200: the read period cannot be negative");
+        _read_task.reset();
+        _read_period = period;
+        if (period == 0.0) return;
+        _read_snapshot = _iface->peek32(REG_GPIO_READ); //valid before the first refresh
+        _read_task = task::make(boost::bind(&gpio_core_200_impl::refresh_once, this));
+        _read_task->set_name("gpio_read");
     }
 
 private:
     wb_iface::sptr _iface;
     const size_t _base;
+    const poke_batch_type _poke_batch;
 
     uhd::dict<unit_t, boost::uint16_t> _pin_ctrl, _gpio_out, _gpio_ddr;
     uhd::dict<unit_t, uhd::dict<atr_reg_t, boost::uint16_t> > _atr_regs;
+    uhd::dict<wb_iface::wb_addr_type, boost::uint32_t> _written; //the last value of each register
+    size_t _update_depth;
+
+    double _read_period;
+    boost::mutex _read_mutex;
+    boost::uint32_t _read_snapshot;
+    task::sptr _read_task;
 
     unsigned unit2shit(const unit_t unit){
         return (unit == dboard_iface::UNIT_RX)? 0 : 16;
     }
 
+    boost::uint32_t combine(uhd::dict<unit_t, boost::uint16_t> &values){
+        return
+            (boost::uint32_t(values[dboard_iface::UNIT_RX]) << unit2shit(dboard_iface::UNIT_RX)) |
+            (boost::uint32_t(values[dboard_iface::UNIT_TX]) << unit2shit(dboard_iface::UNIT_TX));
+    }
+
     void update(void){
-        this->update(dboard_iface::ATR_REG_IDLE, REG_GPIO_IDLE);
-        this->update(dboard_iface::ATR_REG_TX_ONLY, REG_GPIO_TX_ONLY);
-        this->update(dboard_iface::ATR_REG_RX_ONLY, REG_GPIO_RX_ONLY);
-        this->update(dboard_iface::ATR_REG_FULL_DUPLEX, REG_GPIO_BOTH);
+        if (_update_depth > 0) return; //held back until the commit
+
+        pokes_type pokes;
+        this->update(dboard_iface::ATR_REG_IDLE, REG_GPIO_IDLE, pokes);
+        this->update(dboard_iface::ATR_REG_TX_ONLY, REG_GPIO_TX_ONLY, pokes);
+        this->update(dboard_iface::ATR_REG_RX_ONLY, REG_GPIO_RX_ONLY, pokes);
+        this->update(dboard_iface::ATR_REG_FULL_DUPLEX, REG_GPIO_BOTH, pokes);
+        this->update(REG_GPIO_DDR, this->combine(_gpio_ddr), pokes); //after the values it drives
+        if (pokes.empty()) return;
+
+        if (pokes.size() > 1 and _poke_batch) _poke_batch(pokes);
+        else BOOST_FOREACH(const pokes_type::value_type &poke, pokes){
+            _iface->poke32(poke.first, poke.second);
+        }
+        BOOST_FOREACH(const pokes_type::value_type &poke, pokes){
+            _written[poke.first] = poke.second;
+        }
     }
 
-    void update(const atr_reg_t atr, const size_t addr){
-        const boost::uint32_t atr_val =
-            (boost::uint32_t(_atr_regs[dboard_iface::UNIT_RX][atr]) << unit2shit(dboard_iface::UNIT_RX)) |
-            (boost::uint32_t(_atr_regs[dboard_iface::UNIT_TX][atr]) << unit2shit(dboard_iface::UNIT_TX));
+    void update(const atr_reg_t atr, const wb_iface::wb_addr_type addr, pokes_type &pokes){
+        uhd::dict<unit_t, boost::uint16_t> atr_vals;
+        atr_vals[dboard_iface::UNIT_RX] = _atr_regs[dboard_iface::UNIT_RX][atr];
+        atr_vals[dboard_iface::UNIT_TX] = _atr_regs[dboard_iface::UNIT_TX][atr];
+        const boost::uint32_t atr_val = this->combine(atr_vals);
+        const boost::uint32_t gpio_val = this->combine(_gpio_out);
+        const boost::uint32_t ctrl = this->combine(_pin_ctrl);
+        this->update(addr, (ctrl & atr_val) | ((~ctrl) & gpio_val), pokes);
+    }
 
-        const boost::uint32_t gpio_val =
-            (boost::uint32_t(_gpio_out[dboard_iface::UNIT_RX]) << unit2shit(dboard_iface::UNIT_RX)) |
-            (boost::uint32_t(_gpio_out[dboard_iface::UNIT_TX]) << unit2shit(dboard_iface::UNIT_TX));
+    void update(const wb_iface::wb_addr_type addr, const boost::uint32_t value, pokes_type &pokes){
+        if (_written.has_key(addr) and _written[addr] == value) return; //unchanged
+        pokes.push_back(std::make_pair(addr, value));
+    }
 
-        const boost::uint32_t ctrl =
-            (boost::uint32_t(_pin_ctrl[dboard_iface::UNIT_RX]) << unit2shit(dboard_iface::UNIT_RX)) |
-            (boost::uint32_t(_pin_ctrl[dboard_iface::UNIT_TX]) << unit2shit(dboard_iface::UNIT_TX));
-        _iface->poke32(addr, (ctrl & atr_val) | ((~ctrl) & gpio_val));
+    void refresh_once(void){
+        boost::this_thread::sleep(boost::posix_time::microseconds(long(_read_period*1e6)));
+        try{
+            const boost::uint32_t value = _iface->peek32(REG_GPIO_READ);
+            boost::mutex::scoped_lock lock(_read_mutex);
+            _read_snapshot = value;
+        }
+        catch(const std::exception &e){
+            UHD_LOG << "gpio_core_200: read refresh failed: " << e.what() << std::endl;
+        }
     }
 
 };
 
-gpio_core_200::sptr gpio_core_200::make(wb_iface::sptr iface, const size_t base){
-    return sptr(new gpio_core_200_impl(iface, base));
+gpio_core_200::sptr gpio_core_200::make(
+    wb_iface::sptr iface, const size_t base, const poke_batch_type &poke_batch
+){
+    return sptr(new gpio_core_200_impl(iface, base, poke_batch));
 }
@@ -23,7 +23,10 @@
 #include <boost/cstdint.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
 #include "wb_iface.hpp"
+#include <utility>
+#include <vector>
 
 class gpio_core_200 : boost::noncopyable{
 public:
@@ -32,8 +35,40 @@ public:
     typedef uhd::usrp::dboard_iface::unit_t unit_t;
     typedef uhd::usrp::dboard_iface::atr_reg_t atr_reg_t;
 
-    //! makes a new GPIO core from iface and slave base
-    static sptr make(wb_iface::sptr iface, const size_t base);
+    //! a sequence of register writes as address and data pairs
+    typedef std::vector<std::pair<wb_iface::wb_addr_type, boost::uint32_t> > pokes_type;
+
+    //! a function that writes a sequence of registers in one transaction
+    typedef boost::function<void(const pokes_type &)> poke_batch_type;
+
+    /*!
+     * Make a new GPIO core from iface and slave base.
+     * Only the registers that change are written.
+     * \param iface the register interface
+     * \param base the slave base address
+     * \param poke_batch writes the registers of a commit (default: one poke each)
+     */
+    static sptr make(
+        wb_iface::sptr iface, const size_t base,
+        const poke_batch_type &poke_batch = poke_batch_type()
+    );
+
+    /*!
+     * Hold back the register writes until the matching commit:
+     * the set calls only update the shadows in the meantime.
+     * Calls may nest, the outermost commit writes.
+     */
+    virtual void begin_update(void) = 0;
+
+    //! Write the registers that changed since begin, all at once
+    virtual void commit_update(void) = 0;
+
+    /*!
+     * Read back from a snapshot of the GPIO inputs,
+     * refreshed by a thread of the core every period.
+     * \param period the seconds between refreshes (0 to read each call)
+     */
+    virtual void set_read_period(const double period) = 0;
 
     //! 1 = ATR
     virtual void set_pin_ctrl(const unit_t unit, const boost::uint16_t value) = 0;
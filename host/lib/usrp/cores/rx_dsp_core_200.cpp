@@ -29,10 +29,14 @@
 //skip one right here
 #define REG_DSP_RX_DECIM      _dsp_base + 8
 #define REG_DSP_RX_MUX        _dsp_base + 12
+#define REG_DSP_RX_FORMAT     _dsp_base + 16
 
 #define FLAG_DSP_RX_MUX_SWAP_IQ   (1 << 0)
 #define FLAG_DSP_RX_MUX_REAL_MODE (1 << 1)
 
+#define FLAG_DSP_RX_FORMAT_SC8    (1 << 0)
+#define FLAG_DSP_RX_FORMAT_SC12   (1 << 1)
+
 #define REG_RX_CTRL_STREAM_CMD     _ctrl_base + 0
 #define REG_RX_CTRL_TIME_SECS      _ctrl_base + 4
 #define REG_RX_CTRL_TIME_TICKS     _ctrl_base + 8
@@ -54,9 +58,11 @@ public:
     rx_dsp_core_200_impl(
         wb_iface::sptr iface,
         const size_t dsp_base, const size_t ctrl_base,
-        const boost::uint32_t sid, const bool lingering_packet
+        const boost::uint32_t sid, const bool lingering_packet,
+        const poke_batch_type &poke_batch
     ):
-        _iface(iface), _dsp_base(dsp_base), _ctrl_base(ctrl_base)
+        _iface(iface), _poke_batch(poke_batch), _dsp_base(dsp_base), _ctrl_base(ctrl_base),
+        _bits_per_samp(32), _nsamps_per_packet(0)
     {
         //This is a hack/fix for the lingering packet problem.
         //The caller should also flush the recv transports
@@ -76,10 +82,27 @@ public:
         );
         _iface->poke32(REG_RX_CTRL_VRT_SID, sid);
         _iface->poke32(REG_RX_CTRL_VRT_TLR, 0);
+        _iface->poke32(REG_DSP_RX_FORMAT, 0);
     }
 
     void set_nsamps_per_packet(const size_t nsamps){
-        _iface->poke32(REG_RX_CTRL_NSAMPS_PP, nsamps);
+        _nsamps_per_packet = nsamps;
+        //the framer counts 32-bit lines, not samples
+        _iface->poke32(REG_RX_CTRL_NSAMPS_PP, nsamps*_bits_per_samp/32);
+    }
+
+    void set_otw_type(const otw_type_t &otw_type){
+        boost::uint32_t format;
+        switch(otw_type.width){
+        case 16: format = 0; break;
+        case 12: format = FLAG_DSP_RX_FORMAT_SC12; break;
+        case 8:  format = FLAG_DSP_RX_FORMAT_SC8; break;
+        default: throw uhd::value_error("rx dsp: unsupported otw width");
+        }
+        UHD_ASSERT_THROW(otw_type.shift == 16 - otw_type.width);
+        _bits_per_samp = otw_type.width*2;
+        _iface->poke32(REG_DSP_RX_FORMAT, format);
+        if (_nsamps_per_packet != 0) this->set_nsamps_per_packet(_nsamps_per_packet);
     }
 
     void issue_stream_command(const stream_cmd_t &stream_cmd){
@@ -106,12 +129,16 @@ public:
         cmd_word |= boost::uint32_t((inst_chain)?            1 : 0) << 30;
         cmd_word |= boost::uint32_t((inst_reload)?           1 : 0) << 29;
         cmd_word |= boost::uint32_t((inst_stop)?             1 : 0) << 28;
-        cmd_word |= (inst_samps)? stream_cmd.num_samps : ((inst_stop)? 0 : 1);
+        const size_t num_lines = (stream_cmd.num_samps*_bits_per_samp + 31)/32;
+        cmd_word |= (inst_samps)? num_lines : ((inst_stop)? 0 : 1);
 
         //issue the stream command
-        _iface->poke32(REG_RX_CTRL_STREAM_CMD, cmd_word);
-        _iface->poke32(REG_RX_CTRL_TIME_SECS, boost::uint32_t(stream_cmd.time_spec.get_full_secs()));
-        _iface->poke32(REG_RX_CTRL_TIME_TICKS, stream_cmd.time_spec.get_tick_count(_tick_rate)); //latches the command
+        pokes_type pokes;
+        pokes.push_back(std::make_pair(REG_RX_CTRL_STREAM_CMD, cmd_word));
+        pokes.push_back(std::make_pair(REG_RX_CTRL_TIME_SECS, boost::uint32_t(stream_cmd.time_spec.get_full_secs())));
+        pokes.push_back(std::make_pair(REG_RX_CTRL_TIME_TICKS, boost::uint32_t(stream_cmd.time_spec.get_tick_count(_tick_rate)))); //latches the command
+        if (_poke_batch) _poke_batch(pokes);
+        else for (size_t i = 0; i < pokes.size(); i++) _iface->poke32(pokes[i].first, pokes[i].second);
     }
 
     void set_mux(const std::string &mode, const bool fe_swapped){
@@ -129,12 +156,12 @@ public:
     }
 
     void set_link_rate(const double rate){
-        _link_rate = rate/sizeof(boost::uint32_t); //in samps/s
+        _link_rate = rate/sizeof(boost::uint32_t); //in lines/s
     }
 
     double set_host_rate(const double rate){
         const size_t decim_rate = uhd::clip<size_t>(
-            boost::math::iround(_tick_rate/rate), size_t(std::ceil(_tick_rate/_link_rate)), 512
+            boost::math::iround(_tick_rate/rate), size_t(std::ceil(_tick_rate/(_link_rate*32/_bits_per_samp))), 512
         );
         size_t decim = decim_rate;
 
@@ -192,12 +219,14 @@ public:
 
 private:
     wb_iface::sptr _iface;
+    const poke_batch_type _poke_batch;
     const size_t _dsp_base, _ctrl_base;
     double _tick_rate, _link_rate;
     bool _continuous_streaming;
     double _scaling_adjustment;
+    size_t _bits_per_samp, _nsamps_per_packet;
 };
 
-rx_dsp_core_200::sptr rx_dsp_core_200::make(wb_iface::sptr iface, const size_t dsp_base, const size_t ctrl_base, const boost::uint32_t sid, const bool lingering_packet){
-    return sptr(new rx_dsp_core_200_impl(iface, dsp_base, ctrl_base, sid, lingering_packet));
+rx_dsp_core_200::sptr rx_dsp_core_200::make(wb_iface::sptr iface, const size_t dsp_base, const size_t ctrl_base, const boost::uint32_t sid, const bool lingering_packet, const poke_batch_type &poke_batch){
+    return sptr(new rx_dsp_core_200_impl(iface, dsp_base, ctrl_base, sid, lingering_packet, poke_batch));
 }
@@ -22,22 +22,40 @@
 #include <uhd/types/ranges.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
 #include <uhd/types/stream_cmd.hpp>
+#include <uhd/types/otw_type.hpp>
 #include "wb_iface.hpp"
 #include <string>
+#include <utility>
+#include <vector>
 
 class rx_dsp_core_200 : boost::noncopyable{
 public:
     typedef boost::shared_ptr<rx_dsp_core_200> sptr;
 
+    //! a sequence of register writes as address and data pairs
+    typedef std::vector<std::pair<wb_iface::wb_addr_type, boost::uint32_t> > pokes_type;
+
+    //! a function that writes a sequence of registers in one transaction
+    typedef boost::function<void(const pokes_type &)> poke_batch_type;
+
+    /*!
+     * Make a new rx dsp core.
+     * \param poke_batch writes the registers of a stream command (default: one poke each)
+     */
     static sptr make(
         wb_iface::sptr iface,
         const size_t dsp_base, const size_t ctrl_base,
-        const boost::uint32_t sid, const bool lingering_packet = false
+        const boost::uint32_t sid, const bool lingering_packet = false,
+        const poke_batch_type &poke_batch = poke_batch_type()
     );
 
     virtual void set_nsamps_per_packet(const size_t nsamps) = 0;
 
+    //! Set the over-the-wire format: width 16 (sc16), 12 (packed sc12) or 8 (packed sc8)
+    virtual void set_otw_type(const uhd::otw_type_t &otw_type) = 0;
+
     virtual void issue_stream_command(const uhd::stream_cmd_t &stream_cmd) = 0;
 
     virtual void set_mux(const std::string &mode, const bool fe_swapped = false) = 0;
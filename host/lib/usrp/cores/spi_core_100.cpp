@@ -51,12 +51,7 @@ public:
         size_t num_bits,
         bool readback
     ){
-        UHD_ASSERT_THROW(num_bits <= 32 and (num_bits % 8) == 0);
-
-        int edge_flags = ((config.miso_edge==spi_config_t::EDGE_FALL) ? SPI_CTRL_RXNEG : 0) |
-                         ((config.mosi_edge==spi_config_t::EDGE_FALL) ? 0 : SPI_CTRL_TXNEG)
-                         ;
-        boost::uint16_t ctrl = SPI_CTRL_ASS | (SPI_CTRL_CHAR_LEN_MASK & num_bits) | edge_flags;
+        const boost::uint16_t ctrl = this->get_ctrl(config, num_bits);
 
         spi_wait();
         _iface->poke16(REG_SPI_DIV, 0x0001); // = fpga_clk / 4
@@ -70,7 +65,36 @@ public:
         return _iface->peek32(REG_SPI_TXRX0);
     }
 
+    void write_spi_burst(
+        int which_slave,
+        const spi_config_t &config,
+        const std::vector<boost::uint32_t> &data,
+        size_t num_bits
+    ){
+        if (data.empty()) return;
+        const boost::uint16_t ctrl = this->get_ctrl(config, num_bits);
+
+        spi_wait();
+        _iface->poke16(REG_SPI_DIV, 0x0001); // = fpga_clk / 4
+        _iface->poke32(REG_SPI_SS, which_slave & 0xFFFF);
+        _iface->poke16(REG_SPI_CTRL, ctrl);
+        for (size_t i = 0; i < data.size(); i++){
+            if (i != 0) spi_wait(); //the data register is busy until the shift completes
+            _iface->poke32(REG_SPI_TXRX0, data[i]);
+            _iface->poke16(REG_SPI_CTRL, ctrl | SPI_CTRL_GO_BSY);
+        }
+    }
+
 private:
+    boost::uint16_t get_ctrl(const spi_config_t &config, size_t num_bits){
+        UHD_ASSERT_THROW(num_bits <= 32 and (num_bits % 8) == 0);
+
+        int edge_flags = ((config.miso_edge==spi_config_t::EDGE_FALL) ? SPI_CTRL_RXNEG : 0) |
+                         ((config.mosi_edge==spi_config_t::EDGE_FALL) ? 0 : SPI_CTRL_TXNEG)
+                         ;
+        return SPI_CTRL_ASS | (SPI_CTRL_CHAR_LEN_MASK & num_bits) | edge_flags;
+    }
+
     void spi_wait(void) {
         for (size_t i = 0; i < 100; i++){
             if ((_iface->peek16(REG_SPI_CTRL) & SPI_CTRL_GO_BSY) == 0) return;
@@ -22,7 +22,9 @@
 #include <uhd/types/serial.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
 #include "wb_iface.hpp"
+#include <vector>
 
 class spi_core_100 : boost::noncopyable, public uhd::spi_iface{
 public:
@@ -30,6 +32,22 @@ public:
 
     //! makes a new spi core from iface and slave base
     static sptr make(wb_iface::sptr iface, const size_t base);
+
+    /*!
+     * Write a sequence of words to one slave.
+     * The divider, slave select, and control registers are set once,
+     * then each word costs its data write, go write, and busy wait.
+     * \param which_slave the slave select bits
+     * \param config the spi configuration
+     * \param data the words to write in order
+     * \param num_bits the number of bits in each word
+     */
+    virtual void write_spi_burst(
+        int which_slave,
+        const uhd::spi_config_t &config,
+        const std::vector<boost::uint32_t> &data,
+        size_t num_bits
+    ) = 0;
 };
 
 #endif /* INCLUDED_LIBUHD_USRP_SPI_CORE_100_HPP */
@@ -17,6 +17,7 @@
 
 #include "time64_core_200.hpp"
 #include <uhd/exception.hpp>
+#include <uhd/types/tick_time.hpp>
 #include <uhd/utils/assert_has.hpp>
 #include <boost/math/special_functions/round.hpp>
 
@@ -67,7 +68,7 @@ public:
             const boost::uint32_t secs = _iface->peek32(_readback_bases.rb_secs_now);
             const boost::uint32_t ticks = _iface->peek32(_readback_bases.rb_ticks_now);
             if (secs != _iface->peek32(_readback_bases.rb_secs_now)) continue;
-            return time_spec_t(secs, ticks, _tick_rate);
+            return tick_time_t(secs, ticks, _tick_rate).to_time_spec();
         }
         throw uhd::runtime_error("time64_core_200: get time now timeout");
     }
@@ -77,21 +78,25 @@ public:
             const boost::uint32_t secs = _iface->peek32(_readback_bases.rb_secs_pps);
             const boost::uint32_t ticks = _iface->peek32(_readback_bases.rb_ticks_pps);
             if (secs != _iface->peek32(_readback_bases.rb_secs_pps)) continue;
-            return time_spec_t(secs, ticks, _tick_rate);
+            return tick_time_t(secs, ticks, _tick_rate).to_time_spec();
         }
         throw uhd::runtime_error("time64_core_200: get time last pps timeout");
     }
 
     void set_time_now(const uhd::time_spec_t &time){
-        _iface->poke32(REG_TIME64_TICKS, time.get_tick_count(_tick_rate));
+        //rounded ticks that reach a full second carry into the seconds
+        const tick_time_t tick_time(time, _tick_rate);
+        _iface->poke32(REG_TIME64_TICKS, boost::uint32_t(tick_time.get_ticks()));
         _iface->poke32(REG_TIME64_IMM, FLAG_TIME64_LATCH_NOW);
-        _iface->poke32(REG_TIME64_SECS, boost::uint32_t(time.get_full_secs())); //latches all 3
+        _iface->poke32(REG_TIME64_SECS, boost::uint32_t(tick_time.get_full_secs())); //latches all 3
     }
 
     void set_time_next_pps(const uhd::time_spec_t &time){
-        _iface->poke32(REG_TIME64_TICKS, time.get_tick_count(_tick_rate));
+        //rounded ticks that reach a full second carry into the seconds
+        const tick_time_t tick_time(time, _tick_rate);
+        _iface->poke32(REG_TIME64_TICKS, boost::uint32_t(tick_time.get_ticks()));
         _iface->poke32(REG_TIME64_IMM, FLAG_TIME64_LATCH_NEXT_PPS);
-        _iface->poke32(REG_TIME64_SECS, boost::uint32_t(time.get_full_secs())); //latches all 3
+        _iface->poke32(REG_TIME64_SECS, boost::uint32_t(tick_time.get_full_secs())); //latches all 3
     }
 
     void set_time_source(const std::string &source){
@@ -28,6 +28,7 @@
 #define REG_DSP_TX_FREQ          _dsp_base + 0
 #define REG_DSP_TX_SCALE_IQ      _dsp_base + 4
 #define REG_DSP_TX_INTERP        _dsp_base + 8
+#define REG_DSP_TX_FORMAT        _dsp_base + 12
 
 #define REG_TX_CTRL_NUM_CHAN        _ctrl_base + 0
 #define REG_TX_CTRL_CLEAR_STATE     _ctrl_base + 4
@@ -40,6 +41,9 @@
 #define FLAG_TX_CTRL_POLICY_NEXT_PACKET   (0x1 << 1)
 #define FLAG_TX_CTRL_POLICY_NEXT_BURST    (0x1 << 2)
 
+#define FLAG_DSP_TX_FORMAT_SC8            (0x1 << 0)
+#define FLAG_DSP_TX_FORMAT_SC12           (0x1 << 1)
+
 //enable flag for registers: cycles and packets per update packet
 #define FLAG_TX_CTRL_UP_ENB              (1ul << 31)
 
@@ -56,26 +60,41 @@ public:
         const size_t dsp_base, const size_t ctrl_base,
         const boost::uint32_t sid
     ):
-        _iface(iface), _dsp_base(dsp_base), _ctrl_base(ctrl_base)
+        _iface(iface), _dsp_base(dsp_base), _ctrl_base(ctrl_base),
+        _bits_per_samp(32)
     {
         //init the tx control registers
         _iface->poke32(REG_TX_CTRL_CLEAR_STATE, 1); //reset
         _iface->poke32(REG_TX_CTRL_NUM_CHAN, 0);    //1 channel
         _iface->poke32(REG_TX_CTRL_REPORT_SID, sid);
         _iface->poke32(REG_TX_CTRL_POLICY, FLAG_TX_CTRL_POLICY_NEXT_PACKET);
+        _iface->poke32(REG_DSP_TX_FORMAT, 0);
     }
 
     void set_tick_rate(const double rate){
         _tick_rate = rate;
     }
 
+    void set_otw_type(const otw_type_t &otw_type){
+        boost::uint32_t format;
+        switch(otw_type.width){
+        case 16: format = 0; break;
+        case 12: format = FLAG_DSP_TX_FORMAT_SC12; break;
+        case 8:  format = FLAG_DSP_TX_FORMAT_SC8; break;
+        default: throw uhd::value_error("tx dsp: unsupported otw width");
+        }
+        UHD_ASSERT_THROW(otw_type.shift == 16 - otw_type.width);
+        _bits_per_samp = otw_type.width*2;
+        _iface->poke32(REG_DSP_TX_FORMAT, format);
+    }
+
     void set_link_rate(const double rate){
-        _link_rate = rate/sizeof(boost::uint32_t); //in samps/s
+        _link_rate = rate/sizeof(boost::uint32_t); //in lines/s
     }
 
     double set_host_rate(const double rate){
         const size_t interp_rate = uhd::clip<size_t>(
-            boost::math::iround(_tick_rate/rate), size_t(std::ceil(_tick_rate/_link_rate)), 512
+            boost::math::iround(_tick_rate/rate), size_t(std::ceil(_tick_rate/(_link_rate*32/_bits_per_samp))), 512
         );
         size_t interp = interp_rate;
 
@@ -133,6 +152,7 @@ private:
     wb_iface::sptr _iface;
     const size_t _dsp_base, _ctrl_base;
     double _tick_rate, _link_rate;
+    size_t _bits_per_samp;
 };
 
 tx_dsp_core_200::sptr tx_dsp_core_200::make(wb_iface::sptr iface, const size_t dsp_base, const size_t ctrl_base, const boost::uint32_t sid){
@@ -20,6 +20,7 @@
 
 #include <uhd/config.hpp>
 #include <uhd/types/ranges.hpp>
+#include <uhd/types/otw_type.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 #include "wb_iface.hpp"
@@ -36,6 +37,9 @@ public:
 
     virtual void set_tick_rate(const double rate) = 0;
 
+    //! Set the over-the-wire format: width 16 (sc16), 12 (packed sc12) or 8 (packed sc8)
+    virtual void set_otw_type(const uhd::otw_type_t &otw_type) = 0;
+
     virtual void set_link_rate(const double rate) = 0;
 
     virtual double set_host_rate(const double rate) = 0;
@@ -0,0 +1,78 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "wb_cache_iface.hpp"
+#include <uhd/types/dict.hpp>
+#include <boost/thread/mutex.hpp>
+#include <utility>
+#include <vector>
+
+class wb_cache_iface_impl : public wb_cache_iface{
+public:
+    wb_cache_iface_impl(wb_iface::sptr iface):
+        _iface(iface) { /* NOP */ }
+
+    void add_range(const wb_addr_type base, const size_t num_regs){
+        boost::mutex::scoped_lock lock(_mutex);
+        _ranges.push_back(std::make_pair(base, base + num_regs*4));
+    }
+
+    void clear(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        _cache = uhd::dict<wb_addr_type, boost::uint32_t>();
+    }
+
+    void poke32(wb_addr_type addr, boost::uint32_t data){
+        boost::mutex::scoped_lock lock(_mutex);
+        const bool cached = this->is_cached(addr);
+        if (cached and _cache.has_key(addr) and _cache[addr] == data) return; //redundant
+        _iface->poke32(addr, data);
+        if (cached) _cache[addr] = data;
+    }
+
+    boost::uint32_t peek32(wb_addr_type addr){
+        return _iface->peek32(addr);
+    }
+
+    void poke16(wb_addr_type addr, boost::uint16_t data){
+        boost::mutex::scoped_lock lock(_mutex);
+        const wb_addr_type word_addr = addr & ~wb_addr_type(3);
+        if (_cache.has_key(word_addr)) _cache.pop(word_addr); //a partial write, forget the word
+        _iface->poke16(addr, data);
+    }
+
+    boost::uint16_t peek16(wb_addr_type addr){
+        return _iface->peek16(addr);
+    }
+
+private:
+    bool is_cached(const wb_addr_type addr) const{
+        for (size_t i = 0; i < _ranges.size(); i++){
+            if (addr >= _ranges[i].first and addr < _ranges[i].second) return true;
+        }
+        return false;
+    }
+
+    wb_iface::sptr _iface;
+    boost::mutex _mutex;
+    std::vector<std::pair<wb_addr_type, wb_addr_type> > _ranges;
+    uhd::dict<wb_addr_type, boost::uint32_t> _cache;
+};
+
+wb_cache_iface::sptr wb_cache_iface::make(wb_iface::sptr iface){
+    return sptr(new wb_cache_iface_impl(iface));
+}
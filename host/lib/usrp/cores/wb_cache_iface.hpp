@@ -0,0 +1,49 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_WB_CACHE_IFACE_HPP
+#define INCLUDED_LIBUHD_USRP_WB_CACHE_IFACE_HPP
+
+#include <uhd/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include "wb_iface.hpp"
+
+/*!
+ * A write cache in front of a wishbone interface:
+ * Remembers the last value poked to each cached register,
+ * and drops a poke32 that would write the same value again.
+ * Only registers in the added ranges are cached, so registers
+ * whose writes have side effects (commands, clears) always go through.
+ */
+class wb_cache_iface : boost::noncopyable, public wb_iface{
+public:
+    typedef boost::shared_ptr<wb_cache_iface> sptr;
+
+    //! makes a new write cache in front of iface (caches nothing yet)
+    static sptr make(wb_iface::sptr iface);
+
+    //! cache the registers at [base, base + num_regs*4)
+    virtual void add_range(const wb_addr_type base, const size_t num_regs) = 0;
+
+    //! forget the cached values, ex: after the device was reset
+    virtual void clear(void) = 0;
+
+};
+
+#endif /* INCLUDED_LIBUHD_USRP_WB_CACHE_IFACE_HPP */
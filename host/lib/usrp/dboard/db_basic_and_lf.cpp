@@ -24,6 +24,7 @@
 #include <uhd/usrp/dboard_manager.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
 
 using namespace uhd;
 using namespace uhd::usrp;
@@ -48,11 +49,10 @@ public:
     basic_rx(ctor_args_t args, double max_freq);
     ~basic_rx(void);
 
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
-
 private:
     double _max_freq;
+
+    double set_bandwidth(double bandwidth);
 };
 
 class basic_tx : public tx_dboard_base{
@@ -60,20 +60,54 @@ public:
     basic_tx(ctor_args_t args, double max_freq);
     ~basic_tx(void);
 
-    void tx_get(const wax::obj &key, wax::obj &val);
-    void tx_set(const wax::obj &key, const wax::obj &val);
-
 private:
     double _max_freq;
+
+    double set_bandwidth(double bandwidth);
 };
 
-static const uhd::dict<std::string, subdev_conn_t> sd_name_to_conn = map_list_of
-    ("AB", SUBDEV_CONN_COMPLEX_IQ)
-    ("BA", SUBDEV_CONN_COMPLEX_QI)
-    ("A",  SUBDEV_CONN_REAL_I)
-    ("B",  SUBDEV_CONN_REAL_Q)
+static const uhd::dict<std::string, std::string> sd_name_to_conn = map_list_of
+    ("AB", "IQ")
+    ("BA", "QI")
+    ("A",  "I")
+    ("B",  "Q")
 ;
 
+/***********************************************************************
+ * The properties of the basic and lf boards:
+ *   The settings are fixed, the coercers keep them that way.
+ **********************************************************************/
+static double coerce_zero_freq(double){
+    return double(0); // it wont do you much good, but you can set it
+}
+
+static std::string coerce_no_antenna(const std::string &ant){
+    if (ant.empty()) return ant;
+    throw uhd::value_error("no selectable antennas on this board");
+}
+
+static void populate_basic_props(
+    property_tree::sptr subtree, const std::string &name,
+    const std::string &conn, const double max_freq
+){
+    subtree->create<std::string>("name").set(name);
+    subtree->create<int>("sensors"); //phony property so this dir exists
+    subtree->create<int>("gains"); //phony property so this dir exists
+    subtree->create<double>("freq/value")
+        .coerce(&coerce_zero_freq)
+        .set(double(0));
+    subtree->create<meta_range_t>("freq/range")
+        .set(freq_range_t(-max_freq, +max_freq));
+    subtree->create<std::string>("antenna/value")
+        .coerce(&coerce_no_antenna)
+        .set("");
+    subtree->create<std::vector<std::string> >("antenna/options")
+        .set(prop_names_t(1, "")); //vector of 1 empty string
+    subtree->create<std::string>("connection").set(conn);
+    subtree->create<bool>("enabled").set(true); //always enabled
+    subtree->create<bool>("use_lo_offset").set(false);
+}
+
 /***********************************************************************
  * Register the basic and LF dboards
  **********************************************************************/
@@ -111,108 +145,30 @@ basic_rx::basic_rx(ctor_args_t args, double max_freq) : rx_dboard_base(args){
     this->get_iface()->set_gpio_ddr(dboard_iface::UNIT_RX, 0xFFFF);
     this->get_iface()->set_gpio_out(dboard_iface::UNIT_RX, 0x0000);
     this->get_iface()->set_clock_enabled(dboard_iface::UNIT_RX, true);
+
+    ////////////////////////////////////////////////////////////////////
+    // Register properties
+    ////////////////////////////////////////////////////////////////////
+    populate_basic_props(
+        this->get_rx_subtree(),
+        str(boost::format("%s - %s") % get_rx_id().to_pp_string() % get_subdev_name()),
+        sd_name_to_conn[get_subdev_name()], _max_freq
+    );
+    create_coerced<double>(this->get_rx_subtree(), "bandwidth/value",
+        subdev_bandwidth_scalar[get_subdev_name()]*_max_freq,
+        boost::bind(&basic_rx::set_bandwidth, this, _1)
+    );
 }
 
 basic_rx::~basic_rx(void){
     /* NOP */
 }
 
-void basic_rx::rx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = std::string(str(boost::format("%s - %s")
-            % get_rx_id().to_pp_string()
-            % get_subdev_name()
-        ));
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        val = double(0);
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        val = gain_range_t(0, 0, 0);
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = double(0);
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = freq_range_t(-_max_freq, +_max_freq);
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = std::string("");
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = prop_names_t(1, ""); //vector of 1 empty string
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = std::vector<std::string>(); //empty
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = sd_name_to_conn[get_subdev_name()];
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = true; //always enabled
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = subdev_bandwidth_scalar[get_subdev_name()]*_max_freq;
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
-}
-
-void basic_rx::rx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_GAIN:
-        UHD_ASSERT_THROW(val.as<double>() == double(0));
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        if (val.as<std::string>().empty()) return;
-        throw uhd::value_error("no selectable antennas on this board");
-
-    case SUBDEV_PROP_FREQ:
-        return; // it wont do you much good, but you can set it
-
-    case SUBDEV_PROP_ENABLED:
-        return; //always enabled
-
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << boost::format(
-            "%s: No tunable bandwidth, fixed filtered to %0.2fMHz"
-        ) % get_rx_id().to_pp_string() % _max_freq;
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
+double basic_rx::set_bandwidth(double){
+    UHD_MSG(warning) << boost::format(
+        "%s: No tunable bandwidth, fixed filtered to %0.2fMHz"
+    ) % get_rx_id().to_pp_string() % _max_freq;
+    return subdev_bandwidth_scalar[get_subdev_name()]*_max_freq;
 }
 
 /***********************************************************************
@@ -221,106 +177,28 @@ void basic_rx::rx_set(const wax::obj &key_, const wax::obj &val){
 basic_tx::basic_tx(ctor_args_t args, double max_freq) : tx_dboard_base(args){
     _max_freq = max_freq;
     this->get_iface()->set_clock_enabled(dboard_iface::UNIT_TX, true);
+
+    ////////////////////////////////////////////////////////////////////
+    // Register properties
+    ////////////////////////////////////////////////////////////////////
+    populate_basic_props(
+        this->get_tx_subtree(),
+        str(boost::format("%s - %s") % get_tx_id().to_pp_string() % get_subdev_name()),
+        sd_name_to_conn[get_subdev_name()], _max_freq
+    );
+    create_coerced<double>(this->get_tx_subtree(), "bandwidth/value",
+        subdev_bandwidth_scalar[get_subdev_name()]*_max_freq,
+        boost::bind(&basic_tx::set_bandwidth, this, _1)
+    );
 }
 
 basic_tx::~basic_tx(void){
     /* NOP */
 }
 
-void basic_tx::tx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = std::string(str(boost::format("%s - %s")
-            % get_tx_id().to_pp_string()
-            % get_subdev_name()
-        ));
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        val = double(0);
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        val = gain_range_t(0, 0, 0);
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = double(0);
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = freq_range_t(-_max_freq, +_max_freq);
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = std::string("");
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = prop_names_t(1, ""); //vector of 1 empty string
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = std::vector<std::string>(); //empty
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = sd_name_to_conn[get_subdev_name()];
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = true; //always enabled
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = subdev_bandwidth_scalar[get_subdev_name()]*_max_freq;
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
-}
-
-void basic_tx::tx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_GAIN:
-        UHD_ASSERT_THROW(val.as<double>() == double(0));
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        if (val.as<std::string>().empty()) return;
-        throw uhd::value_error("no selectable antennas on this board");
-
-    case SUBDEV_PROP_FREQ:
-        return; // it wont do you much good, but you can set it
-
-    case SUBDEV_PROP_ENABLED:
-        return; //always enabled
-
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << boost::format(
-            "%s: No tunable bandwidth, fixed filtered to %0.2fMHz"
-        ) % get_tx_id().to_pp_string() % _max_freq;
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
+double basic_tx::set_bandwidth(double){
+    UHD_MSG(warning) << boost::format(
+        "%s: No tunable bandwidth, fixed filtered to %0.2fMHz"
+    ) % get_tx_id().to_pp_string() % _max_freq;
+    return subdev_bandwidth_scalar[get_subdev_name()]*_max_freq;
 }
@@ -32,6 +32,7 @@
 #include <uhd/usrp/dboard_manager.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
 #include <boost/thread.hpp>
 #include <boost/math/special_functions/round.hpp>
 #include <utility>
@@ -55,6 +56,11 @@ static const uhd::dict<std::string, gain_range_t> dbsrx_gain_ranges = map_list_o
     ("GC2", gain_range_t(0, 24, 1))
 ;
 
+static std::string coerce_antenna(const std::string &ant){
+    assert_has(dbsrx_antennas, ant, "DBSRX antenna name");
+    return ant;
+}
+
 /***********************************************************************
  * The DBSRX dboard class
  **********************************************************************/
@@ -63,23 +69,27 @@ public:
     dbsrx(ctor_args_t args);
     ~dbsrx(void);
 
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
-
 private:
     double _lo_freq;
     double _bandwidth;
-    uhd::dict<std::string, double> _gains;
     max2118_write_regs_t _max2118_write_regs;
     max2118_read_regs_t _max2118_read_regs;
     boost::uint8_t _max2118_addr(void){
         return (this->get_iface()->get_special_props().mangle_i2c_addrs)? 0x65 : 0x67;
     };
 
-    void set_lo_freq(double target_freq);
-    void set_gain(double gain, const std::string &name);
+    double set_lo_freq(double target_freq);
+    double set_gain(double gain, const std::string &name);
     void set_bandwidth(double bandwidth);
 
+    //_bandwidth is low-pass, the property is complex double-sided
+    double get_bandwidth(void){
+        return 2*_bandwidth;
+    }
+    void set_complex_bandwidth(double bandwidth){
+        this->set_bandwidth(bandwidth/2.0);
+    }
+
     void send_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg){
         start_reg = boost::uint8_t(uhd::clip(int(start_reg), 0x0, 0x5));
         stop_reg = boost::uint8_t(uhd::clip(int(stop_reg), 0x0, 0x5));
@@ -137,9 +147,9 @@ private:
 
     /*!
      * Is the LO locked?
-     * \return true for locked
+     * \return the lo locked sensor
      */
-    bool get_locked(void){
+    sensor_value_t get_locked(void){
         read_reg(0x0, 0x0);
 
         //mask and return lock detect
@@ -149,7 +159,7 @@ private:
             "DBSRX: locked %d"
         ) % locked << std::endl;
 
-        return locked;
+        return sensor_value_t("LO", locked, "locked", "unlocked");
     }
 
 };
@@ -205,15 +215,39 @@ dbsrx::dbsrx(ctor_args_t args) : rx_dboard_base(args){
     //send initial register settings
     this->send_reg(0x0, 0x5);
 
-    //set defaults for LO, gains, and filter bandwidth
+    ////////////////////////////////////////////////////////////////////
+    // Register properties, the sets apply the defaults
+    ////////////////////////////////////////////////////////////////////
     _bandwidth = 33e6;
-    set_lo_freq(dbsrx_freq_range.start());
-
+    this->get_rx_subtree()->create<std::string>("name")
+        .set(get_rx_id().to_pp_string());
+    this->get_rx_subtree()->create<sensor_value_t>("sensors/lo_locked")
+        .publish(boost::bind(&dbsrx::get_locked, this));
+    this->get_rx_subtree()->create<double>("freq/value")
+        .coerce(boost::bind(&dbsrx::set_lo_freq, this, _1))
+        .set(dbsrx_freq_range.start());
+    this->get_rx_subtree()->create<meta_range_t>("freq/range")
+        .set(dbsrx_freq_range);
     BOOST_FOREACH(const std::string &name, dbsrx_gain_ranges.keys()){
-        set_gain(dbsrx_gain_ranges[name].start(), name);
+        this->get_rx_subtree()->create<double>("gains/"+name+"/value")
+            .coerce(boost::bind(&dbsrx::set_gain, this, _1, name))
+            .set(dbsrx_gain_ranges[name].start());
+        this->get_rx_subtree()->create<meta_range_t>("gains/"+name+"/range")
+            .set(dbsrx_gain_ranges[name]);
     }
-
-    set_bandwidth(33e6); // default bandwidth from datasheet
+    this->get_rx_subtree()->create<std::string>("antenna/value")
+        .coerce(&coerce_antenna)
+        .set(dbsrx_antennas.at(0));
+    this->get_rx_subtree()->create<std::vector<std::string> >("antenna/options")
+        .set(dbsrx_antennas);
+    this->get_rx_subtree()->create<std::string>("connection").set("IQ");
+    this->get_rx_subtree()->create<bool>("enabled").set(true); //always enabled
+    this->get_rx_subtree()->create<bool>("use_lo_offset").set(false);
+    //the tuning may update the filter, so the bandwidth is read back
+    this->get_rx_subtree()->create<double>("bandwidth/value")
+        .publish(boost::bind(&dbsrx::get_bandwidth, this))
+        .subscribe(boost::bind(&dbsrx::set_complex_bandwidth, this, _1))
+        .set(2*33e6); // default bandwidth from datasheet
 }
 
 dbsrx::~dbsrx(void){
@@ -223,7 +257,7 @@ dbsrx::~dbsrx(void){
 /***********************************************************************
  * Tuning
  **********************************************************************/
-void dbsrx::set_lo_freq(double target_freq){
+double dbsrx::set_lo_freq(double target_freq){
     target_freq = dbsrx_freq_range.clip(target_freq);
 
     double actual_freq=0.0, pfd_freq=0.0, ref_clock=0.0;
@@ -398,6 +432,7 @@ void dbsrx::set_lo_freq(double target_freq){
 
     if (update_filter_settings) set_bandwidth(_bandwidth);
     get_locked();
+    return _lo_freq;
 }
 
 /***********************************************************************
@@ -456,7 +491,7 @@ static double gain_to_gc1_rfvga_dac(double &gain){
     return dac_volts;
 }
 
-void dbsrx::set_gain(double gain, const std::string &name){
+double dbsrx::set_gain(double gain, const std::string &name){
     assert_has(dbsrx_gain_ranges.keys(), name, "dbsrx gain name");
     if (name == "GC2"){
         _max2118_write_regs.gc2 = gain_to_gc2_vga_reg(gain);
@@ -467,7 +502,7 @@ void dbsrx::set_gain(double gain, const std::string &name){
         this->get_iface()->write_aux_dac(dboard_iface::UNIT_RX, dboard_iface::AUX_DAC_A, gain_to_gc1_rfvga_dac(gain));
     }
     else UHD_THROW_INVALID_CODE_PATH();
-    _gains[name] = gain;
+    return gain;
 }
 
 /***********************************************************************
@@ -493,108 +528,3 @@ void dbsrx::set_bandwidth(double bandwidth){
 
     this->send_reg(0x3, 0x4);
 }
-
-/***********************************************************************
- * RX Get and Set
- **********************************************************************/
-void dbsrx::rx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = get_rx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        assert_has(_gains.keys(), key.name, "dbsrx gain name");
-        val = _gains[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        assert_has(dbsrx_gain_ranges.keys(), key.name, "dbsrx gain name");
-        val = dbsrx_gain_ranges[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(dbsrx_gain_ranges.keys());
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = _lo_freq;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = dbsrx_freq_range;
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = dbsrx_antennas.at(0);
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = dbsrx_antennas;
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = SUBDEV_CONN_COMPLEX_IQ;
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = true; //always enabled
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_SENSOR:
-        UHD_ASSERT_THROW(key.name == "lo_locked");
-        val = sensor_value_t("LO", this->get_locked(), "locked", "unlocked");
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = prop_names_t(1, "lo_locked");
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = 2*_bandwidth; //_bandwidth is low-pass, we want complex double-sided
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
-}
-
-void dbsrx::rx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_FREQ:
-        this->set_lo_freq(val.as<double>());
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        assert_has(dbsrx_antennas, val.as<std::string>(), "DBSRX antenna name");
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        this->set_gain(val.as<double>(), key.name);
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        return; //always enabled
-
-    case SUBDEV_PROP_BANDWIDTH:
-        this->set_bandwidth(val.as<double>()/2.0); //complex double-sided, we want low-pass
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
-}
-
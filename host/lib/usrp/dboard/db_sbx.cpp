@@ -85,6 +85,7 @@
 #include <uhd/usrp/dboard_manager.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
 #include <boost/math/special_functions/round.hpp>
 #include <boost/thread.hpp>
 
@@ -97,6 +98,9 @@ using namespace boost::assign;
  **********************************************************************/
 static const freq_range_t sbx_freq_range(400e6, 4.4e9);
 
+//the number of cached divider plans per unit before the cache starts over
+static const size_t MAX_LO_PLANS = 256;
+
 static const freq_range_t sbx_tx_lo_2dbm = list_of
     (range_t(0.35e9, 0.37e9))
 ;
@@ -129,23 +133,28 @@ public:
     sbx_xcvr(ctor_args_t args);
     ~sbx_xcvr(void);
 
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
-
-    void tx_get(const wax::obj &key, wax::obj &val);
-    void tx_set(const wax::obj &key, const wax::obj &val);
-
 private:
     uhd::dict<std::string, double> _tx_gains, _rx_gains;
     double       _rx_lo_freq, _tx_lo_freq;
     std::string  _tx_ant, _rx_ant;
-
-    void set_rx_lo_freq(double freq);
-    void set_tx_lo_freq(double freq);
-    void set_rx_ant(const std::string &ant);
-    void set_tx_ant(const std::string &ant);
-    void set_rx_gain(double gain, const std::string &name);
-    void set_tx_gain(double gain, const std::string &name);
+    uhd::dict<dboard_iface::unit_t, adf4350_regs_t> _lo_regs;
+
+    //! The divider settings that tune one unit to one frequency
+    struct lo_plan_t{
+        double ref_freq, actual_freq;
+        int R, BS, N, FRAC, MOD, RFdiv;
+        adf4350_regs_t::prescaler_t prescaler;
+        adf4350_regs_t::reference_divide_by_2_t T;
+        adf4350_regs_t::reference_doubler_t D;
+    };
+    uhd::dict<dboard_iface::unit_t, uhd::dict<double, lo_plan_t> > _lo_plans;
+
+    double set_rx_lo_freq(double freq);
+    double set_tx_lo_freq(double freq);
+    std::string set_rx_ant(const std::string &ant);
+    std::string set_tx_ant(const std::string &ant);
+    double set_rx_gain(double gain, const std::string &name);
+    double set_tx_gain(double gain, const std::string &name);
 
     void update_atr(void);
 
@@ -157,6 +166,14 @@ private:
      */
     double set_lo_freq(dboard_iface::unit_t unit, double target_freq);
 
+    /*!
+     * Calculate the divider settings for an LO frequency.
+     * \param unit which unit rx or tx
+     * \param target_freq the desired frequency in Hz (clipped)
+     * \return the dividers and the actual frequency
+     */
+    lo_plan_t make_lo_plan(dboard_iface::unit_t unit, double target_freq);
+
     /*!
      * Get the lock detect status of the LO.
      * \param unit which unit rx or tx
@@ -166,6 +183,10 @@ private:
         return (this->get_iface()->read_gpio(unit) & LOCKDET_MASK) != 0;
     }
 
+    sensor_value_t get_locked_sensor(dboard_iface::unit_t unit){
+        return sensor_value_t("LO", this->get_locked(unit), "locked", "unlocked");
+    }
+
     /*!
      * Flash the LEDs
      */
@@ -238,6 +259,11 @@ private:
 
 };
 
+static double coerce_fixed_bandwidth(double){
+    UHD_MSG(warning) << "SBX: No tunable bandwidth, fixed filtered to 40MHz";
+    return 2*20.0e6; //20MHz low-pass, we want complex double-sided
+}
+
 /***********************************************************************
  * Register the SBX dboard (min freq, max freq, rx div2, tx div2)
  **********************************************************************/
@@ -271,17 +297,67 @@ sbx_xcvr::sbx_xcvr(ctor_args_t args) : xcvr_dboard_base(args){
         "SBX GPIO Direction: RX: 0x%08x, TX: 0x%08x"
     ) % RXIO_MASK % TXIO_MASK << std::endl;
 
-    //set some default values
-    set_rx_lo_freq((sbx_freq_range.start() + sbx_freq_range.stop())/2.0);
-    set_tx_lo_freq((sbx_freq_range.start() + sbx_freq_range.stop())/2.0);
-    set_rx_ant("RX2");
-
-    BOOST_FOREACH(const std::string &name, sbx_tx_gain_ranges.keys()){
-        set_tx_gain(sbx_tx_gain_ranges[name].start(), name);
-    }
+    ////////////////////////////////////////////////////////////////////
+    // Register RX properties, the sets apply the defaults
+    ////////////////////////////////////////////////////////////////////
+    this->get_rx_subtree()->create<std::string>("name")
+        .set(get_rx_id().to_pp_string());
+    this->get_rx_subtree()->create<sensor_value_t>("sensors/lo_locked")
+        .publish(boost::bind(&sbx_xcvr::get_locked_sensor, this, dboard_iface::UNIT_RX));
+    this->get_rx_subtree()->create<double>("freq/value")
+        .coerce(boost::bind(&sbx_xcvr::set_rx_lo_freq, this, _1))
+        .set((sbx_freq_range.start() + sbx_freq_range.stop())/2.0);
+    this->get_rx_subtree()->create<meta_range_t>("freq/range").set(sbx_freq_range);
+    this->get_rx_subtree()->create<std::string>("antenna/value")
+        .coerce(boost::bind(&sbx_xcvr::set_rx_ant, this, _1))
+        .set("RX2");
+    this->get_rx_subtree()->create<std::vector<std::string> >("antenna/options")
+        .set(sbx_rx_antennas);
     BOOST_FOREACH(const std::string &name, sbx_rx_gain_ranges.keys()){
-        set_rx_gain(sbx_rx_gain_ranges[name].start(), name);
+        this->get_rx_subtree()->create<double>("gains/"+name+"/value")
+            .coerce(boost::bind(&sbx_xcvr::set_rx_gain, this, _1, name))
+            .set(sbx_rx_gain_ranges[name].start());
+        this->get_rx_subtree()->create<meta_range_t>("gains/"+name+"/range")
+            .set(sbx_rx_gain_ranges[name]);
     }
+    this->get_rx_subtree()->create<std::string>("connection").set("IQ");
+    this->get_rx_subtree()->create<bool>("enabled").set(true); //always enabled
+    this->get_rx_subtree()->create<bool>("use_lo_offset").set(false);
+    create_coerced<double>(this->get_rx_subtree(), "bandwidth/value",
+        2*20.0e6, //20MHz low-pass, we want complex double-sided
+        &coerce_fixed_bandwidth
+    );
+
+    ////////////////////////////////////////////////////////////////////
+    // Register TX properties, the sets apply the defaults
+    ////////////////////////////////////////////////////////////////////
+    this->get_tx_subtree()->create<std::string>("name")
+        .set(get_tx_id().to_pp_string());
+    this->get_tx_subtree()->create<sensor_value_t>("sensors/lo_locked")
+        .publish(boost::bind(&sbx_xcvr::get_locked_sensor, this, dboard_iface::UNIT_TX));
+    this->get_tx_subtree()->create<double>("freq/value")
+        .coerce(boost::bind(&sbx_xcvr::set_tx_lo_freq, this, _1))
+        .set((sbx_freq_range.start() + sbx_freq_range.stop())/2.0);
+    this->get_tx_subtree()->create<meta_range_t>("freq/range").set(sbx_freq_range);
+    this->get_tx_subtree()->create<std::string>("antenna/value")
+        .coerce(boost::bind(&sbx_xcvr::set_tx_ant, this, _1))
+        .set(sbx_tx_antennas.at(0));
+    this->get_tx_subtree()->create<std::vector<std::string> >("antenna/options")
+        .set(sbx_tx_antennas);
+    BOOST_FOREACH(const std::string &name, sbx_tx_gain_ranges.keys()){
+        this->get_tx_subtree()->create<double>("gains/"+name+"/value")
+            .coerce(boost::bind(&sbx_xcvr::set_tx_gain, this, _1, name))
+            .set(sbx_tx_gain_ranges[name].start());
+        this->get_tx_subtree()->create<meta_range_t>("gains/"+name+"/range")
+            .set(sbx_tx_gain_ranges[name]);
+    }
+    this->get_tx_subtree()->create<std::string>("connection").set("QI");
+    this->get_tx_subtree()->create<bool>("enabled").set(true); //always enabled
+    this->get_tx_subtree()->create<bool>("use_lo_offset").set(false);
+    create_coerced<double>(this->get_tx_subtree(), "bandwidth/value",
+        2*20.0e6, //20MHz low-pass, we want complex double-sided
+        &coerce_fixed_bandwidth
+    );
 }
 
 sbx_xcvr::~sbx_xcvr(void){
@@ -335,7 +411,7 @@ static int tx_pga0_gain_to_iobits(double &gain){
     return iobits;
 }
 
-void sbx_xcvr::set_tx_gain(double gain, const std::string &name){
+double sbx_xcvr::set_tx_gain(double gain, const std::string &name){
     assert_has(sbx_tx_gain_ranges.keys(), name, "sbx tx gain name");
     if(name == "PGA0"){
         tx_pga0_gain_to_iobits(gain);
@@ -345,9 +421,10 @@ void sbx_xcvr::set_tx_gain(double gain, const std::string &name){
         update_atr();
     }
     else UHD_THROW_INVALID_CODE_PATH();
+    return gain;
 }
 
-void sbx_xcvr::set_rx_gain(double gain, const std::string &name){
+double sbx_xcvr::set_rx_gain(double gain, const std::string &name){
     assert_has(sbx_rx_gain_ranges.keys(), name, "sbx rx gain name");
     if(name == "PGA0"){
         rx_pga0_gain_to_iobits(gain);
@@ -357,6 +434,7 @@ void sbx_xcvr::set_rx_gain(double gain, const std::string &name){
         update_atr();
     }
     else UHD_THROW_INVALID_CODE_PATH();
+    return gain;
 }
 
 /***********************************************************************
@@ -373,6 +451,9 @@ void sbx_xcvr::update_atr(void){
     int rx_ant_led = _rx_ant == "TX/RX" ? RX_LED_RX1RX2 : 0;
     int tx_ant_led = _rx_ant == "TX/RX" ? 0 : TX_LED_TXRX;
 
+    //write all the atr regs below at once
+    this->get_iface()->begin_gpio_update();
+
     //setup the tx atr (this does not change with antenna)
     this->get_iface()->set_atr_reg(dboard_iface::UNIT_TX, dboard_iface::ATR_REG_IDLE,
         tx_pga0_iobits | tx_lo_lpf_en | tx_ld_led | tx_ant_led | TX_POWER_UP | ANT_XX | TX_MIXER_DIS);
@@ -397,12 +478,14 @@ void sbx_xcvr::update_atr(void){
         rx_pga0_iobits | rx_lo_lpf_en | rx_ld_led | rx_ant_led | RX_POWER_UP | RX_MIXER_ENB | 
             ((_rx_ant == "TX/RX")? ANT_TXRX : ANT_RX2));
 
+    this->get_iface()->commit_gpio_update();
+
     UHD_LOGV(often) << boost::format(
         "SBX RXONLY ATR REG: 0x%08x"
     ) % (rx_pga0_iobits | RX_POWER_UP | RX_MIXER_ENB | ((_rx_ant == "TX/RX")? ANT_TXRX : ANT_RX2)) << std::endl;
 }
 
-void sbx_xcvr::set_rx_ant(const std::string &ant){
+std::string sbx_xcvr::set_rx_ant(const std::string &ant){
     //validate input
     assert_has(sbx_rx_antennas, ant, "sbx rx antenna name");
 
@@ -411,50 +494,38 @@ void sbx_xcvr::set_rx_ant(const std::string &ant){
 
     //write the new antenna setting to atr regs
     update_atr();
+    return _rx_ant;
 }
 
-void sbx_xcvr::set_tx_ant(const std::string &ant){
+std::string sbx_xcvr::set_tx_ant(const std::string &ant){
     assert_has(sbx_tx_antennas, ant, "sbx tx antenna name");
     //only one antenna option, do nothing
+    return ant;
 }
 
 /***********************************************************************
  * Tuning
  **********************************************************************/
-void sbx_xcvr::set_rx_lo_freq(double freq){
+double sbx_xcvr::set_rx_lo_freq(double freq){
     _rx_lo_freq = set_lo_freq(dboard_iface::UNIT_RX, freq);
+    return _rx_lo_freq;
 }
 
-void sbx_xcvr::set_tx_lo_freq(double freq){
+double sbx_xcvr::set_tx_lo_freq(double freq){
     _tx_lo_freq = set_lo_freq(dboard_iface::UNIT_TX, freq);
+    return _tx_lo_freq;
 }
 
-double sbx_xcvr::set_lo_freq(
+sbx_xcvr::lo_plan_t sbx_xcvr::make_lo_plan(
     dboard_iface::unit_t unit,
     double target_freq
 ){
-    UHD_LOGV(often) << boost::format(
-        "SBX tune: target frequency %f Mhz"
-    ) % (target_freq/1e6) << std::endl;
-
-    //clip the input
-    target_freq = sbx_freq_range.clip(target_freq);
-
     //map prescaler setting to mininmum integer divider (N) values (pg.18 prescaler)
     static const uhd::dict<int, int> prescaler_to_min_int_div = map_list_of
         (0,23) //adf4350_regs_t::PRESCALER_4_5
         (1,75) //adf4350_regs_t::PRESCALER_8_9
     ;
 
-    //map rf divider select output dividers to enums
-    static const uhd::dict<int, adf4350_regs_t::rf_divider_select_t> rfdivsel_to_enum = map_list_of
-        (1,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV1)
-        (2,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV2)
-        (4,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV4)
-        (8,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV8)
-        (16, adf4350_regs_t::RF_DIVIDER_SELECT_DIV16)
-    ;
-
     double actual_freq, pfd_freq;
     double ref_freq = this->get_iface()->get_clock_rate(unit);
     int R=0, BS=0, N=0, FRAC=0, MOD=0;
@@ -478,13 +549,9 @@ double sbx_xcvr::set_lo_freq(
     adf4350_regs_t::prescaler_t prescaler = vco_freq > 3e9 ? adf4350_regs_t::PRESCALER_8_9 : adf4350_regs_t::PRESCALER_4_5;
 
     /*
-     * The goal here is to loop though possible R dividers,
-     * band select clock dividers, N (int) dividers, and FRAC 
-     * (frac) dividers.
-     *
-     * Calculate the N and F dividers for each set of values.
-     * The loop exists when it meets all of the constraints.
-     * The resulting loop values are loaded into the registers.
+     * The R and band select dividers only depend on the reference,
+     * so they are calculated directly instead of searched for.
+     * The N and F dividers follow from the resulting PFD frequency.
      *
      * from pg.21
      *
@@ -494,26 +561,19 @@ double sbx_xcvr::set_lo_freq(
      * f_rf = f_vco/RFdiv)
      * f_actual = f_rf/2
      */
-    for(R = 1; R <= 1023; R+=1){
-        //PFD input frequency = f_ref/R ... ignoring Reference doubler/divide-by-2 (D & T)
-        pfd_freq = ref_freq*(1+D)/(R*(1+T));
-
-        //keep the PFD frequency at or below 25MHz (Loop Filter Bandwidth)
-        if (pfd_freq > 25e6) continue;
 
-        //ignore fractional part of tuning
-        N = int(std::floor(vco_freq/pfd_freq));
+    //the smallest R that keeps the PFD frequency at or below 25MHz (Loop Filter Bandwidth)
+    //PFD input frequency = f_ref/R ... ignoring Reference divide-by-2 (T)
+    R = std::max(1, int(std::ceil(ref_freq*(1+D)/25e6)));
+    pfd_freq = ref_freq*(1+D)/(R*(1+T));
 
-        //keep N > minimum int divider requirement
-        if (N < prescaler_to_min_int_div[prescaler]) continue;
+    //ignore fractional part of tuning
+    //N > minimum int divider requirement since f_vco >= 2.2GHz and f_pfd <= 25MHz
+    N = int(std::floor(vco_freq/pfd_freq));
+    UHD_ASSERT_THROW(N >= prescaler_to_min_int_div[prescaler]);
 
-        for(BS=1; BS <= 255; BS+=1){
-            //keep the band select frequency at or below 100KHz
-            //constraint on band select clock
-            if (pfd_freq/BS > 100e3) continue;
-            goto done_loop;
-        }
-    } done_loop:
+    //the smallest band select clock divider that keeps the band select frequency at or below 100KHz
+    BS = std::min(255, int(std::ceil(pfd_freq/100e3)));
 
     //Fractional-N calculation
     MOD = 4095; //max fractional accuracy
@@ -531,43 +591,89 @@ double sbx_xcvr::set_lo_freq(
 
     UHD_LOGV(often)
         << boost::format("SBX Intermediates: ref=%0.2f, outdiv=%f, fbdiv=%f") % (ref_freq*(1+int(D))/(R*(1+int(T)))) % double(RFdiv*2) % double(N + double(FRAC)/double(MOD)) << std::endl
-        << boost::format("SBX tune: R=%d, BS=%d, N=%d, FRAC=%d, MOD=%d, T=%d, D=%d, RFdiv=%d, LD=%d"
-            ) % R % BS % N % FRAC % MOD % T % D % RFdiv % get_locked(unit)<< std::endl
+        << boost::format("SBX tune: R=%d, BS=%d, N=%d, FRAC=%d, MOD=%d, T=%d, D=%d, RFdiv=%d"
+            ) % R % BS % N % FRAC % MOD % T % D % RFdiv << std::endl
         << boost::format("SBX Frequencies (MHz): REQ=%0.2f, ACT=%0.2f, VCO=%0.2f, PFD=%0.2f, BAND=%0.2f"
             ) % (target_freq/1e6) % (actual_freq/1e6) % (vco_freq/1e6) % (pfd_freq/1e6) % (pfd_freq/BS/1e6) << std::endl;
 
-    //load the register values
-    adf4350_regs_t regs;
+    lo_plan_t plan;
+    plan.ref_freq = ref_freq;
+    plan.actual_freq = actual_freq;
+    plan.R = R; plan.BS = BS; plan.N = N;
+    plan.FRAC = FRAC; plan.MOD = MOD; plan.RFdiv = RFdiv;
+    plan.prescaler = prescaler;
+    plan.T = T; plan.D = D;
+    return plan;
+}
+
+double sbx_xcvr::set_lo_freq(
+    dboard_iface::unit_t unit,
+    double target_freq
+){
+    UHD_LOGV(often) << boost::format(
+        "SBX tune: target frequency %f Mhz"
+    ) % (target_freq/1e6) << std::endl;
+
+    //clip the input
+    target_freq = sbx_freq_range.clip(target_freq);
+
+    //map rf divider select output dividers to enums
+    static const uhd::dict<int, adf4350_regs_t::rf_divider_select_t> rfdivsel_to_enum = map_list_of
+        (1,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV1)
+        (2,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV2)
+        (4,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV4)
+        (8,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV8)
+        (16, adf4350_regs_t::RF_DIVIDER_SELECT_DIV16)
+    ;
+
+    //reuse the dividers from an earlier tune to this frequency,
+    //so hopping over a fixed set of frequencies skips the search
+    uhd::dict<double, lo_plan_t> &plans = _lo_plans[unit];
+    const double ref_freq = this->get_iface()->get_clock_rate(unit);
+    if (not plans.has_key(target_freq) or plans[target_freq].ref_freq != ref_freq){
+        if (plans.size() >= MAX_LO_PLANS) plans = uhd::dict<double, lo_plan_t>();
+        plans[target_freq] = this->make_lo_plan(unit, target_freq);
+    }
+    const lo_plan_t plan = plans[target_freq];
+    const double actual_freq = plan.actual_freq;
+
+    //load the register values over the last ones written to this unit
+    adf4350_regs_t &regs = _lo_regs[unit];
+    const bool first_load = not regs.has_saved_state();
+    regs.save_state();
 
     if ((unit == dboard_iface::UNIT_TX) and (actual_freq == sbx_tx_lo_2dbm.clip(actual_freq))) 
         regs.output_power = adf4350_regs_t::OUTPUT_POWER_2DBM;
     else
         regs.output_power = adf4350_regs_t::OUTPUT_POWER_5DBM;
 
-    regs.frac_12_bit = FRAC;
-    regs.int_16_bit = N;
-    regs.mod_12_bit = MOD;
-    regs.prescaler = prescaler;
-    regs.r_counter_10_bit = R;
-    regs.reference_divide_by_2 = T;
-    regs.reference_doubler = D;
-    regs.band_select_clock_div = BS;
-    UHD_ASSERT_THROW(rfdivsel_to_enum.has_key(RFdiv));
-    regs.rf_divider_select = rfdivsel_to_enum[RFdiv];
+    regs.frac_12_bit = plan.FRAC;
+    regs.int_16_bit = plan.N;
+    regs.mod_12_bit = plan.MOD;
+    regs.prescaler = plan.prescaler;
+    regs.r_counter_10_bit = plan.R;
+    regs.reference_divide_by_2 = plan.T;
+    regs.reference_doubler = plan.D;
+    regs.band_select_clock_div = plan.BS;
+    UHD_ASSERT_THROW(rfdivsel_to_enum.has_key(plan.RFdiv));
+    regs.rf_divider_select = rfdivsel_to_enum[plan.RFdiv];
 
     //write the registers
     //correct power-up sequence to write registers (5, 4, 3, 2, 1, 0)
+    //after the first load, only write the registers that changed,
+    //but always finish with R0 since it starts the VCO band select
+    const std::set<int> changed_addrs = regs.get_changed_addrs<int>();
     int addr;
+    std::vector<boost::uint32_t> spi_regs;
 
     for(addr=5; addr>=0; addr--){
+        if (not first_load and addr != 0 and changed_addrs.count(addr) == 0) continue;
         UHD_LOGV(often) << boost::format(
             "SBX SPI Reg (0x%02x): 0x%08x"
         ) % addr % regs.get_reg(addr) << std::endl;
-        this->get_iface()->write_spi(
-            unit, spi_config_t::EDGE_RISE,
-            regs.get_reg(addr), 32
-        );
+        spi_regs.push_back(regs.get_reg(addr));
     }
+    this->get_iface()->write_spi_batch(unit, spi_config_t::EDGE_RISE, spi_regs, 32);
 
     //return the actual frequency
     UHD_LOGV(often) << boost::format(
@@ -575,211 +681,3 @@ double sbx_xcvr::set_lo_freq(
     ) % (actual_freq/1e6) << std::endl;
     return actual_freq;
 }
-
-/***********************************************************************
- * RX Get and Set
- **********************************************************************/
-void sbx_xcvr::rx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = get_rx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        assert_has(_rx_gains.keys(), key.name, "sbx rx gain name");
-        val = _rx_gains[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        assert_has(sbx_rx_gain_ranges.keys(), key.name, "sbx rx gain name");
-        val = sbx_rx_gain_ranges[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(sbx_rx_gain_ranges.keys());
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = _rx_lo_freq;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = sbx_freq_range;
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = _rx_ant;
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = sbx_rx_antennas;
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = SUBDEV_CONN_COMPLEX_IQ;
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = true; //always enabled
-        return;
-
-    case SUBDEV_PROP_SENSOR:
-        UHD_ASSERT_THROW(key.name == "lo_locked");
-        val = sensor_value_t("LO", this->get_locked(dboard_iface::UNIT_RX), "locked", "unlocked");
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = prop_names_t(1, "lo_locked");
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = 2*20.0e6; //20MHz low-pass, we want complex double-sided
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
-}
-
-void sbx_xcvr::rx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_FREQ:
-        this->set_rx_lo_freq(val.as<double>());
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        this->set_rx_gain(val.as<double>(), key.name);
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        this->set_rx_ant(val.as<std::string>());
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        return; //always enabled
-
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << "SBX: No tunable bandwidth, fixed filtered to 40MHz";
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
-}
-
-/***********************************************************************
- * TX Get and Set
- **********************************************************************/
-void sbx_xcvr::tx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = get_tx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        assert_has(_tx_gains.keys(), key.name, "sbx tx gain name");
-        val = _tx_gains[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        assert_has(sbx_tx_gain_ranges.keys(), key.name, "sbx tx gain name");
-        val = sbx_tx_gain_ranges[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(sbx_tx_gain_ranges.keys());
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = _tx_lo_freq;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = sbx_freq_range;
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = std::string("TX/RX");
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = sbx_tx_antennas;
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = SUBDEV_CONN_COMPLEX_QI;
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = true; //always enabled
-        return;
-
-    case SUBDEV_PROP_SENSOR:
-        UHD_ASSERT_THROW(key.name == "lo_locked");
-        val = sensor_value_t("LO", this->get_locked(dboard_iface::UNIT_TX), "locked", "unlocked");
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = prop_names_t(1, "lo_locked");
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = 2*20.0e6; //20MHz low-pass, we want complex double-sided
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
-}
-
-void sbx_xcvr::tx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_FREQ:
-        this->set_tx_lo_freq(val.as<double>());
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        this->set_tx_gain(val.as<double>(), key.name);
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        this->set_tx_ant(val.as<std::string>());
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        return; //always enabled
-
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << "SBX: No tunable bandwidth, fixed filtered to 40MHz";
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
-}
@@ -39,6 +39,7 @@
 #include <uhd/usrp/dboard_manager.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
 #include <boost/thread.hpp>
 #include <boost/array.hpp>
 #include <boost/math/special_functions/round.hpp>
@@ -128,6 +129,16 @@ static const double tvrx_if_freq = 43.75e6; //IF freq of TVRX module
 static const boost::uint16_t reference_divider = 640; //clock reference divider to use
 static const double reference_freq = 4.0e6;
 
+static std::string coerce_antenna(const std::string &ant){
+    assert_has(tvrx_antennas, ant, "TVRX antenna name");
+    return ant;
+}
+
+static double coerce_fixed_bandwidth(double){
+    UHD_MSG(warning) << "TVRX: No tunable bandwidth, fixed filtered to 6MHz";
+    return 6.0e6;
+}
+
 /***********************************************************************
  * The tvrx dboard class
  **********************************************************************/
@@ -136,9 +147,6 @@ public:
     tvrx(ctor_args_t args);
     ~tvrx(void);
 
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
-
 private:
     uhd::dict<std::string, double> _gains;
     double _lo_freq;
@@ -147,8 +155,9 @@ private:
         return (this->get_iface()->get_special_props().mangle_i2c_addrs)? 0x61 : 0x60; //ok really? we could rename that call
     };
 
-    void set_gain(double gain, const std::string &name);
+    double set_gain(double gain, const std::string &name);
     void set_freq(double freq);
+    double get_freq(void);
 
     void update_regs(void){
         byte_vector_t regs_vector(4);
@@ -198,14 +207,39 @@ tvrx::tvrx(ctor_args_t args) : rx_dboard_base(args){
 
     //send initial register settings if necessary
 
-    //set default freq
+    ////////////////////////////////////////////////////////////////////
+    // Register properties, the sets apply the defaults
+    ////////////////////////////////////////////////////////////////////
     _lo_freq = tvrx_freq_range.start() + tvrx_if_freq; //init _lo_freq to a sane default
-    set_freq(tvrx_freq_range.start());
-
-    //set default gains
+    this->get_rx_subtree()->create<std::string>("name")
+        .set(get_rx_id().to_pp_string());
+    this->get_rx_subtree()->create<int>("sensors"); //phony property so this dir exists
+    //the tuned frequency depends on the codec rate, so it is read back
+    this->get_rx_subtree()->create<double>("freq/value")
+        .publish(boost::bind(&tvrx::get_freq, this))
+        .subscribe(boost::bind(&tvrx::set_freq, this, _1))
+        .set(tvrx_freq_range.start());
+    this->get_rx_subtree()->create<meta_range_t>("freq/range")
+        .set(tvrx_freq_range);
     BOOST_FOREACH(const std::string &name, get_tvrx_gain_ranges().keys()){
-        set_gain(get_tvrx_gain_ranges()[name].start(), name);
+        this->get_rx_subtree()->create<double>("gains/"+name+"/value")
+            .coerce(boost::bind(&tvrx::set_gain, this, _1, name))
+            .set(get_tvrx_gain_ranges()[name].start());
+        this->get_rx_subtree()->create<meta_range_t>("gains/"+name+"/range")
+            .set(get_tvrx_gain_ranges()[name]);
     }
+    this->get_rx_subtree()->create<std::string>("antenna/value")
+        .coerce(&coerce_antenna)
+        .set(tvrx_antennas.front()); //there's only one
+    this->get_rx_subtree()->create<std::vector<std::string> >("antenna/options")
+        .set(tvrx_antennas);
+    this->get_rx_subtree()->create<std::string>("connection").set("I");
+    this->get_rx_subtree()->create<bool>("enabled").set(true); //always enabled
+    this->get_rx_subtree()->create<bool>("use_lo_offset").set(false);
+    create_coerced<double>(this->get_rx_subtree(), "bandwidth/value",
+        6.0e6,
+        &coerce_fixed_bandwidth
+    );
 }
 
 tvrx::~tvrx(void){
@@ -317,7 +351,7 @@ static double if_gain_to_voltage(double gain){
     return dac_volts;
 }
 
-void tvrx::set_gain(double gain, const std::string &name){
+double tvrx::set_gain(double gain, const std::string &name){
     assert_has(get_tvrx_gain_ranges().keys(), name, "tvrx gain name");
     if (name == "RF"){
         this->get_iface()->write_aux_dac(dboard_iface::UNIT_RX, dboard_iface::AUX_DAC_B, rf_gain_to_voltage(gain, _lo_freq));
@@ -327,6 +361,7 @@ void tvrx::set_gain(double gain, const std::string &name){
     }
     else UHD_THROW_INVALID_CODE_PATH();
     _gains[name] = gain;
+    return gain;
 }
 
 /*!
@@ -388,110 +423,22 @@ static double get_alias(double freq, double fs) {
 }
 
 /***********************************************************************
- * RX Get and Set
+ * Get the tuned frequency
  **********************************************************************/
-void tvrx::rx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-    double codec_rate;
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = get_rx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        assert_has(_gains.keys(), key.name, "tvrx gain name");
-        val = _gains[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        assert_has(get_tvrx_gain_ranges().keys(), key.name, "tvrx gain name");
-        val = get_tvrx_gain_ranges()[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(get_tvrx_gain_ranges().keys());
-        return;
-
-    case SUBDEV_PROP_FREQ:
+double tvrx::get_freq(void){
     /*
      * so here we have to do some magic. because the TVRX uses a relatively high IF,
      * we have to watch the sample rate to see if the IF will be aliased
      * or if it will fall within Nyquist.
      */
-        codec_rate = this->get_iface()->get_codec_rate(dboard_iface::UNIT_RX);
-        val = (_lo_freq - tvrx_if_freq) + get_alias(tvrx_if_freq, codec_rate);
-        UHD_LOGV(often)
-            << "Getting TVRX freq..." << std::endl
-            << "\tCodec rate: " << codec_rate << std::endl
-            << "\tLO freq: " << _lo_freq << std::endl
-            << "\tIF freq: " << tvrx_if_freq << std::endl
-            << "\tAlias freq: " << get_alias(tvrx_if_freq, codec_rate) << std::endl
-            << "\tCalculated freq: " << val.as<double>() << std::endl;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = tvrx_freq_range;
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = tvrx_antennas.front(); //there's only one
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = tvrx_antennas;
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = SUBDEV_CONN_REAL_I;
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = true; //always enabled
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = 6.0e6;
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = std::vector<std::string>(); //empty
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
-}
-
-void tvrx::rx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_GAIN:
-        this->set_gain(val.as<double>(), key.name);
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        this->set_freq(val.as<double>());
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        return; //always enabled
-
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << "TVRX: No tunable bandwidth, fixed filtered to 6MHz";
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
+    const double codec_rate = this->get_iface()->get_codec_rate(dboard_iface::UNIT_RX);
+    const double freq = (_lo_freq - tvrx_if_freq) + get_alias(tvrx_if_freq, codec_rate);
+    UHD_LOGV(often)
+        << "Getting TVRX freq..." << std::endl
+        << "\tCodec rate: " << codec_rate << std::endl
+        << "\tLO freq: " << _lo_freq << std::endl
+        << "\tIF freq: " << tvrx_if_freq << std::endl
+        << "\tAlias freq: " << get_alias(tvrx_if_freq, codec_rate) << std::endl
+        << "\tCalculated freq: " << freq << std::endl;
+    return freq;
 }
-
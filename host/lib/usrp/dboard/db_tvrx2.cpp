@@ -63,6 +63,7 @@
 #include <uhd/usrp/dboard_manager.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
 #include <boost/thread.hpp>
 #include <boost/array.hpp>
 #include <boost/math/special_functions/round.hpp>
@@ -709,9 +710,9 @@ static const uhd::dict<std::string, std::string> tvrx2_sd_name_to_antennas = map
     ("RX2", "J140")
 ;
 
-static const uhd::dict<std::string, subdev_conn_t> tvrx2_sd_name_to_conn = map_list_of
-    ("RX1",  SUBDEV_CONN_REAL_Q)
-    ("RX2",  SUBDEV_CONN_REAL_I)
+static const uhd::dict<std::string, std::string> tvrx2_sd_name_to_conn = map_list_of
+    ("RX1",  "Q")
+    ("RX2",  "I")
 ;
 
 static const uhd::dict<std::string, boost::uint8_t> tvrx2_sd_name_to_i2c_addr = map_list_of
@@ -745,33 +746,36 @@ public:
     tvrx2(ctor_args_t args);
     ~tvrx2(void);
 
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
-
 private:
     double _freq_scalar;
     double _lo_freq;
     double _if_freq;
     double _bandwidth;
-    uhd::dict<std::string, double> _gains;
     tda18272hnm_regs_t _tda18272hnm_regs;
     uhd::dict<boost::uint32_t, tvrx2_tda18272_rfcal_result_t> _rfcal_results;
     uhd::dict<boost::uint32_t, tvrx2_tda18272_rfcal_coeffs_t> _rfcal_coeffs;
 
+    //register values last sent to or read from the tuner
+    uhd::dict<boost::uint8_t, boost::uint8_t> _reg_shadow;
+
+    //rfcal_freq registers read since the last calibration
+    bool _rfcal_freqs_cached;
+
     bool _enabled;
 
-    void set_enabled(void);
+    bool set_enabled(bool enb);
     void set_disabled(void);
 
-    void set_lo_freq(double target_freq);
-    void set_gain(double gain, const std::string &name);
-    void set_bandwidth(double bandwidth);
+    double set_lo_freq(double target_freq);
+    double set_gain(double gain, const std::string &name);
+    double set_bandwidth(double bandwidth);
 
     void set_scaled_rf_freq(double rf_freq);
     double get_scaled_rf_freq(void);
     void set_scaled_if_freq(double if_freq);
     double get_scaled_if_freq(void);
     void send_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg);
+    void update_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg);
     void read_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg);
 
     freq_range_t get_tda18272_rfcal_result_freq_range(boost::uint32_t result);
@@ -826,9 +830,9 @@ private:
 
     /*!
      * Is the LO locked?
-     * \return true for locked
+     * \return the lo locked sensor
      */
-    bool get_locked(void){
+    sensor_value_t get_locked(void){
         read_reg(0x5, 0x5);
 
         //return lock detect
@@ -838,14 +842,14 @@ private:
             "TVRX2 (%s): locked %d"
         ) % (get_subdev_name()) % locked << std::endl;
 
-        return locked;
+        return sensor_value_t("LO", locked, "locked", "unlocked");
     }
 
     /*!
      * Read the RSSI from the registers
-     * \return the rssi in dB(m?) FIXME
+     * \return the rssi sensor in dB(m?) FIXME
      */
-    double get_rssi(void){
+    sensor_value_t get_rssi(void){
         //Launch RSSI calculation with MSM statemachine
         _tda18272hnm_regs.set_reg(0x19, 0x80); //set MSM_byte_1 for rssi calculation
         _tda18272hnm_regs.set_reg(0x1A, 0x01); //set MSM_byte_2 for launching rssi calculation
@@ -859,14 +863,15 @@ private:
 
         //calculate the rssi from the voltage
         double rssi_dBuV = 40.0 + double(((110.0 - 40.0)/128.0) * _tda18272hnm_regs.get_reg(0x7));
-        return rssi_dBuV - 107.0; //convert to dBm in 50ohm environment ( -108.8 if 75ohm ) FIXME
+        double rssi = rssi_dBuV - 107.0; //convert to dBm in 50ohm environment ( -108.8 if 75ohm ) FIXME
+        return sensor_value_t("RSSI", rssi, "dBm");
     }
 
     /*!
      * Read the Temperature from the registers
-     * \return the temp in degC
+     * \return the temp sensor in degC
      */
-    double get_temp(void){
+    sensor_value_t get_temp(void){
         //Enable Temperature reading
         _tda18272hnm_regs.tm_on = tda18272hnm_regs_t::TM_ON_SENSOR_ON;
         send_reg(0x4, 0x4);
@@ -882,10 +887,14 @@ private:
         _tda18272hnm_regs.tm_on = tda18272hnm_regs_t::TM_ON_SENSOR_OFF;
         send_reg(0x4, 0x4);
 
-        return (double(_tda18272hnm_regs.tm_d));
+        return sensor_value_t("TEMP", double(_tda18272hnm_regs.tm_d), "degC");
     }
 };
 
+static std::string coerce_fixed_antenna(const std::string &, const std::string &antenna){
+    return antenna; //there is one antenna per subdev, a set changes nothing
+}
+
 /***********************************************************************
  * Register the TVRX2 dboard
  **********************************************************************/
@@ -985,6 +994,8 @@ tvrx2::tvrx2(ctor_args_t args) : rx_dboard_base(args){
 
     _lo_freq = tvrx2_freq_range.start();
 
+    _rfcal_freqs_cached = false;
+
     _enabled = false;
 
     //send initial register settings
@@ -1011,9 +1022,54 @@ tvrx2::tvrx2(ctor_args_t args) : rx_dboard_base(args){
     //soft_calibration();
     //tvrx2_tda18272_init_rfcal();
     transition_0();
+
+    ////////////////////////////////////////////////////////////////////
+    // Register properties:
+    //   The tuner is programmed when it is enabled,
+    //   so the coercers are registered after the defaults.
+    ////////////////////////////////////////////////////////////////////
+    this->get_rx_subtree()->create<std::string>("name")
+        .set(get_rx_id().to_pp_string());
+    this->get_rx_subtree()->create<sensor_value_t>("sensors/lo_locked")
+        .publish(boost::bind(&tvrx2::get_locked, this));
+    this->get_rx_subtree()->create<sensor_value_t>("sensors/rssi")
+        .publish(boost::bind(&tvrx2::get_rssi, this));
+    this->get_rx_subtree()->create<sensor_value_t>("sensors/temperature")
+        .publish(boost::bind(&tvrx2::get_temp, this));
+    BOOST_FOREACH(const std::string &name, tvrx2_gain_ranges.keys()){
+        this->get_rx_subtree()->create<double>("gains/"+name+"/value")
+            .set(tvrx2_gain_ranges[name].start())
+            .coerce(boost::bind(&tvrx2::set_gain, this, _1, name));
+        this->get_rx_subtree()->create<meta_range_t>("gains/"+name+"/range")
+            .set(tvrx2_gain_ranges[name]);
+    }
+    this->get_rx_subtree()->create<double>("freq/value")
+        .set(_lo_freq)
+        .coerce(boost::bind(&tvrx2::set_lo_freq, this, _1));
+    this->get_rx_subtree()->create<meta_range_t>("freq/range")
+        .set(tvrx2_freq_range);
+    this->get_rx_subtree()->create<std::string>("antenna/value")
+        .set(tvrx2_sd_name_to_antennas[get_subdev_name()])
+        .coerce(boost::bind(&coerce_fixed_antenna, _1, tvrx2_sd_name_to_antennas[get_subdev_name()]));
+    this->get_rx_subtree()->create<std::vector<std::string> >("antenna/options")
+        .set(prop_names_t(1, tvrx2_sd_name_to_antennas[get_subdev_name()]));
+    this->get_rx_subtree()->create<std::string>("connection")
+        .set(tvrx2_sd_name_to_conn[get_subdev_name()]);
+    this->get_rx_subtree()->create<bool>("enabled")
+        .set(_enabled)
+        .coerce(boost::bind(&tvrx2::set_enabled, this, _1));
+    this->get_rx_subtree()->create<bool>("use_lo_offset").set(false);
+    this->get_rx_subtree()->create<double>("bandwidth/value")
+        .set(_bandwidth)
+        .coerce(boost::bind(&tvrx2::set_bandwidth, this, _1));
 }
 
-void tvrx2::set_enabled(void){
+bool tvrx2::set_enabled(bool enb){
+    if (not enb){
+        this->set_disabled();
+        return _enabled;
+    }
+
     //setup tuner parameters
     transition_1();
 
@@ -1021,18 +1077,23 @@ void tvrx2::set_enabled(void){
 
     test_rf_filter_robustness();
 
+    //the sets keep the properties in step with the tuner
     BOOST_FOREACH(const std::string &name, tvrx2_gain_ranges.keys()){
-        set_gain(tvrx2_gain_ranges[name].start(), name);
+        this->get_rx_subtree()->access<double>("gains/"+name+"/value")
+            .set(tvrx2_gain_ranges[name].start());
     }
 
-    set_bandwidth(_bandwidth); // default bandwidth from datasheet
+    this->get_rx_subtree()->access<double>("bandwidth/value")
+        .set(_bandwidth); // default bandwidth from datasheet
 
     //transition_2 equivalent
-    set_lo_freq(tvrx2_freq_range.start());
+    this->get_rx_subtree()->access<double>("freq/value")
+        .set(tvrx2_freq_range.start());
 
     //enter standby mode
     transition_3();
     _enabled = true;
+    return _enabled;
 }
 
 tvrx2::~tvrx2(void){
@@ -1084,6 +1145,7 @@ void tvrx2::send_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg){
         //get the register data
         for(int i=0; i<num_bytes; i++){
             regs_vector[1+i] = _tda18272hnm_regs.get_reg(start_addr+i);
+            _reg_shadow[start_addr+i] = regs_vector[1+i];
             UHD_LOGV(often) << boost::format(
                 "TVRX2 (%s, 0x%02x): send reg 0x%02x, value 0x%04x, start_addr = 0x%04x, num_bytes %d"
             ) % (get_subdev_name()) % int(tvrx2_sd_name_to_i2c_addr[get_subdev_name()]) % int(start_addr+i) % int(regs_vector[1+i]) % int(start_addr) % num_bytes << std::endl;
@@ -1096,6 +1158,30 @@ void tvrx2::send_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg){
     }
 }
 
+/*!
+ * Send only the registers in the range that differ from the shadow,
+ * each run of changed registers goes out in one send_reg() call.
+ * Use send_reg() for registers that the tuner changes on its own
+ * or that launch an action when written.
+ */
+void tvrx2::update_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg){
+    start_reg = boost::uint8_t(uhd::clip(int(start_reg), 0x0, 0x43));
+    stop_reg = boost::uint8_t(uhd::clip(int(stop_reg), 0x0, 0x43));
+
+    int run_start = -1;
+    for(int addr = start_reg; addr <= stop_reg + 1; addr++){
+        bool changed = addr <= stop_reg and (
+            not _reg_shadow.has_key(addr) or
+            _reg_shadow[addr] != _tda18272hnm_regs.get_reg(addr)
+        );
+        if (changed and run_start < 0) run_start = addr;
+        if (not changed and run_start >= 0){
+            send_reg(boost::uint8_t(run_start), boost::uint8_t(addr - 1));
+            run_start = -1;
+        }
+    }
+}
+
 void tvrx2::read_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg){
     static const boost::uint8_t status_addr = 0x0;
     start_reg = boost::uint8_t(uhd::clip(int(start_reg), 0x0, 0x43));
@@ -1127,6 +1213,7 @@ void tvrx2::read_reg(boost::uint8_t start_reg, boost::uint8_t stop_reg){
             if (i + start_addr >= status_addr){
                 _tda18272hnm_regs.set_reg(i + start_addr, regs_vector[i]);
             }
+            _reg_shadow[i + start_addr] = regs_vector[i];
             UHD_LOGV(often) << boost::format(
                 "TVRX2 (%s, 0x%02x): read reg 0x%02x, value 0x%04x, start_addr = 0x%04x, num_bytes %d"
             ) % (get_subdev_name()) % int(tvrx2_sd_name_to_i2c_addr[get_subdev_name()]) % int(start_addr+i) % int(regs_vector[i]) % int(start_addr) % num_bytes << std::endl;
@@ -1266,8 +1353,11 @@ void tvrx2::tvrx2_tda18272_tune_rf_filter(boost::uint32_t uRF)
     boost::int32_t                   RF_B1 = 0;
     freq_range_t                     subband_freqs;
 
-    /* read byte 0x26-0x2B */
-    read_reg(0x26, 0x2B);
+    /* read byte 0x26-0x2B, once per calibration */
+    if (not _rfcal_freqs_cached){
+        read_reg(0x26, 0x2B);
+        _rfcal_freqs_cached = true;
+    }
 
     subband_freqs = get_tda18272_rfcal_result_freq_range(1);
     uRFCal0 = subband_freqs.start();
@@ -1373,6 +1463,7 @@ void tvrx2::soft_calibration(void){
     _tda18272hnm_regs.set_reg(0x1A, 0x01); //set MSM_byte_2 for launching calibration
 
     send_reg(0x19, 0x1A);
+    _rfcal_freqs_cached = false;
 
     wait_irq();
 
@@ -1496,6 +1587,7 @@ void tvrx2::transition_0(void){
         _tda18272hnm_regs.set_reg(0x1A, 0x01); //set MSM_byte_2 for launching calibration
 
         send_reg(0x19, 0x1A);
+        _rfcal_freqs_cached = false;
 
         wait_irq();
     }
@@ -1536,7 +1628,7 @@ void tvrx2::transition_1(void){
         "\nTVRX2 (%s): Transistion 1: Select TV Standard\n") % (get_subdev_name()) << std::endl;
 
     //send magic xtal_cal_dac setting
-    send_reg(0x65, 0x65);
+    update_reg(0x65, 0x65);
 
     //Choose IF Byte 1 Setting
     //_tda18272hnm_regs.if_hp_fc = tda18272hnm_regs_t::IF_HP_FC_0_4MHZ;
@@ -1548,17 +1640,17 @@ void tvrx2::transition_1(void){
     //Choose IR Mixer Byte 2 Setting
     //_tda18272hnm_regs.hi_pass = tda18272hnm_regs_t::HI_PASS_DISABLE;
     //_tda18272hnm_regs.dc_notch = tda18272hnm_regs_t::DC_NOTCH_OFF;
-    send_reg(0x23, 0x23);
+    update_reg(0x23, 0x23);
 
     //Set AGC TOP Bytes
-    send_reg(0x0C, 0x13);
+    update_reg(0x0C, 0x13);
 
     //Set PSM Byt1
-    send_reg(0x1B, 0x1B);
+    update_reg(0x1B, 0x1B);
 
     //Choose IF Frequency, setting is 50KHz steps
     set_scaled_if_freq(_if_freq);
-    send_reg(0x15, 0x15);
+    update_reg(0x15, 0x15);
 }
 
 void tvrx2::transition_2(int rf_freq){
@@ -1567,7 +1659,7 @@ void tvrx2::transition_2(int rf_freq){
         "\nTVRX2 (%s): Transistion 2: Select RF Frequency after changing TV Standard\n") % (get_subdev_name()) << std::endl;
 
     //send magic xtal_cal_dac setting
-    send_reg(0x65, 0x65);
+    update_reg(0x65, 0x65);
 
     //Wake up from Standby
     _tda18272hnm_regs.sm = tda18272hnm_regs_t::SM_NORMAL;
@@ -1578,7 +1670,7 @@ void tvrx2::transition_2(int rf_freq){
     
     //Set Clock Mode
     _tda18272hnm_regs.set_reg(0x36, 0x00);
-    send_reg(0x36, 0x36);
+    update_reg(0x36, 0x36);
     
     //Set desired RF Frequency
     set_scaled_rf_freq(rf_freq);
@@ -1605,11 +1697,11 @@ void tvrx2::transition_3(void){
         "\nTVRX2 (%s): Transistion 3: Standby Mode\n") % (get_subdev_name()) << std::endl;
 
     //send magic xtal_cal_dac setting
-    send_reg(0x65, 0x65);
+    update_reg(0x65, 0x65);
 
     //Set clock mode
     _tda18272hnm_regs.set_reg(0x36, 0x0E);
-    send_reg(0x36, 0x36);
+    update_reg(0x36, 0x36);
 
     //go to standby mode
     _tda18272hnm_regs.sm = tda18272hnm_regs_t::SM_STANDBY;
@@ -1624,7 +1716,7 @@ void tvrx2::transition_4(int rf_freq){
         "\nTVRX2 (%s): Transistion 4: Change RF Frequency without changing TV Standard\n") % (get_subdev_name()) << std::endl;
 
     //send magic xtal_cal_dac setting
-    send_reg(0x65, 0x65);
+    update_reg(0x65, 0x65);
 
     //Set desired RF Frequency
     set_scaled_rf_freq(rf_freq);
@@ -1646,16 +1738,17 @@ void tvrx2::transition_4(int rf_freq){
 }
 
 void tvrx2::wait_irq(void){
-    int timeout = 20; //irq waiting timeout in milliseconds
+    int timeout = 200; //irq waiting timeout in milliseconds
     //int irq = (this->get_iface()->read_gpio(dboard_iface::UNIT_RX) & int(tvrx2_sd_name_to_irq_io[get_subdev_name()]));
     bool irq = get_irq();
     UHD_LOGV(often) << boost::format(
         "\nTVRX2 (%s): Waiting on IRQ, subdev = %d, mask = 0x%x, Status: 0x%x\n") % (get_subdev_name()) % get_subdev_name() % (int(tvrx2_sd_name_to_irq_io[get_subdev_name()])) % irq << std::endl;
 
     while (not irq and timeout > 0) {
+        //poll finely, the tuning actions finish in a few milliseconds
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
         //irq = (this->get_iface()->read_gpio(dboard_iface::UNIT_RX) & tvrx2_sd_name_to_irq_io[get_subdev_name()]);
         irq = get_irq();
-        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
         timeout -= 1;
     }
 
@@ -1682,7 +1775,7 @@ void tvrx2::wait_irq(void){
 /***********************************************************************
  * Tuning
  **********************************************************************/
-void tvrx2::set_lo_freq(double target_freq){
+double tvrx2::set_lo_freq(double target_freq){
     //target_freq = std::clip(target_freq, tvrx2_freq_range.min, tvrx2_freq_range.max);
 
     read_reg(0x6, 0x6);
@@ -1705,13 +1798,11 @@ void tvrx2::set_lo_freq(double target_freq){
         "\tReadback: \t%f\n"
         "\tIF Frequency: \t%f\n") % (get_subdev_name()) % target_freq % double(int(target_freq/1e3)*1e3) % get_scaled_rf_freq() % get_scaled_if_freq() << std::endl;
 
-    get_locked();
-
-    test_rf_filter_robustness();
+    //the lock, rssi, and filter robustness are not measured on every tune:
+    //the rssi launches another tuner action and the robustness only changes
+    //with a calibration; read the lo_locked and rssi sensors instead
 
-    UHD_LOGV(often) << boost::format(
-        "\nTVRX2 (%s): RSSI = %f dBm\n"
-    ) % (get_subdev_name()) % (get_rssi()) << std::endl;
+    return _lo_freq;
 }
 
 /***********************************************************************
@@ -1741,7 +1832,7 @@ static double gain_to_if_gain_dac(double &gain){
     return dac_volts;
 }
 
-void tvrx2::set_gain(double gain, const std::string &name){
+double tvrx2::set_gain(double gain, const std::string &name){
     assert_has(tvrx2_gain_ranges.keys(), name, "tvrx2 gain name");
 
     if (name == "IF"){
@@ -1750,8 +1841,7 @@ void tvrx2::set_gain(double gain, const std::string &name){
     }
     else UHD_THROW_INVALID_CODE_PATH();
 
-    //shadow gain setting
-    _gains[name] = gain;
+    return gain;
 }
 
 /***********************************************************************
@@ -1780,7 +1870,7 @@ static tda18272hnm_regs_t::lp_fc_t bandwidth_to_lp_fc_reg(double &bandwidth){
     UHD_THROW_INVALID_CODE_PATH();
 }
 
-void tvrx2::set_bandwidth(double bandwidth){
+double tvrx2::set_bandwidth(double bandwidth){
     //compute low pass cutoff frequency setting
     _tda18272hnm_regs.lp_fc = bandwidth_to_lp_fc_reg(bandwidth);
 
@@ -1793,119 +1883,6 @@ void tvrx2::set_bandwidth(double bandwidth){
     UHD_LOGV(often) << boost::format(
         "TVRX2 (%s) Bandwidth (lp_fc): %f Hz, reg: %d"
     ) % (get_subdev_name()) % _bandwidth % (int(_tda18272hnm_regs.lp_fc)) << std::endl;
-}
-
-/***********************************************************************
- * RX Get and Set
- **********************************************************************/
-void tvrx2::rx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = get_rx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        assert_has(_gains.keys(), key.name, "tvrx2 gain name");
-        val = _gains[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        assert_has(tvrx2_gain_ranges.keys(), key.name, "tvrx2 gain name");
-        val = tvrx2_gain_ranges[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(tvrx2_gain_ranges.keys());
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = _lo_freq;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = tvrx2_freq_range;
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = tvrx2_sd_name_to_antennas[get_subdev_name()];
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = prop_names_t(1, tvrx2_sd_name_to_antennas[get_subdev_name()]);
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = tvrx2_sd_name_to_conn[get_subdev_name()];
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = _enabled;
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_SENSOR:
-        if (key.name == "lo_locked")
-            val = sensor_value_t("LO", this->get_locked(), "locked", "unlocked");
-        else if (key.name == "rssi")
-            val = sensor_value_t("RSSI", this->get_rssi(), "dBm");
-        else if (key.name == "temperature")
-            val = sensor_value_t("TEMP", this->get_temp(), "degC");
-        else
-            UHD_THROW_INVALID_CODE_PATH();
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:{
-            prop_names_t names = list_of("lo_locked")("rssi")("temperature");
-            val = names;
-        }
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = _bandwidth;
-        return;
 
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
+    return _bandwidth;
 }
-
-void tvrx2::rx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_FREQ:
-        this->set_lo_freq(val.as<double>());
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        this->set_gain( val.as<double>(), key.name);
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        if ((val.as<bool>())) this->set_enabled();
-        else if (not (val.as<bool>())) this->set_disabled();
-
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        this->set_bandwidth(val.as<double>());
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
-}
-
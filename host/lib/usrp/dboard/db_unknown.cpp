@@ -64,17 +64,11 @@ static void warn_if_old_rfx(const dboard_id_t &dboard_id, const std::string &xx)
 class unknown_rx : public rx_dboard_base{
 public:
     unknown_rx(ctor_args_t args);
-
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
 };
 
 class unknown_tx : public tx_dboard_base{
 public:
     unknown_tx(ctor_args_t args);
-
-    void tx_get(const wax::obj &key, wax::obj &val);
-    void tx_set(const wax::obj &key, const wax::obj &val);
 };
 
 /***********************************************************************
@@ -94,103 +88,52 @@ UHD_STATIC_BLOCK(reg_unknown_dboards){
 }
 
 /***********************************************************************
- * Unknown RX dboard
+ * The properties of the unknown boards:
+ *   The settings are fixed, the coercers keep them that way.
  **********************************************************************/
-unknown_rx::unknown_rx(ctor_args_t args) : rx_dboard_base(args){
-    warn_if_old_rfx(this->get_rx_id(), "RX");
+static double coerce_zero_freq(double){
+    return double(0); // it wont do you much good, but you can set it
 }
 
-void unknown_rx::rx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = "Unknown - " + get_rx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        val = double(0);
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        val = gain_range_t(0, 0, 0);
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = double(0);
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = freq_range_t(0.0, 0.0);
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = std::string("");
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = prop_names_t(1, ""); //vector of 1 empty string
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = std::vector<std::string>(); //empty
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = SUBDEV_CONN_COMPLEX_IQ;
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = true; //always enabled
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = 0.0;
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
+static std::string coerce_no_antenna(const std::string &ant){
+    if (ant.empty()) return ant;
+    throw uhd::value_error("Unknown Daughterboard: No selectable antenna");
 }
 
-void unknown_rx::rx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_GAIN:
-        UHD_ASSERT_THROW(val.as<double>() == double(0));
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        if (val.as<std::string>().empty()) return;
-        throw uhd::value_error("Unknown Daughterboard: No selectable antenna");
-
-    case SUBDEV_PROP_FREQ:
-        return; // it wont do you much good, but you can set it
-
-    case SUBDEV_PROP_ENABLED:
-        return; //always enabled
+static double coerce_no_bandwidth(double){
+    UHD_MSG(warning) << "Unknown Daughterboard: No tunable bandwidth, fixed filtered to 0.0MHz";
+    return 0.0;
+}
 
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << "Unknown Daughterboard: No tunable bandwidth, fixed filtered to 0.0MHz";
-        return;
+static void populate_unknown_props(property_tree::sptr subtree, const dboard_id_t &dboard_id){
+    subtree->create<std::string>("name").set("Unknown - " + dboard_id.to_pp_string());
+    subtree->create<int>("sensors"); //phony property so this dir exists
+    subtree->create<int>("gains"); //phony property so this dir exists
+    subtree->create<double>("freq/value")
+        .coerce(&coerce_zero_freq)
+        .set(double(0));
+    subtree->create<meta_range_t>("freq/range")
+        .set(freq_range_t(0.0, 0.0));
+    subtree->create<std::string>("antenna/value")
+        .coerce(&coerce_no_antenna)
+        .set("");
+    subtree->create<std::vector<std::string> >("antenna/options")
+        .set(prop_names_t(1, "")); //vector of 1 empty string
+    subtree->create<std::string>("connection").set("IQ");
+    subtree->create<bool>("enabled").set(true); //always enabled
+    subtree->create<bool>("use_lo_offset").set(false);
+    dboard_base::create_coerced<double>(subtree, "bandwidth/value",
+        0.0,
+        &coerce_no_bandwidth
+    );
+}
 
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
+/***********************************************************************
+ * Unknown RX dboard
+ **********************************************************************/
+unknown_rx::unknown_rx(ctor_args_t args) : rx_dboard_base(args){
+    warn_if_old_rfx(this->get_rx_id(), "RX");
+    populate_unknown_props(this->get_rx_subtree(), this->get_rx_id());
 }
 
 /***********************************************************************
@@ -198,97 +141,5 @@ void unknown_rx::rx_set(const wax::obj &key_, const wax::obj &val){
  **********************************************************************/
 unknown_tx::unknown_tx(ctor_args_t args) : tx_dboard_base(args){
     warn_if_old_rfx(this->get_tx_id(), "TX");
-}
-
-void unknown_tx::tx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = "Unknown - " + get_tx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        val = double(0);
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        val = gain_range_t(0, 0, 0);
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = double(0);
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = freq_range_t(0.0, 0.0);
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = std::string("");
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = prop_names_t(1, ""); //vector of 1 empty string
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = std::vector<std::string>(); //empty
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = SUBDEV_CONN_COMPLEX_IQ;
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = true; //always enabled
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = 0.0;
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
-}
-
-void unknown_tx::tx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_GAIN:
-        UHD_ASSERT_THROW(val.as<double>() == double(0));
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        if (val.as<std::string>().empty()) return;
-        throw uhd::value_error("Unknown Daughterboard: No selectable antenna");
-
-    case SUBDEV_PROP_FREQ:
-        return; // it wont do you much good, but you can set it
-
-    case SUBDEV_PROP_ENABLED:
-        return; //always enabled
-
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << "Unknown Daughterboard: No tunable bandwidth, fixed filtered to 0.0MHz";
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
+    populate_unknown_props(this->get_tx_subtree(), this->get_tx_id());
 }
@@ -69,6 +69,7 @@
 #include <uhd/usrp/dboard_base.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
 #include <boost/math/special_functions/round.hpp>
 
 using namespace uhd;
@@ -78,6 +79,9 @@ using namespace boost::assign;
 /***********************************************************************
  * The WBX Common dboard constants
  **********************************************************************/
+//the number of cached divider plans per unit before the cache starts over
+static const size_t MAX_LO_PLANS = 256;
+
 static const uhd::dict<std::string, gain_range_t> wbx_tx_gain_ranges = map_list_of
     ("PGA0", gain_range_t(0, 25, 0.05))
 ;
@@ -90,6 +94,11 @@ static const uhd::dict<std::string, gain_range_t> wbx_rx_gain_ranges = map_list_
     ("PGA0", gain_range_t(0, 31.5, 0.5))
 ;
 
+static double coerce_fixed_bandwidth(double){
+    UHD_MSG(warning) << "WBX: No tunable bandwidth, fixed filtered to 40MHz";
+    return 2*20.0e6; //20MHz low-pass, we want complex double-sided
+}
+
 /***********************************************************************
  * WBX Common Implementation
  **********************************************************************/
@@ -120,23 +129,49 @@ wbx_base::wbx_base(ctor_args_t args) : xcvr_dboard_base(args){
     this->get_iface()->set_atr_reg(dboard_iface::UNIT_RX, dboard_iface::ATR_REG_RX_ONLY,     RX_MIXER_ENB, RX_MIXER_DIS | RX_MIXER_ENB);
     this->get_iface()->set_atr_reg(dboard_iface::UNIT_RX, dboard_iface::ATR_REG_FULL_DUPLEX, RX_MIXER_ENB, RX_MIXER_DIS | RX_MIXER_ENB);
 
-    //set some default values
-    if (is_v3()) {
-        BOOST_FOREACH(const std::string &name, wbx_v3_tx_gain_ranges.keys()){
-            set_tx_gain(wbx_v3_tx_gain_ranges[name].start(), name);
-        }
-    }
-    else {
-        BOOST_FOREACH(const std::string &name, wbx_tx_gain_ranges.keys()){
-            set_tx_gain(wbx_tx_gain_ranges[name].start(), name);
-        }
+    ////////////////////////////////////////////////////////////////////
+    // Register the common properties, the sets apply the defaults:
+    //   The implementation registers the name, freq and antenna.
+    ////////////////////////////////////////////////////////////////////
+    this->get_rx_subtree()->create<sensor_value_t>("sensors/lo_locked")
+        .publish(boost::bind(&wbx_base::get_locked_sensor, this, dboard_iface::UNIT_RX));
+    BOOST_FOREACH(const std::string &name, wbx_rx_gain_ranges.keys()){
+        this->get_rx_subtree()->create<double>("gains/"+name+"/value")
+            .coerce(boost::bind(&wbx_base::set_rx_gain, this, _1, name))
+            .set(wbx_rx_gain_ranges[name].start());
+        this->get_rx_subtree()->create<meta_range_t>("gains/"+name+"/range")
+            .set(wbx_rx_gain_ranges[name]);
     }
+    this->get_rx_subtree()->create<std::string>("connection").set("IQ");
+    this->get_rx_subtree()->create<bool>("enabled")
+        .subscribe(boost::bind(&wbx_base::set_rx_enabled, this, _1))
+        .set(false);
+    this->get_rx_subtree()->create<bool>("use_lo_offset").set(false);
+    create_coerced<double>(this->get_rx_subtree(), "bandwidth/value",
+        2*20.0e6, //20MHz low-pass, we want complex double-sided
+        &coerce_fixed_bandwidth
+    );
 
-    BOOST_FOREACH(const std::string &name, wbx_rx_gain_ranges.keys()){
-        set_rx_gain(wbx_rx_gain_ranges[name].start(), name);
+    const uhd::dict<std::string, gain_range_t> &tx_gain_ranges = is_v3()?
+        wbx_v3_tx_gain_ranges : wbx_tx_gain_ranges;
+    this->get_tx_subtree()->create<sensor_value_t>("sensors/lo_locked")
+        .publish(boost::bind(&wbx_base::get_locked_sensor, this, dboard_iface::UNIT_TX));
+    BOOST_FOREACH(const std::string &name, tx_gain_ranges.keys()){
+        this->get_tx_subtree()->create<double>("gains/"+name+"/value")
+            .coerce(boost::bind(&wbx_base::set_tx_gain, this, _1, name))
+            .set(tx_gain_ranges[name].start());
+        this->get_tx_subtree()->create<meta_range_t>("gains/"+name+"/range")
+            .set(tx_gain_ranges[name]);
     }
-    set_rx_enabled(false);
-    set_tx_enabled(false);
+    this->get_tx_subtree()->create<std::string>("connection").set("IQ");
+    this->get_tx_subtree()->create<bool>("enabled")
+        .subscribe(boost::bind(&wbx_base::set_tx_enabled, this, _1))
+        .set(false);
+    this->get_tx_subtree()->create<bool>("use_lo_offset").set(false);
+    create_coerced<double>(this->get_tx_subtree(), "bandwidth/value",
+        2*20.0e6, //20MHz low-pass, we want complex double-sided
+        &coerce_fixed_bandwidth
+    );
 }
 
 wbx_base::~wbx_base(void){
@@ -232,12 +267,11 @@ static double tx_pga0_gain_to_dac_volts(double &gain){
     return dac_volts;
 }
 
-void wbx_base::set_tx_gain(double gain, const std::string &name){
+double wbx_base::set_tx_gain(double gain, const std::string &name){
     if (is_v3()) {
         assert_has(wbx_v3_tx_gain_ranges.keys(), name, "wbx tx gain name");
         if(name == "PGA0"){
             boost::uint16_t io_bits = tx_pga0_gain_to_iobits(gain);
-            _tx_gains[name] = gain;
 
             //write the new gain to tx gpio outputs
             this->get_iface()->set_gpio_out(dboard_iface::UNIT_TX, io_bits, TX_ATTN_MASK);
@@ -248,53 +282,40 @@ void wbx_base::set_tx_gain(double gain, const std::string &name){
         assert_has(wbx_tx_gain_ranges.keys(), name, "wbx tx gain name");
         if(name == "PGA0"){
             double dac_volts = tx_pga0_gain_to_dac_volts(gain);
-            _tx_gains[name] = gain;
 
             //write the new voltage to the aux dac
             this->get_iface()->write_aux_dac(dboard_iface::UNIT_TX, dboard_iface::AUX_DAC_A, dac_volts);
         }
         else UHD_THROW_INVALID_CODE_PATH();
     }
+    return gain;
 }
 
-void wbx_base::set_rx_gain(double gain, const std::string &name){
+double wbx_base::set_rx_gain(double gain, const std::string &name){
     assert_has(wbx_rx_gain_ranges.keys(), name, "wbx rx gain name");
     if(name == "PGA0"){
         boost::uint16_t io_bits = rx_pga0_gain_to_iobits(gain);
-        _rx_gains[name] = gain;
 
         //write the new gain to rx gpio outputs
         this->get_iface()->set_gpio_out(dboard_iface::UNIT_RX, io_bits, RX_ATTN_MASK);
     }
     else UHD_THROW_INVALID_CODE_PATH();
+    return gain;
 }
 
 /***********************************************************************
  * Tuning
  **********************************************************************/
-double wbx_base::set_lo_freq(
+wbx_base::lo_plan_t wbx_base::make_lo_plan(
     dboard_iface::unit_t unit,
     double target_freq
 ){
-    UHD_LOGV(often) << boost::format(
-        "WBX tune: target frequency %f Mhz"
-    ) % (target_freq/1e6) << std::endl;
-
     //map prescaler setting to mininmum integer divider (N) values (pg.18 prescaler)
     static const uhd::dict<int, int> prescaler_to_min_int_div = map_list_of
         (0,23) //adf4350_regs_t::PRESCALER_4_5
         (1,75) //adf4350_regs_t::PRESCALER_8_9
     ;
 
-    //map rf divider select output dividers to enums
-    static const uhd::dict<int, adf4350_regs_t::rf_divider_select_t> rfdivsel_to_enum = map_list_of
-        (1,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV1)
-        (2,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV2)
-        (4,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV4)
-        (8,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV8)
-        (16, adf4350_regs_t::RF_DIVIDER_SELECT_DIV16)
-    ;
-
     double actual_freq, pfd_freq;
     double ref_freq = this->get_iface()->get_clock_rate(unit);
     int R=0, BS=0, N=0, FRAC=0, MOD=0;
@@ -318,13 +339,9 @@ double wbx_base::set_lo_freq(
     adf4350_regs_t::prescaler_t prescaler = vco_freq > 3e9 ? adf4350_regs_t::PRESCALER_8_9 : adf4350_regs_t::PRESCALER_4_5;
 
     /*
-     * The goal here is to loop though possible R dividers,
-     * band select clock dividers, N (int) dividers, and FRAC 
-     * (frac) dividers.
-     *
-     * Calculate the N and F dividers for each set of values.
-     * The loop exists when it meets all of the constraints.
-     * The resulting loop values are loaded into the registers.
+     * The R and band select dividers only depend on the reference,
+     * so they are calculated directly instead of searched for.
+     * The N and F dividers follow from the resulting PFD frequency.
      *
      * from pg.21
      *
@@ -334,26 +351,19 @@ double wbx_base::set_lo_freq(
      * f_rf = f_vco/RFdiv)
      * f_actual = f_rf/2
      */
-    for(R = 1; R <= 1023; R+=1){
-        //PFD input frequency = f_ref/R ... ignoring Reference doubler/divide-by-2 (D & T)
-        pfd_freq = ref_freq*(1+D)/(R*(1+T));
-
-        //keep the PFD frequency at or below 25MHz (Loop Filter Bandwidth)
-        if (pfd_freq > 25e6) continue;
 
-        //ignore fractional part of tuning
-        N = int(std::floor(vco_freq/pfd_freq));
+    //the smallest R that keeps the PFD frequency at or below 25MHz (Loop Filter Bandwidth)
+    //PFD input frequency = f_ref/R ... ignoring Reference divide-by-2 (T)
+    R = std::max(1, int(std::ceil(ref_freq*(1+D)/25e6)));
+    pfd_freq = ref_freq*(1+D)/(R*(1+T));
 
-        //keep N > minimum int divider requirement
-        if (N < prescaler_to_min_int_div[prescaler]) continue;
+    //ignore fractional part of tuning
+    //N > minimum int divider requirement since f_vco >= 2.2GHz and f_pfd <= 25MHz
+    N = int(std::floor(vco_freq/pfd_freq));
+    UHD_ASSERT_THROW(N >= prescaler_to_min_int_div[prescaler]);
 
-        for(BS=1; BS <= 255; BS+=1){
-            //keep the band select frequency at or below 100KHz
-            //constraint on band select clock
-            if (pfd_freq/BS > 100e3) continue;
-            goto done_loop;
-        }
-    } done_loop:
+    //the smallest band select clock divider that keeps the band select frequency at or below 100KHz
+    BS = std::min(255, int(std::ceil(pfd_freq/100e3)));
 
     //Fractional-N calculation
     MOD = 4095; //max fractional accuracy
@@ -373,24 +383,64 @@ double wbx_base::set_lo_freq(
     UHD_LOGV(often)
         << boost::format("WBX Intermediates: ref=%0.2f, outdiv=%f, fbdiv=%f") % (ref_freq*(1+int(D))/(R*(1+int(T)))) % double(RFdiv*2) % double(N + double(FRAC)/double(MOD)) << std::endl
 
-        << boost::format("WBX tune: R=%d, BS=%d, N=%d, FRAC=%d, MOD=%d, T=%d, D=%d, RFdiv=%d, LD=%d"
-            ) % R % BS % N % FRAC % MOD % T % D % RFdiv % get_locked(unit)<< std::endl
+        << boost::format("WBX tune: R=%d, BS=%d, N=%d, FRAC=%d, MOD=%d, T=%d, D=%d, RFdiv=%d"
+            ) % R % BS % N % FRAC % MOD % T % D % RFdiv << std::endl
         << boost::format("WBX Frequencies (MHz): REQ=%0.2f, ACT=%0.2f, VCO=%0.2f, PFD=%0.2f, BAND=%0.2f"
             ) % (target_freq/1e6) % (actual_freq/1e6) % (vco_freq/1e6) % (pfd_freq/1e6) % (pfd_freq/BS/1e6) << std::endl;
 
-    //load the register values
-    adf4350_regs_t regs;
+    lo_plan_t plan;
+    plan.ref_freq = ref_freq;
+    plan.actual_freq = actual_freq;
+    plan.R = R; plan.BS = BS; plan.N = N;
+    plan.FRAC = FRAC; plan.MOD = MOD; plan.RFdiv = RFdiv;
+    plan.prescaler = prescaler;
+    plan.T = T; plan.D = D;
+    return plan;
+}
+
+double wbx_base::set_lo_freq(
+    dboard_iface::unit_t unit,
+    double target_freq
+){
+    UHD_LOGV(often) << boost::format(
+        "WBX tune: target frequency %f Mhz"
+    ) % (target_freq/1e6) << std::endl;
+
+    //map rf divider select output dividers to enums
+    static const uhd::dict<int, adf4350_regs_t::rf_divider_select_t> rfdivsel_to_enum = map_list_of
+        (1,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV1)
+        (2,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV2)
+        (4,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV4)
+        (8,  adf4350_regs_t::RF_DIVIDER_SELECT_DIV8)
+        (16, adf4350_regs_t::RF_DIVIDER_SELECT_DIV16)
+    ;
 
-    regs.frac_12_bit = FRAC;
-    regs.int_16_bit = N;
-    regs.mod_12_bit = MOD;
-    regs.prescaler = prescaler;
-    regs.r_counter_10_bit = R;
-    regs.reference_divide_by_2 = T;
-    regs.reference_doubler = D;
-    regs.band_select_clock_div = BS;
-    UHD_ASSERT_THROW(rfdivsel_to_enum.has_key(RFdiv));
-    regs.rf_divider_select = rfdivsel_to_enum[RFdiv];
+    //reuse the dividers from an earlier tune to this frequency,
+    //so hopping over a fixed set of frequencies skips the search
+    uhd::dict<double, lo_plan_t> &plans = _lo_plans[unit];
+    const double ref_freq = this->get_iface()->get_clock_rate(unit);
+    if (not plans.has_key(target_freq) or plans[target_freq].ref_freq != ref_freq){
+        if (plans.size() >= MAX_LO_PLANS) plans = uhd::dict<double, lo_plan_t>();
+        plans[target_freq] = this->make_lo_plan(unit, target_freq);
+    }
+    const lo_plan_t plan = plans[target_freq];
+    const double actual_freq = plan.actual_freq;
+
+    //load the register values over the last ones written to this unit
+    adf4350_regs_t &regs = _lo_regs[unit];
+    const bool first_load = not regs.has_saved_state();
+    regs.save_state();
+
+    regs.frac_12_bit = plan.FRAC;
+    regs.int_16_bit = plan.N;
+    regs.mod_12_bit = plan.MOD;
+    regs.prescaler = plan.prescaler;
+    regs.r_counter_10_bit = plan.R;
+    regs.reference_divide_by_2 = plan.T;
+    regs.reference_doubler = plan.D;
+    regs.band_select_clock_div = plan.BS;
+    UHD_ASSERT_THROW(rfdivsel_to_enum.has_key(plan.RFdiv));
+    regs.rf_divider_select = rfdivsel_to_enum[plan.RFdiv];
 
     if (unit == dboard_iface::UNIT_RX) {
         freq_range_t rx_lo_5dbm = list_of
@@ -423,17 +473,20 @@ double wbx_base::set_lo_freq(
 
     //write the registers
     //correct power-up sequence to write registers (5, 4, 3, 2, 1, 0)
+    //after the first load, only write the registers that changed,
+    //but always finish with R0 since it starts the VCO band select
+    const std::set<int> changed_addrs = regs.get_changed_addrs<int>();
     int addr;
+    std::vector<boost::uint32_t> spi_regs;
 
     for(addr=5; addr>=0; addr--){
+        if (not first_load and addr != 0 and changed_addrs.count(addr) == 0) continue;
         UHD_LOGV(often) << boost::format(
             "WBX SPI Reg (0x%02x): 0x%08x"
         ) % addr % regs.get_reg(addr) << std::endl;
-        this->get_iface()->write_spi(
-            unit, spi_config_t::EDGE_RISE,
-            regs.get_reg(addr), 32
-        );
+        spi_regs.push_back(regs.get_reg(addr));
     }
+    this->get_iface()->write_spi_batch(unit, spi_config_t::EDGE_RISE, spi_regs, 32);
 
     //return the actual frequency
     UHD_LOGV(often) << boost::format(
@@ -446,211 +499,10 @@ bool wbx_base::get_locked(dboard_iface::unit_t unit){
     return (this->get_iface()->read_gpio(unit) & LOCKDET_MASK) != 0;
 }
 
-bool wbx_base::is_v3(void){
-    return get_rx_id().to_uint16() == 0x057;
-}
-
-/***********************************************************************
- * RX Get and Set
- **********************************************************************/
-void wbx_base::rx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = get_rx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        assert_has(_rx_gains.keys(), key.name, "wbx rx gain name");
-        val = _rx_gains[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        assert_has(wbx_rx_gain_ranges.keys(), key.name, "wbx rx gain name");
-        val = wbx_rx_gain_ranges[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        val = prop_names_t(wbx_rx_gain_ranges.keys());
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = 0.0;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = freq_range_t(0.0, 0.0, 0.0);;
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = std::string("");
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = prop_names_t(1, "");
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = SUBDEV_CONN_COMPLEX_IQ;
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = _rx_enabled;
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_SENSOR:
-        UHD_ASSERT_THROW(key.name == "lo_locked");
-        val = sensor_value_t("LO", this->get_locked(dboard_iface::UNIT_RX), "locked", "unlocked");
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = prop_names_t(1, "lo_locked");
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = 2*20.0e6; //20MHz low-pass, we want complex double-sided
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
+sensor_value_t wbx_base::get_locked_sensor(dboard_iface::unit_t unit){
+    return sensor_value_t("LO", this->get_locked(unit), "locked", "unlocked");
 }
 
-void wbx_base::rx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_GAIN:
-        this->set_rx_gain(val.as<double>(), key.name);
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        _rx_enabled = val.as<bool>();
-        this->set_rx_enabled(_rx_enabled);
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << "WBX: No tunable bandwidth, fixed filtered to 40MHz";
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
-}
-
-/***********************************************************************
- * TX Get and Set
- **********************************************************************/
-void wbx_base::tx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        val = get_tx_id().to_pp_string();
-        return;
-
-    case SUBDEV_PROP_OTHERS:
-        val = prop_names_t(); //empty
-        return;
-
-    case SUBDEV_PROP_GAIN:
-        assert_has(_tx_gains.keys(), key.name, "wbx tx gain name");
-        val = _tx_gains[key.name];
-        return;
-
-    case SUBDEV_PROP_GAIN_RANGE:
-        if (is_v3()) {
-            assert_has(wbx_v3_tx_gain_ranges.keys(), key.name, "wbx tx gain name");
-            val = wbx_v3_tx_gain_ranges[key.name];
-        }
-        else {
-            assert_has(wbx_tx_gain_ranges.keys(), key.name, "wbx tx gain name");
-            val = wbx_tx_gain_ranges[key.name];
-        }
-        return;
-
-    case SUBDEV_PROP_GAIN_NAMES:
-        if (is_v3())
-            val = prop_names_t(wbx_v3_tx_gain_ranges.keys());
-        else
-            val = prop_names_t(wbx_tx_gain_ranges.keys());
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = 0.0;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = freq_range_t(0.0, 0.0, 0.0);
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = std::string("");
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = prop_names_t(1, "");
-        return;
-
-    case SUBDEV_PROP_CONNECTION:
-        val = SUBDEV_CONN_COMPLEX_IQ;
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        val = _tx_enabled;
-        return;
-
-    case SUBDEV_PROP_USE_LO_OFFSET:
-        val = false;
-        return;
-
-    case SUBDEV_PROP_SENSOR:
-        UHD_ASSERT_THROW(key.name == "lo_locked");
-        val = sensor_value_t("LO", this->get_locked(dboard_iface::UNIT_TX), "locked", "unlocked");
-        return;
-
-    case SUBDEV_PROP_SENSOR_NAMES:
-        val = prop_names_t(1, "lo_locked");
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        val = 2*20.0e6; //20MHz low-pass, we want complex double-sided
-        return;
-
-    default: UHD_THROW_PROP_GET_ERROR();
-    }
-}
-
-void wbx_base::tx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_GAIN:
-        this->set_tx_gain(val.as<double>(), key.name);
-        return;
-
-    case SUBDEV_PROP_ENABLED:
-        _tx_enabled = val.as<bool>();
-        this->set_tx_enabled(_tx_enabled);
-        return;
-
-    case SUBDEV_PROP_BANDWIDTH:
-        UHD_MSG(warning) << "WBX: No tunable bandwidth, fixed filtered to 40MHz";
-        return;
-
-    default: UHD_THROW_PROP_SET_ERROR();
-    }
+bool wbx_base::is_v3(void){
+    return get_rx_id().to_uint16() == 0x057;
 }
@@ -21,6 +21,7 @@
 #include "adf4350_regs.hpp"
 #include <uhd/types/dict.hpp>
 #include <uhd/types/ranges.hpp>
+#include <uhd/types/sensors.hpp>
 #include <uhd/utils/props.hpp>
 #include <uhd/usrp/dboard_base.hpp>
 
@@ -35,18 +36,12 @@ public:
     virtual ~wbx_base(void);
 
 protected:
-    virtual void set_rx_gain(double gain, const std::string &name);
-    virtual void set_tx_gain(double gain, const std::string &name);
+    virtual double set_rx_gain(double gain, const std::string &name);
+    virtual double set_tx_gain(double gain, const std::string &name);
 
     virtual void set_rx_enabled(bool enb);
     virtual void set_tx_enabled(bool enb);
 
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
-
-    void tx_get(const wax::obj &key, wax::obj &val);
-    void tx_set(const wax::obj &key, const wax::obj &val);
-
     /*!
      * Set the LO frequency for the particular dboard unit.
      * \param unit which unit rx or tx
@@ -62,6 +57,13 @@ protected:
      */
     virtual bool get_locked(dboard_iface::unit_t unit);
 
+    /*!
+     * Get the lock detect sensor of the LO.
+     * \param unit which unit rx or tx
+     * \return the lo locked sensor
+     */
+    sensor_value_t get_locked_sensor(dboard_iface::unit_t unit);
+
     /*!
      * Detect if this a v3 WBX
      * \return true for locked
@@ -69,8 +71,24 @@ protected:
     virtual bool is_v3(void);
 
 private:
-    uhd::dict<std::string, double> _tx_gains, _rx_gains;
-    bool _rx_enabled, _tx_enabled;
+    //! The divider settings that tune one unit to one frequency
+    struct lo_plan_t{
+        double ref_freq, actual_freq;
+        int R, BS, N, FRAC, MOD, RFdiv;
+        adf4350_regs_t::prescaler_t prescaler;
+        adf4350_regs_t::reference_divide_by_2_t T;
+        adf4350_regs_t::reference_doubler_t D;
+    };
+    uhd::dict<dboard_iface::unit_t, uhd::dict<double, lo_plan_t> > _lo_plans;
+    uhd::dict<dboard_iface::unit_t, adf4350_regs_t> _lo_regs;
+
+    /*!
+     * Calculate the divider settings for an LO frequency.
+     * \param unit which unit rx or tx
+     * \param target_freq the desired frequency in Hz
+     * \return the dividers and the actual frequency
+     */
+    lo_plan_t make_lo_plan(dboard_iface::unit_t unit, double target_freq);
 };
 
 }} //namespace uhd::usrp
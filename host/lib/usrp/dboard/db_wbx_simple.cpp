@@ -27,6 +27,7 @@
 #include <uhd/utils/assert_has.hpp>
 #include <uhd/usrp/dboard_manager.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
 
 using namespace uhd;
 using namespace uhd::usrp;
@@ -49,20 +50,12 @@ public:
     wbx_simple(ctor_args_t args);
     ~wbx_simple(void);
 
-    void rx_get(const wax::obj &key, wax::obj &val);
-    void rx_set(const wax::obj &key, const wax::obj &val);
-
-    void tx_get(const wax::obj &key, wax::obj &val);
-    void tx_set(const wax::obj &key, const wax::obj &val);
-
 private:
-    void set_rx_lo_freq(double freq);
-    void set_tx_lo_freq(double freq);
-    double _rx_lo_freq, _tx_lo_freq;
+    double set_rx_lo_freq(double freq);
+    double set_tx_lo_freq(double freq);
 
-    void set_rx_ant(const std::string &ant);
-    void set_tx_ant(const std::string &ant);
-    std::string _rx_ant;
+    std::string set_rx_ant(const std::string &ant);
+    std::string set_tx_ant(const std::string &ant);
 };
 
 /***********************************************************************
@@ -100,10 +93,34 @@ wbx_simple::wbx_simple(ctor_args_t args) : wbx_base(args){
     this->get_iface()->set_atr_reg(dboard_iface::UNIT_RX, dboard_iface::ATR_REG_TX_ONLY,     ANT_RX2, ANTSW_IO);
     this->get_iface()->set_atr_reg(dboard_iface::UNIT_RX, dboard_iface::ATR_REG_FULL_DUPLEX, ANT_RX2, ANTSW_IO);
 
-    //set some default values
-    set_rx_lo_freq((wbx_freq_range.start() + wbx_freq_range.stop())/2.0);
-    set_tx_lo_freq((wbx_freq_range.start() + wbx_freq_range.stop())/2.0);
-    set_rx_ant("RX2");
+    ////////////////////////////////////////////////////////////////////
+    // Register properties, the sets apply the defaults
+    ////////////////////////////////////////////////////////////////////
+    this->get_rx_subtree()->create<std::string>("name").set(
+        is_v3()? "WBX v3 RX + Simple GDB" : "WBX RX + Simple GDB"
+    );
+    this->get_rx_subtree()->create<double>("freq/value")
+        .coerce(boost::bind(&wbx_simple::set_rx_lo_freq, this, _1))
+        .set((wbx_freq_range.start() + wbx_freq_range.stop())/2.0);
+    this->get_rx_subtree()->create<meta_range_t>("freq/range").set(wbx_freq_range);
+    this->get_rx_subtree()->create<std::string>("antenna/value")
+        .coerce(boost::bind(&wbx_simple::set_rx_ant, this, _1))
+        .set("RX2");
+    this->get_rx_subtree()->create<std::vector<std::string> >("antenna/options")
+        .set(wbx_rx_antennas);
+
+    this->get_tx_subtree()->create<std::string>("name").set(
+        is_v3()? "WBX v3 TX + Simple GDB" : "WBX TX + Simple GDB"
+    );
+    this->get_tx_subtree()->create<double>("freq/value")
+        .coerce(boost::bind(&wbx_simple::set_tx_lo_freq, this, _1))
+        .set((wbx_freq_range.start() + wbx_freq_range.stop())/2.0);
+    this->get_tx_subtree()->create<meta_range_t>("freq/range").set(wbx_freq_range);
+    this->get_tx_subtree()->create<std::string>("antenna/value")
+        .coerce(boost::bind(&wbx_simple::set_tx_ant, this, _1))
+        .set(wbx_tx_antennas.at(0));
+    this->get_tx_subtree()->create<std::vector<std::string> >("antenna/options")
+        .set(wbx_tx_antennas);
 }
 
 wbx_simple::~wbx_simple(void){
@@ -113,143 +130,28 @@ wbx_simple::~wbx_simple(void){
 /***********************************************************************
  * Antennas
  **********************************************************************/
-void wbx_simple::set_rx_ant(const std::string &ant){
+std::string wbx_simple::set_rx_ant(const std::string &ant){
     //validate input
     assert_has(wbx_rx_antennas, ant, "wbx rx antenna name");
 
-    //shadow the setting
-    _rx_ant = ant;
-
     //write the new antenna setting to atr regs
-    this->get_iface()->set_atr_reg(dboard_iface::UNIT_RX, dboard_iface::ATR_REG_RX_ONLY, ((_rx_ant == "TX/RX")? ANT_TXRX : ANT_RX2), ANTSW_IO);
+    this->get_iface()->set_atr_reg(dboard_iface::UNIT_RX, dboard_iface::ATR_REG_RX_ONLY, ((ant == "TX/RX")? ANT_TXRX : ANT_RX2), ANTSW_IO);
+    return ant;
 }
 
-void wbx_simple::set_tx_ant(const std::string &ant){
+std::string wbx_simple::set_tx_ant(const std::string &ant){
     assert_has(wbx_tx_antennas, ant, "wbx tx antenna name");
     //only one antenna option, do nothing
+    return ant;
 }
 
 /***********************************************************************
  * Tuning
  **********************************************************************/
-void wbx_simple::set_rx_lo_freq(double freq){
-    _rx_lo_freq = set_lo_freq(dboard_iface::UNIT_RX, wbx_freq_range.clip(freq));
-}
-
-void wbx_simple::set_tx_lo_freq(double freq){
-    _tx_lo_freq = set_lo_freq(dboard_iface::UNIT_TX, wbx_freq_range.clip(freq));
-}
-
-/***********************************************************************
- * RX Get and Set
- **********************************************************************/
-void wbx_simple::rx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        if (is_v3())
-            val = std::string("WBX v3 RX + Simple GDB");
-        else
-            val = std::string("WBX RX + Simple GDB");
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = _rx_lo_freq;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = wbx_freq_range;
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = _rx_ant;
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = wbx_rx_antennas;
-        return;
-
-    default:
-        //call into the base class for other properties
-        wbx_base::rx_get(key_, val);
-    }
+double wbx_simple::set_rx_lo_freq(double freq){
+    return set_lo_freq(dboard_iface::UNIT_RX, wbx_freq_range.clip(freq));
 }
 
-void wbx_simple::rx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_FREQ:
-        this->set_rx_lo_freq(val.as<double>());
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        this->set_rx_ant(val.as<std::string>());
-        return;
-
-    default:
-        //call into the base class for other properties
-        wbx_base::rx_set(key_, val);
-    }
-}
-
-/***********************************************************************
- * TX Get and Set
- **********************************************************************/
-void wbx_simple::tx_get(const wax::obj &key_, wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-    case SUBDEV_PROP_NAME:
-        if (is_v3())
-            val = std::string("WBX v3 TX + Simple GDB");
-        else
-            val = std::string("WBX TX + Simple GDB");
-        return;
-
-    case SUBDEV_PROP_FREQ:
-        val = _tx_lo_freq;
-        return;
-
-    case SUBDEV_PROP_FREQ_RANGE:
-        val = wbx_freq_range;
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        val = std::string("TX/RX");
-        return;
-
-    case SUBDEV_PROP_ANTENNA_NAMES:
-        val = wbx_tx_antennas;
-        return;
-
-    default:
-        //call into the base class for other properties
-        wbx_base::tx_get(key_, val);
-    }
-}
-
-void wbx_simple::tx_set(const wax::obj &key_, const wax::obj &val){
-    named_prop_t key = named_prop_t::extract(key_);
-
-    //handle the get request conditioned on the key
-    switch(key.as<subdev_prop_t>()){
-
-    case SUBDEV_PROP_FREQ:
-        this->set_tx_lo_freq(val.as<double>());
-        return;
-
-    case SUBDEV_PROP_ANTENNA:
-        this->set_tx_ant(val.as<std::string>());
-        return;
-
-    default:
-        //call into the base class for other properties
-        wbx_base::tx_set(key_, val);
-    }
+double wbx_simple::set_tx_lo_freq(double freq){
+    return set_lo_freq(dboard_iface::UNIT_TX, wbx_freq_range.clip(freq));
 }
@@ -17,6 +17,7 @@
 
 #include "dboard_ctor_args.hpp"
 #include <uhd/usrp/dboard_base.hpp>
+#include <uhd/exception.hpp>
 #include <boost/format.hpp>
 #include <stdexcept>
 
@@ -54,6 +55,30 @@ dboard_id_t dboard_base::get_tx_id(void){
     return _impl->args.tx_id;
 }
 
+void dboard_base::rx_get(const wax::obj &, wax::obj &){
+    throw uhd::not_implemented_error("this dboard has no rx_get, its properties are in the rx subtree");
+}
+
+void dboard_base::rx_set(const wax::obj &, const wax::obj &){
+    throw uhd::not_implemented_error("this dboard has no rx_set, its properties are in the rx subtree");
+}
+
+void dboard_base::tx_get(const wax::obj &, wax::obj &){
+    throw uhd::not_implemented_error("this dboard has no tx_get, its properties are in the tx subtree");
+}
+
+void dboard_base::tx_set(const wax::obj &, const wax::obj &){
+    throw uhd::not_implemented_error("this dboard has no tx_set, its properties are in the tx subtree");
+}
+
+uhd::property_tree::sptr dboard_base::get_rx_subtree(void){
+    return _impl->args.rx_subtree;
+}
+
+uhd::property_tree::sptr dboard_base::get_tx_subtree(void){
+    return _impl->args.tx_subtree;
+}
+
 /***********************************************************************
  * xcvr dboard dboard_base class
  **********************************************************************/
@@ -90,14 +115,6 @@ rx_dboard_base::~rx_dboard_base(void){
     /* NOP */
 }
 
-void rx_dboard_base::tx_get(const wax::obj &, wax::obj &){
-    throw uhd::runtime_error("cannot call tx_get on a rx dboard");
-}
-
-void rx_dboard_base::tx_set(const wax::obj &, const wax::obj &){
-    throw uhd::runtime_error("cannot call tx_set on a rx dboard");
-}
-
 /***********************************************************************
  * tx dboard dboard_base class
  **********************************************************************/
@@ -113,11 +130,3 @@ tx_dboard_base::tx_dboard_base(ctor_args_t args) : dboard_base(args){
 tx_dboard_base::~tx_dboard_base(void){
     /* NOP */
 }
-
-void tx_dboard_base::rx_get(const wax::obj &, wax::obj &){
-    throw uhd::runtime_error("cannot call rx_get on a tx dboard");
-}
-
-void tx_dboard_base::rx_set(const wax::obj &, const wax::obj &){
-    throw uhd::runtime_error("cannot call rx_set on a tx dboard");
-}
@@ -21,6 +21,7 @@
 #include <uhd/usrp/dboard_id.hpp>
 #include <uhd/usrp/dboard_base.hpp>
 #include <uhd/usrp/dboard_iface.hpp>
+#include <uhd/property_tree.hpp>
 #include <string>
 
 namespace uhd{ namespace usrp{
@@ -29,6 +30,7 @@ namespace uhd{ namespace usrp{
         std::string               sd_name;
         dboard_iface::sptr        db_iface;
         dboard_id_t               rx_id, tx_id;
+        property_tree::sptr       rx_subtree, tx_subtree;
     };
 
 }} //namespace
@@ -148,5 +148,14 @@ void dboard_eeprom_t::store(i2c_iface &iface, boost::uint8_t addr) const{
     //load the checksum
     bytes[DB_EEPROM_CHKSUM] = checksum(bytes);
 
-    iface.write_eeprom(addr, 0, bytes);
+    //write back only the runs of bytes that differ from the eeprom
+    const byte_vector_t old_bytes = iface.read_eeprom(addr, 0, DB_EEPROM_CLEN);
+    size_t i = 0;
+    while (i < bytes.size()){
+        if (i < old_bytes.size() and bytes[i] == old_bytes[i]){i++; continue;}
+        size_t end = i;
+        while (end < bytes.size() and (end >= old_bytes.size() or bytes[end] != old_bytes[end])) end++;
+        iface.write_eeprom(addr, i, byte_vector_t(bytes.begin() + i, bytes.begin() + end));
+        i = end;
+    }
 }
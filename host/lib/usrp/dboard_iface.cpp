@@ -76,3 +76,22 @@ void dboard_iface::set_gpio_out(
 boost::uint16_t dboard_iface::get_gpio_out(unit_t unit){
     return _impl->gpio_out_shadow[unit];
 }
+
+void dboard_iface::begin_gpio_update(void){
+    /* NOP */
+}
+
+void dboard_iface::commit_gpio_update(void){
+    /* NOP */
+}
+
+void dboard_iface::write_spi_batch(
+    unit_t unit,
+    const spi_config_t &config,
+    const std::vector<boost::uint32_t> &data,
+    size_t num_bits
+){
+    for (size_t i = 0; i < data.size(); i++){
+        this->write_spi(unit, config, data[i], num_bits);
+    }
+}
@@ -23,10 +23,14 @@
 #include <uhd/utils/static.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/types/dict.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/types/sensors.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/format.hpp>
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/assign/list_of.hpp>
 
 using namespace uhd;
@@ -147,42 +151,263 @@ std::string dboard_id_t::to_pp_string(void) const{
  * internal helper classes
  **********************************************************************/
 /*!
- * A special wax proxy object that forwards calls to a subdev.
- * A sptr to an instance will be used in the properties structure. 
+ * Holds a dboard and constructs it on the first use.
+ * The rx and tx frontends of a xcvr board share one holder.
  */
-class subdev_proxy : boost::noncopyable, public wax::obj{
+class dboard_holder : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<dboard_holder> sptr;
+    typedef boost::function<dboard_base::sptr(void)> ctor_type;
+    typedef boost::function<void(void)> callback_type;
+
+    dboard_holder(const ctor_type &ctor):
+        _ctor(ctor)
+    {
+        /* NOP */
+    }
+
+    dboard_base::sptr get(void){
+        std::vector<callback_type> callbacks;
+        dboard_base::sptr dboard;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (_dboard.get() == NULL){
+                _dboard = _ctor();
+                callbacks.swap(_callbacks);
+            }
+            dboard = _dboard;
+        }
+        //run outside of the lock, the callbacks access the dboard
+        BOOST_FOREACH(const callback_type &callback, callbacks) callback();
+        return dboard;
+    }
+
+    bool is_initialized(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        return _dboard.get() != NULL;
+    }
+
+    //! Call back once the dboard is constructed, or now if it already is
+    void on_init(const callback_type &callback){
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (_dboard.get() == NULL){
+                _callbacks.push_back(callback);
+                return;
+            }
+        }
+        callback();
+    }
+
+private:
+    boost::mutex _mutex;
+    ctor_type _ctor;
+    dboard_base::sptr _dboard;
+    std::vector<callback_type> _callbacks;
+};
+
+/***********************************************************************
+ * Legacy dboards: populate the frontend from the wax interface
+ *
+ * A dboard that creates no frontend properties in its constructor
+ * implements the deprecated rx_get/tx_get interface instead.
+ * The frontend properties forward to it through a wax proxy.
+ **********************************************************************/
+class legacy_subdev : boost::noncopyable, public wax::obj{
 public:
-    typedef boost::shared_ptr<subdev_proxy> sptr;
+    typedef boost::shared_ptr<legacy_subdev> sptr;
     enum type_t{RX_TYPE, TX_TYPE};
 
-    //structors
-    subdev_proxy(dboard_base::sptr subdev, type_t type):
-        _subdev(subdev), _type(type)
+    legacy_subdev(dboard_base::sptr dboard, type_t type):
+        _dboard(dboard), _type(type)
     {
         /* NOP */
     }
 
 private:
-    dboard_base::sptr   _subdev;
-    type_t              _type;
+    dboard_base::sptr _dboard;
+    type_t            _type;
 
     //forward the get calls to the rx or tx
     void get(const wax::obj &key, wax::obj &val){
         switch(_type){
-        case RX_TYPE: return _subdev->rx_get(key, val);
-        case TX_TYPE: return _subdev->tx_get(key, val);
+        case RX_TYPE: return _dboard->rx_get(key, val);
+        case TX_TYPE: return _dboard->tx_get(key, val);
         }
     }
 
     //forward the set calls to the rx or tx
     void set(const wax::obj &key, const wax::obj &val){
         switch(_type){
-        case RX_TYPE: return _subdev->rx_set(key, val);
-        case TX_TYPE: return _subdev->tx_set(key, val);
+        case RX_TYPE: return _dboard->rx_set(key, val);
+        case TX_TYPE: return _dboard->tx_set(key, val);
         }
     }
 };
 
+static sensor_value_t get_legacy_sensor(legacy_subdev::sptr subdev, const std::string &name){
+    return (*subdev)[named_prop_t(SUBDEV_PROP_SENSOR, name)].as<sensor_value_t>();
+}
+
+static void set_legacy_gain(legacy_subdev::sptr subdev, const std::string &name, const double gain){
+    (*subdev)[named_prop_t(SUBDEV_PROP_GAIN, name)] = gain;
+}
+
+static double get_legacy_gain(legacy_subdev::sptr subdev, const std::string &name){
+    return (*subdev)[named_prop_t(SUBDEV_PROP_GAIN, name)].as<double>();
+}
+
+static meta_range_t get_legacy_gain_range(legacy_subdev::sptr subdev, const std::string &name){
+    return (*subdev)[named_prop_t(SUBDEV_PROP_GAIN_RANGE, name)].as<meta_range_t>();
+}
+
+template <typename T> static T get_legacy(legacy_subdev::sptr subdev, const subdev_prop_t key){
+    return (*subdev)[key].as<T>();
+}
+
+template <typename T> static void set_legacy(legacy_subdev::sptr subdev, const subdev_prop_t key, const T &val){
+    (*subdev)[key] = val;
+}
+
+static std::string get_legacy_conn(legacy_subdev::sptr subdev){
+    switch((*subdev)[SUBDEV_PROP_CONNECTION].as<subdev_conn_t>()){
+    case SUBDEV_CONN_COMPLEX_IQ: return "IQ";
+    case SUBDEV_CONN_COMPLEX_QI: return "QI";
+    case SUBDEV_CONN_REAL_I: return "I";
+    case SUBDEV_CONN_REAL_Q: return "Q";
+    }
+    UHD_THROW_INVALID_CODE_PATH();
+}
+
+static bool get_set_legacy_enb(legacy_subdev::sptr subdev, const bool enb){
+    (*subdev)[SUBDEV_PROP_ENABLED] = enb;
+    return (*subdev)[SUBDEV_PROP_ENABLED].as<bool>();
+}
+
+static void populate_legacy_frontend(property_tree::sptr subtree, legacy_subdev::sptr subdev){
+    subtree->create<std::string>("name").set((*subdev)[SUBDEV_PROP_NAME].as<std::string>());
+
+    subtree->create<int>("sensors"); //phony property so this dir exists
+    BOOST_FOREACH(const std::string &name, (*subdev)[SUBDEV_PROP_SENSOR_NAMES].as<prop_names_t>()){
+        subtree->create<sensor_value_t>("sensors/" + name)
+            .publish(boost::bind(&get_legacy_sensor, subdev, name));
+    }
+
+    subtree->create<int>("gains"); //phony property so this dir exists
+    BOOST_FOREACH(const std::string &name, (*subdev)[SUBDEV_PROP_GAIN_NAMES].as<prop_names_t>()){
+        subtree->create<double>("gains/" + name + "/value")
+            .publish(boost::bind(&get_legacy_gain, subdev, name))
+            .subscribe(boost::bind(&set_legacy_gain, subdev, name, _1));
+        subtree->create<meta_range_t>("gains/" + name + "/range")
+            .publish(boost::bind(&get_legacy_gain_range, subdev, name));
+    }
+
+    subtree->create<double>("freq/value")
+        .publish(boost::bind(&get_legacy<double>, subdev, SUBDEV_PROP_FREQ))
+        .subscribe(boost::bind(&set_legacy<double>, subdev, SUBDEV_PROP_FREQ, _1));
+    subtree->create<meta_range_t>("freq/range")
+        .publish(boost::bind(&get_legacy<meta_range_t>, subdev, SUBDEV_PROP_FREQ_RANGE));
+    subtree->create<std::string>("antenna/value")
+        .publish(boost::bind(&get_legacy<std::string>, subdev, SUBDEV_PROP_ANTENNA))
+        .subscribe(boost::bind(&set_legacy<std::string>, subdev, SUBDEV_PROP_ANTENNA, _1));
+    subtree->create<std::vector<std::string> >("antenna/options")
+        .publish(boost::bind(&get_legacy<std::vector<std::string> >, subdev, SUBDEV_PROP_ANTENNA_NAMES));
+    subtree->create<std::string>("connection")
+        .publish(boost::bind(&get_legacy_conn, subdev));
+    subtree->create<bool>("use_lo_offset")
+        .publish(boost::bind(&get_legacy<bool>, subdev, SUBDEV_PROP_USE_LO_OFFSET));
+    subtree->create<double>("bandwidth/value")
+        .publish(boost::bind(&get_legacy<double>, subdev, SUBDEV_PROP_BANDWIDTH))
+        .subscribe(boost::bind(&set_legacy<double>, subdev, SUBDEV_PROP_BANDWIDTH, _1));
+    subtree->create<bool>("enabled")
+        .coerce(boost::bind(&get_set_legacy_enb, subdev, _1));
+}
+
+static dboard_base::sptr make_dboard(
+    dboard_manager::dboard_ctor_t dboard_ctor, dboard_ctor_args_t db_ctor_args
+){
+    dboard_base::sptr dboard = dboard_ctor(&db_ctor_args);
+
+    //a dboard without a name property is a legacy dboard
+    if (db_ctor_args.rx_subtree.get() != NULL and not db_ctor_args.rx_subtree->exists("name")){
+        populate_legacy_frontend(db_ctor_args.rx_subtree, legacy_subdev::sptr(new legacy_subdev(dboard, legacy_subdev::RX_TYPE)));
+    }
+    if (db_ctor_args.tx_subtree.get() != NULL and not db_ctor_args.tx_subtree->exists("name")){
+        populate_legacy_frontend(db_ctor_args.tx_subtree, legacy_subdev::sptr(new legacy_subdev(dboard, legacy_subdev::TX_TYPE)));
+    }
+    return dboard;
+}
+
+/***********************************************************************
+ * Deferred init: forward the frontend properties to the subdev
+ *
+ * The subdev of a deferred holder populates a private subtree.
+ * The frontend subtree gets a property for each of the common ones,
+ * and any access through it constructs the subdev first.
+ **********************************************************************/
+template <typename T> static T get_deferred(
+    dboard_holder::sptr holder, property_tree::sptr staging, const std::string &path
+){
+    holder->get();
+    return staging->access<T>(path).get();
+}
+
+template <typename T> static void set_deferred(
+    dboard_holder::sptr holder, property_tree::sptr staging, const std::string &path, const T &val
+){
+    holder->get();
+    staging->access<T>(path).set(val);
+}
+
+template <typename T> static void forward_deferred(
+    property_tree::sptr subtree, dboard_holder::sptr holder,
+    property_tree::sptr staging, const std::string &path
+){
+    subtree->create<T>(path)
+        .publish(boost::bind(&get_deferred<T>, holder, staging, path))
+        .subscribe(boost::bind(&set_deferred<T>, holder, staging, path, _1));
+}
+
+static bool set_enb_deferred(
+    dboard_holder::sptr holder, property_tree::sptr staging, const bool enb
+){
+    //disabling a dboard that was never constructed does not construct it
+    if (not enb and not holder->is_initialized()) return false;
+    holder->get();
+    return staging->access<bool>("enabled").set(enb).get();
+}
+
+//! Forward the sensors and gains, their names depend on the dboard
+static void forward_named_props(
+    property_tree::sptr subtree, dboard_holder::sptr holder, property_tree::sptr staging
+){
+    BOOST_FOREACH(const std::string &name, staging->list("sensors")){
+        forward_deferred<sensor_value_t>(subtree, holder, staging, "sensors/" + name);
+    }
+    BOOST_FOREACH(const std::string &name, staging->list("gains")){
+        forward_deferred<double>(subtree, holder, staging, "gains/" + name + "/value");
+        forward_deferred<meta_range_t>(subtree, holder, staging, "gains/" + name + "/range");
+    }
+}
+
+static void forward_frontend(
+    property_tree::sptr subtree, dboard_holder::sptr holder, property_tree::sptr staging
+){
+    forward_deferred<std::string>(subtree, holder, staging, "name");
+    subtree->create<int>("sensors"); //phony property so this dir exists
+    subtree->create<int>("gains"); //phony property so this dir exists
+    holder->on_init(boost::bind(&forward_named_props, subtree, holder, staging));
+    forward_deferred<double>(subtree, holder, staging, "freq/value");
+    forward_deferred<meta_range_t>(subtree, holder, staging, "freq/range");
+    forward_deferred<std::string>(subtree, holder, staging, "antenna/value");
+    forward_deferred<std::vector<std::string> >(subtree, holder, staging, "antenna/options");
+    forward_deferred<std::string>(subtree, holder, staging, "connection");
+    forward_deferred<bool>(subtree, holder, staging, "use_lo_offset");
+    forward_deferred<double>(subtree, holder, staging, "bandwidth/value");
+    subtree->create<bool>("enabled")
+        .coerce(boost::bind(&set_enb_deferred, holder, staging, _1));
+}
+
 /***********************************************************************
  * dboard manager implementation class
  **********************************************************************/
@@ -192,24 +417,29 @@ public:
     dboard_manager_impl(
         dboard_id_t rx_dboard_id,
         dboard_id_t tx_dboard_id,
-        dboard_iface::sptr iface
+        dboard_iface::sptr iface,
+        property_tree::sptr subtree,
+        bool defer_init
     );
     ~dboard_manager_impl(void);
 
     //dboard_iface
     prop_names_t get_rx_subdev_names(void);
     prop_names_t get_tx_subdev_names(void);
-    wax::obj get_rx_subdev(const std::string &subdev_name);
-    wax::obj get_tx_subdev(const std::string &subdev_name);
+    void populate_prop_tree(property_tree::sptr subtree);
 
 private:
+    void populate(void);
     void init(dboard_id_t, dboard_id_t);
+    dboard_holder::sptr make_holder(dboard_ctor_t, dboard_ctor_args_t, const bool has_rx, const bool has_tx);
     //list of rx and tx dboards in this dboard_manager
-    //each dboard here is actually a subdevice proxy
-    //the subdevice proxy is internal to the cpp file
-    uhd::dict<std::string, subdev_proxy::sptr> _rx_dboards;
-    uhd::dict<std::string, subdev_proxy::sptr> _tx_dboards;
+    //the rx and tx holders of a xcvr dboard are the same holder
+    uhd::dict<std::string, dboard_holder::sptr> _rx_dboards;
+    uhd::dict<std::string, dboard_holder::sptr> _tx_dboards;
+    dboard_id_t _rx_dboard_id, _tx_dboard_id;
     dboard_iface::sptr _iface;
+    property_tree::sptr _subtree;
+    bool _defer_init;
     void set_nice_dboard_if(void);
 };
 
@@ -219,10 +449,24 @@ private:
 dboard_manager::sptr dboard_manager::make(
     dboard_id_t rx_dboard_id,
     dboard_id_t tx_dboard_id,
-    dboard_iface::sptr iface
+    dboard_iface::sptr iface,
+    property_tree::sptr subtree,
+    bool defer_init
 ){
     return dboard_manager::sptr(
-        new dboard_manager_impl(rx_dboard_id, tx_dboard_id, iface)
+        new dboard_manager_impl(rx_dboard_id, tx_dboard_id, iface, subtree, defer_init)
+    );
+}
+
+dboard_manager::sptr dboard_manager::make(
+    dboard_id_t rx_dboard_id,
+    dboard_id_t tx_dboard_id,
+    dboard_iface::sptr iface,
+    bool defer_init
+){
+    //the subdevs are made when populate_prop_tree provides the subtree
+    return dboard_manager::sptr(
+        new dboard_manager_impl(rx_dboard_id, tx_dboard_id, iface, property_tree::sptr(), defer_init)
     );
 }
 
@@ -232,15 +476,38 @@ dboard_manager::sptr dboard_manager::make(
 dboard_manager_impl::dboard_manager_impl(
     dboard_id_t rx_dboard_id,
     dboard_id_t tx_dboard_id,
-    dboard_iface::sptr iface
+    dboard_iface::sptr iface,
+    property_tree::sptr subtree,
+    bool defer_init
 ):
-    _iface(iface)
+    _rx_dboard_id(rx_dboard_id),
+    _tx_dboard_id(tx_dboard_id),
+    _iface(iface),
+    _subtree(subtree),
+    _defer_init(defer_init)
 {
+    if (_subtree.get() != NULL) this->populate();
+}
+
+void dboard_manager_impl::populate_prop_tree(property_tree::sptr subtree){
+    if (_subtree.get() != NULL) throw uhd::runtime_error(
+        "The daughterboard manager was made with a subtree, its subdevs already populate it"
+    );
+    _subtree = subtree;
+    this->populate();
+}
+
+void dboard_manager_impl::populate(void){
     try{
-        this->init(rx_dboard_id, tx_dboard_id);
+        this->init(_rx_dboard_id, _tx_dboard_id);
     }
     catch(const std::exception &e){
         UHD_MSG(error) << "The daughterboard manager encountered a recoverable error in init" << std::endl << e.what();
+        //drop what the failed subdevs populated before falling back
+        _rx_dboards = uhd::dict<std::string, dboard_holder::sptr>();
+        _tx_dboards = uhd::dict<std::string, dboard_holder::sptr>();
+        if (_subtree->exists("rx_frontends")) _subtree->remove("rx_frontends");
+        if (_subtree->exists("tx_frontends")) _subtree->remove("tx_frontends");
         this->init(dboard_id_t::none(), dboard_id_t::none());
     }
 }
@@ -291,15 +558,9 @@ void dboard_manager_impl::init(
             db_ctor_args.sd_name = subdev;
             db_ctor_args.rx_id = rx_dboard_id;
             db_ctor_args.tx_id = tx_dboard_id;
-            dboard_base::sptr xcvr_dboard = dboard_ctor(&db_ctor_args);
-            //create a rx proxy for this xcvr board
-            _rx_dboards[subdev] = subdev_proxy::sptr(
-                new subdev_proxy(xcvr_dboard, subdev_proxy::RX_TYPE)
-            );
-            //create a tx proxy for this xcvr board
-            _tx_dboards[subdev] = subdev_proxy::sptr(
-                new subdev_proxy(xcvr_dboard, subdev_proxy::TX_TYPE)
-            );
+            dboard_holder::sptr xcvr_dboard = this->make_holder(dboard_ctor, db_ctor_args, true, true);
+            _rx_dboards[subdev] = xcvr_dboard;
+            _tx_dboards[subdev] = xcvr_dboard;
         }
     }
 
@@ -320,11 +581,7 @@ void dboard_manager_impl::init(
             db_ctor_args.sd_name = subdev;
             db_ctor_args.rx_id = rx_dboard_id;
             db_ctor_args.tx_id = dboard_id_t::none();
-            dboard_base::sptr rx_dboard = rx_dboard_ctor(&db_ctor_args);
-            //create a rx proxy for this rx board
-            _rx_dboards[subdev] = subdev_proxy::sptr(
-                new subdev_proxy(rx_dboard, subdev_proxy::RX_TYPE)
-            );
+            _rx_dboards[subdev] = this->make_holder(rx_dboard_ctor, db_ctor_args, true, false);
         }
 
         //force the tx key to the unknown board for bad combinations
@@ -341,15 +598,36 @@ void dboard_manager_impl::init(
             db_ctor_args.sd_name = subdev;
             db_ctor_args.rx_id = dboard_id_t::none();
             db_ctor_args.tx_id = tx_dboard_id;
-            dboard_base::sptr tx_dboard = tx_dboard_ctor(&db_ctor_args);
-            //create a tx proxy for this tx board
-            _tx_dboards[subdev] = subdev_proxy::sptr(
-                new subdev_proxy(tx_dboard, subdev_proxy::TX_TYPE)
-            );
+            _tx_dboards[subdev] = this->make_holder(tx_dboard_ctor, db_ctor_args, false, true);
         }
     }
 }
 
+dboard_holder::sptr dboard_manager_impl::make_holder(
+    dboard_ctor_t dboard_ctor, dboard_ctor_args_t db_ctor_args,
+    const bool has_rx, const bool has_tx
+){
+    const property_tree::sptr rx_subtree = (has_rx)? _subtree->subtree("rx_frontends/" + db_ctor_args.sd_name) : property_tree::sptr();
+    const property_tree::sptr tx_subtree = (has_tx)? _subtree->subtree("tx_frontends/" + db_ctor_args.sd_name) : property_tree::sptr();
+
+    //the subdev populates the frontend subtrees directly
+    if (not _defer_init){
+        db_ctor_args.rx_subtree = rx_subtree;
+        db_ctor_args.tx_subtree = tx_subtree;
+        dboard_holder::sptr holder(new dboard_holder(boost::bind(&make_dboard, dboard_ctor, db_ctor_args)));
+        holder->get(); //construct now so errors surface in init
+        return holder;
+    }
+
+    //the subdev populates private subtrees that the frontends forward to
+    if (has_rx) db_ctor_args.rx_subtree = property_tree::make();
+    if (has_tx) db_ctor_args.tx_subtree = property_tree::make();
+    dboard_holder::sptr holder(new dboard_holder(boost::bind(&make_dboard, dboard_ctor, db_ctor_args)));
+    if (has_rx) forward_frontend(rx_subtree, holder, db_ctor_args.rx_subtree);
+    if (has_tx) forward_frontend(tx_subtree, holder, db_ctor_args.tx_subtree);
+    return holder;
+}
+
 dboard_manager_impl::~dboard_manager_impl(void){UHD_SAFE_CALL(
     set_nice_dboard_if();
 )}
@@ -362,22 +640,6 @@ prop_names_t dboard_manager_impl::get_tx_subdev_names(void){
     return _tx_dboards.keys();
 }
 
-wax::obj dboard_manager_impl::get_rx_subdev(const std::string &subdev_name){
-    if (not _rx_dboards.has_key(subdev_name)) throw uhd::key_error(
-        str(boost::format("Unknown rx subdev name %s") % subdev_name)
-    );
-    //get a link to the rx subdev proxy
-    return _rx_dboards[subdev_name]->get_link();
-}
-
-wax::obj dboard_manager_impl::get_tx_subdev(const std::string &subdev_name){
-    if (not _tx_dboards.has_key(subdev_name)) throw uhd::key_error(
-        str(boost::format("Unknown tx subdev name %s") % subdev_name)
-    );
-    //get a link to the tx subdev proxy
-    return _tx_dboards[subdev_name]->get_link();
-}
-
 void dboard_manager_impl::set_nice_dboard_if(void){
     //make a list of possible unit types
     std::vector<dboard_iface::unit_t> units = boost::assign::list_of
@@ -393,136 +655,15 @@ void dboard_manager_impl::set_nice_dboard_if(void){
         _iface->set_clock_enabled(unit, false); //clock off
     }
 
-    //disable all rx subdevices
+    //disable all rx subdevices, the deferred ones are not running
     BOOST_FOREACH(const std::string &sd_name, this->get_rx_subdev_names()){
-        this->get_rx_subdev(sd_name)[SUBDEV_PROP_ENABLED] = false;
+        if (not _rx_dboards[sd_name]->is_initialized()) continue;
+        _subtree->access<bool>("rx_frontends/" + sd_name + "/enabled").set(false);
     }
 
-    //disable all tx subdevices
+    //disable all tx subdevices, the deferred ones are not running
     BOOST_FOREACH(const std::string &sd_name, this->get_tx_subdev_names()){
-        this->get_tx_subdev(sd_name)[SUBDEV_PROP_ENABLED] = false;
+        if (not _tx_dboards[sd_name]->is_initialized()) continue;
+        _subtree->access<bool>("tx_frontends/" + sd_name + "/enabled").set(false);
     }
 }
-
-/***********************************************************************
- * Populate a properties tree from a subdev waxy object
- **********************************************************************/
-#include <uhd/types/ranges.hpp>
-#include <uhd/types/sensors.hpp>
-
-static sensor_value_t get_sensor(wax::obj subdev, const std::string &name){
-    return subdev[named_prop_t(SUBDEV_PROP_SENSOR, name)].as<sensor_value_t>();
-}
-
-static void set_gain(wax::obj subdev, const std::string &name, const double gain){
-    subdev[named_prop_t(SUBDEV_PROP_GAIN, name)] = gain;
-}
-
-static double get_gain(wax::obj subdev, const std::string &name){
-    return subdev[named_prop_t(SUBDEV_PROP_GAIN, name)].as<double>();
-}
-
-static meta_range_t get_gain_range(wax::obj subdev, const std::string &name){
-    return subdev[named_prop_t(SUBDEV_PROP_GAIN_RANGE, name)].as<meta_range_t>();
-}
-
-static void set_freq(wax::obj subdev, const double freq){
-    subdev[SUBDEV_PROP_FREQ] = freq;
-}
-
-static double get_freq(wax::obj subdev){
-    return subdev[SUBDEV_PROP_FREQ].as<double>();
-}
-
-static meta_range_t get_freq_range(wax::obj subdev){
-    return subdev[SUBDEV_PROP_FREQ_RANGE].as<meta_range_t>();
-}
-
-static void set_ant(wax::obj subdev, const std::string &ant){
-    subdev[SUBDEV_PROP_ANTENNA] = ant;
-}
-
-static std::string get_ant(wax::obj subdev){
-    return subdev[SUBDEV_PROP_ANTENNA].as<std::string>();
-}
-
-static std::vector<std::string> get_ants(wax::obj subdev){
-    return subdev[SUBDEV_PROP_ANTENNA_NAMES].as<std::vector<std::string> >();
-}
-
-static std::string get_conn(wax::obj subdev){
-    switch(subdev[SUBDEV_PROP_CONNECTION].as<subdev_conn_t>()){
-    case SUBDEV_CONN_COMPLEX_IQ: return "IQ";
-    case SUBDEV_CONN_COMPLEX_QI: return "QI";
-    case SUBDEV_CONN_REAL_I: return "I";
-    case SUBDEV_CONN_REAL_Q: return "Q";
-    }
-    UHD_THROW_INVALID_CODE_PATH();
-}
-
-static bool get_use_lo_off(wax::obj subdev){
-    return subdev[SUBDEV_PROP_USE_LO_OFFSET].as<bool>();
-}
-
-static bool get_set_enb(wax::obj subdev, const bool enb){
-    subdev[SUBDEV_PROP_ENABLED] = enb;
-    return subdev[SUBDEV_PROP_ENABLED].as<bool>();
-}
-
-static void set_bw(wax::obj subdev, const double freq){
-    subdev[SUBDEV_PROP_BANDWIDTH] = freq;
-}
-
-static double get_bw(wax::obj subdev){
-    return subdev[SUBDEV_PROP_BANDWIDTH].as<double>();
-}
-
-void dboard_manager::populate_prop_tree_from_subdev(
-    property_tree::sptr subtree, wax::obj subdev
-){
-    subtree->create<std::string>("name").set(subdev[SUBDEV_PROP_NAME].as<std::string>());
-
-    const prop_names_t sensor_names = subdev[SUBDEV_PROP_SENSOR_NAMES].as<prop_names_t>();
-    subtree->create<int>("sensors"); //phony property so this dir exists
-    BOOST_FOREACH(const std::string &name, sensor_names){
-        subtree->create<sensor_value_t>("sensors/" + name)
-            .publish(boost::bind(&get_sensor, subdev, name));
-    }
-
-    const prop_names_t gain_names = subdev[SUBDEV_PROP_GAIN_NAMES].as<prop_names_t>();
-    subtree->create<int>("gains"); //phony property so this dir exists
-    BOOST_FOREACH(const std::string &name, gain_names){
-        subtree->create<double>("gains/" + name + "/value")
-            .publish(boost::bind(&get_gain, subdev, name))
-            .subscribe(boost::bind(&set_gain, subdev, name, _1));
-        subtree->create<meta_range_t>("gains/" + name + "/range")
-            .publish(boost::bind(&get_gain_range, subdev, name));
-    }
-
-    subtree->create<double>("freq/value")
-        .publish(boost::bind(&get_freq, subdev))
-        .subscribe(boost::bind(&set_freq, subdev, _1));
-
-    subtree->create<meta_range_t>("freq/range")
-        .publish(boost::bind(&get_freq_range, subdev));
-
-    subtree->create<std::string>("antenna/value")
-        .publish(boost::bind(&get_ant, subdev))
-        .subscribe(boost::bind(&set_ant, subdev, _1));
-
-    subtree->create<std::vector<std::string> >("antenna/options")
-        .publish(boost::bind(&get_ants, subdev));
-
-    subtree->create<std::string>("connection")
-        .publish(boost::bind(&get_conn, subdev));
-
-    subtree->create<bool>("enabled")
-        .coerce(boost::bind(&get_set_enb, subdev, _1));
-
-    subtree->create<bool>("use_lo_offset")
-        .publish(boost::bind(&get_use_lo_off, subdev));
-
-    subtree->create<double>("bandwidth/value")
-        .publish(boost::bind(&get_bw, subdev))
-        .subscribe(boost::bind(&set_bw, subdev, _1));
-}
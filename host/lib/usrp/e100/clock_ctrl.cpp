@@ -20,6 +20,7 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/assert_has.hpp>
+#include <uhd/types/dict.hpp>
 #include <boost/cstdint.hpp>
 #include "e100_regs.hpp" //spi slave constants
 #include <boost/assign/list_of.hpp>
@@ -167,10 +168,11 @@ static clock_settings_type get_clock_settings(double rate){
  **********************************************************************/
 class e100_clock_ctrl_impl : public e100_clock_ctrl{
 public:
-    e100_clock_ctrl_impl(spi_iface::sptr iface, double master_clock_rate, const bool dboard_clocks_diff):
+    e100_clock_ctrl_impl(e100_aux_spi_iface::sptr iface, double master_clock_rate, const bool dboard_clocks_diff):
         _dboard_clocks_diff(dboard_clocks_diff)
     {
         _iface = iface;
+        _lock_pending = false;
         _chan_rate = 0.0;
         _out_rate = 0.0;
 
@@ -193,7 +195,7 @@ public:
 
         //initialize the FPGA clock rate
         UHD_MSG(status) << boost::format("Initializing FPGA clock to %fMHz...") % (master_clock_rate/1e6) << std::endl;
-        this->set_fpga_clock_rate(master_clock_rate);
+        this->update_fpga_clock_rate(master_clock_rate); //lock waited on in wait_for_lock()
 
         this->enable_test_clock(ENABLE_THE_TEST_OUT);
         this->enable_rx_dboard_clock(false);
@@ -212,7 +214,10 @@ public:
      *  - set clock rate w/ external VCXO
      **********************************************************************/
     void set_clock_settings_with_internal_vco(double rate){
-        const clock_settings_type cs = get_clock_settings(rate);
+        if (not _clock_settings_cache.has_key(rate)){
+            _clock_settings_cache[rate] = get_clock_settings(rate);
+        }
+        const clock_settings_type cs = _clock_settings_cache[rate];
 
         //set the rates to private variables so the implementation knows!
         _chan_rate = cs.get_chan_rate();
@@ -256,8 +261,10 @@ public:
             _ad9522_regs.divider1_bypass
         );
 
+        //the vco only needs calibrating when the pll setup changed
+        const bool pll_changed = this->regs_changed(0x010, 0x01E) or this->regs_changed(0x1E0, 0x1E1);
         this->send_all_regs();
-        calibrate_now();
+        if (pll_changed) this->start_vco_calibration();
     }
 
     void set_clock_settings_with_external_vcxo(double rate){
@@ -293,6 +300,11 @@ public:
     }
 
     void set_fpga_clock_rate(double rate){
+        this->update_fpga_clock_rate(rate);
+        this->wait_for_lock();
+    }
+
+    void update_fpga_clock_rate(double rate){
         if (_out_rate == rate) return;
         if (rate == 61.44e6) set_clock_settings_with_external_vcxo(rate);
         else                 set_clock_settings_with_internal_vco(rate);
@@ -433,22 +445,35 @@ public:
     }
 
     bool get_locked(void){
-        static const boost::uint8_t addr = 0x01F;
-        boost::uint32_t reg = _iface->read_spi(
-            UE_SPI_SS_AD9522, spi_config_t::EDGE_RISE,
-            _ad9522_regs.get_read_reg(addr), 24
-        );
-        _ad9522_regs.set_reg(addr, reg);
+        this->read_status_reg();
         return _ad9522_regs.digital_lock_detect != 0;
     }
 
+    void wait_for_lock(void){
+        if (not _lock_pending) return;
+        _lock_pending = false;
+        if (not this->poll_status_bit(_ad9522_regs.vco_calibration_finished)){
+            UHD_MSG(error) << "USRP-E100 clock control: VCO calibration timeout" << std::endl;
+        }
+        if (not this->poll_status_bit(_ad9522_regs.digital_lock_detect)){
+            UHD_MSG(error) << "USRP-E100 clock control: lock detection timeout" << std::endl;
+        }
+    }
+
 private:
-    spi_iface::sptr _iface;
+    e100_aux_spi_iface::sptr _iface;
     const bool _dboard_clocks_diff;
     ad9522_regs_t _ad9522_regs;
     double _out_rate; //rate at the fpga and codec
     double _chan_rate; //rate before final dividers
     double _rx_clock_rate, _tx_clock_rate;
+    bool _lock_pending; //vco calibration started but not waited on
+
+    //register values last written to or read from the chip
+    uhd::dict<boost::uint16_t, boost::uint8_t> _reg_shadow;
+
+    //clock settings computed per requested rate
+    uhd::dict<double, clock_settings_type> _clock_settings_cache;
 
     void latch_regs(void){
         _ad9522_regs.io_update = 1;
@@ -458,6 +483,7 @@ private:
     void send_reg(boost::uint16_t addr){
         boost::uint32_t reg = _ad9522_regs.get_write_reg(addr);
         UHD_LOGV(often) << "clock control write reg: " << std::hex << reg << std::endl;
+        _reg_shadow[addr] = boost::uint8_t(reg & 0xff);
         _iface->write_spi(
             UE_SPI_SS_AD9522,
             spi_config_t::EDGE_RISE,
@@ -465,7 +491,17 @@ private:
         );
     }
 
-    void calibrate_now(void){
+    void read_status_reg(void){
+        static const boost::uint16_t addr = 0x01F;
+        boost::uint32_t reg = _iface->read_spi(
+            UE_SPI_SS_AD9522, spi_config_t::EDGE_RISE,
+            _ad9522_regs.get_read_reg(addr), 24
+        );
+        _ad9522_regs.set_reg(addr, reg);
+        _reg_shadow[addr] = boost::uint8_t(_ad9522_regs.get_reg(addr));
+    }
+
+    void start_vco_calibration(void){
         //vco calibration routine:
         _ad9522_regs.vco_calibration_now = 0;
         this->send_reg(0x18);
@@ -473,30 +509,22 @@ private:
         _ad9522_regs.vco_calibration_now = 1;
         this->send_reg(0x18);
         this->latch_regs();
-        //wait for calibration done:
-        static const boost::uint8_t addr = 0x01F;
-        for (size_t ms10 = 0; ms10 < 100; ms10++){
-            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-            boost::uint32_t reg = _iface->read_spi(
-                UE_SPI_SS_AD9522, spi_config_t::EDGE_RISE,
-                _ad9522_regs.get_read_reg(addr), 24
-            );
-            _ad9522_regs.set_reg(addr, reg);
-            if (_ad9522_regs.vco_calibration_finished) goto wait_for_ld;
-        }
-        UHD_MSG(error) << "USRP-E100 clock control: VCO calibration timeout" << std::endl;
-        wait_for_ld:
-        //wait for digital lock detect:
-        for (size_t ms10 = 0; ms10 < 100; ms10++){
-            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-            boost::uint32_t reg = _iface->read_spi(
-                UE_SPI_SS_AD9522, spi_config_t::EDGE_RISE,
-                _ad9522_regs.get_read_reg(addr), 24
-            );
-            _ad9522_regs.set_reg(addr, reg);
-            if (_ad9522_regs.digital_lock_detect) return;
+        _lock_pending = true;
+    }
+
+    /*!
+     * Poll the readback register until a status bit is set.
+     * The bit is a field of the register cache, refreshed by each read.
+     * \return true if the bit was set before the deadline
+     */
+    bool poll_status_bit(const boost::uint8_t &bit){
+        const boost::system_time deadline = boost::get_system_time() + boost::posix_time::seconds(1);
+        while (true){
+            this->read_status_reg();
+            if (bit != 0) return true;
+            if (boost::get_system_time() > deadline) return false;
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
         }
-        UHD_MSG(error) << "USRP-E100 clock control: lock detection timeout" << std::endl;
     }
 
     void soft_sync(void){
@@ -508,6 +536,18 @@ private:
         this->latch_regs();
     }
 
+    bool reg_changed(boost::uint16_t addr){
+        return not _reg_shadow.has_key(addr) or
+            _reg_shadow[addr] != boost::uint8_t(_ad9522_regs.get_reg(addr));
+    }
+
+    bool regs_changed(boost::uint16_t first, boost::uint16_t last){
+        for (boost::uint16_t addr = first; addr <= last; addr++){
+            if (this->reg_changed(addr)) return true;
+        }
+        return false;
+    }
+
     void send_all_regs(void){
         //setup a list of register ranges to write
         typedef std::pair<boost::uint16_t, boost::uint16_t> range_t;
@@ -517,11 +557,26 @@ private:
             (range_t(0x1E0, 0x1E1)) (range_t(0x230, 0x230))
         ;
 
-        //write initial register values and latch/update
+        //stream each range in a single transaction:
+        //in msb first mode the address decrements per byte,
+        //so the instruction names the top of the range;
+        //each range is trimmed to the registers that differ from the chip
         BOOST_FOREACH(const range_t &range, ranges){
-            for(boost::uint16_t addr = range.first; addr <= range.second; addr++){
-                this->send_reg(addr);
+            int first = range.first, last = range.second;
+            while (first <= last and not this->reg_changed(first)) first++;
+            while (last >= first and not this->reg_changed(last)) last--;
+            if (first > last) continue;
+
+            const boost::uint16_t instr = (0x3 << 13) | last; //W1:W0 = streaming
+            byte_vector_t bytes;
+            bytes.push_back(boost::uint8_t(instr >> 8));
+            bytes.push_back(boost::uint8_t(instr & 0xff));
+            for (int addr = last; addr >= first; addr--){
+                bytes.push_back(boost::uint8_t(_ad9522_regs.get_reg(addr)));
+                _reg_shadow[addr] = bytes.back();
             }
+            UHD_LOGV(often) << "clock control stream regs: " << std::hex << first << "-" << last << std::endl;
+            _iface->write_spi_stream(bytes);
         }
         this->latch_regs();
     }
@@ -530,6 +585,6 @@ private:
 /***********************************************************************
  * Clock Control Make
  **********************************************************************/
-e100_clock_ctrl::sptr e100_clock_ctrl::make(spi_iface::sptr iface, double master_clock_rate, const bool dboard_clocks_diff){
+e100_clock_ctrl::sptr e100_clock_ctrl::make(e100_aux_spi_iface::sptr iface, double master_clock_rate, const bool dboard_clocks_diff){
     return sptr(new e100_clock_ctrl_impl(iface, master_clock_rate, dboard_clocks_diff));
 }
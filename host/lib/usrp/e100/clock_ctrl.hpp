@@ -18,6 +18,7 @@
 #ifndef INCLUDED_USRP_E100_CLOCK_CTRL_HPP
 #define INCLUDED_USRP_E100_CLOCK_CTRL_HPP
 
+#include "e100_ctrl.hpp"
 #include <uhd/types/serial.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
@@ -34,12 +35,12 @@ public:
 
     /*!
      * Make a new clock control object.
-     * \param iface the spi iface object
+     * \param iface the aux spi iface object
      * \param master clock rate the FPGA rate
      * param dboard_clocks_diff are they differential?
      * \return the clock control object
      */
-    static sptr make(uhd::spi_iface::sptr iface, double master_clock_rate, const bool dboard_clocks_diff);
+    static sptr make(e100_aux_spi_iface::sptr iface, double master_clock_rate, const bool dboard_clocks_diff);
 
     /*!
      * Set the rate of the fpga clock line.
@@ -122,6 +123,14 @@ public:
     //! Is the reference locked?
     virtual bool get_locked(void) = 0;
 
+    /*!
+     * Wait for the VCO calibration and PLL lock started by make().
+     * The constructor does not block on lock, so the caller can
+     * do unrelated work (like loading the FPGA) in the meantime.
+     * Call this before anything that needs a stable clock.
+     */
+    virtual void wait_for_lock(void) = 0;
+
 };
 
 #endif /* INCLUDED_USRP_E100_CLOCK_CTRL_HPP */
@@ -16,6 +16,7 @@
 //
 
 #include "wb_iface.hpp"
+#include "spi_core_100.hpp"
 #include <uhd/types/serial.hpp>
 #include "e100_regs.hpp"
 #include "clock_ctrl.hpp"
@@ -36,7 +37,7 @@ public:
     e100_dboard_iface(
         wb_iface::sptr wb_iface,
         i2c_iface::sptr i2c_iface,
-        spi_iface::sptr spi_iface,
+        spi_core_100::sptr spi_iface,
         e100_clock_ctrl::sptr clock,
         e100_codec_ctrl::sptr codec
     ){
@@ -85,6 +86,13 @@ public:
         size_t num_bits
     );
 
+    void write_spi_batch(
+        unit_t unit,
+        const spi_config_t &config,
+        const std::vector<boost::uint32_t> &data,
+        size_t num_bits
+    );
+
     boost::uint32_t read_write_spi(
         unit_t unit,
         const spi_config_t &config,
@@ -101,7 +109,7 @@ public:
 private:
     wb_iface::sptr _wb_iface;
     i2c_iface::sptr _i2c_iface;
-    spi_iface::sptr _spi_iface;
+    spi_core_100::sptr _spi_iface;
     e100_clock_ctrl::sptr _clock;
     e100_codec_ctrl::sptr _codec;
 };
@@ -112,7 +120,7 @@ private:
 dboard_iface::sptr make_e100_dboard_iface(
     wb_iface::sptr wb_iface,
     i2c_iface::sptr i2c_iface,
-    spi_iface::sptr spi_iface,
+    spi_core_100::sptr spi_iface,
     e100_clock_ctrl::sptr clock,
     e100_codec_ctrl::sptr codec
 ){
@@ -258,6 +266,15 @@ void e100_dboard_iface::write_spi(
     _spi_iface->write_spi(unit_to_otw_spi_dev(unit), config, data, num_bits);
 }
 
+void e100_dboard_iface::write_spi_batch(
+    unit_t unit,
+    const spi_config_t &config,
+    const std::vector<boost::uint32_t> &data,
+    size_t num_bits
+){
+    _spi_iface->write_spi_burst(unit_to_otw_spi_dev(unit), config, data, num_bits);
+}
+
 boost::uint32_t e100_dboard_iface::read_write_spi(
     unit_t unit,
     const spi_config_t &config,
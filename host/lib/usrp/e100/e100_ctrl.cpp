@@ -21,6 +21,7 @@
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/msg.hpp>
 #include <sys/ioctl.h> //ioctl
+#include <sys/mman.h> //mmap
 #include <fcntl.h> //open, close
 #include <linux/usrp_e.h> //ioctl structures and constants
 #include <boost/thread/thread.hpp> //sleep
@@ -32,14 +33,68 @@
 using namespace uhd;
 
 /***********************************************************************
- * Sysfs GPIO wrapper class
+ * Memory mapped OMAP3 GPIO registers:
+ * Each bank of 32 gpios is a page of registers in /dev/mem.
+ * The set and clear data out registers change single pins
+ * without a read modify write, and without a syscall per pin.
+ **********************************************************************/
+static const off_t omap_gpio_bank_addrs[] = {
+    0x48310000, 0x49050000, 0x49052000, 0x49054000, 0x49056000, 0x49058000
+};
+static const size_t omap_gpio_num_banks = sizeof(omap_gpio_bank_addrs)/sizeof(off_t);
+static const size_t omap_gpio_bank_size = 0x1000;
+
+//register offsets as word indexes into a bank
+static const size_t OMAP_GPIO_DATAIN = 0x038/4;
+static const size_t OMAP_GPIO_DATAOUT = 0x03C/4;
+static const size_t OMAP_GPIO_CLEARDATAOUT = 0x090/4;
+static const size_t OMAP_GPIO_SETDATAOUT = 0x094/4;
+
+class omap_gpio_regs : boost::noncopyable{
+public:
+    omap_gpio_regs(void){
+        _fd = ::open("/dev/mem", O_RDWR | O_SYNC);
+        for (size_t i = 0; i < omap_gpio_num_banks; i++) _banks[i] = MAP_FAILED;
+    }
+    ~omap_gpio_regs(void){
+        for (size_t i = 0; i < omap_gpio_num_banks; i++){
+            if (_banks[i] != MAP_FAILED) ::munmap(_banks[i], omap_gpio_bank_size);
+        }
+        if (_fd >= 0) ::close(_fd);
+    }
+
+    //! get the registers of the bank with this gpio or NULL when unavailable
+    volatile boost::uint32_t *get_bank(const int num){
+        const size_t bank = size_t(num)/32;
+        if (_fd < 0 or bank >= omap_gpio_num_banks) return NULL;
+        if (_banks[bank] == MAP_FAILED) _banks[bank] = ::mmap(
+            NULL, omap_gpio_bank_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, omap_gpio_bank_addrs[bank]
+        );
+        if (_banks[bank] == MAP_FAILED) return NULL;
+        return reinterpret_cast<volatile boost::uint32_t *>(_banks[bank]);
+    }
+
+private:
+    int _fd;
+    void *_banks[sizeof(omap_gpio_bank_addrs)/sizeof(off_t)];
+};
+
+/***********************************************************************
+ * Sysfs GPIO wrapper class:
+ * Sysfs exports the pin and sets the direction.
+ * The value goes through the mapped registers when they agree with sysfs,
+ * otherwise through the sysfs value file.
  **********************************************************************/
 class gpio{
 public:
-    gpio(const int num, const std::string &dir) : _num(num){
+    gpio(const int num, const std::string &dir, omap_gpio_regs &regs) : _num(num){
         this->set_xport("export");
         this->set_dir(dir);
         _value_file.open(str(boost::format("/sys/class/gpio/gpio%d/value") % num).c_str(), std::ios_base::in | std::ios_base::out);
+
+        _mask = boost::uint32_t(1) << (num % 32);
+        _bank = regs.get_bank(num);
+        if (_bank != NULL and not this->check_bank(dir)) _bank = NULL;
     }
     ~gpio(void){
         _value_file.close();
@@ -47,13 +102,18 @@ public:
         this->set_xport("unexport");
     }
     void operator()(const int val){
+        if (_bank != NULL){
+            _bank[(val)? OMAP_GPIO_SETDATAOUT : OMAP_GPIO_CLEARDATAOUT] = _mask;
+            return;
+        }
         _value_file << val << std::endl << std::flush;
     }
     int operator()(void){
-        std::string val;
-        std::getline(_value_file, val);
-        _value_file.seekg(0);
-        return int(val.at(0) - '0') & 0x1;
+        if (_bank != NULL) return ((_bank[OMAP_GPIO_DATAIN] & _mask) != 0)? 1 : 0;
+        return this->read_value_file();
+    }
+    bool is_mapped(void) const{
+        return _bank != NULL;
     }
 private:
     void set_xport(const std::string &xport){
@@ -66,20 +126,48 @@ private:
         dir_file << dir << std::endl << std::flush;
         dir_file.close();
     }
+    int read_value_file(void){
+        std::string val;
+        std::getline(_value_file, val);
+        _value_file.seekg(0);
+        return int(val.at(0) - '0') & 0x1;
+    }
+
+    //! does the mapped bank read back what sysfs reports for this pin?
+    bool check_bank(const std::string &dir){
+        if (dir == "out"){ //ends high: the idle level of the clock and enable lines
+            for (int val = 0; val <= 1; val++){
+                _value_file << val << std::endl << std::flush;
+                if (((_bank[OMAP_GPIO_DATAOUT] & _mask) != 0) != (val != 0)) return false;
+            }
+            return true;
+        }
+        return ((_bank[OMAP_GPIO_DATAIN] & _mask) != 0) == (this->read_value_file() != 0);
+    }
+
     const int _num;
     std::fstream _value_file;
+    volatile boost::uint32_t *_bank;
+    boost::uint32_t _mask;
 };
 
 /***********************************************************************
  * Aux spi implementation
  **********************************************************************/
-class aux_spi_iface_impl : public spi_iface{
+class aux_spi_iface_impl : public e100_aux_spi_iface{
 public:
     aux_spi_iface_impl(void):
-        spi_sclk_gpio(65, "out"),
-        spi_sen_gpio(186, "out"),
-        spi_mosi_gpio(145, "out"),
-        spi_miso_gpio(147, "in"){}
+        spi_sclk_gpio(65, "out", _gpio_regs),
+        spi_sen_gpio(186, "out", _gpio_regs),
+        spi_mosi_gpio(145, "out", _gpio_regs),
+        spi_miso_gpio(147, "in", _gpio_regs)
+    {
+        //the register accesses are slow enough to meet the spi timing,
+        //only the sysfs writes need the settling sleeps
+        _mapped = spi_sclk_gpio.is_mapped() and spi_sen_gpio.is_mapped()
+            and spi_mosi_gpio.is_mapped() and spi_miso_gpio.is_mapped();
+        UHD_LOG << "aux spi through " << ((_mapped)? "mapped gpio registers" : "sysfs gpio") << std::endl;
+    }
 
     boost::uint32_t transact_spi(
         int, const spi_config_t &, //not used params
@@ -87,29 +175,47 @@ public:
         size_t num_bits,
         bool readback
     ){
-        boost::uint32_t rb_bits = 0;
         this->spi_sen_gpio(0);
+        const boost::uint32_t rb_bits = this->clock_bits(bits, num_bits, readback);
+        this->spi_sen_gpio(1);
+        this->settle(100);
+        return rb_bits;
+    }
 
+    void write_spi_stream(const byte_vector_t &bytes){
+        this->spi_sen_gpio(0);
+        BOOST_FOREACH(boost::uint8_t byte, bytes){
+            this->clock_bits(byte, 8, false);
+        }
+        this->spi_sen_gpio(1);
+        this->settle(100);
+    }
+
+private:
+    omap_gpio_regs _gpio_regs; //declared before the gpios that use it
+    gpio spi_sclk_gpio, spi_sen_gpio, spi_mosi_gpio, spi_miso_gpio;
+    bool _mapped;
+
+    void settle(const long us){
+        if (not _mapped) boost::this_thread::sleep(boost::posix_time::microseconds(us));
+    }
+
+    boost::uint32_t clock_bits(boost::uint32_t bits, size_t num_bits, bool readback){
+        boost::uint32_t rb_bits = 0;
         for (size_t i = 0; i < num_bits; i++){
             this->spi_sclk_gpio(0);
             this->spi_mosi_gpio((bits >> (num_bits-i-1)) & 0x1);
-            boost::this_thread::sleep(boost::posix_time::microseconds(10));
+            this->settle(10);
             if (readback) rb_bits = (rb_bits << 1) | this->spi_miso_gpio();
             this->spi_sclk_gpio(1);
-            boost::this_thread::sleep(boost::posix_time::microseconds(10));
+            this->settle(10);
         }
-
-        this->spi_sen_gpio(1);
-        boost::this_thread::sleep(boost::posix_time::microseconds(100));
         return rb_bits;
     }
-
-private:
-    gpio spi_sclk_gpio, spi_sen_gpio, spi_mosi_gpio, spi_miso_gpio;
 };
 
-uhd::spi_iface::sptr e100_ctrl::make_aux_spi_iface(void){
-    return uhd::spi_iface::sptr(new aux_spi_iface_impl());
+e100_aux_spi_iface::sptr e100_ctrl::make_aux_spi_iface(void){
+    return e100_aux_spi_iface::sptr(new aux_spi_iface_impl());
 }
 
 /***********************************************************************
@@ -273,11 +379,25 @@ public:
             ) % USRP_E_COMPAT_NUMBER % module_compat_num));
         }
 
+        //map the control window, or peek and poke through the ioctls
+        _ctl_mem = NULL;
+        _ctl_size = 0;
+        usrp_e_ctl_mmap_info info;
+        if (::ioctl(_node_fd, USRP_E_GET_CTL_MMAP_INFO, &info) >= 0){
+            void *mem = ::mmap(NULL, info.size, PROT_READ | PROT_WRITE, MAP_SHARED, _node_fd, info.offset);
+            if (mem != MAP_FAILED){
+                _ctl_mem = reinterpret_cast<char *>(mem);
+                _ctl_size = info.size;
+            }
+        }
+        UHD_LOG << "mapped control window: " << _ctl_size << " bytes" << std::endl;
+
         //perform a global reset after opening
         this->poke32(E100_REG_GLOBAL_RESET, 0);
     }
 
     ~e100_ctrl_impl(void){
+        if (_ctl_mem != NULL) ::munmap(_ctl_mem, _ctl_size);
         ::close(_node_fd);
     }
 
@@ -294,9 +414,18 @@ public:
         }
     }
     /*******************************************************************
-     * Peek and Poke
+     * Peek and Poke:
+     * Through the mapped window, an access is a volatile load or store
+     * between barriers, so it stays in program order with the others.
      ******************************************************************/
     void poke32(wb_addr_type addr, boost::uint32_t value){
+        if (this->mapped(addr, sizeof(value))){
+            mem_barrier();
+            *reinterpret_cast<volatile boost::uint32_t *>(_ctl_mem + addr) = value;
+            mem_barrier();
+            return;
+        }
+
         //load the data struct
         usrp_e_ctl32 data;
         data.offset = addr;
@@ -308,6 +437,13 @@ public:
     }
 
     void poke16(wb_addr_type addr, boost::uint16_t value){
+        if (this->mapped(addr, sizeof(value))){
+            mem_barrier();
+            *reinterpret_cast<volatile boost::uint16_t *>(_ctl_mem + addr) = value;
+            mem_barrier();
+            return;
+        }
+
         //load the data struct
         usrp_e_ctl16 data;
         data.offset = addr;
@@ -319,6 +455,13 @@ public:
     }
 
     boost::uint32_t peek32(wb_addr_type addr){
+        if (this->mapped(addr, sizeof(boost::uint32_t))){
+            mem_barrier();
+            const boost::uint32_t value = *reinterpret_cast<volatile boost::uint32_t *>(_ctl_mem + addr);
+            mem_barrier();
+            return value;
+        }
+
         //load the data struct
         usrp_e_ctl32 data;
         data.offset = addr;
@@ -331,6 +474,13 @@ public:
     }
 
     boost::uint16_t peek16(wb_addr_type addr){
+        if (this->mapped(addr, sizeof(boost::uint16_t))){
+            mem_barrier();
+            const boost::uint16_t value = *reinterpret_cast<volatile boost::uint16_t *>(_ctl_mem + addr);
+            mem_barrier();
+            return value;
+        }
+
         //load the data struct
         usrp_e_ctl16 data;
         data.offset = addr;
@@ -345,6 +495,18 @@ public:
 private:
     int _node_fd;
     boost::mutex _ioctl_mutex;
+    char *_ctl_mem; //mapped control window or NULL
+    size_t _ctl_size;
+
+    UHD_INLINE bool mapped(wb_addr_type addr, size_t num_bytes) const{
+        return _ctl_mem != NULL and size_t(addr) + num_bytes <= _ctl_size;
+    }
+
+    static UHD_INLINE void mem_barrier(void){
+        #if defined(__GNUC__)
+        __sync_synchronize();
+        #endif
+    }
 };
 
 /***********************************************************************
@@ -23,6 +23,22 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
 
+/*!
+ * The aux spi bus to the clock generator is bit-banged over gpios.
+ * Besides 32-bit transactions, it can clock out an arbitrary
+ * stream of bytes under a single chip select.
+ */
+class e100_aux_spi_iface : boost::noncopyable, public uhd::spi_iface{
+public:
+    typedef boost::shared_ptr<e100_aux_spi_iface> sptr;
+
+    /*!
+     * Write a stream of bytes under one chip select, MSB first.
+     * \param bytes the bytes to clock out in order
+     */
+    virtual void write_spi_stream(const uhd::byte_vector_t &bytes) = 0;
+};
+
 class e100_ctrl : boost::noncopyable, public wb_iface{
 public:
     typedef boost::shared_ptr<e100_ctrl> sptr;
@@ -33,8 +49,8 @@ public:
     //! Make an i2c iface for the i2c device node
     static uhd::i2c_iface::sptr make_dev_i2c_iface(const std::string &node);
 
-    //! Make an i2c iface for the i2c device node
-    static uhd::spi_iface::sptr make_aux_spi_iface(void);
+    //! Make an spi iface for the aux spi bus
+    static e100_aux_spi_iface::sptr make_aux_spi_iface(void);
 
     //! Make a uart iface for the uart device node
     static uhd::uart_iface::sptr make_gps_uart_iface(const std::string &node);
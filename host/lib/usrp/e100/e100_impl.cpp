@@ -89,7 +89,17 @@ static size_t hash_fpga_file(const std::string &file_path){
     size_t hash = 0;
     std::ifstream file(file_path.c_str());
     if (not file.good()) throw uhd::io_error("cannot open fpga file for read: " + file_path);
-    while (file.good()) boost::hash_combine(hash, file.get());
+    //read in blocks, but hash the same values as a get() per byte,
+    //so an image that is already loaded still matches its readback
+    char buf[4096];
+    do{
+        file.read(buf, sizeof(buf));
+        const std::streamsize n = file.gcount();
+        for (std::streamsize i = 0; i < n; i++){
+            boost::hash_combine(hash, std::char_traits<char>::to_int_type(buf[i]));
+        }
+    } while (file.good());
+    boost::hash_combine(hash, std::char_traits<char>::eof());
     file.close();
     return hash;
 }
@@ -128,17 +138,16 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
     const std::string e100_fpga_image = find_image_path(device_addr.get("fpga", default_fpga_file_name));
     const boost::uint32_t file_hash = boost::uint32_t(hash_fpga_file(e100_fpga_image));
 
-    //When the hash does not match:
+    //When the hash does not match, the fpga gets reloaded:
     // - close the device node
     // - load the fpga bin file
     // - re-open the device node
-    if (_fpga_ctrl->peek32(E100_REG_RB_MISC_TEST32) != file_hash){
-        _fpga_ctrl.reset();
-        e100_load_fpga(e100_fpga_image);
-        _fpga_ctrl = e100_ctrl::make(node);
-    }
+    const bool reload_fpga = _fpga_ctrl->peek32(E100_REG_RB_MISC_TEST32) != file_hash;
+    if (reload_fpga) _fpga_ctrl.reset();
 
     //setup clock control here to ensure that the FPGA has a good clock before we continue
+    //the clock generator is on the aux spi bus, not behind the FPGA,
+    //so the VCO calibrates while a new FPGA image is being loaded
     bool dboard_clocks_diff = true;
     if      (mb_eeprom.get("revision", "0") == "3") dboard_clocks_diff = false;
     else if (mb_eeprom.get("revision", "0") == "4") dboard_clocks_diff = true;
@@ -150,6 +159,10 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
     _aux_spi_iface = e100_ctrl::make_aux_spi_iface();
     _clock_ctrl = e100_clock_ctrl::make(_aux_spi_iface, master_clock_rate, dboard_clocks_diff);
 
+    if (reload_fpga) e100_load_fpga(e100_fpga_image);
+    _clock_ctrl->wait_for_lock();
+    if (reload_fpga) _fpga_ctrl = e100_ctrl::make(node);
+
     //Perform wishbone readback tests, these tests also write the hash
     bool test_fail = false;
     UHD_MSG(status) << "Performing wishbone readback test... " << std::flush;
@@ -182,7 +195,8 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
     ////////////////////////////////////////////////////////////////////
     _fpga_i2c_ctrl = i2c_core_100::make(_fpga_ctrl, E100_REG_SLAVE(3));
     _fpga_spi_ctrl = spi_core_100::make(_fpga_ctrl, E100_REG_SLAVE(2));
-    _data_transport = e100_make_mmap_zero_copy(_fpga_ctrl);
+    _memory_budget = memory_budget::make(device_addr);
+    _data_transport = e100_make_mmap_zero_copy(_fpga_ctrl, _memory_budget, device_addr);
 
     ////////////////////////////////////////////////////////////////////
     // Initialize the properties tree
@@ -238,18 +252,20 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
     catch(std::exception &e){
         UHD_MSG(error) << "An error occurred making GPSDO control: " << e.what() << std::endl;
     }
-    if (_gps.get() != NULL and _gps->gps_detected()){
-        BOOST_FOREACH(const std::string &name, _gps->get_sensors()){
-            _tree->create<sensor_value_t>(mb_path / "sensors" / name)
-                .publish(boost::bind(&gps_ctrl::get_sensor, _gps, name));
-        }
-    }
+    //the gps is detected in the background, its sensors are added after the init
 
     ////////////////////////////////////////////////////////////////////
     // create frontend control objects
     ////////////////////////////////////////////////////////////////////
-    _rx_fe = rx_frontend_core_200::make(_fpga_ctrl, E100_REG_SR_ADDR(UE_SR_RX_FRONT));
-    _tx_fe = tx_frontend_core_200::make(_fpga_ctrl, E100_REG_SR_ADDR(UE_SR_TX_FRONT));
+    //cache the settings registers of the frontend and dsp cores
+    _wb_cache = wb_cache_iface::make(_fpga_ctrl);
+    _wb_cache->add_range(E100_REG_SR_ADDR(UE_SR_RX_FRONT), 5);
+    _wb_cache->add_range(E100_REG_SR_ADDR(UE_SR_RX_DSP0), 4);
+    _wb_cache->add_range(E100_REG_SR_ADDR(UE_SR_RX_DSP1), 4);
+    _wb_cache->add_range(E100_REG_SR_ADDR(UE_SR_TX_FRONT), 5);
+    _wb_cache->add_range(E100_REG_SR_ADDR(UE_SR_TX_DSP), 3);
+    _rx_fe = rx_frontend_core_200::make(_wb_cache, E100_REG_SR_ADDR(UE_SR_RX_FRONT));
+    _tx_fe = tx_frontend_core_200::make(_wb_cache, E100_REG_SR_ADDR(UE_SR_TX_FRONT));
     //TODO lots of properties to expose here for frontends
     _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec")
         .subscribe(boost::bind(&e100_impl::update_rx_subdev_spec, this, _1));
@@ -260,10 +276,10 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
     // create rx dsp control objects
     ////////////////////////////////////////////////////////////////////
     _rx_dsps.push_back(rx_dsp_core_200::make(
-        _fpga_ctrl, E100_REG_SR_ADDR(UE_SR_RX_DSP0), E100_REG_SR_ADDR(UE_SR_RX_CTRL0), E100_RX_SID_BASE + 0
+        _wb_cache, E100_REG_SR_ADDR(UE_SR_RX_DSP0), E100_REG_SR_ADDR(UE_SR_RX_CTRL0), E100_RX_SID_BASE + 0
     ));
     _rx_dsps.push_back(rx_dsp_core_200::make(
-        _fpga_ctrl, E100_REG_SR_ADDR(UE_SR_RX_DSP1), E100_REG_SR_ADDR(UE_SR_RX_CTRL1), E100_RX_SID_BASE + 1
+        _wb_cache, E100_REG_SR_ADDR(UE_SR_RX_DSP1), E100_REG_SR_ADDR(UE_SR_RX_CTRL1), E100_RX_SID_BASE + 1
     ));
     for (size_t dspno = 0; dspno < _rx_dsps.size(); dspno++){
         _rx_dsps[dspno]->set_link_rate(E100_RX_LINK_RATE_BPS);
@@ -285,7 +301,7 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
     // create tx dsp control objects
     ////////////////////////////////////////////////////////////////////
     _tx_dsp = tx_dsp_core_200::make(
-        _fpga_ctrl, E100_REG_SR_ADDR(UE_SR_TX_DSP), E100_REG_SR_ADDR(UE_SR_TX_CTRL), E100_TX_ASYNC_SID
+        _wb_cache, E100_REG_SR_ADDR(UE_SR_TX_DSP), E100_REG_SR_ADDR(UE_SR_TX_CTRL), E100_TX_ASYNC_SID
     );
     _tx_dsp->set_link_rate(E100_TX_LINK_RATE_BPS);
     _tree->access<double>(mb_path / "tick_rate")
@@ -355,23 +371,13 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
     _dboard_manager = dboard_manager::make(
         rx_db_eeprom.id,
         ((gdb_eeprom.id == dboard_id_t::none())? tx_db_eeprom : gdb_eeprom).id,
-        _dboard_iface
+        _dboard_iface,
+        _tree->subtree(mb_path / "dboards/A"),
+        device_addr.has_key("defer_dboard_init")
     );
-    BOOST_FOREACH(const std::string &name, _dboard_manager->get_rx_subdev_names()){
-        dboard_manager::populate_prop_tree_from_subdev(
-            _tree->subtree(mb_path / "dboards/A/rx_frontends" / name),
-            _dboard_manager->get_rx_subdev(name)
-        );
-    }
-    BOOST_FOREACH(const std::string &name, _dboard_manager->get_tx_subdev_names()){
-        dboard_manager::populate_prop_tree_from_subdev(
-            _tree->subtree(mb_path / "dboards/A/tx_frontends" / name),
-            _dboard_manager->get_tx_subdev(name)
-        );
-    }
 
     //initialize io handling
-    this->io_init();
+    this->io_init(device_addr);
 
     ////////////////////////////////////////////////////////////////////
     // do some post-init tasks
@@ -394,6 +400,10 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
 
     //GPS installed: use external ref, time, and init time spec
     if (_gps.get() != NULL and _gps->gps_detected()){
+        BOOST_FOREACH(const std::string &name, _gps->get_sensors()){
+            _tree->create<sensor_value_t>(mb_path / "sensors" / name)
+                .publish(boost::bind(&gps_ctrl::get_sensor, _gps, name));
+        }
         UHD_MSG(status) << "Setting references to the internal GPSDO" << std::endl;
         _tree->access<std::string>(mb_path / "time_source/value").set("external");
         _tree->access<std::string>(mb_path / "clock_source/value").set("external");
@@ -401,10 +411,18 @@ e100_impl::e100_impl(const uhd::device_addr_t &device_addr){
         _time64->set_time_next_pps(time_spec_t(time_t(_gps->get_sensor("gps_time").to_int()+1)));
     }
 
+    //export the counters from a thread, with the telemetry device address keys
+    _telemetry = telemetry_exporter::make(device_addr, _tree);
+
+    //share the tree with the local tools, with the prop_socket device address key
+    if (device_addr.has_key("prop_socket")){
+        _prop_server = property_server::make(_tree, device_addr["prop_socket"]);
+    }
 }
 
 e100_impl::~e100_impl(void){
-    /* NOP */
+    _prop_server.reset();
+    _telemetry.reset(); //stop reading the tree first
 }
 
 double e100_impl::update_rx_codec_gain(const double gain){
@@ -25,6 +25,10 @@
 #include "rx_dsp_core_200.hpp"
 #include "tx_dsp_core_200.hpp"
 #include "time64_core_200.hpp"
+#include "wb_cache_iface.hpp"
+#include "memory_budget.hpp"
+#include "telemetry.hpp"
+#include <uhd/usrp/property_broker.hpp>
 #include <uhd/device.hpp>
 #include <uhd/property_tree.hpp>
 #include <uhd/utils/pimpl.hpp>
@@ -38,11 +42,15 @@
 #include <uhd/types/stream_cmd.hpp>
 #include <uhd/usrp/dboard_manager.hpp>
 #include <uhd/transport/zero_copy.hpp>
+#include <boost/function.hpp>
 
 #ifndef INCLUDED_E100_IMPL_HPP
 #define INCLUDED_E100_IMPL_HPP
 
-uhd::transport::zero_copy_if::sptr e100_make_mmap_zero_copy(e100_ctrl::sptr iface);
+uhd::transport::zero_copy_if::sptr e100_make_mmap_zero_copy(
+    e100_ctrl::sptr iface, uhd::usrp::memory_budget::sptr budget,
+    const uhd::device_addr_t &hints = uhd::device_addr_t()
+);
 
 // = gpmc_clock_rate/clk_div/cycles_per_transaction*bytes_per_transaction
 static const double          E100_RX_LINK_RATE_BPS = 166e6/3/2*2;
@@ -54,14 +62,20 @@ static const boost::uint32_t E100_RX_SID_BASE = 2;
 static const boost::uint32_t E100_TX_ASYNC_SID = 1;
 static const double          E100_DEFAULT_CLOCK_RATE = 64e6;
 
-//! load an fpga image from a bin file into the usrp-e fpga
-extern void e100_load_fpga(const std::string &bin_file);
+/*!
+ * Load an fpga image from a bin file into the usrp-e fpga.
+ * The optional progress callback is given the fraction of the image sent.
+ */
+extern void e100_load_fpga(
+    const std::string &bin_file,
+    const boost::function<void(double)> &progress = boost::function<void(double)>()
+);
 
 //! Make an e100 dboard interface
 uhd::usrp::dboard_iface::sptr make_e100_dboard_iface(
     wb_iface::sptr wb_iface,
     uhd::i2c_iface::sptr i2c_iface,
-    uhd::spi_iface::sptr spi_iface,
+    spi_core_100::sptr spi_iface,
     e100_clock_ctrl::sptr clock,
     e100_codec_ctrl::sptr codec
 );
@@ -80,7 +94,13 @@ public:
     //the io interface
     size_t send(const send_buffs_type &, size_t, const uhd::tx_metadata_t &, const uhd::io_type_t &, send_mode_t, double);
     size_t recv(const recv_buffs_type &, size_t, uhd::rx_metadata_t &, const uhd::io_type_t &, recv_mode_t, double);
+    size_t recv_full_buff(const recv_buffs_type &, size_t, recv_metadata_array_type &, const uhd::io_type_t &, double);
+    size_t recv_view(recv_view_t &, double);
+    size_t get_send_view(send_view_t &, double);
+    size_t commit_send_view(send_view_t &, size_t, double);
     bool recv_async_msg(uhd::async_metadata_t &, double);
+    uhd::transport::poll_fds_t get_recv_poll_fds(void);
+    uhd::transport::poll_fds_t get_async_msg_poll_fds(void);
     size_t get_max_send_samps_per_packet(void) const;
     size_t get_max_recv_samps_per_packet(void) const;
 
@@ -90,6 +110,7 @@ private:
     //controllers
     spi_core_100::sptr _fpga_spi_ctrl;
     i2c_core_100::sptr _fpga_i2c_ctrl;
+    wb_cache_iface::sptr _wb_cache;
     rx_frontend_core_200::sptr _rx_fe;
     tx_frontend_core_200::sptr _tx_fe;
     std::vector<rx_dsp_core_200::sptr> _rx_dsps;
@@ -99,11 +120,12 @@ private:
     e100_codec_ctrl::sptr _codec_ctrl;
     e100_ctrl::sptr _fpga_ctrl;
     uhd::i2c_iface::sptr _dev_i2c_iface;
-    uhd::spi_iface::sptr _aux_spi_iface;
+    e100_aux_spi_iface::sptr _aux_spi_iface;
     uhd::gps_ctrl::sptr _gps;
 
     //transports
     uhd::transport::zero_copy_if::sptr _data_transport;
+    uhd::usrp::memory_budget::sptr _memory_budget;
 
     //dboard stuff
     uhd::usrp::dboard_manager::sptr _dboard_manager;
@@ -112,7 +134,7 @@ private:
     //handle io stuff
     uhd::otw_type_t _rx_otw_type, _tx_otw_type;
     UHD_PIMPL_DECL(io_impl) _io_impl;
-    void io_init(void);
+    void io_init(const uhd::device_addr_t &);
 
     //device properties interface
     uhd::property_tree::sptr get_tree(void) const{
@@ -130,6 +152,10 @@ private:
     void update_clock_source(const std::string &);
     uhd::sensor_value_t get_ref_locked(void);
 
+
+    //last, so the exporter thread stops before the rest goes away
+    uhd::usrp::telemetry_exporter::sptr _telemetry;
+    uhd::usrp::property_server::sptr _prop_server;
 };
 
 #endif /* INCLUDED_E100_IMPL_HPP */
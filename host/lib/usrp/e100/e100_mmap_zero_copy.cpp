@@ -16,20 +16,33 @@
 //
 
 #include "e100_ctrl.hpp"
+#include "memory_budget.hpp"
 #include <uhd/transport/zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/exception.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
 #include <linux/usrp_e.h>
 #include <sys/mman.h> //mmap
+#include <sys/ioctl.h> //ioctl
 #include <unistd.h> //getpagesize
 #include <poll.h> //poll
+#include <cerrno>
+#include <algorithm>
 #include <vector>
 
 using namespace uhd;
 using namespace uhd::transport;
 
 #define fp_verbose false //fast-path verbose
-static const size_t poll_breakout = 10; //how many poll timeouts constitute a full timeout
+
+//The longest time that a committed send frame should wait for the kick
+static const double DEFAULT_SEND_BATCH_TIMEOUT = 0.001;
+
+//Wakeups without the awaited frame before the wait sleeps between checks
+static const size_t MAX_EARLY_WAKEUPS = 4;
+static const long EARLY_WAKEUP_SLEEP_US = 100;
 
 /***********************************************************************
  * Reusable managed receiver buffer:
@@ -37,13 +50,14 @@ static const size_t poll_breakout = 10; //how many poll timeouts constitute a fu
  **********************************************************************/
 class e100_mmap_zero_copy_mrb : public managed_recv_buffer{
 public:
-    e100_mmap_zero_copy_mrb(void *mem, ring_buffer_info *info):
-        _mem(mem), _info(info) { /* NOP */ }
+    e100_mmap_zero_copy_mrb(void *mem, ring_buffer_info *info, zero_copy_stats_t &stats):
+        _mem(mem), _info(info), _stats(stats) { /* NOP */ }
 
     void release(void){
         if (_info->flags != RB_USER_PROCESS) return;
         if (fp_verbose) UHD_LOGV(always) << "recv buff: release" << std::endl;
         _info->flags = RB_KERNEL; //release the frame
+        _stats.release_recv();
     }
 
     bool ready(void){return _info->flags & RB_USER;}
@@ -51,6 +65,7 @@ public:
     sptr get_new(void){
         if (fp_verbose) UHD_LOGV(always) << "  make_recv_buff: " << get_size() << std::endl;
         _info->flags = RB_USER_PROCESS; //claim the frame
+        _stats.claim_recv(_info->len);
         return make_managed_buffer(this);
     }
 
@@ -60,25 +75,92 @@ private:
 
     void *_mem;
     ring_buffer_info *_info;
+    zero_copy_stats_t &_stats;
+};
+
+/***********************************************************************
+ * Driver kick for committed send frames:
+ *  - Committed frames are counted until the kernel is notified.
+ *  - The kernel is notified once per batch of contiguous frames,
+ *    when the oldest frame is older than the timeout, or on flush.
+ *  - The age is checked on push and when a send frame is requested.
+ *  - The notification is the USRP_E_SEND_FRAMES ioctl,
+ *    or a zero length write for drivers without the ioctl.
+ **********************************************************************/
+class e100_mmap_zero_copy_kick{
+public:
+    e100_mmap_zero_copy_kick(int fd, size_t batch_size, double timeout):
+        _fd(fd), _batch_size(std::max<size_t>(batch_size, 1)),
+        _timeout(boost::posix_time::microseconds(long(timeout*1e6))),
+        _use_ioctl(true), _first_index(0), _num_queued(0) { /* NOP */ }
+
+    void push(size_t index){
+        //no batching: skip the time keeping and notify right away
+        if (_batch_size == 1){
+            _first_index = index;
+            _num_queued = 1;
+            return this->flush();
+        }
+        const boost::system_time now = boost::get_system_time();
+        if (_num_queued == 0){
+            _first_index = index;
+            _deadline = now + _timeout;
+        }
+        if (++_num_queued == _batch_size or now >= _deadline) this->flush();
+    }
+
+    void flush_expired(void){
+        if (_num_queued != 0 and boost::get_system_time() >= _deadline) this->flush();
+    }
+
+    void flush(void){
+        if (_num_queued == 0) return;
+        if (fp_verbose) UHD_LOGV(always) << "send kick: " << _num_queued << std::endl;
+        if (_use_ioctl){
+            usrp_e_frame_range range;
+            range.start = _first_index;
+            range.count = _num_queued;
+            if (::ioctl(_fd, USRP_E_SEND_FRAMES, &range) >= 0){
+                _num_queued = 0;
+                return;
+            }
+            _use_ioctl = false; //older driver: fall back to the write notification
+        }
+        if (::write(_fd, NULL, 0) < 0){ //notifies the kernel
+            UHD_LOGV(rarely) << UHD_THROW_SITE_INFO("write error") << std::endl;
+        }
+        _num_queued = 0;
+    }
+
+private:
+    const int _fd;
+    const size_t _batch_size;
+    const boost::posix_time::time_duration _timeout;
+    bool _use_ioctl;
+    size_t _first_index, _num_queued;
+    boost::system_time _deadline;
 };
 
 /***********************************************************************
  * Reusable managed send buffer:
  *  - The buffer knows how to claim and release a frame.
+ *  - The kick notifies the kernel of committed frames.
  **********************************************************************/
 class e100_mmap_zero_copy_msb : public managed_send_buffer{
 public:
-    e100_mmap_zero_copy_msb(void *mem, ring_buffer_info *info, size_t len, int fd):
-        _mem(mem), _info(info), _len(len), _fd(fd) { /* NOP */ }
+    e100_mmap_zero_copy_msb(
+        void *mem, ring_buffer_info *info, size_t len, size_t index,
+        e100_mmap_zero_copy_kick &kick, zero_copy_stats_t &stats
+    ):
+        _mem(mem), _info(info), _len(len), _index(index), _kick(&kick), _stats(stats) { /* NOP */ }
 
     void commit(size_t len){
         if (_info->flags != RB_USER_PROCESS) return;
         if (fp_verbose) UHD_LOGV(always) << "send buff: commit " << len << std::endl;
+        _stats.commit_send(len);
         _info->len = len;
         _info->flags = RB_USER; //release the frame
-        if (::write(_fd, NULL, 0) < 0){ //notifies the kernel
-            UHD_LOGV(rarely) << UHD_THROW_SITE_INFO("write error") << std::endl;
-        }
+        _kick->push(_index);
     }
 
     bool ready(void){return _info->flags & RB_KERNEL;}
@@ -86,6 +168,7 @@ public:
     sptr get_new(void){
         if (fp_verbose) UHD_LOGV(always) << "  make_send_buff: " << get_size() << std::endl;
         _info->flags = RB_USER_PROCESS; //claim the frame
+        _stats.claim_send();
         return make_managed_buffer(this);
     }
 
@@ -96,7 +179,9 @@ private:
     void *_mem;
     ring_buffer_info *_info;
     size_t _len;
-    int _fd;
+    size_t _index;
+    e100_mmap_zero_copy_kick *_kick;
+    zero_copy_stats_t &_stats;
 };
 
 /***********************************************************************
@@ -104,8 +189,14 @@ private:
  **********************************************************************/
 class e100_mmap_zero_copy_impl : public zero_copy_if{
 public:
-    e100_mmap_zero_copy_impl(e100_ctrl::sptr iface):
-        _fd(iface->get_file_descriptor()), _recv_index(0), _send_index(0)
+    e100_mmap_zero_copy_impl(e100_ctrl::sptr iface, uhd::usrp::memory_budget::sptr budget, const device_addr_t &hints):
+        _fd(iface->get_file_descriptor()),
+        _send_kick(_fd,
+            size_t(hints.cast<double>("send_batch", 1)),
+            hints.cast<double>("send_batch_timeout", DEFAULT_SEND_BATCH_TIMEOUT)
+        ),
+        _recv_index(0), _send_index(0),
+        _recv_ready(0), _send_ready(0)
     {
         //get system sizes
         iface->ioctl(USRP_E_GET_RB_INFO, &_rb_size);
@@ -128,6 +219,9 @@ public:
             << "map_size:           " << _map_size                   << std::endl
         ;
 
+        //the driver sizes the ring, its memory was allocated by the kernel
+        budget->record_mapped("transport_ring", _map_size);
+
         //call mmap to get the memory
         _mapped_mem = ::mmap(
             NULL, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0
@@ -163,20 +257,25 @@ public:
         //initialize the managed receive buffers
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _mrb_pool.push_back(e100_mmap_zero_copy_mrb(
-                recv_buff + get_recv_frame_size()*i, (*recv_info) + i
+                recv_buff + get_recv_frame_size()*i, (*recv_info) + i, _stats
             ));
         }
 
         //initialize the managed send buffers
-        for (size_t i = 0; i < get_num_recv_frames(); i++){
+        for (size_t i = 0; i < get_num_send_frames(); i++){
             _msb_pool.push_back(e100_mmap_zero_copy_msb(
                 send_buff + get_send_frame_size()*i, (*send_info) + i,
-                get_send_frame_size(), _fd
+                get_send_frame_size(), i, _send_kick, _stats
             ));
         }
+        budget->record("transport_buffers",
+            _mrb_pool.capacity()*sizeof(e100_mmap_zero_copy_mrb) +
+            _msb_pool.capacity()*sizeof(e100_mmap_zero_copy_msb)
+        );
     }
 
     ~e100_mmap_zero_copy_impl(void){
+        _send_kick.flush();
         UHD_LOG << "cleanup: munmap" << std::endl;
         ::munmap(_mapped_mem, _map_size);
     }
@@ -185,18 +284,16 @@ public:
         if (fp_verbose) UHD_LOGV(always) << "get_recv_buff: " << _recv_index << std::endl;
         e100_mmap_zero_copy_mrb &mrb = _mrb_pool[_recv_index];
 
-        //poll/wait for a ready frame
-        if (not mrb.ready()){
-            for (size_t i = 0; i < poll_breakout; i++){
-                pollfd pfd;
-                pfd.fd = _fd;
-                pfd.events = POLLIN;
-                ssize_t poll_ret = ::poll(&pfd, 1, size_t(timeout*1e3/poll_breakout));
-                if (fp_verbose) UHD_LOGV(always) << "  POLLIN: " << poll_ret << std::endl;
-                if (poll_ret > 0) goto found_user_frame; //good poll, continue on
+        //when no frames are left from the last wakeup:
+        //wait for a ready frame, then claim all of the frames ready behind it
+        if (_recv_ready == 0){
+            if (not wait_for_frame(mrb, POLLIN, timeout)){
+                _stats.recv_timeouts++;
+                return managed_recv_buffer::sptr(); //timed-out for real
             }
-            return managed_recv_buffer::sptr(); //timed-out for real
-        } found_user_frame:
+            _recv_ready = count_ready_frames(_mrb_pool, _recv_index);
+        }
+        _recv_ready--;
 
         //increment the index for the next call
         if (++_recv_index == get_num_recv_frames()) _recv_index = 0;
@@ -216,16 +313,24 @@ public:
     managed_send_buffer::sptr get_send_buff(double timeout){
         if (fp_verbose) UHD_LOGV(always) << "get_send_buff: " << _send_index << std::endl;
         e100_mmap_zero_copy_msb &msb = _msb_pool[_send_index];
-
-        //poll/wait for a ready frame
-        if (not msb.ready()){
-            pollfd pfd;
-            pfd.fd = _fd;
-            pfd.events = POLLOUT;
-            ssize_t poll_ret = ::poll(&pfd, 1, size_t(timeout*1e3));
-            if (fp_verbose) UHD_LOGV(always) << "  POLLOUT: " << poll_ret << std::endl;
-            if (poll_ret <= 0) return managed_send_buffer::sptr();
+        _send_kick.flush_expired(); //dont hold aged frames until the next commit
+
+        //when no frames are left from the last wakeup:
+        //wait for a ready frame, then claim all of the frames ready behind it
+        if (_send_ready == 0){
+            if (not msb.ready()){
+                _send_kick.flush(); //the kernel frees frames only once it knows about them
+                const boost::system_time start_time = boost::get_system_time();
+                const bool ready = wait_for_frame(msb, POLLOUT, timeout);
+                _stats.send_wait_time += (boost::get_system_time() - start_time).total_microseconds()/1e6;
+                if (not ready){
+                    _stats.send_timeouts++;
+                    return managed_send_buffer::sptr();
+                }
+            }
+            _send_ready = count_ready_frames(_msb_pool, _send_index);
         }
+        _send_ready--;
 
         //increment the index for the next call
         if (++_send_index == get_num_send_frames()) _send_index = 0;
@@ -242,10 +347,70 @@ public:
         return _frame_size;
     }
 
+    void flush_send_buffs(void){
+        _send_kick.flush();
+    }
+
+    zero_copy_stats_t get_stats(void) const{
+        return _stats;
+    }
+
+    //the driver marks the descriptor readable when a receive frame is ready
+    poll_fds_t get_recv_poll_fds(void) const{
+        return poll_fds_t(1, poll_fd_t(_fd, POLLIN));
+    }
+
 private:
+    /*!
+     * Wait for the frame to become ready with a single poll on the driver.
+     * The poll is repeated with the remaining time only when it wakes up
+     * without the frame's flags being set (a signal, or a different frame).
+     * The driver stays readable while a different frame is ready,
+     * so after a few such wakeups the flags are checked in short sleeps.
+     * The flags are in mapped memory, so a zero timeout only checks them.
+     * \return true when the frame is ready
+     */
+    template <typename buff_type>
+    bool wait_for_frame(buff_type &buff, const short events, const double timeout){
+        if (timeout <= 0) return buff.ready();
+        const boost::system_time exit_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+        size_t num_wakeups = 0;
+        while (not buff.ready()){
+            if (num_wakeups >= MAX_EARLY_WAKEUPS){
+                if (boost::get_system_time() >= exit_time) return buff.ready();
+                boost::this_thread::sleep(boost::posix_time::microseconds(EARLY_WAKEUP_SLEEP_US));
+                continue;
+            }
+            const long timeout_ms = std::max<long>((exit_time - boost::get_system_time()).total_milliseconds(), 0);
+            pollfd pfd;
+            pfd.fd = _fd;
+            pfd.events = events;
+            const int poll_ret = ::poll(&pfd, 1, int(timeout_ms));
+            if (fp_verbose) UHD_LOGV(always) << "  poll " << events << ": " << poll_ret << std::endl;
+            if (poll_ret == 0) return buff.ready(); //timed out, but check the flags one last time
+            if (poll_ret < 0 and errno != EINTR) return false;
+            num_wakeups++;
+        }
+        return true;
+    }
+
+    //! Count the contiguous ready frames starting at the index (at least one frame is ready)
+    template <typename buff_type>
+    static size_t count_ready_frames(std::vector<buff_type> &pool, size_t index){
+        size_t num_ready = 0;
+        while (num_ready < pool.size() and pool[index].ready()){
+            num_ready++;
+            if (++index == pool.size()) index = 0;
+        }
+        return std::max<size_t>(num_ready, 1);
+    }
+
     //file descriptor for mmap
     int _fd;
 
+    //notifies the kernel of committed send frames
+    e100_mmap_zero_copy_kick _send_kick;
+
     //the mapped memory itself
     void *_mapped_mem;
 
@@ -253,17 +418,25 @@ private:
     usrp_e_ring_buffer_size_t _rb_size;
     size_t _frame_size, _map_size;
 
+    //performance counters updated by the managed buffers
+    zero_copy_stats_t _stats;
+
     //re-usable managed buffers
     std::vector<e100_mmap_zero_copy_mrb> _mrb_pool;
     std::vector<e100_mmap_zero_copy_msb> _msb_pool;
 
     //indexes into sub-sections of mapped memory
     size_t _recv_index, _send_index;
+
+    //frames found ready at the last wakeup, claimed without re-reading the flags
+    size_t _recv_ready, _send_ready;
 };
 
 /***********************************************************************
  * The zero copy interface make function
  **********************************************************************/
-zero_copy_if::sptr e100_make_mmap_zero_copy(e100_ctrl::sptr iface){
-    return zero_copy_if::sptr(new e100_mmap_zero_copy_impl(iface));
+zero_copy_if::sptr e100_make_mmap_zero_copy(
+    e100_ctrl::sptr iface, uhd::usrp::memory_budget::sptr budget, const device_addr_t &hints
+){
+    return zero_copy_if::sptr(new e100_mmap_zero_copy_impl(iface, budget, hints));
 }
@@ -29,9 +29,12 @@ namespace uhd{
 }
 #endif
 
+#include <boost/function.hpp>
 #include <sstream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <cstdlib>
 
 #include <fcntl.h>
@@ -62,6 +65,11 @@ const unsigned int INIT_B = 114;
 
 const int BUF_SIZE = 4096;
 
+//! upper bound on a single transfer when spidev allows large messages
+const int MAX_BUF_SIZE = 1 << 16;
+
+typedef boost::function<void(double)> progress_cb_t;
+
 enum gpio_direction {IN, OUT};
 
 class gpio {
@@ -86,6 +94,9 @@ class spidev {
 
 	void send(char *wbuf, char *rbuf, unsigned int nbytes);
 
+	//! Write only, no receive buffer to fill and copy back
+	void write(const char *wbuf, unsigned int nbytes);
+
 	private:
 
 	int fd;
@@ -189,6 +200,9 @@ spidev::spidev(std::string fname)
 	int bits = 8;
 
 	fd = open(fname.c_str(), O_RDWR);
+	if (fd < 0) throw uhd::os_error(
+		"Failed to open spi device: " + fname
+	);
 
 	ret = ioctl(fd, SPI_IOC_WR_MODE, &mode);
 	ret = ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed);
@@ -217,8 +231,38 @@ void spidev::send(char *buf, char *rbuf, unsigned int nbytes)
 
 }
 
-static void send_file_to_fpga(const std::string &file_name, gpio &error, gpio &done)
+void spidev::write(const char *buf, unsigned int nbytes)
 {
+	struct spi_ioc_transfer tr = spi_ioc_transfer();
+	tr.tx_buf = (unsigned long) buf;
+	tr.rx_buf = 0;
+	tr.len = nbytes;
+	tr.delay_usecs = 0;
+	tr.speed_hz = 48000000;
+	tr.bits_per_word = 8;
+
+	if (ioctl(fd, SPI_IOC_MESSAGE(1), &tr) < int(nbytes)) throw uhd::io_error(
+		"Failed to write bitstream to spi device."
+	);
+}
+
+/*!
+ * The spidev driver rejects messages larger than its bufsiz parameter.
+ * Use the largest transfer the driver allows so the bitstream goes out
+ * in a few dozen ioctls instead of one per 4 KiB.
+ */
+static int get_transfer_size(void)
+{
+	std::ifstream bufsiz_file("/sys/module/spidev/parameters/bufsiz");
+	int bufsiz = 0;
+	if (not (bufsiz_file >> bufsiz) or bufsiz < BUF_SIZE) return BUF_SIZE;
+	return (bufsiz < MAX_BUF_SIZE)? bufsiz : MAX_BUF_SIZE;
+}
+
+static void send_file_to_fpga(
+	const std::string &file_name, gpio &error, gpio &done,
+	const progress_cb_t &progress
+){
 	std::ifstream bitstream;
 
 	bitstream.open(file_name.c_str(), std::ios::binary);
@@ -226,26 +270,42 @@ static void send_file_to_fpga(const std::string &file_name, gpio &error, gpio &d
 		"Coult not open the file: " + file_name
 	);
 
+	//read the entire image up front so the spi writes are back to back
+	bitstream.seekg(0, std::ios::end);
+	const std::streamoff file_size = bitstream.tellg();
+	bitstream.seekg(0, std::ios::beg);
+	if (file_size <= 0) throw uhd::os_error(
+		"Empty FPGA image file: " + file_name
+	);
+	std::vector<char> image(static_cast<size_t>(file_size));
+	bitstream.read(&image.front(), image.size());
+	if (size_t(bitstream.gcount()) != image.size()) throw uhd::io_error(
+		"Failed to read the file: " + file_name
+	);
+
 	spidev spi("/dev/spidev1.0");
-	char buf[BUF_SIZE];
-	char rbuf[BUF_SIZE];
+	const size_t xfer_size = get_transfer_size();
 
-	do {
-		bitstream.read(buf, BUF_SIZE);
-		spi.send(buf, rbuf, bitstream.gcount());
+	for (size_t offset = 0; offset < image.size(); offset += xfer_size){
+		const size_t nbytes = std::min(xfer_size, image.size() - offset);
+		spi.write(&image[offset], nbytes);
 
 		if (error.get_value())
 			throw uhd::os_error("INIT_B went high, error occured.");
 
-		if (!done.get_value())
-			UHD_MSG(status) << "Configuration complete." << std::endl;
+		if (progress) progress(double(offset + nbytes)/image.size());
+	}
 
-	} while (bitstream.gcount() == BUF_SIZE);
+	if (!done.get_value())
+		UHD_MSG(status) << "Configuration complete." << std::endl;
 }
 
 }//namespace usrp_e_fpga_downloader_utility
 
-void e100_load_fpga(const std::string &bin_file){
+void e100_load_fpga(
+	const std::string &bin_file,
+	const boost::function<void(double)> &progress
+){
 	using namespace usrp_e_fpga_downloader_utility;
 
 	gpio gpio_prog_b(PROG_B, OUT);
@@ -262,7 +322,7 @@ void e100_load_fpga(const std::string &bin_file){
 
 	UHD_MSG(status) << "done = " << gpio_done.get_value() << std::endl;
 
-	send_file_to_fpga(bin_file, gpio_init_b, gpio_done);
+	send_file_to_fpga(bin_file, gpio_init_b, gpio_done, progress);
 
 //	if(std::system("/sbin/modprobe usrp_e") != 0){
 //		UHD_MSG(warning) << "USRP-E100 FPGA downloader: could not load usrp_e module" << std::endl;
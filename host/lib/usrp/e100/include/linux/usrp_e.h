@@ -35,6 +35,9 @@ struct usrp_e_ctl32 {
 #define USRP_E_READ_CTL32	_IOWR(USRP_E_IOC_MAGIC, 0x23, struct usrp_e_ctl32)
 #define USRP_E_GET_RB_INFO      _IOR(USRP_E_IOC_MAGIC, 0x27, struct usrp_e_ring_buffer_size_t)
 #define USRP_E_GET_COMPAT_NUMBER _IO(USRP_E_IOC_MAGIC, 0x28)
+#define USRP_E_SEND_FRAMES	_IOW(USRP_E_IOC_MAGIC, 0x29, struct usrp_e_frame_range)
+#define USRP_E_READ_ASYNC32	_IOR(USRP_E_IOC_MAGIC, 0x2a, struct usrp_e_ctl32)
+#define USRP_E_GET_CTL_MMAP_INFO _IOR(USRP_E_IOC_MAGIC, 0x2b, struct usrp_e_ctl_mmap_info)
 
 #define USRP_E_COMPAT_NUMBER 3
 
@@ -50,6 +53,34 @@ struct ring_buffer_info {
 	int len;
 };
 
+/*
+ * Committed tx frames for USRP_E_SEND_FRAMES: count frames starting at
+ * the frame index start (wrapping around the ring) are ready to send.
+ * Drivers without this ioctl are notified with a zero length write.
+ */
+struct usrp_e_frame_range {
+	__u32 start;
+	__u32 count;
+};
+
+/*
+ * Async messages for USRP_E_READ_ASYNC32: the driver reads the FPGA's
+ * error buffer on the IRQ and queues the packets. poll() reports POLLPRI
+ * while a packet is queued; the ioctl pops one packet into a usrp_e_ctl32
+ * (count is the number of words, 0 when the queue is empty).
+ */
+
+/*
+ * Control window for USRP_E_GET_CTL_MMAP_INFO: mapping size bytes of the
+ * device node at the page aligned offset gives the FPGA's control space
+ * (uncached), addressed like the offset of the CTL16/CTL32 ioctls.
+ * Drivers without this ioctl only provide the CTL16/CTL32 ioctls.
+ */
+struct usrp_e_ctl_mmap_info {
+	__u32 offset;
+	__u32 size;
+};
+
 struct usrp_e_ring_buffer_size_t {
 	int num_pages_rx_flags;
 	int num_rx_frames;
@@ -17,8 +17,10 @@
 
 #include "recv_packet_demuxer.hpp"
 #include "validate_subdev_spec.hpp"
+#include "late_send_policy.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
+#include "../../transport/async_msg_ring.hpp"
 #include <linux/usrp_e.h> //ioctl structures and constants
 #include "e100_impl.hpp"
 #include "e100_regs.hpp"
@@ -33,6 +35,7 @@
 #include <boost/thread/thread.hpp>
 #include <poll.h> //poll
 #include <fcntl.h> //open, close
+#include <sys/ioctl.h> //ioctl
 #include <sstream>
 #include <fstream>
 
@@ -43,23 +46,29 @@ using namespace uhd::transport;
 /***********************************************************************
  * io impl details (internal to this file)
  * - pirate crew of 1
- * - bounded buffer
+ * - async message ring
  * - thread loop
  * - vrt packet handler states
  **********************************************************************/
 struct e100_impl::io_impl{
-    io_impl(void):
-        false_alarm(0), async_msg_fifo(100/*messages deep*/)
+    io_impl(const size_t async_msg_depth):
+        false_alarm(0), driver_async(false), async_msg_fifo(async_msg_depth)
     { /* NOP */ }
 
     double tick_rate; //set by update tick rate method
     e100_ctrl::sptr iface; //so handle irq can peek and poke
     void handle_irq(void);
+    void handle_async_packet(const boost::uint32_t *buf, size_t num_words);
     size_t false_alarm;
+    bool driver_async; //the driver queues the async messages itself
     //The data transport is listed first so that it is deconstructed last,
     //which is after the states and booty which may hold managed buffers.
     recv_packet_demuxer::sptr demuxer;
 
+    //streaming error events per dsp
+    std::vector<stream_event_counters::sptr> rx_counters;
+    stream_event_counters::sptr tx_counters;
+
     //state management for the vrt packet handler code
     sph::recv_packet_handler recv_handler;
     sph::send_packet_handler send_handler;
@@ -68,6 +77,8 @@ struct e100_impl::io_impl{
     void recv_pirate_loop(
         spi_iface::sptr //keep a sptr to iface which shares gpio147
     ){
+        if (driver_async) return this->recv_driver_async_loop();
+
         //open the GPIO and set it up for an IRQ
         std::ofstream edge_file("/sys/class/gpio/gpio147/edge");
         edge_file << "rising" << std::endl << std::flush;
@@ -86,7 +97,28 @@ struct e100_impl::io_impl{
         //cleanup before thread exit
         ::close(fd);
     }
-    bounded_buffer<async_metadata_t> async_msg_fifo;
+
+    //The driver reads out the async messages on the IRQ and queues them:
+    //poll flags POLLPRI while a message is queued, and the ioctl pops one.
+    void recv_driver_async_loop(void){
+        const int fd = iface->get_file_descriptor();
+        while (not boost::this_thread::interruption_requested()){
+            pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLPRI;
+            if (::poll(&pfd, 1, 100/*ms*/) <= 0) continue;
+
+            //drain all of the queued messages
+            usrp_e_ctl32 data;
+            while (true){
+                data.offset = 0;
+                data.count = 0;
+                if (::ioctl(fd, USRP_E_READ_ASYNC32, &data) < 0 or data.count == 0) break;
+                this->handle_async_packet(data.buf, data.count);
+            }
+        }
+    }
+    async_msg_ring async_msg_fifo;
     task::sptr pirate_task;
 };
 
@@ -111,14 +143,22 @@ void e100_impl::io_impl::handle_irq(void){
         //data.buf[i] = iface->peek32(E100_REG_ERR_BUFF + i*sizeof(boost::uint32_t));
         //std::cout << boost::format("    buff[%u] = 0x%08x\n") % i % data.buf[i];
     //}
+    this->handle_async_packet(data.buf, data.count);
+
+    //prepare for the next round
+    iface->poke32(E100_REG_SR_ERR_CTRL, 1 << 0); //clear
+    while ((iface->peek32(E100_REG_RB_ERR_STATUS) & (1 << 2)) == 0){} //wait for idle
+    iface->poke32(E100_REG_SR_ERR_CTRL, 1 << 1); //start
+}
 
+void e100_impl::io_impl::handle_async_packet(const boost::uint32_t *buf, size_t num_words){
     //unpack the vrt header and process below...
     vrt::if_packet_info_t if_packet_info;
-    if_packet_info.num_packet_words32 = data.count;
-    try{vrt::if_hdr_unpack_le(data.buf, if_packet_info);}
+    if_packet_info.num_packet_words32 = num_words;
+    try{vrt::if_hdr_unpack_le(buf, if_packet_info);}
     catch(const std::exception &e){
         UHD_MSG(error) << "Error unpacking vrt header:\n" << e.what() << std::endl;
-        goto prepare;
+        return;
     }
 
     //handle a tx async report message
@@ -131,33 +171,29 @@ void e100_impl::io_impl::handle_irq(void){
         metadata.time_spec = time_spec_t(
             time_t(if_packet_info.tsi), long(if_packet_info.tsf), tick_rate
         );
-        metadata.event_code = async_metadata_t::event_code_t(sph::get_context_code(data.buf, if_packet_info));
+        metadata.event_code = async_metadata_t::event_code_t(sph::get_context_code(buf, if_packet_info));
 
         //push the message onto the queue
         async_msg_fifo.push_with_pop_on_full(metadata);
 
-        //print some fastpath messages
+        //count the error events
         if (metadata.event_code &
             ( async_metadata_t::EVENT_CODE_UNDERFLOW
             | async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET)
-        ) UHD_MSG(fastpath) << "U";
+        ) tx_counters->record(stream_event_counters::EVENT_UNDERFLOW);
         else if (metadata.event_code &
             ( async_metadata_t::EVENT_CODE_SEQ_ERROR
             | async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST)
-        ) UHD_MSG(fastpath) << "S";
+        ) tx_counters->record(stream_event_counters::EVENT_SEQ_ERROR);
+        else if (metadata.event_code & async_metadata_t::EVENT_CODE_TIME_ERROR)
+            tx_counters->record(stream_event_counters::EVENT_LATE_COMMAND);
     }
-
-    //prepare for the next round
-    prepare:
-    iface->poke32(E100_REG_SR_ERR_CTRL, 1 << 0); //clear
-    while ((iface->peek32(E100_REG_RB_ERR_STATUS) & (1 << 2)) == 0){} //wait for idle
-    iface->poke32(E100_REG_SR_ERR_CTRL, 1 << 1); //start
 }
 
 /***********************************************************************
  * Helper Functions
  **********************************************************************/
-void e100_impl::io_init(void){
+void e100_impl::io_init(const device_addr_t &device_addr){
 
     //setup rx otw type
     _rx_otw_type.width = 16;
@@ -169,9 +205,55 @@ void e100_impl::io_init(void){
     _tx_otw_type.shift = 0;
     _tx_otw_type.byteorder = uhd::otw_type_t::BO_LITTLE_ENDIAN;
 
-    //create new io impl
-    _io_impl = UHD_PIMPL_MAKE(io_impl, ());
-    _io_impl->demuxer = recv_packet_demuxer::make(_data_transport, _rx_dsps.size(), E100_RX_SID_BASE);
+    //size the async message ring from the memory budget:
+    //the ring rounds up to a power of two, so a smaller depth rounds down
+    size_t async_msg_depth = device_addr.cast<size_t>("async_msg_depth", 100);
+    const size_t async_msg_fit = _memory_budget->fit(async_msg_ring::get_bytes_per_msg(), async_msg_depth, 4);
+    if (async_msg_fit < async_msg_depth){
+        for (async_msg_depth = 4; async_msg_depth*2 <= async_msg_fit;) async_msg_depth *= 2;
+    }
+
+    //create new io impl, the async messages overwrite the oldest past the depth
+    _io_impl = UHD_PIMPL_MAKE(io_impl, (async_msg_depth));
+    async_msg_ring::publish(_tree, "/mboards/0", _io_impl->async_msg_fifo);
+    _memory_budget->record("async_msgs", _io_impl->async_msg_fifo.get_depth()*async_msg_ring::get_bytes_per_msg());
+    const std::string demux_policy = device_addr.get("demux_policy", "block");
+    if (demux_policy != "block" and demux_policy != "drop") throw uhd::value_error(
+        "unknown demux_policy " + demux_policy + ", expected block or drop"
+    );
+    const std::vector<size_t> pirate_cpus = cpus_from_string(device_addr.get("pirate_cpu", ""));
+    _io_impl->demuxer = recv_packet_demuxer::make(
+        _data_transport, _rx_dsps.size(), E100_RX_SID_BASE, device_addr.cast<int>("demux_thread", 0) != 0,
+        (demux_policy == "drop")? recv_packet_demuxer::FULL_POLICY_DROP : recv_packet_demuxer::FULL_POLICY_BLOCK,
+        pirate_cpus, thread_sched_t::from_string(device_addr.get("demux_sched", ""))
+    );
+    _memory_budget->record("demux_queues",
+        _rx_dsps.size()*_data_transport->get_num_recv_frames()*sizeof(managed_recv_buffer::sptr)
+    );
+
+    //publish the frame counters of the demuxer queues
+    for (size_t dspno = 0; dspno < _rx_dsps.size(); dspno++){
+        const fs_path demux_path = str(boost::format("/mboards/0/rx_dsps/%u/demux") % dspno);
+        _tree->create<size_t>(demux_path / "queued")
+            .publish(boost::bind(&recv_packet_demuxer::get_num_queued, _io_impl->demuxer, dspno));
+        _tree->create<size_t>(demux_path / "dropped")
+            .publish(boost::bind(&recv_packet_demuxer::get_num_dropped, _io_impl->demuxer, dspno));
+    }
+
+    //create and publish the streaming event counters
+    const bool fastpath_chars = device_addr.cast<bool>("fastpath_chars", true);
+    for (size_t dspno = 0; dspno < _rx_dsps.size(); dspno++){
+        _io_impl->rx_counters.push_back(stream_event_counters::make(fastpath_chars));
+        stream_event_counters::publish(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _io_impl->rx_counters.back());
+    }
+    _io_impl->tx_counters = stream_event_counters::make(fastpath_chars);
+    stream_event_counters::publish(_tree, "/mboards/0/tx_dsps/0", _io_impl->tx_counters);
+
+    //the host resamplers, one setting per handler shared by the dsps
+    for (size_t dspno = 0; dspno < _rx_dsps.size(); dspno++){
+        publish_resampler(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _io_impl->recv_handler);
+    }
+    publish_resampler(_tree, "/mboards/0/tx_dsps/0", _io_impl->send_handler);
     _io_impl->iface = _fpga_ctrl;
 
     //clear state machines
@@ -183,17 +265,30 @@ void e100_impl::io_init(void){
     while ((_fpga_ctrl->peek32(E100_REG_RB_ERR_STATUS) & (1 << 2)) == 0){} //wait for idle
     _fpga_ctrl->poke32(E100_REG_SR_ERR_CTRL, 1 << 1); //start
 
+    //probe for a driver that queues the async messages:
+    //older drivers reject the ioctl, and the messages are read back over spi
+    usrp_e_ctl32 probe;
+    probe.offset = 0;
+    probe.count = 0; //a message popped here predates the clear above
+    _io_impl->driver_async = ::ioctl(_fpga_ctrl->get_file_descriptor(), USRP_E_READ_ASYNC32, &probe) >= 0;
+    UHD_LOG << "async messages from driver: " << _io_impl->driver_async << std::endl;
+
     //spawn a pirate, yarrr!
     _io_impl->pirate_task = task::make(boost::bind(
         &e100_impl::io_impl::recv_pirate_loop, _io_impl.get(), _aux_spi_iface
-    ));
+    ), pirate_cpus, thread_sched_t::from_string(device_addr.get("pirate_sched", "")));
+    _io_impl->pirate_task->set_name("e100 pirate");
 
     //init some handler stuff
-    _io_impl->recv_handler.set_vrt_unpacker(&vrt::if_hdr_unpack_le);
+    _io_impl->recv_handler.set_vrt_unpacker(&vrt::if_hdr_unpack_le_sid_tsi_tsf_tlr);
     _io_impl->recv_handler.set_converter(_rx_otw_type);
     _io_impl->send_handler.set_vrt_packer(&vrt::if_hdr_pack_le);
     _io_impl->send_handler.set_converter(_tx_otw_type);
     _io_impl->send_handler.set_max_samples_per_packet(get_max_send_samps_per_packet());
+    setup_late_send_policy(_io_impl->send_handler, _tree, "/mboards/0", device_addr);
+
+    //everything is sized, report the footprint
+    _memory_budget->publish(_tree, "/mboards/0");
 }
 
 void e100_impl::update_tick_rate(const double rate){
@@ -242,6 +337,7 @@ void e100_impl::update_rx_subdev_spec(const uhd::usrp::subdev_spec_t &spec){
             &recv_packet_demuxer::get_recv_buff, _io_impl->demuxer, i, _1
         ));
         _io_impl->recv_handler.set_overflow_handler(i, boost::bind(&rx_dsp_core_200::handle_overflow, _rx_dsps[i]));
+        _io_impl->recv_handler.set_event_counters(i, _io_impl->rx_counters[i]);
     }
 }
 
@@ -261,9 +357,13 @@ void e100_impl::update_tx_subdev_spec(const uhd::usrp::subdev_spec_t &spec){
 
     //bind new callbacks for the handler
     for (size_t i = 0; i < _io_impl->send_handler.size(); i++){
+        _io_impl->send_handler.set_xport_chan_flush(i, boost::bind(
+            &zero_copy_if::flush_send_buffs, _data_transport
+        ));
         _io_impl->send_handler.set_xport_chan_get_buff(i, boost::bind(
             &zero_copy_if::get_send_buff, _data_transport, _1
         ));
+        _io_impl->send_handler.set_event_counters(i, _io_impl->tx_counters);
     }
 }
 
@@ -291,6 +391,14 @@ size_t e100_impl::send(
     );
 }
 
+size_t e100_impl::get_send_view(send_view_t &view, double timeout){
+    return _io_impl->send_handler.get_send_view(view, timeout);
+}
+
+size_t e100_impl::commit_send_view(send_view_t &view, size_t nsamps, double){
+    return _io_impl->send_handler.commit_send_view(view, nsamps);
+}
+
 /***********************************************************************
  * Data Recv
  **********************************************************************/
@@ -316,6 +424,21 @@ size_t e100_impl::recv(
     );
 }
 
+size_t e100_impl::recv_full_buff(
+    const recv_buffs_type &buffs, size_t nsamps_per_buff,
+    recv_metadata_array_type &metadata_array,
+    const io_type_t &io_type, double timeout
+){
+    return _io_impl->recv_handler.recv_full_buff(
+        buffs, nsamps_per_buff,
+        metadata_array, io_type, timeout
+    );
+}
+
+size_t e100_impl::recv_view(recv_view_t &view, double timeout){
+    return _io_impl->recv_handler.recv_view(view, timeout);
+}
+
 /***********************************************************************
  * Async Recv
  **********************************************************************/
@@ -325,3 +448,18 @@ bool e100_impl::recv_async_msg(
     boost::this_thread::disable_interruption di; //disable because the wait can throw
     return _io_impl->async_msg_fifo.pop_with_timed_wait(async_metadata, timeout);
 }
+
+poll_fds_t e100_impl::get_async_msg_poll_fds(void){
+    const poll_fds_t fds = _io_impl->async_msg_fifo.get_poll_fds();
+    if (fds.empty()) throw uhd::not_implemented_error("e100 async messages cannot be polled on this platform");
+    return fds;
+}
+
+/***********************************************************************
+ * Receive Readiness
+ **********************************************************************/
+poll_fds_t e100_impl::get_recv_poll_fds(void){
+    const poll_fds_t fds = _io_impl->demuxer->get_recv_poll_fds();
+    if (fds.empty()) throw uhd::not_implemented_error("e100 receive transport cannot be polled");
+    return fds;
+}
@@ -20,11 +20,17 @@
 #include <uhd/utils/props.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/types/sensors.hpp>
+#include <uhd/types/dict.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/cstdint.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/format.hpp>
 
@@ -36,23 +42,123 @@ using namespace boost::this_thread;
 
 /*!
  * A GPS control for Jackson Labs devices (and other NMEA compatible GPS's)
+ *
+ * A background thread detects and initializes the GPS,
+ * then parses the NMEA stream into a cache of the latest sentences.
+ * Sensor reads come from the cache and do not wait on the serial port,
+ * except to wait for the detection or a first sentence after the open.
  */
 
 class gps_ctrl_impl : public gps_ctrl{
 public:
-  gps_ctrl_impl(uart_iface::sptr uart){
-    _uart = uart;
+  gps_ctrl_impl(uart_iface::sptr uart):
+    _uart(uart), gps_type(GPS_TYPE_NONE), _detect_done(false), _running(true)
+  {
+    _thread_group.create_thread(boost::bind(&gps_ctrl_impl::run, this));
+  }
 
+  ~gps_ctrl_impl(void){
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _running = false;
+    }
+    _thread_group.join_all(); //the reader checks the flag between reads
+  }
+
+  //return a list of supported sensors
+  std::vector<std::string> get_sensors(void) {
+    std::vector<std::string> ret = boost::assign::list_of
+        ("gps_gpgga")
+        ("gps_gprmc")
+        ("gps_gpgsa")
+        ("gps_time")
+        ("gps_locked");
+    return ret;
+  }
+
+  uhd::sensor_value_t get_sensor(std::string key) {
+    if(key == "gps_gpgga"
+    or key == "gps_gprmc"
+    or key == "gps_gpgsa") {
+        return sensor_value_t(
+                 boost::to_upper_copy(key),
+                 get_nmea(boost::to_upper_copy(key.substr(4,8))),
+                 "");
+    }
+    else if(key == "gps_time") {
+        return sensor_value_t("GPS epoch time", int(get_epoch_time()), "seconds");
+    }
+    else if(key == "gps_locked") {
+        return sensor_value_t("GPS lock status", locked(), "locked", "unlocked");
+    }
+    else {
+        UHD_THROW_PROP_GET_ERROR();
+    }
+  }
+
+  bool gps_detected(void) {
+    boost::mutex::scoped_lock lock(_mutex);
+    while (not _detect_done) _cond.wait(lock);
+    return (gps_type != GPS_TYPE_NONE);
+  }
+
+private:
+  //the latest sentence of one type and the host time it arrived
+  struct nmea_entry_t{
+    std::string sentence;
+    boost::system_time arrival;
+  };
+
+  /*******************************************************************
+   * Background thread: detect, initialize, then parse the stream
+   ******************************************************************/
+  void run(void){
+    UHD_SAFE_CALL(this->detect();)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _detect_done = true;
+    }
+    _cond.notify_all();
+    if (not gps_detected()) return;
+
+    UHD_SAFE_CALL(
+      if (gps_type == GPS_TYPE_JACKSON_LABS) init_firefly();
+      while (running()) {
+        const std::string reply = _recv();
+        if (reply.size() < 6 or reply.substr(0, 3) != "$GP") continue;
+        nmea_entry_t entry;
+        entry.sentence = reply;
+        entry.arrival = boost::get_system_time();
+        {
+          boost::mutex::scoped_lock lock(_mutex);
+          _sentences[reply.substr(1, 5)] = entry;
+        }
+        _cond.notify_all();
+      }
+    )
+  }
+
+  bool running(void){
+    boost::mutex::scoped_lock lock(_mutex);
+    return _running;
+  }
+
+  //sleep on the reader thread unless the control is closing
+  bool _sleep(const int ms){
+    sleep(milliseconds(ms));
+    return running();
+  }
+
+  void detect(void){
     std::string reply;
     bool i_heard_some_nmea = false, i_heard_something_weird = false;
-    gps_type = GPS_TYPE_NONE;
     
     //first we look for a Jackson Labs Firefly (since that's what we provide...)
     _flush(); //get whatever junk is in the rx buffer right now, and throw it away
     _send("HAAAY GUYYYYS\n"); //to elicit a response from the Firefly
 
     //wait for _send(...) to return
-    sleep(milliseconds(FIREFLY_STUPID_DELAY_MS));
+    if (not _sleep(FIREFLY_STUPID_DELAY_MS)) return;
 
     //then we loop until we either timeout, or until we get a response that indicates we're a JL device
     const boost::system_time comm_timeout = boost::get_system_time() + milliseconds(GPS_COMM_TIMEOUT_MS);
@@ -64,7 +170,7 @@ public:
       } 
       else if(reply.substr(0, 3) == "$GP") i_heard_some_nmea = true; //but keep looking for that "Command Error" response
       else if(reply.length() != 0) i_heard_something_weird = true; //probably wrong baud rate
-      sleep(milliseconds(GPS_TIMEOUT_DELAY_MS));
+      if (not _sleep(GPS_TIMEOUT_DELAY_MS)) return;
     }
 
     if((i_heard_some_nmea) && (gps_type != GPS_TYPE_JACKSON_LABS)) gps_type = GPS_TYPE_GENERIC_NMEA;
@@ -76,11 +182,10 @@ public:
     switch(gps_type) {
     case GPS_TYPE_JACKSON_LABS:
       UHD_MSG(status) << "Found a Jackson Labs GPS" << std::endl;
-      init_firefly();
       break;
 
     case GPS_TYPE_GENERIC_NMEA:
-      if(gps_type == GPS_TYPE_GENERIC_NMEA) UHD_MSG(status) << "Found a generic NMEA GPS device" << std::endl;
+      UHD_MSG(status) << "Found a generic NMEA GPS device" << std::endl;
       break;
 
     case GPS_TYPE_NONE:
@@ -90,81 +195,43 @@ public:
     }
   }
 
-  ~gps_ctrl_impl(void){
-    /* NOP */
-  }
-
-  //return a list of supported sensors
-  std::vector<std::string> get_sensors(void) {
-    std::vector<std::string> ret = boost::assign::list_of
-        ("gps_gpgga")
-        ("gps_gprmc")
-        ("gps_gpgsa")
-        ("gps_time")
-        ("gps_locked");
-    return ret;
-  }
-
-  uhd::sensor_value_t get_sensor(std::string key) {
-    if(key == "gps_gpgga"
-    or key == "gps_gprmc"
-    or key == "gps_gpgsa") {
-        return sensor_value_t(
-                 boost::to_upper_copy(key),
-                 get_nmea(boost::to_upper_copy(key.substr(4,8))),
-                 "");
-    }
-    else if(key == "gps_time") {
-        return sensor_value_t("GPS epoch time", int(get_epoch_time()), "seconds");
-    }
-    else if(key == "gps_locked") {
-        return sensor_value_t("GPS lock status", locked(), "locked", "unlocked");
-    }
-    else {
-        UHD_THROW_PROP_GET_ERROR();
-    }
-  }
-
-private:
   void init_firefly(void) {
     //issue some setup stuff so it spits out the appropriate data
     //none of these should issue replies so we don't bother looking for them
     //we have to sleep between commands because the JL device, despite not acking, takes considerable time to process each command.
-     sleep(milliseconds(FIREFLY_STUPID_DELAY_MS));
-    _send("SYST:COMM:SER:ECHO OFF\n");
-     sleep(milliseconds(FIREFLY_STUPID_DELAY_MS));
-    _send("SYST:COMM:SER:PRO OFF\n");
-     sleep(milliseconds(FIREFLY_STUPID_DELAY_MS));
-    _send("GPS:GPGGA 1\n");
-     sleep(milliseconds(FIREFLY_STUPID_DELAY_MS));
-    _send("GPS:GGAST 0\n");
-     sleep(milliseconds(FIREFLY_STUPID_DELAY_MS));
-    _send("GPS:GPRMC 1\n");
-     sleep(milliseconds(FIREFLY_STUPID_DELAY_MS));
-    _send("GPS:GPGSA 1\n");
-     sleep(milliseconds(FIREFLY_STUPID_DELAY_MS));
+    static const char *commands[] = {
+      "SYST:COMM:SER:ECHO OFF\n",
+      "SYST:COMM:SER:PRO OFF\n",
+      "GPS:GPGGA 1\n",
+      "GPS:GGAST 0\n",
+      "GPS:GPRMC 1\n",
+      "GPS:GPGSA 1\n"
+    };
+    if (not _sleep(FIREFLY_STUPID_DELAY_MS)) return;
+    for (size_t i = 0; i < sizeof(commands)/sizeof(commands[0]); i++){
+      _send(commands[i]);
+      if (not _sleep(FIREFLY_STUPID_DELAY_MS)) return;
+    }
   }
  
-  //retrieve a raw NMEA sentence
-  std::string get_nmea(std::string msgtype) {
-    msgtype.insert(0, "$");
-    std::string reply;
+  //retrieve the latest raw NMEA sentence, waiting only for the first one
+  nmea_entry_t get_nmea_entry(const std::string &msgtype) {
+    boost::mutex::scoped_lock lock(_mutex);
+    const boost::system_time comm_timeout = boost::get_system_time() + milliseconds(GPS_COMM_TIMEOUT_MS);
+    while (not _sentences.has_key(msgtype)){
+      if (not _cond.timed_wait(lock, comm_timeout)) throw uhd::value_error(
+        str(boost::format("get_nmea(): no $%s message found") % msgtype)
+      );
+    }
+    return _sentences[msgtype];
+  }
+
+  std::string get_nmea(const std::string &msgtype) {
     if(not gps_detected()) {
         UHD_MSG(error) << "get_nmea(): unsupported GPS or no GPS detected";
         return std::string();
     }
-
-    _flush(); //flush all input before waiting for a message
-
-    const boost::system_time comm_timeout = boost::get_system_time() + milliseconds(GPS_COMM_TIMEOUT_MS);
-    while(boost::get_system_time() < comm_timeout) {
-        reply = _recv();
-        if(reply.substr(0, 6) == msgtype)
-          return reply;
-        boost::this_thread::sleep(milliseconds(GPS_TIMEOUT_DELAY_MS));
-    }
-    throw uhd::value_error(str(boost::format("get_nmea(): no %s message found") % msgtype));
-    return std::string();
+    return get_nmea_entry(msgtype).sentence;
   }
 
   //helper function to retrieve a field from an NMEA sentence
@@ -181,64 +248,45 @@ private:
   }
 
   ptime get_time(void) {
-    int error_cnt = 0;
-    ptime gps_time;
-    while(error_cnt < 3) {
-        try {
-            std::string reply = get_nmea("GPRMC");
-
-            std::string datestr = get_token(reply, 9);
-            std::string timestr = get_token(reply, 1);
-
-            if(datestr.size() == 0 or timestr.size() == 0) {
-                throw uhd::value_error(str(boost::format("Invalid response \"%s\"") % reply));
-            }
-            
-            //just trust me on this one
-            gps_time = ptime( date( 
-                             greg_year(boost::lexical_cast<int>(datestr.substr(4, 2)) + 2000),
-                             greg_month(boost::lexical_cast<int>(datestr.substr(2, 2))), 
-                             greg_day(boost::lexical_cast<int>(datestr.substr(0, 2))) 
-                           ),
-                          hours(  boost::lexical_cast<int>(timestr.substr(0, 2)))
-                        + minutes(boost::lexical_cast<int>(timestr.substr(2, 2)))
-                        + seconds(boost::lexical_cast<int>(timestr.substr(4, 2)))
-                     );
-            return gps_time;
-            
-        } catch(std::exception &e) {
-            UHD_MSG(warning) << "get_time: " << e.what();
-            error_cnt++;
-        }
+    if(not gps_detected()) throw uhd::value_error("get_time(): no GPS detected");
+    const nmea_entry_t entry = get_nmea_entry("GPRMC");
+    const std::string &reply = entry.sentence;
+
+    std::string datestr = get_token(reply, 9);
+    std::string timestr = get_token(reply, 1);
+
+    if(datestr.size() == 0 or timestr.size() == 0) {
+        throw uhd::value_error(str(boost::format("Invalid response \"%s\"") % reply));
     }
-    throw uhd::value_error("Timeout after no valid message found");
     
-    return gps_time; //keep gcc from complaining
+    try {
+        //just trust me on this one
+        const ptime gps_time = ptime( date( 
+                         greg_year(boost::lexical_cast<int>(datestr.substr(4, 2)) + 2000),
+                         greg_month(boost::lexical_cast<int>(datestr.substr(2, 2))), 
+                         greg_day(boost::lexical_cast<int>(datestr.substr(0, 2))) 
+                       ),
+                      hours(  boost::lexical_cast<int>(timestr.substr(0, 2)))
+                    + minutes(boost::lexical_cast<int>(timestr.substr(2, 2)))
+                    + seconds(boost::lexical_cast<int>(timestr.substr(4, 2)))
+                 );
+
+        //the sentence follows its PPS edge, count the edges since it arrived
+        const long elapsed_secs = (boost::get_system_time() - entry.arrival).total_seconds();
+        return gps_time + seconds(elapsed_secs);
+    } catch(std::exception &e) {
+        throw uhd::value_error(str(boost::format("get_time: %s in \"%s\"") % e.what() % reply));
+    }
   }
   
   time_t get_epoch_time(void) {
       return (get_time() - from_time_t(0)).total_seconds();
   }
 
-  bool gps_detected(void) {
-    return (gps_type != GPS_TYPE_NONE);
-  }
-
   bool locked(void) {
-    int error_cnt = 0;
-    while(error_cnt < 3) {
-        try {
-            std::string reply = get_nmea("GPGGA");
-            if(reply.size() <= 1) return false;
-
-            return (get_token(reply, 6) != "0");
-        } catch(std::exception &e) {
-            UHD_MSG(warning) << "locked: " << e.what();
-            error_cnt++;
-        }
-    }
-    throw uhd::value_error("Timeout after no valid message found");
-    return false;
+    std::string reply = get_nmea("GPGGA");
+    if(reply.size() <= 1) return false;
+    return (get_token(reply, 6) != "0");
   }
 
   uart_iface::sptr _uart;
@@ -263,6 +311,13 @@ private:
     GPS_TYPE_NONE
   } gps_type;
 
+  //state shared with the reader thread
+  boost::mutex _mutex;
+  boost::condition_variable _cond;
+  bool _detect_done, _running;
+  uhd::dict<std::string, nmea_entry_t> _sentences;
+  boost::thread_group _thread_group;
+
   static const int GPS_COMM_TIMEOUT_MS = 1500;
   static const int GPS_TIMEOUT_DELAY_MS = 200;
   static const int FIREFLY_STUPID_DELAY_MS = 200;
@@ -18,6 +18,7 @@
 #include <uhd/usrp/mboard_eeprom.hpp>
 #include <uhd/types/mac_addr.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/exception.hpp>
 #include <boost/asio/ip/address_v4.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/lexical_cast.hpp>
@@ -65,6 +66,50 @@ static const byte_vector_t string_to_bytes(const std::string &string, size_t max
     return bytes;
 }
 
+/*!
+ * A window onto the EEPROM that covers every field of a map:
+ * The window is read in one bulk transfer and parsed from memory.
+ * Stores modify the window, and only the bytes that changed are written.
+ */
+class eeprom_image{
+public:
+    eeprom_image(i2c_iface &iface, boost::uint8_t addr, size_t base, size_t len):
+        _iface(iface), _addr(addr), _base(base),
+        _bytes(iface.read_eeprom(addr, base, len)), _orig(_bytes)
+    {
+        UHD_ASSERT_THROW(_bytes.size() == len);
+    }
+
+    byte_vector_t get(size_t offset, size_t len) const{
+        UHD_ASSERT_THROW(offset >= _base and offset + len <= _base + _bytes.size());
+        return byte_vector_t(_bytes.begin() + (offset - _base), _bytes.begin() + (offset - _base + len));
+    }
+
+    void set(size_t offset, const byte_vector_t &bytes){
+        UHD_ASSERT_THROW(offset >= _base and offset + bytes.size() <= _base + _bytes.size());
+        std::copy(bytes.begin(), bytes.end(), _bytes.begin() + (offset - _base));
+    }
+
+    //! write each run of changed bytes back to the EEPROM
+    void commit(void){
+        size_t i = 0;
+        while (i < _bytes.size()){
+            if (_bytes[i] == _orig[i]){i++; continue;}
+            size_t end = i;
+            while (end < _bytes.size() and _bytes[end] != _orig[end]) end++;
+            _iface.write_eeprom(_addr, _base + i, byte_vector_t(_bytes.begin() + i, _bytes.begin() + end));
+            i = end;
+        }
+        _orig = _bytes;
+    }
+
+private:
+    i2c_iface &_iface;
+    const boost::uint8_t _addr;
+    const size_t _base;
+    byte_vector_t _bytes, _orig;
+};
+
 /***********************************************************************
  * Implementation of N100 load/store
  **********************************************************************/
@@ -81,6 +126,8 @@ static const uhd::dict<std::string, boost::uint8_t> USRP_N100_OFFSETS = boost::a
     ("name", 0x18 + SERIAL_LEN)
 ;
 
+static const size_t N100_EEPROM_LEN = 0x18 + SERIAL_LEN + NAME_MAX_LEN;
+
 enum n200_gpsdo_type{
     N200_GPSDO_NONE = 0,
     N200_GPSDO_INTERNAL = 1,
@@ -88,27 +135,29 @@ enum n200_gpsdo_type{
 };
 
 static void load_n100(mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
+    const eeprom_image image(iface, N100_EEPROM_ADDR, 0, N100_EEPROM_LEN);
+
     //extract the revision number
-    byte_vector_t rev_lsb_msb = iface.read_eeprom(N100_EEPROM_ADDR, USRP_N100_OFFSETS["rev-lsb-msb"], 2);
+    byte_vector_t rev_lsb_msb = image.get(USRP_N100_OFFSETS["rev-lsb-msb"], 2);
     boost::uint16_t rev = (boost::uint16_t(rev_lsb_msb.at(0)) << 0) | (boost::uint16_t(rev_lsb_msb.at(1)) << 8);
     mb_eeprom["rev"] = boost::lexical_cast<std::string>(rev);
 
     //extract the product code
-    byte_vector_t prod_lsb_msb = iface.read_eeprom(N100_EEPROM_ADDR, USRP_N100_OFFSETS["prod-lsb-msb"], 2);
+    byte_vector_t prod_lsb_msb = image.get(USRP_N100_OFFSETS["prod-lsb-msb"], 2);
     boost::uint16_t prod = (boost::uint16_t(prod_lsb_msb.at(0)) << 0) | (boost::uint16_t(prod_lsb_msb.at(1)) << 8);
     mb_eeprom["product"] = (prod == 0 or prod == 0xffff)? "" : boost::lexical_cast<std::string>(prod);
 
     //extract the addresses
-    mb_eeprom["mac-addr"] = mac_addr_t::from_bytes(iface.read_eeprom(
-        N100_EEPROM_ADDR, USRP_N100_OFFSETS["mac-addr"], 6
+    mb_eeprom["mac-addr"] = mac_addr_t::from_bytes(image.get(
+        USRP_N100_OFFSETS["mac-addr"], 6
     )).to_string();
 
     boost::asio::ip::address_v4::bytes_type ip_addr_bytes;
-    byte_copy(iface.read_eeprom(N100_EEPROM_ADDR, USRP_N100_OFFSETS["ip-addr"], 4), ip_addr_bytes);
+    byte_copy(image.get(USRP_N100_OFFSETS["ip-addr"], 4), ip_addr_bytes);
     mb_eeprom["ip-addr"] = boost::asio::ip::address_v4(ip_addr_bytes).to_string();
 
     //gpsdo capabilities
-    boost::uint8_t gpsdo_byte = iface.read_eeprom(N100_EEPROM_ADDR, USRP_N100_OFFSETS["gpsdo"], 1).at(0);
+    boost::uint8_t gpsdo_byte = image.get(USRP_N100_OFFSETS["gpsdo"], 1).at(0);
     switch(n200_gpsdo_type(gpsdo_byte)){
     case N200_GPSDO_INTERNAL: mb_eeprom["gpsdo"] = "internal"; break;
     case N200_GPSDO_ONBOARD: mb_eeprom["gpsdo"] = "onboard"; break;
@@ -116,13 +165,13 @@ static void load_n100(mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
     }
 
     //extract the serial
-    mb_eeprom["serial"] = bytes_to_string(iface.read_eeprom(
-        N100_EEPROM_ADDR, USRP_N100_OFFSETS["serial"], SERIAL_LEN
+    mb_eeprom["serial"] = bytes_to_string(image.get(
+        USRP_N100_OFFSETS["serial"], SERIAL_LEN
     ));
 
     //extract the name
-    mb_eeprom["name"] = bytes_to_string(iface.read_eeprom(
-        N100_EEPROM_ADDR, USRP_N100_OFFSETS["name"], NAME_MAX_LEN
+    mb_eeprom["name"] = bytes_to_string(image.get(
+        USRP_N100_OFFSETS["name"], NAME_MAX_LEN
     ));
 
     //Empty serial correction: use the mac address to determine serial.
@@ -136,6 +185,8 @@ static void load_n100(mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
 }
 
 static void store_n100(const mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
+    eeprom_image image(iface, N100_EEPROM_ADDR, 0, N100_EEPROM_LEN);
+
     //parse the revision number
     if (mb_eeprom.has_key("rev")){
         boost::uint16_t rev = boost::lexical_cast<boost::uint16_t>(mb_eeprom["rev"]);
@@ -143,7 +194,7 @@ static void store_n100(const mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
             (boost::uint8_t(rev >> 0))
             (boost::uint8_t(rev >> 8))
         ;
-        iface.write_eeprom(N100_EEPROM_ADDR, USRP_N100_OFFSETS["rev-lsb-msb"], rev_lsb_msb);
+        image.set(USRP_N100_OFFSETS["rev-lsb-msb"], rev_lsb_msb);
     }
 
     //parse the product code
@@ -153,19 +204,19 @@ static void store_n100(const mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
             (boost::uint8_t(prod >> 0))
             (boost::uint8_t(prod >> 8))
         ;
-        iface.write_eeprom(N100_EEPROM_ADDR, USRP_N100_OFFSETS["prod-lsb-msb"], prod_lsb_msb);
+        image.set(USRP_N100_OFFSETS["prod-lsb-msb"], prod_lsb_msb);
     }
 
     //store the addresses
-    if (mb_eeprom.has_key("mac-addr")) iface.write_eeprom(
-        N100_EEPROM_ADDR, USRP_N100_OFFSETS["mac-addr"],
+    if (mb_eeprom.has_key("mac-addr")) image.set(
+        USRP_N100_OFFSETS["mac-addr"],
         mac_addr_t::from_string(mb_eeprom["mac-addr"]).to_bytes()
     );
 
     if (mb_eeprom.has_key("ip-addr")){
         byte_vector_t ip_addr_bytes(4);
         byte_copy(boost::asio::ip::address_v4::from_string(mb_eeprom["ip-addr"]).to_bytes(), ip_addr_bytes);
-        iface.write_eeprom(N100_EEPROM_ADDR, USRP_N100_OFFSETS["ip-addr"], ip_addr_bytes);
+        image.set(USRP_N100_OFFSETS["ip-addr"], ip_addr_bytes);
     }
 
     //gpsdo capabilities
@@ -173,20 +224,22 @@ static void store_n100(const mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
         boost::uint8_t gpsdo_byte = N200_GPSDO_NONE;
         if (mb_eeprom["gpsdo"] == "internal") gpsdo_byte = N200_GPSDO_INTERNAL;
         if (mb_eeprom["gpsdo"] == "onboard") gpsdo_byte = N200_GPSDO_ONBOARD;
-        iface.write_eeprom(N100_EEPROM_ADDR, USRP_N100_OFFSETS["gpsdo"], byte_vector_t(1, gpsdo_byte));
+        image.set(USRP_N100_OFFSETS["gpsdo"], byte_vector_t(1, gpsdo_byte));
     }
 
     //store the serial
-    if (mb_eeprom.has_key("serial")) iface.write_eeprom(
-        N100_EEPROM_ADDR, USRP_N100_OFFSETS["serial"],
+    if (mb_eeprom.has_key("serial")) image.set(
+        USRP_N100_OFFSETS["serial"],
         string_to_bytes(mb_eeprom["serial"], SERIAL_LEN)
     );
 
     //store the name
-    if (mb_eeprom.has_key("name")) iface.write_eeprom(
-        N100_EEPROM_ADDR, USRP_N100_OFFSETS["name"],
+    if (mb_eeprom.has_key("name")) image.set(
+        USRP_N100_OFFSETS["name"],
         string_to_bytes(mb_eeprom["name"], NAME_MAX_LEN)
     );
+
+    image.commit();
 }
 
 /***********************************************************************
@@ -201,21 +254,27 @@ static const uhd::dict<std::string, boost::uint8_t> USRP_B000_OFFSETS = boost::a
     ("mcr", 0xf8 - NAME_MAX_LEN - sizeof(boost::uint32_t))
 ;
 
+//the b000 fields are packed against the end of the eeprom
+static const size_t B000_EEPROM_BASE = 0xf8 - NAME_MAX_LEN - sizeof(boost::uint32_t);
+static const size_t B000_EEPROM_LEN = 0xf8 + B000_SERIAL_LEN - B000_EEPROM_BASE;
+
 static void load_b000(mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
+    const eeprom_image image(iface, B000_EEPROM_ADDR, B000_EEPROM_BASE, B000_EEPROM_LEN);
+
     //extract the serial
-    mb_eeprom["serial"] = bytes_to_string(iface.read_eeprom(
-        B000_EEPROM_ADDR, USRP_B000_OFFSETS["serial"], B000_SERIAL_LEN
+    mb_eeprom["serial"] = bytes_to_string(image.get(
+        USRP_B000_OFFSETS["serial"], B000_SERIAL_LEN
     ));
 
     //extract the name
-    mb_eeprom["name"] = bytes_to_string(iface.read_eeprom(
-        B000_EEPROM_ADDR, USRP_B000_OFFSETS["name"], NAME_MAX_LEN
+    mb_eeprom["name"] = bytes_to_string(image.get(
+        USRP_B000_OFFSETS["name"], NAME_MAX_LEN
     ));
 
     //extract master clock rate as a 32-bit uint in Hz
     boost::uint32_t master_clock_rate;
-    const byte_vector_t rate_bytes = iface.read_eeprom(
-        B000_EEPROM_ADDR, USRP_B000_OFFSETS["mcr"], sizeof(master_clock_rate)
+    const byte_vector_t rate_bytes = image.get(
+        USRP_B000_OFFSETS["mcr"], sizeof(master_clock_rate)
     );
     std::copy(
         rate_bytes.begin(), rate_bytes.end(), //input
@@ -229,15 +288,17 @@ static void load_b000(mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
 }
 
 static void store_b000(const mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
+    eeprom_image image(iface, B000_EEPROM_ADDR, B000_EEPROM_BASE, B000_EEPROM_LEN);
+
     //store the serial
-    if (mb_eeprom.has_key("serial")) iface.write_eeprom(
-        B000_EEPROM_ADDR, USRP_B000_OFFSETS["serial"],
+    if (mb_eeprom.has_key("serial")) image.set(
+        USRP_B000_OFFSETS["serial"],
         string_to_bytes(mb_eeprom["serial"], B000_SERIAL_LEN)
     );
 
     //store the name
-    if (mb_eeprom.has_key("name")) iface.write_eeprom(
-        B000_EEPROM_ADDR, USRP_B000_OFFSETS["name"],
+    if (mb_eeprom.has_key("name")) image.set(
+        USRP_B000_OFFSETS["name"],
         string_to_bytes(mb_eeprom["name"], NAME_MAX_LEN)
     );
 
@@ -249,11 +310,12 @@ static void store_b000(const mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
             reinterpret_cast<const boost::uint8_t *>(&master_clock_rate),
             reinterpret_cast<const boost::uint8_t *>(&master_clock_rate) + sizeof(master_clock_rate)
         );
-        iface.write_eeprom(
-            B000_EEPROM_ADDR, USRP_B000_OFFSETS["mcr"], rate_bytes
-        );
+        image.set(USRP_B000_OFFSETS["mcr"], rate_bytes);
     }
+
+    image.commit();
 }
+
 /***********************************************************************
  * Implementation of E100 load/store
  **********************************************************************/
@@ -281,9 +343,13 @@ template <typename T> static const byte_vector_t to_bytes(const T &item){
 #define sizeof_member(struct_name, member_name) \
     sizeof(reinterpret_cast<struct_name*>(NULL)->member_name)
 
+static const size_t E100_EEPROM_LEN = offsetof(e100_eeprom_map, name) + sizeof_member(e100_eeprom_map, name);
+
 static void load_e100(mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
+    const eeprom_image image(iface, E100_EEPROM_ADDR, 0, E100_EEPROM_LEN);
+
     const size_t num_bytes = offsetof(e100_eeprom_map, model);
-    byte_vector_t map_bytes = iface.read_eeprom(E100_EEPROM_ADDR, 0, num_bytes);
+    byte_vector_t map_bytes = image.get(0, num_bytes);
     e100_eeprom_map map; std::memcpy(&map, &map_bytes[0], map_bytes.size());
 
     mb_eeprom["vendor"] = boost::lexical_cast<std::string>(uhd::ntohx(map.vendor));
@@ -291,8 +357,8 @@ static void load_e100(mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
     mb_eeprom["revision"] = boost::lexical_cast<std::string>(unsigned(map.revision));
     mb_eeprom["content"] = boost::lexical_cast<std::string>(unsigned(map.content));
 
-    #define load_e100_string_xx(key) mb_eeprom[#key] = bytes_to_string(iface.read_eeprom( \
-        E100_EEPROM_ADDR, offsetof(e100_eeprom_map, key), sizeof_member(e100_eeprom_map, key) \
+    #define load_e100_string_xx(key) mb_eeprom[#key] = bytes_to_string(image.get( \
+        offsetof(e100_eeprom_map, key), sizeof_member(e100_eeprom_map, key) \
     ));
 
     load_e100_string_xx(model);
@@ -303,29 +369,30 @@ static void load_e100(mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
 }
 
 static void store_e100(const mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
+    eeprom_image image(iface, E100_EEPROM_ADDR, 0, E100_EEPROM_LEN);
 
-    if (mb_eeprom.has_key("vendor")) iface.write_eeprom(
-        E100_EEPROM_ADDR, offsetof(e100_eeprom_map, vendor),
+    if (mb_eeprom.has_key("vendor")) image.set(
+        offsetof(e100_eeprom_map, vendor),
         to_bytes(uhd::htonx(boost::lexical_cast<boost::uint16_t>(mb_eeprom["vendor"])))
     );
 
-    if (mb_eeprom.has_key("device")) iface.write_eeprom(
-        E100_EEPROM_ADDR, offsetof(e100_eeprom_map, device),
+    if (mb_eeprom.has_key("device")) image.set(
+        offsetof(e100_eeprom_map, device),
         to_bytes(uhd::htonx(boost::lexical_cast<boost::uint16_t>(mb_eeprom["device"])))
     );
 
-    if (mb_eeprom.has_key("revision")) iface.write_eeprom(
-        E100_EEPROM_ADDR, offsetof(e100_eeprom_map, revision),
+    if (mb_eeprom.has_key("revision")) image.set(
+        offsetof(e100_eeprom_map, revision),
         byte_vector_t(1, boost::lexical_cast<unsigned>(mb_eeprom["revision"]))
     );
 
-    if (mb_eeprom.has_key("content")) iface.write_eeprom(
-        E100_EEPROM_ADDR, offsetof(e100_eeprom_map, content),
+    if (mb_eeprom.has_key("content")) image.set(
+        offsetof(e100_eeprom_map, content),
         byte_vector_t(1, boost::lexical_cast<unsigned>(mb_eeprom["content"]))
     );
 
-    #define store_e100_string_xx(key) if (mb_eeprom.has_key(#key)) iface.write_eeprom( \
-        E100_EEPROM_ADDR, offsetof(e100_eeprom_map, key), \
+    #define store_e100_string_xx(key) if (mb_eeprom.has_key(#key)) image.set( \
+        offsetof(e100_eeprom_map, key), \
         string_to_bytes(mb_eeprom[#key], sizeof_member(e100_eeprom_map, key)) \
     );
 
@@ -334,6 +401,8 @@ static void store_e100(const mboard_eeprom_t &mb_eeprom, i2c_iface &iface){
     store_e100_string_xx(env_setting);
     store_e100_string_xx(serial);
     store_e100_string_xx(name);
+
+    image.commit();
 }
 
 /***********************************************************************
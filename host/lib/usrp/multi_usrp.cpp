@@ -15,17 +15,23 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "../transport/polyphase_resampler.hpp"
 #include <uhd/property_tree.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <uhd/usrp/mboard_iface.hpp>
+#include <uhd/usrp/time_extrapolator.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/gain_group.hpp>
+#include <uhd/utils/tasks.hpp>
 #include <boost/thread.hpp>
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
+#include <boost/make_shared.hpp>
 #include <cmath>
+#include <deque>
+#include <map>
 
 using namespace uhd;
 using namespace uhd::usrp;
@@ -84,23 +90,24 @@ static meta_range_t make_overall_tune_range(
 /***********************************************************************
  * Gain helper functions
  **********************************************************************/
-static double get_gain_value(property_tree::sptr subtree){
-    return subtree->access<double>("value").get();
+static double get_gain_value(property<double>::sptr value){
+    return value->get();
 }
 
-static void set_gain_value(property_tree::sptr subtree, const double gain){
-    subtree->access<double>("value").set(gain);
+static void set_gain_value(property<double>::sptr value, const double gain){
+    value->set(gain);
 }
 
-static meta_range_t get_gain_range(property_tree::sptr subtree){
-    return subtree->access<meta_range_t>("range").get();
+static meta_range_t get_gain_range(property<meta_range_t>::sptr range){
+    return range->get();
 }
 
 static gain_fcns_t make_gain_fcns_from_subtree(property_tree::sptr subtree){
+    //resolve the properties once, the gain group calls these on every access
     gain_fcns_t gain_fcns;
-    gain_fcns.get_range = boost::bind(&get_gain_range, subtree);
-    gain_fcns.get_value = boost::bind(&get_gain_value, subtree);
-    gain_fcns.set_value = boost::bind(&set_gain_value, subtree, _1);
+    gain_fcns.get_range = boost::bind(&get_gain_range, subtree->access_handle<meta_range_t>("range"));
+    gain_fcns.get_value = boost::bind(&get_gain_value, subtree->access_handle<double>("value"));
+    gain_fcns.set_value = boost::bind(&set_gain_value, subtree->access_handle<double>("value"), _1);
     return gain_fcns;
 }
 
@@ -110,21 +117,43 @@ static gain_fcns_t make_gain_fcns_from_subtree(property_tree::sptr subtree){
 static const double RX_SIGN = +1.0;
 static const double TX_SIGN = -1.0;
 
+//! The properties of a channel that tuning touches, resolved once
+struct tune_props_type{
+    property<double>::sptr dsp_rate, dsp_freq;
+    property<double>::sptr rf_fe_freq, rf_fe_bandwidth;
+    property<bool>::sptr rf_fe_use_lo_offset;
+};
+
+static tune_props_type make_tune_props(
+    property_tree::sptr dsp_subtree,
+    property_tree::sptr rf_fe_subtree
+){
+    tune_props_type props;
+    props.dsp_rate = dsp_subtree->access_handle<double>("rate/value");
+    props.dsp_freq = dsp_subtree->access_handle<double>("freq/value");
+    props.rf_fe_freq = rf_fe_subtree->access_handle<double>("freq/value");
+    props.rf_fe_bandwidth = rf_fe_subtree->access_handle<double>("bandwidth/value");
+    props.rf_fe_use_lo_offset = rf_fe_subtree->access_handle<bool>("use_lo_offset");
+    return props;
+}
+
 static tune_result_t tune_xx_subdev_and_dsp(
     const double xx_sign,
-    property_tree::sptr dsp_subtree,
-    property_tree::sptr rf_fe_subtree,
+    const tune_props_type &props,
     const tune_request_t &tune_request
 ){
     //------------------------------------------------------------------
     //-- calculate the LO offset, only used with automatic policy
     //------------------------------------------------------------------
     double lo_offset = 0.0;
-    if (rf_fe_subtree->access<bool>("use_lo_offset").get()){
+    if (
+        tune_request.rf_freq_policy == tune_request_t::POLICY_AUTO and
+        props.rf_fe_use_lo_offset->get()
+    ){
         //If the local oscillator will be in the passband, use an offset.
         //But constrain the LO offset by the width of the filter bandwidth.
-        const double rate = dsp_subtree->access<double>("rate/value").get();
-        const double bw = rf_fe_subtree->access<double>("bandwidth/value").get();
+        const double rate = props.dsp_rate->get();
+        const double bw = props.rf_fe_bandwidth->get();
         if (bw > rate) lo_offset = std::min((bw - rate)/2, rate/2);
     }
 
@@ -135,17 +164,17 @@ static tune_result_t tune_xx_subdev_and_dsp(
     switch (tune_request.rf_freq_policy){
     case tune_request_t::POLICY_AUTO:
         target_rf_freq = tune_request.target_freq + lo_offset;
-        rf_fe_subtree->access<double>("freq/value").set(target_rf_freq);
+        props.rf_fe_freq->set(target_rf_freq);
         break;
 
     case tune_request_t::POLICY_MANUAL:
         target_rf_freq = tune_request.rf_freq;
-        rf_fe_subtree->access<double>("freq/value").set(target_rf_freq);
+        props.rf_fe_freq->set(target_rf_freq);
         break;
 
     case tune_request_t::POLICY_NONE: break; //does not set
     }
-    const double actual_rf_freq = rf_fe_subtree->access<double>("freq/value").get();
+    const double actual_rf_freq = props.rf_fe_freq->get();
 
     //------------------------------------------------------------------
     //-- calculate the dsp freq, only used with automatic policy
@@ -160,17 +189,17 @@ static tune_result_t tune_xx_subdev_and_dsp(
     //------------------------------------------------------------------
     switch (tune_request.dsp_freq_policy){
     case tune_request_t::POLICY_AUTO:
-        dsp_subtree->access<double>("freq/value").set(target_dsp_freq);
+        props.dsp_freq->set(target_dsp_freq);
         break;
 
     case tune_request_t::POLICY_MANUAL:
         target_dsp_freq = tune_request.dsp_freq;
-        dsp_subtree->access<double>("freq/value").set(target_dsp_freq);
+        props.dsp_freq->set(target_dsp_freq);
         break;
 
     case tune_request_t::POLICY_NONE: break; //does not set
     }
-    const double actual_dsp_freq = dsp_subtree->access<double>("freq/value").get();
+    const double actual_dsp_freq = props.dsp_freq->get();
 
     //------------------------------------------------------------------
     //-- load and return the tune result
@@ -183,19 +212,86 @@ static tune_result_t tune_xx_subdev_and_dsp(
     return tune_result;
 }
 
+static tune_request_t make_tune_plan(
+    const tune_request_t &tune_request,
+    const tune_result_t &tune_result
+){
+    //replay the resolved frequencies, leave unset elements alone
+    tune_request_t tune_plan(tune_request.target_freq);
+    tune_plan.rf_freq_policy = tune_request_t::POLICY_NONE;
+    tune_plan.dsp_freq_policy = tune_request_t::POLICY_NONE;
+    if (tune_request.rf_freq_policy != tune_request_t::POLICY_NONE){
+        tune_plan.rf_freq_policy = tune_request_t::POLICY_MANUAL;
+        tune_plan.rf_freq = tune_result.target_rf_freq;
+    }
+    if (tune_request.dsp_freq_policy != tune_request_t::POLICY_NONE){
+        tune_plan.dsp_freq_policy = tune_request_t::POLICY_MANUAL;
+        tune_plan.dsp_freq = tune_result.target_dsp_freq;
+    }
+    return tune_plan;
+}
+
 static double derive_freq_from_xx_subdev_and_dsp(
     const double xx_sign,
-    property_tree::sptr dsp_subtree,
-    property_tree::sptr rf_fe_subtree
+    const tune_props_type &props
 ){
     //extract actual dsp and IF frequencies
-    const double actual_rf_freq = rf_fe_subtree->access<double>("freq/value").get();
-    const double actual_dsp_freq = dsp_subtree->access<double>("freq/value").get();
+    const double actual_rf_freq = props.rf_fe_freq->get();
+    const double actual_dsp_freq = props.dsp_freq->get();
 
     //invert the sign on the dsp freq for transmit
     return actual_rf_freq - actual_dsp_freq * xx_sign;
 }
 
+/***********************************************************************
+ * Batch helper functions
+ **********************************************************************/
+typedef boost::function<void(void)> batch_job_type;
+typedef std::map<size_t, std::vector<batch_job_type> > mboard_jobs_type;
+
+static void run_batch_jobs(
+    const std::vector<batch_job_type> &jobs,
+    boost::shared_ptr<uhd::exception> &error
+){
+    //capture the error so the caller can rethrow it after the join
+    try{
+        BOOST_FOREACH(const batch_job_type &job, jobs) job();
+    }
+    catch(const uhd::exception &e){
+        error.reset(e.dynamic_clone());
+    }
+    catch(const std::exception &e){
+        error.reset(new uhd::runtime_error(e.what()));
+    }
+}
+
+static void store_system_time(time_spec_t *time){
+    *time = time_spec_t::get_system_time();
+}
+
+static void run_batch_jobs_per_mboard(const mboard_jobs_type &mboard_jobs){
+    //a single mboard does not need a thread
+    if (mboard_jobs.size() <= 1){
+        BOOST_FOREACH(const mboard_jobs_type::value_type &jobs, mboard_jobs){
+            BOOST_FOREACH(const batch_job_type &job, jobs.second) job();
+        }
+        return;
+    }
+
+    //one thread per mboard, each mboard runs its jobs in order
+    std::vector<boost::shared_ptr<uhd::exception> > errors(mboard_jobs.size());
+    boost::thread_group threads;
+    size_t i = 0;
+    BOOST_FOREACH(const mboard_jobs_type::value_type &jobs, mboard_jobs){
+        threads.create_thread(boost::bind(&run_batch_jobs, boost::cref(jobs.second), boost::ref(errors[i++])));
+    }
+    threads.join_all();
+
+    BOOST_FOREACH(const boost::shared_ptr<uhd::exception> &error, errors){
+        if (error.get() != NULL) error->dynamic_throw();
+    }
+}
+
 /***********************************************************************
  * Multi USRP Implementation
  **********************************************************************/
@@ -204,6 +300,29 @@ public:
     multi_usrp_impl(const device_addr_t &addr){
         _dev = device::make(addr);
         _tree = _dev->get_tree();
+
+        //the motherboards are fixed once the device is made
+        BOOST_FOREACH(const std::string &name, _tree->list("/mboards")){
+            _mb_roots.push_back("/mboards/" + name);
+        }
+
+        //the channel paths depend on the subdev spec, however it is set;
+        //the subscribers hold the caches, which outlive this object with the tree
+        _chan_caches = boost::make_shared<chan_caches_type>();
+        BOOST_FOREACH(const fs_path &mb_path, _mb_roots){
+            if (_tree->exists(mb_path / "rx_subdev_spec")){
+                _tree->access<subdev_spec_t>(mb_path / "rx_subdev_spec")
+                    .subscribe(boost::bind(&chan_caches_type::clear, _chan_caches, true));
+            }
+            if (_tree->exists(mb_path / "tx_subdev_spec")){
+                _tree->access<subdev_spec_t>(mb_path / "tx_subdev_spec")
+                    .subscribe(boost::bind(&chan_caches_type::clear, _chan_caches, false));
+            }
+        }
+    }
+
+    ~multi_usrp_impl(void){
+        _lock_wait_task.reset(); //stops the lock waits before the device goes away
     }
 
     device::sptr get_device(void){
@@ -215,7 +334,7 @@ public:
      ******************************************************************/
     void set_master_clock_rate(double rate, size_t mboard){
         if (mboard != ALL_MBOARDS){
-            _tree->access<double>(mb_root(mboard) / "tick_rate").set(rate);
+            prop<double>(mb_root(mboard) / "tick_rate").set(rate);
             return;
         }
         for (size_t m = 0; m < get_num_mboards(); m++){
@@ -224,7 +343,7 @@ public:
     }
 
     double get_master_clock_rate(size_t mboard){
-        return _tree->access<double>(mb_root(mboard) / "tick_rate").get();
+        return prop<double>(mb_root(mboard) / "tick_rate").get();
     }
 
     std::string get_pp_string(void){
@@ -283,7 +402,11 @@ public:
     }
 
     time_spec_t get_time_now(size_t mboard = 0){
-        return _tree->access<time_spec_t>(mb_root(mboard) / "time/now").get();
+        return prop<time_spec_t>(mb_root(mboard) / "time/now").get();
+    }
+
+    time_spec_t get_time_now_extrapolated(double &uncertainty, size_t mboard = 0){
+        return get_time_extrapolator(mboard)->get_time_now(uncertainty);
     }
 
     time_spec_t get_time_last_pps(size_t mboard = 0){
@@ -292,7 +415,7 @@ public:
 
     void set_time_now(const time_spec_t &time_spec, size_t mboard){
         if (mboard != ALL_MBOARDS){
-            _tree->access<time_spec_t>(mb_root(mboard) / "time/now").set(time_spec);
+            prop<time_spec_t>(mb_root(mboard) / "time/now").set(time_spec);
             return;
         }
         for (size_t m = 0; m < get_num_mboards(); m++){
@@ -301,29 +424,91 @@ public:
     }
 
     void set_time_next_pps(const time_spec_t &time_spec){
+        if (get_num_mboards() == 1){
+            _tree->access<time_spec_t>(mb_root(0) / "time/pps").set(time_spec);
+            return;
+        }
+
+        //one thread per mboard, so the control round trips overlap
+        std::vector<std::string> errors(get_num_mboards());
+        boost::thread_group threads;
         for (size_t m = 0; m < get_num_mboards(); m++){
-            _tree->access<time_spec_t>(mb_root(m) / "time/pps").set(time_spec);
+            threads.create_thread(boost::bind(&multi_usrp_impl::set_time_next_pps_one, this, time_spec, m, &errors[m]));
+        }
+        threads.join_all();
+        BOOST_FOREACH(const std::string &error, errors){
+            if (not error.empty()) throw uhd::runtime_error(error);
+        }
+    }
+
+    void set_time_next_pps_one(const time_spec_t &time_spec, const size_t mboard, std::string *error){
+        try{
+            _tree->access<time_spec_t>(mb_root(mboard) / "time/pps").set(time_spec);
+        }
+        catch(const std::exception &e){
+            *error = str(boost::format("set time next pps on board %u: %s") % mboard % e.what());
         }
     }
 
     void set_time_unknown_pps(const time_spec_t &time_spec){
         UHD_MSG(status) << "    1) catch time transition at pps edge" << std::endl;
-        time_spec_t time_start = get_time_now();
-        time_spec_t time_start_last_pps = get_time_last_pps();
-        while(true){
-            if (get_time_last_pps() != time_start_last_pps) break;
-            if ((get_time_now() - time_start) > time_spec_t(1.1)){
-                throw uhd::runtime_error(
-                    "Board 0 may not be getting a PPS signal!\n"
-                    "No PPS detected within the time interval.\n"
-                    "See the application notes for your device.\n"
-                );
+
+        //the time since the last pps tells how long until the next one,
+        //and the time of the reads is the control latency
+        const time_spec_t host_start = time_spec_t::get_system_time();
+        const time_spec_t time_start_last_pps = get_time_last_pps();
+        const time_spec_t time_start = get_time_now();
+        const time_spec_t host_read = time_spec_t::get_system_time();
+        const double rtt = (host_read - host_start).get_real_secs()/2;
+        const double elapsed = (time_start - time_start_last_pps).get_real_secs();
+
+        //the sets need a few round trips before the next pps, with room to spare
+        const double set_time = 4*rtt + 0.05;
+        time_spec_t host_edge = host_read - time_spec_t(elapsed);
+        if (elapsed < 0.0 or elapsed + set_time >= 1.0){
+            //the next pps is too near or unknown: poll for it, once per round trip
+            const long poll_us = std::max<long>(long(rtt*1e6), 100);
+            while (get_time_last_pps() == time_start_last_pps){
+                if ((time_spec_t::get_system_time() - host_start) > time_spec_t(1.1)){
+                    throw uhd::runtime_error(
+                        "Board 0 may not be getting a PPS signal!\n"
+                        "No PPS detected within the time interval.\n"
+                        "See the application notes for your device.\n"
+                    );
+                }
+                boost::this_thread::sleep(boost::posix_time::microseconds(poll_us));
             }
+            host_edge = time_spec_t::get_system_time() - time_spec_t(rtt);
         }
 
         UHD_MSG(status) << "    2) set times next pps (synchronously)" << std::endl;
+        time_spec_t last_pps = get_time_last_pps();
         set_time_next_pps(time_spec);
-        boost::this_thread::sleep(boost::posix_time::seconds(1));
+
+        //wait out the next pps, then the last pps of board 0 changes to the time that was set
+        //(or one second later when the read comes after the pps that follows)
+        const double wait = (host_edge + time_spec_t(1.0) - time_spec_t::get_system_time()).get_real_secs() + 0.01;
+        if (wait > 0.0) boost::this_thread::sleep(boost::posix_time::microseconds(long(wait*1e6)));
+        const time_spec_t host_set = time_spec_t::get_system_time();
+        bool pps_seen = false;
+        while (true){
+            const time_spec_t pps = get_time_last_pps();
+            if (pps != last_pps){
+                if (pps >= time_spec and pps <= time_spec + time_spec_t(1.0)) break;
+                pps_seen = true; //an edge before the set took effect
+                last_pps = pps;
+            }
+            if ((time_spec_t::get_system_time() - host_set) > time_spec_t(1.1)){
+                throw uhd::runtime_error(pps_seen?
+                    "Board 0 did not take the time at the next PPS!\n"
+                    "The last PPS time does not match the time that was set.\n" :
+                    "Board 0 may not be getting a PPS signal!\n"
+                    "The time was not set at the next PPS.\n"
+                    "See the application notes for your device.\n"
+                );
+            }
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
 
         //verify that the time registers are read to be within a few RTT
         for (size_t m = 1; m < get_num_mboards(); m++){
@@ -348,14 +533,64 @@ public:
         return true;
     }
 
+    void set_command_time(const time_spec_t &time_spec, size_t mboard){
+        if (mboard != ALL_MBOARDS){
+            if (not _tree->exists(mb_root(mboard) / "time/cmd")){
+                throw uhd::not_implemented_error("timed command feature not implemented on this hardware");
+            }
+            _tree->access<time_spec_t>(mb_root(mboard) / "time/cmd").set(time_spec);
+            return;
+        }
+        for (size_t m = 0; m < get_num_mboards(); m++){
+            set_command_time(time_spec, m);
+        }
+    }
+
+    void clear_command_time(size_t mboard){
+        if (mboard != ALL_MBOARDS){
+            //a time of zero clears the command time
+            set_command_time(time_spec_t(0.0), mboard);
+            return;
+        }
+        for (size_t m = 0; m < get_num_mboards(); m++){
+            clear_command_time(m);
+        }
+    }
+
     void issue_stream_cmd(const stream_cmd_t &stream_cmd, size_t chan){
         if (chan != ALL_CHANS){
             _tree->access<stream_cmd_t>(rx_dsp_root(chan) / "stream_cmd").set(stream_cmd);
             return;
         }
+        std::vector<std::pair<size_t, stream_cmd_t> > stream_cmds;
         for (size_t c = 0; c < get_rx_num_channels(); c++){
-            issue_stream_cmd(stream_cmd, c);
+            stream_cmds.push_back(std::make_pair(c, stream_cmd));
+        }
+        this->issue_stream_cmds(stream_cmds);
+    }
+
+    double issue_stream_cmds(const std::vector<std::pair<size_t, stream_cmd_t> > &stream_cmds){
+        mboard_jobs_type mboard_jobs;
+        for (size_t i = 0; i < stream_cmds.size(); i++){
+            mboard_jobs[rx_chan_to_mcp(stream_cmds[i].first).mboard].push_back(boost::bind(
+                &multi_usrp_impl::issue_stream_cmd, this, stream_cmds[i].second, stream_cmds[i].first
+            ));
+        }
+
+        //the last job of each mboard marks when it took all of its commands
+        const time_spec_t start = time_spec_t::get_system_time();
+        std::vector<time_spec_t> done(mboard_jobs.size(), start);
+        size_t i = 0;
+        BOOST_FOREACH(mboard_jobs_type::value_type &jobs, mboard_jobs){
+            jobs.second.push_back(boost::bind(&store_system_time, &done[i++]));
+        }
+        run_batch_jobs_per_mboard(mboard_jobs);
+
+        double worst = 0.0;
+        BOOST_FOREACH(const time_spec_t &t, done){
+            worst = std::max(worst, (t - start).get_real_secs());
         }
+        return worst;
     }
 
     void set_clock_config(const clock_config_t &clock_config, size_t mboard){
@@ -388,7 +623,7 @@ public:
     }
 
     size_t get_num_mboards(void){
-        return _tree->list("/mboards").size();
+        return _mb_roots.size();
     }
 
     sensor_value_t get_mboard_sensor(const std::string &name, size_t mboard){
@@ -399,6 +634,53 @@ public:
         return _tree->list(mb_root(mboard) / "sensors");
     }
 
+    dict<std::string, sensor_value_t> get_mboard_sensor_snapshot(size_t mboard, double max_age){
+        //one reader at a time, the others then find the fresh snapshot
+        boost::mutex::scoped_lock lock(_snapshot_mutex);
+        const boost::system_time now = boost::get_system_time();
+        snapshot_type &snapshot = _snapshots[mboard];
+        if (snapshot.values.get() != NULL and max_age > 0 and
+            now < snapshot.time + boost::posix_time::microseconds(long(max_age*1e6))
+        ) return *snapshot.values;
+
+        //the sensor dirs of the mboard and of every frontend
+        const fs_path root = mb_root(mboard);
+        std::vector<std::string> dirs(1, "sensors");
+        static const char *fe_dirs[] = {"rx_frontends", "tx_frontends"};
+        BOOST_FOREACH(const std::string &db, _tree->list(root / "dboards")){
+            BOOST_FOREACH(const char *xx, fe_dirs){
+                const fs_path fe_dir = fs_path("dboards") / db / xx;
+                if (not _tree->exists(root / fe_dir)) continue;
+                BOOST_FOREACH(const std::string &fe, _tree->list(root / fe_dir)){
+                    dirs.push_back(fe_dir / fe / "sensors");
+                }
+            }
+        }
+
+        //the device may read its sensor registers in one transaction
+        const bool batch = _tree->exists(root / "sensor_batch");
+        if (batch) _tree->access<bool>(root / "sensor_batch").set(true);
+        //sensor values cannot be assigned, so collect them before the dict
+        std::vector<std::pair<std::string, sensor_value_t> > values;
+        BOOST_FOREACH(const std::string &dir, dirs){
+            if (not _tree->exists(root / dir)) continue;
+            BOOST_FOREACH(const std::string &name, _tree->list(root / dir)){
+                const std::string key = fs_path(dir) / name;
+                try{
+                    values.push_back(std::make_pair(key, _tree->access<sensor_value_t>(root / key).get()));
+                }
+                catch(const std::exception &e){
+                    UHD_MSG(warning) << boost::format("Sensor %s not read: %s") % key % e.what() << std::endl;
+                }
+            }
+        }
+        if (batch) _tree->access<bool>(root / "sensor_batch").set(false);
+
+        snapshot.time = now;
+        snapshot.values.reset(new dict<std::string, sensor_value_t>(values.begin(), values.end()));
+        return *snapshot.values;
+    }
+
     mboard_iface::sptr get_mboard_iface(size_t){
         return mboard_iface::sptr(); //not implemented
     }
@@ -433,28 +715,48 @@ public:
     }
 
     void set_rx_rate(double rate, size_t chan){
+        this->set_rx_rate(rate, device_addr_t("resample=off"), chan);
+    }
+
+    void set_rx_rate(double rate, const device_addr_t &options, size_t chan){
         if (chan != ALL_CHANS){
-            _tree->access<double>(rx_dsp_root(chan) / "rate" / "value").set(rate);
+            set_dsp_rate(rx_dsp_root(chan), rate, options);
             do_samp_rate_warning_message(rate, get_rx_rate(chan), "RX");
             return;
         }
         for (size_t c = 0; c < get_rx_num_channels(); c++){
-            set_rx_rate(rate, c);
+            set_rx_rate(rate, options, c);
         }
     }
 
     double get_rx_rate(size_t chan){
-        return _tree->access<double>(rx_dsp_root(chan) / "rate" / "value").get();
+        return get_dsp_rate(rx_dsp_root(chan));
     }
 
     tune_result_t set_rx_freq(const tune_request_t &tune_request, size_t chan){
-        tune_result_t r = tune_xx_subdev_and_dsp(RX_SIGN, _tree->subtree(rx_dsp_root(chan)), _tree->subtree(rx_rf_fe_root(chan)), tune_request);
+        tune_result_t r = tune_xx_subdev_and_dsp(RX_SIGN, rx_chan_cache(chan).tune_props, tune_request);
         do_tune_freq_warning_message(tune_request.target_freq, get_rx_freq(chan), "RX");
         return r;
     }
 
+    tune_request_t make_rx_tune_plan(const tune_request_t &tune_request, size_t chan){
+        return make_tune_plan(tune_request, this->set_rx_freq(tune_request, chan));
+    }
+
+    std::vector<tune_result_t> set_rx_freqs(const std::vector<std::pair<size_t, tune_request_t> > &tune_requests){
+        std::vector<tune_result_t> results(tune_requests.size());
+        mboard_jobs_type mboard_jobs;
+        for (size_t i = 0; i < tune_requests.size(); i++){
+            mboard_jobs[rx_chan_to_mcp(tune_requests[i].first).mboard].push_back(boost::bind(
+                &multi_usrp_impl::store_rx_freq, this, tune_requests[i].second, tune_requests[i].first, &results[i]
+            ));
+        }
+        run_batch_jobs_per_mboard(mboard_jobs);
+        return results;
+    }
+
     double get_rx_freq(size_t chan){
-        return derive_freq_from_xx_subdev_and_dsp(RX_SIGN, _tree->subtree(rx_dsp_root(chan)), _tree->subtree(rx_rf_fe_root(chan)));
+        return derive_freq_from_xx_subdev_and_dsp(RX_SIGN, rx_chan_cache(chan).tune_props);
     }
 
     freq_range_t get_rx_freq_range(size_t chan){
@@ -481,10 +783,30 @@ public:
         return rx_gain_group(chan)->get_names();
     }
 
+    void set_rx_gains(const std::vector<std::pair<size_t, double> > &gains){
+        mboard_jobs_type mboard_jobs;
+        for (size_t i = 0; i < gains.size(); i++){
+            mboard_jobs[rx_chan_to_mcp(gains[i].first).mboard].push_back(boost::bind(
+                &multi_usrp_impl::set_rx_gain, this, gains[i].second, ALL_GAINS, gains[i].first
+            ));
+        }
+        run_batch_jobs_per_mboard(mboard_jobs);
+    }
+
     void set_rx_antenna(const std::string &ant, size_t chan){
         _tree->access<std::string>(rx_rf_fe_root(chan) / "antenna" / "value").set(ant);
     }
 
+    void set_rx_antennas(const std::vector<std::pair<size_t, std::string> > &ants){
+        mboard_jobs_type mboard_jobs;
+        for (size_t i = 0; i < ants.size(); i++){
+            mboard_jobs[rx_chan_to_mcp(ants[i].first).mboard].push_back(boost::bind(
+                &multi_usrp_impl::set_rx_antenna, this, ants[i].second, ants[i].first
+            ));
+        }
+        run_batch_jobs_per_mboard(mboard_jobs);
+    }
+
     std::string get_rx_antenna(size_t chan){
         return _tree->access<std::string>(rx_rf_fe_root(chan) / "antenna" / "value").get();
     }
@@ -513,6 +835,14 @@ public:
         return _tree->list(rx_rf_fe_root(chan) / "sensors");
     }
 
+    bool wait_rx_lo_locked(double timeout, size_t chan){
+        return wait_lo_locked(rx_rf_fe_root(chan) / "sensors", timeout);
+    }
+
+    void async_wait_rx_lo_locked(const lo_locked_callback_type &callback, double timeout, size_t chan){
+        post_lock_wait(boost::bind(&multi_usrp_impl::wait_rx_lo_locked, this, timeout, chan), callback);
+    }
+
     /*******************************************************************
      * TX methods
      ******************************************************************/
@@ -543,28 +873,48 @@ public:
     }
 
     void set_tx_rate(double rate, size_t chan){
+        this->set_tx_rate(rate, device_addr_t("resample=off"), chan);
+    }
+
+    void set_tx_rate(double rate, const device_addr_t &options, size_t chan){
         if (chan != ALL_CHANS){
-            _tree->access<double>(tx_dsp_root(chan) / "rate" / "value").set(rate);
+            set_dsp_rate(tx_dsp_root(chan), rate, options);
             do_samp_rate_warning_message(rate, get_tx_rate(chan), "TX");
             return;
         }
         for (size_t c = 0; c < get_tx_num_channels(); c++){
-            set_tx_rate(rate, c);
+            set_tx_rate(rate, options, c);
         }
     }
 
     double get_tx_rate(size_t chan){
-        return _tree->access<double>(tx_dsp_root(chan) / "rate" / "value").get();
+        return get_dsp_rate(tx_dsp_root(chan));
     }
 
     tune_result_t set_tx_freq(const tune_request_t &tune_request, size_t chan){
-        tune_result_t r = tune_xx_subdev_and_dsp(TX_SIGN, _tree->subtree(tx_dsp_root(chan)), _tree->subtree(tx_rf_fe_root(chan)), tune_request);
+        tune_result_t r = tune_xx_subdev_and_dsp(TX_SIGN, tx_chan_cache(chan).tune_props, tune_request);
         do_tune_freq_warning_message(tune_request.target_freq, get_tx_freq(chan), "TX");
         return r;
     }
 
+    tune_request_t make_tx_tune_plan(const tune_request_t &tune_request, size_t chan){
+        return make_tune_plan(tune_request, this->set_tx_freq(tune_request, chan));
+    }
+
+    std::vector<tune_result_t> set_tx_freqs(const std::vector<std::pair<size_t, tune_request_t> > &tune_requests){
+        std::vector<tune_result_t> results(tune_requests.size());
+        mboard_jobs_type mboard_jobs;
+        for (size_t i = 0; i < tune_requests.size(); i++){
+            mboard_jobs[tx_chan_to_mcp(tune_requests[i].first).mboard].push_back(boost::bind(
+                &multi_usrp_impl::store_tx_freq, this, tune_requests[i].second, tune_requests[i].first, &results[i]
+            ));
+        }
+        run_batch_jobs_per_mboard(mboard_jobs);
+        return results;
+    }
+
     double get_tx_freq(size_t chan){
-        return derive_freq_from_xx_subdev_and_dsp(TX_SIGN, _tree->subtree(tx_dsp_root(chan)), _tree->subtree(tx_rf_fe_root(chan)));
+        return derive_freq_from_xx_subdev_and_dsp(TX_SIGN, tx_chan_cache(chan).tune_props);
     }
 
     freq_range_t get_tx_freq_range(size_t chan){
@@ -591,10 +941,30 @@ public:
         return tx_gain_group(chan)->get_names();
     }
 
+    void set_tx_gains(const std::vector<std::pair<size_t, double> > &gains){
+        mboard_jobs_type mboard_jobs;
+        for (size_t i = 0; i < gains.size(); i++){
+            mboard_jobs[tx_chan_to_mcp(gains[i].first).mboard].push_back(boost::bind(
+                &multi_usrp_impl::set_tx_gain, this, gains[i].second, ALL_GAINS, gains[i].first
+            ));
+        }
+        run_batch_jobs_per_mboard(mboard_jobs);
+    }
+
     void set_tx_antenna(const std::string &ant, size_t chan){
         _tree->access<std::string>(tx_rf_fe_root(chan) / "antenna" / "value").set(ant);
     }
 
+    void set_tx_antennas(const std::vector<std::pair<size_t, std::string> > &ants){
+        mboard_jobs_type mboard_jobs;
+        for (size_t i = 0; i < ants.size(); i++){
+            mboard_jobs[tx_chan_to_mcp(ants[i].first).mboard].push_back(boost::bind(
+                &multi_usrp_impl::set_tx_antenna, this, ants[i].second, ants[i].first
+            ));
+        }
+        run_batch_jobs_per_mboard(mboard_jobs);
+    }
+
     std::string get_tx_antenna(size_t chan){
         return _tree->access<std::string>(tx_rf_fe_root(chan) / "antenna" / "value").get();
     }
@@ -623,6 +993,14 @@ public:
         return _tree->list(tx_rf_fe_root(chan) / "sensors");
     }
 
+    bool wait_tx_lo_locked(double timeout, size_t chan){
+        return wait_lo_locked(tx_rf_fe_root(chan) / "sensors", timeout);
+    }
+
+    void async_wait_tx_lo_locked(const lo_locked_callback_type &callback, double timeout, size_t chan){
+        post_lock_wait(boost::bind(&multi_usrp_impl::wait_tx_lo_locked, this, timeout, chan), callback);
+    }
+
 private:
     device::sptr _dev;
     property_tree::sptr _tree;
@@ -632,6 +1010,14 @@ private:
         mboard_chan_pair(void): mboard(0), chan(0){}
     };
 
+    void store_rx_freq(const tune_request_t &tune_request, size_t chan, tune_result_t *result){
+        *result = this->set_rx_freq(tune_request, chan);
+    }
+
+    void store_tx_freq(const tune_request_t &tune_request, size_t chan, tune_result_t *result){
+        *result = this->set_tx_freq(tune_request, chan);
+    }
+
     mboard_chan_pair rx_chan_to_mcp(size_t chan){
         mboard_chan_pair mcp;
         mcp.chan = chan;
@@ -654,59 +1040,272 @@ private:
         return mcp;
     }
 
+    /*!
+     * Set the rate of a dsp, then turn on its host resampler
+     * when the options allow and the dsp could not make the rate.
+     * The dsp is moved up a step when it came in under the rate,
+     * so the resampler does not cut into the requested bandwidth.
+     */
+    void set_dsp_rate(const fs_path &dsp_root, const double rate, const device_addr_t &options){
+        const fs_path resampler_path = dsp_root / "rate" / "resampler";
+        const bool has_resampler = _tree->exists(resampler_path);
+        if (has_resampler) prop<transport::resampler_config_t>(resampler_path).set(transport::resampler_config_t());
+
+        property<double> &dsp_rate = prop<double>(dsp_root / "rate" / "value");
+        dsp_rate.set(rate);
+        if (not has_resampler or options.get("resample", "auto") == "off") return;
+        if (std::abs(dsp_rate.get() - rate) <= 1e-9*rate) return;
+
+        if (dsp_rate.get() < rate){
+            const double tick_rate = prop<double>(dsp_root.branch_path().branch_path() / "tick_rate").get();
+            const double factor = std::floor(tick_rate/dsp_rate.get() + 0.5);
+            if (factor > 1) dsp_rate.set(tick_rate/(factor - 1));
+            if (dsp_rate.get() < rate) dsp_rate.set(rate); //could not step up
+        }
+
+        transport::resampler_config_t config;
+        config.rate = rate;
+        config.taps_per_phase = options.cast<size_t>("taps_per_phase", config.taps_per_phase);
+        config.max_phases = options.cast<size_t>("max_phases", config.max_phases);
+        prop<transport::resampler_config_t>(resampler_path).set(config);
+    }
+
+    //! Get the host side rate of a dsp, the resampler rate when it is on
+    double get_dsp_rate(const fs_path &dsp_root){
+        const fs_path resampler_path = dsp_root / "rate" / "resampler";
+        if (_tree->exists(resampler_path)){
+            const double rate = prop<transport::resampler_config_t>(resampler_path).get().rate;
+            if (rate != 0) return rate;
+        }
+        return prop<double>(dsp_root / "rate" / "value").get();
+    }
+
     fs_path mb_root(const size_t mboard){
-        const std::string name = _tree->list("/mboards").at(mboard);
-        return "/mboards/" + name;
+        return _mb_roots.at(mboard);
     }
 
     fs_path rx_dsp_root(const size_t chan){
-        mboard_chan_pair mcp = rx_chan_to_mcp(chan);
-        const std::string name = _tree->list(mb_root(mcp.mboard) / "rx_dsps").at(mcp.chan);
-        return mb_root(mcp.mboard) / "rx_dsps" / name;
+        return rx_chan_cache(chan).dsp_root;
     }
 
     fs_path tx_dsp_root(const size_t chan){
-        mboard_chan_pair mcp = tx_chan_to_mcp(chan);
-        const std::string name = _tree->list(mb_root(mcp.mboard) / "tx_dsps").at(mcp.chan);
-        return mb_root(mcp.mboard) / "tx_dsps" / name;
+        return tx_chan_cache(chan).dsp_root;
     }
 
     fs_path rx_rf_fe_root(const size_t chan){
-        mboard_chan_pair mcp = rx_chan_to_mcp(chan);
-        const subdev_spec_pair_t spec = get_rx_subdev_spec(mcp.mboard).at(mcp.chan);
-        return mb_root(mcp.mboard) / "dboards" / spec.db_name / "rx_frontends" / spec.sd_name;
+        return rx_chan_cache(chan).rf_fe_root;
     }
 
     fs_path tx_rf_fe_root(const size_t chan){
-        mboard_chan_pair mcp = tx_chan_to_mcp(chan);
-        const subdev_spec_pair_t spec = get_tx_subdev_spec(mcp.mboard).at(mcp.chan);
-        return mb_root(mcp.mboard) / "dboards" / spec.db_name / "tx_frontends" / spec.sd_name;
+        return tx_chan_cache(chan).rf_fe_root;
     }
 
     gain_group::sptr rx_gain_group(size_t chan){
+        return rx_chan_cache(chan).gains;
+    }
+
+    gain_group::sptr tx_gain_group(size_t chan){
+        return tx_chan_cache(chan).gains;
+    }
+
+    /*******************************************************************
+     * Caches of resolved paths and property handles:
+     * The per-channel paths depend on the subdev spec,
+     * so the subdev spec subscribers clear them.
+     ******************************************************************/
+    struct chan_cache_type{
+        fs_path dsp_root, rf_fe_root;
+        tune_props_type tune_props;
+        gain_group::sptr gains;
+    };
+
+    struct chan_caches_type{
+        chan_caches_type(void): rx_generation(0), tx_generation(0){}
+        boost::mutex mutex;
+        std::map<size_t, chan_cache_type> rx, tx;
+        size_t rx_generation, tx_generation; //a resolve started before a clear is dropped
+
+        void clear(const bool is_rx){
+            boost::mutex::scoped_lock lock(mutex);
+            if (is_rx){rx.clear(); rx_generation++;}
+            else      {tx.clear(); tx_generation++;}
+        }
+    };
+
+    boost::mutex _cache_mutex;
+    std::vector<fs_path> _mb_roots;
+    std::map<std::string, boost::shared_ptr<void> > _prop_cache;
+    boost::shared_ptr<chan_caches_type> _chan_caches;
+
+    //the latest sensor snapshot of each mboard
+    struct snapshot_type{
+        boost::system_time time;
+        boost::shared_ptr<const dict<std::string, sensor_value_t> > values;
+    };
+    boost::mutex _snapshot_mutex;
+    std::map<size_t, snapshot_type> _snapshots;
+
+    /*******************************************************************
+     * Time extrapolators:
+     * Made on first use for each mboard, and reset by any set
+     * of the time registers or tick rate through the property tree.
+     ******************************************************************/
+    boost::mutex _time_extrapolator_mutex;
+    std::map<size_t, time_extrapolator::sptr> _time_extrapolators;
+
+    time_extrapolator::sptr get_time_extrapolator(size_t mboard){
+        boost::mutex::scoped_lock lock(_time_extrapolator_mutex);
+        time_extrapolator::sptr &extrapolator = _time_extrapolators[mboard];
+        if (extrapolator.get() != NULL) return extrapolator;
+
+        extrapolator = time_extrapolator::make(
+            boost::bind(&multi_usrp_impl::get_time_now, this, mboard)
+        );
+        const boost::function<void(void)> reset = boost::bind(&time_extrapolator::reset, extrapolator);
+        _tree->access<time_spec_t>(mb_root(mboard) / "time/now").subscribe(boost::bind(reset));
+        if (_tree->exists(mb_root(mboard) / "time/pps")){
+            _tree->access<time_spec_t>(mb_root(mboard) / "time/pps").subscribe(boost::bind(reset));
+        }
+        _tree->access<double>(mb_root(mboard) / "tick_rate").subscribe(boost::bind(reset));
+        return extrapolator;
+    }
+
+    /*******************************************************************
+     * LO lock waits:
+     * The async waits are queued for a worker task,
+     * which is started by the first async wait.
+     ******************************************************************/
+    struct lock_wait_type{
+        boost::function<bool(void)> wait;
+        lo_locked_callback_type callback;
+    };
+    boost::mutex _lock_wait_mutex;
+    boost::condition_variable _lock_wait_cond;
+    std::deque<lock_wait_type> _lock_waits;
+    task::sptr _lock_wait_task;
+
+    bool wait_lo_locked(const fs_path &sensors, double timeout){
+        if (not _tree->exists(sensors / "lo_locked")) return true;
+        property<sensor_value_t> &lo_locked = prop<sensor_value_t>(sensors / "lo_locked");
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::microseconds(long(timeout*1e6));
+
+        //each read is a control round trip, which paces the polling
+        while (not lo_locked.get().to_bool()){
+            if (boost::get_system_time() >= exit_time) return false;
+            boost::this_thread::interruption_point();
+        }
+        return true;
+    }
+
+    void post_lock_wait(const boost::function<bool(void)> &wait, const lo_locked_callback_type &callback){
+        boost::mutex::scoped_lock lock(_lock_wait_mutex);
+        lock_wait_type lock_wait;
+        lock_wait.wait = wait;
+        lock_wait.callback = callback;
+        _lock_waits.push_back(lock_wait);
+        if (_lock_wait_task.get() == NULL){
+            _lock_wait_task = task::make(boost::bind(&multi_usrp_impl::lock_wait_task, this));
+            _lock_wait_task->set_name("lock wait");
+        }
+        _lock_wait_cond.notify_one();
+    }
+
+    void lock_wait_task(void){
+        lock_wait_type lock_wait;
+        {
+            boost::mutex::scoped_lock lock(_lock_wait_mutex);
+            while (_lock_waits.empty()) _lock_wait_cond.wait(lock);
+            lock_wait = _lock_waits.front();
+            _lock_waits.pop_front();
+        }
+
+        //an error in one wait must not end the task
+        bool locked = false;
+        try{
+            locked = lock_wait.wait();
+        }
+        catch(const std::exception &e){
+            UHD_MSG(error) << "LO lock wait failed: " << e.what() << std::endl;
+        }
+        try{
+            lock_wait.callback(locked);
+        }
+        catch(const std::exception &e){
+            UHD_MSG(error) << "LO lock callback failed: " << e.what() << std::endl;
+        }
+    }
+
+    //! Access a property through a handle that is resolved on first use
+    template <typename T> property<T> &prop(const fs_path &path){
+        boost::mutex::scoped_lock lock(_cache_mutex);
+        const std::map<std::string, boost::shared_ptr<void> >::const_iterator it = _prop_cache.find(path);
+        if (it != _prop_cache.end()) return *boost::static_pointer_cast<property<T> >(it->second);
+        typename property<T>::sptr handle = _tree->access_handle<T>(path);
+        _prop_cache[path] = handle;
+        return *handle;
+    }
+
+    chan_cache_type rx_chan_cache(const size_t chan){
+        size_t generation;
+        {
+            boost::mutex::scoped_lock lock(_chan_caches->mutex);
+            const std::map<size_t, chan_cache_type>::const_iterator it = _chan_caches->rx.find(chan);
+            if (it != _chan_caches->rx.end()) return it->second;
+            generation = _chan_caches->rx_generation;
+        }
+
+        //resolve outside of the lock, this accesses the tree
+        chan_cache_type cache;
         mboard_chan_pair mcp = rx_chan_to_mcp(chan);
+        const std::string dsp_name = _tree->list(mb_root(mcp.mboard) / "rx_dsps").at(mcp.chan);
+        cache.dsp_root = mb_root(mcp.mboard) / "rx_dsps" / dsp_name;
         const subdev_spec_pair_t spec = get_rx_subdev_spec(mcp.mboard).at(mcp.chan);
-        gain_group::sptr gg = gain_group::make();
+        cache.rf_fe_root = mb_root(mcp.mboard) / "dboards" / spec.db_name / "rx_frontends" / spec.sd_name;
+        cache.tune_props = make_tune_props(_tree->subtree(cache.dsp_root), _tree->subtree(cache.rf_fe_root));
+
+        cache.gains = gain_group::make();
         BOOST_FOREACH(const std::string &name, _tree->list(mb_root(mcp.mboard) / "rx_codecs" / spec.db_name / "gains")){
-            gg->register_fcns("ADC-"+name, make_gain_fcns_from_subtree(_tree->subtree(mb_root(mcp.mboard) / "rx_codecs" / spec.db_name / "gains" / name)), 0 /* low prio */);
+            cache.gains->register_fcns("ADC-"+name, make_gain_fcns_from_subtree(_tree->subtree(mb_root(mcp.mboard) / "rx_codecs" / spec.db_name / "gains" / name)), 0 /* low prio */);
         }
-        BOOST_FOREACH(const std::string &name, _tree->list(rx_rf_fe_root(chan) / "gains")){
-            gg->register_fcns(name, make_gain_fcns_from_subtree(_tree->subtree(rx_rf_fe_root(chan) / "gains" / name)), 1 /* high prio */);
+        BOOST_FOREACH(const std::string &name, _tree->list(cache.rf_fe_root / "gains")){
+            cache.gains->register_fcns(name, make_gain_fcns_from_subtree(_tree->subtree(cache.rf_fe_root / "gains" / name)), 1 /* high prio */);
         }
-        return gg;
+
+        boost::mutex::scoped_lock lock(_chan_caches->mutex);
+        if (generation == _chan_caches->rx_generation) _chan_caches->rx[chan] = cache;
+        return cache;
     }
 
-    gain_group::sptr tx_gain_group(size_t chan){
+    chan_cache_type tx_chan_cache(const size_t chan){
+        size_t generation;
+        {
+            boost::mutex::scoped_lock lock(_chan_caches->mutex);
+            const std::map<size_t, chan_cache_type>::const_iterator it = _chan_caches->tx.find(chan);
+            if (it != _chan_caches->tx.end()) return it->second;
+            generation = _chan_caches->tx_generation;
+        }
+
+        //resolve outside of the lock, this accesses the tree
+        chan_cache_type cache;
         mboard_chan_pair mcp = tx_chan_to_mcp(chan);
+        const std::string dsp_name = _tree->list(mb_root(mcp.mboard) / "tx_dsps").at(mcp.chan);
+        cache.dsp_root = mb_root(mcp.mboard) / "tx_dsps" / dsp_name;
         const subdev_spec_pair_t spec = get_tx_subdev_spec(mcp.mboard).at(mcp.chan);
-        gain_group::sptr gg = gain_group::make();
+        cache.rf_fe_root = mb_root(mcp.mboard) / "dboards" / spec.db_name / "tx_frontends" / spec.sd_name;
+        cache.tune_props = make_tune_props(_tree->subtree(cache.dsp_root), _tree->subtree(cache.rf_fe_root));
+
+        cache.gains = gain_group::make();
         BOOST_FOREACH(const std::string &name, _tree->list(mb_root(mcp.mboard) / "tx_codecs" / spec.db_name / "gains")){
-            gg->register_fcns("ADC-"+name, make_gain_fcns_from_subtree(_tree->subtree(mb_root(mcp.mboard) / "tx_codecs" / spec.db_name / "gains" / name)), 1 /* high prio */);
+            cache.gains->register_fcns("ADC-"+name, make_gain_fcns_from_subtree(_tree->subtree(mb_root(mcp.mboard) / "tx_codecs" / spec.db_name / "gains" / name)), 1 /* high prio */);
         }
-        BOOST_FOREACH(const std::string &name, _tree->list(tx_rf_fe_root(chan) / "gains")){
-            gg->register_fcns(name, make_gain_fcns_from_subtree(_tree->subtree(tx_rf_fe_root(chan) / "gains" / name)), 0 /* low prio */);
+        BOOST_FOREACH(const std::string &name, _tree->list(cache.rf_fe_root / "gains")){
+            cache.gains->register_fcns(name, make_gain_fcns_from_subtree(_tree->subtree(cache.rf_fe_root / "gains" / name)), 0 /* low prio */);
         }
-        return gg;
+
+        boost::mutex::scoped_lock lock(_chan_caches->mutex);
+        if (generation == _chan_caches->tx_generation) _chan_caches->tx[chan] = cache;
+        return cache;
     }
 };
 
@@ -0,0 +1,395 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "../transport/udp_common.hpp"
+#include <uhd/usrp/property_broker.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/types/sensors.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/exception.hpp>
+#include <boost/asio.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <cstdio>
+
+using namespace uhd;
+using namespace uhd::usrp;
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+/***********************************************************************
+ * Broker protocol:
+ * A request is one line on the socket: the operation, the path,
+ * and for a set the value, separated by a space:
+ *  - list <path>, type <path>, get <path>, set <path> <value>
+ * The reply is one line: "ok <value>" or "error <message>".
+ * A backslash and a newline in a value or a message are escaped.
+ **********************************************************************/
+static const double poll_interval = 0.1; //seconds, of the server thread
+static const double send_timeout = 0.1; //seconds, before a client that does not read is dropped
+static const size_t max_line_len = 65536;
+
+static std::string escape_line(const std::string &str){
+    std::string out;
+    BOOST_FOREACH(const char ch, str){
+        if (ch == '\\') out += "\\\\";
+        else if (ch == '\n') out += "\\n";
+        else out += ch;
+    }
+    return out;
+}
+
+static std::string unescape_line(const std::string &str){
+    std::string out;
+    for (size_t i = 0; i < str.size(); i++){
+        if (str[i] == '\\' and i + 1 < str.size()){
+            out += (str[++i] == 'n')? '\n' : str[i];
+        }
+        else out += str[i];
+    }
+    return out;
+}
+
+/***********************************************************************
+ * Property values as strings
+ **********************************************************************/
+static std::string get_type_name(const std::type_info &type){
+    if (type == typeid(bool))                     return "bool";
+    if (type == typeid(int))                      return "int";
+    if (type == typeid(double))                   return "double";
+    if (type == typeid(size_t))                   return "size_t";
+    if (type == typeid(std::string))              return "string";
+    if (type == typeid(time_spec_t))              return "time_spec";
+    if (type == typeid(meta_range_t))             return "meta_range";
+    if (type == typeid(sensor_value_t))           return "sensor_value";
+    if (type == typeid(std::vector<std::string>)) return "string_list";
+    return "unknown";
+}
+
+static std::string get_value(property_tree::sptr tree, const fs_path &path){
+    const std::type_info &type = tree->type_of(path);
+    if (type == typeid(bool)) return tree->access<bool>(path).get()? "true" : "false";
+    if (type == typeid(int)) return boost::lexical_cast<std::string>(tree->access<int>(path).get());
+    if (type == typeid(double)) return boost::lexical_cast<std::string>(tree->access<double>(path).get());
+    if (type == typeid(size_t)) return boost::lexical_cast<std::string>(tree->access<size_t>(path).get());
+    if (type == typeid(std::string)) return tree->access<std::string>(path).get();
+    if (type == typeid(time_spec_t)){
+        return str(boost::format("%.9f") % tree->access<time_spec_t>(path).get().get_real_secs());
+    }
+    if (type == typeid(meta_range_t)){
+        const meta_range_t range = tree->access<meta_range_t>(path).get();
+        return str(boost::format("%g:%g:%g") % range.start() % range.stop() % range.step());
+    }
+    if (type == typeid(sensor_value_t)) return tree->access<sensor_value_t>(path).get().to_pp_string();
+    if (type == typeid(std::vector<std::string>)){
+        std::string out;
+        BOOST_FOREACH(const std::string &value, tree->access<std::vector<std::string> >(path).get()){
+            out += ((out.empty())? "" : ",") + value;
+        }
+        return out;
+    }
+    throw uhd::type_error("property server: cannot get a property of this type: " + path);
+}
+
+static bool to_bool(const std::string &value){
+    if (value == "true" or value == "1") return true;
+    if (value == "false" or value == "0") return false;
+    throw uhd::value_error("property server: not a bool: " + value);
+}
+
+static void set_value(property_tree::sptr tree, const fs_path &path, const std::string &value){
+    const std::type_info &type = tree->type_of(path);
+    if (type == typeid(bool)) tree->access<bool>(path).set(to_bool(value));
+    else if (type == typeid(int)) tree->access<int>(path).set(boost::lexical_cast<int>(value));
+    else if (type == typeid(double)) tree->access<double>(path).set(boost::lexical_cast<double>(value));
+    else if (type == typeid(size_t)) tree->access<size_t>(path).set(boost::lexical_cast<size_t>(value));
+    else if (type == typeid(std::string)) tree->access<std::string>(path).set(value);
+    else if (type == typeid(time_spec_t)) tree->access<time_spec_t>(path).set(time_spec_t(boost::lexical_cast<double>(value)));
+    else throw uhd::type_error("property server: cannot set a property of this type: " + path);
+}
+
+/***********************************************************************
+ * Property server:
+ * One thread waits on the listening socket and on every client,
+ * and answers the requests of each client in order.
+ **********************************************************************/
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+#include <sys/stat.h>
+
+typedef asio::local::stream_protocol::socket local_socket_type;
+
+//! Wait for a socket to take more bytes, true when it is ready
+static bool wait_for_send_ready(int sock_fd, double timeout){
+    timeval tv;
+    tv.tv_sec = int(timeout);
+    tv.tv_usec = int(timeout*1000000)%1000000;
+
+    fd_set wset;
+    FD_ZERO(&wset);
+    FD_SET(sock_fd, &wset);
+    return ::select(sock_fd+1, NULL, &wset, NULL, &tv) > 0;
+}
+
+//! Write all of a buffer without blocking longer than the timeout
+static bool write_with_timeout(local_socket_type &socket, const std::string &buff, const double timeout){
+    const boost::system_time exit_time = boost::get_system_time() +
+        boost::posix_time::microseconds(long(timeout*1e6));
+    size_t pos = 0;
+    while (pos < buff.size()){
+        boost::system::error_code ec;
+        pos += socket.write_some(asio::buffer(buff.data() + pos, buff.size() - pos), ec);
+        if (ec == asio::error::would_block){
+            const double remaining = double((exit_time - boost::get_system_time()).total_microseconds())/1e6;
+            if (remaining <= 0.0 or not wait_for_send_ready(socket.native(), remaining)) return false;
+        }
+        else if (ec) return false;
+    }
+    return true;
+}
+
+class property_server_impl : public property_server{
+public:
+    property_server_impl(property_tree::sptr tree, const std::string &socket_path):
+        _tree(tree), _socket_path(socket_path), _acceptor(_io_service)
+    {
+        const asio::local::stream_protocol::endpoint endpoint(_socket_path);
+
+        //a socket where a server still answers is not taken over,
+        //a socket left behind by a server that died is replaced
+        {
+            local_socket_type probe(_io_service);
+            boost::system::error_code ec;
+            probe.connect(endpoint, ec);
+            if (not ec) throw uhd::runtime_error("property server: a server already answers on " + _socket_path);
+        }
+        std::remove(_socket_path.c_str());
+
+        //only the user of the process may connect: restrict the socket before it listens
+        _acceptor.open(endpoint.protocol());
+        _acceptor.bind(endpoint);
+        if (::chmod(_socket_path.c_str(), S_IRUSR | S_IWUSR) != 0){
+            throw uhd::os_error("property server: cannot restrict the permissions of " + _socket_path);
+        }
+        _acceptor.listen();
+        UHD_LOG << "property server on " << _socket_path << std::endl;
+        _thread = boost::thread(boost::bind(&property_server_impl::serve_loop, this));
+    }
+
+    ~property_server_impl(void){UHD_SAFE_CALL(
+        _thread.interrupt();
+        _thread.join();
+        _clients.clear();
+        _acceptor.close();
+        std::remove(_socket_path.c_str());
+    )}
+
+    size_t get_num_requests(void) const{
+        return _num_requests.read();
+    }
+
+private:
+    struct client_type{
+        boost::shared_ptr<local_socket_type> socket;
+        std::string line; //the partial request
+    };
+
+    void serve_loop(void){
+        std::vector<int> fds;
+        std::vector<bool> ready;
+        char buff[4096];
+        while (not boost::this_thread::interruption_requested()){
+            fds.assign(1, _acceptor.native());
+            BOOST_FOREACH(const client_type &client, _clients) fds.push_back(client.socket->native());
+            if (not wait_for_recv_ready(fds, poll_interval, ready)) continue;
+
+            //serve the clients that were polled, before the new client
+            for (size_t i = _clients.size(); i > 0; i--){
+                if (not ready[i]) continue;
+                boost::system::error_code ec;
+                const size_t len = _clients[i-1].socket->read_some(asio::buffer(buff), ec);
+                if (ec or not this->handle_data(_clients[i-1], buff, len)){
+                    _clients.erase(_clients.begin() + (i-1));
+                }
+            }
+
+            if (ready[0]){
+                client_type client;
+                client.socket.reset(new local_socket_type(_io_service));
+                boost::system::error_code ec;
+                _acceptor.accept(*client.socket, ec);
+                if (not ec) client.socket->non_blocking(true, ec); //bounded replies, see handle_data
+                if (not ec) _clients.push_back(client);
+            }
+        }
+    }
+
+    /*!
+     * Answer the complete lines, false to drop the client.
+     * A client that does not read its replies within the send timeout
+     * is dropped, so that it cannot stall the other clients.
+     */
+    bool handle_data(client_type &client, const char *buff, const size_t len){
+        client.line.append(buff, len);
+        size_t pos;
+        while ((pos = client.line.find('\n')) != std::string::npos){
+            const std::string reply = this->handle_request(client.line.substr(0, pos)) + "\n";
+            client.line.erase(0, pos + 1);
+            _num_requests.inc();
+            if (not write_with_timeout(*client.socket, reply, send_timeout)){
+                UHD_LOG << "property server: dropped a client that does not read its replies" << std::endl;
+                return false;
+            }
+        }
+        return client.line.size() < max_line_len;
+    }
+
+    std::string handle_request(const std::string &request){
+        const size_t op_end = request.find(' ');
+        const std::string op = request.substr(0, op_end);
+        const std::string args = (op_end == std::string::npos)? "" : request.substr(op_end + 1);
+        const size_t path_end = args.find(' ');
+        const fs_path path = args.substr(0, path_end);
+        const std::string value = (path_end == std::string::npos)? "" : unescape_line(args.substr(path_end + 1));
+        try{
+            if (op == "list"){
+                std::string names;
+                BOOST_FOREACH(const std::string &name, _tree->list(path)){
+                    names += ((names.empty())? "" : " ") + name;
+                }
+                return "ok " + escape_line(names);
+            }
+            if (op == "type") return "ok " + get_type_name(_tree->type_of(path));
+            if (op == "get") return "ok " + escape_line(get_value(_tree, path));
+            if (op == "set"){
+                set_value(_tree, path, value);
+                return "ok " + escape_line(get_value(_tree, path));
+            }
+            throw uhd::value_error("property server: unknown request " + op);
+        }
+        catch(const std::exception &e){
+            return "error " + escape_line(e.what());
+        }
+    }
+
+    property_tree::sptr _tree;
+    const std::string _socket_path;
+    asio::io_service _io_service;
+    asio::local::stream_protocol::acceptor _acceptor;
+    std::vector<client_type> _clients;
+    mutable atomic_uint32_t _num_requests;
+    boost::thread _thread;
+};
+
+property_server::sptr property_server::make(property_tree::sptr tree, const std::string &socket_path){
+    return sptr(new property_server_impl(tree, socket_path));
+}
+
+/***********************************************************************
+ * Property client:
+ * Writes a request line and waits for the reply line.
+ **********************************************************************/
+class property_client_impl : public property_client{
+public:
+    property_client_impl(const std::string &socket_path, const double timeout):
+        _socket(_io_service), _timeout(timeout)
+    {
+        boost::system::error_code ec;
+        _socket.connect(asio::local::stream_protocol::endpoint(socket_path), ec);
+        if (ec) throw uhd::io_error("property client: cannot connect to " + socket_path + ": " + ec.message());
+    }
+
+    std::vector<std::string> list(const fs_path &path){
+        std::vector<std::string> names;
+        const std::string reply = this->request("list " + path);
+        size_t pos = 0;
+        while (pos < reply.size()){
+            const size_t end = std::min(reply.find(' ', pos), reply.size());
+            names.push_back(reply.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        return names;
+    }
+
+    std::string get_type(const fs_path &path){
+        return this->request("type " + path);
+    }
+
+    std::string get(const fs_path &path){
+        return this->request("get " + path);
+    }
+
+    std::string set(const fs_path &path, const std::string &value){
+        return this->request("set " + path + " " + escape_line(value));
+    }
+
+private:
+    std::string request(const std::string &line){
+        boost::mutex::scoped_lock lock(_mutex);
+        const std::string request = line + "\n";
+        boost::system::error_code ec;
+        asio::write(_socket, asio::buffer(request), ec);
+        if (ec) throw uhd::io_error("property client: send failed: " + ec.message());
+
+        //the reply line, a server answers the requests in order
+        size_t pos;
+        char buff[4096];
+        while ((pos = _line.find('\n')) == std::string::npos){
+            if (not wait_for_recv_ready(_socket.native(), _timeout)){
+                throw uhd::io_error("property client: no reply to " + line);
+            }
+            const size_t len = _socket.read_some(asio::buffer(buff), ec);
+            if (ec) throw uhd::io_error("property client: receive failed: " + ec.message());
+            _line.append(buff, len);
+        }
+        const std::string reply = _line.substr(0, pos);
+        _line.erase(0, pos + 1);
+
+        if (reply.compare(0, 3, "ok ") == 0) return unescape_line(reply.substr(3));
+        if (reply.compare(0, 6, "error ") == 0) throw uhd::runtime_error(unescape_line(reply.substr(6)));
+        throw uhd::io_error("property client: bad reply " + reply);
+    }
+
+    boost::mutex _mutex;
+    asio::io_service _io_service;
+    local_socket_type _socket;
+    const double _timeout;
+    std::string _line; //the received bytes after the last reply
+};
+
+property_client::sptr property_client::make(const std::string &socket_path, const double timeout){
+    return sptr(new property_client_impl(socket_path, timeout));
+}
+
+#else /*BOOST_ASIO_HAS_LOCAL_SOCKETS*/
+
+property_server::sptr property_server::make(property_tree::sptr, const std::string &){
+    throw uhd::not_implemented_error("property server: no local sockets on this platform");
+}
+
+property_client::sptr property_client::make(const std::string &, const double){
+    throw uhd::not_implemented_error("property client: no local sockets on this platform");
+}
+
+#endif /*BOOST_ASIO_HAS_LOCAL_SOCKETS*/
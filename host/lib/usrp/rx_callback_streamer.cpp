@@ -0,0 +1,164 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/usrp/rx_callback_streamer.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/exception.hpp>
+#include <boost/bind.hpp>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+static const double STREAM_TIMEOUT = 0.1; //seconds, bounds the time to stop the thread
+
+/***********************************************************************
+ * Converted samples:
+ * The streaming thread receives into buffers owned by the streamer
+ * and calls back with the same buffers each time.
+ **********************************************************************/
+class rx_callback_streamer_impl : public rx_callback_streamer{
+public:
+    rx_callback_streamer_impl(
+        device::sptr dev,
+        const io_type_t &io_type,
+        const size_t num_chans,
+        const size_t nsamps_per_buff,
+        const recv_callback_type &callback,
+        const std::vector<size_t> &cpus,
+        const thread_sched_t &sched
+    ):
+        _dev(dev), _io_type(io_type), _callback(callback),
+        _nsamps_per_buff((nsamps_per_buff == 0)? dev->get_max_recv_samps_per_packet() : nsamps_per_buff),
+        _recv_mode((nsamps_per_buff == 0)? device::RECV_MODE_ONE_PACKET : device::RECV_MODE_FULL_BUFF)
+    {
+        if (num_chans == 0) throw uhd::value_error("rx callback streamer needs at least one channel");
+        _mem.resize(num_chans, std::vector<char>(_nsamps_per_buff*io_type.size));
+        for (size_t i = 0; i < num_chans; i++){
+            _buffs.push_back(&_mem[i].front());
+            _const_buffs.push_back(&_mem[i].front());
+        }
+        _task = task::make(boost::bind(&rx_callback_streamer_impl::stream_loop, this), cpus, sched);
+        _task->set_name("rx callback streamer");
+    }
+
+    ~rx_callback_streamer_impl(void){
+        _task.reset(); //stop the thread before the buffers go away
+    }
+
+    size_t get_num_callbacks(void) const{
+        return _num_callbacks.read();
+    }
+
+    thread_sched_t get_sched(void) const{
+        return _task->get_sched();
+    }
+
+private:
+    void stream_loop(void){
+        rx_metadata_t metadata;
+        const size_t nsamps = _dev->recv(
+            _buffs, _nsamps_per_buff, metadata, _io_type, _recv_mode, STREAM_TIMEOUT
+        );
+        if (nsamps == 0 and metadata.error_code == rx_metadata_t::ERROR_CODE_TIMEOUT) return;
+        _callback(_const_buffs, nsamps, metadata);
+        _num_callbacks.inc();
+    }
+
+    device::sptr _dev;
+    const io_type_t _io_type;
+    const recv_callback_type _callback;
+    const size_t _nsamps_per_buff;
+    const device::recv_mode_t _recv_mode;
+    std::vector<std::vector<char> > _mem;
+    std::vector<void *> _buffs;
+    std::vector<const void *> _const_buffs;
+    mutable atomic_uint32_t _num_callbacks;
+    task::sptr _task;
+};
+
+/***********************************************************************
+ * Raw transport frames:
+ * The streaming thread receives a view and releases it
+ * once the callback returns, so the frames go back to the transport.
+ **********************************************************************/
+class rx_callback_streamer_raw : public rx_callback_streamer{
+public:
+    rx_callback_streamer_raw(
+        device::sptr dev,
+        const view_callback_type &callback,
+        const std::vector<size_t> &cpus,
+        const thread_sched_t &sched
+    ):
+        _dev(dev), _callback(callback)
+    {
+        _task = task::make(boost::bind(&rx_callback_streamer_raw::stream_loop, this), cpus, sched);
+        _task->set_name("rx callback streamer");
+    }
+
+    ~rx_callback_streamer_raw(void){
+        _task.reset(); //stop the thread before the view goes away
+    }
+
+    size_t get_num_callbacks(void) const{
+        return _num_callbacks.read();
+    }
+
+    thread_sched_t get_sched(void) const{
+        return _task->get_sched();
+    }
+
+private:
+    void stream_loop(void){
+        const size_t nsamps = _dev->recv_view(_view, STREAM_TIMEOUT);
+        if (nsamps == 0 and _view.metadata.error_code == rx_metadata_t::ERROR_CODE_TIMEOUT) return;
+        _callback(_view);
+        _view.release();
+        _num_callbacks.inc();
+    }
+
+    device::sptr _dev;
+    const view_callback_type _callback;
+    device::recv_view_t _view;
+    mutable atomic_uint32_t _num_callbacks;
+    task::sptr _task;
+};
+
+/***********************************************************************
+ * The make functions
+ **********************************************************************/
+rx_callback_streamer::sptr rx_callback_streamer::make(
+    device::sptr dev,
+    const io_type_t &io_type,
+    size_t num_chans,
+    size_t nsamps_per_buff,
+    const recv_callback_type &callback,
+    const std::vector<size_t> &cpus,
+    const thread_sched_t &sched
+){
+    return sptr(new rx_callback_streamer_impl(dev, io_type, num_chans, nsamps_per_buff, callback, cpus, sched));
+}
+
+rx_callback_streamer::sptr rx_callback_streamer::make_raw(
+    device::sptr dev,
+    const view_callback_type &callback,
+    const std::vector<size_t> &cpus,
+    const thread_sched_t &sched
+){
+    return sptr(new rx_callback_streamer_raw(dev, callback, cpus, sched));
+}
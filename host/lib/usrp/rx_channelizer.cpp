@@ -0,0 +1,381 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/usrp/rx_channelizer.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/types/io_type.hpp>
+#include <uhd/types/otw_type.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+typedef std::complex<float> fc32_t;
+
+/***********************************************************************
+ * Prototype filter design helpers
+ **********************************************************************/
+static const double pi = std::acos(-1.0);
+
+//! modified bessel function of the first kind, order zero
+static double bessel_i0(const double x){
+    double sum = 1.0, term = 1.0;
+    for (size_t k = 1; k < 50; k++){
+        term *= (x/(2*k))*(x/(2*k));
+        sum += term;
+        if (term < sum*1e-12) break;
+    }
+    return sum;
+}
+
+/*!
+ * Design the lowpass prototype with a cutoff at half the channel spacing.
+ * The taps are a kaiser windowed sinc normalized for unity gain at DC.
+ */
+static std::vector<double> design_prototype(const size_t num_chans, const size_t num_taps){
+    static const double beta = 7.0;
+    std::vector<double> taps(num_taps);
+    const double center = (num_taps - 1)/2.0;
+    double sum = 0;
+    for (size_t i = 0; i < num_taps; i++){
+        const double x = (i - center)/num_chans;
+        const double sinc = (x == 0)? 1.0 : std::sin(pi*x)/(pi*x);
+        const double r = (num_taps > 1)? (i - center)/center : 0.0;
+        const double window = bessel_i0(beta*std::sqrt(std::max(0.0, 1 - r*r)))/bessel_i0(beta);
+        taps[i] = sinc*window;
+        sum += taps[i];
+    }
+    for (size_t i = 0; i < num_taps; i++) taps[i] /= sum;
+    return taps;
+}
+
+/***********************************************************************
+ * RX channelizer implementation
+ *
+ * Output n of the filterbank is computed over the input window
+ * [n*M, n*M + K*M) with M channels and K taps per channel:
+ *   v_p = sum_k h[p + k*M] * x[n*M + K*M-1 - p - k*M]
+ *   y_c = r_c * sum_p v_p * exp(j*2*pi*c*p/M)
+ * The second sum is an inverse FFT over the branches,
+ * and r_c rotates the channel mixer back to the window's newest sample.
+ **********************************************************************/
+class rx_channelizer_impl : public rx_channelizer{
+public:
+    rx_channelizer_impl(
+        device::sptr dev,
+        const double samp_rate,
+        const size_t num_chans,
+        const size_t taps_per_chan,
+        const size_t num_threads,
+        const double scale_factor
+    ):
+        _dev(dev),
+        _samp_rate(samp_rate),
+        _num_chans(num_chans),
+        _taps_per_chan(taps_per_chan),
+        _window_len(num_chans*taps_per_chan),
+        _scale_factor(scale_factor),
+        _num_threads(num_threads),
+        _generation(0), _num_pending(0), _running(true),
+        _outputs(NULL), _nsamps(0)
+    {
+        if (num_chans < 2 or (num_chans & (num_chans - 1)) != 0) throw uhd::value_error(str(
+            boost::format("rx channelizer: the number of channels must be a power of two, got %u") % num_chans
+        ));
+        if (taps_per_chan == 0) throw uhd::value_error("rx channelizer: the taps per channel must be positive");
+        if (samp_rate <= 0) throw uhd::value_error("rx channelizer: the sample rate must be positive");
+
+        //branch p holds the taps p, p+M, p+2M, ... of the prototype
+        const std::vector<double> proto = design_prototype(_num_chans, _window_len);
+        _taps.resize(_window_len);
+        for (size_t p = 0; p < _num_chans; p++){
+            for (size_t k = 0; k < _taps_per_chan; k++){
+                _taps[p*_taps_per_chan + k] = float(proto[p + k*_num_chans]);
+            }
+        }
+
+        //the fft twiddles and the bit reversed branch order
+        size_t num_bits = 0;
+        while ((size_t(1) << num_bits) < _num_chans) num_bits++;
+        _bitrev.resize(_num_chans);
+        for (size_t i = 0; i < _num_chans; i++){
+            size_t r = 0;
+            for (size_t b = 0; b < num_bits; b++) if (i & (size_t(1) << b)) r |= size_t(1) << (num_bits - 1 - b);
+            _bitrev[i] = r;
+        }
+        _twiddles.resize(_num_chans/2);
+        for (size_t i = 0; i < _num_chans/2; i++){
+            _twiddles[i] = std::polar(1.0f, float(2*pi*i/_num_chans));
+        }
+
+        //the mixer of channel c advanced by K*M-1 samples is exp(j*2*pi*c/M)
+        _rotations.resize(_num_chans);
+        for (size_t c = 0; c < _num_chans; c++){
+            _rotations[c] = std::polar(1.0f, float(2*pi*c/_num_chans));
+        }
+
+        _scratch.resize(_num_threads + 1, std::vector<fc32_t>(_num_chans));
+        for (size_t i = 0; i < _num_threads; i++){
+            _threads.create_thread(boost::bind(&rx_channelizer_impl::worker, this, i+1));
+        }
+        this->reset();
+    }
+
+    ~rx_channelizer_impl(void){
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _running = false;
+        }
+        _work_cond.notify_all();
+        _threads.join_all();
+    }
+
+    size_t get_num_chans(void) const{
+        return _num_chans;
+    }
+
+    double get_chan_rate(void) const{
+        return _samp_rate/_num_chans;
+    }
+
+    double get_chan_freq(const size_t chan) const{
+        if (chan >= _num_chans) throw uhd::index_error(str(
+            boost::format("rx channelizer: channel %u out of range for %u channels") % chan % _num_chans
+        ));
+        const double offset = chan*_samp_rate/_num_chans;
+        return (chan > _num_chans/2)? offset - _samp_rate : offset;
+    }
+
+    void reset(void){
+        _buff.clear();
+        _read = 0;
+        _time_fresh = true;
+        _time_valid = false;
+        _num_consumed = 0;
+        _view.release();
+    }
+
+    size_t recv(
+        const device::recv_buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &metadata,
+        const double timeout
+    ){
+        if (buffs.size() != _num_chans) throw uhd::value_error(str(
+            boost::format("rx channelizer: expected %u buffers, got %u") % _num_chans % buffs.size()
+        ));
+        metadata = rx_metadata_t();
+        if (nsamps_per_buff == 0) return 0;
+
+        //drop the consumed input, the tail is the next window's history
+        if (_read != 0){
+            _buff.erase(_buff.begin(), _buff.begin() + _read);
+            _read = 0;
+        }
+
+        //receive until the input covers every output window
+        const size_t needed = (nsamps_per_buff - 1)*_num_chans + _window_len;
+        while (_buff.size() < needed){
+            const size_t nsamps = _dev->recv_view(_view, timeout);
+            if (nsamps == 0){
+                metadata = _view.metadata;
+                if (metadata.error_code == rx_metadata_t::ERROR_CODE_NONE) continue;
+                //a timeout keeps the input, any other error breaks the stream
+                if (metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) this->reset();
+                return 0;
+            }
+            if (_time_fresh){
+                _time_fresh = false;
+                _time_valid = _view.metadata.has_time_spec;
+                _time = _view.metadata.time_spec;
+            }
+            this->load_view(nsamps);
+            _view.release();
+        }
+
+        //compute the output blocks, split across the workers
+        _outputs = &buffs;
+        _nsamps = nsamps_per_buff;
+        if (_num_threads == 0) this->run_share(0);
+        else{
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                _num_pending = _num_threads;
+                _generation++;
+            }
+            _work_cond.notify_all();
+
+            this->run_share(0);
+
+            boost::mutex::scoped_lock lock(_mutex);
+            while (_num_pending != 0) _done_cond.wait(lock);
+        }
+
+        //the output is centered on the middle of its window
+        metadata.has_time_spec = _time_valid;
+        metadata.time_spec = _time + time_spec_t(
+            (_num_consumed + (_window_len - 1)/2.0)/_samp_rate
+        );
+        _read = nsamps_per_buff*_num_chans;
+        _num_consumed += _read;
+        return nsamps_per_buff;
+    }
+
+private:
+    device::sptr _dev;
+    const double _samp_rate;
+    const size_t _num_chans, _taps_per_chan, _window_len;
+    const double _scale_factor;
+
+    //prototype taps by branch, fft tables, and channel rotations
+    std::vector<float> _taps;
+    std::vector<size_t> _bitrev;
+    std::vector<fc32_t> _twiddles, _rotations;
+
+    //the converted input, with the history before the read position
+    std::vector<fc32_t> _buff;
+    size_t _read;
+    device::recv_view_t _view;
+    convert::plan_t _converter;
+    otw_type_t _otw_type;
+
+    //the time of the first input sample since the reset
+    bool _time_fresh, _time_valid;
+    time_spec_t _time;
+    boost::uint64_t _num_consumed;
+
+    //the worker pool runs the output blocks of one recv
+    const size_t _num_threads;
+    boost::thread_group _threads;
+    boost::mutex _mutex;
+    boost::condition_variable _work_cond, _done_cond;
+    size_t _generation, _num_pending;
+    bool _running;
+    std::vector<std::vector<fc32_t> > _scratch;
+    const device::recv_buffs_type *_outputs;
+    size_t _nsamps;
+
+    void load_view(const size_t nsamps){
+        const otw_type_t &otw_type = _view.otw_type;
+        if (_converter.empty() or
+            otw_type.width != _otw_type.width or
+            otw_type.shift != _otw_type.shift or
+            otw_type.byteorder != _otw_type.byteorder
+        ){
+            _converter = convert::plan_t(convert::get_converter_otw_to_cpu(
+                io_type_t::COMPLEX_FLOAT32, otw_type, 1, 1
+            ), 1, 1, _scale_factor);
+            _otw_type = otw_type;
+        }
+
+        const size_t offset = _buff.size();
+        _buff.resize(offset + nsamps);
+        const void *input = _view.payloads.front();
+        void *output = &_buff[offset];
+        _converter(&input, &output, nsamps);
+    }
+
+    void run_share(const size_t index){
+        const size_t num_tasks = _num_threads + 1;
+        const size_t per_task = (_nsamps + num_tasks - 1)/num_tasks;
+        const size_t first = std::min(_nsamps, index*per_task);
+        const size_t last = std::min(_nsamps, first + per_task);
+        std::vector<fc32_t> &scratch = _scratch[index];
+        for (size_t n = first; n < last; n++){
+            this->filter(n, scratch);
+            this->fft(scratch);
+            for (size_t c = 0; c < _num_chans; c++){
+                reinterpret_cast<fc32_t *>((*_outputs)[c])[n] = scratch[c]*_rotations[c];
+            }
+        }
+    }
+
+    //! Run the branch filters of output n into bit reversed order
+    UHD_INLINE void filter(const size_t n, std::vector<fc32_t> &out){
+        const fc32_t *newest = &_buff[_read + n*_num_chans + _window_len - 1];
+        for (size_t p = 0; p < _num_chans; p++){
+            const float *taps = &_taps[p*_taps_per_chan];
+            const fc32_t *x = newest - p;
+            float re = 0, im = 0;
+            for (size_t k = 0; k < _taps_per_chan; k++){
+                const fc32_t &s = x[-std::ptrdiff_t(k*_num_chans)];
+                re += taps[k]*s.real();
+                im += taps[k]*s.imag();
+            }
+            out[_bitrev[p]] = fc32_t(re, im);
+        }
+    }
+
+    //! In place radix-2 inverse FFT (no scaling) of bit reversed input
+    UHD_INLINE void fft(std::vector<fc32_t> &a){
+        for (size_t len = 2; len <= _num_chans; len <<= 1){
+            const size_t half = len/2, step = _num_chans/len;
+            for (size_t i = 0; i < _num_chans; i += len){
+                for (size_t j = 0; j < half; j++){
+                    const fc32_t u = a[i + j];
+                    const fc32_t v = a[i + j + half]*_twiddles[j*step];
+                    a[i + j] = u + v;
+                    a[i + j + half] = u - v;
+                }
+            }
+        }
+    }
+
+    void worker(const size_t index){
+        uhd::set_thread_priority_safe();
+        size_t generation = 0;
+        while (true){
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                while (_running and _generation == generation) _work_cond.wait(lock);
+                if (not _running) return;
+                generation = _generation;
+            }
+            this->run_share(index);
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                if (--_num_pending == 0) _done_cond.notify_one();
+            }
+        }
+    }
+};
+
+/***********************************************************************
+ * The make function
+ **********************************************************************/
+rx_channelizer::sptr rx_channelizer::make(
+    device::sptr dev,
+    double samp_rate,
+    size_t num_chans,
+    size_t taps_per_chan,
+    size_t num_threads,
+    double scale_factor
+){
+    return sptr(new rx_channelizer_impl(
+        dev, samp_rate, num_chans, taps_per_chan, num_threads, scale_factor
+    ));
+}
@@ -0,0 +1,110 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "sim_impl.hpp"
+#include <uhd/usrp/dboard_iface.hpp>
+#include <uhd/types/dict.hpp>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+/***********************************************************************
+ * The simulated dboard interface:
+ * There is no dboard hardware behind the simulated frontends,
+ * so the gpio loops back to itself and the buses read back zeros.
+ **********************************************************************/
+class sim_dboard_iface : public dboard_iface{
+public:
+    sim_dboard_iface(const boost::function<double(void)> &get_tick_rate):
+        _get_tick_rate(get_tick_rate)
+    {
+        _gpio_out[UNIT_RX] = _gpio_out[UNIT_TX] = 0;
+    }
+
+    special_props_t get_special_props(void){
+        special_props_t props;
+        props.soft_clock_divider = false;
+        props.mangle_i2c_addrs = false;
+        return props;
+    }
+
+    void write_aux_dac(unit_t, aux_dac_t, double){
+        /* NOP */
+    }
+
+    double read_aux_adc(unit_t, aux_adc_t){
+        return 0.0;
+    }
+
+    void _set_pin_ctrl(unit_t, boost::uint16_t){}
+    void _set_atr_reg(unit_t, atr_reg_t, boost::uint16_t){}
+    void _set_gpio_ddr(unit_t, boost::uint16_t){}
+    void _set_gpio_out(unit_t unit, boost::uint16_t value){
+        _gpio_out[unit] = value;
+    }
+    void set_gpio_debug(unit_t, int){}
+    boost::uint16_t read_gpio(unit_t unit){
+        return _gpio_out[unit];
+    }
+
+    void write_i2c(boost::uint8_t, const byte_vector_t &){
+        /* NOP */
+    }
+
+    byte_vector_t read_i2c(boost::uint8_t, size_t num_bytes){
+        return byte_vector_t(num_bytes, 0);
+    }
+
+    void write_spi(unit_t, const spi_config_t &, boost::uint32_t, size_t){
+        /* NOP */
+    }
+
+    boost::uint32_t read_write_spi(unit_t, const spi_config_t &, boost::uint32_t, size_t){
+        return 0;
+    }
+
+    void set_clock_rate(unit_t, double){
+        /* NOP: the dboard clock is the tick rate */
+    }
+
+    std::vector<double> get_clock_rates(unit_t){
+        return std::vector<double>(1, _get_tick_rate());
+    }
+
+    double get_clock_rate(unit_t){
+        return _get_tick_rate();
+    }
+
+    void set_clock_enabled(unit_t, bool){
+        /* NOP */
+    }
+
+    double get_codec_rate(unit_t){
+        return _get_tick_rate();
+    }
+
+private:
+    const boost::function<double(void)> _get_tick_rate;
+    uhd::dict<unit_t, boost::uint16_t> _gpio_out;
+};
+
+/***********************************************************************
+ * Make Function
+ **********************************************************************/
+dboard_iface::sptr make_sim_dboard_iface(const boost::function<double(void)> &get_tick_rate){
+    return dboard_iface::sptr(new sim_dboard_iface(get_tick_rate));
+}
@@ -0,0 +1,440 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "validate_subdev_spec.hpp"
+#include "late_send_policy.hpp"
+#include "../../transport/super_recv_packet_handler.hpp"
+#include "../../transport/super_send_packet_handler.hpp"
+#include "../../transport/async_msg_ring.hpp"
+#include "sim_impl.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/weak_ptr.hpp>
+
+using namespace uhd;
+using namespace uhd::usrp;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * io impl details (internal to this file)
+ * - async message fifo
+ * - vrt packet handler states
+ **********************************************************************/
+struct sim_impl::io_impl{
+    io_impl(const size_t async_msg_depth):
+        async_msg_fifo(async_msg_depth)
+    { /* NOP */ }
+
+    //streaming error events per dsp
+    std::vector<stream_event_counters::sptr> rx_counters;
+    stream_event_counters::sptr tx_counters;
+
+    //state management for the vrt packet handler code
+    sph::recv_packet_handler recv_handler;
+    sph::send_packet_handler send_handler;
+
+    //the handler settings of the device address, for the streams too
+    device_addr_t handler_args;
+
+    //the latest stream of each dsp and its channel, it follows the rate changes
+    std::vector<boost::weak_ptr<sph::recv_packet_streamer> > rx_streamers;
+    std::vector<size_t> rx_streamer_chans;
+    boost::weak_ptr<sph::send_packet_streamer> tx_streamer;
+
+    void handle_async_message(const async_metadata_t &metadata);
+    async_msg_ring async_msg_fifo;
+};
+
+void sim_impl::io_impl::handle_async_message(const async_metadata_t &metadata){
+    //push the message onto the queue
+    async_msg_fifo.push_with_pop_on_full(metadata);
+
+    //count the error events
+    if (metadata.event_code &
+        ( async_metadata_t::EVENT_CODE_UNDERFLOW
+        | async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET)
+    ) tx_counters->record(stream_event_counters::EVENT_UNDERFLOW);
+    else if (metadata.event_code &
+        ( async_metadata_t::EVENT_CODE_SEQ_ERROR
+        | async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST)
+    ) tx_counters->record(stream_event_counters::EVENT_SEQ_ERROR);
+    else if (metadata.event_code & async_metadata_t::EVENT_CODE_TIME_ERROR)
+        tx_counters->record(stream_event_counters::EVENT_LATE_COMMAND);
+}
+
+/***********************************************************************
+ * Helper Functions
+ **********************************************************************/
+//! Setup a receive handler from the device address settings
+static void init_recv_handler(
+    sph::recv_packet_handler &handler, const otw_type_t &otw_type, const device_addr_t &device_addr
+){
+    handler.set_vrt_unpacker(&vrt::if_hdr_unpack_be_sid_tsi_tsf_tlr);
+    handler.set_converter(otw_type);
+    handler.set_convert_threads(
+        boost::lexical_cast<size_t>(device_addr.get("recv_convert_threads", "0"))
+    );
+    handler.set_lookahead(device_addr.cast<int>("recv_lookahead", 0) != 0);
+
+    //one thread each for recv and send: skip the per-call mutex
+    handler.set_single_owner(device_addr.cast<int>("single_owner", 0) != 0);
+}
+
+//! Setup a send handler from the device address settings
+static void init_send_handler(
+    sph::send_packet_handler &handler, const otw_type_t &otw_type, const device_addr_t &device_addr,
+    property_tree::sptr tree, const size_t max_samps_per_packet
+){
+    handler.set_vrt_packer(&vrt::if_hdr_pack_be);
+    handler.set_converter(otw_type);
+    handler.set_scale_factor(32767.);
+    handler.set_max_samples_per_packet(max_samps_per_packet);
+    setup_late_send_policy(handler, tree, "/mboards/0", device_addr);
+    handler.set_single_owner(device_addr.cast<int>("single_owner", 0) != 0);
+}
+
+//! Bind a receive transport channel to a dsp's transport
+static void bind_recv_chan(
+    sph::recv_packet_handler &handler, const size_t chan,
+    zero_copy_if::sptr xport, stream_event_counters::sptr counters
+){
+    handler.set_xport_chan_get_buff(chan, boost::bind(&zero_copy_if::get_recv_buff, xport, _1));
+    //the simulated dsp resumes a continuous stream on its own
+    handler.set_overflow_handler(chan, &sph::handle_overflow_nop);
+    handler.set_event_counters(chan, counters);
+}
+
+//! Bind a send transport channel to the tx transport
+static void bind_send_chan(
+    sph::send_packet_handler &handler, const size_t chan,
+    zero_copy_if::sptr xport, stream_event_counters::sptr counters
+){
+    handler.set_xport_chan_flush(chan, boost::bind(&zero_copy_if::flush_send_buffs, xport));
+    handler.set_xport_chan_get_buff(chan, boost::bind(&zero_copy_if::get_send_buff, xport, _1));
+    handler.set_event_counters(chan, counters);
+}
+
+void sim_impl::io_init(const device_addr_t &device_addr){
+
+    //setup rx otw type
+    _rx_otw_type.width = 16;
+    _rx_otw_type.shift = 0;
+    _rx_otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    //setup tx otw type
+    _tx_otw_type.width = 16;
+    _tx_otw_type.shift = 0;
+    _tx_otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    //create new io impl, the async messages overwrite the oldest past the depth
+    _io_impl = UHD_PIMPL_MAKE(io_impl, (device_addr.cast<size_t>("async_msg_depth", 100)));
+    async_msg_ring::publish(_tree, "/mboards/0", _io_impl->async_msg_fifo);
+
+    //create and publish the streaming event counters
+    const bool fastpath_chars = device_addr.cast<bool>("fastpath_chars", true);
+    for (size_t dspno = 0; dspno < _rx_xports.size(); dspno++){
+        _io_impl->rx_counters.push_back(stream_event_counters::make(fastpath_chars));
+        stream_event_counters::publish(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _io_impl->rx_counters.back());
+        publish_xport_stats(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _rx_xports[dspno], true);
+    }
+    _io_impl->tx_counters = stream_event_counters::make(fastpath_chars);
+    stream_event_counters::publish(_tree, "/mboards/0/tx_dsps/0", _io_impl->tx_counters);
+    _io_impl->rx_streamers.resize(_rx_xports.size());
+    _io_impl->rx_streamer_chans.resize(_rx_xports.size());
+
+    //the host resamplers, one setting per handler shared by the dsps
+    for (size_t dspno = 0; dspno < _rx_xports.size(); dspno++){
+        publish_resampler(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _io_impl->recv_handler);
+    }
+    publish_resampler(_tree, "/mboards/0/tx_dsps/0", _io_impl->send_handler);
+
+    //the tx transport posts its async messages straight to the fifo
+    _tx_xport = sim_send_sink::make(_clock, boost::bind(
+        &sim_impl::io_impl::handle_async_message, _io_impl.get(), _1
+    ), device_addr);
+    publish_xport_stats(_tree, "/mboards/0/tx_dsps/0", _tx_xport, false);
+
+    //init some handler stuff
+    _io_impl->handler_args = device_addr;
+    init_recv_handler(_io_impl->recv_handler, _rx_otw_type, device_addr);
+    init_send_handler(_io_impl->send_handler, _tx_otw_type, device_addr, _tree, get_max_send_samps_per_packet());
+}
+
+void sim_impl::update_tick_rate(const double rate){
+    {
+        boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
+        _io_impl->recv_handler.set_tick_rate(rate);
+        boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
+        _io_impl->send_handler.set_tick_rate(rate);
+    }
+    BOOST_FOREACH(const boost::weak_ptr<sph::recv_packet_streamer> &weak, _io_impl->rx_streamers){
+        boost::shared_ptr<sph::recv_packet_streamer> my_streamer = weak.lock();
+        if (not my_streamer) continue;
+        boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+        my_streamer->set_tick_rate(rate);
+    }
+    boost::shared_ptr<sph::send_packet_streamer> my_tx_streamer = _io_impl->tx_streamer.lock();
+    if (my_tx_streamer){
+        boost::mutex::scoped_lock lock = my_tx_streamer->get_scoped_lock();
+        my_tx_streamer->set_tick_rate(rate);
+    }
+
+    //re-coerce the host rates to the divisors of the new tick rate
+    const fs_path mb_path = "/mboards/0";
+    BOOST_FOREACH(const std::string &name, _tree->list(mb_path / "rx_dsps")){
+        property<double> &prop = _tree->access<double>(mb_path / "rx_dsps" / name / "rate" / "value");
+        if (not prop.empty()) prop.set(prop.get());
+    }
+    BOOST_FOREACH(const std::string &name, _tree->list(mb_path / "tx_dsps")){
+        property<double> &prop = _tree->access<double>(mb_path / "tx_dsps" / name / "rate" / "value");
+        if (not prop.empty()) prop.set(prop.get());
+    }
+}
+
+void sim_impl::update_rx_samp_rate(const size_t dspno, const double rate){
+    {
+        boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
+        _io_impl->recv_handler.set_samp_rate(rate);
+        _io_impl->recv_handler.set_scale_factor(1/32767.);
+    }
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer = _io_impl->rx_streamers[dspno].lock();
+    if (not my_streamer) return;
+    boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+    my_streamer->set_samp_rate(rate);
+}
+
+void sim_impl::drop_rx_lookahead(const size_t dspno){
+    if (_io_impl->handler_args.cast<int>("recv_lookahead", 0) == 0) return; //nothing is held
+    if (dspno < _io_impl->recv_handler.size()){
+        boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
+        _io_impl->recv_handler.drop_lookahead(dspno);
+    }
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer = _io_impl->rx_streamers[dspno].lock();
+    if (not my_streamer) return;
+    boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+    my_streamer->drop_lookahead(_io_impl->rx_streamer_chans[dspno]);
+}
+
+void sim_impl::update_tx_samp_rate(const double rate){
+    {
+        boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
+        _io_impl->send_handler.set_samp_rate(rate);
+    }
+    boost::shared_ptr<sph::send_packet_streamer> my_streamer = _io_impl->tx_streamer.lock();
+    if (not my_streamer) return;
+    boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+    my_streamer->set_samp_rate(rate);
+}
+
+void sim_impl::update_rx_subdev_spec(const uhd::usrp::subdev_spec_t &spec){
+    boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
+
+    //sanity checking
+    validate_subdev_spec(_tree, spec, "rx");
+
+    //resize for the new occupancy
+    _io_impl->recv_handler.resize(spec.size());
+
+    //bind new callbacks for the handler
+    for (size_t i = 0; i < _io_impl->recv_handler.size(); i++){
+        _rx_xports[i]->set_nsamps_per_packet(get_max_recv_samps_per_packet()); //seems to be a good place to set this
+        bind_recv_chan(_io_impl->recv_handler, i, _rx_xports[i], _io_impl->rx_counters[i]);
+    }
+}
+
+void sim_impl::update_tx_subdev_spec(const uhd::usrp::subdev_spec_t &spec){
+    boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
+
+    //sanity checking
+    validate_subdev_spec(_tree, spec, "tx");
+
+    //resize for the new occupancy
+    _io_impl->send_handler.resize(spec.size());
+
+    //bind new callbacks for the handler
+    for (size_t i = 0; i < _io_impl->send_handler.size(); i++){
+        bind_send_chan(_io_impl->send_handler, i, _tx_xport, _io_impl->tx_counters);
+    }
+}
+
+/***********************************************************************
+ * Data Send
+ **********************************************************************/
+size_t sim_impl::get_max_send_samps_per_packet(void) const{
+    static const size_t hdr_size = 0
+        + vrt::max_if_hdr_words32*sizeof(boost::uint32_t)
+        - sizeof(vrt::if_packet_info_t().cid) //no class id ever used
+    ;
+    size_t bpp = _tx_xport->get_send_frame_size() - hdr_size;
+    return bpp/_tx_otw_type.get_sample_size();
+}
+
+size_t sim_impl::send(
+    const send_buffs_type &buffs, size_t nsamps_per_buff,
+    const tx_metadata_t &metadata, const io_type_t &io_type,
+    send_mode_t send_mode, double timeout
+){
+    return _io_impl->send_handler.send(
+        buffs, nsamps_per_buff,
+        metadata, io_type,
+        send_mode, timeout
+    );
+}
+
+size_t sim_impl::get_send_view(send_view_t &view, double timeout){
+    return _io_impl->send_handler.get_send_view(view, timeout);
+}
+
+size_t sim_impl::commit_send_view(send_view_t &view, size_t nsamps, double){
+    return _io_impl->send_handler.commit_send_view(view, nsamps);
+}
+
+/***********************************************************************
+ * Data Recv
+ **********************************************************************/
+size_t sim_impl::get_max_recv_samps_per_packet(void) const{
+    static const size_t hdr_size = 0
+        + vrt::max_if_hdr_words32*sizeof(boost::uint32_t)
+        + sizeof(vrt::if_packet_info_t().tlr) //forced to have trailer
+        - sizeof(vrt::if_packet_info_t().cid) //no class id ever used
+    ;
+    size_t bpp = _rx_xports.front()->get_recv_frame_size() - hdr_size;
+    return bpp/_rx_otw_type.get_sample_size();
+}
+
+size_t sim_impl::recv(
+    const recv_buffs_type &buffs, size_t nsamps_per_buff,
+    rx_metadata_t &metadata, const io_type_t &io_type,
+    recv_mode_t recv_mode, double timeout
+){
+    return _io_impl->recv_handler.recv(
+        buffs, nsamps_per_buff,
+        metadata, io_type,
+        recv_mode, timeout
+    );
+}
+
+size_t sim_impl::recv_full_buff(
+    const recv_buffs_type &buffs, size_t nsamps_per_buff,
+    recv_metadata_array_type &metadata_array,
+    const io_type_t &io_type, double timeout
+){
+    return _io_impl->recv_handler.recv_full_buff(
+        buffs, nsamps_per_buff,
+        metadata_array, io_type, timeout
+    );
+}
+
+size_t sim_impl::recv_view(recv_view_t &view, double timeout){
+    return _io_impl->recv_handler.recv_view(view, timeout);
+}
+
+/***********************************************************************
+ * Streams
+ **********************************************************************/
+//! Fill in the default channels and check the channels and the otw format
+static void check_stream_args(stream_args_t &args, const size_t num_chans, const std::string &dir){
+    if (args.otw_format.empty()) args.otw_format = "sc16";
+    if (args.otw_format != "sc16") throw uhd::value_error(
+        "sim " + dir + " streams only carry the sc16 otw format, not " + args.otw_format
+    );
+    if (args.channels.empty()) for (size_t i = 0; i < num_chans; i++) args.channels.push_back(i);
+    BOOST_FOREACH(const size_t chan, args.channels){
+        if (chan < num_chans) continue;
+        throw uhd::index_error(str(boost::format(
+            "sim %s stream: channel %u is not in the %u channels of the subdevice specification"
+        ) % dir % chan % num_chans));
+    }
+}
+
+rx_streamer::sptr sim_impl::get_rx_stream(const stream_args_t &args_){
+    stream_args_t args = args_;
+    check_stream_args(args, _tree->access<subdev_spec_t>("/mboards/0/rx_subdev_spec").get().size(), "rx");
+    const size_t spp = (args.spp == 0)? get_max_recv_samps_per_packet() : std::min(args.spp, get_max_recv_samps_per_packet());
+
+    //make a handler for the channels of this stream
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer(new sph::recv_packet_streamer(
+        io_type_t(args.cpu_type), spp
+    ));
+    my_streamer->resize(args.channels.size());
+    init_recv_handler(*my_streamer, _rx_otw_type, _io_impl->handler_args);
+    my_streamer->set_scale_factor(1/32767.);
+    my_streamer->set_tick_rate(_tick_rate);
+    my_streamer->set_samp_rate(_tree->access<double>(
+        str(boost::format("/mboards/0/rx_dsps/%u/rate/value") % args.channels.front())
+    ).get());
+
+    //the channels of the subdevice specification are the dsps in order
+    for (size_t i = 0; i < args.channels.size(); i++){
+        const size_t dsp = args.channels[i];
+        _rx_xports[dsp]->set_nsamps_per_packet(spp);
+        bind_recv_chan(*my_streamer, i, _rx_xports[dsp], _io_impl->rx_counters[dsp]);
+        _io_impl->rx_streamers[dsp] = my_streamer;
+        _io_impl->rx_streamer_chans[dsp] = i;
+    }
+    return my_streamer;
+}
+
+tx_streamer::sptr sim_impl::get_tx_stream(const stream_args_t &args_){
+    stream_args_t args = args_;
+    check_stream_args(args, _tree->access<subdev_spec_t>("/mboards/0/tx_subdev_spec").get().size(), "tx");
+    const size_t spp = (args.spp == 0)? get_max_send_samps_per_packet() : std::min(args.spp, get_max_send_samps_per_packet());
+
+    //make a handler for the channels of this stream
+    boost::shared_ptr<sph::send_packet_streamer> my_streamer(new sph::send_packet_streamer(
+        io_type_t(args.cpu_type), spp
+    ));
+    my_streamer->resize(args.channels.size());
+    init_send_handler(*my_streamer, _tx_otw_type, _io_impl->handler_args, _tree, spp);
+    my_streamer->set_tick_rate(_tick_rate);
+    my_streamer->set_samp_rate(_tree->access<double>("/mboards/0/tx_dsps/0/rate/value").get());
+
+    //every channel goes to the one tx dsp
+    for (size_t i = 0; i < args.channels.size(); i++){
+        bind_send_chan(*my_streamer, i, _tx_xport, _io_impl->tx_counters);
+    }
+    _io_impl->tx_streamer = my_streamer;
+    return my_streamer;
+}
+
+/***********************************************************************
+ * Async Recv
+ **********************************************************************/
+bool sim_impl::recv_async_msg(
+    async_metadata_t &async_metadata, double timeout
+){
+    boost::this_thread::disable_interruption di; //disable because the wait can throw
+    return _io_impl->async_msg_fifo.pop_with_timed_wait(async_metadata, timeout);
+}
+
+poll_fds_t sim_impl::get_async_msg_poll_fds(void){
+    const poll_fds_t fds = _io_impl->async_msg_fifo.get_poll_fds();
+    if (fds.empty()) throw uhd::not_implemented_error("sim async messages cannot be polled on this platform");
+    return fds;
+}
+
+/***********************************************************************
+ * Receive Readiness
+ **********************************************************************/
+poll_fds_t sim_impl::get_recv_poll_fds(void){
+    throw uhd::not_implemented_error("sim receive transports cannot be polled");
+}
@@ -0,0 +1,285 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "sim_impl.hpp"
+#include <uhd/utils/msg.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/static.hpp>
+#include <uhd/utils/algorithm.hpp>
+#include <uhd/usrp/mboard_eeprom.hpp>
+#include <uhd/usrp/dboard_eeprom.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/assign/list_of.hpp>
+#include <boost/math/special_functions/round.hpp>
+#include <algorithm>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+/***********************************************************************
+ * Discovery
+ **********************************************************************/
+static device_addrs_t sim_find(const device_addr_t &hint){
+    device_addrs_t sim_addrs;
+
+    //the simulator is only found when it is asked for by type
+    if (not hint.has_key("type") or hint["type"] != "sim") return sim_addrs;
+
+    device_addr_t new_addr;
+    new_addr["type"] = "sim";
+    new_addr["name"] = hint.get("name", "");
+    new_addr["serial"] = hint.get("serial", "sim0");
+    sim_addrs.push_back(new_addr);
+
+    return sim_addrs;
+}
+
+/***********************************************************************
+ * Make
+ **********************************************************************/
+static device::sptr sim_make(const device_addr_t &device_addr){
+    return device::sptr(new sim_impl(device_addr));
+}
+
+UHD_STATIC_BLOCK(register_sim_device){
+    device::register_device(&sim_find, &sim_make);
+}
+
+/***********************************************************************
+ * Structors
+ **********************************************************************/
+sim_impl::sim_impl(const uhd::device_addr_t &device_addr):
+    _clock(new sim_clock()),
+    _tick_rate(SIM_DEFAULT_TICK_RATE),
+    _rx_decims(SIM_NUM_RX_DSPS, 1),
+    _tx_interp(1)
+{
+    UHD_MSG(status) << "Opening a simulated device, the samples are synthetic" << std::endl;
+
+    //the simulated transports play the part of the dsps
+    for (size_t dspno = 0; dspno < SIM_NUM_RX_DSPS; dspno++){
+        _rx_xports.push_back(sim_recv_source::make(_clock, SIM_RX_SID_BASE + dspno, device_addr));
+    }
+
+    ////////////////////////////////////////////////////////////////////
+    // Initialize the properties tree
+    ////////////////////////////////////////////////////////////////////
+    _tree = property_tree::make();
+    _tree->create<std::string>("/name").set("Simulated Device");
+    const fs_path mb_path = "/mboards/0";
+    _tree->create<std::string>(mb_path / "name").set("SIM (simulator)");
+
+    ////////////////////////////////////////////////////////////////////
+    // setup the mboard eeprom (kept in memory)
+    ////////////////////////////////////////////////////////////////////
+    mboard_eeprom_t mb_eeprom;
+    mb_eeprom["name"] = device_addr.get("name", "");
+    mb_eeprom["serial"] = device_addr.get("serial", "sim0");
+    _tree->create<mboard_eeprom_t>(mb_path / "eeprom").set(mb_eeprom);
+
+    ////////////////////////////////////////////////////////////////////
+    // create clock control objects
+    ////////////////////////////////////////////////////////////////////
+    _tree->create<double>(mb_path / "tick_rate")
+        .coerce(boost::bind(&sim_impl::coerce_tick_rate, this, _1))
+        .set(device_addr.cast<double>("master_clock_rate", SIM_DEFAULT_TICK_RATE));
+
+    ////////////////////////////////////////////////////////////////////
+    // create codec control objects
+    ////////////////////////////////////////////////////////////////////
+    _tree->create<std::string>(mb_path / "rx_codecs/A/name").set("sim adc");
+    _tree->create<int>(mb_path / "rx_codecs/A/gains"); //phony property so this dir exists
+    _tree->create<std::string>(mb_path / "tx_codecs/A/name").set("sim dac");
+    _tree->create<int>(mb_path / "tx_codecs/A/gains"); //phony property so this dir exists
+
+    ////////////////////////////////////////////////////////////////////
+    // and do the misc mboard sensors
+    ////////////////////////////////////////////////////////////////////
+    _tree->create<sensor_value_t>(mb_path / "sensors/ref_locked")
+        .publish(boost::bind(&sim_impl::get_ref_locked, this));
+
+    ////////////////////////////////////////////////////////////////////
+    // create frontend control objects
+    ////////////////////////////////////////////////////////////////////
+    _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec")
+        .subscribe(boost::bind(&sim_impl::update_rx_subdev_spec, this, _1));
+    _tree->create<subdev_spec_t>(mb_path / "tx_subdev_spec")
+        .subscribe(boost::bind(&sim_impl::update_tx_subdev_spec, this, _1));
+
+    ////////////////////////////////////////////////////////////////////
+    // create rx dsp control objects
+    ////////////////////////////////////////////////////////////////////
+    for (size_t dspno = 0; dspno < SIM_NUM_RX_DSPS; dspno++){
+        fs_path rx_dsp_path = mb_path / str(boost::format("rx_dsps/%u") % dspno);
+        _tree->create<double>(rx_dsp_path / "rate/value")
+            .coerce(boost::bind(&sim_impl::set_rx_dsp_rate, this, dspno, _1))
+            .subscribe(boost::bind(&sim_impl::update_rx_samp_rate, this, dspno, _1));
+        _tree->create<double>(rx_dsp_path / "freq/value")
+            .coerce(boost::bind(&sim_impl::set_dsp_freq, this, _1));
+        _tree->create<meta_range_t>(rx_dsp_path / "freq/range")
+            .publish(boost::bind(&sim_impl::get_dsp_freq_range, this));
+        _tree->create<stream_cmd_t>(rx_dsp_path / "stream_cmd")
+            .subscribe(boost::bind(&sim_recv_source::issue_stream_command, _rx_xports[dspno], _1))
+            .subscribe(boost::bind(&sim_impl::drop_rx_lookahead, this, dspno));
+    }
+
+    ////////////////////////////////////////////////////////////////////
+    // create tx dsp control objects
+    ////////////////////////////////////////////////////////////////////
+    _tree->create<double>(mb_path / "tx_dsps/0/rate/value")
+        .coerce(boost::bind(&sim_impl::set_tx_dsp_rate, this, _1))
+        .subscribe(boost::bind(&sim_impl::update_tx_samp_rate, this, _1));
+    _tree->create<double>(mb_path / "tx_dsps/0/freq/value")
+        .coerce(boost::bind(&sim_impl::set_dsp_freq, this, _1));
+    _tree->create<meta_range_t>(mb_path / "tx_dsps/0/freq/range")
+        .publish(boost::bind(&sim_impl::get_dsp_freq_range, this));
+
+    ////////////////////////////////////////////////////////////////////
+    // create time control objects
+    ////////////////////////////////////////////////////////////////////
+    _tree->create<time_spec_t>(mb_path / "time/now")
+        .publish(boost::bind(&sim_clock::get_time_now, _clock))
+        .subscribe(boost::bind(&sim_clock::set_time_now, _clock, _1));
+    _tree->create<time_spec_t>(mb_path / "time/pps")
+        .publish(boost::bind(&sim_clock::get_time_last_pps, _clock))
+        .subscribe(boost::bind(&sim_clock::set_time_next_pps, _clock, _1));
+    //setup time source props
+    _tree->create<std::string>(mb_path / "time_source/value")
+        .subscribe(boost::bind(&sim_impl::update_time_source, this, _1));
+    static const std::vector<std::string> time_sources = boost::assign::list_of("none")("external")("_external_");
+    _tree->create<std::vector<std::string> >(mb_path / "time_source/options").set(time_sources);
+    //setup reference source props
+    _tree->create<std::string>(mb_path / "clock_source/value")
+        .subscribe(boost::bind(&sim_impl::update_clock_source, this, _1));
+    static const std::vector<std::string> clock_sources = boost::assign::list_of("internal")("external")("auto");
+    _tree->create<std::vector<std::string> >(mb_path / "clock_source/options").set(clock_sources);
+
+    ////////////////////////////////////////////////////////////////////
+    // create dboard control objects
+    ////////////////////////////////////////////////////////////////////
+
+    //a basic rx and a basic tx board: frontends without tuning or gain
+    dboard_eeprom_t rx_db_eeprom, tx_db_eeprom, gdb_eeprom;
+    rx_db_eeprom.id = dboard_id_t::from_uint16(0x0001);
+    tx_db_eeprom.id = dboard_id_t::from_uint16(0x0000);
+
+    //create the properties, the eeproms are kept in memory
+    _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/rx_eeprom").set(rx_db_eeprom);
+    _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/tx_eeprom").set(tx_db_eeprom);
+    _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/gdb_eeprom").set(gdb_eeprom);
+
+    //create a new dboard interface and manager
+    _dboard_iface = make_sim_dboard_iface(boost::bind(&sim_impl::get_tick_rate, this));
+    _tree->create<dboard_iface::sptr>(mb_path / "dboards/A/iface").set(_dboard_iface);
+    _dboard_manager = dboard_manager::make(
+        rx_db_eeprom.id, tx_db_eeprom.id,
+        _dboard_iface, _tree->subtree(mb_path / "dboards/A"),
+        device_addr.has_key("defer_dboard_init")
+    );
+
+    //initialize io handling
+    this->io_init(device_addr);
+
+    ////////////////////////////////////////////////////////////////////
+    // do some post-init tasks
+    ////////////////////////////////////////////////////////////////////
+    _tree->access<double>(mb_path / "tick_rate") //subscribe and then update the io and dsp rates
+        .subscribe(boost::bind(&sim_impl::update_tick_rate, this, _1)).update();
+
+    //and now that the tick rate is set, init the host rates to something
+    BOOST_FOREACH(const std::string &name, _tree->list(mb_path / "rx_dsps")){
+        _tree->access<double>(mb_path / "rx_dsps" / name / "rate" / "value").set(1e6);
+    }
+    BOOST_FOREACH(const std::string &name, _tree->list(mb_path / "tx_dsps")){
+        _tree->access<double>(mb_path / "tx_dsps" / name / "rate" / "value").set(1e6);
+    }
+
+    _tree->access<subdev_spec_t>(mb_path / "rx_subdev_spec").set(subdev_spec_t("A:"+_dboard_manager->get_rx_subdev_names()[0]));
+    _tree->access<subdev_spec_t>(mb_path / "tx_subdev_spec").set(subdev_spec_t("A:"+_dboard_manager->get_tx_subdev_names()[0]));
+    _tree->access<std::string>(mb_path / "clock_source/value").set("internal");
+    _tree->access<std::string>(mb_path / "time_source/value").set("none");
+
+    //export the counters from a thread, with the telemetry device address keys
+    _telemetry = telemetry_exporter::make(device_addr, _tree);
+
+    //share the tree with the local tools, with the prop_socket device address key
+    if (device_addr.has_key("prop_socket")){
+        _prop_server = property_server::make(_tree, device_addr["prop_socket"]);
+    }
+}
+
+sim_impl::~sim_impl(void){
+    _prop_server.reset();
+    _telemetry.reset(); //stop reading the tree first
+}
+
+/***********************************************************************
+ * Clock and DSP settings
+ **********************************************************************/
+double sim_impl::coerce_tick_rate(const double rate){
+    if (rate <= 0) throw uhd::value_error(str(boost::format(
+        "sim: cannot set a tick rate of %f") % rate
+    ));
+    //the device time counts whole ticks per second
+    _tick_rate = std::max(1.0, boost::math::round(rate));
+    return _tick_rate;
+}
+
+static size_t rate_to_divisor(const double tick_rate, const double rate){
+    const double divisor = (rate > 0)? boost::math::round(tick_rate/rate) : 1.0;
+    return size_t(uhd::clip<double>(divisor, 1, SIM_MAX_RATE_DIVISOR));
+}
+
+double sim_impl::set_rx_dsp_rate(const size_t dspno, const double rate){
+    _rx_decims[dspno] = rate_to_divisor(_tick_rate, rate);
+    _rx_xports[dspno]->set_rates(_tick_rate, _rx_decims[dspno]);
+    return _tick_rate/_rx_decims[dspno];
+}
+
+double sim_impl::set_tx_dsp_rate(const double rate){
+    _tx_interp = rate_to_divisor(_tick_rate, rate);
+    _tx_xport->set_rates(_tick_rate, _tx_interp);
+    return _tick_rate/_tx_interp;
+}
+
+double sim_impl::set_dsp_freq(const double freq){
+    //the simulated dsp does not shift the signal, only the range is honored
+    return this->get_dsp_freq_range().clip(freq);
+}
+
+meta_range_t sim_impl::get_dsp_freq_range(void){
+    return meta_range_t(-_tick_rate/2, +_tick_rate/2);
+}
+
+/***********************************************************************
+ * Clock and time sources
+ **********************************************************************/
+void sim_impl::update_time_source(const std::string &source){
+    const std::vector<std::string> sources = _tree->access<std::vector<std::string> >("/mboards/0/time_source/options").get();
+    if (not uhd::has(sources, source)) throw uhd::value_error("sim: unknown time source: " + source);
+}
+
+void sim_impl::update_clock_source(const std::string &source){
+    const std::vector<std::string> sources = _tree->access<std::vector<std::string> >("/mboards/0/clock_source/options").get();
+    if (not uhd::has(sources, source)) throw uhd::value_error("sim: unknown clock source: " + source);
+}
+
+sensor_value_t sim_impl::get_ref_locked(void){
+    return sensor_value_t("Ref", true, "locked", "unlocked");
+}
@@ -0,0 +1,125 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_SIM_IMPL_HPP
+#define INCLUDED_SIM_IMPL_HPP
+
+#include "sim_zero_copy.hpp"
+#include "telemetry.hpp"
+#include <uhd/usrp/property_broker.hpp>
+#include <uhd/device.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/utils/pimpl.hpp>
+#include <uhd/types/otw_type.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/types/sensors.hpp>
+#include <uhd/types/stream_cmd.hpp>
+#include <uhd/usrp/subdev_spec.hpp>
+#include <uhd/usrp/dboard_iface.hpp>
+#include <uhd/usrp/dboard_manager.hpp>
+#include <boost/function.hpp>
+#include <vector>
+
+static const double          SIM_DEFAULT_TICK_RATE = 100e6;
+static const size_t          SIM_NUM_RX_DSPS = 2;
+static const size_t          SIM_MAX_RATE_DIVISOR = 512; //largest decimation or interpolation
+static const boost::uint32_t SIM_TX_ASYNC_SID = 2;
+static const boost::uint32_t SIM_RX_SID_BASE = 3;
+
+//! Make a sim dboard interface, the dboard clock follows the tick rate
+uhd::usrp::dboard_iface::sptr make_sim_dboard_iface(
+    const boost::function<double(void)> &get_tick_rate
+);
+
+/*!
+ * Simulated device implementation guts:
+ * The device has the property tree of a single mboard usrp,
+ * with 2 rx dsps, a tx dsp, and a basic rx and tx dboard in slot A.
+ * The samples stream through the real packet handlers and converters,
+ * over simulated transports that play the part of the device.
+ */
+class sim_impl : public uhd::device{
+public:
+    //structors
+    sim_impl(const uhd::device_addr_t &);
+    ~sim_impl(void);
+
+    //the io interface
+    size_t send(const send_buffs_type &, size_t, const uhd::tx_metadata_t &, const uhd::io_type_t &, send_mode_t, double);
+    size_t recv(const recv_buffs_type &, size_t, uhd::rx_metadata_t &, const uhd::io_type_t &, recv_mode_t, double);
+    size_t recv_full_buff(const recv_buffs_type &, size_t, recv_metadata_array_type &, const uhd::io_type_t &, double);
+    size_t recv_view(recv_view_t &, double);
+    size_t get_send_view(send_view_t &, double);
+    size_t commit_send_view(send_view_t &, size_t, double);
+    uhd::rx_streamer::sptr get_rx_stream(const uhd::stream_args_t &);
+    uhd::tx_streamer::sptr get_tx_stream(const uhd::stream_args_t &);
+    bool recv_async_msg(uhd::async_metadata_t &, double);
+    uhd::transport::poll_fds_t get_recv_poll_fds(void);
+    uhd::transport::poll_fds_t get_async_msg_poll_fds(void);
+    size_t get_max_send_samps_per_packet(void) const;
+    size_t get_max_recv_samps_per_packet(void) const;
+
+private:
+    uhd::property_tree::sptr _tree;
+
+    //the simulated hardware
+    sim_clock::sptr _clock;
+    std::vector<sim_recv_source::sptr> _rx_xports;
+    sim_send_sink::sptr _tx_xport;
+    uhd::usrp::dboard_iface::sptr _dboard_iface;
+    uhd::usrp::dboard_manager::sptr _dboard_manager;
+
+    //the dsp settings
+    double _tick_rate;
+    std::vector<size_t> _rx_decims;
+    size_t _tx_interp;
+
+    //handle io stuff
+    uhd::otw_type_t _rx_otw_type, _tx_otw_type;
+    UHD_PIMPL_DECL(io_impl) _io_impl;
+    void io_init(const uhd::device_addr_t &);
+
+    //device properties interface
+    uhd::property_tree::sptr get_tree(void) const{
+        return _tree;
+    }
+
+    double get_tick_rate(void){
+        return _tick_rate;
+    }
+
+    double coerce_tick_rate(const double);
+    double set_rx_dsp_rate(const size_t, const double);
+    double set_tx_dsp_rate(const double);
+    double set_dsp_freq(const double);
+    uhd::meta_range_t get_dsp_freq_range(void);
+    uhd::sensor_value_t get_ref_locked(void);
+    void update_tick_rate(const double rate);
+    void update_rx_samp_rate(const size_t dspno, const double rate);
+    void drop_rx_lookahead(const size_t dspno);
+    void update_tx_samp_rate(const double rate);
+    void update_rx_subdev_spec(const uhd::usrp::subdev_spec_t &);
+    void update_tx_subdev_spec(const uhd::usrp::subdev_spec_t &);
+    void update_time_source(const std::string &);
+    void update_clock_source(const std::string &);
+
+    //last, so the exporter thread stops before the rest goes away
+    uhd::usrp::telemetry_exporter::sptr _telemetry;
+    uhd::usrp::property_server::sptr _prop_server;
+};
+
+#endif /* INCLUDED_SIM_IMPL_HPP */
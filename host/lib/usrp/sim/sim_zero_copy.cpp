@@ -0,0 +1,637 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "sim_zero_copy.hpp"
+#include <uhd/transport/vrt_if_packet.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/math/special_functions/round.hpp>
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <deque>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+static const size_t DEFAULT_FRAME_SIZE = 1472; //same as the usrp2 udp mtu
+static const size_t DEFAULT_NUM_FRAMES = 32;
+static const double DEFAULT_RECV_BUFF_SIZE = 50e6; //same as the usrp2 socket default
+static const double DEFAULT_SEND_FIFO_SIZE = 1 << 20; //same as the usrp2 sram
+static const size_t SIGNAL_TABLE_SIZE = 1 << 16; //samples, the ramp covers all 16 bits
+static const size_t BYTES_PER_SAMPLE = sizeof(boost::uint32_t); //sc16
+
+/***********************************************************************
+ * Device time helpers:
+ *  - The samples are timed in whole ticks of the tick rate.
+ *  - The vrt time is whole seconds (tsi) and ticks in the second (tsf).
+ **********************************************************************/
+static boost::int64_t time_to_ticks(const time_spec_t &time, const boost::int64_t tps){
+    return boost::int64_t(time.get_full_secs())*tps + time.get_tick_count(double(tps));
+}
+
+static time_spec_t ticks_to_time(const boost::int64_t ticks, const boost::int64_t tps){
+    const boost::int64_t secs = (ticks >= 0)? ticks/tps : -((-ticks + tps - 1)/tps);
+    return time_spec_t(time_t(secs), long(ticks - secs*tps), double(tps));
+}
+
+//! Round up to the next multiple of the step
+static boost::int64_t align_up(const boost::int64_t ticks, const boost::int64_t step){
+    return ((ticks + step - 1)/step)*step;
+}
+
+/***********************************************************************
+ * Simulated device clock
+ **********************************************************************/
+sim_clock::sim_clock(void):
+    _offset(time_spec_t::get_system_time()), _pps_pending(false)
+{
+    /* NOP */
+}
+
+void sim_clock::update_pps(const time_spec_t &host_time){
+    if (not _pps_pending or host_time < _pps_edge) return;
+    _offset = _pps_offset;
+    _pps_pending = false;
+}
+
+time_spec_t sim_clock::get_time_now(void){
+    const time_spec_t host_time = time_spec_t::get_system_time();
+    boost::mutex::scoped_lock lock(_mutex);
+    this->update_pps(host_time);
+    return host_time - _offset;
+}
+
+time_spec_t sim_clock::get_time_last_pps(void){
+    const time_spec_t host_time = time_spec_t::get_system_time();
+    boost::mutex::scoped_lock lock(_mutex);
+    this->update_pps(host_time);
+    return time_spec_t(host_time.get_full_secs()) - _offset;
+}
+
+void sim_clock::set_time_now(const time_spec_t &time){
+    const time_spec_t host_time = time_spec_t::get_system_time();
+    boost::mutex::scoped_lock lock(_mutex);
+    _offset = host_time - time;
+    _pps_pending = false;
+}
+
+void sim_clock::set_time_next_pps(const time_spec_t &time){
+    const time_spec_t host_time = time_spec_t::get_system_time();
+    boost::mutex::scoped_lock lock(_mutex);
+    _pps_edge = time_spec_t(host_time.get_full_secs() + 1);
+    _pps_offset = _pps_edge - time;
+    _pps_pending = true;
+}
+
+/***********************************************************************
+ * Synthetic signal:
+ *  - One period of the signal is kept as over-the-wire words,
+ *    so that making a frame is a copy out of the table.
+ *  - The table is indexed by the sample number of the device time,
+ *    so the signal is continuous across frames and shows the gaps.
+ **********************************************************************/
+static std::vector<boost::uint32_t> make_signal_table(
+    const std::string &type, const double freq, const double ampl, const double samp_rate
+){
+    std::vector<boost::uint32_t> table(SIGNAL_TABLE_SIZE);
+    //the tone has a whole number of cycles per table, so it wraps without a phase jump
+    const double cycles = boost::math::round(freq/samp_rate*SIGNAL_TABLE_SIZE);
+    boost::uint32_t lcg = 0x5eed;
+    for (size_t i = 0; i < SIGNAL_TABLE_SIZE; i++){
+        std::complex<double> samp(0.0, 0.0);
+        if (type == "tone"){
+            samp = std::polar(ampl, 2*std::acos(-1.0)*cycles*i/SIGNAL_TABLE_SIZE);
+        }
+        else if (type == "noise"){
+            //the sum of uniforms is close enough to gaussian for a load
+            double re = 0.0, im = 0.0;
+            for (size_t j = 0; j < 4; j++){
+                lcg = lcg*1664525 + 1013904223; re += double(lcg >> 8)/(1 << 24) - 0.5;
+                lcg = lcg*1664525 + 1013904223; im += double(lcg >> 8)/(1 << 24) - 0.5;
+            }
+            samp = std::complex<double>(re, im)*ampl*0.5;
+        }
+        else if (type == "ramp"){
+            const boost::int16_t count = boost::int16_t(boost::uint16_t(i));
+            table[i] = uhd::htonx(boost::uint32_t((boost::uint16_t(count) << 16) | boost::uint16_t(-count)));
+            continue;
+        }
+        else if (type != "zero") throw uhd::value_error(
+            "unknown sim_signal " + type + ", expected tone, noise, ramp, or zero"
+        );
+        const boost::int16_t re = boost::int16_t(std::max(-1.0, std::min(1.0, samp.real()))*32767);
+        const boost::int16_t im = boost::int16_t(std::max(-1.0, std::min(1.0, samp.imag()))*32767);
+        table[i] = uhd::htonx(boost::uint32_t((boost::uint16_t(re) << 16) | boost::uint16_t(im)));
+    }
+    return table;
+}
+
+/***********************************************************************
+ * Reusable managed receive buffer:
+ *  - The buffer owns the memory of one frame.
+ *  - The buffer is claimed while a caller holds it.
+ **********************************************************************/
+class sim_recv_mrb : public managed_recv_buffer{
+public:
+    sim_recv_mrb(const size_t frame_size, zero_copy_stats_t &stats):
+        _mem(frame_size/sizeof(boost::uint32_t)), _len(0), _claimed(false), _stats(stats)
+    {
+        /* NOP */
+    }
+
+    void release(void){
+        if (not _claimed) return;
+        _claimed = false;
+        _stats.release_recv();
+    }
+
+    bool claimed(void) const{return _claimed;}
+
+    boost::uint32_t *mem(void){return &_mem.front();}
+
+    sptr get_new(const size_t len){
+        _len = len;
+        _claimed = true;
+        _stats.claim_recv(len);
+        return make_managed_buffer(this);
+    }
+
+private:
+    const void *get_buff(void) const{return &_mem.front();}
+    size_t get_size(void) const{return _len;}
+
+    std::vector<boost::uint32_t> _mem;
+    size_t _len;
+    bool _claimed;
+    zero_copy_stats_t &_stats;
+};
+
+/***********************************************************************
+ * Simulated receive transport:
+ *  - The frames are made by the thread that gets the receive buffer.
+ *  - Paced: a frame is handed out once the device time passes its last sample,
+ *    and an overflow is reported when the frames not yet taken
+ *    would overfill the socket buffer (recv_buff_size).
+ *  - Not paced: the frames are made as fast as they are taken,
+ *    the timestamps follow the sample count and never overflow.
+ **********************************************************************/
+class sim_recv_source_impl : public sim_recv_source{
+public:
+    sim_recv_source_impl(sim_clock::sptr clock, const boost::uint32_t sid, const device_addr_t &hints):
+        _clock(clock), _sid(sid),
+        _pace(hints.cast<bool>("sim_pace", true)),
+        _frame_size(size_t(hints.cast<double>("recv_frame_size", DEFAULT_FRAME_SIZE))),
+        _recv_buff_size(hints.cast<double>("recv_buff_size", DEFAULT_RECV_BUFF_SIZE)),
+        _signal(hints.get("sim_signal", "tone")),
+        _signal_freq(hints.cast<double>("sim_signal_freq", 100e3)),
+        _signal_ampl(hints.cast<double>("sim_signal_ampl", 0.3)),
+        _next_mrb(0), _tps(1), _decim(1), _spp(1), _buff_ticks(0),
+        _active(false), _continuous(false), _more(false), _chained(false),
+        _remaining(0), _next_tick(0), _packet_count(0)
+    {
+        const size_t num_frames = size_t(hints.cast<double>("num_recv_frames", DEFAULT_NUM_FRAMES));
+        if (_frame_size < (vrt::max_if_hdr_words32 + 2)*sizeof(boost::uint32_t)) throw uhd::value_error(
+            "sim: recv_frame_size is too small for a vrt frame"
+        );
+        for (size_t i = 0; i < num_frames; i++){
+            _mrbs.push_back(boost::shared_ptr<sim_recv_mrb>(new sim_recv_mrb(_frame_size, _stats)));
+        }
+        this->set_rates(1e6, 1);
+    }
+
+    void set_rates(const double tick_rate, const size_t decim){
+        boost::mutex::scoped_lock lock(_mutex);
+        _tps = std::max<boost::int64_t>(boost::math::llround(tick_rate), 1);
+        _decim = std::max<size_t>(decim, 1);
+        _buff_ticks = boost::int64_t(_recv_buff_size/BYTES_PER_SAMPLE)*boost::int64_t(_decim);
+        _table = make_signal_table(_signal, _signal_freq, _signal_ampl, double(_tps)/_decim);
+    }
+
+    void set_nsamps_per_packet(const size_t nsamps){
+        boost::mutex::scoped_lock lock(_mutex);
+        const size_t max_nsamps = _frame_size/BYTES_PER_SAMPLE - vrt::max_if_hdr_words32 - 1/*tlr*/;
+        _spp = std::max<size_t>(std::min(nsamps, max_nsamps), 1);
+    }
+
+    void issue_stream_command(const stream_cmd_t &stream_cmd){
+        boost::mutex::scoped_lock lock(_mutex);
+        if (stream_cmd.stream_mode == stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS){
+            _cmds.clear();
+            _active = false;
+            _chained = false;
+        }
+        else{
+            //a stream now command starts when it is issued, not when it is read
+            stream_cmd_t cmd = stream_cmd;
+            if (cmd.stream_now) cmd.time_spec = _clock->get_time_now();
+            _cmds.push_back(cmd);
+        }
+        _cond.notify_one();
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(double timeout){
+        sim_recv_mrb &mrb = *_mrbs[_next_mrb];
+        if (mrb.claimed()){ //every frame is held by the caller
+            _stats.recv_timeouts++;
+            return managed_recv_buffer::sptr();
+        }
+
+        const boost::system_time exit_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+        boost::mutex::scoped_lock lock(_mutex);
+        while (true){
+            const boost::int64_t now = time_to_ticks(_clock->get_time_now(), _tps);
+            boost::int64_t wait_ticks = 0;
+
+            //start the next stream command, or wait for one
+            if (not _active){
+                if (not _cmds.empty()){
+                    const stream_cmd_t stream_cmd = _cmds.front();
+                    _cmds.pop_front();
+                    if (this->start_command(stream_cmd, now)) continue;
+                    //a timed command that is already late is dropped
+                    return this->make_context(mrb, rx_metadata_t::ERROR_CODE_LATE_COMMAND,
+                        time_to_ticks(stream_cmd.time_spec, _tps));
+                }
+                if (_chained and (not _pace or now >= _next_tick)){ //the chain ended without a command to continue it
+                    _chained = false;
+                    return this->make_context(mrb, rx_metadata_t::ERROR_CODE_BROKEN_CHAIN, _next_tick);
+                }
+                wait_ticks = _chained? _next_tick - now : -1;
+            }
+
+            //make and pace the next frame of the stream
+            else{
+                const size_t nsamps = _continuous? _spp : std::min(_spp, _remaining);
+                const boost::int64_t end_tick = _next_tick + boost::int64_t(nsamps*_decim);
+                if (_pace and end_tick > now) wait_ticks = end_tick - now;
+                else if (_pace and now - end_tick > _buff_ticks){
+                    const boost::int64_t lost_tick = _next_tick;
+                    if (_continuous) _next_tick = align_up(now, boost::int64_t(_spp*_decim)); //resume
+                    else _active = _more = false;
+                    return this->make_context(mrb, rx_metadata_t::ERROR_CODE_OVERFLOW, lost_tick);
+                }
+                else return this->make_data(mrb, nsamps);
+            }
+
+            //wait for the device time or a new command, but not past the timeout
+            boost::system_time wait_time = exit_time;
+            if (wait_ticks >= 0) wait_time = std::min(wait_time, boost::get_system_time()
+                + boost::posix_time::microseconds(long(double(wait_ticks)*1e6/_tps) + 1));
+            if (boost::get_system_time() >= exit_time){
+                _stats.recv_timeouts++;
+                return managed_recv_buffer::sptr();
+            }
+            _cond.timed_wait(lock, wait_time);
+        }
+    }
+
+    size_t get_num_recv_frames(void) const{return _mrbs.size();}
+    size_t get_recv_frame_size(void) const{return _frame_size;}
+
+    managed_send_buffer::sptr get_send_buff(double){return managed_send_buffer::sptr();}
+    size_t get_num_send_frames(void) const{return 0;}
+    size_t get_send_frame_size(void) const{return 0;}
+
+    zero_copy_stats_t get_stats(void) const{return _stats;}
+
+private:
+    //! Start streaming for a command, returns false for a late command
+    bool start_command(const stream_cmd_t &stream_cmd, const boost::int64_t now){
+        boost::int64_t start_tick = _next_tick;
+        if (_chained) _chained = false; //continue right after the last command
+        else if (stream_cmd.stream_now){
+            //on the frame grid, so the dsps started together are aligned
+            //not paced, the stream may already be ahead of the device time
+            const boost::int64_t issued = std::min(now, time_to_ticks(stream_cmd.time_spec, _tps));
+            start_tick = align_up(_pace? issued : std::max(issued, _next_tick), boost::int64_t(_spp*_decim));
+        }
+        else{
+            start_tick = time_to_ticks(stream_cmd.time_spec, _tps);
+            if (_pace and start_tick < now) return false;
+        }
+        _next_tick = start_tick;
+        _continuous = stream_cmd.stream_mode == stream_cmd_t::STREAM_MODE_START_CONTINUOUS;
+        _more = stream_cmd.stream_mode == stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_MORE;
+        _remaining = stream_cmd.num_samps;
+        _active = _continuous or _remaining != 0;
+        _chained = not _active and _more;
+        return true;
+    }
+
+    void pack_header(boost::uint32_t *mem, vrt::if_packet_info_t &ifpi, const boost::int64_t tick){
+        const time_spec_t time = ticks_to_time(tick, _tps);
+        //only the data packets take a sequence count
+        ifpi.packet_count = _packet_count;
+        if (ifpi.packet_type == vrt::if_packet_info_t::PACKET_TYPE_DATA) _packet_count = (_packet_count + 1) % 16;
+        ifpi.sob = false;
+        ifpi.eob = false;
+        ifpi.has_sid = true;
+        ifpi.sid = _sid;
+        ifpi.has_cid = false;
+        ifpi.has_tsi = true;
+        ifpi.tsi = boost::uint32_t(time.get_full_secs());
+        ifpi.has_tsf = true;
+        ifpi.tsf = boost::uint64_t(time.get_tick_count(double(_tps)));
+        vrt::if_hdr_pack_be(mem, ifpi);
+    }
+
+    managed_recv_buffer::sptr make_data(sim_recv_mrb &mrb, const size_t nsamps){
+        const bool last = not _continuous and nsamps == _remaining;
+        vrt::if_packet_info_t ifpi;
+        ifpi.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+        ifpi.num_payload_words32 = nsamps;
+        ifpi.has_tlr = true;
+        ifpi.tlr = (last and not _more)? ((1 << 20) | (1 << 8)) : 0; //eob enable and indicator bits
+        boost::uint32_t *mem = mrb.mem();
+        this->pack_header(mem, ifpi, _next_tick);
+
+        //copy the samples out of the signal table, wrapping at the end
+        boost::uint32_t *payload = mem + ifpi.num_header_words32;
+        const size_t index = size_t((_next_tick/boost::int64_t(_decim)) % SIGNAL_TABLE_SIZE);
+        const size_t first = std::min(nsamps, SIGNAL_TABLE_SIZE - index);
+        std::copy(_table.begin() + index, _table.begin() + index + first, payload);
+        std::copy(_table.begin(), _table.begin() + (nsamps - first), payload + first);
+        payload[nsamps] = uhd::htonx(ifpi.tlr);
+
+        _next_tick += boost::int64_t(nsamps*_decim);
+        if (not _continuous){
+            _remaining -= nsamps;
+            if (_remaining == 0){
+                _active = false;
+                _chained = _more;
+            }
+        }
+        return this->hand_out(mrb, ifpi);
+    }
+
+    managed_recv_buffer::sptr make_context(sim_recv_mrb &mrb, const rx_metadata_t::error_code_t code, const boost::int64_t tick){
+        vrt::if_packet_info_t ifpi;
+        ifpi.packet_type = vrt::if_packet_info_t::PACKET_TYPE_CONTEXT;
+        ifpi.num_payload_words32 = 1;
+        ifpi.has_tlr = false;
+        boost::uint32_t *mem = mrb.mem();
+        this->pack_header(mem, ifpi, tick);
+        mem[ifpi.num_header_words32] = uhd::htonx(boost::uint32_t(code));
+        return this->hand_out(mrb, ifpi);
+    }
+
+    managed_recv_buffer::sptr hand_out(sim_recv_mrb &mrb, const vrt::if_packet_info_t &ifpi){
+        if (++_next_mrb == _mrbs.size()) _next_mrb = 0;
+        return mrb.get_new(ifpi.num_packet_words32*sizeof(boost::uint32_t));
+    }
+
+    sim_clock::sptr _clock;
+    const boost::uint32_t _sid;
+    const bool _pace;
+    const size_t _frame_size;
+    const double _recv_buff_size;
+    const std::string _signal;
+    const double _signal_freq, _signal_ampl;
+    std::vector<boost::uint32_t> _table;
+    std::vector<boost::shared_ptr<sim_recv_mrb> > _mrbs;
+    size_t _next_mrb;
+    zero_copy_stats_t _stats;
+
+    //the stream state, the commands come from other threads
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::deque<stream_cmd_t> _cmds;
+    boost::int64_t _tps;
+    size_t _decim, _spp;
+    boost::int64_t _buff_ticks;
+    bool _active, _continuous, _more, _chained;
+    size_t _remaining;
+    boost::int64_t _next_tick;
+    size_t _packet_count;
+};
+
+sim_recv_source::sptr sim_recv_source::make(
+    sim_clock::sptr clock, const boost::uint32_t sid, const device_addr_t &hints
+){
+    return sptr(new sim_recv_source_impl(clock, sid, hints));
+}
+
+/***********************************************************************
+ * Reusable managed send buffer:
+ *  - The buffer owns the memory of one frame.
+ *  - A commit hands the frame to the sink, then frees the buffer.
+ **********************************************************************/
+class sim_send_sink_impl;
+
+class sim_send_msb : public managed_send_buffer{
+public:
+    sim_send_msb(const size_t frame_size, sim_send_sink_impl &sink):
+        _mem(frame_size/sizeof(boost::uint32_t)), _claimed(false), _sink(sink)
+    {
+        /* NOP */
+    }
+
+    void commit(size_t num_bytes);
+
+    bool claimed(void) const{return _claimed;}
+
+    sptr get_new(void){
+        _claimed = true;
+        return make_managed_buffer(this);
+    }
+
+private:
+    void *get_buff(void) const{return const_cast<boost::uint32_t *>(&_mem.front());}
+    size_t get_size(void) const{return _mem.size()*sizeof(boost::uint32_t);}
+
+    std::vector<boost::uint32_t> _mem;
+    bool _claimed;
+    sim_send_sink_impl &_sink;
+};
+
+/***********************************************************************
+ * Simulated send transport:
+ *  - The fifo drains at the sample rate from the start of each burst.
+ *  - Paced: a get of a send buffer waits until the fifo has room for
+ *    a frame, and a burst that runs the fifo dry reports an underflow.
+ *  - Not paced: the fifo drains at once, so a get never waits.
+ **********************************************************************/
+class sim_send_sink_impl : public sim_send_sink{
+public:
+    sim_send_sink_impl(sim_clock::sptr clock, const async_handler_type &async_handler, const device_addr_t &hints):
+        _clock(clock), _async_handler(async_handler),
+        _pace(hints.cast<bool>("sim_pace", true)),
+        _frame_size(size_t(hints.cast<double>("send_frame_size", DEFAULT_FRAME_SIZE))),
+        _fifo_size(hints.cast<double>("sim_send_fifo_size", DEFAULT_SEND_FIFO_SIZE)),
+        _next_msb(0), _tps(1), _interp(1),
+        _in_burst(false), _drop_burst(false), _fifo_start(0), _fifo_end(0), _next_seq(0)
+    {
+        const size_t num_frames = size_t(hints.cast<double>("num_send_frames", DEFAULT_NUM_FRAMES));
+        for (size_t i = 0; i < num_frames; i++){
+            _msbs.push_back(boost::shared_ptr<sim_send_msb>(new sim_send_msb(_frame_size, *this)));
+        }
+        this->set_rates(1e6, 1);
+    }
+
+    void set_rates(const double tick_rate, const size_t interp){
+        boost::mutex::scoped_lock lock(_mutex);
+        _tps = std::max<boost::int64_t>(boost::math::llround(tick_rate), 1);
+        _interp = std::max<size_t>(interp, 1);
+    }
+
+    managed_send_buffer::sptr get_send_buff(double timeout){
+        sim_send_msb &msb = *_msbs[_next_msb];
+        if (msb.claimed()){ //every frame is held by the caller
+            _stats.send_timeouts++;
+            return managed_send_buffer::sptr();
+        }
+
+        //flow control: wait until the fifo has room for a whole frame
+        if (_pace){
+            const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+            while (true){
+                const time_spec_t start_time = time_spec_t::get_system_time();
+                double wait_secs = 0.0;
+                {
+                    boost::mutex::scoped_lock lock(_mutex);
+                    const boost::int64_t now = time_to_ticks(_clock->get_time_now(), _tps);
+                    const boost::int64_t queued = _fifo_end - std::max(now, _fifo_start);
+                    const boost::int64_t frame = boost::int64_t(_frame_size/BYTES_PER_SAMPLE*_interp);
+                    const boost::int64_t room = boost::int64_t(_fifo_size/BYTES_PER_SAMPLE)*boost::int64_t(_interp);
+                    if (queued + frame > room) wait_secs = double(queued + frame - room)/_tps;
+                }
+                if (wait_secs == 0.0) break;
+                const double timeout_left = (exit_time - start_time).get_real_secs();
+                const bool timed_out = wait_secs > timeout_left;
+                if (timed_out) wait_secs = std::max(timeout_left, 0.0);
+                boost::this_thread::sleep(boost::posix_time::microseconds(long(wait_secs*1e6)));
+                _stats.send_wait_time += (time_spec_t::get_system_time() - start_time).get_real_secs();
+                if (timed_out){
+                    _stats.send_timeouts++;
+                    return managed_send_buffer::sptr();
+                }
+            }
+        }
+
+        if (++_next_msb == _msbs.size()) _next_msb = 0;
+        _stats.claim_send();
+        return msb.get_new();
+    }
+
+    size_t get_num_send_frames(void) const{return _msbs.size();}
+    size_t get_send_frame_size(void) const{return _frame_size;}
+
+    managed_recv_buffer::sptr get_recv_buff(double){return managed_recv_buffer::sptr();}
+    size_t get_num_recv_frames(void) const{return 0;}
+    size_t get_recv_frame_size(void) const{return 0;}
+
+    zero_copy_stats_t get_stats(void) const{return _stats;}
+
+    //! Consume a committed frame, called by the send buffer
+    void handle_frame(const boost::uint32_t *mem, const size_t num_bytes){
+        _stats.commit_send(num_bytes);
+        if (num_bytes == 0) return; //released without a commit
+
+        vrt::if_packet_info_t ifpi;
+        ifpi.num_packet_words32 = num_bytes/sizeof(boost::uint32_t);
+        try{
+            vrt::if_hdr_unpack_be(mem, ifpi);
+        }
+        catch(const std::exception &e){
+            UHD_LOGV(rarely) << "sim: bad vrt frame from the send handler: " << e.what() << std::endl;
+            return;
+        }
+        if (ifpi.packet_type != vrt::if_packet_info_t::PACKET_TYPE_DATA) return;
+
+        boost::mutex::scoped_lock lock(_mutex);
+        const boost::int64_t now = time_to_ticks(_clock->get_time_now(), _tps);
+        const boost::int64_t duration = boost::int64_t(ifpi.num_payload_words32*_interp);
+
+        //the device checks the sequence of every frame
+        if (ifpi.packet_count != _next_seq) this->post(_in_burst?
+            async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST : async_metadata_t::EVENT_CODE_SEQ_ERROR, now
+        );
+        _next_seq = (ifpi.packet_count + 1) % 16;
+
+        //the first frame of a burst: check the time and queue it behind the fifo
+        if (not _in_burst){
+            _in_burst = true;
+            _drop_burst = false;
+            boost::int64_t start = now;
+            if (ifpi.has_tsi and ifpi.has_tsf){
+                start = boost::int64_t(ifpi.tsi)*_tps + boost::int64_t(ifpi.tsf);
+                if (start < now){ //a late burst is dropped up to its end
+                    this->post(async_metadata_t::EVENT_CODE_TIME_ERROR, start);
+                    _drop_burst = true;
+                }
+            }
+            if (not _pace or _fifo_end <= now) _fifo_start = _fifo_end = start; //the fifo was empty
+            else _fifo_end = std::max(_fifo_end, start);
+        }
+
+        //the fifo ran dry in the middle of a burst
+        else if (_pace and not _drop_burst and _fifo_end < now){
+            this->post(async_metadata_t::EVENT_CODE_UNDERFLOW, _fifo_end);
+            _fifo_start = _fifo_end = now;
+        }
+
+        if (not _drop_burst) _fifo_end += duration;
+        if (ifpi.eob){
+            _in_burst = false;
+            if (not _drop_burst) this->post(async_metadata_t::EVENT_CODE_BURST_ACK, _fifo_end);
+        }
+    }
+
+private:
+    void post(const async_metadata_t::event_code_t code, const boost::int64_t tick){
+        async_metadata_t metadata;
+        metadata.channel = 0;
+        metadata.has_time_spec = true;
+        metadata.time_spec = ticks_to_time(tick, _tps);
+        metadata.event_code = code;
+        _async_handler(metadata);
+    }
+
+    sim_clock::sptr _clock;
+    const async_handler_type _async_handler;
+    const bool _pace;
+    const size_t _frame_size;
+    const double _fifo_size;
+    std::vector<boost::shared_ptr<sim_send_msb> > _msbs;
+    size_t _next_msb;
+    zero_copy_stats_t _stats;
+
+    //the fifo state, the rates come from other threads
+    boost::mutex _mutex;
+    boost::int64_t _tps;
+    size_t _interp;
+    bool _in_burst, _drop_burst;
+    boost::int64_t _fifo_start, _fifo_end; //the ticks of the queued samples
+    size_t _next_seq;
+};
+
+void sim_send_msb::commit(size_t num_bytes){
+    if (not _claimed) return;
+    _claimed = false;
+    _sink.handle_frame(&_mem.front(), num_bytes);
+}
+
+sim_send_sink::sptr sim_send_sink::make(
+    sim_clock::sptr clock, const async_handler_type &async_handler, const device_addr_t &hints
+){
+    return sptr(new sim_send_sink_impl(clock, async_handler, hints));
+}
@@ -0,0 +1,115 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_SIM_ZERO_COPY_HPP
+#define INCLUDED_LIBUHD_USRP_SIM_ZERO_COPY_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/stream_cmd.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/cstdint.hpp>
+
+/*!
+ * The clock of a simulated device:
+ * The device time runs on the host monotonic clock, from zero at open.
+ * The PPS edges are on the whole seconds of the host clock.
+ */
+class sim_clock : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<sim_clock> sptr;
+
+    sim_clock(void);
+
+    uhd::time_spec_t get_time_now(void);
+
+    uhd::time_spec_t get_time_last_pps(void);
+
+    void set_time_now(const uhd::time_spec_t &time);
+
+    //! The time is set on the next PPS edge, like the hardware
+    void set_time_next_pps(const uhd::time_spec_t &time);
+
+private:
+    boost::mutex _mutex;
+    uhd::time_spec_t _offset; //host time minus device time
+    uhd::time_spec_t _pps_edge, _pps_offset; //the offset to take at the edge
+    bool _pps_pending;
+    void update_pps(const uhd::time_spec_t &host_time);
+};
+
+/*!
+ * The receive transport of a simulated rx dsp:
+ * Generates vrt frames of big endian sc16 samples from a synthetic signal,
+ * timed by the stream commands and paced to the sample rate.
+ */
+class sim_recv_source : public uhd::transport::zero_copy_if{
+public:
+    typedef boost::shared_ptr<sim_recv_source> sptr;
+
+    /*!
+     * Make a new simulated receive transport.
+     * \param clock the device clock that times the samples
+     * \param sid the vrt stream id of the frames
+     * \param hints the signal, pacing, and frame options
+     */
+    static sptr make(
+        sim_clock::sptr clock, const boost::uint32_t sid,
+        const uhd::device_addr_t &hints
+    );
+
+    //! Set the tick rate and the decimation that gives the sample rate
+    virtual void set_rates(const double tick_rate, const size_t decim) = 0;
+
+    virtual void set_nsamps_per_packet(const size_t nsamps) = 0;
+
+    virtual void issue_stream_command(const uhd::stream_cmd_t &stream_cmd) = 0;
+};
+
+/*!
+ * The send transport of a simulated tx dsp:
+ * Consumes vrt frames from a sample fifo that drains at the sample rate,
+ * and reports the burst acks, underflows, and errors as async messages.
+ * A get of a send buffer blocks while the fifo is full (the flow control).
+ */
+class sim_send_sink : public uhd::transport::zero_copy_if{
+public:
+    typedef boost::shared_ptr<sim_send_sink> sptr;
+    typedef boost::function<void(const uhd::async_metadata_t &)> async_handler_type;
+
+    /*!
+     * Make a new simulated send transport.
+     * \param clock the device clock that times the bursts
+     * \param async_handler called with each async message
+     * \param hints the pacing, fifo, and frame options
+     */
+    static sptr make(
+        sim_clock::sptr clock, const async_handler_type &async_handler,
+        const uhd::device_addr_t &hints
+    );
+
+    //! Set the tick rate and the interpolation that gives the sample rate
+    virtual void set_rates(const double tick_rate, const size_t interp) = 0;
+};
+
+#endif /* INCLUDED_LIBUHD_USRP_SIM_ZERO_COPY_HPP */
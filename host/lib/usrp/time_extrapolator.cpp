@@ -0,0 +1,118 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/usrp/time_extrapolator.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <cmath>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+//! the number of samples in the drift window
+static const size_t MAX_NUM_SAMPLES = 16;
+
+//! the drift bound before there are two samples to measure it (100 ppm)
+static const double DEFAULT_DRIFT_BOUND = 100e-6;
+
+/***********************************************************************
+ * Time extrapolator implementation
+ **********************************************************************/
+class time_extrapolator_impl : public time_extrapolator{
+public:
+    time_extrapolator_impl(const time_fcn_t &device_time, const time_fcn_t &host_time):
+        _device_time(device_time), _host_time(host_time), _resample_period(1.0)
+    {
+        /* NOP */
+    }
+
+    void set_resample_period(double period){
+        if (period <= 0) throw uhd::value_error("time extrapolator: resample period must be positive");
+        boost::mutex::scoped_lock lock(_mutex);
+        _resample_period = period;
+    }
+
+    void reset(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        _samples.clear();
+    }
+
+    time_spec_t sample(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        return this->take_sample();
+    }
+
+    time_spec_t get_time_now(double &uncertainty){
+        boost::mutex::scoped_lock lock(_mutex);
+
+        time_spec_t host_now = _host_time();
+        if (_samples.empty() or (host_now - _samples.back().host).get_real_secs() > _resample_period){
+            this->take_sample();
+            host_now = _host_time();
+        }
+
+        const sample_type &newest = _samples.back();
+        const sample_type &oldest = _samples.front();
+        const double elapsed = (host_now - newest.host).get_real_secs();
+
+        //the device ticks per host tick and how well the samples pin it down
+        double ratio = 1.0, drift_bound = DEFAULT_DRIFT_BOUND;
+        const double span = (newest.host - oldest.host).get_real_secs();
+        if (_samples.size() >= 2 and span > 0){
+            ratio = (newest.device - oldest.device).get_real_secs()/span;
+            drift_bound = (oldest.half_rtt + newest.half_rtt)/span;
+        }
+
+        uncertainty = newest.half_rtt + std::abs(elapsed)*drift_bound;
+        return newest.device + time_spec_t(elapsed*ratio);
+    }
+
+private:
+    struct sample_type{
+        time_spec_t host; //midpoint of the host reads
+        time_spec_t device;
+        double half_rtt;
+    };
+
+    time_spec_t take_sample(void){
+        sample_type s;
+        const time_spec_t host_before = _host_time();
+        s.device = _device_time();
+        const time_spec_t host_after = _host_time();
+        s.half_rtt = (host_after - host_before).get_real_secs()/2;
+        s.host = host_before + time_spec_t(s.half_rtt);
+
+        _samples.push_back(s);
+        if (_samples.size() > MAX_NUM_SAMPLES) _samples.pop_front();
+        return s.device;
+    }
+
+    const time_fcn_t _device_time, _host_time;
+    double _resample_period;
+    std::deque<sample_type> _samples;
+    boost::mutex _mutex;
+};
+
+/***********************************************************************
+ * Time extrapolator factory function
+ **********************************************************************/
+time_extrapolator::sptr time_extrapolator::make(
+    const time_fcn_t &device_time, const time_fcn_t &host_time
+){
+    return sptr(new time_extrapolator_impl(device_time, host_time));
+}
@@ -0,0 +1,186 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/usrp/tx_burst_scheduler.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+static const double MAX_WAIT = 0.1; //seconds, bounds the time to see a change of the device time
+
+/***********************************************************************
+ * The scheduler:
+ *  - the queue is a heap of the bursts, earliest first
+ *  - the sending thread waits for the earliest burst's turn,
+ *    or for an earlier burst to be queued, then sends it
+ **********************************************************************/
+class tx_burst_scheduler_impl : public tx_burst_scheduler{
+public:
+    tx_burst_scheduler_impl(
+        const std::vector<tx_streamer::sptr> &streams,
+        const time_fcn_type &time_fcn,
+        const double lead_time,
+        const std::vector<size_t> &cpus,
+        const thread_sched_t &sched
+    ):
+        _streams(streams), _time_fcn(time_fcn), _lead_time(lead_time),
+        _num_queued(0), _has_margin(false)
+    {
+        if (streams.empty()) throw uhd::value_error("tx burst scheduler needs at least one stream");
+        if (lead_time < 0.0) throw uhd::value_error("tx burst scheduler needs a lead time of zero or more");
+        _task = task::make(boost::bind(&tx_burst_scheduler_impl::send_loop, this), cpus, sched);
+        _task->set_name("tx burst scheduler");
+    }
+
+    ~tx_burst_scheduler_impl(void){
+        _task.reset(); //stop the thread before the queue goes away
+        while (not _queue.empty()){
+            release(_queue.top().burst, false);
+            _queue.pop();
+        }
+    }
+
+    void enqueue(const burst_t &burst){
+        if (burst.stream >= _streams.size()) throw uhd::index_error(str(boost::format(
+            "tx burst scheduler: stream %u is not in the %u streams"
+        ) % burst.stream % _streams.size()));
+        boost::mutex::scoped_lock lock(_mutex);
+        const bool earliest = _queue.empty() or burst.time < _queue.top().burst.time;
+        _queue.push(entry_t(burst, _num_queued++));
+        lock.unlock();
+        if (earliest) _cond.notify_one();
+    }
+
+    stats_t get_stats(void) const{
+        boost::mutex::scoped_lock lock(_mutex);
+        stats_t stats = _stats;
+        stats.num_queued = _queue.size();
+        return stats;
+    }
+
+    thread_sched_t get_sched(void) const{
+        return _task->get_sched();
+    }
+
+private:
+    struct entry_t{
+        entry_t(const burst_t &burst, const size_t seq): burst(burst), seq(seq){}
+        burst_t burst;
+        size_t seq; //keeps the order of the bursts of the same time
+    };
+
+    //! The heap order: the top is the earliest burst, the first queued of a time
+    struct entry_later{
+        bool operator()(const entry_t &a, const entry_t &b) const{
+            if (a.burst.time != b.burst.time) return b.burst.time < a.burst.time;
+            return a.seq > b.seq;
+        }
+    };
+
+    static void release(const burst_t &burst, const bool sent){
+        if (burst.release) burst.release(sent);
+    }
+
+    void send_loop(void){
+        //the time of the earliest burst, waiting for one when empty
+        time_spec_t next_time;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while (_queue.empty()) _cond.wait(lock);
+            next_time = _queue.top().burst.time;
+        }
+
+        //wait for its turn, unless an earlier burst is queued meanwhile
+        const time_spec_t now = _time_fcn();
+        const time_spec_t host_now = time_spec_t::get_system_time();
+        const double wait = (next_time - now).get_real_secs() - _lead_time;
+        boost::mutex::scoped_lock lock(_mutex);
+        if (wait > 0.0){
+            if (_queue.top().burst.time == next_time) _cond.timed_wait(lock,
+                boost::get_system_time() + boost::posix_time::microseconds(long(std::min(wait, MAX_WAIT)*1e6))
+            );
+            return;
+        }
+        const burst_t burst = _queue.top().burst;
+        _queue.pop();
+
+        //a burst whose time has passed is dropped
+        if (burst.time < now){
+            _stats.num_late++;
+            _stats.max_lateness = std::max(_stats.max_lateness, (now - burst.time).get_real_secs());
+            lock.unlock();
+            release(burst, false);
+            return;
+        }
+        lock.unlock();
+
+        tx_metadata_t metadata;
+        metadata.start_of_burst = true;
+        metadata.end_of_burst = true;
+        metadata.has_time_spec = true;
+        metadata.time_spec = burst.time;
+        const size_t num_sent = _streams[burst.stream]->send(
+            burst.buffs, burst.nsamps, metadata, _lead_time + MAX_WAIT
+        );
+
+        //the margin is what was left of the device time, by the host clock
+        const double margin = (burst.time - now).get_real_secs()
+            - (time_spec_t::get_system_time() - host_now).get_real_secs();
+        lock.lock();
+        if (num_sent == burst.nsamps) _stats.num_sent++;
+        else _stats.num_short++;
+        _stats.min_margin = _has_margin? std::min(_stats.min_margin, margin) : margin;
+        _has_margin = true;
+        lock.unlock();
+        release(burst, num_sent == burst.nsamps);
+    }
+
+    const std::vector<tx_streamer::sptr> _streams;
+    const time_fcn_type _time_fcn;
+    const double _lead_time;
+    mutable boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::priority_queue<entry_t, std::vector<entry_t>, entry_later> _queue;
+    size_t _num_queued;
+    stats_t _stats;
+    bool _has_margin;
+    task::sptr _task;
+};
+
+/***********************************************************************
+ * The make function
+ **********************************************************************/
+tx_burst_scheduler::sptr tx_burst_scheduler::make(
+    const std::vector<tx_streamer::sptr> &streams,
+    const time_fcn_type &time_fcn,
+    double lead_time,
+    const std::vector<size_t> &cpus,
+    const thread_sched_t &sched
+){
+    return sptr(new tx_burst_scheduler_impl(streams, time_fcn, lead_time, cpus, sched));
+}
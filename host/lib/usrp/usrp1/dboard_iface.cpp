@@ -89,6 +89,11 @@ public:
                    boost::uint32_t data,
                    size_t num_bits);
 
+    void write_spi_batch(unit_t unit,
+                         const spi_config_t &config,
+                         const std::vector<boost::uint32_t> &data,
+                         size_t num_bits);
+
     boost::uint32_t read_write_spi(unit_t unit,
                                    const spi_config_t &config,
                                    boost::uint32_t data,
@@ -340,6 +345,15 @@ void usrp1_dboard_iface::write_spi(unit_t unit,
                          config, data, num_bits);
 }
 
+void usrp1_dboard_iface::write_spi_batch(unit_t unit,
+                                         const spi_config_t &config,
+                                         const std::vector<boost::uint32_t> &data,
+                                         size_t num_bits)
+{
+    _iface->write_spi_batch(unit_to_otw_spi_dev(unit, _dboard_slot),
+                            config, data, num_bits);
+}
+
 boost::uint32_t usrp1_dboard_iface::read_write_spi(unit_t unit,
                                                    const spi_config_t &config,
                                                    boost::uint32_t data,
@@ -16,23 +16,25 @@
 //
 
 #include "validate_subdev_spec.hpp"
-#define SRPH_DONT_CHECK_SEQUENCE
-#include "../../transport/super_recv_packet_handler.hpp"
-#define SSPH_DONT_PAD_TO_ONE
-#include "../../transport/super_send_packet_handler.hpp"
+#include "../../transport/raw_recv_stream_handler.hpp"
+#include "../../transport/raw_send_stream_handler.hpp"
+#include "../../transport/stream_event_counters.hpp"
 #include "usrp1_calc_mux.hpp"
 #include "fpga_regs_standard.h"
 #include "usrp_commands.h"
 #include "usrp1_impl.hpp"
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/tasks.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/algorithm.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
 #include <boost/math/special_functions/sign.hpp>
 #include <boost/math/special_functions/round.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/bind.hpp>
 #include <boost/format.hpp>
+#include <cmath>
 
 using namespace uhd;
 using namespace uhd::usrp;
@@ -40,185 +42,37 @@ using namespace uhd::transport;
 
 static const size_t alignment_padding = 512;
 
-/***********************************************************************
- * Helper struct to associate an offset with a buffer
- **********************************************************************/
-struct offset_send_buffer{
-    offset_send_buffer(void){
-        /* NOP */
-    }
-
-    offset_send_buffer(managed_send_buffer::sptr buff, size_t offset = 0):
-        buff(buff), offset(offset)
-    {
-        /* NOP */
-    }
-
-    //member variables
-    managed_send_buffer::sptr buff;
-    size_t offset; /* in bytes */
-};
-
-/***********************************************************************
- * Reusable managed send buffer to handle aligned commits
- **********************************************************************/
-class offset_managed_send_buffer : public managed_send_buffer{
-public:
-    typedef boost::function<void(offset_send_buffer&, offset_send_buffer&, size_t)> commit_cb_type;
-    offset_managed_send_buffer(const commit_cb_type &commit_cb):
-        _commit_cb(commit_cb)
-    {
-        /* NOP */
-    }
-
-    void commit(size_t size){
-        if (size != 0) this->_commit_cb(_curr_buff, _next_buff, size);
-    }
-
-    sptr get_new(
-        offset_send_buffer &curr_buff,
-        offset_send_buffer &next_buff
-    ){
-        _curr_buff = curr_buff;
-        _next_buff = next_buff;
-        return make_managed_buffer(this);
-    }
-
-private:
-    void  *get_buff(void) const{return _curr_buff.buff->cast<char *>() + _curr_buff.offset;}
-    size_t get_size(void) const{return _curr_buff.buff->size()         - _curr_buff.offset;}
-
-    offset_send_buffer _curr_buff, _next_buff;
-    commit_cb_type _commit_cb;
-};
-
-/***********************************************************************
- * BS VRT packer/unpacker functions (since samples don't have headers)
- **********************************************************************/
-static void usrp1_bs_vrt_packer(
-    boost::uint32_t *,
-    vrt::if_packet_info_t &if_packet_info
-){
-    if_packet_info.num_header_words32 = 0;
-    if_packet_info.num_packet_words32 = if_packet_info.num_payload_words32;
-}
-
-static void usrp1_bs_vrt_unpacker(
-    const boost::uint32_t *,
-    vrt::if_packet_info_t &if_packet_info
-){
-    if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
-    if_packet_info.num_payload_words32 = if_packet_info.num_packet_words32;
-    if_packet_info.num_header_words32 = 0;
-    if_packet_info.packet_count = 0;
-    if_packet_info.sob = false;
-    if_packet_info.eob = false;
-    if_packet_info.has_sid = false;
-    if_packet_info.has_cid = false;
-    if_packet_info.has_tsi = false;
-    if_packet_info.has_tsf = false;
-    if_packet_info.has_tlr = false;
-}
-
 /***********************************************************************
  * IO Implementation Details
  **********************************************************************/
 struct usrp1_impl::io_impl{
     io_impl(zero_copy_if::sptr data_transport):
-        data_transport(data_transport),
-        curr_buff(offset_send_buffer(data_transport->get_send_buff())),
-        omsb(boost::bind(&usrp1_impl::io_impl::commit_send_buff, this, _1, _2, _3))
+        data_transport(data_transport)
     {
         /* NOP */
     }
 
     ~io_impl(void){
-        UHD_SAFE_CALL(flush_send_buff();)
+        UHD_SAFE_CALL(send_handler.flush(.1);)
     }
 
     zero_copy_if::sptr data_transport;
 
-    //state management for the vrt packet handler code
-    sph::recv_packet_handler recv_handler;
-    sph::send_packet_handler send_handler;
-
-    //wrapper around the actual send buffer interface
-    //all of this to ensure only aligned lengths are committed
-    //NOTE: you must commit before getting a new buffer
-    //since the vrt packet handler obeys this, we are ok
-    offset_send_buffer curr_buff;
-    offset_managed_send_buffer omsb;
-    void commit_send_buff(offset_send_buffer&, offset_send_buffer&, size_t);
-    void flush_send_buff(void);
-    managed_send_buffer::sptr get_send_buff(double timeout){
-        //try to get a new managed buffer with timeout
-        offset_send_buffer next_buff(data_transport->get_send_buff(timeout));
-        if (not next_buff.buff.get()) return managed_send_buffer::sptr(); /* propagate timeout here */
-
-        //make a new managed buffer with the offset buffs
-        return omsb.get_new(curr_buff, next_buff);
-    }
+    //streaming error events, the status registers are device-wide
+    stream_event_counters::sptr rx_counters, tx_counters;
+
+    //the headerless stream handlers, send commits only aligned lengths
+    sph::raw_recv_stream_handler recv_handler;
+    sph::raw_send_stream_handler send_handler;
 
     task::sptr vandal_task;
     boost::system_time last_send_time;
 };
 
-/*!
- * Perform an actual commit on the send buffer:
- * Copy the remainder of alignment to the next buffer.
- * Commit the current buffer at multiples of alignment.
- */
-void usrp1_impl::io_impl::commit_send_buff(
-    offset_send_buffer &curr,
-    offset_send_buffer &next,
-    size_t num_bytes
-){
-    //total number of bytes now in the current buffer
-    size_t bytes_in_curr_buffer = curr.offset + num_bytes;
-
-    //calculate how many to commit and remainder
-    size_t num_bytes_remaining = bytes_in_curr_buffer % alignment_padding;
-    size_t num_bytes_to_commit = bytes_in_curr_buffer - num_bytes_remaining;
-
-    //copy the remainder into the next buffer
-    std::memcpy(
-        next.buff->cast<char *>() + next.offset,
-        curr.buff->cast<char *>() + num_bytes_to_commit,
-        num_bytes_remaining
-    );
-
-    //update the offset into the next buffer
-    next.offset += num_bytes_remaining;
-
-    //commit the current buffer
-    curr.buff->commit(num_bytes_to_commit);
-
-    //store the next buffer for the next call
-    curr_buff = next;
-}
-
-/*!
- * Flush the current buffer by padding out to alignment and committing.
- */
-void usrp1_impl::io_impl::flush_send_buff(void){
-    //calculate the number of bytes to alignment
-    size_t bytes_to_pad = (-1*curr_buff.offset)%alignment_padding;
-
-    //send at least alignment_padding to guarantee zeros are sent
-    if (bytes_to_pad == 0) bytes_to_pad = alignment_padding;
-
-    //get the buffer, clear, and commit (really current buffer)
-    managed_send_buffer::sptr buff = this->get_send_buff(.1);
-    if (buff.get() != NULL){
-        std::memset(buff->cast<void *>(), 0, bytes_to_pad);
-        buff->commit(bytes_to_pad);
-    }
-}
-
 /***********************************************************************
  * Initialize internals within this file
  **********************************************************************/
-void usrp1_impl::io_init(void){
+void usrp1_impl::io_init(const device_addr_t &device_addr){
     _rx_otw_type.width = 16;
     _rx_otw_type.shift = 0;
     _rx_otw_type.byteorder = otw_type_t::BO_LITTLE_ENDIAN;
@@ -229,21 +83,45 @@ void usrp1_impl::io_init(void){
 
     _io_impl = UHD_PIMPL_MAKE(io_impl, (_data_transport));
 
+    //create the event counters and publish them for every dsp
+    const bool fastpath_chars = device_addr.cast<bool>("fastpath_chars", true);
+    _io_impl->rx_counters = stream_event_counters::make(fastpath_chars);
+    _io_impl->tx_counters = stream_event_counters::make(fastpath_chars);
+    for (size_t dspno = 0; dspno < get_num_ddcs(); dspno++){
+        stream_event_counters::publish(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _io_impl->rx_counters);
+    }
+    for (size_t dspno = 0; dspno < get_num_ducs(); dspno++){
+        stream_event_counters::publish(_tree, str(boost::format("/mboards/0/tx_dsps/%u") % dspno), _io_impl->tx_counters);
+    }
+
+    //the host resamplers, one setting per handler shared by the dsps
+    for (size_t dspno = 0; dspno < get_num_ddcs(); dspno++){
+        publish_resampler(_tree, str(boost::format("/mboards/0/rx_dsps/%u") % dspno), _io_impl->recv_handler);
+    }
+    for (size_t dspno = 0; dspno < get_num_ducs(); dspno++){
+        publish_resampler(_tree, str(boost::format("/mboards/0/tx_dsps/%u") % dspno), _io_impl->send_handler);
+    }
+
+    //the send window may be held in time, recomputed from the rate (device-wide)
+    if (get_num_ducs() > 0) _tree->create<double>("/mboards/0/tx_dsps/0/fc_window_time")
+        .subscribe(boost::bind(&usrp1_impl::set_tx_window_time, this, _1))
+        .set(device_addr.cast<double>("send_window_time", 0.0));
+
     //create a new vandal thread to poll xerflow conditions
     _io_impl->vandal_task = task::make(boost::bind(
         &usrp1_impl::vandal_conquest_loop, this
-    ));
+    ), cpus_from_string(device_addr.get("pirate_cpu", "")),
+        thread_sched_t::from_string(device_addr.get("vandal_sched", ""))
+    );
+    _io_impl->vandal_task->set_name("usrp1 vandal");
 
     //init some handler stuff
-    _io_impl->recv_handler.set_tick_rate(_master_clock_rate);
-    _io_impl->recv_handler.set_vrt_unpacker(&usrp1_bs_vrt_unpacker);
-    _io_impl->recv_handler.set_xport_chan_get_buff(0, boost::bind(
+    _io_impl->recv_handler.set_xport_get_buff(boost::bind(
         &uhd::transport::zero_copy_if::get_recv_buff, _io_impl->data_transport, _1
     ));
-    _io_impl->send_handler.set_tick_rate(_master_clock_rate);
-    _io_impl->send_handler.set_vrt_packer(&usrp1_bs_vrt_packer);
-    _io_impl->send_handler.set_xport_chan_get_buff(0, boost::bind(
-        &usrp1_impl::io_impl::get_send_buff, _io_impl.get(), _1
+    _io_impl->send_handler.set_alignment(alignment_padding);
+    _io_impl->send_handler.set_xport_get_buff(boost::bind(
+        &uhd::transport::zero_copy_if::get_send_buff, _io_impl->data_transport, _1
     ));
 
     //init as disabled, then call the real function (uses restore)
@@ -251,7 +129,7 @@ void usrp1_impl::io_init(void){
     this->enable_tx(false);
     rx_stream_on_off(false);
     tx_stream_on_off(false);
-    _io_impl->flush_send_buff();
+    _io_impl->send_handler.flush(.1);
 }
 
 void usrp1_impl::rx_stream_on_off(bool enb){
@@ -264,12 +142,20 @@ void usrp1_impl::rx_stream_on_off(bool enb){
 
 void usrp1_impl::tx_stream_on_off(bool enb){
     _io_impl->last_send_time = boost::get_system_time();
-    if (_tx_enabled and not enb) _io_impl->flush_send_buff();
+    if (_tx_enabled and not enb) _io_impl->send_handler.flush(.1);
     this->restore_tx(enb);
 }
 
+void usrp1_impl::update_status_push(void){
+    const bool enb = _status_transport.get() != NULL and (_rx_enabled or _tx_enabled);
+    if (enb == _status_push) return;
+    _status_push = enb;
+    _fx2_ctrl->usrp_control_write(VRQ_SET_STATUS_EP, enb? 1 : 0, 0, NULL, 0);
+}
+
 /*!
- * Casually poll the overflow and underflow registers.
+ * Casually poll the overflow and underflow registers,
+ * or wait on the status transport while the firmware pushes them.
  * On an underflow, push an async message into the queue and print.
  * On an overflow, interleave an inline message into recv and print.
  * This procedure creates "soft" inline and async user messages.
@@ -286,6 +172,8 @@ void usrp1_impl::vandal_conquest_loop(void){
     rx_metadata_t inline_metadata;
     inline_metadata.has_time_spec = true;
     inline_metadata.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
+    inline_metadata.num_samps_lost = 0;
+    inline_metadata.has_recv_timestamp = false;
 
     //start the polling loop...
     try{ while (not boost::this_thread::interruption_requested()){
@@ -296,27 +184,40 @@ void usrp1_impl::vandal_conquest_loop(void){
             this->tx_stream_on_off(false);
         }
 
+        //wait for pushed status, the timeout keeps the shutoff check above running
+        if (_status_push){
+            managed_recv_buffer::sptr buff = _status_transport->get_recv_buff(0.05);
+            if (buff.get() != NULL and buff->size() >= STATUS_EP_LEN){
+                underflow = buff->cast<const boost::uint8_t *>()[STATUS_EP_TX_UNDERRUN];
+                overflow = buff->cast<const boost::uint8_t *>()[STATUS_EP_RX_OVERRUN];
+            }
+        }
+
         //always poll regardless of enabled so we can clear the conditions
-        _fx2_ctrl->usrp_control_read(
-            VRQ_GET_STATUS, 0, GS_TX_UNDERRUN, &underflow, sizeof(underflow)
-        );
-        _fx2_ctrl->usrp_control_read(
-            VRQ_GET_STATUS, 0, GS_RX_OVERRUN, &overflow, sizeof(overflow)
-        );
+        else{
+            _fx2_ctrl->usrp_control_read(
+                VRQ_GET_STATUS, 0, GS_TX_UNDERRUN, &underflow, sizeof(underflow)
+            );
+            _fx2_ctrl->usrp_control_read(
+                VRQ_GET_STATUS, 0, GS_RX_OVERRUN, &overflow, sizeof(overflow)
+            );
+        }
 
         //handle message generation for xerflow conditions
         if (_tx_enabled and underflow){
             async_metadata.time_spec = _soft_time_ctrl->get_time();
             _soft_time_ctrl->get_async_queue().push_with_pop_on_full(async_metadata);
-            UHD_MSG(fastpath) << "U";
+            _io_impl->tx_counters->record(stream_event_counters::EVENT_UNDERFLOW);
         }
         if (_rx_enabled and overflow){
             inline_metadata.time_spec = _soft_time_ctrl->get_time();
             _soft_time_ctrl->get_inline_queue().push_with_pop_on_full(inline_metadata);
-            UHD_MSG(fastpath) << "O";
+            _io_impl->rx_counters->record(stream_event_counters::EVENT_OVERFLOW);
         }
 
-        boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+        if (not _status_push){
+            boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+        }
     }}
     catch(const boost::thread_interrupted &){} //normal exit condition
     catch(const std::exception &e){
@@ -374,6 +275,10 @@ void usrp1_impl::update_tx_subdev_spec(const uhd::usrp::subdev_spec_t &spec){
 
     //if the spec changes size, so does the max samples per packet...
     _io_impl->send_handler.set_max_samples_per_packet(get_max_send_samps_per_packet());
+
+    //...and the window in time
+    const property<double> &rate = _tree->access<double>("/mboards/0/tx_dsps/0/rate/value");
+    if (not rate.empty()) this->update_tx_window(rate.get());
 }
 
 double usrp1_impl::update_rx_samp_rate(const double samp_rate){
@@ -388,6 +293,9 @@ double usrp1_impl::update_rx_samp_rate(const double samp_rate){
     this->restore_rx(s);
 
     _io_impl->recv_handler.set_samp_rate(_master_clock_rate / rate);
+    _data_transport->set_recv_rate(
+        _master_clock_rate / rate * _rx_otw_type.get_sample_size() * std::max<size_t>(_rx_subdev_spec.size(), 1)
+    );
     return _master_clock_rate / rate;
 }
 
@@ -403,9 +311,35 @@ double usrp1_impl::update_tx_samp_rate(const double samp_rate){
     this->restore_tx(s);
 
     _io_impl->send_handler.set_samp_rate(_master_clock_rate / rate);
+    _data_transport->set_send_rate(
+        _master_clock_rate / rate * _tx_otw_type.get_sample_size() * std::max<size_t>(_tx_subdev_spec.size(), 1)
+    );
+    //the send frame size may follow the rate, and so does the max samples per packet
+    if (not _tx_subdev_spec.empty()) _io_impl->send_handler.set_max_samples_per_packet(get_max_send_samps_per_packet());
+    this->update_tx_window(_master_clock_rate / rate);
     return _master_clock_rate / rate;
 }
 
+void usrp1_impl::update_tx_window(const double rate){
+    //call with the send handler locked, no other thread may use the send buffers
+    const double window_time = _tree->access<double>("/mboards/0/tx_dsps/0/fc_window_time").get();
+    size_t num_frames = _data_transport->get_num_send_frames();
+    if (window_time > 0.0){
+        const double bytes_per_sec = rate*_tx_otw_type.get_sample_size()*std::max<size_t>(_tx_subdev_spec.size(), 1);
+        num_frames = size_t(uhd::clip<double>(
+            std::ceil(window_time*bytes_per_sec/_data_transport->get_send_frame_size()), 1, num_frames
+        ));
+    }
+    _data_transport->set_send_window(num_frames);
+}
+
+void usrp1_impl::set_tx_window_time(const double){
+    const property<double> &rate = _tree->access<double>("/mboards/0/tx_dsps/0/rate/value");
+    if (rate.empty()) return; //updated again once the rate is set
+    boost::mutex::scoped_lock lock = _io_impl->send_handler.get_scoped_lock();
+    this->update_tx_window(rate.get());
+}
+
 double usrp1_impl::update_rx_dsp_freq(const size_t dspno, const double freq_){
 
     //correct for outside of rate (wrap around)
@@ -442,11 +376,26 @@ bool usrp1_impl::recv_async_msg(
     return _soft_time_ctrl->get_async_queue().pop_with_timed_wait(async_metadata, timeout);
 }
 
+poll_fds_t usrp1_impl::get_async_msg_poll_fds(void){
+    const poll_fds_t fds = _soft_time_ctrl->get_async_queue().get_poll_fds();
+    if (fds.empty()) throw uhd::not_implemented_error("usrp1 async messages cannot be polled on this platform");
+    return fds;
+}
+
+/***********************************************************************
+ * Receive Readiness
+ **********************************************************************/
+poll_fds_t usrp1_impl::get_recv_poll_fds(void){
+    const poll_fds_t fds = _data_transport->get_recv_poll_fds();
+    if (fds.empty()) throw uhd::not_implemented_error("usrp1 receive transport cannot be polled");
+    return fds;
+}
+
 /***********************************************************************
  * Data send + helper functions
  **********************************************************************/
 size_t usrp1_impl::get_max_send_samps_per_packet(void) const {
-    return (_data_transport->get_send_frame_size() - alignment_padding)
+    return _data_transport->get_send_frame_size()
         / _tx_otw_type.get_sample_size()
         / _tx_subdev_spec.size()
     ;
@@ -481,6 +430,35 @@ size_t usrp1_impl::send(
     return num_samps_sent;
 }
 
+size_t usrp1_impl::get_send_view(send_view_t &view, double timeout){
+    return _io_impl->send_handler.get_send_view(view, timeout);
+}
+
+size_t usrp1_impl::commit_send_view(send_view_t &view, size_t nsamps, double timeout){
+    //the soft time control waits for the time spec or drops late frames
+    if (_soft_time_ctrl->send_pre(view.metadata, timeout)){
+        view.release();
+        return 0;
+    }
+
+    this->tx_stream_on_off(true); //always enable (it will do the right thing)
+    const bool end_of_burst = view.metadata.end_of_burst;
+    size_t num_samps_sent = _io_impl->send_handler.commit_send_view(view, nsamps);
+
+    //handle eob flag (commit the buffer, /*disable the DACs*/)
+    if (end_of_burst and num_samps_sent == nsamps){
+        async_metadata_t metadata;
+        metadata.channel = 0;
+        metadata.has_time_spec = true;
+        metadata.time_spec = _soft_time_ctrl->get_time();
+        metadata.event_code = async_metadata_t::EVENT_CODE_BURST_ACK;
+        _soft_time_ctrl->get_async_queue().push_with_pop_on_full(metadata);
+        this->tx_stream_on_off(false);
+    }
+
+    return num_samps_sent;
+}
+
 /***********************************************************************
  * Data recv + helper functions
  **********************************************************************/
@@ -507,3 +485,16 @@ size_t usrp1_impl::recv(
 
     return _soft_time_ctrl->recv_post(metadata, num_samps_recvd);
 }
+
+size_t usrp1_impl::recv_view(recv_view_t &view, double timeout){
+    //interleave a "soft" inline message into the receive stream:
+    view.release();
+    if (_soft_time_ctrl->get_inline_queue().pop_with_haste(view.metadata)) return 0;
+
+    _io_impl->recv_handler.recv_view(view, timeout);
+
+    //the soft time control may clip the view at the end of a burst
+    view.nsamps = _soft_time_ctrl->recv_post(view.metadata, view.nsamps);
+    if (view.nsamps == 0) view.release();
+    return view.nsamps;
+}
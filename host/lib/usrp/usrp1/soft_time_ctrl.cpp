@@ -17,8 +17,9 @@
 
 #include "soft_time_ctrl.hpp"
 #include <uhd/utils/tasks.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <boost/make_shared.hpp>
-#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <iostream>
 
@@ -27,7 +28,9 @@ using namespace uhd::usrp;
 using namespace uhd::transport;
 namespace pt = boost::posix_time;
 
-static const time_spec_t TWIDDLE(0.0011);
+//defaults for the timing knobs, see the usrp1 application notes
+static const double DEFAULT_TWIDDLE = 0.0011; //wake before the requested time
+static const double DEFAULT_SPIN_TIME = 0.0005; //spin over the end of the sleep
 
 /***********************************************************************
  * Soft time control implementation
@@ -35,7 +38,9 @@ static const time_spec_t TWIDDLE(0.0011);
 class soft_time_ctrl_impl : public soft_time_ctrl{
 public:
 
-    soft_time_ctrl_impl(const cb_fcn_type &stream_on_off):
+    soft_time_ctrl_impl(const cb_fcn_type &stream_on_off, const device_addr_t &args):
+        _twiddle(args.cast<double>("soft_time_twiddle", DEFAULT_TWIDDLE)),
+        _spin_time(args.cast<double>("soft_time_spin", DEFAULT_SPIN_TIME)),
         _nsamps_remaining(0),
         _stream_mode(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS),
         _cmd_queue(2),
@@ -44,7 +49,12 @@ public:
         _stream_on_off(stream_on_off)
     {
         //synchronously spawn a new thread
-        _recv_cmd_task = task::make(boost::bind(&soft_time_ctrl_impl::recv_cmd_task, this));
+        _recv_cmd_task = task::make(
+            boost::bind(&soft_time_ctrl_impl::recv_cmd_task, this),
+            cpus_from_string(args.get("pirate_cpu", "")),
+            thread_sched_t::from_string(args.get("soft_time_sched", ""))
+        );
+        _recv_cmd_task->set_name("usrp1 soft time");
 
         //initialize the time to something
         this->set_time(time_spec_t(0.0));
@@ -68,13 +78,27 @@ public:
         return time_spec_t::get_system_time() - _time_offset;
     }
 
+    /*!
+     * Sleep until the time with the lock released.
+     * The scheduler wakes a sleeping thread late by a varying amount,
+     * so sleep until the spin time before the deadline,
+     * then spin on the system time for the rest of the wait.
+     */
     UHD_INLINE void sleep_until_time(
         boost::mutex::scoped_lock &lock, const time_spec_t &time
     ){
-        boost::condition_variable cond;
-        //use a condition variable to unlock, sleep, lock
-        double seconds_to_sleep = (time - time_now()).get_real_secs();
-        cond.timed_wait(lock, pt::microseconds(long(seconds_to_sleep*1e6)));
+        const time_spec_t system_time_at = time + _time_offset;
+        lock.unlock();
+
+        const double seconds_to_sleep = (system_time_at - time_spec_t::get_system_time()).get_real_secs() - _spin_time;
+        if (seconds_to_sleep > 0){
+            boost::this_thread::sleep(pt::microseconds(long(seconds_to_sleep*1e6)));
+        }
+        while (time_spec_t::get_system_time() < system_time_at){
+            /* spin */
+        }
+
+        lock.lock();
     }
 
     /*******************************************************************
@@ -105,6 +129,8 @@ public:
             metadata.has_time_spec = true;
             metadata.time_spec = this->time_now();
             metadata.error_code = rx_metadata_t::ERROR_CODE_BROKEN_CHAIN;
+            metadata.num_samps_lost = 0;
+            metadata.has_recv_timestamp = false;
             _inline_msg_queue.push_with_pop_on_full(metadata);
         } //continue to next case...
         case stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE:
@@ -136,7 +162,7 @@ public:
 
         boost::mutex::scoped_lock lock(_update_mutex);
 
-        time_spec_t time_at(md.time_spec - TWIDDLE);
+        time_spec_t time_at(md.time_spec - _twiddle);
 
         //handle late packets
         if (time_at < time_now()){
@@ -162,12 +188,14 @@ public:
 
         //handle the stream at time by sleeping
         if (not cmd.stream_now){
-            time_spec_t time_at(cmd.time_spec - TWIDDLE);
+            time_spec_t time_at(cmd.time_spec - _twiddle);
             if (time_at < time_now()){
                 rx_metadata_t metadata;
                 metadata.has_time_spec = true;
                 metadata.time_spec = this->time_now();
                 metadata.error_code = rx_metadata_t::ERROR_CODE_LATE_COMMAND;
+                metadata.num_samps_lost = 0;
+                metadata.has_recv_timestamp = false;
                 _inline_msg_queue.push_with_pop_on_full(metadata);
                 this->issue_stream_cmd(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
                 return;
@@ -200,7 +228,7 @@ public:
         recv_cmd_handle_cmd(*cmd);
     }
 
-    bounded_buffer<async_metadata_t> &get_async_queue(void){
+    pollable_bounded_buffer<async_metadata_t> &get_async_queue(void){
         return _async_msg_queue;
     }
 
@@ -209,12 +237,14 @@ public:
     }
 
 private:
+    const time_spec_t _twiddle;
+    const double _spin_time;
     boost::mutex _update_mutex;
     size_t _nsamps_remaining;
     stream_cmd_t::stream_mode_t _stream_mode;
     time_spec_t _time_offset;
     bounded_buffer<boost::shared_ptr<stream_cmd_t> > _cmd_queue;
-    bounded_buffer<async_metadata_t> _async_msg_queue;
+    pollable_bounded_buffer<async_metadata_t> _async_msg_queue;
     bounded_buffer<rx_metadata_t> _inline_msg_queue;
     const cb_fcn_type _stream_on_off;
     task::sptr _recv_cmd_task;
@@ -223,6 +253,6 @@ private:
 /***********************************************************************
  * Soft time control factor
  **********************************************************************/
-soft_time_ctrl::sptr soft_time_ctrl::make(const cb_fcn_type &stream_on_off){
-    return sptr(new soft_time_ctrl_impl(stream_on_off));
+soft_time_ctrl::sptr soft_time_ctrl::make(const cb_fcn_type &stream_on_off, const device_addr_t &args){
+    return sptr(new soft_time_ctrl_impl(stream_on_off, args));
 }
@@ -21,7 +21,9 @@
 #include <uhd/types/stream_cmd.hpp>
 #include <uhd/types/time_spec.hpp>
 #include <uhd/types/metadata.hpp>
+#include <uhd/types/device_addr.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
+#include "../../transport/pollable_event.hpp"
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
@@ -42,10 +44,12 @@ public:
 
     /*!
      * Make a new soft time control.
+     * The args may set soft_time_twiddle and soft_time_spin in seconds.
      * \param stream_on_off a function to enable/disable rx
+     * \param args the device args with the timing knobs
      * \return a new soft time control object
      */
-    static sptr make(const cb_fcn_type &stream_on_off);
+    static sptr make(const cb_fcn_type &stream_on_off, const device_addr_t &args);
 
     //! Set the current time
     virtual void set_time(const time_spec_t &time) = 0;
@@ -63,7 +67,7 @@ public:
     virtual void issue_stream_cmd(const stream_cmd_t &cmd) = 0;
 
     //! Get access to a buffer of async metadata
-    virtual transport::bounded_buffer<async_metadata_t> &get_async_queue(void) = 0;
+    virtual transport::pollable_bounded_buffer<async_metadata_t> &get_async_queue(void) = 0;
 
     //! Get access to a buffer of inline metadata
     virtual transport::bounded_buffer<rx_metadata_t> &get_inline_queue(void) = 0;
@@ -18,29 +18,82 @@
 #include "usrp1_iface.hpp"
 #include "usrp_commands.h"
 #include <uhd/utils/log.hpp>
+#include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
 #include <boost/format.hpp>
 #include <stdexcept>
 #include <iomanip>
+#include <cstring>
+#include <vector>
+#include <deque>
 
 using namespace uhd;
 using namespace uhd::usrp;
 using namespace uhd::transport;
 
+static const size_t FX2_EP0_PACKET_SIZE = 64;
+static const size_t max_batch_bytes = 4*FX2_EP0_PACKET_SIZE;
+static const size_t max_queued_writes = 256;
+
+/*!
+ * A queued SPI write:
+ * the fields of a VRQ_SPI_WRITE or a VRQ_SPI_WRITE_BATCH record.
+ */
+struct spi_write_t{
+    boost::uint8_t enables, format;
+    boost::uint8_t header_hi, header_lo;
+    boost::uint8_t len;
+    unsigned char data[4];
+};
+
 class usrp1_iface_impl : public usrp1_iface{
 public:
     /*******************************************************************
      * Structors
      ******************************************************************/
-    usrp1_iface_impl(uhd::usrp::fx2_ctrl::sptr ctrl_transport)
+    usrp1_iface_impl(uhd::usrp::fx2_ctrl::sptr ctrl_transport):
+        _batch_probed(false), _has_batch(false), _batch_seq(0), _in_flight(false)
     {
         _ctrl_transport = ctrl_transport;
     }
 
     ~usrp1_iface_impl(void)
     {
-        /* NOP */
+        UHD_SAFE_CALL(this->flush_ctrl();)
+        _submit_task.reset(); //stops the submit thread
+    }
+
+    /*******************************************************************
+     * Async control writes
+     ******************************************************************/
+    void set_ctrl_async(bool enb)
+    {
+        if (not enb){
+            this->flush_ctrl();
+            _submit_task.reset();
+            return;
+        }
+        if (_submit_task.get() != NULL) return;
+
+        if (not this->has_batch()) UHD_MSG(warning)
+            << "USRP1: the firmware does not support batched control writes," << std::endl
+            << "async writes are sent one request at a time." << std::endl
+        ;
+        _submit_task = task::make(boost::bind(&usrp1_iface_impl::submit_task, this));
+        _submit_task->set_name("usrp1 ctrl submit");
+    }
+
+    void flush_ctrl(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        while (not _queue.empty() or _in_flight) _cond.wait(lock);
+        this->check_async_error();
     }
 
     /*******************************************************************
@@ -56,17 +109,15 @@ public:
             << std::hex << std::setw(8) << value << ")" << std::endl
         ;
 
-        boost::uint8_t w_index_h = SPI_ENABLE_FPGA & 0xff;
-        boost::uint8_t w_index_l = (SPI_FMT_MSB | SPI_FMT_HDR_1) & 0xff;
-
-        int ret =_ctrl_transport->usrp_control_write(
-                                          VRQ_SPI_WRITE,
-                                          addr & 0x7f,
-                                          (w_index_h << 8) | (w_index_l << 0),
-                                          (unsigned char*) &swapped,
-                                          sizeof(boost::uint32_t));
+        spi_write_t write;
+        write.enables = SPI_ENABLE_FPGA & 0xff;
+        write.format = (SPI_FMT_MSB | SPI_FMT_HDR_1) & 0xff;
+        write.header_hi = 0;
+        write.header_lo = addr & 0x7f;
+        write.len = sizeof(boost::uint32_t);
+        std::memcpy(write.data, &swapped, sizeof(boost::uint32_t));
 
-        if (ret < 0) throw uhd::io_error("USRP1: failed control write");
+        this->spi_write(write);
     }
 
     boost::uint32_t peek32(boost::uint32_t addr)
@@ -76,6 +127,8 @@ public:
             << std::dec << std::setw(2) << addr << ")" << std::endl
         ;
 
+        this->flush_ctrl();
+
         boost::uint32_t value_out;
 
         boost::uint8_t w_index_h = SPI_ENABLE_FPGA & 0xff;
@@ -106,10 +159,12 @@ public:
      * I2C
      ******************************************************************/
     void write_i2c(boost::uint8_t addr, const byte_vector_t &bytes){
+        this->flush_ctrl();
         return _ctrl_transport->write_i2c(addr, bytes);
     }
 
     byte_vector_t read_i2c(boost::uint8_t addr, size_t num_bytes){
+        this->flush_ctrl();
         return _ctrl_transport->read_i2c(addr, num_bytes);
     }
 
@@ -141,6 +196,7 @@ public:
         size_t num_bytes = num_bits / 8;
 
         if (readback) {
+            this->flush_ctrl();
             unsigned char buff[4] = {
                 (bits >> 0) & 0xff, (bits >> 8) & 0xff,
                 (bits >> 16) & 0xff, (bits >> 24) & 0xff
@@ -172,28 +228,200 @@ public:
             return val; 
         }
         else {
-            // Byteswap on num_bytes
-            unsigned char buff[4] = { 0 };
-            for (size_t i = 1; i <= num_bytes; i++)
-                buff[num_bytes - i] = (bits >> ((i - 1) * 8)) & 0xff;
-
-            boost::uint8_t w_index_h = which_slave & 0xff;
-            boost::uint8_t w_index_l = (SPI_FMT_MSB | SPI_FMT_HDR_0) & 0xff;
-
-            int ret =_ctrl_transport->usrp_control_write(
-                                          VRQ_SPI_WRITE,
-                                          0x00,
-                                          (w_index_h << 8) | (w_index_l << 0),
-                                          buff, num_bytes);
+            this->spi_write(make_spi_write(which_slave, bits, num_bits));
+            return 0;
+        }
+    }
 
-            if (ret < 0) throw uhd::io_error("USRP1: failed SPI transaction");
+    void write_spi_batch(int which_slave,
+                         const spi_config_t &,
+                         const std::vector<boost::uint32_t> &data,
+                         size_t num_bits)
+    {
+        std::vector<spi_write_t> writes;
+        for (size_t i = 0; i < data.size(); i++){
+            writes.push_back(make_spi_write(which_slave, data[i], num_bits));
+        }
 
-            return 0;
+        //async mode: queue the writes together so they share requests
+        if (_submit_task.get() != NULL){
+            boost::mutex::scoped_lock lock(_mutex);
+            this->check_async_error();
+            for (size_t i = 0; i < writes.size(); i++){
+                while (_queue.size() >= max_queued_writes) _cond.wait(lock);
+                _queue.push_back(writes[i]);
+                _cond.notify_all();
+            }
+            return;
         }
+
+        const std::string error = this->send_spi_writes(writes);
+        if (not error.empty()) throw uhd::io_error(error);
     }
 
 private:
     uhd::usrp::fx2_ctrl::sptr _ctrl_transport;
+
+    //! Make a non-readback SPI write, the bits go out MSB first
+    static spi_write_t make_spi_write(int which_slave, boost::uint32_t bits, size_t num_bits)
+    {
+        UHD_ASSERT_THROW((num_bits <= 32) && !(num_bits % 8));
+        const size_t num_bytes = num_bits / 8;
+
+        spi_write_t write;
+        write.enables = which_slave & 0xff;
+        write.format = (SPI_FMT_MSB | SPI_FMT_HDR_0) & 0xff;
+        write.header_hi = 0;
+        write.header_lo = 0;
+        write.len = num_bytes;
+
+        // Byteswap on num_bytes
+        for (size_t i = 1; i <= num_bytes; i++)
+            write.data[num_bytes - i] = (bits >> ((i - 1) * 8)) & 0xff;
+
+        return write;
+    }
+
+    //! Does the firmware take batched writes? Probed on the first call.
+    bool has_batch(void)
+    {
+        if (_batch_probed) return _has_batch;
+        //an empty batch probes the firmware, older firmware stalls the request
+        _has_batch = _ctrl_transport->usrp_control_write(
+            VRQ_SPI_WRITE_BATCH, 0, 0, NULL, 0
+        ) >= 0;
+        _batch_probed = true;
+        return _has_batch;
+    }
+
+    /*******************************************************************
+     * SPI writes: sent now in sync mode, queued in async mode
+     ******************************************************************/
+    void spi_write(const spi_write_t &write)
+    {
+        if (_submit_task.get() == NULL){
+            if (not this->send_spi_write(write))
+                throw uhd::io_error("USRP1: failed SPI write");
+            return;
+        }
+
+        boost::mutex::scoped_lock lock(_mutex);
+        this->check_async_error();
+        while (_queue.size() >= max_queued_writes) _cond.wait(lock);
+        _queue.push_back(write);
+        _cond.notify_all();
+    }
+
+    bool send_spi_write(const spi_write_t &write)
+    {
+        return _ctrl_transport->usrp_control_write(
+            VRQ_SPI_WRITE,
+            (write.header_hi << 8) | (write.header_lo << 0),
+            (write.enables << 8) | (write.format << 0),
+            const_cast<unsigned char *>(write.data), write.len
+        ) >= 0;
+    }
+
+    //! Pack the writes into records, no record spans an EP0 packet
+    size_t pack_batch(const std::vector<spi_write_t> &writes, std::vector<unsigned char> &batch)
+    {
+        batch.clear();
+        size_t num_packed = 0;
+        for (; num_packed < writes.size(); num_packed++){
+            const spi_write_t &write = writes[num_packed];
+            const size_t record_len = SPI_BATCH_HDR_LEN + write.len;
+            const size_t packet_room = FX2_EP0_PACKET_SIZE - batch.size() % FX2_EP0_PACKET_SIZE;
+            const size_t pad_len = (record_len > packet_room)? packet_room : 0;
+            if (batch.size() + pad_len + record_len > max_batch_bytes) break;
+
+            batch.resize(batch.size() + pad_len, 0); //zero len ends the packet
+            batch.push_back(write.len);
+            batch.push_back(write.enables);
+            batch.push_back(write.format);
+            batch.push_back(write.header_hi);
+            batch.push_back(write.header_lo);
+            batch.insert(batch.end(), write.data, write.data + write.len);
+        }
+        return num_packed;
+    }
+
+    /*******************************************************************
+     * Submit task: drains the queue one request at a time.
+     * Writes queued during a request go out together in the next one.
+     ******************************************************************/
+    void submit_task(void)
+    {
+        std::vector<spi_write_t> writes;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while (_queue.empty()) _cond.wait(lock); //interruptible
+            writes.assign(_queue.begin(), _queue.end());
+            _in_flight = true;
+        }
+
+        std::string error;
+        try{
+            error = this->send_spi_writes(writes);
+        }
+        catch(const std::exception &e){
+            error = e.what();
+        }
+
+        boost::mutex::scoped_lock lock(_mutex);
+        _queue.erase(_queue.begin(), _queue.begin() + writes.size());
+        if (not error.empty() and _async_error.empty()) _async_error = error;
+        _in_flight = false;
+        _cond.notify_all();
+    }
+
+    //! Send the writes in order, as few requests as possible
+    std::string send_spi_writes(const std::vector<spi_write_t> &writes)
+    {
+        size_t num_sent = 0;
+        while (num_sent < writes.size()){
+            if (this->has_batch()){
+                std::vector<spi_write_t> rest(writes.begin() + num_sent, writes.end());
+                num_sent += this->pack_batch(rest, _batch);
+                const boost::uint16_t seq = ++_batch_seq;
+                if (_ctrl_transport->usrp_control_write(
+                    VRQ_SPI_WRITE_BATCH, seq, 0, &_batch.front(), _batch.size()
+                ) < 0) return str(boost::format(
+                    "USRP1: failed SPI write batch %u (last applied batch %u)"
+                ) % seq % this->get_batch_seq());
+            }
+            else{
+                if (not this->send_spi_write(writes[num_sent++]))
+                    return "USRP1: failed SPI write";
+            }
+        }
+        return "";
+    }
+
+    unsigned get_batch_seq(void)
+    {
+        unsigned char buff[2] = {0, 0};
+        _ctrl_transport->usrp_control_read(VRQ_GET_BATCH_SEQ, 0, 0, buff, sizeof(buff));
+        return (unsigned(buff[1]) << 8) | (unsigned(buff[0]) << 0);
+    }
+
+    //! Throw the first async error since the last check, the lock must be held
+    void check_async_error(void)
+    {
+        if (_async_error.empty()) return;
+        const std::string error = _async_error;
+        _async_error.clear();
+        throw uhd::io_error(error);
+    }
+
+    bool _batch_probed, _has_batch;
+    boost::uint16_t _batch_seq;
+    std::vector<unsigned char> _batch;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::deque<spi_write_t> _queue;
+    bool _in_flight;
+    std::string _async_error;
+    task::sptr _submit_task;
 };
 
 /***********************************************************************
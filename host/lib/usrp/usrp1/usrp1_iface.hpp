@@ -23,6 +23,8 @@
 #include <uhd/types/serial.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
+#include <boost/cstdint.hpp>
+#include <vector>
 
 /*!
  * The usrp1 interface class:
@@ -39,6 +41,39 @@ public:
      * \return a new usrp1 interface object
      */
     static sptr make(uhd::usrp::fx2_ctrl::sptr ctrl_transport);
+
+    /*!
+     * Enable or disable async control writes.
+     * In async mode, poke32 and non-readback SPI writes return
+     * once queued and a submit thread sends them in the background.
+     * Writes queued while a request is in flight are batched
+     * into one vendor request when the firmware supports it.
+     * Reads and I2C transactions flush the queue first.
+     * \param enb true to enable async mode
+     */
+    virtual void set_ctrl_async(bool enb) = 0;
+
+    /*!
+     * Wait until all queued async writes have been sent.
+     * Throws if a queued write has failed since the last flush.
+     */
+    virtual void flush_ctrl(void) = 0;
+
+    /*!
+     * Write a sequence of non-readback SPI words to one slave.
+     * The words are packed into batch requests when the firmware
+     * supports it, otherwise they are sent one request per word.
+     * \param which_slave the slave device enables
+     * \param config spi config args
+     * \param data the words to write, in order
+     * \param num_bits the number of bits per word
+     */
+    virtual void write_spi_batch(
+        int which_slave,
+        const uhd::spi_config_t &config,
+        const std::vector<boost::uint32_t> &data,
+        size_t num_bits
+    ) = 0;
 };
 
 #endif /* INCLUDED_USRP1_IFACE_HPP */
@@ -170,9 +170,28 @@ usrp1_impl::usrp1_impl(const device_addr_t &device_addr){
         1, 2,          // OUT interface, endpoint
         device_addr    // param hints
     );
+
+    //probe the firmware for pushed under/over run status on the interrupt endpoint,
+    //older firmware rejects the request and the status is polled instead;
+    //pushing is only turned on while a stream is enabled (see update_status_push)
+    _rx_enabled = _tx_enabled = _status_push = false;
+    if (_fx2_ctrl->usrp_control_write(VRQ_SET_STATUS_EP, 0, 0, NULL, 0) >= 0){
+        device_addr_t status_xport_args;
+        status_xport_args["recv_frame_size"] = boost::lexical_cast<std::string>(STATUS_EP_LEN);
+        status_xport_args["num_recv_frames"] = "4";
+        status_xport_args["send_frame_size"] = boost::lexical_cast<std::string>(STATUS_EP_LEN);
+        status_xport_args["num_send_frames"] = "1"; //never used: there is no OUT endpoint
+        _status_transport = usb_zero_copy::make(
+            handle,
+            0, 1, //interface, endpoint
+            0, 1, //interface, endpoint
+            status_xport_args
+        );
+    }
     _iface = usrp1_iface::make(_fx2_ctrl);
+    if (device_addr.has_key("ctrl_async")) _iface->set_ctrl_async(true);
     _soft_time_ctrl = soft_time_ctrl::make(
-        boost::bind(&usrp1_impl::rx_stream_on_off, this, _1)
+        boost::bind(&usrp1_impl::rx_stream_on_off, this, _1), device_addr
     );
     _dbc["A"]; _dbc["B"]; //ensure that keys exist
 
@@ -344,20 +363,10 @@ usrp1_impl::usrp1_impl(const device_addr_t &device_addr){
         _dbc[db].dboard_manager = dboard_manager::make(
             rx_db_eeprom.id,
             ((gdb_eeprom.id == dboard_id_t::none())? tx_db_eeprom : gdb_eeprom).id,
-            _dbc[db].dboard_iface
+            _dbc[db].dboard_iface,
+            _tree->subtree(mb_path / "dboards" / db),
+            device_addr.has_key("defer_dboard_init")
         );
-        BOOST_FOREACH(const std::string &name, _dbc[db].dboard_manager->get_rx_subdev_names()){
-            dboard_manager::populate_prop_tree_from_subdev(
-                _tree->subtree(mb_path / "dboards" / db/ "rx_frontends" / name),
-                _dbc[db].dboard_manager->get_rx_subdev(name)
-            );
-        }
-        BOOST_FOREACH(const std::string &name, _dbc[db].dboard_manager->get_tx_subdev_names()){
-            dboard_manager::populate_prop_tree_from_subdev(
-                _tree->subtree(mb_path / "dboards" / db/ "tx_frontends" / name),
-                _dbc[db].dboard_manager->get_tx_subdev(name)
-            );
-        }
 
         //init the subdev specs if we have a dboard (wont leave this loop empty)
         if (rx_db_eeprom.id != dboard_id_t::none() or _rx_subdev_spec.empty()){
@@ -369,7 +378,7 @@ usrp1_impl::usrp1_impl(const device_addr_t &device_addr){
     }
 
     //initialize io handling
-    this->io_init();
+    this->io_init(device_addr);
 
     ////////////////////////////////////////////////////////////////////
     // do some post-init tasks
@@ -386,10 +395,13 @@ usrp1_impl::usrp1_impl(const device_addr_t &device_addr){
         _tree->access<subdev_spec_t>(mb_path / "rx_subdev_spec").set(_rx_subdev_spec);
     if (_tree->list(mb_path / "tx_dsps").size() > 0)
         _tree->access<subdev_spec_t>(mb_path / "tx_subdev_spec").set(_tx_subdev_spec);
- 
+
+    //export the counters from a thread, with the telemetry device address keys
+    _telemetry = telemetry_exporter::make(device_addr, _tree);
 }
 
 usrp1_impl::~usrp1_impl(void){
+    _telemetry.reset(); //stop reading the tree first
     UHD_SAFE_CALL(
         this->enable_rx(false);
         this->enable_tx(false);
@@ -397,6 +409,7 @@ usrp1_impl::~usrp1_impl(void){
     _tree.reset(); //resets counts on sptrs held in tree
     _soft_time_ctrl.reset(); //stops cmd task before proceeding
     _io_impl.reset(); //stops vandal before other stuff gets deconstructed
+    _status_transport.reset(); //the disables above turned off the status push
 }
 
 /*!
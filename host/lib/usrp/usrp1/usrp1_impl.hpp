@@ -18,6 +18,7 @@
 #include "usrp1_iface.hpp"
 #include "codec_ctrl.hpp"
 #include "soft_time_ctrl.hpp"
+#include "telemetry.hpp"
 #include <uhd/device.hpp>
 #include <uhd/property_tree.hpp>
 #include <uhd/utils/pimpl.hpp>
@@ -65,6 +66,9 @@ public:
                 size_t, uhd::rx_metadata_t &,
                 const uhd::io_type_t &,
                 recv_mode_t, double);
+    size_t recv_view(recv_view_t &, double);
+    size_t get_send_view(send_view_t &, double);
+    size_t commit_send_view(send_view_t &, size_t, double);
 
     size_t get_max_send_samps_per_packet(void) const;
 
@@ -72,6 +76,10 @@ public:
 
     bool recv_async_msg(uhd::async_metadata_t &, double);
 
+    uhd::transport::poll_fds_t get_recv_poll_fds(void);
+
+    uhd::transport::poll_fds_t get_async_msg_poll_fds(void);
+
 private:
     uhd::property_tree::sptr _tree;
 
@@ -85,6 +93,7 @@ private:
     usrp1_iface::sptr _iface;
     uhd::usrp::soft_time_ctrl::sptr _soft_time_ctrl;
     uhd::transport::usb_zero_copy::sptr _data_transport;
+    uhd::transport::usb_zero_copy::sptr _status_transport; //null when status is polled
     struct db_container_type{
         usrp1_codec_ctrl::sptr codec;
         uhd::usrp::dboard_iface::sptr dboard_iface;
@@ -101,6 +110,8 @@ private:
     void update_tx_subdev_spec(const uhd::usrp::subdev_spec_t &);
     double update_rx_samp_rate(const double);
     double update_tx_samp_rate(const double);
+    void update_tx_window(const double);
+    void set_tx_window_time(const double);
     double update_rx_dsp_freq(const size_t, const double);
     double update_tx_dsp_freq(const size_t, const double);
 
@@ -114,7 +125,7 @@ private:
 
     //handle io stuff
     UHD_PIMPL_DECL(io_impl) _io_impl;
-    void io_init(void);
+    void io_init(const uhd::device_addr_t &);
     void rx_stream_on_off(bool);
     void tx_stream_on_off(bool);
     void handle_overrun(size_t);
@@ -135,13 +146,21 @@ private:
     bool _rx_enabled, _tx_enabled;
     void enable_rx(bool enb){
         _rx_enabled = enb;
+        _iface->flush_ctrl(); //apply the queued writes first
         _fx2_ctrl->usrp_rx_enable(enb);
+        this->update_status_push();
     }
     void enable_tx(bool enb){
         _tx_enabled = enb;
+        _iface->flush_ctrl(); //apply the queued writes first
         _fx2_ctrl->usrp_tx_enable(enb);
+        this->update_status_push();
     }
 
+    //push the status only while a stream is enabled, the vandal polls otherwise
+    bool _status_push;
+    void update_status_push(void);
+
     //conditionally disable and enable rx
     bool disable_rx(void){
         if (_rx_enabled){
@@ -169,6 +188,9 @@ private:
             enable_tx(last);
         }
     }
+
+    //last, so the exporter thread stops before the rest goes away
+    uhd::usrp::telemetry_exporter::sptr _telemetry;
 };
 
 #endif /* INCLUDED_USRP1_IMPL_HPP */
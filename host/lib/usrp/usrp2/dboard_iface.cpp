@@ -24,6 +24,7 @@
 #include <uhd/exception.hpp>
 #include <uhd/utils/algorithm.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
 #include <boost/asio.hpp> //htonl and ntohl
 #include <boost/math/special_functions/round.hpp>
 #include "ad7922_regs.hpp" //aux adc
@@ -35,7 +36,7 @@ using namespace boost::assign;
 
 class usrp2_dboard_iface : public dboard_iface{
 public:
-    usrp2_dboard_iface(usrp2_iface::sptr iface, usrp2_clock_ctrl::sptr clock_ctrl);
+    usrp2_dboard_iface(usrp2_iface::sptr iface, usrp2_clock_ctrl::sptr clock_ctrl, const double gpio_read_period);
     ~usrp2_dboard_iface(void);
 
     special_props_t get_special_props(void){
@@ -54,6 +55,8 @@ public:
     void _set_gpio_out(unit_t, boost::uint16_t);
     void set_gpio_debug(unit_t, int);
     boost::uint16_t read_gpio(unit_t);
+    void begin_gpio_update(void);
+    void commit_gpio_update(void);
 
     void write_i2c(boost::uint8_t, const byte_vector_t &);
     byte_vector_t read_i2c(boost::uint8_t, size_t);
@@ -71,6 +74,13 @@ public:
         size_t num_bits
     );
 
+    void write_spi_batch(
+        unit_t unit,
+        const spi_config_t &config,
+        const std::vector<boost::uint32_t> &data,
+        size_t num_bits
+    );
+
     boost::uint32_t read_write_spi(
         unit_t unit,
         const spi_config_t &config,
@@ -93,21 +103,33 @@ private:
  **********************************************************************/
 dboard_iface::sptr make_usrp2_dboard_iface(
     usrp2_iface::sptr iface,
-    usrp2_clock_ctrl::sptr clock_ctrl
+    usrp2_clock_ctrl::sptr clock_ctrl,
+    const double gpio_read_period
 ){
-    return dboard_iface::sptr(new usrp2_dboard_iface(iface, clock_ctrl));
+    return dboard_iface::sptr(new usrp2_dboard_iface(iface, clock_ctrl, gpio_read_period));
 }
 
 /***********************************************************************
  * Structors
  **********************************************************************/
+//! Write the registers of a gpio commit in one control transaction
+static void poke_gpio_batch(usrp2_iface::sptr iface, const gpio_core_200::pokes_type &pokes){
+    usrp2_iface::ctrl_batch_t batch;
+    for (size_t i = 0; i < pokes.size(); i++){
+        batch.poke32(pokes[i].first, pokes[i].second);
+    }
+    iface->transact_batch(batch);
+}
+
 usrp2_dboard_iface::usrp2_dboard_iface(
     usrp2_iface::sptr iface,
-    usrp2_clock_ctrl::sptr clock_ctrl
+    usrp2_clock_ctrl::sptr clock_ctrl,
+    const double gpio_read_period
 ){
     _iface = iface;
     _clock_ctrl = clock_ctrl;
-    _gpio = gpio_core_200::make(_iface, GPIO_BASE);
+    _gpio = gpio_core_200::make(_iface, GPIO_BASE, boost::bind(&poke_gpio_batch, _iface, _1));
+    _gpio->set_read_period(gpio_read_period);
 
     //reset the aux dacs
     _dac_regs[UNIT_RX] = ad5623_regs_t();
@@ -184,6 +206,14 @@ void usrp2_dboard_iface::_set_atr_reg(unit_t unit, atr_reg_t atr, boost::uint16_
     return _gpio->set_atr_reg(unit, atr, value);
 }
 
+void usrp2_dboard_iface::begin_gpio_update(void){
+    _gpio->begin_update();
+}
+
+void usrp2_dboard_iface::commit_gpio_update(void){
+    _gpio->commit_update();
+}
+
 void usrp2_dboard_iface::set_gpio_debug(unit_t, int){
     throw uhd::not_implemented_error("no set_gpio_debug implemented");
 }
@@ -205,6 +235,19 @@ void usrp2_dboard_iface::write_spi(
     _iface->write_spi(unit_to_spi_dev[unit], config, data, num_bits);
 }
 
+void usrp2_dboard_iface::write_spi_batch(
+    unit_t unit,
+    const spi_config_t &config,
+    const std::vector<boost::uint32_t> &data,
+    size_t num_bits
+){
+    usrp2_iface::ctrl_batch_t batch;
+    for (size_t i = 0; i < data.size(); i++){
+        batch.write_spi(unit_to_spi_dev[unit], config, data[i], num_bits);
+    }
+    _iface->transact_batch(batch);
+}
+
 boost::uint32_t usrp2_dboard_iface::read_write_spi(
     unit_t unit,
     const spi_config_t &config,
@@ -31,7 +31,7 @@ extern "C" {
 
 //fpga and firmware compatibility numbers
 #define USRP2_FPGA_COMPAT_NUM 7
-#define USRP2_FW_COMPAT_NUM 11
+#define USRP2_FW_COMPAT_NUM 16
 #define USRP2_FW_VER_MINOR 0
 
 //used to differentiate control packets over data port
@@ -44,6 +44,7 @@ extern "C" {
 #define USRP2_UDP_RX_DSP0_PORT 49156
 #define USRP2_UDP_TX_DSP0_PORT 49157
 #define USRP2_UDP_RX_DSP1_PORT 49158
+#define USRP2_UDP_TX_DSP1_PORT 49159
 #define USRP2_UDP_UART_BASE_PORT 49170
 #define USRP2_UDP_UART_GPS_PORT 49172
 
@@ -91,6 +92,21 @@ typedef enum{
     USRP2_CTRL_ID_HEY_WRITE_THIS_UART_FOR_ME_BRO = 'u',
     USRP2_CTRL_ID_MAN_I_TOTALLY_WROTE_THAT_UART_DUDE = 'U',
 
+    USRP2_CTRL_ID_DO_ALL_THESE_OPS_BRO = 'o',
+    USRP2_CTRL_ID_DID_ALL_THOSE_OPS_DUDE = 'O',
+
+    USRP2_CTRL_ID_DO_THESE_OPS_LATER_BRO = 't',
+    USRP2_CTRL_ID_OPS_ARE_QUEUED_UP_DUDE = 'T',
+
+    USRP2_CTRL_ID_SET_UP_THESE_FRAMERS_BRO = 'f',
+    USRP2_CTRL_ID_FRAMERS_ARE_SET_UP_DUDE = 'F',
+
+    USRP2_CTRL_ID_QUEUE_THIS_I2C_BRO = 'q',
+    USRP2_CTRL_ID_I2C_IS_QUEUED_DUDE = 'Q',
+
+    USRP2_CTRL_ID_HOWS_MY_I2C_BRO = 'j',
+    USRP2_CTRL_ID_HERES_YOUR_I2C_DUDE = 'J',
+
     USRP2_CTRL_ID_HOLLER_AT_ME_BRO = 'l',
     USRP2_CTRL_ID_HOLLER_BACK_DUDE = 'L',
 
@@ -114,9 +130,33 @@ typedef enum{
     USRP2_REG_ACTION_FPGA_POKE32 = 3,
     USRP2_REG_ACTION_FPGA_POKE16 = 4,
     USRP2_REG_ACTION_FW_PEEK32   = 5,
-    USRP2_REG_ACTION_FW_POKE32   = 6
+    USRP2_REG_ACTION_FW_POKE32   = 6,
+    USRP2_REG_ACTION_SPI_WRITE   = 7, //ops packet only
+    USRP2_REG_ACTION_SPI_READ    = 8  //ops packet only
 } usrp2_reg_action_t;
 
+//max number of framers in one framer setup packet:
+//the framers stream to the source address of the control packet,
+//the reply holds the number of framers programmed (0 without an arp entry)
+#define USRP2_CTRL_MAX_FRAMERS 4
+
+//queued i2c transactions run on the firmware's interrupt driven i2c engine:
+//the queue reply holds a ticket (0 when the queue is full),
+//the host polls the ticket until the transaction is done
+#define USRP2_CTRL_MAX_QUEUED_I2C 4
+#define USRP2_CTRL_MAX_QUEUED_I2C_BYTES 16
+
+typedef enum{
+    USRP2_I2C_FLAG_READ = 1
+} usrp2_i2c_flag_t;
+
+typedef enum{
+    USRP2_I2C_STATUS_PENDING = 'p',
+    USRP2_I2C_STATUS_DONE    = 'd',
+    USRP2_I2C_STATUS_ERROR   = 'e',
+    USRP2_I2C_STATUS_UNKNOWN = 'u' //no such ticket
+} usrp2_i2c_status_t;
+
 typedef struct{
     uint32_t proto_ver;
     uint32_t id;
@@ -136,6 +176,14 @@ typedef struct{
             uint8_t bytes;
             uint8_t data[20];
         } i2c_args;
+        struct {
+            uint32_t ticket;
+            uint8_t addr;
+            uint8_t bytes;
+            uint8_t flags; //usrp2_i2c_flag_t
+            uint8_t status; //usrp2_i2c_status_t, reply only
+            uint8_t data[USRP2_CTRL_MAX_QUEUED_I2C_BYTES];
+        } queued_i2c_args;
         struct {
             uint32_t addr;
             uint32_t data;
@@ -144,9 +192,50 @@ typedef struct{
         struct {
             uint32_t len;
         } echo_args;
+        struct {
+            uint32_t num_ops;
+            uint32_t time_secs; //timed ops only
+            uint32_t time_ticks; //timed ops only
+        } ops_args;
+        struct {
+            uint32_t num_framers; //the number programmed in the reply
+            struct {
+                uint16_t dsp_port; //the device port of the dsp
+                uint16_t host_port; //the host port to send to
+            } framers[USRP2_CTRL_MAX_FRAMERS];
+        } framer_args;
     } data;
 } usrp2_ctrl_data_t;
 
+//max number of operations in one ops packet
+#define USRP2_CTRL_MAX_OPS 32
+
+//max number of timed ops packets the firmware holds at once
+#define USRP2_CTRL_MAX_TIMED_BATCHES 2
+
+typedef struct{
+    uint32_t addr; //register address or spi slave
+    uint32_t data; //data to write, holds the readback in the reply
+    uint8_t action; //usrp2_reg_action_t
+    uint8_t num_bits; //spi only
+    uint8_t miso_edge; //spi only
+    uint8_t mosi_edge; //spi only
+} usrp2_ctrl_op_t;
+
+/*!
+ * The ops packet: a control packet followed by a list of operations.
+ * The firmware executes the ops in order and replies with the same layout,
+ * where the data field of each op holds its readback value.
+ *
+ * The timed ops packet has the same layout plus a time in the ops args.
+ * The firmware queues the ops and executes them once the time is reached.
+ * The reply is a bare control packet; num_ops is 0 when the queue is full.
+ */
+typedef struct{
+    usrp2_ctrl_data_t ctrl; //ctrl.data.ops_args.num_ops ops follow
+    usrp2_ctrl_op_t ops[USRP2_CTRL_MAX_OPS];
+} usrp2_ctrl_ops_data_t;
+
 #ifdef __cplusplus
 }
 #endif
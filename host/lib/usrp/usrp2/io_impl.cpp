@@ -16,8 +16,11 @@
 //
 
 #include "validate_subdev_spec.hpp"
+#include "late_send_policy.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
+#include "../../transport/udp_common.hpp"
+#include "../../transport/async_msg_ring.hpp"
 #include "usrp2_impl.hpp"
 #include "usrp2_regs.hpp"
 #include <uhd/utils/log.hpp>
@@ -26,11 +29,16 @@
 #include <uhd/exception.hpp>
 #include <uhd/utils/byteswap.hpp>
 #include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/trace.hpp>
+#include <uhd/utils/atomic.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/udp_zero_copy.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/format.hpp>
 #include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
 #include <iostream>
 
 using namespace uhd;
@@ -59,6 +67,7 @@ static const size_t vrt_send_header_offset_words32 = 1;
  * flow control monitor for a single tx channel
  *  - the pirate thread calls update
  *  - the get send buffer calls check
+ *  - the sequence counters are atomics, the check spins then blocks
  **********************************************************************/
 class flow_control_monitor{
 public:
@@ -71,9 +80,17 @@ public:
      */
     flow_control_monitor(seq_type max_seqs_out){
         _last_seq_out = 0;
-        _last_seq_ack = 0;
-        _max_seqs_out = max_seqs_out;
-        _ready_fcn = boost::bind(&flow_control_monitor::ready, this);
+        this->set_max_seqs_out(max_seqs_out);
+    }
+
+    /*!
+     * Set the in-flight window of the monitor.
+     * \param max_seqs_out num seqs before throttling
+     */
+    void set_max_seqs_out(const size_t max_seqs_out){
+        if (max_seqs_out == 0) throw uhd::value_error("flow control window must be non-zero");
+        _max_seqs_out.write(seq_type(max_seqs_out));
+        this->notify(); //a larger window may release the waiter
     }
 
     /*!
@@ -91,10 +108,46 @@ public:
      * \return false on timeout
      */
     UHD_INLINE bool check_fc_condition(double timeout){
+        if (timeout <= 0) return this->ready(); //non-blocking, skip the spin and condition
+        for (size_t i = 0; i < SPIN_COUNT; i++){
+            if (this->ready()) return true;
+        }
+        UHD_TRACE_SCOPE("fc_stall");
+        const boost::system_time exit_time = boost::get_system_time() + to_time_dur(timeout);
+        boost::this_thread::disable_interruption di; //disable because the wait can throw
         boost::mutex::scoped_lock lock(_fc_mutex);
-        if (this->ready()) return true;
+        _waiting.write(1);
+        uhd::atomic_full_barrier(); //the flag is published before the check
+        while (not this->ready()){
+            if (not _fc_cond.timed_wait(lock, exit_time)) break;
+        }
+        _waiting.write(0);
+        return this->ready();
+    }
+
+    /*!
+     * Wait for window room to send a number of seqs back to back.
+     * \param num_seqs the number of seqs to send
+     * \param timeout the timeout in seconds
+     * \return false on timeout
+     */
+    bool check_fc_room(const size_t num_seqs, double timeout){
+        if (num_seqs > _max_seqs_out.read()) throw uhd::value_error(str(boost::format(
+            "a preloaded burst of %u packets does not fit in the flow control window of %u packets"
+        ) % num_seqs % _max_seqs_out.read()));
+        if (this->ready(seq_type(num_seqs))) return true;
+        if (timeout <= 0) return false;
+        UHD_TRACE_SCOPE("fc_preload");
+        const boost::system_time exit_time = boost::get_system_time() + to_time_dur(timeout);
         boost::this_thread::disable_interruption di; //disable because the wait can throw
-        return _fc_cond.timed_wait(lock, to_time_dur(timeout), _ready_fcn);
+        boost::mutex::scoped_lock lock(_fc_mutex);
+        _waiting.write(1);
+        uhd::atomic_full_barrier(); //the flag is published before the check
+        while (not this->ready(seq_type(num_seqs))){
+            if (not _fc_cond.timed_wait(lock, exit_time)) break;
+        }
+        _waiting.write(0);
+        return this->ready(seq_type(num_seqs));
     }
 
     /*!
@@ -102,21 +155,34 @@ public:
      * \param seq the last sequence number to be ACK'd
      */
     UHD_INLINE void update_fc_condition(seq_type seq){
-        boost::mutex::scoped_lock lock(_fc_mutex);
-        _last_seq_ack = seq;
-        lock.unlock();
-        _fc_cond.notify_one();
+        _last_seq_ack.write(seq);
+        uhd::atomic_full_barrier(); //the ack is published before the flag is read
+        if (_waiting.read()) this->notify();
     }
 
 private:
-    bool ready(void){
-        return seq_type(_last_seq_out -_last_seq_ack) < _max_seqs_out;
+    //! The number of checks before the sender blocks on the condition
+    static const size_t SPIN_COUNT = 1000;
+
+    bool ready(const seq_type num_seqs = 1){
+        return seq_type(_last_seq_out - _last_seq_ack.read()) + num_seqs <= _max_seqs_out.read();
+    }
+
+    /*!
+     * The waiting flag is written before the sender checks the condition,
+     * and the ack is written before the pirate reads the flag.
+     * A full barrier follows both writes, so either the sender sees the
+     * ack, or the pirate sees the flag and notifies under the lock.
+     */
+    void notify(void){
+        boost::mutex::scoped_lock lock(_fc_mutex);
+        _fc_cond.notify_one();
     }
 
     boost::mutex _fc_mutex;
     boost::condition _fc_cond;
-    seq_type _last_seq_out, _last_seq_ack, _max_seqs_out;
-    boost::function<bool(void)> _ready_fcn;
+    seq_type _last_seq_out; //only touched by the sender
+    uhd::atomic_uint32_t _last_seq_ack, _max_seqs_out, _waiting;
 };
 
 /***********************************************************************
@@ -128,8 +194,8 @@ private:
  **********************************************************************/
 struct usrp2_impl::io_impl{
 
-    io_impl(void):
-        async_msg_fifo(100/*messages deep*/)
+    io_impl(const size_t async_msg_depth):
+        async_msg_fifo(async_msg_depth)
     {
         /* NOP */
     }
@@ -154,18 +220,64 @@ struct usrp2_impl::io_impl{
         return buff;
     }
 
-    //tx dsp: xports and flow control monitors
+    //! Bind a receive transport channel to an rx dsp and its transport
+    void bind_recv_chan(
+        sph::recv_packet_handler &handler, const size_t chan, mb_container_type &mbc,
+        const stream_event_counters::sptr &counters, const size_t dsp
+    ){
+        handler.set_event_counters(chan, counters);
+        if (mbc.rx_resume) handler.set_overflow_handler(chan, &sph::handle_overflow_nop);
+        else handler.set_overflow_handler(chan, boost::bind(
+            &rx_dsp_core_200::handle_overflow, mbc.rx_dsps[dsp]
+        ));
+        handler.set_xport_chan_get_buff(chan, boost::bind(
+            &zero_copy_if::get_recv_buff, mbc.rx_dsp_xports[dsp], _1
+        ));
+    }
+
+    //! Bind a send transport channel to a tx xport and its flow control
+    void bind_send_chan(sph::send_packet_handler &handler, const size_t chan, const size_t index){
+        handler.set_xport_chan_flush(chan, boost::bind(
+            &zero_copy_if::flush_send_buffs, tx_xports[index]
+        ));
+        handler.set_event_counters(chan, tx_counters[index]);
+        handler.set_xport_chan_get_buff(chan, boost::bind(
+            &usrp2_impl::io_impl::get_send_buff, this, index, _1
+        ));
+        if (handler_args.cast<bool>("send_preload", false)) handler.set_xport_chan_preload(chan, boost::bind(
+            &flow_control_monitor::check_fc_room, fc_mons[index], _1, _2
+        ));
+    }
+
+    //tx dsp: xports and flow control monitors (all mboards in order),
+    //and the channel of each xport for the async messages
     std::vector<zero_copy_if::sptr> tx_xports;
     std::vector<flow_control_monitor::sptr> fc_mons;
+    std::vector<size_t> tx_xport_chans;
+
+    //streaming error events: rx per mboard and dsp, tx per tx xport
+    uhd::dict<std::string, std::vector<stream_event_counters::sptr> > rx_counters;
+    std::vector<stream_event_counters::sptr> tx_counters;
 
     //state management for the vrt packet handler code
     sph::recv_packet_handler recv_handler;
     sph::send_packet_handler send_handler;
 
+    //the handler settings of the device address, for the streams too
+    device_addr_t handler_args;
+
+    //the latest stream of each rx dsp (per mboard) and tx xport, it follows the rate changes;
+    //the channel of each rx dsp in its stream
+    uhd::dict<std::string, std::vector<boost::weak_ptr<sph::recv_packet_streamer> > > rx_streamers;
+    uhd::dict<std::string, std::vector<size_t> > rx_streamer_chans;
+    std::vector<boost::weak_ptr<sph::send_packet_streamer> > tx_streamers;
+
     //methods and variables for the pirate crew
     void recv_pirate_loop(zero_copy_if::sptr, size_t);
+    void recv_pirate_crew_loop(const std::vector<size_t> &);
+    void handle_async_packet(managed_recv_buffer::sptr, size_t);
     std::list<task::sptr> pirate_tasks;
-    bounded_buffer<async_metadata_t> async_msg_fifo;
+    async_msg_ring async_msg_fifo;
     double tick_rate;
 };
 
@@ -178,128 +290,366 @@ struct usrp2_impl::io_impl{
 void usrp2_impl::io_impl::recv_pirate_loop(
     zero_copy_if::sptr err_xport, size_t index
 ){
-    set_thread_priority_safe();
-
-    //store a reference to the flow control monitor (offset by max dsps)
-    flow_control_monitor &fc_mon = *(this->fc_mons[index]);
-
     while (not boost::this_thread::interruption_requested()){
         managed_recv_buffer::sptr buff = err_xport->get_recv_buff();
         if (not buff.get()) continue; //ignore timeout/error buffers
+        this->handle_async_packet(buff, index);
+    }
+}
+
+/***********************************************************************
+ * Receive Pirate Crew Loop
+ * - one thread waits on the sockets of several tx xports
+ * - drain each ready socket without blocking
+ **********************************************************************/
+void usrp2_impl::io_impl::recv_pirate_crew_loop(const std::vector<size_t> &indexes){
+    std::vector<int> sock_fds;
+    BOOST_FOREACH(size_t index, indexes){
+        sock_fds.push_back(boost::dynamic_pointer_cast<udp_zero_copy>(tx_xports[index])->get_recv_fd());
+    }
 
-        try{
-            //extract the vrt header packet info
-            vrt::if_packet_info_t if_packet_info;
-            if_packet_info.num_packet_words32 = buff->size()/sizeof(boost::uint32_t);
-            const boost::uint32_t *vrt_hdr = buff->cast<const boost::uint32_t *>();
-            vrt::if_hdr_unpack_be(vrt_hdr, if_packet_info);
-
-            //handle a tx async report message
-            if (if_packet_info.sid == USRP2_TX_ASYNC_SID and if_packet_info.packet_type != vrt::if_packet_info_t::PACKET_TYPE_DATA){
-
-                //fill in the async metadata
-                async_metadata_t metadata;
-                metadata.channel = index;
-                metadata.has_time_spec = if_packet_info.has_tsi and if_packet_info.has_tsf;
-                metadata.time_spec = time_spec_t(
-                    time_t(if_packet_info.tsi), size_t(if_packet_info.tsf), tick_rate
-                );
-                metadata.event_code = async_metadata_t::event_code_t(sph::get_context_code(vrt_hdr, if_packet_info));
-
-                //catch the flow control packets and react
-                if (metadata.event_code == 0){
-                    boost::uint32_t fc_word32 = (vrt_hdr + if_packet_info.num_header_words32)[1];
-                    fc_mon.update_fc_condition(uhd::ntohx(fc_word32));
-                    continue;
-                }
-                //else UHD_MSG(often) << "metadata.event_code " << metadata.event_code << std::endl;
-                async_msg_fifo.push_with_pop_on_full(metadata);
-
-                if (metadata.event_code &
-                    ( async_metadata_t::EVENT_CODE_UNDERFLOW
-                    | async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET)
-                ) UHD_MSG(fastpath) << "U";
-                else if (metadata.event_code &
-                    ( async_metadata_t::EVENT_CODE_SEQ_ERROR
-                    | async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST)
-                ) UHD_MSG(fastpath) << "S";
+    std::vector<bool> ready;
+    while (not boost::this_thread::interruption_requested()){
+        if (not wait_for_recv_ready(sock_fds, 0.1, ready)) continue; //timeout
+        for (size_t i = 0; i < indexes.size(); i++){
+            if (not ready[i]) continue;
+            managed_recv_buffer::sptr buff;
+            while ((buff = tx_xports[indexes[i]]->get_recv_buff(0.0)).get() != NULL){
+                this->handle_async_packet(buff, indexes[i]);
             }
-            else{
-                //TODO unknown received packet, may want to print error...
+        }
+    }
+}
+
+void usrp2_impl::io_impl::handle_async_packet(
+    managed_recv_buffer::sptr buff, size_t index
+){
+    //the flow control monitor of this tx xport
+    flow_control_monitor &fc_mon = *(this->fc_mons[index]);
+
+    try{
+        //extract the vrt header packet info
+        vrt::if_packet_info_t if_packet_info;
+        if_packet_info.num_packet_words32 = buff->size()/sizeof(boost::uint32_t);
+        const boost::uint32_t *vrt_hdr = buff->cast<const boost::uint32_t *>();
+        vrt::if_hdr_unpack_be(vrt_hdr, if_packet_info);
+
+        //handle a tx async report message
+        if (if_packet_info.sid == USRP2_TX_ASYNC_SID and if_packet_info.packet_type != vrt::if_packet_info_t::PACKET_TYPE_DATA){
+
+            //fill in the async metadata
+            async_metadata_t metadata;
+            metadata.channel = tx_xport_chans[index];
+            metadata.has_time_spec = if_packet_info.has_tsi and if_packet_info.has_tsf;
+            metadata.time_spec = time_spec_t(
+                time_t(if_packet_info.tsi), size_t(if_packet_info.tsf), tick_rate
+            );
+            metadata.event_code = async_metadata_t::event_code_t(sph::get_context_code(vrt_hdr, if_packet_info));
+
+            //catch the flow control packets and react
+            if (metadata.event_code == 0){
+                boost::uint32_t fc_word32 = (vrt_hdr + if_packet_info.num_header_words32)[1];
+                UHD_TRACE_INSTANT("tx_fc_update");
+                fc_mon.update_fc_condition(uhd::ntohx(fc_word32));
+                return;
             }
-        }catch(const std::exception &e){
-            UHD_MSG(error) << "Error in recv pirate loop: " << e.what() << std::endl;
+            //else UHD_MSG(often) << "metadata.event_code " << metadata.event_code << std::endl;
+            async_msg_fifo.push_with_pop_on_full(metadata);
+
+            if (metadata.event_code &
+                ( async_metadata_t::EVENT_CODE_UNDERFLOW
+                | async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET)
+            ) tx_counters[index]->record(stream_event_counters::EVENT_UNDERFLOW);
+            else if (metadata.event_code &
+                ( async_metadata_t::EVENT_CODE_SEQ_ERROR
+                | async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST)
+            ) tx_counters[index]->record(stream_event_counters::EVENT_SEQ_ERROR);
+            else if (metadata.event_code & async_metadata_t::EVENT_CODE_TIME_ERROR)
+                tx_counters[index]->record(stream_event_counters::EVENT_LATE_COMMAND);
+        }
+        else{
+            //TODO unknown received packet, may want to print error...
         }
+    }catch(const std::exception &e){
+        UHD_MSG(error) << "Error in recv pirate loop: " << e.what() << std::endl;
     }
 }
 
 /***********************************************************************
  * Helper Functions
  **********************************************************************/
-void usrp2_impl::io_init(void){
+static uhd::otw_type_t make_otw_type(const std::string &format){
+    uhd::otw_type_t otw_type;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+    if (format == "sc16"){
+        otw_type.width = 16;
+        otw_type.shift = 0;
+    }
+    else if (format == "sc12"){ //packed, four samples per three 32-bit lines
+        otw_type.width = 12;
+        otw_type.shift = 4;
+    }
+    else if (format == "sc8"){ //packed, two samples per 32-bit line
+        otw_type.width = 8;
+        otw_type.shift = 8;
+    }
+    else throw uhd::value_error("usrp2: unknown otw format " + format);
+    return otw_type;
+}
 
-    //setup rx otw type
-    _rx_otw_type.width = 16;
-    _rx_otw_type.shift = 0;
-    _rx_otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+//! packed sc12 fills whole 32-bit lines in groups of 4 samples
+static size_t round_to_otw_group(const size_t nsamps, const uhd::otw_type_t &otw_type){
+    return (otw_type.width == 12)? nsamps & ~size_t(3) : nsamps;
+}
 
-    //setup tx otw type
-    _tx_otw_type.width = 16;
-    _tx_otw_type.shift = 0;
-    _tx_otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+//! Setup a receive handler from the device address settings
+static void init_recv_handler(
+    sph::recv_packet_handler &handler, const otw_type_t &otw_type,
+    const device_addr_t &device_addr, const size_t packets_per_sock_buff
+){
+    handler.set_vrt_unpacker(&vrt::if_hdr_unpack_be_sid_tsi_tsf_tlr);
+    handler.set_converter(otw_type);
+    handler.set_convert_threads(
+        boost::lexical_cast<size_t>(device_addr.get("recv_convert_threads", "0"))
+    );
+    handler.set_lookahead(device_addr.cast<int>("recv_lookahead", 0) != 0);
 
-    //create new io impl
-    _io_impl = UHD_PIMPL_MAKE(io_impl, ());
+    //one thread each for recv and send: skip the per-call mutex
+    handler.set_single_owner(device_addr.cast<int>("single_owner", 0) != 0);
 
-    //init first so we dont have an access race
+    //set the packet threshold to be an entire socket buffer's worth
+    handler.set_alignment_failure_threshold(packets_per_sock_buff);
+}
+
+//! Setup a send handler from the device address settings
+static void init_send_handler(
+    sph::send_packet_handler &handler, const otw_type_t &otw_type,
+    const device_addr_t &device_addr, property_tree::sptr tree,
+    const fs_path &mb_path, const size_t max_samps_per_packet
+){
+    handler.set_vrt_packer(&vrt::if_hdr_pack_be, vrt_send_header_offset_words32);
+    handler.set_converter(otw_type);
+    handler.set_scale_factor(32767./(1 << otw_type.shift));
+    handler.set_max_samples_per_packet(max_samps_per_packet);
+    setup_late_send_policy(handler, tree, mb_path, device_addr);
+    handler.set_single_owner(device_addr.cast<int>("single_owner", 0) != 0);
+}
+
+//! Check that a stream asks for the otw format of the device
+static void check_otw_format(const std::string &format, const otw_type_t &otw_type, const std::string &dir){
+    if (format.empty()) return;
+    const otw_type_t wanted = make_otw_type(format);
+    if (wanted.width == otw_type.width and wanted.shift == otw_type.shift) return;
+    throw uhd::value_error(str(boost::format(
+        "usrp2 %s stream: the dsps pack one otw format, set %s with the %s_otw_format device address key"
+    ) % dir % format % ((dir == "rx")? "recv" : "send")));
+}
+
+void usrp2_impl::io_init(const device_addr_t &device_addr){
+
+    //setup the otw types (sc12 and sc8 pack more samples into the bytes on the wire)
+    _rx_otw_type = make_otw_type(device_addr.get("recv_otw_format", "sc16"));
+    _tx_otw_type = make_otw_type(device_addr.get("send_otw_format", "sc16"));
+
+    //the dsp cores must pack and unpack the same format
     BOOST_FOREACH(const std::string &mb, _mbc.keys()){
-        //init the tx xport and flow control monitor
-        _io_impl->tx_xports.push_back(_mbc[mb].tx_dsp_xport);
-        _io_impl->fc_mons.push_back(flow_control_monitor::sptr(new flow_control_monitor(
-            USRP2_SRAM_BYTES/_mbc[mb].tx_dsp_xport->get_send_frame_size()
-        )));
+        BOOST_FOREACH(rx_dsp_core_200::sptr rx_dsp, _mbc[mb].rx_dsps){
+            rx_dsp->set_otw_type(_rx_otw_type);
+        }
+        BOOST_FOREACH(tx_dsp_core_200::sptr tx_dsp, _mbc[mb].tx_dsps){
+            tx_dsp->set_otw_type(_tx_otw_type);
+        }
     }
 
-    //create a new pirate thread for each zc if (yarr!!)
-    size_t index = 0;
+    //create new io impl, the async messages overwrite the oldest past the depth
+    _io_impl = UHD_PIMPL_MAKE(io_impl, (device_addr.cast<size_t>("async_msg_depth", 100)));
+    async_msg_ring::publish(_tree, "/mboards/" + _mbc.keys().front(), _io_impl->async_msg_fifo);
+
+    //init first so we dont have an access race
+    std::vector<std::vector<size_t> > xport_cpus; //the nic local cpus per tx xport with numa=auto
     BOOST_FOREACH(const std::string &mb, _mbc.keys()){
+        const bool fastpath_chars = device_addr.cast<bool>("fastpath_chars", true);
+        for (size_t dspno = 0; dspno < _mbc[mb].tx_dsp_xports.size(); dspno++){
+            const std::string tx_dsp_path = str(boost::format("/mboards/%s/tx_dsps/%u") % mb % dspno);
+            const zero_copy_if::sptr xport = _mbc[mb].tx_dsp_xports[dspno];
+
+            //init the tx xport and flow control monitor
+            const size_t fifo_packets = get_usrp2_tx_fifo_bytes(dspno)/xport->get_send_frame_size();
+            _io_impl->tx_xport_chans.push_back(_io_impl->tx_xports.size());
+            _io_impl->tx_xports.push_back(xport);
+            xport_cpus.push_back(_mbc[mb].locality_cpus);
+            const flow_control_monitor::sptr fc_mon(new flow_control_monitor(fifo_packets));
+            _io_impl->fc_mons.push_back(fc_mon);
+
+            //the in-flight window in packets, defaults to the fifo capacity
+            _tree->create<size_t>(tx_dsp_path + "/fc_window")
+                .set(fifo_packets)
+                .subscribe(boost::bind(&flow_control_monitor::set_max_seqs_out, fc_mon, _1))
+                .subscribe(boost::bind(&usrp2_impl::update_tx_fc_updates, this, mb, dspno));
+
+            //or the window in time, recomputed in packets when the rate changes
+            _tree->create<double>(tx_dsp_path + "/fc_window_time")
+                .subscribe(boost::bind(&usrp2_impl::update_tx_window, this, mb, dspno))
+                .set(device_addr.cast<double>("send_window_time", 0.0));
+            _tree->access<double>(tx_dsp_path + "/rate/value")
+                .subscribe(boost::bind(&usrp2_impl::update_tx_window, this, mb, dspno));
+
+            //create and publish the streaming event counters and transport stats
+            _io_impl->tx_counters.push_back(stream_event_counters::make(fastpath_chars));
+            stream_event_counters::publish(_tree, tx_dsp_path, _io_impl->tx_counters.back());
+            publish_xport_stats(_tree, tx_dsp_path, xport, false);
+        }
+        for (size_t dspno = 0; dspno < _mbc[mb].rx_dsps.size(); dspno++){
+            const std::string rx_dsp_path = str(boost::format("/mboards/%s/rx_dsps/%u") % mb % dspno);
+            _io_impl->rx_counters[mb].push_back(stream_event_counters::make(fastpath_chars));
+            stream_event_counters::publish(_tree, rx_dsp_path, _io_impl->rx_counters[mb].back());
+            publish_xport_stats(_tree, rx_dsp_path, _mbc[mb].rx_dsp_xports[dspno], true);
+        }
+
+        //the host resamplers, one setting per handler shared by the dsps
+        for (size_t dspno = 0; dspno < _mbc[mb].rx_dsps.size(); dspno++){
+            publish_resampler(_tree, str(boost::format("/mboards/%s/rx_dsps/%u") % mb % dspno), _io_impl->recv_handler);
+        }
+        for (size_t dspno = 0; dspno < _mbc[mb].tx_dsps.size(); dspno++){
+            publish_resampler(_tree, str(boost::format("/mboards/%s/tx_dsps/%u") % mb % dspno), _io_impl->send_handler);
+        }
+    }
+
+    //create a new pirate thread for each zc if (yarr!!),
+    //or share a small crew of threads across all of the zc ifs;
+    //without pirate_cpu, numa=auto pins each pirate to the cpus of its nic
+    const std::vector<size_t> pirate_cpus = cpus_from_string(device_addr.get("pirate_cpu", ""));
+    const thread_sched_t pirate_sched = thread_sched_t::from_string(device_addr.get("pirate_sched", "rr"));
+    const size_t num_xports = _io_impl->tx_xports.size();
+    size_t num_pirates = std::min(num_xports, boost::lexical_cast<size_t>(device_addr.get("pirate_threads", "0")));
+    BOOST_FOREACH(const zero_copy_if::sptr &xport, _io_impl->tx_xports){
+        if (num_pirates == 0 or boost::dynamic_pointer_cast<udp_zero_copy>(xport).get() != NULL) continue;
+        UHD_MSG(warning) << "usrp2: pirate_threads needs udp transports, using a thread per transport" << std::endl;
+        num_pirates = 0;
+        break;
+    }
+
+    if (num_pirates == 0) for (size_t index = 0; index < num_xports; index++){
         //spawn a new pirate to plunder the recv booty
         _io_impl->pirate_tasks.push_back(task::make(boost::bind(
             &usrp2_impl::io_impl::recv_pirate_loop, _io_impl.get(),
-            _mbc[mb].tx_dsp_xport, index++
-        )));
+            _io_impl->tx_xports[index], index
+        ), (pirate_cpus.empty())? xport_cpus[index] : pirate_cpus, pirate_sched));
+        _io_impl->pirate_tasks.back()->set_name(str(boost::format("usrp2 pirate %u") % index));
+    }
+    else for (size_t pirate = 0; pirate < num_pirates; pirate++){
+        //deal the zc ifs round robin across the crew
+        std::vector<size_t> indexes;
+        for (size_t index = pirate; index < num_xports; index += num_pirates){
+            indexes.push_back(index);
+        }
+        _io_impl->pirate_tasks.push_back(task::make(boost::bind(
+            &usrp2_impl::io_impl::recv_pirate_crew_loop, _io_impl.get(), indexes
+        ), (pirate_cpus.empty())? xport_cpus[indexes.front()] : pirate_cpus, pirate_sched));
+        _io_impl->pirate_tasks.back()->set_name(str(boost::format("usrp2 pirate crew %u") % pirate));
     }
 
     //init some handler stuff
-    _io_impl->recv_handler.set_vrt_unpacker(&vrt::if_hdr_unpack_be);
-    _io_impl->recv_handler.set_converter(_rx_otw_type);
-    _io_impl->send_handler.set_vrt_packer(&vrt::if_hdr_pack_be, vrt_send_header_offset_words32);
-    _io_impl->send_handler.set_converter(_tx_otw_type);
-    _io_impl->send_handler.set_max_samples_per_packet(get_max_send_samps_per_packet());
+    _io_impl->handler_args = device_addr;
+    init_recv_handler(_io_impl->recv_handler, _rx_otw_type, device_addr, get_packets_per_sock_buff());
+    init_send_handler(
+        _io_impl->send_handler, _tx_otw_type, device_addr, _tree,
+        "/mboards/" + _mbc.keys().front(), get_max_send_samps_per_packet()
+    );
+    BOOST_FOREACH(const std::string &mb, _mbc.keys()){
+        _io_impl->rx_streamers[mb].resize(_mbc[mb].rx_dsps.size());
+        _io_impl->rx_streamer_chans[mb].resize(_mbc[mb].rx_dsps.size());
+    }
+    _io_impl->tx_streamers.resize(_io_impl->tx_xports.size());
+}
 
-    //set the packet threshold to be an entire socket buffer's worth
-    const size_t packets_per_sock_buff = size_t(50e6/_mbc[_mbc.keys().front()].rx_dsp_xports[0]->get_recv_frame_size());
-    _io_impl->recv_handler.set_alignment_failure_threshold(packets_per_sock_buff);
+size_t usrp2_impl::get_packets_per_sock_buff(void) const{
+    return size_t(50e6/_mbc[_mbc.keys().front()].rx_dsp_xports[0]->get_recv_frame_size());
 }
 
 void usrp2_impl::update_tick_rate(const double rate){
     _io_impl->tick_rate = rate;
-    boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
-    _io_impl->recv_handler.set_tick_rate(rate);
-    boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
-    _io_impl->send_handler.set_tick_rate(rate);
+    {
+        boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
+        _io_impl->recv_handler.set_tick_rate(rate);
+        boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
+        _io_impl->send_handler.set_tick_rate(rate);
+    }
+    BOOST_FOREACH(const std::string &mb, _io_impl->rx_streamers.keys()){
+        BOOST_FOREACH(const boost::weak_ptr<sph::recv_packet_streamer> &weak, _io_impl->rx_streamers[mb]){
+            boost::shared_ptr<sph::recv_packet_streamer> my_streamer = weak.lock();
+            if (not my_streamer) continue;
+            boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+            my_streamer->set_tick_rate(rate);
+        }
+    }
+    BOOST_FOREACH(const boost::weak_ptr<sph::send_packet_streamer> &weak, _io_impl->tx_streamers){
+        boost::shared_ptr<sph::send_packet_streamer> my_streamer = weak.lock();
+        if (not my_streamer) continue;
+        boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+        my_streamer->set_tick_rate(rate);
+    }
 }
 
-void usrp2_impl::update_rx_samp_rate(const double rate){
-    boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
-    _io_impl->recv_handler.set_samp_rate(rate);
-    const double adj = _mbc[_mbc.keys().front()].rx_dsps.front()->get_scaling_adjustment();
-    _io_impl->recv_handler.set_scale_factor(adj/32767.);
+void usrp2_impl::update_rx_samp_rate(const std::string &mb, const size_t dspno, const double rate){
+    const double adj = _mbc[mb].rx_dsps[dspno]->get_scaling_adjustment();
+    const double scale_factor = adj*(1 << _rx_otw_type.shift)/32767.;
+
+    //with a command time, the dsp takes the rate at that time while streaming,
+    //so the handlers switch at the first packet of that time
+    const time_spec_t cmd_time = _mbc[mb].cmd_time;
+    {
+        boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
+        if (cmd_time != time_spec_t(0.0)) _io_impl->recv_handler.set_samp_rate_at(cmd_time, rate, scale_factor);
+        else{
+            _io_impl->recv_handler.set_samp_rate(rate);
+            _io_impl->recv_handler.set_scale_factor(scale_factor);
+        }
+    }
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer = _io_impl->rx_streamers[mb][dspno].lock();
+    if (not my_streamer) return;
+    boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+    if (cmd_time != time_spec_t(0.0)) my_streamer->set_samp_rate_at(cmd_time, rate, scale_factor);
+    else{
+        my_streamer->set_samp_rate(rate);
+        my_streamer->set_scale_factor(scale_factor);
+    }
 }
 
-void usrp2_impl::update_tx_samp_rate(const double rate){
-    boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
-    _io_impl->send_handler.set_samp_rate(rate);
+void usrp2_impl::drop_rx_lookahead(const std::string &which_mb, const size_t dspno){
+    if (_io_impl->handler_args.cast<int>("recv_lookahead", 0) == 0) return; //nothing is held
+
+    //the device handler channels are the dsps of the subdev specs, across the mboards in order
+    size_t chan = 0;
+    BOOST_FOREACH(const std::string &mb, _mbc.keys()){
+        if (mb == which_mb) break;
+        chan += _mbc[mb].rx_chan_occ;
+    }
+    if (dspno < _mbc[which_mb].rx_chan_occ){
+        boost::mutex::scoped_lock recv_lock = _io_impl->recv_handler.get_scoped_lock();
+        _io_impl->recv_handler.drop_lookahead(chan + dspno);
+    }
+
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer = _io_impl->rx_streamers[which_mb][dspno].lock();
+    if (not my_streamer) return;
+    boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+    my_streamer->drop_lookahead(_io_impl->rx_streamer_chans[which_mb][dspno]);
+}
+
+void usrp2_impl::update_tx_samp_rate(const std::string &mb, const size_t dspno, const double rate){
+    {
+        boost::mutex::scoped_lock send_lock = _io_impl->send_handler.get_scoped_lock();
+        _io_impl->send_handler.set_samp_rate(rate);
+    }
+    size_t index = dspno; //the tx xports are indexed across the mboards
+    BOOST_FOREACH(const std::string &key, _mbc.keys()){
+        if (key == mb) break;
+        index += _mbc[key].tx_dsp_xports.size();
+    }
+    boost::shared_ptr<sph::send_packet_streamer> my_streamer = _io_impl->tx_streamers[index].lock();
+    if (not my_streamer) return;
+    boost::mutex::scoped_lock lock = my_streamer->get_scoped_lock();
+    my_streamer->set_samp_rate(rate);
 }
 
 static subdev_spec_t replace_zero_in_spec(const std::string &type, const subdev_spec_t &spec){
@@ -346,9 +696,7 @@ subdev_spec_t usrp2_impl::update_rx_subdev_spec(const std::string &which_mb, con
     BOOST_FOREACH(const std::string &mb, _mbc.keys()){
         for (size_t dsp = 0; dsp < _mbc[mb].rx_chan_occ; dsp++){
             _mbc[mb].rx_dsps[dsp]->set_nsamps_per_packet(get_max_recv_samps_per_packet()); //seems to be a good place to set this
-            _io_impl->recv_handler.set_xport_chan_get_buff(chan++, boost::bind(
-                &zero_copy_if::get_recv_buff, _mbc[mb].rx_dsp_xports[dsp], _1
-            ));
+            _io_impl->bind_recv_chan(_io_impl->recv_handler, chan++, _mbc[mb], _io_impl->rx_counters[mb][dsp], dsp);
         }
     }
     return spec;
@@ -362,7 +710,14 @@ subdev_spec_t usrp2_impl::update_tx_subdev_spec(const std::string &which_mb, con
     //sanity checking
     validate_subdev_spec(_tree, spec, "tx", which_mb);
 
-    //set the mux for this spec
+    //set the mux for this spec, the tx dsps are summed into one frontend
+    for (size_t i = 1; i < spec.size(); i++){
+        if (spec[i] == spec[0]) continue;
+        throw uhd::value_error(str(boost::format(
+            "The TX subdevice specification \"%s\" names different subdevices.\n"
+            "The TX DSPs on mboard %s are summed into one frontend: use \"%s\" for every channel."
+        ) % spec.to_string() % which_mb % (spec[0].db_name + ":" + spec[0].sd_name)));
+    }
     const std::string conn = _tree->access<std::string>(root / spec[0].db_name / "tx_frontends" / spec[0].sd_name / "connection").get();
     _mbc[which_mb].tx_fe->set_mux(conn);
 
@@ -373,13 +728,14 @@ subdev_spec_t usrp2_impl::update_tx_subdev_spec(const std::string &which_mb, con
     _io_impl->send_handler.resize(nchan);
 
     //bind new callbacks for the handler
-    size_t chan = 0, i = 0;
+    size_t chan = 0, base = 0;
     BOOST_FOREACH(const std::string &mb, _mbc.keys()){
         for (size_t dsp = 0; dsp < _mbc[mb].tx_chan_occ; dsp++){
-            _io_impl->send_handler.set_xport_chan_get_buff(chan++, boost::bind(
-                &usrp2_impl::io_impl::get_send_buff, _io_impl.get(), i++, _1
-            ));
+            const size_t i = base + dsp;
+            _io_impl->tx_xport_chans[i] = chan;
+            _io_impl->bind_send_chan(_io_impl->send_handler, chan++, i);
         }
+        base += _mbc[mb].tx_dsp_xports.size();
     }
     return spec;
 }
@@ -394,6 +750,27 @@ bool usrp2_impl::recv_async_msg(
     return _io_impl->async_msg_fifo.pop_with_timed_wait(async_metadata, timeout);
 }
 
+poll_fds_t usrp2_impl::get_async_msg_poll_fds(void){
+    const poll_fds_t fds = _io_impl->async_msg_fifo.get_poll_fds();
+    if (fds.empty()) throw uhd::not_implemented_error("usrp2 async messages cannot be polled on this platform");
+    return fds;
+}
+
+/***********************************************************************
+ * Receive Readiness
+ **********************************************************************/
+poll_fds_t usrp2_impl::get_recv_poll_fds(void){
+    poll_fds_t fds;
+    BOOST_FOREACH(const std::string &mb, _mbc.keys()){
+        BOOST_FOREACH(const zero_copy_if::sptr &xport, _mbc[mb].rx_dsp_xports){
+            const poll_fds_t xport_fds = xport->get_recv_poll_fds();
+            if (xport_fds.empty()) throw uhd::not_implemented_error("usrp2 receive transport cannot be polled");
+            fds.insert(fds.end(), xport_fds.begin(), xport_fds.end());
+        }
+    }
+    return fds;
+}
+
 /***********************************************************************
  * Send Data
  **********************************************************************/
@@ -403,8 +780,8 @@ size_t usrp2_impl::get_max_send_samps_per_packet(void) const{
         + vrt_send_header_offset_words32*sizeof(boost::uint32_t)
         - sizeof(vrt::if_packet_info_t().cid) //no class id ever used
     ;
-    const size_t bpp = _mbc[_mbc.keys().front()].tx_dsp_xport->get_send_frame_size() - hdr_size;
-    return bpp/_tx_otw_type.get_sample_size();
+    const size_t bpp = _mbc[_mbc.keys().front()].tx_dsp_xports[0]->get_send_frame_size() - hdr_size;
+    return round_to_otw_group(bpp/_tx_otw_type.get_sample_size(), _tx_otw_type);
 }
 
 size_t usrp2_impl::send(
@@ -419,6 +796,14 @@ size_t usrp2_impl::send(
     );
 }
 
+size_t usrp2_impl::get_send_view(send_view_t &view, double timeout){
+    return _io_impl->send_handler.get_send_view(view, timeout);
+}
+
+size_t usrp2_impl::commit_send_view(send_view_t &view, size_t nsamps, double){
+    return _io_impl->send_handler.commit_send_view(view, nsamps);
+}
+
 /***********************************************************************
  * Receive Data
  **********************************************************************/
@@ -428,8 +813,13 @@ size_t usrp2_impl::get_max_recv_samps_per_packet(void) const{
         + sizeof(vrt::if_packet_info_t().tlr) //forced to have trailer
         - sizeof(vrt::if_packet_info_t().cid) //no class id ever used
     ;
-    const size_t bpp = _mbc[_mbc.keys().front()].rx_dsp_xports[0]->get_recv_frame_size() - hdr_size;
-    return bpp/_rx_otw_type.get_sample_size();
+    //the frame size may be clipped per motherboard, use the smallest
+    size_t frame_size = _mbc[_mbc.keys().front()].rx_dsp_xports[0]->get_recv_frame_size();
+    BOOST_FOREACH(const std::string &mb, _mbc.keys()){
+        frame_size = std::min(frame_size, _mbc[mb].rx_dsp_xports[0]->get_recv_frame_size());
+    }
+    const size_t bpp = frame_size - hdr_size;
+    return round_to_otw_group(bpp/_rx_otw_type.get_sample_size(), _rx_otw_type);
 }
 
 size_t usrp2_impl::recv(
@@ -443,3 +833,111 @@ size_t usrp2_impl::recv(
         recv_mode, timeout
     );
 }
+
+size_t usrp2_impl::recv_full_buff(
+    const recv_buffs_type &buffs, size_t nsamps_per_buff,
+    recv_metadata_array_type &metadata_array,
+    const io_type_t &io_type, double timeout
+){
+    return _io_impl->recv_handler.recv_full_buff(
+        buffs, nsamps_per_buff,
+        metadata_array, io_type, timeout
+    );
+}
+
+size_t usrp2_impl::recv_view(recv_view_t &view, double timeout){
+    return _io_impl->recv_handler.recv_view(view, timeout);
+}
+
+/***********************************************************************
+ * Streams
+ **********************************************************************/
+//! Fill in the default channels and check them against the device channels
+static void check_stream_channels(stream_args_t &args, const size_t num_chans, const std::string &dir){
+    if (args.channels.empty()) for (size_t i = 0; i < num_chans; i++) args.channels.push_back(i);
+    BOOST_FOREACH(const size_t chan, args.channels){
+        if (chan < num_chans) continue;
+        throw uhd::index_error(str(boost::format(
+            "usrp2 %s stream: channel %u is not in the %u channels of the subdevice specifications"
+        ) % dir % chan % num_chans));
+    }
+}
+
+rx_streamer::sptr usrp2_impl::get_rx_stream(const stream_args_t &args_){
+    stream_args_t args = args_;
+    check_otw_format(args.otw_format, _rx_otw_type, "rx");
+
+    //the device channels are the dsps of the subdev specs, across the mboards in order
+    std::vector<std::pair<std::string, size_t> > chan_to_dsp;
+    BOOST_FOREACH(const std::string &mb, _mbc.keys()){
+        for (size_t dsp = 0; dsp < _mbc[mb].rx_chan_occ; dsp++){
+            chan_to_dsp.push_back(std::make_pair(mb, dsp));
+        }
+    }
+    check_stream_channels(args, chan_to_dsp.size(), "rx");
+    const size_t spp = (args.spp == 0)? get_max_recv_samps_per_packet() : std::min(args.spp, get_max_recv_samps_per_packet());
+
+    //make a handler for the channels of this stream, at the rate of its first dsp
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer(new sph::recv_packet_streamer(
+        io_type_t(args.cpu_type), spp
+    ));
+    my_streamer->resize(args.channels.size());
+    init_recv_handler(*my_streamer, _rx_otw_type, _io_impl->handler_args, get_packets_per_sock_buff());
+    const std::string &mb0 = chan_to_dsp[args.channels.front()].first;
+    const size_t dsp0 = chan_to_dsp[args.channels.front()].second;
+    my_streamer->set_tick_rate(_io_impl->tick_rate);
+    my_streamer->set_samp_rate(_tree->access<double>(
+        str(boost::format("/mboards/%s/rx_dsps/%u/rate/value") % mb0 % dsp0)
+    ).get());
+    my_streamer->set_scale_factor(_mbc[mb0].rx_dsps[dsp0]->get_scaling_adjustment()*(1 << _rx_otw_type.shift)/32767.);
+
+    for (size_t i = 0; i < args.channels.size(); i++){
+        const std::string &mb = chan_to_dsp[args.channels[i]].first;
+        const size_t dsp = chan_to_dsp[args.channels[i]].second;
+        _mbc[mb].rx_dsps[dsp]->set_nsamps_per_packet(spp);
+        _io_impl->bind_recv_chan(*my_streamer, i, _mbc[mb], _io_impl->rx_counters[mb][dsp], dsp);
+        _io_impl->rx_streamers[mb][dsp] = my_streamer;
+        _io_impl->rx_streamer_chans[mb][dsp] = i;
+    }
+    return my_streamer;
+}
+
+tx_streamer::sptr usrp2_impl::get_tx_stream(const stream_args_t &args_){
+    stream_args_t args = args_;
+    check_otw_format(args.otw_format, _tx_otw_type, "tx");
+
+    //the device channels are the dsps of the subdev specs, the tx xports are indexed across the mboards
+    std::vector<std::pair<std::string, size_t> > chan_to_dsp;
+    std::vector<size_t> chan_to_index;
+    size_t base = 0;
+    BOOST_FOREACH(const std::string &mb, _mbc.keys()){
+        for (size_t dsp = 0; dsp < _mbc[mb].tx_chan_occ; dsp++){
+            chan_to_dsp.push_back(std::make_pair(mb, dsp));
+            chan_to_index.push_back(base + dsp);
+        }
+        base += _mbc[mb].tx_dsp_xports.size();
+    }
+    check_stream_channels(args, chan_to_dsp.size(), "tx");
+    const size_t spp = (args.spp == 0)? get_max_send_samps_per_packet() : std::min(args.spp, get_max_send_samps_per_packet());
+
+    //make a handler for the channels of this stream, at the rate of its first dsp
+    boost::shared_ptr<sph::send_packet_streamer> my_streamer(new sph::send_packet_streamer(
+        io_type_t(args.cpu_type), spp
+    ));
+    my_streamer->resize(args.channels.size());
+    init_send_handler(
+        *my_streamer, _tx_otw_type, _io_impl->handler_args, _tree,
+        "/mboards/" + _mbc.keys().front(), spp
+    );
+    my_streamer->set_tick_rate(_io_impl->tick_rate);
+    my_streamer->set_samp_rate(_tree->access<double>(str(boost::format("/mboards/%s/tx_dsps/%u/rate/value")
+        % chan_to_dsp[args.channels.front()].first % chan_to_dsp[args.channels.front()].second
+    )).get());
+
+    for (size_t i = 0; i < args.channels.size(); i++){
+        const size_t index = chan_to_index[args.channels[i]];
+        _io_impl->bind_send_chan(*my_streamer, i, index);
+        _io_impl->tx_streamers[index] = my_streamer;
+    }
+    return my_streamer;
+}
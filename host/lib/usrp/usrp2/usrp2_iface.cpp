@@ -22,6 +22,9 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/tasks.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/trace.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/types/time_spec.hpp>
 #include <uhd/types/dict.hpp>
 #include <boost/thread.hpp>
 #include <boost/foreach.hpp>
@@ -33,6 +36,8 @@
 #include <boost/functional/hash.hpp>
 #include <algorithm>
 #include <iostream>
+#include <cstring>
+#include <set>
 
 using namespace uhd;
 using namespace uhd::usrp;
@@ -40,12 +45,44 @@ using namespace uhd::transport;
 
 static const double CTRL_RECV_TIMEOUT = 1.0;
 
+//max number of pipelined requests in flight before the sender waits on an ack
+static const size_t CTRL_MAX_OUTSTANDING = 8;
+
 static const boost::uint32_t MIN_PROTO_COMPAT_SPI = 7;
 static const boost::uint32_t MIN_PROTO_COMPAT_I2C = 7;
 // The register compat number must reflect the protocol compatibility
 // and the compatibility of the register mapping (more likely to change).
 static const boost::uint32_t MIN_PROTO_COMPAT_REG = 10;
 static const boost::uint32_t MIN_PROTO_COMPAT_UART = 7;
+static const boost::uint32_t MIN_PROTO_COMPAT_OPS = 12;
+static const boost::uint32_t MIN_PROTO_COMPAT_GPSDO = 11;
+static const boost::uint32_t MIN_PROTO_COMPAT_TIMED = 13;
+static const boost::uint32_t MIN_PROTO_COMPAT_FRAMER = 14;
+static const boost::uint32_t MIN_PROTO_COMPAT_TX_DSP1 = 15;
+static const boost::uint32_t MIN_PROTO_COMPAT_QUEUED_I2C = 16;
+
+static const uhd::dict<spi_config_t::edge_t, int> spi_edge_to_otw = boost::assign::map_list_of
+    (spi_config_t::EDGE_RISE, USRP2_CLK_EDGE_RISE)
+    (spi_config_t::EDGE_FALL, USRP2_CLK_EDGE_FALL)
+;
+
+//Load one op of a batch into its over-the-wire representation
+static void load_otw_op(usrp2_ctrl_op_t &otw_op, const usrp2_iface::ctrl_batch_t::op_t &op){
+    typedef usrp2_iface::ctrl_batch_t ctrl_batch_t;
+    otw_op.addr = htonl(op.addr);
+    otw_op.data = htonl(op.data);
+    switch(op.type){
+    case ctrl_batch_t::OP_POKE32: otw_op.action = USRP2_REG_ACTION_FPGA_POKE32; break;
+    case ctrl_batch_t::OP_PEEK32: otw_op.action = USRP2_REG_ACTION_FPGA_PEEK32; break;
+    case ctrl_batch_t::OP_WRITE_SPI: otw_op.action = USRP2_REG_ACTION_SPI_WRITE; break;
+    case ctrl_batch_t::OP_READ_SPI: otw_op.action = USRP2_REG_ACTION_SPI_READ; break;
+    }
+    if (op.type == ctrl_batch_t::OP_WRITE_SPI or op.type == ctrl_batch_t::OP_READ_SPI){
+        otw_op.num_bits = op.num_bits;
+        otw_op.miso_edge = spi_edge_to_otw[op.config.miso_edge];
+        otw_op.mosi_edge = spi_edge_to_otw[op.config.mosi_edge];
+    }
+}
 
 //Define get_gpid() to get a globally unique identifier for this process.
 //The gpid is implemented as a hash of the pid and a unique machine identifier.
@@ -82,7 +119,10 @@ public:
     usrp2_iface_impl(udp_simple::sptr ctrl_transport):
         _ctrl_transport(ctrl_transport),
         _ctrl_seq_num(0),
-        _protocol_compat(0) //initialized below...
+        _protocol_compat(0), //initialized below...
+        _ctrl_pipelined(false),
+        _cmd_timed(false),
+        _i2c_ticket(0)
     {
         //Obtain the firmware's compat number.
         //Save the response compat number for communication.
@@ -97,7 +137,7 @@ public:
         mb_eeprom = mboard_eeprom_t(*this, mboard_eeprom_t::MAP_N100);
 
         //----------------------- special temporary warning ------------
-        if (mb_eeprom["gpsdo"] == "internal" and _protocol_compat < USRP2_FW_COMPAT_NUM){
+        if (mb_eeprom["gpsdo"] == "internal" and _protocol_compat < MIN_PROTO_COMPAT_GPSDO){
             UHD_MSG(warning) << "You must upgrade your USRP's firmware to use the GPSDO" << std::endl;
         }
         //--------------------------------------------------------------
@@ -106,6 +146,8 @@ public:
 
     ~usrp2_iface_impl(void){UHD_SAFE_CALL(
         this->lock_device(false);
+        this->clear_command_time();
+        this->flush_ctrl();
     )}
 
 /***********************************************************************
@@ -116,6 +158,7 @@ public:
         if (lock){
             this->get_reg<boost::uint32_t, USRP2_REG_ACTION_FW_POKE32>(U2_FW_REG_LOCK_GPID, boost::uint32_t(get_gpid()));
             _lock_task = task::make(boost::bind(&usrp2_iface_impl::lock_task, this));
+            _lock_task->set_name("usrp2 lock");
         }
         else{
             _lock_task.reset(); //shutdown the task
@@ -143,14 +186,53 @@ public:
         boost::this_thread::sleep(boost::posix_time::milliseconds(1500));
     }
 
+/***********************************************************************
+ * Data framers
+ **********************************************************************/
+    bool setup_framers(const uhd::dict<boost::uint16_t, boost::uint16_t> &ports){
+        if (_protocol_compat < MIN_PROTO_COMPAT_FRAMER) return false;
+        UHD_ASSERT_THROW(ports.size() <= USRP2_CTRL_MAX_FRAMERS);
+
+        //setup the out data
+        usrp2_ctrl_data_t out_data = usrp2_ctrl_data_t();
+        out_data.id = htonl(USRP2_CTRL_ID_SET_UP_THESE_FRAMERS_BRO);
+        out_data.data.framer_args.num_framers = htonl(boost::uint32_t(ports.size()));
+        const std::vector<boost::uint16_t> dsp_ports = ports.keys(), host_ports = ports.vals();
+        for (size_t i = 0; i < ports.size(); i++){
+            out_data.data.framer_args.framers[i].dsp_port = htons(dsp_ports[i]);
+            out_data.data.framer_args.framers[i].host_port = htons(host_ports[i]);
+        }
+
+        //send and recv
+        usrp2_ctrl_data_t in_data = this->ctrl_send_and_recv(out_data, MIN_PROTO_COMPAT_FRAMER);
+        UHD_ASSERT_THROW(ntohl(in_data.id) == USRP2_CTRL_ID_FRAMERS_ARE_SET_UP_DUDE);
+        return ntohl(in_data.data.framer_args.num_framers) == ports.size();
+    }
+
+    bool has_tx_dsp1(void){
+        return _protocol_compat >= MIN_PROTO_COMPAT_TX_DSP1;
+    }
+
 /***********************************************************************
  * Peek and Poke
  **********************************************************************/
     void poke32(wb_addr_type addr, boost::uint32_t data){
+        {
+            boost::mutex::scoped_lock lock(_cmd_mutex);
+            if (_cmd_timed){
+                _cmd_batch.poke32(addr, data);
+                this->send_timed_ops_when_full();
+                return;
+            }
+        }
         this->get_reg<boost::uint32_t, USRP2_REG_ACTION_FPGA_POKE32>(addr, data);
     }
 
     boost::uint32_t peek32(wb_addr_type addr){
+        {
+            boost::mutex::scoped_lock lock(_snapshot_mutex);
+            if (_peek_snapshot.has_key(addr)) return _peek_snapshot[addr];
+        }
         return this->get_reg<boost::uint32_t, USRP2_REG_ACTION_FPGA_PEEK32>(addr);
     }
 
@@ -171,6 +253,18 @@ public:
         out_data.data.reg_args.data = htonl(boost::uint32_t(data));
         out_data.data.reg_args.action = action;
 
+        //writes do not need the reply when pipelined
+        switch(action){
+        case USRP2_REG_ACTION_FPGA_POKE32:
+        case USRP2_REG_ACTION_FPGA_POKE16:
+        case USRP2_REG_ACTION_FW_POKE32:
+            if (_ctrl_pipelined){
+                this->ctrl_send_pipelined(out_data, MIN_PROTO_COMPAT_REG);
+                return data;
+            }
+        default: break;
+        }
+
         //send and recv
         usrp2_ctrl_data_t in_data = this->ctrl_send_and_recv(out_data, MIN_PROTO_COMPAT_REG);
         UHD_ASSERT_THROW(ntohl(in_data.id) == USRP2_CTRL_ID_OMG_GOT_REGISTER_SO_BAD_DUDE);
@@ -187,11 +281,6 @@ public:
         size_t num_bits,
         bool readback
     ){
-        static const uhd::dict<spi_config_t::edge_t, int> spi_edge_to_otw = boost::assign::map_list_of
-            (spi_config_t::EDGE_RISE, USRP2_CLK_EDGE_RISE)
-            (spi_config_t::EDGE_FALL, USRP2_CLK_EDGE_FALL)
-        ;
-
         //setup the out data
         usrp2_ctrl_data_t out_data = usrp2_ctrl_data_t();
         out_data.id = htonl(USRP2_CTRL_ID_TRANSACT_ME_SOME_SPI_BRO);
@@ -202,6 +291,22 @@ public:
         out_data.data.spi_args.num_bits = num_bits;
         out_data.data.spi_args.data = htonl(data);
 
+        //a timed write-only transaction is collected for later
+        if (not readback){
+            boost::mutex::scoped_lock lock(_cmd_mutex);
+            if (_cmd_timed){
+                _cmd_batch.write_spi(which_slave, config, data, num_bits);
+                this->send_timed_ops_when_full();
+                return 0;
+            }
+        }
+
+        //a write-only transaction does not need the reply when pipelined
+        if (not readback and _ctrl_pipelined){
+            this->ctrl_send_pipelined(out_data, MIN_PROTO_COMPAT_SPI);
+            return 0;
+        }
+
         //send and recv
         usrp2_ctrl_data_t in_data = this->ctrl_send_and_recv(out_data, MIN_PROTO_COMPAT_SPI);
         UHD_ASSERT_THROW(ntohl(in_data.id) == USRP2_CTRL_ID_OMG_TRANSACTED_SPI_DUDE);
@@ -209,6 +314,157 @@ public:
         return ntohl(in_data.data.spi_args.data);
     }
 
+/***********************************************************************
+ * Batch of operations
+ **********************************************************************/
+    std::vector<boost::uint32_t> transact_batch(const ctrl_batch_t &batch){
+        const std::vector<ctrl_batch_t::op_t> &ops = batch.get_ops();
+        std::vector<boost::uint32_t> result(ops.size());
+
+        //older firmware: one control packet per op
+        //timed: each write is collected and each read is immediate
+        if (_protocol_compat < MIN_PROTO_COMPAT_OPS or this->is_command_timed()){
+            for (size_t i = 0; i < ops.size(); i++){
+                const ctrl_batch_t::op_t &op = ops[i];
+                switch(op.type){
+                case ctrl_batch_t::OP_POKE32:
+                    this->poke32(op.addr, op.data);
+                    result[i] = op.data;
+                    break;
+                case ctrl_batch_t::OP_PEEK32:
+                    result[i] = this->peek32(op.addr);
+                    break;
+                case ctrl_batch_t::OP_WRITE_SPI:
+                    this->write_spi(op.addr, op.config, op.data, op.num_bits);
+                    result[i] = op.data;
+                    break;
+                case ctrl_batch_t::OP_READ_SPI:
+                    result[i] = this->read_spi(op.addr, op.config, op.data, op.num_bits);
+                    break;
+                }
+            }
+            return result;
+        }
+
+        //one ops packet per USRP2_CTRL_MAX_OPS ops
+        for (size_t first = 0; first < ops.size(); first += USRP2_CTRL_MAX_OPS){
+            const size_t num_ops = std::min<size_t>(ops.size() - first, USRP2_CTRL_MAX_OPS);
+            const size_t len = sizeof(usrp2_ctrl_data_t) + num_ops*sizeof(usrp2_ctrl_op_t);
+
+            //setup the out data
+            usrp2_ctrl_ops_data_t out_data = usrp2_ctrl_ops_data_t();
+            out_data.ctrl.id = htonl(USRP2_CTRL_ID_DO_ALL_THESE_OPS_BRO);
+            out_data.ctrl.data.ops_args.num_ops = htonl(num_ops);
+            bool readback = false;
+            for (size_t i = 0; i < num_ops; i++){
+                const ctrl_batch_t::op_t &op = ops[first + i];
+                load_otw_op(out_data.ops[i], op);
+                readback = readback or op.type == ctrl_batch_t::OP_PEEK32 or op.type == ctrl_batch_t::OP_READ_SPI;
+                result[first + i] = op.data;
+            }
+
+            //writes do not need the reply when pipelined
+            if (not readback and _ctrl_pipelined){
+                this->ctrl_send_pipelined(out_data.ctrl, MIN_PROTO_COMPAT_OPS, USRP2_FW_COMPAT_NUM, len);
+                continue;
+            }
+
+            //send and recv
+            boost::uint8_t usrp2_ctrl_data_in_mem[udp_simple::mtu]; //allocate max bytes for recv
+            const usrp2_ctrl_ops_data_t *in_data = reinterpret_cast<const usrp2_ctrl_ops_data_t *>(usrp2_ctrl_data_in_mem);
+            const size_t in_len = this->ctrl_transact(out_data.ctrl, len, usrp2_ctrl_data_in_mem, MIN_PROTO_COMPAT_OPS, USRP2_FW_COMPAT_NUM);
+            UHD_ASSERT_THROW(ntohl(in_data->ctrl.id) == USRP2_CTRL_ID_DID_ALL_THOSE_OPS_DUDE);
+            UHD_ASSERT_THROW(ntohl(in_data->ctrl.data.ops_args.num_ops) == num_ops and in_len >= len);
+
+            //copy out the readbacks
+            for (size_t i = 0; i < num_ops; i++){
+                result[first + i] = ntohl(in_data->ops[i].data);
+            }
+        }
+        return result;
+    }
+
+/***********************************************************************
+ * Peek snapshot
+ **********************************************************************/
+    void begin_peek_snapshot(const std::vector<wb_addr_type> &addrs){
+        this->end_peek_snapshot(); //the batch reads the device
+
+        ctrl_batch_t batch;
+        BOOST_FOREACH(const wb_addr_type addr, addrs) batch.peek32(addr);
+        const std::vector<boost::uint32_t> values = this->transact_batch(batch);
+
+        boost::mutex::scoped_lock lock(_snapshot_mutex);
+        for (size_t i = 0; i < addrs.size(); i++) _peek_snapshot[addrs[i]] = values[i];
+    }
+
+    void end_peek_snapshot(void){
+        boost::mutex::scoped_lock lock(_snapshot_mutex);
+        _peek_snapshot = uhd::dict<wb_addr_type, boost::uint32_t>();
+    }
+
+/***********************************************************************
+ * Timed commands
+ **********************************************************************/
+    void set_command_time(boost::uint32_t secs, boost::uint32_t ticks){
+        if (_protocol_compat < MIN_PROTO_COMPAT_TIMED) throw uhd::runtime_error(str(boost::format(
+            "\nPlease update the firmware and FPGA images for your device.\n"
+            "Timed commands need protocol compatibility number %d, but got %d."
+        ) % MIN_PROTO_COMPAT_TIMED % _protocol_compat));
+
+        boost::mutex::scoped_lock lock(_cmd_mutex);
+        //writes collected for another time go out first
+        if (_cmd_timed and (secs != _cmd_secs or ticks != _cmd_ticks)) this->send_timed_ops();
+        _cmd_timed = true;
+        _cmd_secs = secs;
+        _cmd_ticks = ticks;
+    }
+
+    void clear_command_time(void){
+        boost::mutex::scoped_lock lock(_cmd_mutex);
+        this->send_timed_ops();
+        _cmd_timed = false;
+    }
+
+    bool is_command_timed(void){
+        boost::mutex::scoped_lock lock(_cmd_mutex);
+        return _cmd_timed;
+    }
+
+    //! Send the collected writes once they fill an ops packet (call locked)
+    void send_timed_ops_when_full(void){
+        if (_cmd_batch.get_ops().size() >= USRP2_CTRL_MAX_OPS) this->send_timed_ops();
+    }
+
+    //! Hand the collected writes to the firmware's timed queue (call locked)
+    void send_timed_ops(void){
+        const std::vector<ctrl_batch_t::op_t> ops = _cmd_batch.get_ops();
+        _cmd_batch = ctrl_batch_t();
+        if (ops.empty()) return;
+        const size_t num_ops = ops.size();
+        const size_t len = sizeof(usrp2_ctrl_data_t) + num_ops*sizeof(usrp2_ctrl_op_t);
+
+        //setup the out data
+        usrp2_ctrl_ops_data_t out_data = usrp2_ctrl_ops_data_t();
+        out_data.ctrl.id = htonl(USRP2_CTRL_ID_DO_THESE_OPS_LATER_BRO);
+        out_data.ctrl.data.ops_args.num_ops = htonl(num_ops);
+        out_data.ctrl.data.ops_args.time_secs = htonl(_cmd_secs);
+        out_data.ctrl.data.ops_args.time_ticks = htonl(_cmd_ticks);
+        for (size_t i = 0; i < num_ops; i++){
+            load_otw_op(out_data.ops[i], ops[i]);
+        }
+
+        //send and recv, the firmware acks once the ops are queued
+        boost::uint8_t usrp2_ctrl_data_in_mem[udp_simple::mtu]; //allocate max bytes for recv
+        const usrp2_ctrl_data_t *in_data = reinterpret_cast<const usrp2_ctrl_data_t *>(usrp2_ctrl_data_in_mem);
+        this->ctrl_transact(out_data.ctrl, len, usrp2_ctrl_data_in_mem, MIN_PROTO_COMPAT_TIMED, USRP2_FW_COMPAT_NUM);
+        UHD_ASSERT_THROW(ntohl(in_data->id) == USRP2_CTRL_ID_OPS_ARE_QUEUED_UP_DUDE);
+        if (ntohl(in_data->data.ops_args.num_ops) != num_ops) throw uhd::runtime_error(str(boost::format(
+            "the firmware's timed command queue is full (%d batches),\n"
+            "the earlier commands have not reached their time yet"
+        ) % USRP2_CTRL_MAX_TIMED_BATCHES));
+    }
+
 /***********************************************************************
  * I2C
  **********************************************************************/
@@ -225,6 +481,12 @@ public:
         //copy in the data
         std::copy(buf.begin(), buf.end(), out_data.data.i2c_args.data);
 
+        //writes do not need the reply when pipelined
+        if (_ctrl_pipelined){
+            this->ctrl_send_pipelined(out_data, MIN_PROTO_COMPAT_I2C);
+            return;
+        }
+
         //send and recv
         usrp2_ctrl_data_t in_data = this->ctrl_send_and_recv(out_data, MIN_PROTO_COMPAT_I2C);
         UHD_ASSERT_THROW(ntohl(in_data.id) == USRP2_CTRL_ID_COOL_IM_DONE_I2C_WRITE_DUDE);
@@ -251,45 +513,255 @@ public:
         return result;
     }
 
+/***********************************************************************
+ * Queued I2C
+ **********************************************************************/
+    size_t queue_write_i2c(boost::uint8_t addr, const byte_vector_t &buf){
+        return this->queue_i2c(addr, buf, buf.size(), false);
+    }
+
+    size_t queue_read_i2c(boost::uint8_t addr, size_t num_bytes){
+        return this->queue_i2c(addr, byte_vector_t(), num_bytes, true);
+    }
+
+    byte_vector_t reap_i2c(size_t ticket, double timeout){
+        queued_i2c_t queued;
+        {
+            boost::mutex::scoped_lock lock(_i2c_mutex);
+            if (not _queued_i2c.has_key(ticket)) throw uhd::key_error(str(boost::format(
+                "no queued i2c transaction with ticket %u"
+            ) % ticket));
+            queued = _queued_i2c.pop(ticket);
+        }
+        if (queued.fw_ticket == 0) return queued.result; //transacted when queued
+
+        //setup the out data
+        usrp2_ctrl_data_t out_data = usrp2_ctrl_data_t();
+        out_data.id = htonl(USRP2_CTRL_ID_HOWS_MY_I2C_BRO);
+        out_data.data.queued_i2c_args.ticket = htonl(queued.fw_ticket);
+
+        //poll the firmware until the transaction is done
+        const boost::system_time exit_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+        while (true){
+            usrp2_ctrl_data_t in_data = this->ctrl_send_and_recv(out_data, MIN_PROTO_COMPAT_QUEUED_I2C, USRP2_FW_COMPAT_NUM);
+            UHD_ASSERT_THROW(ntohl(in_data.id) == USRP2_CTRL_ID_HERES_YOUR_I2C_DUDE);
+            switch(in_data.data.queued_i2c_args.status){
+            case USRP2_I2C_STATUS_DONE:
+                if (not queued.read) return byte_vector_t();
+                return byte_vector_t(
+                    in_data.data.queued_i2c_args.data,
+                    in_data.data.queued_i2c_args.data + queued.num_bytes
+                );
+
+            case USRP2_I2C_STATUS_PENDING: break;
+
+            default: throw uhd::io_error(str(boost::format(
+                "queued i2c %s of %u bytes at address 0x%02x failed"
+            ) % (queued.read? "read" : "write") % queued.num_bytes % int(queued.addr)));
+            }
+
+            if (boost::get_system_time() > exit_time) break;
+        }
+
+        //keep the ticket so the caller can reap it again
+        boost::mutex::scoped_lock lock(_i2c_mutex);
+        _queued_i2c[ticket] = queued;
+        throw uhd::runtime_error(str(boost::format(
+            "timed out waiting on the queued i2c transaction with ticket %u"
+        ) % ticket));
+    }
+
+    size_t queue_i2c(boost::uint8_t addr, const byte_vector_t &buf, size_t num_bytes, bool read){
+        UHD_ASSERT_THROW(num_bytes > 0 and num_bytes <= USRP2_CTRL_MAX_QUEUED_I2C_BYTES);
+
+        queued_i2c_t queued;
+        queued.addr = addr;
+        queued.num_bytes = num_bytes;
+        queued.read = read;
+        queued.fw_ticket = 0;
+
+        if (_protocol_compat >= MIN_PROTO_COMPAT_QUEUED_I2C){
+            //setup the out data
+            usrp2_ctrl_data_t out_data = usrp2_ctrl_data_t();
+            out_data.id = htonl(USRP2_CTRL_ID_QUEUE_THIS_I2C_BRO);
+            out_data.data.queued_i2c_args.addr = addr;
+            out_data.data.queued_i2c_args.bytes = num_bytes;
+            out_data.data.queued_i2c_args.flags = read? USRP2_I2C_FLAG_READ : 0;
+            std::copy(buf.begin(), buf.end(), out_data.data.queued_i2c_args.data);
+
+            //send and recv
+            usrp2_ctrl_data_t in_data = this->ctrl_send_and_recv(out_data, MIN_PROTO_COMPAT_QUEUED_I2C, USRP2_FW_COMPAT_NUM);
+            UHD_ASSERT_THROW(ntohl(in_data.id) == USRP2_CTRL_ID_I2C_IS_QUEUED_DUDE);
+            queued.fw_ticket = ntohl(in_data.data.queued_i2c_args.ticket);
+        }
+
+        //older firmware or a full queue: transact now
+        if (queued.fw_ticket == 0){
+            if (read) queued.result = this->read_i2c(addr, num_bytes);
+            else this->write_i2c(addr, buf);
+        }
+
+        boost::mutex::scoped_lock lock(_i2c_mutex);
+        const size_t ticket = ++_i2c_ticket;
+        _queued_i2c[ticket] = queued;
+        return ticket;
+    }
+
 /***********************************************************************
  * Send/Recv over control
  **********************************************************************/
+    void set_ctrl_pipelined(bool enb){
+        if (not enb) this->flush_ctrl();
+        boost::mutex::scoped_lock lock(_ctrl_mutex);
+        _ctrl_pipelined = enb;
+    }
+
+    bool is_ctrl_pipelined(void){
+        boost::mutex::scoped_lock lock(_ctrl_mutex);
+        return _ctrl_pipelined;
+    }
+
+    void flush_ctrl(void){
+        boost::mutex::scoped_lock lock(_ctrl_mutex);
+        boost::uint8_t usrp2_ctrl_data_in_mem[udp_simple::mtu]; //allocate max bytes for recv
+        while (not _ctrl_outstanding.empty()){
+            if (this->ctrl_recv(usrp2_ctrl_data_in_mem, MIN_PROTO_COMPAT_SPI, USRP2_FW_COMPAT_NUM) == 0){
+                this->throw_missing_acks();
+            }
+        }
+    }
+
+    /*!
+     * Send a control request without waiting for the reply.
+     * The seq number is remembered and the ack is reaped later,
+     * either opportunistically here, or by the next synchronous request.
+     * Must only be used for requests whose reply carries no data.
+     */
+    void ctrl_send_pipelined(
+        const usrp2_ctrl_data_t &out_data,
+        boost::uint32_t lo = USRP2_FW_COMPAT_NUM,
+        boost::uint32_t hi = USRP2_FW_COMPAT_NUM,
+        size_t len = sizeof(usrp2_ctrl_data_t)
+    ){
+        boost::mutex::scoped_lock lock(_ctrl_mutex);
+        boost::uint8_t usrp2_ctrl_data_in_mem[udp_simple::mtu]; //allocate max bytes for recv
+
+        //wait for an ack when the firmware has too many requests in flight
+        while (_ctrl_outstanding.size() >= CTRL_MAX_OUTSTANDING){
+            if (this->ctrl_recv(usrp2_ctrl_data_in_mem, lo, hi, CTRL_RECV_TIMEOUT) == 0){
+                this->throw_missing_acks();
+            }
+        }
+
+        _ctrl_outstanding.insert(this->ctrl_send(out_data, len));
+
+        //reap any acks that already arrived without blocking
+        while (not _ctrl_outstanding.empty()){
+            if (this->ctrl_recv(usrp2_ctrl_data_in_mem, lo, hi, 0.0) == 0) break;
+        }
+    }
+
     usrp2_ctrl_data_t ctrl_send_and_recv(
         const usrp2_ctrl_data_t &out_data,
         boost::uint32_t lo = USRP2_FW_COMPAT_NUM,
         boost::uint32_t hi = USRP2_FW_COMPAT_NUM
     ){
+        boost::uint8_t usrp2_ctrl_data_in_mem[udp_simple::mtu]; //allocate max bytes for recv
+        this->ctrl_transact(out_data, sizeof(usrp2_ctrl_data_t), usrp2_ctrl_data_in_mem, lo, hi);
+        return *reinterpret_cast<const usrp2_ctrl_data_t *>(usrp2_ctrl_data_in_mem);
+    }
+
+    /*!
+     * Send a control packet of len bytes and wait for its reply.
+     * \return the length of the reply written into in_mem
+     */
+    size_t ctrl_transact(
+        const usrp2_ctrl_data_t &out_data, size_t len,
+        boost::uint8_t *in_mem, boost::uint32_t lo, boost::uint32_t hi
+    ){
+        UHD_TRACE_SCOPE("ctrl_transact");
         boost::mutex::scoped_lock lock(_ctrl_mutex);
 
-        //fill in the seq number and send
-        usrp2_ctrl_data_t out_copy = out_data;
-        out_copy.proto_ver = htonl(_protocol_compat);
-        out_copy.seq = htonl(++_ctrl_seq_num);
-        _ctrl_transport->send(boost::asio::buffer(&out_copy, sizeof(usrp2_ctrl_data_t)));
+        const time_spec_t send_time = time_spec_t::get_system_time();
+        const boost::uint32_t seq = this->ctrl_send(out_data, len);
 
         //loop until we get the packet or timeout
-        boost::uint8_t usrp2_ctrl_data_in_mem[udp_simple::mtu]; //allocate max bytes for recv
-        const usrp2_ctrl_data_t *ctrl_data_in = reinterpret_cast<const usrp2_ctrl_data_t *>(usrp2_ctrl_data_in_mem);
+        const usrp2_ctrl_data_t *ctrl_data_in = reinterpret_cast<const usrp2_ctrl_data_t *>(in_mem);
         while(true){
-            size_t len = _ctrl_transport->recv(boost::asio::buffer(usrp2_ctrl_data_in_mem), CTRL_RECV_TIMEOUT);
-            boost::uint32_t compat = ntohl(ctrl_data_in->proto_ver);
-            if(len >= sizeof(boost::uint32_t) and (hi < compat or lo > compat)){
-                throw uhd::runtime_error(str(boost::format(
-                    "\nPlease update the firmware and FPGA images for your device.\n"
-                    "See the application notes for USRP2/N-Series for instructions.\n"
-                    "Expected protocol compatibility number %s, but got %d:\n"
-                    "The firmware build is not compatible with the host code build."
-                ) % ((lo == hi)? (boost::format("%d") % hi) : (boost::format("[%d to %d]") % lo % hi)) % compat));
+            size_t in_len = this->ctrl_recv(in_mem, lo, hi);
+            if (in_len >= sizeof(usrp2_ctrl_data_t) and ntohl(ctrl_data_in->seq) == seq){
+                this->record_ctrl_latency(time_spec_t::get_system_time() - send_time);
+                //the firmware handles requests in order:
+                //any pipelined request still outstanding was lost
+                if (not _ctrl_outstanding.empty()) this->throw_missing_acks();
+                return in_len;
             }
-            if (len >= sizeof(usrp2_ctrl_data_t) and ntohl(ctrl_data_in->seq) == _ctrl_seq_num){
-                return *ctrl_data_in;
-            }
-            if (len == 0) break; //timeout
+            if (in_len == 0) break; //timeout
             //didnt get seq or bad packet, continue looking...
         }
         throw uhd::runtime_error("no control response");
     }
 
+    //! Fill in the seq number and send, return the seq number (call locked)
+    boost::uint32_t ctrl_send(const usrp2_ctrl_data_t &out_data, size_t len){
+        boost::uint8_t usrp2_ctrl_data_out_mem[udp_simple::mtu];
+        UHD_ASSERT_THROW(len >= sizeof(usrp2_ctrl_data_t) and len <= sizeof(usrp2_ctrl_data_out_mem));
+        std::memcpy(usrp2_ctrl_data_out_mem, &out_data, len);
+        usrp2_ctrl_data_t *out_copy = reinterpret_cast<usrp2_ctrl_data_t *>(usrp2_ctrl_data_out_mem);
+        out_copy->proto_ver = htonl(_protocol_compat);
+        out_copy->seq = htonl(++_ctrl_seq_num);
+        _ctrl_transport->send(boost::asio::buffer(usrp2_ctrl_data_out_mem, len));
+        return _ctrl_seq_num;
+    }
+
+    /*!
+     * Receive one control packet and check its compat number (call locked).
+     * The ack for an outstanding pipelined request is reaped here.
+     * \return the length of the packet, 0 on timeout
+     */
+    size_t ctrl_recv(
+        boost::uint8_t *mem,
+        boost::uint32_t lo, boost::uint32_t hi,
+        double timeout = CTRL_RECV_TIMEOUT
+    ){
+        const usrp2_ctrl_data_t *ctrl_data_in = reinterpret_cast<const usrp2_ctrl_data_t *>(mem);
+        size_t len = _ctrl_transport->recv(boost::asio::buffer(mem, udp_simple::mtu), timeout);
+        boost::uint32_t compat = ntohl(ctrl_data_in->proto_ver);
+        if(len >= sizeof(boost::uint32_t) and (hi < compat or lo > compat)){
+            throw uhd::runtime_error(str(boost::format(
+                "\nPlease update the firmware and FPGA images for your device.\n"
+                "See the application notes for USRP2/N-Series for instructions.\n"
+                "Expected protocol compatibility number %s, but got %d:\n"
+                "The firmware build is not compatible with the host code build."
+            ) % ((lo == hi)? (boost::format("%d") % hi) : (boost::format("[%d to %d]") % lo % hi)) % compat));
+        }
+        if (len >= sizeof(usrp2_ctrl_data_t)){
+            _ctrl_outstanding.erase(ntohl(ctrl_data_in->seq));
+        }
+        return len;
+    }
+
+    //! Count a round trip, the stats have one writer under the control lock (call locked)
+    void record_ctrl_latency(const time_spec_t &latency){
+        const boost::uint32_t us = boost::uint32_t(latency.get_real_secs()*1e6);
+        _ctrl_stats[CTRL_STAT_TRANSACTIONS].inc();
+        _ctrl_stats[CTRL_STAT_LATENCY_US].write(_ctrl_stats[CTRL_STAT_LATENCY_US].read() + us);
+        if (us > _ctrl_stats[CTRL_STAT_MAX_LATENCY_US].read()) _ctrl_stats[CTRL_STAT_MAX_LATENCY_US].write(us);
+    }
+
+    size_t get_ctrl_stat(ctrl_stat_t stat){
+        return _ctrl_stats[stat].read();
+    }
+
+    //! Forget the lost pipelined requests and report them (call locked)
+    void throw_missing_acks(void){
+        const size_t num_missing = _ctrl_outstanding.size();
+        _ctrl_outstanding.clear();
+        throw uhd::runtime_error(str(boost::format(
+            "no control response for %u pipelined request(s)"
+        ) % num_missing));
+    }
+
     rev_type get_rev(void){
         switch (boost::lexical_cast<boost::uint16_t>(mb_eeprom["rev"])){
         case 0x0300:
@@ -329,6 +801,33 @@ private:
     boost::mutex _ctrl_mutex;
     boost::uint32_t _ctrl_seq_num;
     boost::uint32_t _protocol_compat;
+    uhd::atomic_uint32_t _ctrl_stats[NUM_CTRL_STATS];
+
+    //pipelined control: seq numbers sent but not yet acked
+    bool _ctrl_pipelined;
+    std::set<boost::uint32_t> _ctrl_outstanding;
+
+    //timed commands: writes collected for the command time
+    boost::mutex _cmd_mutex;
+    bool _cmd_timed;
+    boost::uint32_t _cmd_secs, _cmd_ticks;
+    ctrl_batch_t _cmd_batch;
+
+    //readback values served from a snapshot
+    boost::mutex _snapshot_mutex;
+    uhd::dict<wb_addr_type, boost::uint32_t> _peek_snapshot;
+
+    //queued i2c: the firmware ticket, or the result when transacted at once
+    struct queued_i2c_t{
+        boost::uint8_t addr;
+        size_t num_bytes;
+        bool read;
+        boost::uint32_t fw_ticket; //0 when transacted at once
+        byte_vector_t result;
+    };
+    boost::mutex _i2c_mutex;
+    size_t _i2c_ticket;
+    uhd::dict<size_t, queued_i2c_t> _queued_i2c;
 
     //lock thread stuff
     task::sptr _lock_task;
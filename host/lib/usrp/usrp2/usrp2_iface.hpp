@@ -20,6 +20,7 @@
 
 #include <uhd/transport/udp_simple.hpp>
 #include <uhd/types/serial.hpp>
+#include <uhd/types/dict.hpp>
 #include <uhd/usrp/mboard_eeprom.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
@@ -27,6 +28,7 @@
 #include "usrp2_regs.hpp"
 #include "wb_iface.hpp"
 #include <string>
+#include <vector>
 
 /*!
  * The usrp2 interface class:
@@ -66,6 +68,158 @@ public:
     //! Is this device locked?
     virtual bool is_device_locked(void) = 0;
 
+    /*!
+     * Program the framers of the dsps in one control round trip,
+     * so the dsps stream to this host without a first data packet.
+     * The framers stream to the host address of the control transport.
+     * \param ports the host udp port for each device dsp port
+     * \return true when all framers were programmed, false on older firmware
+     */
+    virtual bool setup_framers(const uhd::dict<boost::uint16_t, boost::uint16_t> &ports) = 0;
+
+    //! Does the firmware route and frame the second tx dsp?
+    virtual bool has_tx_dsp1(void) = 0;
+
+    /*!
+     * Enable or disable pipelined control.
+     * When pipelined, writes are sent without waiting for their acks;
+     * the acks are reaped as they arrive. A read or a flush waits on
+     * all outstanding acks and throws when a write went unanswered.
+     * \param enb true to enable pipelined control
+     */
+    virtual void set_ctrl_pipelined(bool enb) = 0;
+
+    //! Are the writes sent without waiting for their acks?
+    virtual bool is_ctrl_pipelined(void) = 0;
+
+    //! Wait on the acks for all outstanding pipelined writes
+    virtual void flush_ctrl(void) = 0;
+
+    //! The stats of the control transactions that wait for a reply
+    enum ctrl_stat_t{
+        CTRL_STAT_TRANSACTIONS = 0, //the replies received
+        CTRL_STAT_LATENCY_US,       //the sum of the round trips in microseconds
+        CTRL_STAT_MAX_LATENCY_US,   //the longest round trip in microseconds
+        NUM_CTRL_STATS
+    };
+
+    //! Get a control stat without waiting on the control lock (wraps at 32 bits)
+    virtual size_t get_ctrl_stat(ctrl_stat_t stat) = 0;
+
+    /*!
+     * A sequence of peeks, pokes, and spi transactions
+     * that transact_batch() performs in order as one control transaction.
+     */
+    class ctrl_batch_t{
+    public:
+        enum op_type{OP_POKE32, OP_PEEK32, OP_WRITE_SPI, OP_READ_SPI};
+
+        struct op_t{
+            op_type type;
+            boost::uint32_t addr; //register address or spi slave
+            boost::uint32_t data;
+            uhd::spi_config_t config;
+            size_t num_bits;
+        };
+
+        void poke32(wb_addr_type addr, boost::uint32_t data){
+            this->add(OP_POKE32, addr, data);
+        }
+
+        void peek32(wb_addr_type addr){
+            this->add(OP_PEEK32, addr, 0);
+        }
+
+        void write_spi(int which_slave, const uhd::spi_config_t &config, boost::uint32_t data, size_t num_bits){
+            this->add(OP_WRITE_SPI, which_slave, data, config, num_bits);
+        }
+
+        void read_spi(int which_slave, const uhd::spi_config_t &config, boost::uint32_t data, size_t num_bits){
+            this->add(OP_READ_SPI, which_slave, data, config, num_bits);
+        }
+
+        const std::vector<op_t> &get_ops(void) const{
+            return _ops;
+        }
+
+    private:
+        void add(
+            op_type type, boost::uint32_t addr, boost::uint32_t data,
+            const uhd::spi_config_t &config = uhd::spi_config_t(), size_t num_bits = 0
+        ){
+            op_t op;
+            op.type = type;
+            op.addr = addr;
+            op.data = data;
+            op.config = config;
+            op.num_bits = num_bits;
+            _ops.push_back(op);
+        }
+
+        std::vector<op_t> _ops;
+    };
+
+    /*!
+     * Perform the operations of a batch in order.
+     * The ops go out in as few control packets as possible;
+     * older firmware without ops packets gets one packet per op.
+     * A batch of only writes is fire-and-forget in pipelined mode.
+     * \param batch the sequence of operations
+     * \return the readback for each op (the written data for writes)
+     */
+    virtual std::vector<boost::uint32_t> transact_batch(const ctrl_batch_t &batch) = 0;
+
+    /*!
+     * Read a set of readback registers in one control transaction.
+     * Until end_peek_snapshot(), a peek32() of one of these addresses
+     * returns the value read here instead of asking the device,
+     * so several sensors of the same register see a single read.
+     * \param addrs the readback register addresses
+     */
+    virtual void begin_peek_snapshot(const std::vector<wb_addr_type> &addrs) = 0;
+
+    //! Go back to reading the registers from the device
+    virtual void end_peek_snapshot(void) = 0;
+
+    /*!
+     * Set the time for the writes that follow.
+     * Register writes and write-only spi transactions are collected
+     * and handed to the firmware in timed ops packets,
+     * which it executes once its time reaches secs and ticks.
+     * Reads are not timed and see the current state.
+     * \param secs the whole seconds of the command time
+     * \param ticks the fractional seconds in ticks
+     */
+    virtual void set_command_time(boost::uint32_t secs, boost::uint32_t ticks) = 0;
+
+    //! Send the collected timed writes and make writes immediate again
+    virtual void clear_command_time(void) = 0;
+
+    /*!
+     * Queue an i2c write on the firmware's interrupt driven i2c engine.
+     * The call returns once the write is queued, so other control
+     * traffic proceeds while the bus is busy; reap the ticket later.
+     * Older firmware and a full queue fall back to a synchronous write.
+     * Synchronous i2c transactions run after all queued transactions.
+     * \param addr the device address
+     * \param buf the bytes to write (1 to 16 bytes)
+     * \return a ticket for reap_i2c()
+     */
+    virtual size_t queue_write_i2c(boost::uint8_t addr, const uhd::byte_vector_t &buf) = 0;
+
+    //! Queue an i2c read of 1 to 16 bytes, see queue_write_i2c()
+    virtual size_t queue_read_i2c(boost::uint8_t addr, size_t num_bytes) = 0;
+
+    /*!
+     * Wait on a queued i2c transaction and collect its result.
+     * Throws when the transaction failed or did not finish in time;
+     * the ticket can be reaped again after a timeout.
+     * \param ticket the ticket from queue_write_i2c() or queue_read_i2c()
+     * \param timeout the time to wait in seconds
+     * \return the bytes read, empty for a write
+     */
+    virtual uhd::byte_vector_t reap_i2c(size_t ticket, double timeout = 1.0) = 0;
+
     //! A version string for firmware
     virtual const std::string get_fw_version_string(void) = 0;
 
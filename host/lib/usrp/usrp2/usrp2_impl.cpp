@@ -17,6 +17,7 @@
 
 #include "usrp2_impl.hpp"
 #include "fw_common.h"
+#include "open_timer.hpp"
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
@@ -27,64 +28,144 @@
 #include <uhd/utils/static.hpp>
 #include <uhd/utils/byteswap.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/algorithm.hpp>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/asio/ip/address_v4.hpp>
 #include <boost/asio.hpp> //used for htonl and ntohl
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/mutex.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
 
 using namespace uhd;
 using namespace uhd::usrp;
 using namespace uhd::transport;
 namespace asio = boost::asio;
+namespace fs = boost::filesystem;
 
 /***********************************************************************
- * Discovery over the udp transport
+ * On-disk caches in the UHD temp path
  **********************************************************************/
-static device_addrs_t usrp2_find(const device_addr_t &hint_){
-    //handle the multi-device discovery
-    device_addrs_t hints = separate_device_addr(hint_);
-    if (hints.size() > 1){
-        device_addrs_t found_devices;
-        BOOST_FOREACH(const device_addr_t &hint_i, hints){
-            device_addrs_t found_devices_i = usrp2_find(hint_i);
-            if (found_devices_i.size() != 1) throw uhd::value_error(str(boost::format(
-                "Could not resolve device hint \"%s\" to a single device."
-            ) % hint_i.to_string()));
-            found_devices.push_back(found_devices_i[0]);
+fs::path get_temp_path(void); //defined in paths.cpp
+
+struct cache_entry_t{
+    std::time_t time;
+    std::string key, value;
+};
+
+static boost::mutex cache_mutex; //serializes the stores of concurrent mboards
+
+static std::vector<cache_entry_t> load_cache(const std::string &name, const double ttl){
+    //one entry per line: time <tab> key <tab> value
+    std::vector<cache_entry_t> entries;
+    std::ifstream file((get_temp_path() / name).string().c_str());
+    const std::time_t now = std::time(NULL);
+    std::string line;
+    while (std::getline(file, line)){
+        std::istringstream ss(line);
+        cache_entry_t entry;
+        std::string time_str;
+        if (not std::getline(ss, time_str, '\t')) continue;
+        if (not std::getline(ss, entry.key, '\t')) continue;
+        if (not std::getline(ss, entry.value)) continue;
+        entry.time = std::time_t(std::atof(time_str.c_str()));
+        if (std::difftime(now, entry.time) > ttl) continue; //expired
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+static std::vector<std::string> get_cached(const std::string &name, const double ttl, const std::string &key){
+    std::vector<std::string> values;
+    BOOST_FOREACH(const cache_entry_t &entry, load_cache(name, ttl)){
+        if (entry.key == key) values.push_back(entry.value);
+    }
+    return values;
+}
+
+static void store_cache(
+    const std::string &name, const double ttl,
+    const std::string &key, const std::vector<std::string> &values
+){
+    //rewrite the unexpired entries of other keys and add the new ones
+    boost::mutex::scoped_lock lock(cache_mutex);
+    try{
+        const fs::path path = get_temp_path() / name;
+        const fs::path tmp_path = path.parent_path() / fs::unique_path(name + "-%%%%-%%%%.tmp");
+        {
+            std::ofstream file(tmp_path.string().c_str());
+            BOOST_FOREACH(const cache_entry_t &entry, load_cache(name, ttl)){
+                if (entry.key == key) continue;
+                file << entry.time << "\t" << entry.key << "\t" << entry.value << std::endl;
+            }
+            BOOST_FOREACH(const std::string &value, values){
+                file << std::time(NULL) << "\t" << key << "\t" << value << std::endl;
+            }
         }
-        return device_addrs_t(1, combine_device_addrs(found_devices));
+        fs::rename(tmp_path, path); //replace the old cache in one step
     }
+    catch(const std::exception &e){
+        UHD_LOG << "Cannot store the usrp2 cache " << name << ": " << e.what() << std::endl;
+    }
+}
 
-    //initialize the hint for a single device case
-    UHD_ASSERT_THROW(hints.size() <= 1);
-    hints.resize(1); //in case it was empty
-    device_addr_t hint = hints[0];
-    device_addrs_t usrp2_addrs;
+/***********************************************************************
+ * Discovery cache
+ *
+ * Setting UHD_USRP2_FIND_CACHE_TTL to a time in seconds enables an
+ * on-disk cache of the discovery results, so repeated finds with the
+ * same hint skip the network within that time. Empty results are not
+ * cached, a newly powered device is found on the next call.
+ * Cached devices are still checked for a lock, like discovered devices.
+ **********************************************************************/
+static const std::string find_cache_name = "uhd_usrp2_find_cache.txt";
 
-    //return an empty list of addresses when type is set to non-usrp2
-    if (hint.has_key("type") and hint["type"] != "usrp2") return usrp2_addrs;
+static double get_find_cache_ttl(void){
+    const char *ttl = std::getenv("UHD_USRP2_FIND_CACHE_TTL");
+    return (ttl == NULL)? 0.0 : std::atof(ttl);
+}
 
-    //if no address was specified, send a broadcast on each interface
-    if (not hint.has_key("addr")){
-        BOOST_FOREACH(const if_addrs_t &if_addrs, get_if_addrs()){
-            //avoid the loopback device
-            if (if_addrs.inet == asio::ip::address_v4::loopback().to_string()) continue;
-
-            //create a new hint with this broadcast address
-            device_addr_t new_hint = hint;
-            new_hint["addr"] = if_addrs.bcast;
-
-            //call discover with the new hint and append results
-            device_addrs_t new_usrp2_addrs = usrp2_find(new_hint);
-            usrp2_addrs.insert(usrp2_addrs.begin(),
-                new_usrp2_addrs.begin(), new_usrp2_addrs.end()
-            );
-        }
-        return usrp2_addrs;
+static bool is_device_locked(const device_addr_t &addr){
+    try{
+        return usrp2_iface::make(udp_simple::make_connected(
+            addr["addr"], BOOST_STRINGIZE(USRP2_UDP_CTRL_PORT)
+        ))->is_device_locked();
+    }
+    catch(const std::exception &){
+        return false; //same as discovery: a mismatched device may still be found
     }
+}
+
+static bool find_cached(const std::string &key, const double ttl, device_addrs_t &addrs){
+    BOOST_FOREACH(const std::string &addr, get_cached(find_cache_name, ttl, key)){
+        const device_addr_t cached_addr(addr);
+        if (is_device_locked(cached_addr)) continue; //ignore locked devices
+        addrs.push_back(cached_addr);
+    }
+    return not addrs.empty();
+}
+
+static void store_find_cache(const std::string &key, const double ttl, const device_addrs_t &addrs){
+    std::vector<std::string> values;
+    BOOST_FOREACH(const device_addr_t &addr, addrs) values.push_back(addr.to_string());
+    store_cache(find_cache_name, ttl, key, values);
+}
+
+/***********************************************************************
+ * Discovery over the udp transport
+ **********************************************************************/
+static device_addrs_t usrp2_find_addr(const device_addr_t &hint){
+    device_addrs_t usrp2_addrs;
 
     //Create a UDP transport to communicate:
     //Some devices will cause a throw when opened for a broadcast address.
@@ -104,11 +185,14 @@ static device_addrs_t usrp2_find(const device_addr_t &hint_){
     ctrl_data_out.id = uhd::htonx<boost::uint32_t>(USRP2_CTRL_ID_WAZZUP_BRO);
     udp_transport->send(boost::asio::buffer(&ctrl_data_out, sizeof(ctrl_data_out)));
 
-    //loop and recieve until the timeout
+    //loop and recieve until the deadline, then drain what is already queued
+    static const double find_timeout = 0.1; //100 ms
+    const boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds(long(find_timeout*1e6));
     boost::uint8_t usrp2_ctrl_data_in_mem[udp_simple::mtu]; //allocate max bytes for recv
     const usrp2_ctrl_data_t *ctrl_data_in = reinterpret_cast<const usrp2_ctrl_data_t *>(usrp2_ctrl_data_in_mem);
     while(true){
-        size_t len = udp_transport->recv(asio::buffer(usrp2_ctrl_data_in_mem));
+        const double timeout = std::max(0.0, (deadline - boost::get_system_time()).total_microseconds()/1e6);
+        size_t len = udp_transport->recv(asio::buffer(usrp2_ctrl_data_in_mem), timeout);
         if (len > offsetof(usrp2_ctrl_data_t, data) and ntohl(ctrl_data_in->id) == USRP2_CTRL_ID_WAZZUP_DUDE){
 
             //make a boost asio ipv4 with the raw addr in host byte order
@@ -152,6 +236,79 @@ static device_addrs_t usrp2_find(const device_addr_t &hint_){
     return usrp2_addrs;
 }
 
+static void usrp2_find_addr_task(const device_addr_t &hint, device_addrs_t *usrp2_addrs){
+    try{
+        *usrp2_addrs = usrp2_find_addr(hint);
+    }
+    catch(const std::exception &e){
+        UHD_MSG(error) << boost::format("Discovery on %s failed\n%s") % hint["addr"] % e.what() << std::endl;
+    }
+}
+
+static device_addrs_t usrp2_find_bcast(const device_addr_t &hint){
+    //create a new hint with the broadcast address of each interface
+    device_addrs_t bcast_hints;
+    BOOST_FOREACH(const if_addrs_t &if_addrs, get_if_addrs()){
+        //avoid the loopback device
+        if (if_addrs.inet == asio::ip::address_v4::loopback().to_string()) continue;
+        device_addr_t new_hint = hint;
+        new_hint["addr"] = if_addrs.bcast;
+        bcast_hints.push_back(new_hint);
+    }
+
+    //broadcast on all interfaces at once, so the timeouts overlap
+    std::vector<device_addrs_t> bcast_addrs(bcast_hints.size());
+    boost::thread_group threads;
+    for (size_t i = 0; i < bcast_hints.size(); i++){
+        threads.create_thread(boost::bind(&usrp2_find_addr_task, bcast_hints[i], &bcast_addrs[i]));
+    }
+    threads.join_all();
+
+    //append results in the same order as the serial search did
+    device_addrs_t usrp2_addrs;
+    BOOST_FOREACH(const device_addrs_t &new_usrp2_addrs, bcast_addrs){
+        usrp2_addrs.insert(usrp2_addrs.begin(),
+            new_usrp2_addrs.begin(), new_usrp2_addrs.end()
+        );
+    }
+    return usrp2_addrs;
+}
+
+static device_addrs_t usrp2_find(const device_addr_t &hint_){
+    //handle the multi-device discovery
+    device_addrs_t hints = separate_device_addr(hint_);
+    if (hints.size() > 1){
+        device_addrs_t found_devices;
+        BOOST_FOREACH(const device_addr_t &hint_i, hints){
+            device_addrs_t found_devices_i = usrp2_find(hint_i);
+            if (found_devices_i.size() != 1) throw uhd::value_error(str(boost::format(
+                "Could not resolve device hint \"%s\" to a single device."
+            ) % hint_i.to_string()));
+            found_devices.push_back(found_devices_i[0]);
+        }
+        return device_addrs_t(1, combine_device_addrs(found_devices));
+    }
+
+    //initialize the hint for a single device case
+    UHD_ASSERT_THROW(hints.size() <= 1);
+    hints.resize(1); //in case it was empty
+    device_addr_t hint = hints[0];
+    device_addrs_t usrp2_addrs;
+
+    //return an empty list of addresses when type is set to non-usrp2
+    if (hint.has_key("type") and hint["type"] != "usrp2") return usrp2_addrs;
+
+    //use the recent results for this hint when the cache is enabled
+    const double cache_ttl = get_find_cache_ttl();
+    if (cache_ttl > 0 and find_cached(hint.to_string(), cache_ttl, usrp2_addrs)) return usrp2_addrs;
+
+    //if no address was specified, send a broadcast on each interface
+    usrp2_addrs = hint.has_key("addr")? usrp2_find_addr(hint) : usrp2_find_bcast(hint);
+
+    if (cache_ttl > 0 and not usrp2_addrs.empty()) store_find_cache(hint.to_string(), cache_ttl, usrp2_addrs);
+    return usrp2_addrs;
+}
+
 /***********************************************************************
  * Make
  **********************************************************************/
@@ -170,72 +327,238 @@ struct mtu_result_t{
     size_t recv_mtu, send_mtu;
 };
 
+/*!
+ * Setting UHD_USRP2_MTU_CACHE_TTL to a time in seconds caches the results
+ * per device address and requested sizes. A warm open confirms the cached
+ * sizes with one round of probes and skips the search when they still work.
+ */
+static const std::string mtu_cache_name = "uhd_usrp2_mtu_cache.txt";
+static const size_t mtu_probes_per_round = 4;
+static const size_t mtu_probe_retries = 1; //a lost reply does not shrink the range
+static const double echo_timeout = 0.020; //20 ms
+
+static double get_mtu_cache_ttl(void){
+    const char *ttl = std::getenv("UHD_USRP2_MTU_CACHE_TTL");
+    return (ttl == NULL)? 0.0 : std::atof(ttl);
+}
+
+struct mtu_probe_t{
+    bool recv; //probes the recv direction, else the send direction
+    size_t size;
+    bool ok;
+};
+
+/*!
+ * Send the pending probes at once, then gather the replies until the timeout.
+ * The sequence number identifies the probe of each reply.
+ */
+static size_t run_mtu_probes_once(
+    udp_simple::sptr udp_sock,
+    std::vector<boost::uint8_t> &buffer,
+    std::vector<mtu_probe_t> &probes,
+    boost::uint32_t &seq
+){
+    usrp2_ctrl_data_t *ctrl_data = reinterpret_cast<usrp2_ctrl_data_t *>(&buffer.front());
+    const boost::uint32_t first_seq = seq;
+    std::vector<size_t> sent; //probe index by sequence offset
+    for (size_t i = 0; i < probes.size(); i++){
+        if (probes[i].ok) continue;
+        ctrl_data->id = htonl(USRP2_CTRL_ID_HOLLER_AT_ME_BRO);
+        ctrl_data->proto_ver = htonl(USRP2_FW_COMPAT_NUM);
+        ctrl_data->seq = htonl(seq++);
+        if (probes[i].recv){ //small request, reply the size of the probe
+            ctrl_data->data.echo_args.len = htonl(probes[i].size);
+            udp_sock->send(boost::asio::buffer(buffer, sizeof(usrp2_ctrl_data_t)));
+        }
+        else{ //request the size of the probe, small reply with the received length
+            ctrl_data->data.echo_args.len = htonl(sizeof(usrp2_ctrl_data_t));
+            udp_sock->send(boost::asio::buffer(buffer, probes[i].size));
+        }
+        sent.push_back(i);
+    }
+
+    const boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds(long(echo_timeout*1e6));
+    size_t num_pending = sent.size();
+    while (num_pending != 0){
+        const double timeout = std::max(0.0, (deadline - boost::get_system_time()).total_microseconds()/1e6);
+        size_t len = udp_sock->recv(boost::asio::buffer(buffer), timeout);
+        if (len == 0) break; //timeout
+        if (len < sizeof(usrp2_ctrl_data_t)) continue;
+        if (ntohl(ctrl_data->id) != USRP2_CTRL_ID_HOLLER_BACK_DUDE) continue;
+
+        //ignore late replies from an earlier round
+        const boost::uint32_t j = ntohl(ctrl_data->seq) - first_seq;
+        if (j >= sent.size() or probes[sent[j]].ok) continue;
+        mtu_probe_t &probe = probes[sent[j]];
+        if (not probe.recv) len = ntohl(ctrl_data->data.echo_args.len);
+        if (len < probe.size) continue;
+        probe.ok = true;
+        num_pending--;
+    }
+    return num_pending;
+}
+
+/*!
+ * Run the probes, and send the unanswered probes again before they fail,
+ * so a reply lost to a burst of probes does not shrink the range.
+ */
+static void run_mtu_probes(
+    udp_simple::sptr udp_sock,
+    std::vector<boost::uint8_t> &buffer,
+    std::vector<mtu_probe_t> &probes,
+    boost::uint32_t &seq
+){
+    for (size_t i = 0; i < probes.size(); i++) probes[i].ok = false;
+    for (size_t attempt = 0; attempt <= mtu_probe_retries; attempt++){
+        if (run_mtu_probes_once(udp_sock, buffer, probes, seq) == 0) return;
+    }
+}
+
+//! The largest size known to work and the largest size that may work
+struct mtu_range_t{
+    size_t lo, hi;
+};
+
+static void add_mtu_probes(std::vector<mtu_probe_t> &probes, const bool recv, const mtu_range_t &range){
+    //split the range evenly, the last probe tests the upper bound
+    size_t last_size = range.lo;
+    for (size_t k = 1; k <= mtu_probes_per_round; k++){
+        const size_t size = (range.lo + (range.hi - range.lo)*k/mtu_probes_per_round) & ~size_t(3);
+        if (size <= last_size) continue;
+        mtu_probe_t probe;
+        probe.recv = recv;
+        probe.size = size;
+        probes.push_back(probe);
+        last_size = size;
+    }
+}
+
+static void update_mtu_range(const std::vector<mtu_probe_t> &probes, const bool recv, mtu_range_t &range){
+    BOOST_FOREACH(const mtu_probe_t &probe, probes){
+        if (probe.recv == recv and probe.ok) range.lo = std::max(range.lo, probe.size);
+    }
+    BOOST_FOREACH(const mtu_probe_t &probe, probes){
+        if (probe.recv == recv and not probe.ok and probe.size > range.lo) range.hi = std::min(range.hi, probe.size - 4);
+    }
+    range.hi = std::max(range.lo, range.hi);
+}
+
 static mtu_result_t determine_mtu(const std::string &addr, const mtu_result_t &user_mtu){
     udp_simple::sptr udp_sock = udp_simple::make_connected(
         addr, BOOST_STRINGIZE(USRP2_UDP_CTRL_PORT)
     );
 
-    //The FPGA offers 4K buffers, and the user may manually request this.
+    //The FPGA offers 4K buffers (8K on jumbo capable N-Series images),
+    //and the user may manually request this; the device init clips to the image.
     //However, multiple simultaneous receives (2DSP slave + 2DSP master),
     //require that buffering to be used internally, and this is a safe setting.
-    std::vector<boost::uint8_t> buffer(std::max(user_mtu.recv_mtu, user_mtu.send_mtu));
+    std::vector<boost::uint8_t> buffer(std::max(std::max(user_mtu.recv_mtu, user_mtu.send_mtu), sizeof(usrp2_ctrl_data_t)));
     usrp2_ctrl_data_t *ctrl_data = reinterpret_cast<usrp2_ctrl_data_t *>(&buffer.front());
-    static const double echo_timeout = 0.020; //20 ms
+    boost::uint32_t seq = 0;
 
     //test holler - check if its supported in this fw version
     ctrl_data->id = htonl(USRP2_CTRL_ID_HOLLER_AT_ME_BRO);
     ctrl_data->proto_ver = htonl(USRP2_FW_COMPAT_NUM);
+    ctrl_data->seq = htonl(seq++);
     ctrl_data->data.echo_args.len = htonl(sizeof(usrp2_ctrl_data_t));
     udp_sock->send(boost::asio::buffer(buffer, sizeof(usrp2_ctrl_data_t)));
     udp_sock->recv(boost::asio::buffer(buffer), echo_timeout);
     if (ntohl(ctrl_data->id) != USRP2_CTRL_ID_HOLLER_BACK_DUDE)
         throw uhd::not_implemented_error("holler protocol not implemented");
 
-    size_t min_recv_mtu = sizeof(usrp2_ctrl_data_t), max_recv_mtu = user_mtu.recv_mtu;
-    size_t min_send_mtu = sizeof(usrp2_ctrl_data_t), max_send_mtu = user_mtu.send_mtu;
-
-    while (min_recv_mtu < max_recv_mtu){
+    //confirm the cached sizes with one round of probes
+    const double cache_ttl = get_mtu_cache_ttl();
+    const std::string cache_key = str(boost::format("%s %u %u") % addr % user_mtu.recv_mtu % user_mtu.send_mtu);
+    const std::vector<std::string> cached = (cache_ttl > 0)?
+        get_cached(mtu_cache_name, cache_ttl, cache_key) : std::vector<std::string>();
+    mtu_result_t mtu;
+    std::istringstream cached_ss((cached.size() == 1)? cached.front() : "");
+    if (cached_ss >> mtu.recv_mtu >> mtu.send_mtu){
+        std::vector<mtu_probe_t> probes(2);
+        probes[0].recv = true;
+        probes[0].size = mtu.recv_mtu;
+        probes[1].recv = false;
+        probes[1].size = mtu.send_mtu;
+        run_mtu_probes(udp_sock, buffer, probes, seq);
+        if (probes[0].ok and probes[1].ok) return mtu;
+    }
 
-        size_t test_mtu = (max_recv_mtu/2 + min_recv_mtu/2 + 3) & ~3;
+    //search both directions at once, each round narrows the ranges
+    mtu_range_t recv_range, send_range;
+    recv_range.lo = send_range.lo = sizeof(usrp2_ctrl_data_t);
+    recv_range.hi = std::max(recv_range.lo, user_mtu.recv_mtu & ~size_t(3));
+    send_range.hi = std::max(send_range.lo, user_mtu.send_mtu & ~size_t(3));
+    while (recv_range.lo < recv_range.hi or send_range.lo < send_range.hi){
+        std::vector<mtu_probe_t> probes;
+        add_mtu_probes(probes, true, recv_range);
+        add_mtu_probes(probes, false, send_range);
+        run_mtu_probes(udp_sock, buffer, probes, seq);
+        update_mtu_range(probes, true, recv_range);
+        update_mtu_range(probes, false, send_range);
+    }
 
-        ctrl_data->id = htonl(USRP2_CTRL_ID_HOLLER_AT_ME_BRO);
-        ctrl_data->proto_ver = htonl(USRP2_FW_COMPAT_NUM);
-        ctrl_data->data.echo_args.len = htonl(test_mtu);
-        udp_sock->send(boost::asio::buffer(buffer, sizeof(usrp2_ctrl_data_t)));
+    mtu.recv_mtu = recv_range.lo;
+    mtu.send_mtu = send_range.lo;
+    if (cache_ttl > 0) store_cache(mtu_cache_name, cache_ttl, cache_key, std::vector<std::string>(
+        1, str(boost::format("%u %u") % mtu.recv_mtu % mtu.send_mtu)
+    ));
+    return mtu;
+}
 
-        size_t len = udp_sock->recv(boost::asio::buffer(buffer), echo_timeout);
+static void store_mtu(const std::string &addr, const mtu_result_t &user_mtu, mtu_result_t *mtu){
+    *mtu = determine_mtu(addr, user_mtu);
+}
 
-        if (len >= test_mtu) min_recv_mtu = test_mtu;
-        else                 max_recv_mtu = test_mtu - 4;
+/***********************************************************************
+ * Per-mboard tasks
+ **********************************************************************/
+typedef boost::function<void(void)> mb_task_type;
 
+static void run_mb_task(const mb_task_type &task, boost::shared_ptr<uhd::exception> &error){
+    //capture the error so the caller can rethrow it after the join
+    try{
+        task();
     }
+    catch(const uhd::exception &e){
+        error.reset(e.dynamic_clone());
+    }
+    catch(const std::exception &e){
+        error.reset(new uhd::runtime_error(e.what()));
+    }
+}
 
-    while (min_send_mtu < max_send_mtu){
-
-        size_t test_mtu = (max_send_mtu/2 + min_send_mtu/2 + 3) & ~3;
-
-        ctrl_data->id = htonl(USRP2_CTRL_ID_HOLLER_AT_ME_BRO);
-        ctrl_data->proto_ver = htonl(USRP2_FW_COMPAT_NUM);
-        ctrl_data->data.echo_args.len = htonl(sizeof(usrp2_ctrl_data_t));
-        udp_sock->send(boost::asio::buffer(buffer, test_mtu));
-
-        size_t len = udp_sock->recv(boost::asio::buffer(buffer), echo_timeout);
-        if (len >= sizeof(usrp2_ctrl_data_t)) len = ntohl(ctrl_data->data.echo_args.len);
+/*!
+ * Run one task per mboard, each on its own thread.
+ * When tasks fail, the error of the lowest mboard index is rethrown,
+ * so the outcome does not depend on the thread scheduling.
+ */
+static void run_mb_tasks(const std::vector<mb_task_type> &tasks){
+    //a single mboard does not need a thread
+    if (tasks.size() <= 1){
+        BOOST_FOREACH(const mb_task_type &task, tasks) task();
+        return;
+    }
 
-        if (len >= test_mtu) min_send_mtu = test_mtu;
-        else                 max_send_mtu = test_mtu - 4;
+    std::vector<boost::shared_ptr<uhd::exception> > errors(tasks.size());
+    boost::thread_group threads;
+    for (size_t i = 0; i < tasks.size(); i++){
+        threads.create_thread(boost::bind(&run_mb_task, boost::cref(tasks[i]), boost::ref(errors[i])));
     }
+    threads.join_all();
 
-    mtu_result_t mtu;
-    mtu.recv_mtu = min_recv_mtu;
-    mtu.send_mtu = min_send_mtu;
-    return mtu;
+    boost::shared_ptr<uhd::exception> first_error;
+    for (size_t i = 0; i < errors.size(); i++){
+        if (errors[i].get() == NULL) continue;
+        if (first_error.get() == NULL) first_error = errors[i];
+        else UHD_MSG(error) << boost::format("Motherboard %u: %s") % i % errors[i]->what() << std::endl;
+    }
+    if (first_error.get() != NULL) first_error->dynamic_throw();
 }
 
 /***********************************************************************
  * Helpers
  **********************************************************************/
-static zero_copy_if::sptr make_xport(
+static udp_zero_copy::sptr make_xport(
     const std::string &addr,
     const std::string &port,
     const device_addr_t &hints,
@@ -250,11 +573,12 @@ static zero_copy_if::sptr make_xport(
     }
 
     //make the transport object with the filtered hints
-    zero_copy_if::sptr xport = udp_zero_copy::make(addr, port, filtered_hints);
+    return udp_zero_copy::make(addr, port, filtered_hints);
+}
 
-    //Send a small data packet so the usrp2 knows the udp source port.
-    //This setup must happen before further initialization occurs
-    //or the async update packets will cause ICMP destination unreachable.
+//Send a small data packet so the usrp2 knows the udp source port.
+//Only older firmware needs this, newer firmware takes the framer setup packet.
+static void send_hello_packet(zero_copy_if::sptr xport){
     static const boost::uint32_t data[2] = {
         uhd::htonx(boost::uint32_t(0 /* don't care seq num */)),
         uhd::htonx(boost::uint32_t(USRP2_INVALID_VRT_HEADER))
@@ -262,8 +586,17 @@ static zero_copy_if::sptr make_xport(
     transport::managed_send_buffer::sptr send_buff = xport->get_send_buff();
     std::memcpy(send_buff->cast<void*>(), &data, sizeof(data));
     send_buff->commit(sizeof(data));
+    xport->flush_send_buffs();
+}
 
-    return xport;
+//Write the registers of a stream command in one control transaction:
+//one control round trip per command instead of one per register.
+static void poke_stream_cmd_batch(usrp2_iface::sptr iface, const rx_dsp_core_200::pokes_type &pokes){
+    usrp2_iface::ctrl_batch_t batch;
+    for (size_t i = 0; i < pokes.size(); i++){
+        batch.poke32(pokes[i].first, pokes[i].second);
+    }
+    iface->transact_batch(batch);
 }
 
 /***********************************************************************
@@ -290,6 +623,7 @@ usrp2_impl::usrp2_impl(const device_addr_t &_device_addr){
     }
 
     device_addrs_t device_args = separate_device_addr(device_addr);
+    const time_spec_t mtu_start_time = time_spec_t::get_system_time();
 
     //extract the user's requested MTU size or default
     mtu_result_t user_mtu;
@@ -298,11 +632,16 @@ usrp2_impl::usrp2_impl(const device_addr_t &_device_addr){
 
     try{
         //calculate the minimum send and recv mtu of all devices
-        mtu_result_t mtu = determine_mtu(device_args[0]["addr"], user_mtu);
-        for (size_t i = 1; i < device_args.size(); i++){
-            mtu_result_t mtu_i = determine_mtu(device_args[i]["addr"], user_mtu);
-            mtu.recv_mtu = std::min(mtu.recv_mtu, mtu_i.recv_mtu);
-            mtu.send_mtu = std::min(mtu.send_mtu, mtu_i.send_mtu);
+        std::vector<mtu_result_t> mtus(device_args.size());
+        std::vector<mb_task_type> mtu_tasks;
+        for (size_t i = 0; i < device_args.size(); i++){
+            mtu_tasks.push_back(boost::bind(&store_mtu, device_args[i]["addr"], user_mtu, &mtus[i]));
+        }
+        run_mb_tasks(mtu_tasks);
+        mtu_result_t mtu = mtus[0];
+        for (size_t i = 1; i < mtus.size(); i++){
+            mtu.recv_mtu = std::min(mtu.recv_mtu, mtus[i].recv_mtu);
+            mtu.send_mtu = std::min(mtu.send_mtu, mtus[i].send_mtu);
         }
 
         device_addr["recv_frame_size"] = boost::lexical_cast<std::string>(mtu.recv_mtu);
@@ -322,276 +661,23 @@ usrp2_impl::usrp2_impl(const device_addr_t &_device_addr){
     ////////////////////////////////////////////////////////////////////
     _tree = property_tree::make();
     _tree->create<std::string>("/name").set("USRP2 / N-Series Device");
+    record_open_time(_tree, "/", "mtu", (time_spec_t::get_system_time() - mtu_start_time).get_real_secs());
+    open_timer timer(_tree, "/");
 
+    //create the mboard entries in order, the mboards are set up concurrently
+    std::vector<mb_task_type> mb_tasks;
     for (size_t mbi = 0; mbi < device_args.size(); mbi++){
-        const device_addr_t device_args_i = device_args[mbi];
         const std::string mb = boost::lexical_cast<std::string>(mbi);
-        const std::string addr = device_args_i["addr"];
-        const fs_path mb_path = "/mboards/" + mb;
-
-        ////////////////////////////////////////////////////////////////
-        // create the iface that controls i2c, spi, uart, and wb
-        ////////////////////////////////////////////////////////////////
-        _mbc[mb].iface = usrp2_iface::make(udp_simple::make_connected(
-            addr, BOOST_STRINGIZE(USRP2_UDP_CTRL_PORT)
-        ));
-        _tree->create<std::string>(mb_path / "name").set(_mbc[mb].iface->get_cname());
-        _tree->create<std::string>(mb_path / "fw_version").set(_mbc[mb].iface->get_fw_version_string());
-
-        //check the fpga compatibility number
-        const boost::uint32_t fpga_compat_num = _mbc[mb].iface->peek32(U2_REG_COMPAT_NUM_RB);
-        boost::uint16_t fpga_major = fpga_compat_num >> 16, fpga_minor = fpga_compat_num & 0xffff;
-        if (fpga_major == 0){ //old version scheme
-            fpga_major = fpga_minor;
-            fpga_minor = 0;
-        }
-        if (fpga_major != USRP2_FPGA_COMPAT_NUM){
-            throw uhd::runtime_error(str(boost::format(
-                "\nPlease update the firmware and FPGA images for your device.\n"
-                "See the application notes for USRP2/N-Series for instructions.\n"
-                "Expected FPGA compatibility number %d, but got %d:\n"
-                "The FPGA build is not compatible with the host code build."
-            ) % int(USRP2_FPGA_COMPAT_NUM) % fpga_major));
-        }
-        _tree->create<std::string>(mb_path / "fpga_version").set(str(boost::format("%u.%u") % fpga_major % fpga_minor));
-
-        //lock the device/motherboard to this process
-        _mbc[mb].iface->lock_device(true);
-
-        ////////////////////////////////////////////////////////////////
-        // construct transports for RX and TX DSPs
-        ////////////////////////////////////////////////////////////////
-        UHD_LOG << "Making transport for RX DSP0..." << std::endl;
-        _mbc[mb].rx_dsp_xports.push_back(make_xport(
-            addr, BOOST_STRINGIZE(USRP2_UDP_RX_DSP0_PORT), device_args_i, "recv"
-        ));
-        UHD_LOG << "Making transport for RX DSP1..." << std::endl;
-        _mbc[mb].rx_dsp_xports.push_back(make_xport(
-            addr, BOOST_STRINGIZE(USRP2_UDP_RX_DSP1_PORT), device_args_i, "recv"
-        ));
-        UHD_LOG << "Making transport for TX DSP0..." << std::endl;
-        _mbc[mb].tx_dsp_xport = make_xport(
-            addr, BOOST_STRINGIZE(USRP2_UDP_TX_DSP0_PORT), device_args_i, "send"
-        );
-        //set the filter on the router to take dsp data from this port
-        _mbc[mb].iface->poke32(U2_REG_ROUTER_CTRL_PORTS, USRP2_UDP_TX_DSP0_PORT);
-
-        ////////////////////////////////////////////////////////////////
-        // setup the mboard eeprom
-        ////////////////////////////////////////////////////////////////
-        _tree->create<mboard_eeprom_t>(mb_path / "eeprom")
-            .set(_mbc[mb].iface->mb_eeprom)
-            .subscribe(boost::bind(&usrp2_impl::set_mb_eeprom, this, mb, _1));
-
-        ////////////////////////////////////////////////////////////////
-        // create clock control objects
-        ////////////////////////////////////////////////////////////////
-        _mbc[mb].clock = usrp2_clock_ctrl::make(_mbc[mb].iface);
-        _tree->create<double>(mb_path / "tick_rate")
-            .publish(boost::bind(&usrp2_clock_ctrl::get_master_clock_rate, _mbc[mb].clock))
-            .subscribe(boost::bind(&usrp2_impl::update_tick_rate, this, _1));
-
-        ////////////////////////////////////////////////////////////////
-        // create codec control objects
-        ////////////////////////////////////////////////////////////////
-        const fs_path rx_codec_path = mb_path / "rx_codecs/A";
-        const fs_path tx_codec_path = mb_path / "tx_codecs/A";
-        _tree->create<int>(rx_codec_path / "gains"); //phony property so this dir exists
-        _tree->create<int>(tx_codec_path / "gains"); //phony property so this dir exists
-        _mbc[mb].codec = usrp2_codec_ctrl::make(_mbc[mb].iface);
-        switch(_mbc[mb].iface->get_rev()){
-        case usrp2_iface::USRP_N200:
-        case usrp2_iface::USRP_N210:
-        case usrp2_iface::USRP_N200_R4:
-        case usrp2_iface::USRP_N210_R4:{
-            _tree->create<std::string>(rx_codec_path / "name").set("ads62p44");
-            _tree->create<meta_range_t>(rx_codec_path / "gains/digital/range").set(meta_range_t(0, 6.0, 0.5));
-            _tree->create<double>(rx_codec_path / "gains/digital/value")
-                .subscribe(boost::bind(&usrp2_codec_ctrl::set_rx_digital_gain, _mbc[mb].codec, _1)).set(0);
-            _tree->create<meta_range_t>(rx_codec_path / "gains/fine/range").set(meta_range_t(0, 0.5, 0.05));
-            _tree->create<double>(rx_codec_path / "gains/fine/value")
-                .subscribe(boost::bind(&usrp2_codec_ctrl::set_rx_digital_fine_gain, _mbc[mb].codec, _1)).set(0);
-        }break;
-
-        case usrp2_iface::USRP2_REV3:
-        case usrp2_iface::USRP2_REV4:
-            _tree->create<std::string>(rx_codec_path / "name").set("ltc2284");
-            break;
-
-        case usrp2_iface::USRP_NXXX:
-            _tree->create<std::string>(rx_codec_path / "name").set("??????");
-            break;
-        }
-        _tree->create<std::string>(tx_codec_path / "name").set("ad9777");
-
-        ////////////////////////////////////////////////////////////////
-        // create gpsdo control objects
-        ////////////////////////////////////////////////////////////////
-        if (_mbc[mb].iface->mb_eeprom["gpsdo"] == "internal"){
-            _mbc[mb].gps = gps_ctrl::make(udp_simple::make_uart(udp_simple::make_connected(
-                addr, BOOST_STRINGIZE(USRP2_UDP_UART_GPS_PORT)
-            )));
-            if(_mbc[mb].gps->gps_detected()) {
-                BOOST_FOREACH(const std::string &name, _mbc[mb].gps->get_sensors()){
-                    _tree->create<sensor_value_t>(mb_path / "sensors" / name)
-                        .publish(boost::bind(&gps_ctrl::get_sensor, _mbc[mb].gps, name));
-                }
-            }
-        }
-
-        ////////////////////////////////////////////////////////////////
-        // and do the misc mboard sensors
-        ////////////////////////////////////////////////////////////////
-        _tree->create<sensor_value_t>(mb_path / "sensors/mimo_locked")
-            .publish(boost::bind(&usrp2_impl::get_mimo_locked, this, mb));
-        _tree->create<sensor_value_t>(mb_path / "sensors/ref_locked")
-            .publish(boost::bind(&usrp2_impl::get_ref_locked, this, mb));
-
-        ////////////////////////////////////////////////////////////////
-        // create frontend control objects
-        ////////////////////////////////////////////////////////////////
-        _mbc[mb].rx_fe = rx_frontend_core_200::make(
-            _mbc[mb].iface, U2_REG_SR_ADDR(SR_RX_FRONT)
-        );
-        _mbc[mb].tx_fe = tx_frontend_core_200::make(
-            _mbc[mb].iface, U2_REG_SR_ADDR(SR_TX_FRONT)
-        );
-        //TODO lots of properties to expose here for frontends
-        _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec")
-            .coerce(boost::bind(&usrp2_impl::update_rx_subdev_spec, this, mb, _1));
-        _tree->create<subdev_spec_t>(mb_path / "tx_subdev_spec")
-            .coerce(boost::bind(&usrp2_impl::update_tx_subdev_spec, this, mb, _1));
-
-        ////////////////////////////////////////////////////////////////
-        // create rx dsp control objects
-        ////////////////////////////////////////////////////////////////
-        _mbc[mb].rx_dsps.push_back(rx_dsp_core_200::make(
-            _mbc[mb].iface, U2_REG_SR_ADDR(SR_RX_DSP0), U2_REG_SR_ADDR(SR_RX_CTRL0), USRP2_RX_SID_BASE + 0, true
-        ));
-        _mbc[mb].rx_dsps.push_back(rx_dsp_core_200::make(
-            _mbc[mb].iface, U2_REG_SR_ADDR(SR_RX_DSP1), U2_REG_SR_ADDR(SR_RX_CTRL1), USRP2_RX_SID_BASE + 1, true
-        ));
-        for (size_t dspno = 0; dspno < _mbc[mb].rx_dsps.size(); dspno++){
-            _mbc[mb].rx_dsps[dspno]->set_link_rate(USRP2_LINK_RATE_BPS);
-            _tree->access<double>(mb_path / "tick_rate")
-                .subscribe(boost::bind(&rx_dsp_core_200::set_tick_rate, _mbc[mb].rx_dsps[dspno], _1));
-            //This is a hack/fix for the lingering packet problem.
-            //The dsp core starts streaming briefly... now we flush
-            _mbc[mb].rx_dsp_xports[dspno]->get_recv_buff(0.01).get(); //recv with timeout for lingering
-            _mbc[mb].rx_dsp_xports[dspno]->get_recv_buff(0.01).get(); //recv with timeout for expected
-            fs_path rx_dsp_path = mb_path / str(boost::format("rx_dsps/%u") % dspno);
-            _tree->create<double>(rx_dsp_path / "rate/value")
-                .coerce(boost::bind(&rx_dsp_core_200::set_host_rate, _mbc[mb].rx_dsps[dspno], _1))
-                .subscribe(boost::bind(&usrp2_impl::update_rx_samp_rate, this, _1));
-            _tree->create<double>(rx_dsp_path / "freq/value")
-                .coerce(boost::bind(&rx_dsp_core_200::set_freq, _mbc[mb].rx_dsps[dspno], _1));
-            _tree->create<meta_range_t>(rx_dsp_path / "freq/range")
-                .publish(boost::bind(&rx_dsp_core_200::get_freq_range, _mbc[mb].rx_dsps[dspno]));
-            _tree->create<stream_cmd_t>(rx_dsp_path / "stream_cmd")
-                .subscribe(boost::bind(&rx_dsp_core_200::issue_stream_command, _mbc[mb].rx_dsps[dspno], _1));
-        }
-
-        ////////////////////////////////////////////////////////////////
-        // create tx dsp control objects
-        ////////////////////////////////////////////////////////////////
-        _mbc[mb].tx_dsp = tx_dsp_core_200::make(
-            _mbc[mb].iface, U2_REG_SR_ADDR(SR_TX_DSP), U2_REG_SR_ADDR(SR_TX_CTRL), USRP2_TX_ASYNC_SID
-        );
-        _mbc[mb].tx_dsp->set_link_rate(USRP2_LINK_RATE_BPS);
-        _tree->access<double>(mb_path / "tick_rate")
-            .subscribe(boost::bind(&tx_dsp_core_200::set_tick_rate, _mbc[mb].tx_dsp, _1));
-        _tree->create<double>(mb_path / "tx_dsps/0/rate/value")
-            .coerce(boost::bind(&tx_dsp_core_200::set_host_rate, _mbc[mb].tx_dsp, _1))
-            .subscribe(boost::bind(&usrp2_impl::update_tx_samp_rate, this, _1));
-        _tree->create<double>(mb_path / "tx_dsps/0/freq/value")
-            .coerce(boost::bind(&usrp2_impl::set_tx_dsp_freq, this, mb, _1));
-        _tree->create<meta_range_t>(mb_path / "tx_dsps/0/freq/range")
-            .publish(boost::bind(&usrp2_impl::get_tx_dsp_freq_range, this, mb));
-
-        //setup dsp flow control
-        const double ups_per_sec = device_args_i.cast<double>("ups_per_sec", 20);
-        const size_t send_frame_size = _mbc[mb].tx_dsp_xport->get_send_frame_size();
-        const double ups_per_fifo = device_args_i.cast<double>("ups_per_fifo", 8.0);
-        _mbc[mb].tx_dsp->set_updates(
-            (ups_per_sec > 0.0)? size_t(100e6/*approx tick rate*//ups_per_sec) : 0,
-            (ups_per_fifo > 0.0)? size_t(USRP2_SRAM_BYTES/ups_per_fifo/send_frame_size) : 0
-        );
-
-        ////////////////////////////////////////////////////////////////
-        // create time control objects
-        ////////////////////////////////////////////////////////////////
-        time64_core_200::readback_bases_type time64_rb_bases;
-        time64_rb_bases.rb_secs_now = U2_REG_TIME64_SECS_RB_IMM;
-        time64_rb_bases.rb_ticks_now = U2_REG_TIME64_TICKS_RB_IMM;
-        time64_rb_bases.rb_secs_pps = U2_REG_TIME64_SECS_RB_PPS;
-        time64_rb_bases.rb_ticks_pps = U2_REG_TIME64_TICKS_RB_PPS;
-        _mbc[mb].time64 = time64_core_200::make(
-            _mbc[mb].iface, U2_REG_SR_ADDR(SR_TIME64), time64_rb_bases, mimo_clock_sync_delay_cycles
-        );
-        _tree->access<double>(mb_path / "tick_rate")
-            .subscribe(boost::bind(&time64_core_200::set_tick_rate, _mbc[mb].time64, _1));
-        _tree->create<time_spec_t>(mb_path / "time/now")
-            .publish(boost::bind(&time64_core_200::get_time_now, _mbc[mb].time64))
-            .subscribe(boost::bind(&time64_core_200::set_time_now, _mbc[mb].time64, _1));
-        _tree->create<time_spec_t>(mb_path / "time/pps")
-            .publish(boost::bind(&time64_core_200::get_time_last_pps, _mbc[mb].time64))
-            .subscribe(boost::bind(&time64_core_200::set_time_next_pps, _mbc[mb].time64, _1));
-        //setup time source props
-        _tree->create<std::string>(mb_path / "time_source/value")
-            .subscribe(boost::bind(&time64_core_200::set_time_source, _mbc[mb].time64, _1));
-        _tree->create<std::vector<std::string> >(mb_path / "time_source/options")
-            .publish(boost::bind(&time64_core_200::get_time_sources, _mbc[mb].time64));
-        //setup reference source props
-        _tree->create<std::string>(mb_path / "clock_source/value")
-            .subscribe(boost::bind(&usrp2_impl::update_clock_source, this, mb, _1));
-        static const std::vector<std::string> clock_sources = boost::assign::list_of("internal")("external")("mimo");
-        _tree->create<std::vector<std::string> >(mb_path / "clock_source/options").set(clock_sources);
-
-        ////////////////////////////////////////////////////////////////
-        // create dboard control objects
-        ////////////////////////////////////////////////////////////////
-
-        //read the dboard eeprom to extract the dboard ids
-        dboard_eeprom_t rx_db_eeprom, tx_db_eeprom, gdb_eeprom;
-        rx_db_eeprom.load(*_mbc[mb].iface, USRP2_I2C_ADDR_RX_DB);
-        tx_db_eeprom.load(*_mbc[mb].iface, USRP2_I2C_ADDR_TX_DB);
-        gdb_eeprom.load(*_mbc[mb].iface, USRP2_I2C_ADDR_TX_DB ^ 5);
-
-        //create the properties and register subscribers
-        _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/rx_eeprom")
-            .set(rx_db_eeprom)
-            .subscribe(boost::bind(&usrp2_impl::set_db_eeprom, this, mb, "rx", _1));
-        _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/tx_eeprom")
-            .set(tx_db_eeprom)
-            .subscribe(boost::bind(&usrp2_impl::set_db_eeprom, this, mb, "tx", _1));
-        _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/gdb_eeprom")
-            .set(gdb_eeprom)
-            .subscribe(boost::bind(&usrp2_impl::set_db_eeprom, this, mb, "gdb", _1));
-
-        //create a new dboard interface and manager
-        _mbc[mb].dboard_iface = make_usrp2_dboard_iface(_mbc[mb].iface, _mbc[mb].clock);
-        _tree->create<dboard_iface::sptr>(mb_path / "dboards/A/iface").set(_mbc[mb].dboard_iface);
-        _mbc[mb].dboard_manager = dboard_manager::make(
-            rx_db_eeprom.id,
-            ((gdb_eeprom.id == dboard_id_t::none())? tx_db_eeprom : gdb_eeprom).id,
-            _mbc[mb].dboard_iface
-        );
-        BOOST_FOREACH(const std::string &name, _mbc[mb].dboard_manager->get_rx_subdev_names()){
-            dboard_manager::populate_prop_tree_from_subdev(
-                _tree->subtree(mb_path / "dboards/A/rx_frontends" / name),
-                _mbc[mb].dboard_manager->get_rx_subdev(name)
-            );
-        }
-        BOOST_FOREACH(const std::string &name, _mbc[mb].dboard_manager->get_tx_subdev_names()){
-            dboard_manager::populate_prop_tree_from_subdev(
-                _tree->subtree(mb_path / "dboards/A/tx_frontends" / name),
-                _mbc[mb].dboard_manager->get_tx_subdev(name)
-            );
-        }
+        _mbc[mb] = mb_container_type();
+        _tree->create<std::string>("/mboards/" + mb + "/name");
+        mb_tasks.push_back(boost::bind(&usrp2_impl::init_mboard, this, mb, device_args[mbi]));
     }
+    run_mb_tasks(mb_tasks);
+    timer.mark("mboards");
 
     //initialize io handling
-    this->io_init();
+    this->io_init(device_addr);
+    timer.mark("io_init");
 
     //do some post-init tasks
     BOOST_FOREACH(const std::string &mb, _mbc.keys()){
@@ -613,6 +699,10 @@ usrp2_impl::usrp2_impl(const device_addr_t &_device_addr){
 
         //GPS installed: use external ref, time, and init time spec
         if (_mbc[mb].gps.get() and _mbc[mb].gps->gps_detected()){
+            BOOST_FOREACH(const std::string &name, _mbc[mb].gps->get_sensors()){
+                _tree->create<sensor_value_t>(root / "sensors" / name)
+                    .publish(boost::bind(&gps_ctrl::get_sensor, _mbc[mb].gps, name));
+            }
             UHD_MSG(status) << "Setting references to the internal GPSDO" << std::endl;
             _tree->access<std::string>(root / "time_source/value").set("external");
             _tree->access<std::string>(root / "clock_source/value").set("external");
@@ -620,15 +710,399 @@ usrp2_impl::usrp2_impl(const device_addr_t &_device_addr){
             _mbc[mb].time64->set_time_next_pps(time_spec_t(time_t(_mbc[mb].gps->get_sensor("gps_time").to_int()+1)));
         }
     }
+    timer.mark("post_init");
 
+    //export the counters from a thread, with the telemetry device address keys
+    _telemetry = telemetry_exporter::make(device_addr, _tree);
+
+    //share the tree with the local tools, with the prop_socket device address key
+    if (device_addr.has_key("prop_socket")){
+        _prop_server = property_server::make(_tree, device_addr["prop_socket"]);
+    }
 }
 
 usrp2_impl::~usrp2_impl(void){UHD_SAFE_CALL(
+    _prop_server.reset();
+    _telemetry.reset(); //stop reading the tree first
     BOOST_FOREACH(const std::string &mb, _mbc.keys()){
-        _mbc[mb].tx_dsp->set_updates(0, 0);
+        BOOST_FOREACH(tx_dsp_core_200::sptr tx_dsp, _mbc[mb].tx_dsps){
+            tx_dsp->set_updates(0, 0);
+        }
     }
 )}
 
+/***********************************************************************
+ * Motherboard initialization
+ **********************************************************************/
+void usrp2_impl::init_mboard(const std::string &mb, const device_addr_t &device_args_i){
+    const std::string addr = device_args_i["addr"];
+    const fs_path mb_path = "/mboards/" + mb;
+    open_timer timer(_tree, mb_path);
+
+    ////////////////////////////////////////////////////////////////
+    // create the iface that controls i2c, spi, uart, and wb
+    ////////////////////////////////////////////////////////////////
+    //ctrl_busy_poll spins for the replies of the register round trips
+    device_addr_t ctrl_hints;
+    if (device_args_i.has_key("ctrl_busy_poll")) ctrl_hints["recv_busy_poll"] = device_args_i["ctrl_busy_poll"];
+    _mbc[mb].iface = usrp2_iface::make(udp_simple::make_connected(
+        addr, BOOST_STRINGIZE(USRP2_UDP_CTRL_PORT), ctrl_hints
+    ));
+    _mbc[mb].iface->set_ctrl_pipelined(device_args_i.cast<int>("ctrl_pipeline", 0) != 0);
+
+    //the control round trips, read by the telemetry exporter
+    _tree->create<size_t>(mb_path / "ctrl/transactions")
+        .publish(boost::bind(&usrp2_iface::get_ctrl_stat, _mbc[mb].iface, usrp2_iface::CTRL_STAT_TRANSACTIONS));
+    _tree->create<size_t>(mb_path / "ctrl/latency_us")
+        .publish(boost::bind(&usrp2_iface::get_ctrl_stat, _mbc[mb].iface, usrp2_iface::CTRL_STAT_LATENCY_US));
+    _tree->create<size_t>(mb_path / "ctrl/max_latency_us")
+        .publish(boost::bind(&usrp2_iface::get_ctrl_stat, _mbc[mb].iface, usrp2_iface::CTRL_STAT_MAX_LATENCY_US));
+    _tree->access<std::string>(mb_path / "name").set(_mbc[mb].iface->get_cname());
+    _tree->create<std::string>(mb_path / "fw_version").set(_mbc[mb].iface->get_fw_version_string());
+    timer.mark("iface"); //the firmware handshake and the mboard eeprom read
+
+    //check the fpga compatibility number
+    const boost::uint32_t fpga_compat_num = _mbc[mb].iface->peek32(U2_REG_COMPAT_NUM_RB);
+    boost::uint16_t fpga_major = fpga_compat_num >> 16, fpga_minor = fpga_compat_num & 0xffff;
+    if (fpga_major == 0){ //old version scheme
+        fpga_major = fpga_minor;
+        fpga_minor = 0;
+    }
+    if (fpga_major != USRP2_FPGA_COMPAT_NUM){
+        throw uhd::runtime_error(str(boost::format(
+            "\nPlease update the firmware and FPGA images for your device.\n"
+            "See the application notes for USRP2/N-Series for instructions.\n"
+            "Expected FPGA compatibility number %d, but got %d:\n"
+            "The FPGA build is not compatible with the host code build."
+        ) % int(USRP2_FPGA_COMPAT_NUM) % fpga_major));
+    }
+    _tree->create<std::string>(mb_path / "fpga_version").set(str(boost::format("%u.%u") % fpga_major % fpga_minor));
+
+    //the second tx dsp needs both the fpga and the firmware to support it
+    const bool has_tx_dsp1 = fpga_minor >= USRP2_FPGA_MINOR_TX_DSP1 and _mbc[mb].iface->has_tx_dsp1();
+
+    //the jumbo frame buffers are in the N-Series fpga images only
+    const bool is_usrp2 = _mbc[mb].iface->get_rev() == usrp2_iface::USRP2_REV3
+                       or _mbc[mb].iface->get_rev() == usrp2_iface::USRP2_REV4;
+    const bool has_jumbo = not is_usrp2 and fpga_minor >= USRP2_FPGA_MINOR_JUMBO;
+
+    //older images stop streaming on an overflow, the host restarts them
+    _mbc[mb].rx_resume = fpga_minor >= USRP2_FPGA_MINOR_RX_RESUME;
+
+    //lock the device/motherboard to this process
+    _mbc[mb].iface->lock_device(true);
+    timer.mark("compat");
+
+    ////////////////////////////////////////////////////////////////
+    // construct transports for RX and TX DSPs
+    ////////////////////////////////////////////////////////////////
+    //the rx dsps cannot send a frame larger than their frame buffer
+    device_addr_t xport_args = device_args_i;
+    const size_t max_recv_frame_size = get_usrp2_max_recv_frame_bytes(has_jumbo);
+    if (xport_args.cast<double>("recv_frame_size", udp_simple::mtu) > max_recv_frame_size){
+        UHD_MSG(warning) << boost::format(
+            "The recv frame size for %s is limited to %d bytes by the FPGA image."
+        ) % addr % max_recv_frame_size << std::endl;
+        xport_args["recv_frame_size"] = boost::lexical_cast<std::string>(max_recv_frame_size);
+    }
+
+    //the locality of the nic on the route to the mboard, numa=auto places the buffers on its node
+    const if_locality_t locality = get_if_locality(addr);
+    _tree->create<std::string>(mb_path / "locality/iface").set(locality.name);
+    _tree->create<int>(mb_path / "locality/numa_node").set(locality.numa_node);
+    _tree->create<std::vector<size_t> >(mb_path / "locality/cpus").set(locality.cpus);
+    if (device_args_i.get("numa", "") == "auto"){
+        _mbc[mb].locality_cpus = locality.cpus;
+        if (locality.numa_node < 0) UHD_MSG(warning) << boost::format(
+            "The NUMA node of the interface to %s is unknown, the buffers are not placed."
+        ) % addr << std::endl;
+        else{
+            const std::string node = boost::lexical_cast<std::string>(locality.numa_node);
+            if (not xport_args.has_key("recv_numa_node")) xport_args["recv_numa_node"] = node;
+            if (not xport_args.has_key("send_numa_node")) xport_args["send_numa_node"] = node;
+        }
+        UHD_LOG << boost::format("locality of %s: %s, numa node %d, %u cpus")
+            % addr % locality.name % locality.numa_node % locality.cpus.size() << std::endl;
+    }
+
+    UHD_LOG << "Making transport for RX DSP0..." << std::endl;
+    const udp_zero_copy::sptr rx_dsp0_xport = make_xport(
+        addr, BOOST_STRINGIZE(USRP2_UDP_RX_DSP0_PORT), xport_args, "recv"
+    );
+    UHD_LOG << "Making transport for RX DSP1..." << std::endl;
+    const udp_zero_copy::sptr rx_dsp1_xport = make_xport(
+        addr, BOOST_STRINGIZE(USRP2_UDP_RX_DSP1_PORT), xport_args, "recv"
+    );
+    UHD_LOG << "Making transport for TX DSP0..." << std::endl;
+    const udp_zero_copy::sptr tx_dsp0_xport = make_xport(
+        addr, BOOST_STRINGIZE(USRP2_UDP_TX_DSP0_PORT), xport_args, "send"
+    );
+    _mbc[mb].rx_dsp_xports.push_back(rx_dsp0_xport);
+    _mbc[mb].rx_dsp_xports.push_back(rx_dsp1_xport);
+    _mbc[mb].tx_dsp_xports.push_back(tx_dsp0_xport);
+    udp_zero_copy::sptr tx_dsp1_xport;
+    if (has_tx_dsp1){
+        UHD_LOG << "Making transport for TX DSP1..." << std::endl;
+        tx_dsp1_xport = make_xport(
+            addr, BOOST_STRINGIZE(USRP2_UDP_TX_DSP1_PORT), xport_args, "send"
+        );
+        _mbc[mb].tx_dsp_xports.push_back(tx_dsp1_xport);
+    }
+
+    //Program the framers with the host ports in one round trip.
+    //This setup must happen before further initialization occurs
+    //or the async update packets will cause ICMP destination unreachable.
+    uhd::dict<boost::uint16_t, boost::uint16_t> framer_ports;
+    framer_ports[USRP2_UDP_RX_DSP0_PORT] = rx_dsp0_xport->get_local_port();
+    framer_ports[USRP2_UDP_RX_DSP1_PORT] = rx_dsp1_xport->get_local_port();
+    framer_ports[USRP2_UDP_TX_DSP0_PORT] = tx_dsp0_xport->get_local_port();
+    if (has_tx_dsp1) framer_ports[USRP2_UDP_TX_DSP1_PORT] = tx_dsp1_xport->get_local_port();
+    if (not _mbc[mb].iface->setup_framers(framer_ports)){
+        send_hello_packet(rx_dsp0_xport);
+        send_hello_packet(rx_dsp1_xport);
+        send_hello_packet(tx_dsp0_xport);
+        if (has_tx_dsp1) send_hello_packet(tx_dsp1_xport);
+    }
+
+    //set the filter on the router to take dsp data from these ports (dsp1 in the high half)
+    _mbc[mb].iface->poke32(U2_REG_ROUTER_CTRL_PORTS,
+        (has_tx_dsp1? boost::uint32_t(USRP2_UDP_TX_DSP1_PORT) << 16 : 0) | USRP2_UDP_TX_DSP0_PORT
+    );
+    timer.mark("transports");
+
+    ////////////////////////////////////////////////////////////////
+    // setup the mboard eeprom
+    ////////////////////////////////////////////////////////////////
+    _tree->create<mboard_eeprom_t>(mb_path / "eeprom")
+        .set(_mbc[mb].iface->mb_eeprom)
+        .subscribe(boost::bind(&usrp2_impl::set_mb_eeprom, this, mb, _1));
+
+    ////////////////////////////////////////////////////////////////
+    // create clock control objects
+    ////////////////////////////////////////////////////////////////
+    _mbc[mb].clock = usrp2_clock_ctrl::make(_mbc[mb].iface);
+    _tree->create<double>(mb_path / "tick_rate")
+        .publish(boost::bind(&usrp2_clock_ctrl::get_master_clock_rate, _mbc[mb].clock))
+        .subscribe(boost::bind(&usrp2_impl::update_tick_rate, this, _1));
+
+    ////////////////////////////////////////////////////////////////
+    // create codec control objects
+    ////////////////////////////////////////////////////////////////
+    const fs_path rx_codec_path = mb_path / "rx_codecs/A";
+    const fs_path tx_codec_path = mb_path / "tx_codecs/A";
+    _tree->create<int>(rx_codec_path / "gains"); //phony property so this dir exists
+    _tree->create<int>(tx_codec_path / "gains"); //phony property so this dir exists
+    _mbc[mb].codec = usrp2_codec_ctrl::make(_mbc[mb].iface);
+    switch(_mbc[mb].iface->get_rev()){
+    case usrp2_iface::USRP_N200:
+    case usrp2_iface::USRP_N210:
+    case usrp2_iface::USRP_N200_R4:
+    case usrp2_iface::USRP_N210_R4:{
+        _tree->create<std::string>(rx_codec_path / "name").set("ads62p44");
+        _tree->create<meta_range_t>(rx_codec_path / "gains/digital/range").set(meta_range_t(0, 6.0, 0.5));
+        _tree->create<double>(rx_codec_path / "gains/digital/value")
+            .subscribe(boost::bind(&usrp2_codec_ctrl::set_rx_digital_gain, _mbc[mb].codec, _1)).set(0);
+        _tree->create<meta_range_t>(rx_codec_path / "gains/fine/range").set(meta_range_t(0, 0.5, 0.05));
+        _tree->create<double>(rx_codec_path / "gains/fine/value")
+            .subscribe(boost::bind(&usrp2_codec_ctrl::set_rx_digital_fine_gain, _mbc[mb].codec, _1)).set(0);
+    }break;
+
+    case usrp2_iface::USRP2_REV3:
+    case usrp2_iface::USRP2_REV4:
+        _tree->create<std::string>(rx_codec_path / "name").set("ltc2284");
+        break;
+
+    case usrp2_iface::USRP_NXXX:
+        _tree->create<std::string>(rx_codec_path / "name").set("??????");
+        break;
+    }
+    _tree->create<std::string>(tx_codec_path / "name").set("ad9777");
+    timer.mark("clock_codec");
+
+    ////////////////////////////////////////////////////////////////
+    // create gpsdo control objects
+    ////////////////////////////////////////////////////////////////
+    if (_mbc[mb].iface->mb_eeprom["gpsdo"] == "internal"){
+        _mbc[mb].gps = gps_ctrl::make(udp_simple::make_uart(udp_simple::make_connected(
+            addr, BOOST_STRINGIZE(USRP2_UDP_UART_GPS_PORT)
+        )));
+        //the gps is detected in the background, its sensors are added after the init
+    }
+    timer.mark("gps");
+
+    ////////////////////////////////////////////////////////////////
+    // and do the misc mboard sensors
+    ////////////////////////////////////////////////////////////////
+    _tree->create<sensor_value_t>(mb_path / "sensors/mimo_locked")
+        .publish(boost::bind(&usrp2_impl::get_mimo_locked, this, mb));
+    _tree->create<sensor_value_t>(mb_path / "sensors/ref_locked")
+        .publish(boost::bind(&usrp2_impl::get_ref_locked, this, mb));
+    _tree->create<bool>(mb_path / "sensor_batch")
+        .subscribe(boost::bind(&usrp2_impl::set_sensor_batch, this, mb, _1));
+
+    ////////////////////////////////////////////////////////////////
+    // cache the settings registers of the frontend and dsp cores
+    ////////////////////////////////////////////////////////////////
+    _mbc[mb].wb_cache = wb_cache_iface::make(_mbc[mb].iface);
+    _mbc[mb].wb_cache->add_range(U2_REG_SR_ADDR(SR_RX_FRONT), 5);
+    _mbc[mb].wb_cache->add_range(U2_REG_SR_ADDR(SR_RX_DSP0), 7);
+    _mbc[mb].wb_cache->add_range(U2_REG_SR_ADDR(SR_RX_DSP1), 7);
+    _mbc[mb].wb_cache->add_range(U2_REG_SR_ADDR(SR_TX_FRONT), 5);
+    _mbc[mb].wb_cache->add_range(U2_REG_SR_ADDR(SR_TX_DSP), 5);
+    if (has_tx_dsp1) _mbc[mb].wb_cache->add_range(U2_REG_SR_ADDR(SR_TX_DSP1), 5);
+
+    ////////////////////////////////////////////////////////////////
+    // create frontend control objects
+    ////////////////////////////////////////////////////////////////
+    _mbc[mb].rx_fe = rx_frontend_core_200::make(
+        _mbc[mb].wb_cache, U2_REG_SR_ADDR(SR_RX_FRONT)
+    );
+    _mbc[mb].tx_fe = tx_frontend_core_200::make(
+        _mbc[mb].wb_cache, U2_REG_SR_ADDR(SR_TX_FRONT)
+    );
+    //TODO lots of properties to expose here for frontends
+    _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec")
+        .coerce(boost::bind(&usrp2_impl::update_rx_subdev_spec, this, mb, _1));
+    _tree->create<subdev_spec_t>(mb_path / "tx_subdev_spec")
+        .coerce(boost::bind(&usrp2_impl::update_tx_subdev_spec, this, mb, _1));
+
+    ////////////////////////////////////////////////////////////////
+    // create rx dsp control objects
+    ////////////////////////////////////////////////////////////////
+    _mbc[mb].rx_dsps.push_back(rx_dsp_core_200::make(
+        _mbc[mb].wb_cache, U2_REG_SR_ADDR(SR_RX_DSP0), U2_REG_SR_ADDR(SR_RX_CTRL0), USRP2_RX_SID_BASE + 0, true,
+        boost::bind(&poke_stream_cmd_batch, _mbc[mb].iface, _1)
+    ));
+    _mbc[mb].rx_dsps.push_back(rx_dsp_core_200::make(
+        _mbc[mb].wb_cache, U2_REG_SR_ADDR(SR_RX_DSP1), U2_REG_SR_ADDR(SR_RX_CTRL1), USRP2_RX_SID_BASE + 1, true,
+        boost::bind(&poke_stream_cmd_batch, _mbc[mb].iface, _1)
+    ));
+    for (size_t dspno = 0; dspno < _mbc[mb].rx_dsps.size(); dspno++){
+        _mbc[mb].rx_dsps[dspno]->set_link_rate(USRP2_LINK_RATE_BPS);
+        _tree->access<double>(mb_path / "tick_rate")
+            .subscribe(boost::bind(&rx_dsp_core_200::set_tick_rate, _mbc[mb].rx_dsps[dspno], _1));
+        //This is a hack/fix for the lingering packet problem.
+        //The dsp core starts streaming briefly... now we flush
+        _mbc[mb].rx_dsp_xports[dspno]->get_recv_buff(0.01).get(); //recv with timeout for lingering
+        _mbc[mb].rx_dsp_xports[dspno]->get_recv_buff(0.01).get(); //recv with timeout for expected
+        fs_path rx_dsp_path = mb_path / str(boost::format("rx_dsps/%u") % dspno);
+        _tree->create<double>(rx_dsp_path / "rate/value")
+            .coerce(boost::bind(&rx_dsp_core_200::set_host_rate, _mbc[mb].rx_dsps[dspno], _1))
+            .subscribe(boost::bind(&usrp2_impl::update_rx_samp_rate, this, mb, dspno, _1));
+        _tree->create<double>(rx_dsp_path / "freq/value")
+            .coerce(boost::bind(&rx_dsp_core_200::set_freq, _mbc[mb].rx_dsps[dspno], _1));
+        _tree->create<meta_range_t>(rx_dsp_path / "freq/range")
+            .publish(boost::bind(&rx_dsp_core_200::get_freq_range, _mbc[mb].rx_dsps[dspno]));
+        _tree->create<stream_cmd_t>(rx_dsp_path / "stream_cmd")
+            .subscribe(boost::bind(&usrp2_impl::issue_rx_stream_cmd, this, mb, dspno, _1));
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // create tx dsp control objects
+    ////////////////////////////////////////////////////////////////
+    _mbc[mb].tx_dsps.push_back(tx_dsp_core_200::make(
+        _mbc[mb].wb_cache, U2_REG_SR_ADDR(SR_TX_DSP), U2_REG_SR_ADDR(SR_TX_CTRL), USRP2_TX_ASYNC_SID
+    ));
+    if (has_tx_dsp1) _mbc[mb].tx_dsps.push_back(tx_dsp_core_200::make(
+        _mbc[mb].wb_cache, U2_REG_SR_ADDR(SR_TX_DSP1), U2_REG_SR_ADDR(SR_TX_CTRL1), USRP2_TX_ASYNC_SID
+    ));
+    const std::string ups_per_sec = device_args_i.get("ups_per_sec", "auto");
+    for (size_t dspno = 0; dspno < _mbc[mb].tx_dsps.size(); dspno++){
+        _mbc[mb].tx_dsps[dspno]->set_link_rate(USRP2_LINK_RATE_BPS);
+        _tree->access<double>(mb_path / "tick_rate")
+            .subscribe(boost::bind(&tx_dsp_core_200::set_tick_rate, _mbc[mb].tx_dsps[dspno], _1));
+        fs_path tx_dsp_path = mb_path / str(boost::format("tx_dsps/%u") % dspno);
+        _tree->create<double>(tx_dsp_path / "rate/value")
+            .coerce(boost::bind(&tx_dsp_core_200::set_host_rate, _mbc[mb].tx_dsps[dspno], _1))
+            .subscribe(boost::bind(&usrp2_impl::update_tx_samp_rate, this, mb, dspno, _1));
+        _tree->create<double>(tx_dsp_path / "freq/value")
+            .coerce(boost::bind(&usrp2_impl::set_tx_dsp_freq, this, mb, dspno, _1));
+        _tree->create<meta_range_t>(tx_dsp_path / "freq/range")
+            .publish(boost::bind(&usrp2_impl::get_tx_dsp_freq_range, this, mb, dspno));
+
+        //setup dsp flow control, the update cadence can be retuned while streaming
+        _tree->create<double>(tx_dsp_path / "ups_per_sec")
+            .set((ups_per_sec == "auto")? -1.0 : boost::lexical_cast<double>(ups_per_sec))
+            .subscribe(boost::bind(&usrp2_impl::update_tx_fc_updates, this, mb, dspno));
+        _tree->create<double>(tx_dsp_path / "ups_per_fifo")
+            .set(device_args_i.cast<double>("ups_per_fifo", 8.0))
+            .subscribe(boost::bind(&usrp2_impl::update_tx_fc_updates, this, mb, dspno));
+        _tree->access<double>(tx_dsp_path / "rate/value")
+            .subscribe(boost::bind(&usrp2_impl::update_tx_fc_updates, this, mb, dspno));
+        _tree->access<double>(mb_path / "tick_rate")
+            .subscribe(boost::bind(&usrp2_impl::update_tx_fc_updates, this, mb, dspno));
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // create time control objects
+    ////////////////////////////////////////////////////////////////
+    time64_core_200::readback_bases_type time64_rb_bases;
+    time64_rb_bases.rb_secs_now = U2_REG_TIME64_SECS_RB_IMM;
+    time64_rb_bases.rb_ticks_now = U2_REG_TIME64_TICKS_RB_IMM;
+    time64_rb_bases.rb_secs_pps = U2_REG_TIME64_SECS_RB_PPS;
+    time64_rb_bases.rb_ticks_pps = U2_REG_TIME64_TICKS_RB_PPS;
+    _mbc[mb].time64 = time64_core_200::make(
+        _mbc[mb].iface, U2_REG_SR_ADDR(SR_TIME64), time64_rb_bases, mimo_clock_sync_delay_cycles
+    );
+    _tree->access<double>(mb_path / "tick_rate")
+        .subscribe(boost::bind(&time64_core_200::set_tick_rate, _mbc[mb].time64, _1));
+    _tree->create<time_spec_t>(mb_path / "time/now")
+        .publish(boost::bind(&time64_core_200::get_time_now, _mbc[mb].time64))
+        .subscribe(boost::bind(&time64_core_200::set_time_now, _mbc[mb].time64, _1));
+    _tree->create<time_spec_t>(mb_path / "time/pps")
+        .publish(boost::bind(&time64_core_200::get_time_last_pps, _mbc[mb].time64))
+        .subscribe(boost::bind(&time64_core_200::set_time_next_pps, _mbc[mb].time64, _1));
+    _tree->create<time_spec_t>(mb_path / "time/cmd")
+        .subscribe(boost::bind(&usrp2_impl::set_command_time, this, mb, _1));
+    //setup time source props
+    _tree->create<std::string>(mb_path / "time_source/value")
+        .subscribe(boost::bind(&time64_core_200::set_time_source, _mbc[mb].time64, _1));
+    _tree->create<std::vector<std::string> >(mb_path / "time_source/options")
+        .publish(boost::bind(&time64_core_200::get_time_sources, _mbc[mb].time64));
+    //setup reference source props
+    _tree->create<std::string>(mb_path / "clock_source/value")
+        .subscribe(boost::bind(&usrp2_impl::update_clock_source, this, mb, _1));
+    static const std::vector<std::string> clock_sources = boost::assign::list_of("internal")("external")("mimo");
+    _tree->create<std::vector<std::string> >(mb_path / "clock_source/options").set(clock_sources);
+    timer.mark("dsp_cores"); //with the frontend, time, and misc mboard properties
+
+    ////////////////////////////////////////////////////////////////
+    // create dboard control objects
+    ////////////////////////////////////////////////////////////////
+
+    //read the dboard eeprom to extract the dboard ids
+    dboard_eeprom_t rx_db_eeprom, tx_db_eeprom, gdb_eeprom;
+    rx_db_eeprom.load(*_mbc[mb].iface, USRP2_I2C_ADDR_RX_DB);
+    tx_db_eeprom.load(*_mbc[mb].iface, USRP2_I2C_ADDR_TX_DB);
+    gdb_eeprom.load(*_mbc[mb].iface, USRP2_I2C_ADDR_TX_DB ^ 5);
+    timer.mark("dboard_eeprom");
+
+    //create the properties and register subscribers
+    _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/rx_eeprom")
+        .set(rx_db_eeprom)
+        .subscribe(boost::bind(&usrp2_impl::set_db_eeprom, this, mb, "rx", _1));
+    _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/tx_eeprom")
+        .set(tx_db_eeprom)
+        .subscribe(boost::bind(&usrp2_impl::set_db_eeprom, this, mb, "tx", _1));
+    _tree->create<dboard_eeprom_t>(mb_path / "dboards/A/gdb_eeprom")
+        .set(gdb_eeprom)
+        .subscribe(boost::bind(&usrp2_impl::set_db_eeprom, this, mb, "gdb", _1));
+
+    //create a new dboard interface and manager
+    _mbc[mb].dboard_iface = make_usrp2_dboard_iface(
+        _mbc[mb].iface, _mbc[mb].clock, device_args_i.cast<double>("gpio_read_period", 0.0)
+    );
+    _tree->create<dboard_iface::sptr>(mb_path / "dboards/A/iface").set(_mbc[mb].dboard_iface);
+    _mbc[mb].dboard_manager = dboard_manager::make(
+        rx_db_eeprom.id,
+        ((gdb_eeprom.id == dboard_id_t::none())? tx_db_eeprom : gdb_eeprom).id,
+        _mbc[mb].dboard_iface,
+        _tree->subtree(mb_path / "dboards/A"),
+        device_args_i.has_key("defer_dboard_init")
+    );
+    timer.mark("dboard_manager");
+}
+
 void usrp2_impl::set_mb_eeprom(const std::string &mb, const uhd::usrp::mboard_eeprom_t &mb_eeprom){
     mb_eeprom.commit(*(_mbc[mb].iface), mboard_eeprom_t::MAP_N100);
 }
@@ -649,13 +1123,27 @@ sensor_value_t usrp2_impl::get_ref_locked(const std::string &mb){
     return sensor_value_t("Ref", lock, "locked", "unlocked");
 }
 
+void usrp2_impl::set_sensor_batch(const std::string &mb, const bool batch){
+    //the lock bits and the dboard gpio (lo lock) readbacks in one transaction
+    static const wb_iface::wb_addr_type sensor_regs[] = {U2_REG_IRQ_RB, GPIO_BASE};
+    if (batch) _mbc[mb].iface->begin_peek_snapshot(std::vector<wb_iface::wb_addr_type>(
+        sensor_regs, sensor_regs + sizeof(sensor_regs)/sizeof(sensor_regs[0])
+    ));
+    else _mbc[mb].iface->end_peek_snapshot();
+}
+
 #include <boost/math/special_functions/round.hpp>
 #include <boost/math/special_functions/sign.hpp>
 
-double usrp2_impl::set_tx_dsp_freq(const std::string &mb, const double freq_){
+double usrp2_impl::set_tx_dsp_freq(const std::string &mb, const size_t dspno, const double freq_){
     double new_freq = freq_;
     const double tick_rate = _tree->access<double>("/mboards/"+mb+"/tick_rate").get();
 
+    //the dac shift is shared: tx dsp 0 chooses it, the other dsps tune around it
+    if (dspno != 0){
+        return _mbc[mb].tx_dsps[dspno]->set_freq(new_freq - _mbc[mb].tx_dac_shift) + _mbc[mb].tx_dac_shift;
+    }
+
     //calculate the DAC shift (multiples of rate)
     const int sign = boost::math::sign(new_freq);
     const int zone = std::min(boost::math::iround(new_freq/tick_rate), 2);
@@ -666,15 +1154,97 @@ double usrp2_impl::set_tx_dsp_freq(const std::string &mb, const double freq_){
     if (zone == 0) _mbc[mb].codec->set_tx_mod_mode(0); //no shift
     else _mbc[mb].codec->set_tx_mod_mode(sign*4/zone); //DAC interp = 4
 
-    return _mbc[mb].tx_dsp->set_freq(new_freq) + dac_shift; //actual freq
+    //a new dac shift moves the other dsps: retune them around it
+    const bool shift_changed = dac_shift != _mbc[mb].tx_dac_shift;
+    _mbc[mb].tx_dac_shift = dac_shift;
+    const double actual_freq = _mbc[mb].tx_dsps[0]->set_freq(new_freq) + dac_shift;
+    for (size_t i = 1; shift_changed and i < _mbc[mb].tx_dsps.size(); i++){
+        property<double> &freq = _tree->access<double>(str(boost::format("/mboards/%s/tx_dsps/%u/freq/value") % mb % i));
+        if (not freq.empty()) freq.update();
+    }
+    return actual_freq;
 }
 
-meta_range_t usrp2_impl::get_tx_dsp_freq_range(const std::string &mb){
+meta_range_t usrp2_impl::get_tx_dsp_freq_range(const std::string &mb, const size_t dspno){
     const double tick_rate = _tree->access<double>("/mboards/"+mb+"/tick_rate").get();
-    const meta_range_t dsp_range = _mbc[mb].tx_dsp->get_freq_range();
+    const meta_range_t dsp_range = _mbc[mb].tx_dsps[dspno]->get_freq_range();
+    if (dspno != 0) return meta_range_t( //around the shift of tx dsp 0
+        dsp_range.start() + _mbc[mb].tx_dac_shift, dsp_range.stop() + _mbc[mb].tx_dac_shift, dsp_range.step()
+    );
     return meta_range_t(dsp_range.start() - tick_rate*2, dsp_range.stop() + tick_rate*2, dsp_range.step());
 }
 
+void usrp2_impl::update_tx_fc_updates(const std::string &mb, const size_t dspno){
+    const fs_path tx_dsp_path = "/mboards/" + mb + str(boost::format("/tx_dsps/%u") % dspno);
+    const property<double> &rate = _tree->access<double>(tx_dsp_path / "rate/value");
+    if (rate.empty()) return; //updated again once the rate is set
+    const double tick_rate = _tree->access<double>("/mboards/" + mb + "/tick_rate").get();
+    const double ups_per_fifo = _tree->access<double>(tx_dsp_path / "ups_per_fifo").get();
+    double ups_per_sec = _tree->access<double>(tx_dsp_path / "ups_per_sec").get();
+    const size_t fifo_bytes = get_usrp2_tx_fifo_bytes(dspno);
+
+    //auto: a timed update for each fraction of the time it takes to drain the fifo,
+    //so fast streams get enough updates to keep the window open,
+    //and slow streams do not keep the pirate thread busy with updates
+    if (ups_per_sec < 0.0){
+        const double bytes_per_samp = _tx_otw_type.get_sample_size();
+        ups_per_sec = uhd::clip(
+            rate.get()*bytes_per_samp*USRP2_AUTO_UPS_PER_FIFO/fifo_bytes,
+            USRP2_AUTO_UPS_PER_SEC_MIN, USRP2_AUTO_UPS_PER_SEC_MAX
+        );
+    }
+
+    const size_t send_frame_size = _mbc[mb].tx_dsp_xports[dspno]->get_send_frame_size();
+    size_t packets_per_up = (ups_per_fifo > 0.0)? std::max<size_t>(1, size_t(fifo_bytes/ups_per_fifo/send_frame_size)) : 0;
+
+    //a small window needs updates at least twice per window or the host stalls on it
+    if (_tree->exists(tx_dsp_path / "fc_window")){
+        const size_t window = _tree->access<size_t>(tx_dsp_path / "fc_window").get();
+        if (packets_per_up > window/2) packets_per_up = std::max<size_t>(1, window/2);
+    }
+
+    _mbc[mb].tx_dsps[dspno]->set_updates(
+        (ups_per_sec > 0.0)? size_t(tick_rate/ups_per_sec) : 0, packets_per_up
+    );
+}
+
+void usrp2_impl::update_tx_window(const std::string &mb, const size_t dspno){
+    const fs_path tx_dsp_path = "/mboards/" + mb + str(boost::format("/tx_dsps/%u") % dspno);
+    const property<double> &rate = _tree->access<double>(tx_dsp_path / "rate/value");
+    const double window_time = _tree->access<double>(tx_dsp_path / "fc_window_time").get();
+    if (window_time <= 0.0 or rate.empty()) return; //the window is held in packets
+
+    //the samples in flight over the window time, rounded up to whole packets
+    const size_t fifo_packets = get_usrp2_tx_fifo_bytes(dspno)/_mbc[mb].tx_dsp_xports[dspno]->get_send_frame_size();
+    const double packets = std::ceil(window_time*rate.get()/this->get_max_send_samps_per_packet());
+    _tree->access<size_t>(tx_dsp_path / "fc_window").set(size_t(uhd::clip<double>(packets, 1, fifo_packets)));
+}
+
+void usrp2_impl::set_command_time(const std::string &mb, const time_spec_t &time){
+    _mbc[mb].cmd_time = time;
+
+    //a time of zero clears the command time
+    if (time == time_spec_t(0.0)){
+        _mbc[mb].iface->clear_command_time();
+        return;
+    }
+    const double tick_rate = _tree->access<double>("/mboards/"+mb+"/tick_rate").get();
+    _mbc[mb].iface->set_command_time(
+        boost::uint32_t(time.get_full_secs()),
+        boost::uint32_t(time.get_tick_count(tick_rate))
+    );
+}
+
+void usrp2_impl::issue_rx_stream_cmd(const std::string &mb, const size_t dspno, const stream_cmd_t &stream_cmd){
+    //the dsp writes the command in one control batch (see poke_stream_cmd_batch),
+    //in pipelined mode the flush makes sure the command is taken when this returns
+    _mbc[mb].rx_dsps[dspno]->issue_stream_command(stream_cmd);
+    if (_mbc[mb].iface->is_ctrl_pipelined()) _mbc[mb].iface->flush_ctrl();
+
+    //a frame held from before the command is not returned after it
+    this->drop_rx_lookahead(mb, dspno);
+}
+
 void usrp2_impl::update_clock_source(const std::string &mb, const std::string &source){
     //clock source ref 10mhz
     switch(_mbc[mb].iface->get_rev()){
@@ -26,6 +26,9 @@
 #include "rx_dsp_core_200.hpp"
 #include "tx_dsp_core_200.hpp"
 #include "time64_core_200.hpp"
+#include "wb_cache_iface.hpp"
+#include "telemetry.hpp"
+#include <uhd/usrp/property_broker.hpp>
 #include <uhd/property_tree.hpp>
 #include <uhd/usrp/gps_ctrl.hpp>
 #include <uhd/device.hpp>
@@ -48,18 +51,39 @@ static const double mimo_clock_delay_usrp2_rev4 = 4.18e-9;
 static const double mimo_clock_delay_usrp_n2xx = 3.55e-9;
 static const size_t mimo_clock_sync_delay_cycles = 138;
 static const size_t USRP2_SRAM_BYTES = size_t(1 << 20);
+static const size_t USRP2_TX_DSP1_FIFO_BYTES = size_t(1 << 14); //block ram fifo
+static const boost::uint16_t USRP2_FPGA_MINOR_TX_DSP1 = 4;
+static const size_t USRP2_RX_DSP_FRAME_BYTES = size_t(1 << 12); //block ram frame buffer
+static const size_t USRP2_RX_DSP_JUMBO_FRAME_BYTES = size_t(1 << 13);
+static const boost::uint16_t USRP2_FPGA_MINOR_JUMBO = 5;
+static const boost::uint16_t USRP2_FPGA_MINOR_RX_RESUME = 6; //continuous rx resumes after an overflow
+static const double USRP2_AUTO_UPS_PER_FIFO = 8.0;
+static const double USRP2_AUTO_UPS_PER_SEC_MIN = 2.0;
+static const double USRP2_AUTO_UPS_PER_SEC_MAX = 1000.0;
 static const boost::uint32_t USRP2_TX_ASYNC_SID = 2;
 static const boost::uint32_t USRP2_RX_SID_BASE = 3;
 
+//! The sample buffer of a tx dsp: tx dsp 0 has the sram
+static inline size_t get_usrp2_tx_fifo_bytes(const size_t dspno){
+    return (dspno == 0)? USRP2_SRAM_BYTES : USRP2_TX_DSP1_FIFO_BYTES;
+}
+
+//! The largest rx frame: the rx dsps buffer a whole frame before it is sent
+static inline size_t get_usrp2_max_recv_frame_bytes(const bool jumbo){
+    return jumbo? USRP2_RX_DSP_JUMBO_FRAME_BYTES : USRP2_RX_DSP_FRAME_BYTES;
+}
+
 /*!
  * Make a usrp2 dboard interface.
  * \param iface the usrp2 interface object
  * \param clk_ctrl the clock control object
+ * \param gpio_read_period the seconds between gpio readback refreshes (0 to read each call)
  * \return a sptr to a new dboard interface
  */
 uhd::usrp::dboard_iface::sptr make_usrp2_dboard_iface(
     usrp2_iface::sptr iface,
-    usrp2_clock_ctrl::sptr clk_ctrl
+    usrp2_clock_ctrl::sptr clk_ctrl,
+    const double gpio_read_period = 0.0
 );
 
 /*!
@@ -83,36 +107,54 @@ public:
         uhd::rx_metadata_t &, const uhd::io_type_t &,
         uhd::device::recv_mode_t, double
     );
+    size_t recv_full_buff(
+        const recv_buffs_type &, size_t,
+        recv_metadata_array_type &, const uhd::io_type_t &, double
+    );
+    size_t recv_view(recv_view_t &, double);
+    size_t get_send_view(send_view_t &, double);
+    size_t commit_send_view(send_view_t &, size_t, double);
+    uhd::rx_streamer::sptr get_rx_stream(const uhd::stream_args_t &);
+    uhd::tx_streamer::sptr get_tx_stream(const uhd::stream_args_t &);
     size_t get_max_send_samps_per_packet(void) const;
     size_t get_max_recv_samps_per_packet(void) const;
     bool recv_async_msg(uhd::async_metadata_t &, double);
+    uhd::transport::poll_fds_t get_recv_poll_fds(void);
+    uhd::transport::poll_fds_t get_async_msg_poll_fds(void);
 
 private:
     uhd::property_tree::sptr _tree;
     struct mb_container_type{
         usrp2_iface::sptr iface;
+        wb_cache_iface::sptr wb_cache;
         usrp2_clock_ctrl::sptr clock;
         usrp2_codec_ctrl::sptr codec;
         uhd::gps_ctrl::sptr gps;
         rx_frontend_core_200::sptr rx_fe;
         tx_frontend_core_200::sptr tx_fe;
         std::vector<rx_dsp_core_200::sptr> rx_dsps;
-        tx_dsp_core_200::sptr tx_dsp;
+        std::vector<tx_dsp_core_200::sptr> tx_dsps;
         time64_core_200::sptr time64;
         std::vector<uhd::transport::zero_copy_if::sptr> rx_dsp_xports;
-        uhd::transport::zero_copy_if::sptr tx_dsp_xport;
+        std::vector<uhd::transport::zero_copy_if::sptr> tx_dsp_xports;
         uhd::usrp::dboard_manager::sptr dboard_manager;
         uhd::usrp::dboard_iface::sptr dboard_iface;
         size_t rx_chan_occ, tx_chan_occ;
-        mb_container_type(void): rx_chan_occ(0), tx_chan_occ(0){}
+        double tx_dac_shift; //the dac modulation shared by the tx dsps
+        bool rx_resume; //the fpga restarts continuous streaming after an overflow
+        std::vector<size_t> locality_cpus; //the cpus local to the nic with numa=auto
+        uhd::time_spec_t cmd_time; //the command time of the timed writes, zero when cleared
+        mb_container_type(void): rx_chan_occ(0), tx_chan_occ(0), tx_dac_shift(0.0), rx_resume(false), cmd_time(0.0){}
     };
     uhd::dict<std::string, mb_container_type> _mbc;
+    void init_mboard(const std::string &, const uhd::device_addr_t &);
 
     void set_mb_eeprom(const std::string &, const uhd::usrp::mboard_eeprom_t &);
     void set_db_eeprom(const std::string &, const std::string &, const uhd::usrp::dboard_eeprom_t &);
 
     uhd::sensor_value_t get_mimo_locked(const std::string &);
     uhd::sensor_value_t get_ref_locked(const std::string &);
+    void set_sensor_batch(const std::string &, const bool);
 
     //device properties interface
     uhd::property_tree::sptr get_tree(void) const{
@@ -122,16 +164,26 @@ private:
     //io impl methods and members
     uhd::otw_type_t _rx_otw_type, _tx_otw_type;
     UHD_PIMPL_DECL(io_impl) _io_impl;
-    void io_init(void);
+    void io_init(const uhd::device_addr_t &);
+    size_t get_packets_per_sock_buff(void) const;
     void update_tick_rate(const double rate);
-    void update_rx_samp_rate(const double rate);
-    void update_tx_samp_rate(const double rate);
+    void update_rx_samp_rate(const std::string &, const size_t, const double rate);
+    void drop_rx_lookahead(const std::string &, const size_t);
+    void update_tx_samp_rate(const std::string &, const size_t, const double rate);
+    void update_tx_fc_updates(const std::string &, const size_t);
+    void update_tx_window(const std::string &, const size_t);
     //update spec methods are coercers until we only accept db_name == A
     uhd::usrp::subdev_spec_t update_rx_subdev_spec(const std::string &, const uhd::usrp::subdev_spec_t &);
     uhd::usrp::subdev_spec_t update_tx_subdev_spec(const std::string &, const uhd::usrp::subdev_spec_t &);
-    double set_tx_dsp_freq(const std::string &, const double);
-    uhd::meta_range_t get_tx_dsp_freq_range(const std::string &);
+    double set_tx_dsp_freq(const std::string &, const size_t, const double);
+    uhd::meta_range_t get_tx_dsp_freq_range(const std::string &, const size_t);
     void update_clock_source(const std::string &, const std::string &);
+    void set_command_time(const std::string &, const uhd::time_spec_t &);
+    void issue_rx_stream_cmd(const std::string &, const size_t, const uhd::stream_cmd_t &);
+
+    //last, so the exporter thread stops before the rest goes away
+    uhd::usrp::telemetry_exporter::sptr _telemetry;
+    uhd::usrp::property_server::sptr _prop_server;
 };
 
 #endif /* INCLUDED_USRP2_IMPL_HPP */
@@ -49,6 +49,8 @@
 #define SR_TX_FRONT 128   // ?
 #define SR_TX_CTRL  144   // 6
 #define SR_TX_DSP   160   // 5
+#define SR_TX_CTRL1 176   // 6
+#define SR_TX_DSP1  184   // 5
 
 #define SR_UDP_SM   192   // 64
 
@@ -0,0 +1,129 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/static.hpp>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+/***********************************************************************
+ * This file is compiled without any instruction set flags:
+ * The buffer swaps start out as the scalar loops below,
+ * and are pointed at the SIMD implementations
+ * once a runtime check finds the host cpu supports them.
+ **********************************************************************/
+template <typename T> static void byteswap_buffer_generic(T *out, const T *in, size_t nwords){
+    for (size_t i = 0; i < nwords; i++) out[i] = uhd::byteswap(in[i]);
+}
+
+typedef void (*byteswap16_fcn_t)(boost::uint16_t *, const boost::uint16_t *, size_t);
+typedef void (*byteswap32_fcn_t)(boost::uint32_t *, const boost::uint32_t *, size_t);
+typedef void (*byteswap64_fcn_t)(boost::uint64_t *, const boost::uint64_t *, size_t);
+
+static byteswap16_fcn_t byteswap16_fcn = &byteswap_buffer_generic<boost::uint16_t>;
+static byteswap32_fcn_t byteswap32_fcn = &byteswap_buffer_generic<boost::uint32_t>;
+static byteswap64_fcn_t byteswap64_fcn = &byteswap_buffer_generic<boost::uint64_t>;
+
+void uhd::byteswap_buffer(boost::uint16_t *out, const boost::uint16_t *in, size_t nwords){
+    byteswap16_fcn(out, in, nwords);
+}
+
+void uhd::byteswap_buffer(boost::uint32_t *out, const boost::uint32_t *in, size_t nwords){
+    byteswap32_fcn(out, in, nwords);
+}
+
+void uhd::byteswap_buffer(boost::uint64_t *out, const boost::uint64_t *in, size_t nwords){
+    byteswap64_fcn(out, in, nwords);
+}
+
+/***********************************************************************
+ * SIMD implementations (defined in byteswap_with_*.cpp)
+ **********************************************************************/
+#define DECLARE_BYTESWAP_BUFFERS(suffix) \
+    void byteswap_buffer16_##suffix(boost::uint16_t *, const boost::uint16_t *, size_t); \
+    void byteswap_buffer32_##suffix(boost::uint32_t *, const boost::uint32_t *, size_t); \
+    void byteswap_buffer64_##suffix(boost::uint64_t *, const boost::uint64_t *, size_t);
+
+#define USE_BYTESWAP_BUFFERS(suffix) \
+    byteswap16_fcn = &byteswap_buffer16_##suffix; \
+    byteswap32_fcn = &byteswap_buffer32_##suffix; \
+    byteswap64_fcn = &byteswap_buffer64_##suffix;
+
+#ifdef HAVE_SSSE3_BYTESWAP
+DECLARE_BYTESWAP_BUFFERS(ssse3)
+#endif
+
+#ifdef HAVE_AVX2_BYTESWAP
+DECLARE_BYTESWAP_BUFFERS(avx2)
+#endif
+
+#ifdef HAVE_NEON_BYTESWAP
+DECLARE_BYTESWAP_BUFFERS(neon)
+#endif
+
+#if defined(HAVE_SSSE3_BYTESWAP) || defined(HAVE_AVX2_BYTESWAP)
+static bool cpu_has_ssse3(void){
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    return (regs[2] & (1 << 9)) != 0;
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3") != 0;
+#else
+    return false;
+#endif
+}
+
+static bool cpu_has_avx2(void){
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+    __cpuid(regs, 1);
+    //the os must save the ymm registers on a context switch
+    const int osxsave_avx = (1 << 27) | (1 << 28);
+    if ((regs[2] & osxsave_avx) != osxsave_avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+UHD_STATIC_BLOCK(byteswap_buffer_dispatch){
+    #ifdef HAVE_SSSE3_BYTESWAP
+    if (cpu_has_ssse3()){USE_BYTESWAP_BUFFERS(ssse3)}
+    #endif
+
+    #ifdef HAVE_AVX2_BYTESWAP
+    if (cpu_has_avx2()){USE_BYTESWAP_BUFFERS(avx2)}
+    #endif
+
+    #ifdef HAVE_NEON_BYTESWAP
+    USE_BYTESWAP_BUFFERS(neon)
+    #endif
+}
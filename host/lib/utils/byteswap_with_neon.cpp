@@ -0,0 +1,51 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <uhd/utils/byteswap.hpp>
+#include <arm_neon.h>
+
+/***********************************************************************
+ * This file is compiled with NEON enabled:
+ * vrev16/32/64 reverse the bytes of every word in 16 bytes.
+ **********************************************************************/
+void byteswap_buffer16_neon(boost::uint16_t *out, const boost::uint16_t *in, size_t nwords){
+    size_t i = 0;
+    for (; i + 8 <= nwords; i += 8){
+        const uint8x16_t Q0 = vld1q_u8(reinterpret_cast<const uint8_t *>(in + i));
+        vst1q_u8(reinterpret_cast<uint8_t *>(out + i), vrev16q_u8(Q0));
+    }
+    for (; i < nwords; i++) out[i] = uhd::byteswap(in[i]);
+}
+
+void byteswap_buffer32_neon(boost::uint32_t *out, const boost::uint32_t *in, size_t nwords){
+    size_t i = 0;
+    for (; i + 4 <= nwords; i += 4){
+        const uint8x16_t Q0 = vld1q_u8(reinterpret_cast<const uint8_t *>(in + i));
+        vst1q_u8(reinterpret_cast<uint8_t *>(out + i), vrev32q_u8(Q0));
+    }
+    for (; i < nwords; i++) out[i] = uhd::byteswap(in[i]);
+}
+
+void byteswap_buffer64_neon(boost::uint64_t *out, const boost::uint64_t *in, size_t nwords){
+    size_t i = 0;
+    for (; i + 2 <= nwords; i += 2){
+        const uint8x16_t Q0 = vld1q_u8(reinterpret_cast<const uint8_t *>(in + i));
+        vst1q_u8(reinterpret_cast<uint8_t *>(out + i), vrev64q_u8(Q0));
+    }
+    for (; i < nwords; i++) out[i] = uhd::byteswap(in[i]);
+}
@@ -0,0 +1,49 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <uhd/utils/byteswap.hpp>
+#include <tmmintrin.h>
+
+/***********************************************************************
+ * This file is compiled with SSSE3 enabled:
+ * byteswap.cpp only calls in here after a runtime cpu check.
+ * A single pshufb reverses the bytes of every word in 16 bytes.
+ **********************************************************************/
+template <typename T> static UHD_INLINE void byteswap_buffer_ssse3(
+    T *out, const T *in, size_t nwords, const __m128i &mask
+){
+    static const size_t words_per_vec = sizeof(__m128i)/sizeof(T);
+    size_t i = 0;
+    for (; i + words_per_vec <= nwords; i += words_per_vec){
+        const __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_shuffle_epi8(tmpi, mask));
+    }
+    for (; i < nwords; i++) out[i] = uhd::byteswap(in[i]);
+}
+
+void byteswap_buffer16_ssse3(boost::uint16_t *out, const boost::uint16_t *in, size_t nwords){
+    byteswap_buffer_ssse3(out, in, nwords, _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+}
+
+void byteswap_buffer32_ssse3(boost::uint32_t *out, const boost::uint32_t *in, size_t nwords){
+    byteswap_buffer_ssse3(out, in, nwords, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+}
+
+void byteswap_buffer64_ssse3(boost::uint64_t *out, const boost::uint64_t *in, size_t nwords){
+    byteswap_buffer_ssse3(out, in, nwords, _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7));
+}
@@ -0,0 +1,225 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/capture_index.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/exception.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/math/special_functions/round.hpp>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+using namespace uhd;
+namespace ipc = boost::interprocess;
+
+/***********************************************************************
+ * The index file layout, all words are little endian:
+ *  - header (32 bytes): magic, version, item size, rate, num chans
+ *  - entries (32 bytes each): offset, full secs, frac secs, flags
+ * A double is stored as the bits of its IEEE 754 representation.
+ **********************************************************************/
+static const char CAPTURE_INDEX_MAGIC[8] = {'U', 'H', 'D', 'C', 'A', 'P', 'I', 'X'};
+static const boost::uint32_t CAPTURE_INDEX_VERSION = 1;
+
+static const boost::uint32_t FLAG_HAS_TIME = (1 << 0);
+static const boost::uint32_t FLAG_OVERFLOW = (1 << 1);
+
+struct index_header_t{
+    char magic[8];
+    boost::uint32_t version, item_size;
+    boost::uint64_t rate;
+    boost::uint32_t num_chans, reserved;
+};
+
+struct index_entry_t{
+    boost::uint64_t offset, full_secs, frac_secs;
+    boost::uint32_t flags, reserved;
+};
+
+static boost::uint64_t double_to_word(const double val){
+    boost::uint64_t word;
+    std::memcpy(&word, &val, sizeof(word));
+    return uhd::htowx(word);
+}
+
+static double word_to_double(const boost::uint64_t word){
+    const boost::uint64_t host = uhd::wtohx(word);
+    double val;
+    std::memcpy(&val, &host, sizeof(val));
+    return val;
+}
+
+capture_index_entry_t::capture_index_entry_t(void):
+    offset(0), has_time(false), overflow(false)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * Index writer
+ **********************************************************************/
+class capture_index_writer_impl : public capture_index_writer{
+public:
+    capture_index_writer_impl(const std::string &path, size_t item_size, double rate, size_t num_chans):
+        _path(path), _file(path.c_str(), std::ofstream::binary | std::ofstream::trunc)
+    {
+        index_header_t header;
+        std::memcpy(header.magic, CAPTURE_INDEX_MAGIC, sizeof(header.magic));
+        header.version = uhd::htowx(CAPTURE_INDEX_VERSION);
+        header.item_size = uhd::htowx(boost::uint32_t(item_size));
+        header.rate = double_to_word(rate);
+        header.num_chans = uhd::htowx(boost::uint32_t(num_chans));
+        header.reserved = 0;
+        this->write(&header, sizeof(header));
+    }
+
+    void append(const capture_index_entry_t &entry){
+        index_entry_t word;
+        word.offset = uhd::htowx(entry.offset);
+        word.full_secs = uhd::htowx(boost::uint64_t(boost::int64_t(entry.time.get_full_secs())));
+        word.frac_secs = double_to_word(entry.time.get_frac_secs());
+        word.flags = uhd::htowx(boost::uint32_t(
+            ((entry.has_time)? FLAG_HAS_TIME : 0) | ((entry.overflow)? FLAG_OVERFLOW : 0)
+        ));
+        word.reserved = 0;
+        this->write(&word, sizeof(word));
+    }
+
+private:
+    void write(const void *mem, size_t num_bytes){
+        _file.write(static_cast<const char *>(mem), num_bytes);
+        _file.flush();
+        if (_file.fail()) throw uhd::io_error("capture index: cannot write " + _path);
+    }
+
+    const std::string _path;
+    std::ofstream _file;
+};
+
+capture_index_writer::sptr capture_index_writer::make(
+    const std::string &path, size_t item_size, double rate, size_t num_chans
+){
+    return sptr(new capture_index_writer_impl(path, item_size, rate, num_chans));
+}
+
+/***********************************************************************
+ * Index reader
+ **********************************************************************/
+static bool entry_time_less(const time_spec_t &time, const capture_index_entry_t &entry){
+    return time < entry.time;
+}
+
+class capture_index_reader_impl : public capture_index_reader{
+public:
+    capture_index_reader_impl(const std::string &path){
+        std::ifstream file(path.c_str(), std::ifstream::binary);
+        index_header_t header;
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (file.fail() or std::memcmp(header.magic, CAPTURE_INDEX_MAGIC, sizeof(header.magic)) != 0){
+            throw uhd::io_error("capture index: not a capture index " + path);
+        }
+        if (uhd::wtohx(header.version) != CAPTURE_INDEX_VERSION){
+            throw uhd::io_error("capture index: unsupported version in " + path);
+        }
+        _item_size = uhd::wtohx(header.item_size);
+        _rate = word_to_double(header.rate);
+        _num_chans = uhd::wtohx(header.num_chans);
+
+        //a partial entry at the end is from a recording that was cut short
+        index_entry_t word;
+        while (file.read(reinterpret_cast<char *>(&word), sizeof(word))){
+            capture_index_entry_t entry;
+            entry.offset = uhd::wtohx(word.offset);
+            const boost::uint32_t flags = uhd::wtohx(word.flags);
+            entry.has_time = (flags & FLAG_HAS_TIME) != 0;
+            entry.overflow = (flags & FLAG_OVERFLOW) != 0;
+            entry.time = time_spec_t(
+                time_t(boost::int64_t(uhd::wtohx(word.full_secs))), word_to_double(word.frac_secs)
+            );
+            _entries.push_back(entry);
+            if (entry.has_time) _timed_entries.push_back(entry);
+        }
+    }
+
+    size_t get_item_size(void) const{
+        return _item_size;
+    }
+
+    double get_rate(void) const{
+        return _rate;
+    }
+
+    size_t get_num_chans(void) const{
+        return _num_chans;
+    }
+
+    const std::vector<capture_index_entry_t> &get_entries(void) const{
+        return _entries;
+    }
+
+    boost::uint64_t find_offset(const time_spec_t &time) const{
+        if (_timed_entries.empty()) throw uhd::lookup_error("capture index: no entry has a time");
+
+        //the first entry after the time, the run before it holds the time
+        std::vector<capture_index_entry_t>::const_iterator next = std::upper_bound(
+            _timed_entries.begin(), _timed_entries.end(), time, &entry_time_less
+        );
+        if (next == _timed_entries.begin()) return next->offset;
+        const capture_index_entry_t &entry = *(next - 1);
+
+        const boost::uint64_t num_items = boost::uint64_t(boost::math::llround(
+            (time - entry.time).get_real_secs()*_rate
+        ));
+        const boost::uint64_t offset = entry.offset + num_items*_item_size;
+        if (next != _timed_entries.end() and offset >= next->offset) return next->offset; //in a gap
+        return offset;
+    }
+
+private:
+    size_t _item_size, _num_chans;
+    double _rate;
+    std::vector<capture_index_entry_t> _entries, _timed_entries;
+};
+
+capture_index_reader::sptr capture_index_reader::make(const std::string &path){
+    return sptr(new capture_index_reader_impl(path));
+}
+
+/***********************************************************************
+ * Region mapping
+ **********************************************************************/
+struct capture_region_t{
+    ipc::file_mapping mapping;
+    ipc::mapped_region region;
+};
+
+boost::shared_ptr<const void> uhd::map_capture_region(
+    const std::string &path, boost::uint64_t offset, size_t num_bytes
+){
+    if (num_bytes == 0) throw uhd::value_error("capture index: cannot map an empty region");
+    boost::shared_ptr<capture_region_t> region(new capture_region_t());
+    try{
+        region->mapping = ipc::file_mapping(path.c_str(), ipc::read_only);
+        region->region = ipc::mapped_region(region->mapping, ipc::read_only, ipc::offset_t(offset), num_bytes);
+    }
+    catch(const ipc::interprocess_exception &e){
+        throw uhd::io_error("capture index: cannot map " + path + ": " + e.what());
+    }
+    return boost::shared_ptr<const void>(region, region->region.get_address());
+}
@@ -22,17 +22,19 @@
 #include <uhd/exception.hpp>
 #include <boost/foreach.hpp>
 #include <boost/bind.hpp>
+#include <boost/format.hpp>
 #include <algorithm>
 #include <vector>
 
 using namespace uhd;
 
 static const bool verbose = false;
+static const size_t max_table_size = 1 << 16;
 
 static bool compare_by_step_size(
-    const size_t &rhs, const size_t &lhs, std::vector<gain_fcns_t> &fcns
+    const size_t &rhs, const size_t &lhs, const std::vector<gain_range_t> &ranges
 ){
-    return fcns.at(rhs).get_range().step() > fcns.at(lhs).get_range().step();
+    return ranges.at(rhs).step() > ranges.at(lhs).step();
 }
 
 /*!
@@ -54,12 +56,70 @@ template <typename T> static T floor_step(T num, T step, T e = T(0.001)){
     return step*int(num/step + e);
 }
 
+/*!
+ * Distribute an overall gain across the gain elements.
+ * \param gain the overall gain
+ * \param ranges the ranges of the elements (highest priority first)
+ * \return the gain of each element
+ */
+static std::vector<double> distribute_gain(
+    const double gain, const std::vector<gain_range_t> &ranges
+){
+    //get the max step size among the gains
+    double max_step = 0;
+    BOOST_FOREACH(const gain_range_t &range, ranges){
+        max_step = std::max(max_step, range.step());
+    }
+
+    //create gain bucket to distribute power
+    std::vector<double> gain_bucket;
+
+    //distribute power according to priority (round to max step)
+    double gain_left_to_distribute = gain;
+    BOOST_FOREACH(const gain_range_t &range, ranges){
+        gain_bucket.push_back(floor_step(uhd::clip(
+            gain_left_to_distribute, range.start(), range.stop()
+        ), max_step));
+        gain_left_to_distribute -= gain_bucket.back();
+    }
+
+    //get a list of indexes sorted by step size large to small
+    std::vector<size_t> indexes_step_size_dec;
+    for (size_t i = 0; i < ranges.size(); i++){
+        indexes_step_size_dec.push_back(i);
+    }
+    std::sort(
+        indexes_step_size_dec.begin(), indexes_step_size_dec.end(),
+        boost::bind(&compare_by_step_size, _1, _2, boost::cref(ranges))
+    );
+    UHD_ASSERT_THROW(
+        ranges.at(indexes_step_size_dec.front()).step() >=
+        ranges.at(indexes_step_size_dec.back()).step()
+    );
+
+    //distribute the remainder (less than max step)
+    //fill in the largest step sizes first that are less than the remainder
+    BOOST_FOREACH(size_t i, indexes_step_size_dec){
+        const gain_range_t &range = ranges.at(i);
+        double additional_gain = floor_step(uhd::clip(
+            gain_bucket.at(i) + gain_left_to_distribute, range.start(), range.stop()
+        ), range.step()) - gain_bucket.at(i);
+        gain_bucket.at(i) += additional_gain;
+        gain_left_to_distribute -= additional_gain;
+    }
+    UHD_LOGV(often) << "gain_left_to_distribute " << gain_left_to_distribute << std::endl;
+
+    return gain_bucket;
+}
+
 /***********************************************************************
  * gain group implementation
  **********************************************************************/
 class gain_group_impl : public gain_group{
 public:
-    gain_group_impl(void){
+    gain_group_impl(void):
+        _table_start(0), _table_stop(0), _table_step(0)
+    {
         /*NOP*/
     }
 
@@ -89,55 +149,36 @@ public:
     }
 
     void set_value(double gain, const std::string &name){
-        if (not name.empty()) return _name_to_fcns[name].set_value(gain);
-
-        std::vector<gain_fcns_t> all_fcns = get_all_fcns();
-        if (all_fcns.size() == 0) return; //nothing to set!
+        if (not name.empty()){
+            _table_written.assign(_table_written.size(), size_t(-1)); //an element was set on its own
+            return _name_to_fcns[name].set_value(gain);
+        }
 
-        //get the max step size among the gains
-        double max_step = 0;
-        BOOST_FOREACH(const gain_fcns_t &fcns, all_fcns){
-            max_step = std::max(max_step, fcns.get_range().step());
+        //the table: look up the bucket and only write the changed elements
+        if (not _table.empty()){
+            const double index = (uhd::clip(gain, _table_start, _table_stop) - _table_start)/_table_step;
+            const size_t entry = std::min(size_t(index + 0.5), _table.size() - 1);
+            for (size_t i = 0; i < _table_fcns.size(); i++){
+                const size_t prev = _table_written.at(i);
+                const double value = _table.at(entry).at(i);
+                if (prev >= _table.size() or _table.at(prev).at(i) != value){
+                    UHD_LOGV(often) << i << ": " << value << std::endl;
+                    _table_fcns.at(i).set_value(value);
+                }
+                _table_written.at(i) = entry;
+            }
+            return;
         }
 
-        //create gain bucket to distribute power
-        std::vector<double> gain_bucket;
+        std::vector<gain_fcns_t> all_fcns = get_all_fcns();
+        if (all_fcns.size() == 0) return; //nothing to set!
 
-        //distribute power according to priority (round to max step)
-        double gain_left_to_distribute = gain;
+        //read each range once, they are used throughout the distribution
+        std::vector<gain_range_t> ranges;
         BOOST_FOREACH(const gain_fcns_t &fcns, all_fcns){
-            const gain_range_t range = fcns.get_range();
-            gain_bucket.push_back(floor_step(uhd::clip(
-                gain_left_to_distribute, range.start(), range.stop()
-            ), max_step));
-            gain_left_to_distribute -= gain_bucket.back();
-        }
-
-        //get a list of indexes sorted by step size large to small
-        std::vector<size_t> indexes_step_size_dec;
-        for (size_t i = 0; i < all_fcns.size(); i++){
-            indexes_step_size_dec.push_back(i);
-        }
-        std::sort(
-            indexes_step_size_dec.begin(), indexes_step_size_dec.end(),
-            boost::bind(&compare_by_step_size, _1, _2, all_fcns)
-        );
-        UHD_ASSERT_THROW(
-            all_fcns.at(indexes_step_size_dec.front()).get_range().step() >=
-            all_fcns.at(indexes_step_size_dec.back()).get_range().step()
-        );
-
-        //distribute the remainder (less than max step)
-        //fill in the largest step sizes first that are less than the remainder
-        BOOST_FOREACH(size_t i, indexes_step_size_dec){
-            const gain_range_t range = all_fcns.at(i).get_range();
-            double additional_gain = floor_step(uhd::clip(
-                gain_bucket.at(i) + gain_left_to_distribute, range.start(), range.stop()
-            ), range.step()) - gain_bucket.at(i);
-            gain_bucket.at(i) += additional_gain;
-            gain_left_to_distribute -= additional_gain;
+            ranges.push_back(fcns.get_range());
         }
-        UHD_LOGV(often) << "gain_left_to_distribute " << gain_left_to_distribute << std::endl;
+        const std::vector<double> gain_bucket = distribute_gain(gain, ranges);
 
         //now write the bucket out to the individual gain values
         for (size_t i = 0; i < gain_bucket.size(); i++){
@@ -146,6 +187,38 @@ public:
         }
     }
 
+    void set_table_step(double step){
+        _table.clear();
+        _table_fcns.clear();
+        _table_written.clear();
+        if (step <= 0) return;
+
+        _table_fcns = get_all_fcns();
+        if (_table_fcns.size() == 0) return; //nothing to set!
+        std::vector<gain_range_t> ranges;
+        BOOST_FOREACH(const gain_fcns_t &fcns, _table_fcns){
+            ranges.push_back(fcns.get_range());
+        }
+
+        //one bucket per step across the overall range
+        double overall_start = 0, overall_stop = 0;
+        BOOST_FOREACH(const gain_range_t &range, ranges){
+            overall_start += range.start();
+            overall_stop += range.stop();
+        }
+        const double num_steps = (overall_stop - overall_start)/step;
+        if (num_steps > max_table_size) throw uhd::value_error(str(boost::format(
+            "gain group: a table step of %f dB needs more than %u entries"
+        ) % step % max_table_size));
+        _table_start = overall_start;
+        _table_stop = overall_stop;
+        _table_step = step;
+        for (size_t i = 0; i <= size_t(num_steps + 0.001); i++){
+            _table.push_back(distribute_gain(std::min(_table_start + i*step, _table_stop), ranges));
+        }
+        _table_written.assign(_table_fcns.size(), size_t(-1)); //write everything on the first set
+    }
+
     const std::vector<std::string> get_names(void){
         return _name_to_fcns.keys();
     }
@@ -161,6 +234,7 @@ public:
         }
         _registry[priority].push_back(gain_fcns);
         _name_to_fcns[name] = gain_fcns;
+        this->set_table_step(0); //the table no longer covers every element
     }
 
 private:
@@ -176,6 +250,12 @@ private:
 
     uhd::dict<size_t, std::vector<gain_fcns_t> > _registry;
     uhd::dict<std::string, gain_fcns_t> _name_to_fcns;
+
+    //precomputed buckets, the entry last written to each element
+    double _table_start, _table_stop, _table_step;
+    std::vector<std::vector<double> > _table;
+    std::vector<gain_fcns_t> _table_fcns;
+    std::vector<size_t> _table_written;
 };
 
 /***********************************************************************
@@ -17,14 +17,57 @@
 
 #include <uhd/utils/images.hpp>
 #include <uhd/exception.hpp>
+#include <uhd/types/dict.hpp>
 #include <boost/foreach.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+#include <ctime>
 #include <vector>
 
 namespace fs = boost::filesystem;
 
 std::vector<fs::path> get_image_paths(void); //defined in paths.cpp
 
+/***********************************************************************
+ * Resolved image path cache
+ **********************************************************************/
+/*!
+ * The image paths found in the search paths, keyed by the image name
+ * and the search paths. An entry is valid while the image keeps its mtime,
+ * so a warm lookup costs one stat instead of probing every search path.
+ */
+struct resolved_image_t{
+    std::string path;
+    std::time_t mtime;
+};
+
+static boost::mutex resolved_images_mutex;
+static uhd::dict<std::string, resolved_image_t> resolved_images;
+
+static bool get_resolved_image(const std::string &key, std::string &path){
+    boost::mutex::scoped_lock lock(resolved_images_mutex);
+    if (not resolved_images.has_key(key)) return false;
+    const resolved_image_t &resolved = resolved_images[key];
+    boost::system::error_code ec;
+    const std::time_t mtime = fs::last_write_time(resolved.path, ec);
+    if (ec or mtime != resolved.mtime){
+        resolved_images.pop(key);
+        return false;
+    }
+    path = resolved.path;
+    return true;
+}
+
+static void set_resolved_image(const std::string &key, const fs::path &path){
+    boost::system::error_code ec;
+    resolved_image_t resolved;
+    resolved.path = path.string();
+    resolved.mtime = fs::last_write_time(path, ec);
+    if (ec) return;
+    boost::mutex::scoped_lock lock(resolved_images_mutex);
+    resolved_images[key] = resolved;
+}
+
 /***********************************************************************
  * Find a image in the image paths
  **********************************************************************/
@@ -32,9 +75,20 @@ std::string uhd::find_image_path(const std::string &image_name){
     if (fs::exists(image_name)){
         return fs::system_complete(image_name).string();
     }
-    BOOST_FOREACH(const fs::path &path, get_image_paths()){
+
+    const std::vector<fs::path> image_paths = get_image_paths();
+    std::string key = image_name;
+    BOOST_FOREACH(const fs::path &path, image_paths) key += "\n" + path.string();
+
+    std::string resolved_path;
+    if (get_resolved_image(key, resolved_path)) return resolved_path;
+
+    BOOST_FOREACH(const fs::path &path, image_paths){
         fs::path image_path = path / image_name;
-        if (fs::exists(image_path)) return image_path.string();
+        if (fs::exists(image_path)){
+            set_resolved_image(key, image_path);
+            return image_path.string();
+        }
     }
     throw uhd::io_error("Could not find path for image: " + image_name);
 }
@@ -15,14 +15,21 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
-#include <uhd/utils/static.hpp>
+#include <uhd/utils/log.hpp>
 #include <uhd/exception.hpp>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
 #include <string>
 #include <vector>
+#include <map>
 
 namespace fs = boost::filesystem;
 
@@ -31,6 +38,8 @@ namespace fs = boost::filesystem;
  **********************************************************************/
 #ifdef HAVE_DLOPEN
 #include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
 static void load_module(const std::string &file_name){
     if (dlopen(file_name.c_str(), RTLD_LAZY) == NULL){
         throw uhd::os_error(str(
@@ -61,49 +70,214 @@ static void load_module(const std::string &file_name){
 }
 #endif /* HAVE_LOAD_MODULES_DUMMY */
 
+/***********************************************************************
+ * Module Manifest
+ **********************************************************************/
+/*!
+ * The manifest caches the listing of each module directory with its mtime.
+ * A directory whose mtime matches the manifest is not read again,
+ * so an unchanged module tree costs one stat per directory.
+ *
+ * The listed files are loaded, and the temp path is shared by all users:
+ * the manifest is per user, it is only read when it is owned by the user
+ * and not writable by others, and a cached listing is only used when
+ * every entry is a direct child of its directory.
+ */
+fs::path get_temp_path(void); //defined in paths.cpp
+
+static std::string get_manifest_name(void){
+    #ifdef HAVE_DLOPEN
+    return str(boost::format("uhd_modules_manifest-%u.txt") % unsigned(::geteuid()));
+    #else
+    return "uhd_modules_manifest.txt";
+    #endif
+}
+
+static bool read_manifest_file(const fs::path &path, std::string &contents){
+    std::FILE *fp = std::fopen(path.string().c_str(), "r");
+    if (fp == NULL) return false;
+    #ifdef HAVE_DLOPEN
+    //check the opened file, a check on the path could be raced
+    struct stat st;
+    if (
+        ::fstat(::fileno(fp), &st) != 0 or not S_ISREG(st.st_mode) or
+        st.st_uid != ::geteuid() or (st.st_mode & (S_IWGRP | S_IWOTH)) != 0
+    ){
+        UHD_LOG << "Ignoring the module manifest " << path.string() << ": not owned by this user" << std::endl;
+        std::fclose(fp);
+        return false;
+    }
+    #endif
+    char buff[4096];
+    size_t len;
+    while ((len = std::fread(buff, 1, sizeof(buff), fp)) > 0) contents.append(buff, len);
+    std::fclose(fp);
+    return true;
+}
+
+struct dir_listing_t{
+    std::time_t mtime;
+    std::vector<std::string> files, dirs;
+};
+
+typedef std::map<std::string, dir_listing_t> manifest_t;
+
+static manifest_t load_manifest(void){
+    //one entry per line: dir mtime <tab> dir <tab> f|d|- <tab> child
+    manifest_t manifest;
+    std::string contents;
+    if (not read_manifest_file(get_temp_path() / get_manifest_name(), contents)) return manifest;
+    std::istringstream file(contents);
+    std::string line;
+    while (std::getline(file, line)){
+        std::istringstream ss(line);
+        std::string mtime_str, dir, type, child;
+        if (not std::getline(ss, mtime_str, '\t')) continue;
+        if (not std::getline(ss, dir, '\t')) continue;
+        if (not std::getline(ss, type, '\t')) continue;
+        std::getline(ss, child);
+        dir_listing_t &listing = manifest[dir];
+        listing.mtime = std::time_t(std::atof(mtime_str.c_str()));
+        if (type == "f") listing.files.push_back(child);
+        if (type == "d") listing.dirs.push_back(child);
+    }
+    return manifest;
+}
+
+static void store_manifest(const manifest_t &manifest){
+    try{
+        const std::string manifest_name = get_manifest_name();
+        const fs::path path = get_temp_path() / manifest_name;
+        const fs::path tmp_path = path.parent_path() / fs::unique_path(manifest_name + "-%%%%-%%%%.tmp");
+        {
+            std::ofstream file(tmp_path.string().c_str());
+            BOOST_FOREACH(const manifest_t::value_type &entry, manifest){
+                const std::string prefix = str(boost::format("%d\t%s\t") % entry.second.mtime % entry.first);
+                BOOST_FOREACH(const std::string &child, entry.second.files) file << prefix << "f\t" << child << std::endl;
+                BOOST_FOREACH(const std::string &child, entry.second.dirs) file << prefix << "d\t" << child << std::endl;
+                if (entry.second.files.empty() and entry.second.dirs.empty()) file << prefix << "-\t" << std::endl;
+            }
+        }
+        #ifdef HAVE_DLOPEN
+        if (::chmod(tmp_path.string().c_str(), S_IRUSR | S_IWUSR) != 0){
+            fs::remove(tmp_path);
+            throw uhd::os_error("chmod failed on " + tmp_path.string());
+        }
+        #endif
+        fs::rename(tmp_path, path); //replace the old manifest in one step
+    }
+    catch(const std::exception &e){
+        UHD_LOG << "Cannot store the module manifest: " << e.what() << std::endl;
+    }
+}
+
+//! True when every entry of the listing is a direct child of the directory
+static bool is_listing_of(const fs::path &dir, const dir_listing_t &listing){
+    std::vector<std::string> children(listing.files);
+    children.insert(children.end(), listing.dirs.begin(), listing.dirs.end());
+    BOOST_FOREACH(const std::string &child, children){
+        const fs::path child_path(child);
+        const fs::path name = child_path.filename();
+        if (name.empty() or name == "." or name == "..") return false;
+        if (child_path != dir / name) return false;
+    }
+    return true;
+}
+
 /***********************************************************************
  * Load Modules
  **********************************************************************/
 /*!
- * Load all modules in a given path.
+ * Find all module files in a given path.
  * This will recurse into sub-directories.
- * Does not throw, prints to std error.
+ * The listing of a directory comes from the manifest when its mtime
+ * matches, the new manifest gets the listing of every directory seen.
  * \param path the filesystem path
+ * \param cached the manifest from the last run
+ * \param manifest the manifest for this run
+ * \param files the module files found, in order
+ * \return true when a directory was read from disk
  */
-static void load_module_path(const fs::path &path){
-    if (not fs::exists(path)){
-        //std::cerr << boost::format("Module path \"%s\" not found.") % path.string() << std::endl;
-        return;
+static bool find_module_files(
+    const fs::path &path,
+    const manifest_t &cached,
+    manifest_t &manifest,
+    std::vector<std::string> &files
+){
+    if (not fs::exists(path)) return false;
+
+    //its not a directory, it is a module
+    if (not fs::is_directory(path)){
+        files.push_back(path.string());
+        return false;
     }
 
-    //try to load the files in this path
-    if (fs::is_directory(path)){
+    const std::time_t mtime = fs::last_write_time(path);
+    manifest_t::const_iterator it = cached.find(path.string());
+    bool updated = false;
+    dir_listing_t listing;
+    if (it != cached.end() and it->second.mtime == mtime and is_listing_of(path, it->second)){
+        listing = it->second;
+    }
+    else{
+        listing.mtime = mtime;
         for(
             fs::directory_iterator dir_itr(path);
             dir_itr != fs::directory_iterator();
             ++dir_itr
         ){
-            load_module_path(dir_itr->path());
+            if (fs::is_directory(dir_itr->path())) listing.dirs.push_back(dir_itr->path().string());
+            else listing.files.push_back(dir_itr->path().string());
         }
-        return;
+        updated = true;
     }
 
-    //its not a directory, try to load it
-    try{
-        load_module(path.string());
-    }
-    catch(const std::exception &err){
-        std::cerr << boost::format("Error: %s") % err.what() << std::endl;
+    //a directory changed within the mtime resolution may change again
+    //without a new mtime, so only a settled listing goes into the manifest
+    if (std::difftime(std::time(NULL), mtime) >= 2) manifest[path.string()] = listing;
+
+    files.insert(files.end(), listing.files.begin(), listing.files.end());
+    BOOST_FOREACH(const std::string &dir, listing.dirs){
+        updated = find_module_files(dir, cached, manifest, files) or updated;
     }
+    return updated;
 }
 
 std::vector<fs::path> get_module_paths(void); //defined in paths.cpp
 
 /*!
  * Load all the modules given in the module paths.
+ * Modules are loaded on the first call, by the first device discovery,
+ * so processes that never look for a device do not load the modules.
+ * Does not throw, prints to std error.
  */
-UHD_STATIC_BLOCK(load_modules){
+void load_modules(void){
+    static boost::mutex mutex;
+    static bool loaded = false;
+    boost::mutex::scoped_lock lock(mutex);
+    if (loaded) return;
+    loaded = true;
+
+    const manifest_t cached = load_manifest();
+    manifest_t manifest;
+    std::vector<std::string> files;
+    bool updated = false;
     BOOST_FOREACH(const fs::path &path, get_module_paths()){
-        load_module_path(path);
+        try{
+            updated = find_module_files(path, cached, manifest, files) or updated;
+        }
+        catch(const std::exception &err){
+            std::cerr << boost::format("Error: %s") % err.what() << std::endl;
+        }
+    }
+    if (updated or manifest.size() != cached.size()) store_manifest(manifest);
+
+    BOOST_FOREACH(const std::string &file, files){
+        try{
+            load_module(file);
+        }
+        catch(const std::exception &err){
+            std::cerr << boost::format("Error: %s") % err.what() << std::endl;
+        }
     }
 }
@@ -18,9 +18,14 @@
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/static.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/atomic.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #ifdef BOOST_MSVC
 //whoops! https://svn.boost.org/trac/boost/ticket/5287
@@ -35,11 +40,6 @@ namespace boost{ namespace interprocess{
 #else
 #include <boost/interprocess/sync/file_lock.hpp>
 #endif
-#ifdef BOOST_MSVC
-#define USE_GET_TEMP_PATH
-#include <Windows.h> //GetTempPath
-#endif
-#include <stdio.h> //P_tmpdir
 #include <cstdlib> //getenv
 #include <fstream>
 #include <sstream>
@@ -49,50 +49,91 @@ namespace fs = boost::filesystem;
 namespace pt = boost::posix_time;
 namespace ip = boost::interprocess;
 
+fs::path get_temp_path(void); //defined in paths.cpp
+
 /***********************************************************************
- * Helper function to get the system's temporary path
+ * Log message queue
  **********************************************************************/
-static fs::path get_temp_path(void){
-    const char *tmp_path = NULL;
-
-    //try the official uhd temp path environment variable
-    tmp_path = std::getenv("UHD_TEMP_PATH");
-    if (tmp_path != NULL) return tmp_path;
-
-    //try the windows function if available
-    #ifdef USE_GET_TEMP_PATH
-    char lpBuffer[2048];
-    if (GetTempPath(sizeof(lpBuffer), lpBuffer)) return lpBuffer;
-    #endif
-
-    //try windows environment variables
-    tmp_path = std::getenv("TMP");
-    if (tmp_path != NULL) return tmp_path;
-
-    tmp_path = std::getenv("TEMP");
-    if (tmp_path != NULL) return tmp_path;
+/*!
+ * A bounded multi-producer single-consumer queue of log messages.
+ * Each slot has a sequence number that tells whose turn it is:
+ * a producer claims a slot with a cas on the head,
+ * and the consumer owns the slot the tail points to.
+ * A full queue drops the message instead of blocking the producer.
+ * The atomics do not order the slots on all cpus (see atomic.hpp),
+ * so full barriers fence the message around each sequence access.
+ */
+class log_queue_type : boost::noncopyable{
+public:
+    log_queue_type(const size_t capacity):
+        _capacity(capacity), _slots(new slot_type[capacity])
+    {
+        for (size_t i = 0; i < _capacity; i++) _slots[i].seq.write(boost::uint32_t(i));
+        _tail = 0;
+    }
 
-    //try the stdio define if available
-    #ifdef P_tmpdir
-        return P_tmpdir;
-    #endif
+    //! Push a message, swapping it into the queue; false when full
+    bool push(std::string &msg){
+        boost::uint32_t pos = _head.read();
+        while (true){
+            slot_type &slot = _slots[pos % _capacity];
+            const boost::int32_t diff = boost::int32_t(slot.seq.read() - pos);
+            if (diff == 0){
+                if (_head.cas(pos + 1, pos) != pos){
+                    pos = _head.read(); //another producer got this slot
+                    continue;
+                }
+                uhd::atomic_full_barrier(); //the slot is free before it is written
+                slot.msg.swap(msg);
+                uhd::atomic_full_barrier(); //the message is written before it is published
+                slot.seq.write(pos + 1); //publish to the consumer
+                return true;
+            }
+            if (diff < 0) return false; //the consumer has not freed this slot
+            pos = _head.read();
+        }
+    }
 
-    //try unix environment variables
-    tmp_path = std::getenv("TMPDIR");
-    if (tmp_path != NULL) return tmp_path;
+    //! Pop a message, swapping it out of the queue; false when empty
+    bool pop(std::string &msg){
+        slot_type &slot = _slots[_tail % _capacity];
+        if (slot.seq.read() != _tail + 1) return false;
+        uhd::atomic_full_barrier(); //the message is read after its sequence
+        msg.swap(slot.msg);
+        slot.msg.clear();
+        uhd::atomic_full_barrier(); //the slot is done with before it is freed
+        slot.seq.write(boost::uint32_t(_tail + _capacity)); //free for the next lap
+        _tail++;
+        return true;
+    }
 
-    //give up and use the unix default
-    return "/tmp";
-}
+private:
+    struct slot_type{
+        uhd::atomic_uint32_t seq;
+        std::string msg;
+    };
+    const size_t _capacity;
+    boost::scoped_array<slot_type> _slots;
+    uhd::atomic_uint32_t _head;
+    boost::uint32_t _tail; //only touched by the consumer
+};
 
 /***********************************************************************
  * Global resources for the logger
  **********************************************************************/
+//! the number of messages that can wait for the writer
+static const size_t LOG_QUEUE_CAPACITY = 4096; //a power of two, so slots survive the index wrap
+
+//! how long the writer sleeps when there is nothing to write
+static const long LOG_WRITER_IDLE_MS = 10;
+
 class log_resource_type{
 public:
     uhd::_log::verbosity_t level;
 
-    log_resource_type(void){
+    log_resource_type(void):
+        _num_reported(0)
+    {
 
         //file lock pointer must be null
         _file_lock = NULL;
@@ -112,20 +153,23 @@ public:
 
     ~log_resource_type(void){
         boost::mutex::scoped_lock lock(_mutex);
+        _writer_task.reset(); //stop the writer, then write what is left
+        try{
+            if (_file_lock != NULL) this->write_batch();
+        }
+        catch(...){}
         _file_stream.close();
         if (_file_lock != NULL) delete _file_lock;
     }
 
-    void log_to_file(const std::string &log_msg){
-        boost::mutex::scoped_lock lock(_mutex);
-        if (_file_lock == NULL){
-            const std::string log_path = (get_temp_path() / "uhd.log").string();
-            _file_stream.open(log_path.c_str(), std::fstream::out | std::fstream::app);
-            _file_lock = new ip::file_lock(log_path.c_str());
-        }
-        _file_lock->lock();
-        _file_stream << log_msg << std::flush;
-        _file_lock->unlock();
+    /*!
+     * Queue a message for the writer thread.
+     * This never blocks: under overload the message is dropped and counted.
+     * The message string is consumed.
+     */
+    void log_to_file(std::string &log_msg){
+        if (_writer_started.read() == 0) this->start_writer();
+        if (not _queue->push(log_msg)) _num_dropped.inc();
     }
 
 private:
@@ -145,10 +189,64 @@ private:
         if_lls_equal(never);
     }
 
+    //! open the log file and spawn the writer, once for the process
+    void start_writer(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_writer_started.read() != 0) return;
+        _queue.reset(new log_queue_type(LOG_QUEUE_CAPACITY));
+        const std::string log_path = (get_temp_path() / "uhd.log").string();
+        _file_stream.open(log_path.c_str(), std::fstream::out | std::fstream::app);
+        _file_lock = new ip::file_lock(log_path.c_str());
+        _writer_task = uhd::task::make(boost::bind(&log_resource_type::writer_task, this));
+        _writer_task->set_name("log writer");
+        _writer_started.write(1);
+    }
+
+    //! write everything in the queue with one file lock and flush
+    bool write_batch(void){
+        std::string batch, msg;
+        while (_queue->pop(msg)) batch += msg;
+
+        //report the drops since the last report
+        const boost::uint32_t num_dropped = _num_dropped.read();
+        if (num_dropped != _num_reported){
+            batch += str(boost::format("\n-- %u log messages dropped, the writer fell behind\n") % (num_dropped - _num_reported));
+            _num_reported = num_dropped;
+        }
+
+        if (batch.empty()) return false;
+        _file_lock->lock();
+        _file_stream << batch << std::flush;
+        _file_lock->unlock();
+        return true;
+    }
+
+    void writer_task(void){
+        try{
+            if (this->write_batch()) return;
+        }
+        catch(const std::exception &e){
+            //disable the logger before messaging, the message facility logs too
+            this->level = uhd::_log::never;
+            UHD_MSG(error)
+                << "Logging failed: " << e.what() << std::endl
+                << "Logging has been disabled for this process" << std::endl
+            ;
+        }
+        boost::this_thread::sleep(boost::posix_time::milliseconds(LOG_WRITER_IDLE_MS));
+    }
+
     //file stream and lock:
     std::ofstream _file_stream;
     ip::file_lock *_file_lock;
     boost::mutex _mutex;
+
+    //queue and writer thread:
+    boost::scoped_ptr<log_queue_type> _queue; //made with the writer, no memory when not logging
+    uhd::atomic_uint32_t _writer_started;
+    uhd::atomic_uint32_t _num_dropped;
+    boost::uint32_t _num_reported; //only touched by the writer
+    uhd::task::sptr _writer_task;
 };
 
 UHD_SINGLETON_FCN(log_resource_type, log_rs);
@@ -180,6 +278,7 @@ uhd::_log::log::log(
 ){
     _impl = UHD_PIMPL_MAKE(impl, ());
     _impl->verbosity = verbosity;
+    if (verbosity < log_rs().level) return; //skip the formatting, it will not be logged
     const std::string time = pt::to_simple_string(pt::microsec_clock::local_time());
     const std::string header1 = str(boost::format("-- %s - level %d") % time % int(verbosity));
     const std::string header2 = str(boost::format("-- %s") % function).substr(0, 80);
@@ -199,7 +298,8 @@ uhd::_log::log::~log(void){
     if (_impl->verbosity < log_rs().level) return;
     _impl->ss << std::endl;
     try{
-        log_rs().log_to_file(_impl->ss.str());
+        std::string log_msg = _impl->ss.str();
+        log_rs().log_to_file(log_msg);
     }
     catch(const std::exception &e){
         /*!
@@ -120,7 +120,9 @@ uhd::msg::_msg::_msg(const type_t type){
 
 uhd::msg::_msg::~_msg(void){
     boost::mutex::scoped_lock lock(msg_rs().mutex);
-    msg_rs().handler(_impl->type, _impl->ss.str());
+    //a message of the static initialization may come before the registration
+    if (msg_rs().handler) msg_rs().handler(_impl->type, _impl->ss.str());
+    else default_msg_handler(_impl->type, _impl->ss.str());
 }
 
 std::ostream & uhd::msg::_msg::operator()(void){
@@ -20,6 +20,11 @@
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
 #include <boost/bind.hpp>
+#ifdef BOOST_MSVC
+#define USE_GET_TEMP_PATH
+#include <Windows.h> //GetTempPath
+#endif
+#include <stdio.h> //P_tmpdir
 #include <cstdlib>
 #include <string>
 #include <vector>
@@ -79,3 +84,57 @@ std::vector<fs::path> get_module_paths(void){
     paths.push_back(get_uhd_pkg_data_path() / "modules");
     return paths;
 }
+
+/***********************************************************************
+ * Get the directory of the saved transport profiles
+ **********************************************************************/
+fs::path get_temp_path(void);
+
+fs::path get_profile_path(void){
+    const char *profile_path = std::getenv("UHD_PROFILE_PATH");
+    if (profile_path != NULL) return profile_path;
+
+    //try the unix home, then the windows home
+    const char *home_path = std::getenv("HOME");
+    if (home_path == NULL) home_path = std::getenv("APPDATA");
+    if (home_path != NULL) return fs::path(home_path) / ".uhd" / "profiles";
+
+    //give up and use the temp path
+    return get_temp_path() / "uhd_profiles";
+}
+
+/***********************************************************************
+ * Helper function to get the system's temporary path
+ **********************************************************************/
+fs::path get_temp_path(void){
+    const char *tmp_path = NULL;
+
+    //try the official uhd temp path environment variable
+    tmp_path = std::getenv("UHD_TEMP_PATH");
+    if (tmp_path != NULL) return tmp_path;
+
+    //try the windows function if available
+    #ifdef USE_GET_TEMP_PATH
+    char lpBuffer[2048];
+    if (GetTempPath(sizeof(lpBuffer), lpBuffer)) return lpBuffer;
+    #endif
+
+    //try windows environment variables
+    tmp_path = std::getenv("TMP");
+    if (tmp_path != NULL) return tmp_path;
+
+    tmp_path = std::getenv("TEMP");
+    if (tmp_path != NULL) return tmp_path;
+
+    //try the stdio define if available
+    #ifdef P_tmpdir
+        return P_tmpdir;
+    #endif
+
+    //try unix environment variables
+    tmp_path = std::getenv("TMPDIR");
+    if (tmp_path != NULL) return tmp_path;
+
+    //give up and use the unix default
+    return "/tmp";
+}
@@ -0,0 +1,42 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/sample_buffer.hpp>
+#include <uhd/transport/buffer_pool.hpp>
+#include <uhd/exception.hpp>
+
+/***********************************************************************
+ * A sample buffer is a buffer pool of one buffer:
+ * The returned pointer shares the ownership of the pool,
+ * so the memory lives as long as any copy of the pointer.
+ **********************************************************************/
+boost::shared_ptr<void> uhd::alloc_sample_buffer(
+    const size_t num_bytes,
+    const size_t alignment,
+    const bool hugepages
+){
+    if (alignment == 0 or (alignment & (alignment-1)) != 0) throw uhd::value_error(
+        "alloc_sample_buffer: the alignment must be a power of two"
+    );
+
+    uhd::transport::buffer_pool::alloc_policy_t policy;
+    policy.hugepages = hugepages;
+    uhd::transport::buffer_pool::sptr pool = uhd::transport::buffer_pool::make(
+        1, num_bytes, alignment, policy
+    );
+    return boost::shared_ptr<void>(pool, pool->at(0));
+}
@@ -17,38 +17,137 @@
 
 #include <uhd/utils/tasks.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/types/time_spec.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/barrier.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/foreach.hpp>
+#include <algorithm>
 #include <exception>
 #include <iostream>
+#include <list>
+
+#ifdef HAVE_PTHREAD_GETCPUCLOCKID
+#include <pthread.h>
+#include <time.h>
+#endif /*HAVE_PTHREAD_GETCPUCLOCKID*/
 
 using namespace uhd;
 
+task_stats_t::task_stats_t(void):
+    name("task"), iterations(0), run_time(0.0), cpu_time(0.0), wait_time(0.0)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * The cpu clock of the calling thread, readable from other threads
+ **********************************************************************/
+#ifdef HAVE_PTHREAD_GETCPUCLOCKID
+struct cpu_clock_t{
+    cpu_clock_t(void): valid(false){}
+    void init(void){valid = pthread_getcpuclockid(pthread_self(), &id) == 0;}
+    double read(void) const{
+        timespec ts;
+        if (not valid or clock_gettime(id, &ts) != 0) return 0.0;
+        return ts.tv_sec + ts.tv_nsec*1e-9;
+    }
+    bool valid;
+    clockid_t id;
+};
+#else
+struct cpu_clock_t{
+    void init(void){}
+    double read(void) const{return 0.0;}
+};
+#endif /*HAVE_PTHREAD_GETCPUCLOCKID*/
+
+/***********************************************************************
+ * Task implementation
+ **********************************************************************/
+class task_impl;
+
+//! The live tasks, for the stats of every task
+struct task_registry_t{
+    boost::mutex mutex;
+    std::list<task_impl *> tasks;
+};
+
+static task_registry_t &get_task_registry(void){
+    static task_registry_t *registry = new task_registry_t(); //never destroyed, tasks may outlive static destruction
+    return *registry;
+}
+
 class task_impl : public task{
 public:
 
-    task_impl(const task_fcn_type &task_fcn):
-        _spawn_barrier(2)
+    task_impl(const task_fcn_type &task_fcn, const std::vector<size_t> &cpus, const thread_sched_t &sched):
+        _spawn_barrier(2),
+        _iterations(0),
+        _exited(false),
+        _exit_cpu_time(0.0)
     {
-        _thread_group.create_thread(boost::bind(&task_impl::task_loop, this, task_fcn));
+        _thread_group.create_thread(boost::bind(&task_impl::task_loop, this, task_fcn, cpus, sched));
         _spawn_barrier.wait();
+
+        task_registry_t &registry = get_task_registry();
+        boost::mutex::scoped_lock lock(registry.mutex);
+        registry.tasks.push_back(this);
     }
 
     ~task_impl(void){
+        {
+            task_registry_t &registry = get_task_registry();
+            boost::mutex::scoped_lock lock(registry.mutex);
+            registry.tasks.remove(this);
+        }
         _running = false;
         _thread_group.interrupt_all();
         _thread_group.join_all();
     }
 
+    thread_sched_t get_sched(void) const{
+        return _sched;
+    }
+
+    void set_name(const std::string &name){
+        boost::mutex::scoped_lock lock(get_task_registry().mutex);
+        _name = name;
+    }
+
+    //! Called with the registry lock held, it guards the name
+    task_stats_t get_stats_locked(void) const{
+        task_stats_t stats;
+        if (not _name.empty()) stats.name = _name;
+        stats.iterations = _iterations;
+        stats.run_time = (time_spec_t::get_system_time() - _start_time).get_real_secs();
+        stats.cpu_time = _exited? _exit_cpu_time : _cpu_clock.read();
+        if (stats.cpu_time > 0.0) stats.wait_time = std::max(stats.run_time - stats.cpu_time, 0.0);
+        return stats;
+    }
+
+    task_stats_t get_stats(void) const{
+        boost::mutex::scoped_lock lock(get_task_registry().mutex);
+        return this->get_stats_locked();
+    }
+
 private:
 
-    void task_loop(const task_fcn_type &task_fcn){
+    void task_loop(const task_fcn_type &task_fcn, const std::vector<size_t> &cpus, const thread_sched_t &sched){
+        if (not cpus.empty()) set_thread_affinity_safe(cpus);
+        set_thread_sched_safe(sched);
+        try{_sched = get_thread_sched();}
+        catch(const std::exception &){_sched = thread_sched_t();}
+        _cpu_clock.init();
+        _start_time = time_spec_t::get_system_time();
         _running = true;
         _spawn_barrier.wait();
 
         try{
             while (_running){
                 task_fcn();
+                _iterations++;
             }
         }
         catch(const boost::thread_interrupted &){
@@ -62,6 +161,10 @@ private:
             //Unfortunately, this is also an ok way to end a task,
             //because on some systems boost throws uncatchables.
         }
+
+        //the cpu clock is gone with the thread, keep its final reading
+        _exit_cpu_time = _cpu_clock.read();
+        _exited = true;
     }
 
     void do_error_msg(const std::string &msg){
@@ -75,8 +178,39 @@ private:
     boost::thread_group _thread_group;
     boost::barrier _spawn_barrier;
     bool _running;
+    thread_sched_t _sched; //written before the spawn barrier
+
+    //the accounting is written by the task thread only
+    std::string _name;
+    cpu_clock_t _cpu_clock;
+    time_spec_t _start_time;
+    volatile size_t _iterations;
+    volatile bool _exited;
+    double _exit_cpu_time;
 };
 
+std::vector<task_stats_t> task::get_all_stats(void){
+    task_registry_t &registry = get_task_registry();
+    boost::mutex::scoped_lock lock(registry.mutex);
+    std::vector<task_stats_t> all_stats;
+    BOOST_FOREACH(const task_impl *task, registry.tasks){
+        all_stats.push_back(task->get_stats_locked());
+    }
+    return all_stats;
+}
+
 task::sptr task::make(const task_fcn_type &task_fcn){
-    return task::sptr(new task_impl(task_fcn));
+    return task::sptr(new task_impl(task_fcn, std::vector<size_t>(), thread_sched_t()));
+}
+
+task::sptr task::make(const task_fcn_type &task_fcn, const std::vector<size_t> &cpus){
+    return task::sptr(new task_impl(task_fcn, cpus, thread_sched_t()));
+}
+
+task::sptr task::make(
+    const task_fcn_type &task_fcn,
+    const std::vector<size_t> &cpus,
+    const thread_sched_t &sched
+){
+    return task::sptr(new task_impl(task_fcn, cpus, sched));
 }
@@ -19,6 +19,9 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
 #include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <iostream>
 
 bool uhd::set_thread_priority_safe(float priority, bool realtime){
@@ -35,25 +38,171 @@ bool uhd::set_thread_priority_safe(float priority, bool realtime){
     }
 }
 
+bool uhd::set_thread_affinity_safe(const std::vector<size_t> &cpus){
+    try{
+        set_thread_affinity(cpus);
+        return true;
+    }catch(const std::exception &e){
+        UHD_MSG(warning) << boost::format(
+            "Unable to set the thread affinity. The thread may run on any CPU.\n"
+            "%s\n"
+        ) % e.what();
+        return false;
+    }
+}
+
+std::vector<size_t> uhd::cpus_from_string(const std::string &cpus){
+    std::vector<size_t> result;
+    if (cpus.empty()) return result;
+    std::vector<std::string> toks;
+    boost::split(toks, cpus, boost::is_any_of(","));
+    try{
+        for (size_t i = 0; i < toks.size(); i++){
+            const std::string tok = boost::trim_copy(toks[i]);
+            const size_t dash = tok.find('-');
+            const size_t first = boost::lexical_cast<size_t>(tok.substr(0, dash));
+            const size_t last = (dash == std::string::npos)? first : boost::lexical_cast<size_t>(tok.substr(dash+1));
+            if (last < first) throw uhd::value_error("reversed range");
+            for (size_t cpu = first; cpu <= last; cpu++) result.push_back(cpu);
+        }
+    }
+    catch(const std::exception &){
+        throw uhd::value_error("malformed cpu set " + cpus + ", expected N, N-M, or a comma separated list");
+    }
+    return result;
+}
+
+bool uhd::set_thread_sched_safe(const thread_sched_t &sched){
+    try{
+        set_thread_sched(sched);
+        return true;
+    }catch(const std::exception &e){
+        UHD_MSG(warning) << boost::format(
+            "Unable to set the thread scheduling to %s. Performance may be negatively affected.\n"
+            "Please see the general application notes in the manual for instructions.\n"
+            "%s\n"
+        ) % sched.to_string() % e.what();
+        return false;
+    }
+}
+
 static void check_priority_range(float priority){
     if (priority > +1.0 or priority < -1.0)
         throw uhd::value_error("priority out of range [-1.0, +1.0]");
 }
 
+void uhd::set_thread_priority(float priority, bool realtime){
+    check_priority_range(priority);
+    set_thread_sched(thread_sched_t(
+        (realtime)? thread_sched_t::POLICY_RR : thread_sched_t::POLICY_OTHER, priority
+    ));
+}
+
+/***********************************************************************
+ * Scheduling request strings
+ **********************************************************************/
+uhd::thread_sched_t::thread_sched_t(policy_t policy, float priority):
+    policy(policy), priority(priority), runtime(0), deadline(0), period(0)
+{
+    /* NOP */
+}
+
+uhd::thread_sched_t uhd::thread_sched_t::from_string(const std::string &sched){
+    if (sched.empty()) return thread_sched_t();
+
+    std::vector<std::string> toks;
+    boost::split(toks, sched, boost::is_any_of(":"));
+    try{
+        if (toks[0] == "deadline" and toks.size() == 3){
+            thread_sched_t result(POLICY_DEADLINE, 0);
+            result.runtime = boost::lexical_cast<double>(toks[1]);
+            result.deadline = result.period = boost::lexical_cast<double>(toks[2]);
+            return result;
+        }
+        if (toks.size() <= 2){
+            const float priority = (toks.size() == 2)? boost::lexical_cast<float>(toks[1]) : default_thread_priority;
+            check_priority_range(priority);
+            if (toks[0] == "other") return thread_sched_t(POLICY_OTHER, priority);
+            if (toks[0] == "rr") return thread_sched_t(POLICY_RR, priority);
+            if (toks[0] == "fifo") return thread_sched_t(POLICY_FIFO, priority);
+        }
+    }
+    catch(const std::exception &){} //fall through to the error below
+    throw uhd::value_error(
+        "malformed thread scheduling " + sched +
+        ", expected other[:P], rr[:P], fifo[:P], or deadline:RUNTIME:PERIOD"
+    );
+}
+
+std::string uhd::thread_sched_t::to_string(void) const{
+    switch(policy){
+    case POLICY_INHERIT: return "";
+    case POLICY_OTHER: return str(boost::format("other:%g") % priority);
+    case POLICY_RR: return str(boost::format("rr:%g") % priority);
+    case POLICY_FIFO: return str(boost::format("fifo:%g") % priority);
+    case POLICY_DEADLINE: return str(boost::format("deadline:%g:%g") % runtime % period);
+    }
+    return "";
+}
+
 /***********************************************************************
  * Pthread API to set priority
  **********************************************************************/
 #ifdef HAVE_PTHREAD_SETSCHEDPARAM
     #include <pthread.h>
+    #include <boost/cstdint.hpp>
+    #include <boost/math/special_functions/round.hpp>
+    #include <unistd.h>
+    #include <sys/syscall.h>
 
-    void uhd::set_thread_priority(float priority, bool realtime){
-        check_priority_range(priority);
+    //the deadline policy has no pthread api, use the raw system calls
+    #if defined(__linux__) && defined(__NR_sched_setattr) && defined(__NR_sched_getattr)
+        #define HAVE_SCHED_SETATTR
+        static const int policy_deadline = 6; //SCHED_DEADLINE
+
+        struct sched_attr_type{
+            boost::uint32_t size;
+            boost::uint32_t sched_policy;
+            boost::uint64_t sched_flags;
+            boost::int32_t sched_nice;
+            boost::uint32_t sched_priority;
+            boost::uint64_t sched_runtime; //nanoseconds
+            boost::uint64_t sched_deadline; //nanoseconds
+            boost::uint64_t sched_period; //nanoseconds
+        };
 
-        //when realtime is not enabled, use sched other
-        int policy = (realtime)? SCHED_RR : SCHED_OTHER;
+        static boost::uint64_t to_nsecs(const double secs){
+            return boost::uint64_t(boost::math::llround(secs*1e9));
+        }
+    #endif
+
+    void uhd::set_thread_sched(const thread_sched_t &sched){
+        if (sched.policy == thread_sched_t::POLICY_INHERIT) return;
+
+        if (sched.policy == thread_sched_t::POLICY_DEADLINE){
+            #ifdef HAVE_SCHED_SETATTR
+            if (sched.runtime <= 0 or sched.runtime > sched.deadline or sched.deadline > sched.period)
+                throw uhd::value_error("deadline scheduling requires 0 < runtime <= deadline <= period");
+            sched_attr_type attr = sched_attr_type();
+            attr.size = sizeof(attr);
+            attr.sched_policy = policy_deadline;
+            attr.sched_runtime = to_nsecs(sched.runtime);
+            attr.sched_deadline = to_nsecs(sched.deadline);
+            attr.sched_period = to_nsecs(sched.period);
+            if (::syscall(__NR_sched_setattr, 0, &attr, 0) != 0) throw uhd::os_error("error in sched_setattr");
+            return;
+            #else
+            throw uhd::not_implemented_error("deadline scheduling not implemented");
+            #endif
+        }
+
+        check_priority_range(sched.priority);
+        int policy = SCHED_OTHER;
+        if (sched.policy == thread_sched_t::POLICY_RR) policy = SCHED_RR;
+        if (sched.policy == thread_sched_t::POLICY_FIFO) policy = SCHED_FIFO;
 
         //we cannot have below normal priority, set to zero
-        if (priority < 0) priority = 0;
+        const float priority = std::max(sched.priority, 0.0f);
 
         //get the priority bounds for the selected policy
         int min_pri = sched_get_priority_min(policy);
@@ -66,41 +215,147 @@ static void check_priority_range(float priority){
         int ret = pthread_setschedparam(pthread_self(), policy, &sp);
         if (ret != 0) throw uhd::os_error("error in pthread_setschedparam");
     }
+
+    uhd::thread_sched_t uhd::get_thread_sched(void){
+        int policy = SCHED_OTHER;
+        sched_param sp;
+        if (pthread_getschedparam(pthread_self(), &policy, &sp) != 0)
+            throw uhd::os_error("error in pthread_getschedparam");
+
+        #ifdef HAVE_SCHED_SETATTR
+        if (policy == policy_deadline){
+            sched_attr_type attr = sched_attr_type();
+            if (::syscall(__NR_sched_getattr, 0, &attr, sizeof(attr), 0) != 0)
+                throw uhd::os_error("error in sched_getattr");
+            thread_sched_t result(thread_sched_t::POLICY_DEADLINE, 0);
+            result.runtime = attr.sched_runtime/1e9;
+            result.deadline = attr.sched_deadline/1e9;
+            result.period = attr.sched_period/1e9;
+            return result;
+        }
+        #endif
+
+        if (policy != SCHED_RR and policy != SCHED_FIFO) return thread_sched_t(thread_sched_t::POLICY_OTHER, 0);
+
+        //scale the priority back into [0, 1]
+        int min_pri = sched_get_priority_min(policy);
+        int max_pri = sched_get_priority_max(policy);
+        if (min_pri == -1 or max_pri == -1) throw uhd::os_error("error in sched_get_priority_min/max");
+        return thread_sched_t(
+            (policy == SCHED_RR)? thread_sched_t::POLICY_RR : thread_sched_t::POLICY_FIFO,
+            float(sp.sched_priority - min_pri)/(max_pri - min_pri)
+        );
+    }
 #endif /* HAVE_PTHREAD_SETSCHEDPARAM */
 
+/***********************************************************************
+ * Pthread API to set affinity
+ **********************************************************************/
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+    #include <pthread.h>
+
+    void uhd::set_thread_affinity(const std::vector<size_t> &cpus){
+        if (cpus.empty()) return;
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (size_t i = 0; i < cpus.size(); i++){
+            if (cpus[i] >= CPU_SETSIZE) throw uhd::value_error("cpu index out of range");
+            CPU_SET(cpus[i], &cpu_set);
+        }
+
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (ret != 0) throw uhd::os_error("error in pthread_setaffinity_np");
+    }
+#endif /* HAVE_PTHREAD_SETAFFINITY_NP */
+
 /***********************************************************************
  * Windows API to set priority
  **********************************************************************/
 #ifdef HAVE_WIN_SETTHREADPRIORITY
     #include <windows.h>
 
-    void uhd::set_thread_priority(float priority, bool realtime){
-        check_priority_range(priority);
+    static const int win_priorities[] = {
+        THREAD_PRIORITY_IDLE, THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+        THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST, THREAD_PRIORITY_TIME_CRITICAL
+    };
 
-        //set the priority class on the process
-        int pri_class = (realtime)? REALTIME_PRIORITY_CLASS : NORMAL_PRIORITY_CLASS;
+    void uhd::set_thread_sched(const thread_sched_t &sched){
+        if (sched.policy == thread_sched_t::POLICY_INHERIT) return;
+        if (sched.policy == thread_sched_t::POLICY_DEADLINE)
+            throw uhd::not_implemented_error("deadline scheduling not implemented");
+        check_priority_range(sched.priority);
+
+        //set the priority class on the process, fifo is treated as round-robin
+        int pri_class = (sched.policy == thread_sched_t::POLICY_OTHER)? NORMAL_PRIORITY_CLASS : REALTIME_PRIORITY_CLASS;
         if (SetPriorityClass(GetCurrentProcess(), pri_class) == 0)
             throw uhd::os_error("error in SetPriorityClass");
 
         //scale the priority value to the constants
-        int priorities[] = {
-            THREAD_PRIORITY_IDLE, THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
-            THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST, THREAD_PRIORITY_TIME_CRITICAL
-        };
-        size_t pri_index = size_t((priority+1.0)*6/2.0); // -1 -> 0, +1 -> 6
+        size_t pri_index = size_t((sched.priority+1.0)*6/2.0); // -1 -> 0, +1 -> 6
 
         //set the thread priority on the thread
-        if (SetThreadPriority(GetCurrentThread(), priorities[pri_index]) == 0)
+        if (SetThreadPriority(GetCurrentThread(), win_priorities[pri_index]) == 0)
             throw uhd::os_error("error in SetThreadPriority");
     }
+
+    uhd::thread_sched_t uhd::get_thread_sched(void){
+        const int win_priority = GetThreadPriority(GetCurrentThread());
+        if (win_priority == THREAD_PRIORITY_ERROR_RETURN) throw uhd::os_error("error in GetThreadPriority");
+
+        //find the nearest constant and scale it back into [-1, 1]
+        size_t pri_index = 0;
+        while (pri_index < 6 and win_priorities[pri_index] < win_priority) pri_index++;
+        const bool realtime = GetPriorityClass(GetCurrentProcess()) == REALTIME_PRIORITY_CLASS;
+        return thread_sched_t(
+            (realtime)? thread_sched_t::POLICY_RR : thread_sched_t::POLICY_OTHER,
+            float(pri_index)*2/6 - 1
+        );
+    }
 #endif /* HAVE_WIN_SETTHREADPRIORITY */
 
+/***********************************************************************
+ * Windows API to set affinity
+ **********************************************************************/
+#ifdef HAVE_WIN_SETTHREADAFFINITYMASK
+    #include <windows.h>
+
+    void uhd::set_thread_affinity(const std::vector<size_t> &cpus){
+        if (cpus.empty()) return;
+
+        DWORD_PTR mask = 0;
+        for (size_t i = 0; i < cpus.size(); i++){
+            if (cpus[i] >= sizeof(DWORD_PTR)*8) throw uhd::value_error("cpu index out of range");
+            mask |= DWORD_PTR(1) << cpus[i];
+        }
+
+        if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+            throw uhd::os_error("error in SetThreadAffinityMask");
+    }
+#endif /* HAVE_WIN_SETTHREADAFFINITYMASK */
+
 /***********************************************************************
  * Unimplemented API to set priority
  **********************************************************************/
-#ifdef HAVE_LOAD_MODULES_DUMMY
-    void uhd::set_thread_priority(float, bool){
+#ifdef HAVE_THREAD_PRIO_DUMMY
+    void uhd::set_thread_sched(const thread_sched_t &sched){
+        if (sched.policy == thread_sched_t::POLICY_INHERIT) return;
         throw uhd::not_implemented_error("set thread priority not implemented");
     }
 
-#endif /* HAVE_LOAD_MODULES_DUMMY */
+    uhd::thread_sched_t uhd::get_thread_sched(void){
+        return thread_sched_t(thread_sched_t::POLICY_OTHER, 0);
+    }
+
+#endif /* HAVE_THREAD_PRIO_DUMMY */
+
+/***********************************************************************
+ * Unimplemented API to set affinity
+ **********************************************************************/
+#ifdef HAVE_THREAD_AFFINITY_DUMMY
+    void uhd::set_thread_affinity(const std::vector<size_t> &cpus){
+        if (cpus.empty()) return;
+        throw uhd::not_implemented_error("set thread affinity not implemented");
+    }
+
+#endif /* HAVE_THREAD_AFFINITY_DUMMY */
@@ -0,0 +1,194 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/trace.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/static.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/foreach.hpp>
+#include <cstdlib> //getenv
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+volatile bool uhd::_trace::is_on = false;
+
+/***********************************************************************
+ * Per thread event rings
+ **********************************************************************/
+//! The events per thread, the oldest are overwritten
+static const size_t TRACE_RING_SIZE = size_t(1 << 14);
+
+//! Events this close to being overwritten are skipped when writing
+static const size_t TRACE_RING_GUARD = TRACE_RING_SIZE/16;
+
+struct trace_event_t{
+    const char *name;
+    boost::int64_t time_ns;
+    boost::int64_t dur_ns;
+};
+
+/*!
+ * The ring of one thread.
+ * Only the owning thread writes the events,
+ * the count is written after the event so a reader sees whole events.
+ * A clear only moves the cleared count up to the count,
+ * and the reader skips the events before it.
+ */
+struct trace_ring_t{
+    trace_ring_t(const size_t tid): tid(tid), cleared_count(0), events(TRACE_RING_SIZE){}
+    const size_t tid;
+    uhd::atomic_uint32_t count;
+    boost::uint32_t cleared_count; //under the registry mutex
+    std::vector<trace_event_t> events;
+};
+
+//! The rings of all traced threads, they outlive their threads
+struct trace_registry_t{
+    boost::mutex mutex;
+    std::vector<trace_ring_t *> rings;
+};
+
+static trace_registry_t &get_registry(void){
+    static trace_registry_t *registry = new trace_registry_t(); //never destroyed, rings are read at exit
+    return *registry;
+}
+
+static void trace_ring_cleanup(trace_ring_t *){
+    /* NOP: the registry keeps the ring to write it later */
+}
+
+static trace_ring_t &get_thread_ring(void){
+    static boost::thread_specific_ptr<trace_ring_t> thread_ring(&trace_ring_cleanup);
+    if (thread_ring.get() == NULL){
+        trace_registry_t &registry = get_registry();
+        boost::mutex::scoped_lock lock(registry.mutex);
+        thread_ring.reset(new trace_ring_t(registry.rings.size()));
+        registry.rings.push_back(thread_ring.get());
+    }
+    return *thread_ring;
+}
+
+boost::int64_t uhd::_trace::get_time_ns(void){
+    const uhd::time_spec_t now = uhd::time_spec_t::get_system_time();
+    return boost::int64_t(now.get_full_secs())*1000000000 + boost::int64_t(now.get_tick_count(1e9));
+}
+
+void uhd::_trace::record(const char *name, boost::int64_t time_ns, boost::int64_t dur_ns){
+    trace_ring_t &ring = get_thread_ring();
+    const boost::uint32_t count = ring.count.read();
+    trace_event_t &event = ring.events[count % TRACE_RING_SIZE];
+    event.name = name;
+    event.time_ns = time_ns;
+    event.dur_ns = dur_ns;
+    uhd::atomic_full_barrier(); //the event is written before the count
+    ring.count.write(count + 1);
+}
+
+/***********************************************************************
+ * Trace control and the chrome trace writer
+ **********************************************************************/
+//! Chrome trace times are in microseconds
+static void write_us(std::ostream &out, const boost::int64_t ns){
+    out << ns/1000 << "." << std::setw(3) << std::setfill('0') << ns%1000 << std::setfill(' ');
+}
+
+bool uhd::trace::is_compiled(void){
+    #ifdef UHD_TRACE
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+void uhd::trace::set_enabled(const bool enb){
+    uhd::_trace::is_on = enb;
+}
+
+bool uhd::trace::is_enabled(void){
+    return uhd::_trace::is_on;
+}
+
+void uhd::trace::clear(void){
+    //the events are owned by the writing thread, so only forget what it has written
+    trace_registry_t &registry = get_registry();
+    boost::mutex::scoped_lock lock(registry.mutex);
+    BOOST_FOREACH(trace_ring_t *ring, registry.rings){
+        ring->cleared_count = ring->count.read();
+    }
+}
+
+size_t uhd::trace::write_chrome_json(const std::string &path){
+    std::ofstream out(path.c_str());
+    if (not out.is_open()) throw uhd::os_error("trace: cannot open " + path);
+
+    trace_registry_t &registry = get_registry();
+    boost::mutex::scoped_lock lock(registry.mutex);
+    size_t num_events = 0;
+    out << "{\"traceEvents\":[";
+    BOOST_FOREACH(trace_ring_t *ring, registry.rings){
+        //a full ring is still being overwritten from its oldest event
+        const boost::uint32_t count = ring->count.read();
+        uhd::atomic_full_barrier(); //the events are read after the count
+        const boost::uint32_t num_kept = (count > TRACE_RING_SIZE)? boost::uint32_t(TRACE_RING_SIZE - TRACE_RING_GUARD) : count;
+        const boost::uint32_t first = count - std::min(num_kept, boost::uint32_t(count - ring->cleared_count));
+        for (boost::uint32_t i = first; i != count; i++){
+            const trace_event_t event = ring->events[i % TRACE_RING_SIZE];
+            out << ((num_events++ == 0)? "\n" : ",\n");
+            out << "{\"name\":\"" << event.name << "\",\"cat\":\"uhd\",\"pid\":0,\"tid\":" << ring->tid;
+            out << ",\"ts\":"; write_us(out, event.time_ns);
+            if (event.dur_ns < 0) out << ",\"ph\":\"i\",\"s\":\"t\"}";
+            else{
+                out << ",\"ph\":\"X\",\"dur\":"; write_us(out, event.dur_ns);
+                out << "}";
+            }
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+    return num_events;
+}
+
+/***********************************************************************
+ * Trace a whole run through the environment
+ **********************************************************************/
+struct trace_file_writer_t{
+    ~trace_file_writer_t(void){
+        if (path.empty()) return;
+        try{
+            uhd::trace::write_chrome_json(path);
+        }
+        catch(const std::exception &e){
+            UHD_MSG(error) << "Cannot write the trace file: " << e.what() << std::endl;
+        }
+    }
+    std::string path;
+};
+
+UHD_STATIC_BLOCK(trace_from_environment){
+    static trace_file_writer_t writer;
+    const char *trace_file_env = std::getenv("UHD_TRACE_FILE");
+    if (trace_file_env == NULL) return;
+    writer.path = trace_file_env;
+    uhd::trace::set_enabled(true);
+    if (not uhd::trace::is_compiled()) UHD_MSG(warning)
+        << "UHD_TRACE_FILE is set, but this build has no trace points (configure with ENABLE_TRACE=ON)" << std::endl;
+}
@@ -0,0 +1,111 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "../lib/transport/async_msg_ring.hpp"
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+static const double timeout = 0.01/*secs*/;
+
+static async_metadata_t make_msg(const size_t channel, const async_metadata_t::event_code_t event_code){
+    async_metadata_t metadata;
+    metadata.channel = channel;
+    metadata.has_time_spec = false;
+    metadata.event_code = event_code;
+    return metadata;
+}
+
+BOOST_AUTO_TEST_CASE(test_async_msg_ring_overwrite){
+    async_msg_ring ring(3); //rounded up to 4
+
+    for (size_t i = 0; i < 6; i++){
+        ring.push_with_pop_on_full(make_msg(i, async_metadata_t::EVENT_CODE_BURST_ACK));
+    }
+
+    //the oldest two were overwritten
+    async_metadata_t metadata;
+    for (size_t i = 2; i < 6; i++){
+        BOOST_REQUIRE(ring.pop_with_timed_wait(metadata, timeout));
+        BOOST_CHECK_EQUAL(metadata.channel, i);
+    }
+    BOOST_CHECK(not ring.pop_with_timed_wait(metadata, timeout));
+    BOOST_CHECK(not ring.pop_with_timed_wait(metadata, 0.0));
+
+    BOOST_CHECK_EQUAL(ring.get_count(async_msg_ring::COUNTER_BURST_ACK), size_t(6));
+    BOOST_CHECK_EQUAL(ring.get_count(async_msg_ring::COUNTER_DROPPED), size_t(2));
+}
+
+BOOST_AUTO_TEST_CASE(test_async_msg_ring_counters){
+    async_msg_ring ring(4);
+
+    //the counts include the messages that are never popped
+    for (size_t i = 0; i < 100; i++){
+        ring.push_with_pop_on_full(make_msg(0, async_metadata_t::EVENT_CODE_UNDERFLOW));
+    }
+    ring.push_with_pop_on_full(make_msg(0, async_metadata_t::event_code_t(
+        async_metadata_t::EVENT_CODE_TIME_ERROR | async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST
+    )));
+
+    BOOST_CHECK_EQUAL(ring.get_count(async_msg_ring::COUNTER_UNDERFLOW), size_t(100));
+    BOOST_CHECK_EQUAL(ring.get_count(async_msg_ring::COUNTER_TIME_ERROR), size_t(1));
+    BOOST_CHECK_EQUAL(ring.get_count(async_msg_ring::COUNTER_SEQ_ERROR_IN_BURST), size_t(1));
+    BOOST_CHECK_EQUAL(ring.get_count(async_msg_ring::COUNTER_BURST_ACK), size_t(0));
+
+    //the lost messages are counted once a pop skips over them
+    async_metadata_t metadata;
+    BOOST_CHECK(ring.pop_with_timed_wait(metadata, timeout));
+    BOOST_CHECK_EQUAL(ring.get_count(async_msg_ring::COUNTER_DROPPED), size_t(101 - 4));
+}
+
+static void push_msgs(async_msg_ring *ring, const size_t channel, const size_t num_msgs){
+    for (size_t i = 0; i < num_msgs; i++){
+        async_metadata_t metadata = make_msg(channel, async_metadata_t::EVENT_CODE_BURST_ACK);
+        metadata.time_spec = time_spec_t(time_t(i), 0.0); //the order of this producer
+        ring->push_with_pop_on_full(metadata);
+        if (i % 16 == 0) boost::this_thread::yield();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_async_msg_ring_threads){
+    static const size_t num_msgs = 10000, num_producers = 3;
+    async_msg_ring ring(64);
+
+    boost::thread_group producers;
+    for (size_t i = 0; i < num_producers; i++){
+        producers.create_thread(boost::bind(&push_msgs, &ring, i, num_msgs));
+    }
+
+    //every message is popped or counted as dropped, and each producer stays in order
+    size_t num_popped = 0;
+    std::vector<long> last_secs(num_producers, -1);
+    async_metadata_t metadata;
+    while (ring.pop_with_timed_wait(metadata, 0.1)){
+        BOOST_REQUIRE(metadata.channel < num_producers);
+        BOOST_CHECK(long(metadata.time_spec.get_full_secs()) > last_secs[metadata.channel]);
+        last_secs[metadata.channel] = long(metadata.time_spec.get_full_secs());
+        num_popped++;
+    }
+    producers.join_all();
+    while (ring.pop_with_timed_wait(metadata, 0.0)) num_popped++;
+
+    BOOST_CHECK_EQUAL(ring.get_count(async_msg_ring::COUNTER_BURST_ACK), num_producers*num_msgs);
+    BOOST_CHECK_EQUAL(num_popped + ring.get_count(async_msg_ring::COUNTER_DROPPED), num_producers*num_msgs);
+}
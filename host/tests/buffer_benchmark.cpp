@@ -0,0 +1,209 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace po = boost::program_options;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * Queue operations by mode:
+ * The haste mode spins with a yield until the operation succeeds.
+ * The timed wait mode retries on timeout.
+ **********************************************************************/
+enum mode_type{MODE_HASTE, MODE_WAIT, MODE_TIMED_WAIT};
+
+static const double timeout = 0.1;
+
+template <typename queue_type, typename elem_type>
+static void push(queue_type &queue, const elem_type &elem, mode_type mode){
+    switch(mode){
+    case MODE_HASTE: while (not queue.push_with_haste(elem)) boost::this_thread::yield(); return;
+    case MODE_WAIT: queue.push_with_wait(elem); return;
+    case MODE_TIMED_WAIT: while (not queue.push_with_timed_wait(elem, timeout)){} return;
+    }
+}
+
+template <typename queue_type, typename elem_type>
+static void pop(queue_type &queue, elem_type &elem, mode_type mode){
+    switch(mode){
+    case MODE_HASTE: while (not queue.pop_with_haste(elem)) boost::this_thread::yield(); return;
+    case MODE_WAIT: queue.pop_with_wait(elem); return;
+    case MODE_TIMED_WAIT: while (not queue.pop_with_timed_wait(elem, timeout)){} return;
+    }
+}
+
+/***********************************************************************
+ * Throughput: producers and consumers run flat out
+ **********************************************************************/
+template <typename queue_type>
+static void produce(queue_type &queue, size_t num_items, mode_type mode){
+    for (size_t i = 0; i < num_items; i++) push(queue, double(i), mode);
+}
+
+template <typename queue_type>
+static void consume(queue_type &queue, size_t num_items, mode_type mode){
+    double elem;
+    for (size_t i = 0; i < num_items; i++) pop(queue, elem, mode);
+}
+
+template <typename queue_type>
+static double bench_throughput(
+    size_t capacity, size_t num_producers, size_t num_consumers,
+    size_t num_items, mode_type mode
+){
+    //every consumer pops the same number of items
+    const size_t per_producer = (num_items/num_producers/num_consumers)*num_consumers;
+    const size_t per_consumer = per_producer*num_producers/num_consumers;
+
+    queue_type queue(capacity);
+    boost::thread_group threads;
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    for (size_t i = 0; i < num_consumers; i++){
+        threads.create_thread(boost::bind(&consume<queue_type>, boost::ref(queue), per_consumer, mode));
+    }
+    for (size_t i = 0; i < num_producers; i++){
+        threads.create_thread(boost::bind(&produce<queue_type>, boost::ref(queue), per_producer, mode));
+    }
+    threads.join_all();
+    const double secs = (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+    return per_producer*num_producers/secs;
+}
+
+/***********************************************************************
+ * Wakeup latency: one producer pushes a time stamp at a slow pace,
+ * so the consumer is idle in its pop when each element arrives.
+ **********************************************************************/
+template <typename queue_type>
+static void produce_paced(queue_type &queue, size_t num_items, double interval, mode_type mode){
+    for (size_t i = 0; i < num_items; i++){
+        boost::this_thread::sleep(boost::posix_time::microseconds(long(interval*1e6)));
+        push(queue, uhd::time_spec_t::get_system_time().get_real_secs(), mode);
+    }
+}
+
+template <typename queue_type>
+static void consume_paced(queue_type &queue, std::vector<double> &latencies, mode_type mode){
+    double stamp;
+    for (size_t i = 0; i < latencies.size(); i++){
+        pop(queue, stamp, mode);
+        latencies[i] = uhd::time_spec_t::get_system_time().get_real_secs() - stamp;
+    }
+}
+
+template <typename queue_type>
+static std::vector<double> bench_wakeup(size_t num_items, double interval, mode_type mode){
+    queue_type queue(16);
+    std::vector<double> latencies(num_items);
+    boost::thread_group threads;
+    threads.create_thread(boost::bind(&consume_paced<queue_type>, boost::ref(queue), boost::ref(latencies), mode));
+    threads.create_thread(boost::bind(&produce_paced<queue_type>, boost::ref(queue), num_items, interval, mode));
+    threads.join_all();
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+static double percentile(const std::vector<double> &sorted, double p){
+    return sorted[std::min(sorted.size() - 1, size_t(p*sorted.size()))];
+}
+
+/***********************************************************************
+ * Run every queue policy, pattern, and mode
+ **********************************************************************/
+template <typename queue_type>
+static void bench_queue(
+    const std::string &name, bool single_producer_only,
+    const std::vector<std::string> &patterns, const std::vector<std::string> &modes,
+    size_t capacity, size_t num_threads, size_t num_items,
+    size_t num_wakeups, double interval
+){
+    BOOST_FOREACH(const std::string &mode_name, modes){
+        const mode_type mode = (mode_name == "haste")? MODE_HASTE : (mode_name == "wait")? MODE_WAIT : MODE_TIMED_WAIT;
+
+        BOOST_FOREACH(const std::string &pattern, patterns){
+            if (single_producer_only and pattern != "spsc") continue;
+            const size_t num_producers = (pattern == "spsc")? 1 : num_threads;
+            const size_t num_consumers = (pattern == "mpmc")? num_threads : 1;
+            const double rate = bench_throughput<queue_type>(capacity, num_producers, num_consumers, num_items, mode);
+            std::cout << boost::format("%-8s %-6s %-10s %12.3f")
+                % name % pattern % mode_name % (rate/1e6) << std::endl;
+        }
+
+        if (num_wakeups == 0) continue;
+        const std::vector<double> lat = bench_wakeup<queue_type>(num_wakeups, interval, mode);
+        std::cout << boost::format("%-8s %-6s %-10s %12s  wakeup p50 %.1f us, p99 %.1f us, max %.1f us")
+            % name % "wakeup" % mode_name % "" % (percentile(lat, 0.5)*1e6)
+            % (percentile(lat, 0.99)*1e6) % (lat.back()*1e6) << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]){
+    std::string queues, patterns, modes;
+    size_t capacity, num_threads, num_items, num_wakeups;
+    double interval;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("queues", po::value<std::string>(&queues)->default_value("mutex,spsc"), "comma separated queue policies: mutex, spsc")
+        ("patterns", po::value<std::string>(&patterns)->default_value("spsc,mpsc,mpmc"), "comma separated thread patterns")
+        ("modes", po::value<std::string>(&modes)->default_value("haste,wait,timed_wait"), "comma separated push and pop modes")
+        ("capacity", po::value<size_t>(&capacity)->default_value(64), "queue capacity for the throughput test")
+        ("threads", po::value<size_t>(&num_threads)->default_value(4), "producers (and consumers for mpmc) in the multi patterns")
+        ("items", po::value<size_t>(&num_items)->default_value(1000000), "total items per throughput test")
+        ("wakeups", po::value<size_t>(&num_wakeups)->default_value(1000), "items in the wakeup latency test (0 to skip)")
+        ("interval", po::value<double>(&interval)->default_value(100e-6), "seconds between pushes in the wakeup test")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Bounded Buffer Benchmark %s") % desc << std::endl;
+        std::cout <<
+            "    The mutex policy is bounded_buffer, the spsc policy is spsc_bounded_buffer.\n"
+            "    The spsc policy only runs the single producer single consumer pattern.\n"
+            << std::endl;
+        return ~0;
+    }
+
+    std::vector<std::string> queue_list, pattern_list, mode_list;
+    boost::split(queue_list, queues, boost::is_any_of(","));
+    boost::split(pattern_list, patterns, boost::is_any_of(","));
+    boost::split(mode_list, modes, boost::is_any_of(","));
+
+    std::cout << boost::format("%-8s %-6s %-10s %12s") % "queue" % "test" % "mode" % "Mops/sec" << std::endl;
+    BOOST_FOREACH(const std::string &queue, queue_list){
+        if (queue == "mutex") bench_queue<bounded_buffer<double> >(
+            queue, false, pattern_list, mode_list, capacity, num_threads, num_items, num_wakeups, interval
+        );
+        else if (queue == "spsc") bench_queue<spsc_bounded_buffer<double> >(
+            queue, true, pattern_list, mode_list, capacity, num_threads, num_items, num_wakeups, interval
+        );
+        else throw std::runtime_error("unknown queue policy " + queue);
+    }
+    return 0;
+}
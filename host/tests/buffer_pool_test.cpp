@@ -0,0 +1,91 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/transport/buffer_pool.hpp>
+#include <uhd/exception.hpp>
+#include <boost/bind.hpp>
+#include <vector>
+
+using namespace uhd::transport;
+
+/***********************************************************************
+ * A memory provider that keeps count of its allocations
+ **********************************************************************/
+class counting_provider{
+public:
+    counting_provider(void): num_allocs(0), num_frees(0), num_bytes(0){
+        /* NOP */
+    }
+
+    boost::shared_ptr<void> alloc(size_t bytes){
+        num_allocs++;
+        num_bytes = bytes;
+        mem.resize(bytes);
+        return boost::shared_ptr<void>(&mem.front(), boost::bind(&counting_provider::free, this));
+    }
+
+    void free(void){
+        num_frees++;
+    }
+
+    size_t num_allocs, num_frees, num_bytes;
+    std::vector<char> mem;
+};
+
+BOOST_AUTO_TEST_CASE(test_buffer_pool_mem_provider){
+    counting_provider provider;
+    buffer_pool::alloc_policy_t policy;
+    policy.mem_provider = boost::bind(&counting_provider::alloc, &provider, _1);
+
+    buffer_pool::sptr pool = buffer_pool::make(4, 1000, 64, policy);
+    BOOST_CHECK_EQUAL(provider.num_allocs, size_t(1));
+    BOOST_CHECK(provider.num_bytes >= 4*1024);
+    BOOST_REQUIRE_EQUAL(pool->size(), size_t(4));
+
+    //the buffers are aligned and inside the provided memory
+    const char *mem_start = &provider.mem.front();
+    for (size_t i = 0; i < pool->size(); i++){
+        const char *buff = static_cast<const char *>(pool->at(i));
+        BOOST_CHECK_EQUAL(size_t(buff) % 64, size_t(0));
+        BOOST_CHECK(buff >= mem_start);
+        BOOST_CHECK(buff + 1000 <= mem_start + provider.num_bytes);
+    }
+
+    //the memory is given back with the pool
+    BOOST_CHECK_EQUAL(provider.num_frees, size_t(0));
+    pool.reset();
+    BOOST_CHECK_EQUAL(provider.num_frees, size_t(1));
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_pool_mem_provider_hints){
+    counting_provider provider;
+    buffer_pool::register_mem_provider("counting", boost::bind(&counting_provider::alloc, &provider, _1));
+
+    uhd::device_addr_t hints;
+    hints["recv_mem_provider"] = "counting";
+    buffer_pool::make(2, 100, 16, buffer_pool::alloc_policy_t::from_hints(hints, "recv"));
+    BOOST_CHECK_EQUAL(provider.num_allocs, size_t(1));
+    BOOST_CHECK_EQUAL(provider.num_frees, size_t(1));
+
+    //the send prefix is not set, so the pool uses its own memory
+    buffer_pool::make(2, 100, 16, buffer_pool::alloc_policy_t::from_hints(hints, "send"));
+    BOOST_CHECK_EQUAL(provider.num_allocs, size_t(1));
+
+    hints["recv_mem_provider"] = "unknown";
+    BOOST_CHECK_THROW(buffer_pool::alloc_policy_t::from_hints(hints, "recv"), uhd::key_error);
+}
@@ -18,6 +18,7 @@
 #include <boost/test/unit_test.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/thread/thread.hpp>
 
 using namespace boost::assign;
 using namespace uhd::transport;
@@ -62,3 +63,43 @@ BOOST_AUTO_TEST_CASE(test_bounded_buffer_with_pop_on_full){
     BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
     BOOST_CHECK_EQUAL(val, 3);
 }
+
+BOOST_AUTO_TEST_CASE(test_spsc_bounded_buffer_with_timed_wait){
+    spsc_bounded_buffer<int> bb(3);
+
+    //push elements, check for timeout
+    BOOST_CHECK(bb.push_with_timed_wait(0, timeout));
+    BOOST_CHECK(bb.push_with_timed_wait(1, timeout));
+    BOOST_CHECK(bb.push_with_timed_wait(2, timeout));
+    BOOST_CHECK(not bb.push_with_timed_wait(3, timeout));
+
+    int val;
+    //pop elements, check for timeout and check values
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 0);
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 1);
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 2);
+    BOOST_CHECK(not bb.pop_with_timed_wait(val, timeout));
+}
+
+static void spsc_producer(spsc_bounded_buffer<int> *bb, int num){
+    for (int i = 0; i < num; i++) bb->push_with_wait(i);
+}
+
+BOOST_AUTO_TEST_CASE(test_spsc_bounded_buffer_with_threads){
+    spsc_bounded_buffer<int> bb(4);
+    static const int num = 100000;
+    boost::thread producer(boost::bind(&spsc_producer, &bb, num));
+
+    //pop elements, check that every element arrives in order
+    int val = -1, errors = 0;
+    for (int i = 0; i < num; i++){
+        bb.pop_with_wait(val);
+        if (val != i) errors++;
+    }
+    producer.join();
+    BOOST_CHECK_EQUAL(errors, 0);
+    BOOST_CHECK(not bb.pop_with_haste(val));
+}
@@ -17,6 +17,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <vector>
 
 BOOST_AUTO_TEST_CASE(test_byteswap16){
     boost::uint16_t x = 0x0123;
@@ -37,3 +38,43 @@ BOOST_AUTO_TEST_CASE(test_byteswap64){
     BOOST_CHECK_EQUAL(uhd::byteswap(x), y);
 }
 
+/***********************************************************************
+ * Buffer swaps: lengths around the vector widths cover the tail loops
+ **********************************************************************/
+template <typename T> static void check_byteswap_buffer(size_t nwords){
+    std::vector<T> in(nwords), out(nwords);
+    for (size_t i = 0; i < nwords; i++){
+        for (size_t b = 0; b < sizeof(T); b++){ //distinct bytes
+            in[i] = T(in[i] << 8) | T((i*sizeof(T) + b + 1) & 0xff);
+        }
+    }
+
+    uhd::byteswap_buffer(&out.front(), &in.front(), nwords);
+    for (size_t i = 0; i < nwords; i++){
+        BOOST_CHECK_EQUAL(out[i], uhd::byteswap(in[i]));
+    }
+
+    //in-place swap restores the input
+    uhd::byteswap_buffer(&out.front(), &out.front(), nwords);
+    for (size_t i = 0; i < nwords; i++){
+        BOOST_CHECK_EQUAL(out[i], in[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_byteswap_buffer16){
+    for (size_t nwords = 1; nwords < 70; nwords++){
+        check_byteswap_buffer<boost::uint16_t>(nwords);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_byteswap_buffer32){
+    for (size_t nwords = 1; nwords < 40; nwords++){
+        check_byteswap_buffer<boost::uint32_t>(nwords);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_byteswap_buffer64){
+    for (size_t nwords = 1; nwords < 20; nwords++){
+        check_byteswap_buffer<boost::uint64_t>(nwords);
+    }
+}
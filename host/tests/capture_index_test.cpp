@@ -0,0 +1,91 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/capture_index.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/cstdint.hpp>
+#include <fstream>
+#include <vector>
+
+namespace fs = boost::filesystem;
+using namespace uhd;
+
+/***********************************************************************
+ * A recording of 4-byte items at 1 Msps:
+ * 3000 items from time 10.0, then a gap, then 1000 items from 20.0
+ **********************************************************************/
+static const size_t item_size = 4;
+static const double rate = 1e6;
+
+static void write_index(const std::string &path){
+    capture_index_writer::sptr writer = capture_index_writer::make(path, item_size, rate, 1);
+    capture_index_entry_t entry;
+    entry.has_time = true;
+    for (size_t i = 0; i < 3; i++){
+        entry.offset = i*1000*item_size;
+        entry.time = time_spec_t(10.0) + time_spec_t(0, long(i*1000), rate);
+        writer->append(entry);
+    }
+    entry.offset = 3000*item_size;
+    entry.time = time_spec_t(20.0);
+    entry.overflow = true;
+    writer->append(entry);
+}
+
+BOOST_AUTO_TEST_CASE(test_capture_index_read){
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("uhd_capture_index_%%%%%%%%.idx");
+    write_index(path.string());
+
+    capture_index_reader::sptr reader = capture_index_reader::make(path.string());
+    BOOST_CHECK_EQUAL(reader->get_item_size(), item_size);
+    BOOST_CHECK_EQUAL(reader->get_rate(), rate);
+    BOOST_CHECK_EQUAL(reader->get_num_chans(), size_t(1));
+    BOOST_REQUIRE_EQUAL(reader->get_entries().size(), size_t(4));
+    BOOST_CHECK(not reader->get_entries()[2].overflow);
+    BOOST_CHECK(reader->get_entries()[3].overflow);
+    BOOST_CHECK_CLOSE(reader->get_entries()[1].time.get_real_secs(), 10.001, 1e-9);
+
+    //seek within the runs
+    BOOST_CHECK_EQUAL(reader->find_offset(time_spec_t(10.0)), boost::uint64_t(0));
+    BOOST_CHECK_EQUAL(reader->find_offset(time_spec_t(10.0015)), boost::uint64_t(1500*item_size));
+    BOOST_CHECK_EQUAL(reader->find_offset(time_spec_t(20.0005)), boost::uint64_t(3500*item_size));
+
+    //seek before the recording and into the gap
+    BOOST_CHECK_EQUAL(reader->find_offset(time_spec_t(5.0)), boost::uint64_t(0));
+    BOOST_CHECK_EQUAL(reader->find_offset(time_spec_t(15.0)), boost::uint64_t(3000*item_size));
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_capture_index_map_region){
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("uhd_capture_data_%%%%%%%%.dat");
+    std::vector<boost::uint32_t> items(100000);
+    for (size_t i = 0; i < items.size(); i++) items[i] = boost::uint32_t(i);
+    {
+        std::ofstream file(path.string().c_str(), std::ofstream::binary);
+        file.write(reinterpret_cast<const char *>(&items.front()), items.size()*sizeof(boost::uint32_t));
+    }
+
+    //an offset off the page boundaries
+    const boost::shared_ptr<const void> region = map_capture_region(path.string(), 12345*item_size, 100*item_size);
+    const boost::uint32_t *mapped = static_cast<const boost::uint32_t *>(region.get());
+    BOOST_CHECK_EQUAL(mapped[0], boost::uint32_t(12345));
+    BOOST_CHECK_EQUAL(mapped[99], boost::uint32_t(12444));
+
+    fs::remove(path);
+}
@@ -16,13 +16,18 @@
 //
 
 #include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/sample_buffer.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/foreach.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/format.hpp>
 #include <complex>
 #include <vector>
 #include <cstdlib>
 #include <iostream>
+#include <string>
 
 using namespace uhd;
 
@@ -107,6 +112,44 @@ BOOST_AUTO_TEST_CASE(test_convert_types_le_sc16){
     }
 }
 
+/***********************************************************************
+ * Test the sc16 item32 layout: (i << 16) | q in the wire byte order
+ **********************************************************************/
+static void test_convert_sc16_item32_layout(size_t nsamps, bool big_endian){
+    io_type_t io_type(io_type_t::COMPLEX_INT16);
+    otw_type_t otw_type;
+    otw_type.byteorder = (big_endian)? otw_type_t::BO_BIG_ENDIAN : otw_type_t::BO_LITTLE_ENDIAN;
+    otw_type.width = 16;
+
+    std::vector<sc16_t> input(nsamps);
+    BOOST_FOREACH(sc16_t &in, input) in = sc16_t(
+        std::rand()-(RAND_MAX/2),
+        std::rand()-(RAND_MAX/2)
+    );
+    std::vector<boost::uint32_t> interm(nsamps);
+
+    std::vector<const void *> input0(1, &input[0]);
+    std::vector<void *> output0(1, &interm[0]);
+    convert::get_converter_cpu_to_otw(
+        io_type, otw_type, input0.size(), output0.size()
+    )(input0, output0, nsamps, 32767.);
+
+    for (size_t i = 0; i < nsamps; i++){
+        const boost::uint32_t item =
+            (boost::uint32_t(boost::uint16_t(input[i].real())) << 16) |
+            (boost::uint32_t(boost::uint16_t(input[i].imag())) << 0);
+        BOOST_CHECK_EQUAL(interm[i], (big_endian)? uhd::htonx(item) : uhd::htowx(item));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_item32_layout){
+    //lengths around the simd widths test the remainder loops
+    for (size_t nsamps = 1; nsamps < 40; nsamps++){
+        test_convert_sc16_item32_layout(nsamps, true);
+        test_convert_sc16_item32_layout(nsamps, false);
+    }
+}
+
 /***********************************************************************
  * Test float conversion
  **********************************************************************/
@@ -181,6 +224,60 @@ BOOST_AUTO_TEST_CASE(test_convert_types_le_fc64){
     }
 }
 
+/***********************************************************************
+ * Test the float item32 layout: the scale is a power of two,
+ * so every conversion path lands on the same integer values
+ **********************************************************************/
+template <typename data_type>
+static void test_convert_float_item32_layout(size_t nsamps, bool big_endian){
+    typedef typename data_type::value_type value_type;
+    io_type_t io_type((sizeof(value_type) == sizeof(double))?
+        io_type_t::COMPLEX_FLOAT64 : io_type_t::COMPLEX_FLOAT32
+    );
+    otw_type_t otw_type;
+    otw_type.byteorder = (big_endian)? otw_type_t::BO_BIG_ENDIAN : otw_type_t::BO_LITTLE_ENDIAN;
+    otw_type.width = 16;
+
+    std::vector<sc16_t> ints(nsamps);
+    std::vector<data_type> input(nsamps), output(nsamps);
+    for (size_t i = 0; i < nsamps; i++){
+        ints[i] = sc16_t(
+            boost::int16_t(std::rand()-(RAND_MAX/2)),
+            boost::int16_t(std::rand()-(RAND_MAX/2))
+        );
+        input[i] = data_type(ints[i].real()/value_type(32768), ints[i].imag()/value_type(32768));
+    }
+    std::vector<boost::uint32_t> interm(nsamps);
+
+    std::vector<const void *> input0(1, &input[0]), input1(1, &interm[0]);
+    std::vector<void *> output0(1, &interm[0]), output1(1, &output[0]);
+    convert::get_converter_cpu_to_otw(
+        io_type, otw_type, input0.size(), output0.size()
+    )(input0, output0, nsamps, 32768.);
+    convert::get_converter_otw_to_cpu(
+        io_type, otw_type, input1.size(), output1.size()
+    )(input1, output1, nsamps, 1/32768.);
+
+    for (size_t i = 0; i < nsamps; i++){
+        const boost::uint32_t item =
+            (boost::uint32_t(boost::uint16_t(ints[i].real())) << 16) |
+            (boost::uint32_t(boost::uint16_t(ints[i].imag())) << 0);
+        BOOST_CHECK_EQUAL(interm[i], (big_endian)? uhd::htonx(item) : uhd::htowx(item));
+        BOOST_CHECK_EQUAL(output[i].real(), input[i].real());
+        BOOST_CHECK_EQUAL(output[i].imag(), input[i].imag());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_float_item32_layout){
+    //lengths around the simd widths test the remainder loops
+    for (size_t nsamps = 1; nsamps < 40; nsamps++){
+        test_convert_float_item32_layout<fc32_t>(nsamps, true);
+        test_convert_float_item32_layout<fc32_t>(nsamps, false);
+        test_convert_float_item32_layout<fc64_t>(nsamps, true);
+        test_convert_float_item32_layout<fc64_t>(nsamps, false);
+    }
+}
+
 /***********************************************************************
  * Test float to short conversion loopback
  **********************************************************************/
@@ -260,3 +357,427 @@ BOOST_AUTO_TEST_CASE(test_convert_types_sc16_to_fc32){
         MY_CHECK_CLOSE(input[i].imag()/float(32767), output[i].imag(), float(0.01));
     }
 }
+
+/***********************************************************************
+ * Test packed sc8 over-the-wire conversion
+ **********************************************************************/
+template <typename data_type>
+static void test_convert_types_sc8_otw_for_floats(
+    size_t nsamps,
+    const io_type_t &io_type,
+    const otw_type_t &otw_type
+){
+    typedef typename data_type::value_type value_type;
+
+    //fill the input samples
+    std::vector<data_type> input(nsamps), output(nsamps);
+    BOOST_FOREACH(data_type &in, input) in = data_type(
+        (std::rand()/value_type(RAND_MAX/2)) - 1,
+        (std::rand()/value_type(RAND_MAX/2)) - 1
+    );
+
+    //item16 is the otw type for sc8
+    std::vector<boost::uint16_t> interm(nsamps);
+
+    std::vector<const void *> input0(1, &input[0]), input1(1, &interm[0]);
+    std::vector<void *> output0(1, &interm[0]), output1(1, &output[0]);
+
+    convert::get_converter_cpu_to_otw(
+        io_type, otw_type, input0.size(), output0.size()
+    )(input0, output0, nsamps, 127.);
+
+    convert::get_converter_otw_to_cpu(
+        io_type, otw_type, input1.size(), output1.size()
+    )(input1, output1, nsamps, 1/127.);
+
+    //8-bit quantization: within one step of the input
+    for (size_t i = 0; i < nsamps; i++){
+        BOOST_CHECK_SMALL(input[i].real() - output[i].real(), value_type(0.01));
+        BOOST_CHECK_SMALL(input[i].imag() - output[i].imag(), value_type(0.01));
+    }
+}
+
+static otw_type_t make_sc8_otw_type(bool little_endian){
+    otw_type_t otw_type;
+    if (little_endian) otw_type.byteorder = otw_type_t::BO_LITTLE_ENDIAN;
+    else               otw_type.byteorder = otw_type_t::BO_BIG_ENDIAN;
+    otw_type.width = 8;
+    otw_type.shift = 8;
+    return otw_type;
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc8_otw_fc32){
+    io_type_t io_type(io_type_t::COMPLEX_FLOAT32);
+    for (size_t nsamps = 1; nsamps < 20; nsamps++){
+        test_convert_types_sc8_otw_for_floats<fc32_t>(nsamps, io_type, make_sc8_otw_type(false));
+        test_convert_types_sc8_otw_for_floats<fc32_t>(nsamps, io_type, make_sc8_otw_type(true));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc8_otw_fc64){
+    io_type_t io_type(io_type_t::COMPLEX_FLOAT64);
+    for (size_t nsamps = 1; nsamps < 20; nsamps++){
+        test_convert_types_sc8_otw_for_floats<fc64_t>(nsamps, io_type, make_sc8_otw_type(false));
+        test_convert_types_sc8_otw_for_floats<fc64_t>(nsamps, io_type, make_sc8_otw_type(true));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc8_otw_sc16){
+    io_type_t io_type(io_type_t::COMPLEX_INT16);
+    for (size_t nsamps = 1; nsamps < 20; nsamps++) for (int le = 0; le < 2; le++){
+        //only the upper byte of a dsp_int makes it over the wire
+        std::vector<sc16_t> input(nsamps), output(nsamps);
+        BOOST_FOREACH(sc16_t &in, input) in = sc16_t(
+            boost::int16_t((std::rand() & 0xff) << 8),
+            boost::int16_t((std::rand() & 0xff) << 8)
+        );
+        std::vector<boost::uint16_t> interm(nsamps);
+
+        std::vector<const void *> input0(1, &input[0]), input1(1, &interm[0]);
+        std::vector<void *> output0(1, &interm[0]), output1(1, &output[0]);
+
+        const otw_type_t otw_type = make_sc8_otw_type(le != 0);
+        convert::get_converter_cpu_to_otw(io_type, otw_type, 1, 1)(input0, output0, nsamps, 127.);
+        convert::get_converter_otw_to_cpu(io_type, otw_type, 1, 1)(input1, output1, nsamps, 1/127.);
+        BOOST_CHECK_EQUAL_COLLECTIONS(input.begin(), input.end(), output.begin(), output.end());
+
+        //big endian on the wire: bytes are i0 q0 i1 q1..., little endian swaps each pair
+        const boost::uint8_t *bytes = reinterpret_cast<const boost::uint8_t *>(&interm[0]);
+        for (size_t i = 0; i < nsamps; i++){
+            BOOST_CHECK_EQUAL(bytes[2*i+(le? 1 : 0)], boost::uint8_t(input[i].real() >> 8));
+            BOOST_CHECK_EQUAL(bytes[2*i+(le? 0 : 1)], boost::uint8_t(input[i].imag() >> 8));
+        }
+    }
+}
+
+/***********************************************************************
+ * Test packed sc12 over-the-wire conversion
+ **********************************************************************/
+static otw_type_t make_sc12_otw_type(bool little_endian){
+    otw_type_t otw_type;
+    if (little_endian) otw_type.byteorder = otw_type_t::BO_LITTLE_ENDIAN;
+    else               otw_type.byteorder = otw_type_t::BO_BIG_ENDIAN;
+    otw_type.width = 12;
+    otw_type.shift = 4;
+    return otw_type;
+}
+
+template <typename data_type>
+static void test_convert_types_sc12_otw_for_floats(
+    size_t nsamps,
+    const io_type_t &io_type,
+    const otw_type_t &otw_type
+){
+    typedef typename data_type::value_type value_type;
+
+    //fill the input samples
+    std::vector<data_type> input(nsamps), output(nsamps);
+    BOOST_FOREACH(data_type &in, input) in = data_type(
+        (std::rand()/value_type(RAND_MAX/2)) - 1,
+        (std::rand()/value_type(RAND_MAX/2)) - 1
+    );
+
+    //3 bytes per sample
+    std::vector<boost::uint8_t> interm(nsamps*otw_type.get_sample_size());
+
+    std::vector<const void *> input0(1, &input[0]), input1(1, &interm[0]);
+    std::vector<void *> output0(1, &interm[0]), output1(1, &output[0]);
+
+    convert::get_converter_cpu_to_otw(
+        io_type, otw_type, input0.size(), output0.size()
+    )(input0, output0, nsamps, 2047.);
+
+    convert::get_converter_otw_to_cpu(
+        io_type, otw_type, input1.size(), output1.size()
+    )(input1, output1, nsamps, 1/2047.);
+
+    //12-bit quantization: within one step of the input
+    for (size_t i = 0; i < nsamps; i++){
+        BOOST_CHECK_SMALL(input[i].real() - output[i].real(), value_type(0.001));
+        BOOST_CHECK_SMALL(input[i].imag() - output[i].imag(), value_type(0.001));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc12_otw_fc32){
+    io_type_t io_type(io_type_t::COMPLEX_FLOAT32);
+    for (size_t nsamps = 1; nsamps < 40; nsamps++){
+        test_convert_types_sc12_otw_for_floats<fc32_t>(nsamps, io_type, make_sc12_otw_type(false));
+        test_convert_types_sc12_otw_for_floats<fc32_t>(nsamps, io_type, make_sc12_otw_type(true));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc12_otw_fc64){
+    io_type_t io_type(io_type_t::COMPLEX_FLOAT64);
+    for (size_t nsamps = 1; nsamps < 40; nsamps++){
+        test_convert_types_sc12_otw_for_floats<fc64_t>(nsamps, io_type, make_sc12_otw_type(false));
+        test_convert_types_sc12_otw_for_floats<fc64_t>(nsamps, io_type, make_sc12_otw_type(true));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc12_otw_sc16){
+    io_type_t io_type(io_type_t::COMPLEX_INT16);
+    for (size_t nsamps = 1; nsamps < 40; nsamps++){
+        //only the upper 12 bits of a dsp_int make it over the wire
+        std::vector<sc16_t> input(nsamps), output(nsamps);
+        BOOST_FOREACH(sc16_t &in, input) in = sc16_t(
+            boost::int16_t((std::rand() & 0xfff) << 4),
+            boost::int16_t((std::rand() & 0xfff) << 4)
+        );
+        std::vector<boost::uint8_t> interm(nsamps*3);
+
+        std::vector<const void *> input0(1, &input[0]), input1(1, &interm[0]);
+        std::vector<void *> output0(1, &interm[0]), output1(1, &output[0]);
+
+        for (size_t le = 0; le < 2; le++){
+            const otw_type_t otw_type = make_sc12_otw_type(le != 0);
+            convert::get_converter_cpu_to_otw(io_type, otw_type, 1, 1)(input0, output0, nsamps, 2047.);
+            convert::get_converter_otw_to_cpu(io_type, otw_type, 1, 1)(input1, output1, nsamps, 1/2047.);
+            BOOST_CHECK_EQUAL_COLLECTIONS(input.begin(), input.end(), output.begin(), output.end());
+        }
+
+        //big endian on the wire: bytes are i[11:4], i[3:0]q[11:8], q[7:0]
+        const otw_type_t otw_type = make_sc12_otw_type(false);
+        convert::get_converter_cpu_to_otw(io_type, otw_type, 1, 1)(input0, output0, nsamps, 2047.);
+        const boost::uint16_t real = boost::uint16_t(input[0].real()), imag = boost::uint16_t(input[0].imag());
+        BOOST_CHECK_EQUAL(interm[0], boost::uint8_t(real >> 8));
+        BOOST_CHECK_EQUAL(interm[1], boost::uint8_t((real & 0xf0) | (imag >> 12)));
+        BOOST_CHECK_EQUAL(interm[2], boost::uint8_t(imag >> 4));
+    }
+}
+
+template <typename data_type>
+static void test_convert_sc12_unpack(const std::string &cpu_type, const std::string &swap){
+    //the simd unpackers against the general ones, when they are registered
+    const std::string markup = str(boost::format("convert_item24_1_to_%s_1_%s") % cpu_type % swap);
+    convert::function_type custom;
+    try{
+        custom = convert::get_converter(markup, convert::PRIORITY_CUSTOM);
+    }
+    catch(const uhd::lookup_error &){
+        return;
+    }
+    const convert::function_type general = convert::get_converter(markup, convert::PRIORITY_GENERAL);
+
+    //lengths around the simd widths test the remainder loops
+    for (size_t nsamps = 1; nsamps < 40; nsamps++){
+        std::vector<boost::uint8_t> interm(nsamps*3);
+        BOOST_FOREACH(boost::uint8_t &byte, interm) byte = boost::uint8_t(std::rand());
+        std::vector<data_type> output(nsamps), expected(nsamps);
+
+        std::vector<const void *> input0(1, &interm[0]);
+        std::vector<void *> output0(1, &output[0]), output1(1, &expected[0]);
+        custom(input0, output0, nsamps, 1/2047.);
+        general(input0, output1, nsamps, 1/2047.);
+        BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.end(), expected.begin(), expected.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc12_otw_unpack){
+    test_convert_sc12_unpack<sc16_t>("sc16", "nswap");
+    test_convert_sc12_unpack<sc16_t>("sc16", "bswap");
+    test_convert_sc12_unpack<fc32_t>("fc32", "nswap");
+    test_convert_sc12_unpack<fc32_t>("fc32", "bswap");
+}
+
+/***********************************************************************
+ * Test the streaming store converters against the general ones
+ **********************************************************************/
+template <typename data_type>
+static void test_convert_stream(const std::string &cpu_type, const std::string &swap){
+    const std::string markup = str(boost::format("convert_item32_1_to_%s_1_%s") % cpu_type % swap);
+    convert::function_type stream;
+    try{
+        stream = convert::get_converter(markup, convert::PRIORITY_CUSTOM_STREAM);
+    }
+    catch(const uhd::lookup_error &){
+        return;
+    }
+    const convert::function_type general = convert::get_converter(markup, convert::PRIORITY_GENERAL);
+
+    //the sample offsets from the aligned start test the head loop
+    static const size_t max_nsamps = 40, max_offset = 4;
+    boost::shared_ptr<data_type> mem = alloc_sample_buffer<data_type>(max_nsamps + max_offset);
+    BOOST_CHECK_EQUAL(size_t(mem.get()) % SAMPLE_BUFFER_CACHE_ALIGNMENT, size_t(0));
+
+    for (size_t offset = 0; offset < max_offset; offset++){
+        for (size_t nsamps = 1; nsamps < max_nsamps; nsamps++){
+            std::vector<boost::uint32_t> interm(nsamps);
+            BOOST_FOREACH(boost::uint32_t &item, interm) item = boost::uint32_t(std::rand()) ^ (boost::uint32_t(std::rand()) << 16);
+            std::vector<data_type> expected(nsamps);
+
+            std::vector<const void *> input0(1, &interm[0]);
+            std::vector<void *> output0(1, mem.get() + offset), output1(1, &expected[0]);
+            stream(input0, output0, nsamps, 1/32767.);
+            general(input0, output1, nsamps, 1/32767.);
+            for (size_t i = 0; i < nsamps; i++){
+                MY_CHECK_CLOSE(expected[i].real(), mem.get()[offset + i].real(), float(0.001));
+                MY_CHECK_CLOSE(expected[i].imag(), mem.get()[offset + i].imag(), float(0.001));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_stream){
+    test_convert_stream<fc32_t>("fc32", "nswap");
+    test_convert_stream<fc32_t>("fc32", "bswap");
+    test_convert_stream<fc64_t>("fc64", "nswap");
+    test_convert_stream<fc64_t>("fc64", "bswap");
+}
+
+/***********************************************************************
+ * Test multi-channel interleave and deinterleave:
+ *    Cross the selected converter with the general converter
+ *    so that a mistake in the channel order cannot cancel out.
+ **********************************************************************/
+template <typename data_type> static void test_convert_types_multi_chan(
+    size_t nsamps, size_t nchan,
+    const std::string &cpu_type, const std::string &swap,
+    const std::vector<std::vector<data_type> > &input,
+    double scale_factor, double tolerance
+){
+    const std::string to_otw_markup = str(boost::format("convert_%s_%u_to_item32_1_%s") % cpu_type % nchan % swap);
+    const std::string to_cpu_markup = str(boost::format("convert_item32_1_to_%s_%u_%s") % cpu_type % nchan % swap);
+    const convert::function_type generals[] = {
+        convert::get_converter(to_otw_markup, convert::PRIORITY_GENERAL),
+        convert::get_converter(to_cpu_markup, convert::PRIORITY_GENERAL)
+    };
+    const convert::function_type customs[] = {
+        convert::get_converter(to_otw_markup, convert::PRIORITY_CUSTOM),
+        convert::get_converter(to_cpu_markup, convert::PRIORITY_CUSTOM)
+    };
+
+    std::vector<boost::uint32_t> interm(nsamps*nchan);
+    std::vector<std::vector<data_type> > output(nchan, std::vector<data_type>(nsamps));
+    std::vector<const void *> input0, input1(1, &interm[0]);
+    std::vector<void *> output0(1, &interm[0]), output1;
+    for (size_t ch = 0; ch < nchan; ch++){
+        input0.push_back(&input[ch][0]);
+        output1.push_back(&output[ch][0]);
+    }
+
+    for (size_t pass = 0; pass < 2; pass++){
+        (pass? customs : generals)[0](input0, output0, nsamps, scale_factor);
+        (pass? generals : customs)[1](input1, output1, nsamps, 1/scale_factor);
+        for (size_t ch = 0; ch < nchan; ch++) for (size_t i = 0; i < nsamps; i++){
+            BOOST_CHECK_SMALL(double(input[ch][i].real() - output[ch][i].real()), tolerance);
+            BOOST_CHECK_SMALL(double(input[ch][i].imag() - output[ch][i].imag()), tolerance);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_multi_chan_fc32){
+    for (size_t nchan = 2; nchan <= 4; nchan += 2)
+    for (size_t nsamps = 1; nsamps < 20; nsamps++){
+        std::vector<std::vector<fc32_t> > input(nchan, std::vector<fc32_t>(nsamps));
+        for (size_t ch = 0; ch < nchan; ch++) BOOST_FOREACH(fc32_t &in, input[ch]) in = fc32_t(
+            (std::rand()/float(RAND_MAX/2)) - 1,
+            (std::rand()/float(RAND_MAX/2)) - 1
+        );
+        test_convert_types_multi_chan(nsamps, nchan, "fc32", "nswap", input, 32767., 0.001);
+        test_convert_types_multi_chan(nsamps, nchan, "fc32", "bswap", input, 32767., 0.001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_multi_chan_sc16){
+    for (size_t nchan = 2; nchan <= 4; nchan += 2)
+    for (size_t nsamps = 1; nsamps < 20; nsamps++){
+        std::vector<std::vector<sc16_t> > input(nchan, std::vector<sc16_t>(nsamps));
+        for (size_t ch = 0; ch < nchan; ch++) BOOST_FOREACH(sc16_t &in, input[ch]) in = sc16_t(
+            std::rand()-(RAND_MAX/2),
+            std::rand()-(RAND_MAX/2)
+        );
+        test_convert_types_multi_chan(nsamps, nchan, "sc16", "nswap", input, 1., 0.5);
+        test_convert_types_multi_chan(nsamps, nchan, "sc16", "bswap", input, 1., 0.5);
+    }
+}
+
+/***********************************************************************
+ * Test converters with fused dc offset and iq correction
+ **********************************************************************/
+static void test_convert_types_corrected_fc32(size_t nsamps, const otw_type_t &otw_type){
+    const io_type_t io_type(io_type_t::COMPLEX_FLOAT32);
+    convert::correction_t correction;
+    correction.dc_offset = std::complex<double>(0.1, -0.05);
+    correction.ii = 1.02; correction.iq = -0.03;
+    correction.qi = 0.01; correction.qq = 0.97;
+
+    std::vector<boost::uint32_t> input(nsamps);
+    BOOST_FOREACH(boost::uint32_t &in, input) in = boost::uint32_t(std::rand());
+    std::vector<fc32_t> plain(nsamps), output(nsamps);
+
+    std::vector<const void *> input0(1, &input[0]);
+    std::vector<void *> output0(1, &plain[0]), output1(1, &output[0]);
+    convert::get_converter_otw_to_cpu(io_type, otw_type, 1, 1)(input0, output0, nsamps, 1/32767.);
+    convert::get_corrected_converter_otw_to_cpu(io_type, otw_type, correction)(input0, output1, nsamps, 1/32767.);
+
+    for (size_t i = 0; i < nsamps; i++){
+        const std::complex<double> tmp = std::complex<double>(plain[i]) - correction.dc_offset;
+        BOOST_CHECK_SMALL(correction.ii*tmp.real() + correction.iq*tmp.imag() - output[i].real(), 1e-5);
+        BOOST_CHECK_SMALL(correction.qi*tmp.real() + correction.qq*tmp.imag() - output[i].imag(), 1e-5);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_corrected){
+    BOOST_CHECK(convert::correction_t().is_identity());
+
+    static const char *prios[] = {"general", ""};
+    for (size_t p = 0; p < 2; p++){
+        convert::set_forced_priority(prios[p]);
+        for (size_t nsamps = 1; nsamps < 20; nsamps++){
+            otw_type_t otw_type;
+            otw_type.width = 16;
+            otw_type.byteorder = otw_type_t::BO_BIG_ENDIAN;
+            test_convert_types_corrected_fc32(nsamps, otw_type);
+            otw_type.byteorder = otw_type_t::BO_LITTLE_ENDIAN;
+            test_convert_types_corrected_fc32(nsamps, otw_type);
+            test_convert_types_corrected_fc32(nsamps, make_sc8_otw_type(false));
+        }
+    }
+}
+
+/***********************************************************************
+ * Test that a conversion plan matches the converter it wraps
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_plan){
+    io_type_t io_type(io_type_t::COMPLEX_FLOAT32);
+    otw_type_t otw_type;
+    otw_type.byteorder = otw_type_t::BO_BIG_ENDIAN;
+    otw_type.width = 16;
+
+    const size_t nsamps = 37;
+    std::vector<boost::uint32_t> input(nsamps);
+    BOOST_FOREACH(boost::uint32_t &in, input) in = boost::uint32_t(std::rand());
+    std::vector<fc32_t> output(nsamps), planned(nsamps);
+
+    const convert::function_type &converter = convert::get_converter_otw_to_cpu(io_type, otw_type, 1, 1);
+    std::vector<const void *> input0(1, &input[0]);
+    std::vector<void *> output0(1, &output[0]), output1(1, &planned[0]);
+    converter(input0, output0, nsamps, 1/32767.);
+
+    const convert::plan_t plan(converter, 1, 1, 1/32767.);
+    BOOST_CHECK(not plan.empty());
+    plan(&input0.front(), &output1.front(), nsamps);
+    BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.end(), planned.begin(), planned.end());
+
+    BOOST_CHECK(convert::plan_t().empty());
+}
+
+/***********************************************************************
+ * Test the registry: every registered markup finds its own converter,
+ * so the predicates of the generated table match the markup parser
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_registry){
+    const convert::converter_infos_t infos = convert::get_converter_infos();
+    BOOST_CHECK(not infos.empty());
+    BOOST_FOREACH(const convert::converter_info_t &info, infos){
+        BOOST_CHECK_NO_THROW(convert::get_converter(info.markup, info.prio));
+    }
+
+    //the general converters are in the table
+    io_type_t io_type(io_type_t::COMPLEX_INT16);
+    otw_type_t otw_type;
+    otw_type.byteorder = otw_type_t::BO_NATIVE;
+    otw_type.width = 8;
+    BOOST_CHECK(convert::get_priority_otw_to_cpu(io_type, otw_type, 1, 1) >= convert::PRIORITY_GENERAL);
+    BOOST_CHECK_NO_THROW(convert::get_converter("convert_item16_1_to_sc8_1_nswap", convert::PRIORITY_GENERAL));
+}
@@ -18,6 +18,8 @@
 #include <boost/test/unit_test.hpp>
 #include <uhd/types/dict.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/lexical_cast.hpp>
+#include <vector>
 
 BOOST_AUTO_TEST_CASE(test_dict_init){
     uhd::dict<int, int> d;
@@ -70,3 +72,74 @@ BOOST_AUTO_TEST_CASE(test_dict_pop){
     BOOST_CHECK(d.keys()[0] == -1);
     BOOST_CHECK(d.keys()[1] == 1);
 }
+
+BOOST_AUTO_TEST_CASE(test_dict_duplicate_keys){
+    //the range constructor keeps the first item of a key
+    std::vector<std::pair<std::string, int> > items;
+    for (size_t i = 0; i < 40; i++) items.push_back(std::make_pair(boost::lexical_cast<std::string>(i), int(i)));
+    items.push_back(std::make_pair(std::string("7"), 77));
+    uhd::dict<std::string, int> d(items.begin(), items.end());
+    BOOST_CHECK_EQUAL(d.size(), size_t(40));
+    BOOST_CHECK_EQUAL(d["7"], 7);
+    BOOST_CHECK_EQUAL(d.pop("7"), 7);
+    BOOST_CHECK(not d.has_key("7"));
+
+    uhd::dict<int, int> small = boost::assign::map_list_of(1, 2)(1, 3);
+    BOOST_CHECK_EQUAL(small.size(), size_t(1));
+    BOOST_CHECK_EQUAL(small.pop(1), 2);
+    BOOST_CHECK(not small.has_key(1));
+}
+
+BOOST_AUTO_TEST_CASE(test_dict_string_keys){
+    uhd::dict<std::string, int> d;
+    d["c"] = 1;
+    d["a"] = 2;
+    d["b"] = 3;
+    BOOST_CHECK(d.has_key("a"));
+    BOOST_CHECK(not d.has_key("d"));
+    BOOST_CHECK_EQUAL(d["b"], 3);
+    BOOST_CHECK_EQUAL(d.get("d", 4), 4);
+    BOOST_CHECK_THROW(d.get("d"), std::exception);
+
+    //the keys keep their insertion order
+    BOOST_CHECK(d.keys()[0] == "c");
+    BOOST_CHECK(d.keys()[1] == "a");
+    BOOST_CHECK(d.keys()[2] == "b");
+
+    //a copy has its own index
+    uhd::dict<std::string, int> copy = d;
+    BOOST_CHECK_EQUAL(copy.pop("a"), 2);
+    BOOST_CHECK(not copy.has_key("a"));
+    BOOST_CHECK(d.has_key("a"));
+    copy["a"] = 5;
+    BOOST_CHECK(copy.keys()[2] == "a");
+    BOOST_CHECK_EQUAL(copy["a"], 5);
+    BOOST_CHECK_EQUAL(d["a"], 2);
+
+    d = copy;
+    BOOST_CHECK_EQUAL(d["a"], 5);
+    d["c"] = 6;
+    BOOST_CHECK_EQUAL(d["c"], 6);
+    BOOST_CHECK_EQUAL(copy["c"], 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_dict_many_string_keys){
+    //enough keys to use the index
+    uhd::dict<std::string, size_t> d;
+    for (size_t i = 0; i < 40; i++) d[boost::lexical_cast<std::string>(i)] = i;
+    for (size_t i = 0; i < 40; i++){
+        BOOST_CHECK_EQUAL(d[boost::lexical_cast<std::string>(i)], i);
+        BOOST_CHECK(d.keys()[i] == boost::lexical_cast<std::string>(i));
+    }
+    BOOST_CHECK(not d.has_key("40"));
+
+    const uhd::dict<std::string, size_t> copy = d;
+    BOOST_CHECK_EQUAL(d.pop("7"), size_t(7));
+    BOOST_CHECK(not d.has_key("7"));
+    BOOST_CHECK(copy.has_key("7"));
+    BOOST_CHECK_EQUAL(copy["39"], size_t(39));
+    BOOST_CHECK_THROW(copy["40"], std::exception);
+    d["7"] = 77;
+    BOOST_CHECK(d.keys().back() == "7");
+    BOOST_CHECK_EQUAL(d["7"], size_t(77));
+}
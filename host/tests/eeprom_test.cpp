@@ -0,0 +1,117 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/usrp/mboard_eeprom.hpp>
+#include <uhd/usrp/dboard_eeprom.hpp>
+#include <uhd/types/serial.hpp>
+#include <algorithm>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+/*!
+ * A fake 256 byte eeprom behind an i2c interface:
+ * Counts the i2c transactions and the bytes written,
+ * and skips the write cycle delay of the built in write_eeprom.
+ */
+class fake_eeprom_iface : public i2c_iface{
+public:
+    fake_eeprom_iface(void): mem(256, 0xff), ptr(0), num_reads(0), num_bytes_written(0){}
+
+    void write_i2c(boost::uint8_t, const byte_vector_t &bytes){
+        ptr = bytes.at(0);
+        for (size_t i = 1; i < bytes.size(); i++) mem.at((ptr++) % mem.size()) = bytes[i];
+    }
+
+    byte_vector_t read_i2c(boost::uint8_t, size_t num_bytes){
+        num_reads++;
+        byte_vector_t bytes;
+        for (size_t i = 0; i < num_bytes; i++) bytes.push_back(mem.at((ptr++) % mem.size()));
+        return bytes;
+    }
+
+    void write_eeprom(boost::uint8_t, boost::uint8_t offset, const byte_vector_t &bytes){
+        std::copy(bytes.begin(), bytes.end(), mem.begin() + offset);
+        num_bytes_written += bytes.size();
+    }
+
+    byte_vector_t mem;
+    size_t ptr, num_reads, num_bytes_written;
+};
+
+BOOST_AUTO_TEST_CASE(test_mboard_eeprom_round_trip){
+    fake_eeprom_iface iface;
+    mboard_eeprom_t mb_eeprom;
+    mb_eeprom["rev"] = "2560";
+    mb_eeprom["mac-addr"] = "00:50:c2:85:3f:ff";
+    mb_eeprom["ip-addr"] = "192.168.10.2";
+    mb_eeprom["serial"] = "abc123";
+    mb_eeprom["name"] = "radio0";
+    mb_eeprom.commit(iface, mboard_eeprom_t::MAP_N100);
+
+    iface.num_reads = 0;
+    mboard_eeprom_t loaded(iface, mboard_eeprom_t::MAP_N100);
+    BOOST_CHECK_EQUAL(loaded["rev"], "2560");
+    BOOST_CHECK_EQUAL(loaded["mac-addr"], "00:50:c2:85:3f:ff");
+    BOOST_CHECK_EQUAL(loaded["ip-addr"], "192.168.10.2");
+    BOOST_CHECK_EQUAL(loaded["serial"], "abc123");
+    BOOST_CHECK_EQUAL(loaded["name"], "radio0");
+
+    //the whole map comes in with a handful of sequential reads
+    BOOST_CHECK(iface.num_reads <= 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_mboard_eeprom_writes_changes){
+    fake_eeprom_iface iface;
+    mboard_eeprom_t mb_eeprom;
+    mb_eeprom["serial"] = "abc123";
+    mb_eeprom["name"] = "radio0";
+    mb_eeprom["mcr"] = "64e6";
+    mb_eeprom.commit(iface, mboard_eeprom_t::MAP_B000);
+
+    //an unchanged commit does not touch the eeprom
+    iface.num_bytes_written = 0;
+    mboard_eeprom_t loaded(iface, mboard_eeprom_t::MAP_B000);
+    loaded.commit(iface, mboard_eeprom_t::MAP_B000);
+    BOOST_CHECK_EQUAL(iface.num_bytes_written, size_t(0));
+
+    //a one character rename writes one byte
+    loaded["name"] = "radio1";
+    loaded.commit(iface, mboard_eeprom_t::MAP_B000);
+    BOOST_CHECK_EQUAL(iface.num_bytes_written, size_t(1));
+    BOOST_CHECK_EQUAL(mboard_eeprom_t(iface, mboard_eeprom_t::MAP_B000)["name"], "radio1");
+    BOOST_CHECK_EQUAL(mboard_eeprom_t(iface, mboard_eeprom_t::MAP_B000)["serial"], "abc123");
+}
+
+BOOST_AUTO_TEST_CASE(test_dboard_eeprom_writes_changes){
+    fake_eeprom_iface iface;
+    dboard_eeprom_t db_eeprom;
+    db_eeprom.id = dboard_id_t::from_uint16(0x0042);
+    db_eeprom.serial = "XYZ";
+    db_eeprom.store(iface, 0x50);
+
+    dboard_eeprom_t loaded;
+    loaded.load(iface, 0x50);
+    BOOST_CHECK(loaded.id == db_eeprom.id);
+    BOOST_CHECK_EQUAL(loaded.serial, "XYZ");
+
+    //restoring the same contents writes nothing
+    iface.num_bytes_written = 0;
+    loaded.store(iface, 0x50);
+    BOOST_CHECK_EQUAL(iface.num_bytes_written, size_t(0));
+}
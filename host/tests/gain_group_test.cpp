@@ -17,9 +17,11 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/utils/gain_group.hpp>
+#include <uhd/exception.hpp>
 #include <boost/bind.hpp>
 #include <boost/math/special_functions/round.hpp>
 #include <iostream>
+#include <vector>
 
 #define rint(x) boost::math::iround(x)
 
@@ -120,3 +122,41 @@ BOOST_AUTO_TEST_CASE(test_gain_group_priority){
     //test the the higher priority gain got filled first (gain 2)
     BOOST_CHECK_CLOSE(g2.get_value(), g2.get_range().stop(), tolerance);
 }
+
+BOOST_AUTO_TEST_CASE(test_gain_group_table){
+    gain_group::sptr gg = get_gain_group(0, 1);
+    gain_group::sptr gg_table = get_gain_group(0, 1);
+    gg_table->set_table_step(0.5);
+
+    //the direct distribution on the table grid
+    std::vector<double> gains, values, g1_values, g2_values;
+    for (double gain = -20; gain <= 100; gain += 0.5){
+        gg->set_value(gain);
+        gains.push_back(gain);
+        values.push_back(gg->get_value());
+        g1_values.push_back(g1.get_value());
+        g2_values.push_back(g2.get_value());
+    }
+
+    //the table gives the same distribution
+    for (size_t i = 0; i < gains.size(); i++){
+        gg_table->set_value(gains[i]);
+        BOOST_CHECK_CLOSE(gg_table->get_value(), values[i], tolerance);
+        BOOST_CHECK_CLOSE(g1.get_value(), g1_values[i], tolerance);
+        BOOST_CHECK_CLOSE(g2.get_value(), g2_values[i], tolerance);
+    }
+
+    //an element that did not change is not written again
+    gg_table->set_value(50);
+    g1.set_value(0); //behind the group's back
+    gg_table->set_value(50.5);
+    BOOST_CHECK_CLOSE(g2.get_value(), 10.0, tolerance);
+    BOOST_CHECK_CLOSE(g1.get_value(), 0.0, tolerance);
+
+    //setting an element by name makes the next set write everything
+    gg_table->set_value(0, "g1");
+    gg_table->set_value(50.5);
+    BOOST_CHECK_CLOSE(g1.get_value(), 40.0, tolerance);
+
+    BOOST_CHECK_THROW(gg_table->set_table_step(1e-6), uhd::value_error);
+}
@@ -0,0 +1,94 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace uhd::transport;
+
+static const size_t num_threads = 4;
+static const size_t num_refs = 100000;
+
+/***********************************************************************
+ * A managed receive buffer that counts its releases
+ **********************************************************************/
+class counting_mrb : public managed_recv_buffer{
+public:
+    counting_mrb(void): num_releases(0){}
+
+    void release(void){
+        num_releases++;
+    }
+
+    template <typename ref_policy> sptr get_new(void){
+        return make_managed_buffer<ref_policy>(this);
+    }
+
+    size_t num_releases;
+
+private:
+    const void *get_buff(void) const{return &_mem;}
+    size_t get_size(void) const{return sizeof(_mem);}
+    int _mem;
+};
+
+static void copy_and_drop(managed_recv_buffer::sptr buff){
+    for (size_t i = 0; i < num_refs; i++){
+        managed_recv_buffer::sptr copy = buff;
+    }
+}
+
+/***********************************************************************
+ * Test the reference counts
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_managed_buffer_local_refs){
+    counting_mrb mrb;
+    managed_recv_buffer::sptr buff = mrb.get_new<managed_buffer_local_refs>();
+    BOOST_CHECK(not mrb._ref_atomic);
+    managed_recv_buffer::sptr copy = buff;
+    buff.reset();
+    BOOST_CHECK_EQUAL(mrb.num_releases, size_t(0));
+    copy.reset();
+    BOOST_CHECK_EQUAL(mrb.num_releases, size_t(1));
+}
+
+BOOST_AUTO_TEST_CASE(test_managed_buffer_shared_refs){
+    counting_mrb mrb;
+    for (size_t run = 0; run < 2; run++){
+        //made shared, or made local and switched before the handoff
+        managed_recv_buffer::sptr buff = (run == 0)?
+            mrb.get_new<managed_buffer_shared_refs>() :
+            mrb.get_new<managed_buffer_local_refs>();
+        if (run == 1) buff->enable_shared_refs();
+        BOOST_CHECK(mrb._ref_atomic);
+
+        //every thread copies and drops references to the same buffer
+        boost::thread_group threads;
+        for (size_t i = 0; i < num_threads; i++){
+            threads.create_thread(boost::bind(&copy_and_drop, buff));
+        }
+        buff.reset(); //likely not the last reference
+        threads.join_all();
+        BOOST_CHECK_EQUAL(mrb.num_releases, run + 1);
+    }
+
+    //a new buffer returns to the policy it is made with
+    managed_recv_buffer::sptr buff = mrb.get_new<managed_buffer_local_refs>();
+    BOOST_CHECK(not mrb._ref_atomic);
+}
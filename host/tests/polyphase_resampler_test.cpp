@@ -0,0 +1,75 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <boost/test/unit_test.hpp>
+#include "../lib/transport/polyphase_resampler.hpp"
+#include <complex>
+#include <cmath>
+#include <vector>
+
+using namespace uhd::transport;
+
+BOOST_AUTO_TEST_CASE(test_resampler_ratio){
+    //exact ratios are found when the numerator fits
+    polyphase_resampler::sptr resampler = polyphase_resampler::make(10e6, 7.5e6, 16, 256);
+    BOOST_CHECK_EQUAL(resampler->get_interp(), 3);
+    BOOST_CHECK_EQUAL(resampler->get_decim(), 4);
+    BOOST_CHECK_CLOSE(resampler->get_out_rate(), 7.5e6, 1e-9);
+
+    //other ratios get the closest fraction under the bound
+    resampler = polyphase_resampler::make(3.125e6, 3.072e6, 16, 256);
+    BOOST_CHECK(resampler->get_interp() <= 256);
+    BOOST_CHECK_CLOSE(resampler->get_out_rate(), 3.072e6, 0.01);
+    resampler = polyphase_resampler::make(3.125e6, 3.072e6, 16, 4096);
+    BOOST_CHECK_EQUAL(resampler->get_interp(), 3072);
+    BOOST_CHECK_EQUAL(resampler->get_decim(), 3125);
+}
+
+static void check_tone(const double in_rate, const double out_rate){
+    polyphase_resampler::sptr resampler = polyphase_resampler::make(in_rate, out_rate, 16, 256);
+    const double freq = 0.1*std::min(in_rate, out_rate);
+    const double two_pi = 2*std::acos(-1.0);
+
+    //feed a tone in uneven blocks, pulling the outputs in between
+    std::vector<std::complex<float> > out(20000);
+    size_t num_in = 0, num_out = 0;
+    for (size_t block = 0; num_in < 10000; block++){
+        std::complex<float> *in = resampler->get_input_buff();
+        const size_t num_samps = std::min<size_t>(resampler->get_input_space(), 100 + block%7);
+        for (size_t i = 0; i < num_samps; i++, num_in++){
+            in[i] = std::polar(1.0f, float(two_pi*freq*num_in/in_rate));
+        }
+        resampler->commit_input(num_samps);
+        num_out += resampler->get_output(&out[num_out], out.size() - num_out);
+    }
+    BOOST_CHECK(num_out <= num_in*resampler->get_out_rate()/in_rate + 1);
+    BOOST_CHECK(num_out + 20*out_rate/in_rate >= num_in*resampler->get_out_rate()/in_rate);
+
+    //past the start up, each output is the tone at its time less the delay
+    double max_error = 0;
+    for (size_t k = 100; k < num_out; k++){
+        const double t = k/resampler->get_out_rate() - resampler->get_delay()/in_rate;
+        max_error = std::max<double>(max_error, std::abs(out[k] - std::polar(1.0f, float(two_pi*freq*t))));
+    }
+    BOOST_CHECK(max_error < 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(test_resampler_tone){
+    check_tone(10e6, 7.5e6);
+    check_tone(7.5e6, 10e6);
+    check_tone(3.125e6, 3.072e6);
+    check_tone(1e6, 1e6);
+}
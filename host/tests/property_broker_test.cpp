@@ -0,0 +1,140 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/usrp/property_broker.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/exception.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/asio.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+static double coerce_rate(const double rate){
+    return (rate > 10e6)? 10e6 : rate;
+}
+
+static property_tree::sptr make_tree(void){
+    property_tree::sptr tree = property_tree::make();
+    tree->create<double>("/mboards/0/rate").coerce(&coerce_rate).set(1e6);
+    tree->create<std::string>("/mboards/0/name").set("test board");
+    tree->create<bool>("/mboards/0/enabled").set(false);
+    tree->create<time_spec_t>("/mboards/0/time").set(time_spec_t(1.5));
+    tree->create<meta_range_t>("/mboards/0/range").set(meta_range_t(0.0, 10.0, 0.5));
+    tree->create<std::vector<int> >("/mboards/0/other");
+    return tree;
+}
+
+static std::string get_socket_path(void){
+    return (boost::filesystem::temp_directory_path() / "uhd_property_broker_test").string();
+}
+
+BOOST_AUTO_TEST_CASE(test_property_broker){
+    property_tree::sptr tree = make_tree();
+    property_server::sptr server = property_server::make(tree, get_socket_path());
+    property_client::sptr client = property_client::make(get_socket_path());
+
+    //the directories and types of the tree
+    const std::vector<std::string> names = client->list("/mboards/0");
+    BOOST_CHECK_EQUAL(names.size(), size_t(6));
+    BOOST_CHECK(client->list("/mboards/0/rate").empty());
+    BOOST_CHECK_EQUAL(client->get_type("/mboards/0/rate"), "double");
+    BOOST_CHECK_EQUAL(client->get_type("/mboards/0/other"), "unknown");
+
+    //the values as strings, a set returns the coerced value
+    BOOST_CHECK_EQUAL(client->get("/mboards/0/rate"), "1000000");
+    BOOST_CHECK_EQUAL(client->set("/mboards/0/rate", "20e6"), "10000000");
+    BOOST_CHECK_EQUAL(tree->access<double>("/mboards/0/rate").get(), 10e6);
+    BOOST_CHECK_EQUAL(client->get("/mboards/0/name"), "test board");
+    BOOST_CHECK_EQUAL(client->set("/mboards/0/name", "line\nbreak"), "line\nbreak");
+    BOOST_CHECK_EQUAL(client->set("/mboards/0/enabled", "1"), "true");
+    BOOST_CHECK_EQUAL(client->get("/mboards/0/time"), "1.500000000");
+    BOOST_CHECK_EQUAL(client->get("/mboards/0/range"), "0:10:0.5");
+
+    //the errors of the server are thrown by the client
+    BOOST_CHECK_THROW(client->get("/mboards/1/rate"), uhd::runtime_error);
+    BOOST_CHECK_THROW(client->set("/mboards/0/rate", "fast"), uhd::runtime_error);
+    BOOST_CHECK_THROW(client->set("/mboards/0/range", "1:2:3"), uhd::runtime_error);
+    BOOST_CHECK_THROW(client->get("/mboards/0/other"), uhd::runtime_error);
+    BOOST_CHECK_EQUAL(client->get("/mboards/0/name"), "line\nbreak");
+    BOOST_CHECK_EQUAL(server->get_num_requests(), size_t(16));
+
+    //the socket goes away with the server
+    server.reset();
+    BOOST_CHECK(not boost::filesystem::exists(get_socket_path()));
+    BOOST_CHECK_THROW(property_client::make(get_socket_path()), uhd::io_error);
+}
+
+static void get_rates(property_client::sptr client, size_t *num_ok){
+    for (size_t i = 0; i < 100; i++){
+        if (client->get("/mboards/0/rate") == "1000000") (*num_ok)++;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_property_broker_clients){
+    property_tree::sptr tree = make_tree();
+    property_server::sptr server = property_server::make(tree, get_socket_path());
+
+    //several clients, and threads sharing a client
+    std::vector<property_client::sptr> clients;
+    for (size_t i = 0; i < 3; i++) clients.push_back(property_client::make(get_socket_path()));
+    clients.push_back(clients.back());
+
+    std::vector<size_t> num_ok(clients.size(), 0);
+    boost::thread_group threads;
+    for (size_t i = 0; i < clients.size(); i++){
+        threads.create_thread(boost::bind(&get_rates, clients[i], &num_ok[i]));
+    }
+    threads.join_all();
+    for (size_t i = 0; i < clients.size(); i++) BOOST_CHECK_EQUAL(num_ok[i], size_t(100));
+    BOOST_CHECK_EQUAL(server->get_num_requests(), size_t(400));
+
+    //a client that goes away is dropped by the server
+    clients.clear();
+    property_client::sptr client = property_client::make(get_socket_path());
+    BOOST_CHECK_EQUAL(client->get("/mboards/0/enabled"), "false");
+}
+
+BOOST_AUTO_TEST_CASE(test_property_broker_socket){
+    property_tree::sptr tree = make_tree();
+    property_server::sptr server = property_server::make(tree, get_socket_path());
+
+    //only the user may connect, and a second server does not take over the socket
+    BOOST_CHECK_EQUAL(
+        boost::filesystem::status(get_socket_path()).permissions(),
+        boost::filesystem::owner_read | boost::filesystem::owner_write
+    );
+    BOOST_CHECK_THROW(property_server::make(tree, get_socket_path()), uhd::runtime_error);
+    property_client::sptr client = property_client::make(get_socket_path());
+    BOOST_CHECK_EQUAL(client->get("/mboards/0/enabled"), "false");
+
+    //a client that never reads its replies is dropped, the others are still answered
+    boost::asio::io_service io_service;
+    boost::asio::local::stream_protocol::socket stalled(io_service);
+    stalled.connect(boost::asio::local::stream_protocol::endpoint(get_socket_path()));
+    std::string requests;
+    for (size_t i = 0; i < 50000; i++) requests += "get /mboards/0/name\n";
+    boost::system::error_code ec;
+    boost::asio::write(stalled, boost::asio::buffer(requests), ec);
+    BOOST_CHECK(ec); //the server closed the socket
+    BOOST_CHECK_EQUAL(client->get("/mboards/0/name"), "test board");
+}
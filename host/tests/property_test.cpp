@@ -18,6 +18,7 @@
 #include <boost/test/unit_test.hpp>
 #include <uhd/property_tree.hpp>
 #include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <exception>
 #include <iostream>
 
@@ -57,6 +58,22 @@ BOOST_AUTO_TEST_CASE(test_prop_simple){
     BOOST_CHECK_EQUAL(prop.get(), 34);
 }
 
+struct const_value_type{
+    const_value_type(int x): _x(x){}
+    const int _x;
+};
+
+BOOST_AUTO_TEST_CASE(test_prop_non_assignable){
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+    uhd::property<const_value_type> &prop = tree->create<const_value_type>("/");
+
+    //a type with const members cannot be assigned, only constructed
+    prop.set(const_value_type(42));
+    BOOST_CHECK_EQUAL(prop.get()._x, 42);
+    prop.set(const_value_type(34));
+    BOOST_CHECK_EQUAL(prop.get()._x, 34);
+}
+
 BOOST_AUTO_TEST_CASE(test_prop_with_subscriber){
     uhd::property_tree::sptr tree = uhd::property_tree::make();
     uhd::property<int> &prop = tree->create<int>("/");
@@ -148,6 +165,12 @@ BOOST_AUTO_TEST_CASE(test_prop_tree){
     BOOST_CHECK_EQUAL(tree->access<int>("/test/prop0").get(), 42);
     BOOST_CHECK_EQUAL(tree->access<int>("/test/prop1").get(), 34);
 
+    //the type is the one the property was created with
+    tree->create<double>("/test/prop2");
+    BOOST_CHECK(tree->type_of("/test/prop0") == typeid(int));
+    BOOST_CHECK(tree->type_of("/test/prop2") == typeid(double));
+    BOOST_CHECK_THROW(tree->type_of("/test"), std::exception);
+
     tree->remove("/test/prop0");
     BOOST_CHECK(not tree->exists("/test/prop0"));
     BOOST_CHECK(tree->exists("/test/prop1"));
@@ -158,6 +181,91 @@ BOOST_AUTO_TEST_CASE(test_prop_tree){
 
 }
 
+BOOST_AUTO_TEST_CASE(test_prop_tree_handle){
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+    tree->create<int>("/test/prop0");
+
+    uhd::property<int>::sptr handle = tree->access_handle<int>("/test/prop0");
+    BOOST_CHECK(handle.get() == &tree->access<int>("/test/prop0"));
+
+    handle->set(42);
+    BOOST_CHECK_EQUAL(tree->access<int>("/test/prop0").get(), 42);
+    tree->access<int>("/test/prop0").set(34);
+    BOOST_CHECK_EQUAL(handle->get(), 34);
+
+    //the handle outlives the removed property
+    tree->remove("/test/prop0");
+    BOOST_CHECK(not tree->exists("/test/prop0"));
+    BOOST_CHECK_EQUAL(handle->get(), 34);
+    BOOST_CHECK_THROW(tree->access_handle<int>("/test/prop0"), std::exception);
+}
+
+struct counter_type{
+    counter_type(void): _count(0){}
+    void doit(int x){
+        _x = x;
+        _count++;
+    }
+
+    int _x, _count;
+};
+
+BOOST_AUTO_TEST_CASE(test_prop_transaction){
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+    counter_type counter0, counter1;
+    tree->create<int>("/test/prop0").subscribe(boost::bind(&counter_type::doit, &counter0, _1));
+    tree->create<int>("/test/prop1").subscribe(boost::bind(&counter_type::doit, &counter1, _1));
+
+    uhd::property_transaction transaction(tree);
+    transaction.set<int>("/test/prop0", 1).set<int>("/test/prop1", 2).set<int>("/test/prop0", 3);
+    BOOST_CHECK_EQUAL(counter0._count, 0);
+    BOOST_CHECK_THROW(transaction.set<int>("/test/prop2", 4), std::exception);
+
+    //each property is set once with the last value
+    transaction.commit();
+    BOOST_CHECK_EQUAL(counter0._count, 1);
+    BOOST_CHECK_EQUAL(counter0._x, 3);
+    BOOST_CHECK_EQUAL(counter1._count, 1);
+    BOOST_CHECK_EQUAL(tree->access<int>("/test/prop1").get(), 2);
+
+    //the commit empties the transaction
+    transaction.commit();
+    BOOST_CHECK_EQUAL(counter0._count, 1);
+}
+
+struct double_setter_type{
+    void doit(const double &x){
+        _x = x;
+    }
+
+    double _x;
+};
+
+BOOST_AUTO_TEST_CASE(test_prop_set_get_timing){
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+    double_setter_type setter;
+    tree->create<double>("/test/gain").subscribe(boost::bind(&double_setter_type::doit, &setter, _1));
+    uhd::property<double>::sptr handle = tree->access_handle<double>("/test/gain");
+
+    //sweep the value like a gain or frequency scan would
+    const size_t num_iters = 1000000;
+    double sum = 0.0;
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (size_t i = 0; i < num_iters; i++){
+        handle->set(double(i % 64));
+        sum += handle->get();
+    }
+    const boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+
+    const double ns_per_iter = elapsed.total_microseconds()*1e3/num_iters;
+    std::cout << "property<double> set/get: " << ns_per_iter << " ns per iteration" << std::endl;
+    BOOST_CHECK_EQUAL(setter._x, double((num_iters-1) % 64));
+    BOOST_CHECK_EQUAL(sum, double(num_iters/64)*(63*64/2));
+
+    //an allocation per set costs tens of nanoseconds, leave lots of headroom
+    BOOST_CHECK(ns_per_iter < 1000.0);
+}
+
 BOOST_AUTO_TEST_CASE(test_prop_subtree){
     uhd::property_tree::sptr tree = uhd::property_tree::make();
     tree->create<int>("/subdir1/subdir2");
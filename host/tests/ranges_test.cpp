@@ -17,6 +17,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/types/ranges.hpp>
+#include <uhd/exception.hpp>
 #include <iostream>
 
 using namespace uhd;
@@ -55,3 +56,41 @@ BOOST_AUTO_TEST_CASE(test_ranges_clip){
     BOOST_CHECK_CLOSE(mr.clip(50.9, false), 50.9, tolerance);
     BOOST_CHECK_CLOSE(mr.clip(50.9, true), 51.0, tolerance);
 }
+
+BOOST_AUTO_TEST_CASE(test_ranges_clip_many){
+    //sub-bands of 10 wide with gaps of 5, like a composed lo range
+    meta_range_t mr;
+    for (size_t i = 0; i < 100; i++){
+        mr.push_back(range_t(i*15.0, i*15.0 + 10.0, 0.5));
+    }
+    BOOST_CHECK_CLOSE(mr.start(), 0.0, tolerance);
+    BOOST_CHECK_CLOSE(mr.stop(), 99*15.0 + 10.0, tolerance);
+    BOOST_CHECK_CLOSE(mr.step(), 0.5, tolerance);
+
+    //outside of the ranges
+    BOOST_CHECK_CLOSE(mr.clip(-5.0), 0.0, tolerance);
+    BOOST_CHECK_CLOSE(mr.clip(1e6), 99*15.0 + 10.0, tolerance);
+
+    //in-between ranges, clip to the nearest end
+    BOOST_CHECK_CLOSE(mr.clip(506.0), 505.0, tolerance);
+    BOOST_CHECK_CLOSE(mr.clip(509.0), 510.0, tolerance);
+    BOOST_CHECK_CLOSE(mr.clip(491.0), 490.0, tolerance);
+    BOOST_CHECK_CLOSE(mr.clip(494.0), 495.0, tolerance);
+
+    //in a range and at its ends
+    BOOST_CHECK_CLOSE(mr.clip(742.3), 742.3, tolerance);
+    BOOST_CHECK_CLOSE(mr.clip(742.3, true), 742.5, tolerance);
+    BOOST_CHECK_CLOSE(mr.clip(745.0, true), 745.0, tolerance);
+    BOOST_CHECK_CLOSE(mr.clip(750.0, true), 750.0, tolerance);
+}
+
+BOOST_AUTO_TEST_CASE(test_ranges_monotonic){
+    meta_range_t mr;
+    BOOST_CHECK_THROW(mr.clip(1.0), uhd::value_error);
+    mr.push_back(range_t(10.0, 20.0));
+    mr.push_back(range_t(15.0, 30.0));
+    #ifndef NDEBUG
+    BOOST_CHECK_THROW(mr.clip(1.0), uhd::value_error); //only checked in debug builds
+    #endif
+    BOOST_CHECK_THROW(mr.start(), uhd::value_error);
+}
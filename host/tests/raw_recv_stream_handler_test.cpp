@@ -0,0 +1,211 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "../lib/transport/raw_recv_stream_handler.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/bind.hpp>
+#include <complex>
+#include <vector>
+#include <list>
+
+/***********************************************************************
+ * A dummy managed receive buffer for testing
+ **********************************************************************/
+class dummy_mrb : public uhd::transport::managed_recv_buffer{
+public:
+    void release(void){
+        //NOP
+    }
+
+    sptr get_new(boost::shared_array<char> mem, size_t len){
+        _mem = mem;
+        _len = len;
+        return make_managed_buffer(this);
+    }
+
+private:
+    const void *get_buff(void) const{return _mem.get();}
+    size_t get_size(void) const{return _len;}
+
+    boost::shared_array<char> _mem;
+    size_t _len;
+};
+
+/***********************************************************************
+ * A dummy transport of headerless transfers:
+ * Each item is little endian sc16 with I counting up and Q = -I,
+ * the channels of an item carry I + 1000*channel.
+ **********************************************************************/
+class dummy_raw_xport_class{
+public:
+    dummy_raw_xport_class(const size_t nchan): _nchan(nchan), _count(0){
+        /* NOP */
+    }
+
+    void push_transfer(const size_t nitems){
+        boost::shared_array<char> mem(new char[nitems*_nchan*sizeof(boost::uint32_t)]);
+        boost::uint32_t *words = reinterpret_cast<boost::uint32_t *>(mem.get());
+        for (size_t i = 0; i < nitems; i++, _count++){
+            for (size_t ch = 0; ch < _nchan; ch++){
+                const boost::int16_t val = boost::int16_t(_count + 1000*ch);
+                const boost::uint32_t word = (boost::uint32_t(boost::uint16_t(val)) << 16) | (boost::uint32_t(boost::uint16_t(-val)) << 0);
+                words[i*_nchan + ch] = uhd::htowx(word);
+            }
+        }
+        _mems.push_back(std::make_pair(mem, nitems*_nchan*sizeof(boost::uint32_t)));
+    }
+
+    uhd::transport::managed_recv_buffer::sptr get_recv_buff(double){
+        if (_mems.empty()) return uhd::transport::managed_recv_buffer::sptr(); //timeout
+        _mrbs.push_back(dummy_mrb());
+        uhd::transport::managed_recv_buffer::sptr mrb = _mrbs.back().get_new(_mems.front().first, _mems.front().second);
+        _mems.pop_front();
+        return mrb;
+    }
+
+private:
+    const size_t _nchan;
+    size_t _count;
+    std::list<std::pair<boost::shared_array<char>, size_t> > _mems;
+    std::list<dummy_mrb> _mrbs; //list means no-realloc
+};
+
+static uhd::otw_type_t make_otw_type(void){
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_LITTLE_ENDIAN;
+    return otw_type;
+}
+
+/***********************************************************************
+ * Test the modes across the transfer boundaries
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_raw_recv_modes){
+    dummy_raw_xport_class dummy_recv_xport(1);
+    dummy_recv_xport.push_transfer(100);
+    dummy_recv_xport.push_transfer(100);
+    dummy_recv_xport.push_transfer(100);
+
+    uhd::transport::sph::raw_recv_stream_handler handler;
+    handler.set_xport_get_buff(boost::bind(&dummy_raw_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(make_otw_type());
+
+    std::vector<std::complex<short> > buff(250);
+    uhd::rx_metadata_t metadata;
+
+    //one packet: the first 60 of a transfer, then a fragment of the other 40
+    size_t num_samps_ret = handler.recv(
+        &buff.front(), 60, metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::RECV_MODE_ONE_PACKET, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_samps_ret, size_t(60));
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK(metadata.more_fragments);
+    BOOST_CHECK(not metadata.has_time_spec);
+    num_samps_ret = handler.recv(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::RECV_MODE_ONE_PACKET, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_samps_ret, size_t(40));
+    BOOST_CHECK_EQUAL(metadata.fragment_offset, size_t(60));
+    BOOST_CHECK(not metadata.more_fragments);
+    BOOST_CHECK_EQUAL(buff[0].real(), 60);
+    BOOST_CHECK_EQUAL(buff[39].imag(), -99);
+
+    //full buffer: the remaining transfers, then a timeout
+    num_samps_ret = handler.recv(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::RECV_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_samps_ret, size_t(200));
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    for (size_t i = 0; i < num_samps_ret; i++){
+        BOOST_CHECK_EQUAL(buff[i], std::complex<short>(short(100 + i), -short(100 + i)));
+    }
+    num_samps_ret = handler.recv(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::RECV_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_samps_ret, size_t(0));
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
+
+/***********************************************************************
+ * Test the deinterleave of channels and floats conversion
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_raw_recv_channels){
+    static const size_t NCHAN = 2;
+    dummy_raw_xport_class dummy_recv_xport(NCHAN);
+    dummy_recv_xport.push_transfer(64);
+    dummy_recv_xport.push_transfer(64);
+
+    uhd::transport::sph::raw_recv_stream_handler handler;
+    handler.set_xport_get_buff(boost::bind(&dummy_raw_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(make_otw_type(), NCHAN);
+
+    std::vector<std::vector<std::complex<float> > > buffs(NCHAN, std::vector<std::complex<float> >(128));
+    std::vector<void *> buff_ptrs;
+    for (size_t ch = 0; ch < NCHAN; ch++) buff_ptrs.push_back(&buffs[ch].front());
+
+    uhd::rx_metadata_t metadata;
+    const size_t num_samps_ret = handler.recv(
+        buff_ptrs, 128, metadata, uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::RECV_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_samps_ret, size_t(128));
+    for (size_t ch = 0; ch < NCHAN; ch++){
+        for (size_t i = 0; i < num_samps_ret; i++){
+            const float val = float(i + 1000*ch)/32767;
+            BOOST_CHECK_CLOSE(buffs[ch][i].real(), val, 0.01);
+            BOOST_CHECK_CLOSE(buffs[ch][i].imag(), -val, 0.01);
+        }
+    }
+}
+
+/***********************************************************************
+ * Test the view of the rest of a transfer
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_raw_recv_view){
+    dummy_raw_xport_class dummy_recv_xport(1);
+    dummy_recv_xport.push_transfer(100);
+
+    uhd::transport::sph::raw_recv_stream_handler handler;
+    handler.set_xport_get_buff(boost::bind(&dummy_raw_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(make_otw_type());
+
+    std::vector<std::complex<short> > buff(30);
+    uhd::rx_metadata_t metadata;
+    handler.recv(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::RECV_MODE_ONE_PACKET, 1.0
+    );
+
+    uhd::device::recv_view_t view;
+    BOOST_CHECK_EQUAL(handler.recv_view(view, 1.0), size_t(70));
+    BOOST_CHECK_EQUAL(view.metadata.fragment_offset, size_t(30));
+    BOOST_CHECK_EQUAL(view.item_size, sizeof(boost::uint32_t));
+    BOOST_REQUIRE_EQUAL(view.frames.size(), size_t(1));
+    const boost::uint32_t first = uhd::wtohx(*reinterpret_cast<const boost::uint32_t *>(view.payloads.front()));
+    BOOST_CHECK_EQUAL(first >> 16, boost::uint32_t(30));
+    view.release();
+
+    BOOST_CHECK_EQUAL(handler.recv_view(view, 1.0), size_t(0));
+    BOOST_CHECK_EQUAL(view.metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
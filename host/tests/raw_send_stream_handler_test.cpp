@@ -0,0 +1,234 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "../lib/transport/raw_send_stream_handler.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/bind.hpp>
+#include <complex>
+#include <vector>
+#include <list>
+
+static const size_t frame_size = 2048;
+static const size_t alignment = 512;
+
+/***********************************************************************
+ * A dummy managed send buffer for testing
+ **********************************************************************/
+class dummy_msb : public uhd::transport::managed_send_buffer{
+public:
+    void commit(size_t len){
+        if (len == 0) return;
+        *_len = len;
+    }
+
+    sptr get_new(boost::shared_array<char> mem, size_t *len){
+        _mem = mem;
+        _len = len;
+        return make_managed_buffer(this);
+    }
+
+private:
+    void *get_buff(void) const{return _mem.get();}
+    size_t get_size(void) const{return frame_size;}
+
+    boost::shared_array<char> _mem;
+    size_t *_len;
+};
+
+/***********************************************************************
+ * A dummy transport that keeps the frames and their commit lengths,
+ * a length of zero means the frame was not committed (yet).
+ **********************************************************************/
+class dummy_raw_xport_class{
+public:
+    dummy_raw_xport_class(const size_t num_frames): _num_frames(num_frames){
+        /* NOP */
+    }
+
+    uhd::transport::managed_send_buffer::sptr get_send_buff(double){
+        if (_mems.size() == _num_frames) return uhd::transport::managed_send_buffer::sptr(); //timeout
+        _msbs.push_back(dummy_msb());
+        _mems.push_back(boost::shared_array<char>(new char[frame_size]));
+        std::fill(_mems.back().get(), _mems.back().get() + frame_size, char(0xff));
+        _lens.push_back(0);
+        return _msbs.back().get_new(_mems.back(), &_lens.back());
+    }
+
+    //! Get the I of a sc16 item in a frame
+    short get_real(const size_t frame, const size_t index){
+        std::list<boost::shared_array<char> >::iterator mem = _mems.begin();
+        std::advance(mem, frame);
+        const boost::uint32_t item = uhd::wtohx(reinterpret_cast<const boost::uint32_t *>(mem->get())[index]);
+        return short(item >> 16);
+    }
+
+    std::vector<size_t> get_lens(void) const{
+        return std::vector<size_t>(_lens.begin(), _lens.end());
+    }
+
+private:
+    const size_t _num_frames;
+    std::list<boost::shared_array<char> > _mems;
+    std::list<size_t> _lens;
+    std::list<dummy_msb> _msbs; //list means no-realloc
+};
+
+static void setup_handler(
+    uhd::transport::sph::raw_send_stream_handler &handler,
+    dummy_raw_xport_class &xport
+){
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_LITTLE_ENDIAN;
+    handler.set_xport_get_buff(boost::bind(&dummy_raw_xport_class::get_send_buff, &xport, _1));
+    handler.set_alignment(alignment);
+    handler.set_converter(otw_type);
+    handler.set_max_samples_per_packet(frame_size/otw_type.get_sample_size());
+}
+
+static std::vector<std::complex<short> > make_ramp(const size_t start, const size_t nsamps){
+    std::vector<std::complex<short> > buff;
+    for (size_t i = 0; i < nsamps; i++){
+        buff.push_back(std::complex<short>(short(start + i), -short(start + i)));
+    }
+    return buff;
+}
+
+/***********************************************************************
+ * Test that the frames are filled in place across the sends
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_raw_send_fill_frames){
+    dummy_raw_xport_class dummy_send_xport(10);
+    uhd::transport::sph::raw_send_stream_handler handler;
+    setup_handler(handler, dummy_send_xport);
+    uhd::tx_metadata_t metadata;
+
+    //an unaligned send stays held in the frame
+    std::vector<std::complex<short> > buff = make_ramp(0, 300);
+    BOOST_CHECK_EQUAL(handler.send(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    ), buff.size());
+    BOOST_REQUIRE_EQUAL(dummy_send_xport.get_lens().size(), size_t(1));
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_lens()[0], size_t(0));
+
+    //the next send continues the frame and spills into the next one
+    buff = make_ramp(300, 400);
+    BOOST_CHECK_EQUAL(handler.send(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    ), buff.size());
+    BOOST_REQUIRE_EQUAL(dummy_send_xport.get_lens().size(), size_t(2));
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_lens()[0], frame_size);
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_lens()[1], size_t(0));
+    for (size_t i = 0; i < frame_size/4; i++){
+        BOOST_CHECK_EQUAL(dummy_send_xport.get_real(0, i), short(i));
+    }
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_real(1, 0), short(frame_size/4));
+
+    //a send that lands on the alignment is committed right away
+    buff = make_ramp(700, 68);
+    handler.send(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_lens()[1], size_t(256*4));
+
+    //one packet mode is limited by the max samples per packet
+    buff = make_ramp(0, 1000);
+    BOOST_CHECK_EQUAL(handler.send(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::SEND_MODE_ONE_PACKET, 1.0
+    ), frame_size/4);
+}
+
+/***********************************************************************
+ * Test the flush pads the held frame with zeros to the alignment
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_raw_send_flush){
+    dummy_raw_xport_class dummy_send_xport(10);
+    uhd::transport::sph::raw_send_stream_handler handler;
+    setup_handler(handler, dummy_send_xport);
+    uhd::tx_metadata_t metadata;
+
+    std::vector<std::complex<short> > buff = make_ramp(1, 10);
+    handler.send(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    );
+    handler.flush(1.0);
+    BOOST_REQUIRE_EQUAL(dummy_send_xport.get_lens().size(), size_t(1));
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_lens()[0], alignment);
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_real(0, 9), short(10));
+    for (size_t i = 10; i < alignment/4; i++){
+        BOOST_CHECK_EQUAL(dummy_send_xport.get_real(0, i), short(0));
+    }
+
+    //with nothing held, one alignment of zeros is sent
+    handler.flush(1.0);
+    BOOST_REQUIRE_EQUAL(dummy_send_xport.get_lens().size(), size_t(2));
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_lens()[1], alignment);
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_real(1, 0), short(0));
+}
+
+/***********************************************************************
+ * Test the send view writes after the held samples
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_raw_send_view){
+    dummy_raw_xport_class dummy_send_xport(10);
+    uhd::transport::sph::raw_send_stream_handler handler;
+    setup_handler(handler, dummy_send_xport);
+    uhd::tx_metadata_t metadata;
+
+    std::vector<std::complex<short> > buff = make_ramp(0, 100);
+    handler.send(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    );
+
+    uhd::device::send_view_t view;
+    BOOST_CHECK_EQUAL(handler.get_send_view(view, 1.0), frame_size/4 - 100);
+    BOOST_CHECK_EQUAL(view.num_header_words32, size_t(0));
+    BOOST_REQUIRE_EQUAL(view.payloads.size(), size_t(1));
+    boost::uint32_t *payload = reinterpret_cast<boost::uint32_t *>(view.payloads.front());
+    for (size_t i = 0; i < 28; i++) payload[i] = uhd::htowx(boost::uint32_t(100 + i) << 16);
+    BOOST_CHECK_EQUAL(handler.commit_send_view(view, 28), size_t(28));
+    BOOST_CHECK(view.frames.empty());
+
+    //100 + 28 items land on the alignment
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_lens()[0], alignment);
+    BOOST_CHECK_EQUAL(dummy_send_xport.get_real(0, 127), short(127));
+}
+
+/***********************************************************************
+ * Test that a timeout returns the samples sent so far
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_raw_send_timeout){
+    dummy_raw_xport_class dummy_send_xport(2);
+    uhd::transport::sph::raw_send_stream_handler handler;
+    setup_handler(handler, dummy_send_xport);
+    uhd::tx_metadata_t metadata;
+
+    std::vector<std::complex<short> > buff = make_ramp(0, 3*frame_size/4);
+    BOOST_CHECK_EQUAL(handler.send(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::SEND_MODE_FULL_BUFF, 0.0
+    ), 2*frame_size/4);
+}
@@ -0,0 +1,184 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/usrp/rx_callback_streamer.hpp>
+#include <uhd/property_tree.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <vector>
+
+static const size_t spp = 100;
+
+/***********************************************************************
+ * A dummy device that receives a counting ramp,
+ * with a timeout on every third call and an overflow on the seventh
+ **********************************************************************/
+class dummy_ramp_device : public uhd::device{
+public:
+    dummy_ramp_device(void): _num_calls(0), _next(0), _packet(spp){}
+
+    size_t recv(
+        const recv_buffs_type &buffs, size_t nsamps, uhd::rx_metadata_t &md,
+        const uhd::io_type_t &io_type, recv_mode_t, double
+    ){
+        BOOST_REQUIRE_EQUAL(io_type.size, sizeof(boost::int16_t));
+        md = uhd::rx_metadata_t();
+        if (++_num_calls % 3 == 0){
+            md.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        if (_num_calls == 7){
+            md.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+            return 0;
+        }
+        nsamps = std::min(nsamps, spp);
+        for (size_t ch = 0; ch < buffs.size(); ch++){
+            boost::int16_t *out = reinterpret_cast<boost::int16_t *>(buffs[ch]);
+            for (size_t i = 0; i < nsamps; i++) out[i] = boost::int16_t(_next + i + ch);
+        }
+        _next += nsamps;
+        return nsamps;
+    }
+
+    size_t recv_view(recv_view_t &view, double){
+        view.release();
+        view.metadata = uhd::rx_metadata_t();
+        if (++_num_calls % 3 == 0){
+            view.metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        for (size_t i = 0; i < spp; i++) _packet[i] = boost::uint32_t(_next + i);
+        view.payloads.push_back(&_packet.front());
+        view.nsamps = spp;
+        view.item_size = sizeof(boost::uint32_t);
+        _next += spp;
+        return spp;
+    }
+
+    size_t send(const send_buffs_type &, size_t, const uhd::tx_metadata_t &, const uhd::io_type_t &, send_mode_t, double){
+        return 0;
+    }
+
+    size_t get_max_send_samps_per_packet(void) const{return spp;}
+    size_t get_max_recv_samps_per_packet(void) const{return spp;}
+
+    bool recv_async_msg(uhd::async_metadata_t &, double){
+        return false;
+    }
+
+    uhd::property_tree::sptr get_tree(void) const{
+        return uhd::property_tree::sptr();
+    }
+
+private:
+    size_t _num_calls, _next;
+    std::vector<boost::uint32_t> _packet;
+};
+
+/***********************************************************************
+ * Callbacks that record what they were handed
+ **********************************************************************/
+struct recorder{
+    boost::mutex mutex;
+    std::vector<size_t> nsamps;
+    std::vector<uhd::rx_metadata_t::error_code_t> errors;
+    std::vector<std::vector<boost::int16_t> > firsts; //first sample per channel
+    boost::thread::id thread_id;
+
+    void on_recv(const std::vector<const void *> &buffs, size_t n, const uhd::rx_metadata_t &md){
+        boost::mutex::scoped_lock lock(mutex);
+        thread_id = boost::this_thread::get_id();
+        nsamps.push_back(n);
+        errors.push_back(md.error_code);
+        std::vector<boost::int16_t> first;
+        for (size_t ch = 0; ch < buffs.size(); ch++){
+            first.push_back((n == 0)? -1 : reinterpret_cast<const boost::int16_t *>(buffs[ch])[0]);
+        }
+        firsts.push_back(first);
+    }
+
+    void on_view(const uhd::device::recv_view_t &view){
+        boost::mutex::scoped_lock lock(mutex);
+        nsamps.push_back(view.nsamps);
+        errors.push_back(view.metadata.error_code);
+        firsts.push_back(std::vector<boost::int16_t>(1, boost::int16_t(
+            reinterpret_cast<const boost::uint32_t *>(view.payloads.at(0))[0]
+        )));
+    }
+
+    size_t size(void){
+        boost::mutex::scoped_lock lock(mutex);
+        return nsamps.size();
+    }
+};
+
+static void wait_for_callbacks(uhd::usrp::rx_callback_streamer::sptr streamer, const size_t num){
+    for (size_t i = 0; i < 1000 and streamer->get_num_callbacks() < num; i++){
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+}
+
+/***********************************************************************
+ * Tests
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_rx_callback_streamer_converted){
+    uhd::device::sptr dev(new dummy_ramp_device());
+    recorder rec;
+    uhd::usrp::rx_callback_streamer::sptr streamer = uhd::usrp::rx_callback_streamer::make(
+        dev, uhd::io_type_t(sizeof(boost::int16_t)), 2, 0,
+        boost::bind(&recorder::on_recv, &rec, _1, _2, _3)
+    );
+    wait_for_callbacks(streamer, 6);
+    streamer.reset(); //stops the thread, no more callbacks
+
+    //calls 1 2 _ 4 5 _ 7(overflow) 8: timeouts are not reported
+    BOOST_REQUIRE_GE(rec.size(), 6);
+    BOOST_CHECK(rec.thread_id != boost::this_thread::get_id());
+    const size_t expected_nsamps[] = {spp, spp, spp, spp, 0, spp};
+    const boost::int16_t expected_first[] = {0, 100, 200, 300, -1, 400};
+    for (size_t i = 0; i < 6; i++){
+        BOOST_CHECK_EQUAL(rec.nsamps[i], expected_nsamps[i]);
+        BOOST_CHECK_EQUAL(rec.errors[i], (expected_nsamps[i] == 0)?
+            uhd::rx_metadata_t::ERROR_CODE_OVERFLOW : uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_REQUIRE_EQUAL(rec.firsts[i].size(), 2);
+        BOOST_CHECK_EQUAL(rec.firsts[i][0], expected_first[i]);
+        if (expected_nsamps[i] != 0) BOOST_CHECK_EQUAL(rec.firsts[i][1], expected_first[i] + 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_callback_streamer_raw){
+    uhd::device::sptr dev(new dummy_ramp_device());
+    recorder rec;
+    uhd::usrp::rx_callback_streamer::sptr streamer = uhd::usrp::rx_callback_streamer::make_raw(
+        dev, boost::bind(&recorder::on_view, &rec, _1)
+    );
+    wait_for_callbacks(streamer, 4);
+    const size_t num_callbacks = streamer->get_num_callbacks();
+    streamer.reset();
+
+    BOOST_REQUIRE_GE(rec.size(), 4);
+    BOOST_CHECK_GE(rec.size(), num_callbacks);
+    for (size_t i = 0; i < 4; i++){
+        BOOST_CHECK_EQUAL(rec.nsamps[i], spp);
+        BOOST_CHECK_EQUAL(rec.errors[i], uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK_EQUAL(rec.firsts[i][0], boost::int16_t(i*spp));
+    }
+}
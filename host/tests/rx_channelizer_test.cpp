@@ -0,0 +1,219 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/usrp/rx_channelizer.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/property_tree.hpp>
+#include <boost/cstdint.hpp>
+#include <complex>
+#include <cmath>
+#include <vector>
+
+static const double pi = std::acos(-1.0);
+static const double samp_rate = 1e6;
+
+/***********************************************************************
+ * A dummy device that hands out views of a test tone
+ **********************************************************************/
+class dummy_view_device : public uhd::device{
+public:
+    dummy_view_device(const double freq, const size_t spp):
+        _freq(freq), _spp(spp), _next(0), _overflow(false), _packet(spp)
+    {
+        _otw_type.width = 16;
+        _otw_type.shift = 0;
+        _otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+    }
+
+    //! Fail the next view with an overflow and skip some samples
+    void inject_overflow(const size_t num_dropped){
+        _overflow = true;
+        _next += num_dropped;
+    }
+
+    size_t recv_view(recv_view_t &view, double){
+        view.release();
+        view.metadata = uhd::rx_metadata_t();
+        if (_overflow){
+            _overflow = false;
+            view.metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+            return 0;
+        }
+
+        std::vector<std::complex<float> > samps(_spp);
+        for (size_t i = 0; i < _spp; i++){
+            samps[i] = std::polar(0.5f, float(2*pi*_freq*(_next + i)/samp_rate));
+        }
+        const uhd::convert::input_type inputs(&samps.front());
+        const uhd::convert::output_type outputs(&_packet.front());
+        uhd::convert::get_converter_cpu_to_otw(
+            uhd::io_type_t::COMPLEX_FLOAT32, _otw_type, 1, 1
+        )(inputs, outputs, _spp, 32767.);
+
+        view.payloads.push_back(&_packet.front());
+        view.nsamps = _spp;
+        view.item_size = sizeof(boost::uint32_t);
+        view.otw_type = _otw_type;
+        view.metadata.has_time_spec = true;
+        view.metadata.time_spec = uhd::time_spec_t(_next/samp_rate);
+        _next += _spp;
+        return _spp;
+    }
+
+    size_t send(const send_buffs_type &, size_t, const uhd::tx_metadata_t &, const uhd::io_type_t &, send_mode_t, double){
+        return 0;
+    }
+
+    size_t recv(const recv_buffs_type &, size_t, uhd::rx_metadata_t &, const uhd::io_type_t &, recv_mode_t, double){
+        return 0;
+    }
+
+    size_t get_max_send_samps_per_packet(void) const{return _spp;}
+    size_t get_max_recv_samps_per_packet(void) const{return _spp;}
+
+    bool recv_async_msg(uhd::async_metadata_t &, double){
+        return false;
+    }
+
+    uhd::property_tree::sptr get_tree(void) const{
+        return uhd::property_tree::sptr();
+    }
+
+private:
+    const double _freq;
+    const size_t _spp;
+    size_t _next;
+    bool _overflow;
+    uhd::otw_type_t _otw_type;
+    std::vector<boost::uint32_t> _packet;
+};
+
+/***********************************************************************
+ * Helpers to receive into one buffer per channel
+ **********************************************************************/
+typedef std::vector<std::vector<std::complex<float> > > chan_buffs_type;
+
+static size_t recv_chans(
+    uhd::usrp::rx_channelizer::sptr chan, chan_buffs_type &buffs,
+    const size_t nsamps, uhd::rx_metadata_t &md
+){
+    std::vector<void *> ptrs;
+    for (size_t c = 0; c < buffs.size(); c++){
+        buffs[c].resize(nsamps);
+        ptrs.push_back(&buffs[c].front());
+    }
+    return chan->recv(ptrs, nsamps, md);
+}
+
+static double peak_mag(const std::vector<std::complex<float> > &buff){
+    double peak = 0;
+    for (size_t i = 0; i < buff.size(); i++) peak = std::max(peak, double(std::abs(buff[i])));
+    return peak;
+}
+
+/***********************************************************************
+ * Tests
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_rx_channelizer_tone){
+    static const size_t num_chans = 8, chan = 3, nsamps = 200;
+    const double offset = 1e3;
+    uhd::device::sptr dev(new dummy_view_device(chan*samp_rate/num_chans + offset, 300));
+    uhd::usrp::rx_channelizer::sptr channelizer = uhd::usrp::rx_channelizer::make(dev, samp_rate, num_chans);
+    BOOST_CHECK_EQUAL(channelizer->get_num_chans(), num_chans);
+    BOOST_CHECK_CLOSE(channelizer->get_chan_rate(), samp_rate/num_chans, 1e-9);
+    BOOST_CHECK_CLOSE(channelizer->get_chan_freq(chan), chan*samp_rate/num_chans, 1e-9);
+    BOOST_CHECK_CLOSE(channelizer->get_chan_freq(num_chans-1), -samp_rate/num_chans, 1e-9);
+
+    chan_buffs_type buffs(num_chans);
+    for (size_t call = 0; call < 3; call++){
+        uhd::rx_metadata_t md;
+        BOOST_REQUIRE_EQUAL(recv_chans(channelizer, buffs, nsamps, md), nsamps);
+        BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(md.has_time_spec);
+
+        //the tone lands in its channel, mixed down to the offset
+        for (size_t n = 0; n < nsamps; n++){
+            const double t = md.time_spec.get_real_secs() + n/channelizer->get_chan_rate();
+            const std::complex<double> expected = std::polar(0.5, 2*pi*offset*t);
+            BOOST_CHECK_SMALL(std::abs(std::complex<double>(buffs[chan][n]) - expected), 0.01);
+        }
+
+        //the other channels reject it
+        for (size_t c = 0; c < num_chans; c++){
+            if (c == chan) continue;
+            BOOST_CHECK_SMALL(peak_mag(buffs[c]), 0.005);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_channelizer_threads){
+    static const size_t num_chans = 16, nsamps = 333;
+    const double freq = -5*samp_rate/num_chans + 2e3;
+    uhd::device::sptr dev0(new dummy_view_device(freq, 256));
+    uhd::device::sptr dev1(new dummy_view_device(freq, 256));
+    uhd::usrp::rx_channelizer::sptr single = uhd::usrp::rx_channelizer::make(dev0, samp_rate, num_chans, 8, 0);
+    uhd::usrp::rx_channelizer::sptr pooled = uhd::usrp::rx_channelizer::make(dev1, samp_rate, num_chans, 8, 3);
+
+    chan_buffs_type buffs0(num_chans), buffs1(num_chans);
+    for (size_t call = 0; call < 4; call++){
+        uhd::rx_metadata_t md0, md1;
+        BOOST_REQUIRE_EQUAL(recv_chans(single, buffs0, nsamps, md0), nsamps);
+        BOOST_REQUIRE_EQUAL(recv_chans(pooled, buffs1, nsamps, md1), nsamps);
+        BOOST_CHECK(md0.time_spec == md1.time_spec);
+        for (size_t c = 0; c < num_chans; c++){
+            BOOST_CHECK(buffs0[c] == buffs1[c]);
+        }
+    }
+    BOOST_CHECK_CLOSE(peak_mag(buffs0[num_chans-5]), 0.5, 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_channelizer_overflow){
+    static const size_t num_chans = 4, nsamps = 100;
+    dummy_view_device *dummy = new dummy_view_device(0.0, 150);
+    uhd::device::sptr dev(dummy);
+    uhd::usrp::rx_channelizer::sptr channelizer = uhd::usrp::rx_channelizer::make(dev, samp_rate, num_chans);
+    chan_buffs_type buffs(num_chans);
+
+    uhd::rx_metadata_t md;
+    BOOST_REQUIRE_EQUAL(recv_chans(channelizer, buffs, nsamps, md), nsamps);
+    const uhd::time_spec_t first_time = md.time_spec;
+    BOOST_REQUIRE_EQUAL(recv_chans(channelizer, buffs, nsamps, md), nsamps);
+    BOOST_CHECK_CLOSE((md.time_spec - first_time).get_real_secs(), nsamps*num_chans/samp_rate, 1e-6);
+
+    //the overflow is reported, then the filterbank restarts after the gap
+    dummy->inject_overflow(1000);
+    BOOST_CHECK_EQUAL(recv_chans(channelizer, buffs, nsamps, md), size_t(0));
+    BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+    BOOST_REQUIRE_EQUAL(recv_chans(channelizer, buffs, nsamps, md), nsamps);
+    BOOST_CHECK(md.has_time_spec);
+    BOOST_CHECK(md.time_spec > first_time + uhd::time_spec_t(1000/samp_rate));
+    BOOST_CHECK_CLOSE(peak_mag(buffs[0]), 0.5, 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_channelizer_bad_args){
+    uhd::device::sptr dev(new dummy_view_device(0.0, 100));
+    BOOST_CHECK_THROW(uhd::usrp::rx_channelizer::make(dev, samp_rate, 6), uhd::value_error);
+    BOOST_CHECK_THROW(uhd::usrp::rx_channelizer::make(dev, samp_rate, 1), uhd::value_error);
+    BOOST_CHECK_THROW(uhd::usrp::rx_channelizer::make(dev, samp_rate, 8, 0), uhd::value_error);
+
+    uhd::usrp::rx_channelizer::sptr channelizer = uhd::usrp::rx_channelizer::make(dev, samp_rate, 8);
+    chan_buffs_type buffs(4);
+    uhd::rx_metadata_t md;
+    BOOST_CHECK_THROW(recv_chans(channelizer, buffs, 10, md), uhd::value_error);
+}
@@ -0,0 +1,101 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/transport/shm_fanout.hpp>
+#include <uhd/exception.hpp>
+#include <boost/cstdint.hpp>
+#include <cstring>
+
+using namespace uhd::transport;
+
+static const double timeout = 0.01/*secs*/;
+static const std::string name = "uhd_shm_fanout_test";
+
+static void write_frame(shm_fanout_writer::sptr writer, boost::uint32_t num){
+    std::memcpy(writer->get_frame_buff(), &num, sizeof(num));
+    uhd::rx_metadata_t md = uhd::rx_metadata_t();
+    md.has_time_spec = true;
+    md.time_spec = uhd::time_spec_t(double(num));
+    writer->commit(sizeof(num), md);
+}
+
+static boost::uint32_t read_frame(shm_fanout_reader::sptr reader){
+    size_t num_bytes; uhd::rx_metadata_t md;
+    const void *mem = reader->get_frame(num_bytes, md, timeout);
+    BOOST_REQUIRE(mem != NULL);
+    BOOST_REQUIRE_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_REQUIRE_EQUAL(num_bytes, sizeof(boost::uint32_t));
+    boost::uint32_t num; std::memcpy(&num, mem, sizeof(num));
+    BOOST_CHECK(md.has_time_spec);
+    BOOST_CHECK_EQUAL(md.time_spec.get_full_secs(), time_t(num));
+    return num;
+}
+
+BOOST_AUTO_TEST_CASE(test_shm_fanout_readers){
+    shm_fanout_writer::sptr writer = shm_fanout_writer::make(name, 64, 8);
+    shm_fanout_reader::sptr reader0 = shm_fanout_reader::make(name);
+    BOOST_CHECK_EQUAL(reader0->get_frame_size(), size_t(64));
+
+    //nothing written yet, check for timeout
+    size_t num_bytes; uhd::rx_metadata_t md;
+    BOOST_CHECK(reader0->get_frame(num_bytes, md, timeout) == NULL);
+    BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+
+    write_frame(writer, 0);
+    write_frame(writer, 1);
+
+    //a late reader starts at the newest frame
+    shm_fanout_reader::sptr reader1 = shm_fanout_reader::make(name);
+    write_frame(writer, 2);
+
+    //each reader has its own cursor
+    BOOST_CHECK_EQUAL(read_frame(reader0), boost::uint32_t(0));
+    BOOST_CHECK_EQUAL(read_frame(reader1), boost::uint32_t(2));
+    BOOST_CHECK_EQUAL(read_frame(reader0), boost::uint32_t(1));
+    BOOST_CHECK(reader0->frame_valid());
+    BOOST_CHECK_EQUAL(read_frame(reader0), boost::uint32_t(2));
+    BOOST_CHECK(reader0->get_frame(num_bytes, md, timeout) == NULL);
+    BOOST_CHECK(reader1->get_frame(num_bytes, md, timeout) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(test_shm_fanout_overflow){
+    shm_fanout_writer::sptr writer = shm_fanout_writer::make(name, 64, 8);
+    shm_fanout_reader::sptr reader = shm_fanout_reader::make(name);
+
+    write_frame(writer, 0);
+    BOOST_CHECK_EQUAL(read_frame(reader), boost::uint32_t(0));
+
+    //lap the reader, the last frame is overwritten
+    for (boost::uint32_t i = 1; i <= 20; i++) write_frame(writer, i);
+    BOOST_CHECK(not reader->frame_valid());
+
+    size_t num_bytes; uhd::rx_metadata_t md;
+    BOOST_CHECK(reader->get_frame(num_bytes, md, timeout) == NULL);
+    BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+    BOOST_CHECK_EQUAL(reader->get_num_overflows(), size_t(1));
+
+    //the reader resumes half a ring behind the writer
+    for (boost::uint32_t i = 17; i <= 20; i++){
+        BOOST_CHECK_EQUAL(read_frame(reader), i);
+    }
+    BOOST_CHECK_EQUAL(reader->get_num_overflows(), size_t(1));
+}
+
+BOOST_AUTO_TEST_CASE(test_shm_fanout_no_ring){
+    BOOST_CHECK_THROW(shm_fanout_reader::make(name + "_missing"), uhd::io_error);
+}
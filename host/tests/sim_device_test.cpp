@@ -0,0 +1,362 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/device.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/types/stream_cmd.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/usrp/subdev_spec.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/bind.hpp>
+#include <complex>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace uhd;
+
+static const fs_path mb_path = "/mboards/0";
+
+static device::sptr make_sim(const std::string &args){
+    const device_addr_t hint("type=sim," + args);
+    BOOST_REQUIRE_EQUAL(device::find(hint).size(), size_t(1));
+    return device::make(hint);
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_find){
+    //not found unless asked for by type
+    BOOST_CHECK(device::find(device_addr_t("type=none")).empty());
+
+    device::sptr dev = make_sim("");
+    property_tree::sptr tree = dev->get_tree();
+    BOOST_CHECK_EQUAL(tree->list(mb_path / "rx_dsps").size(), size_t(2));
+    BOOST_CHECK_EQUAL(tree->list(mb_path / "tx_dsps").size(), size_t(1));
+    BOOST_CHECK_EQUAL(tree->access<double>(mb_path / "tick_rate").get(), 100e6);
+    BOOST_CHECK_EQUAL(tree->access<double>(mb_path / "rx_dsps/0/rate/value").get(), 1e6);
+
+    //the rates are the tick rate divided by a whole number
+    tree->access<double>(mb_path / "rx_dsps/0/rate/value").set(3e6);
+    BOOST_CHECK_CLOSE(tree->access<double>(mb_path / "rx_dsps/0/rate/value").get(), 100e6/33, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_recv_ramp){
+    device::sptr dev = make_sim("sim_signal=ramp,sim_pace=0");
+    property_tree::sptr tree = dev->get_tree();
+    const double rate = tree->access<double>(mb_path / "rx_dsps/0/rate/value").get();
+
+    static const size_t total = 10000;
+    stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    stream_cmd.num_samps = total;
+    stream_cmd.stream_now = true;
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/0/stream_cmd").set(stream_cmd);
+
+    std::vector<std::complex<short> > buff(dev->get_max_recv_samps_per_packet());
+    size_t num_recvd = 0;
+    time_spec_t first_time;
+    int next_i = -1;
+    while (true){
+        rx_metadata_t md;
+        const size_t n = dev->recv(
+            &buff.front(), buff.size(), md, io_type_t::COMPLEX_INT16,
+            device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_REQUIRE_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_REQUIRE(md.has_time_spec);
+
+        //the timestamps count the samples
+        if (num_recvd == 0) first_time = md.time_spec;
+        BOOST_CHECK_CLOSE(
+            (md.time_spec - first_time).get_real_secs(),
+            num_recvd/rate, 1e-6
+        );
+
+        //the ramp is continuous across the packets
+        for (size_t i = 0; i < n; i++){
+            if (next_i >= 0) BOOST_REQUIRE_EQUAL(short(buff[i].real()), short(next_i));
+            BOOST_REQUIRE_EQUAL(short(buff[i].imag()), short(-buff[i].real()));
+            next_i = (buff[i].real() + 1) & 0xffff;
+        }
+
+        num_recvd += n;
+        if (md.end_of_burst) break;
+    }
+    BOOST_CHECK_EQUAL(num_recvd, total);
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_recv_late_command){
+    device::sptr dev = make_sim("");
+    property_tree::sptr tree = dev->get_tree();
+    tree->access<time_spec_t>(mb_path / "time/now").set(time_spec_t(1.0));
+
+    stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    stream_cmd.num_samps = 100;
+    stream_cmd.stream_now = false;
+    stream_cmd.time_spec = time_spec_t(0.5);
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/0/stream_cmd").set(stream_cmd);
+
+    std::vector<std::complex<float> > buff(dev->get_max_recv_samps_per_packet());
+    rx_metadata_t md;
+    const size_t n = dev->recv(
+        &buff.front(), buff.size(), md, io_type_t::COMPLEX_FLOAT32,
+        device::RECV_MODE_ONE_PACKET, 1.0
+    );
+    BOOST_CHECK_EQUAL(n, size_t(0));
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_LATE_COMMAND);
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_recv_overflow){
+    //a small buffer overflows quickly when nobody reads it
+    device::sptr dev = make_sim("recv_buff_size=100e3");
+    property_tree::sptr tree = dev->get_tree();
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/0/stream_cmd")
+        .set(stream_cmd_t(stream_cmd_t::STREAM_MODE_START_CONTINUOUS));
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+
+    std::vector<std::complex<float> > buff(dev->get_max_recv_samps_per_packet());
+    rx_metadata_t md;
+    dev->recv(
+        &buff.front(), buff.size(), md, io_type_t::COMPLEX_FLOAT32,
+        device::RECV_MODE_ONE_PACKET, 1.0
+    );
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_OVERFLOW);
+
+    //the continuous stream resumes after the overflow
+    dev->recv(
+        &buff.front(), buff.size(), md, io_type_t::COMPLEX_FLOAT32,
+        device::RECV_MODE_ONE_PACKET, 1.0
+    );
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_NONE);
+
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/0/stream_cmd")
+        .set(stream_cmd_t(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS));
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_telemetry){
+    const boost::filesystem::path file = boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path("uhd-telemetry-%%%%%%%%.prom");
+    device::sptr dev = make_sim("telemetry_period=0.01,telemetry_file=" + file.string());
+
+    //the first snapshot replaces the file whole after a period
+    for (size_t i = 0; i < 200 and not boost::filesystem::exists(file); i++){
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    BOOST_REQUIRE(boost::filesystem::exists(file));
+    std::ifstream in(file.string().c_str());
+    std::stringstream snapshot;
+    snapshot << in.rdbuf();
+
+    BOOST_CHECK(snapshot.str().find("# TYPE uhd_events_overflows counter\n") != std::string::npos);
+    BOOST_CHECK(snapshot.str().find("uhd_events_overflows{path=\"/mboards/0/rx_dsps/1\"} 0\n") != std::string::npos);
+    BOOST_CHECK(snapshot.str().find("uhd_xport_frames{path=\"/mboards/0/tx_dsps/0\"}") != std::string::npos);
+    BOOST_CHECK(snapshot.str().find("uhd_task_cpu_seconds{task=\"telemetry\"}") != std::string::npos);
+
+    dev.reset();
+    boost::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_send_burst){
+    device::sptr dev = make_sim("");
+    property_tree::sptr tree = dev->get_tree();
+
+    //a timed burst is acked at its end
+    const time_spec_t start = tree->access<time_spec_t>(mb_path / "time/now").get() + time_spec_t(0.01);
+    std::vector<std::complex<float> > buff(1000);
+    tx_metadata_t md;
+    md.start_of_burst = true;
+    md.end_of_burst = true;
+    md.has_time_spec = true;
+    md.time_spec = start;
+    BOOST_CHECK_EQUAL(dev->send(
+        &buff.front(), buff.size(), md, io_type_t::COMPLEX_FLOAT32,
+        device::SEND_MODE_FULL_BUFF, 1.0
+    ), buff.size());
+
+    async_metadata_t async_md;
+    BOOST_REQUIRE(dev->recv_async_msg(async_md, 1.0));
+    BOOST_CHECK_EQUAL(async_md.event_code, async_metadata_t::EVENT_CODE_BURST_ACK);
+    BOOST_CHECK(async_md.time_spec >= start);
+
+    //a burst in the past is reported as a time error
+    md.time_spec = time_spec_t(0.0);
+    dev->send(
+        &buff.front(), buff.size(), md, io_type_t::COMPLEX_FLOAT32,
+        device::SEND_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_REQUIRE(dev->recv_async_msg(async_md, 1.0));
+    BOOST_CHECK_EQUAL(async_md.event_code, async_metadata_t::EVENT_CODE_TIME_ERROR);
+}
+
+static void recv_ramp_stream(rx_streamer::sptr stream, size_t *num_recvd, bool *ramp_ok){
+    std::vector<std::complex<short> > buff(stream->get_max_num_samps());
+    int next_i = -1;
+    while (true){
+        rx_metadata_t md;
+        const size_t n = stream->recv(&buff.front(), buff.size(), md, 1.0, true);
+        if (md.error_code != rx_metadata_t::ERROR_CODE_NONE) break;
+        for (size_t i = 0; i < n; i++){
+            if (next_i >= 0 and short(buff[i].real()) != short(next_i)) *ramp_ok = false;
+            next_i = (buff[i].real() + 1) & 0xffff;
+        }
+        *num_recvd += n;
+        if (md.end_of_burst) break;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_streams){
+    device::sptr dev = make_sim("sim_signal=ramp,sim_pace=0");
+    property_tree::sptr tree = dev->get_tree();
+    const std::string sd = tree->list(mb_path / "dboards/A/rx_frontends").front();
+    tree->access<usrp::subdev_spec_t>(mb_path / "rx_subdev_spec").set(usrp::subdev_spec_t("A:" + sd + " A:" + sd));
+
+    //the format and the channels are checked when the stream is made
+    stream_args_t args(io_type_t::COMPLEX_INT16);
+    args.otw_format = "sc8";
+    BOOST_CHECK_THROW(dev->get_rx_stream(args), uhd::value_error);
+    args.otw_format = "";
+    BOOST_CHECK_EQUAL(dev->get_rx_stream(args)->get_num_channels(), size_t(2));
+    args.channels.push_back(2);
+    BOOST_CHECK_THROW(dev->get_rx_stream(args), uhd::index_error);
+
+    //one stream per dsp, each received from its own thread
+    static const size_t total = 10000;
+    std::vector<rx_streamer::sptr> streams;
+    for (size_t dsp = 0; dsp < 2; dsp++){
+        args.channels = std::vector<size_t>(1, dsp);
+        streams.push_back(dev->get_rx_stream(args));
+        BOOST_CHECK_EQUAL(streams.back()->get_num_channels(), size_t(1));
+        BOOST_CHECK_EQUAL(streams.back()->get_max_num_samps(), dev->get_max_recv_samps_per_packet());
+    }
+    stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    stream_cmd.num_samps = total;
+    stream_cmd.stream_now = true;
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/0/stream_cmd").set(stream_cmd);
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/1/stream_cmd").set(stream_cmd);
+
+    size_t num_recvd[2] = {0, 0};
+    bool ramp_ok[2] = {true, true};
+    boost::thread_group threads;
+    for (size_t i = 0; i < 2; i++){
+        threads.create_thread(boost::bind(&recv_ramp_stream, streams[i], &num_recvd[i], &ramp_ok[i]));
+    }
+    threads.join_all();
+    for (size_t i = 0; i < 2; i++){
+        BOOST_CHECK_EQUAL(num_recvd[i], total);
+        BOOST_CHECK(ramp_ok[i]);
+    }
+
+    //a transmit stream sends a burst that is acked
+    tx_streamer::sptr tx_stream = dev->get_tx_stream(stream_args_t(io_type_t::COMPLEX_FLOAT32));
+    std::vector<std::complex<float> > buff(1000);
+    tx_metadata_t md;
+    md.start_of_burst = true;
+    md.end_of_burst = true;
+    BOOST_CHECK_EQUAL(tx_stream->send(&buff.front(), buff.size(), md, 1.0), buff.size());
+    async_metadata_t async_md;
+    BOOST_REQUIRE(dev->recv_async_msg(async_md, 1.0));
+    BOOST_CHECK_EQUAL(async_md.event_code, async_metadata_t::EVENT_CODE_BURST_ACK);
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_stream_spp){
+    device::sptr dev = make_sim("sim_signal=ramp,sim_pace=0");
+    property_tree::sptr tree = dev->get_tree();
+
+    //the packets of the stream carry the samples per packet of its arguments
+    stream_args_t args(io_type_t::COMPLEX_INT16);
+    args.spp = 32;
+    rx_streamer::sptr rx_stream = dev->get_rx_stream(args);
+    BOOST_CHECK_EQUAL(rx_stream->get_max_num_samps(), args.spp);
+
+    stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    stream_cmd.num_samps = 10*args.spp;
+    stream_cmd.stream_now = true;
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/0/stream_cmd").set(stream_cmd);
+    std::vector<std::complex<short> > buff(1000);
+    size_t num_recvd = 0;
+    while (true){
+        rx_metadata_t md;
+        const size_t n = rx_stream->recv(&buff.front(), buff.size(), md, 1.0, true);
+        if (md.error_code != rx_metadata_t::ERROR_CODE_NONE) break;
+        BOOST_CHECK_EQUAL(n, args.spp);
+        num_recvd += n;
+        if (md.end_of_burst) break;
+    }
+    BOOST_CHECK_EQUAL(num_recvd, stream_cmd.num_samps);
+
+    //too many samples per packet are limited to the maximum
+    args.spp = dev->get_max_recv_samps_per_packet() + 1;
+    BOOST_CHECK_EQUAL(dev->get_rx_stream(args)->get_max_num_samps(), dev->get_max_recv_samps_per_packet());
+    BOOST_CHECK_EQUAL(dev->get_tx_stream(args)->get_max_num_samps(), dev->get_max_send_samps_per_packet());
+    args.spp = 32;
+    BOOST_CHECK_EQUAL(dev->get_tx_stream(args)->get_max_num_samps(), args.spp);
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_set_time_unknown_pps){
+    usrp::multi_usrp::sptr usrp = usrp::multi_usrp::make(device_addr_t("type=sim"));
+
+    //from any point of the second, the time is set at the next pps,
+    //also when the time goes back to zero from a later time
+    for (size_t i = 0; i < 3; i++){
+        const double time_set = 100.0*((i + 1)%3);
+        const time_spec_t host_start = time_spec_t::get_system_time();
+        usrp->set_time_unknown_pps(time_spec_t(time_set));
+        const time_spec_t host_done = time_spec_t::get_system_time();
+        BOOST_CHECK_EQUAL(usrp->get_time_last_pps().get_real_secs(), time_set);
+        const double time_now = usrp->get_time_now().get_real_secs();
+        BOOST_CHECK(time_now >= time_set and time_now < time_set + 1.0);
+
+        //no longer than the next pps or the one after it, when it was too near
+        BOOST_CHECK((host_done - host_start) < time_spec_t(2.2));
+        boost::this_thread::sleep(boost::posix_time::milliseconds(300));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_subdev_spec_through_tree){
+    usrp::multi_usrp::sptr usrp = usrp::multi_usrp::make(device_addr_t("type=sim"));
+    property_tree::sptr tree = usrp->get_device()->get_tree();
+
+    //the channel paths follow a subdev spec that was set around the multi usrp
+    tree->access<usrp::subdev_spec_t>(mb_path / "rx_subdev_spec").set(usrp::subdev_spec_t("A:A"));
+    const std::string name_a = usrp->get_rx_subdev_name(0);
+    tree->access<usrp::subdev_spec_t>(mb_path / "rx_subdev_spec").set(usrp::subdev_spec_t("A:B"));
+    BOOST_CHECK_EQUAL(usrp->get_rx_subdev_name(0), tree->access<std::string>(mb_path / "dboards/A/rx_frontends/B/name").get());
+    BOOST_CHECK(usrp->get_rx_subdev_name(0) != name_a);
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_recv_lookahead_stop){
+    device::sptr dev = make_sim("sim_signal=ramp,sim_pace=0,recv_lookahead=1");
+    property_tree::sptr tree = dev->get_tree();
+    stream_args_t args(io_type_t::COMPLEX_INT16);
+    rx_streamer::sptr stream = dev->get_rx_stream(args);
+
+    //the lookahead holds the next packet after a recv
+    stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    stream_cmd.stream_now = true;
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/0/stream_cmd").set(stream_cmd);
+    std::vector<std::complex<short> > buff(stream->get_max_num_samps());
+    rx_metadata_t md;
+    BOOST_CHECK(stream->recv(&buff.front(), buff.size(), md, 1.0, true) != 0);
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_NONE);
+
+    //the held packet is dropped by the stop, nothing follows it
+    tree->access<stream_cmd_t>(mb_path / "rx_dsps/0/stream_cmd").set(stream_cmd_t(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS));
+    BOOST_CHECK_EQUAL(stream->recv(&buff.front(), buff.size(), md, 0.1, true), size_t(0));
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
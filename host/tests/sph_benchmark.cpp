@@ -0,0 +1,274 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "../lib/transport/super_recv_packet_handler.hpp"
+#include "../lib/transport/super_send_packet_handler.hpp"
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+#include <complex>
+#include <vector>
+
+namespace po = boost::program_options;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * A loopback transport:
+ * Receive replays a ring of pre-built VRT frames from memory,
+ * send accepts every frame and drops it, both at unlimited rate.
+ * The ring length is a multiple of 16 so the packet counts wrap cleanly.
+ **********************************************************************/
+class loopback_mrb : public managed_recv_buffer{
+public:
+    loopback_mrb(const char *mem, size_t len): _mem(mem), _len(len){}
+    void release(void){/* NOP */}
+    sptr get_new(void){return make_managed_buffer(this);}
+private:
+    const void *get_buff(void) const{return _mem;}
+    size_t get_size(void) const{return _len;}
+    const char *_mem; size_t _len;
+};
+
+class loopback_msb : public managed_send_buffer{
+public:
+    loopback_msb(char *mem, size_t len, size_t &num_bytes): _mem(mem), _len(len), _num_bytes(num_bytes){}
+    void commit(size_t len){_num_bytes += len;}
+    sptr get_new(void){return make_managed_buffer(this);}
+private:
+    void *get_buff(void) const{return _mem;}
+    size_t get_size(void) const{return _len;}
+    char *_mem; size_t _len; size_t &_num_bytes;
+};
+
+class loopback_zero_copy : public zero_copy_if{
+public:
+    loopback_zero_copy(const uhd::otw_type_t &otw_type, size_t spp, size_t num_frames, double tick_rate, double samp_rate):
+        _frame_size((spp*otw_type.get_sample_size() + 4*vrt::max_if_hdr_words32 + 4 + 3) & ~size_t(3)),
+        _mem(num_frames*_frame_size), _next_recv(0), _next_send(0), num_sent_bytes(0)
+    {
+        vrt::if_packet_info_t ifpi;
+        ifpi.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+        ifpi.num_payload_words32 = spp*otw_type.get_sample_size()/sizeof(boost::uint32_t);
+        ifpi.sob = false; ifpi.eob = false;
+        ifpi.has_sid = true; ifpi.sid = 0;
+        ifpi.has_cid = false; ifpi.has_tlr = false;
+        ifpi.has_tsi = true; ifpi.has_tsf = true;
+        ifpi.tsi = 0; ifpi.tsf = 0;
+        for (size_t i = 0; i < num_frames; i++){
+            char *frame = &_mem[i*_frame_size];
+            ifpi.packet_count = i;
+            if (otw_type.byteorder == uhd::otw_type_t::BO_BIG_ENDIAN){
+                vrt::if_hdr_pack_be(reinterpret_cast<boost::uint32_t *>(frame), ifpi);
+            }
+            else vrt::if_hdr_pack_le(reinterpret_cast<boost::uint32_t *>(frame), ifpi);
+            //fill the payload with a ramp so the converters see real data
+            boost::uint32_t *payload = reinterpret_cast<boost::uint32_t *>(frame) + ifpi.num_header_words32;
+            for (size_t j = 0; j < ifpi.num_payload_words32; j++) payload[j] = boost::uint32_t(j*0x00010003);
+            _mrbs.push_back(loopback_mrb(frame, ifpi.num_packet_words32*sizeof(boost::uint32_t)));
+            _msbs.push_back(loopback_msb(frame, _frame_size, num_sent_bytes));
+            ifpi.tsf += boost::uint64_t(spp*tick_rate/samp_rate);
+        }
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(double){
+        loopback_mrb &mrb = _mrbs[_next_recv];
+        _next_recv = (_next_recv + 1) % _mrbs.size();
+        return mrb.get_new();
+    }
+
+    size_t get_num_recv_frames(void) const{return _mrbs.size();}
+    size_t get_recv_frame_size(void) const{return _frame_size;}
+
+    managed_send_buffer::sptr get_send_buff(double){
+        loopback_msb &msb = _msbs[_next_send];
+        _next_send = (_next_send + 1) % _msbs.size();
+        return msb.get_new();
+    }
+
+    size_t get_num_send_frames(void) const{return _msbs.size();}
+    size_t get_send_frame_size(void) const{return _frame_size;}
+
+private:
+    const size_t _frame_size;
+    std::vector<char> _mem;
+    std::vector<loopback_mrb> _mrbs;
+    std::vector<loopback_msb> _msbs;
+    size_t _next_recv, _next_send;
+public:
+    size_t num_sent_bytes;
+};
+
+/***********************************************************************
+ * Benchmark helpers
+ **********************************************************************/
+static const double tick_rate = 100e6;
+static const double samp_rate = 25e6;
+
+static uhd::io_type_t::tid_t type_to_tid(const std::string &type){
+    if (type == "fc32") return uhd::io_type_t::COMPLEX_FLOAT32;
+    if (type == "fc64") return uhd::io_type_t::COMPLEX_FLOAT64;
+    if (type == "sc16") return uhd::io_type_t::COMPLEX_INT16;
+    throw std::runtime_error("unknown type " + type);
+}
+
+static void print_row(
+    const std::string &dir, const std::string &type, size_t nchan,
+    const std::string &mode, double num_samps, double secs, size_t num_errors
+){
+    std::cout << boost::format("%-4s %-5s %5u %-10s %12.3f %10.2f %8u")
+        % dir % type % nchan % mode % (num_samps/secs/1e6) % (secs*1e9/num_samps) % num_errors << std::endl;
+}
+
+static void bench_recv(
+    const uhd::otw_type_t &otw_type, const std::string &type, size_t nchan,
+    const std::string &mode, size_t spp, size_t spb, double duration
+){
+    std::vector<boost::shared_ptr<loopback_zero_copy> > xports;
+    sph::recv_packet_handler handler(nchan);
+    handler.set_vrt_unpacker((otw_type.byteorder == uhd::otw_type_t::BO_BIG_ENDIAN)?
+        &vrt::if_hdr_unpack_be : &vrt::if_hdr_unpack_le);
+    handler.set_tick_rate(tick_rate);
+    handler.set_samp_rate(samp_rate);
+    for (size_t ch = 0; ch < nchan; ch++){
+        xports.push_back(boost::shared_ptr<loopback_zero_copy>(new loopback_zero_copy(otw_type, spp, 64, tick_rate, samp_rate)));
+        handler.set_xport_chan_get_buff(ch, boost::bind(&loopback_zero_copy::get_recv_buff, xports.back(), _1));
+    }
+    handler.set_converter(otw_type);
+
+    const uhd::io_type_t io_type(type_to_tid(type));
+    std::vector<std::vector<char> > mem(nchan, std::vector<char>(spb*io_type.size));
+    std::vector<void *> buffs;
+    for (size_t ch = 0; ch < nchan; ch++) buffs.push_back(&mem[ch].front());
+    const uhd::device::recv_mode_t recv_mode = (mode == "full_buff")?
+        uhd::device::RECV_MODE_FULL_BUFF : uhd::device::RECV_MODE_ONE_PACKET;
+
+    double num_samps = 0;
+    size_t num_errors = 0;
+    uhd::rx_metadata_t md;
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    uhd::time_spec_t elapsed;
+    do{
+        for (size_t i = 0; i < 64; i++){
+            num_samps += handler.recv(buffs, spb, md, io_type, recv_mode, 0.0);
+            if (md.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE) num_errors++;
+        }
+        elapsed = uhd::time_spec_t::get_system_time() - start;
+    } while (elapsed.get_real_secs() < duration);
+    print_row("recv", type, nchan, mode, num_samps, elapsed.get_real_secs(), num_errors);
+}
+
+static void bench_send(
+    const uhd::otw_type_t &otw_type, const std::string &type, size_t nchan,
+    const std::string &mode, size_t spp, size_t spb, double duration
+){
+    std::vector<boost::shared_ptr<loopback_zero_copy> > xports;
+    sph::send_packet_handler handler(nchan);
+    handler.set_vrt_packer((otw_type.byteorder == uhd::otw_type_t::BO_BIG_ENDIAN)?
+        &vrt::if_hdr_pack_be : &vrt::if_hdr_pack_le);
+    handler.set_tick_rate(tick_rate);
+    handler.set_samp_rate(samp_rate);
+    for (size_t ch = 0; ch < nchan; ch++){
+        xports.push_back(boost::shared_ptr<loopback_zero_copy>(new loopback_zero_copy(otw_type, spp, 64, tick_rate, samp_rate)));
+        handler.set_xport_chan_get_buff(ch, boost::bind(&loopback_zero_copy::get_send_buff, xports.back(), _1));
+    }
+    handler.set_converter(otw_type);
+    handler.set_max_samples_per_packet(spp);
+
+    const uhd::io_type_t io_type(type_to_tid(type));
+    std::vector<std::vector<char> > mem(nchan, std::vector<char>(spb*io_type.size));
+    std::vector<const void *> buffs;
+    for (size_t ch = 0; ch < nchan; ch++) buffs.push_back(&mem[ch].front());
+    const uhd::device::send_mode_t send_mode = (mode == "full_buff")?
+        uhd::device::SEND_MODE_FULL_BUFF : uhd::device::SEND_MODE_ONE_PACKET;
+
+    double num_samps = 0;
+    size_t num_errors = 0;
+    uhd::tx_metadata_t md;
+    md.has_time_spec = false;
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    uhd::time_spec_t elapsed;
+    do{
+        for (size_t i = 0; i < 64; i++){
+            const size_t num_sent = handler.send(buffs, spb, md, io_type, send_mode, 0.0);
+            if (num_sent == 0) num_errors++; //one packet mode may send less than spb
+            num_samps += num_sent;
+        }
+        elapsed = uhd::time_spec_t::get_system_time() - start;
+    } while (elapsed.get_real_secs() < duration);
+    print_row("send", type, nchan, mode, num_samps, elapsed.get_real_secs(), num_errors);
+}
+
+/***********************************************************************
+ * Run the packet handlers over the loopback transport
+ **********************************************************************/
+int main(int argc, char *argv[]){
+    std::string types, modes, otw, chans;
+    size_t spp, spb;
+    double duration;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("duration", po::value<double>(&duration)->default_value(1.0), "seconds per measurement")
+        ("types", po::value<std::string>(&types)->default_value("fc32,sc16,fc64"), "comma separated host types")
+        ("modes", po::value<std::string>(&modes)->default_value("one_packet,full_buff"), "comma separated modes")
+        ("chans", po::value<std::string>(&chans)->default_value("1,2"), "comma separated channel counts")
+        ("otw", po::value<std::string>(&otw)->default_value("sc16"), "wire format: sc16 or sc8")
+        ("spp", po::value<size_t>(&spp)->default_value(364), "samples per packet")
+        ("spb", po::value<size_t>(&spb)->default_value(0), "samples per buffer (0 for one packet)")
+        ("le", "use little endian frames (usb devices)")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Packet Handler Benchmark %s") % desc << std::endl;
+        std::cout <<
+            "    Measures the host cost of the packet handlers without hardware:\n"
+            "    header unpack and pack, channel alignment, and conversion.\n"
+            << std::endl;
+        return ~0;
+    }
+
+    uhd::otw_type_t otw_type;
+    otw_type.width = (otw == "sc8")? 8 : 16;
+    otw_type.shift = (otw == "sc8")? 8 : 0;
+    otw_type.byteorder = (vm.count("le"))? uhd::otw_type_t::BO_LITTLE_ENDIAN : uhd::otw_type_t::BO_BIG_ENDIAN;
+    if (spb == 0) spb = spp;
+
+    std::vector<std::string> type_list, mode_list, chan_list;
+    boost::split(type_list, types, boost::is_any_of(","));
+    boost::split(mode_list, modes, boost::is_any_of(","));
+    boost::split(chan_list, chans, boost::is_any_of(","));
+
+    std::cout << boost::format("%-4s %-5s %5s %-10s %12s %10s %8s")
+        % "dir" % "type" % "chans" % "mode" % "Msps/chan" % "ns/samp" % "errors" << std::endl;
+    BOOST_FOREACH(const std::string &type, type_list)
+    BOOST_FOREACH(const std::string &mode, mode_list)
+    BOOST_FOREACH(const std::string &chan, chan_list){
+        const size_t nchan = boost::lexical_cast<size_t>(chan);
+        bench_recv(otw_type, type, nchan, mode, spp, spb, duration);
+        bench_send(otw_type, type, nchan, mode, spp, spb, duration);
+    }
+    return 0;
+}
@@ -0,0 +1,389 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "../lib/transport/super_recv_packet_handler.hpp"
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+#include <complex>
+#include <vector>
+#include <deque>
+
+namespace po = boost::program_options;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * The faults, one decision per logical packet:
+ * Drops, reorders and duplicates hit one channel at a time,
+ * timestamp jumps and overflows hit every channel like a device would.
+ **********************************************************************/
+enum fault_type{
+    FAULT_DROP,
+    FAULT_REORDER,
+    FAULT_DUPLICATE,
+    FAULT_JUMP,
+    FAULT_OVERFLOW,
+    NUM_FAULTS
+};
+
+static const char *fault_names[NUM_FAULTS] = {"drop", "reorder", "duplicate", "jump", "overflow"};
+
+struct fault_params_type{
+    double rates[NUM_FAULTS]; //probability per packet
+    size_t nchan, spp;
+    size_t gap; //packets lost behind an overflow
+    long jump; //samples the timestamps jump by
+    boost::uint64_t seed;
+};
+
+static const double tick_rate = 100e6;
+static const double samp_rate = 25e6;
+static const boost::uint64_t ticks_per_samp = 4;
+static const boost::uint64_t time_base = 1 << 24; //samples, so a back jump stays positive
+
+//! A repeatable uniform number for a packet and a fault
+static boost::uint64_t hash(boost::uint64_t seed, boost::uint64_t k, boost::uint64_t salt){
+    boost::uint64_t x = seed ^ (k*0x9e3779b97f4a7c15ULL) ^ (salt << 56);
+    x = (x ^ (x >> 30))*0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27))*0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/***********************************************************************
+ * A fault injecting transport:
+ * Generates an endless stream of big endian VRT frames for a channel.
+ * Each sample holds its index in the stream (I high, Q low 16 bits),
+ * so the receiver can tell exactly which samples it was handed.
+ **********************************************************************/
+class fault_mrb : public managed_recv_buffer{
+public:
+    void release(void){/* NOP */}
+    sptr get_new(const char *mem, size_t len){_mem = mem; _len = len; return make_managed_buffer(this);}
+private:
+    const void *get_buff(void) const{return _mem;}
+    size_t get_size(void) const{return _len;}
+    const char *_mem; size_t _len;
+};
+
+class fault_zero_copy{
+public:
+    fault_zero_copy(const size_t chan, const fault_params_type &params, size_t &num_packets):
+        _chan(chan), _params(params), _num_packets(num_packets),
+        _frame_words(params.spp + vrt::max_if_hdr_words32 + 1),
+        _mem(num_ring_frames*_frame_words), _mrbs(num_ring_frames), _next(0),
+        _k(0), _packet_count(0), _jump(0)
+    {
+        for (size_t i = 0; i < NUM_FAULTS; i++) num_faults[i] = 0;
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(double){
+        while (_pending.empty()) this->plan_next();
+        const frame_spec_type spec = _pending.front();
+        _pending.pop_front();
+        _num_packets++;
+
+        //the handler holds a few frames per channel, the ring has plenty more
+        boost::uint32_t *frame = &_mem[_next*_frame_words];
+        vrt::if_packet_info_t ifpi;
+        ifpi.packet_type = (spec.message)?
+            vrt::if_packet_info_t::PACKET_TYPE_EXTENSION : vrt::if_packet_info_t::PACKET_TYPE_DATA;
+        ifpi.num_payload_words32 = (spec.message)? 1 : _params.spp;
+        ifpi.packet_count = spec.packet_count;
+        ifpi.sob = false; ifpi.eob = false;
+        ifpi.has_sid = true; ifpi.sid = boost::uint32_t(_chan);
+        ifpi.has_cid = false; ifpi.has_tlr = false;
+        ifpi.has_tsi = true; ifpi.has_tsf = true;
+        const boost::uint64_t ticks = spec.time*ticks_per_samp;
+        ifpi.tsi = boost::uint32_t(ticks/boost::uint64_t(tick_rate));
+        ifpi.tsf = ticks%boost::uint64_t(tick_rate);
+        vrt::if_hdr_pack_be(frame, ifpi);
+        boost::uint32_t *payload = frame + ifpi.num_header_words32;
+        if (spec.message){
+            const boost::uint32_t code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+            payload[0] = code | uhd::byteswap(code);
+        }
+        else for (size_t i = 0; i < _params.spp; i++){
+            payload[i] = uhd::htonx(boost::uint32_t(spec.index + i));
+        }
+        managed_recv_buffer::sptr mrb = _mrbs[_next].get_new(
+            reinterpret_cast<const char *>(frame), ifpi.num_packet_words32*sizeof(boost::uint32_t)
+        );
+        _next = (_next + 1)%num_ring_frames;
+        return mrb;
+    }
+
+    //! The faults on this channel (device wide faults on every channel)
+    size_t num_faults[NUM_FAULTS];
+
+private:
+    static const size_t num_ring_frames = 32;
+
+    struct frame_spec_type{
+        bool message;
+        size_t packet_count;
+        boost::uint64_t index; //of the first sample in the stream
+        boost::uint64_t time; //in samples
+    };
+
+    bool fault(const boost::uint64_t k, const fault_type type) const{
+        if (_params.rates[type] == 0) return false;
+        const double u = double(hash(_params.seed, k, type) >> 11)/double(1ULL << 53);
+        if (u >= _params.rates[type]) return false;
+        if (type == FAULT_JUMP or type == FAULT_OVERFLOW) return true;
+        return hash(_params.seed, k, type + NUM_FAULTS)%_params.nchan == _chan;
+    }
+
+    frame_spec_type make_data(const boost::uint64_t k){
+        frame_spec_type spec;
+        spec.message = false;
+        spec.packet_count = _packet_count;
+        _packet_count = (_packet_count + 1)%16;
+        spec.index = k*_params.spp;
+        spec.time = time_base + k*_params.spp + _jump;
+        return spec;
+    }
+
+    void plan_next(void){
+        const boost::uint64_t k = _k++;
+
+        //an overflow message, the stream resumes after the lost packets
+        if (fault(k, FAULT_OVERFLOW)){
+            frame_spec_type spec = make_data(k);
+            _packet_count = spec.packet_count; //messages are not in the data sequence
+            spec.message = true;
+            _pending.push_back(spec);
+            _k += _params.gap;
+            num_faults[FAULT_OVERFLOW]++;
+            return;
+        }
+
+        if (fault(k, FAULT_JUMP)){
+            _jump += _params.jump;
+            num_faults[FAULT_JUMP]++;
+        }
+        const frame_spec_type spec = make_data(k);
+
+        if (fault(k, FAULT_DROP)){
+            num_faults[FAULT_DROP]++;
+            return;
+        }
+        if (fault(k, FAULT_DUPLICATE)){
+            _pending.push_back(spec);
+            _pending.push_back(spec);
+            num_faults[FAULT_DUPLICATE]++;
+            return;
+        }
+        //swap with the next packet, unless a device wide fault is due there
+        if (fault(k, FAULT_REORDER) and not fault(k+1, FAULT_OVERFLOW) and not fault(k+1, FAULT_JUMP)){
+            _pending.push_back(make_data(_k++));
+            _pending.push_back(spec);
+            num_faults[FAULT_REORDER]++;
+            return;
+        }
+        _pending.push_back(spec);
+    }
+
+    const size_t _chan;
+    const fault_params_type _params;
+    size_t &_num_packets;
+    const size_t _frame_words;
+    std::vector<boost::uint32_t> _mem;
+    std::vector<fault_mrb> _mrbs;
+    size_t _next;
+    boost::uint64_t _k;
+    size_t _packet_count;
+    boost::uint64_t _jump;
+    std::deque<frame_spec_type> _pending;
+};
+
+/***********************************************************************
+ * Run the receive handler over the faults:
+ * A recovery starts at the first recv that reports an error or hands
+ * out discontinuous samples, and ends with the next recv of good data.
+ **********************************************************************/
+static boost::uint64_t sample_index(const std::complex<boost::int16_t> &samp){
+    return (boost::uint64_t(boost::uint16_t(samp.real())) << 16) | boost::uint16_t(samp.imag());
+}
+
+static double run_fault_case(const std::string &name, const fault_params_type &params, size_t num_recvs){
+    size_t num_packets = 0;
+    std::vector<boost::shared_ptr<fault_zero_copy> > xports;
+    sph::recv_packet_handler handler(params.nchan);
+    handler.set_vrt_unpacker(&vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(tick_rate);
+    handler.set_samp_rate(samp_rate);
+    for (size_t ch = 0; ch < params.nchan; ch++){
+        xports.push_back(boost::shared_ptr<fault_zero_copy>(new fault_zero_copy(ch, params, num_packets)));
+        handler.set_xport_chan_get_buff(ch, boost::bind(&fault_zero_copy::get_recv_buff, xports.back(), _1));
+        handler.set_event_counters(ch, stream_event_counters::make(false)); //no O characters in the table
+    }
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+    handler.set_converter(otw_type);
+
+    std::vector<std::vector<std::complex<boost::int16_t> > > mem(params.nchan, std::vector<std::complex<boost::int16_t> >(params.spp));
+    std::vector<void *> buffs;
+    for (size_t ch = 0; ch < params.nchan; ch++) buffs.push_back(&mem[ch].front());
+
+    size_t num_errors = 0, num_silent = 0, num_misaligned = 0, num_recoveries = 0;
+    size_t recovery_packets = 0, max_recovery_packets = 0;
+    double recovery_secs = 0, max_recovery_secs = 0;
+    boost::uint64_t num_lost = 0, num_repeated = 0, num_reported = 0, next_index = 0;
+    bool next_index_valid = false, recovering = false;
+    uhd::time_spec_t recovery_start;
+    size_t recovery_start_packets = 0;
+
+    uhd::rx_metadata_t md;
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    for (size_t i = 0; i < num_recvs; i++){
+        const uhd::time_spec_t t0 = uhd::time_spec_t::get_system_time();
+        const size_t packets0 = num_packets;
+        const size_t nsamps = handler.recv(
+            buffs, params.spp, md, uhd::io_type_t::COMPLEX_INT16, uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        const uhd::time_spec_t t1 = uhd::time_spec_t::get_system_time();
+
+        bool fault = md.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE;
+        if (fault) num_errors++;
+        if (not fault and nsamps != 0){
+            const boost::uint64_t index = sample_index(mem[0][0]);
+            for (size_t ch = 1; ch < params.nchan; ch++){
+                if (sample_index(mem[ch][0]) != index) num_misaligned++;
+            }
+            num_reported += md.num_samps_lost;
+            if (next_index_valid and index != next_index){
+                if (index > next_index) num_lost += index - next_index;
+                else num_repeated += next_index - index;
+                if (not recovering) num_silent++; //no error told of the fault
+                fault = true;
+            }
+            next_index = index + nsamps;
+            next_index_valid = true;
+        }
+
+        if (fault and not recovering){
+            recovering = true;
+            recovery_start = t0;
+            recovery_start_packets = packets0;
+        }
+        //good data ends the recovery, unless it is the discontinuous data itself
+        if (recovering and md.error_code == uhd::rx_metadata_t::ERROR_CODE_NONE and nsamps != 0){
+            const double secs = (t1 - recovery_start).get_real_secs();
+            const size_t packets = num_packets - recovery_start_packets;
+            recovery_secs += secs;
+            recovery_packets += packets;
+            max_recovery_secs = std::max(max_recovery_secs, secs);
+            max_recovery_packets = std::max(max_recovery_packets, packets);
+            num_recoveries++;
+            recovering = false;
+        }
+    }
+    const double secs = (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+
+    size_t num_faults = 0;
+    for (size_t f = 0; f < NUM_FAULTS; f++){
+        if (f == FAULT_JUMP or f == FAULT_OVERFLOW) num_faults += xports.front()->num_faults[f];
+        else for (size_t ch = 0; ch < params.nchan; ch++) num_faults += xports[ch]->num_faults[f];
+    }
+
+    const double per_fault = (num_faults == 0)? 0.0 : 1.0/num_faults;
+    const double per_recovery = (num_recoveries == 0)? 0.0 : 1.0/num_recoveries;
+    std::cout << boost::format("%-10s %5u %7u %7u %7u %10.1f %10.1f %10.1f %7u %10.2f %10.2f %8.1f %8u %8.1f")
+        % name % params.nchan % num_faults % num_errors % num_silent
+        % (num_lost*per_fault) % (num_repeated*per_fault) % (num_reported*per_fault) % num_misaligned
+        % (recovery_secs*per_recovery*1e6) % (max_recovery_secs*1e6)
+        % (recovery_packets*per_recovery) % max_recovery_packets % (secs*1e9/num_packets) << std::endl;
+    return double(max_recovery_packets);
+}
+
+/***********************************************************************
+ * Run each fault on its own, then all of them together
+ **********************************************************************/
+int main(int argc, char *argv[]){
+    std::string faults, chans;
+    size_t spp, gap, num_recvs, max_recovery;
+    double rate;
+    long jump;
+    boost::uint64_t seed;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("faults", po::value<std::string>(&faults)->default_value("none,drop,reorder,duplicate,jump,overflow,mixed"), "comma separated faults")
+        ("chans", po::value<std::string>(&chans)->default_value("1,2"), "comma separated channel counts")
+        ("rate", po::value<double>(&rate)->default_value(0.001), "probability of a fault per packet")
+        ("recvs", po::value<size_t>(&num_recvs)->default_value(200000), "number of recv calls per measurement")
+        ("spp", po::value<size_t>(&spp)->default_value(364), "samples per packet")
+        ("gap", po::value<size_t>(&gap)->default_value(16), "packets lost behind an overflow message")
+        ("jump", po::value<long>(&jump)->default_value(-1000), "samples the timestamps jump by")
+        ("seed", po::value<boost::uint64_t>(&seed)->default_value(1), "seed of the fault pattern")
+        ("max_recovery", po::value<size_t>(&max_recovery)->default_value(0), "fail when a recovery takes more packets (0 for no limit)")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Packet Handler Fault Benchmark %s") % desc << std::endl;
+        std::cout <<
+            "    Measures how the receive packet handler recovers from faults\n"
+            "    injected into a synthetic transport: the samples lost per fault,\n"
+            "    and the time and packets it takes to hand out aligned data again.\n"
+            << std::endl;
+        return ~0;
+    }
+
+    std::vector<std::string> fault_list, chan_list;
+    boost::split(fault_list, faults, boost::is_any_of(","));
+    boost::split(chan_list, chans, boost::is_any_of(","));
+
+    std::cout << boost::format("%-10s %5s %7s %7s %7s %10s %10s %10s %7s %10s %10s %8s %8s %8s")
+        % "fault" % "chans" % "faults" % "errors" % "silent" % "lost/flt" % "dup/flt" % "rprt/flt"
+        % "misalgn" % "recov us" % "max us" % "recov pk" % "max pk" % "ns/pkt" << std::endl;
+    bool failed = false;
+    BOOST_FOREACH(const std::string &fault, fault_list)
+    BOOST_FOREACH(const std::string &chan, chan_list){
+        fault_params_type params;
+        params.nchan = boost::lexical_cast<size_t>(chan);
+        params.spp = spp;
+        params.gap = gap;
+        params.jump = jump;
+        params.seed = seed;
+        bool known = (fault == "none" or fault == "mixed");
+        for (size_t f = 0; f < NUM_FAULTS; f++){
+            params.rates[f] = (fault == "mixed" or fault == fault_names[f])? rate : 0.0;
+            known = known or fault == fault_names[f];
+        }
+        if (not known) throw std::runtime_error("unknown fault " + fault);
+        const double max_packets = run_fault_case(fault, params, num_recvs);
+        if (max_recovery != 0 and max_packets > max_recovery) failed = true;
+    }
+
+    if (failed){
+        std::cout << boost::format("A recovery took more than %u packets") % max_recovery << std::endl;
+        return 1;
+    }
+    return 0;
+}
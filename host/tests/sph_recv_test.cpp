@@ -22,6 +22,7 @@
 #include <complex>
 #include <vector>
 #include <list>
+#include <utility>
 
 #define BOOST_CHECK_TS_CLOSE(a, b) \
     BOOST_CHECK_CLOSE((a).get_real_secs(), (b).get_real_secs(), 0.001)
@@ -48,18 +49,27 @@ public:
         //NOP
     }
 
-    sptr get_new(boost::shared_array<char> mem, size_t len){
+    sptr get_new(boost::shared_array<char> mem, size_t len, const bool has_stamp = false, const uhd::time_spec_t &stamp = uhd::time_spec_t(0.0)){
         _mem = mem;
         _len = len;
+        _has_stamp = has_stamp;
+        _stamp = stamp;
         return make_managed_buffer(this);
     }
 
+    bool get_recv_timestamp(uhd::time_spec_t &time) const{
+        time = _stamp;
+        return _has_stamp;
+    }
+
 private:
     const void *get_buff(void) const{return _mem.get();}
     size_t get_size(void) const{return _len;}
 
     boost::shared_array<char> _mem;
     size_t _len;
+    bool _has_stamp;
+    uhd::time_spec_t _stamp;
 };
 
 /***********************************************************************
@@ -69,6 +79,13 @@ class dummy_recv_xport_class{
 public:
     dummy_recv_xport_class(const uhd::otw_type_t &otw_type){
         _otw_type = otw_type;
+        _has_stamp = false;
+    }
+
+    //! Stamp the packets pushed from now on with a receive timestamp
+    void set_recv_timestamp(const bool has_stamp, const uhd::time_spec_t &stamp = uhd::time_spec_t(0.0)){
+        _has_stamp = has_stamp;
+        _stamp = stamp;
     }
 
     void push_back_packet(
@@ -85,22 +102,29 @@ public:
         }
         (reinterpret_cast<boost::uint32_t *>(_mems.back().get()) + ifpi.num_header_words32)[0] = optional_msg_word | uhd::byteswap(optional_msg_word);
         _lens.push_back(ifpi.num_packet_words32*sizeof(boost::uint32_t));
+        _stamps.push_back(std::make_pair(_has_stamp, _stamp));
     }
 
     uhd::transport::managed_recv_buffer::sptr get_recv_buff(double){
         if (_mems.empty()) return uhd::transport::managed_recv_buffer::sptr(); //timeout
         _mrbs.push_back(dummy_mrb());
-        uhd::transport::managed_recv_buffer::sptr mrb = _mrbs.back().get_new(_mems.front(), _lens.front());
+        uhd::transport::managed_recv_buffer::sptr mrb = _mrbs.back().get_new(
+            _mems.front(), _lens.front(), _stamps.front().first, _stamps.front().second
+        );
         _mems.pop_front();
         _lens.pop_front();
+        _stamps.pop_front();
         return mrb;
     }
 
 private:
     std::list<boost::shared_array<char> > _mems;
     std::list<size_t> _lens;
+    std::list<std::pair<bool, uhd::time_spec_t> > _stamps;
     std::list<dummy_mrb> _mrbs; //list means no-realloc
     uhd::otw_type_t _otw_type;
+    bool _has_stamp;
+    uhd::time_spec_t _stamp;
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -162,6 +186,7 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_normal){
         BOOST_CHECK(metadata.has_time_spec);
         BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, num_accum_samps, SAMP_RATE));
         BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+        BOOST_CHECK(not metadata.has_recv_timestamp);
         num_accum_samps += num_samps_ret;
     }
 
@@ -177,6 +202,79 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_normal){
     }
 }
 
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_recv_timestamp){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_recv_xport_class dummy_recv_xport(otw_type);
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 10;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 6;
+
+    //the transport stamps the first half of the packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        if (i < NUM_PKTS_TO_TEST/2) dummy_recv_xport.set_recv_timestamp(true, uhd::time_spec_t(1000.0 + i));
+        else dummy_recv_xport.set_recv_timestamp(false);
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(otw_type);
+
+    //check that each packet carries its own stamp, a fragment keeps its packet's stamp
+    std::vector<std::complex<float> > buff(5);
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "stamp check " << i << std::endl;
+        for (size_t frag = 0; frag < 2; frag++){
+            handler.recv(
+                &buff.front(), buff.size(), metadata,
+                uhd::io_type_t::COMPLEX_FLOAT32,
+                uhd::device::RECV_MODE_ONE_PACKET, 1.0
+            );
+            BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+            BOOST_CHECK_EQUAL(metadata.has_recv_timestamp, i < NUM_PKTS_TO_TEST/2);
+            if (metadata.has_recv_timestamp){
+                BOOST_CHECK_TS_CLOSE(metadata.recv_timestamp, uhd::time_spec_t(1000.0 + i));
+            }
+        }
+    }
+
+    //a timeout has no stamp
+    handler.recv(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::RECV_MODE_ONE_PACKET, 1.0
+    );
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    BOOST_CHECK(not metadata.has_recv_timestamp);
+}
+
 ////////////////////////////////////////////////////////////////////////
 BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_sequence_error){
 ////////////////////////////////////////////////////////////////////////
@@ -222,6 +320,10 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_sequence_error){
     handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
     handler.set_converter(otw_type);
 
+    //count the lost samples without printing
+    uhd::transport::stream_event_counters::sptr counters = uhd::transport::stream_event_counters::make(false);
+    handler.set_event_counters(0, counters);
+
     //check the received packets
     size_t num_accum_samps = 0;
     std::vector<std::complex<float> > buff(20);
@@ -246,8 +348,12 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_sequence_error){
             BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, num_accum_samps, SAMP_RATE));
             BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
             num_accum_samps += num_samps_ret;
+
+            //the packet after the gap counts the samples of the lost packet
+            BOOST_CHECK_EQUAL(metadata.num_samps_lost, size_t((i == NUM_PKTS_TO_TEST/2 + 1)? 10 + (i-1)%10 : 0));
         }
     }
+    BOOST_CHECK_EQUAL(counters->get_count(uhd::transport::stream_event_counters::EVENT_LOST_SAMPS), size_t(10 + (NUM_PKTS_TO_TEST/2)%10));
 
     //subsequent receives should be a timeout
     for (size_t i = 0; i < 3; i++){
@@ -261,6 +367,84 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_sequence_error){
     }
 }
 
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_full_buff_metadata_array){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_recv_xport_class dummy_recv_xport(otw_type);
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 10;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 6;
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        if (i != NUM_PKTS_TO_TEST/2){ //simulate a lost packet
+            dummy_recv_xport.push_back_packet(ifpi);
+        }
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(otw_type);
+
+    //one call receives every packet and continues past the overflow
+    std::vector<std::complex<float> > buff(50);
+    uhd::device::recv_metadata_array_type metadata_array;
+    size_t num_samps_ret = handler.recv_full_buff(
+        &buff.front(), buff.size(), metadata_array,
+        uhd::io_type_t::COMPLEX_FLOAT32, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_samps_ret, buff.size());
+    BOOST_REQUIRE_EQUAL(metadata_array.size(), NUM_PKTS_TO_TEST);
+
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        const uhd::device::recv_packet_metadata_t &entry = metadata_array[i];
+        const size_t packet_offset = 10*((i > NUM_PKTS_TO_TEST/2)? i-1 : i);
+        BOOST_CHECK_EQUAL(entry.offset, packet_offset);
+        if (i == NUM_PKTS_TO_TEST/2){
+            BOOST_CHECK_EQUAL(entry.metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+            continue;
+        }
+        BOOST_CHECK_EQUAL(entry.metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(entry.metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(entry.metadata.time_spec, uhd::time_spec_t(0, 10*i, SAMP_RATE));
+    }
+
+    //a subsequent receive ends with a timeout
+    num_samps_ret = handler.recv_full_buff(
+        &buff.front(), buff.size(), metadata_array,
+        uhd::io_type_t::COMPLEX_FLOAT32, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_samps_ret, 0);
+    BOOST_REQUIRE_EQUAL(metadata_array.size(), 1);
+    BOOST_CHECK_EQUAL(metadata_array.back().metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
+
 ////////////////////////////////////////////////////////////////////////
 BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_inline_message){
 ////////////////////////////////////////////////////////////////////////
@@ -316,6 +500,10 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_inline_message){
     overflow_handler_type overflow_handler;
     handler.set_overflow_handler(0, boost::bind(&overflow_handler_type::handle, &overflow_handler));
 
+    //count the events without printing
+    uhd::transport::stream_event_counters::sptr counters = uhd::transport::stream_event_counters::make(false);
+    handler.set_event_counters(0, counters);
+
     //check the received packets
     size_t num_accum_samps = 0;
     std::vector<std::complex<float> > buff(20);
@@ -343,6 +531,8 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_inline_message){
             BOOST_REQUIRE(metadata.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
             BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, num_accum_samps, SAMP_RATE));
             BOOST_CHECK_EQUAL(overflow_handler.num_overflow, size_t(1));
+            BOOST_CHECK_EQUAL(counters->get_count(uhd::transport::stream_event_counters::EVENT_OVERFLOW), size_t(1));
+            BOOST_CHECK_EQUAL(counters->get_count(uhd::transport::stream_event_counters::EVENT_LATE_COMMAND), size_t(0));
         }
     }
 
@@ -631,6 +821,110 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_time_error){
     }
 }
 
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_overflow_realign){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 10;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NUM_SAMPS_PER_BUFF = 20;
+    static const size_t NCHANNELS = 2;
+    static const size_t TICKS_PER_PKT = 10*size_t(TICK_RATE/SAMP_RATE);
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class(otw_type));
+
+    //channel 0 overflows a third of the way in, and the device resumes it a third later,
+    //channel 1 streams on, so its packets in between can never be aligned
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        ifpi.packet_count = 0;
+        for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+            ifpi.tsf = i*TICKS_PER_PKT;
+            if (ch == 0 and i == NUM_PKTS_TO_TEST/3){
+                ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_EXTENSION;
+                ifpi.num_payload_words32 = 1;
+                dummy_recv_xports[ch].push_back_packet(ifpi, uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+                ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+                ifpi.num_payload_words32 = 10;
+            }
+            if (ch == 0 and i >= NUM_PKTS_TO_TEST/3 and i < 2*NUM_PKTS_TO_TEST/3) continue;
+            dummy_recv_xports[ch].push_back_packet(ifpi);
+            ifpi.packet_count++;
+        }
+    }
+
+    //create the super receive packet handler,
+    //the threshold is below the number of packets to drop on channel 1
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+    }
+    handler.set_converter(otw_type);
+    handler.set_alignment_failure_threshold(2);
+
+    //check the received packets
+    std::vector<std::complex<float> > mem(NUM_SAMPS_PER_BUFF*NCHANNELS);
+    std::vector<std::complex<float> *> buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        if (i >= NUM_PKTS_TO_TEST/3 and i < 2*NUM_PKTS_TO_TEST/3) continue;
+        if (i == 2*NUM_PKTS_TO_TEST/3){
+            handler.recv(
+                buffs, NUM_SAMPS_PER_BUFF, metadata,
+                uhd::io_type_t::COMPLEX_FLOAT32,
+                uhd::device::RECV_MODE_ONE_PACKET, 1.0
+            );
+            std::cout << "metadata.error_code " << metadata.error_code << std::endl;
+            BOOST_REQUIRE(metadata.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+            BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, (NUM_PKTS_TO_TEST/3)*TICKS_PER_PKT, TICK_RATE));
+        }
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata,
+            uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, i*TICKS_PER_PKT, TICK_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, size_t(10));
+        BOOST_CHECK_EQUAL(metadata.num_samps_lost, size_t((i == 2*NUM_PKTS_TO_TEST/3)? 10*NUM_PKTS_TO_TEST/3 : 0));
+    }
+
+    //subsequent receives should be a timeout
+    for (size_t i = 0; i < 3; i++){
+        std::cout << "timeout check " << i << std::endl;
+        handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata,
+            uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////
 BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_fragment){
 ////////////////////////////////////////////////////////////////////////
@@ -730,3 +1024,746 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_fragment){
     }
 
 }
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_view){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NUM_SAMPS_PER_BUFF = 5;
+    static const size_t NCHANNELS = 4;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class(otw_type));
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            dummy_recv_xports[ch].push_back_packet(ifpi);
+        }
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+    }
+    handler.set_converter(otw_type);
+
+    //check the received packets: odd packets start with a copying recv
+    size_t num_accum_samps = 0;
+    std::vector<std::complex<float> > mem(NUM_SAMPS_PER_BUFF*NCHANNELS);
+    std::vector<std::complex<float> *> buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata;
+    uhd::device::recv_view_t view;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t fragment_offset = 0;
+        if (i%2 == 1){
+            fragment_offset = handler.recv(
+                buffs, NUM_SAMPS_PER_BUFF, metadata,
+                uhd::io_type_t::COMPLEX_FLOAT32,
+                uhd::device::RECV_MODE_ONE_PACKET, 1.0
+            );
+            BOOST_CHECK_EQUAL(fragment_offset, NUM_SAMPS_PER_BUFF);
+            BOOST_CHECK(metadata.more_fragments);
+            num_accum_samps += fragment_offset;
+        }
+
+        size_t num_samps_ret = handler.recv_view(view, 1.0);
+        BOOST_CHECK_EQUAL(view.metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(not view.metadata.more_fragments);
+        BOOST_CHECK_EQUAL(view.metadata.fragment_offset, fragment_offset);
+        BOOST_CHECK(view.metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(view.metadata.time_spec, uhd::time_spec_t(0, num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10 - fragment_offset);
+        BOOST_CHECK_EQUAL(view.nsamps, num_samps_ret);
+        BOOST_CHECK_EQUAL(view.item_size, sizeof(boost::uint32_t));
+        BOOST_REQUIRE_EQUAL(view.payloads.size(), NCHANNELS);
+        BOOST_REQUIRE_EQUAL(view.frames.size(), NCHANNELS);
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            //the payload points into the frame, the remainder ends with it
+            const char *frame_begin = view.frames[ch]->cast<const char *>();
+            const char *payload = reinterpret_cast<const char *>(view.payloads[ch]);
+            BOOST_CHECK(payload > frame_begin);
+            BOOST_CHECK(payload + num_samps_ret*sizeof(boost::uint32_t) == frame_begin + view.frames[ch]->size());
+        }
+        view.release();
+        num_accum_samps += num_samps_ret;
+    }
+
+    //subsequent receives should be a timeout
+    for (size_t i = 0; i < 3; i++){
+        std::cout << "timeout check " << i << std::endl;
+        BOOST_CHECK_EQUAL(handler.recv_view(view, 1.0), size_t(0));
+        BOOST_CHECK_EQUAL(view.metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+        BOOST_CHECK(view.frames.empty());
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_convert_threads){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NUM_SAMPS_PER_BUFF = 20;
+    static const size_t NCHANNELS = 4;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class(otw_type));
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            dummy_recv_xports[ch].push_back_packet(ifpi, boost::uint32_t(i*NCHANNELS + ch));
+        }
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //the copies share the packet memory: one handler converts in series
+    std::vector<dummy_recv_xport_class> serial_recv_xports(dummy_recv_xports);
+
+    //create the super receive packet handlers
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS), serial_handler(NCHANNELS);
+    handler.set_convert_threads(2);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+        serial_handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &serial_recv_xports[ch], _1));
+    }
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_converter(otw_type);
+    serial_handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    serial_handler.set_tick_rate(TICK_RATE);
+    serial_handler.set_samp_rate(SAMP_RATE);
+    serial_handler.set_converter(otw_type);
+
+    //check the received packets against the serial conversion
+    size_t num_accum_samps = 0;
+    std::vector<std::complex<boost::int16_t> > mem(NUM_SAMPS_PER_BUFF*NCHANNELS), serial_mem(mem.size());
+    std::vector<std::complex<boost::int16_t> *> buffs(NCHANNELS), serial_buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+        serial_buffs[ch] = &serial_mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata, serial_metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata,
+            uhd::io_type_t::COMPLEX_INT16,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        serial_handler.recv(
+            serial_buffs, NUM_SAMPS_PER_BUFF, serial_metadata,
+            uhd::io_type_t::COMPLEX_INT16,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                buffs[ch], buffs[ch] + num_samps_ret,
+                serial_buffs[ch], serial_buffs[ch] + num_samps_ret
+            );
+        }
+        num_accum_samps += num_samps_ret;
+    }
+
+    //subsequent receives should be a timeout
+    for (size_t i = 0; i < 3; i++){
+        std::cout << "timeout check " << i << std::endl;
+        handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata,
+            uhd::io_type_t::COMPLEX_INT16,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    }
+}
+
+/***********************************************************************
+ * A receive call for a thread other than the owner
+ **********************************************************************/
+static void recv_from_other_thread(
+    uhd::transport::sph::recv_packet_handler &handler, bool &caught
+){
+    std::vector<std::complex<float> > buff(20);
+    uhd::rx_metadata_t metadata;
+    try{
+        handler.recv(
+            &buff.front(), buff.size(), metadata,
+            uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::RECV_MODE_ONE_PACKET, 0.0
+        );
+    }
+    catch(const uhd::assertion_error &){
+        caught = true;
+    }
+}
+
+static void lock_from_other_thread(
+    uhd::transport::sph::recv_packet_handler &handler, bool &caught
+){
+    try{
+        boost::mutex::scoped_lock lock = handler.get_scoped_lock();
+    }
+    catch(const uhd::runtime_error &){
+        caught = true;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_single_owner){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_recv_xport_class dummy_recv_xport(otw_type);
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler without the per-call mutex
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(otw_type);
+    handler.set_single_owner(true);
+
+    //check the received packets
+    size_t num_accum_samps = 0;
+    std::vector<std::complex<float> > buff(20);
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv(
+            &buff.front(), buff.size(), metadata,
+            uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+        num_accum_samps += num_samps_ret;
+    }
+
+    //a call from another thread is caught
+    bool caught = false;
+    boost::thread other(boost::bind(&recv_from_other_thread, boost::ref(handler), boost::ref(caught)));
+    other.join();
+    BOOST_CHECK(caught);
+
+    //reconfiguration from another thread is caught, the owner may reconfigure
+    caught = false;
+    boost::thread other_lock(boost::bind(&lock_from_other_thread, boost::ref(handler), boost::ref(caught)));
+    other_lock.join();
+    BOOST_CHECK(caught);
+    {
+        boost::mutex::scoped_lock lock = handler.get_scoped_lock();
+        handler.set_samp_rate(SAMP_RATE);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_lookahead){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_recv_xport_class dummy_recv_xport(otw_type);
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(otw_type);
+    handler.set_lookahead(true);
+
+    //check the received packets
+    size_t num_accum_samps = 0;
+    std::vector<std::complex<float> > buff(20);
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv(
+            &buff.front(), buff.size(), metadata,
+            uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(not metadata.more_fragments);
+        BOOST_CHECK(metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+        num_accum_samps += num_samps_ret;
+    }
+
+    //subsequent receives should be a timeout
+    for (size_t i = 0; i < 3; i++){
+        std::cout << "timeout check " << i << std::endl;
+        handler.recv(
+            &buff.front(), buff.size(), metadata,
+            uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_resampler){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_recv_xport_class dummy_recv_xport(otw_type);
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 20;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const double HOST_RATE = 7.5e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(otw_type);
+
+    uhd::transport::resampler_config_t config;
+    config.rate = HOST_RATE;
+    BOOST_CHECK_CLOSE(handler.set_resampler(config).rate, HOST_RATE, 1e-9);
+    const double delay = uhd::transport::polyphase_resampler::make(
+        SAMP_RATE, HOST_RATE, config.taps_per_phase, config.max_phases
+    )->get_delay()/SAMP_RATE;
+
+    //the outputs are timed at the host rate, less the filter delay
+    size_t num_accum_samps = 0;
+    std::vector<std::complex<float> > buff(100);
+    uhd::rx_metadata_t metadata;
+    while (true){
+        size_t num_samps_ret = handler.recv(
+            &buff.front(), buff.size(), metadata,
+            uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::RECV_MODE_FULL_BUFF, 1.0
+        );
+        if (num_samps_ret == 0) break;
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(
+            metadata.time_spec + uhd::time_spec_t(delay),
+            uhd::time_spec_t(0, num_accum_samps, HOST_RATE)
+        );
+        num_accum_samps += num_samps_ret;
+    }
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+
+    //all but the filter length of the input was resampled
+    const size_t num_input = NUM_PKTS_TO_TEST*ifpi.num_payload_words32;
+    BOOST_CHECK(num_accum_samps <= num_input*3/4);
+    BOOST_CHECK(num_accum_samps >= (num_input - config.taps_per_phase)*3/4);
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_timed_rate_change){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_recv_xport_class dummy_recv_xport(otw_type);
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 10;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const double NEW_SAMP_RATE = 5e6;
+    static const size_t NUM_PKTS_TO_TEST = 10;
+    static const size_t CHANGE_PKT = 5;
+
+    //generate a bunch of packets, at the new rate from the change on
+    uhd::time_spec_t change_time;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        if (i == CHANGE_PKT) change_time = uhd::time_spec_t(0, ifpi.tsf, TICK_RATE);
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/((i < CHANGE_PKT)? SAMP_RATE : NEW_SAMP_RATE));
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(otw_type);
+    handler.set_samp_rate_at(change_time, NEW_SAMP_RATE);
+
+    //a full buffer receive ends right before the change
+    std::vector<std::complex<float> > buff(1000);
+    uhd::rx_metadata_t metadata;
+    size_t num_samps_ret = handler.recv(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::RECV_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK_EQUAL(num_samps_ret, CHANGE_PKT*10);
+    BOOST_CHECK(not metadata.has_rate_change);
+    BOOST_CHECK_CLOSE(metadata.samp_rate, SAMP_RATE, 1e-9);
+    BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0.0));
+
+    //the next receive starts at the change
+    num_samps_ret = handler.recv(
+        &buff.front(), 15, metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::RECV_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK_EQUAL(num_samps_ret, size_t(15));
+    BOOST_CHECK(metadata.has_rate_change);
+    BOOST_CHECK_CLOSE(metadata.samp_rate, NEW_SAMP_RATE, 1e-9);
+    BOOST_CHECK_TS_CLOSE(metadata.time_spec, change_time);
+
+    //the fragments after the change are timed at the new rate
+    num_samps_ret = handler.recv(
+        &buff.front(), 15, metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::RECV_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK_EQUAL(num_samps_ret, size_t(15));
+    BOOST_CHECK(not metadata.has_rate_change);
+    BOOST_CHECK_CLOSE(metadata.samp_rate, NEW_SAMP_RATE, 1e-9);
+    BOOST_CHECK_TS_CLOSE(metadata.time_spec, change_time + uhd::time_spec_t(0, 15, NEW_SAMP_RATE));
+}
+
+/***********************************************************************
+ * A receive hook that decimates by two and counts its calls
+ **********************************************************************/
+struct decim_hook_type{
+    decim_hook_type(const size_t nchans): num_calls(nchans, 0){}
+
+    size_t hook(const size_t chan, void *buff, const size_t nsamps, const uhd::rx_metadata_t &){
+        std::complex<boost::int16_t> *samps = reinterpret_cast<std::complex<boost::int16_t> *>(buff);
+        for (size_t i = 0; i < nsamps/2; i++) samps[i] = samps[i*2];
+        num_calls[chan]++;
+        return nsamps/2;
+    }
+
+    std::vector<size_t> num_calls; //one per channel, the channels may run in parallel
+};
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_hook){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 6;
+
+    dummy_recv_xport_class dummy_recv_xport(otw_type);
+
+    //packets of 10 samples, the first sample of each marks the packet
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10;
+        dummy_recv_xport.push_back_packet(ifpi, boost::uint32_t(i + 1));
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(otw_type);
+    decim_hook_type decim_hook(1);
+    handler.set_recv_hook(boost::bind(&decim_hook_type::hook, &decim_hook, _1, _2, _3, _4));
+
+    //a full buffer holds the kept samples of the whole packets that fit
+    std::vector<std::complex<boost::int16_t> > buff(25);
+    uhd::rx_metadata_t metadata;
+    const size_t num_samps_ret = handler.recv(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::RECV_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0.0));
+    BOOST_CHECK_EQUAL(num_samps_ret, size_t(20));
+    BOOST_CHECK_EQUAL(decim_hook.num_calls[0], size_t(4));
+    for (size_t i = 0; i < 4; i++){
+        const std::complex<boost::int16_t> mark = buff[i*5];
+        BOOST_CHECK_EQUAL(mark.real() + mark.imag(), boost::int16_t(257*(i + 1)));
+    }
+
+    //without the hook, the packets are whole again
+    handler.set_recv_hook(uhd::transport::sph::recv_hook_type());
+    BOOST_CHECK_EQUAL(handler.recv(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_INT16,
+        uhd::device::RECV_MODE_ONE_PACKET, 1.0
+    ), size_t(10));
+    BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t(0, 40, SAMP_RATE));
+    BOOST_CHECK_EQUAL(decim_hook.num_calls[0], size_t(4));
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_hook_convert_threads){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NUM_SAMPS_PER_BUFF = 20;
+    static const size_t NCHANNELS = 4;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class(otw_type));
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            dummy_recv_xports[ch].push_back_packet(ifpi, boost::uint32_t(i*NCHANNELS + ch));
+        }
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //the copies share the packet memory: one handler hooks in series
+    std::vector<dummy_recv_xport_class> serial_recv_xports(dummy_recv_xports);
+
+    //create the super receive packet handlers
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS), serial_handler(NCHANNELS);
+    handler.set_convert_threads(2);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+        serial_handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &serial_recv_xports[ch], _1));
+    }
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_converter(otw_type);
+    serial_handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    serial_handler.set_tick_rate(TICK_RATE);
+    serial_handler.set_samp_rate(SAMP_RATE);
+    serial_handler.set_converter(otw_type);
+    decim_hook_type decim_hook(NCHANNELS), serial_decim_hook(NCHANNELS);
+    handler.set_recv_hook(boost::bind(&decim_hook_type::hook, &decim_hook, _1, _2, _3, _4));
+    serial_handler.set_recv_hook(boost::bind(&decim_hook_type::hook, &serial_decim_hook, _1, _2, _3, _4));
+
+    //check the received packets against the serial hooks
+    std::vector<std::complex<boost::int16_t> > mem(NUM_SAMPS_PER_BUFF*NCHANNELS), serial_mem(mem.size());
+    std::vector<std::complex<boost::int16_t> *> buffs(NCHANNELS), serial_buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+        serial_buffs[ch] = &serial_mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata, serial_metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata,
+            uhd::io_type_t::COMPLEX_INT16,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        serial_handler.recv(
+            serial_buffs, NUM_SAMPS_PER_BUFF, serial_metadata,
+            uhd::io_type_t::COMPLEX_INT16,
+            uhd::device::RECV_MODE_ONE_PACKET, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK_EQUAL(num_samps_ret, (10 + i%10)/2);
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                buffs[ch], buffs[ch] + num_samps_ret,
+                serial_buffs[ch], serial_buffs[ch] + num_samps_ret
+            );
+        }
+    }
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        BOOST_CHECK_EQUAL(decim_hook.num_calls[ch], NUM_PKTS_TO_TEST);
+        BOOST_CHECK_EQUAL(serial_decim_hook.num_calls[ch], NUM_PKTS_TO_TEST);
+    }
+}
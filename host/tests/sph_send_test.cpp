@@ -81,6 +81,10 @@ public:
         return mrb;
     }
 
+    bool empty(void) const{
+        return _mems.empty();
+    }
+
 private:
     std::list<boost::shared_array<char> > _mems;
     std::list<size_t> _lens;
@@ -147,6 +151,65 @@ BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_one_packet_mode){
     }
 }
 
+//! Get a send buffer from the transport unless it would block
+static uhd::transport::managed_send_buffer::sptr get_send_buff_unless_blocked(
+    dummy_send_xport_class *xport, const bool *would_block, double timeout
+){
+    if (*would_block) return uhd::transport::managed_send_buffer::sptr();
+    return xport->get_send_buff(timeout);
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_send_two_channel_would_block){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_send_xport_class dummy_send_xport0(otw_type), dummy_send_xport1(otw_type);
+    bool would_block0 = false, would_block1 = true;
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(2);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(100e6);
+    handler.set_samp_rate(10e6);
+    handler.set_xport_chan_get_buff(0, boost::bind(&get_send_buff_unless_blocked, &dummy_send_xport0, &would_block0, _1));
+    handler.set_xport_chan_get_buff(1, boost::bind(&get_send_buff_unless_blocked, &dummy_send_xport1, &would_block1, _1));
+    handler.set_converter(otw_type);
+    handler.set_max_samples_per_packet(20);
+
+    std::vector<std::complex<float> > buff0(20), buff1(20);
+    std::vector<void *> buffs;
+    buffs.push_back(&buff0.front());
+    buffs.push_back(&buff1.front());
+    uhd::tx_metadata_t metadata;
+
+    //the second channel would block: nothing is sent on either channel
+    BOOST_CHECK_EQUAL(handler.send(
+        buffs, 15, metadata, uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_ONE_PACKET, 0.0
+    ), 0);
+    BOOST_CHECK(dummy_send_xport1.empty());
+
+    //once it unblocks, the held buffer of the first channel is used
+    would_block1 = false;
+    BOOST_CHECK_EQUAL(handler.send(
+        buffs, 15, metadata, uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_ONE_PACKET, 0.0
+    ), 15);
+
+    uhd::transport::vrt::if_packet_info_t ifpi0, ifpi1;
+    dummy_send_xport0.pop_front_packet(ifpi0);
+    dummy_send_xport1.pop_front_packet(ifpi1);
+    BOOST_CHECK_EQUAL(ifpi0.num_payload_words32, 15);
+    BOOST_CHECK_EQUAL(ifpi1.num_payload_words32, 15);
+    BOOST_CHECK_EQUAL(ifpi0.packet_count, ifpi1.packet_count);
+    BOOST_CHECK(dummy_send_xport0.empty());
+    BOOST_CHECK(dummy_send_xport1.empty());
+}
+
 ////////////////////////////////////////////////////////////////////////
 BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_full_buffer_mode){
 ////////////////////////////////////////////////////////////////////////
@@ -193,6 +256,7 @@ BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_full_buffer_mode){
         std::cout << "data check " << i << std::endl;
         dummy_send_xport.pop_front_packet(ifpi);
         BOOST_CHECK_EQUAL(ifpi.num_payload_words32, 20);
+        BOOST_CHECK_EQUAL(ifpi.packet_count, i%16);
         BOOST_CHECK(ifpi.has_tsi);
         BOOST_CHECK(ifpi.has_tsf);
         BOOST_CHECK_EQUAL(ifpi.tsi, 0);
@@ -202,3 +266,330 @@ BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_full_buffer_mode){
         num_accum_samps += ifpi.num_payload_words32;
     }
 }
+
+////////////////////////////////////////////////////////////////////////
+static uhd::time_spec_t get_fixed_time(const double secs){
+    return uhd::time_spec_t(secs);
+}
+
+BOOST_AUTO_TEST_CASE(test_sph_send_late_policy_drop){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_send_xport_class dummy_send_xport(otw_type);
+
+    //create the super send packet handler, the device is at 1 second
+    typedef uhd::transport::sph::send_packet_handler handler_type;
+    handler_type handler(1);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(100e6);
+    handler.set_samp_rate(10e6);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xport, _1));
+    handler.set_converter(otw_type);
+    handler.set_max_samples_per_packet(20);
+    handler.set_late_policy(handler_type::LATE_POLICY_DROP, boost::bind(&get_fixed_time, 1.0), 0.01);
+    uhd::transport::stream_event_counters::sptr counters = uhd::transport::stream_event_counters::make(false);
+    handler.set_event_counters(0, counters);
+
+    std::vector<std::complex<float> > buff(50);
+    uhd::tx_metadata_t metadata;
+    metadata.start_of_burst = true;
+    metadata.end_of_burst = false;
+    metadata.has_time_spec = true;
+
+    //a burst within the margin is dropped, the rest of the burst with it
+    metadata.time_spec = uhd::time_spec_t(1.005);
+    BOOST_CHECK_EQUAL(handler.send(
+        &buff.front(), buff.size(), metadata, uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    ), buff.size());
+    metadata.start_of_burst = false;
+    metadata.end_of_burst = true;
+    metadata.has_time_spec = false;
+    BOOST_CHECK_EQUAL(handler.send(
+        &buff.front(), 10, metadata, uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_ONE_PACKET, 1.0
+    ), size_t(10));
+    BOOST_CHECK(dummy_send_xport.empty());
+    BOOST_CHECK_EQUAL(counters->get_count(uhd::transport::stream_event_counters::EVENT_LATE_SAMPS), buff.size() + 10);
+
+    //the next burst in time is sent
+    metadata.start_of_burst = true;
+    metadata.has_time_spec = true;
+    metadata.time_spec = uhd::time_spec_t(1.5);
+    BOOST_CHECK_EQUAL(handler.send(
+        &buff.front(), 10, metadata, uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_ONE_PACKET, 1.0
+    ), size_t(10));
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    dummy_send_xport.pop_front_packet(ifpi);
+    BOOST_CHECK(ifpi.sob);
+    BOOST_CHECK(ifpi.eob);
+    BOOST_CHECK_EQUAL(ifpi.packet_count, 0);
+    BOOST_CHECK(dummy_send_xport.empty());
+    BOOST_CHECK_EQUAL(counters->get_count(uhd::transport::stream_event_counters::EVENT_LATE_SAMPS), buff.size() + 10);
+}
+
+////////////////////////////////////////////////////////////////////////
+static void count_flush(size_t *num_flushes){
+    (*num_flushes)++;
+}
+
+BOOST_AUTO_TEST_CASE(test_sph_send_flush_on_end_of_burst){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_send_xport_class dummy_send_xport(otw_type);
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(1);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xport, _1));
+    size_t num_flushes = 0;
+    handler.set_xport_chan_flush(0, boost::bind(&count_flush, &num_flushes));
+    handler.set_converter(otw_type);
+    handler.set_max_samples_per_packet(20);
+
+    //allocate metadata and buffer
+    std::vector<std::complex<float> > buff(20*NUM_PKTS_TO_TEST);
+    uhd::tx_metadata_t metadata;
+    metadata.start_of_burst = true;
+    metadata.end_of_burst = false;
+    metadata.has_time_spec = false;
+
+    //a burst without an end should not flush
+    handler.send(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_flushes, 0);
+
+    //the end of burst flushes once after the final fragment
+    metadata.start_of_burst = false;
+    metadata.end_of_burst = true;
+    handler.send(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_flushes, 1);
+}
+
+////////////////////////////////////////////////////////////////////////
+static bool fake_preload(size_t *room, std::vector<size_t> *asked, size_t num_packets, double){
+    asked->push_back(num_packets);
+    return num_packets <= *room;
+}
+
+BOOST_AUTO_TEST_CASE(test_sph_send_preload_timed_burst){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_send_xport_class dummy_send_xport(otw_type);
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(1);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xport, _1));
+    size_t room = NUM_PKTS_TO_TEST - 1;
+    std::vector<size_t> asked;
+    handler.set_xport_chan_preload(0, boost::bind(&fake_preload, &room, &asked, _1, _2));
+    handler.set_converter(otw_type);
+    handler.set_max_samples_per_packet(20);
+
+    //allocate metadata and buffer
+    std::vector<std::complex<float> > buff(20*NUM_PKTS_TO_TEST - 5);
+    uhd::tx_metadata_t metadata;
+    metadata.start_of_burst = true;
+    metadata.end_of_burst = true;
+    metadata.has_time_spec = true;
+    metadata.time_spec = uhd::time_spec_t(1.0);
+
+    //without room for the whole burst, nothing is sent
+    size_t num_sent = handler.send(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_FULL_BUFF, 0.0
+    );
+    BOOST_CHECK_EQUAL(num_sent, 0);
+    BOOST_CHECK(dummy_send_xport.empty());
+
+    //with room, the whole burst goes out
+    room = NUM_PKTS_TO_TEST;
+    num_sent = handler.send(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_FULL_BUFF, 0.0
+    );
+    BOOST_CHECK_EQUAL(num_sent, buff.size());
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        dummy_send_xport.pop_front_packet(ifpi);
+        BOOST_CHECK_EQUAL(ifpi.sob, i == 0);
+        BOOST_CHECK_EQUAL(ifpi.eob, i == NUM_PKTS_TO_TEST-1);
+    }
+    BOOST_CHECK(dummy_send_xport.empty());
+
+    //a burst that is not whole, or not timed, streams as before
+    metadata.end_of_burst = false;
+    handler.send(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_FULL_BUFF, 0.0
+    );
+    BOOST_CHECK_EQUAL(asked.size(), 2);
+    BOOST_CHECK_EQUAL(asked.back(), NUM_PKTS_TO_TEST);
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_view){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_send_xport_class dummy_send_xport(otw_type);
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(1);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xport, _1));
+    handler.set_converter(otw_type);
+    handler.set_max_samples_per_packet(20);
+
+    //fill the payloads in place, the burst flags are set before commit
+    uhd::device::send_view_t view;
+    view.metadata.has_time_spec = true;
+    view.metadata.time_spec = uhd::time_spec_t(0.0);
+    std::vector<const boost::uint32_t *> payloads;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        BOOST_CHECK_EQUAL(handler.get_send_view(view, 1.0), size_t(20));
+        BOOST_CHECK_EQUAL(view.item_size, sizeof(boost::uint32_t));
+        BOOST_CHECK_EQUAL(view.otw_type.byteorder, uhd::otw_type_t::BO_BIG_ENDIAN);
+        BOOST_REQUIRE_EQUAL(view.payloads.size(), size_t(1));
+        boost::uint32_t *payload = reinterpret_cast<boost::uint32_t *>(view.payloads[0]);
+        for (size_t j = 0; j < 10 + i%10; j++) payload[j] = boost::uint32_t(i*100 + j);
+        payloads.push_back(payload);
+
+        view.metadata.start_of_burst = (i == 0);
+        view.metadata.end_of_burst = (i == NUM_PKTS_TO_TEST-1);
+        BOOST_CHECK_EQUAL(handler.commit_send_view(view, 10 + i%10), 10 + i%10);
+        BOOST_CHECK(view.frames.empty());
+        view.metadata.time_spec += uhd::time_spec_t(0, 10 + i%10, SAMP_RATE);
+    }
+
+    //check the sent packets
+    size_t num_accum_samps = 0;
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        dummy_send_xport.pop_front_packet(ifpi);
+        BOOST_CHECK_EQUAL(ifpi.num_payload_words32, 10+i%10);
+        BOOST_CHECK_EQUAL(ifpi.packet_count, i%16);
+        BOOST_CHECK(ifpi.has_tsi);
+        BOOST_CHECK(ifpi.has_tsf);
+        BOOST_CHECK_EQUAL(ifpi.tsf, num_accum_samps*TICK_RATE/SAMP_RATE);
+        BOOST_CHECK_EQUAL(ifpi.sob, i == 0);
+        BOOST_CHECK_EQUAL(ifpi.eob, i == NUM_PKTS_TO_TEST-1);
+        BOOST_CHECK_EQUAL(payloads[i][ifpi.num_payload_words32-1], boost::uint32_t(i*100 + ifpi.num_payload_words32-1));
+        num_accum_samps += ifpi.num_payload_words32;
+    }
+
+    //a different header layout than the reserved one is an error
+    BOOST_CHECK_EQUAL(handler.get_send_view(view, 1.0), size_t(20));
+    view.metadata.has_time_spec = false;
+    BOOST_CHECK_THROW(handler.commit_send_view(view, 10), uhd::value_error);
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_resampler){
+////////////////////////////////////////////////////////////////////////
+    uhd::otw_type_t otw_type;
+    otw_type.width = 16;
+    otw_type.shift = 0;
+    otw_type.byteorder = uhd::otw_type_t::BO_BIG_ENDIAN;
+
+    dummy_send_xport_class dummy_send_xport(otw_type);
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const double HOST_RATE = 7.5e6;
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(1);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xport, _1));
+    handler.set_converter(otw_type);
+    handler.set_max_samples_per_packet(20);
+
+    uhd::transport::resampler_config_t config;
+    config.rate = HOST_RATE;
+    BOOST_CHECK_CLOSE(handler.set_resampler(config).rate, HOST_RATE, 1e-9);
+    const double delay = uhd::transport::polyphase_resampler::make(
+        HOST_RATE, SAMP_RATE, config.taps_per_phase, config.max_phases
+    )->get_delay()/HOST_RATE;
+
+    //send one burst at the host rate
+    std::vector<std::complex<float> > buff(300);
+    uhd::tx_metadata_t metadata;
+    metadata.start_of_burst = true;
+    metadata.end_of_burst = true;
+    metadata.has_time_spec = true;
+    metadata.time_spec = uhd::time_spec_t(0.5);
+    const size_t num_sent = handler.send(
+        &buff.front(), buff.size(), metadata,
+        uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::SEND_MODE_FULL_BUFF, 1.0
+    );
+    BOOST_CHECK_EQUAL(num_sent, buff.size());
+
+    //the burst is early by the filter delay, the filter tail is flushed
+    size_t num_accum_samps = 0;
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    for (size_t i = 0; not dummy_send_xport.empty(); i++){
+        std::cout << "data check " << i << std::endl;
+        dummy_send_xport.pop_front_packet(ifpi);
+        BOOST_CHECK(ifpi.has_tsf);
+        BOOST_CHECK_TS_CLOSE(
+            uhd::time_spec_t(time_t(ifpi.tsi), long(ifpi.tsf), TICK_RATE),
+            metadata.time_spec - uhd::time_spec_t(delay) + uhd::time_spec_t(0, num_accum_samps, SAMP_RATE)
+        );
+        BOOST_CHECK_EQUAL(ifpi.sob, i == 0);
+        BOOST_CHECK_EQUAL(ifpi.eob, dummy_send_xport.empty());
+        num_accum_samps += ifpi.num_payload_words32;
+    }
+    BOOST_CHECK(num_accum_samps >= buff.size()*4/3);
+    BOOST_CHECK(num_accum_samps <= (buff.size() + config.taps_per_phase)*4/3 + 1);
+}
@@ -0,0 +1,101 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/usrp/time_extrapolator.hpp>
+#include <boost/bind.hpp>
+#include <cmath>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+/*!
+ * Fake clocks: the device runs 50 ppm fast with an offset,
+ * and each device read takes a round trip of host time.
+ */
+struct fake_clocks{
+    fake_clocks(void): host(0.0), rtt(100e-6), num_reads(0){}
+
+    time_spec_t device_at(double host_secs) const{
+        return time_spec_t(1000.0) + time_spec_t(host_secs*(1 + 50e-6));
+    }
+
+    time_spec_t read_device(void){
+        num_reads++;
+        host += rtt/2;
+        const time_spec_t t = device_at(host);
+        host += rtt/2;
+        return t;
+    }
+
+    time_spec_t read_host(void){
+        return time_spec_t(host);
+    }
+
+    double host, rtt;
+    size_t num_reads;
+};
+
+static time_extrapolator::sptr make_extrapolator(fake_clocks &clocks){
+    return time_extrapolator::make(
+        boost::bind(&fake_clocks::read_device, &clocks),
+        boost::bind(&fake_clocks::read_host, &clocks)
+    );
+}
+
+BOOST_AUTO_TEST_CASE(test_time_extrapolator_first_query_reads){
+    fake_clocks clocks;
+    time_extrapolator::sptr te = make_extrapolator(clocks);
+
+    double uncertainty = 0;
+    const time_spec_t t = te->get_time_now(uncertainty);
+    BOOST_CHECK_EQUAL(clocks.num_reads, size_t(1));
+    BOOST_CHECK(std::abs((t - clocks.device_at(clocks.host)).get_real_secs()) <= uncertainty);
+}
+
+BOOST_AUTO_TEST_CASE(test_time_extrapolator_bounded_error){
+    fake_clocks clocks;
+    time_extrapolator::sptr te = make_extrapolator(clocks);
+    te->set_resample_period(1.0);
+
+    //query ten times a second for a minute
+    double uncertainty = 0;
+    for (size_t i = 0; i < 600; i++){
+        clocks.host += 0.1;
+        const time_spec_t t = te->get_time_now(uncertainty);
+        const double error = std::abs((t - clocks.device_at(clocks.host)).get_real_secs());
+        BOOST_CHECK(error <= uncertainty);
+    }
+
+    //about one read per resample period, and the drift is learned
+    BOOST_CHECK(clocks.num_reads <= 61);
+    BOOST_CHECK(uncertainty < 100e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_time_extrapolator_reset){
+    fake_clocks clocks;
+    time_extrapolator::sptr te = make_extrapolator(clocks);
+
+    double uncertainty = 0;
+    te->get_time_now(uncertainty);
+    te->get_time_now(uncertainty);
+    BOOST_CHECK_EQUAL(clocks.num_reads, size_t(1));
+
+    te->reset();
+    te->get_time_now(uncertainty);
+    BOOST_CHECK_EQUAL(clocks.num_reads, size_t(2));
+}
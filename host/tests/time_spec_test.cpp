@@ -17,6 +17,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/types/time_spec.hpp>
+#include <uhd/types/tick_time.hpp>
 #include <boost/foreach.hpp>
 #include <boost/thread.hpp> //sleep
 #include <iostream>
@@ -97,3 +98,53 @@ BOOST_AUTO_TEST_CASE(test_time_spec_neg_values){
     BOOST_CHECK(tsa > tsb);
     BOOST_CHECK(tsc > tsd);
 }
+
+BOOST_AUTO_TEST_CASE(test_tick_time_normalize){
+    std::cout << "Testing tick time normalize..." << std::endl;
+
+    const uhd::tick_time_t t0(1, 250, 100);
+    BOOST_CHECK_EQUAL(t0.get_full_secs(), 3);
+    BOOST_CHECK_EQUAL(t0.get_ticks(), 50);
+
+    const uhd::tick_time_t t1(1, -10, 100);
+    BOOST_CHECK_EQUAL(t1.get_full_secs(), 0);
+    BOOST_CHECK_EQUAL(t1.get_ticks(), 90);
+
+    //rounding to the next tick carries into the seconds
+    const uhd::tick_time_t t2(uhd::time_spec_t(1, 0.9999999999), 100e6);
+    BOOST_CHECK_EQUAL(t2.get_full_secs(), 2);
+    BOOST_CHECK_EQUAL(t2.get_ticks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_tick_time_conversions){
+    std::cout << "Testing tick time conversions..." << std::endl;
+
+    const uhd::time_spec_t ts(5, 1234567, 100e6);
+    const uhd::tick_time_t tt(ts, 100e6);
+    BOOST_CHECK_EQUAL(tt.get_full_secs(), 5);
+    BOOST_CHECK_EQUAL(tt.get_ticks(), 1234567);
+    BOOST_CHECK(tt.to_time_spec() == ts);
+
+    BOOST_CHECK(uhd::tick_time_t(1, 50, 100) == uhd::tick_time_t(1, 5, 10));
+    BOOST_CHECK(uhd::tick_time_t(1, 50, 100) < uhd::tick_time_t(1, 6, 10));
+    BOOST_CHECK(uhd::tick_time_t(1, 99, 100) < uhd::tick_time_t(2, 0, 100));
+}
+
+BOOST_AUTO_TEST_CASE(test_tick_time_accumulate){
+    std::cout << "Testing tick time accumulate..." << std::endl;
+
+    //one hour of 364 sample packets at 25 Msps on a 100 MHz tick clock
+    static const double tick_rate = 100e6;
+    static const boost::int64_t ticks_per_packet = 364*4;
+    static const boost::int64_t num_packets = boost::int64_t(3600*25e6/364);
+
+    uhd::tick_time_t tt(10, 0, tick_rate);
+    for (boost::int64_t i = 0; i < num_packets; i++) tt += ticks_per_packet;
+
+    const boost::int64_t total_ticks = num_packets*ticks_per_packet;
+    BOOST_CHECK_EQUAL(tt.get_full_secs(), 10 + total_ticks/boost::int64_t(tick_rate));
+    BOOST_CHECK_EQUAL(tt.get_ticks(), total_ticks%boost::int64_t(tick_rate));
+
+    tt -= total_ticks;
+    BOOST_CHECK(tt == uhd::tick_time_t(10, 0, tick_rate));
+}
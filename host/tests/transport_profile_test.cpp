@@ -0,0 +1,90 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/transport/transport_profile.hpp>
+#include <uhd/exception.hpp>
+#include <boost/filesystem.hpp>
+#include <cstdlib>
+
+namespace fs = boost::filesystem;
+using namespace uhd::transport;
+
+//! Point the profiles at a fresh test directory
+static fs::path setup_profile_path(void){
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("uhd_profile_test_%%%%%%%%");
+    #ifdef UHD_PLATFORM_WIN32
+    _putenv_s("UHD_PROFILE_PATH", path.string().c_str());
+    #else
+    setenv("UHD_PROFILE_PATH", path.string().c_str(), 1);
+    #endif
+    return path;
+}
+
+BOOST_AUTO_TEST_CASE(test_transport_profile_path){
+    const fs::path profile_path = setup_profile_path();
+
+    uhd::device_addr_t dev_addr("type=usrp2, addr=192.168.10.2");
+    BOOST_CHECK_EQUAL(get_transport_profile_path(dev_addr), (profile_path / "usrp2_192.168.10.2.profile").string());
+
+    //the serial is preferred over the address
+    dev_addr["serial"] = "E1R23";
+    BOOST_CHECK_EQUAL(get_transport_profile_path(dev_addr), (profile_path / "usrp2_E1R23.profile").string());
+
+    BOOST_CHECK_EQUAL(get_transport_profile_path(uhd::device_addr_t("type=usrp2")), std::string(""));
+}
+
+BOOST_AUTO_TEST_CASE(test_transport_profile_save_load){
+    const fs::path profile_path = setup_profile_path();
+    const uhd::device_addr_t dev_addr("type=b100, serial=1234");
+
+    //no profile yet
+    BOOST_CHECK_EQUAL(load_transport_profile(dev_addr).size(), size_t(0));
+
+    const uhd::device_addr_t profile("recv_frame_size=8000, num_recv_frames=128, pirate_sched=fifo:0.5");
+    save_transport_profile(dev_addr, profile);
+    const uhd::device_addr_t loaded = load_transport_profile(dev_addr);
+    BOOST_CHECK_EQUAL(loaded.size(), size_t(3));
+    BOOST_CHECK_EQUAL(loaded["recv_frame_size"], "8000");
+    BOOST_CHECK_EQUAL(loaded["num_recv_frames"], "128");
+    BOOST_CHECK_EQUAL(loaded["pirate_sched"], "fifo:0.5");
+
+    //another device has no profile
+    BOOST_CHECK_EQUAL(load_transport_profile(uhd::device_addr_t("type=b100, serial=5678")).size(), size_t(0));
+
+    fs::remove_all(profile_path);
+}
+
+BOOST_AUTO_TEST_CASE(test_named_transport_profile){
+    const uhd::device_addr_t latency = get_named_transport_profile("low_latency", "usrp2");
+    const uhd::device_addr_t throughput = get_named_transport_profile("throughput", "usrp2");
+    BOOST_CHECK_LT(latency.cast<double>("recv_frame_size", 0), throughput.cast<double>("recv_frame_size", 0));
+    BOOST_CHECK_LT(latency.cast<double>("num_recv_frames", 0), throughput.cast<double>("num_recv_frames", 0));
+    BOOST_CHECK(latency.has_key("recv_busy_poll"));
+    BOOST_CHECK(not get_named_transport_profile("low_cpu", "usrp2").has_key("recv_busy_poll"));
+
+    //every name has hints for every device type
+    const char *names[] = {"low_latency", "throughput", "low_cpu"};
+    const char *types[] = {"usrp2", "usrp1", "b100", "e100", "sim"};
+    for (size_t n = 0; n < 3; n++) for (size_t t = 0; t < 5; t++){
+        BOOST_CHECK(get_named_transport_profile(names[n], types[t]).size() != 0);
+    }
+
+    //an unknown type gets no hints, an unknown name throws
+    BOOST_CHECK_EQUAL(get_named_transport_profile("throughput", "other").size(), size_t(0));
+    BOOST_CHECK_THROW(get_named_transport_profile("fastest", "usrp2"), uhd::key_error);
+}
@@ -0,0 +1,137 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/usrp/tx_burst_scheduler.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
+#include <vector>
+
+using namespace uhd;
+
+static const double lead_time = 0.01;
+
+/***********************************************************************
+ * A dummy stream that records the bursts it is handed,
+ * and how far ahead of its time each one came
+ **********************************************************************/
+class dummy_tx_stream : public tx_streamer{
+public:
+    size_t get_num_channels(void) const{return 1;}
+    size_t get_max_num_samps(void) const{return 100;}
+
+    size_t send(const buffs_type &buffs, size_t nsamps, const tx_metadata_t &md, double){
+        boost::mutex::scoped_lock lock(mutex);
+        BOOST_CHECK_EQUAL(buffs.size(), size_t(1));
+        BOOST_CHECK(md.start_of_burst and md.end_of_burst and md.has_time_spec);
+        times.push_back(md.time_spec);
+        aheads.push_back((md.time_spec - time_spec_t::get_system_time()).get_real_secs());
+        return nsamps;
+    }
+
+    boost::mutex mutex;
+    std::vector<time_spec_t> times;
+    std::vector<double> aheads;
+};
+
+struct release_recorder{
+    boost::mutex mutex;
+    std::vector<std::pair<size_t, bool> > releases;
+
+    void on_release(size_t id, bool sent){
+        boost::mutex::scoped_lock lock(mutex);
+        releases.push_back(std::make_pair(id, sent));
+    }
+};
+
+BOOST_AUTO_TEST_CASE(test_tx_burst_scheduler_order){
+    boost::shared_ptr<dummy_tx_stream> stream(new dummy_tx_stream());
+    release_recorder recorder;
+    usrp::tx_burst_scheduler::sptr scheduler = usrp::tx_burst_scheduler::make(
+        std::vector<tx_streamer::sptr>(1, stream), &time_spec_t::get_system_time, lead_time
+    );
+
+    //bursts out of time order, and one whose time has passed
+    std::vector<char> buff(400);
+    const time_spec_t start = time_spec_t::get_system_time();
+    const double offsets[] = {0.15, 0.05, 0.10, -0.05};
+    for (size_t i = 0; i < 4; i++){
+        usrp::tx_burst_scheduler::burst_t burst;
+        burst.time = start + time_spec_t(offsets[i]);
+        burst.buffs.push_back(&buff.front());
+        burst.nsamps = 100;
+        burst.release = boost::bind(&release_recorder::on_release, &recorder, i, _1);
+        scheduler->enqueue(burst);
+    }
+    usrp::tx_burst_scheduler::burst_t bad_burst;
+    bad_burst.stream = 1;
+    BOOST_CHECK_THROW(scheduler->enqueue(bad_burst), uhd::index_error);
+
+    boost::this_thread::sleep(boost::posix_time::milliseconds(300));
+    const usrp::tx_burst_scheduler::stats_t stats = scheduler->get_stats();
+    BOOST_CHECK_EQUAL(stats.num_queued, size_t(0));
+    BOOST_CHECK_EQUAL(stats.num_sent, size_t(3));
+    BOOST_CHECK_EQUAL(stats.num_late, size_t(1));
+    BOOST_CHECK_EQUAL(stats.num_short, size_t(0));
+    BOOST_CHECK(stats.max_lateness > 0.0);
+
+    //sent in time order, each one just ahead of its time
+    boost::mutex::scoped_lock lock(stream->mutex);
+    BOOST_REQUIRE_EQUAL(stream->times.size(), size_t(3));
+    for (size_t i = 1; i < stream->times.size(); i++){
+        BOOST_CHECK(stream->times[i-1] < stream->times[i]);
+    }
+    for (size_t i = 0; i < stream->aheads.size(); i++){
+        BOOST_CHECK(stream->aheads[i] > 0.0);
+        BOOST_CHECK(stream->aheads[i] <= lead_time + 0.005);
+    }
+
+    //the late burst is released unsent, the others once sent
+    boost::mutex::scoped_lock release_lock(recorder.mutex);
+    BOOST_REQUIRE_EQUAL(recorder.releases.size(), size_t(4));
+    BOOST_CHECK_EQUAL(recorder.releases[0].first, size_t(3));
+    BOOST_CHECK(not recorder.releases[0].second);
+    BOOST_CHECK_EQUAL(recorder.releases[1].first, size_t(1));
+    BOOST_CHECK_EQUAL(recorder.releases[2].first, size_t(2));
+    BOOST_CHECK_EQUAL(recorder.releases[3].first, size_t(0));
+    BOOST_CHECK(recorder.releases[3].second);
+}
+
+BOOST_AUTO_TEST_CASE(test_tx_burst_scheduler_release_on_destroy){
+    boost::shared_ptr<dummy_tx_stream> stream(new dummy_tx_stream());
+    release_recorder recorder;
+    {
+        usrp::tx_burst_scheduler::sptr scheduler = usrp::tx_burst_scheduler::make(
+            std::vector<tx_streamer::sptr>(1, stream), &time_spec_t::get_system_time, lead_time
+        );
+        for (size_t i = 0; i < 3; i++){
+            usrp::tx_burst_scheduler::burst_t burst;
+            burst.time = time_spec_t::get_system_time() + time_spec_t(10.0 + i);
+            burst.release = boost::bind(&release_recorder::on_release, &recorder, i, _1);
+            scheduler->enqueue(burst);
+        }
+        BOOST_CHECK_EQUAL(scheduler->get_stats().num_queued, size_t(3));
+    }
+    BOOST_CHECK_EQUAL(recorder.releases.size(), size_t(3));
+    for (size_t i = 0; i < recorder.releases.size(); i++){
+        BOOST_CHECK(not recorder.releases[i].second);
+    }
+    BOOST_CHECK(stream->times.empty());
+}
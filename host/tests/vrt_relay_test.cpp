@@ -0,0 +1,168 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/transport/vrt_relay.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+#include <list>
+
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+/***********************************************************************
+ * A dummy managed receive buffer for testing
+ **********************************************************************/
+class dummy_mrb : public managed_recv_buffer{
+public:
+    void release(void){
+        //NOP
+    }
+
+    sptr get_new(boost::shared_array<boost::uint32_t> mem, size_t len){
+        _mem = mem;
+        _len = len;
+        return make_managed_buffer(this);
+    }
+
+private:
+    const void *get_buff(void) const{return _mem.get();}
+    size_t get_size(void) const{return _len;}
+
+    boost::shared_array<boost::uint32_t> _mem;
+    size_t _len;
+};
+
+/***********************************************************************
+ * Local receivers of the relay on ephemeral ports
+ **********************************************************************/
+class dummy_receiver{
+public:
+    dummy_receiver(asio::io_service &io_service): _socket(io_service){
+        _socket.open(asio::ip::udp::v4());
+        _socket.bind(asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    }
+
+    std::string get_addr(void) const{
+        return "127.0.0.1:" + boost::lexical_cast<std::string>(_socket.local_endpoint().port());
+    }
+
+    //! Receive one datagram of words, empty on timeout
+    std::vector<boost::uint32_t> recv(void){
+        for (size_t i = 0; i < 100 and _socket.available() == 0; i++){
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        }
+        std::vector<boost::uint32_t> words(_socket.available()/sizeof(boost::uint32_t));
+        if (not words.empty()) _socket.receive(asio::buffer(words));
+        return words;
+    }
+
+private:
+    asio::ip::udp::socket _socket;
+};
+
+static std::list<dummy_mrb> mrbs; //list means no-realloc
+
+static uhd::device::recv_view_t make_view(
+    const std::vector<boost::uint32_t> &words, const size_t nchan, const bool big_endian
+){
+    uhd::device::recv_view_t view;
+    view.otw_type.byteorder = (big_endian)? uhd::otw_type_t::BO_BIG_ENDIAN : uhd::otw_type_t::BO_LITTLE_ENDIAN;
+    for (size_t ch = 0; ch < nchan; ch++){
+        boost::shared_array<boost::uint32_t> mem(new boost::uint32_t[words.size()]);
+        for (size_t i = 0; i < words.size(); i++) mem[i] = words[i] + boost::uint32_t(ch);
+        if (big_endian) mem[0] = uhd::htonx(mem[0]);
+        else mem[0] = uhd::htowx(mem[0]);
+        mrbs.push_back(dummy_mrb());
+        view.frames.push_back(mrbs.back().get_new(mem, words.size()*sizeof(boost::uint32_t)));
+        view.payloads.push_back(mem.get() + 1);
+    }
+    return view;
+}
+
+static boost::uint32_t packet_count(const boost::uint32_t word0){
+    return (word0 >> 16) & 0xf;
+}
+
+/***********************************************************************
+ * Test the frames reach every destination with the counts rewritten
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_vrt_relay_destinations){
+    asio::io_service io_service;
+    dummy_receiver receiver0(io_service), receiver1(io_service);
+    std::vector<std::string> addrs;
+    addrs.push_back(receiver0.get_addr());
+    addrs.push_back(receiver1.get_addr());
+    vrt_relay::sptr relay = vrt_relay::make(addrs, "49152", 2);
+
+    //a header word with a packet count of 9 and three payload words
+    std::vector<boost::uint32_t> words;
+    words.push_back(0x10090004);
+    words.push_back(100);
+    words.push_back(101);
+    words.push_back(102);
+
+    //the first view is held for the batch
+    relay->relay(make_view(words, 1, true));
+    BOOST_CHECK_EQUAL(relay->get_num_frames(), size_t(0));
+    relay->relay(make_view(words, 1, true));
+    BOOST_CHECK_EQUAL(relay->get_num_frames(), size_t(2));
+    BOOST_CHECK_EQUAL(relay->get_num_dropped(), size_t(0));
+
+    dummy_receiver *receivers[] = {&receiver0, &receiver1};
+    for (size_t r = 0; r < 2; r++){
+        for (size_t i = 0; i < 2; i++){
+            const std::vector<boost::uint32_t> datagram = receivers[r]->recv();
+            BOOST_REQUIRE_EQUAL(datagram.size(), words.size());
+            BOOST_CHECK_EQUAL(packet_count(uhd::ntohx(datagram[0])), i);
+            BOOST_CHECK_EQUAL(uhd::ntohx(datagram[0]) & ~0xf0000, words[0] & ~0xf0000);
+            for (size_t j = 1; j < words.size(); j++) BOOST_CHECK_EQUAL(datagram[j], words[j]);
+        }
+    }
+}
+
+/***********************************************************************
+ * Test the counts per channel and the skipped count of a gap
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_vrt_relay_gap){
+    asio::io_service io_service;
+    dummy_receiver receiver(io_service);
+    vrt_relay::sptr relay = vrt_relay::make(std::vector<std::string>(1, receiver.get_addr()), "49152", 4);
+
+    std::vector<boost::uint32_t> words;
+    words.push_back(0x100f0002);
+    words.push_back(7);
+
+    relay->relay(make_view(words, 2, false));
+    relay->mark_gap();
+    relay->relay(make_view(words, 2, false));
+    relay->flush();
+    BOOST_CHECK_EQUAL(relay->get_num_frames(), size_t(4));
+
+    const boost::uint32_t expected_counts[] = {0, 0, 2, 2};
+    for (size_t i = 0; i < 4; i++){
+        const std::vector<boost::uint32_t> datagram = receiver.recv();
+        BOOST_REQUIRE_EQUAL(datagram.size(), words.size());
+        BOOST_CHECK_EQUAL(packet_count(uhd::wtohx(datagram[0])), expected_counts[i]);
+        BOOST_CHECK_EQUAL(datagram[1], words[1] + boost::uint32_t(i%2)); //the channel
+    }
+}
@@ -17,7 +17,9 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/transport/vrt_if_packet.hpp>
+#include <uhd/utils/byteswap.hpp>
 #include <cstdlib>
+#include <vector>
 
 using namespace uhd::transport;
 
@@ -139,3 +141,68 @@ BOOST_AUTO_TEST_CASE(test_with_all){
     if_packet_info.num_payload_words32 = 44444;
     pack_and_unpack(if_packet_info);
 }
+
+/***********************************************************************
+ * Check the fixed layout unpacker against the generic unpacker
+ * for packets of its layout and packets that take the fallback.
+ **********************************************************************/
+static void check_fixed_unpack(
+    vrt::if_packet_info_t &if_packet_info_in
+){
+    std::vector<boost::uint32_t> packet_buff(vrt::max_if_hdr_words32 + if_packet_info_in.num_payload_words32 + 1);
+    vrt::if_hdr_pack_be(&packet_buff.front(), if_packet_info_in);
+    if (if_packet_info_in.has_tlr){ //the packer leaves the trailer to the caller
+        packet_buff[if_packet_info_in.num_packet_words32-1] = uhd::htonx(if_packet_info_in.tlr);
+    }
+
+    vrt::if_packet_info_t generic, fixed;
+    generic.num_packet_words32 = if_packet_info_in.num_packet_words32;
+    fixed.num_packet_words32 = if_packet_info_in.num_packet_words32;
+    vrt::if_hdr_unpack_be(&packet_buff.front(), generic);
+    vrt::if_hdr_unpack_be_sid_tsi_tsf_tlr(&packet_buff.front(), fixed);
+
+    BOOST_CHECK_EQUAL(generic.packet_type, fixed.packet_type);
+    BOOST_CHECK_EQUAL(generic.packet_count, fixed.packet_count);
+    BOOST_CHECK_EQUAL(generic.sob, fixed.sob);
+    BOOST_CHECK_EQUAL(generic.eob, fixed.eob);
+    BOOST_CHECK_EQUAL(generic.num_header_words32, fixed.num_header_words32);
+    BOOST_CHECK_EQUAL(generic.num_payload_words32, fixed.num_payload_words32);
+    BOOST_CHECK_EQUAL(generic.has_sid, fixed.has_sid);
+    if (generic.has_sid) BOOST_CHECK_EQUAL(generic.sid, fixed.sid);
+    BOOST_CHECK_EQUAL(generic.has_cid, fixed.has_cid);
+    BOOST_CHECK_EQUAL(generic.has_tsi, fixed.has_tsi);
+    if (generic.has_tsi) BOOST_CHECK_EQUAL(generic.tsi, fixed.tsi);
+    BOOST_CHECK_EQUAL(generic.has_tsf, fixed.has_tsf);
+    if (generic.has_tsf) BOOST_CHECK_EQUAL(generic.tsf, fixed.tsf);
+    BOOST_CHECK_EQUAL(generic.has_tlr, fixed.has_tlr);
+    if (generic.has_tlr) BOOST_CHECK_EQUAL(generic.tlr, if_packet_info_in.tlr);
+    if (fixed.has_tlr) BOOST_CHECK_EQUAL(fixed.tlr, if_packet_info_in.tlr);
+}
+
+BOOST_AUTO_TEST_CASE(test_fixed_unpack){
+    vrt::if_packet_info_t if_packet_info;
+    if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    if_packet_info.packet_count = 5;
+    if_packet_info.sob = false;
+    if_packet_info.eob = true;
+    if_packet_info.has_sid = true;
+    if_packet_info.has_cid = false;
+    if_packet_info.has_tsi = true;
+    if_packet_info.has_tsf = true;
+    if_packet_info.has_tlr = true;
+    if_packet_info.sid = std::rand();
+    if_packet_info.tsi = std::rand();
+    if_packet_info.tsf = std::rand();
+    if_packet_info.tlr = std::rand();
+    if_packet_info.num_payload_words32 = 555;
+    check_fixed_unpack(if_packet_info);
+
+    //a layout without the trailer takes the fallback
+    if_packet_info.has_tlr = false;
+    check_fixed_unpack(if_packet_info);
+
+    //a layout without the stream id takes the fallback
+    if_packet_info.has_tlr = true;
+    if_packet_info.has_sid = false;
+    check_fixed_unpack(if_packet_info);
+}
@@ -21,9 +21,16 @@
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <vector>
+#include <algorithm>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <boost/format.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
 #include <sys/mman.h> //mmap
 #include <unistd.h> //getpagesize
 #include <poll.h> //poll
@@ -32,10 +39,13 @@ static const size_t bytes_per_frame = 2048;
 
 static const int poll_timeout_ms = 100;
 
+static const size_t max_latency_us = 10000; //histogram range, longer latencies go in the last bin
+
 struct loopback_pkt_hdr_type{
     boost::uint32_t words32;
     boost::uint32_t checksum;
     boost::uint64_t seq_num;
+    boost::uint64_t time_us; //filled in by the write thread
 };
 
 struct loopback_pkt_type{
@@ -49,19 +59,38 @@ static loopback_pkt_type (*recv_buff)[];
 static loopback_pkt_type (*send_buff)[];
 
 static struct usrp_e_ring_buffer_size_t rb_size;
+static void *map_mem;
+static size_t map_size;
 
-static bool running = true;
+static volatile bool running = true;
 
 static boost::uint64_t seq_errors = 0;
 static boost::uint64_t checksum_errors = 0;
 static boost::uint64_t sent_words32 = 0;
 static boost::uint64_t recvd_words32 = 0;
 
+//frames in flight: committed by the write thread and not yet released by the read thread
+static boost::mutex flight_mutex;
+static boost::condition_variable flight_cond;
+static boost::uint64_t sent_frames = 0;
+static boost::uint64_t recvd_frames = 0;
+
+//latency from the fill of a frame to its claim on the receive side
+static std::vector<boost::uint64_t> latency_hist;
+static boost::uint64_t latency_min_us, latency_max_us, latency_sum_us;
+
+static const boost::posix_time::ptime time_epoch = boost::get_system_time();
+
+static inline boost::uint64_t time_now_us(void){
+    return (boost::get_system_time() - time_epoch).total_microseconds();
+}
+
 static inline void print_pkt(const loopback_pkt_type &pkt){
     std::cout << std::endl;
     std::cout << "pkt.hdr.words32 " << pkt.hdr.words32 << std::endl;
     std::cout << "pkt.hdr.checksum " << pkt.hdr.checksum << std::endl;
     std::cout << "pkt.hdr.seq_num " << pkt.hdr.seq_num << std::endl;
+    std::cout << "pkt.hdr.time_us " << pkt.hdr.time_us << std::endl;
 }
 
 boost::uint32_t my_checksum(void *buff, size_t size32){
@@ -73,45 +102,92 @@ boost::uint32_t my_checksum(void *buff, size_t size32){
     return x;
 }
 
+template <typename T> static std::vector<T> split_list(const std::string &list, const std::string &seps = ","){
+    std::vector<std::string> tokens;
+    boost::split(tokens, list, boost::is_any_of(seps));
+    std::vector<T> values;
+    BOOST_FOREACH(const std::string &token, tokens){
+        values.push_back(boost::lexical_cast<T>(boost::trim_copy(token)));
+    }
+    return values;
+}
+
+static double latency_percentile(const double fraction){
+    boost::uint64_t num = 0, count = 0;
+    BOOST_FOREACH(const boost::uint64_t n, latency_hist) num += n;
+    for (size_t i = 0; i < latency_hist.size(); i++){
+        count += latency_hist[i];
+        if (count >= fraction*num) return double(i);
+    }
+    return double(latency_hist.size());
+}
+
 /***********************************************************************
  * Read thread - recv frames and verify checksum
+ *  - Claims up to batch ready frames, then releases them together.
+ *  - The frames are released early when the next frame is not ready.
  **********************************************************************/
-static void read_thread(void){
-    std::cout << "start read thread... " << std::endl;
+static void release_frames(std::vector<size_t> &claimed){
+    BOOST_FOREACH(const size_t i, claimed) (*recv_info)[i].flags = RB_KERNEL;
+    {
+        boost::mutex::scoped_lock lock(flight_mutex);
+        recvd_frames += claimed.size();
+    }
+    flight_cond.notify_one();
+    claimed.clear();
+}
 
+static void read_thread(const size_t batch){
     boost::uint64_t seq_num = 0;
     size_t index = 0;
+    std::vector<size_t> claimed;
 
     while (running){
 
         loopback_pkt_type &pkt = (*recv_buff)[index];
         ring_buffer_info &info = (*recv_info)[index];
 
-        //wait for frame available
+        //wait for frame available, after releasing the claimed frames
         if (not (info.flags & RB_USER)){
+            if (not claimed.empty()){
+                release_frames(claimed);
+                continue;
+            }
             pollfd pfd;
             pfd.fd = fp;
             pfd.events = POLLIN;
             if (poll(&pfd, 1, poll_timeout_ms) <= 0){
                 std::cout << "Read poll timeout, exiting read thread!" << std::endl;
                 running = false;
-                return;
+                break;
             }
         }
         info.flags = RB_USER_PROCESS;
 
         //print_pkt(pkt);
 
-        //handle checksum
-        const boost::uint32_t expected_checksum = pkt.hdr.checksum;
-        pkt.hdr.checksum = 0; //set to zero for calculation
-        const boost::uint32_t actual_checksum = my_checksum(&pkt, pkt.hdr.words32);
-        if (expected_checksum != actual_checksum){
-            checksum_errors++;
-            std::cerr << "C";
+        //handle latency
+        {
+            const boost::uint64_t now_us = time_now_us();
+            const boost::uint64_t latency_us = (now_us > pkt.hdr.time_us)? now_us - pkt.hdr.time_us : 0;
+            latency_hist[std::min<size_t>(latency_us, latency_hist.size()-1)]++;
+            latency_min_us = std::min(latency_min_us, latency_us);
+            latency_max_us = std::max(latency_max_us, latency_us);
+            latency_sum_us += latency_us;
         }
-        else{
-            recvd_words32 += pkt.hdr.words32;
+
+        //handle checksum
+        {
+            const boost::uint32_t expected_checksum = pkt.hdr.checksum;
+            pkt.hdr.checksum = 0; //set to zero for calculation
+            const boost::uint32_t actual_checksum = my_checksum(&pkt, pkt.hdr.words32);
+            if (expected_checksum != actual_checksum){
+                checksum_errors++;
+                std::cerr << "C";
+            }
+            else{
+                recvd_words32 += pkt.hdr.words32;
+            }
         }
 
         //handle sequence
@@ -121,26 +197,51 @@ static void read_thread(void){
         }
         seq_num = pkt.hdr.seq_num+1;
 
-        //release the packet
-        info.flags = RB_KERNEL;
+        claimed.push_back(index);
 
         //increment index and wrap around to zero
         index++;
         if (index == size_t(rb_size.num_rx_frames)) index = 0;
+
+        //release the packets
+        if (claimed.size() >= batch) release_frames(claimed);
     }
 
+    release_frames(claimed);
+    running = false;
 }
 
 /***********************************************************************
- * Write thread - send frames and calculate checksum
+ * Commit frames to the kernel:
+ *  - The USRP_E_SEND_FRAMES ioctl commits a range of frames at once.
+ *  - Drivers without the ioctl are notified with a zero length write.
  **********************************************************************/
-static void write_thread(const size_t num_words32){
-    std::cout << "start write thread... " << std::endl;
+static bool use_send_frames_ioctl = true;
+
+static void commit_frames(const size_t start, const size_t count){
+    if (count == 0) return;
+    if (use_send_frames_ioctl){
+        usrp_e_frame_range range;
+        range.start = start;
+        range.count = count;
+        if (::ioctl(fp, USRP_E_SEND_FRAMES, &range) >= 0) return;
+        use_send_frames_ioctl = false; //older driver: fall back to the write notification
+    }
+    ::write(fp, NULL, 0);
+}
 
+/***********************************************************************
+ * Write thread - send frames and calculate checksum
+ *  - At most num_frames frames are in flight at once.
+ *  - The kernel is notified once per batch of filled frames,
+ *    and before waiting on the ring or on the frames in flight.
+ **********************************************************************/
+static void write_thread(const size_t num_words32, const size_t num_frames, const size_t batch){
     srandom(std::time(NULL));
 
     boost::uint64_t seq_num = 0;
     size_t index = 0;
+    size_t batch_start = 0, batch_count = 0;
 
     //write into tmp and memcopy into pkt to avoid cache issues
     loopback_pkt_type pkt_tmp;
@@ -149,8 +250,30 @@ static void write_thread(const size_t num_words32){
 
         ring_buffer_info &info = (*send_info)[index];
 
+        //wait for a free slot in the window of frames in flight
+        {
+            boost::mutex::scoped_lock lock(flight_mutex);
+            if (sent_frames + batch_count - recvd_frames >= num_frames){
+                lock.unlock();
+                commit_frames(batch_start, batch_count);
+                lock.lock();
+                sent_frames += batch_count;
+                batch_count = 0;
+                while (running and sent_frames - recvd_frames >= num_frames){
+                    flight_cond.timed_wait(lock, boost::posix_time::milliseconds(poll_timeout_ms));
+                }
+                if (not running) break;
+            }
+        }
+
         //wait for frame available
         if (not (info.flags & RB_KERNEL)){
+            commit_frames(batch_start, batch_count);
+            {
+                boost::mutex::scoped_lock lock(flight_mutex);
+                sent_frames += batch_count;
+            }
+            batch_count = 0;
             pollfd pfd;
             pfd.fd = fp;
             pfd.events = POLLOUT;
@@ -166,6 +289,7 @@ static void write_thread(const size_t num_words32){
         pkt_tmp.hdr.words32 = sizeof(pkt_tmp.hdr)/sizeof(boost::uint32_t) + num_words32;
         pkt_tmp.hdr.checksum = 0; //set to zero for checksum()
         pkt_tmp.hdr.seq_num = seq_num++;
+        pkt_tmp.hdr.time_us = time_now_us();
         for (size_t i = 0; i < num_words32; i++) pkt_tmp.data[i] = seed + i;
         pkt_tmp.hdr.checksum = my_checksum(&pkt_tmp, pkt_tmp.hdr.words32);
         sent_words32 += pkt_tmp.hdr.words32;
@@ -175,32 +299,38 @@ static void write_thread(const size_t num_words32){
 
         //print_pkt(pkt);
 
-        //commit the packet
+        //commit the packet, the kernel is notified per batch
         info.len = pkt_tmp.hdr.words32*sizeof(boost::uint32_t);
         info.flags = RB_USER;
-        ::write(fp, NULL, 0);
+        if (batch_count++ == 0) batch_start = index;
+        if (batch_count == batch){
+            commit_frames(batch_start, batch_count);
+            boost::mutex::scoped_lock lock(flight_mutex);
+            sent_frames += batch_count;
+            batch_count = 0;
+        }
 
         //increment index and wrap around to zero
         index++;
         if (index == size_t(rb_size.num_tx_frames)) index = 0;
     }
+
+    commit_frames(batch_start, batch_count);
 }
 
 /***********************************************************************
  * Setup memory mapped ring buffer
  **********************************************************************/
 static void setup_ring(void){
-    std::cout << "setup memory mapped ring buffer... " << std::flush;
-
     //calculate various sizes
     const size_t page_size = getpagesize();
     ioctl(fp, USRP_E_GET_RB_INFO, &rb_size);
-    const size_t map_size = (rb_size.num_pages_rx_flags + rb_size.num_pages_tx_flags) * page_size +
+    map_size = (rb_size.num_pages_rx_flags + rb_size.num_pages_tx_flags) * page_size +
         (rb_size.num_rx_frames + rb_size.num_tx_frames) * (page_size >> 1);
 
     //call into memory map
-    void *mem = ::mmap(0, map_size, PROT_READ|PROT_WRITE, MAP_SHARED, fp, 0);
-    if (mem == MAP_FAILED) {
+    map_mem = ::mmap(0, map_size, PROT_READ|PROT_WRITE, MAP_SHARED, fp, 0);
+    if (map_mem == MAP_FAILED) {
         std::cerr << "mmap failed" << std::endl;
         std::exit(-1);
     }
@@ -214,13 +344,91 @@ static void setup_ring(void){
     //set the internal pointers for info and buffers
     typedef ring_buffer_info (*rbi_pta)[];
     typedef loopback_pkt_type (*pkt_pta)[];
-    char *rb_ptr = reinterpret_cast<char *>(mem);
+    char *rb_ptr = reinterpret_cast<char *>(map_mem);
     recv_info = reinterpret_cast<rbi_pta>(rb_ptr + recv_info_off);
     recv_buff = reinterpret_cast<pkt_pta>(rb_ptr + recv_buff_off);
     send_info = reinterpret_cast<rbi_pta>(rb_ptr + send_info_off);
     send_buff = reinterpret_cast<pkt_pta>(rb_ptr + send_buff_off);
+}
+
+/***********************************************************************
+ * Open the device in loopback mode with cleared FIFOs
+ **********************************************************************/
+static void open_loopback(void){
+    if ((fp = ::open("/dev/usrp_e0", O_RDWR)) < 0){
+        std::cerr << "Open failed" << std::endl;
+        std::exit(-1);
+    }
 
-    std::cout << "done" << std::endl;
+    //set the mode to loopback
+    poke16(E100_REG_MISC_XFER_RATE, (1<<8) | (1<<9));
+
+    //clear FIFO state in FPGA and kernel
+    poke32(E100_REG_CLEAR_RX, 0);
+    poke32(E100_REG_CLEAR_TX, 0);
+    ::close(fp);
+    if ((fp = ::open("/dev/usrp_e0", O_RDWR)) < 0){
+        std::cerr << "Open failed" << std::endl;
+        std::exit(-1);
+    }
+
+    //setup the ring buffer
+    setup_ring();
+}
+
+/***********************************************************************
+ * Run one loopback test and print its results as a row
+ **********************************************************************/
+static boost::uint64_t run_loopback(
+    const double duration, const size_t nwords,
+    size_t num_frames, const size_t batch
+){
+    open_loopback();
+    if (num_frames == 0 or num_frames > size_t(rb_size.num_tx_frames)) num_frames = rb_size.num_tx_frames;
+
+    //reset the state of the last run
+    running = true;
+    seq_errors = checksum_errors = 0;
+    sent_words32 = recvd_words32 = 0;
+    sent_frames = recvd_frames = 0;
+    latency_hist.assign(max_latency_us + 1, 0);
+    latency_min_us = ~boost::uint64_t(0);
+    latency_max_us = latency_sum_us = 0;
+
+    //spawn threads
+    boost::thread_group tg;
+    tg.create_thread(boost::bind(&read_thread, batch));
+    tg.create_thread(boost::bind(&write_thread, nwords, num_frames, batch));
+
+    const boost::system_time start_time = boost::get_system_time();
+    const boost::system_time finish_time = start_time + boost::posix_time::milliseconds(long(duration*1000));
+    while (running and boost::get_system_time() < finish_time){
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    running = false;
+    tg.join_all();
+    const double elapsed = (boost::get_system_time() - start_time).total_microseconds()/1e6;
+
+    ::munmap(map_mem, map_size);
+    ::close(fp);
+
+    //print the results
+    const double bytes_per_word = sizeof(boost::uint32_t);
+    std::cout << boost::format(
+        "%6u %6u %10.3f %10.3f %10.0f %8u %8.1f %8.0f %8.0f %8u %6u %6u"
+    )
+        % num_frames % batch
+        % (sent_words32*bytes_per_word/elapsed/1e6)
+        % (recvd_words32*bytes_per_word/elapsed/1e6)
+        % (recvd_frames/elapsed)
+        % ((recvd_frames == 0)? 0 : latency_min_us)
+        % ((recvd_frames == 0)? 0 : double(latency_sum_us)/recvd_frames)
+        % latency_percentile(0.5) % latency_percentile(0.99)
+        % latency_max_us
+        % seq_errors % checksum_errors
+    << std::endl;
+
+    return seq_errors + checksum_errors;
 }
 
 /***********************************************************************
@@ -233,14 +441,17 @@ int main(int argc, char *argv[]){
     //variables to be set by po
     double duration;
     size_t nwords;
+    std::string frames, batches;
 
     //setup the program options
     namespace po = boost::program_options;
     po::options_description desc("Allowed options");
     desc.add_options()
         ("help", "help message")
-        ("duration", po::value<double>(&duration)->default_value(10), "number of seconds to run loopback")
+        ("duration", po::value<double>(&duration)->default_value(10), "number of seconds to run each loopback test")
         ("nwords", po::value<size_t>(&nwords)->default_value(400), "number of words32 to send per packet")
+        ("frames", po::value<std::string>(&frames)->default_value("0"), "comma separated numbers of frames in flight (0 for the whole ring)")
+        ("batch", po::value<std::string>(&batches)->default_value("1"), "comma separated numbers of frames per claim and commit")
     ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -249,51 +460,32 @@ int main(int argc, char *argv[]){
     //print the help message
     if (vm.count("help")){
         std::cout << boost::format("UHD USRP-E-Loopback %s") % desc << std::endl;
+        std::cout
+            << "Runs one loopback test per combination of frames and batch," << std::endl
+            << "and prints the rates in MB/s and the frame latencies in us." << std::endl
+            << "Example: usrp-e-loopback --frames=1,4,16,0 --batch=1,8" << std::endl
+            << std::endl;
         return ~0;
     }
 
-    if ((fp = ::open("/dev/usrp_e0", O_RDWR)) < 0){
-        std::cerr << "Open failed" << std::endl;
-        return -1;
-    }
-
-    //set the mode to loopback
-    poke16(E100_REG_MISC_XFER_RATE, (1<<8) | (1<<9));
-
-    //clear FIFO state in FPGA and kernel
-    poke32(E100_REG_CLEAR_RX, 0);
-    poke32(E100_REG_CLEAR_TX, 0);
-    ::close(fp);
-    if ((fp = ::open("/dev/usrp_e0", O_RDWR)) < 0){
-        std::cerr << "Open failed" << std::endl;
+    const size_t max_nwords = sizeof(loopback_pkt_type::data)/sizeof(boost::uint32_t);
+    if (nwords > max_nwords){
+        std::cerr << boost::format("nwords must be at most %u") % max_nwords << std::endl;
         return -1;
     }
 
-    //setup the ring buffer
-    setup_ring();
-
-    //spawn threads
-    boost::thread_group tg;
-    tg.create_thread(boost::bind(&read_thread));
-    tg.create_thread(boost::bind(&write_thread, nwords));
+    std::cout << boost::format(
+        "%6s %6s %10s %10s %10s %8s %8s %8s %8s %8s %6s %6s"
+    ) % "frames" % "batch" % "tx_MB/s" % "rx_MB/s" % "frames/s"
+      % "lat_min" % "lat_avg" % "lat_p50" % "lat_p99" % "lat_max" % "seq" % "csum"
+    << std::endl;
 
-    const boost::system_time start_time = boost::get_system_time();
-    const boost::system_time finish_time = start_time + boost::posix_time::milliseconds(long(duration*1000));
-    while (boost::get_system_time() < finish_time){
-        boost::this_thread::sleep(boost::posix_time::milliseconds(1000));
-        std::cerr << ".";
+    boost::uint64_t errors = 0;
+    BOOST_FOREACH(const size_t num_frames, split_list<size_t>(frames)){
+        BOOST_FOREACH(const size_t batch, split_list<size_t>(batches)){
+            errors += run_loopback(duration, nwords, num_frames, std::max<size_t>(batch, 1));
+        }
     }
-    running = false;
-    tg.join_all();
-
-    std::cout << std::endl;
-    std::cout << "seq_errors          " << seq_errors << std::endl;
-    std::cout << "checksum_errors     " << checksum_errors << std::endl;
-    std::cout << "sent_words32        " << sent_words32 << std::endl;
-    std::cout << "recvd_words32       " << recvd_words32 << std::endl;
-    std::cout << "approx send rate    " << (sent_words32/duration)/1e6 << "Msps" << std::endl;
-    std::cout << "approx recv rate    " << (recvd_words32/duration)/1e6 << "Msps" << std::endl;
 
-    ::close(fp);
-    return seq_errors + checksum_errors;
+    return errors;
 }
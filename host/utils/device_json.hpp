@@ -0,0 +1,77 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_DEVICE_JSON_HPP
+#define INCLUDED_UHD_UTILS_DEVICE_JSON_HPP
+
+#include <uhd/types/dict.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {/*anon*/
+
+    /***********************************************************************
+     * Machine readable output of the utilities:
+     * Helpers to write JSON values, the utilities compose the documents.
+     **********************************************************************/
+    std::string json_quote(const std::string &str){
+        std::stringstream ss;
+        ss << '"';
+        BOOST_FOREACH(const char ch, str){
+            switch(ch){
+            case '"': ss << "\\\""; break;
+            case '\\': ss << "\\\\"; break;
+            case '\n': ss << "\\n"; break;
+            case '\r': ss << "\\r"; break;
+            case '\t': ss << "\\t"; break;
+            default:
+                if ((unsigned char)(ch) < 0x20) ss << boost::format("\\u%04x") % int(ch);
+                else ss << ch;
+            }
+        }
+        ss << '"';
+        return ss.str();
+    }
+
+    std::string json_array(const std::vector<std::string> &values){
+        std::stringstream ss;
+        ss << "[";
+        for (size_t i = 0; i < values.size(); i++){
+            ss << ((i)? ", " : "") << json_quote(values[i]);
+        }
+        ss << "]";
+        return ss.str();
+    }
+
+    //! An object of the key/value pairs, ex: a device address or an eeprom
+    std::string json_object(const uhd::dict<std::string, std::string> &addr){
+        std::stringstream ss;
+        ss << "{";
+        size_t count = 0;
+        BOOST_FOREACH(const std::string &key, addr.keys()){
+            ss << ((count++)? ", " : "") << json_quote(key) << ": " << json_quote(addr[key]);
+        }
+        ss << "}";
+        return ss.str();
+    }
+
+} //namespace /*anon*/
+
+#endif /* INCLUDED_UHD_UTILS_DEVICE_JSON_HPP */
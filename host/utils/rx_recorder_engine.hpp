@@ -0,0 +1,435 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_RX_RECORDER_ENGINE_HPP
+#define INCLUDED_UHD_UTILS_RX_RECORDER_ENGINE_HPP
+
+/***********************************************************************
+ * The receive to disk engine of uhd_rx_recorder, shared with the
+ * examples that record. The build defines HAVE_O_DIRECT for the
+ * sources that include it when the platform has direct I/O.
+ **********************************************************************/
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/capture_index.hpp>
+#include <uhd/device.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef HAVE_O_DIRECT
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {/*anon*/
+
+    //direct I/O needs the memory, offsets and lengths aligned to the disk blocks
+    static const size_t disk_align = 4096;
+
+    /***********************************************************************
+     * File sink: writes with O_DIRECT where supported
+     **********************************************************************/
+    class file_sink : boost::noncopyable{
+    public:
+        typedef boost::shared_ptr<file_sink> sptr;
+
+        file_sink(const std::string &path, bool direct):
+            _path(path), _direct(false)
+        {
+#ifdef HAVE_O_DIRECT
+            if (direct){
+                _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+                if (_fd >= 0) _direct = true;
+                else std::cerr << boost::format(
+                    "Direct I/O not available for %s, using buffered writes") % path << std::endl;
+            }
+            if (not _direct) _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (_fd < 0) throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+#else
+            if (direct) std::cerr << "Direct I/O not supported, using buffered writes" << std::endl;
+            _file.open(path.c_str(), std::ofstream::binary);
+            if (not _file.is_open()) throw std::runtime_error("Cannot open " + path);
+#endif
+        }
+
+        ~file_sink(void){
+#ifdef HAVE_O_DIRECT
+            ::close(_fd);
+#endif
+        }
+
+        //! Write aligned memory, only the last write may have an unaligned length
+        void write(const char *mem, size_t num_bytes){
+#ifdef HAVE_O_DIRECT
+            const size_t tail = (_direct)? num_bytes % disk_align : 0;
+            this->write_all(mem, num_bytes - tail);
+            if (tail != 0){
+                //drop out of direct I/O for the unaligned end of the recording
+                ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) & ~O_DIRECT);
+                _direct = false;
+                this->write_all(mem + num_bytes - tail, tail);
+            }
+#else
+            _file.write(mem, num_bytes);
+            if (_file.fail()) throw std::runtime_error("Cannot write to " + _path);
+#endif
+        }
+
+        bool is_direct(void) const{
+            return _direct;
+        }
+
+    private:
+#ifdef HAVE_O_DIRECT
+        void write_all(const char *mem, size_t num_bytes){
+            while (num_bytes != 0){
+                const ssize_t ret = ::write(_fd, mem, num_bytes);
+                if (ret < 0 and errno == EINTR) continue;
+                if (ret <= 0) throw std::runtime_error("Cannot write to " + _path + ": " + std::strerror(errno));
+                mem += ret; num_bytes -= size_t(ret);
+            }
+        }
+        int _fd;
+#else
+        std::ofstream _file;
+#endif
+        const std::string _path;
+        bool _direct;
+    };
+
+    /***********************************************************************
+     * Block pool: one aligned region per channel in each block
+     **********************************************************************/
+    struct block_t{
+        std::vector<char *> chans;
+        size_t num_bytes; //valid bytes in each channel region
+        std::vector<uhd::capture_index_entry_t> entries; //offsets within the block
+    };
+
+    class block_pool : boost::noncopyable{
+    public:
+        block_pool(size_t num_blocks, size_t num_chans, size_t block_bytes):
+            free_blocks(num_blocks), full_blocks(num_blocks + 1),
+            _mem(new char[num_blocks*num_chans*block_bytes + disk_align]),
+            _blocks(num_blocks)
+        {
+            char *mem = _mem.get() + (disk_align - size_t(_mem.get()) % disk_align) % disk_align;
+            for (size_t i = 0; i < num_blocks; i++){
+                for (size_t ch = 0; ch < num_chans; ch++){
+                    _blocks[i].chans.push_back(mem); mem += block_bytes;
+                }
+                free_blocks.push_with_haste(&_blocks[i]);
+            }
+        }
+
+        uhd::transport::bounded_buffer<block_t *> free_blocks, full_blocks;
+
+    private:
+        boost::shared_array<char> _mem;
+        std::vector<block_t> _blocks;
+    };
+
+    /***********************************************************************
+     * Recorder accounting
+     **********************************************************************/
+    struct recorder_stats_t{
+        size_t num_overflows, num_timeouts;
+        size_t num_drops, num_dropped_bytes;
+        size_t num_written_bytes, max_pending_blocks;
+        uhd::atomic_uint32_t num_pending_blocks;
+        bool has_first_time;
+        uhd::time_spec_t first_time; //of the first sample received
+        recorder_stats_t(void):
+            num_overflows(0), num_timeouts(0), num_drops(0),
+            num_dropped_bytes(0), num_written_bytes(0), max_pending_blocks(0),
+            has_first_time(false)
+        {}
+    };
+
+    /***********************************************************************
+     * Receive side: fills one block with converted or otw samples
+     **********************************************************************/
+    class block_receiver{
+    public:
+        block_receiver(uhd::device::sptr dev, const std::string &type, double rate, const bool &stop):
+            _dev(dev), _otw(type == "otw"), _view_offset(0), _otw_item_size(4),
+            _io_type((type == "short")? uhd::io_type_t::COMPLEX_INT16 : uhd::io_type_t::COMPLEX_FLOAT32),
+            _rate(rate), _stop(stop), _lost(false), _timeout(0.1)
+        {
+            if (type != "float" and type != "short" and type != "otw"){
+                throw std::runtime_error("Unknown type " + type);
+            }
+        }
+
+        //! Get the bytes per sample, the otw size is known after the first packet
+        size_t get_item_size(void) const{
+            return (_otw)? _otw_item_size : _io_type.size;
+        }
+
+        //! Mark the samples since the last entry as lost, ex: a dropped block
+        void mark_lost(void){
+            _lost = true;
+        }
+
+        //! Wait this long for the first samples, ex: a stream at a future time
+        void set_start_delay(double delay){
+            _timeout = delay + 0.1;
+        }
+
+        //! Fill the block, returns false once the stream is done
+        bool fill(block_t &block, size_t max_bytes, recorder_stats_t &stats){
+            block.num_bytes = 0;
+            block.entries.clear();
+            while (max_bytes - block.num_bytes >= this->get_item_size() and not _stop){
+                uhd::rx_metadata_t md;
+                const size_t num_bytes = (_otw)?
+                    this->recv_otw(block, max_bytes, md) :
+                    this->recv_converted(block, max_bytes, md);
+
+                //index the start of each block and each run after lost samples
+                if (num_bytes != 0 and (block.num_bytes == 0 or _lost)){
+                    uhd::capture_index_entry_t entry;
+                    entry.offset = block.num_bytes;
+                    entry.has_time = md.has_time_spec;
+                    entry.time = md.time_spec;
+                    entry.overflow = _lost;
+                    block.entries.push_back(entry);
+                    _lost = false;
+                    if (not stats.has_first_time and md.has_time_spec){
+                        stats.has_first_time = true;
+                        stats.first_time = md.time_spec;
+                    }
+                }
+                block.num_bytes += num_bytes;
+
+                switch(md.error_code){
+                case uhd::rx_metadata_t::ERROR_CODE_NONE: break;
+                case uhd::rx_metadata_t::ERROR_CODE_OVERFLOW: stats.num_overflows++; _lost = true; break;
+                case uhd::rx_metadata_t::ERROR_CODE_TIMEOUT: stats.num_timeouts++; return false;
+                default: throw std::runtime_error(str(boost::format(
+                    "Unexpected error code 0x%x") % md.error_code
+                ));
+                }
+            }
+            return not _stop;
+        }
+
+    private:
+        size_t recv_converted(block_t &block, size_t max_bytes, uhd::rx_metadata_t &md){
+            std::vector<void *> buffs;
+            for (size_t ch = 0; ch < block.chans.size(); ch++){
+                buffs.push_back(block.chans[ch] + block.num_bytes);
+            }
+            return _io_type.size*_dev->recv(
+                buffs, (max_bytes - block.num_bytes)/_io_type.size, md, _io_type,
+                uhd::device::RECV_MODE_FULL_BUFF, this->get_timeout()
+            );
+        }
+
+        size_t recv_otw(block_t &block, size_t max_bytes, uhd::rx_metadata_t &md){
+            //a packet that did not fit into the last block continues here
+            if (_view_offset == _view.nsamps){
+                _view_offset = 0;
+                if (_dev->recv_view(_view, this->get_timeout()) == 0){
+                    md = _view.metadata;
+                    if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_NONE){
+                        md.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+                    }
+                    return 0;
+                }
+                _otw_item_size = _view.item_size;
+            }
+            //the time of a packet that continues from the last block
+            md = _view.metadata;
+            if (md.has_time_spec) md.time_spec += uhd::time_spec_t(0, long(_view_offset), _rate);
+            md.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+            const size_t num_items = std::min(
+                _view.nsamps - _view_offset, (max_bytes - block.num_bytes)/_otw_item_size
+            );
+            for (size_t ch = 0; ch < block.chans.size(); ch++){
+                std::memcpy(
+                    block.chans[ch] + block.num_bytes,
+                    static_cast<const char *>(_view.payloads[ch]) + _view_offset*_otw_item_size,
+                    num_items*_otw_item_size
+                );
+            }
+            _view_offset += num_items;
+            if (_view_offset == _view.nsamps){
+                _view.release();
+                _view_offset = 0;
+            }
+            return num_items*_otw_item_size;
+        }
+
+        //! The timeout of the next receive, short after the first one
+        double get_timeout(void){
+            const double timeout = _timeout;
+            _timeout = 0.1;
+            return timeout;
+        }
+
+        uhd::device::sptr _dev;
+        const bool _otw;
+        uhd::device::recv_view_t _view;
+        size_t _view_offset, _otw_item_size;
+        const uhd::io_type_t _io_type;
+        const double _rate;
+        const bool &_stop;
+        bool _lost;
+        double _timeout;
+    };
+
+    /***********************************************************************
+     * Writer thread: drains the full blocks to the files
+     **********************************************************************/
+    static void writer_loop(
+        block_pool &pool, std::vector<file_sink::sptr> &files, recorder_stats_t &stats,
+        const std::string &index_file, const block_receiver &receiver, double rate
+    ){
+        uhd::capture_index_writer::sptr index;
+        block_t *block;
+        while (true){
+            pool.full_blocks.pop_with_wait(block);
+            if (block == NULL) return; //the receive side is done
+
+            //the otw item size is known once the first block is full
+            if (index.get() == NULL) index = uhd::capture_index_writer::make(
+                index_file, receiver.get_item_size(), rate, files.size()
+            );
+            BOOST_FOREACH(uhd::capture_index_entry_t entry, block->entries){
+                entry.offset += stats.num_written_bytes;
+                index->append(entry);
+            }
+
+            for (size_t ch = 0; ch < files.size(); ch++){
+                files[ch]->write(block->chans[ch], block->num_bytes);
+            }
+            stats.num_written_bytes += block->num_bytes;
+            stats.num_pending_blocks.dec();
+            pool.free_blocks.push_with_haste(block);
+        }
+    }
+
+    static std::string channel_file_name(const std::string &file, size_t num_chans, size_t ch){
+        if (num_chans == 1) return file;
+        const size_t dot = file.find_last_of('.');
+        const std::string ext = (dot == std::string::npos)? "" : file.substr(dot);
+        return str(boost::format("%s.ch%u%s") % file.substr(0, file.size() - ext.size()) % ch % ext);
+    }
+
+    /***********************************************************************
+     * Block recorder: a receiver, a block pool, and a writer thread,
+     * records the channels of one device to one file per channel.
+     * The receive side never waits on the disk: when no block is free,
+     * the samples go to a scratch block and are marked lost in the index.
+     **********************************************************************/
+    class block_recorder : boost::noncopyable{
+    public:
+        block_recorder(
+            uhd::device::sptr dev, const std::string &type, double rate, size_t num_chans,
+            const std::string &file, size_t spb, size_t num_blocks, bool direct, const bool &stop
+        ):
+            _receiver(dev, type, rate, stop),
+            _block_bytes(((spb*_receiver.get_item_size() + disk_align - 1)/disk_align)*disk_align),
+            _pool(num_blocks, num_chans, _block_bytes),
+            _scratch_mem(new char[num_chans*_block_bytes]),
+            _index_file(file + ".idx"), _rate(rate)
+        {
+            for (size_t ch = 0; ch < num_chans; ch++){
+                _scratch.chans.push_back(_scratch_mem.get() + ch*_block_bytes);
+                _files.push_back(file_sink::sptr(new file_sink(channel_file_name(file, num_chans, ch), direct)));
+            }
+        }
+
+        file_sink::sptr get_file(size_t ch) const{
+            return _files[ch];
+        }
+
+        const std::string &get_index_file(void) const{
+            return _index_file;
+        }
+
+        size_t get_item_size(void) const{
+            return _receiver.get_item_size();
+        }
+
+        const recorder_stats_t &get_stats(void) const{
+            return _stats;
+        }
+
+        //! Wait this long for the first samples, ex: a stream at a future time
+        void set_start_delay(double delay){
+            _receiver.set_start_delay(delay);
+        }
+
+        //! Record until the stream is done or total_num_samps per channel (0 for no limit)
+        void run(size_t total_num_samps){
+            boost::thread writer(boost::bind(
+                &writer_loop, boost::ref(_pool), boost::ref(_files), boost::ref(_stats),
+                _index_file, boost::cref(_receiver), _rate
+            ));
+
+            size_t num_acc_bytes = 0;
+            bool streaming = true;
+            while (streaming and (total_num_samps == 0 or num_acc_bytes/_receiver.get_item_size() < total_num_samps)){
+                block_t *block;
+                if (not _pool.free_blocks.pop_with_haste(block)){
+                    //the disk is behind: keep the stream flowing but lose this block
+                    streaming = _receiver.fill(_scratch, _block_bytes, _stats);
+                    _stats.num_drops++;
+                    _stats.num_dropped_bytes += _scratch.num_bytes;
+                    num_acc_bytes += _scratch.num_bytes;
+                    _receiver.mark_lost();
+                    continue;
+                }
+                streaming = _receiver.fill(*block, _block_bytes, _stats);
+                num_acc_bytes += block->num_bytes;
+                const size_t pending = _stats.num_pending_blocks.inc() + 1;
+                _stats.max_pending_blocks = std::max(_stats.max_pending_blocks, pending);
+                _pool.full_blocks.push_with_haste(block);
+            }
+
+            _pool.full_blocks.push_with_wait(NULL);
+            writer.join();
+        }
+
+    private:
+        block_receiver _receiver;
+        const size_t _block_bytes;
+        block_pool _pool;
+        block_t _scratch;
+        boost::shared_array<char> _scratch_mem;
+        std::vector<file_sink::sptr> _files;
+        const std::string _index_file;
+        const double _rate;
+        recorder_stats_t _stats;
+    };
+
+} //namespace /*anon*/
+
+#endif /* INCLUDED_UHD_UTILS_RX_RECORDER_ENGINE_HPP */
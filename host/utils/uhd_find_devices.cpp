@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "device_json.hpp"
 #include <uhd/utils/safe_main.hpp>
 #include <uhd/device.hpp>
 #include <boost/program_options.hpp>
@@ -28,6 +29,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     desc.add_options()
         ("help", "help message")
         ("args", po::value<std::string>()->default_value(""), "device address args")
+        ("json", "print the results as a JSON array of device addresses")
     ;
 
     po::variables_map vm;
@@ -43,6 +45,15 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     //discover the usrps and print the results
     uhd::device_addrs_t device_addrs = uhd::device::find(vm["args"].as<std::string>());
 
+    if (vm.count("json")){
+        std::cout << "[";
+        for (size_t i = 0; i < device_addrs.size(); i++){
+            std::cout << ((i)? "," : "") << std::endl << "  " << json_object(device_addrs[i]);
+        }
+        std::cout << std::endl << "]" << std::endl;
+        return (device_addrs.size() == 0)? ~0 : 0;
+    }
+
     if (device_addrs.size() == 0){
         std::cerr << "No UHD Devices Found" << std::endl;
         return ~0;
@@ -0,0 +1,90 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/usrp/property_broker.hpp>
+#include <boost/program_options.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <iostream>
+
+namespace po = boost::program_options;
+using namespace uhd::usrp;
+
+//! Print the properties under a path, one per line with the value
+static void print_tree(property_client::sptr client, const uhd::fs_path &path){
+    const std::vector<std::string> names = client->list(path);
+    if (names.empty()){
+        const std::string type = client->get_type(path);
+        std::string value = "<" + type + ">";
+        if (type != "unknown"){
+            try{value = client->get(path);}
+            catch(const std::exception &e){value = "<" + std::string(e.what()) + ">";}
+        }
+        std::cout << path << " = " << value << std::endl;
+    }
+    BOOST_FOREACH(const std::string &name, names) print_tree(client, path / name);
+}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    std::string socket, op, path, value;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("socket", po::value<std::string>(&socket)->default_value("/tmp/uhd_props"), "the prop_socket of the device owner")
+        ("op", po::value<std::string>(&op)->default_value("tree"), "the operation: tree, list, type, get, or set")
+        ("path", po::value<std::string>(&path)->default_value("/"), "the path of the property or directory")
+        ("value", po::value<std::string>(&value), "the new value for a set")
+    ;
+    po::positional_options_description pos;
+    pos.add("op", 1).add("path", 1).add("value", 1);
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).positional(pos).run(), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Property %s") % desc << std::endl;
+        std::cout
+            << "Reads and writes the property tree of a device in another process," << std::endl
+            << "opened with the device address key prop_socket=<socket>." << std::endl
+            << "Ex: uhd_property set /mboards/0/rx_dsps/0/freq/value 1e6" << std::endl
+            << std::endl;
+        return ~0;
+    }
+
+    property_client::sptr client = property_client::make(socket);
+    if (op == "tree") print_tree(client, path);
+    else if (op == "list"){
+        BOOST_FOREACH(const std::string &name, client->list(path)) std::cout << name << std::endl;
+    }
+    else if (op == "type") std::cout << client->get_type(path) << std::endl;
+    else if (op == "get") std::cout << client->get(path) << std::endl;
+    else if (op == "set"){
+        if (not vm.count("value")){
+            std::cerr << "a set needs a value" << std::endl;
+            return ~0;
+        }
+        std::cout << client->set(path, value) << std::endl;
+    }
+    else{
+        std::cerr << "unknown operation: " << op << std::endl;
+        return ~0;
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "rx_recorder_engine.hpp"
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/exception.hpp>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/thread.hpp>
+#include <iostream>
+#include <csignal>
+#include <complex>
+
+namespace po = boost::program_options;
+
+static bool stop_signal_called = false;
+void sig_int_handler(int){stop_signal_called = true;}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    std::string args, file, type, ant, subdev;
+    size_t total_num_samps, spb, num_blocks;
+    double rate, freq, gain;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "multi uhd device address args")
+        ("file", po::value<std::string>(&file)->default_value("usrp_samples.dat"), "name of the file to write binary samples to")
+        ("type", po::value<std::string>(&type)->default_value("short"), "sample type: float, short, or otw (raw items without conversion)")
+        ("nsamps", po::value<size_t>(&total_num_samps)->default_value(0), "total number of samples to receive per channel")
+        ("spb", po::value<size_t>(&spb)->default_value(1 << 18), "samples per buffer per channel")
+        ("nbuffs", po::value<size_t>(&num_blocks)->default_value(32), "number of buffers between receive and disk")
+        ("rate", po::value<double>(&rate), "rate of incoming samples")
+        ("freq", po::value<double>(&freq), "RF center frequency in Hz")
+        ("gain", po::value<double>(&gain), "gain for the RF chain")
+        ("ant", po::value<std::string>(&ant), "daughterboard antenna selection")
+        ("subdev", po::value<std::string>(&subdev), "daughterboard subdevice specification, one channel per subdevice")
+        ("buffered", "use buffered writes instead of direct I/O")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help") or not vm.count("rate") or not vm.count("freq")){
+        std::cout << boost::format("UHD RX Recorder %s") % desc << std::endl;
+        std::cout <<
+            "    Record one or more channels to disk with a receive thread and a writer thread.\n"
+            "    Each channel goes to its own file when there is more than one.\n"
+            "    The otw type records the raw items in the device byte order.\n"
+            "    The <file>.idx index maps the device time to the offset in the files.\n"
+            << std::endl;
+        return ~0;
+    }
+
+    //create a usrp device
+    std::cout << std::endl;
+    std::cout << boost::format("Creating the usrp device with: %s...") % args << std::endl;
+    uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(args);
+
+    //always select the subdevice first, the channel mapping affects the other settings
+    if (vm.count("subdev")) usrp->set_rx_subdev_spec(subdev);
+    std::cout << boost::format("Using Device: %s") % usrp->get_pp_string() << std::endl;
+
+    std::cout << boost::format("Setting RX Rate: %f Msps...") % (rate/1e6) << std::endl;
+    usrp->set_rx_rate(rate);
+    std::cout << boost::format("Actual RX Rate: %f Msps...") % (usrp->get_rx_rate()/1e6) << std::endl << std::endl;
+
+    const size_t num_chans = usrp->get_rx_num_channels();
+    for (size_t ch = 0; ch < num_chans; ch++){
+        usrp->set_rx_freq(freq, ch);
+        if (vm.count("gain")) usrp->set_rx_gain(gain, ch);
+        if (vm.count("ant")) usrp->set_rx_antenna(ant, ch);
+    }
+    std::cout << boost::format("Actual RX Freq: %f MHz...") % (usrp->get_rx_freq()/1e6) << std::endl << std::endl;
+
+    boost::this_thread::sleep(boost::posix_time::seconds(1)); //allow for some setup time
+
+    //record through a block pool drained by a writer thread
+    block_recorder recorder(
+        usrp->get_device(), type, usrp->get_rx_rate(), num_chans,
+        file, spb, num_blocks, not vm.count("buffered"), stop_signal_called
+    );
+    for (size_t ch = 0; ch < num_chans; ch++){
+        std::cout << boost::format("Recording channel %u to %s%s")
+            % ch % channel_file_name(file, num_chans, ch)
+            % ((recorder.get_file(ch)->is_direct())? " (direct I/O)" : "") << std::endl;
+    }
+    std::cout << boost::format("Indexing the recording to %s") % recorder.get_index_file() << std::endl;
+
+    //setup streaming
+    uhd::stream_cmd_t stream_cmd((total_num_samps == 0)?
+        uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS:
+        uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE
+    );
+    stream_cmd.num_samps = total_num_samps;
+    stream_cmd.stream_now = true;
+    usrp->issue_stream_cmd(stream_cmd);
+    std::signal(SIGINT, &sig_int_handler);
+    std::cout << "Press Ctrl + C to stop recording..." << std::endl;
+
+    //receive into free blocks, never wait on the disk
+    recorder.run(total_num_samps);
+    if (total_num_samps == 0) usrp->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+    const recorder_stats_t &stats = recorder.get_stats();
+
+    //finished
+    std::cout << std::endl << boost::format(
+        "Recorded %u samples per channel (%u channels, %u bytes each)\n"
+        "Device overflows: %u, receive timeouts: %u\n"
+        "Dropped buffers: %u (%u samples per channel)\n"
+        "Peak buffers waiting on disk: %u of %u"
+    ) % (stats.num_written_bytes/recorder.get_item_size()) % num_chans % stats.num_written_bytes
+      % stats.num_overflows % stats.num_timeouts
+      % stats.num_drops % (stats.num_dropped_bytes/recorder.get_item_size())
+      % stats.max_pending_blocks % num_blocks << std::endl;
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/sample_buffer.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/transport/transport_profile.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <iostream>
+#include <complex>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace po = boost::program_options;
+
+/***********************************************************************
+ * The parameter grid: a list of hint keys and their candidate values
+ **********************************************************************/
+typedef std::vector<std::pair<std::string, std::vector<std::string> > > grid_type;
+
+static void set_grid_entry(grid_type &grid, const std::string &key, const std::string &values){
+    std::vector<std::string> toks;
+    boost::split(toks, values, boost::is_any_of(" "), boost::token_compress_on);
+    for (size_t i = 0; i < grid.size(); i++){
+        if (grid[i].first == key){
+            grid[i].second = toks;
+            return;
+        }
+    }
+    grid.push_back(std::make_pair(key, toks));
+}
+
+//! Get every combination of the grid values as hints
+static std::vector<uhd::device_addr_t> get_grid_points(const grid_type &grid){
+    std::vector<uhd::device_addr_t> points(1);
+    for (size_t i = 0; i < grid.size(); i++){
+        std::vector<uhd::device_addr_t> next;
+        BOOST_FOREACH(const uhd::device_addr_t &point, points){
+            BOOST_FOREACH(const std::string &value, grid[i].second){
+                next.push_back(point);
+                next.back()[grid[i].first] = value;
+            }
+        }
+        points = next;
+    }
+    return points;
+}
+
+/***********************************************************************
+ * A trial: stream with one set of hints for the duration
+ **********************************************************************/
+struct trial_result_t{
+    bool made;
+    double samps_per_sec;
+    size_t num_errors; //overflows or underflows
+    double cpu_load; //the process cpu time over the wall clock time
+    trial_result_t(void): made(false), samps_per_sec(0), num_errors(0), cpu_load(0){}
+
+    //! The stream kept up: no errors and nearly the requested rate
+    bool ok(double rate) const{
+        return made and num_errors == 0 and samps_per_sec >= 0.95*rate;
+    }
+};
+
+static uhd::usrp::multi_usrp::sptr make_trial_usrp(const std::string &args, const uhd::device_addr_t &hints){
+    uhd::device_addr_t dev_addr(args);
+    BOOST_FOREACH(const std::string &key, hints.keys()) dev_addr[key] = hints[key];
+    dev_addr["transport_profile"] = "0"; //tune from the defaults, not an old profile
+    return uhd::usrp::multi_usrp::make(dev_addr);
+}
+
+static trial_result_t run_rx_trial(
+    const std::string &args, const uhd::device_addr_t &hints, double rate, double duration
+){
+    trial_result_t result;
+    uhd::usrp::multi_usrp::sptr usrp = make_trial_usrp(args, hints);
+    result.made = true;
+    usrp->set_rx_rate(rate);
+
+    const size_t spp = usrp->get_device()->get_max_recv_samps_per_packet();
+    boost::shared_ptr<std::complex<float> > buff = uhd::alloc_sample_buffer<std::complex<float> >(spp);
+    uhd::rx_metadata_t md;
+
+    size_t num_samps = 0;
+    usrp->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    const std::clock_t cpu_start = std::clock();
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    double elapsed = 0;
+    while (elapsed < duration){
+        num_samps += usrp->get_device()->recv(
+            buff.get(), spp, md, uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::RECV_MODE_ONE_PACKET
+        );
+        if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_NONE) result.num_errors += (md.num_samps_lost == 0)? 0 : 1;
+        else result.num_errors++;
+        elapsed = (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+    }
+    result.cpu_load = double(std::clock() - cpu_start)/CLOCKS_PER_SEC/elapsed;
+    result.samps_per_sec = num_samps/elapsed;
+    usrp->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+
+    //drain the samples in flight
+    while (usrp->get_device()->recv(
+        buff.get(), spp, md, uhd::io_type_t::COMPLEX_FLOAT32,
+        uhd::device::RECV_MODE_ONE_PACKET, 0.1
+    ) != 0){}
+    return result;
+}
+
+static trial_result_t run_tx_trial(
+    const std::string &args, const uhd::device_addr_t &hints, double rate, double duration
+){
+    trial_result_t result;
+    uhd::usrp::multi_usrp::sptr usrp = make_trial_usrp(args, hints);
+    result.made = true;
+    usrp->set_tx_rate(rate);
+
+    const size_t spp = usrp->get_device()->get_max_send_samps_per_packet();
+    boost::shared_ptr<std::complex<float> > buff = uhd::alloc_sample_buffer<std::complex<float> >(spp);
+    uhd::tx_metadata_t md;
+    uhd::async_metadata_t async_md;
+
+    size_t num_samps = 0;
+    const std::clock_t cpu_start = std::clock();
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    double elapsed = 0;
+    while (elapsed < duration){
+        num_samps += usrp->get_device()->send(
+            buff.get(), spp, md, uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::SEND_MODE_ONE_PACKET
+        );
+        while (usrp->get_device()->recv_async_msg(async_md, 0.0)){
+            if (async_md.event_code != uhd::async_metadata_t::EVENT_CODE_BURST_ACK) result.num_errors++;
+        }
+        elapsed = (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+    }
+    result.cpu_load = double(std::clock() - cpu_start)/CLOCKS_PER_SEC/elapsed;
+    result.samps_per_sec = num_samps/elapsed;
+
+    //end the burst
+    md.end_of_burst = true;
+    usrp->get_device()->send("", 0, md, uhd::io_type_t::COMPLEX_FLOAT32, uhd::device::SEND_MODE_FULL_BUFF);
+    return result;
+}
+
+/***********************************************************************
+ * Run the trials of a grid and pick the best set of hints:
+ * The lowest cpu load of the trials that kept up,
+ * otherwise the highest rate of the trials with the fewest errors.
+ **********************************************************************/
+static bool is_better(const trial_result_t &result, const trial_result_t &best, double rate){
+    if (result.ok(rate) != best.ok(rate)) return result.ok(rate);
+    if (result.ok(rate)) return result.cpu_load < best.cpu_load;
+    if (result.num_errors != best.num_errors) return result.num_errors < best.num_errors;
+    return result.samps_per_sec > best.samps_per_sec;
+}
+
+typedef trial_result_t (*trial_fcn_type)(const std::string &, const uhd::device_addr_t &, double, double);
+
+static uhd::device_addr_t tune_grid(
+    const std::string &name, trial_fcn_type trial_fcn, const grid_type &grid,
+    const std::string &args, double rate, double duration
+){
+    const std::vector<uhd::device_addr_t> points = get_grid_points(grid);
+    std::cout << boost::format("Tuning %s at %f Msps with %u trials...") % name % (rate/1e6) % points.size() << std::endl;
+
+    size_t best = points.size();
+    trial_result_t best_result;
+    for (size_t i = 0; i < points.size(); i++){
+        trial_result_t result;
+        try{
+            result = trial_fcn(args, points[i], rate, duration);
+        }
+        catch(const std::exception &e){
+            std::cout << boost::format("  %s: failed: %s") % points[i].to_string() % e.what() << std::endl;
+            continue;
+        }
+        std::cout << boost::format("  %s: %.3f Msps, %u errors, %.1f%% cpu%s")
+            % points[i].to_string() % (result.samps_per_sec/1e6) % result.num_errors
+            % (result.cpu_load*100) % (result.ok(rate)? "" : " (did not keep up)")
+        << std::endl;
+
+        if (best == points.size() or is_better(result, best_result, rate)){
+            best = i;
+            best_result = result;
+        }
+    }
+
+    if (best == points.size()) throw std::runtime_error("every " + name + " trial failed");
+    if (not best_result.ok(rate)) std::cerr << boost::format(
+        "Warning: no %s trial kept up with %f Msps, using the best effort"
+    ) % name % (rate/1e6) << std::endl;
+    std::cout << boost::format("Best %s hints: %s") % name % points[best].to_string() << std::endl << std::endl;
+    return points[best];
+}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    std::string args;
+    double duration, rx_rate, tx_rate;
+    std::vector<std::string> grid_args;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "single uhd device address args")
+        ("duration", po::value<double>(&duration)->default_value(2.0), "duration of each trial in seconds")
+        ("rx_rate", po::value<double>(&rx_rate), "tune the receive hints at this rate (sps)")
+        ("tx_rate", po::value<double>(&tx_rate), "tune the transmit hints at this rate (sps)")
+        ("grid", po::value<std::vector<std::string> >(&grid_args)->composing(), "replace or add a grid entry: \"key=value value...\"")
+        ("dry_run", "print the best hints without saving the profile")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help") or (vm.count("rx_rate") + vm.count("tx_rate")) == 0){
+        std::cout << boost::format("UHD Transport Tuner %s") % desc << std::endl;
+        std::cout <<
+        "    Streams with every combination of the grid values and saves the best\n"
+        "    hints as the transport profile of the device, which device::make() loads.\n"
+        "    Grid keys with \"send\" in the name are tuned with --tx_rate,\n"
+        "    the other keys with --rx_rate, ex: --grid \"pirate_sched=rr fifo:0.5\"\n"
+        << std::endl;
+        return ~0;
+    }
+
+    //the default grids
+    grid_type rx_grid, tx_grid;
+    set_grid_entry(rx_grid, "recv_frame_size", "1472 8000");
+    set_grid_entry(rx_grid, "num_recv_frames", "32 128 512");
+    set_grid_entry(rx_grid, "recv_buff_size", "1e6 10e6 50e6");
+    set_grid_entry(tx_grid, "send_frame_size", "1472 8000");
+    set_grid_entry(tx_grid, "num_send_frames", "32 128 512");
+    set_grid_entry(tx_grid, "send_buff_size", "1e6 10e6");
+    BOOST_FOREACH(const std::string &grid_arg, grid_args){
+        const size_t equal = grid_arg.find('=');
+        if (equal == std::string::npos) throw std::runtime_error("malformed grid entry " + grid_arg);
+        const std::string key = grid_arg.substr(0, equal);
+        set_grid_entry((key.find("send") == std::string::npos)? rx_grid : tx_grid, key, grid_arg.substr(equal+1));
+    }
+
+    //the profile belongs to the discovered device
+    const uhd::device_addrs_t device_addrs = uhd::device::find(args);
+    if (device_addrs.empty()) throw std::runtime_error("No UHD Devices Found");
+    std::cout << boost::format("Tuning the device:\n%s") % device_addrs.front().to_pp_string() << std::endl;
+    const std::string dev_args = device_addrs.front().to_string();
+
+    uhd::device_addr_t profile = uhd::transport::load_transport_profile(device_addrs.front());
+    if (vm.count("rx_rate")){
+        const uhd::device_addr_t best = tune_grid("receive", &run_rx_trial, rx_grid, dev_args, rx_rate, duration);
+        BOOST_FOREACH(const std::string &key, best.keys()) profile[key] = best[key];
+    }
+    if (vm.count("tx_rate")){
+        const uhd::device_addr_t best = tune_grid("transmit", &run_tx_trial, tx_grid, dev_args, tx_rate, duration);
+        BOOST_FOREACH(const std::string &key, best.keys()) profile[key] = best[key];
+    }
+
+    std::cout << boost::format("Transport profile: %s") % profile.to_string() << std::endl;
+    if (not vm.count("dry_run")){
+        const std::string path = uhd::transport::save_transport_profile(device_addrs.front(), profile);
+        std::cout << boost::format("Saved the transport profile to %s") % path << std::endl;
+    }
+
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+    return 0;
+}
@@ -0,0 +1,322 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/capture_index.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/format.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+#include <csignal>
+#include <cstring>
+#include <complex>
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+static bool stop_signal_called = false;
+void sig_int_handler(int){stop_signal_called = true;}
+
+//! The channel data file names of uhd_rx_recorder
+static std::string channel_file_name(const std::string &file, size_t num_chans, size_t ch){
+    if (num_chans == 1) return file;
+    const size_t dot = file.find_last_of('.');
+    const std::string ext = (dot == std::string::npos)? "" : file.substr(dot);
+    return str(boost::format("%s.ch%u%s") % file.substr(0, file.size() - ext.size()) % ch % ext);
+}
+
+/***********************************************************************
+ * Replay plan: the runs of the index within the loop span
+ * A run is contiguous in the files and in time,
+ * a run after lost samples starts a new timed burst.
+ **********************************************************************/
+struct run_t{
+    boost::uint64_t begin, end; //byte offsets in the data files
+    bool has_time, new_burst;
+    uhd::time_spec_t time; //the recording time of the first sample
+};
+
+static std::vector<run_t> make_runs(
+    const uhd::capture_index_reader &index, boost::uint64_t span_begin, boost::uint64_t span_end
+){
+    const std::vector<uhd::capture_index_entry_t> &entries = index.get_entries();
+    std::vector<run_t> runs;
+    for (size_t i = 0; i < entries.size(); i++){
+        run_t run;
+        run.begin = std::max(entries[i].offset, span_begin);
+        run.end = std::min((i+1 < entries.size())? entries[i+1].offset : span_end, span_end);
+        if (run.begin >= run.end) continue;
+        run.has_time = entries[i].has_time;
+        run.time = entries[i].time + uhd::time_spec_t(
+            0, long((run.begin - entries[i].offset)/index.get_item_size()), index.get_rate()
+        );
+        run.new_burst = runs.empty() or entries[i].overflow;
+        runs.push_back(run);
+    }
+    return runs;
+}
+
+/***********************************************************************
+ * Read ahead: map the next chunk of each channel and fault in its pages
+ * on the reader thread, so the send thread never waits on the disk.
+ **********************************************************************/
+struct chunk_t{
+    std::vector<boost::shared_ptr<const void> > regions;
+    size_t num_bytes;
+    bool start_of_burst, end_of_burst, has_time_spec;
+    uhd::time_spec_t time_spec; //the device time of a burst start
+};
+
+typedef boost::shared_ptr<chunk_t> chunk_sptr;
+
+static void touch_pages(const void *mem, size_t num_bytes){
+    volatile const char *bytes = static_cast<const char *>(mem);
+    for (size_t i = 0; i < num_bytes; i += 4096) (void)bytes[i];
+}
+
+static void reader_loop(
+    uhd::transport::bounded_buffer<chunk_sptr> &queue,
+    const std::vector<std::string> &files, const std::vector<run_t> &runs,
+    size_t item_size, double rate, size_t chunk_bytes, size_t num_loops,
+    const uhd::time_spec_t &start_time
+){
+    //the device time follows the recording time from the start of the span
+    const uhd::time_spec_t span_time = runs.front().time;
+    const uhd::time_spec_t span_duration = runs.back().time
+        + uhd::time_spec_t(0, long((runs.back().end - runs.back().begin)/item_size), rate) - span_time;
+
+    for (size_t loop = 0; (num_loops == 0 or loop < num_loops) and not stop_signal_called; loop++){
+        for (size_t r = 0; r < runs.size() and not stop_signal_called; r++){
+            const run_t &run = runs[r];
+            const bool new_burst = run.new_burst or r == 0;
+            const bool last_of_burst = (r+1 == runs.size() or runs[r+1].new_burst);
+            for (boost::uint64_t offset = run.begin; offset < run.end and not stop_signal_called;){
+                chunk_sptr chunk(new chunk_t());
+                chunk->num_bytes = size_t(std::min<boost::uint64_t>(chunk_bytes, run.end - offset));
+                chunk->start_of_burst = new_burst and offset == run.begin;
+                chunk->end_of_burst = last_of_burst and offset + chunk->num_bytes == run.end;
+                chunk->has_time_spec = chunk->start_of_burst and run.has_time;
+                chunk->time_spec = start_time + (run.time - span_time);
+                for (size_t l = 0; l < loop; l++) chunk->time_spec += span_duration;
+                for (size_t ch = 0; ch < files.size(); ch++){
+                    chunk->regions.push_back(uhd::map_capture_region(files[ch], offset, chunk->num_bytes));
+                    touch_pages(chunk->regions.back().get(), chunk->num_bytes);
+                }
+                while (not queue.push_with_timed_wait(chunk, 0.1) and not stop_signal_called){}
+                offset += chunk->num_bytes;
+            }
+        }
+    }
+    queue.push_with_wait(chunk_sptr()); //the end of the replay
+}
+
+/***********************************************************************
+ * Send side: converted samples through send(), otw items through views
+ **********************************************************************/
+static void send_chunk(
+    uhd::usrp::multi_usrp::sptr usrp, const chunk_t &chunk, const std::string &type, size_t item_size
+){
+    //a timed burst may wait for its time while the device buffers fill
+    const uhd::device::sptr dev = usrp->get_device();
+    const double timeout = 1.0 + ((chunk.has_time_spec)?
+        std::max(0.0, (chunk.time_spec - usrp->get_time_now()).get_real_secs()) : 0.0);
+
+    if (type != "otw"){
+        uhd::tx_metadata_t md;
+        md.start_of_burst = chunk.start_of_burst;
+        md.end_of_burst = chunk.end_of_burst;
+        md.has_time_spec = chunk.has_time_spec;
+        md.time_spec = chunk.time_spec;
+        std::vector<const void *> buffs;
+        for (size_t ch = 0; ch < chunk.regions.size(); ch++) buffs.push_back(chunk.regions[ch].get());
+        dev->send(
+            buffs, chunk.num_bytes/item_size, md,
+            (type == "short")? uhd::io_type_t::COMPLEX_INT16 : uhd::io_type_t::COMPLEX_FLOAT32,
+            uhd::device::SEND_MODE_FULL_BUFF, timeout
+        );
+        return;
+    }
+
+    //otw items are copied from the mapping into the transport frames
+    size_t offset = 0;
+    while (offset < chunk.num_bytes and not stop_signal_called){
+        uhd::device::send_view_t view;
+        view.metadata.start_of_burst = chunk.start_of_burst and offset == 0;
+        view.metadata.has_time_spec = chunk.has_time_spec and offset == 0;
+        view.metadata.time_spec = chunk.time_spec;
+        const size_t max_items = dev->get_send_view(view, timeout);
+        if (max_items == 0) continue; //timeout
+        const size_t num_bytes = std::min(max_items*view.item_size, chunk.num_bytes - offset);
+        view.metadata.end_of_burst = chunk.end_of_burst and offset + num_bytes == chunk.num_bytes;
+        for (size_t ch = 0; ch < view.payloads.size(); ch++){
+            std::memcpy(view.payloads[ch], static_cast<const char *>(chunk.regions[ch].get()) + offset, num_bytes);
+        }
+        dev->commit_send_view(view, num_bytes/view.item_size, timeout);
+        offset += num_bytes;
+    }
+}
+
+static void async_loop(uhd::device::sptr dev, size_t &num_underflows, size_t &num_time_errors){
+    uhd::async_metadata_t async_md;
+    while (not boost::this_thread::interruption_requested()){
+        if (not dev->recv_async_msg(async_md)) continue;
+        switch(async_md.event_code){
+        case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
+        case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET: num_underflows++; break;
+        case uhd::async_metadata_t::EVENT_CODE_TIME_ERROR: num_time_errors++; break;
+        default: break;
+        }
+    }
+}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    std::string args, file, type, ant, subdev;
+    size_t spb, num_blocks, num_loops;
+    double freq, gain, delay, loop_start, loop_end;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "multi uhd device address args")
+        ("file", po::value<std::string>(&file)->default_value("usrp_samples.dat"), "name of the recording from uhd_rx_recorder")
+        ("type", po::value<std::string>(&type)->default_value("short"), "sample type of the recording: float, short, or otw")
+        ("spb", po::value<size_t>(&spb)->default_value(1 << 18), "samples per read ahead buffer per channel")
+        ("nbuffs", po::value<size_t>(&num_blocks)->default_value(16), "number of buffers read ahead of the send")
+        ("delay", po::value<double>(&delay)->default_value(1.0), "seconds from now to the start of the replay")
+        ("loop_start", po::value<double>(&loop_start)->default_value(0.0), "start of the replay in seconds from the recording start")
+        ("loop_end", po::value<double>(&loop_end)->default_value(0.0), "end of the replay in seconds from the recording start (0 for the end)")
+        ("loops", po::value<size_t>(&num_loops)->default_value(1), "number of times to replay (0 to repeat until Ctrl + C)")
+        ("freq", po::value<double>(&freq), "RF center frequency in Hz")
+        ("gain", po::value<double>(&gain), "gain for the RF chain")
+        ("ant", po::value<std::string>(&ant), "daughterboard antenna selection")
+        ("subdev", po::value<std::string>(&subdev), "daughterboard subdevice specification, one channel per subdevice")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help") or not vm.count("freq")){
+        std::cout << boost::format("UHD TX Replay %s") % desc << std::endl;
+        std::cout <<
+            "    Replay a recording of uhd_rx_recorder at its recorded rate and timing.\n"
+            "    The gaps of lost samples in the recording are kept as gaps in the replay.\n"
+            "    The files are mapped and read ahead on a separate thread.\n"
+            << std::endl;
+        return ~0;
+    }
+    if (type != "float" and type != "short" and type != "otw"){
+        throw std::runtime_error("Unknown type " + type);
+    }
+
+    //read the index of the recording
+    const uhd::capture_index_reader::sptr index = uhd::capture_index_reader::make(file + ".idx");
+    const size_t item_size = index->get_item_size();
+    const size_t num_chans = index->get_num_chans();
+    if (index->get_entries().empty()) throw std::runtime_error("The recording is empty");
+    if (type == "float" and item_size != sizeof(std::complex<float>)) throw std::runtime_error("The recording is not of type float");
+    if (type == "short" and item_size != sizeof(std::complex<short>)) throw std::runtime_error("The recording is not of type short");
+
+    std::vector<std::string> files;
+    for (size_t ch = 0; ch < num_chans; ch++) files.push_back(channel_file_name(file, num_chans, ch));
+    const boost::uint64_t file_bytes = fs::file_size(files.front());
+
+    //the loop span in bytes, seeking by the device time of the recording
+    const uhd::capture_index_entry_t &first = index->get_entries().front();
+    boost::uint64_t span_begin = 0, span_end = file_bytes;
+    if (loop_start != 0 or loop_end != 0){
+        if (not first.has_time) throw std::runtime_error("The recording has no time to seek with");
+        span_begin = index->find_offset(first.time + uhd::time_spec_t(loop_start));
+        if (loop_end != 0) span_end = std::min(file_bytes, index->find_offset(first.time + uhd::time_spec_t(loop_end)));
+    }
+    const std::vector<run_t> runs = make_runs(*index, span_begin, span_end);
+    if (runs.empty()) throw std::runtime_error("The loop span holds no samples");
+
+    //create a usrp device
+    std::cout << std::endl;
+    std::cout << boost::format("Creating the usrp device with: %s...") % args << std::endl;
+    uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(args);
+    if (vm.count("subdev")) usrp->set_tx_subdev_spec(subdev);
+    std::cout << boost::format("Using Device: %s") % usrp->get_pp_string() << std::endl;
+    if (usrp->get_tx_num_channels() != num_chans) throw std::runtime_error(str(boost::format(
+        "The recording has %u channels, the device transmits on %u") % num_chans % usrp->get_tx_num_channels()
+    ));
+
+    std::cout << boost::format("Setting TX Rate: %f Msps...") % (index->get_rate()/1e6) << std::endl;
+    usrp->set_tx_rate(index->get_rate());
+    std::cout << boost::format("Actual TX Rate: %f Msps...") % (usrp->get_tx_rate()/1e6) << std::endl << std::endl;
+    for (size_t ch = 0; ch < num_chans; ch++){
+        usrp->set_tx_freq(freq, ch);
+        if (vm.count("gain")) usrp->set_tx_gain(gain, ch);
+        if (vm.count("ant")) usrp->set_tx_antenna(ant, ch);
+    }
+
+    //start the read ahead, the replay starts at a device time
+    const uhd::time_spec_t start_time = usrp->get_time_now() + uhd::time_spec_t(delay);
+    uhd::transport::bounded_buffer<chunk_sptr> queue(num_blocks);
+    boost::thread reader(boost::bind(
+        &reader_loop, boost::ref(queue), boost::cref(files), boost::cref(runs),
+        item_size, index->get_rate(), spb*item_size, num_loops, start_time
+    ));
+    size_t num_underflows = 0, num_time_errors = 0;
+    boost::thread async(boost::bind(&async_loop, usrp->get_device(), boost::ref(num_underflows), boost::ref(num_time_errors)));
+
+    std::signal(SIGINT, &sig_int_handler);
+    std::cout << boost::format("Replaying %u runs of %s in %f seconds...") % runs.size() % file % delay << std::endl;
+    std::cout << "Press Ctrl + C to stop replaying..." << std::endl;
+
+    size_t num_sent_bytes = 0;
+    chunk_sptr chunk;
+    bool in_burst = false;
+    while (true){
+        queue.pop_with_wait(chunk);
+        if (chunk.get() == NULL) break;
+        send_chunk(usrp, *chunk, type, item_size);
+        num_sent_bytes += chunk->num_bytes;
+        in_burst = not chunk->end_of_burst;
+    }
+
+    //end a burst that was cut short
+    if (in_burst){
+        uhd::tx_metadata_t md;
+        md.end_of_burst = true;
+        usrp->get_device()->send("", 0, md, uhd::io_type_t::COMPLEX_FLOAT32, uhd::device::SEND_MODE_FULL_BUFF);
+    }
+    reader.join();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100)); //the last async messages
+    async.interrupt();
+    async.join();
+
+    //finished
+    std::cout << std::endl << boost::format(
+        "Replayed %u samples per channel (%u channels)\n"
+        "Underflows: %u, late bursts: %u"
+    ) % (num_sent_bytes/item_size) % num_chans % num_underflows % num_time_errors << std::endl;
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/device.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/transport/usb_device_handle.hpp>
+#include <uhd/transport/usb_gateway.hpp>
+#include <boost/program_options.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <iostream>
+#include <csignal>
+
+namespace po = boost::program_options;
+using namespace uhd::transport;
+
+static bool stop_signal_called = false;
+void sig_int_handler(int){stop_signal_called = true;}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    std::string serial, port;
+    size_t send_batch;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("serial", po::value<std::string>(&serial)->default_value(""), "serial of the B100 to serve, blank for the first one")
+        ("port", po::value<std::string>(&port)->default_value("49200"), "control port of the gateway")
+        ("send_batch", po::value<size_t>(&send_batch)->default_value(16), "max number of frames per batched network send")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD USB Gateway %s") % desc << std::endl;
+        std::cout
+            << std::endl
+            << "Serves a B100 on this host to a remote host, where it can be made with\n"
+            << "    --args=\"gateway=<this host>[, gateway_port=<port>]\"\n"
+            << std::endl;
+        return ~0;
+    }
+
+    //the discovery loads the firmware, so the device comes up with its serial
+    uhd::device_addr_t hint("type=b100");
+    if (not serial.empty()) hint["serial"] = serial;
+    if (uhd::device::find(hint).empty()){
+        std::cerr << "No B100 found" << std::endl;
+        return ~0;
+    }
+
+    usb_device_handle::sptr handle;
+    BOOST_FOREACH(usb_device_handle::sptr dev_handle, usb_device_handle::get_device_list(0x2500, 0x0001)){
+        if (serial.empty() or dev_handle->get_serial() == serial){
+            handle = dev_handle;
+            break;
+        }
+    }
+    if (handle.get() == NULL){
+        std::cerr << "The B100 went away after the firmware load" << std::endl;
+        return ~0;
+    }
+
+    uhd::device_addr_t hints;
+    hints["send_batch"] = boost::lexical_cast<std::string>(send_batch);
+    usb_gateway_server::sptr server = usb_gateway_server::make(handle, port, hints);
+    std::cout << boost::format("Serving B100 %s on port %s, press Ctrl + C to stop") % handle->get_serial() % port << std::endl;
+
+    std::signal(SIGINT, &sig_int_handler);
+    size_t last_recv = 0, last_send = 0;
+    while (not stop_signal_called){
+        boost::this_thread::sleep(boost::posix_time::seconds(1));
+        const size_t num_recv = server->get_num_recv_frames(), num_send = server->get_num_send_frames();
+        std::cout << boost::format("\rFrames per second: %u to the network, %u to the device     ")
+            % (num_recv - last_recv) % (num_send - last_send) << std::flush;
+        last_recv = num_recv;
+        last_send = num_send;
+    }
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+
+    return 0;
+}
@@ -15,7 +15,11 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "device_json.hpp"
 #include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/exception.hpp>
 #include <uhd/version.hpp>
 #include <uhd/device.hpp>
 #include <uhd/types/ranges.hpp>
@@ -27,7 +31,11 @@
 #include <boost/program_options.hpp>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <vector>
 
@@ -174,6 +182,177 @@ void print_tree(const uhd::fs_path &path, uhd::property_tree::sptr tree){
     }
 }
 
+static void print_task_stats(const double seconds){
+    boost::this_thread::sleep(boost::posix_time::milliseconds(long(seconds*1000)));
+    std::cout << boost::format("%-24s %12s %10s %10s %10s %6s") % "Task" % "Iterations" % "Run (s)" % "CPU (s)" % "Wait (s)" % "CPU %" << std::endl;
+    BOOST_FOREACH(const uhd::task_stats_t &stats, uhd::task::get_all_stats()){
+        std::cout << boost::format("%-24s %12u %10.3f %10.3f %10.3f %6.1f")
+            % stats.name % stats.iterations % stats.run_time % stats.cpu_time % stats.wait_time
+            % ((stats.run_time > 0)? 100*stats.cpu_time/stats.run_time : 0.0)
+        << std::endl;
+    }
+}
+
+/***********************************************************************
+ * Inventory: a JSON description of a device
+ * Only the names of the frontends are listed, so that devices made
+ * with deferred dboard init do not initialize their frontends.
+ **********************************************************************/
+static std::string get_dboard_json(property_tree::sptr tree, const fs_path &path, const std::string &pad){
+    std::stringstream ss;
+    ss << "{" << std::endl;
+    ss << pad << "  \"slot\": " << json_quote(path.leaf()) << "," << std::endl;
+    static const char *eeprom_names[] = {"rx_eeprom", "tx_eeprom", "gdb_eeprom"};
+    BOOST_FOREACH(const std::string &name, eeprom_names){
+        if (not tree->exists(path / name)) continue;
+        usrp::dboard_eeprom_t db_eeprom = tree->access<usrp::dboard_eeprom_t>(path / name).get();
+        ss << pad << boost::format("  %s: {\"id\": %s, \"serial\": %s},")
+            % json_quote(name.substr(0, name.find('_')))
+            % json_quote((db_eeprom.id == usrp::dboard_id_t::none())? "" : db_eeprom.id.to_pp_string())
+            % json_quote(db_eeprom.serial) << std::endl;
+    }
+    ss << pad << "  \"rx_frontends\": " << json_array(tree->list(path / "rx_frontends")) << "," << std::endl;
+    ss << pad << "  \"tx_frontends\": " << json_array(tree->list(path / "tx_frontends")) << std::endl;
+    ss << pad << "}";
+    return ss.str();
+}
+
+static std::string get_mboard_json(property_tree::sptr tree, const fs_path &path, const std::string &pad){
+    std::stringstream ss;
+    ss << "{" << std::endl;
+    ss << pad << "  \"name\": " << json_quote(tree->access<std::string>(path / "name").get()) << "," << std::endl;
+    ss << pad << "  \"eeprom\": " << json_object(tree->access<usrp::mboard_eeprom_t>(path / "eeprom").get()) << "," << std::endl;
+    ss << pad << "  \"time_sources\": " << json_array(tree->access<std::vector<std::string> >(path / "time_source" / "options").get()) << "," << std::endl;
+    ss << pad << "  \"clock_sources\": " << json_array(tree->access<std::vector<std::string> >(path / "clock_source" / "options").get()) << "," << std::endl;
+    ss << pad << "  \"sensors\": " << json_array(tree->list(path / "sensors")) << "," << std::endl;
+    ss << pad << "  \"rx_dsps\": " << json_array(tree->list(path / "rx_dsps")) << "," << std::endl;
+    ss << pad << "  \"tx_dsps\": " << json_array(tree->list(path / "tx_dsps")) << "," << std::endl;
+    ss << pad << "  \"dboards\": [";
+    size_t count = 0;
+    BOOST_FOREACH(const std::string &name, tree->list(path / "dboards")){
+        ss << ((count++)? ", " : "") << get_dboard_json(tree, path / "dboards" / name, pad + "  ");
+    }
+    ss << "]" << std::endl;
+    ss << pad << "}";
+    return ss.str();
+}
+
+static std::string get_device_json(property_tree::sptr tree, const std::string &pad){
+    std::stringstream ss;
+    ss << pad << "  \"name\": " << json_quote(tree->access<std::string>("/name").get()) << "," << std::endl;
+    if (tree->exists("/open_times")){
+        ss << pad << "  \"open_times\": {";
+        size_t count = 0;
+        BOOST_FOREACH(const std::string &phase, tree->list("/open_times")){
+            ss << ((count++)? ", " : "") << boost::format("%s: %.3f") % json_quote(phase) % tree->access<double>("/open_times/" + phase).get();
+        }
+        ss << "}," << std::endl;
+    }
+    ss << pad << "  \"mboards\": [";
+    size_t count = 0;
+    BOOST_FOREACH(const std::string &name, tree->list("/mboards")){
+        ss << ((count++)? ", " : "") << get_mboard_json(tree, "/mboards/" + name, pad + "  ");
+    }
+    ss << "]" << std::endl;
+    return ss.str();
+}
+
+/***********************************************************************
+ * Inventory: open and probe the discovered devices concurrently
+ **********************************************************************/
+struct probe_job_type{
+    device_addr_t addr;
+    std::string json; //the fields of the device object
+    std::string error; //empty on success
+    double seconds;
+};
+
+static void probe_device(probe_job_type &job){
+    const boost::system_time start = boost::get_system_time();
+    try{
+        device::sptr dev = device::make(job.addr);
+        job.json = get_device_json(dev->get_tree(), "  ");
+    }
+    catch(const std::exception &e){
+        job.error = e.what();
+    }
+    job.seconds = 1e-3*(boost::get_system_time() - start).total_milliseconds();
+}
+
+static boost::mutex inventory_msg_mutex; //serializes the progress and the messages on stderr
+
+//! Each worker takes the next job until none are left
+static void probe_worker(std::vector<probe_job_type> &jobs, size_t &next_job, boost::mutex &mutex){
+    while (true){
+        size_t i;
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            if (next_job == jobs.size()) return;
+            i = next_job++;
+        }
+        probe_device(jobs[i]);
+        boost::mutex::scoped_lock lock(inventory_msg_mutex);
+        std::cerr << boost::format("%s: %s in %.1f seconds")
+            % jobs[i].addr.to_string() % ((jobs[i].error.empty())? "probed" : "FAILED") % jobs[i].seconds << std::endl;
+    }
+}
+
+//! The status messages of the concurrent opens go to stderr, away from the inventory
+static void inventory_msg_handler(uhd::msg::type_t type, const std::string &msg){
+    const std::string prefix = (type == uhd::msg::warning)? "UHD Warning: " : ((type == uhd::msg::error)? "UHD Error: " : "");
+    boost::mutex::scoped_lock lock(inventory_msg_mutex);
+    std::cerr << prefix << msg << std::flush;
+}
+
+static int print_inventory(const device_addr_t &args, const size_t num_workers, std::ostream &out){
+    const boost::system_time start = boost::get_system_time();
+    uhd::msg::register_handler(&inventory_msg_handler);
+
+    //discover once, then make each device from its own address and the given args
+    std::vector<probe_job_type> jobs;
+    BOOST_FOREACH(const device_addr_t &found, device::find(args)){
+        probe_job_type job;
+        job.addr = found;
+        BOOST_FOREACH(const std::string &key, args.keys()){
+            if (not job.addr.has_key(key)) job.addr[key] = args[key];
+        }
+        job.seconds = 0;
+        jobs.push_back(job);
+    }
+
+    size_t next_job = 0;
+    boost::mutex mutex;
+    boost::thread_group threads;
+    for (size_t i = 0; i < std::min(std::max<size_t>(num_workers, 1), jobs.size()); i++){
+        threads.create_thread(boost::bind(&probe_worker, boost::ref(jobs), boost::ref(next_job), boost::ref(mutex)));
+    }
+    threads.join_all();
+
+    size_t num_failed = 0;
+    out << "{" << std::endl;
+    out << "  \"devices\": [";
+    for (size_t i = 0; i < jobs.size(); i++){
+        out << ((i)? ", " : "") << "{" << std::endl;
+        out << "    \"args\": " << json_object(jobs[i].addr) << "," << std::endl;
+        out << boost::format("    \"probe_time\": %.3f,") % jobs[i].seconds << std::endl;
+        if (jobs[i].error.empty()){
+            out << "    \"status\": \"ok\"," << std::endl << jobs[i].json;
+        }
+        else{
+            out << "    \"status\": \"error\"," << std::endl;
+            out << "    \"error\": " << json_quote(jobs[i].error) << std::endl;
+            num_failed++;
+        }
+        out << "  }";
+    }
+    out << "]," << std::endl;
+    out << "  \"num_devices\": " << jobs.size() << "," << std::endl;
+    out << "  \"num_failed\": " << num_failed << "," << std::endl;
+    out << boost::format("  \"total_time\": %.3f") % (1e-3*(boost::get_system_time() - start).total_milliseconds()) << std::endl;
+    out << "}" << std::endl;
+    return (num_failed == 0 and not jobs.empty())? 0 : ~0;
+}
+
 int UHD_SAFE_MAIN(int argc, char *argv[]){
     po::options_description desc("Allowed options");
     desc.add_options()
@@ -182,6 +361,11 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("args", po::value<std::string>()->default_value(""), "device address args")
         ("tree", "specify to print a complete property tree")
         ("string", po::value<std::string>(), "query a string value from the properties tree")
+        ("tasks", po::value<double>()->implicit_value(1.0), "print the cpu usage of the internal tasks after the given seconds")
+        ("inventory", "probe every device found with the args and print a JSON inventory")
+        ("jobs", po::value<size_t>()->default_value(8), "inventory: the number of devices probed at once")
+        ("output", po::value<std::string>(), "inventory: write the JSON to this file instead of stdout")
+        ("init-dboards", "inventory: initialize the frontends instead of deferring their init")
     ;
 
     po::variables_map vm;
@@ -199,7 +383,22 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         return 0;
     }
 
-    device::sptr dev = device::make(vm["args"].as<std::string>());
+    device_addr_t args(vm["args"].as<std::string>());
+
+    //the inventory only lists the frontends, so their init can be deferred
+    if (vm.count("inventory")){
+        if (vm.count("init-dboards") == 0) args["defer_dboard_init"] = "";
+        else if (args.has_key("defer_dboard_init")) args.pop("defer_dboard_init");
+        if (vm.count("output") == 0) return print_inventory(args, vm["jobs"].as<size_t>(), std::cout);
+        std::ofstream out(vm["output"].as<std::string>().c_str());
+        if (not out.is_open()) throw uhd::io_error("cannot open " + vm["output"].as<std::string>());
+        return print_inventory(args, vm["jobs"].as<size_t>(), out);
+    }
+
+    //the probe enumerates every dboard, so never defer their init
+    if (args.has_key("defer_dboard_init")) args.pop("defer_dboard_init");
+
+    device::sptr dev = device::make(args);
     property_tree::sptr tree = dev->get_tree();
 
     if (vm.count("string")){
@@ -210,5 +409,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     if (vm.count("tree") != 0) print_tree("/", tree);
     else std::cout << make_border(get_device_pp_string(tree)) << std::endl;
 
+    if (vm.count("tasks") != 0) print_task_stats(vm["tasks"].as<double>());
+
     return 0;
 }
@@ -0,0 +1,486 @@
+//
+// Copyright 2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/transport/udp_simple.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/exception.hpp>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/crc.hpp>
+#include <boost/cstdint.hpp>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <vector>
+#include <map>
+
+namespace po = boost::program_options;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * Constants (see usrp_n2xx_net_burner.py and udp_fw_update.h)
+ **********************************************************************/
+static const std::string UDP_FW_UPDATE_PORT = "49154";
+static const double UDP_TIMEOUT = 3.0; //before a request is sent again
+static const double UDP_HASH_TIMEOUT = 30.0; //the firmware reads the whole image to hash it
+static const size_t UDP_MAX_RETRIES = 5;
+static const boost::uint32_t USRP2_FW_PROTO_VERSION = 7; //unused after r6
+
+static const size_t FPGA_IMAGE_SIZE_BYTES = 1572864;
+static const size_t FW_IMAGE_SIZE_BYTES = 31744;
+static const boost::uint32_t SAFE_FPGA_IMAGE_LOCATION_ADDR = 0x00000000;
+static const boost::uint32_t SAFE_FW_IMAGE_LOCATION_ADDR = 0x003F0000;
+static const boost::uint32_t PROD_FPGA_IMAGE_LOCATION_ADDR = 0x00180000;
+static const boost::uint32_t PROD_FW_IMAGE_LOCATION_ADDR = 0x00300000;
+
+static const size_t FLASH_DATA_PACKET_SIZE = 256;
+
+enum update_id_t{
+    USRP2_FW_UPDATE_ID_WAT = ' ',
+    USRP2_FW_UPDATE_ID_OHAI_LOL = 'a',
+    USRP2_FW_UPDATE_ID_OHAI_OMG = 'A',
+    USRP2_FW_UPDATE_ID_WATS_TEH_FLASH_INFO_LOL = 'f',
+    USRP2_FW_UPDATE_ID_HERES_TEH_FLASH_INFO_OMG = 'F',
+    USRP2_FW_UPDATE_ID_ERASE_TEH_FLASHES_LOL = 'e',
+    USRP2_FW_UPDATE_ID_ERASING_TEH_FLASHES_OMG = 'E',
+    USRP2_FW_UPDATE_ID_R_U_DONE_ERASING_LOL = 'd',
+    USRP2_FW_UPDATE_ID_IM_DONE_ERASING_OMG = 'D',
+    USRP2_FW_UPDATE_ID_NOPE_NOT_DONE_ERASING_OMG = 'B',
+    USRP2_FW_UPDATE_ID_WRITE_TEH_FLASHES_LOL = 'w',
+    USRP2_FW_UPDATE_ID_WROTE_TEH_FLASHES_OMG = 'W',
+    USRP2_FW_UPDATE_ID_READ_TEH_FLASHES_LOL = 'r',
+    USRP2_FW_UPDATE_ID_KK_READ_TEH_FLASHES_OMG = 'R',
+    USRP2_FW_UPDATE_ID_RESET_MAH_COMPUTORZ_LOL = 's',
+    USRP2_FW_UPDATE_ID_RESETTIN_TEH_COMPUTORZ_OMG = 'S',
+    USRP2_FW_UPDATE_ID_I_CAN_HAS_HW_REV_LOL = 'v',
+    USRP2_FW_UPDATE_ID_HERES_TEH_HW_REV_OMG = 'V',
+    USRP2_FW_UPDATE_ID_HASH_TEH_FLASHES_LOL = 'h',
+    USRP2_FW_UPDATE_ID_HERES_TEH_HASH_OMG = 'H'
+};
+
+//! The update packet, all fields in network byte order
+struct update_packet_t{
+    boost::uint32_t proto_ver;
+    boost::uint32_t id;
+    boost::uint32_t seq;
+    boost::uint32_t flash_addr; //also the ip address, hw rev, and sector size
+    boost::uint32_t length; //also the memory size
+    boost::uint8_t data[FLASH_DATA_PACKET_SIZE]; //the hash reply holds the crc here
+};
+
+static update_packet_t make_packet(
+    const update_id_t id, const boost::uint32_t flash_addr = 0, const boost::uint32_t length = 0
+){
+    update_packet_t pkt;
+    std::memset(&pkt, 0, sizeof(pkt));
+    pkt.proto_ver = uhd::htonx(USRP2_FW_PROTO_VERSION);
+    pkt.id = uhd::htonx(boost::uint32_t(id));
+    pkt.flash_addr = uhd::htonx(flash_addr);
+    pkt.length = uhd::htonx(length);
+    return pkt;
+}
+
+/***********************************************************************
+ * Images
+ **********************************************************************/
+typedef std::vector<boost::uint8_t> image_type;
+
+static image_type read_image(const std::string &path, const size_t max_size){
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (not file.good()) throw uhd::io_error("cannot open image file " + path);
+    const image_type image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (image.size() > max_size) throw uhd::value_error("image file too large: " + path);
+    return image;
+}
+
+static bool is_valid_fpga_image(const image_type &image){
+    for (size_t i = 0; i < 63 and i + 1 < image.size(); i++){
+        if (image[i] == 0xff) continue;
+        if (image[i] == 0xaa and image[i+1] == 0x99) return true;
+    }
+    return false;
+}
+
+static bool is_valid_fw_image(const image_type &image){
+    return image.size() >= 4 and image[0] == 0x0b and image[1] == 0x0b and image[2] == 0x0b and image[3] == 0x0b;
+}
+
+//the fpga image names for a hardware revision, empty when unknown
+static std::vector<std::string> get_rev_names(const boost::uint16_t hw_rev){
+    std::vector<std::string> names;
+    switch(hw_rev){
+    case 0x0a00: names.push_back("n200_r3"); names.push_back("n200_r2"); break;
+    case 0x0a10: names.push_back("n200_r4"); break;
+    case 0x0a01: names.push_back("n210_r3"); names.push_back("n210_r2"); break;
+    case 0x0a11: names.push_back("n210_r4"); break;
+    }
+    return names;
+}
+
+/***********************************************************************
+ * The burner for one device:
+ * Firmware that echoes the sequence number in its replies gets
+ * a window of requests in flight, older firmware gets one at a time.
+ **********************************************************************/
+static boost::mutex print_mutex;
+
+class n2xx_burner{
+public:
+    n2xx_burner(const std::string &addr, const size_t window):
+        _addr(addr), _window(window), _seq(0), _seq_echo(false),
+        _sock(udp_simple::make_connected(addr, UDP_FW_UPDATE_PORT))
+    {
+        //check that the device is there and if it echoes the seq
+        const update_packet_t reply = this->transact(make_packet(USRP2_FW_UPDATE_ID_OHAI_LOL), UDP_TIMEOUT);
+        if (uhd::ntohx(reply.id) != USRP2_FW_UPDATE_ID_OHAI_OMG){
+            throw uhd::runtime_error("invalid reply received from device");
+        }
+        _seq_echo = uhd::ntohx(reply.seq) == _seq;
+        if (not _seq_echo) this->status("device firmware does not support windowed updates");
+    }
+
+    void status(const std::string &msg){
+        boost::mutex::scoped_lock lock(print_mutex);
+        std::cout << boost::format("[%s] %s") % _addr % msg << std::endl;
+    }
+
+    boost::uint16_t get_hw_rev(void){
+        const update_packet_t reply = this->transact(make_packet(USRP2_FW_UPDATE_ID_I_CAN_HAS_HW_REV_LOL), UDP_TIMEOUT);
+        if (uhd::ntohx(reply.id) != USRP2_FW_UPDATE_ID_HERES_TEH_HW_REV_OMG) return 0;
+        //the eeprom holds the revision little endian
+        return uhd::byteswap(boost::uint16_t(uhd::ntohx(reply.flash_addr)));
+    }
+
+    size_t get_flash_size(void){
+        const update_packet_t reply = this->transact(make_packet(USRP2_FW_UPDATE_ID_WATS_TEH_FLASH_INFO_LOL), UDP_TIMEOUT);
+        this->check_id(reply, USRP2_FW_UPDATE_ID_HERES_TEH_FLASH_INFO_OMG);
+        return uhd::ntohx(reply.length);
+    }
+
+    void erase(const boost::uint32_t addr, const size_t length){
+        this->check_id(this->transact(
+            make_packet(USRP2_FW_UPDATE_ID_ERASE_TEH_FLASHES_LOL, addr, length), UDP_TIMEOUT
+        ), USRP2_FW_UPDATE_ID_ERASING_TEH_FLASHES_OMG);
+        while (true){
+            const update_packet_t reply = this->transact(make_packet(USRP2_FW_UPDATE_ID_R_U_DONE_ERASING_LOL), UDP_TIMEOUT);
+            if (uhd::ntohx(reply.id) == USRP2_FW_UPDATE_ID_IM_DONE_ERASING_OMG) return;
+            this->check_id(reply, USRP2_FW_UPDATE_ID_NOPE_NOT_DONE_ERASING_OMG);
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        }
+    }
+
+    void write(const image_type &image, const boost::uint32_t addr){
+        std::vector<update_packet_t> requests;
+        for (size_t offset = 0; offset < image.size(); offset += FLASH_DATA_PACKET_SIZE){
+            requests.push_back(make_packet(USRP2_FW_UPDATE_ID_WRITE_TEH_FLASHES_LOL, addr + offset, FLASH_DATA_PACKET_SIZE));
+            const size_t n = std::min(FLASH_DATA_PACKET_SIZE, image.size() - offset);
+            std::memset(requests.back().data, 0xff, FLASH_DATA_PACKET_SIZE); //an erased flash reads 0xff
+            std::memcpy(requests.back().data, &image[offset], n);
+        }
+        std::vector<update_packet_t> replies;
+        this->windowed_transact_check(requests, replies, USRP2_FW_UPDATE_ID_WROTE_TEH_FLASHES_OMG);
+    }
+
+    void verify(const image_type &image, const boost::uint32_t addr){
+        //firmware with the hash: compare the crc32 of the image
+        update_packet_t request = make_packet(USRP2_FW_UPDATE_ID_HASH_TEH_FLASHES_LOL, addr, image.size());
+        const update_packet_t reply = this->transact(request, UDP_HASH_TIMEOUT);
+        if (uhd::ntohx(reply.id) == USRP2_FW_UPDATE_ID_HERES_TEH_HASH_OMG){
+            boost::uint32_t crc; std::memcpy(&crc, reply.data, sizeof(crc));
+            boost::crc_32_type image_crc;
+            image_crc.process_bytes(&image.front(), image.size());
+            if (uhd::ntohx(crc) != image_crc.checksum()) throw uhd::runtime_error("verify failed, the image hash does not match");
+            return;
+        }
+
+        //older firmware: read the image back
+        std::vector<update_packet_t> requests;
+        for (size_t offset = 0; offset < image.size(); offset += FLASH_DATA_PACKET_SIZE){
+            const size_t n = std::min(FLASH_DATA_PACKET_SIZE, image.size() - offset);
+            requests.push_back(make_packet(USRP2_FW_UPDATE_ID_READ_TEH_FLASHES_LOL, addr + offset, n));
+        }
+        std::vector<update_packet_t> replies;
+        this->windowed_transact_check(requests, replies, USRP2_FW_UPDATE_ID_KK_READ_TEH_FLASHES_OMG);
+        for (size_t i = 0; i < replies.size(); i++){
+            const size_t offset = i*FLASH_DATA_PACKET_SIZE;
+            const size_t n = std::min(FLASH_DATA_PACKET_SIZE, image.size() - offset);
+            if (std::memcmp(replies[i].data, &image[offset], n) != 0){
+                throw uhd::runtime_error("verify failed, the image did not write correctly");
+            }
+        }
+    }
+
+    void reset(void){
+        _sock->send(boost::asio::buffer(&this->next_seq(make_packet(USRP2_FW_UPDATE_ID_RESET_MAH_COMPUTORZ_LOL)), sizeof(update_packet_t)));
+        update_packet_t reply;
+        if (this->recv(reply, UDP_TIMEOUT) and uhd::ntohx(reply.id) == USRP2_FW_UPDATE_ID_RESETTIN_TEH_COMPUTORZ_OMG){
+            throw uhd::runtime_error("device failed to reset");
+        }
+    }
+
+private:
+    const std::string _addr;
+    const size_t _window;
+    boost::uint32_t _seq;
+    bool _seq_echo;
+    udp_simple::sptr _sock;
+    update_packet_t _seq_pkt;
+
+    struct in_flight_type{
+        boost::system_time deadline;
+        size_t retries;
+    };
+
+    //! Give the packet the next seq, return the copy to send
+    const update_packet_t &next_seq(const update_packet_t &pkt){
+        _seq_pkt = pkt;
+        _seq_pkt.seq = uhd::htonx(++_seq);
+        return _seq_pkt;
+    }
+
+    //! Receive one reply, false on timeout
+    bool recv(update_packet_t &reply, const double timeout){
+        boost::uint8_t mem[udp_simple::mtu];
+        const size_t len = _sock->recv(boost::asio::buffer(mem), timeout);
+        if (len < 3*sizeof(boost::uint32_t)) return false;
+        std::memset(&reply, 0, sizeof(reply));
+        std::memcpy(&reply, mem, std::min(len, sizeof(reply)));
+        return true;
+    }
+
+    void check_id(const update_packet_t &reply, const update_id_t id){
+        if (uhd::ntohx(reply.id) != boost::uint32_t(id)) throw uhd::runtime_error(str(
+            boost::format("invalid reply %c from device") % char(uhd::ntohx(reply.id))
+        ));
+    }
+
+    //! One request at a time
+    update_packet_t transact(const update_packet_t &request, const double timeout){
+        std::vector<update_packet_t> requests(1, request), replies;
+        this->windowed_transact(requests, replies, timeout);
+        return replies.front();
+    }
+
+    void windowed_transact_check(
+        const std::vector<update_packet_t> &requests,
+        std::vector<update_packet_t> &replies,
+        const update_id_t id
+    ){
+        this->windowed_transact(requests, replies, UDP_TIMEOUT);
+        for (size_t i = 0; i < replies.size(); i++) this->check_id(replies[i], id);
+    }
+
+    /*!
+     * Keep up to a window of requests in flight, resend on timeout.
+     * The replies are matched by seq when the firmware echoes it;
+     * otherwise the window is one and the reply goes with the last request.
+     */
+    void windowed_transact(
+        const std::vector<update_packet_t> &requests,
+        std::vector<update_packet_t> &replies,
+        const double timeout
+    ){
+        const size_t window = _seq_echo? _window : 1;
+        const boost::uint32_t first_seq = _seq + 1;
+        replies.resize(requests.size());
+
+        std::map<size_t, in_flight_type> in_flight;
+        std::vector<update_packet_t> sent(requests.size());
+        size_t next = 0, num_done = 0;
+
+        while (num_done < requests.size()){
+            //fill the window
+            while (in_flight.size() < window and next < requests.size()){
+                sent[next] = this->next_seq(requests[next]);
+                _sock->send(boost::asio::buffer(&sent[next], sizeof(update_packet_t)));
+                in_flight_type &entry = in_flight[next++];
+                entry.deadline = boost::get_system_time() + boost::posix_time::milliseconds(long(timeout*1000));
+                entry.retries = 0;
+            }
+
+            //take one reply
+            update_packet_t reply;
+            if (this->recv(reply, std::min(timeout, 0.1))){
+                const size_t i = _seq_echo? size_t(uhd::ntohx(reply.seq) - first_seq) : in_flight.begin()->first;
+                if (in_flight.count(i) != 0){
+                    replies[i] = reply;
+                    in_flight.erase(i);
+                    num_done++;
+                }
+            }
+
+            //resend the requests that timed out
+            const boost::system_time now = boost::get_system_time();
+            for (std::map<size_t, in_flight_type>::iterator it = in_flight.begin(); it != in_flight.end(); it++){
+                if (now < it->second.deadline) continue;
+                if (++it->second.retries > UDP_MAX_RETRIES) throw uhd::runtime_error("no response from device");
+                _sock->send(boost::asio::buffer(&sent[it->first], sizeof(update_packet_t)));
+                it->second.deadline = now + boost::posix_time::milliseconds(long(timeout*1000));
+            }
+        }
+    }
+};
+
+/***********************************************************************
+ * Burn one device, the thread for each device calls this
+ **********************************************************************/
+struct burn_job_type{
+    std::string addr;
+    const image_type *fw, *fpga;
+    std::string fpga_path;
+    bool safe, reset;
+    size_t window;
+    std::string error; //empty on success
+};
+
+static void burn_image(
+    n2xx_burner &burner, const std::string &name,
+    const image_type &image, const boost::uint32_t addr, const size_t erase_size
+){
+    const boost::system_time start = boost::get_system_time();
+    burner.status("erasing the " + name + " image...");
+    burner.erase(addr, erase_size);
+    burner.status("writing the " + name + " image...");
+    burner.write(image, addr);
+    burner.status("verifying the " + name + " image...");
+    burner.verify(image, addr);
+    burner.status(str(boost::format("%s image done in %.1f seconds")
+        % name % (1e-3*(boost::get_system_time() - start).total_milliseconds())
+    ));
+}
+
+static void burn_device(burn_job_type &job){
+    try{
+        n2xx_burner burner(job.addr, job.window);
+        const size_t flash_size = burner.get_flash_size();
+
+        if (job.fpga != NULL){
+            const std::vector<std::string> names = get_rev_names(burner.get_hw_rev());
+            bool match = names.empty();
+            for (size_t i = 0; i < names.size(); i++){
+                match = match or job.fpga_path.find(names[i]) != std::string::npos;
+            }
+            if (not match) throw uhd::value_error("incorrect FPGA image version, please use the image for " + names.front());
+            const boost::uint32_t addr = job.safe? SAFE_FPGA_IMAGE_LOCATION_ADDR : PROD_FPGA_IMAGE_LOCATION_ADDR;
+            if (addr + job.fpga->size() > flash_size) throw uhd::value_error("cannot write past end of device");
+            burn_image(burner, "FPGA", *job.fpga, addr, FPGA_IMAGE_SIZE_BYTES);
+        }
+
+        if (job.fw != NULL){
+            const boost::uint32_t addr = job.safe? SAFE_FW_IMAGE_LOCATION_ADDR : PROD_FW_IMAGE_LOCATION_ADDR;
+            if (addr + job.fw->size() > flash_size) throw uhd::value_error("cannot write past end of device");
+            burn_image(burner, "firmware", *job.fw, addr, FW_IMAGE_SIZE_BYTES);
+        }
+
+        if (job.reset){
+            burner.status("resetting the device...");
+            burner.reset();
+        }
+    }
+    catch(const std::exception &e){
+        job.error = e.what();
+    }
+}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    std::string addrs, fw_path, fpga_path;
+    size_t window;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("addrs", po::value<std::string>(&addrs), "comma separated USRP-N2XX addresses")
+        ("fw", po::value<std::string>(&fw_path), "firmware image path (optional)")
+        ("fpga", po::value<std::string>(&fpga_path), "fpga image path (optional)")
+        ("window", po::value<size_t>(&window)->default_value(16), "flash packets in flight per device")
+        ("reset", "reset the devices after writing")
+        ("overwrite-safe", "never ever use this option")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help") or not vm.count("addrs") or not (vm.count("fw") or vm.count("fpga") or vm.count("reset"))){
+        std::cout << boost::format("USRP-N2XX Multi Burner %s") % desc << std::endl;
+        std::cout << boost::format(
+            "Burn the firmware and/or FPGA images into many devices at once.\n"
+            "Specify either a firmware image or FPGA image, and/or reset.\n"
+        ) << std::endl;
+        return ~0;
+    }
+
+    const bool safe = vm.count("overwrite-safe") != 0;
+    if (safe){
+        std::cout << "Are you REALLY, REALLY sure you want to overwrite the safe image? This is ALMOST ALWAYS a terrible idea." << std::endl;
+        std::cout << "If your image is faulty, your USRP2+ will become a brick until reprogrammed via JTAG." << std::endl;
+        std::cout << "Type \"yes\" to continue, or anything else to quit: " << std::flush;
+        std::string response; std::getline(std::cin, response);
+        if (response != "yes") return 0;
+    }
+
+    //load and check the images once for all devices
+    image_type fw, fpga;
+    if (vm.count("fw")){
+        fw = read_image(fw_path, FW_IMAGE_SIZE_BYTES);
+        if (not is_valid_fw_image(fw)) throw uhd::value_error("invalid firmware image file");
+    }
+    if (vm.count("fpga")){
+        fpga = read_image(fpga_path, FPGA_IMAGE_SIZE_BYTES);
+        if (not is_valid_fpga_image(fpga)) throw uhd::value_error("invalid FPGA image file");
+    }
+
+    //one job and thread per device
+    std::vector<std::string> addr_list;
+    boost::split(addr_list, addrs, boost::is_any_of(","));
+    std::vector<burn_job_type> jobs;
+    for (size_t i = 0; i < addr_list.size(); i++){
+        if (addr_list[i].empty()) continue;
+        burn_job_type job;
+        job.addr = addr_list[i];
+        job.fw = vm.count("fw")? &fw : NULL;
+        job.fpga = vm.count("fpga")? &fpga : NULL;
+        job.fpga_path = fpga_path;
+        job.safe = safe;
+        job.reset = vm.count("reset") != 0;
+        job.window = std::max<size_t>(window, 1);
+        jobs.push_back(job);
+    }
+
+    boost::thread_group threads;
+    for (size_t i = 0; i < jobs.size(); i++){
+        threads.create_thread(boost::bind(&burn_device, boost::ref(jobs[i])));
+    }
+    threads.join_all();
+
+    //summary
+    size_t num_failed = 0;
+    std::cout << std::endl;
+    for (size_t i = 0; i < jobs.size(); i++){
+        if (jobs[i].error.empty()) std::cout << boost::format("%s: success") % jobs[i].addr << std::endl;
+        else std::cout << boost::format("%s: FAILED: %s") % jobs[i].addr % jobs[i].error << std::endl;
+        if (not jobs[i].error.empty()) num_failed++;
+    }
+    std::cout << boost::format("%u of %u devices updated") % (jobs.size() - num_failed) % jobs.size() << std::endl;
+    return (num_failed == 0)? 0 : ~0;
+}